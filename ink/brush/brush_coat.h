@@ -34,6 +34,8 @@ namespace ink {
 struct BrushCoat {
   BrushTip tip;
   BrushPaint paint;
+
+  friend bool operator==(const BrushCoat&, const BrushCoat&) = default;
 };
 
 namespace brush_internal {
@@ -14,19 +14,31 @@
 
 #include "ink/brush/brush_family.h"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "absl/base/attributes.h"
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "ink/brush/brush_behavior.h"
 #include "ink/brush/brush_coat.h"
 #include "ink/brush/brush_paint.h"
 #include "ink/brush/brush_tip.h"
+#include "ink/brush/texture_handle.h"
+#include "ink/types/memory_footprint.h"
 
 namespace ink {
 
@@ -43,12 +55,89 @@ uint32_t BrushFamily::MaxBrushCoats() {
   return 10;
 }
 
+namespace {
+
+size_t HashBrushCoats(absl::Span<const BrushCoat> coats) {
+  size_t hash = absl::HashOf(coats.size());
+  for (const BrushCoat& coat : coats) {
+    const BrushTip& tip = coat.tip;
+    hash = absl::HashOf(hash, coat.paint, tip.scale, tip.corner_rounding,
+                        tip.slant, tip.pinch, tip.rotation,
+                        tip.opacity_multiplier, tip.particle_gap_distance_scale,
+                        tip.particle_gap_duration, tip.behaviors.size());
+  }
+  return hash;
+}
+
+// A brush family whose coats have been validated, along with their hash.
+struct ValidatedFamily {
+  size_t coats_hash;
+  BrushFamily family;
+};
+
+// The number of recently validated families that are remembered. Each one is
+// held in a slot chosen by the hash of its coats.
+constexpr size_t kValidatedFamilyCacheSlots = 64;
+
+ABSL_CONST_INIT absl::Mutex validated_families_mutex(absl::kConstInit);
+
+std::optional<ValidatedFamily>& ValidatedFamilySlot(size_t coats_hash)
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(validated_families_mutex) {
+  // Intentionally leaked to avoid destruction order issues at exit.
+  static auto* slots =
+      new std::array<std::optional<ValidatedFamily>,
+                     kValidatedFamilyCacheSlots>();
+  return (*slots)[coats_hash % kValidatedFamilyCacheSlots];
+}
+
+std::vector<std::vector<TextureHandle>> InternTextureIds(
+    absl::Span<const BrushCoat> coats) {
+  std::vector<std::vector<TextureHandle>> texture_handles(coats.size());
+  for (size_t i = 0; i < coats.size(); ++i) {
+    texture_handles[i].reserve(coats[i].paint.texture_layers.size());
+    for (const BrushPaint::TextureLayer& layer :
+         coats[i].paint.texture_layers) {
+      texture_handles[i].push_back(
+          TextureHandle::Intern(layer.client_texture_id));
+    }
+  }
+  return texture_handles;
+}
+
+}  // namespace
+
+BrushFamily::BrushFamily() : data_(DefaultData()) {}
+
 BrushFamily::BrushFamily(absl::Span<const BrushCoat> coats,
                          absl::string_view client_brush_family_id,
-                         const InputModel& input_model)
-    : coats_(coats.begin(), coats.end()),
-      client_brush_family_id_(client_brush_family_id),
-      input_model_(input_model) {}
+                         const InputModel& input_model, size_t coats_hash)
+    : data_(std::make_shared<const Data>(Data{
+          .coats = {coats.begin(), coats.end()},
+          .client_brush_family_id = std::string(client_brush_family_id),
+          .input_model = input_model,
+          .texture_handles = InternTextureIds(coats),
+          .hash = absl::HashOf(coats_hash, client_brush_family_id,
+                               input_model.index()),
+      })) {}
+
+const std::shared_ptr<const BrushFamily::Data>& BrushFamily::DefaultData() {
+  // Intentionally leaked to avoid destruction order issues at exit.
+  static const auto* data = new std::shared_ptr<const Data>(
+      BrushFamily({BrushCoat{.tip = BrushTip{}}}, "", DefaultInputModel(),
+                  HashBrushCoats({BrushCoat{.tip = BrushTip{}}}))
+          .data_);
+  return *data;
+}
+
+bool operator==(const BrushFamily& a, const BrushFamily& b) {
+  if (a.data_ == b.data_) return true;
+  const BrushFamily::Data& a_data = *a.data_;
+  const BrushFamily::Data& b_data = *b.data_;
+  return a_data.hash == b_data.hash &&
+         a_data.input_model.index() == b_data.input_model.index() &&
+         a_data.client_brush_family_id == b_data.client_brush_family_id &&
+         a_data.coats == b_data.coats;
+}
 
 absl::StatusOr<BrushFamily> BrushFamily::Create(
     const BrushTip& tip, const BrushPaint& paint,
@@ -66,21 +155,95 @@ absl::StatusOr<BrushFamily> BrushFamily::Create(
         absl::StrCat("A `BrushFamily` cannot have more than ", MaxBrushCoats(),
                      " `BrushCoat`s, but `coats.size()` was ", coats.size()));
   }
+  size_t coats_hash = HashBrushCoats(coats);
+
+  // Families are typically created over and over from the same few brushes,
+  // e.g. when switching between them or decoding a document, and validating
+  // every behavior graph each time is comparatively expensive.
+  {
+    absl::MutexLock lock(&validated_families_mutex);
+    const std::optional<ValidatedFamily>& slot =
+        ValidatedFamilySlot(coats_hash);
+    if (slot.has_value() && slot->coats_hash == coats_hash &&
+        slot->family.GetCoats() == coats) {
+      if (slot->family.GetClientBrushFamilyId() == client_brush_family_id &&
+          slot->family.GetInputModel().index() == input_model.index()) {
+        return slot->family;
+      }
+      return BrushFamily(coats, client_brush_family_id, input_model,
+                         coats_hash);
+    }
+  }
+
   for (const BrushCoat& coat : coats) {
     if (absl::Status status = brush_internal::ValidateBrushCoat(coat);
         !status.ok()) {
       return status;
     }
   }
-  return BrushFamily(coats, client_brush_family_id, input_model);
+  BrushFamily family(coats, client_brush_family_id, input_model, coats_hash);
+  absl::MutexLock lock(&validated_families_mutex);
+  ValidatedFamilySlot(coats_hash) =
+      ValidatedFamily{.coats_hash = coats_hash, .family = family};
+  return family;
+}
+
+absl::StatusOr<BrushFamily> BrushFamily::CreatePreviouslyValidated(
+    absl::Span<const BrushCoat> coats, absl::string_view client_brush_family_id,
+    const InputModel& input_model) {
+  if (coats.size() > MaxBrushCoats()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("A `BrushFamily` cannot have more than ", MaxBrushCoats(),
+                     " `BrushCoat`s, but `coats.size()` was ", coats.size()));
+  }
+  // The behavior nodes are evaluated on a stack, so a malformed node list
+  // could read past it even if every node is otherwise valid.
+  for (const BrushCoat& coat : coats) {
+    for (const BrushBehavior& behavior : coat.tip.behaviors) {
+      if (absl::Status status =
+              brush_internal::ValidateBrushBehaviorTopLevel(behavior);
+          !status.ok()) {
+        return status;
+      }
+    }
+  }
+  return BrushFamily(coats, client_brush_family_id, input_model,
+                     HashBrushCoats(coats));
+}
+
+void BrushFamily::AddToMemoryFootprint(MemoryFootprint& footprint) const {
+  if (!footprint.AddShared(data_.get())) return;
+  // This counts the containers that scale with the complexity of the brush,
+  // but not smaller allocations nested within behavior nodes.
+  size_t bytes = sizeof(Data) + data_->coats.capacity() * sizeof(BrushCoat) +
+                 data_->client_brush_family_id.capacity() +
+                 data_->texture_handles.capacity() *
+                     sizeof(std::vector<TextureHandle>);
+  for (const std::vector<TextureHandle>& handles : data_->texture_handles) {
+    bytes += handles.capacity() * sizeof(TextureHandle);
+  }
+  for (const BrushCoat& coat : data_->coats) {
+    bytes += coat.tip.behaviors.capacity() * sizeof(BrushBehavior);
+    for (const BrushBehavior& behavior : coat.tip.behaviors) {
+      bytes += behavior.nodes.capacity() * sizeof(BrushBehavior::Node);
+    }
+    bytes += coat.paint.texture_layers.capacity() *
+             sizeof(BrushPaint::TextureLayer);
+    for (const BrushPaint::TextureLayer& layer : coat.paint.texture_layers) {
+      bytes += layer.client_texture_id.capacity() +
+               layer.keyframes.capacity() * sizeof(BrushPaint::TextureKeyframe);
+    }
+  }
+  footprint.AddBytes(bytes);
 }
 
 std::string BrushFamily::ToFormattedString() const {
   std::string formatted =
-      absl::StrCat("BrushFamily(coats=[", absl::StrJoin(coats_, ", "), "]");
-  if (!client_brush_family_id_.empty()) {
+      absl::StrCat("BrushFamily(coats=[", absl::StrJoin(data_->coats, ", "),
+                   "]");
+  if (!data_->client_brush_family_id.empty()) {
     absl::StrAppend(&formatted, ", client_brush_family_id='",
-                    client_brush_family_id_, "'");
+                    data_->client_brush_family_id, "'");
   }
   formatted.push_back(')');
   return formatted;
@@ -15,23 +15,32 @@
 #ifndef INK_STROKES_BRUSH_BRUSH_FAMILY_H_
 #define INK_STROKES_BRUSH_BRUSH_FAMILY_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/base/nullability.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush_coat.h"
 #include "ink/brush/brush_paint.h"
 #include "ink/brush/brush_tip.h"
+#include "ink/brush/texture_handle.h"
+#include "ink/types/memory_footprint.h"
 
 namespace ink {
 
 // A `BrushFamily` combines one or more `BrushCoat`s with an optional
 // client-specified string ID, which exists for the convenience of higher level
 // serialization and asset management APIs.
+//
+// A brush family is immutable, and its copies share the same data, so copying
+// one, e.g. along with a `Brush` or `Stroke`, takes constant time.
 class BrushFamily {
  public:
   // LINT.IfChange(input_model_types)
@@ -46,12 +55,21 @@ class BrushFamily {
   // later.
   struct ExperimentalRawPositionModel {};
 
+  // Spring-based model like `SpringModel`, which additionally thins out the
+  // modeled inputs along straight and gently curving parts of the stroke. The
+  // spacing between modeled inputs adapts to the local curvature, so that the
+  // polyline through them stays within roughly the brush epsilon of the
+  // modeled curve. This is an experimental configuration which may be adjusted
+  // or removed later.
+  struct ExperimentalAdaptiveSamplingModel {};
+
   // Specifies a model for turning a sequence of raw hardware inputs (e.g. from
   // a stylus, touchscreen, or mouse) into a sequence of smoothed, modeled
   // inputs. Raw hardware inputs tend to be noisy, and must be smoothed before
   // being passed into a brush's behaviors and extruded into a mesh in order to
   // get a good-looking stroke.
-  using InputModel = std::variant<SpringModel, ExperimentalRawPositionModel>;
+  using InputModel = std::variant<SpringModel, ExperimentalRawPositionModel,
+                                  ExperimentalAdaptiveSamplingModel>;
 
   // Returns the default `InputModel` that will be used by
   // `BrushFamily::Create()` when none is specified.
@@ -98,6 +116,11 @@ class BrushFamily {
   //    rendering tiling and winding textures in a single `BrushPaint`.
   //  * Every enum property must be equal to one of the named enumerators for
   //    that property's type.
+  //
+  // Recently validated coats are remembered, so creating a family whose coats
+  // are equal to those of a recently created one skips their validation. If
+  // its ID and input model are equal too, the new family shares the data of
+  // the earlier one.
   static absl::StatusOr<BrushFamily> Create(
       const BrushTip& tip, const BrushPaint& paint,
       absl::string_view client_brush_family_id = "",
@@ -107,17 +130,39 @@ class BrushFamily {
       absl::string_view client_brush_family_id = "",
       const InputModel& input_model = DefaultInputModel());
 
+  // Identifies the rules that `Create()` validates brush families against. It
+  // is incremented whenever those rules change, so that a family recorded as
+  // validated by an earlier version of the library is validated again.
+  static constexpr uint32_t kValidationVersion = 1;
+
+  // Same as `Create()`, but for coats that are known to have passed the
+  // validation of `Create()` with the same `kValidationVersion`, e.g. because
+  // they were decoded from a trusted proto that records this. Only the number
+  // of coats and the structure of each behavior's node list are checked, which
+  // protect memory safety. Coats that would fail `Create()` may produce a
+  // family that doesn't satisfy all of the invariants documented above.
+  static absl::StatusOr<BrushFamily> CreatePreviouslyValidated(
+      absl::Span<const BrushCoat> coats,
+      absl::string_view client_brush_family_id = "",
+      const InputModel& input_model = DefaultInputModel());
+
   // Constructs a brush-family with default tip and paint and empty ID.
-  BrushFamily() = default;
+  BrushFamily();
 
+  // There are no move operations, which would leave the moved-from family
+  // without data. Copying only increments a reference count.
   BrushFamily(const BrushFamily&) = default;
-  BrushFamily(BrushFamily&&) = default;
   BrushFamily& operator=(const BrushFamily&) = default;
-  BrushFamily& operator=(BrushFamily&&) = default;
 
   absl::Span<const BrushCoat> GetCoats() const;
   const InputModel& GetInputModel() const;
 
+  // Returns the interned `client_texture_id` of each texture layer of the
+  // paint of the coat at `coat_index`, in order. These are interned once when
+  // the family is created, so that renderers can look up textures by handle.
+  // `coat_index` must be less than the number of coats.
+  absl::Span<const TextureHandle> GetTextureHandles(size_t coat_index) const;
+
   // Returns the ID for this brush family specified by the client that
   // originally created it, or an empty string if no ID was specified. This is
   // considered when comparing `BrushFaily` objects for equality, but it is
@@ -125,37 +170,73 @@ class BrushFamily {
   // equivalent, and the ID is not otherwise used internally by Ink.
   const std::string& GetClientBrushFamilyId() const;
 
+  // Adds an estimate of the memory held by this brush family to `footprint`.
+  // Copies of a brush family share their data, so it is only counted once.
+  void AddToMemoryFootprint(MemoryFootprint& footprint) const;
+
+  // Returns true if `a` and `b` have equal coats, input models, and client IDs.
+  // This takes constant time if they share their data, e.g. because one is a
+  // copy of the other, or if their hashes differ.
+  friend bool operator==(const BrushFamily& a, const BrushFamily& b);
+
+  // Brush families are hashed in constant time, using a hash of their contents
+  // that is computed once when they are created.
+  template <typename H>
+  friend H AbslHashValue(H h, const BrushFamily& family) {
+    return H::combine(std::move(h), family.data_->hash);
+  }
+
   template <typename Sink>
   friend void AbslStringify(Sink& sink, const BrushFamily& family) {
     sink.Append(family.ToFormattedString());
   }
 
  private:
+  // The contents of a brush family, shared between its copies.
+  struct Data {
+    std::vector<BrushCoat> coats;
+    std::string client_brush_family_id;
+    InputModel input_model;
+    // The interned texture IDs of each coat's texture layers. These are
+    // derived from `coats`, so don't take part in the hash or in equality.
+    std::vector<std::vector<TextureHandle>> texture_handles;
+    // A hash of the above. Brush tips are not hashable, so only some of their
+    // properties take part in it.
+    size_t hash;
+  };
+
   BrushFamily(absl::Span<const BrushCoat> coats,
               absl::string_view client_brush_family_id,
-              const InputModel& input_model);
+              const InputModel& input_model, size_t coats_hash);
+
+  // Returns the data of a default-constructed brush family, which is shared by
+  // all of them.
+  static const std::shared_ptr<const Data>& DefaultData();
 
   // Implementation helper for AbslStringify.
   std::string ToFormattedString() const;
 
-  std::vector<BrushCoat> coats_ = {BrushCoat{.tip = BrushTip{}}};
-  std::string client_brush_family_id_;
-  InputModel input_model_;
+  absl_nonnull std::shared_ptr<const Data> data_;
 };
 
 // ---------------------------------------------------------------------------
 //                     Implementation details below
 
 inline absl::Span<const BrushCoat> BrushFamily::GetCoats() const {
-  return coats_;
+  return data_->coats;
 }
 
 inline const std::string& BrushFamily::GetClientBrushFamilyId() const {
-  return client_brush_family_id_;
+  return data_->client_brush_family_id;
 }
 
 inline const BrushFamily::InputModel& BrushFamily::GetInputModel() const {
-  return input_model_;
+  return data_->input_model;
+}
+
+inline absl::Span<const TextureHandle> BrushFamily::GetTextureHandles(
+    size_t coat_index) const {
+  return data_->texture_handles[coat_index];
 }
 
 }  // namespace ink
@@ -14,6 +14,7 @@
 
 #include "ink/brush/brush_family.h"
 
+#include <cstddef>
 #include <limits>
 #include <optional>
 #include <string>
@@ -23,6 +24,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
+#include "absl/hash/hash.h"
+#include "absl/hash/hash_testing.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -34,11 +37,13 @@
 #include "ink/brush/brush_tip.h"
 #include "ink/brush/easing_function.h"
 #include "ink/brush/fuzz_domains.h"
+#include "ink/brush/texture_handle.h"
 #include "ink/brush/type_matchers.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/vec.h"
 #include "ink/types/duration.h"
+#include "ink/types/memory_footprint.h"
 
 namespace ink {
 namespace {
@@ -185,6 +190,17 @@ TEST(BrushFamilyTest, CreateWithMultipleCoats) {
   EXPECT_THAT(family->GetCoats(), SizeIs(2));
 }
 
+TEST(BrushFamilyTest, CreateInternsTextureIds) {
+  BrushCoat untextured_coat = {.tip = CreatePressureTestTip()};
+  absl::StatusOr<BrushFamily> family =
+      BrushFamily::Create({CreateTestCoat(), untextured_coat});
+  ASSERT_EQ(family.status(), absl::OkStatus());
+  EXPECT_THAT(family->GetTextureHandles(0),
+              ElementsAre(TextureHandle::Intern(kTestTextureId)));
+  EXPECT_THAT(family->GetTextureHandles(1), IsEmpty());
+  EXPECT_THAT(BrushFamily().GetTextureHandles(0), IsEmpty());
+}
+
 TEST(BrushFamilyTest, CreateWithTooManyCoats) {
   std::vector<BrushCoat> coats(BrushFamily::MaxBrushCoats() + 1,
                                CreateTestCoat());
@@ -193,6 +209,28 @@ TEST(BrushFamilyTest, CreateWithTooManyCoats) {
   EXPECT_THAT(family.status().message(), HasSubstr("coats.size()"));
 }
 
+TEST(BrushFamilyTest, CreatePreviouslyValidated) {
+  // This coat would fail `Create()`, but its validation is skipped.
+  BrushCoat coat = {.tip = {.corner_rounding = 2}};
+  absl::StatusOr<BrushFamily> family =
+      BrushFamily::CreatePreviouslyValidated({coat}, "test-family");
+  ASSERT_EQ(family.status(), absl::OkStatus());
+  EXPECT_EQ(family->GetCoats()[0].tip.corner_rounding, 2);
+  EXPECT_EQ(family->GetClientBrushFamilyId(), "test-family");
+
+  // The number of coats and the structure of behaviors are still checked.
+  std::vector<BrushCoat> too_many_coats(BrushFamily::MaxBrushCoats() + 1,
+                                        CreateTestCoat());
+  EXPECT_EQ(
+      BrushFamily::CreatePreviouslyValidated(too_many_coats).status().code(),
+      absl::StatusCode::kInvalidArgument);
+  BrushCoat malformed_coat = {
+      .tip = {.behaviors = {BrushBehavior{{BrushBehavior::ConstantNode{}}}}}};
+  EXPECT_EQ(
+      BrushFamily::CreatePreviouslyValidated({malformed_coat}).status().code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
 TEST(BrushFamilyTest, CreateWithInvalidTipScale) {
   {
     absl::Status status =
@@ -965,6 +1003,90 @@ TEST(BrushFamilyTest, CopyAndMove) {
   }
 }
 
+TEST(BrushFamilyTest, CopiesShareCoats) {
+  auto family = BrushFamily::Create(CreatePressureTestTip(), CreateTestPaint(),
+                                    "/brush-family:test-family");
+  ASSERT_EQ(absl::OkStatus(), family.status());
+
+  BrushFamily copied_family = *family;
+  EXPECT_EQ(copied_family.GetCoats().data(), family->GetCoats().data());
+  EXPECT_EQ(copied_family, *family);
+
+  BrushFamily assigned_family;
+  assigned_family = *family;
+  EXPECT_EQ(assigned_family.GetCoats().data(), family->GetCoats().data());
+  EXPECT_EQ(assigned_family, *family);
+}
+
+TEST(BrushFamilyTest, CreateEqualFamiliesSharesCoats) {
+  auto family = BrushFamily::Create(CreatePressureTestTip(), CreateTestPaint(),
+                                    "/brush-family:test-family");
+  ASSERT_EQ(absl::OkStatus(), family.status());
+  auto same_family =
+      BrushFamily::Create(CreatePressureTestTip(), CreateTestPaint(),
+                          "/brush-family:test-family");
+  ASSERT_EQ(absl::OkStatus(), same_family.status());
+  EXPECT_EQ(same_family->GetCoats().data(), family->GetCoats().data());
+
+  // A family with the same coats but a different ID skips validation, but
+  // can't share the data.
+  auto other_id_family =
+      BrushFamily::Create(CreatePressureTestTip(), CreateTestPaint(),
+                          "/brush-family:other-family");
+  ASSERT_EQ(absl::OkStatus(), other_id_family.status());
+  EXPECT_NE(other_id_family->GetCoats().data(), family->GetCoats().data());
+  EXPECT_THAT(other_id_family->GetCoats(),
+              Pointwise(BrushCoatEq(), family->GetCoats()));
+  EXPECT_EQ(other_id_family->GetClientBrushFamilyId(),
+            "/brush-family:other-family");
+}
+
+TEST(BrushFamilyTest, EqualityAndHash) {
+  auto family = BrushFamily::Create(CreatePressureTestTip(), CreateTestPaint(),
+                                    "/brush-family:test-family");
+  ASSERT_EQ(absl::OkStatus(), family.status());
+  auto same_family =
+      BrushFamily::Create(CreatePressureTestTip(), CreateTestPaint(),
+                          "/brush-family:test-family");
+  ASSERT_EQ(absl::OkStatus(), same_family.status());
+  auto other_id_family =
+      BrushFamily::Create(CreatePressureTestTip(), CreateTestPaint(),
+                          "/brush-family:other-family");
+  ASSERT_EQ(absl::OkStatus(), other_id_family.status());
+  auto other_tip_family =
+      BrushFamily::Create(BrushTip{}, CreateTestPaint(),
+                          "/brush-family:test-family");
+  ASSERT_EQ(absl::OkStatus(), other_tip_family.status());
+
+  EXPECT_EQ(*family, *same_family);
+  EXPECT_EQ(absl::HashOf(*family), absl::HashOf(*same_family));
+  EXPECT_NE(*family, *other_id_family);
+  EXPECT_NE(*family, *other_tip_family);
+  EXPECT_EQ(BrushFamily(), BrushFamily());
+
+  EXPECT_TRUE(absl::VerifyTypeImplementsAbslHashCorrectly({
+      BrushFamily(),
+      *family,
+      *same_family,
+      *other_id_family,
+      *other_tip_family,
+  }));
+}
+
+TEST(BrushFamilyTest, MemoryFootprintCountsSharedDataOnce) {
+  auto family = BrushFamily::Create(CreatePressureTestTip(), CreateTestPaint(),
+                                    "/brush-family:test-family");
+  ASSERT_EQ(absl::OkStatus(), family.status());
+  BrushFamily copied_family = *family;
+
+  MemoryFootprint footprint;
+  family->AddToMemoryFootprint(footprint);
+  size_t one_family_bytes = footprint.TotalBytes();
+  EXPECT_GT(one_family_bytes, 0u);
+  copied_family.AddToMemoryFootprint(footprint);
+  EXPECT_EQ(footprint.TotalBytes(), one_family_bytes);
+}
+
 TEST(BrushFamilyTest, CreateWithInvalidBrushPaint) {
   // `TextureLayer::mapping` has invalid enum value
   {
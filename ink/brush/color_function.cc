@@ -20,6 +20,7 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "ink/color/color.h"
 
 namespace ink {
@@ -29,6 +30,14 @@ Color ColorFunction::operator()(const Color& color) const {
                     parameters);
 }
 
+void ColorFunction::Apply(absl::Span<Color> colors) const {
+  std::visit(
+      [colors](const auto& params) {
+        for (Color& color : colors) color = params(color);
+      },
+      parameters);
+}
+
 Color ColorFunction::OpacityMultiplier::operator()(const Color& color) const {
   return color.WithAlphaFloat(multiplier * color.GetAlphaFloat());
 }
@@ -21,6 +21,7 @@
 #include <variant>
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "ink/color/color.h"
 
 namespace ink {
@@ -51,6 +52,11 @@ struct ColorFunction {
   Parameters parameters;
 
   Color operator()(const Color& color) const;
+
+  // Applies this function to each of `colors` in place, dispatching on the
+  // type of `parameters` only once for the whole span.
+  void Apply(absl::Span<Color> colors) const;
+
   friend bool operator==(const ColorFunction&, const ColorFunction&) = default;
 };
 
@@ -14,7 +14,9 @@
 
 #include "ink/brush/color_function.h"
 
+#include <cstddef>
 #include <limits>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -23,6 +25,7 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "ink/brush/fuzz_domains.h"
 #include "ink/color/color.h"
 #include "ink/color/fuzz_domains.h"
@@ -32,6 +35,7 @@ namespace {
 
 using ::absl_testing::IsOk;
 using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 static_assert(std::numeric_limits<float>::has_quiet_NaN);
@@ -143,6 +147,32 @@ TEST(ColorFunctionTest, ApplyOpacityMultiplier) {
             Color::FromFloat(1, 1, 1, 0.375));
 }
 
+TEST(ColorFunctionTest, ApplyToSpan) {
+  std::vector<Color> colors = {Color::Red(), Color::FromFloat(1, 1, 1, 0.75)};
+  (ColorFunction{ColorFunction::OpacityMultiplier{0.5}}).Apply(
+      absl::MakeSpan(colors));
+  EXPECT_THAT(colors, ElementsAre(Color::Red().WithAlphaFloat(0.5),
+                                  Color::FromFloat(1, 1, 1, 0.375)));
+
+  (ColorFunction{ColorFunction::ReplaceColor{Color::Blue()}}).Apply(
+      absl::MakeSpan(colors));
+  EXPECT_THAT(colors, ElementsAre(Color::Blue(), Color::Blue()));
+
+  ColorFunction().Apply(absl::Span<Color>());
+}
+
+void ApplyToSpanMatchesApplyToEachColor(const ColorFunction& color_function,
+                                        const std::vector<Color>& colors) {
+  std::vector<Color> applied = colors;
+  color_function.Apply(absl::MakeSpan(applied));
+  ASSERT_EQ(applied.size(), colors.size());
+  for (size_t i = 0; i < colors.size(); ++i) {
+    EXPECT_EQ(applied[i], color_function(colors[i]));
+  }
+}
+FUZZ_TEST(ColorFunctionTest, ApplyToSpanMatchesApplyToEachColor)
+    .WithDomains(ValidColorFunction(), fuzztest::VectorOf(ArbitraryColor()));
+
 void DefaultConstructedColorFunctionIsIdentity(const Color& color) {
   ColorFunction color_function;
   EXPECT_EQ(color_function(color), color);
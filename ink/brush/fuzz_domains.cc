@@ -545,7 +545,8 @@ Domain<BrushFamily> ValidBrushFamily(DomainVariant variant) {
 
 Domain<BrushFamily::InputModel> ValidBrushFamilyInputModel() {
   return VariantOf(StructOf<BrushFamily::SpringModel>(),
-                   StructOf<BrushFamily::ExperimentalRawPositionModel>());
+                   StructOf<BrushFamily::ExperimentalRawPositionModel>(),
+                   StructOf<BrushFamily::ExperimentalAdaptiveSamplingModel>());
 }
 
 namespace {
@@ -43,6 +43,7 @@ using ::ink::jni::ThrowExceptionFromStatus;
 // 0 is reserved for internal use.
 constexpr jint kSpringModel = 1;
 constexpr jint kExperimentalRawPositionModel = 2;
+constexpr jint kExperimentalAdaptiveSamplingModel = 3;
 
 BrushFamily::InputModel JIntToInputModel(jint input_model_value) {
   switch (input_model_value) {
@@ -50,6 +51,8 @@ BrushFamily::InputModel JIntToInputModel(jint input_model_value) {
       return BrushFamily::SpringModel();
     case kExperimentalRawPositionModel:
       return BrushFamily::ExperimentalRawPositionModel();
+    case kExperimentalAdaptiveSamplingModel:
+      return BrushFamily::ExperimentalAdaptiveSamplingModel();
     default:
       ABSL_CHECK(false) << "Unknown input model value: " << input_model_value;
   }
@@ -61,6 +64,10 @@ jint InputModelToJInt(BrushFamily::ExperimentalRawPositionModel) {
   return kExperimentalRawPositionModel;
 }
 
+jint InputModelToJInt(BrushFamily::ExperimentalAdaptiveSamplingModel) {
+  return kExperimentalAdaptiveSamplingModel;
+}
+
 jint InputModelToJInt(BrushFamily::InputModel input_model) {
   return std::visit([](const auto& model) { return InputModelToJInt(model); },
                     input_model);
@@ -0,0 +1,66 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/brush/texture_handle.h"
+
+#include <string>
+
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ink {
+namespace {
+
+// The interned texture IDs. Node-based, so that the address of each ID is
+// stable, and never destroyed, so that handles remain valid during static
+// destruction.
+struct InternedIds {
+  absl::Mutex mutex;
+  absl::node_hash_set<std::string> ids ABSL_GUARDED_BY(mutex);
+};
+
+InternedIds& GetInternedIds() {
+  static InternedIds* interned_ids = new InternedIds();
+  return *interned_ids;
+}
+
+const std::string* absl_nonnull EmptyId() {
+  static const std::string* empty_id = new std::string();
+  return empty_id;
+}
+
+}  // namespace
+
+TextureHandle TextureHandle::Intern(absl::string_view texture_id) {
+  if (texture_id.empty()) return TextureHandle();
+  InternedIds& interned_ids = GetInternedIds();
+  {
+    // IDs are almost always interned already, so look them up under a shared
+    // lock first.
+    absl::ReaderMutexLock lock(&interned_ids.mutex);
+    if (auto it = interned_ids.ids.find(texture_id);
+        it != interned_ids.ids.end()) {
+      return TextureHandle(&*it);
+    }
+  }
+  absl::MutexLock lock(&interned_ids.mutex);
+  return TextureHandle(&*interned_ids.ids.emplace(texture_id).first);
+}
+
+TextureHandle::TextureHandle() : id_(EmptyId()) {}
+
+}  // namespace ink
@@ -0,0 +1,74 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_BRUSH_TEXTURE_HANDLE_H_
+#define INK_BRUSH_TEXTURE_HANDLE_H_
+
+#include <string>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/strings/string_view.h"
+
+namespace ink {
+
+// A compact handle for the `client_texture_id` of a `BrushPaint::TextureLayer`.
+//
+// Texture IDs are interned, so that handles for equal IDs are equal, and
+// handles are compared and hashed in constant time, regardless of the length
+// of the ID. This lets renderers look up cached texture objects without
+// hashing strings on every draw. `BrushFamily` interns the texture IDs of its
+// coats when it is created; see `BrushFamily::GetTextureHandles()`.
+//
+// Interned IDs are kept for the lifetime of the process, since apps use few
+// distinct textures. Handles are not stable across processes, so store the ID
+// rather than the handle.
+class TextureHandle {
+ public:
+  // Returns the handle for `texture_id`, interning it first if needed. This
+  // takes a lock and hashes `texture_id`, so it should be called once, e.g.
+  // when a brush family is created, rather than for each lookup.
+  static TextureHandle Intern(absl::string_view texture_id);
+
+  // Constructs the handle for the empty ID.
+  TextureHandle();
+
+  TextureHandle(const TextureHandle&) = default;
+  TextureHandle& operator=(const TextureHandle&) = default;
+
+  const std::string& TextureId() const { return *id_; }
+
+  friend bool operator==(TextureHandle a, TextureHandle b) {
+    return a.id_ == b.id_;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, TextureHandle handle) {
+    return H::combine(std::move(h), handle.id_);
+  }
+
+  template <typename Sink>
+  friend void AbslStringify(Sink& sink, TextureHandle handle) {
+    sink.Append(*handle.id_);
+  }
+
+ private:
+  explicit TextureHandle(const std::string* absl_nonnull id) : id_(id) {}
+
+  const std::string* absl_nonnull id_;
+};
+
+}  // namespace ink
+
+#endif  // INK_BRUSH_TEXTURE_HANDLE_H_
@@ -0,0 +1,57 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/brush/texture_handle.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
+
+namespace ink {
+namespace {
+
+TEST(TextureHandleTest, DefaultIsEmptyId) {
+  EXPECT_EQ(TextureHandle().TextureId(), "");
+  EXPECT_EQ(TextureHandle(), TextureHandle::Intern(""));
+}
+
+TEST(TextureHandleTest, EqualIdsHaveEqualHandles) {
+  std::string id = "test-texture";
+  TextureHandle a = TextureHandle::Intern(id);
+  TextureHandle b = TextureHandle::Intern(std::string("test-") + "texture");
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(absl::HashOf(a), absl::HashOf(b));
+  EXPECT_EQ(a.TextureId(), id);
+  // The interned ID is not the argument.
+  EXPECT_NE(&a.TextureId(), &id);
+}
+
+TEST(TextureHandleTest, DifferentIdsHaveDifferentHandles) {
+  TextureHandle a = TextureHandle::Intern("texture-a");
+  TextureHandle b = TextureHandle::Intern("texture-b");
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, TextureHandle());
+  EXPECT_EQ(a.TextureId(), "texture-a");
+  EXPECT_EQ(b.TextureId(), "texture-b");
+}
+
+TEST(TextureHandleTest, Stringify) {
+  EXPECT_EQ(absl::StrCat(TextureHandle::Intern("some-texture")),
+            "some-texture");
+}
+
+}  // namespace
+}  // namespace ink
@@ -347,6 +347,12 @@ Matcher<BrushFamily::InputModel> BrushFamilyInputModelEqMatcher(
       _);  // no fields to match
 }
 
+Matcher<BrushFamily::InputModel> BrushFamilyInputModelEqMatcher(
+    const BrushFamily::ExperimentalAdaptiveSamplingModel& input_model) {
+  return VariantWith<BrushFamily::ExperimentalAdaptiveSamplingModel>(
+      _);  // no fields to match
+}
+
 [[maybe_unused]] Matcher<BrushFamily::InputModel> BrushFamilyInputModelEq(
     const BrushFamily::InputModel& expected) {
   return std::visit(
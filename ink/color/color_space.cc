@@ -14,12 +14,14 @@
 
 #include "ink/color/color_space.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <string>
 
 #include "absl/log/absl_log.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 
 namespace ink {
 namespace {
@@ -126,6 +128,97 @@ float GammaEncode(float linear_value, ColorSpace space) {
 
 namespace {
 
+// The number of linearly interpolated segments in each of the transfer function
+// tables used to decode and encode spans of values.
+constexpr int kTransferTableSegments = 1024;
+
+using TransferTable = std::array<float, kTransferTableSegments + 1>;
+
+// Tables of the sRGB transfer functions, which are also used by Display P3.
+struct SrgbTransferTables {
+  // The EOTF at `i / kTransferTableSegments` for each index `i`.
+  TransferTable decode;
+  // The OETF at `(i / kTransferTableSegments)^2` for each index `i`. Indexing
+  // by the square root of the linear value puts more entries near black, where
+  // the OETF is most curved, so that interpolation stays accurate there.
+  TransferTable encode;
+};
+
+const SrgbTransferTables& GetSrgbTransferTables() {
+  static const SrgbTransferTables* tables = [] {
+    auto* tables = new SrgbTransferTables;
+    for (int i = 0; i <= kTransferTableSegments; ++i) {
+      double t = static_cast<double>(i) / kTransferTableSegments;
+      tables->decode[i] = static_cast<float>(
+          t < kSrgbD ? kSrgbC * t : std::pow(kSrgbA * t + kSrgbB, kSrgbG));
+      double linear = t * t;
+      tables->encode[i] = static_cast<float>(
+          linear < kSrgbC * kSrgbD
+              ? linear / kSrgbC
+              : (std::pow(linear, 1.0 / kSrgbG) - kSrgbB) / kSrgbA);
+    }
+    return tables;
+  }();
+  return *tables;
+}
+
+// Returns the linear interpolation of `table` at `t`, which must be in [0, 1].
+float InterpolateTransferTable(const TransferTable& table, float t) {
+  float scaled = t * kTransferTableSegments;
+  int index = std::min(static_cast<int>(scaled), kTransferTableSegments - 1);
+  float fraction = scaled - static_cast<float>(index);
+  return table[index] + (table[index + 1] - table[index]) * fraction;
+}
+
+bool IsKnownColorSpace(ColorSpace space) {
+  switch (space) {
+    case ColorSpace::kSrgb:
+    case ColorSpace::kDisplayP3:
+      return true;
+  }
+  ABSL_LOG(DFATAL) << "Unknown ColorSpace enum value "
+                   << static_cast<int>(space);
+  return false;
+}
+
+}  // namespace
+
+void GammaDecode(absl::Span<float> encoded_values, ColorSpace space) {
+  if (!IsKnownColorSpace(space)) {
+    std::fill(encoded_values.begin(), encoded_values.end(), 0.0f);
+    return;
+  }
+  // sRGB and Display P3 use the same gamma curve: the sRGB curve.
+  const TransferTable& table = GetSrgbTransferTables().decode;
+  for (float& value : encoded_values) {
+    // This is false for NaN, which is passed through.
+    if (value >= 0 && value <= 1) {
+      value = InterpolateTransferTable(table, value);
+    } else {
+      value = GammaDecode(value, space);
+    }
+  }
+}
+
+void GammaEncode(absl::Span<float> linear_values, ColorSpace space) {
+  if (!IsKnownColorSpace(space)) {
+    std::fill(linear_values.begin(), linear_values.end(), 0.0f);
+    return;
+  }
+  // sRGB and Display P3 use the same gamma curve: the sRGB curve.
+  const TransferTable& table = GetSrgbTransferTables().encode;
+  for (float& value : linear_values) {
+    if (value >= kSrgbC * kSrgbD && value <= 1) {
+      value = InterpolateTransferTable(table, std::sqrt(value));
+    } else {
+      // The linear segment near black is cheap enough to compute exactly.
+      value = GammaEncode(value, space);
+    }
+  }
+}
+
+namespace {
+
 // Multiplies two 3x3 matrices. a, b, and result are column-major.
 std::array<double, 9> MultMat3ByMat3(const std::array<double, 9>& a,
                                      const std::array<double, 9>& b) {
@@ -165,6 +258,17 @@ std::array<float, 4> ConvertColor(
   return MultMat3ByVec4(conversion_matrix, rgba_linear_nonpremultiplied);
 }
 
+void ConvertColors(
+    absl::Span<std::array<float, 4>> rgba_linear_nonpremultiplied,
+    ColorSpace source, ColorSpace target) {
+  if (source == target) return;
+  const std::array<double, 9> conversion_matrix =
+      MultMat3ByMat3(GetFromXyzD65(target), GetToXyzD65(source));
+  for (std::array<float, 4>& rgba : rgba_linear_nonpremultiplied) {
+    rgba = MultMat3ByVec4(conversion_matrix, rgba);
+  }
+}
+
 std::array<float, 5> GetGammaDecodingParameters(ColorSpace space) {
   switch (space) {
     case ColorSpace::kSrgb:
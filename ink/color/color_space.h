@@ -18,6 +18,8 @@
 #include <array>
 #include <string>
 
+#include "absl/types/span.h"
+
 namespace ink {
 
 // A color space, which gives concrete meaning to raw color channel values.
@@ -43,6 +45,18 @@ float GammaDecode(float encoded_value, ColorSpace space);
 // instead.
 float GammaEncode(float linear_value, ColorSpace space);
 
+// Applies `GammaDecode()` to each of `encoded_values` in place. Values in
+// [0, 1] are decoded with a precomputed table, which is much faster than
+// decoding them one at a time, and is within 1e-6 of `GammaDecode()`. Values
+// outside of that range are decoded exactly.
+void GammaDecode(absl::Span<float> encoded_values, ColorSpace space);
+
+// Applies `GammaEncode()` to each of `linear_values` in place. Values in
+// [0, 1] are encoded with a precomputed table, which is much faster than
+// encoding them one at a time, and is within 1e-5 of `GammaEncode()`. Values
+// outside of that range are encoded exactly.
+void GammaEncode(absl::Span<float> linear_values, ColorSpace space);
+
 // Converts linear, non-premultiplied RGBA coordinates color space `source` to
 // linear, non-premultiplied coordinates for the same color in `target`. Most
 // callers should use Color::InColorSpace() instead.
@@ -50,6 +64,12 @@ std::array<float, 4> ConvertColor(
     const std::array<float, 4>& rgba_linear_nonpremultiplied, ColorSpace source,
     ColorSpace target);
 
+// Applies `ConvertColor()` to each of `rgba_linear_nonpremultiplied` in place,
+// computing the conversion matrix only once.
+void ConvertColors(
+    absl::Span<std::array<float, 4>> rgba_linear_nonpremultiplied,
+    ColorSpace source, ColorSpace target);
+
 // For external implementations (e.g., shaders) only. Prefer calling
 // GammaDecode() or GammaEncode().
 //
@@ -16,11 +16,14 @@
 
 #include <array>
 #include <cmath>
+#include <cstddef>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "ink/color/fuzz_domains.h"
 #include "ink/color/type_matchers.h"
 
@@ -89,6 +92,60 @@ void DisplayP3UsesSameTransferFunctionAsSrgb(float x) {
 FUZZ_TEST(ColorSpaceTest, DisplayP3UsesSameTransferFunctionAsSrgb)
     .WithDomains(fuzztest::InRange(0.0f, 1.0f));
 
+void SpanGammaDecodeIsCloseToGammaDecode(float x) {
+  for (ColorSpace space : {ColorSpace::kSrgb, ColorSpace::kDisplayP3}) {
+    float value = x;
+    GammaDecode(absl::MakeSpan(&value, 1), space);
+    EXPECT_THAT(value, FloatNear(GammaDecode(x, space), 1e-6));
+  }
+}
+FUZZ_TEST(ColorSpaceTest, SpanGammaDecodeIsCloseToGammaDecode)
+    .WithDomains(fuzztest::InRange(0.0f, 1.0f));
+
+void SpanGammaEncodeIsCloseToGammaEncode(float x) {
+  for (ColorSpace space : {ColorSpace::kSrgb, ColorSpace::kDisplayP3}) {
+    float value = x;
+    GammaEncode(absl::MakeSpan(&value, 1), space);
+    EXPECT_THAT(value, FloatNear(GammaEncode(x, space), 1e-5));
+  }
+}
+FUZZ_TEST(ColorSpaceTest, SpanGammaEncodeIsCloseToGammaEncode)
+    .WithDomains(fuzztest::InRange(0.0f, 1.0f));
+
+TEST(ColorSpaceTest, SpanGammaDecodeAndEncodeOfEveryByte) {
+  std::vector<float> values;
+  for (int i = 0; i <= 255; ++i) values.push_back(i / 255.0f);
+  std::vector<float> decoded = values;
+  GammaDecode(absl::MakeSpan(decoded), ColorSpace::kSrgb);
+  std::vector<float> encoded = decoded;
+  GammaEncode(absl::MakeSpan(encoded), ColorSpace::kSrgb);
+  for (int i = 0; i <= 255; ++i) {
+    EXPECT_THAT(decoded[i],
+                FloatNear(GammaDecode(values[i], ColorSpace::kSrgb), 1e-6));
+    // The round trip doesn't change any 8-bit value.
+    EXPECT_EQ(std::round(encoded[i] * 255), i);
+  }
+}
+
+TEST(ColorSpaceTest, SpanGammaIsExactOutsideZeroToOne) {
+  std::array<float, 4> values = {-0.5f, 1.5f, 10.0f, std::nanf("")};
+  std::array<float, 4> decoded = values;
+  GammaDecode(absl::MakeSpan(decoded), ColorSpace::kSrgb);
+  std::array<float, 4> encoded = values;
+  GammaEncode(absl::MakeSpan(encoded), ColorSpace::kSrgb);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(decoded[i], GammaDecode(values[i], ColorSpace::kSrgb));
+    EXPECT_EQ(encoded[i], GammaEncode(values[i], ColorSpace::kSrgb));
+  }
+  EXPECT_TRUE(std::isnan(decoded[3]));
+  EXPECT_TRUE(std::isnan(encoded[3]));
+}
+
+TEST(ColorSpaceTest, SpanGammaOfEmptySpan) {
+  GammaDecode(absl::Span<float>(), ColorSpace::kSrgb);
+  GammaEncode(absl::Span<float>(), ColorSpace::kSrgb);
+}
+
 TEST(ColorSpaceDeathTest, GammaDecodeWithOutOfRangeEnumValueDies) {
   // TODO: b/173787033 - Simplify once --config=wasm supports death tests.
 #ifdef GTEST_HAS_DEATH_TEST
@@ -166,6 +223,23 @@ void DisplayP3ToSrgbAndBackIsIdentity(const std::array<float, 4>& rgba) {
 FUZZ_TEST(ColorSpaceTest, DisplayP3ToSrgbAndBackIsIdentity)
     .WithDomains(FourFloatsInZeroOne());
 
+void ConvertColorsMatchesConvertColor(
+    const std::vector<std::array<float, 4>>& colors) {
+  for (ColorSpace source : {ColorSpace::kSrgb, ColorSpace::kDisplayP3}) {
+    for (ColorSpace target : {ColorSpace::kSrgb, ColorSpace::kDisplayP3}) {
+      std::vector<std::array<float, 4>> converted = colors;
+      ConvertColors(absl::MakeSpan(converted), source, target);
+      ASSERT_EQ(converted.size(), colors.size());
+      for (size_t i = 0; i < colors.size(); ++i) {
+        EXPECT_THAT(converted[i],
+                    ElementsAreArray(ConvertColor(colors[i], source, target)));
+      }
+    }
+  }
+}
+FUZZ_TEST(ColorSpaceTest, ConvertColorsMatchesConvertColor)
+    .WithDomains(fuzztest::VectorOf(FourFloatsInZeroOne()));
+
 void SrgbColorsAreInsideDisplayP3Gamut(const std::array<float, 4>& rgba) {
   EXPECT_THAT(
       ConvertColor(rgba, ColorSpace::kSrgb, ColorSpace::kDisplayP3),
@@ -14,12 +14,15 @@
 
 #include "ink/geometry/affine_transform.h"
 
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
 
+#include "absl/log/absl_check.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/quad.h"
@@ -55,6 +58,28 @@ Point AffineTransform::Apply(Point p) const {
   return Point{A() * p.x + B() * p.y + C(), D() * p.x + E() * p.y + F()};
 }
 
+void AffineTransform::Apply(absl::Span<const Point> input,
+                            absl::Span<Point> output) const {
+  ABSL_CHECK_EQ(input.size(), output.size());
+  // Copying the coefficients into locals lets the compiler assume that they
+  // aren't modified by the writes to `output`, so that it can vectorize the
+  // loop.
+  const float a = a_;
+  const float b = b_;
+  const float c = c_;
+  const float d = d_;
+  const float e = e_;
+  const float f = f_;
+  const Point* in = input.data();
+  Point* out = output.data();
+  for (size_t i = 0; i < input.size(); ++i) {
+    const float x = in[i].x;
+    const float y = in[i].y;
+    out[i].x = a * x + b * y + c;
+    out[i].y = d * x + e * y + f;
+  }
+}
+
 Segment AffineTransform::Apply(const Segment& s) const {
   return Segment{Apply(s.start), Apply(s.end)};
 }
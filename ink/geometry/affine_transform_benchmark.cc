@@ -0,0 +1,114 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh_format.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+
+namespace ink {
+namespace {
+
+const AffineTransform kTransform(1.5f, -0.5f, 10.f, 0.25f, 2.f, -3.f);
+
+std::vector<Point> MakePoints(int64_t n_points) {
+  std::vector<Point> points;
+  points.reserve(n_points);
+  for (int64_t i = 0; i < n_points; ++i) {
+    points.push_back({0.1f * i, -0.2f * i});
+  }
+  return points;
+}
+
+void BM_ApplyToEachPoint(benchmark::State& state) {
+  std::vector<Point> points = MakePoints(state.range(0));
+  for (auto s : state) {
+    for (Point& p : points) p = kTransform.Apply(p);
+    benchmark::DoNotOptimize(points.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ApplyToEachPoint)->Range(8, 1 << 16);
+
+void BM_ApplyInPlace(benchmark::State& state) {
+  std::vector<Point> points = MakePoints(state.range(0));
+  for (auto s : state) {
+    kTransform.ApplyInPlace(absl::MakeSpan(points));
+    benchmark::DoNotOptimize(points.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ApplyInPlace)->Range(8, 1 << 16);
+
+MutableMesh MakeMesh(const MeshFormat& format, int64_t n_vertices) {
+  MutableMesh mesh(format);
+  for (Point p : MakePoints(n_vertices)) mesh.AppendVertex(p);
+  return mesh;
+}
+
+void BM_TransformVertexPositionsWithSetVertexPosition(
+    benchmark::State& state) {
+  MutableMesh mesh = MakeMesh(MeshFormat(), state.range(0));
+  for (auto s : state) {
+    for (uint32_t i = 0; i < mesh.VertexCount(); ++i) {
+      mesh.SetVertexPosition(i, kTransform.Apply(mesh.VertexPosition(i)));
+    }
+    benchmark::DoNotOptimize(mesh.RawVertexData().data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformVertexPositionsWithSetVertexPosition)
+    ->Range(8, 1 << 16);
+
+void BM_TransformVertexPositionsPositionOnly(benchmark::State& state) {
+  MutableMesh mesh = MakeMesh(MeshFormat(), state.range(0));
+  for (auto s : state) {
+    mesh.TransformVertexPositions(kTransform);
+    benchmark::DoNotOptimize(mesh.RawVertexData().data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformVertexPositionsPositionOnly)->Range(8, 1 << 16);
+
+void BM_TransformVertexPositionsInterleaved(benchmark::State& state) {
+  MutableMesh mesh = MakeMesh(
+      *MeshFormat::Create(
+          {{MeshFormat::AttributeType::kFloat2Unpacked,
+            MeshFormat::AttributeId::kPosition},
+           {MeshFormat::AttributeType::kFloat4PackedInOneFloat,
+            MeshFormat::AttributeId::kCustom0},
+           {MeshFormat::AttributeType::kFloat3PackedInTwoFloats,
+            MeshFormat::AttributeId::kCustom1}},
+          MeshFormat::IndexFormat::k32BitUnpacked16BitPacked),
+      state.range(0));
+  for (auto s : state) {
+    mesh.TransformVertexPositions(kTransform);
+    benchmark::DoNotOptimize(mesh.RawVertexData().data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransformVertexPositionsInterleaved)->Range(8, 1 << 16);
+
+}  // namespace
+}  // namespace ink
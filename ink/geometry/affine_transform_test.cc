@@ -15,12 +15,15 @@
 #include "ink/geometry/affine_transform.h"
 
 #include <array>
+#include <cstddef>
 #include <optional>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/fuzz_domains.h"
 #include "ink/geometry/point.h"
@@ -34,6 +37,8 @@
 namespace ink {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::Optional;
 
 TEST(AffineTransformTest, Stringify) {
@@ -1436,5 +1441,32 @@ TEST(AffineTransformTest, Multiplication) {
                                                 177.0f, 144.0f)));
 }
 
+TEST(AffineTransformTest, ApplyToSpanMatchesApplyToEachPoint) {
+  AffineTransform transform(2.0f, -5.0f, 4.0f, 3.0f, 9.0f, -6.0f);
+  std::vector<Point> input;
+  for (int i = 0; i < 1000; ++i) {
+    input.push_back({0.5f * i, -0.25f * i + 3});
+  }
+  std::vector<Point> output(input.size());
+  transform.Apply(input, absl::MakeSpan(output));
+  for (size_t i = 0; i < input.size(); ++i) {
+    EXPECT_THAT(output[i], PointEq(transform.Apply(input[i]))) << "i = " << i;
+  }
+}
+
+TEST(AffineTransformTest, ApplyInPlace) {
+  AffineTransform transform = AffineTransform::Translate({1, 2}) *
+                              AffineTransform::Rotate(kQuarterTurn);
+  std::vector<Point> points = {{0, 0}, {1, 0}, {0, 3}};
+  transform.ApplyInPlace(absl::MakeSpan(points));
+  EXPECT_THAT(points, ElementsAre(PointNear({1, 2}, 1e-6),
+                                  PointNear({1, 3}, 1e-6),
+                                  PointNear({-2, 2}, 1e-6)));
+
+  std::vector<Point> empty;
+  transform.ApplyInPlace(absl::MakeSpan(empty));
+  EXPECT_THAT(empty, IsEmpty());
+}
+
 }  // namespace
 }  // namespace ink
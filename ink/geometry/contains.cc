@@ -0,0 +1,276 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/contains.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+#include "ink/geometry/vec.h"
+
+namespace ink {
+namespace {
+
+// This is a helper function for the `Contains` overloads that take a convex
+// primitive and a `PartitionedMesh`.
+template <typename ConvexType>
+bool ConvexContainsPartitionedMesh(const ConvexType& a,
+                                   const PartitionedMesh& b,
+                                   const AffineTransform& b_to_a_transform) {
+  std::optional<Rect> b_bounds = b.Bounds().AsRect();
+  // An empty shape is not contained in anything.
+  if (!b_bounds.has_value()) return false;
+
+  // If `b`'s bounds are inside `a`, then so is `b`.
+  bool bounds_are_inside = true;
+  for (Point corner : b_to_a_transform.Apply(*b_bounds).Corners()) {
+    if (!a.Contains(corner)) {
+      bounds_are_inside = false;
+      break;
+    }
+  }
+  if (bounds_are_inside) return true;
+
+  // Since `a` is convex, it contains each of `b`'s triangles exactly when it
+  // contains the triangle's vertices.
+  for (const Mesh& mesh : b.Meshes()) {
+    for (uint32_t i = 0; i < mesh.VertexCount(); ++i) {
+      if (!a.Contains(b_to_a_transform.Apply(mesh.VertexPosition(i)))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// For each triangle of a `PartitionedMesh`, indexed by mesh and then by
+// triangle, a bitmask of the edges of the triangle that lie on the boundary of
+// the mesh, where bit k stands for `Triangle::GetEdge(k)`.
+using BoundaryEdgeMasks = std::vector<std::vector<uint8_t>>;
+
+// Returns the endpoints of the segment from `p` to `q` in lexicographic order,
+// so that the edges of adjacent triangles match regardless of their winding.
+std::pair<Point, Point> EdgeKey(Point p, Point q) {
+  if (q.x < p.x || (q.x == p.x && q.y < p.y)) std::swap(p, q);
+  return {p, q};
+}
+
+// Finds the edges of `mesh`'s triangles that are not shared with any other
+// triangle. Edges are matched by the positions of their endpoints, rather than
+// by vertex index, so that edges that were split between meshes still match.
+BoundaryEdgeMasks FindBoundaryEdges(const PartitionedMesh& mesh) {
+  absl::flat_hash_map<std::pair<Point, Point>, uint32_t> edge_counts;
+  for (const Mesh& m : mesh.Meshes()) {
+    for (uint32_t i = 0; i < m.TriangleCount(); ++i) {
+      Triangle triangle = m.GetTriangle(i);
+      for (int k = 0; k < 3; ++k) {
+        Segment edge = triangle.GetEdge(k);
+        ++edge_counts[EdgeKey(edge.start, edge.end)];
+      }
+    }
+  }
+  BoundaryEdgeMasks masks;
+  masks.reserve(mesh.Meshes().size());
+  for (const Mesh& m : mesh.Meshes()) {
+    std::vector<uint8_t>& mesh_masks = masks.emplace_back(m.TriangleCount());
+    for (uint32_t i = 0; i < m.TriangleCount(); ++i) {
+      Triangle triangle = m.GetTriangle(i);
+      for (int k = 0; k < 3; ++k) {
+        Segment edge = triangle.GetEdge(k);
+        if (edge_counts[EdgeKey(edge.start, edge.end)] == 1) {
+          mesh_masks[i] |= 1 << k;
+        }
+      }
+    }
+  }
+  return masks;
+}
+
+std::array<Point, 3> Corners(const Triangle& triangle) {
+  return {triangle.p0, triangle.p1, triangle.p2};
+}
+std::array<Point, 4> Corners(const Quad& quad) { return quad.Corners(); }
+
+// Returns true if any part of `segment` lies strictly inside the convex polygon
+// with the given `corners`, which may wind in either direction. This clips the
+// segment to the polygon, and then checks whether the middle of the clipped
+// part is strictly inside, so that a segment that only touches the polygon's
+// boundary doesn't count.
+template <size_t N>
+bool SegmentEntersConvexPolygon(const Segment& segment,
+                                const std::array<Point, N>& corners) {
+  float twice_signed_area = 0;
+  for (size_t i = 1; i + 1 < N; ++i) {
+    twice_signed_area +=
+        Vec::Determinant(corners[i] - corners[0], corners[i + 1] - corners[0]);
+  }
+  // A degenerate polygon has no interior.
+  if (twice_signed_area == 0) return false;
+  float orientation = twice_signed_area > 0 ? 1 : -1;
+
+  // The distances below are positive on the inner side of each edge, scaled by
+  // the length of the edge.
+  float t_min = 0;
+  float t_max = 1;
+  for (size_t i = 0; i < N; ++i) {
+    Vec edge = corners[(i + 1) % N] - corners[i];
+    float start_distance =
+        orientation * Vec::Determinant(edge, segment.start - corners[i]);
+    float end_distance =
+        orientation * Vec::Determinant(edge, segment.end - corners[i]);
+    if (start_distance < 0 && end_distance < 0) return false;
+    if (start_distance < 0) {
+      t_min = std::max(t_min, start_distance / (start_distance - end_distance));
+    } else if (end_distance < 0) {
+      t_max = std::min(t_max, start_distance / (start_distance - end_distance));
+    }
+  }
+  if (t_min >= t_max) return false;
+
+  Point middle = segment.Lerp((t_min + t_max) / 2);
+  for (size_t i = 0; i < N; ++i) {
+    Vec edge = corners[(i + 1) % N] - corners[i];
+    if (orientation * Vec::Determinant(edge, middle - corners[i]) <= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if the boundary of `mesh`, as given by `boundary_edges`, passes
+// through the interior of the convex `region`.
+template <typename ConvexType>
+bool BoundaryEntersRegion(const PartitionedMesh& mesh,
+                          const BoundaryEdgeMasks& boundary_edges,
+                          const ConvexType& region) {
+  auto corners = Corners(region);
+  bool enters = false;
+  mesh.VisitIntersectedTriangles(
+      region, [&](PartitionedMesh::TriangleIndexPair index) {
+        uint8_t mask = boundary_edges[index.mesh_index][index.triangle_index];
+        if (mask == 0) return PartitionedMesh::FlowControl::kContinue;
+        Triangle triangle =
+            mesh.Meshes()[index.mesh_index].GetTriangle(index.triangle_index);
+        for (int k = 0; k < 3; ++k) {
+          if ((mask & (1 << k)) != 0 &&
+              SegmentEntersConvexPolygon(triangle.GetEdge(k), corners)) {
+            enters = true;
+            return PartitionedMesh::FlowControl::kBreak;
+          }
+        }
+        return PartitionedMesh::FlowControl::kContinue;
+      });
+  return enters;
+}
+
+bool MeshContainsPoint(const PartitionedMesh& mesh, Point point) {
+  bool found_triangle = false;
+  mesh.VisitIntersectedTriangles(
+      point, [&found_triangle](PartitionedMesh::TriangleIndexPair) {
+        found_triangle = true;
+        return PartitionedMesh::FlowControl::kBreak;
+      });
+  return found_triangle;
+}
+
+// Returns true if `mesh` contains the convex `region`. Since the region is
+// connected, if the boundary of `mesh` does not pass through its interior, the
+// interior is either all inside `mesh` or all outside it, which is decided by
+// testing a single interior point.
+template <typename ConvexType>
+bool MeshContainsRegion(const PartitionedMesh& mesh,
+                        const BoundaryEdgeMasks& boundary_edges,
+                        const ConvexType& region) {
+  auto corners = Corners(region);
+  Point centroid = {0, 0};
+  for (Point corner : corners) {
+    centroid.x += corner.x / corners.size();
+    centroid.y += corner.y / corners.size();
+  }
+  return MeshContainsPoint(mesh, centroid) &&
+         !BoundaryEntersRegion(mesh, boundary_edges, region);
+}
+
+}  // namespace
+
+bool Contains(const Triangle& a, const PartitionedMesh& b,
+              const AffineTransform& b_to_a_transform) {
+  return ConvexContainsPartitionedMesh(a, b, b_to_a_transform);
+}
+
+bool Contains(const Rect& a, const PartitionedMesh& b,
+              const AffineTransform& b_to_a_transform) {
+  return ConvexContainsPartitionedMesh(a, b, b_to_a_transform);
+}
+
+bool Contains(const Quad& a, const PartitionedMesh& b,
+              const AffineTransform& b_to_a_transform) {
+  return ConvexContainsPartitionedMesh(a, b, b_to_a_transform);
+}
+
+bool Contains(const PartitionedMesh& a,
+              const AffineTransform& a_to_common_transform,
+              const PartitionedMesh& b,
+              const AffineTransform& b_to_common_transform) {
+  std::optional<Rect> b_bounds = b.Bounds().AsRect();
+  if (a.Meshes().empty() || !b_bounds.has_value()) return false;
+  std::optional<AffineTransform> common_to_a = a_to_common_transform.Inverse();
+  if (!common_to_a.has_value()) return false;
+  AffineTransform b_to_a = *common_to_a * b_to_common_transform;
+
+  // The outlines trace the edge of `b`, so they are where `b` is most likely
+  // to stick out of `a`; testing their vertices first rejects most strokes
+  // that cross the edge of a lasso after a few point queries.
+  for (uint32_t group = 0; group < b.RenderGroupCount(); ++group) {
+    absl::Span<const Mesh> meshes = b.RenderGroupMeshes(group);
+    for (uint32_t i = 0; i < b.OutlineCount(group); ++i) {
+      for (PartitionedMesh::VertexIndexPair vertex : b.Outline(group, i)) {
+        Point position =
+            meshes[vertex.mesh_index].VertexPosition(vertex.vertex_index);
+        if (!MeshContainsPoint(a, b_to_a.Apply(position))) return false;
+      }
+    }
+  }
+
+  BoundaryEdgeMasks boundary_edges = FindBoundaryEdges(a);
+  if (MeshContainsRegion(a, boundary_edges, b_to_a.Apply(*b_bounds))) {
+    return true;
+  }
+  for (const Mesh& mesh : b.Meshes()) {
+    for (uint32_t i = 0; i < mesh.TriangleCount(); ++i) {
+      if (!MeshContainsRegion(a, boundary_edges,
+                              b_to_a.Apply(mesh.GetTriangle(i)))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace ink
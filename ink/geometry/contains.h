@@ -0,0 +1,71 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_GEOMETRY_CONTAINS_H_
+#define INK_GEOMETRY_CONTAINS_H_
+
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink {
+
+// These functions return true if `b` lies entirely within `a`, i.e. if every
+// point of every triangle of `b` is also contained in `a`; points on the
+// boundary of `a` are considered to be contained. They answer the same
+// question as `a.CoverageIsGreaterThan(b, threshold)` with a threshold just
+// below 1, but stop at the first part of `b` found outside `a`, without
+// computing any areas, so they are much cheaper for e.g. selecting the strokes
+// that lie fully inside a lasso.
+//
+// As with `Intersects`, the transform maps from the `PartitionedMesh`'s
+// coordinate space to the coordinate space that containment should be checked
+// in. An empty `PartitionedMesh` is not contained in anything.
+//
+// Since `Triangle`, `Rect` and `Quad` are convex, `b` is inside them exactly
+// when all of its vertices are, and so these overloads never need to test
+// `b`'s triangles; if `b`'s bounds lie inside `a`, its vertices aren't tested
+// either.
+bool Contains(const Triangle& a, const PartitionedMesh& b,
+              const AffineTransform& b_to_a_transform);
+bool Contains(const Rect& a, const PartitionedMesh& b,
+              const AffineTransform& b_to_a_transform);
+bool Contains(const Quad& a, const PartitionedMesh& b,
+              const AffineTransform& b_to_a_transform);
+
+// Returns true if `b` lies entirely within the union of `a`'s triangles. Both
+// are mapped to a common coordinate space by the given transforms; if
+// `a_to_common_transform` is not invertible, `a` has no area, and this returns
+// false.
+//
+// The vertices of `b`'s outlines, which are the ones most likely to lie outside
+// `a`, are tested first. After that, `b` is inside `a` if each of its triangles
+// has a vertex inside `a`, and is not entered by `a`'s boundary, which is made
+// of the edges that are not shared by two of `a`'s triangles. This is exact for
+// meshes like a tessellated lasso polygon, whose triangles meet edge to edge.
+// Where triangles of `a` overlap without sharing edges, their edges count as
+// boundary, so `b` may be reported as not contained even though it is.
+//
+// Finding `a`'s boundary visits all of its triangles, so this is meant for
+// a small `a`, like a lasso, and a `b` of any size.
+bool Contains(const PartitionedMesh& a,
+              const AffineTransform& a_to_common_transform,
+              const PartitionedMesh& b,
+              const AffineTransform& b_to_common_transform);
+
+}  // namespace ink
+
+#endif  // INK_GEOMETRY_CONTAINS_H_
@@ -0,0 +1,166 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/contains.h"
+
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink {
+namespace {
+
+PartitionedMesh MakeSingleTrianglePartitionedMesh(const Triangle& triangle) {
+  MutableMesh mesh;
+  mesh.AppendVertex(triangle.p0);
+  mesh.AppendVertex(triangle.p1);
+  mesh.AppendVertex(triangle.p2);
+  mesh.AppendTriangleIndices({0, 1, 2});
+  absl::StatusOr<PartitionedMesh> partitioned_mesh =
+      PartitionedMesh::FromMutableMesh(mesh);
+  ABSL_CHECK_OK(partitioned_mesh);
+  return *partitioned_mesh;
+}
+
+TEST(ContainsTest, TriangleContainsPartitionedMesh) {
+  // The mesh spans (0, -1) to (5, 0).
+  PartitionedMesh mesh = MakeStraightLinePartitionedMesh(4);
+
+  EXPECT_TRUE(Contains(Triangle{{-1, 1}, {-1, -10}, {12, 1}}, mesh, {}));
+  EXPECT_TRUE(Contains(Triangle{{9, 1}, {9, -10}, {22, 1}}, mesh,
+                       AffineTransform::Translate({10, 0})));
+
+  EXPECT_FALSE(Contains(Triangle{{-1, 1}, {-1, -10}, {5, 1}}, mesh, {}));
+  EXPECT_FALSE(Contains(Triangle{{9, 1}, {9, -10}, {22, 1}}, mesh, {}));
+}
+
+TEST(ContainsTest, RectContainsPartitionedMesh) {
+  // The mesh spans (0, -1) to (5, 0).
+  PartitionedMesh mesh = MakeStraightLinePartitionedMesh(4);
+
+  EXPECT_TRUE(Contains(Rect::FromTwoPoints({0, -1}, {5, 0}), mesh, {}));
+  EXPECT_TRUE(Contains(Rect::FromTwoPoints({0, -2}, {10, 0}), mesh,
+                       AffineTransform::Scale(2)));
+  EXPECT_TRUE(Contains(Rect::FromTwoPoints({-0.1, -0.1}, {1.1, 5.1}), mesh,
+                       AffineTransform::Rotate(Angle::Degrees(90))));
+
+  EXPECT_FALSE(Contains(Rect::FromTwoPoints({0, -1}, {4.9, 0}), mesh, {}));
+  EXPECT_FALSE(Contains(Rect::FromTwoPoints({0, -1}, {5, 0}), mesh,
+                        AffineTransform::Scale(2)));
+}
+
+TEST(ContainsTest, QuadContainsPartitionedMesh) {
+  // The mesh spans (0, -1) to (5, 0).
+  PartitionedMesh mesh = MakeStraightLinePartitionedMesh(4);
+
+  EXPECT_TRUE(Contains(Quad::FromCenterDimensionsAndRotation(
+                           {2.5, -0.5}, 7, 2, Angle::Degrees(10)),
+                       mesh, {}));
+
+  EXPECT_FALSE(Contains(Quad::FromCenterDimensionsAndRotation(
+                            {2.5, -0.5}, 7, 2, Angle::Degrees(45)),
+                        mesh, {}));
+}
+
+TEST(ContainsTest, ConvexContainsPartitionedMeshButNotItsBounds) {
+  Triangle triangle = {{0, 0}, {1, -1}, {2, 0}};
+  PartitionedMesh mesh = MakeSingleTrianglePartitionedMesh(triangle);
+
+  EXPECT_TRUE(Contains(triangle, mesh, {}));
+  EXPECT_TRUE(
+      Contains(Triangle{{-0.1, 0.05}, {1, -1.1}, {2.1, 0.05}}, mesh, {}));
+}
+
+TEST(ContainsTest, EmptyPartitionedMeshIsNotContained) {
+  PartitionedMesh empty;
+  PartitionedMesh mesh = MakeStraightLinePartitionedMesh(4);
+
+  EXPECT_FALSE(Contains(Triangle{{-1, 1}, {-1, -10}, {12, 1}}, empty, {}));
+  EXPECT_FALSE(Contains(Rect::FromTwoPoints({-10, -10}, {10, 10}), empty, {}));
+  EXPECT_FALSE(Contains(Quad::FromCenterAndDimensions({0, 0}, 20, 20), empty,
+                        {}));
+  EXPECT_FALSE(Contains(mesh, {}, empty, {}));
+  EXPECT_FALSE(Contains(empty, {}, mesh, {}));
+}
+
+TEST(ContainsTest, PartitionedMeshContainsPartitionedMesh) {
+  // The ring's band lies between radii of about 0.74 and 0.98.
+  PartitionedMesh ring = MakeCoiledRingPartitionedMesh(32, 16);
+
+  EXPECT_TRUE(Contains(ring, {},
+                       MakeSingleTrianglePartitionedMesh(
+                           {{-0.05, 0.85}, {0.05, 0.85}, {0, 0.9}}),
+                       {}));
+  // The vertices of this triangle lie in the ring's band, but its bottom edge
+  // cuts across the ring's hole.
+  EXPECT_FALSE(Contains(ring, {},
+                        MakeSingleTrianglePartitionedMesh(
+                            {{0.608, 0.608}, {-0.608, 0.608}, {0, 0.86}}),
+                        {}));
+  // This triangle surrounds the hole.
+  EXPECT_FALSE(
+      Contains(ring, {},
+               MakeSingleTrianglePartitionedMesh({{-2, -1}, {2, -1}, {0, 2}}),
+               {}));
+  EXPECT_FALSE(Contains(ring, {},
+                        MakeSingleTrianglePartitionedMesh(
+                            {{-0.05, 0.95}, {0.05, 0.95}, {0, 1.05}}),
+                        {}));
+}
+
+TEST(ContainsTest, PartitionedMeshContainsPartitionedMeshWithOutlines) {
+  // The mesh covers (1, -1) to (10, 0), and a bit more at either end.
+  PartitionedMesh lasso = MakeStraightLinePartitionedMesh(10);
+  MutableMesh stroke = MakeStraightLineMutableMesh(
+      8, MakeSinglePackedPositionFormat(), AffineTransform::Scale(0.5));
+  absl::StatusOr<PartitionedMesh> stroke_mesh =
+      PartitionedMesh::FromMutableMesh(stroke, {{1, 5, 4, 0}, {5, 9, 8, 4}});
+  ASSERT_EQ(stroke_mesh.status(), absl::OkStatus());
+
+  EXPECT_TRUE(Contains(lasso, {}, *stroke_mesh,
+                       AffineTransform::Translate({2, -0.25})));
+  EXPECT_FALSE(Contains(lasso, {}, *stroke_mesh,
+                        AffineTransform::Translate({7, -0.25})));
+  EXPECT_FALSE(Contains(lasso, {}, *stroke_mesh,
+                        AffineTransform::Translate({2, 0.25})));
+}
+
+TEST(ContainsTest, PartitionedMeshContainsPartitionedMeshWithTransforms) {
+  PartitionedMesh ring = MakeCoiledRingPartitionedMesh(32, 16);
+  PartitionedMesh triangle = MakeSingleTrianglePartitionedMesh(
+      {{-0.05, 0.85}, {0.05, 0.85}, {0, 0.9}});
+
+  EXPECT_TRUE(Contains(ring, AffineTransform::Scale(2), triangle,
+                       AffineTransform::Scale(2)));
+  EXPECT_TRUE(Contains(ring, AffineTransform::Translate({5, 5}), triangle,
+                       AffineTransform::Translate({5, 5})));
+  EXPECT_FALSE(
+      Contains(ring, AffineTransform::Scale(2), triangle, AffineTransform()));
+  // `ring` collapses to a segment, so it contains nothing.
+  EXPECT_FALSE(Contains(ring, AffineTransform::ScaleY(0), triangle,
+                        AffineTransform::ScaleY(0)));
+}
+
+}  // namespace
+}  // namespace ink
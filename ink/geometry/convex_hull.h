@@ -29,6 +29,16 @@ inline std::vector<Point> ConvexHull(absl::Span<const Point> points) {
       geometry_internal::PointTessellationHelper>(points);
 }
 
+// Like above, but replaces the contents of `hull` with the result, reusing its
+// storage. Temporary buffers are reused across calls on the same thread, so
+// that, e.g., running shape recognition on each update of a gesture does no
+// heap allocation once `hull` has grown to size.
+inline void ConvexHull(absl::Span<const Point> points,
+                       std::vector<Point>& hull) {
+  ink::geometry_internal::ConvexHull<
+      geometry_internal::PointTessellationHelper>(points, hull);
+}
+
 }  // namespace ink
 
 #endif  // INK_GEOMETRY_CONVEX_HULL_H_
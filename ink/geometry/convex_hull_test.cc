@@ -14,6 +14,9 @@
 
 #include "ink/geometry/convex_hull.h"
 
+#include <cstdlib>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "ink/geometry/point.h"
@@ -85,5 +88,45 @@ TEST(ConvexHullTest, PreservesAllPointsOnConvexHull) {
                         Point{-3, 0}, Point{-3, -1}}));
 }
 
+TEST(ConvexHullTest, PreservesExtremaOfLargeInput) {
+  // Large inputs are pruned before computing the hull; the extreme points used
+  // for pruning must still be kept.
+  std::vector<Point> points;
+  for (int x = -15; x <= 15; ++x) {
+    for (int y = -15; y <= 15; ++y) {
+      if (std::abs(x) + std::abs(y) < 20) {
+        points.push_back({static_cast<float>(x), static_cast<float>(y)});
+      }
+    }
+  }
+  points.push_back({0, -20});
+  points.push_back({20, 0});
+  points.push_back({0, 20});
+  points.push_back({-20, 0});
+  ASSERT_GT(points.size(), 500);
+  EXPECT_THAT(ConvexHull(points),
+              ElementsAreArray({Point{0, -20}, Point{20, 0}, Point{0, 20},
+                                Point{-20, 0}}));
+}
+
+TEST(ConvexHullTest, OutputParameterReplacesContents) {
+  std::vector<Point> large_input;
+  for (int x = -15; x <= 15; ++x) {
+    for (int y = -15; y <= 15; ++y) {
+      large_input.push_back({static_cast<float>(x), static_cast<float>(y)});
+    }
+  }
+  std::vector<Point> small_input = {{1, 0}, {-2, -2}, {-3, -1},
+                                    {0, -2}, {-1, 1}, {-3, 0}};
+
+  std::vector<Point> hull = {{100, 100}};
+  ConvexHull(large_input, hull);
+  EXPECT_THAT(hull, ElementsAreArray(ConvexHull(large_input)));
+  ConvexHull(small_input, hull);
+  EXPECT_THAT(hull, ElementsAreArray(ConvexHull(small_input)));
+  ConvexHull({}, hull);
+  EXPECT_THAT(hull, IsEmpty());
+}
+
 }  // namespace
 }  // namespace ink
@@ -15,8 +15,14 @@
 #include "ink/geometry/distance.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/intersects.h"
+#include "ink/geometry/partitioned_mesh.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/quad.h"
 #include "ink/geometry/rect.h"
@@ -288,4 +294,95 @@ float Distance(const Quad& a, const Quad& b) {
                    Distance(a.GetEdge(2), b), Distance(a.GetEdge(3), b)});
 }
 
+namespace {
+
+// This is a helper function for `FindNearestTriangles` and the
+// `PartitionedMesh` overloads of `Distance`, which does a branch-and-bound
+// search over `mesh`'s index: the distance to each branch's transformed bounds
+// is a lower bound on the distance to any triangle in it, so the search stops
+// once that bound can't beat the results found so far.
+template <typename QueryType>
+std::vector<TriangleDistance> FindNearestTrianglesImpl(
+    const QueryType& query, const PartitionedMesh& mesh,
+    const AffineTransform& mesh_to_query_transform, size_t max_count,
+    float max_distance) {
+  // This is kept sorted by distance, nearest first.
+  std::vector<TriangleDistance> nearest;
+  if (max_count == 0) return nearest;
+
+  mesh.VisitTrianglesInBoundsDistanceOrder(
+      [&query, &mesh_to_query_transform](const Rect& bounds) {
+        // This is a `Quad`, since a transformed `Rect` is not in general a
+        // `Rect`.
+        return Distance(query, mesh_to_query_transform.Apply(bounds));
+      },
+      [&query, &mesh, &mesh_to_query_transform, max_count, max_distance,
+       &nearest](PartitionedMesh::TriangleIndexPair index,
+                 float lower_bound) {
+        bool is_full = nearest.size() == max_count;
+        // Once we have `max_count` results, a triangle must be strictly
+        // nearer than the farthest of them to replace it.
+        if (is_full ? lower_bound >= nearest.back().distance
+                    : lower_bound > max_distance) {
+          return PartitionedMesh::FlowControl::kBreak;
+        }
+        float distance = Distance(
+            query, mesh_to_query_transform.Apply(
+                       mesh.Meshes()[index.mesh_index].GetTriangle(
+                           index.triangle_index)));
+        if (is_full ? distance >= nearest.back().distance
+                    : distance > max_distance) {
+          return PartitionedMesh::FlowControl::kContinue;
+        }
+        if (is_full) nearest.pop_back();
+        nearest.insert(
+            absl::c_upper_bound(nearest, distance,
+                                [](float d, const TriangleDistance& result) {
+                                  return d < result.distance;
+                                }),
+            {.triangle = index, .distance = distance});
+        return PartitionedMesh::FlowControl::kContinue;
+      });
+  return nearest;
+}
+
+template <typename QueryType>
+float DistanceToPartitionedMesh(
+    const QueryType& query, const PartitionedMesh& mesh,
+    const AffineTransform& mesh_to_query_transform) {
+  std::vector<TriangleDistance> nearest =
+      FindNearestTrianglesImpl(query, mesh, mesh_to_query_transform, 1,
+                               std::numeric_limits<float>::infinity());
+  if (nearest.empty()) return std::numeric_limits<float>::infinity();
+  return nearest.front().distance;
+}
+
+}  // namespace
+
+float Distance(Point query, const PartitionedMesh& mesh,
+               const AffineTransform& mesh_to_query_transform) {
+  return DistanceToPartitionedMesh(query, mesh, mesh_to_query_transform);
+}
+
+float Distance(const Segment& query, const PartitionedMesh& mesh,
+               const AffineTransform& mesh_to_query_transform) {
+  return DistanceToPartitionedMesh(query, mesh, mesh_to_query_transform);
+}
+
+std::vector<TriangleDistance> FindNearestTriangles(
+    Point query, const PartitionedMesh& mesh,
+    const AffineTransform& mesh_to_query_transform, size_t max_count,
+    float max_distance) {
+  return FindNearestTrianglesImpl(query, mesh, mesh_to_query_transform,
+                                  max_count, max_distance);
+}
+
+std::vector<TriangleDistance> FindNearestTriangles(
+    const Segment& query, const PartitionedMesh& mesh,
+    const AffineTransform& mesh_to_query_transform, size_t max_count,
+    float max_distance) {
+  return FindNearestTrianglesImpl(query, mesh, mesh_to_query_transform,
+                                  max_count, max_distance);
+}
+
 }  // namespace ink
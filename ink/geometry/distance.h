@@ -16,9 +16,14 @@
 #define INK_GEOMETRY_DISTANCE_H_
 
 #include <algorithm>
+#include <cstddef>
+#include <limits>
 #include <optional>
+#include <vector>
 
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/intersects.h"
+#include "ink/geometry/partitioned_mesh.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/quad.h"
 #include "ink/geometry/rect.h"
@@ -63,6 +68,44 @@ float Distance(const Quad& quad, const Triangle& triangle);
 float Distance(const Quad& quad, const Rect& rect);
 float Distance(const Quad& a, const Quad& b);
 
+// These functions return the minimum distance between `query` and the
+// triangles of `mesh`, measured in `query`'s coordinate space;
+// `mesh_to_query_transform` maps from the `PartitionedMesh`'s coordinate space
+// to `query`'s. They return infinity if `mesh` has no triangles.
+//
+// These use the mesh's spatial index to find the nearest triangles without
+// testing the others, and will initialize the index if it has not already been
+// done.
+float Distance(Point query, const PartitionedMesh& mesh,
+               const AffineTransform& mesh_to_query_transform);
+float Distance(const Segment& query, const PartitionedMesh& mesh,
+               const AffineTransform& mesh_to_query_transform);
+float Distance(const PartitionedMesh& mesh,
+               const AffineTransform& mesh_to_query_transform, Point query);
+float Distance(const PartitionedMesh& mesh,
+               const AffineTransform& mesh_to_query_transform,
+               const Segment& query);
+
+// A triangle of a `PartitionedMesh` and its distance from a query, as returned
+// by `FindNearestTriangles`.
+struct TriangleDistance {
+  PartitionedMesh::TriangleIndexPair triangle;
+  float distance;
+};
+
+// Returns the (up to) `max_count` triangles of `mesh` that are nearest to
+// `query` and no farther than `max_distance` from it, nearest first. Distances
+// are measured as for `Distance` above. Triangles at equal distances are
+// returned in arbitrary order.
+std::vector<TriangleDistance> FindNearestTriangles(
+    Point query, const PartitionedMesh& mesh,
+    const AffineTransform& mesh_to_query_transform, size_t max_count,
+    float max_distance = std::numeric_limits<float>::infinity());
+std::vector<TriangleDistance> FindNearestTriangles(
+    const Segment& query, const PartitionedMesh& mesh,
+    const AffineTransform& mesh_to_query_transform, size_t max_count,
+    float max_distance = std::numeric_limits<float>::infinity());
+
 ////////////////////////////////////////////////////////////////////////////////
 // Inline function definitions
 ////////////////////////////////////////////////////////////////////////////////
@@ -141,6 +184,16 @@ inline float Distance(const Quad& quad, const Triangle& triangle) {
 inline float Distance(const Quad& quad, const Rect& rect) {
   return Distance(rect, quad);
 }
+inline float Distance(const PartitionedMesh& mesh,
+                      const AffineTransform& mesh_to_query_transform,
+                      Point query) {
+  return Distance(query, mesh, mesh_to_query_transform);
+}
+inline float Distance(const PartitionedMesh& mesh,
+                      const AffineTransform& mesh_to_query_transform,
+                      const Segment& query) {
+  return Distance(query, mesh, mesh_to_query_transform);
+}
 
 }  // namespace ink
 
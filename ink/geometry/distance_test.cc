@@ -15,9 +15,19 @@
 #include "ink/geometry/distance.h"
 
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/angle.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/partitioned_mesh.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/quad.h"
 #include "ink/geometry/rect.h"
@@ -27,6 +37,11 @@
 namespace ink {
 namespace {
 
+using ::testing::FloatEq;
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::Pointwise;
+
 TEST(DistanceTest, PointToPoint) {
   // Distance in the positive and negative x and y directions
   EXPECT_FLOAT_EQ(Distance(Point{1.0f, 1.0f}, Point{5.0f, 1.0f}), 4.0f);
@@ -1416,5 +1431,116 @@ TEST(DistanceTest,
       0.0f);
 }
 
+// Returns the distances from `query` to every triangle of `mesh`, in
+// increasing order.
+template <typename QueryType>
+std::vector<float> AllTriangleDistances(
+    const QueryType& query, const PartitionedMesh& mesh,
+    const AffineTransform& mesh_to_query_transform) {
+  std::vector<float> distances;
+  for (const Mesh& m : mesh.Meshes()) {
+    for (uint32_t i = 0; i < m.TriangleCount(); ++i) {
+      distances.push_back(
+          Distance(query, mesh_to_query_transform.Apply(m.GetTriangle(i))));
+    }
+  }
+  absl::c_sort(distances);
+  return distances;
+}
+
+std::vector<float> GetDistances(absl::Span<const TriangleDistance> results) {
+  std::vector<float> distances;
+  for (const TriangleDistance& result : results) {
+    distances.push_back(result.distance);
+  }
+  return distances;
+}
+
+TEST(DistanceTest, PointToPartitionedMesh) {
+  PartitionedMesh mesh = MakeCoiledRingPartitionedMesh(300, 12);
+  AffineTransform mesh_to_query =
+      AffineTransform::Translate({5, -2}) *
+      AffineTransform::Rotate(kQuarterTurn / 3) * AffineTransform::Scale(3, 2);
+
+  for (Point query : {Point{5, -2}, Point{8, -1}, Point{20, 30}}) {
+    float expected = AllTriangleDistances(query, mesh, mesh_to_query).front();
+    EXPECT_FLOAT_EQ(Distance(query, mesh, mesh_to_query), expected);
+    EXPECT_FLOAT_EQ(Distance(mesh, mesh_to_query, query), expected);
+  }
+}
+
+TEST(DistanceTest, PointInsidePartitionedMeshReturnsZero) {
+  PartitionedMesh mesh = MakeStraightLinePartitionedMesh(10);
+
+  EXPECT_EQ(Distance(Point{1, -0.5}, mesh, AffineTransform()), 0);
+}
+
+TEST(DistanceTest, SegmentToPartitionedMesh) {
+  PartitionedMesh mesh = MakeCoiledRingPartitionedMesh(300, 12);
+  AffineTransform mesh_to_query = AffineTransform::Scale(4);
+
+  for (Segment query : {Segment{{-10, 10}, {10, 10}},
+                        Segment{{-1, -1}, {1, 1}}, Segment{{7, 0}, {9, 0}}}) {
+    float expected = AllTriangleDistances(query, mesh, mesh_to_query).front();
+    EXPECT_FLOAT_EQ(Distance(query, mesh, mesh_to_query), expected);
+    EXPECT_FLOAT_EQ(Distance(mesh, mesh_to_query, query), expected);
+  }
+}
+
+TEST(DistanceTest, DistanceToEmptyPartitionedMeshIsInfinite) {
+  EXPECT_EQ(Distance(Point{0, 0}, PartitionedMesh(), AffineTransform()),
+            std::numeric_limits<float>::infinity());
+  EXPECT_EQ(
+      Distance(Segment{{0, 0}, {1, 1}}, PartitionedMesh(), AffineTransform()),
+      std::numeric_limits<float>::infinity());
+}
+
+TEST(DistanceTest, FindNearestTriangles) {
+  PartitionedMesh mesh = MakeCoiledRingPartitionedMesh(300, 12);
+  AffineTransform mesh_to_query = AffineTransform::Scale(10);
+  Point point_query = {15, 3};
+  Segment segment_query = {{-20, -20}, {-5, -30}};
+
+  std::vector<float> point_distances =
+      AllTriangleDistances(point_query, mesh, mesh_to_query);
+  EXPECT_THAT(GetDistances(FindNearestTriangles(point_query, mesh,
+                                                mesh_to_query, 5)),
+              Pointwise(FloatEq(),
+                                   absl::MakeConstSpan(point_distances)
+                                       .first(5)));
+
+  std::vector<float> segment_distances =
+      AllTriangleDistances(segment_query, mesh, mesh_to_query);
+  EXPECT_THAT(GetDistances(FindNearestTriangles(segment_query, mesh,
+                                                mesh_to_query, 8)),
+              Pointwise(FloatEq(),
+                                   absl::MakeConstSpan(segment_distances)
+                                       .first(8)));
+}
+
+TEST(DistanceTest, FindNearestTrianglesRespectsMaxDistance) {
+  PartitionedMesh mesh = MakeStraightLinePartitionedMesh(10);
+  Point query = {5, 3};
+
+  // The nearest triangles touch the top edge of the mesh, 3 units below the
+  // query, so none are within 2.
+  EXPECT_THAT(FindNearestTriangles(query, mesh, AffineTransform(), 5, 2),
+              IsEmpty());
+  std::vector<TriangleDistance> nearest =
+      FindNearestTriangles(query, mesh, AffineTransform(), 100, 3.5);
+  EXPECT_THAT(nearest, Not(IsEmpty()));
+  for (const TriangleDistance& result : nearest) {
+    EXPECT_LE(result.distance, 3.5);
+  }
+  EXPECT_LT(nearest.size(), mesh.Meshes()[0].TriangleCount());
+}
+
+TEST(DistanceTest, FindNearestTrianglesWithZeroCount) {
+  PartitionedMesh mesh = MakeStraightLinePartitionedMesh(10);
+
+  EXPECT_THAT(FindNearestTriangles(Point{0, 0}, mesh, AffineTransform(), 0),
+              IsEmpty());
+}
+
 }  // namespace
 }  // namespace ink
@@ -122,6 +122,10 @@ fuzztest::Domain<MeshFormat::AttributeType> ArbitraryMeshAttributeType() {
       MeshFormat::AttributeType::kFloat4PackedInOneFloat,
       MeshFormat::AttributeType::kFloat4PackedInTwoFloats,
       MeshFormat::AttributeType::kFloat4PackedInThreeFloats,
+      MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts,
+      MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts,
+      MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats,
+      MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats,
   });
 }
 fuzztest::Domain<MeshFormat::AttributeType> PositionMeshAttributeType() {
@@ -0,0 +1,295 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/distance.h"
+#include "ink/geometry/intersects.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink {
+namespace {
+
+// The number of pseudo-random pairs that each primitive benchmark cycles
+// through, so that branch prediction doesn't learn a single fixed answer.
+constexpr int kNumPrimitivePairs = 1024;
+
+// Generates pseudo-random primitives of each type, centered in the square from
+// (-10, -10) to (10, 10) and with sizes of up to 5, so that about half of all
+// pairs intersect.
+class PrimitiveGenerator {
+ public:
+  explicit PrimitiveGenerator(uint64_t seed) : rng_(seed) {}
+
+  template <typename T>
+  T Make();
+
+ private:
+  float Between(float a, float b) {
+    return std::uniform_real_distribution<float>(a, b)(rng_);
+  }
+  Point MakePointNear(Point p) {
+    return {p.x + Between(-2.5, 2.5), p.y + Between(-2.5, 2.5)};
+  }
+
+  std::mt19937_64 rng_;
+};
+
+template <>
+Point PrimitiveGenerator::Make<Point>() {
+  return {Between(-10, 10), Between(-10, 10)};
+}
+
+template <>
+Segment PrimitiveGenerator::Make<Segment>() {
+  Point center = Make<Point>();
+  return {MakePointNear(center), MakePointNear(center)};
+}
+
+template <>
+Triangle PrimitiveGenerator::Make<Triangle>() {
+  Point center = Make<Point>();
+  return {MakePointNear(center), MakePointNear(center), MakePointNear(center)};
+}
+
+template <>
+Rect PrimitiveGenerator::Make<Rect>() {
+  return Rect::FromCenterAndDimensions(Make<Point>(), Between(0.5, 5),
+                                       Between(0.5, 5));
+}
+
+template <>
+Quad PrimitiveGenerator::Make<Quad>() {
+  return Quad::FromCenterDimensionsRotationAndSkew(
+      Make<Point>(), Between(0.5, 5), Between(0.5, 5),
+      Angle::Radians(Between(0, 6.28)), Between(-1, 1));
+}
+
+template <typename A, typename B>
+struct PrimitivePairs {
+  std::vector<A> a;
+  std::vector<B> b;
+};
+
+template <typename A, typename B>
+PrimitivePairs<A, B> MakePrimitivePairs() {
+  PrimitiveGenerator generator(0);
+  PrimitivePairs<A, B> pairs;
+  for (int i = 0; i < kNumPrimitivePairs; ++i) {
+    pairs.a.push_back(generator.Make<A>());
+    pairs.b.push_back(generator.Make<B>());
+  }
+  return pairs;
+}
+
+template <typename A, typename B>
+void BM_IntersectsPrimitives(benchmark::State& state) {
+  PrimitivePairs<A, B> pairs = MakePrimitivePairs<A, B>();
+  int i = 0;
+  for (auto s : state) {
+    benchmark::DoNotOptimize(Intersects(pairs.a[i], pairs.b[i]));
+    i = (i + 1) % kNumPrimitivePairs;
+  }
+}
+
+template <typename A, typename B>
+void BM_DistancePrimitives(benchmark::State& state) {
+  PrimitivePairs<A, B> pairs = MakePrimitivePairs<A, B>();
+  int i = 0;
+  for (auto s : state) {
+    benchmark::DoNotOptimize(Distance(pairs.a[i], pairs.b[i]));
+    i = (i + 1) % kNumPrimitivePairs;
+  }
+}
+
+// Both of these operations are symmetric, so only one order of each pair of
+// types is benchmarked.
+#define INK_BENCHMARK_PRIMITIVE_PAIR(A, B)          \
+  BENCHMARK_TEMPLATE(BM_IntersectsPrimitives, A, B); \
+  BENCHMARK_TEMPLATE(BM_DistancePrimitives, A, B)
+
+INK_BENCHMARK_PRIMITIVE_PAIR(Point, Point);
+INK_BENCHMARK_PRIMITIVE_PAIR(Point, Segment);
+INK_BENCHMARK_PRIMITIVE_PAIR(Point, Triangle);
+INK_BENCHMARK_PRIMITIVE_PAIR(Point, Rect);
+INK_BENCHMARK_PRIMITIVE_PAIR(Point, Quad);
+INK_BENCHMARK_PRIMITIVE_PAIR(Segment, Segment);
+INK_BENCHMARK_PRIMITIVE_PAIR(Segment, Triangle);
+INK_BENCHMARK_PRIMITIVE_PAIR(Segment, Rect);
+INK_BENCHMARK_PRIMITIVE_PAIR(Segment, Quad);
+INK_BENCHMARK_PRIMITIVE_PAIR(Triangle, Triangle);
+INK_BENCHMARK_PRIMITIVE_PAIR(Triangle, Rect);
+INK_BENCHMARK_PRIMITIVE_PAIR(Triangle, Quad);
+INK_BENCHMARK_PRIMITIVE_PAIR(Rect, Rect);
+INK_BENCHMARK_PRIMITIVE_PAIR(Rect, Quad);
+INK_BENCHMARK_PRIMITIVE_PAIR(Quad, Quad);
+
+#undef INK_BENCHMARK_PRIMITIVE_PAIR
+
+// The mesh benchmarks below use a stroke-like mesh: a thin ring of radius 100
+// that winds around twice, overlapping itself, with `state.range(0)`
+// triangles.
+PartitionedMesh MakeStrokeLikeMesh(int64_t n_triangles) {
+  return MakeCoiledRingPartitionedMesh(
+      n_triangles, std::max<uint32_t>(n_triangles / 4, 3), MeshFormat(),
+      AffineTransform::Scale(100));
+}
+
+#define INK_MESH_SIZES RangeMultiplier(10)->Range(100, 100000)
+
+// Generates `kNumPrimitivePairs` queries of type `T` scattered across the
+// bounds of the stroke-like mesh, so that some hit it and some don't.
+template <typename T>
+std::vector<T> MakeMeshQueries() {
+  PrimitiveGenerator generator(1);
+  std::vector<T> queries;
+  AffineTransform to_mesh_space = AffineTransform::Scale(11);
+  for (int i = 0; i < kNumPrimitivePairs; ++i) {
+    queries.push_back(generator.Make<T>());
+  }
+  if constexpr (std::is_same_v<T, Rect>) {
+    for (Rect& query : queries) {
+      query = Rect::FromCenterAndDimensions(to_mesh_space.Apply(query.Center()),
+                                            11 * query.Width(),
+                                            11 * query.Height());
+    }
+  } else {
+    for (T& query : queries) query = to_mesh_space.Apply(query);
+  }
+  return queries;
+}
+
+template <typename T>
+void BM_IntersectsMesh(benchmark::State& state) {
+  PartitionedMesh mesh = MakeStrokeLikeMesh(state.range(0));
+  mesh.InitializeSpatialIndex();
+  std::vector<T> queries = MakeMeshQueries<T>();
+  int i = 0;
+  for (auto s : state) {
+    benchmark::DoNotOptimize(Intersects(queries[i], mesh, {}));
+    i = (i + 1) % kNumPrimitivePairs;
+  }
+}
+BENCHMARK_TEMPLATE(BM_IntersectsMesh, Point)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_IntersectsMesh, Segment)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_IntersectsMesh, Triangle)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_IntersectsMesh, Rect)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_IntersectsMesh, Quad)->INK_MESH_SIZES;
+
+// As above, but with a rotated query transform, which doesn't keep `Rect`
+// queries axis-aligned.
+template <typename T>
+void BM_IntersectsMeshWithRotatedTransform(benchmark::State& state) {
+  PartitionedMesh mesh = MakeStrokeLikeMesh(state.range(0));
+  mesh.InitializeSpatialIndex();
+  std::vector<T> queries = MakeMeshQueries<T>();
+  AffineTransform transform = AffineTransform::Rotate(Angle::Degrees(30));
+  int i = 0;
+  for (auto s : state) {
+    benchmark::DoNotOptimize(Intersects(queries[i], mesh, transform));
+    i = (i + 1) % kNumPrimitivePairs;
+  }
+}
+BENCHMARK_TEMPLATE(BM_IntersectsMeshWithRotatedTransform, Rect)
+    ->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_IntersectsMeshWithRotatedTransform, Quad)
+    ->INK_MESH_SIZES;
+
+template <typename T>
+void BM_DistanceToMesh(benchmark::State& state) {
+  PartitionedMesh mesh = MakeStrokeLikeMesh(state.range(0));
+  mesh.InitializeSpatialIndex();
+  std::vector<T> queries = MakeMeshQueries<T>();
+  int i = 0;
+  for (auto s : state) {
+    benchmark::DoNotOptimize(Distance(queries[i], mesh, {}));
+    i = (i + 1) % kNumPrimitivePairs;
+  }
+}
+BENCHMARK_TEMPLATE(BM_DistanceToMesh, Point)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_DistanceToMesh, Segment)->INK_MESH_SIZES;
+
+template <typename T>
+void BM_CoverageOfMesh(benchmark::State& state) {
+  PartitionedMesh mesh = MakeStrokeLikeMesh(state.range(0));
+  mesh.InitializeSpatialIndex();
+  std::vector<T> queries = MakeMeshQueries<T>();
+  int i = 0;
+  for (auto s : state) {
+    benchmark::DoNotOptimize(mesh.Coverage(queries[i]));
+    i = (i + 1) % kNumPrimitivePairs;
+  }
+}
+BENCHMARK_TEMPLATE(BM_CoverageOfMesh, Triangle)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_CoverageOfMesh, Rect)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_CoverageOfMesh, Quad)->INK_MESH_SIZES;
+
+template <typename T>
+void BM_CoverageOfMeshIsGreaterThan(benchmark::State& state) {
+  PartitionedMesh mesh = MakeStrokeLikeMesh(state.range(0));
+  mesh.InitializeSpatialIndex();
+  std::vector<T> queries = MakeMeshQueries<T>();
+  int i = 0;
+  for (auto s : state) {
+    benchmark::DoNotOptimize(mesh.CoverageIsGreaterThan(queries[i], 0.01));
+    i = (i + 1) % kNumPrimitivePairs;
+  }
+}
+BENCHMARK_TEMPLATE(BM_CoverageOfMeshIsGreaterThan, Triangle)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_CoverageOfMeshIsGreaterThan, Rect)->INK_MESH_SIZES;
+BENCHMARK_TEMPLATE(BM_CoverageOfMeshIsGreaterThan, Quad)->INK_MESH_SIZES;
+
+void BM_CoverageOfMeshByMesh(benchmark::State& state) {
+  PartitionedMesh mesh = MakeStrokeLikeMesh(state.range(0));
+  PartitionedMesh query = MakeStrokeLikeMesh(state.range(0));
+  mesh.InitializeSpatialIndex();
+  query.InitializeSpatialIndex();
+  AffineTransform query_to_mesh = AffineTransform::Translate({50, 0});
+  for (auto s : state) {
+    benchmark::DoNotOptimize(mesh.Coverage(query, query_to_mesh));
+  }
+}
+BENCHMARK(BM_CoverageOfMeshByMesh)->INK_MESH_SIZES;
+
+void BM_InitializeSpatialIndex(benchmark::State& state) {
+  PartitionedMesh mesh = MakeStrokeLikeMesh(state.range(0));
+  for (auto s : state) {
+    // Copying a `PartitionedMesh` shares its spatial index, so this makes a
+    // fresh one each time, outside of the timed section.
+    state.PauseTiming();
+    PartitionedMesh unindexed = *PartitionedMesh::FromMeshes(mesh.Meshes());
+    state.ResumeTiming();
+    unindexed.InitializeSpatialIndex();
+  }
+}
+BENCHMARK(BM_InitializeSpatialIndex)->INK_MESH_SIZES;
+
+#undef INK_MESH_SIZES
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,96 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/incremental_convex_hull.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/convex_hull.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+
+namespace ink {
+namespace {
+
+// The pending points are folded into the hull once there are at least this
+// many of them, and at least as many as there are points on the hull; the
+// latter keeps the amortized cost of each point logarithmic.
+constexpr size_t kMinPointsToFold = 256;
+
+}  // namespace
+
+void IncrementalConvexHull::Reset() {
+  hull_.clear();
+  pending_.clear();
+  envelope_.Reset();
+}
+
+void IncrementalConvexHull::Add(Point p) {
+  pending_.push_back(p);
+  envelope_.Add(p);
+  if (pending_.size() >= std::max(kMinPointsToFold, hull_.size())) {
+    FoldPendingPoints();
+  }
+}
+
+void IncrementalConvexHull::Add(const Mesh& mesh) {
+  for (uint32_t i = 0; i < mesh.VertexCount(); ++i) {
+    Add(mesh.VertexPosition(i));
+  }
+}
+
+void IncrementalConvexHull::Add(const MutableMesh& mesh) {
+  for (uint32_t i = 0; i < mesh.VertexCount(); ++i) {
+    Add(mesh.VertexPosition(i));
+  }
+}
+
+void IncrementalConvexHull::Add(const IncrementalConvexHull& other) {
+  // `other.hull_` is a subset of the points that were added to `other`, but
+  // every other point added to `other` is inside of it, so adding it in their
+  // place doesn't change the hull.
+  Add(absl::MakeConstSpan(other.hull_));
+  Add(absl::MakeConstSpan(other.pending_));
+}
+
+void IncrementalConvexHull::AddTransformed(absl::Span<const Point> points,
+                                           const AffineTransform& transform) {
+  for (Point p : points) {
+    Add(transform.Apply(p));
+  }
+}
+
+std::vector<Point> IncrementalConvexHull::ConvexHull() const {
+  if (pending_.empty()) return hull_;
+  std::vector<Point> points;
+  points.reserve(hull_.size() + pending_.size());
+  points.insert(points.end(), hull_.begin(), hull_.end());
+  points.insert(points.end(), pending_.begin(), pending_.end());
+  return ink::ConvexHull(points);
+}
+
+void IncrementalConvexHull::FoldPendingPoints() {
+  pending_.insert(pending_.end(), hull_.begin(), hull_.end());
+  hull_ = ink::ConvexHull(pending_);
+  pending_.clear();
+}
+
+}  // namespace ink
@@ -0,0 +1,118 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_GEOMETRY_INCREMENTAL_CONVEX_HULL_H_
+#define INK_GEOMETRY_INCREMENTAL_CONVEX_HULL_H_
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+
+namespace ink {
+
+// Accumulates the convex hull and the envelope of a stream of points, without
+// requiring them to be gathered into a single vector first.
+//
+// Points are buffered and periodically folded into the running hull, so that
+// the memory used is proportional to the size of the hull rather than to the
+// number of points added, and the amortized cost of adding a point is
+// O(log(hull size)).
+//
+// Since affine transforms preserve convexity, the hull of a set of transformed
+// points is the transformed hull of the original points. A selection of many
+// strokes can therefore cache each stroke's `ConvexHull()` once, and then
+// compute the hull or envelope of the whole selection under a new transform
+// (e.g. on every frame of a drag) by passing those cached hulls to
+// `AddTransformed()`, at a cost proportional to the total number of hull
+// points instead of the total number of vertices.
+class IncrementalConvexHull {
+ public:
+  IncrementalConvexHull() = default;
+  IncrementalConvexHull(const IncrementalConvexHull&) = default;
+  IncrementalConvexHull(IncrementalConvexHull&&) = default;
+  IncrementalConvexHull& operator=(const IncrementalConvexHull&) = default;
+  IncrementalConvexHull& operator=(IncrementalConvexHull&&) = default;
+  ~IncrementalConvexHull() = default;
+
+  // Returns true if no points have been added since construction or the last
+  // call to `Reset()`.
+  bool IsEmpty() const { return envelope_.IsEmpty(); }
+
+  // Removes all of the accumulated points. This keeps the allocated storage,
+  // so that the hull can be cheaply recomputed, e.g. once per frame.
+  void Reset();
+
+  // Adds `p` to the set of points whose hull is being computed.
+  void Add(Point p);
+
+  // Adds the points in the iterator range [begin, end). `Iterator` must be an
+  // input iterator whose value type is convertible to `Point`.
+  template <typename Iterator>
+  void Add(Iterator begin, Iterator end) {
+    for (auto it = begin; it != end; ++it) Add(Point(*it));
+  }
+
+  // Adds the given points.
+  void Add(absl::Span<const Point> points) {
+    Add(points.begin(), points.end());
+  }
+
+  // Adds the position of each vertex of `mesh`, read directly from the mesh's
+  // vertex data.
+  void Add(const Mesh& mesh);
+  void Add(const MutableMesh& mesh);
+
+  // Adds all of the points that have been added to `other`.
+  void Add(const IncrementalConvexHull& other);
+
+  // Adds each of `points`, after applying `transform` to it.
+  //
+  // This is typically used with the cached `ConvexHull()` of some shape, to
+  // accumulate the hull of that shape under `transform`.
+  void AddTransformed(absl::Span<const Point> points,
+                      const AffineTransform& transform);
+
+  // Returns the convex hull of the added points, in the same form as the free
+  // function `ConvexHull()` in convex_hull.h: the vertices of the hull in
+  // counter-clockwise order, starting with the one with the lowest
+  // y-coordinate (and then the lowest x-coordinate). This is empty if no points
+  // have been added.
+  std::vector<Point> ConvexHull() const;
+
+  // Returns the envelope of the added points. This is kept up to date as
+  // points are added, so it is cheap to call at any time.
+  const Envelope& Bounds() const { return envelope_; }
+
+ private:
+  // Replaces `hull_` with the hull of `hull_` and `pending_`, and clears
+  // `pending_`.
+  void FoldPendingPoints();
+
+  // The convex hull of the points added before the last call to
+  // `FoldPendingPoints()`.
+  std::vector<Point> hull_;
+  // The points added since the last call to `FoldPendingPoints()`.
+  std::vector<Point> pending_;
+  Envelope envelope_;
+};
+
+}  // namespace ink
+
+#endif  // INK_GEOMETRY_INCREMENTAL_CONVEX_HULL_H_
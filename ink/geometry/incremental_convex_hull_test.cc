@@ -0,0 +1,174 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/incremental_convex_hull.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/convex_hull.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/mesh_format.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/type_matchers.h"
+
+namespace ink {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::IsEmpty;
+using ::testing::Optional;
+
+std::vector<Point> MakeRandomPoints(int n_points, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<float> coord(-100, 100);
+  std::vector<Point> points;
+  points.reserve(n_points);
+  for (int i = 0; i < n_points; ++i) {
+    points.push_back({coord(rng), coord(rng)});
+  }
+  return points;
+}
+
+TEST(IncrementalConvexHullTest, IsEmptyByDefault) {
+  IncrementalConvexHull hull;
+  EXPECT_TRUE(hull.IsEmpty());
+  EXPECT_THAT(hull.ConvexHull(), IsEmpty());
+  EXPECT_TRUE(hull.Bounds().IsEmpty());
+}
+
+TEST(IncrementalConvexHullTest, AddSinglePoint) {
+  IncrementalConvexHull hull;
+  hull.Add(Point{3, -2});
+  EXPECT_FALSE(hull.IsEmpty());
+  EXPECT_THAT(hull.ConvexHull(), ElementsAreArray({Point{3, -2}}));
+  EXPECT_THAT(hull.Bounds().AsRect(),
+              Optional(RectEq(Rect::FromTwoPoints({3, -2}, {3, -2}))));
+}
+
+TEST(IncrementalConvexHullTest, MatchesConvexHullOfAllPoints) {
+  for (int n_points : {10, 255, 256, 257, 1000, 20000}) {
+    std::vector<Point> points = MakeRandomPoints(n_points, n_points);
+    IncrementalConvexHull hull;
+    for (Point p : points) hull.Add(p);
+    EXPECT_THAT(hull.ConvexHull(), ElementsAreArray(ConvexHull(points)))
+        << "n_points = " << n_points;
+    EXPECT_THAT(hull.Bounds().AsRect(),
+                Optional(RectEq(*Envelope(points).AsRect())))
+        << "n_points = " << n_points;
+  }
+}
+
+TEST(IncrementalConvexHullTest, AddIteratorRangeAndSpan) {
+  std::vector<Point> points = MakeRandomPoints(1000, 1);
+  IncrementalConvexHull from_range;
+  from_range.Add(points.begin(), points.end());
+  IncrementalConvexHull from_span;
+  from_span.Add(points);
+  EXPECT_THAT(from_range.ConvexHull(), ElementsAreArray(ConvexHull(points)));
+  EXPECT_THAT(from_span.ConvexHull(), ElementsAreArray(ConvexHull(points)));
+}
+
+TEST(IncrementalConvexHullTest, AddMutableMeshAndMesh) {
+  MutableMesh mutable_mesh = MakeCoiledRingMutableMesh(
+      /*n_triangles=*/60, /*n_subdivisions=*/20, MeshFormat(),
+      AffineTransform::Translate({5, 3}));
+  std::vector<Point> positions;
+  for (uint32_t i = 0; i < mutable_mesh.VertexCount(); ++i) {
+    positions.push_back(mutable_mesh.VertexPosition(i));
+  }
+
+  IncrementalConvexHull from_mutable_mesh;
+  from_mutable_mesh.Add(mutable_mesh);
+  EXPECT_THAT(from_mutable_mesh.ConvexHull(),
+              ElementsAreArray(ConvexHull(positions)));
+
+  auto meshes = mutable_mesh.AsMeshes();
+  ASSERT_EQ(meshes.status(), absl::OkStatus());
+  ASSERT_EQ(meshes->size(), 1);
+  std::vector<Point> mesh_positions;
+  for (uint32_t i = 0; i < (*meshes)[0].VertexCount(); ++i) {
+    mesh_positions.push_back((*meshes)[0].VertexPosition(i));
+  }
+  IncrementalConvexHull from_mesh;
+  from_mesh.Add((*meshes)[0]);
+  EXPECT_THAT(from_mesh.ConvexHull(),
+              ElementsAreArray(ConvexHull(mesh_positions)));
+  EXPECT_THAT(from_mesh.Bounds().AsRect(),
+              Optional(RectEq(*(*meshes)[0].Bounds().AsRect())));
+}
+
+TEST(IncrementalConvexHullTest, AddTransformedCachedHulls) {
+  // The transforms are chosen to be exact in floating point, so that the hull
+  // of the transformed cached hulls exactly matches the hull of all of the
+  // transformed points.
+  std::vector<Point> stroke_a = MakeRandomPoints(3000, 2);
+  std::vector<Point> stroke_b = MakeRandomPoints(3000, 3);
+  std::vector<Point> cached_hull_a = ConvexHull(stroke_a);
+  std::vector<Point> cached_hull_b = ConvexHull(stroke_b);
+  AffineTransform transform_a = AffineTransform::Translate({150, -20});
+  AffineTransform transform_b = AffineTransform::Scale(0.5, 2);
+
+  IncrementalConvexHull selection;
+  selection.AddTransformed(cached_hull_a, transform_a);
+  selection.AddTransformed(cached_hull_b, transform_b);
+
+  std::vector<Point> all_points;
+  for (Point p : stroke_a) all_points.push_back(transform_a.Apply(p));
+  for (Point p : stroke_b) all_points.push_back(transform_b.Apply(p));
+  EXPECT_THAT(selection.ConvexHull(), ElementsAreArray(ConvexHull(all_points)));
+  EXPECT_THAT(selection.Bounds().AsRect(),
+              Optional(RectEq(*Envelope(all_points).AsRect())));
+}
+
+TEST(IncrementalConvexHullTest, AddOtherIncrementalConvexHull) {
+  std::vector<Point> points_a = MakeRandomPoints(700, 4);
+  std::vector<Point> points_b = MakeRandomPoints(300, 5);
+  IncrementalConvexHull hull_a;
+  hull_a.Add(points_a);
+  IncrementalConvexHull hull_b;
+  hull_b.Add(points_b);
+  hull_a.Add(hull_b);
+
+  std::vector<Point> all_points = points_a;
+  all_points.insert(all_points.end(), points_b.begin(), points_b.end());
+  EXPECT_THAT(hull_a.ConvexHull(), ElementsAreArray(ConvexHull(all_points)));
+  EXPECT_THAT(hull_a.Bounds().AsRect(),
+              Optional(RectEq(*Envelope(all_points).AsRect())));
+}
+
+TEST(IncrementalConvexHullTest, ResetRemovesAllPoints) {
+  IncrementalConvexHull hull;
+  hull.Add(MakeRandomPoints(1000, 6));
+  hull.Reset();
+  EXPECT_TRUE(hull.IsEmpty());
+  EXPECT_THAT(hull.ConvexHull(), IsEmpty());
+  EXPECT_TRUE(hull.Bounds().IsEmpty());
+
+  hull.Add(Point{1, 2});
+  hull.Add(Point{4, 2});
+  EXPECT_THAT(hull.ConvexHull(), ElementsAreArray({Point{1, 2}, Point{4, 2}}));
+}
+
+}  // namespace
+}  // namespace ink
@@ -46,11 +46,26 @@ void Circle::AppendArcToPolyline(Angle start, Angle arc_angle,
                         std::numeric_limits<int16_t>::max());
   Angle step_angle = arc_angle / steps;
 
+  // Rather than evaluating `sin` and `cos` for every point, we rotate the
+  // offset from the center by `step_angle` using a rotation computed once per
+  // arc. To keep the rounding error from accumulating over long arcs, the
+  // offset is recomputed exactly every `kStepsPerExactOffset` steps.
+  constexpr int32_t kStepsPerExactOffset = 16;
+  float cos_step = Cos(step_angle);
+  float sin_step = Sin(step_angle);
+
   // We do not call `vector::reserve` because we expect cases with multiple
   // "small" arcs strung together.
-  polyline.push_back(GetPoint(start));
+  Vec offset = Vec::FromDirectionAndMagnitude(start, radius_);
+  polyline.push_back(center_ + offset);
   for (int32_t i = 1; i < steps; ++i) {
-    polyline.push_back(GetPoint(start + i * step_angle));
+    if (i % kStepsPerExactOffset == 0) {
+      offset = Vec::FromDirectionAndMagnitude(start + i * step_angle, radius_);
+    } else {
+      offset = {cos_step * offset.x - sin_step * offset.y,
+                sin_step * offset.x + cos_step * offset.y};
+    }
+    polyline.push_back(center_ + offset);
   }
   polyline.push_back(GetPoint(start + arc_angle));
 }
@@ -279,6 +279,29 @@ TEST(CircleTest, AppendArcToPolylineMoreThanFullCircle) {
   EXPECT_THAT(polyline, ChordHeightsAreLessThan(circle, max_chord_height));
 }
 
+TEST(CircleTest, AppendArcToPolylineMatchesDirectEvaluation) {
+  Circle circle({-3, 7}, 50);
+  std::vector<Point> polyline;
+  float max_chord_height = 0.001;
+  Angle starting_angle = Angle::Radians(0.3);
+  Angle arc_angle = -2.5f * kFullTurn;
+  circle.AppendArcToPolyline(starting_angle, arc_angle, max_chord_height,
+                             polyline);
+
+  // This arc needs a few thousand points, so the points computed by
+  // incremental rotation should still agree with evaluating each angle
+  // directly.
+  ASSERT_GT(polyline.size(), 1000);
+  Angle step_angle = arc_angle / (polyline.size() - 1);
+  for (int i = 0; i < polyline.size(); ++i) {
+    EXPECT_THAT(polyline[i],
+                PointNear(circle.GetPoint(starting_angle + i * step_angle),
+                          0.001))
+        << "at index " << i;
+  }
+  EXPECT_THAT(polyline, PointsLieOnCircle(circle));
+}
+
 TEST(CircleTest, AppendArcToPolylineMaxChordHeightGreaterThanRadius) {
   Circle circle({5, 2}, 2);
   std::vector<Point> polyline;
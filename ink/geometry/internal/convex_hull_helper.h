@@ -15,10 +15,13 @@
 #ifndef INK_GEOMETRY_INTERNAL_CONVEX_HULL_HELPER_H_
 #define INK_GEOMETRY_INTERNAL_CONVEX_HULL_HELPER_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <iterator>
 #include <vector>
 
+#include "absl/base/config.h"
 #include "absl/types/span.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/triangle.h"
@@ -34,16 +37,40 @@ std::vector<typename VertexTessellationHelper::VertexType>
 PruneUsingAkiToussaint(
     absl::Span<const typename VertexTessellationHelper::VertexType> points);
 
+// Like above, but replaces the contents of `pruned_points` with the result,
+// reusing its storage.
+template <typename VertexTessellationHelper>
+void PruneUsingAkiToussaint(
+    absl::Span<const typename VertexTessellationHelper::VertexType> points,
+    std::vector<typename VertexTessellationHelper::VertexType>& pruned_points);
+
 template <typename VertexTessellationHelper>
 std::vector<typename VertexTessellationHelper::VertexType> ConvexHull(
     absl::Span<const typename VertexTessellationHelper::VertexType> points);
 
+// Like above, but replaces the contents of `hull` with the result, reusing its
+// storage. The temporary buffers are reused across calls on the same thread, so
+// repeated calls with a similar number of points do no heap allocation.
+template <typename VertexTessellationHelper>
+void ConvexHull(
+    absl::Span<const typename VertexTessellationHelper::VertexType> points,
+    std::vector<typename VertexTessellationHelper::VertexType>& hull);
+
 // ---------------------------------------------------------------------------
 //                     Implementation details below
 template <typename VertexTessellationHelper>
 std::vector<typename VertexTessellationHelper::VertexType>
 PruneUsingAkiToussaint(
     absl::Span<const typename VertexTessellationHelper::VertexType> points) {
+  std::vector<typename VertexTessellationHelper::VertexType> pruned_points;
+  PruneUsingAkiToussaint<VertexTessellationHelper>(points, pruned_points);
+  return pruned_points;
+}
+
+template <typename VertexTessellationHelper>
+void PruneUsingAkiToussaint(
+    absl::Span<const typename VertexTessellationHelper::VertexType> points,
+    std::vector<typename VertexTessellationHelper::VertexType>& pruned_points) {
   constexpr auto GetX = &VertexTessellationHelper::GetX;
   constexpr auto GetY = &VertexTessellationHelper::GetY;
   using VertexType = typename VertexTessellationHelper::VertexType;
@@ -68,7 +95,9 @@ PruneUsingAkiToussaint(
   }
 
   // Points that are inside of the quadrilateral formed by the extrema will not
-  // be in the convex hull, and can be eliminated.
+  // be in the convex hull, and can be eliminated. The extrema themselves lie on
+  // the boundary of the quadrilateral, which `Triangle::Contains` considers to
+  // be inside, so they must be kept explicitly.
   Triangle upper_triangle{Point{GetX(min_x_point), GetY(min_x_point)},
                           Point{GetX(max_x_point), GetY(max_x_point)},
                           Point{GetX(max_y_point), GetY(max_y_point)}};
@@ -77,32 +106,45 @@ PruneUsingAkiToussaint(
                           Point{GetX(min_y_point), GetY(min_y_point)},
                           Point{GetX(max_x_point), GetY(max_x_point)}};
 
-  std::vector<VertexType> pruned_points;
+  pruned_points.clear();
   pruned_points.reserve(points.size());
   for (const auto& p : points) {
     Point test_point{GetX(p), GetY(p)};
-    if (!upper_triangle.Contains(test_point) &&
-        !lower_triangle.Contains(test_point))
+    if (p == min_x_point || p == max_x_point || p == min_y_point ||
+        p == max_y_point ||
+        (!upper_triangle.Contains(test_point) &&
+         !lower_triangle.Contains(test_point)))
       pruned_points.push_back(p);
   }
-
-  return pruned_points;
 }
 
 template <typename VertexTessellationHelper>
 std::vector<typename VertexTessellationHelper::VertexType> ConvexHull(
     absl::Span<const typename VertexTessellationHelper::VertexType> points) {
+  std::vector<typename VertexTessellationHelper::VertexType> hull;
+  ConvexHull<VertexTessellationHelper>(points, hull);
+  return hull;
+}
+
+template <typename VertexTessellationHelper>
+void ConvexHull(
+    absl::Span<const typename VertexTessellationHelper::VertexType> points,
+    std::vector<typename VertexTessellationHelper::VertexType>& hull) {
   constexpr auto GetX = &VertexTessellationHelper::GetX;
   constexpr auto GetY = &VertexTessellationHelper::GetY;
   using VertexType = typename VertexTessellationHelper::VertexType;
 
-  if (points.size() < 2)
-    return std::vector<VertexType>(points.begin(), points.end());
+  if (points.size() < 2) {
+    hull.assign(points.begin(), points.end());
+    return;
+  }
 
-  auto pruned_points =
-      points.size() > 500
-          ? PruneUsingAkiToussaint<VertexTessellationHelper>(points)
-          : std::vector<VertexType>(points.begin(), points.end());
+  // Fall back to a local buffer only if `thread_local` is unsupported, which
+  // should be almost never.
+#ifdef ABSL_HAVE_THREAD_LOCAL
+  thread_local
+#endif
+      std::vector<VertexType> sorted_points;
 
   // Find the point with the lowest y-coordinate, selecting the lowest
   // x-coordinate in the case of ties.
@@ -115,11 +157,18 @@ std::vector<typename VertexTessellationHelper::VertexType> ConvexHull(
 
   // Sort the remaining points by their angle from the start point, placing the
   // closest first in the case of ties.
-  std::vector<VertexType> sorted_points;
-  sorted_points.reserve(points.size());
-  std::copy_if(pruned_points.begin(), pruned_points.end(),
-               std::back_inserter(sorted_points),
-               [start_point](const VertexType& v) { return v != start_point; });
+  if (points.size() > 500) {
+    PruneUsingAkiToussaint<VertexTessellationHelper>(points, sorted_points);
+    sorted_points.erase(
+        std::remove(sorted_points.begin(), sorted_points.end(), start_point),
+        sorted_points.end());
+  } else {
+    sorted_points.clear();
+    sorted_points.reserve(points.size());
+    std::copy_if(
+        points.begin(), points.end(), std::back_inserter(sorted_points),
+        [start_point](const VertexType& v) { return v != start_point; });
+  }
   std::sort(sorted_points.begin(), sorted_points.end(),
             [start_point](const VertexType& lhs, const VertexType& rhs) {
               Vec lhs_vec{GetX(lhs) - GetX(start_point),
@@ -132,7 +181,7 @@ std::vector<typename VertexTessellationHelper::VertexType> ConvexHull(
             });
 
   // Add the sorted points to the hull, removing any that form concavities.
-  std::vector<VertexType> hull;
+  hull.clear();
   constexpr size_t kHullSizeEstimate = 64;  // From real-world experimentation.
   hull.reserve(std::min(kHullSizeEstimate, sorted_points.size()));
   hull.push_back(start_point);
@@ -147,7 +196,12 @@ std::vector<typename VertexTessellationHelper::VertexType> ConvexHull(
     hull.push_back(point);
   }
 
-  return hull;
+  // Don't hold on to the memory for a very large input for the life of the
+  // thread.
+  constexpr size_t kMaxRetainedScratchSize = 1 << 16;
+  if (sorted_points.capacity() > kMaxRetainedScratchSize) {
+    sorted_points = std::vector<VertexType>();
+  }
 }
 
 }  // namespace ink::geometry_internal
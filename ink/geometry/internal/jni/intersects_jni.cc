@@ -14,14 +14,20 @@
 
 #include <jni.h>
 
+#include <cstddef>
+#include <vector>
+
+#include "absl/log/absl_check.h"
 #include "ink/geometry/affine_transform.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/internal/jni/partitioned_mesh_jni_helper.h"
 #include "ink/geometry/intersects.h"
+#include "ink/geometry/partitioned_mesh.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/quad.h"
 #include "ink/geometry/rect.h"
 #include "ink/geometry/segment.h"
+#include "ink/geometry/sweep_intersection.h"
 #include "ink/geometry/triangle.h"
 #include "ink/jni/internal/jni_defines.h"
 
@@ -30,12 +36,63 @@ namespace {
 using ::ink::AffineTransform;
 using ::ink::Angle;
 using ::ink::Intersects;
+using ::ink::PartitionedMesh;
 using ::ink::Point;
 using ::ink::Quad;
 using ::ink::Rect;
 using ::ink::Segment;
+using ::ink::SweepTarget;
 using ::ink::Triangle;
 using ::ink::jni::CastToPartitionedMesh;
+using ::ink::jni::QueryPartitionedMeshes;
+
+// Returns the sweep targets for the Kotlin PartitionedMesh native pointers in
+// `partitioned_mesh_native_pointers`, where `mesh_to_sweep_transforms` holds 6
+// values (a through f) per mesh for the transform that maps from that mesh's
+// coordinate space to the sweep's.
+std::vector<SweepTarget> ReadSweepTargets(
+    JNIEnv* env, jlongArray partitioned_mesh_native_pointers,
+    jfloatArray mesh_to_sweep_transforms) {
+  const jsize num_meshes =
+      env->GetArrayLength(partitioned_mesh_native_pointers);
+  ABSL_CHECK_EQ(env->GetArrayLength(mesh_to_sweep_transforms), 6 * num_meshes);
+  std::vector<SweepTarget> targets;
+  targets.reserve(num_meshes);
+  jlong* mesh_pointers =
+      env->GetLongArrayElements(partitioned_mesh_native_pointers, nullptr);
+  ABSL_CHECK(mesh_pointers != nullptr);
+  jfloat* transforms =
+      env->GetFloatArrayElements(mesh_to_sweep_transforms, nullptr);
+  ABSL_CHECK(transforms != nullptr);
+  for (jsize i = 0; i < num_meshes; ++i) {
+    const jfloat* t = &transforms[6 * i];
+    targets.push_back({.shape = &CastToPartitionedMesh(mesh_pointers[i]),
+                       .shape_to_sweep = AffineTransform(t[0], t[1], t[2],
+                                                         t[3], t[4], t[5])});
+  }
+  // No need to copy back the arrays, which are not modified.
+  env->ReleaseLongArrayElements(partitioned_mesh_native_pointers, mesh_pointers,
+                                JNI_ABORT);
+  env->ReleaseFloatArrayElements(mesh_to_sweep_transforms, transforms,
+                                 JNI_ABORT);
+  return targets;
+}
+
+// Returns a new Java int array holding `indices`.
+jintArray NewJIntArray(JNIEnv* env, const std::vector<size_t>& indices) {
+  std::vector<jint> values(indices.begin(), indices.end());
+  jintArray array = env->NewIntArray(values.size());
+  env->SetIntArrayRegion(array, 0, values.size(), values.data());
+  return array;
+}
+
+// Returns a new Java boolean array holding `values`.
+jbooleanArray NewJBooleanArray(JNIEnv* env,
+                               const std::vector<jboolean>& values) {
+  jbooleanArray array = env->NewBooleanArray(values.size());
+  env->SetBooleanArrayRegion(array, 0, values.size(), values.data());
+  return array;
+}
 
 }  // namespace
 
@@ -366,4 +423,121 @@ JNI_METHOD(geometry, Intersection, jboolean,
       other_to_common_transform);
 }
 
+// The `nativePartitionedMeshes*Intersects` methods below return, for each mesh
+// in `partitioned_mesh_native_pointers`, whether it intersects the query
+// shape, where `query_to_mesh_transforms` holds 6 values (a through f) per mesh
+// for the transform that maps from the query's coordinate space to that mesh's.
+// If `parallel` is true, the meshes are tested concurrently on native threads.
+
+JNI_METHOD(geometry, Intersection, jbooleanArray,
+           nativePartitionedMeshesTriangleIntersects)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat triangle_p0_x, jfloat triangle_p0_y, jfloat triangle_p1_x,
+ jfloat triangle_p1_y, jfloat triangle_p2_x, jfloat triangle_p2_y,
+ jfloatArray query_to_mesh_transforms, jboolean parallel) {
+  Triangle triangle{{triangle_p0_x, triangle_p0_y},
+                    {triangle_p1_x, triangle_p1_y},
+                    {triangle_p2_x, triangle_p2_y}};
+  return NewJBooleanArray(
+      env, QueryPartitionedMeshes<jboolean>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&triangle](const PartitionedMesh& partitioned_mesh,
+                           const AffineTransform& transform) {
+                 return Intersects(triangle, partitioned_mesh, transform);
+               }));
+}
+
+JNI_METHOD(geometry, Intersection, jbooleanArray,
+           nativePartitionedMeshesBoxIntersects)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat box_x_min, jfloat box_y_min, jfloat box_x_max, jfloat box_y_max,
+ jfloatArray query_to_mesh_transforms, jboolean parallel) {
+  Rect rect =
+      Rect::FromTwoPoints({box_x_min, box_y_min}, {box_x_max, box_y_max});
+  return NewJBooleanArray(
+      env, QueryPartitionedMeshes<jboolean>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&rect](const PartitionedMesh& partitioned_mesh,
+                       const AffineTransform& transform) {
+                 return Intersects(rect, partitioned_mesh, transform);
+               }));
+}
+
+JNI_METHOD(geometry, Intersection, jbooleanArray,
+           nativePartitionedMeshesParallelogramIntersects)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat parallelogram_center_x, jfloat parallelogram_center_y,
+ jfloat parallelogram_width, jfloat parallelogram_height,
+ jfloat parallelogram_angle_radian, jfloat parallelogram_shear_factor,
+ jfloatArray query_to_mesh_transforms, jboolean parallel) {
+  Quad quad = Quad::FromCenterDimensionsRotationAndSkew(
+      Point{parallelogram_center_x, parallelogram_center_y},
+      parallelogram_width, parallelogram_height,
+      Angle::Radians(parallelogram_angle_radian), parallelogram_shear_factor);
+  return NewJBooleanArray(
+      env, QueryPartitionedMeshes<jboolean>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&quad](const PartitionedMesh& partitioned_mesh,
+                       const AffineTransform& transform) {
+                 return Intersects(quad, partitioned_mesh, transform);
+               }));
+}
+
+// Returns the indices of the meshes in `partitioned_mesh_native_pointers` that
+// are within `radius` of the polyline through the points in `path_xy`, which
+// holds interleaved x and y coordinates. This answers an eraser's hit test for
+// a whole batch of strokes in a single call; see
+// `ink::FindTargetsIntersectingSweep`.
+JNI_METHOD(geometry, Intersection, jintArray,
+           nativePathSweepPartitionedMeshesIntersects)
+(JNIEnv* env, jobject object, jfloatArray path_xy, jfloat radius,
+ jlongArray partitioned_mesh_native_pointers,
+ jfloatArray mesh_to_path_transforms) {
+  std::vector<SweepTarget> targets = ReadSweepTargets(
+      env, partitioned_mesh_native_pointers, mesh_to_path_transforms);
+  const jsize num_coordinates = env->GetArrayLength(path_xy);
+  ABSL_CHECK_EQ(num_coordinates % 2, 0);
+  std::vector<Point> path;
+  path.reserve(num_coordinates / 2);
+  jfloat* coordinates = env->GetFloatArrayElements(path_xy, nullptr);
+  ABSL_CHECK(coordinates != nullptr);
+  for (jsize i = 0; i < num_coordinates; i += 2) {
+    path.push_back({coordinates[i], coordinates[i + 1]});
+  }
+  // No need to copy back the array, which is not modified.
+  env->ReleaseFloatArrayElements(path_xy, coordinates, JNI_ABORT);
+  return NewJIntArray(
+      env, ink::FindTargetsIntersectingSweep(path, radius, targets));
+}
+
+// Returns the indices of the meshes in `partitioned_mesh_native_pointers` that
+// intersect any of the parallelograms in `parallelograms`, which holds 6 values
+// per parallelogram: center x, center y, width, height, angle in radians, and
+// shear factor.
+JNI_METHOD(geometry, Intersection, jintArray,
+           nativeParallelogramSweepPartitionedMeshesIntersects)
+(JNIEnv* env, jobject object, jfloatArray parallelograms,
+ jlongArray partitioned_mesh_native_pointers,
+ jfloatArray mesh_to_parallelogram_transforms) {
+  std::vector<SweepTarget> targets = ReadSweepTargets(
+      env, partitioned_mesh_native_pointers, mesh_to_parallelogram_transforms);
+  const jsize num_values = env->GetArrayLength(parallelograms);
+  ABSL_CHECK_EQ(num_values % 6, 0);
+  std::vector<Quad> sweep;
+  sweep.reserve(num_values / 6);
+  jfloat* values = env->GetFloatArrayElements(parallelograms, nullptr);
+  ABSL_CHECK(values != nullptr);
+  for (jsize i = 0; i < num_values; i += 6) {
+    sweep.push_back(Quad::FromCenterDimensionsRotationAndSkew(
+        Point{values[i], values[i + 1]}, values[i + 2], values[i + 3],
+        Angle::Radians(values[i + 4]), values[i + 5]));
+  }
+  // No need to copy back the array, which is not modified.
+  env->ReleaseFloatArrayElements(parallelograms, values, JNI_ABORT);
+  return NewJIntArray(env, ink::FindTargetsIntersectingSweep(sweep, targets));
+}
+
 }  // extern "C
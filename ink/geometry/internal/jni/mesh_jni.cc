@@ -25,6 +25,7 @@
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_packing_types.h"
 #include "ink/geometry/point.h"
+#include "ink/jni/internal/jni_array_util.h"
 #include "ink/jni/internal/jni_defines.h"
 
 namespace {
@@ -34,6 +35,7 @@ using ::ink::jni::CastToMesh;
 using ::ink::jni::DeleteNativeMesh;
 using ::ink::jni::FillJBoxAccumulatorOrThrow;
 using ::ink::jni::FillJMutableVecFromPointOrThrow;
+using ::ink::jni::ForEachNativePointer;
 using ::ink::jni::NewNativeMesh;
 using ::ink::jni::NewNativeMeshFormat;
 
@@ -56,6 +58,13 @@ JNI_METHOD(geometry, MeshNative, void, free)
   DeleteNativeMesh(native_pointer);
 }
 
+// Frees each of the Kotlin Mesh.nativePointer values in `native_pointers` in a
+// single call.
+JNI_METHOD(geometry, MeshNative, void, freeAll)
+(JNIEnv* env, jobject object, jlongArray native_pointers) {
+  ForEachNativePointer(env, native_pointers, DeleteNativeMesh);
+}
+
 // Create a newly allocated empty `Mesh`.
 JNI_METHOD(geometry, MeshNative, jlong, createEmpty)
 (JNIEnv* env, jobject object) { return NewNativeMesh(); }
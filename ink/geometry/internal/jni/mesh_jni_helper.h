@@ -5,13 +5,14 @@
 
 #include "absl/log/absl_check.h"
 #include "ink/geometry/mesh.h"
+#include "ink/jni/internal/jni_object_pool.h"
 
 namespace ink::jni {
 
 // Creates a new stack-allocated copy of the `Mesh` and returns a pointer
 // to it as a jlong, suitable for wrapping in a Kotlin Mesh.
 inline jlong NewNativeMesh(const Mesh& mesh) {
-  return reinterpret_cast<jlong>(new Mesh(mesh));
+  return reinterpret_cast<jlong>(GetNativeObjectPool<Mesh>().New(mesh));
 }
 
 // Creates a new stack-allocated empty `Mesh` and returns a pointer
@@ -32,7 +33,7 @@ inline const Mesh& CastToMesh(jlong native_pointer) {
 // Frees a Kotlin Mesh.nativePointer.
 inline void DeleteNativeMesh(jlong native_pointer) {
   if (native_pointer == 0) return;
-  delete reinterpret_cast<Mesh*>(native_pointer);
+  GetNativeObjectPool<Mesh>().Delete(reinterpret_cast<Mesh*>(native_pointer));
 }
 
 }  // namespace ink::jni
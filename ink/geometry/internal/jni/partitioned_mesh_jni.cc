@@ -17,6 +17,7 @@
 #include <cstddef>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "ink/geometry/affine_transform.h"
 #include "ink/geometry/angle.h"
@@ -29,7 +30,9 @@
 #include "ink/geometry/quad.h"
 #include "ink/geometry/rect.h"
 #include "ink/geometry/triangle.h"
+#include "ink/jni/internal/jni_array_util.h"
 #include "ink/jni/internal/jni_defines.h"
+#include "ink/jni/internal/jni_throw_util.h"
 
 namespace {
 
@@ -43,9 +46,38 @@ using ::ink::Rect;
 using ::ink::Triangle;
 using ::ink::jni::CastToPartitionedMesh;
 using ::ink::jni::DeleteNativePartitionedMesh;
+using ::ink::jni::ForEachNativePointer;
 using ::ink::jni::NewNativeMesh;
 using ::ink::jni::NewNativeMeshFormat;
 using ::ink::jni::NewNativePartitionedMesh;
+using ::ink::jni::QueryPartitionedMeshes;
+using ::ink::jni::ThrowExceptionFromStatus;
+using ::ink::jni::WriteToFloatBufferOrArray;
+using ::ink::jni::WriteToIntArray;
+
+jint TotalOutlineVertexCount(const PartitionedMesh& partitioned_mesh,
+                             jint group_index) {
+  jint count = 0;
+  for (jint i = 0; i < partitioned_mesh.OutlineCount(group_index); ++i) {
+    count += partitioned_mesh.Outline(group_index, i).size();
+  }
+  return count;
+}
+
+// Returns a new Java float array holding `values`.
+jfloatArray NewJFloatArray(JNIEnv* env, const std::vector<jfloat>& values) {
+  jfloatArray array = env->NewFloatArray(values.size());
+  env->SetFloatArrayRegion(array, 0, values.size(), values.data());
+  return array;
+}
+
+// Returns a new Java boolean array holding `values`.
+jbooleanArray NewJBooleanArray(JNIEnv* env,
+                               const std::vector<jboolean>& values) {
+  jbooleanArray array = env->NewBooleanArray(values.size());
+  env->SetBooleanArrayRegion(array, 0, values.size(), values.data());
+  return array;
+}
 
 }  // namespace
 
@@ -99,7 +131,7 @@ JNI_METHOD(geometry, PartitionedMeshNative, void,
  jintArray out_mesh_index_and_mesh_vertex_index) {
   const PartitionedMesh& partitioned_mesh =
       CastToPartitionedMesh(native_pointer);
-  absl::Span<const PartitionedMesh::VertexIndexPair> outline =
+  PartitionedMesh::OutlineView outline =
       partitioned_mesh.Outline(group_index, outline_index);
   PartitionedMesh::VertexIndexPair index_pair = outline[outline_vertex_index];
   jint mesh_index_and_mesh_vertex_index[] = {index_pair.mesh_index,
@@ -108,6 +140,90 @@ JNI_METHOD(geometry, PartitionedMeshNative, void,
                          mesh_index_and_mesh_vertex_index);
 }
 
+JNI_METHOD(geometry, PartitionedMeshNative, jint, getTotalOutlineVertexCount)
+(JNIEnv* env, jobject object, jlong native_pointer, jint group_index) {
+  return TotalOutlineVertexCount(CastToPartitionedMesh(native_pointer),
+                                 group_index);
+}
+
+// Writes the vertex count of each outline of the render group into
+// `out_counts`, which must hold at least `getOutlineCount()` values.
+JNI_METHOD(geometry, PartitionedMeshNative, void, fillOutlineVertexCounts)
+(JNIEnv* env, jobject object, jlong native_pointer, jint group_index,
+ jintArray out_counts) {
+  const PartitionedMesh& partitioned_mesh =
+      CastToPartitionedMesh(native_pointer);
+  jint outline_count = partitioned_mesh.OutlineCount(group_index);
+  if (absl::Status status = WriteToIntArray(
+          env, out_counts, outline_count,
+          [&partitioned_mesh, group_index,
+           outline_count](absl::Span<jint> counts) {
+            for (jint i = 0; i < outline_count; ++i) {
+              counts[i] = partitioned_mesh.Outline(group_index, i).size();
+            }
+          });
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+  }
+}
+
+// Writes the x and y of every outline vertex of the render group, outline
+// after outline, into either `out_direct_buffer` or `out_array`, one of which
+// must be non-null and hold at least twice `getTotalOutlineVertexCount()`
+// floats. This replaces a `fillOutlineMeshIndexAndMeshVertexIndex()` call and a
+// position lookup per vertex with a single call.
+JNI_METHOD(geometry, PartitionedMeshNative, void, fillOutlinePositions)
+(JNIEnv* env, jobject object, jlong native_pointer, jint group_index,
+ jobject out_direct_buffer, jfloatArray out_array) {
+  const PartitionedMesh& partitioned_mesh =
+      CastToPartitionedMesh(native_pointer);
+  absl::Span<const Mesh> meshes =
+      partitioned_mesh.RenderGroupMeshes(group_index);
+  if (absl::Status status = WriteToFloatBufferOrArray(
+          env, out_direct_buffer, out_array,
+          2 * TotalOutlineVertexCount(partitioned_mesh, group_index),
+          [&partitioned_mesh, group_index,
+           meshes](absl::Span<jfloat> positions) {
+            size_t i = 0;
+            for (jint outline_index = 0;
+                 outline_index < partitioned_mesh.OutlineCount(group_index);
+                 ++outline_index) {
+              for (PartitionedMesh::VertexIndexPair index_pair :
+                   partitioned_mesh.Outline(group_index, outline_index)) {
+                Point position = meshes[index_pair.mesh_index].VertexPosition(
+                    index_pair.vertex_index);
+                positions[i++] = position.x;
+                positions[i++] = position.y;
+              }
+            }
+          });
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+  }
+}
+
+// Writes the vertex count and triangle count of each mesh of the render group,
+// interleaved, into `out_counts`, which must hold at least twice as many values
+// as there are meshes in the group.
+JNI_METHOD(geometry, PartitionedMeshNative, void,
+           fillMeshVertexAndTriangleCounts)
+(JNIEnv* env, jobject object, jlong native_pointer, jint group_index,
+ jintArray out_counts) {
+  absl::Span<const Mesh> meshes =
+      CastToPartitionedMesh(native_pointer).RenderGroupMeshes(group_index);
+  if (absl::Status status =
+          WriteToIntArray(env, out_counts, 2 * meshes.size(),
+                          [meshes](absl::Span<jint> counts) {
+                            for (size_t i = 0; i < meshes.size(); ++i) {
+                              counts[2 * i] = meshes[i].VertexCount();
+                              counts[2 * i + 1] = meshes[i].TriangleCount();
+                            }
+                          });
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+  }
+}
+
 // Allocate an empty `PartitionedMesh` and return a pointer to it.
 JNI_METHOD(geometry, PartitionedMeshNative, jlong, create)
 (JNIEnv* env, jobject object) { return NewNativePartitionedMesh(); }
@@ -287,6 +403,131 @@ JNI_METHOD(geometry, PartitionedMeshNative, jboolean,
           coverage_threshold, transform);
 }
 
+// The `partitionedMeshes*` methods below answer the same query as the
+// corresponding `partitionedMesh*` method for each mesh in
+// `partitioned_mesh_native_pointers` in a single call, where
+// `query_to_mesh_transforms` holds 6 values (a through f) per mesh. If
+// `parallel` is true, the meshes are queried concurrently on native threads.
+
+JNI_METHOD(geometry, PartitionedMeshNative, jfloatArray,
+           partitionedMeshesTriangleCoverage)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat triangle_p0_x, jfloat triangle_p0_y, jfloat triangle_p1_x,
+ jfloat triangle_p1_y, jfloat triangle_p2_x, jfloat triangle_p2_y,
+ jfloatArray query_to_mesh_transforms, jboolean parallel) {
+  Triangle triangle{{triangle_p0_x, triangle_p0_y},
+                    {triangle_p1_x, triangle_p1_y},
+                    {triangle_p2_x, triangle_p2_y}};
+  return NewJFloatArray(
+      env, QueryPartitionedMeshes<jfloat>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&triangle](const PartitionedMesh& partitioned_mesh,
+                           const AffineTransform& transform) {
+                 return partitioned_mesh.Coverage(triangle, transform);
+               }));
+}
+
+JNI_METHOD(geometry, PartitionedMeshNative, jfloatArray,
+           partitionedMeshesBoxCoverage)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat rect_x_min, jfloat rect_y_min, jfloat rect_x_max, jfloat rect_y_max,
+ jfloatArray query_to_mesh_transforms, jboolean parallel) {
+  Rect rect =
+      Rect::FromTwoPoints({rect_x_min, rect_y_min}, {rect_x_max, rect_y_max});
+  return NewJFloatArray(
+      env, QueryPartitionedMeshes<jfloat>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&rect](const PartitionedMesh& partitioned_mesh,
+                       const AffineTransform& transform) {
+                 return partitioned_mesh.Coverage(rect, transform);
+               }));
+}
+
+JNI_METHOD(geometry, PartitionedMeshNative, jfloatArray,
+           partitionedMeshesParallelogramCoverage)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat quad_center_x, jfloat quad_center_y, jfloat quad_width,
+ jfloat quad_height, jfloat quad_angle_radian, jfloat quad_shear_factor,
+ jfloatArray query_to_mesh_transforms, jboolean parallel) {
+  Quad quad = Quad::FromCenterDimensionsRotationAndSkew(
+      Point{quad_center_x, quad_center_y}, quad_width, quad_height,
+      Angle::Radians(quad_angle_radian), quad_shear_factor);
+  return NewJFloatArray(
+      env, QueryPartitionedMeshes<jfloat>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&quad](const PartitionedMesh& partitioned_mesh,
+                       const AffineTransform& transform) {
+                 return partitioned_mesh.Coverage(quad, transform);
+               }));
+}
+
+JNI_METHOD(geometry, PartitionedMeshNative, jbooleanArray,
+           partitionedMeshesTriangleCoverageIsGreaterThan)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat triangle_p0_x, jfloat triangle_p0_y, jfloat triangle_p1_x,
+ jfloat triangle_p1_y, jfloat triangle_p2_x, jfloat triangle_p2_y,
+ jfloat coverage_threshold, jfloatArray query_to_mesh_transforms,
+ jboolean parallel) {
+  Triangle triangle{{triangle_p0_x, triangle_p0_y},
+                    {triangle_p1_x, triangle_p1_y},
+                    {triangle_p2_x, triangle_p2_y}};
+  return NewJBooleanArray(
+      env, QueryPartitionedMeshes<jboolean>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&triangle, coverage_threshold](
+                   const PartitionedMesh& partitioned_mesh,
+                   const AffineTransform& transform) {
+                 return partitioned_mesh.CoverageIsGreaterThan(
+                     triangle, coverage_threshold, transform);
+               }));
+}
+
+JNI_METHOD(geometry, PartitionedMeshNative, jbooleanArray,
+           partitionedMeshesBoxCoverageIsGreaterThan)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat rect_x_min, jfloat rect_y_min, jfloat rect_x_max, jfloat rect_y_max,
+ jfloat coverage_threshold, jfloatArray query_to_mesh_transforms,
+ jboolean parallel) {
+  Rect rect =
+      Rect::FromTwoPoints({rect_x_min, rect_y_min}, {rect_x_max, rect_y_max});
+  return NewJBooleanArray(
+      env, QueryPartitionedMeshes<jboolean>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&rect, coverage_threshold](
+                   const PartitionedMesh& partitioned_mesh,
+                   const AffineTransform& transform) {
+                 return partitioned_mesh.CoverageIsGreaterThan(
+                     rect, coverage_threshold, transform);
+               }));
+}
+
+JNI_METHOD(geometry, PartitionedMeshNative, jbooleanArray,
+           partitionedMeshesParallelogramCoverageIsGreaterThan)
+(JNIEnv* env, jobject object, jlongArray partitioned_mesh_native_pointers,
+ jfloat quad_center_x, jfloat quad_center_y, jfloat quad_width,
+ jfloat quad_height, jfloat quad_angle_radian, jfloat quad_shear_factor,
+ jfloat coverage_threshold, jfloatArray query_to_mesh_transforms,
+ jboolean parallel) {
+  Quad quad = Quad::FromCenterDimensionsRotationAndSkew(
+      Point{quad_center_x, quad_center_y}, quad_width, quad_height,
+      Angle::Radians(quad_angle_radian), quad_shear_factor);
+  return NewJBooleanArray(
+      env, QueryPartitionedMeshes<jboolean>(
+               env, partitioned_mesh_native_pointers, query_to_mesh_transforms,
+               parallel,
+               [&quad, coverage_threshold](
+                   const PartitionedMesh& partitioned_mesh,
+                   const AffineTransform& transform) {
+                 return partitioned_mesh.CoverageIsGreaterThan(
+                     quad, coverage_threshold, transform);
+               }));
+}
+
 JNI_METHOD(geometry, PartitionedMeshNative, void, initializeSpatialIndex)
 (JNIEnv* env, jobject object, jlong native_pointer) {
   return CastToPartitionedMesh(native_pointer).InitializeSpatialIndex();
@@ -302,4 +543,11 @@ JNI_METHOD(geometry, PartitionedMeshNative, void, free)
   DeleteNativePartitionedMesh(native_pointer);
 }
 
+// Frees each of the Kotlin PartitionedMesh.nativePointer values in
+// `native_pointers` in a single call.
+JNI_METHOD(geometry, PartitionedMeshNative, void, freeAll)
+(JNIEnv* env, jobject object, jlongArray native_pointers) {
+  ForEachNativePointer(env, native_pointers, DeleteNativePartitionedMesh);
+}
+
 }  // extern "C"
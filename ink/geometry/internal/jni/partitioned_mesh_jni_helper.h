@@ -17,15 +17,25 @@
 
 #include <jni.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
 #include "absl/log/absl_check.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/jni/internal/jni_object_pool.h"
+#include "ink/jni/internal/jni_thread_pool.h"
+#include "ink/types/executor.h"
 
 namespace ink::jni {
 
 // Creates a new stack-allocated copy of the `PartitionedMesh` and returns a
 // pointer to it as a jlong, suitable for wrapping in a Kotlin PartitionedMesh.
 inline jlong NewNativePartitionedMesh(const PartitionedMesh& mesh) {
-  return reinterpret_cast<jlong>(new PartitionedMesh(mesh));
+  return reinterpret_cast<jlong>(
+      GetNativeObjectPool<PartitionedMesh>().New(mesh));
 }
 
 // Creates a new stack-allocated empty `PartitionedMesh` and returns a pointer
@@ -45,7 +55,56 @@ inline const PartitionedMesh& CastToPartitionedMesh(jlong native_pointer) {
 // Frees a Kotlin PartitionedMesh.nativePointer.
 inline void DeleteNativePartitionedMesh(jlong native_pointer) {
   if (native_pointer == 0) return;
-  delete reinterpret_cast<PartitionedMesh*>(native_pointer);
+  GetNativeObjectPool<PartitionedMesh>().Delete(
+      reinterpret_cast<PartitionedMesh*>(native_pointer));
+}
+
+// The number of meshes that each task of `QueryPartitionedMeshes()` queries
+// when running in parallel.
+inline constexpr size_t kPartitionedMeshesPerQueryTask = 16;
+
+// Calls `query(mesh, query_to_mesh)` for each Kotlin PartitionedMesh native
+// pointer in `partitioned_mesh_native_pointers`, where
+// `query_to_mesh_transforms` holds 6 values (a through f) per mesh for the
+// transform that maps from the query's coordinate space to that mesh's, and
+// returns the results in the same order. This lets a single JNI call answer a
+// query against a whole batch of strokes, e.g. for lasso selection.
+//
+// If `parallel` is true, the meshes are queried concurrently on
+// `JniThreadPool()`, so `query` must be safe to call concurrently and must not
+// make JNI calls.
+template <typename Result>
+std::vector<Result> QueryPartitionedMeshes(
+    JNIEnv* env, jlongArray partitioned_mesh_native_pointers,
+    jfloatArray query_to_mesh_transforms, bool parallel,
+    absl::FunctionRef<Result(const PartitionedMesh&, const AffineTransform&)>
+        query) {
+  const jsize num_meshes =
+      env->GetArrayLength(partitioned_mesh_native_pointers);
+  ABSL_CHECK_EQ(env->GetArrayLength(query_to_mesh_transforms), 6 * num_meshes);
+  std::vector<jlong> mesh_pointers(num_meshes);
+  env->GetLongArrayRegion(partitioned_mesh_native_pointers, 0, num_meshes,
+                          mesh_pointers.data());
+  std::vector<jfloat> transforms(6 * num_meshes);
+  env->GetFloatArrayRegion(query_to_mesh_transforms, 0, 6 * num_meshes,
+                           transforms.data());
+
+  std::vector<Result> results(num_meshes);
+  size_t n_tasks = (mesh_pointers.size() + kPartitionedMeshesPerQueryTask - 1) /
+                   kPartitionedMeshesPerQueryTask;
+  ParallelFor(parallel ? &JniThreadPool() : nullptr, n_tasks,
+              [&](size_t task_index) {
+                size_t begin = task_index * kPartitionedMeshesPerQueryTask;
+                size_t end = std::min(begin + kPartitionedMeshesPerQueryTask,
+                                      mesh_pointers.size());
+                for (size_t i = begin; i < end; ++i) {
+                  const jfloat* t = &transforms[6 * i];
+                  results[i] = query(
+                      CastToPartitionedMesh(mesh_pointers[i]),
+                      AffineTransform(t[0], t[1], t[2], t[3], t[4], t[5]));
+                }
+              });
+  return results;
 }
 
 }  // namespace ink::jni
@@ -0,0 +1,192 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/internal/mesh_grid_index.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/log/absl_check.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/internal/intersects_internal.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/rect.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+// The most cells that a triangle is stored in. Triangles whose bounds overlap
+// more cells than this are kept in `oversized_triangles_` instead.
+constexpr int64_t kMaxCellsPerTriangle = 64;
+
+// Cell coordinates are clamped to this magnitude, so that computing the size
+// of a cell range can't overflow.
+constexpr float kMaxCellCoordinate = 1 << 30;
+
+int32_t CellCoordinate(float value, float cell_size) {
+  return static_cast<int32_t>(std::clamp(
+      std::floor(value / cell_size), -kMaxCellCoordinate, kMaxCellCoordinate));
+}
+
+}  // namespace
+
+MeshGridIndex::MeshGridIndex(float cell_size) { Reset(cell_size); }
+
+void MeshGridIndex::Reset(float cell_size) {
+  ABSL_CHECK(cell_size > 0 && std::isfinite(cell_size))
+      << "`cell_size` must be positive and finite, got " << cell_size;
+  cell_size_ = cell_size;
+  triangle_bounds_.clear();
+  max_vertex_index_prefix_.clear();
+  cells_.clear();
+  oversized_triangles_.clear();
+}
+
+void MeshGridIndex::Update(const MutableMesh& mesh,
+                           std::optional<uint32_t> first_changed_triangle,
+                           std::optional<uint32_t> first_changed_vertex) {
+  uint32_t unchanged_count = std::min(TriangleCount(), mesh.TriangleCount());
+  if (first_changed_triangle.has_value()) {
+    unchanged_count = std::min(unchanged_count, *first_changed_triangle);
+  }
+  if (first_changed_vertex.has_value()) {
+    // Find the first triangle that refers to a changed vertex.
+    unchanged_count = std::lower_bound(max_vertex_index_prefix_.begin(),
+                                       max_vertex_index_prefix_.begin() +
+                                           unchanged_count,
+                                       *first_changed_vertex) -
+                      max_vertex_index_prefix_.begin();
+  }
+
+  while (TriangleCount() > unchanged_count) PopTriangle();
+
+  triangle_bounds_.reserve(mesh.TriangleCount());
+  max_vertex_index_prefix_.reserve(mesh.TriangleCount());
+  for (uint32_t i = unchanged_count; i < mesh.TriangleCount(); ++i) {
+    std::array<uint32_t, 3> vertices = mesh.TriangleIndices(i);
+    uint32_t max_vertex_index = *std::max_element(vertices.begin(),
+                                                  vertices.end());
+    if (!max_vertex_index_prefix_.empty()) {
+      max_vertex_index =
+          std::max(max_vertex_index, max_vertex_index_prefix_.back());
+    }
+    max_vertex_index_prefix_.push_back(max_vertex_index);
+    AppendTriangle(*Envelope(mesh.GetTriangle(i)).AsRect());
+  }
+}
+
+void MeshGridIndex::VisitTrianglesIntersectingBounds(
+    const Rect& bounds, absl::FunctionRef<bool(uint32_t)> visitor) const {
+  // If the query covers more cells than there are triangles, it's cheaper to
+  // check the bounds of every triangle.
+  std::optional<CellRange> range =
+      GetCellRange(bounds, std::max<int64_t>(TriangleCount(), 1));
+  if (!range.has_value()) {
+    for (uint32_t i = 0; i < TriangleCount(); ++i) {
+      if (IntersectsInternal(bounds, triangle_bounds_[i]) && !visitor(i)) {
+        return;
+      }
+    }
+    return;
+  }
+
+  for (uint32_t i : oversized_triangles_) {
+    if (IntersectsInternal(bounds, triangle_bounds_[i]) && !visitor(i)) return;
+  }
+  for (int32_t x = range->min.first; x <= range->max.first; ++x) {
+    for (int32_t y = range->min.second; y <= range->max.second; ++y) {
+      auto it = cells_.find(Cell{x, y});
+      if (it == cells_.end()) continue;
+      for (uint32_t i : it->second) {
+        const Rect& triangle_bounds = triangle_bounds_[i];
+        if (!IntersectsInternal(bounds, triangle_bounds)) continue;
+        // A triangle that overlaps several cells of the query is only visited
+        // from the cell that holds the minimum corner of the overlap.
+        if (GetCell({std::max(bounds.XMin(), triangle_bounds.XMin()),
+                     std::max(bounds.YMin(), triangle_bounds.YMin())}) !=
+            Cell{x, y}) {
+          continue;
+        }
+        if (!visitor(i)) return;
+      }
+    }
+  }
+}
+
+std::optional<MeshGridIndex::CellRange> MeshGridIndex::GetCellRange(
+    const Rect& bounds, int64_t max_cells) const {
+  if (!std::isfinite(bounds.XMin()) || !std::isfinite(bounds.YMin()) ||
+      !std::isfinite(bounds.XMax()) || !std::isfinite(bounds.YMax())) {
+    return std::nullopt;
+  }
+  CellRange range = {.min = GetCell({bounds.XMin(), bounds.YMin()}),
+                     .max = GetCell({bounds.XMax(), bounds.YMax()})};
+  int64_t cell_count =
+      (static_cast<int64_t>(range.max.first) - range.min.first + 1) *
+      (static_cast<int64_t>(range.max.second) - range.min.second + 1);
+  if (cell_count > max_cells) return std::nullopt;
+  return range;
+}
+
+MeshGridIndex::Cell MeshGridIndex::GetCell(Point point) const {
+  return {CellCoordinate(point.x, cell_size_),
+          CellCoordinate(point.y, cell_size_)};
+}
+
+void MeshGridIndex::AppendTriangle(const Rect& bounds) {
+  uint32_t index = triangle_bounds_.size();
+  triangle_bounds_.push_back(bounds);
+  std::optional<CellRange> range = GetCellRange(bounds, kMaxCellsPerTriangle);
+  if (!range.has_value()) {
+    oversized_triangles_.push_back(index);
+    return;
+  }
+  for (int32_t x = range->min.first; x <= range->max.first; ++x) {
+    for (int32_t y = range->min.second; y <= range->max.second; ++y) {
+      cells_[Cell{x, y}].push_back(index);
+    }
+  }
+}
+
+void MeshGridIndex::PopTriangle() {
+  ABSL_DCHECK(!triangle_bounds_.empty());
+  uint32_t index = triangle_bounds_.size() - 1;
+  std::optional<CellRange> range =
+      GetCellRange(triangle_bounds_.back(), kMaxCellsPerTriangle);
+  triangle_bounds_.pop_back();
+  max_vertex_index_prefix_.pop_back();
+  if (!range.has_value()) {
+    ABSL_DCHECK_EQ(oversized_triangles_.back(), index);
+    oversized_triangles_.pop_back();
+    return;
+  }
+  // The triangle is the last one in each of its cells, since triangles are
+  // added and removed in order. The cells are kept even if they become empty,
+  // since the tail of the mesh is usually re-extruded over the same area.
+  for (int32_t x = range->min.first; x <= range->max.first; ++x) {
+    for (int32_t y = range->min.second; y <= range->max.second; ++y) {
+      std::vector<uint32_t>& cell = cells_.find(Cell{x, y})->second;
+      ABSL_DCHECK_EQ(cell.back(), index);
+      cell.pop_back();
+    }
+  }
+}
+
+}  // namespace ink::geometry_internal
@@ -0,0 +1,155 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_GEOMETRY_INTERNAL_MESH_GRID_INDEX_H_
+#define INK_GEOMETRY_INTERNAL_MESH_GRID_INDEX_H_
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/internal/intersects_internal.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink::geometry_internal {
+
+// A spatial index over the triangles of a `MutableMesh` that is being built
+// incrementally, such as the mesh of an in-progress stroke. Unlike
+// `StaticRTree`, which must be rebuilt from scratch whenever the mesh changes,
+// this can be brought up to date cheaply when triangles are appended to the
+// mesh, or when the end of the mesh is reverted and re-extruded.
+//
+// Each triangle is stored in every cell of a uniform grid that its bounding
+// box overlaps. The grid is sparse, so only cells that contain triangles take
+// up memory. For the index to be efficient, the cell size should be on the
+// order of the size of the mesh's triangles (e.g. the brush size of a stroke);
+// triangles that span many cells are kept in a separate list that is checked
+// by every query.
+//
+// The index only refers to the mesh by triangle index; it is up to the caller
+// to call `Update()` whenever the mesh changes, and to pass the same mesh to
+// the query methods.
+class MeshGridIndex {
+ public:
+  // Constructs an empty index with the given cell size, which must be positive
+  // and finite.
+  explicit MeshGridIndex(float cell_size = 1);
+
+  MeshGridIndex(const MeshGridIndex&) = default;
+  MeshGridIndex(MeshGridIndex&&) = default;
+  MeshGridIndex& operator=(const MeshGridIndex&) = default;
+  MeshGridIndex& operator=(MeshGridIndex&&) = default;
+  ~MeshGridIndex() = default;
+
+  // Removes all triangles from the index and sets its cell size, which must be
+  // positive and finite. This keeps the index's allocations where possible.
+  void Reset(float cell_size);
+
+  // Brings the index up to date with `mesh`. The caller promises that, since
+  // the previous call to `Update()` or `Reset()`, the triangles before
+  // `first_changed_triangle` and the positions of the vertices before
+  // `first_changed_vertex` have not changed, where `std::nullopt` means that
+  // nothing has changed. These are the offsets reported by the
+  // `StrokeShapeBuilder` and `InProgressStroke` for their meshes.
+  //
+  // Indexed triangles from the first one that was changed, or that refers to a
+  // changed vertex, are removed from the index, and the triangles from there to
+  // the end of `mesh` are added, so the cost is proportional to the size of the
+  // changed tail of the mesh.
+  void Update(const MutableMesh& mesh,
+              std::optional<uint32_t> first_changed_triangle,
+              std::optional<uint32_t> first_changed_vertex);
+
+  // Returns the number of triangles in the index, which matches the
+  // `TriangleCount()` of the mesh passed to the last call to `Update()`.
+  uint32_t TriangleCount() const { return triangle_bounds_.size(); }
+
+  // Visits the index of each triangle whose bounding box intersects `bounds`,
+  // once each, in an unspecified order. `visitor` returns whether to continue
+  // the visit.
+  void VisitTrianglesIntersectingBounds(
+      const Rect& bounds, absl::FunctionRef<bool(uint32_t)> visitor) const;
+
+  // Visits the index of each triangle of `mesh` that intersects `query`, as
+  // per `IntersectsInternal`, once each, in an unspecified order. `visitor`
+  // returns whether to continue the visit. `mesh` must be the mesh passed to
+  // the last call to `Update()`, unchanged since then.
+  template <typename QueryType>
+  void VisitIntersectedTriangles(
+      const MutableMesh& mesh, const QueryType& query,
+      absl::FunctionRef<bool(uint32_t)> visitor) const;
+
+ private:
+  using Cell = std::pair<int32_t, int32_t>;
+
+  // The range of cells that a bounding box overlaps, inclusive.
+  struct CellRange {
+    Cell min;
+    Cell max;
+  };
+
+  // Returns the range of cells that `bounds` overlaps, or `std::nullopt` if it
+  // overlaps more than `max_cells`, or has a non-finite coordinate.
+  std::optional<CellRange> GetCellRange(const Rect& bounds,
+                                        int64_t max_cells) const;
+
+  // Returns the cell containing `point`, which must be finite.
+  Cell GetCell(Point point) const;
+
+  // Adds or removes the last triangle to or from the index.
+  void AppendTriangle(const Rect& bounds);
+  void PopTriangle();
+
+  float cell_size_;
+  // The bounding box of each indexed triangle.
+  std::vector<Rect> triangle_bounds_;
+  // For each indexed triangle, the largest vertex index that it refers to, or
+  // that any earlier triangle refers to. This is non-decreasing, so the first
+  // triangle that refers to a vertex at or past a given index can be found by
+  // binary search.
+  std::vector<uint32_t> max_vertex_index_prefix_;
+  // The indices of the triangles in each cell that has held any, in increasing
+  // order.
+  absl::flat_hash_map<Cell, std::vector<uint32_t>> cells_;
+  // The indices of the triangles that overlap too many cells to be stored in
+  // `cells_`, in increasing order.
+  std::vector<uint32_t> oversized_triangles_;
+};
+
+// ---------------------------------------------------------------------------
+//                     Implementation details below
+
+template <typename QueryType>
+void MeshGridIndex::VisitIntersectedTriangles(
+    const MutableMesh& mesh, const QueryType& query,
+    absl::FunctionRef<bool(uint32_t)> visitor) const {
+  VisitTrianglesIntersectingBounds(
+      *Envelope(query).AsRect(), [&mesh, &query, visitor](uint32_t index) {
+        if (!IntersectsInternal(query, mesh.GetTriangle(index))) return true;
+        return visitor(index);
+      });
+}
+
+}  // namespace ink::geometry_internal
+
+#endif  // INK_GEOMETRY_INTERNAL_MESH_GRID_INDEX_H_
@@ -0,0 +1,209 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/internal/mesh_grid_index.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink/geometry/internal/intersects_internal.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAreArray;
+
+std::vector<uint32_t> FindIntersected(const MeshGridIndex& index,
+                                      const MutableMesh& mesh,
+                                      const Rect& query) {
+  std::vector<uint32_t> found;
+  index.VisitIntersectedTriangles(mesh, query, [&found](uint32_t i) {
+    found.push_back(i);
+    return true;
+  });
+  return found;
+}
+
+std::vector<uint32_t> FindIntersectedByBruteForce(const MutableMesh& mesh,
+                                                  const Rect& query) {
+  std::vector<uint32_t> found;
+  for (uint32_t i = 0; i < mesh.TriangleCount(); ++i) {
+    if (IntersectsInternal(query, mesh.GetTriangle(i))) found.push_back(i);
+  }
+  return found;
+}
+
+// Checks the index against a brute-force search over a grid of queries that
+// covers `mesh`.
+void ExpectMatchesBruteForce(const MeshGridIndex& index,
+                             const MutableMesh& mesh) {
+  ASSERT_EQ(index.TriangleCount(), mesh.TriangleCount());
+  for (float x = -2; x < 60; x += 1.5) {
+    for (float y = -3; y < 3; y += 0.75) {
+      Rect query = Rect::FromCenterAndDimensions({x, y}, 0.8, 0.5);
+      EXPECT_THAT(FindIntersected(index, mesh, query),
+                  UnorderedElementsAreArray(
+                      FindIntersectedByBruteForce(mesh, query)))
+          << "x = " << x << ", y = " << y;
+    }
+  }
+}
+
+TEST(MeshGridIndexTest, EmptyIndex) {
+  MeshGridIndex index;
+  MutableMesh mesh;
+  EXPECT_EQ(index.TriangleCount(), 0u);
+  EXPECT_THAT(FindIntersected(index, mesh, Rect::FromTwoPoints({0, 0}, {1, 1})),
+              IsEmpty());
+}
+
+TEST(MeshGridIndexTest, MatchesBruteForceForDifferentCellSizes) {
+  MutableMesh mesh = MakeStraightLineMutableMesh(50);
+  for (float cell_size : {0.01f, 0.5f, 1.f, 3.f, 1000.f}) {
+    MeshGridIndex index(cell_size);
+    index.Update(mesh, 0, 0);
+    ExpectMatchesBruteForce(index, mesh);
+  }
+}
+
+TEST(MeshGridIndexTest, VisitsEachTriangleOnce) {
+  MutableMesh mesh = MakeStraightLineMutableMesh(3);
+  MeshGridIndex index(0.3);
+  index.Update(mesh, 0, 0);
+  // This query overlaps many cells of each triangle.
+  EXPECT_THAT(FindIntersected(index, mesh, Rect::FromTwoPoints({-1, -2},
+                                                                {10, 2})),
+              UnorderedElementsAreArray({0u, 1u, 2u}));
+}
+
+TEST(MeshGridIndexTest, StopsWhenVisitorReturnsFalse) {
+  MutableMesh mesh = MakeStraightLineMutableMesh(10);
+  MeshGridIndex index;
+  index.Update(mesh, 0, 0);
+  int visit_count = 0;
+  index.VisitTrianglesIntersectingBounds(
+      Rect::FromTwoPoints({-1, -2}, {20, 2}), [&visit_count](uint32_t) {
+        ++visit_count;
+        return false;
+      });
+  EXPECT_EQ(visit_count, 1);
+}
+
+TEST(MeshGridIndexTest, UpdateAppendsNewTriangles) {
+  MutableMesh mesh = MakeStraightLineMutableMesh(10);
+  MeshGridIndex index;
+  index.Update(mesh, 0, 0);
+
+  MutableMesh longer_mesh = MakeStraightLineMutableMesh(40);
+  index.Update(longer_mesh, 10, 12);
+  ExpectMatchesBruteForce(index, longer_mesh);
+
+  // Nothing changed.
+  index.Update(longer_mesh, std::nullopt, std::nullopt);
+  ExpectMatchesBruteForce(index, longer_mesh);
+}
+
+TEST(MeshGridIndexTest, UpdateReindexesRevertedTail) {
+  MutableMesh mesh = MakeStraightLineMutableMesh(40);
+  MeshGridIndex index;
+  index.Update(mesh, 0, 0);
+
+  // Revert the last 10 triangles, and extrude them in a different place.
+  mesh.Resize(mesh.VertexCount() - 10, mesh.TriangleCount() - 10);
+  for (uint32_t i = 0; i < 10; ++i) {
+    uint32_t vertex = mesh.VertexCount();
+    mesh.AppendVertex({31.f + i, 2.f});
+    mesh.AppendTriangleIndices({vertex - 2, vertex - 1, vertex});
+  }
+  index.Update(mesh, 30, 32);
+  ExpectMatchesBruteForce(index, mesh);
+
+  // Only remove triangles.
+  mesh.Resize(mesh.VertexCount() - 5, mesh.TriangleCount() - 5);
+  index.Update(mesh, mesh.TriangleCount(), mesh.VertexCount());
+  ExpectMatchesBruteForce(index, mesh);
+}
+
+TEST(MeshGridIndexTest, UpdateReindexesTrianglesWithMovedVertices) {
+  MutableMesh mesh = MakeStraightLineMutableMesh(40);
+  MeshGridIndex index;
+  index.Update(mesh, 0, 0);
+
+  // Moving a vertex changes the earlier triangles that refer to it, even
+  // though no triangle indices changed.
+  mesh.SetVertexPosition(20, {20, 2});
+  index.Update(mesh, std::nullopt, 20);
+  ExpectMatchesBruteForce(index, mesh);
+  EXPECT_THAT(FindIntersected(index, mesh,
+                              Rect::FromCenterAndDimensions({20, 2}, 0.1,
+                                                            0.1)),
+              UnorderedElementsAreArray({18u, 19u, 20u}));
+}
+
+TEST(MeshGridIndexTest, OversizedTriangles) {
+  MutableMesh mesh;
+  mesh.AppendVertex({0, 0});
+  mesh.AppendVertex({100, 0});
+  mesh.AppendVertex({0, 100});
+  mesh.AppendVertex({1, 1});
+  mesh.AppendTriangleIndices({0, 1, 2});
+  mesh.AppendTriangleIndices({0, 3, 2});
+  MeshGridIndex index(0.5);
+  index.Update(mesh, 0, 0);
+  EXPECT_THAT(FindIntersected(index, mesh,
+                              Rect::FromCenterAndDimensions({50, 10}, 1, 1)),
+              ElementsAre(0));
+  EXPECT_THAT(
+      FindIntersected(index, mesh, Rect::FromCenterAndDimensions({0, 0}, 1, 1)),
+      UnorderedElementsAreArray({0u, 1u}));
+
+  mesh.Resize(4, 1);
+  index.Update(mesh, 1, std::nullopt);
+  EXPECT_EQ(index.TriangleCount(), 1u);
+  mesh.Resize(4, 0);
+  index.Update(mesh, 0, std::nullopt);
+  EXPECT_EQ(index.TriangleCount(), 0u);
+}
+
+TEST(MeshGridIndexTest, SegmentQuery) {
+  MutableMesh mesh = MakeStraightLineMutableMesh(10);
+  MeshGridIndex index;
+  index.Update(mesh, 0, 0);
+  std::vector<uint32_t> found;
+  index.VisitIntersectedTriangles(mesh, Segment{{2.5, 1}, {2.5, -2}},
+                                  [&found](uint32_t i) {
+                                    found.push_back(i);
+                                    return true;
+                                  });
+  EXPECT_THAT(found, UnorderedElementsAreArray({1u, 2u}));
+}
+
+TEST(MeshGridIndexDeathTest, InvalidCellSize) {
+  EXPECT_DEATH_IF_SUPPORTED(MeshGridIndex(0), "cell_size");
+  MeshGridIndex index;
+  EXPECT_DEATH_IF_SUPPORTED(index.Reset(-1), "cell_size");
+}
+
+}  // namespace
+}  // namespace ink::geometry_internal
@@ -14,12 +14,16 @@
 
 #include "ink/geometry/internal/mesh_packing.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <optional>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -45,6 +49,63 @@ namespace {
 
 using ComponentCodingParams = MeshAttributeCodingParams::ComponentCodingParams;
 
+// The largest finite value representable by an IEEE 754 half-precision float.
+constexpr float kMaxFiniteHalfFloat = 65504;
+
+// Converts `value` to the bits of the nearest IEEE 754 half-precision float,
+// rounding ties to even. Values too large for a half-float become infinity.
+uint16_t FloatToHalfFloatBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(float));
+  uint16_t sign = (bits >> 16) & 0x8000;
+  uint32_t magnitude = bits & 0x7FFFFFFF;
+
+  // NaN stays NaN, and anything that would round up past the largest finite
+  // half-float becomes infinity.
+  if (magnitude > 0x7F800000) return sign | 0x7E00;
+  if (magnitude >= 0x477FF000) return sign | 0x7C00;
+
+  if (magnitude < 0x38800000) {
+    // The result is a subnormal half-float (or zero). Adding 0.5 shifts the
+    // mantissa bits into place, and lets the FPU do the rounding.
+    float shifted;
+    std::memcpy(&shifted, &magnitude, sizeof(float));
+    shifted += 0.5f;
+    uint32_t shifted_bits;
+    std::memcpy(&shifted_bits, &shifted, sizeof(float));
+    return sign | static_cast<uint16_t>(shifted_bits - 0x3F000000);
+  }
+
+  // Rebias the exponent from 127 to 15, and round the mantissa from 23 to 10
+  // bits, ties to even.
+  uint32_t mantissa_is_odd = (magnitude >> 13) & 1;
+  magnitude = magnitude - 0x38000000 + 0xFFF + mantissa_is_odd;
+  return sign | static_cast<uint16_t>(magnitude >> 13);
+}
+
+// Converts the bits of an IEEE 754 half-precision float to a float; this is
+// exact.
+float HalfFloatBitsToFloat(uint16_t half) {
+  uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  uint32_t exponent = (half >> 10) & 0x1F;
+  uint32_t mantissa = half & 0x3FF;
+  uint32_t bits;
+  if (exponent == 0) {
+    // Zero or subnormal.
+    float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+    std::memcpy(&bits, &magnitude, sizeof(float));
+    bits |= sign;
+  } else if (exponent == 0x1F) {
+    // Infinity or NaN.
+    bits = sign | 0x7F800000 | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  float value;
+  std::memcpy(&value, &bits, sizeof(float));
+  return value;
+}
+
 bool ValuesAreFinite(const SmallArray<float, 4>& values) {
   return absl::c_all_of(values.Values(), ink_internal::IsFinite);
 }
@@ -78,6 +139,16 @@ bool UnpackedFloatValuesAreRepresentable(
     MeshFormat::AttributeType type,
     const MeshAttributeCodingParams& packing_params,
     const SmallArray<float, 4>& unpacked_value) {
+  if (MeshFormat::IsHalfFloatType(type)) {
+    for (int i = 0; i < packing_params.components.Size(); ++i) {
+      float coded =
+          (unpacked_value[i] - packing_params.components[i].offset) /
+          packing_params.components[i].scale;
+      if (!(std::abs(coded) <= kMaxFiniteHalfFloat)) return false;
+    }
+    return true;
+  }
+
   std::optional<SmallArray<uint8_t, 4>> n_bits =
       MeshFormat::PackedBitsPerComponent(type);
   // Any value is valid for an unpacked format.
@@ -295,6 +366,41 @@ void PackFloat4PackedInThreeFloats(
   std::memcpy(packed_bytes.data(), floats.data(), sizeof(float) * 3);
 }
 
+// Packs each component into a 16-bit unsigned integer in native byte order.
+// This is used for both `kFloat2PackedInTwoUnsignedShorts` and
+// `kFloat4PackedInFourUnsignedShorts`.
+void PackFloatsInUnsignedShorts(const MeshAttributeCodingParams& packing_params,
+                                const SmallArray<float, 4>& unpacked_value,
+                                absl::Span<std::byte> packed_bytes) {
+  uint8_t component_count = unpacked_value.Size();
+  std::array<uint16_t, 4> shorts;
+  for (uint8_t i = 0; i < component_count; ++i) {
+    shorts[i] = static_cast<uint16_t>(
+        PackSingleFloat(packing_params.components[i], unpacked_value[i]));
+  }
+  ABSL_DCHECK_EQ(packed_bytes.size(), sizeof(uint16_t) * component_count);
+  std::memcpy(packed_bytes.data(), shorts.data(),
+              sizeof(uint16_t) * component_count);
+}
+
+// Packs each component into a half-precision float in native byte order,
+// after applying the coding params. This is used for both
+// `kFloat2PackedInTwoHalfFloats` and `kFloat4PackedInFourHalfFloats`.
+void PackFloatsInHalfFloats(const MeshAttributeCodingParams& packing_params,
+                            const SmallArray<float, 4>& unpacked_value,
+                            absl::Span<std::byte> packed_bytes) {
+  uint8_t component_count = unpacked_value.Size();
+  std::array<uint16_t, 4> halves;
+  for (uint8_t i = 0; i < component_count; ++i) {
+    const ComponentCodingParams& params = packing_params.components[i];
+    halves[i] = FloatToHalfFloatBits((unpacked_value[i] - params.offset) /
+                                     params.scale);
+  }
+  ABSL_DCHECK_EQ(packed_bytes.size(), sizeof(uint16_t) * component_count);
+  std::memcpy(packed_bytes.data(), halves.data(),
+              sizeof(uint16_t) * component_count);
+}
+
 }  // namespace
 
 uint32_t PackSingleFloat(const ComponentCodingParams& packing_params,
@@ -357,6 +463,14 @@ void PackAttribute(MeshFormat::AttributeType type,
       PackFloat4PackedInThreeFloats(packing_params, unpacked_value,
                                     packed_bytes);
       break;
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+      PackFloatsInUnsignedShorts(packing_params, unpacked_value, packed_bytes);
+      break;
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
+      PackFloatsInHalfFloats(packing_params, unpacked_value, packed_bytes);
+      break;
   }
 }
 
@@ -423,6 +537,120 @@ SmallArray<float, 4> UnpackFloatsFromFloat4Unpacked(
   return unpacked_floats;
 }
 
+// The functions below extract the packed integers of a single attribute value
+// from `packed_bytes`, which must hold at least
+// `MeshFormat::PackedAttributeSize()` bytes for the corresponding type. They
+// take a raw pointer and return a fixed-size array, so that unpacking every
+// vertex of a mesh with `UnpackAttributes()` compiles to a tight loop.
+
+float ReadPackedFloat(const std::byte* absl_nonnull packed_bytes) {
+  float packed_float;
+  std::memcpy(&packed_float, packed_bytes, sizeof(float));
+  return packed_float;
+}
+
+uint32_t ReadPackedFloatAsInteger(const std::byte* absl_nonnull packed_bytes) {
+  return static_cast<uint32_t>(ReadPackedFloat(packed_bytes));
+}
+
+std::array<uint32_t, 1> Float1PackedInOneUnsignedByteIntegers(
+    const std::byte* absl_nonnull packed_bytes) {
+  return {static_cast<uint32_t>(packed_bytes[0])};
+}
+
+std::array<uint32_t, 2> Float2PackedInOneFloatIntegers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t packed = ReadPackedFloatAsInteger(packed_bytes);
+  return {(packed & 0xFFF000) >> 12, packed & 0x000FFF};
+}
+
+std::array<uint32_t, 2> Float2PackedInThreeUnsignedBytes_XY12Integers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t b0 = static_cast<uint32_t>(packed_bytes[0]);
+  uint32_t b1 = static_cast<uint32_t>(packed_bytes[1]);
+  uint32_t b2 = static_cast<uint32_t>(packed_bytes[2]);
+  return {(b0 << 4) + (b1 >> 4), ((b1 & 0x0F) << 8) + b2};
+}
+
+std::array<uint32_t, 3> Float3PackedInFourUnsignedBytes_XYZ10Integers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t b0 = static_cast<uint32_t>(packed_bytes[0]);
+  uint32_t b1 = static_cast<uint32_t>(packed_bytes[1]);
+  uint32_t b2 = static_cast<uint32_t>(packed_bytes[2]);
+  uint32_t b3 = static_cast<uint32_t>(packed_bytes[3]);
+  return {(b0 << 2) + (b1 >> 6), ((b1 & 0x3F) << 4) + (b2 >> 4),
+          ((b2 & 0x0F) << 6) + ((b3 & 0xFC) >> 2)};
+}
+
+std::array<uint32_t, 2> Float2PackedInFourUnsignedBytes_X12_Y20Integers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t b0 = static_cast<uint32_t>(packed_bytes[0]);
+  uint32_t b1 = static_cast<uint32_t>(packed_bytes[1]);
+  uint32_t b2 = static_cast<uint32_t>(packed_bytes[2]);
+  uint32_t b3 = static_cast<uint32_t>(packed_bytes[3]);
+  return {(b0 << 4) + (b1 >> 4), ((b1 & 0xF) << 16) + (b2 << 8) + b3};
+}
+
+std::array<uint32_t, 3> Float3PackedInOneFloatIntegers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t packed = ReadPackedFloatAsInteger(packed_bytes);
+  return {(packed & 0xFF0000) >> 16, (packed & 0x00FF00) >> 8,
+          packed & 0x0000FF};
+}
+
+std::array<uint32_t, 3> Float3PackedInTwoFloatsIntegers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t packed0 = ReadPackedFloatAsInteger(packed_bytes);
+  uint32_t packed1 = ReadPackedFloatAsInteger(packed_bytes + sizeof(float));
+  return {(packed0 & 0xFFFF00) >> 8,
+          (packed0 & 0x0000FF) << 8 | (packed1 & 0xFF0000) >> 16,
+          packed1 & 0x00FFFF};
+}
+
+std::array<uint32_t, 4> Float4PackedInOneFloatIntegers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t packed = ReadPackedFloatAsInteger(packed_bytes);
+  return {(packed & 0xFC0000) >> 18, (packed & 0x03F000) >> 12,
+          (packed & 0x000FC0) >> 6, packed & 0x00003F};
+}
+
+std::array<uint32_t, 4> Float4PackedInTwoFloatsIntegers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t packed0 = ReadPackedFloatAsInteger(packed_bytes);
+  uint32_t packed1 = ReadPackedFloatAsInteger(packed_bytes + sizeof(float));
+  return {(packed0 & 0xFFF000) >> 12, packed0 & 0x000FFF,
+          (packed1 & 0xFFF000) >> 12, packed1 & 0x000FFF};
+}
+
+std::array<uint32_t, 4> Float4PackedInThreeFloatsIntegers(
+    const std::byte* absl_nonnull packed_bytes) {
+  uint32_t packed0 = ReadPackedFloatAsInteger(packed_bytes);
+  uint32_t packed1 = ReadPackedFloatAsInteger(packed_bytes + sizeof(float));
+  uint32_t packed2 = ReadPackedFloatAsInteger(packed_bytes + 2 * sizeof(float));
+  return {(packed0 & 0xFFFFC0) >> 6,
+          (packed0 & 0x00003F) << 12 | (packed1 & 0xFFF000) >> 12,
+          (packed1 & 0x000FFF) << 6 | (packed2 & 0xFC0000) >> 18,
+          packed2 & 0x03FFFF};
+}
+
+// Used for both `kFloat2PackedInTwoUnsignedShorts` and
+// `kFloat4PackedInFourUnsignedShorts`.
+template <size_t kComponentCount>
+std::array<uint32_t, kComponentCount> UnsignedShortsIntegers(
+    const std::byte* absl_nonnull packed_bytes) {
+  std::array<uint16_t, kComponentCount> shorts;
+  std::memcpy(shorts.data(), packed_bytes, sizeof(shorts));
+  std::array<uint32_t, kComponentCount> packed_integers;
+  for (size_t i = 0; i < kComponentCount; ++i) packed_integers[i] = shorts[i];
+  return packed_integers;
+}
+
+template <size_t kComponentCount>
+SmallArray<uint32_t, 4> ToSmallArray(
+    const std::array<uint32_t, kComponentCount>& values) {
+  return SmallArray<uint32_t, 4>(absl::MakeConstSpan(values));
+}
+
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat1PackedInOneUnsignedByte(
     absl::Span<const std::byte> packed_value) {
   ABSL_DCHECK_EQ(
@@ -434,23 +662,18 @@ SmallArray<uint32_t, 4> UnpackIntegersFromFloat1PackedInOneUnsignedByte(
                   MeshFormat::AttributeType::kFloat1PackedInOneUnsignedByte)
                   .value_or(SmallArray<uint8_t, 4>({0})) ==
               (SmallArray<uint8_t, 4>({8})));
-  return {static_cast<uint32_t>(packed_value[0])};
+  return ToSmallArray(
+      Float1PackedInOneUnsignedByteIntegers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat2PackedInOneFloat(
     absl::Span<const std::byte> packed_value) {
   ABSL_DCHECK_EQ(packed_value.size(), sizeof(float));
-  float packed_float;
-  std::memcpy(&packed_float, packed_value.data(), sizeof(float));
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_float) & 0xFFF000) >> 12;
-  uint32_t packed1 = (static_cast<uint32_t>(packed_float) & 0x000FFF);
-
   ABSL_DCHECK(MeshFormat::PackedBitsPerComponent(
                   MeshFormat::AttributeType::kFloat2PackedInOneFloat)
                   .value_or(SmallArray<uint8_t, 4>({0, 0})) ==
               (SmallArray<uint8_t, 4>({12, 12})));
-  return {packed0, packed1};
+  return ToSmallArray(Float2PackedInOneFloatIntegers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat2PackedInThreeUnsignedBytes_XY12(
@@ -459,19 +682,13 @@ SmallArray<uint32_t, 4> UnpackIntegersFromFloat2PackedInThreeUnsignedBytes_XY12(
       packed_value.size(),
       MeshFormat::PackedAttributeSize(
           MeshFormat::AttributeType::kFloat2PackedInThreeUnsignedBytes_XY12));
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_value[0]) << 4) +
-                     (static_cast<uint32_t>(packed_value[1]) >> 4);
-
-  uint32_t packed1 = ((static_cast<uint32_t>(packed_value[1]) & 0x0F) << 8) +
-                     (static_cast<uint32_t>(packed_value[2]));
-
   ABSL_DCHECK(
       MeshFormat::PackedBitsPerComponent(
           MeshFormat::AttributeType::kFloat2PackedInThreeUnsignedBytes_XY12)
           .value_or(SmallArray<uint8_t, 4>({0, 0})) ==
       (SmallArray<uint8_t, 4>({12, 12})));
-  return {packed0, packed1};
+  return ToSmallArray(
+      Float2PackedInThreeUnsignedBytes_XY12Integers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat3PackedInFourUnsignedBytes_XYZ10(
@@ -480,22 +697,13 @@ SmallArray<uint32_t, 4> UnpackIntegersFromFloat3PackedInFourUnsignedBytes_XYZ10(
       packed_value.size(),
       MeshFormat::PackedAttributeSize(
           MeshFormat::AttributeType::kFloat3PackedInFourUnsignedBytes_XYZ10));
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_value[0]) << 2) +
-                     (static_cast<uint32_t>(packed_value[1]) >> 6);
-
-  uint32_t packed1 = ((static_cast<uint32_t>(packed_value[1]) & 0x3F) << 4) +
-                     (static_cast<uint32_t>(packed_value[2]) >> 4);
-
-  uint32_t packed2 = ((static_cast<uint32_t>(packed_value[2]) & 0x0F) << 6) +
-                     ((static_cast<uint32_t>(packed_value[3]) & 0xFC) >> 2);
-
   ABSL_DCHECK(
       MeshFormat::PackedBitsPerComponent(
           MeshFormat::AttributeType::kFloat3PackedInFourUnsignedBytes_XYZ10)
           .value_or(SmallArray<uint8_t, 4>({0, 0, 0})) ==
       (SmallArray<uint8_t, 4>({10, 10, 10})));
-  return {packed0, packed1, packed2};
+  return ToSmallArray(
+      Float3PackedInFourUnsignedBytes_XYZ10Integers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4>
@@ -505,108 +713,241 @@ UnpackIntegersFromFloat2PackedInFourUnsignedBytes_X12_Y20(
       packed_value.size(),
       MeshFormat::PackedAttributeSize(
           MeshFormat::AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20));
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_value[0]) << 4) +
-                     (static_cast<uint32_t>(packed_value[1]) >> 4);
-
-  uint32_t packed1 = ((static_cast<uint32_t>(packed_value[1]) & 0xF) << 16) +
-                     (static_cast<uint32_t>(packed_value[2]) << 8) +
-                     (static_cast<uint32_t>(packed_value[3]));
-
   ABSL_DCHECK(
       MeshFormat::PackedBitsPerComponent(
           MeshFormat::AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20)
           .value_or(SmallArray<uint8_t, 4>({0, 0})) ==
       (SmallArray<uint8_t, 4>({12, 20})));
-  return {packed0, packed1};
+  return ToSmallArray(
+      Float2PackedInFourUnsignedBytes_X12_Y20Integers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat3PackedInOneFloat(
     absl::Span<const std::byte> packed_value) {
   ABSL_DCHECK_EQ(packed_value.size(), sizeof(float));
-  float packed_float;
-  std::memcpy(&packed_float, packed_value.data(), sizeof(float));
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_float) & 0xFF0000) >> 16;
-  uint32_t packed1 = (static_cast<uint32_t>(packed_float) & 0x00FF00) >> 8;
-  uint32_t packed2 = (static_cast<uint32_t>(packed_float) & 0x0000FF);
-
   ABSL_DCHECK(MeshFormat::PackedBitsPerComponent(
                   MeshFormat::AttributeType::kFloat3PackedInOneFloat)
                   .value_or(SmallArray<uint8_t, 4>({0, 0, 0})) ==
               (SmallArray<uint8_t, 4>({8, 8, 8})));
-  return {packed0, packed1, packed2};
+  return ToSmallArray(Float3PackedInOneFloatIntegers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat3PackedInTwoFloats(
     absl::Span<const std::byte> packed_value) {
   ABSL_DCHECK_EQ(packed_value.size(), sizeof(float) * 2);
-  std::array<float, 2> packed_floats;
-  std::memcpy(&packed_floats, packed_value.data(), sizeof(float) * 2);
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_floats[0]) & 0xFFFF00) >> 8;
-  uint32_t packed1 = (static_cast<uint32_t>(packed_floats[0]) & 0x0000FF) << 8 |
-                     (static_cast<uint32_t>(packed_floats[1]) & 0xFF0000) >> 16;
-  uint32_t packed2 = (static_cast<uint32_t>(packed_floats[1]) & 0x00FFFF);
   ABSL_DCHECK(MeshFormat::PackedBitsPerComponent(
                   MeshFormat::AttributeType::kFloat3PackedInTwoFloats)
                   .value_or(SmallArray<uint8_t, 4>({0, 0, 0})) ==
               (SmallArray<uint8_t, 4>({16, 16, 16})));
-  return {packed0, packed1, packed2};
+  return ToSmallArray(Float3PackedInTwoFloatsIntegers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat4PackedInOneFloat(
     absl::Span<const std::byte> packed_value) {
   ABSL_DCHECK_EQ(packed_value.size(), sizeof(float));
-  float packed_float;
-  std::memcpy(&packed_float, packed_value.data(), sizeof(float));
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_float) & 0xFC0000) >> 18;
-  uint32_t packed1 = (static_cast<uint32_t>(packed_float) & 0x03F000) >> 12;
-  uint32_t packed2 = (static_cast<uint32_t>(packed_float) & 0x000FC0) >> 6;
-  uint32_t packed3 = (static_cast<uint32_t>(packed_float) & 0x00003F);
   ABSL_DCHECK(MeshFormat::PackedBitsPerComponent(
                   MeshFormat::AttributeType::kFloat4PackedInOneFloat)
                   .value_or(SmallArray<uint8_t, 4>({0, 0, 0, 0})) ==
               (SmallArray<uint8_t, 4>({6, 6, 6, 6})));
-  return {packed0, packed1, packed2, packed3};
+  return ToSmallArray(Float4PackedInOneFloatIntegers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat4PackedInTwoFloats(
     absl::Span<const std::byte> packed_value) {
   ABSL_DCHECK_EQ(packed_value.size(), sizeof(float) * 2);
-  std::array<float, 2> packed_floats;
-  std::memcpy(&packed_floats, packed_value.data(), sizeof(float) * 2);
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_floats[0]) & 0xFFF000) >> 12;
-  uint32_t packed1 = (static_cast<uint32_t>(packed_floats[0]) & 0x000FFF);
-  uint32_t packed2 = (static_cast<uint32_t>(packed_floats[1]) & 0xFFF000) >> 12;
-  uint32_t packed3 = (static_cast<uint32_t>(packed_floats[1]) & 0x000FFF);
   ABSL_DCHECK(MeshFormat::PackedBitsPerComponent(
                   MeshFormat::AttributeType::kFloat4PackedInTwoFloats)
                   .value_or(SmallArray<uint8_t, 4>({0, 0, 0, 0})) ==
               (SmallArray<uint8_t, 4>({12, 12, 12, 12})));
-  return {packed0, packed1, packed2, packed3};
+  return ToSmallArray(Float4PackedInTwoFloatsIntegers(packed_value.data()));
 }
 
 SmallArray<uint32_t, 4> UnpackIntegersFromFloat4PackedInThreeFloats(
     absl::Span<const std::byte> packed_value) {
   ABSL_DCHECK_EQ(packed_value.size(), sizeof(float) * 3);
-  std::array<float, 3> packed_floats;
-  std::memcpy(&packed_floats, packed_value.data(), sizeof(float) * 3);
-
-  uint32_t packed0 = (static_cast<uint32_t>(packed_floats[0]) & 0xFFFFC0) >> 6;
-  uint32_t packed1 = (static_cast<uint32_t>(packed_floats[0]) & 0x00003F)
-                         << 12 |
-                     (static_cast<uint32_t>(packed_floats[1]) & 0xFFF000) >> 12;
-  uint32_t packed2 = (static_cast<uint32_t>(packed_floats[1]) & 0x000FFF) << 6 |
-                     (static_cast<uint32_t>(packed_floats[2]) & 0xFC0000) >> 18;
-  uint32_t packed3 = (static_cast<uint32_t>(packed_floats[2]) & 0x03FFFF);
   ABSL_DCHECK(MeshFormat::PackedBitsPerComponent(
                   MeshFormat::AttributeType::kFloat4PackedInThreeFloats)
                   .value_or(SmallArray<uint8_t, 4>({0, 0, 0, 0})) ==
               (SmallArray<uint8_t, 4>({18, 18, 18, 18})));
-  return {packed0, packed1, packed2, packed3};
+  return ToSmallArray(Float4PackedInThreeFloatsIntegers(packed_value.data()));
+}
+
+// Used for both `kFloat2PackedInTwoUnsignedShorts` and
+// `kFloat4PackedInFourUnsignedShorts`.
+SmallArray<uint32_t, 4> UnpackIntegersFromUnsignedShorts(
+    uint8_t component_count, absl::Span<const std::byte> packed_value) {
+  ABSL_DCHECK_EQ(packed_value.size(), sizeof(uint16_t) * component_count);
+  if (component_count == 2) {
+    return ToSmallArray(UnsignedShortsIntegers<2>(packed_value.data()));
+  }
+  ABSL_DCHECK_EQ(component_count, 4);
+  return ToSmallArray(UnsignedShortsIntegers<4>(packed_value.data()));
+}
+
+// Used for both `kFloat2PackedInTwoHalfFloats` and
+// `kFloat4PackedInFourHalfFloats`.
+SmallArray<float, 4> UnpackFloatsFromHalfFloats(
+    const MeshAttributeCodingParams& unpacking_params,
+    absl::Span<const std::byte> packed_value) {
+  uint8_t component_count = unpacking_params.components.Size();
+  ABSL_DCHECK_EQ(packed_value.size(), sizeof(uint16_t) * component_count);
+  std::array<uint16_t, 4> halves;
+  std::memcpy(halves.data(), packed_value.data(),
+              sizeof(uint16_t) * component_count);
+  SmallArray<float, 4> unpacked(component_count);
+  for (uint8_t i = 0; i < component_count; ++i) {
+    const ComponentCodingParams& params = unpacking_params.components[i];
+    unpacked[i] =
+        HalfFloatBitsToFloat(halves[i]) * params.scale + params.offset;
+  }
+  return unpacked;
+}
+
+// Calls `emit(vertex_index, unpack_vertex(attribute_bytes))` for each vertex
+// in `vertex_data`, where `attribute_bytes` points to the attribute at
+// `attribute_offset` in that vertex.
+template <typename UnpackVertex, typename Emit>
+void UnpackEachVertex(absl::Span<const std::byte> vertex_data,
+                      uint32_t vertex_stride, uint32_t attribute_offset,
+                      UnpackVertex unpack_vertex, Emit emit) {
+  uint32_t vertex_count = vertex_data.size() / vertex_stride;
+  const std::byte* attribute_bytes = vertex_data.data() + attribute_offset;
+  for (uint32_t i = 0; i < vertex_count; ++i) {
+    emit(i, unpack_vertex(attribute_bytes + i * vertex_stride));
+  }
+}
+
+// Unpacks an attribute of a packed type from each vertex, given the function
+// that extracts its packed integers. The scales and offsets are read once,
+// rather than once per vertex, and the per-vertex work has no branches on the
+// attribute type, so that the compiler can vectorize it.
+template <size_t kComponentCount, bool kIsHalfFloatType,
+          typename ExtractIntegers, typename Emit>
+void UnpackEachPackedVertex(const MeshAttributeCodingParams& unpacking_params,
+                            absl::Span<const std::byte> vertex_data,
+                            uint32_t vertex_stride, uint32_t attribute_offset,
+                            ExtractIntegers extract_integers, Emit emit) {
+  ABSL_DCHECK_EQ(unpacking_params.components.Size(), kComponentCount);
+  std::array<float, kComponentCount> scales;
+  std::array<float, kComponentCount> offsets;
+  for (size_t i = 0; i < kComponentCount; ++i) {
+    scales[i] = unpacking_params.components[i].scale;
+    offsets[i] = unpacking_params.components[i].offset;
+  }
+  UnpackEachVertex(
+      vertex_data, vertex_stride, attribute_offset,
+      [&](const std::byte* packed_bytes) {
+        std::array<uint32_t, kComponentCount> packed_integers =
+            extract_integers(packed_bytes);
+        std::array<float, kComponentCount> unpacked;
+        for (size_t i = 0; i < kComponentCount; ++i) {
+          float value;
+          if constexpr (kIsHalfFloatType) {
+            value = HalfFloatBitsToFloat(
+                static_cast<uint16_t>(packed_integers[i]));
+          } else {
+            value = packed_integers[i];
+          }
+          unpacked[i] = value * scales[i] + offsets[i];
+        }
+        return unpacked;
+      },
+      emit);
+}
+
+template <size_t kComponentCount, typename Emit>
+void ReadEachUnpackedVertex(absl::Span<const std::byte> vertex_data,
+                            uint32_t vertex_stride, uint32_t attribute_offset,
+                            Emit emit) {
+  UnpackEachVertex(vertex_data, vertex_stride, attribute_offset,
+                   [](const std::byte* packed_bytes) {
+                     std::array<float, kComponentCount> unpacked;
+                     std::memcpy(unpacked.data(), packed_bytes,
+                                 sizeof(unpacked));
+                     return unpacked;
+                   },
+                   emit);
+}
+
+// Calls `emit(vertex_index, unpacked_value)` with the unpacked value of the
+// attribute of `type` at `attribute_offset` for each vertex in `vertex_data`,
+// where `unpacked_value` is a `std::array<float, N>` and N is the component
+// count of `type`.
+template <typename Emit>
+void UnpackEachAttribute(MeshFormat::AttributeType type,
+                         const MeshAttributeCodingParams& unpacking_params,
+                         absl::Span<const std::byte> vertex_data,
+                         uint32_t vertex_stride, uint32_t attribute_offset,
+                         Emit emit) {
+  ABSL_DCHECK(IsValidCodingParams(type, unpacking_params))
+      << "Invalid unpacking params";
+  ABSL_DCHECK_GT(vertex_stride, 0);
+  ABSL_DCHECK_EQ(vertex_data.size() % vertex_stride, 0);
+  ABSL_DCHECK_LE(attribute_offset + MeshFormat::PackedAttributeSize(type),
+                 vertex_stride);
+  const MeshAttributeCodingParams& params = unpacking_params;
+  absl::Span<const std::byte> data = vertex_data;
+  uint32_t stride = vertex_stride;
+  uint32_t offset = attribute_offset;
+  switch (type) {
+    case MeshFormat::AttributeType::kFloat1Unpacked:
+      return ReadEachUnpackedVertex<1>(data, stride, offset, emit);
+    case MeshFormat::AttributeType::kFloat2Unpacked:
+      return ReadEachUnpackedVertex<2>(data, stride, offset, emit);
+    case MeshFormat::AttributeType::kFloat3Unpacked:
+      return ReadEachUnpackedVertex<3>(data, stride, offset, emit);
+    case MeshFormat::AttributeType::kFloat4Unpacked:
+      return ReadEachUnpackedVertex<4>(data, stride, offset, emit);
+    case MeshFormat::AttributeType::kFloat1PackedInOneUnsignedByte:
+      return UnpackEachPackedVertex<1, false>(
+          params, data, stride, offset, Float1PackedInOneUnsignedByteIntegers,
+          emit);
+    case MeshFormat::AttributeType::kFloat2PackedInOneFloat:
+      return UnpackEachPackedVertex<2, false>(
+          params, data, stride, offset, Float2PackedInOneFloatIntegers, emit);
+    case MeshFormat::AttributeType::kFloat2PackedInThreeUnsignedBytes_XY12:
+      return UnpackEachPackedVertex<2, false>(
+          params, data, stride, offset,
+          Float2PackedInThreeUnsignedBytes_XY12Integers, emit);
+    case MeshFormat::AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20:
+      return UnpackEachPackedVertex<2, false>(
+          params, data, stride, offset,
+          Float2PackedInFourUnsignedBytes_X12_Y20Integers, emit);
+    case MeshFormat::AttributeType::kFloat3PackedInOneFloat:
+      return UnpackEachPackedVertex<3, false>(
+          params, data, stride, offset, Float3PackedInOneFloatIntegers, emit);
+    case MeshFormat::AttributeType::kFloat3PackedInTwoFloats:
+      return UnpackEachPackedVertex<3, false>(
+          params, data, stride, offset, Float3PackedInTwoFloatsIntegers, emit);
+    case MeshFormat::AttributeType::kFloat3PackedInFourUnsignedBytes_XYZ10:
+      return UnpackEachPackedVertex<3, false>(
+          params, data, stride, offset,
+          Float3PackedInFourUnsignedBytes_XYZ10Integers, emit);
+    case MeshFormat::AttributeType::kFloat4PackedInOneFloat:
+      return UnpackEachPackedVertex<4, false>(
+          params, data, stride, offset, Float4PackedInOneFloatIntegers, emit);
+    case MeshFormat::AttributeType::kFloat4PackedInTwoFloats:
+      return UnpackEachPackedVertex<4, false>(
+          params, data, stride, offset, Float4PackedInTwoFloatsIntegers, emit);
+    case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
+      return UnpackEachPackedVertex<4, false>(
+          params, data, stride, offset, Float4PackedInThreeFloatsIntegers,
+          emit);
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+      return UnpackEachPackedVertex<2, false>(
+          params, data, stride, offset, UnsignedShortsIntegers<2>, emit);
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+      return UnpackEachPackedVertex<4, false>(
+          params, data, stride, offset, UnsignedShortsIntegers<4>, emit);
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+      return UnpackEachPackedVertex<2, true>(
+          params, data, stride, offset, UnsignedShortsIntegers<2>, emit);
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
+      return UnpackEachPackedVertex<4, true>(
+          params, data, stride, offset, UnsignedShortsIntegers<4>, emit);
+  }
+  ABSL_LOG(FATAL) << "Unrecognized AttributeType: "
+                  << static_cast<uint8_t>(type);
 }
 
 }  // namespace
@@ -627,11 +968,15 @@ SmallArray<float, 4> UnpackAttribute(
     return ReadFloatsFromUnpackedAttribute(type, packed_value);
   }
 
+  ABSL_DCHECK_EQ(unpacking_params.components.Size(), num_components);
+  if (MeshFormat::IsHalfFloatType(type)) {
+    return UnpackFloatsFromHalfFloats(unpacking_params, packed_value);
+  }
+
   SmallArray<uint32_t, 4> packed_integers =
       UnpackIntegersFromPackedAttribute(type, packed_value);
   ABSL_DCHECK_EQ(packed_integers.Size(), num_components);
   SmallArray<float, 4> unpacked(num_components);
-  ABSL_DCHECK_EQ(unpacking_params.components.Size(), num_components);
   for (uint8_t i = 0; i < num_components; ++i) {
     unpacked[i] =
         UnpackSingleFloat(unpacking_params.components[i], packed_integers[i]);
@@ -639,6 +984,44 @@ SmallArray<float, 4> UnpackAttribute(
   return unpacked;
 }
 
+void UnpackAttributes(MeshFormat::AttributeType type,
+                      const MeshAttributeCodingParams& unpacking_params,
+                      absl::Span<const std::byte> vertex_data,
+                      uint32_t vertex_stride, uint32_t attribute_offset,
+                      absl::Span<float> unpacked_values) {
+  uint8_t num_components = MeshFormat::ComponentCount(type);
+  ABSL_DCHECK_EQ(unpacked_values.size() * vertex_stride,
+                 vertex_data.size() * num_components);
+  float* out = unpacked_values.data();
+  UnpackEachAttribute(
+      type, unpacking_params, vertex_data, vertex_stride, attribute_offset,
+      [out](uint32_t vertex_index, const auto& unpacked) {
+        constexpr size_t kComponentCount = std::tuple_size_v<
+            std::remove_cvref_t<decltype(unpacked)>>;
+        for (size_t i = 0; i < kComponentCount; ++i) {
+          out[vertex_index * kComponentCount + i] = unpacked[i];
+        }
+      });
+}
+
+void UnpackPositions(MeshFormat::AttributeType type,
+                     const MeshAttributeCodingParams& unpacking_params,
+                     absl::Span<const std::byte> vertex_data,
+                     uint32_t vertex_stride, uint32_t attribute_offset,
+                     absl::Span<Point> positions) {
+  ABSL_DCHECK_EQ(MeshFormat::ComponentCount(type), 2);
+  ABSL_DCHECK_EQ(positions.size() * vertex_stride, vertex_data.size());
+  Point* out = positions.data();
+  UnpackEachAttribute(
+      type, unpacking_params, vertex_data, vertex_stride, attribute_offset,
+      [out](uint32_t vertex_index, const auto& unpacked) {
+        if constexpr (std::tuple_size_v<
+                          std::remove_cvref_t<decltype(unpacked)>> == 2) {
+          out[vertex_index] = {unpacked[0], unpacked[1]};
+        }
+      });
+}
+
 SmallArray<uint32_t, 4> UnpackIntegersFromPackedAttribute(
     MeshFormat::AttributeType type, absl::Span<const std::byte> packed_value) {
   ABSL_DCHECK(PackedFloatValuesAreFinite(type, packed_value));
@@ -668,10 +1051,16 @@ SmallArray<uint32_t, 4> UnpackIntegersFromPackedAttribute(
       return UnpackIntegersFromFloat4PackedInTwoFloats(packed_value);
     case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
       return UnpackIntegersFromFloat4PackedInThreeFloats(packed_value);
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+      return UnpackIntegersFromUnsignedShorts(2, packed_value);
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+      return UnpackIntegersFromUnsignedShorts(4, packed_value);
     case MeshFormat::AttributeType::kFloat1Unpacked:
     case MeshFormat::AttributeType::kFloat2Unpacked:
     case MeshFormat::AttributeType::kFloat3Unpacked:
     case MeshFormat::AttributeType::kFloat4Unpacked:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
       break;
   }
   ABSL_LOG(FATAL) << "Non-packed AttributeType: " << static_cast<uint8_t>(type);
@@ -698,6 +1087,10 @@ SmallArray<float, 4> ReadFloatsFromUnpackedAttribute(
     case MeshFormat::AttributeType::kFloat4PackedInOneFloat:
     case MeshFormat::AttributeType::kFloat4PackedInTwoFloats:
     case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
       break;
   }
   ABSL_LOG(FATAL) << "Packed AttributeType: " << static_cast<uint8_t>(type);
@@ -724,7 +1117,7 @@ std::array<uint32_t, 3> ReadTriangleIndicesFromByteArray(
 void WriteTriangleIndicesToByteArray(uint32_t triangle_index,
                                      uint8_t index_stride,
                                      absl::Span<const uint32_t> vertex_indices,
-                                     std::vector<std::byte>& index_data) {
+                                     absl::Span<std::byte> index_data) {
   ABSL_DCHECK_EQ(vertex_indices.size(), 3);
   ABSL_DCHECK_EQ(index_data.size() % (3 * index_stride), 0);
   size_t offset = triangle_index * size_t{3} * index_stride;
@@ -740,6 +1133,14 @@ void WriteTriangleIndicesToByteArray(uint32_t triangle_index,
   }
 }
 
+void WriteTriangleIndicesToByteArray(uint32_t triangle_index,
+                                     uint8_t index_stride,
+                                     absl::Span<const uint32_t> vertex_indices,
+                                     std::vector<std::byte>& index_data) {
+  WriteTriangleIndicesToByteArray(triangle_index, index_stride, vertex_indices,
+                                  absl::MakeSpan(index_data));
+}
+
 namespace {
 
 float UnalignedLoadFloat(const std::byte* absl_nonnull bytes) {
@@ -769,6 +1170,8 @@ SmallArray<float, 4> ReadUnpackedFloatAttributeFromByteArray(
     case MeshFormat::AttributeType::kFloat2PackedInOneFloat:
     case MeshFormat::AttributeType::kFloat2PackedInThreeUnsignedBytes_XY12:
     case MeshFormat::AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
       return {UnalignedLoadFloat(src), UnalignedLoadFloat(src + sizeof(float))};
     case MeshFormat::AttributeType::kFloat3Unpacked:
     case MeshFormat::AttributeType::kFloat3PackedInOneFloat:
@@ -783,6 +1186,8 @@ SmallArray<float, 4> ReadUnpackedFloatAttributeFromByteArray(
     case MeshFormat::AttributeType::kFloat4PackedInOneFloat:
     case MeshFormat::AttributeType::kFloat4PackedInTwoFloats:
     case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
       return {
           UnalignedLoadFloat(src),
           UnalignedLoadFloat(src + sizeof(float)),
@@ -795,7 +1200,8 @@ SmallArray<float, 4> ReadUnpackedFloatAttributeFromByteArray(
 
 absl::InlinedVector<PartitionInfo, 1> PartitionTriangles(
     absl::Span<const std::byte> index_data,
-    MeshFormat::IndexFormat index_format, uint64_t max_vertices_per_partition) {
+    MeshFormat::IndexFormat index_format, uint64_t max_vertices_per_partition,
+    absl::Span<const uint32_t> vertex_map) {
   uint8_t index_stride = MeshFormat::UnpackedIndexSize(index_format);
   ABSL_DCHECK(index_stride == 2 || index_stride == 4);
   ABSL_DCHECK_EQ(index_data.size() % (3 * index_stride), 0);
@@ -815,6 +1221,9 @@ absl::InlinedVector<PartitionInfo, 1> PartitionTriangles(
   for (uint32_t tri_idx = 0; tri_idx < n_tris; ++tri_idx) {
     std::array<uint32_t, 3> mesh_tri =
         ReadTriangleIndicesFromByteArray(tri_idx, index_stride, index_data);
+    if (!vertex_map.empty()) {
+      for (uint32_t& index : mesh_tri) index = vertex_map[index];
+    }
 
     // Check if this triangle would put us over the maximum number of vertices
     // for this partition.
@@ -848,6 +1257,186 @@ absl::InlinedVector<PartitionInfo, 1> PartitionTriangles(
   return partitions;
 }
 
+namespace {
+
+// The size of the simulated vertex cache used to score vertices in
+// `OptimizePartitionForVertexCache`, and the tuning parameters for the score;
+// these are the values suggested by Forsyth.
+constexpr int kVertexCacheSize = 32;
+constexpr float kCacheDecayPower = 1.5;
+constexpr float kLastTriangleScore = 0.75;
+constexpr float kValenceBoostScale = 2;
+
+// Returns the score of a vertex with the given position in the simulated cache
+// (or -1 if it is not in the cache), that is used by
+// `remaining_triangle_count` triangles that have not yet been emitted.
+float VertexCacheScore(int cache_position, uint32_t remaining_triangle_count) {
+  // A vertex that isn't used by any remaining triangle has no effect on which
+  // triangle is emitted next.
+  if (remaining_triangle_count == 0) return -1;
+
+  float score = 0;
+  if (cache_position >= 0) {
+    if (cache_position < 3) {
+      // The vertex was used by the last triangle; this is given a fixed score,
+      // so that the next triangle isn't biased toward any one of its edges.
+      score = kLastTriangleScore;
+    } else {
+      float scaled_position = 1 - static_cast<float>(cache_position - 3) /
+                                      (kVertexCacheSize - 3);
+      score = std::pow(scaled_position, kCacheDecayPower);
+    }
+  }
+  // Boost vertices with few remaining triangles, so that they get finished off
+  // instead of leaving isolated triangles behind.
+  return score + kValenceBoostScale /
+                     std::sqrt(static_cast<float>(remaining_triangle_count));
+}
+
+}  // namespace
+
+void OptimizePartitionForVertexCache(PartitionInfo& partition) {
+  const uint32_t n_vertices = partition.vertex_indices.size();
+  const uint32_t n_triangles = partition.triangles.size();
+  if (n_triangles == 0) return;
+
+  // Build the vertex-to-triangle adjacency. The triangles adjacent to vertex
+  // `v` are stored in `adjacent_triangles`, starting at `adjacency_offsets[v]`;
+  // the first `remaining_triangle_counts[v]` of those are the ones that have
+  // not yet been emitted.
+  std::vector<uint32_t> adjacency_offsets(n_vertices + 1, 0);
+  for (const std::array<uint32_t, 3>& triangle : partition.triangles) {
+    for (uint32_t v : triangle) {
+      ABSL_DCHECK_LT(v, n_vertices);
+      ++adjacency_offsets[v + 1];
+    }
+  }
+  for (uint32_t v = 0; v < n_vertices; ++v) {
+    adjacency_offsets[v + 1] += adjacency_offsets[v];
+  }
+  std::vector<uint32_t> adjacent_triangles(3 * n_triangles);
+  std::vector<uint32_t> remaining_triangle_counts(n_vertices, 0);
+  for (uint32_t t = 0; t < n_triangles; ++t) {
+    for (uint32_t v : partition.triangles[t]) {
+      uint32_t& count = remaining_triangle_counts[v];
+      adjacent_triangles[adjacency_offsets[v] + count++] = t;
+    }
+  }
+
+  std::vector<int> cache_positions(n_vertices, -1);
+  std::vector<float> vertex_scores(n_vertices);
+  for (uint32_t v = 0; v < n_vertices; ++v) {
+    vertex_scores[v] = VertexCacheScore(-1, remaining_triangle_counts[v]);
+  }
+  std::vector<bool> is_emitted(n_triangles, false);
+  std::vector<std::array<uint32_t, 3>> optimized_triangles;
+  optimized_triangles.reserve(n_triangles);
+
+  // The simulated cache holds the vertices of the last emitted triangle, plus
+  // up to `kVertexCacheSize` others, most recently used first.
+  std::array<uint32_t, kVertexCacheSize + 3> cache;
+  std::array<uint32_t, kVertexCacheSize + 3> next_cache;
+  int cache_size = 0;
+
+  // When there is no candidate triangle in the cache, we just take the first
+  // triangle in the original order that hasn't been emitted yet. This isn't
+  // always the best-scoring triangle, but it keeps the whole pass linear.
+  uint32_t next_unemitted_triangle = 0;
+  std::optional<uint32_t> best_triangle;
+  while (optimized_triangles.size() < n_triangles) {
+    if (!best_triangle.has_value()) {
+      while (is_emitted[next_unemitted_triangle]) ++next_unemitted_triangle;
+      best_triangle = next_unemitted_triangle;
+    }
+    const std::array<uint32_t, 3>& triangle =
+        partition.triangles[*best_triangle];
+    is_emitted[*best_triangle] = true;
+    optimized_triangles.push_back(triangle);
+
+    // Remove the emitted triangle from the adjacency of its vertices, by
+    // swapping it past the end of their remaining triangles.
+    for (uint32_t v : triangle) {
+      uint32_t* begin = &adjacent_triangles[adjacency_offsets[v]];
+      uint32_t* end = begin + remaining_triangle_counts[v];
+      uint32_t* it = std::find(begin, end, *best_triangle);
+      ABSL_DCHECK(it != end);
+      std::swap(*it, *(end - 1));
+      --remaining_triangle_counts[v];
+    }
+
+    // Move the triangle's vertices to the front of the cache.
+    int next_cache_size = 0;
+    for (uint32_t v : triangle) next_cache[next_cache_size++] = v;
+    for (int i = 0; i < cache_size; ++i) {
+      uint32_t v = cache[i];
+      if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+        next_cache[next_cache_size++] = v;
+      }
+    }
+    // Vertices that fall out of the cache need to be rescored too.
+    for (int i = kVertexCacheSize; i < next_cache_size; ++i) {
+      cache_positions[next_cache[i]] = -1;
+      vertex_scores[next_cache[i]] =
+          VertexCacheScore(-1, remaining_triangle_counts[next_cache[i]]);
+    }
+    cache_size = std::min(next_cache_size, kVertexCacheSize);
+    for (int i = 0; i < cache_size; ++i) {
+      uint32_t v = next_cache[i];
+      cache[i] = v;
+      cache_positions[v] = i;
+      vertex_scores[v] = VertexCacheScore(i, remaining_triangle_counts[v]);
+    }
+
+    // Score the remaining triangles that use a touched vertex, and pick the
+    // best of them as the next triangle. Only these triangles' scores can have
+    // changed, and triangles that don't use any vertex in the cache can't be
+    // the best candidate unless all of these are used up.
+    best_triangle = std::nullopt;
+    float best_score = 0;
+    for (int i = 0; i < next_cache_size; ++i) {
+      uint32_t v = next_cache[i];
+      for (uint32_t j = 0; j < remaining_triangle_counts[v]; ++j) {
+        uint32_t t = adjacent_triangles[adjacency_offsets[v] + j];
+        const std::array<uint32_t, 3>& candidate = partition.triangles[t];
+        float score = vertex_scores[candidate[0]] +
+                      vertex_scores[candidate[1]] +
+                      vertex_scores[candidate[2]];
+        // Ties are broken by the original triangle order, so that the result
+        // doesn't depend on the order of the adjacency lists.
+        if (!best_triangle.has_value() || score > best_score ||
+            (score == best_score && t < *best_triangle)) {
+          best_score = score;
+          best_triangle = t;
+        }
+      }
+    }
+  }
+
+  // Renumber the vertices in the order that they are first used.
+  constexpr uint32_t kUnassigned = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> new_vertex_indices(n_vertices, kUnassigned);
+  std::vector<uint32_t> optimized_vertex_indices;
+  optimized_vertex_indices.reserve(n_vertices);
+  for (std::array<uint32_t, 3>& triangle : optimized_triangles) {
+    for (uint32_t& v : triangle) {
+      if (new_vertex_indices[v] == kUnassigned) {
+        new_vertex_indices[v] = optimized_vertex_indices.size();
+        optimized_vertex_indices.push_back(partition.vertex_indices[v]);
+      }
+      v = new_vertex_indices[v];
+    }
+  }
+  // Any vertices that aren't used by a triangle go at the end.
+  for (uint32_t v = 0; v < n_vertices; ++v) {
+    if (new_vertex_indices[v] == kUnassigned) {
+      optimized_vertex_indices.push_back(partition.vertex_indices[v]);
+    }
+  }
+
+  partition.vertex_indices = std::move(optimized_vertex_indices);
+  partition.triangles = std::move(optimized_triangles);
+}
+
 absl::StatusOr<MeshAttributeCodingParams> ComputeCodingParams(
     MeshFormat::AttributeType type, const MeshAttributeBounds& bounds) {
   int n_components = MeshFormat::ComponentCount(type);
@@ -969,6 +1558,111 @@ absl::StatusOr<CodingParamsArray> ComputeCodingParamsArray(
   return coding_params_array;
 }
 
+namespace {
+
+using PackFunction = void (*)(const MeshAttributeCodingParams& packing_params,
+                              const SmallArray<float, 4>& unpacked_value,
+                              absl::Span<std::byte> packed_bytes);
+
+// Returns the function that `PackAttribute` dispatches to for the packed
+// attribute `type`, so that the dispatch can be done once per attribute
+// instead of once per vertex.
+PackFunction PackFunctionForPackedType(MeshFormat::AttributeType type) {
+  switch (type) {
+    case MeshFormat::AttributeType::kFloat1PackedInOneUnsignedByte:
+      return PackFloat1PackedInOneUnsignedByte;
+    case MeshFormat::AttributeType::kFloat2PackedInOneFloat:
+      return PackFloat2PackedInOneFloat;
+    case MeshFormat::AttributeType::kFloat2PackedInThreeUnsignedBytes_XY12:
+      return PackFloat2PackedInThreeUnsignedBytes_XY12;
+    case MeshFormat::AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20:
+      return PackFloat2PackedInFourUnsignedBytes_X12_Y20;
+    case MeshFormat::AttributeType::kFloat3PackedInOneFloat:
+      return PackFloat3PackedInOneFloat;
+    case MeshFormat::AttributeType::kFloat3PackedInTwoFloats:
+      return PackFloat3PackedInTwoFloats;
+    case MeshFormat::AttributeType::kFloat3PackedInFourUnsignedBytes_XYZ10:
+      return PackFloat3PackedInFourUnsignedBytes_XYZ10;
+    case MeshFormat::AttributeType::kFloat4PackedInOneFloat:
+      return PackFloat4PackedInOneFloat;
+    case MeshFormat::AttributeType::kFloat4PackedInTwoFloats:
+      return PackFloat4PackedInTwoFloats;
+    case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
+      return PackFloat4PackedInThreeFloats;
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+      return PackFloatsInUnsignedShorts;
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
+      return PackFloatsInHalfFloats;
+    case MeshFormat::AttributeType::kFloat1Unpacked:
+    case MeshFormat::AttributeType::kFloat2Unpacked:
+    case MeshFormat::AttributeType::kFloat3Unpacked:
+    case MeshFormat::AttributeType::kFloat4Unpacked:
+      break;
+  }
+  ABSL_LOG(FATAL) << "Not a packed AttributeType: " << type;
+}
+
+// Copies the attribute at `unpacked_offset` in each of the vertices in
+// `partition_vertex_indices` to `packed_offset` in the corresponding packed
+// vertex, packing it with `packing_params`. If `override_vertex_positions` is
+// non-null, it is consulted for values to use instead of those in
+// `unpacked_vertex_data`.
+void CopyAndPackAttributeForPartitionVertices(
+    MeshFormat::Attribute attr, size_t unpacked_vertex_stride,
+    absl::Span<const std::byte> unpacked_vertex_data,
+    absl::Span<const uint32_t> partition_vertex_indices,
+    const MeshAttributeCodingParams& packing_params, size_t packed_offset,
+    size_t packed_vertex_stride,
+    const absl::flat_hash_map<uint32_t, Point>* absl_nullable
+        override_vertex_positions,
+    std::vector<std::byte>& partition_vertex_data) {
+  const std::byte* src = unpacked_vertex_data.data() + attr.unpacked_offset;
+  std::byte* dst = partition_vertex_data.data() + packed_offset;
+  uint8_t component_count = MeshFormat::ComponentCount(attr.type);
+
+  if (MeshFormat::IsUnpackedType(attr.type)) {
+    // Unpacked attributes are copied verbatim.
+    for (uint32_t original_vertex_idx : partition_vertex_indices) {
+      const std::byte* vertex_src =
+          src + original_vertex_idx * unpacked_vertex_stride;
+      if (override_vertex_positions != nullptr) {
+        auto override_it = override_vertex_positions->find(original_vertex_idx);
+        if (override_it != override_vertex_positions->end()) {
+          vertex_src = reinterpret_cast<const std::byte*>(&override_it->second);
+        }
+      }
+      std::memcpy(dst, vertex_src, attr.packed_width);
+      dst += packed_vertex_stride;
+    }
+    return;
+  }
+
+  PackFunction pack = PackFunctionForPackedType(attr.type);
+  SmallArray<float, 4> unpacked_value(component_count);
+  for (uint32_t original_vertex_idx : partition_vertex_indices) {
+    std::memcpy(unpacked_value.Values().data(),
+                src + original_vertex_idx * unpacked_vertex_stride,
+                component_count * sizeof(float));
+    if (override_vertex_positions != nullptr) {
+      auto override_it = override_vertex_positions->find(original_vertex_idx);
+      if (override_it != override_vertex_positions->end()) {
+        unpacked_value[0] = override_it->second.x;
+        unpacked_value[1] = override_it->second.y;
+      }
+    }
+    ABSL_DCHECK(ValuesAreFinite(unpacked_value));
+    ABSL_DCHECK(UnpackedFloatValuesAreRepresentable(attr.type, packing_params,
+                                                    unpacked_value));
+    pack(packing_params, unpacked_value,
+         absl::MakeSpan(dst, attr.packed_width));
+    dst += packed_vertex_stride;
+  }
+}
+
+}  // namespace
+
 std::vector<std::byte> CopyAndPackPartitionVertices(
     absl::Span<const std::byte> unpacked_vertex_data,
     absl::Span<const uint32_t> partition_vertex_indices,
@@ -999,52 +1693,35 @@ std::vector<std::byte> CopyAndPackPartitionVertices(
                  n_original_vertices)
       << "Partition refers to non-existent vertex";
 
+  // The omitted attributes are resolved once up front, rather than per vertex.
+  absl::InlinedVector<size_t, kMaxVertexAttributes> packed_attr_indices;
   size_t packed_vertex_stride = 0;
-  std::vector<size_t> packed_attribute_offsets;
-  packed_attribute_offsets.reserve(n_packed_attrs);
-  for (MeshFormat::Attribute original_attr : original_attrs) {
-    if (omit_set.contains(original_attr.id)) continue;
-    packed_attribute_offsets.push_back(packed_vertex_stride);
-    packed_vertex_stride += original_attr.packed_width;
+  for (size_t original_attr_idx = 0; original_attr_idx < n_original_attrs;
+       ++original_attr_idx) {
+    if (omit_set.contains(original_attrs[original_attr_idx].id)) continue;
+    packed_attr_indices.push_back(original_attr_idx);
+    packed_vertex_stride += original_attrs[original_attr_idx].packed_width;
   }
 
-  // Returns the unpacked attribute value read from `unpacked_vertex_data` or
-  // the override position, if applicable.
-  auto get_unpacked_attribute_value =
-      [&](uint32_t original_vertex_index,
-          int original_attribute_index) -> SmallArray<float, 4> {
-    if (original_attribute_index == original_format.PositionAttributeIndex()) {
-      auto override_it = override_vertex_positions.find(original_vertex_index);
-      if (override_it != override_vertex_positions.end()) {
-        return {override_it->second.x, override_it->second.y};
-      }
-    }
-    return ReadUnpackedFloatAttributeFromByteArray(
-        original_vertex_index, original_attribute_index, unpacked_vertex_data,
-        original_format);
-  };
-
+  // The vertices are packed one attribute at a time, so that the work per
+  // vertex is just a load, the packing arithmetic, and a store.
   std::vector<std::byte> partition_vertex_data(partition_vertex_indices.size() *
                                                packed_vertex_stride);
-  for (uint32_t partition_vertex_idx = 0;
-       partition_vertex_idx < partition_vertex_indices.size();
-       ++partition_vertex_idx) {
-    uint32_t original_vertex_idx =
-        partition_vertex_indices[partition_vertex_idx];
-    for (size_t original_attr_idx = 0, packed_attr_idx = 0;
-         original_attr_idx < n_original_attrs; ++original_attr_idx) {
-      MeshFormat::Attribute original_attr = original_attrs[original_attr_idx];
-      if (omit_set.contains(original_attr.id)) continue;
-      absl::Span<std::byte> packed_value = absl::MakeSpan(
-          &partition_vertex_data[partition_vertex_idx * packed_vertex_stride +
-                                 packed_attribute_offsets[packed_attr_idx]],
-          original_attr.packed_width);
-      mesh_internal::PackAttribute(
-          original_attr.type, packing_params_array[packed_attr_idx],
-          get_unpacked_attribute_value(original_vertex_idx, original_attr_idx),
-          packed_value);
-      ++packed_attr_idx;
-    }
+  size_t packed_offset = 0;
+  for (size_t packed_attr_idx = 0; packed_attr_idx < n_packed_attrs;
+       ++packed_attr_idx) {
+    size_t original_attr_idx = packed_attr_indices[packed_attr_idx];
+    bool has_overrides =
+        original_attr_idx == original_format.PositionAttributeIndex() &&
+        !override_vertex_positions.empty();
+    CopyAndPackAttributeForPartitionVertices(
+        original_attrs[original_attr_idx],
+        original_format.UnpackedVertexStride(), unpacked_vertex_data,
+        partition_vertex_indices, packing_params_array[packed_attr_idx],
+        packed_offset, packed_vertex_stride,
+        has_overrides ? &override_vertex_positions : nullptr,
+        partition_vertex_data);
+    packed_offset += original_attrs[original_attr_idx].packed_width;
   }
 
   return partition_vertex_data;
@@ -82,6 +82,11 @@ constexpr uint32_t MaxValueForBits(uint8_t n_bits) {
 //   `(unpacked_value[i] - offset[i]) / scale[i]` must lie in the interval
 //   [0, 2^`MeshFormat::PackedBitsPerComponent(type)` - 1]
 //
+// Half-float types (see `MeshFormat::IsHalfFloatType`) have the same
+// restrictions as the other packed types, except that
+// `(unpacked_value[i] - offset[i]) / scale[i]` must instead lie in the
+// interval [-65504, 65504].
+//
 // For unpacked attribute types, the arguments have the following restrictions:
 // - `packing_params` is ignored
 // - `unpacked_value` and `packed_bytes` (or `packed_value` for
@@ -111,6 +116,35 @@ SmallArray<float, 4> UnpackAttribute(
     const MeshAttributeCodingParams& unpacking_params,
     absl::Span<const std::byte> packed_value);
 
+// Unpacks the attribute of `type` stored at byte offset `attribute_offset` of
+// every vertex in `vertex_data`, whose vertices are `vertex_stride` bytes
+// apart. The N components of the value on vertex i are written to
+// `unpacked_values[N * i]` through `unpacked_values[N * i + N - 1]`, where N is
+// `MeshFormat::ComponentCount(type)`. This gives the same values as calling
+// `UnpackAttribute` for each vertex, but without its per-vertex dispatch on
+// `type`, so it should be preferred when unpacking every vertex of a mesh.
+//
+// All the restrictions of `UnpackAttribute` apply to each vertex. In addition,
+// this DCHECK-fails if:
+// - `vertex_data.size()` is not a multiple of `vertex_stride`
+// - the attribute does not fit in a vertex at `attribute_offset`
+// - `unpacked_values.size()` is not N times the number of vertices
+void UnpackAttributes(MeshFormat::AttributeType type,
+                      const MeshAttributeCodingParams& unpacking_params,
+                      absl::Span<const std::byte> vertex_data,
+                      uint32_t vertex_stride, uint32_t attribute_offset,
+                      absl::Span<float> unpacked_values);
+
+// Like `UnpackAttributes`, but for a two-component attribute, such as the
+// vertex position, whose values are written to `positions`. This DCHECK-fails
+// if `MeshFormat::ComponentCount(type)` is not 2, or if `positions.size()` is
+// not the number of vertices.
+void UnpackPositions(MeshFormat::AttributeType type,
+                     const MeshAttributeCodingParams& unpacking_params,
+                     absl::Span<const std::byte> vertex_data,
+                     uint32_t vertex_stride, uint32_t attribute_offset,
+                     absl::Span<Point> positions);
+
 // Returns the integer value that should be packed into a float.  The packing
 // transform must be valid, and the unpacked value must be in range for that
 // transform.
@@ -120,7 +154,7 @@ uint32_t PackSingleFloat(
 
 // Extracts the integer values from the packed float values for an attribute.
 // The arguments have the following restrictions:
-// - `type` must be a packed attribute type
+// - `type` must be a packed attribute type, and not a half-float type
 // - `packed_value` must lie in the interval [0, 2^24 - 1]
 SmallArray<uint32_t, 4> UnpackIntegersFromPackedAttribute(
     MeshFormat::AttributeType type, absl::Span<const std::byte> packed_value);
@@ -142,6 +176,10 @@ SmallArray<float, 4> ReadFloatsFromUnpackedAttribute(
 std::array<uint32_t, 3> ReadTriangleIndicesFromByteArray(
     uint32_t triangle_index, uint8_t index_stride,
     absl::Span<const std::byte> index_data);
+void WriteTriangleIndicesToByteArray(uint32_t triangle_index,
+                                     uint8_t index_stride,
+                                     absl::Span<const uint32_t> vertex_indices,
+                                     absl::Span<std::byte> index_data);
 void WriteTriangleIndicesToByteArray(uint32_t triangle_index,
                                      uint8_t index_stride,
                                      absl::Span<const uint32_t> vertex_indices,
@@ -162,6 +200,10 @@ SmallArray<float, 4> ReadUnpackedFloatAttributeFromByteArray(
 // DCHECK-fails if `index_data.size()` is not divisible by
 // 3 * `MeshFormat::UnpackedIndexSize(index_format)`; the logic in `MutableMesh`
 // is expected to guarantee this.
+//
+// If `vertex_map` is non-empty, each vertex index `i` in `index_data` is
+// replaced by `vertex_map[i]` before partitioning; this is used to merge
+// duplicate vertices (see `MutableMesh::VertexWelding`).
 struct PartitionInfo {
   // Indices of the vertices in the original `MutableMesh`.
   std::vector<uint32_t> vertex_indices;
@@ -171,7 +213,19 @@ struct PartitionInfo {
 };
 absl::InlinedVector<PartitionInfo, 1> PartitionTriangles(
     absl::Span<const std::byte> index_data,
-    MeshFormat::IndexFormat index_format, uint64_t max_vertices_per_partition);
+    MeshFormat::IndexFormat index_format, uint64_t max_vertices_per_partition,
+    absl::Span<const uint32_t> vertex_map = {});
+
+// Reorders the triangles of `partition` to improve the hit rate of the GPU's
+// post-transform vertex cache, and then reorders its vertices to match the
+// order in which the triangles first use them, to improve vertex fetch
+// locality. The winding of each triangle is preserved, as is the set of
+// triangles and vertices, and the result is deterministic.
+//
+// The triangle order is chosen greedily, using Tom Forsyth's "Linear-Speed
+// Vertex Cache Optimisation" scoring, which doesn't depend on the exact cache
+// size or replacement policy of the GPU.
+void OptimizePartitionForVertexCache(PartitionInfo& partition);
 
 // Returns the `MeshAttributeCodingParams` for packing or unpacking the given
 // attribute type. `bounds` must contain the minimum and maximum values of the
@@ -14,16 +14,19 @@
 
 #include "ink/geometry/internal/mesh_packing.h"
 
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <limits>
 #include <optional>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/absl_check.h"
@@ -42,7 +45,9 @@ using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::FieldsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Property;
+using ::testing::UnorderedElementsAreArray;
 
 using AttrType = MeshFormat::AttributeType;
 using AttrId = MeshFormat::AttributeId;
@@ -524,6 +529,131 @@ TEST(MeshPackingTest, Float4PackedInThreeFloats) {
       ElementsAre(100, 5000, 415.15625, 1987));
 }
 
+// Reinterprets the packed bytes of a 16-bit-per-component attribute as
+// `uint16_t`s, in native byte order.
+std::vector<uint16_t> AsUnsignedShorts(const std::vector<std::byte>& bytes) {
+  ABSL_CHECK_EQ(bytes.size() % sizeof(uint16_t), 0);
+  std::vector<uint16_t> shorts(bytes.size() / sizeof(uint16_t));
+  std::memcpy(shorts.data(), bytes.data(), bytes.size());
+  return shorts;
+}
+
+TEST(MeshPackingTest, Float2PackedInTwoUnsignedShorts) {
+  std::vector<std::byte> byte_vector_1 = PackAttributeAndGetAsByteVector(
+      AttrType::kFloat2PackedInTwoUnsignedShorts,
+      {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+      {255.4, 65535});
+  EXPECT_THAT(AsUnsignedShorts(byte_vector_1), ElementsAre(255, 65535));
+  EXPECT_THAT(
+      UnpackAttribute(AttrType::kFloat2PackedInTwoUnsignedShorts,
+                      {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+                      byte_vector_1)
+          .Values(),
+      ElementsAre(255, 65535));
+  EXPECT_THAT(UnpackIntegersFromPackedAttribute(
+                  AttrType::kFloat2PackedInTwoUnsignedShorts, byte_vector_1)
+                  .Values(),
+              ElementsAre(255, 65535));
+
+  std::vector<std::byte> byte_vector_2 = PackAttributeAndGetAsByteVector(
+      AttrType::kFloat2PackedInTwoUnsignedShorts,
+      {{{.offset = 100, .scale = .5}, {.offset = 100, .scale = .5}}},
+      {100.2, 30000});
+  EXPECT_THAT(AsUnsignedShorts(byte_vector_2), ElementsAre(0, 59800));
+  EXPECT_THAT(UnpackAttribute(AttrType::kFloat2PackedInTwoUnsignedShorts,
+                              {{{.offset = 100, .scale = .5},
+                                {.offset = 100, .scale = .5}}},
+                              byte_vector_2)
+                  .Values(),
+              ElementsAre(100, 30000));
+}
+
+TEST(MeshPackingTest, Float4PackedInFourUnsignedShorts) {
+  std::vector<std::byte> byte_vector = PackAttributeAndGetAsByteVector(
+      AttrType::kFloat4PackedInFourUnsignedShorts,
+      {{{.offset = 0, .scale = 1},
+        {.offset = 0, .scale = 1},
+        {.offset = -10, .scale = 2},
+        {.offset = 0, .scale = 1}}},
+      {0, 1.6, 40000, 65535});
+  EXPECT_THAT(AsUnsignedShorts(byte_vector), ElementsAre(0, 2, 20005, 65535));
+  EXPECT_THAT(UnpackAttribute(AttrType::kFloat4PackedInFourUnsignedShorts,
+                              {{{.offset = 0, .scale = 1},
+                                {.offset = 0, .scale = 1},
+                                {.offset = -10, .scale = 2},
+                                {.offset = 0, .scale = 1}}},
+                              byte_vector)
+                  .Values(),
+              ElementsAre(0, 2, 40000, 65535));
+}
+
+TEST(MeshPackingTest, Float2PackedInTwoHalfFloats) {
+  std::vector<std::byte> byte_vector_1 = PackAttributeAndGetAsByteVector(
+      AttrType::kFloat2PackedInTwoHalfFloats,
+      {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}}, {1, -2.5});
+  EXPECT_THAT(AsUnsignedShorts(byte_vector_1), ElementsAre(0x3C00, 0xC100));
+  EXPECT_THAT(
+      UnpackAttribute(AttrType::kFloat2PackedInTwoHalfFloats,
+                      {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+                      byte_vector_1)
+          .Values(),
+      ElementsAre(1, -2.5));
+
+  // The offset and scale are applied before converting to half-float.
+  std::vector<std::byte> byte_vector_2 = PackAttributeAndGetAsByteVector(
+      AttrType::kFloat2PackedInTwoHalfFloats,
+      {{{.offset = 10, .scale = .25}, {.offset = -5, .scale = 2}}},
+      {10.5, -5});
+  EXPECT_THAT(AsUnsignedShorts(byte_vector_2), ElementsAre(0x4000, 0x0000));
+  EXPECT_THAT(UnpackAttribute(AttrType::kFloat2PackedInTwoHalfFloats,
+                              {{{.offset = 10, .scale = .25},
+                                {.offset = -5, .scale = 2}}},
+                              byte_vector_2)
+                  .Values(),
+              ElementsAre(10.5, -5));
+}
+
+TEST(MeshPackingTest, Float2PackedInTwoHalfFloatsRoundsToNearestEven) {
+  // Half-floats in [2048, 4096) are spaced 2 apart, so 2049 and 2051 are both
+  // ties, which round to the value with an even mantissa.
+  EXPECT_THAT(AsUnsignedShorts(PackAttributeAndGetAsByteVector(
+                  AttrType::kFloat2PackedInTwoHalfFloats,
+                  {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+                  {2049, 2051})),
+              ElementsAre(0x6800, 0x6802));
+  EXPECT_THAT(AsUnsignedShorts(PackAttributeAndGetAsByteVector(
+                  AttrType::kFloat2PackedInTwoHalfFloats,
+                  {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+                  {2049.5, 65519})),
+              ElementsAre(0x6801, 0x7BFF));
+  // Values too small for the smallest subnormal half-float round to zero.
+  EXPECT_THAT(AsUnsignedShorts(PackAttributeAndGetAsByteVector(
+                  AttrType::kFloat2PackedInTwoHalfFloats,
+                  {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+                  {std::ldexp(1.f, -24), 1e-9})),
+              ElementsAre(0x0001, 0x0000));
+}
+
+TEST(MeshPackingTest, Float4PackedInFourHalfFloats) {
+  std::vector<std::byte> byte_vector = PackAttributeAndGetAsByteVector(
+      AttrType::kFloat4PackedInFourHalfFloats,
+      {{{.offset = 0, .scale = 1},
+        {.offset = 0, .scale = 1},
+        {.offset = 0, .scale = 1},
+        {.offset = 0, .scale = 1}}},
+      {0.5, 65504, -65504, std::ldexp(1.f, -14)});
+  EXPECT_THAT(AsUnsignedShorts(byte_vector),
+              ElementsAre(0x3800, 0x7BFF, 0xFBFF, 0x0400));
+  EXPECT_THAT(UnpackAttribute(AttrType::kFloat4PackedInFourHalfFloats,
+                              {{{.offset = 0, .scale = 1},
+                                {.offset = 0, .scale = 1},
+                                {.offset = 0, .scale = 1},
+                                {.offset = 0, .scale = 1}}},
+                              byte_vector)
+                  .Values(),
+              ElementsAre(0.5, 65504, -65504, std::ldexp(1.f, -14)));
+}
+
 TEST(MeshPackingTest, DifferentOffsetAndScalePerComponent) {
   EXPECT_THAT(PackAttributeAndGetAsFloatArray(AttrType::kFloat2PackedInOneFloat,
                                               {{{.offset = -100, .scale = 2},
@@ -1243,6 +1373,23 @@ TEST(MeshPackingDeathTest, CannotPackUnrepresentableValues) {
                                         {.offset = 0, .scale = 1}}},
                                       {0, 0, -1, 0}),
       "");
+  std::vector<std::byte> byte_vector_2(MeshFormat::PackedAttributeSize(
+      AttrType::kFloat2PackedInTwoUnsignedShorts));
+  EXPECT_DEATH_IF_SUPPORTED(
+      PackAttribute(AttrType::kFloat2PackedInTwoUnsignedShorts,
+                    {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+                    {0, 65536}, absl::MakeSpan(byte_vector_2)),
+      "");
+  EXPECT_DEATH_IF_SUPPORTED(
+      PackAttribute(AttrType::kFloat2PackedInTwoHalfFloats,
+                    {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+                    {0, 65505}, absl::MakeSpan(byte_vector_2)),
+      "");
+  EXPECT_DEATH_IF_SUPPORTED(
+      PackAttribute(AttrType::kFloat2PackedInTwoHalfFloats,
+                    {{{.offset = 0, .scale = .5}, {.offset = 0, .scale = 1}}},
+                    {-40000, 0}, absl::MakeSpan(byte_vector_2)),
+      "");
 #else
   GTEST_SKIP() << "This tests behavior that is disabled in opt builds.";
 #endif
@@ -1622,6 +1769,85 @@ TEST(MeshPackingDeathTest, BadAttributeType) {
       "");
 }
 
+TEST(MeshPackingTest, UnpackAttributesMatchesUnpackAttributeForEveryType) {
+  for (AttrType type :
+       {AttrType::kFloat1Unpacked, AttrType::kFloat1PackedInOneUnsignedByte,
+        AttrType::kFloat2Unpacked, AttrType::kFloat2PackedInOneFloat,
+        AttrType::kFloat2PackedInThreeUnsignedBytes_XY12,
+        AttrType::kFloat2PackedInFourUnsignedBytes_X12_Y20,
+        AttrType::kFloat2PackedInTwoUnsignedShorts,
+        AttrType::kFloat2PackedInTwoHalfFloats, AttrType::kFloat3Unpacked,
+        AttrType::kFloat3PackedInOneFloat, AttrType::kFloat3PackedInTwoFloats,
+        AttrType::kFloat3PackedInFourUnsignedBytes_XYZ10,
+        AttrType::kFloat4Unpacked, AttrType::kFloat4PackedInOneFloat,
+        AttrType::kFloat4PackedInTwoFloats,
+        AttrType::kFloat4PackedInThreeFloats,
+        AttrType::kFloat4PackedInFourUnsignedShorts,
+        AttrType::kFloat4PackedInFourHalfFloats}) {
+    SCOPED_TRACE(static_cast<int>(type));
+    uint8_t component_count = MeshFormat::ComponentCount(type);
+    MeshAttributeCodingParams params{
+        .components =
+            SmallArray<MeshAttributeCodingParams::ComponentCodingParams, 4>(
+                component_count)};
+    for (uint8_t i = 0; i < component_count; ++i) {
+      params.components[i] = {.offset = -3.f + i, .scale = .5f};
+    }
+    // Put the attribute at an unaligned offset, between other data, to check
+    // that the stride and offset are respected.
+    constexpr uint32_t kVertexCount = 5;
+    constexpr uint32_t kAttributeOffset = 3;
+    uint32_t vertex_stride =
+        kAttributeOffset + MeshFormat::PackedAttributeSize(type) + 1;
+    std::vector<std::byte> vertex_data(kVertexCount * vertex_stride,
+                                       std::byte{0xFF});
+    for (uint32_t v = 0; v < kVertexCount; ++v) {
+      SmallArray<float, 4> value(component_count);
+      for (uint8_t i = 0; i < component_count; ++i) {
+        // Every value fits in 6 bits, the smallest component size.
+        value[i] = params.components[i].offset +
+                   params.components[i].scale * ((v * 7 + i * 3) % 64);
+      }
+      PackAttribute(type, params, value,
+                    absl::MakeSpan(vertex_data)
+                        .subspan(v * vertex_stride + kAttributeOffset,
+                                 MeshFormat::PackedAttributeSize(type)));
+    }
+
+    std::vector<float> expected;
+    for (uint32_t v = 0; v < kVertexCount; ++v) {
+      SmallArray<float, 4> value = UnpackAttribute(
+          type, params,
+          absl::MakeSpan(vertex_data)
+              .subspan(v * vertex_stride + kAttributeOffset,
+                       MeshFormat::PackedAttributeSize(type)));
+      absl::c_copy(value.Values(), std::back_inserter(expected));
+    }
+    std::vector<float> unpacked(kVertexCount * component_count);
+    UnpackAttributes(type, params, vertex_data, vertex_stride, kAttributeOffset,
+                     absl::MakeSpan(unpacked));
+    EXPECT_THAT(unpacked, ElementsAreArray(expected));
+
+    if (component_count == 2) {
+      std::vector<Point> positions(kVertexCount);
+      UnpackPositions(type, params, vertex_data, vertex_stride,
+                      kAttributeOffset, absl::MakeSpan(positions));
+      for (uint32_t v = 0; v < kVertexCount; ++v) {
+        EXPECT_EQ(positions[v].x, expected[2 * v]);
+        EXPECT_EQ(positions[v].y, expected[2 * v + 1]);
+      }
+    }
+  }
+}
+
+TEST(MeshPackingTest, UnpackAttributesWithNoVertices) {
+  std::vector<float> unpacked;
+  UnpackAttributes(AttrType::kFloat2PackedInOneFloat,
+                   {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}},
+                   {}, sizeof(float), 0, absl::MakeSpan(unpacked));
+  EXPECT_THAT(unpacked, IsEmpty());
+}
+
 TEST(MeshPackingTest, ReadAndWrite16BitTriangleIndices) {
   std::vector<std::byte> bytes(sizeof(uint16_t) * 12);
 
@@ -1800,6 +2026,112 @@ TEST(MeshPackingTest, PartitionTriangles16BitIndex) {
                                                 ElementsAre(1, 5, 4)))));
 }
 
+// Returns a partition for a `n_columns` by `n_rows` grid of quads, each split
+// into two triangles, with the triangles in row-major order. The vertex indices
+// in the original mesh are offset by 1000, to distinguish them from the
+// indices within the partition.
+PartitionInfo MakeGridPartition(uint32_t n_columns, uint32_t n_rows) {
+  PartitionInfo partition;
+  for (uint32_t i = 0; i < (n_columns + 1) * (n_rows + 1); ++i) {
+    partition.vertex_indices.push_back(1000 + i);
+  }
+  for (uint32_t row = 0; row < n_rows; ++row) {
+    for (uint32_t column = 0; column < n_columns; ++column) {
+      uint32_t bottom_left = row * (n_columns + 1) + column;
+      uint32_t top_left = bottom_left + n_columns + 1;
+      partition.triangles.push_back({bottom_left, bottom_left + 1, top_left});
+      partition.triangles.push_back({bottom_left + 1, top_left + 1, top_left});
+    }
+  }
+  return partition;
+}
+
+// Returns the triangles of `partition` in terms of the vertex indices in the
+// original mesh, each rotated so that the smallest index comes first; this
+// preserves the winding of the triangle.
+std::vector<std::array<uint32_t, 3>> OriginalTrianglesWithWinding(
+    const PartitionInfo& partition) {
+  std::vector<std::array<uint32_t, 3>> triangles;
+  for (std::array<uint32_t, 3> triangle : partition.triangles) {
+    for (uint32_t& v : triangle) v = partition.vertex_indices[v];
+    while (triangle[0] > triangle[1] || triangle[0] > triangle[2]) {
+      triangle = {triangle[1], triangle[2], triangle[0]};
+    }
+    triangles.push_back(triangle);
+  }
+  return triangles;
+}
+
+// Returns the average number of vertex cache misses per triangle when the
+// triangles of `partition` are drawn with a FIFO cache of `cache_size`
+// vertices.
+float AverageCacheMissRatio(const PartitionInfo& partition, int cache_size) {
+  std::vector<uint32_t> cache;
+  int n_misses = 0;
+  for (const std::array<uint32_t, 3>& triangle : partition.triangles) {
+    for (uint32_t v : triangle) {
+      if (absl::c_linear_search(cache, v)) continue;
+      ++n_misses;
+      cache.push_back(v);
+      if (cache.size() > static_cast<size_t>(cache_size)) {
+        cache.erase(cache.begin());
+      }
+    }
+  }
+  return static_cast<float>(n_misses) / partition.triangles.size();
+}
+
+TEST(MeshPackingTest, OptimizePartitionForVertexCachePreservesTriangles) {
+  PartitionInfo original = MakeGridPartition(30, 10);
+  PartitionInfo optimized = MakeGridPartition(30, 10);
+  OptimizePartitionForVertexCache(optimized);
+
+  EXPECT_THAT(optimized.vertex_indices,
+              UnorderedElementsAreArray(original.vertex_indices));
+  EXPECT_THAT(OriginalTrianglesWithWinding(optimized),
+              UnorderedElementsAreArray(OriginalTrianglesWithWinding(original)));
+}
+
+TEST(MeshPackingTest, OptimizePartitionForVertexCacheOrdersVertices) {
+  PartitionInfo partition = MakeGridPartition(30, 10);
+  OptimizePartitionForVertexCache(partition);
+
+  uint32_t next_new_vertex = 0;
+  for (const std::array<uint32_t, 3>& triangle : partition.triangles) {
+    for (uint32_t v : triangle) {
+      ASSERT_LE(v, next_new_vertex);
+      if (v == next_new_vertex) ++next_new_vertex;
+    }
+  }
+  EXPECT_EQ(next_new_vertex, partition.vertex_indices.size());
+}
+
+TEST(MeshPackingTest, OptimizePartitionForVertexCacheReducesCacheMisses) {
+  // Each row of the grid is longer than the cache, so in the original order
+  // every vertex is loaded once for each row that uses it.
+  PartitionInfo partition = MakeGridPartition(100, 20);
+  EXPECT_GT(AverageCacheMissRatio(partition, 16), 1);
+
+  OptimizePartitionForVertexCache(partition);
+  EXPECT_LT(AverageCacheMissRatio(partition, 16), 0.75);
+}
+
+TEST(MeshPackingTest, OptimizePartitionForVertexCacheIsDeterministic) {
+  PartitionInfo partition1 = MakeGridPartition(40, 5);
+  PartitionInfo partition2 = MakeGridPartition(40, 5);
+  OptimizePartitionForVertexCache(partition1);
+  OptimizePartitionForVertexCache(partition2);
+  EXPECT_EQ(partition1.vertex_indices, partition2.vertex_indices);
+  EXPECT_EQ(partition1.triangles, partition2.triangles);
+}
+
+TEST(MeshPackingTest, OptimizePartitionForVertexCacheEmptyPartition) {
+  PartitionInfo partition;
+  OptimizePartitionForVertexCache(partition);
+  EXPECT_THAT(partition.vertex_indices, IsEmpty());
+  EXPECT_THAT(partition.triangles, IsEmpty());
+}
+
 TEST(MeshPackingTest, ComputeCodingParamskFloat1Unpacked) {
   absl::StatusOr<MeshAttributeCodingParams> coding_params = ComputeCodingParams(
       AttrType::kFloat1Unpacked, {.minimum = {1, 0}, .maximum = {1, 1}});
@@ -2375,6 +2707,90 @@ TEST(MeshPackingTest,
                                             0})));     // color
 }
 
+// Checks that packing a whole partition produces exactly the same bytes as
+// packing each attribute of each vertex individually with `PackAttribute`.
+TEST(MeshPackingTest, CopyAndPackPartitionVerticesMatchesPackAttribute) {
+  absl::StatusOr<MeshFormat> format = MeshFormat::Create(
+      {{AttrType::kFloat2PackedInFourUnsignedBytes_X12_Y20, AttrId::kPosition},
+       {AttrType::kFloat1PackedInOneUnsignedByte, AttrId::kCustom0},
+       {AttrType::kFloat3PackedInFourUnsignedBytes_XYZ10, AttrId::kCustom1},
+       {AttrType::kFloat1Unpacked, AttrId::kCustom2},
+       {AttrType::kFloat2PackedInThreeUnsignedBytes_XY12, AttrId::kCustom3}},
+      MeshFormat::IndexFormat::k16BitUnpacked16BitPacked);
+  ASSERT_EQ(format.status(), absl::OkStatus());
+  constexpr int kNumVertices = 100;
+  std::vector<float> values;
+  for (int i = 0; i < kNumVertices; ++i) {
+    float t = i / (kNumVertices - 1.f);
+    values.insert(values.end(), {100 * t, 50 * std::sin(7.f * i),  // position
+                                 t,                                // custom0
+                                 t, 1 - t, 0.5f * t,               // custom1
+                                 -3.f * i,                         // custom2
+                                 std::cos(3.f * i), std::sin(5.f * i)});
+  }
+  std::vector<std::byte> bytes = AsByteVector<float>(values);
+
+  CodingParamsArray packing_params_array(4);
+  {
+    absl::StatusOr<MeshAttributeCodingParams> packing_params =
+        ComputeCodingParams(AttrType::kFloat2PackedInFourUnsignedBytes_X12_Y20,
+                            {.minimum = {0, -50}, .maximum = {100, 50}});
+    ASSERT_EQ(packing_params.status(), absl::OkStatus());
+    packing_params_array[0] = *packing_params;
+  }
+  {
+    absl::StatusOr<MeshAttributeCodingParams> packing_params =
+        ComputeCodingParams(AttrType::kFloat1PackedInOneUnsignedByte,
+                            {.minimum = {0}, .maximum = {1}});
+    ASSERT_EQ(packing_params.status(), absl::OkStatus());
+    packing_params_array[1] = *packing_params;
+  }
+  {
+    absl::StatusOr<MeshAttributeCodingParams> packing_params =
+        ComputeCodingParams(AttrType::kFloat3PackedInFourUnsignedBytes_XYZ10,
+                            {.minimum = {0, 0, 0}, .maximum = {1, 1, 1}});
+    ASSERT_EQ(packing_params.status(), absl::OkStatus());
+    packing_params_array[2] = *packing_params;
+  }
+  {
+    absl::StatusOr<MeshAttributeCodingParams> packing_params =
+        ComputeCodingParams(AttrType::kFloat2PackedInThreeUnsignedBytes_XY12,
+                            {.minimum = {-1, -1}, .maximum = {1, 1}});
+    ASSERT_EQ(packing_params.status(), absl::OkStatus());
+    packing_params_array[3] = *packing_params;
+  }
+  absl::flat_hash_map<uint32_t, Point> corrected_positions = {{3, {10, 20}},
+                                                              {50, {90, -40}}};
+  std::vector<uint32_t> partition_vertex_indices;
+  for (uint32_t i = 0; i < kNumVertices; i += 2) {
+    partition_vertex_indices.push_back(kNumVertices - 1 - i);
+  }
+
+  std::vector<std::byte> expected;
+  for (uint32_t vertex_idx : partition_vertex_indices) {
+    for (uint32_t attr_idx : {0, 1, 2, 4}) {
+      SmallArray<float, 4> unpacked_value =
+          ReadUnpackedFloatAttributeFromByteArray(vertex_idx, attr_idx, bytes,
+                                                  *format);
+      if (attr_idx == 0 && corrected_positions.contains(vertex_idx)) {
+        Point corrected = corrected_positions.at(vertex_idx);
+        unpacked_value = {corrected.x, corrected.y};
+      }
+      const MeshFormat::Attribute& attr = format->Attributes()[attr_idx];
+      expected.resize(expected.size() + attr.packed_width);
+      PackAttribute(attr.type,
+                    packing_params_array[attr_idx == 4 ? 3 : attr_idx],
+                    unpacked_value,
+                    absl::MakeSpan(expected).last(attr.packed_width));
+    }
+  }
+
+  EXPECT_THAT(CopyAndPackPartitionVertices(
+                  bytes, partition_vertex_indices, *format, {AttrId::kCustom2},
+                  packing_params_array, corrected_positions),
+              ElementsAreArray(expected));
+}
+
 TEST(MeshPackingDeathTest, WriteTriangleIndicesWrongNumberOfIndices) {
 // There is no EXPECT_DEBUG_DEATH_IF_SUPPORTED, so we only run these when
 // compiled in debug mode.
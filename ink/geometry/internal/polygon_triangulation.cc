@@ -0,0 +1,341 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/internal/polygon_triangulation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "ink/geometry/point.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+// Returns twice the signed area of the triangle (a, b, c), which is positive if
+// the triangle is counter-clockwise. This is computed in double precision so
+// that it is exact for most float inputs.
+double Orientation(Point a, Point b, Point c) {
+  return (static_cast<double>(b.x) - a.x) * (static_cast<double>(c.y) - a.y) -
+         (static_cast<double>(b.y) - a.y) * (static_cast<double>(c.x) - a.x);
+}
+
+// Returns true if `p` is within the bounding box of segment (a, b). If `p` is
+// collinear with the segment, this means that it is on the segment.
+bool IsInSegmentBounds(Point a, Point b, Point p) {
+  return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) &&
+         std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+
+// Returns true if the closed segments (a, b) and (c, d) have any point in
+// common.
+bool SegmentsIntersect(Point a, Point b, Point c, Point d) {
+  double abc = Orientation(a, b, c);
+  double abd = Orientation(a, b, d);
+  double cda = Orientation(c, d, a);
+  double cdb = Orientation(c, d, b);
+  if (((abc > 0 && abd < 0) || (abc < 0 && abd > 0)) &&
+      ((cda > 0 && cdb < 0) || (cda < 0 && cdb > 0))) {
+    return true;
+  }
+  return (abc == 0 && IsInSegmentBounds(a, b, c)) ||
+         (abd == 0 && IsInSegmentBounds(a, b, d)) ||
+         (cda == 0 && IsInSegmentBounds(c, d, a)) ||
+         (cdb == 0 && IsInSegmentBounds(c, d, b));
+}
+
+// A uniform grid over the bounding box of the polygon, in which each cell lists
+// the items (edges or vertices) whose bounding boxes overlap it. This makes the
+// pairwise tests below roughly linear in the number of points for the kinds of
+// polygons we expect (e.g. lassos), instead of quadratic.
+class UniformGrid {
+ public:
+  // Sets up a grid with about one cell per item.
+  UniformGrid(float min_x, float min_y, float max_x, float max_y,
+              uint32_t n_items)
+      : min_x_(min_x), min_y_(min_y) {
+    // This is only used for polygons with non-zero area, so both dimensions
+    // are positive.
+    float width = max_x - min_x;
+    float height = max_y - min_y;
+    float cell_size = std::sqrt(width / n_items * height);
+    constexpr uint32_t kMaxCellsPerAxis = 1024;
+    n_cells_x_ = std::clamp<float>(std::ceil(width / cell_size), 1,
+                                   kMaxCellsPerAxis);
+    n_cells_y_ = std::clamp<float>(std::ceil(height / cell_size), 1,
+                                   kMaxCellsPerAxis);
+    inverse_cell_width_ = n_cells_x_ / width;
+    inverse_cell_height_ = n_cells_y_ / height;
+    cell_starts_.assign(n_cells_x_ * n_cells_y_ + 1, 0);
+  }
+
+  // Adds the items, whose bounding boxes are given by `bounds_fn(i)` for each
+  // `i` in [0, `n_items`). This must be called exactly once, before any calls
+  // to `VisitCells()`.
+  template <typename BoundsFn>
+  void Build(uint32_t n_items, BoundsFn bounds_fn) {
+    // Count the items in each cell, then fill them in.
+    for (uint32_t i = 0; i < n_items; ++i) {
+      ForEachCell(bounds_fn(i),
+                  [this](uint32_t cell) { ++cell_starts_[cell]; });
+    }
+    uint32_t total = 0;
+    for (uint32_t& start : cell_starts_) {
+      uint32_t count = start;
+      start = total;
+      total += count;
+    }
+    items_.resize(total);
+    std::vector<uint32_t> fill_positions(cell_starts_.begin(),
+                                         cell_starts_.end() - 1);
+    for (uint32_t i = 0; i < n_items; ++i) {
+      ForEachCell(bounds_fn(i), [this, &fill_positions, i](uint32_t cell) {
+        items_[fill_positions[cell]++] = i;
+      });
+    }
+  }
+
+  // Calls `visitor(items)` for each cell that overlaps `bounds`, where `items`
+  // is the span of item indices in that cell.
+  template <typename Visitor>
+  void VisitCells(const std::array<float, 4>& bounds, Visitor visitor) const {
+    ForEachCell(bounds, [this, &visitor](uint32_t cell) {
+      visitor(absl::MakeConstSpan(items_).subspan(
+          cell_starts_[cell], cell_starts_[cell + 1] - cell_starts_[cell]));
+    });
+  }
+
+  uint32_t CellCount() const { return n_cells_x_ * n_cells_y_; }
+
+  absl::Span<const uint32_t> CellItems(uint32_t cell) const {
+    return absl::MakeConstSpan(items_).subspan(
+        cell_starts_[cell], cell_starts_[cell + 1] - cell_starts_[cell]);
+  }
+
+ private:
+  uint32_t CellX(float x) const {
+    return std::clamp<float>((x - min_x_) * inverse_cell_width_, 0,
+                             n_cells_x_ - 1);
+  }
+  uint32_t CellY(float y) const {
+    return std::clamp<float>((y - min_y_) * inverse_cell_height_, 0,
+                             n_cells_y_ - 1);
+  }
+
+  // Calls `fn(cell)` for each cell overlapping `bounds` = {min_x, min_y, max_x,
+  // max_y}. Empty bounds (with a minimum greater than the maximum) don't
+  // overlap any cells.
+  template <typename Fn>
+  void ForEachCell(const std::array<float, 4>& bounds, Fn fn) const {
+    if (bounds[0] > bounds[2] || bounds[1] > bounds[3]) return;
+    uint32_t x_end = CellX(bounds[2]);
+    uint32_t y_end = CellY(bounds[3]);
+    for (uint32_t y = CellY(bounds[1]); y <= y_end; ++y) {
+      for (uint32_t x = CellX(bounds[0]); x <= x_end; ++x) {
+        fn(y * n_cells_x_ + x);
+      }
+    }
+  }
+
+  float min_x_;
+  float min_y_;
+  float inverse_cell_width_;
+  float inverse_cell_height_;
+  uint32_t n_cells_x_;
+  uint32_t n_cells_y_;
+  // Items in cell `c` are `items_[cell_starts_[c]]` through
+  // `items_[cell_starts_[c + 1] - 1]`.
+  std::vector<uint32_t> cell_starts_;
+  std::vector<uint32_t> items_;
+};
+
+std::array<float, 4> SegmentBounds(Point a, Point b) {
+  return {std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x),
+          std::max(a.y, b.y)};
+}
+
+// Returns true if no two edges of the polygon intersect, other than adjacent
+// edges at their shared vertex.
+bool IsSimple(absl::Span<const Point> points, const UniformGrid& edge_grid) {
+  uint32_t n = points.size();
+  auto edge_start = [points](uint32_t e) { return points[e]; };
+  auto edge_end = [points, n](uint32_t e) { return points[(e + 1) % n]; };
+
+  // Adjacent edges only share their common vertex, unless the polygon doubles
+  // back on itself there. This also rejects zero-length edges.
+  for (uint32_t e = 0; e < n; ++e) {
+    Point a = edge_start(e);
+    Point b = edge_end(e);
+    Point c = points[(e + 2) % n];
+    if (a == b) return false;
+    if (Orientation(a, b, c) == 0 &&
+        (static_cast<double>(b.x) - a.x) * (static_cast<double>(c.x) - b.x) +
+                (static_cast<double>(b.y) - a.y) *
+                    (static_cast<double>(c.y) - b.y) <
+            0) {
+      return false;
+    }
+  }
+
+  for (uint32_t cell = 0; cell < edge_grid.CellCount(); ++cell) {
+    absl::Span<const uint32_t> edges = edge_grid.CellItems(cell);
+    for (size_t i = 0; i < edges.size(); ++i) {
+      for (size_t j = i + 1; j < edges.size(); ++j) {
+        uint32_t e = edges[i];
+        uint32_t f = edges[j];
+        if ((e + 1) % n == f || (f + 1) % n == e) continue;
+        if (SegmentsIntersect(edge_start(e), edge_end(e), edge_start(f),
+                              edge_end(f))) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+std::optional<std::vector<uint32_t>> TriangulateSimplePolygon(
+    absl::Span<const Point> points) {
+  uint32_t n = points.size();
+  if (n < 3) return std::nullopt;
+
+  float min_x = points[0].x;
+  float min_y = points[0].y;
+  float max_x = points[0].x;
+  float max_y = points[0].y;
+  double twice_area = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    Point p = points[i];
+    if (!std::isfinite(p.x) || !std::isfinite(p.y)) return std::nullopt;
+    min_x = std::min(min_x, p.x);
+    min_y = std::min(min_y, p.y);
+    max_x = std::max(max_x, p.x);
+    max_y = std::max(max_y, p.y);
+    twice_area += Orientation(points[0], p, points[(i + 1) % n]);
+  }
+  if (twice_area == 0 || !(max_x - min_x > 0) || !(max_y - min_y > 0)) {
+    return std::nullopt;
+  }
+  // The sign that `Orientation()` has for the convex corners of the polygon.
+  double orientation_sign = twice_area > 0 ? 1 : -1;
+
+  UniformGrid edge_grid(min_x, min_y, max_x, max_y, n);
+  edge_grid.Build(n, [points, n](uint32_t e) {
+    return SegmentBounds(points[e], points[(e + 1) % n]);
+  });
+  if (!IsSimple(points, edge_grid)) return std::nullopt;
+
+  // The remaining polygon is kept as a circular doubly-linked list.
+  std::vector<uint32_t> prev(n);
+  std::vector<uint32_t> next(n);
+  for (uint32_t i = 0; i < n; ++i) {
+    prev[i] = (i + n - 1) % n;
+    next[i] = (i + 1) % n;
+  }
+  auto corner_orientation = [&](uint32_t i) {
+    return orientation_sign *
+           Orientation(points[prev[i]], points[i], points[next[i]]);
+  };
+
+  // Only the reflex or straight corners can be inside an ear, so only those
+  // need to be checked. Clipping an ear never makes a convex corner reflex, so
+  // the set of candidates can only shrink.
+  std::vector<bool> can_block(n);
+  for (uint32_t i = 0; i < n; ++i) can_block[i] = corner_orientation(i) <= 0;
+  UniformGrid vertex_grid(min_x, min_y, max_x, max_y, n);
+  vertex_grid.Build(n, [points, &can_block](uint32_t i) {
+    // Corners that can't block are left out of the grid entirely.
+    if (!can_block[i]) return std::array<float, 4>{1, 1, 0, 0};
+    return SegmentBounds(points[i], points[i]);
+  });
+
+  auto is_ear = [&](uint32_t i) {
+    uint32_t a = prev[i];
+    uint32_t b = i;
+    uint32_t c = next[i];
+    if (corner_orientation(i) <= 0) return false;
+    Point pa = points[a];
+    Point pb = points[b];
+    Point pc = points[c];
+    std::array<float, 4> bounds = {
+        std::min({pa.x, pb.x, pc.x}), std::min({pa.y, pb.y, pc.y}),
+        std::max({pa.x, pb.x, pc.x}), std::max({pa.y, pb.y, pc.y})};
+    bool is_blocked = false;
+    vertex_grid.VisitCells(bounds, [&](absl::Span<const uint32_t> vertices) {
+      for (uint32_t v : vertices) {
+        if (is_blocked) return;
+        if (!can_block[v] || v == a || v == b || v == c) continue;
+        Point p = points[v];
+        is_blocked = orientation_sign * Orientation(pa, pb, p) >= 0 &&
+                     orientation_sign * Orientation(pb, pc, p) >= 0 &&
+                     orientation_sign * Orientation(pc, pa, p) >= 0;
+      }
+    });
+    return !is_blocked;
+  };
+
+  auto remove = [&](uint32_t i) {
+    next[prev[i]] = next[i];
+    prev[next[i]] = prev[i];
+    can_block[i] = false;
+  };
+
+  std::vector<uint32_t> indices;
+  indices.reserve(3 * (n - 2));
+  uint32_t n_remaining = n;
+  uint32_t i = 0;
+  // The number of corners visited since the last one was clipped; if this
+  // reaches the number of remaining corners, no ear can be found.
+  uint32_t n_visited = 0;
+  while (n_remaining > 3) {
+    if (n_visited > n_remaining) return std::nullopt;
+    uint32_t after = next[i];
+    if (corner_orientation(i) == 0) {
+      // The polygon goes straight on at `i` (it can't double back, since it is
+      // simple), so `i` can be dropped without changing the polygon.
+      remove(i);
+    } else if (is_ear(i)) {
+      indices.insert(indices.end(), {prev[i], i, next[i]});
+      remove(i);
+    } else {
+      i = after;
+      ++n_visited;
+      continue;
+    }
+    --n_remaining;
+    n_visited = 0;
+    // The neighbors of a clipped corner may have stopped being able to block.
+    for (uint32_t neighbor : {prev[after], after}) {
+      if (can_block[neighbor] && corner_orientation(neighbor) > 0) {
+        can_block[neighbor] = false;
+      }
+    }
+    i = after;
+  }
+  if (corner_orientation(i) > 0) {
+    indices.insert(indices.end(), {prev[i], i, next[i]});
+  }
+  if (indices.empty()) return std::nullopt;
+  return indices;
+}
+
+}  // namespace ink::geometry_internal
@@ -0,0 +1,50 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_GEOMETRY_INTERNAL_POLYGON_TRIANGULATION_H_
+#define INK_GEOMETRY_INTERNAL_POLYGON_TRIANGULATION_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "ink/geometry/point.h"
+
+namespace ink::geometry_internal {
+
+// Triangulates the interior of the simple polygon whose vertices are `points`,
+// in order, by ear clipping. This is much cheaper than the general tessellator
+// in generic_tessellator.h, but only handles simple polygons.
+//
+// On success, returns a flat list of indices into `points`, three per
+// triangle. Every triangle has the same orientation as the polygon (i.e. they
+// are all counter-clockwise if the polygon is), and no new vertices are added.
+// Vertices at which the polygon goes straight on may not be used by any
+// triangle, so that none of the triangles are degenerate.
+//
+// Returns `std::nullopt` without triangulating if:
+// - `points` has fewer than three elements, or any coordinate is non-finite.
+// - The polygon is not simple, i.e. any of its edges intersect or touch other
+//   than adjacent edges at their shared vertex. This includes repeated points.
+// - The polygon has zero area.
+// The polygon may also be rejected if it is so close to degenerate that
+// floating-point error prevents finding an ear.
+std::optional<std::vector<uint32_t>> TriangulateSimplePolygon(
+    absl::Span<const Point> points);
+
+}  // namespace ink::geometry_internal
+
+#endif  // INK_GEOMETRY_INTERNAL_POLYGON_TRIANGULATION_H_
@@ -0,0 +1,159 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/internal/polygon_triangulation.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/triangle.h"
+#include "ink/types/numbers.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+using ::testing::SizeIs;
+
+// Returns the total signed area of the triangles in `indices`, and checks that
+// each of them has the sign of `expected_sign`.
+float TotalSignedArea(const std::vector<Point>& points,
+                      const std::vector<uint32_t>& indices,
+                      float expected_sign) {
+  float area = 0;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    float triangle_area = Triangle{points[indices[i]], points[indices[i + 1]],
+                                   points[indices[i + 2]]}
+                              .SignedArea();
+    EXPECT_GT(expected_sign * triangle_area, 0);
+    area += triangle_area;
+  }
+  return area;
+}
+
+TEST(PolygonTriangulationTest, TooFewPoints) {
+  EXPECT_EQ(TriangulateSimplePolygon({}), std::nullopt);
+  EXPECT_EQ(TriangulateSimplePolygon({{0, 0}, {1, 0}}), std::nullopt);
+}
+
+TEST(PolygonTriangulationTest, Triangle) {
+  EXPECT_THAT(TriangulateSimplePolygon({{0, 0}, {1, 0}, {0, 1}}),
+              Optional(ElementsAre(2, 0, 1)));
+}
+
+TEST(PolygonTriangulationTest, ConcaveQuad) {
+  EXPECT_THAT(TriangulateSimplePolygon({{0, 0}, {10, 0}, {2, 2}, {0, 10}}),
+              Optional(ElementsAre(0, 1, 2, 0, 2, 3)));
+}
+
+TEST(PolygonTriangulationTest, ClockwisePolygonGivesClockwiseTriangles) {
+  std::vector<Point> points = {{0, 0}, {0, 10}, {5, 4}, {10, 10}, {10, 0}};
+  std::optional<std::vector<uint32_t>> indices =
+      TriangulateSimplePolygon(points);
+  ASSERT_THAT(indices, Optional(SizeIs(9)));
+  EXPECT_FLOAT_EQ(TotalSignedArea(points, *indices, -1), -70);
+}
+
+TEST(PolygonTriangulationTest, SkipsStraightVertices) {
+  std::vector<Point> points = {{0, 0}, {5, 0}, {10, 0}, {10, 10}, {0, 10}};
+  std::optional<std::vector<uint32_t>> indices =
+      TriangulateSimplePolygon(points);
+  ASSERT_TRUE(indices.has_value());
+  EXPECT_FLOAT_EQ(TotalSignedArea(points, *indices, 1), 100);
+}
+
+TEST(PolygonTriangulationTest, CombWithManyReflexVertices) {
+  // A comb with teeth pointing up from a base along the x-axis.
+  constexpr int kNumTeeth = 100;
+  std::vector<Point> points = {{0, 0}, {2 * kNumTeeth, 0}, {2 * kNumTeeth, 1}};
+  for (int i = kNumTeeth - 1; i >= 0; --i) {
+    points.push_back({2.f * i + 1, 10});
+    points.push_back({2.f * i, 10});
+    if (i > 0) points.push_back({2.f * i, 1});
+  }
+
+  std::optional<std::vector<uint32_t>> indices =
+      TriangulateSimplePolygon(points);
+  ASSERT_TRUE(indices.has_value());
+  EXPECT_FLOAT_EQ(TotalSignedArea(points, *indices, 1),
+                  2 * kNumTeeth + kNumTeeth * 9 * 1.5f);
+}
+
+TEST(PolygonTriangulationTest, WavyCircle) {
+  constexpr int kNumPoints = 2000;
+  std::vector<Point> points;
+  for (int i = 0; i < kNumPoints; ++i) {
+    float theta = 2 * numbers::kPi * i / kNumPoints;
+    float radius = 1 + 0.3f * std::sin(17 * theta);
+    points.push_back({radius * std::cos(theta), radius * std::sin(theta)});
+  }
+
+  std::optional<std::vector<uint32_t>> indices =
+      TriangulateSimplePolygon(points);
+  ASSERT_THAT(indices, Optional(SizeIs(3 * (kNumPoints - 2))));
+  // The area of r(θ) = 1 + 0.3 * sin(17θ) is π * (1 + 0.3² / 2).
+  EXPECT_NEAR(TotalSignedArea(points, *indices, 1),
+              numbers::kPi * (1 + 0.09 / 2), 1e-3);
+}
+
+TEST(PolygonTriangulationTest, RejectsSelfIntersectingPolygon) {
+  EXPECT_EQ(TriangulateSimplePolygon({{0, 0}, {10, 10}, {10, 0}, {0, 10}}),
+            std::nullopt);
+}
+
+TEST(PolygonTriangulationTest, RejectsRepeatedPoint) {
+  EXPECT_EQ(TriangulateSimplePolygon(
+                {{0, 0}, {10, 0}, {20, 0}, {15, 5}, {10, 0}, {5, 5}}),
+            std::nullopt);
+  EXPECT_EQ(TriangulateSimplePolygon({{0, 0}, {10, 0}, {10, 0}, {0, 10}}),
+            std::nullopt);
+}
+
+TEST(PolygonTriangulationTest, RejectsPolygonTouchingItself) {
+  // The vertex at (5, 0) touches the edge from (0, 0) to (10, 0).
+  EXPECT_EQ(TriangulateSimplePolygon(
+                {{0, 0}, {10, 0}, {10, 10}, {5, 0}, {0, 10}}),
+            std::nullopt);
+}
+
+TEST(PolygonTriangulationTest, RejectsPolygonDoublingBack) {
+  EXPECT_EQ(TriangulateSimplePolygon({{0, 0}, {10, 0}, {5, 0}, {0, 10}}),
+            std::nullopt);
+}
+
+TEST(PolygonTriangulationTest, RejectsZeroArea) {
+  EXPECT_EQ(TriangulateSimplePolygon({{0, 0}, {1, 2}, {2, 4}, {3, 6}}),
+            std::nullopt);
+}
+
+TEST(PolygonTriangulationTest, RejectsNonFinitePoints) {
+  EXPECT_EQ(TriangulateSimplePolygon(
+                {{0, 0}, {1, 0}, {0, std::numeric_limits<float>::infinity()}}),
+            std::nullopt);
+  EXPECT_EQ(TriangulateSimplePolygon(
+                {{0, 0}, {1, 0}, {0, std::numeric_limits<float>::quiet_NaN()}}),
+            std::nullopt);
+}
+
+}  // namespace
+}  // namespace ink::geometry_internal
@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/config.h"
 #include "absl/log/absl_check.h"
 #include "absl/types/span.h"
 #include "ink/geometry/distance.h"
@@ -70,8 +71,75 @@ float IntermediateWalkDistance(PolylineData& polyline, int start_index,
   return total_distance;
 }
 
-PolylineData CreateNewPolylineData(absl::Span<const Point> points) {
-  PolylineData polyline;
+namespace {
+
+// Bounds on a walk distance, as computed by `WalkDistance()` or
+// `IntermediateWalkDistance()`.
+struct WalkDistanceBounds {
+  float lower;
+  float upper;
+};
+
+// Returns bounds on the float value of `initial_distance` plus the lengths of
+// segments [`begin_index`, `end_index`), added one at a time in that order,
+// which is how `WalkDistance()` and `IntermediateWalkDistance()` compute them.
+// This takes constant time, using `polyline.cumulative_lengths`, and returns
+// `std::nullopt` if those aren't available.
+//
+// Comparisons that are decided by the bounds therefore have the same result as
+// they would with the summed walk distance, and only comparisons that are too
+// close to call need the walk distance to be summed.
+std::optional<WalkDistanceBounds> BoundWalkDistance(
+    const PolylineData& polyline, int begin_index, int end_index,
+    float initial_distance) {
+  if (polyline.cumulative_lengths.size() != polyline.segments.size() + 1) {
+    return std::nullopt;
+  }
+  double sum = initial_distance;
+  if (begin_index < end_index) {
+    sum += polyline.cumulative_lengths[end_index] -
+           polyline.cumulative_lengths[begin_index];
+  }
+  // Summing k non-negative floats one at a time has a relative error of at
+  // most about k * 2^-24. The difference of the cumulative lengths has an
+  // absolute error of at most about n * 2^-53 times the total length. Both are
+  // doubled here for a comfortable margin.
+  int n_terms = std::max(end_index - begin_index, 0) + 1;
+  double error = std::ldexp(n_terms + 1.0, -23) * sum +
+                 std::ldexp(polyline.segments.size() + 1.0, -52) *
+                     polyline.cumulative_lengths.back() +
+                 std::numeric_limits<float>::denorm_min();
+  float infinity = std::numeric_limits<float>::infinity();
+  return WalkDistanceBounds{
+      .lower = std::nextafter(static_cast<float>(sum - error), -infinity),
+      .upper = std::nextafter(static_cast<float>(sum + error), infinity)};
+}
+
+// Returns true if `IntermediateWalkDistance(polyline, start_index, end_index)`
+// is greater than `threshold`, without summing the segment lengths unless the
+// result is too close to `threshold` to tell otherwise.
+bool IntermediateWalkDistanceExceeds(PolylineData& polyline, int start_index,
+                                     int end_index, float threshold) {
+  if (std::optional<WalkDistanceBounds> bounds =
+          BoundWalkDistance(polyline, start_index + 1, end_index, 0);
+      bounds.has_value()) {
+    if (bounds->lower > threshold) return true;
+    if (bounds->upper <= threshold) return false;
+  }
+  return IntermediateWalkDistance(polyline, start_index, end_index) >
+         threshold;
+}
+
+// Replaces `polyline` with the data for `points`, as returned by
+// `CreateNewPolylineData`, reusing the storage of its vectors.
+void ResetPolylineData(absl::Span<const Point> points, PolylineData& polyline) {
+  std::vector<SegmentBundle> segments = std::move(polyline.segments);
+  std::vector<double> cumulative_lengths =
+      std::move(polyline.cumulative_lengths);
+  segments.clear();
+  cumulative_lengths.clear();
+  polyline = PolylineData{.segments = std::move(segments),
+                          .cumulative_lengths = std::move(cumulative_lengths)};
 
   Point last_point = points[0];
   int segment_count = 0;
@@ -86,17 +154,47 @@ PolylineData CreateNewPolylineData(absl::Span<const Point> points) {
     }
   }
 
-  return polyline;
+  polyline.cumulative_lengths.reserve(polyline.segments.size() + 1);
+  double cumulative_length = 0;
+  polyline.cumulative_lengths.push_back(cumulative_length);
+  for (const SegmentBundle& segment : polyline.segments) {
+    cumulative_length += segment.length;
+    polyline.cumulative_lengths.push_back(cumulative_length);
+  }
 }
 
-// function for use in rtree traversals.
-auto segment_bounds = [](SegmentBundle segment_data) {
-  return Rect::FromTwoPoints(segment_data.segment.start,
-                             segment_data.segment.end);
+// Buffers that are reused across calls on the same thread; see
+// `GetPolylineScratch()`.
+struct PolylineScratch {
+  PolylineData polyline;
+  std::vector<Rect> segment_bounds;
+  StaticRTree<SegmentBundle> rtree;
 };
 
+// Returns the buffers for processing a polyline on the current thread. None of
+// the functions that use this are reentrant, so they can't be used twice at
+// once on the same thread.
+PolylineScratch& GetPolylineScratch() {
+  // Fall back to a single process-wide instance only if `thread_local` is
+  // unsupported, which should be almost never.
+#ifdef ABSL_HAVE_THREAD_LOCAL
+  thread_local
+#endif
+      PolylineScratch scratch;
+  return scratch;
+}
+
+}  // namespace
+
+PolylineData CreateNewPolylineData(absl::Span<const Point> points) {
+  PolylineData polyline;
+  ResetPolylineData(points, polyline);
+  return polyline;
+}
+
+
 void FindFirstAndLastIntersections(
-    ink::geometry_internal::StaticRTree<SegmentBundle> rtree,
+    const ink::geometry_internal::StaticRTree<SegmentBundle>& rtree,
     PolylineData& polyline) {
   SegmentBundle earliest_intersected_segment;
   std::pair<float, float> earliest_intersection_ratios =
@@ -117,10 +215,9 @@ void FindFirstAndLastIntersections(
                     SegmentIntersectionRatio(current_segment_bundle.segment,
                                              other_segment.segment);
                 intersection_ratios.has_value()) {
-              if (IntermediateWalkDistance(polyline,
-                                           current_segment_bundle.index,
-                                           other_segment.index) >
-                  polyline.min_walk_distance / 2.0f) {
+              if (IntermediateWalkDistanceExceeds(
+                      polyline, current_segment_bundle.index,
+                      other_segment.index, polyline.min_walk_distance / 2.0f)) {
                 if (intersection_ratios->first <
                     earliest_intersection_ratios.first) {
                   earliest_intersected_segment = other_segment;
@@ -185,9 +282,10 @@ void FindFirstAndLastIntersections(
                     SegmentIntersectionRatio(current_segment_bundle.segment,
                                              other_segment.segment);
                 intersection_ratios.has_value()) {
-              if (IntermediateWalkDistance(polyline, other_segment.index,
-                                           current_segment_bundle.index) >
-                  polyline.min_walk_distance / 2.0f) {
+              if (IntermediateWalkDistanceExceeds(
+                      polyline, other_segment.index,
+                      current_segment_bundle.index,
+                      polyline.min_walk_distance / 2.0f)) {
                 if (intersection_ratios->first > largest_intersection_ratio) {
                   largest_intersection_ratio = intersection_ratios->first;
                 }
@@ -215,13 +313,32 @@ bool EndpointIsConnectable(PolylineData& polyline, float index,
   // this will fail when the straight line and walk distance to the point is
   // very similar. If the line isn't sufficiently curvy then we don't want to
   // connect.
-  float walk_distance =
-      WalkDistance(polyline, index, fractional_index, walk_backwards);
-  if ((walk_distance < polyline.min_walk_distance) ||
-      (walk_distance / straight_line_distance <
-       polyline.min_connection_ratio)) {
-    return false;
+  auto is_too_short = [&polyline,
+                       straight_line_distance](float walk_distance) {
+    return walk_distance < polyline.min_walk_distance ||
+           walk_distance / straight_line_distance <
+               polyline.min_connection_ratio;
   };
+  // Both comparisons are monotonic in the walk distance, so they can usually be
+  // decided from bounds on it, without summing the segment lengths.
+  std::optional<WalkDistanceBounds> bounds;
+  int segment_index = index;
+  if (walk_backwards) {
+    bounds = BoundWalkDistance(
+        polyline, segment_index + 1, polyline.segments.size(),
+        polyline.segments[segment_index].length * (1.0 - fractional_index));
+  } else {
+    bounds = BoundWalkDistance(
+        polyline, 0, segment_index,
+        polyline.segments[segment_index].length * fractional_index);
+  }
+  if (bounds.has_value() && is_too_short(bounds->upper)) return false;
+  if (!bounds.has_value() || is_too_short(bounds->lower)) {
+    if (is_too_short(
+            WalkDistance(polyline, index, fractional_index, walk_backwards))) {
+      return false;
+    }
+  }
   if (polyline.has_intersection) {
     float walk_distance_to_intersection =
         walk_backwards ? polyline.last_intersection.walk_distance
@@ -299,7 +416,7 @@ inline bool BetterFirstIntersection(PolylineData& polyline,
 }
 
 void FindBestEndpointConnections(
-    ink::geometry_internal::StaticRTree<SegmentBundle> rtree,
+    const ink::geometry_internal::StaticRTree<SegmentBundle>& rtree,
     PolylineData& polyline) {
   Intersection best_first_point_connection;
   float best_first_point_connection_length =
@@ -402,8 +519,9 @@ void FindBestEndpointConnections(
   }
 }
 
-std::vector<Point> CreateNewPolylineFromPolylineData(PolylineData& polyline) {
-  std::vector<Point> new_polyline;
+void CreateNewPolylineFromPolylineData(PolylineData& polyline,
+                                       std::vector<Point>& new_polyline) {
+  new_polyline.clear();
 
   if (polyline.has_intersection) {
     int front_trim_index =
@@ -432,43 +550,75 @@ std::vector<Point> CreateNewPolylineFromPolylineData(PolylineData& polyline) {
       new_polyline.push_back(polyline.segments[i].segment.end);
     }
   }
-  return new_polyline;
 }
 
-std::vector<Point> ProcessPolyline(PolylineData& polyline) {
-  ink::geometry_internal::StaticRTree<SegmentBundle> rtree(polyline.segments,
-                                                           segment_bounds);
-  FindFirstAndLastIntersections(rtree, polyline);
-  FindBestEndpointConnections(rtree, polyline);
+void ProcessPolyline(PolylineScratch& scratch, std::vector<Point>& output) {
+  PolylineData& polyline = scratch.polyline;
+  scratch.segment_bounds.clear();
+  scratch.segment_bounds.reserve(polyline.segments.size());
+  for (const SegmentBundle& segment : polyline.segments) {
+    scratch.segment_bounds.push_back(
+        Rect::FromTwoPoints(segment.segment.start, segment.segment.end));
+  }
+  scratch.rtree.Rebuild(polyline.segments, scratch.segment_bounds);
+  FindFirstAndLastIntersections(scratch.rtree, polyline);
+  FindBestEndpointConnections(scratch.rtree, polyline);
 
-  return CreateNewPolylineFromPolylineData(polyline);
+  CreateNewPolylineFromPolylineData(polyline, output);
 }
 
 std::vector<Point> ProcessPolylineForMeshCreation(
     absl::Span<const Point> points, float min_walk_distance,
     float max_connection_distance, float min_connection_ratio,
     float min_trimming_ratio) {
-  PolylineData polyline = CreateNewPolylineData(points);
+  std::vector<Point> output;
+  ProcessPolylineForMeshCreation(points, min_walk_distance,
+                                 max_connection_distance, min_connection_ratio,
+                                 min_trimming_ratio, output);
+  return output;
+}
+
+void ProcessPolylineForMeshCreation(absl::Span<const Point> points,
+                                    float min_walk_distance,
+                                    float max_connection_distance,
+                                    float min_connection_ratio,
+                                    float min_trimming_ratio,
+                                    std::vector<Point>& output) {
+  PolylineScratch& scratch = GetPolylineScratch();
+  PolylineData& polyline = scratch.polyline;
+  ResetPolylineData(points, polyline);
 
   polyline.min_walk_distance = min_walk_distance;
   polyline.max_connection_distance = max_connection_distance;
   polyline.min_connection_ratio = min_connection_ratio;
   polyline.min_trimming_ratio = min_trimming_ratio;
 
-  return ProcessPolyline(polyline);
+  ProcessPolyline(scratch, output);
 }
 
 std::vector<Point> CreateClosedShape(absl::Span<const Point> points) {
+  std::vector<Point> output;
+  CreateClosedShape(points, output);
+  return output;
+}
+
+void CreateClosedShape(absl::Span<const Point> points,
+                       std::vector<Point>& output) {
   if (points.size() < 3) {
-    return std::vector<Point>(points.begin(), points.end());
+    output.assign(points.begin(), points.end());
+    return;
   }
-  PolylineData polyline = CreateNewPolylineData(points);
+  PolylineScratch& scratch = GetPolylineScratch();
+  PolylineData& polyline = scratch.polyline;
+  ResetPolylineData(points, polyline);
   if (polyline.segments.size() < 2) {
     if (polyline.segments.size() == 1) {
-      return {polyline.segments.front().segment.start,
-              polyline.segments.front().segment.end};
+      output.assign({polyline.segments.front().segment.start,
+                     polyline.segments.front().segment.end});
+      return;
     }
-    return {points.front()};
+    output.assign({points.front()});
+    return;
   }
   // Calculate the total walk distance of the polyline.
   for (size_t i = 0; i < polyline.segments.size(); ++i) {
@@ -491,7 +641,7 @@ std::vector<Point> CreateClosedShape(absl::Span<const Point> points) {
   polyline.min_connection_ratio = kMinConnectionRatio;
   polyline.min_trimming_ratio = kMinTrimmingRatio;
 
-  return ProcessPolyline(polyline);
+  ProcessPolyline(scratch, output);
 }
 
 }  // namespace ink::geometry_internal
@@ -40,6 +40,11 @@ struct Intersection {
 
 struct PolylineData {
   std::vector<SegmentBundle> segments;
+  // The total length of the first `i` segments, for each `i` from 0 to
+  // `segments.size()`, summed in double precision. This is used to bound walk
+  // distances without summing the segment lengths each time. If this doesn't
+  // have `segments.size() + 1` elements, then walk distances are always summed.
+  std::vector<double> cumulative_lengths;
   Intersection first_intersection;
   Intersection last_intersection;
   Point new_first_point;
@@ -58,13 +63,13 @@ struct PolylineData {
 // Finds the first and last intersections in the polyline and updates the input
 // PolylineData with the results.
 void FindFirstAndLastIntersections(
-    ink::geometry_internal::StaticRTree<SegmentBundle> rtree,
+    const ink::geometry_internal::StaticRTree<SegmentBundle>& rtree,
     PolylineData& polyline);
 
 // Finds the best connections for the first and last points of the polyline and
 // updates the input PolylineData with the results.
 void FindBestEndpointConnections(
-    ink::geometry_internal::StaticRTree<SegmentBundle> rtree,
+    const ink::geometry_internal::StaticRTree<SegmentBundle>& rtree,
     PolylineData& polyline);
 
 PolylineData CreateNewPolylineData(absl::Span<const Point> points);
@@ -113,12 +118,29 @@ std::vector<Point> ProcessPolylineForMeshCreation(
     float max_connection_distance, float min_connection_ratio,
     float min_trimming_ratio);
 
+// Like above, but replaces the contents of `output` with the result, reusing
+// its storage. The temporary buffers used by the algorithm are likewise reused
+// across calls on the same thread, so that repeatedly processing polylines of
+// a similar size, e.g. while a lasso is being drawn, does no heap allocation.
+void ProcessPolylineForMeshCreation(absl::Span<const Point> points,
+                                    float min_walk_distance,
+                                    float max_connection_distance,
+                                    float min_connection_ratio,
+                                    float min_trimming_ratio,
+                                    std::vector<Point>& output);
+
 // A version of ProcessPolylineForMeshCreation thats uses default parameters
 // which have been tested to work well for most shapes. If there are fewer than
 // 3 input points, or if there are fewer than 3 points remaining after removing
 // points with the same (x,y) coordinates as the previous point, this function
 // will return the remaining points.
 std::vector<Point> CreateClosedShape(absl::Span<const Point> points);
+
+// Like above, but replaces the contents of `output` with the result, without
+// heap allocation in the steady state; see `ProcessPolylineForMeshCreation`.
+void CreateClosedShape(absl::Span<const Point> points,
+                       std::vector<Point>& output);
+
 }  // namespace ink::geometry_internal
 
 #endif  // INK_GEOMETRY_INTERNAL_POLYLINE_PROCESSING_H_
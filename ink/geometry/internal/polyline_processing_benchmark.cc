@@ -0,0 +1,133 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ink/geometry/convex_hull.h"
+#include "ink/geometry/internal/polyline_processing.h"
+#include "ink/geometry/point.h"
+#include "ink/types/internal/allocation_counter.h"
+#include "ink/types/numbers.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+using ::ink::numbers::kPi;
+
+// Returns `n_points` points along a lasso gesture: a slightly noisy circle of
+// radius 100 that goes around 1.2 times, so that its ends overlap.
+std::vector<Point> MakeLasso(int n_points) {
+  std::mt19937_64 rng(0);
+  std::normal_distribution<float> noise(0, 0.2);
+  std::vector<Point> points;
+  points.reserve(n_points);
+  for (int i = 0; i < n_points; ++i) {
+    float theta = 2.4f * kPi * i / n_points;
+    points.push_back({100 * std::cos(theta) + noise(rng),
+                      100 * std::sin(theta) + noise(rng)});
+  }
+  return points;
+}
+
+// Returns `n_points` points along a random walk with unit-length steps, which
+// crosses itself many times.
+std::vector<Point> MakeScribble(int n_points) {
+  std::mt19937_64 rng(0);
+  std::uniform_real_distribution<float> turn(-0.5, 0.5);
+  std::vector<Point> points;
+  points.reserve(n_points);
+  Point point = {0, 0};
+  float heading = 0;
+  for (int i = 0; i < n_points; ++i) {
+    points.push_back(point);
+    heading += turn(rng);
+    point += {std::cos(heading), std::sin(heading)};
+  }
+  return points;
+}
+
+void BM_CreateClosedShapeFromLasso(benchmark::State& state) {
+  std::vector<Point> points = MakeLasso(state.range(0));
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    benchmark::DoNotOptimize(CreateClosedShape(points));
+  }
+}
+BENCHMARK(BM_CreateClosedShapeFromLasso)->Range(1000, 50000);
+
+void BM_CreateClosedShapeFromScribble(benchmark::State& state) {
+  std::vector<Point> points = MakeScribble(state.range(0));
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    benchmark::DoNotOptimize(CreateClosedShape(points));
+  }
+}
+BENCHMARK(BM_CreateClosedShapeFromScribble)->Range(1000, 50000);
+
+void BM_ProcessPolylineWithLongWalkDistance(benchmark::State& state) {
+  std::vector<Point> points = MakeScribble(state.range(0));
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    benchmark::DoNotOptimize(ProcessPolylineForMeshCreation(
+        points, /*min_walk_distance=*/100.0f,
+        /*max_connection_distance=*/50.0f, /*min_connection_ratio=*/1.2f,
+        /*min_trimming_ratio=*/1.8f));
+  }
+}
+BENCHMARK(BM_ProcessPolylineWithLongWalkDistance)->Range(1000, 50000);
+
+// The benchmarks below reuse their output and the per-thread scratch buffers,
+// as interactive callers do, and fail if that does any heap allocation once the
+// buffers have grown to size.
+void ExpectNoAllocationsInLoop(
+    benchmark::State& state,
+    ink_internal::ScopedAllocationCounters& allocation_counters) {
+  allocation_counters.Report();
+  if (allocation_counters.Allocations().allocations != 0) {
+    state.SkipWithError("Steady-state iterations allocated memory");
+  }
+}
+
+void BM_CreateClosedShapeFromLassoReusingOutput(benchmark::State& state) {
+  std::vector<Point> points = MakeLasso(state.range(0));
+  std::vector<Point> output;
+  CreateClosedShape(points, output);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    CreateClosedShape(points, output);
+    benchmark::DoNotOptimize(output);
+  }
+  ExpectNoAllocationsInLoop(state, allocation_counters);
+}
+BENCHMARK(BM_CreateClosedShapeFromLassoReusingOutput)->Range(1000, 50000);
+
+void BM_ConvexHullOfScribbleReusingOutput(benchmark::State& state) {
+  std::vector<Point> points = MakeScribble(state.range(0));
+  std::vector<Point> hull;
+  ConvexHull(points, hull);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    ConvexHull(points, hull);
+    benchmark::DoNotOptimize(hull);
+  }
+  ExpectNoAllocationsInLoop(state, allocation_counters);
+}
+BENCHMARK(BM_ConvexHullOfScribbleReusingOutput)->Range(1000, 50000);
+
+}  // namespace
+}  // namespace ink::geometry_internal
@@ -1185,6 +1185,37 @@ TEST(PolylineProcessingTest,
                    Point{5, 15}, Point{5, 8}, Point{5, 2.95}, Point{5.2, 3}}));
 }
 
+TEST(PolylineProcessingTest,
+     CreateClosedShapeOutputParameterReplacesContents) {
+  std::vector<Point> lasso = {Point{4.95, 3}, Point{11, 3},  Point{20, 10},
+                              Point{30, 20}, Point{20, 30}, Point{15, 25},
+                              Point{10, 20}, Point{5, 15},  Point{5, 8},
+                              Point{5, 3.2}};
+  std::vector<Point> line = {Point{0, 0}, Point{1, 0}, Point{2, 0}};
+
+  std::vector<Point> output = {Point{100, 100}};
+  // Alternate between inputs, so that each call reuses the buffers left over
+  // from a different polyline.
+  for (int i = 0; i < 2; ++i) {
+    CreateClosedShape(lasso, output);
+    EXPECT_THAT(output,
+                testing::Pointwise(PointsEq(), CreateClosedShape(lasso)));
+    CreateClosedShape(line, output);
+    EXPECT_THAT(output,
+                testing::Pointwise(PointsEq(), CreateClosedShape(line)));
+    ProcessPolylineForMeshCreation(lasso, /*min_walk_distance=*/10,
+                                   /*max_connection_distance=*/1,
+                                   /*min_connection_ratio=*/2,
+                                   /*min_trimming_ratio=*/1.8, output);
+    EXPECT_THAT(output, testing::Pointwise(
+                            PointsEq(), ProcessPolylineForMeshCreation(
+                                            lasso, /*min_walk_distance=*/10,
+                                            /*max_connection_distance=*/1,
+                                            /*min_connection_ratio=*/2,
+                                            /*min_trimming_ratio=*/1.8)));
+  }
+}
+
 void CreateClosedShapeDoesNotCrash(const std::vector<Point>& polyline) {
   CreateClosedShape(polyline);
 }
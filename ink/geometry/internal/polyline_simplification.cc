@@ -0,0 +1,91 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/internal/polyline_simplification.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/segment.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+// This can't use `ink::Distance`, since the distance library depends on
+// `PartitionedMesh`, which uses this library.
+float DistanceToSegment(Point point, const Segment& segment) {
+  float ratio = std::clamp(segment.Project(point).value_or(0.f), 0.f, 1.f);
+  return (point - segment.Lerp(ratio)).Magnitude();
+}
+
+}  // namespace
+
+std::vector<Point> SimplifyClosedPolyline(absl::Span<const Point> points,
+                                          float tolerance) {
+  if (points.size() < 4 || !(tolerance > 0)) {
+    return std::vector<Point>(points.begin(), points.end());
+  }
+  size_t n = points.size();
+
+  size_t split = 1;
+  float split_distance = 0;
+  for (size_t i = 1; i < n; ++i) {
+    float distance = (points[i] - points[0]).Magnitude();
+    if (distance > split_distance) {
+      split = i;
+      split_distance = distance;
+    }
+  }
+
+  std::vector<bool> keep(n, false);
+  keep[0] = true;
+  keep[split] = true;
+  // Ranges [first, last] of indices still to be simplified, where an index of
+  // `n` stands for the first point, closing the loop. This uses an explicit
+  // stack rather than recursion, since outlines can be very long.
+  std::vector<std::pair<size_t, size_t>> ranges = {{0, split}, {split, n}};
+  while (!ranges.empty()) {
+    auto [first, last] = ranges.back();
+    ranges.pop_back();
+    if (last - first < 2) continue;
+
+    Segment chord = {points[first], points[last % n]};
+    size_t farthest = first;
+    float farthest_distance = tolerance;
+    for (size_t i = first + 1; i < last; ++i) {
+      float distance = DistanceToSegment(points[i], chord);
+      if (distance > farthest_distance) {
+        farthest = i;
+        farthest_distance = distance;
+      }
+    }
+    if (farthest == first) continue;
+
+    keep[farthest] = true;
+    ranges.push_back({first, farthest});
+    ranges.push_back({farthest, last});
+  }
+
+  std::vector<Point> simplified;
+  for (size_t i = 0; i < n; ++i) {
+    if (keep[i]) simplified.push_back(points[i]);
+  }
+  return simplified;
+}
+
+}  // namespace ink::geometry_internal
@@ -0,0 +1,39 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_GEOMETRY_INTERNAL_POLYLINE_SIMPLIFICATION_H_
+#define INK_GEOMETRY_INTERNAL_POLYLINE_SIMPLIFICATION_H_
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "ink/geometry/point.h"
+
+namespace ink::geometry_internal {
+
+// Simplifies the closed polyline `points` (whose last point implicitly
+// connects back to the first) with the Douglas-Peucker algorithm, returning a
+// subset of `points`, in order, such that every dropped point lies within
+// `tolerance` of the simplified polyline. The loop is split at the first point
+// and the point farthest from it, both of which are always kept, and each half
+// is simplified on its own.
+//
+// Returns a copy of `points` if there are fewer than four of them, or if
+// `tolerance` is not greater than zero.
+std::vector<Point> SimplifyClosedPolyline(absl::Span<const Point> points,
+                                          float tolerance);
+
+}  // namespace ink::geometry_internal
+
+#endif  // INK_GEOMETRY_INTERNAL_POLYLINE_SIMPLIFICATION_H_
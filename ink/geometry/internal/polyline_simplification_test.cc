@@ -0,0 +1,83 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/internal/polyline_simplification.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "fuzztest/fuzztest.h"
+#include "ink/geometry/fuzz_domains.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/type_matchers.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::Le;
+using ::testing::SizeIs;
+
+TEST(PolylineSimplificationTest, KeepsShortPolylines) {
+  std::vector<Point> triangle = {{0, 0}, {10, 0}, {5, 0.1}};
+  EXPECT_THAT(SimplifyClosedPolyline(triangle, 1), ElementsAreArray(triangle));
+}
+
+TEST(PolylineSimplificationTest, ZeroToleranceKeepsEveryPoint) {
+  std::vector<Point> square = {{0, 0}, {5, 0}, {10, 0}, {10, 10}, {0, 10}};
+  EXPECT_THAT(SimplifyClosedPolyline(square, 0), ElementsAreArray(square));
+  EXPECT_THAT(SimplifyClosedPolyline(square, -1), ElementsAreArray(square));
+}
+
+TEST(PolylineSimplificationTest, DropsPointsWithinTolerance) {
+  std::vector<Point> square = {{0, 0},   {5, 0.1}, {10, 0}, {10.1, 5},
+                               {10, 10}, {5, 9.9}, {0, 10}, {-0.1, 5}};
+  EXPECT_THAT(SimplifyClosedPolyline(square, 0.5),
+              ElementsAre(PointEq({0, 0}), PointEq({10, 0}), PointEq({10, 10}),
+                          PointEq({0, 10})));
+  EXPECT_THAT(SimplifyClosedPolyline(square, 0.05), ElementsAreArray(square));
+}
+
+TEST(PolylineSimplificationTest, SimplifiesTheClosingEdge) {
+  // The last point is only kept because of its distance to the edge that
+  // closes the loop back to the first point.
+  std::vector<Point> polyline = {{0, 0},  {10, 0},     {10, 10},
+                                 {0, 10}, {-1.5, 5.5}, {-3, 1}};
+  EXPECT_THAT(SimplifyClosedPolyline(polyline, 1),
+              ElementsAre(PointEq({0, 0}), PointEq({10, 0}), PointEq({10, 10}),
+                          PointEq({0, 10}), PointEq({-3, 1})));
+}
+
+TEST(PolylineSimplificationTest, CollapsesCollinearPointsToTheirEnds) {
+  std::vector<Point> line = {{0, 0}, {1, 0}, {2, 0}, {3, 0}, {2, 0}, {1, 0}};
+  EXPECT_THAT(SimplifyClosedPolyline(line, 0.01),
+              ElementsAre(PointEq({0, 0}), PointEq({3, 0})));
+}
+
+void SimplifyClosedPolylineReturnsASubsetNoLargerThanTheInput(
+    const std::vector<Point>& points, float tolerance) {
+  std::vector<Point> simplified = SimplifyClosedPolyline(points, tolerance);
+  EXPECT_THAT(simplified, SizeIs(Le(points.size())));
+  if (!points.empty()) {
+    EXPECT_THAT(simplified.front(), PointEq(points.front()));
+  }
+}
+FUZZ_TEST(PolylineSimplificationTest,
+          SimplifyClosedPolylineReturnsASubsetNoLargerThanTheInput)
+    .WithDomains(fuzztest::VectorOf(FinitePoint()), fuzztest::Finite<float>());
+
+}  // namespace
+}  // namespace ink::geometry_internal
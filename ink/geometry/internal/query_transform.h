@@ -0,0 +1,131 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_GEOMETRY_INTERNAL_QUERY_TRANSFORM_H_
+#define INK_GEOMETRY_INTERNAL_QUERY_TRANSFORM_H_
+
+#include <utility>
+
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+#include "ink/geometry/vec.h"
+
+namespace ink::geometry_internal {
+
+// These are stand-ins for `AffineTransform`, for transforms of a restricted
+// form that can be applied to queries more cheaply than a general affine
+// transform. None of them rotate or skew, so they map a `Rect` to a `Rect`,
+// rather than to a `Quad` as `AffineTransform::Apply` does; this keeps the
+// cheaper `Rect` intersection tests for axis-aligned queries.
+//
+// Each has the same `Apply` overloads as `AffineTransform` (except that the
+// `Rect` overload returns a `Rect`), so that code which transforms queries can
+// be written as a template over the transform type; see
+// `VisitSpecializedQueryTransform` below.
+
+// The identity transform.
+struct IdentityQueryTransform {
+  template <typename T>
+  T Apply(const T& value) const {
+    return value;
+  }
+};
+
+// A transform that only translates, by `offset`.
+struct TranslationQueryTransform {
+  Point Apply(Point p) const { return p + offset; }
+  Segment Apply(const Segment& s) const {
+    return {Apply(s.start), Apply(s.end)};
+  }
+  Triangle Apply(const Triangle& t) const {
+    return {Apply(t.p0), Apply(t.p1), Apply(t.p2)};
+  }
+  Rect Apply(const Rect& r) const {
+    return Rect::FromTwoPoints(Apply(Point{r.XMin(), r.YMin()}),
+                               Apply(Point{r.XMax(), r.YMax()}));
+  }
+  Quad Apply(const Quad& q) const {
+    Quad result = q;
+    result.SetCenter(Apply(q.Center()));
+    return result;
+  }
+
+  Vec offset;
+};
+
+// A transform that scales each axis independently, about the origin, and then
+// translates; i.e. an `AffineTransform` with b = d = 0. This includes uniform
+// scales.
+struct ScaleAndTranslationQueryTransform {
+  Point Apply(Point p) const {
+    return {x_scale * p.x + offset.x, y_scale * p.y + offset.y};
+  }
+  Segment Apply(const Segment& s) const {
+    return {Apply(s.start), Apply(s.end)};
+  }
+  Triangle Apply(const Triangle& t) const {
+    return {Apply(t.p0), Apply(t.p1), Apply(t.p2)};
+  }
+  Rect Apply(const Rect& r) const {
+    return Rect::FromTwoPoints(Apply(Point{r.XMin(), r.YMin()}),
+                               Apply(Point{r.XMax(), r.YMax()}));
+  }
+  Quad Apply(const Quad& q) const {
+    // A scaled `Quad` can change its rotation and skew, so this uses the
+    // general formula.
+    return AffineTransform(x_scale, 0, offset.x, 0, y_scale, offset.y).Apply(q);
+  }
+
+  float x_scale;
+  float y_scale;
+  Vec offset;
+};
+
+// Calls `visitor` with the most specialized of the query transforms above that
+// is equivalent to `transform`, or with `transform` itself if none of them is,
+// and returns the result. This lets the transform type be chosen once, at the
+// entry point of a query, so that the code that transforms the query is
+// compiled separately for each kind of transform.
+//
+// `Visitor` must be callable with a const reference to each of
+// `IdentityQueryTransform`, `TranslationQueryTransform`,
+// `ScaleAndTranslationQueryTransform` and `AffineTransform`, returning the same
+// type in each case; typically it is a generic lambda.
+template <typename Visitor>
+decltype(auto) VisitSpecializedQueryTransform(const AffineTransform& transform,
+                                              Visitor&& visitor) {
+  if (transform.B() == 0 && transform.D() == 0) {
+    if (transform.A() == 1 && transform.E() == 1) {
+      if (transform.C() == 0 && transform.F() == 0) {
+        return std::forward<Visitor>(visitor)(IdentityQueryTransform{});
+      }
+      return std::forward<Visitor>(visitor)(TranslationQueryTransform{
+          .offset = {transform.C(), transform.F()}});
+    }
+    return std::forward<Visitor>(visitor)(ScaleAndTranslationQueryTransform{
+        .x_scale = transform.A(),
+        .y_scale = transform.E(),
+        .offset = {transform.C(), transform.F()}});
+  }
+  return std::forward<Visitor>(visitor)(transform);
+}
+
+}  // namespace ink::geometry_internal
+
+#endif  // INK_GEOMETRY_INTERNAL_QUERY_TRANSFORM_H_
@@ -0,0 +1,108 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/internal/query_transform.h"
+
+#include <type_traits>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+#include "ink/geometry/type_matchers.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+enum class Kind { kIdentity, kTranslation, kScaleAndTranslation, kGeneral };
+
+Kind SpecializedKind(const AffineTransform& transform) {
+  return VisitSpecializedQueryTransform(
+      transform, [](const auto& specialized) {
+        using T = std::decay_t<decltype(specialized)>;
+        if constexpr (std::is_same_v<T, IdentityQueryTransform>) {
+          return Kind::kIdentity;
+        } else if constexpr (std::is_same_v<T, TranslationQueryTransform>) {
+          return Kind::kTranslation;
+        } else if constexpr (std::is_same_v<
+                                 T, ScaleAndTranslationQueryTransform>) {
+          return Kind::kScaleAndTranslation;
+        } else {
+          return Kind::kGeneral;
+        }
+      });
+}
+
+TEST(QueryTransformTest, SelectsMostSpecializedTransform) {
+  EXPECT_EQ(SpecializedKind(AffineTransform()), Kind::kIdentity);
+  EXPECT_EQ(SpecializedKind(AffineTransform::Translate({3, -4})),
+            Kind::kTranslation);
+  EXPECT_EQ(SpecializedKind(AffineTransform::Scale(2)),
+            Kind::kScaleAndTranslation);
+  EXPECT_EQ(SpecializedKind(AffineTransform::Translate({1, 2}) *
+                            AffineTransform::Scale(-1, 3)),
+            Kind::kScaleAndTranslation);
+  EXPECT_EQ(SpecializedKind(AffineTransform::Rotate(Angle::Degrees(30))),
+            Kind::kGeneral);
+  EXPECT_EQ(SpecializedKind(AffineTransform::SkewX(0.5)), Kind::kGeneral);
+}
+
+TEST(QueryTransformTest, MatchesAffineTransformForPointsSegmentsTriangles) {
+  Point point = {1.5, -2};
+  Segment segment = {{0, 1}, {-3, 4}};
+  Triangle triangle = {{0, 0}, {5, 1}, {2, 7}};
+  for (const AffineTransform& transform :
+       {AffineTransform(), AffineTransform::Translate({3, -4}),
+        AffineTransform::Scale(2.5), AffineTransform(-2, 0, 7, 0, 0.5, -1)}) {
+    VisitSpecializedQueryTransform(transform, [&](const auto& specialized) {
+      EXPECT_THAT(specialized.Apply(point), PointEq(transform.Apply(point)));
+      EXPECT_THAT(specialized.Apply(segment),
+                  SegmentEq(transform.Apply(segment)));
+      EXPECT_THAT(specialized.Apply(triangle),
+                  TriangleEq(transform.Apply(triangle)));
+    });
+  }
+}
+
+TEST(QueryTransformTest, KeepsRectsAsRects) {
+  Rect rect = Rect::FromTwoPoints({-1, 2}, {3, 5});
+  EXPECT_THAT(IdentityQueryTransform{}.Apply(rect), RectEq(rect));
+  TranslationQueryTransform translation = {.offset = {10, -1}};
+  EXPECT_THAT(translation.Apply(rect),
+              RectEq(Rect::FromTwoPoints({9, 1}, {13, 4})));
+  ScaleAndTranslationQueryTransform scale = {
+      .x_scale = -2, .y_scale = 3, .offset = {1, 1}};
+  EXPECT_THAT(scale.Apply(rect), RectEq(Rect::FromTwoPoints({3, 7}, {-5, 16})));
+}
+
+TEST(QueryTransformTest, MatchesAffineTransformForQuads) {
+  Quad quad = Quad::FromCenterDimensionsRotationAndSkew(
+      {1, 2}, 4, 3, Angle::Degrees(30), 0.5);
+  TranslationQueryTransform translation = {.offset = {3, -4}};
+  EXPECT_THAT(translation.Apply(quad),
+              QuadNear(AffineTransform::Translate({3, -4}).Apply(quad), 1e-5));
+  ScaleAndTranslationQueryTransform scale = {
+      .x_scale = -2, .y_scale = 0.5, .offset = {7, -1}};
+  EXPECT_THAT(scale.Apply(quad),
+              QuadEq(AffineTransform(-2, 0, 7, 0, 0.5, -1).Apply(quad)));
+}
+
+}  // namespace
+}  // namespace ink::geometry_internal
@@ -0,0 +1,249 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/internal/robust_predicates.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#include "absl/log/absl_check.h"
+#include "absl/types/span.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+// Half the machine epsilon of `double`, i.e. the largest relative error of a
+// single rounded operation.
+constexpr double kEpsilon = std::numeric_limits<double>::epsilon() / 2;
+
+// The relative error bound on the `double` evaluation of the orientation
+// determinant; this is Shewchuk's `ccwerrboundA`.
+constexpr double kOrientationErrorBound = (3 + 16 * kEpsilon) * kEpsilon;
+
+static_assert(std::numeric_limits<double>::digits >=
+                  2 * std::numeric_limits<float>::digits,
+              "The product of two floats must be exact in double");
+
+Orientation SignToOrientation(double value) {
+  if (value > 0) return Orientation::kCounterClockwise;
+  if (value < 0) return Orientation::kClockwise;
+  return Orientation::kCollinear;
+}
+
+// Sets `sum + error` to exactly `a + b` (Knuth's TwoSum).
+void TwoSum(double a, double b, double& sum, double& error) {
+  sum = a + b;
+  double b_virtual = sum - a;
+  double a_virtual = sum - b_virtual;
+  error = (a - a_virtual) + (b - b_virtual);
+}
+
+// Returns the sign of the exact orientation determinant. Each of the six terms
+// of the expanded determinant is a product of two `float`s, and so is exact in
+// `double`; their sum is then computed exactly as a nonoverlapping expansion,
+// whose sign is that of its largest-magnitude nonzero component.
+Orientation ExactOrientationFallback(Point a, Point b, Point c) {
+  double terms[6] = {
+      static_cast<double>(a.x) * b.y,  -static_cast<double>(a.x) * c.y,
+      -static_cast<double>(b.x) * a.y, static_cast<double>(b.x) * c.y,
+      static_cast<double>(c.x) * a.y,  -static_cast<double>(c.x) * b.y,
+  };
+  // Shewchuk's Grow-Expansion: `expansion` holds components in increasing
+  // order of magnitude.
+  std::array<double, 6> expansion;
+  size_t expansion_size = 0;
+  for (double term : terms) {
+    double carry = term;
+    for (size_t i = 0; i < expansion_size; ++i) {
+      TwoSum(carry, expansion[i], carry, expansion[i]);
+    }
+    expansion[expansion_size++] = carry;
+  }
+  for (size_t i = expansion_size; i > 0; --i) {
+    if (expansion[i - 1] != 0) return SignToOrientation(expansion[i - 1]);
+  }
+  return Orientation::kCollinear;
+}
+
+// Computes orientations relative to the directed line from `a` to `b`, with
+// the differences that depend only on the line computed once.
+class LineOrientation {
+ public:
+  LineOrientation(Point a, Point b)
+      : a_(a),
+        b_(b),
+        dx_(static_cast<double>(b.x) - a.x),
+        dy_(static_cast<double>(b.y) - a.y) {}
+
+  Orientation Of(Point c) const {
+    double left = dx_ * (static_cast<double>(c.y) - a_.y);
+    double right = dy_ * (static_cast<double>(c.x) - a_.x);
+    double det = left - right;
+    // If the two products have opposite signs, or either is zero, the sign of
+    // their difference is computed correctly.
+    double det_sum;
+    if (left > 0) {
+      if (right <= 0) return SignToOrientation(det);
+      det_sum = left + right;
+    } else if (left < 0) {
+      if (right >= 0) return SignToOrientation(det);
+      det_sum = -left - right;
+    } else {
+      return SignToOrientation(det);
+    }
+    double error_bound = kOrientationErrorBound * det_sum;
+    if (det >= error_bound || -det >= error_bound) {
+      return SignToOrientation(det);
+    }
+    return ExactOrientationFallback(a_, b_, c);
+  }
+
+ private:
+  Point a_;
+  Point b_;
+  double dx_;
+  double dy_;
+};
+
+// Returns whether `point` lies within the bounding box of `segment`. For a
+// point that is collinear with the segment, this is whether it lies on it.
+bool InSegmentBounds(const Segment& segment, Point point) {
+  return std::min(segment.start.x, segment.end.x) <= point.x &&
+         point.x <= std::max(segment.start.x, segment.end.x) &&
+         std::min(segment.start.y, segment.end.y) <= point.y &&
+         point.y <= std::max(segment.start.y, segment.end.y);
+}
+
+// Returns whether the segments intersect, given the orientations of `b`'s
+// endpoints relative to `a`, and of `a`'s endpoints relative to `b`.
+bool SegmentsIntersect(const Segment& a, const Segment& b,
+                       Orientation b_start_to_a, Orientation b_end_to_a,
+                       Orientation a_start_to_b, Orientation a_end_to_b) {
+  auto opposite = [](Orientation o1, Orientation o2) {
+    return static_cast<int>(o1) * static_cast<int>(o2) < 0;
+  };
+  if (opposite(b_start_to_a, b_end_to_a) &&
+      opposite(a_start_to_b, a_end_to_b)) {
+    return true;
+  }
+  // Otherwise, the segments can only intersect at an endpoint of one that lies
+  // on the other. This also covers degenerate and collinear segments, for which
+  // every orientation is `kCollinear`.
+  return (b_start_to_a == Orientation::kCollinear &&
+          InSegmentBounds(a, b.start)) ||
+         (b_end_to_a == Orientation::kCollinear && InSegmentBounds(a, b.end)) ||
+         (a_start_to_b == Orientation::kCollinear &&
+          InSegmentBounds(b, a.start)) ||
+         (a_end_to_b == Orientation::kCollinear && InSegmentBounds(b, a.end));
+}
+
+// Precomputes the edge lines of a triangle, for testing many points.
+class TriangleContainment {
+ public:
+  explicit TriangleContainment(const Triangle& triangle)
+      : triangle_(triangle),
+        edges_{LineOrientation(triangle.p0, triangle.p1),
+               LineOrientation(triangle.p1, triangle.p2),
+               LineOrientation(triangle.p2, triangle.p0)},
+        orientation_(edges_[0].Of(triangle.p2)) {}
+
+  bool Contains(Point point) const {
+    if (orientation_ == Orientation::kCollinear) {
+      // The triangle is degenerate, so it contains exactly the points on its
+      // edges.
+      for (int i = 0; i < 3; ++i) {
+        if (edges_[i].Of(point) == Orientation::kCollinear &&
+            InSegmentBounds(triangle_.GetEdge(i), point)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    // The point is contained unless it lies strictly on the outer side of any
+    // edge.
+    Orientation outside = orientation_ == Orientation::kCounterClockwise
+                              ? Orientation::kClockwise
+                              : Orientation::kCounterClockwise;
+    return edges_[0].Of(point) != outside && edges_[1].Of(point) != outside &&
+           edges_[2].Of(point) != outside;
+  }
+
+ private:
+  Triangle triangle_;
+  LineOrientation edges_[3];
+  Orientation orientation_;
+};
+
+}  // namespace
+
+Orientation ExactOrientation(Point a, Point b, Point c) {
+  return LineOrientation(a, b).Of(c);
+}
+
+bool ExactIntersects(const Segment& a, const Segment& b) {
+  LineOrientation line_a(a.start, a.end);
+  LineOrientation line_b(b.start, b.end);
+  return SegmentsIntersect(a, b, line_a.Of(b.start), line_a.Of(b.end),
+                           line_b.Of(a.start), line_b.Of(a.end));
+}
+
+bool ExactContains(const Triangle& triangle, Point point) {
+  return TriangleContainment(triangle).Contains(point);
+}
+
+void ExactOrientations(Point a, Point b, absl::Span<const Point> points,
+                       absl::Span<Orientation> results) {
+  ABSL_CHECK_EQ(points.size(), results.size());
+  LineOrientation line(a, b);
+  for (size_t i = 0; i < points.size(); ++i) {
+    results[i] = line.Of(points[i]);
+  }
+}
+
+void ExactIntersects(const Segment& a, absl::Span<const Segment> segments,
+                     absl::Span<bool> results) {
+  ABSL_CHECK_EQ(segments.size(), results.size());
+  LineOrientation line_a(a.start, a.end);
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const Segment& b = segments[i];
+    Orientation b_start_to_a = line_a.Of(b.start);
+    Orientation b_end_to_a = line_a.Of(b.end);
+    // If `b` lies strictly on one side of `a`, there's no need to compute the
+    // orientations relative to `b`.
+    if (b_start_to_a == b_end_to_a && b_start_to_a != Orientation::kCollinear) {
+      results[i] = false;
+      continue;
+    }
+    LineOrientation line_b(b.start, b.end);
+    results[i] = SegmentsIntersect(a, b, b_start_to_a, b_end_to_a,
+                                   line_b.Of(a.start), line_b.Of(a.end));
+  }
+}
+
+void ExactContains(const Triangle& triangle, absl::Span<const Point> points,
+                   absl::Span<bool> results) {
+  ABSL_CHECK_EQ(points.size(), results.size());
+  TriangleContainment containment(triangle);
+  for (size_t i = 0; i < points.size(); ++i) {
+    results[i] = containment.Contains(points[i]);
+  }
+}
+
+}  // namespace ink::geometry_internal
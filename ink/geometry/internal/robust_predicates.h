@@ -0,0 +1,79 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_GEOMETRY_INTERNAL_ROBUST_PREDICATES_H_
+#define INK_GEOMETRY_INTERNAL_ROBUST_PREDICATES_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink::geometry_internal {
+
+// Geometric predicates on `float` coordinates whose results are exact, i.e.
+// they are what the predicate would return if evaluated with real numbers.
+//
+// Unlike the `Intersects` family, which evaluates its determinants in `float`
+// and so may misclassify nearly-degenerate configurations, and unlike
+// `PositionRelativeToLine`, which widens "collinear" by a tolerance, these
+// never contradict each other: e.g. a point that lies on the shared edge of two
+// triangles is contained by both, and any other point is contained by at most
+// one of them.
+//
+// Each predicate first evaluates its determinants in `double`, along with a
+// bound on the rounding error, in the style of Shewchuk's adaptive predicates
+// ("Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric
+// Predicates", 1997). Only when the error bound doesn't rule out a sign change
+// are the determinants recomputed exactly, which is rare for non-degenerate
+// input. The exact fallback relies on products of two `float`s being exact in
+// `double`, so unlike Shewchuk's predicates, it needs no intermediate stages.
+//
+// The results are unspecified (but the functions are safe to call) if any
+// coordinate is infinite or NaN.
+
+enum class Orientation : int8_t {
+  kClockwise = -1,
+  kCollinear = 0,
+  kCounterClockwise = 1,
+};
+
+// Returns the orientation of the triangle (a, b, c), i.e. whether `c` lies to
+// the right of, on, or to the left of the directed line from `a` through `b`.
+// This is `kCollinear` if any two of the points are equal.
+Orientation ExactOrientation(Point a, Point b, Point c);
+
+// Returns whether the two closed segments share at least one point. A
+// degenerate segment is treated as a point.
+bool ExactIntersects(const Segment& a, const Segment& b);
+
+// Returns whether the closed triangle contains `point`. A degenerate triangle
+// is treated as a segment or point.
+bool ExactContains(const Triangle& triangle, Point point);
+
+// Batched versions of the above, which share the work that depends only on
+// the first argument. The results for `points[i]` or `segments[i]` are written
+// to `results[i]`; `results` must be the same size as `points` or `segments`.
+void ExactOrientations(Point a, Point b, absl::Span<const Point> points,
+                       absl::Span<Orientation> results);
+void ExactIntersects(const Segment& a, absl::Span<const Segment> segments,
+                     absl::Span<bool> results);
+void ExactContains(const Triangle& triangle, absl::Span<const Point> points,
+                   absl::Span<bool> results);
+
+}  // namespace ink::geometry_internal
+
+#endif  // INK_GEOMETRY_INTERNAL_ROBUST_PREDICATES_H_
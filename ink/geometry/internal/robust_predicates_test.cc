@@ -0,0 +1,244 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/internal/robust_predicates.h"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "fuzztest/fuzztest.h"
+#include "absl/types/span.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+#include "ink/geometry/vec.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+constexpr float kInf = std::numeric_limits<float>::infinity();
+
+float NextUp(float value) { return std::nextafter(value, kInf); }
+float NextDown(float value) { return std::nextafter(value, -kInf); }
+
+Orientation Reverse(Orientation orientation) {
+  return static_cast<Orientation>(-static_cast<int>(orientation));
+}
+
+TEST(RobustPredicatesTest, OrientationOfSimpleTriangles) {
+  EXPECT_EQ(ExactOrientation({0, 0}, {1, 0}, {0, 1}),
+            Orientation::kCounterClockwise);
+  EXPECT_EQ(ExactOrientation({0, 0}, {1, 0}, {0, -1}),
+            Orientation::kClockwise);
+  EXPECT_EQ(ExactOrientation({0, 0}, {1, 0}, {5, 0}), Orientation::kCollinear);
+  EXPECT_EQ(ExactOrientation({0, 0}, {0, 0}, {5, 7}), Orientation::kCollinear);
+  EXPECT_EQ(ExactOrientation({3, 4}, {5, 7}, {3, 4}), Orientation::kCollinear);
+}
+
+TEST(RobustPredicatesTest, OrientationOfNearlyCollinearPoints) {
+  // Points on the line y = x are exactly collinear, whatever their magnitude,
+  // and the next float above the line is exactly to its left.
+  for (float t : {1e-30f, 0.1f, 0.7f, 3.f, 12345.678f, 1e20f}) {
+    EXPECT_EQ(ExactOrientation({-1e30, -1e30}, {1e30, 1e30}, {t, t}),
+              Orientation::kCollinear)
+        << "t = " << t;
+    EXPECT_EQ(ExactOrientation({-1e30, -1e30}, {1e30, 1e30}, {t, NextUp(t)}),
+              Orientation::kCounterClockwise)
+        << "t = " << t;
+    EXPECT_EQ(ExactOrientation({-1e30, -1e30}, {1e30, 1e30}, {t, NextDown(t)}),
+              Orientation::kClockwise)
+        << "t = " << t;
+  }
+
+  // The `float` determinant rounds to zero here, since `c - a` rounds to
+  // `-a`.
+  Point a = {1e10, 1e10};
+  Point b = {-1e10, -1e10};
+  Point c = {1e-10, 0};
+  EXPECT_EQ(Vec::Determinant(b - a, c - a), 0);
+  EXPECT_EQ(ExactOrientation(a, b, c), Orientation::kCounterClockwise);
+}
+
+TEST(RobustPredicatesTest, OrientationWithSubnormalCoordinates) {
+  float tiny = std::numeric_limits<float>::denorm_min();
+  EXPECT_EQ(ExactOrientation({0, 0}, {tiny, 0}, {0, tiny}),
+            Orientation::kCounterClockwise);
+  EXPECT_EQ(ExactOrientation({0, 0}, {tiny, tiny}, {2 * tiny, 2 * tiny}),
+            Orientation::kCollinear);
+}
+
+TEST(RobustPredicatesTest, IntersectsCrossingAndDisjointSegments) {
+  EXPECT_TRUE(
+      ExactIntersects(Segment{{0, 0}, {2, 2}}, Segment{{0, 2}, {2, 0}}));
+  EXPECT_FALSE(
+      ExactIntersects(Segment{{0, 0}, {2, 2}}, Segment{{3, 0}, {5, -2}}));
+  // Parallel, but not collinear.
+  EXPECT_FALSE(
+      ExactIntersects(Segment{{0, 0}, {2, 2}}, Segment{{0, 1}, {2, 3}}));
+}
+
+TEST(RobustPredicatesTest, IntersectsTouchingSegments) {
+  // At a shared endpoint.
+  EXPECT_TRUE(
+      ExactIntersects(Segment{{0, 0}, {1, 1}}, Segment{{1, 1}, {2, 0}}));
+  // An endpoint on the interior of the other segment.
+  EXPECT_TRUE(
+      ExactIntersects(Segment{{0, 0}, {2, 2}}, Segment{{1, 1}, {2, 0}}));
+  // An endpoint just past the other segment.
+  EXPECT_FALSE(ExactIntersects(Segment{{0, 0.1}, {0.3, 0.4}},
+                               Segment{{NextUp(0.3), 0.4}, {1, 0}}));
+}
+
+TEST(RobustPredicatesTest, IntersectsCollinearSegments) {
+  EXPECT_TRUE(
+      ExactIntersects(Segment{{0, 0}, {2, 2}}, Segment{{1, 1}, {3, 3}}));
+  EXPECT_TRUE(
+      ExactIntersects(Segment{{0, 0}, {3, 3}}, Segment{{2, 2}, {1, 1}}));
+  EXPECT_TRUE(
+      ExactIntersects(Segment{{0, 0}, {1, 1}}, Segment{{1, 1}, {3, 3}}));
+  EXPECT_FALSE(
+      ExactIntersects(Segment{{0, 0}, {1, 1}}, Segment{{2, 2}, {3, 3}}));
+}
+
+TEST(RobustPredicatesTest, IntersectsDegenerateSegments) {
+  EXPECT_TRUE(
+      ExactIntersects(Segment{{1, 1}, {1, 1}}, Segment{{0, 0}, {2, 2}}));
+  EXPECT_FALSE(
+      ExactIntersects(Segment{{1, NextUp(1)}, {1, NextUp(1)}},
+                      Segment{{0, 0}, {2, 2}}));
+  EXPECT_TRUE(
+      ExactIntersects(Segment{{1, 1}, {1, 1}}, Segment{{1, 1}, {1, 1}}));
+  EXPECT_FALSE(
+      ExactIntersects(Segment{{1, 1}, {1, 1}}, Segment{{2, 1}, {2, 1}}));
+}
+
+TEST(RobustPredicatesTest, ContainsPointsInAndOnTriangle) {
+  for (Triangle triangle : {Triangle{{0, 0}, {4, 0}, {0, 4}},
+                            Triangle{{0, 0}, {0, 4}, {4, 0}}}) {
+    EXPECT_TRUE(ExactContains(triangle, {1, 1}));
+    EXPECT_TRUE(ExactContains(triangle, {0, 0}));
+    EXPECT_TRUE(ExactContains(triangle, {2, 0}));
+    EXPECT_TRUE(ExactContains(triangle, {2, 2}));
+    EXPECT_FALSE(ExactContains(triangle, {2, NextUp(2)}));
+    EXPECT_FALSE(ExactContains(triangle, {-1, 1}));
+    EXPECT_FALSE(ExactContains(triangle, {5, 5}));
+  }
+}
+
+TEST(RobustPredicatesTest, ContainsForDegenerateTriangles) {
+  Triangle segment_like = {{0, 0}, {1, 1}, {3, 3}};
+  EXPECT_TRUE(ExactContains(segment_like, {2, 2}));
+  EXPECT_TRUE(ExactContains(segment_like, {3, 3}));
+  EXPECT_FALSE(ExactContains(segment_like, {4, 4}));
+  EXPECT_FALSE(ExactContains(segment_like, {2, NextUp(2)}));
+
+  Triangle point_like = {{1, 2}, {1, 2}, {1, 2}};
+  EXPECT_TRUE(ExactContains(point_like, {1, 2}));
+  EXPECT_FALSE(ExactContains(point_like, {1, NextUp(2)}));
+}
+
+TEST(RobustPredicatesTest, PointOnSharedEdgeIsInBothTriangles) {
+  // Two triangles sharing an edge whose interior points are not exactly
+  // representable, tested against points that are on either side of it, or on
+  // it.
+  Point p = {0.1, 0.3};
+  Point q = {0.7, 0.9};
+  Triangle left = {p, q, {0, 1}};
+  Triangle right = {q, p, {1, 0}};
+  for (float x = 0.15; x < 0.7; x += 0.05) {
+    float y = x + 0.2f;
+    for (Point point :
+         {Point{x, NextDown(y)}, Point{x, y}, Point{x, NextUp(y)}}) {
+      bool in_left = ExactContains(left, point);
+      bool in_right = ExactContains(right, point);
+      Orientation orientation = ExactOrientation(p, q, point);
+      EXPECT_EQ(in_left, orientation != Orientation::kClockwise);
+      EXPECT_EQ(in_right, orientation != Orientation::kCounterClockwise);
+    }
+  }
+}
+
+TEST(RobustPredicatesTest, BatchedPredicatesMatchSingleCalls) {
+  std::vector<Point> points;
+  for (float x = -1; x <= 3; x += 0.25) {
+    for (float y = -1; y <= 3; y += 0.25) {
+      points.push_back({x, y});
+      points.push_back({x, NextUp(y)});
+    }
+  }
+  Triangle triangle = {{0, 0}, {2, 0.5}, {0.5, 2}};
+
+  std::vector<Orientation> orientations(points.size());
+  ExactOrientations(triangle.p1, triangle.p2, points,
+                    absl::MakeSpan(orientations));
+  std::unique_ptr<bool[]> contains(new bool[points.size()]);
+  ExactContains(triangle, points,
+                absl::MakeSpan(contains.get(), points.size()));
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(orientations[i],
+              ExactOrientation(triangle.p1, triangle.p2, points[i]));
+    EXPECT_EQ(contains[i], ExactContains(triangle, points[i]));
+  }
+
+  std::vector<Segment> segments;
+  for (size_t i = 0; i + 1 < points.size(); i += 7) {
+    segments.push_back({points[i], points[points.size() - 1 - i]});
+  }
+  Segment segment = {{0.25, -0.5}, {1.5, 2.5}};
+  std::unique_ptr<bool[]> intersects(new bool[segments.size()]);
+  ExactIntersects(segment, segments,
+                  absl::MakeSpan(intersects.get(), segments.size()));
+  for (size_t i = 0; i < segments.size(); ++i) {
+    EXPECT_EQ(intersects[i], ExactIntersects(segment, segments[i]));
+  }
+}
+
+void OrientationIsAntisymmetricAndCyclic(float ax, float ay, float bx,
+                                         float by, float cx, float cy) {
+  Point a = {ax, ay};
+  Point b = {bx, by};
+  Point c = {cx, cy};
+  Orientation orientation = ExactOrientation(a, b, c);
+  EXPECT_EQ(ExactOrientation(b, c, a), orientation);
+  EXPECT_EQ(ExactOrientation(c, a, b), orientation);
+  EXPECT_EQ(ExactOrientation(b, a, c), Reverse(orientation));
+  EXPECT_EQ(ExactOrientation(a, c, b), Reverse(orientation));
+}
+FUZZ_TEST(RobustPredicatesTest, OrientationIsAntisymmetricAndCyclic)
+    .WithDomains(fuzztest::Finite<float>(), fuzztest::Finite<float>(),
+                 fuzztest::Finite<float>(), fuzztest::Finite<float>(),
+                 fuzztest::Finite<float>(), fuzztest::Finite<float>());
+
+void IntersectsIsSymmetric(float ax, float ay, float bx, float by, float cx,
+                           float cy, float dx, float dy) {
+  Segment ab = {{ax, ay}, {bx, by}};
+  Segment cd = {{cx, cy}, {dx, dy}};
+  bool intersects = ExactIntersects(ab, cd);
+  EXPECT_EQ(ExactIntersects(cd, ab), intersects);
+  EXPECT_EQ(ExactIntersects(Segment{ab.end, ab.start},
+                            Segment{cd.end, cd.start}),
+            intersects);
+}
+FUZZ_TEST(RobustPredicatesTest, IntersectsIsSymmetric)
+    .WithDomains(fuzztest::Finite<float>(), fuzztest::Finite<float>(),
+                 fuzztest::Finite<float>(), fuzztest::Finite<float>(),
+                 fuzztest::Finite<float>(), fuzztest::Finite<float>(),
+                 fuzztest::Finite<float>(), fuzztest::Finite<float>());
+
+}  // namespace
+}  // namespace ink::geometry_internal
@@ -15,18 +15,27 @@
 #ifndef INK_GEOMETRY_INTERNAL_STATIC_RTREE_H_
 #define INK_GEOMETRY_INTERNAL_STATIC_RTREE_H_
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <queue>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/config.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/function_ref.h"
 #include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/envelope.h"
 #include "ink/geometry/internal/intersects_internal.h"
 #include "ink/geometry/rect.h"
@@ -61,6 +70,20 @@ class StaticRTree {
   static_assert(kBranchingFactor >= 2,
                 "kBranchingFactor must be at least 2 to form a tree");
 
+  // The maximum number of children of each `BranchNode`.
+  static constexpr uint32_t kMaxChildrenPerNode = kBranchingFactor;
+
+  // The bounding rectangles of the children of a `BranchNode`, stored as one
+  // array per coordinate, so that a query can be tested against all of the
+  // children with a single loop that the compiler can vectorize. Only the first
+  // `BranchNode::child_indices.Size()` entries of each array are meaningful.
+  struct ChildBounds {
+    std::array<float, kBranchingFactor> x_min = {};
+    std::array<float, kBranchingFactor> y_min = {};
+    std::array<float, kBranchingFactor> x_max = {};
+    std::array<float, kBranchingFactor> y_max = {};
+  };
+
   // A branch node in the tree, which has children but no data elements. This is
   // exposed only for testing, and should not be needed for normal use of the
   // `StaticRTree`.
@@ -74,6 +97,8 @@ class StaticRTree {
     // The indices of the children of this node, which may be branch nodes or
     // leaf nodes, per `is_leaf_parent`.
     SmallArray<uint32_t, kBranchingFactor> child_indices;
+    // The bounds of the children at `child_indices`, in the same order.
+    ChildBounds child_bounds;
   };
 
   // Constructs an empty `StaticRTree`. Note that, because the `StaticRTree`
@@ -82,32 +107,73 @@ class StaticRTree {
   StaticRTree() = default;
 
   // Constructs a `StaticRTree` containing `elements`, using `bounds_func` to
-  // compute the bounding rectangle of each element. `bounds_func` will be moved
-  // into the `StaticRTree`; if it references data owned by another object, it
-  // is the responsibility of the caller to ensure that that data remains valid
-  // for the lifetime of the `StaticRTree`.
+  // compute the bounding rectangle of each element. `bounds_func` is called
+  // once per element during construction, and is not retained.
   //
   // This CHECK-fails if `elements` contains more than 2^32 (4294967296)
-  // elements, or if `bounds_func` == nullptr.
+  // elements, or if `elements` is non-empty and `bounds_func` == nullptr.
   StaticRTree(absl::Span<const T> elements,
               std::function<Rect(const T&)> bounds_func);
 
+  // Constructs a `StaticRTree` containing `elements`, where `element_bounds[i]`
+  // is the bounding rectangle of `elements[i]`. This avoids a type-erased call
+  // per element, and lets the caller compute the bounds in whatever way is most
+  // efficient for their data.
+  //
+  // This CHECK-fails if `elements` contains more than 2^32 (4294967296)
+  // elements, or if `element_bounds` is not the same size as `elements`.
+  StaticRTree(absl::Span<const T> elements,
+              absl::Span<const Rect> element_bounds);
+
   // Constructs a `StaticRTree` containing `n_elements` objects, which are
   // generated by repeatedly calling `generator`. `bounds_func` is used to
-  // compute the bounding rectangle of each element, and will be moved into the
-  // `StaticRTree`; if it references data owned by another object, it is the
-  // responsibility of the caller to ensure that that data remains valid for the
-  // lifetime of the `StaticRTree`.
+  // compute the bounding rectangle of each element; it is called once per
+  // element during construction, and is not retained.
   //
   // Template parameter `Generator` must have a zero-argument function call
   // operator that returns an object that is convertible to `T`, and it must be
   // valid to call `generator()` at least `n_elements` times.
   //
-  // This CHECK-fails if `bounds_func` == nullptr.
+  // This CHECK-fails if `n_elements` > 0 and `bounds_func` == nullptr.
   template <typename Generator>
   StaticRTree(uint32_t n_elements, Generator generator,
               std::function<Rect(const T&)> bounds_func);
 
+  // Constructs a `StaticRTree` containing `element_bounds.size()` objects,
+  // which are generated by repeatedly calling `generator`, such that the i-th
+  // generated element has bounding rectangle `element_bounds[i]`.
+  //
+  // Template parameter `Generator` is as above.
+  template <typename Generator,
+            typename = std::enable_if_t<std::is_invocable_v<Generator&>>>
+  StaticRTree(Generator generator, absl::Span<const Rect> element_bounds);
+
+  // Constructs a `StaticRTree` with a previously computed structure (e.g. one
+  // that was returned by `BranchNodes()` and stored), rather than building it
+  // from scratch. The elements are generated by calling `generator`
+  // `element_bounds.size()` times, as in the constructor above, and the i-th
+  // element must have bounding rectangle `element_bounds[i]`.
+  //
+  // Only the `is_leaf_parent` and `child_indices` fields of `branch_nodes` are
+  // used; the bounds are recomputed from `element_bounds`. This returns an
+  // error if `branch_nodes` does not describe a tree rooted at the first node,
+  // in which each node's branch children come after it, and every element and
+  // every non-root branch node is the child of exactly one node.
+  template <typename Generator>
+  static absl::StatusOr<StaticRTree> FromBranchNodes(
+      Generator generator, absl::Span<const Rect> element_bounds,
+      std::vector<BranchNode> branch_nodes);
+
+  // Replaces the contents of this `StaticRTree` with `elements`, where
+  // `element_bounds[i]` is the bounding rectangle of `elements[i]`, as if it
+  // were newly constructed from them. Unlike assigning a newly constructed
+  // `StaticRTree`, this reuses the existing storage, so that repeatedly
+  // rebuilding a tree of a similar size does no heap allocation.
+  //
+  // This CHECK-fails under the same conditions as the constructor above.
+  void Rebuild(absl::Span<const T> elements,
+               absl::Span<const Rect> element_bounds);
+
   StaticRTree(const StaticRTree&) = default;
   StaticRTree(StaticRTree&&) = default;
   StaticRTree& operator=(const StaticRTree&) = default;
@@ -131,14 +197,84 @@ class StaticRTree {
   void VisitIntersectedElements(
       const Rect& bounds, absl::FunctionRef<bool(const T&)> visitor) const;
 
+  // Visits the same elements as `VisitIntersectedElements`, in the same order,
+  // but one leaf block at a time: `visitor` is called once for each leaf-parent
+  // node that has children intersecting `bounds`, with those children (of which
+  // there are at most `kBranchingFactor`). This lets the caller test the
+  // elements of a block against a query together, e.g. with the kernels in
+  // `triangle_block.h`. The traversal continues until `visitor` returns false.
+  void VisitIntersectedLeafBlocks(
+      const Rect& bounds,
+      absl::FunctionRef<bool(absl::Span<const T>)> visitor) const;
+
+  // Visits, for each element of `query_bounds`, the elements of the tree whose
+  // bounding boxes intersect it. This gives the same results as calling
+  // `VisitIntersectedElements` once per query, but walks the tree only once,
+  // carrying down to each node just the queries that intersect it; this is
+  // much faster than separate traversals when there are many nearby queries.
+  //
+  // `visitor` is called with the index of the query in `query_bounds` and the
+  // element. When it returns false, no more elements will be visited for that
+  // query, but the other queries are unaffected. The visitation order is
+  // arbitrary.
+  void VisitIntersectedElementsForEach(
+      absl::Span<const Rect> query_bounds,
+      absl::FunctionRef<bool(uint32_t, const T&)> visitor) const;
+
+  // Visits the elements in increasing order of `bounds_distance` applied to
+  // their bounding boxes, until `visitor` returns false. `visitor` is called
+  // with that distance and the element; ties are visited in arbitrary order.
+  //
+  // `bounds_distance` must not decrease when its argument shrinks, i.e. if
+  // rect A contains rect B, it must be no greater for A than for B; the
+  // distance from a query shape to the rect satisfies this. Then the distance
+  // passed to `visitor` is a lower bound on that of every element not yet
+  // visited, so a branch-and-bound search can stop as soon as that bound is no
+  // better than the best result found so far. The tree is explored best-first,
+  // so branches that can't contain a closer element are never opened.
+  void VisitElementsInBoundsDistanceOrder(
+      absl::FunctionRef<float(const Rect&)> bounds_distance,
+      absl::FunctionRef<bool(float, const T&)> visitor) const;
+
+  // Visits the pairs of an element of this tree and an element of `other`
+  // whose bounding boxes intersect, where `other_to_this` maps from `other`'s
+  // coordinate space to this tree's. The traversal continues until `visitor`
+  // returns false. The visitation order is arbitrary.
+  //
+  // This walks both trees at once, so that a pair of sub-trees whose bounds
+  // don't intersect is discarded without looking at any of their elements.
+  // This is much faster than querying this tree with the bounds of each
+  // element of `other` when only small parts of the two overlap.
+  template <typename U, uint32_t kOtherBranchingFactor>
+  void VisitIntersectedElementPairs(
+      const StaticRTree<U, kOtherBranchingFactor>& other,
+      const AffineTransform& other_to_this,
+      std::type_identity_t<absl::FunctionRef<bool(const T&, const U&)>> visitor)
+      const;
+
   absl::Span<const BranchNode> BranchNodes() const { return branch_nodes_; }
   absl::Span<const T> Elements() const { return elements_; }
 
  private:
-  // Initializes the structure of the tree, populating `branch_nodes_`. If
+  // Initializes the structure of the tree, populating `branch_nodes_`, where
+  // `leaf_bounds[i]` is the bounding rectangle of `elements_[i]`. If
   // `elements_` is empty, this is a no-op, as there is nothing to put in the
-  // tree. CHECK-fails if `bounds_func_` == nullptr.
-  void InitializeTree();
+  // tree.
+  void InitializeTree(absl::Span<const Rect> leaf_bounds);
+
+  // Returns an error if `branch_nodes` is not a valid structure for a tree
+  // containing `n_elements` elements, per `FromBranchNodes`.
+  static absl::Status ValidateBranchNodes(
+      absl::Span<const BranchNode> branch_nodes, uint32_t n_elements);
+
+  // Sets the `i`-th entry of `child_bounds` to `bounds`.
+  static void SetChildBounds(ChildBounds& child_bounds, uint32_t i,
+                             const Rect& bounds);
+
+  // Returns the result of calling `bounds_func` on each of `elements_`.
+  // CHECK-fails if `bounds_func` == nullptr, unless `elements_` is empty.
+  std::vector<Rect> ComputeLeafBounds(
+      const std::function<Rect(const T&)>& bounds_func) const;
 
   // This is a helper method for `VisitIntersectedElements`, which visits the
   // sub-tree whose root is the branch node at index `sub_tree_root_index`. This
@@ -148,6 +284,48 @@ class StaticRTree {
       uint32_t sub_tree_root_idx, const Rect& bounds,
       absl::FunctionRef<bool(const T&)> visitor) const;
 
+  // Helper for `VisitIntersectedLeafBlocks`, which visits the sub-tree whose
+  // root is the branch node at index `sub_tree_root_idx`. `block` is scratch
+  // space for the intersecting elements of a leaf block. This returns `true` if
+  // the traversal should continue, or `false` if it should stop early.
+  bool VisitIntersectedLeafBlocksInSubTree(
+      uint32_t sub_tree_root_idx, const Rect& bounds,
+      absl::InlinedVector<T, kBranchingFactor>& block,
+      absl::FunctionRef<bool(absl::Span<const T>)> visitor) const;
+
+  // Helper for `VisitIntersectedElementsForEach`. The queries to check against
+  // the sub-tree rooted at `sub_tree_root_idx` are the elements of
+  // `active_queries` from `first_active_query` onward; the queries for each
+  // child are appended to `active_queries` while visiting that child, and
+  // removed afterwards. `finished_queries` marks the queries for which
+  // `visitor` has returned false.
+  void VisitIntersectedElementsForEachInSubTree(
+      uint32_t sub_tree_root_idx, absl::Span<const Rect> query_bounds,
+      size_t first_active_query, std::vector<uint32_t>& active_queries,
+      std::vector<bool>& finished_queries,
+      absl::FunctionRef<bool(uint32_t, const T&)> visitor) const;
+
+  // Helper for `VisitIntersectedElementPairs`, which visits the pairs of
+  // elements from the sub-tree of this tree rooted at `sub_tree_root_idx` and
+  // the sub-tree of `other` rooted at `other_sub_tree_root_idx`.
+  // `other_sub_tree_bounds` is the bounding box of the latter in this tree's
+  // coordinate space. This returns `true` if the traversal should continue, or
+  // `false` if it should stop early.
+  template <typename U, uint32_t kOtherBranchingFactor>
+  bool VisitIntersectedElementPairsInSubTrees(
+      uint32_t sub_tree_root_idx,
+      const StaticRTree<U, kOtherBranchingFactor>& other,
+      uint32_t other_sub_tree_root_idx, const Rect& other_sub_tree_bounds,
+      const AffineTransform& other_to_this,
+      absl::FunctionRef<bool(const T&, const U&)> visitor) const;
+
+  // Tests `bounds` against every entry of `child_bounds` (per the `Intersects`
+  // function), including the unused ones past the node's child count. This
+  // always does `kBranchingFactor` iterations with no early exit, which allows
+  // the loop to be vectorized.
+  static std::array<bool, kBranchingFactor> IntersectChildBounds(
+      const ChildBounds& child_bounds, const Rect& bounds);
+
   // The branch nodes are stored such that each node has a depth at least as
   // great as the previous one. This means that the root will always be the
   // first element, and that all branch nodes of a particular depth occupy a
@@ -157,8 +335,6 @@ class StaticRTree {
   // The data elements in the R-Tree, which are also the leaf nodes (since they
   // contain no other information).
   std::vector<T> elements_;
-
-  std::function<Rect(const T&)> bounds_func_;
 };
 
 // -----------------------------------------------------------------------------
@@ -210,6 +386,9 @@ ComputeRTreeBranchDepthOffsets(
 // parent of the child nodes at `child_indices`. `child_bounds` will be the
 // rectangle that contains all of the child nodes referred to by
 // `child_indices`.
+//
+// `sortable_child_indices` is scratch space, whose contents are replaced; it is
+// a parameter so that its storage can be reused across levels and trees.
 template <typename ChildBoundsGetter, typename ParentAssigner>
 void BulkLoadOneLevelOfNodes(uint32_t index_of_first_parent_node,
                              uint32_t n_parent_nodes,
@@ -217,7 +396,8 @@ void BulkLoadOneLevelOfNodes(uint32_t index_of_first_parent_node,
                              uint32_t n_child_nodes,
                              ChildBoundsGetter get_child_bounds,
                              ParentAssigner assign_children_to_parent,
-                             int branching_factor) {
+                             int branching_factor,
+                             std::vector<uint32_t>& sortable_child_indices) {
   // These should be guaranteed by the logic in the ctor.
   ABSL_DCHECK_GT(n_child_nodes, 0u);
   ABSL_DCHECK_EQ(n_parent_nodes, std::ceil(static_cast<double>(n_child_nodes) /
@@ -242,7 +422,7 @@ void BulkLoadOneLevelOfNodes(uint32_t index_of_first_parent_node,
 
   // Instead of sorting the nodes themselves, which would invalidate any
   // references to them by index, we make a list of the indices, and sort those.
-  std::vector<uint32_t> sortable_child_indices(n_child_nodes);
+  sortable_child_indices.resize(n_child_nodes);
   absl::c_iota(sortable_child_indices, index_of_first_child_node);
 
   uint32_t n_tiles =
@@ -298,34 +478,194 @@ void BulkLoadOneLevelOfNodes(uint32_t index_of_first_parent_node,
 template <typename T, uint32_t kBranchingFactor>
 StaticRTree<T, kBranchingFactor>::StaticRTree(
     absl::Span<const T> elements, std::function<Rect(const T&)> bounds_func)
-    : elements_(elements.begin(), elements.end()),
-      bounds_func_(std::move(bounds_func)) {
+    : elements_(elements.begin(), elements.end()) {
+  ABSL_CHECK_LE(elements.size(), uint64_t{1} << 32) << absl::Substitute(
+      "StaticRTree supports a maximum of 2^32 (4294967296) elements; $0 were "
+      "given",
+      elements.size());
+  InitializeTree(ComputeLeafBounds(bounds_func));
+}
+
+template <typename T, uint32_t kBranchingFactor>
+StaticRTree<T, kBranchingFactor>::StaticRTree(
+    absl::Span<const T> elements, absl::Span<const Rect> element_bounds)
+    : elements_(elements.begin(), elements.end()) {
   ABSL_CHECK_LE(elements.size(), uint64_t{1} << 32) << absl::Substitute(
       "StaticRTree supports a maximum of 2^32 (4294967296) elements; $0 were "
       "given",
       elements.size());
-  InitializeTree();
+  ABSL_CHECK_EQ(elements.size(), element_bounds.size());
+  InitializeTree(element_bounds);
+}
+
+template <typename T, uint32_t kBranchingFactor>
+void StaticRTree<T, kBranchingFactor>::Rebuild(
+    absl::Span<const T> elements, absl::Span<const Rect> element_bounds) {
+  ABSL_CHECK_LE(elements.size(), uint64_t{1} << 32) << absl::Substitute(
+      "StaticRTree supports a maximum of 2^32 (4294967296) elements; $0 were "
+      "given",
+      elements.size());
+  ABSL_CHECK_EQ(elements.size(), element_bounds.size());
+  elements_.assign(elements.begin(), elements.end());
+  InitializeTree(element_bounds);
 }
 
 template <typename T, uint32_t kBranchingFactor>
 template <typename Generator>
 StaticRTree<T, kBranchingFactor>::StaticRTree(
     uint32_t n_elements, Generator generator,
-    std::function<Rect(const T&)> bounds_func)
-    : bounds_func_(std::move(bounds_func)) {
+    std::function<Rect(const T&)> bounds_func) {
   elements_.resize(n_elements);
   absl::c_generate(elements_, generator);
-  InitializeTree();
+  InitializeTree(ComputeLeafBounds(bounds_func));
+}
+
+template <typename T, uint32_t kBranchingFactor>
+template <typename Generator, typename>
+StaticRTree<T, kBranchingFactor>::StaticRTree(
+    Generator generator, absl::Span<const Rect> element_bounds) {
+  ABSL_CHECK_LE(element_bounds.size(), uint64_t{1} << 32) << absl::Substitute(
+      "StaticRTree supports a maximum of 2^32 (4294967296) elements; $0 were "
+      "given",
+      element_bounds.size());
+  elements_.resize(element_bounds.size());
+  absl::c_generate(elements_, generator);
+  InitializeTree(element_bounds);
+}
+
+template <typename T, uint32_t kBranchingFactor>
+template <typename Generator>
+absl::StatusOr<StaticRTree<T, kBranchingFactor>>
+StaticRTree<T, kBranchingFactor>::FromBranchNodes(
+    Generator generator, absl::Span<const Rect> element_bounds,
+    std::vector<BranchNode> branch_nodes) {
+  if (element_bounds.size() > uint64_t{1} << 32) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "StaticRTree supports a maximum of 2^32 (4294967296) elements; $0 were "
+        "given",
+        element_bounds.size()));
+  }
+  if (absl::Status status =
+          ValidateBranchNodes(branch_nodes, element_bounds.size());
+      !status.ok()) {
+    return status;
+  }
+
+  StaticRTree rtree;
+  rtree.elements_.resize(element_bounds.size());
+  absl::c_generate(rtree.elements_, generator);
+  rtree.branch_nodes_ = std::move(branch_nodes);
+
+  // Each node's branch children come after it, so visiting the nodes in reverse
+  // order ensures that the children's bounds are known before their parent's.
+  for (uint32_t node_idx = rtree.branch_nodes_.size(); node_idx-- > 0;) {
+    BranchNode& node = rtree.branch_nodes_[node_idx];
+    absl::Span<const uint32_t> child_indices = node.child_indices.Values();
+    node.child_bounds = {};
+    Envelope envelope;
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      Rect child_bounds = node.is_leaf_parent
+                              ? element_bounds[child_indices[i]]
+                              : rtree.branch_nodes_[child_indices[i]].bounds;
+      SetChildBounds(node.child_bounds, i, child_bounds);
+      envelope.Add(child_bounds);
+    }
+    node.bounds = *envelope.AsRect();
+  }
+  return rtree;
+}
+
+template <typename T, uint32_t kBranchingFactor>
+absl::Status StaticRTree<T, kBranchingFactor>::ValidateBranchNodes(
+    absl::Span<const BranchNode> branch_nodes, uint32_t n_elements) {
+  if (n_elements == 0 || branch_nodes.empty()) {
+    if (n_elements != 0 || !branch_nodes.empty()) {
+      return absl::InvalidArgumentError(absl::Substitute(
+          "StaticRTree with $0 elements cannot have $1 branch nodes",
+          n_elements, branch_nodes.size()));
+    }
+    return absl::OkStatus();
+  }
+
+  std::vector<bool> element_has_parent(n_elements, false);
+  std::vector<bool> branch_has_parent(branch_nodes.size(), false);
+  for (uint32_t node_idx = 0; node_idx < branch_nodes.size(); ++node_idx) {
+    const BranchNode& node = branch_nodes[node_idx];
+    if (node.child_indices.Size() == 0) {
+      return absl::InvalidArgumentError(
+          absl::Substitute("Branch node $0 has no children", node_idx));
+    }
+    for (uint32_t child_idx : node.child_indices.Values()) {
+      if (node.is_leaf_parent) {
+        if (child_idx >= n_elements) {
+          return absl::InvalidArgumentError(absl::Substitute(
+              "Branch node $0 has element child $1, but there are only $2 "
+              "elements",
+              node_idx, child_idx, n_elements));
+        }
+        if (element_has_parent[child_idx]) {
+          return absl::InvalidArgumentError(absl::Substitute(
+              "Element $0 is the child of more than one node", child_idx));
+        }
+        element_has_parent[child_idx] = true;
+      } else {
+        if (child_idx <= node_idx || child_idx >= branch_nodes.size()) {
+          return absl::InvalidArgumentError(absl::Substitute(
+              "Branch node $0 has branch child $1, which must be in the range "
+              "($0, $2)",
+              node_idx, child_idx, branch_nodes.size()));
+        }
+        if (branch_has_parent[child_idx]) {
+          return absl::InvalidArgumentError(absl::Substitute(
+              "Branch node $0 is the child of more than one node", child_idx));
+        }
+        branch_has_parent[child_idx] = true;
+      }
+    }
+  }
+  if (!absl::c_all_of(element_has_parent, [](bool b) { return b; })) {
+    return absl::InvalidArgumentError(
+        "Every element must be the child of a branch node");
+  }
+  // The root (the first node) has no parent; every other node must have one.
+  if (!std::all_of(branch_has_parent.begin() + 1, branch_has_parent.end(),
+                   [](bool b) { return b; })) {
+    return absl::InvalidArgumentError(
+        "Every branch node other than the root must have a parent");
+  }
+  return absl::OkStatus();
+}
+
+template <typename T, uint32_t kBranchingFactor>
+void StaticRTree<T, kBranchingFactor>::SetChildBounds(
+    ChildBounds& child_bounds, uint32_t i, const Rect& bounds) {
+  child_bounds.x_min[i] = bounds.XMin();
+  child_bounds.y_min[i] = bounds.YMin();
+  child_bounds.x_max[i] = bounds.XMax();
+  child_bounds.y_max[i] = bounds.YMax();
+}
+
+template <typename T, uint32_t kBranchingFactor>
+std::vector<Rect> StaticRTree<T, kBranchingFactor>::ComputeLeafBounds(
+    const std::function<Rect(const T&)>& bounds_func) const {
+  if (elements_.empty()) return {};
+
+  ABSL_CHECK(bounds_func != nullptr) << "bounds_func must be non-null";
+  std::vector<Rect> leaf_bounds(elements_.size());
+  absl::c_transform(elements_, leaf_bounds.begin(), bounds_func);
+  return leaf_bounds;
 }
 
 template <typename T, uint32_t kBranchingFactor>
-void StaticRTree<T, kBranchingFactor>::InitializeTree() {
+void StaticRTree<T, kBranchingFactor>::InitializeTree(
+    absl::Span<const Rect> leaf_bounds) {
   if (elements_.empty()) {
-    // This is an empty R-Tree, there is nothing to initialize.
+    // This is an empty R-Tree, there is nothing to initialize, but this may be
+    // a rebuild of a non-empty tree.
+    branch_nodes_.clear();
     return;
   }
-
-  ABSL_CHECK(bounds_func_ != nullptr) << "bounds_func must be non-null";
+  ABSL_DCHECK_EQ(leaf_bounds.size(), elements_.size());
 
   absl::InlinedVector<uint32_t, kMaxExpectedRTreeBranchDepth>
       n_branch_nodes_at_depth = ComputeNumberOfRTreeBranchNodesAtDepth(
@@ -337,45 +677,65 @@ void StaticRTree<T, kBranchingFactor>::InitializeTree() {
   branch_nodes_.resize(branch_depth_offsets.back() +
                        n_branch_nodes_at_depth.back());
 
-  std::vector<Rect> leaf_bounds(elements_.size());
-  absl::c_transform(elements_, leaf_bounds.begin(), bounds_func_);
-
-  auto get_leaf_bounds = [bounds = std::move(leaf_bounds)](uint32_t idx) {
-    return bounds[idx];
+  auto get_leaf_bounds = [leaf_bounds](uint32_t idx) {
+    return leaf_bounds[idx];
   };
   auto get_branch_bounds = [this](uint32_t idx) {
     return branch_nodes_[idx].bounds;
   };
 
+  auto assign_children = [](BranchNode& parent,
+                            absl::Span<const uint32_t> child_indices,
+                            auto get_child_bounds) {
+    parent.child_indices =
+        SmallArray<uint32_t, kBranchingFactor>(child_indices);
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      SetChildBounds(parent.child_bounds, i,
+                     get_child_bounds(child_indices[i]));
+    }
+  };
   auto assign_leaf_children_to_parent =
-      [this](uint32_t parent_idx, const Rect& child_bounds,
-             absl::Span<const uint32_t> child_indices) {
+      [this, &assign_children, &get_leaf_bounds](
+          uint32_t parent_idx, const Rect& child_bounds,
+          absl::Span<const uint32_t> child_indices) {
         BranchNode& parent = branch_nodes_[parent_idx];
         parent.bounds = child_bounds;
         parent.is_leaf_parent = true;
-        parent.child_indices =
-            SmallArray<uint32_t, kBranchingFactor>(child_indices);
+        assign_children(parent, child_indices, get_leaf_bounds);
       };
   auto assign_branch_children_to_parent =
-      [this](uint32_t parent_idx, const Rect& child_bounds,
-             absl::Span<const uint32_t> child_indices) {
+      [this, &assign_children, &get_branch_bounds](
+          uint32_t parent_idx, const Rect& child_bounds,
+          absl::Span<const uint32_t> child_indices) {
         BranchNode& parent = branch_nodes_[parent_idx];
         parent.bounds = child_bounds;
         parent.is_leaf_parent = false;
-        parent.child_indices =
-            SmallArray<uint32_t, kBranchingFactor>(child_indices);
+        assign_children(parent, child_indices, get_branch_bounds);
       };
 
+  // The sort buffer is reused across calls on the same thread, so that
+  // `Rebuild()` doesn't allocate; it is released if it gets large, so that
+  // building one large tree doesn't pin its memory for the life of the thread.
+#ifdef ABSL_HAVE_THREAD_LOCAL
+  thread_local
+#endif
+      std::vector<uint32_t> sortable_child_indices;
   BulkLoadOneLevelOfNodes(
       branch_depth_offsets.back(), n_branch_nodes_at_depth.back(),
       /* index_of_first_child_node = */ 0, elements_.size(), get_leaf_bounds,
-      assign_leaf_children_to_parent, kBranchingFactor);
+      assign_leaf_children_to_parent, kBranchingFactor,
+      sortable_child_indices);
 
   for (int depth = n_branch_nodes_at_depth.size() - 2; depth >= 0; --depth) {
     BulkLoadOneLevelOfNodes(
         branch_depth_offsets[depth], n_branch_nodes_at_depth[depth],
         branch_depth_offsets[depth + 1], n_branch_nodes_at_depth[depth + 1],
-        get_branch_bounds, assign_branch_children_to_parent, kBranchingFactor);
+        get_branch_bounds, assign_branch_children_to_parent, kBranchingFactor,
+        sortable_child_indices);
+  }
+  constexpr size_t kMaxRetainedSortBufferSize = 1 << 16;
+  if (sortable_child_indices.capacity() > kMaxRetainedSortBufferSize) {
+    sortable_child_indices = std::vector<uint32_t>();
   }
 }
 
@@ -391,17 +751,19 @@ bool StaticRTree<T, kBranchingFactor>::VisitIntersectedElementsInSubTree(
     uint32_t sub_tree_root_idx, const Rect& bounds,
     absl::FunctionRef<bool(const T&)> visitor) const {
   const BranchNode& node = branch_nodes_[sub_tree_root_idx];
+  std::array<bool, kBranchingFactor> intersects =
+      IntersectChildBounds(node.child_bounds, bounds);
+  absl::Span<const uint32_t> child_indices = node.child_indices.Values();
   if (node.is_leaf_parent) {
-    for (uint32_t leaf_idx : node.child_indices.Values()) {
-      if (IntersectsInternal(bounds_func_(elements_[leaf_idx]), bounds) &&
-          !visitor(elements_[leaf_idx])) {
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      if (intersects[i] && !visitor(elements_[child_indices[i]])) {
         return false;
       }
     }
   } else {
-    for (uint32_t branch_idx : node.child_indices.Values()) {
-      if (IntersectsInternal(branch_nodes_[branch_idx].bounds, bounds) &&
-          !VisitIntersectedElementsInSubTree(branch_idx, bounds, visitor)) {
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      if (intersects[i] && !VisitIntersectedElementsInSubTree(
+                               child_indices[i], bounds, visitor)) {
         return false;
       }
     }
@@ -409,6 +771,254 @@ bool StaticRTree<T, kBranchingFactor>::VisitIntersectedElementsInSubTree(
   return true;
 }
 
+template <typename T, uint32_t kBranchingFactor>
+void StaticRTree<T, kBranchingFactor>::VisitIntersectedLeafBlocks(
+    const Rect& bounds,
+    absl::FunctionRef<bool(absl::Span<const T>)> visitor) const {
+  if (!IntersectsInternal(branch_nodes_.front().bounds, bounds)) return;
+  absl::InlinedVector<T, kBranchingFactor> block;
+  VisitIntersectedLeafBlocksInSubTree(0, bounds, block, visitor);
+}
+
+template <typename T, uint32_t kBranchingFactor>
+bool StaticRTree<T, kBranchingFactor>::VisitIntersectedLeafBlocksInSubTree(
+    uint32_t sub_tree_root_idx, const Rect& bounds,
+    absl::InlinedVector<T, kBranchingFactor>& block,
+    absl::FunctionRef<bool(absl::Span<const T>)> visitor) const {
+  const BranchNode& node = branch_nodes_[sub_tree_root_idx];
+  std::array<bool, kBranchingFactor> intersects =
+      IntersectChildBounds(node.child_bounds, bounds);
+  absl::Span<const uint32_t> child_indices = node.child_indices.Values();
+  if (node.is_leaf_parent) {
+    block.clear();
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      if (intersects[i]) block.push_back(elements_[child_indices[i]]);
+    }
+    return block.empty() || visitor(block);
+  }
+  for (uint32_t i = 0; i < child_indices.size(); ++i) {
+    if (intersects[i] && !VisitIntersectedLeafBlocksInSubTree(
+                             child_indices[i], bounds, block, visitor)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, uint32_t kBranchingFactor>
+void StaticRTree<T, kBranchingFactor>::VisitIntersectedElementsForEach(
+    absl::Span<const Rect> query_bounds,
+    absl::FunctionRef<bool(uint32_t, const T&)> visitor) const {
+  if (branch_nodes_.empty()) return;
+  ABSL_CHECK_LE(query_bounds.size(), uint64_t{1} << 32);
+
+  std::vector<uint32_t> active_queries;
+  active_queries.reserve(2 * query_bounds.size());
+  for (uint32_t i = 0; i < query_bounds.size(); ++i) {
+    if (IntersectsInternal(branch_nodes_.front().bounds, query_bounds[i])) {
+      active_queries.push_back(i);
+    }
+  }
+  if (active_queries.empty()) return;
+  std::vector<bool> finished_queries(query_bounds.size(), false);
+  VisitIntersectedElementsForEachInSubTree(0, query_bounds, 0, active_queries,
+                                           finished_queries, visitor);
+}
+
+template <typename T, uint32_t kBranchingFactor>
+void StaticRTree<T, kBranchingFactor>::VisitIntersectedElementsForEachInSubTree(
+    uint32_t sub_tree_root_idx, absl::Span<const Rect> query_bounds,
+    size_t first_active_query, std::vector<uint32_t>& active_queries,
+    std::vector<bool>& finished_queries,
+    absl::FunctionRef<bool(uint32_t, const T&)> visitor) const {
+  const BranchNode& node = branch_nodes_[sub_tree_root_idx];
+  absl::Span<const uint32_t> child_indices = node.child_indices.Values();
+  size_t end_of_active_queries = active_queries.size();
+  for (uint32_t i = 0; i < child_indices.size(); ++i) {
+    float x_min = node.child_bounds.x_min[i];
+    float y_min = node.child_bounds.y_min[i];
+    float x_max = node.child_bounds.x_max[i];
+    float y_max = node.child_bounds.y_max[i];
+    // Note that these are indices into `active_queries`, which may reallocate
+    // as the child's queries are appended.
+    for (size_t j = first_active_query; j < end_of_active_queries; ++j) {
+      uint32_t query_idx = active_queries[j];
+      const Rect& bounds = query_bounds[query_idx];
+      if (!finished_queries[query_idx] && x_min <= bounds.XMax() &&
+          bounds.XMin() <= x_max && y_min <= bounds.YMax() &&
+          bounds.YMin() <= y_max) {
+        active_queries.push_back(query_idx);
+      }
+    }
+    if (active_queries.size() == end_of_active_queries) continue;
+
+    if (node.is_leaf_parent) {
+      const T& element = elements_[child_indices[i]];
+      for (size_t j = end_of_active_queries; j < active_queries.size(); ++j) {
+        uint32_t query_idx = active_queries[j];
+        if (!visitor(query_idx, element)) finished_queries[query_idx] = true;
+      }
+    } else {
+      VisitIntersectedElementsForEachInSubTree(
+          child_indices[i], query_bounds, end_of_active_queries,
+          active_queries, finished_queries, visitor);
+    }
+    active_queries.resize(end_of_active_queries);
+  }
+}
+
+template <typename T, uint32_t kBranchingFactor>
+void StaticRTree<T, kBranchingFactor>::VisitElementsInBoundsDistanceOrder(
+    absl::FunctionRef<float(const Rect&)> bounds_distance,
+    absl::FunctionRef<bool(float, const T&)> visitor) const {
+  if (branch_nodes_.empty()) return;
+
+  // A branch node or element waiting to be visited, and the distance to its
+  // bounds.
+  struct QueueEntry {
+    float distance;
+    uint32_t index;
+    bool is_element;
+  };
+  auto is_farther = [](const QueueEntry& a, const QueueEntry& b) {
+    return a.distance > b.distance;
+  };
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(is_farther)>
+      queue(is_farther);
+  queue.push({.distance = bounds_distance(branch_nodes_.front().bounds),
+              .index = 0,
+              .is_element = false});
+  while (!queue.empty()) {
+    QueueEntry entry = queue.top();
+    queue.pop();
+    if (entry.is_element) {
+      if (!visitor(entry.distance, elements_[entry.index])) return;
+      continue;
+    }
+    const BranchNode& node = branch_nodes_[entry.index];
+    absl::Span<const uint32_t> child_indices = node.child_indices.Values();
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      Rect child_bounds = Rect::FromTwoPoints(
+          {node.child_bounds.x_min[i], node.child_bounds.y_min[i]},
+          {node.child_bounds.x_max[i], node.child_bounds.y_max[i]});
+      queue.push({.distance = bounds_distance(child_bounds),
+                  .index = child_indices[i],
+                  .is_element = node.is_leaf_parent});
+    }
+  }
+}
+
+// Returns the bounds of the child at index `i` of `child_bounds`, mapped by
+// `transform`.
+template <typename ChildBounds>
+Rect TransformedChildBounds(const ChildBounds& child_bounds, uint32_t i,
+                            const AffineTransform& transform) {
+  return *Envelope(transform.Apply(Rect::FromTwoPoints(
+                       {child_bounds.x_min[i], child_bounds.y_min[i]},
+                       {child_bounds.x_max[i], child_bounds.y_max[i]})))
+              .AsRect();
+}
+
+template <typename T, uint32_t kBranchingFactor>
+template <typename U, uint32_t kOtherBranchingFactor>
+void StaticRTree<T, kBranchingFactor>::VisitIntersectedElementPairs(
+    const StaticRTree<U, kOtherBranchingFactor>& other,
+    const AffineTransform& other_to_this,
+    std::type_identity_t<absl::FunctionRef<bool(const T&, const U&)>> visitor)
+    const {
+  if (branch_nodes_.empty() || other.BranchNodes().empty()) return;
+  Rect other_bounds =
+      *Envelope(other_to_this.Apply(other.BranchNodes().front().bounds))
+           .AsRect();
+  if (!IntersectsInternal(branch_nodes_.front().bounds, other_bounds)) return;
+  VisitIntersectedElementPairsInSubTrees(0, other, 0, other_bounds,
+                                         other_to_this, visitor);
+}
+
+template <typename T, uint32_t kBranchingFactor>
+template <typename U, uint32_t kOtherBranchingFactor>
+bool StaticRTree<T, kBranchingFactor>::VisitIntersectedElementPairsInSubTrees(
+    uint32_t sub_tree_root_idx,
+    const StaticRTree<U, kOtherBranchingFactor>& other,
+    uint32_t other_sub_tree_root_idx, const Rect& other_sub_tree_bounds,
+    const AffineTransform& other_to_this,
+    absl::FunctionRef<bool(const T&, const U&)> visitor) const {
+  const BranchNode& node = branch_nodes_[sub_tree_root_idx];
+  const auto& other_node = other.BranchNodes()[other_sub_tree_root_idx];
+  absl::Span<const uint32_t> child_indices = node.child_indices.Values();
+  absl::Span<const uint32_t> other_child_indices =
+      other_node.child_indices.Values();
+
+  // We descend into the larger of the two nodes, so that we're always
+  // comparing sub-trees of similar size; but once we're at a leaf parent on
+  // one side, we can only descend into the other side.
+  bool descend_into_other =
+      !other_node.is_leaf_parent &&
+      (node.is_leaf_parent ||
+       other_sub_tree_bounds.Area() > node.bounds.Area());
+  if (descend_into_other) {
+    for (uint32_t i = 0; i < other_child_indices.size(); ++i) {
+      Rect other_child_bounds =
+          TransformedChildBounds(other_node.child_bounds, i, other_to_this);
+      if (IntersectsInternal(node.bounds, other_child_bounds) &&
+          !VisitIntersectedElementPairsInSubTrees(
+              sub_tree_root_idx, other, other_child_indices[i],
+              other_child_bounds, other_to_this, visitor)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (!node.is_leaf_parent) {
+    std::array<bool, kBranchingFactor> intersects =
+        IntersectChildBounds(node.child_bounds, other_sub_tree_bounds);
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      if (intersects[i] && !VisitIntersectedElementPairsInSubTrees(
+                               child_indices[i], other, other_sub_tree_root_idx,
+                               other_sub_tree_bounds, other_to_this, visitor)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Both nodes are leaf parents, so we test their elements pairwise.
+  for (uint32_t j = 0; j < other_child_indices.size(); ++j) {
+    std::array<bool, kBranchingFactor> intersects = IntersectChildBounds(
+        node.child_bounds,
+        TransformedChildBounds(other_node.child_bounds, j, other_to_this));
+    const U& other_element = other.Elements()[other_child_indices[j]];
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      if (intersects[i] &&
+          !visitor(elements_[child_indices[i]], other_element)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename T, uint32_t kBranchingFactor>
+std::array<bool, kBranchingFactor>
+StaticRTree<T, kBranchingFactor>::IntersectChildBounds(
+    const ChildBounds& child_bounds, const Rect& bounds) {
+  // This is equivalent to `IntersectsInternal(Rect, Rect)`, but uses
+  // non-short-circuiting operators so that there are no branches in the loop.
+  float x_min = bounds.XMin();
+  float y_min = bounds.YMin();
+  float x_max = bounds.XMax();
+  float y_max = bounds.YMax();
+  std::array<bool, kBranchingFactor> intersects;
+  for (uint32_t i = 0; i < kBranchingFactor; ++i) {
+    intersects[i] = (child_bounds.x_min[i] <= x_max) &
+                    (x_min <= child_bounds.x_max[i]) &
+                    (child_bounds.y_min[i] <= y_max) &
+                    (y_min <= child_bounds.y_max[i]);
+  }
+  return intersects;
+}
+
 }  // namespace ink::geometry_internal
 
 #endif  // INK_GEOMETRY_INTERNAL_STATIC_RTREE_H_
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <random>
 #include <vector>
 
@@ -19,6 +20,7 @@
 #include "benchmark/benchmark.h"
 #include "ink/geometry/internal/static_rtree.h"
 #include "ink/geometry/rect.h"
+#include "ink/types/internal/allocation_counter.h"
 
 namespace ink::geometry_internal {
 namespace {
@@ -45,15 +47,26 @@ std::vector<Rect> MakeVectorOfRandomRects(int n_elements) {
 
 void BM_ConstructFromRandomRects(benchmark::State& state) {
   std::vector<Rect> rects = MakeVectorOfRandomRects(state.range(0));
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     StaticRTree<Rect> rtree(rects, rect_bounds);
   }
 }
 BENCHMARK(BM_ConstructFromRandomRects)->Range(8, 16384);
 
+void BM_ConstructFromRandomRectsWithPrecomputedBounds(benchmark::State& state) {
+  std::vector<Rect> rects = MakeVectorOfRandomRects(state.range(0));
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    StaticRTree<Rect> rtree(rects, absl::MakeConstSpan(rects));
+  }
+}
+BENCHMARK(BM_ConstructFromRandomRectsWithPrecomputedBounds)->Range(8, 16384);
+
 void BM_VisitFirstIntersectingRect(benchmark::State& state) {
   std::vector<Rect> rects = MakeVectorOfRandomRects(state.range(0));
   StaticRTree<Rect> rtree(rects, rect_bounds);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     rtree.VisitIntersectedElements(Rect::FromTwoPoints({-25, -25}, {75, 75}),
                                    [](const Rect&) { return true; });
@@ -66,6 +79,7 @@ void BM_VisitAllIntersectingRects(benchmark::State& state) {
   StaticRTree<Rect> rtree(rects, rect_bounds);
   std::vector<Rect> output;
   output.reserve(rects.size());
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     state.PauseTiming();
     output.clear();
@@ -79,5 +93,52 @@ void BM_VisitAllIntersectingRects(benchmark::State& state) {
 }
 BENCHMARK(BM_VisitAllIntersectingRects)->Range(8, 16384);
 
+// Returns `n_queries` small, overlapping rects along a diagonal line, like the
+// swept samples of an eraser gesture.
+std::vector<Rect> MakeQueriesAlongPath(int n_queries) {
+  std::vector<Rect> queries;
+  queries.reserve(n_queries);
+  for (int i = 0; i < n_queries; ++i) {
+    float t = -100 + 200.f * i / n_queries;
+    queries.push_back(Rect::FromCenterAndDimensions({t, t}, 4, 4));
+  }
+  return queries;
+}
+
+void BM_VisitIntersectingRectsSeparatelyAlongPath(benchmark::State& state) {
+  std::vector<Rect> rects = MakeVectorOfRandomRects(state.range(0));
+  StaticRTree<Rect> rtree(rects, rect_bounds);
+  std::vector<Rect> queries = MakeQueriesAlongPath(256);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    int n_hits = 0;
+    for (const Rect& query : queries) {
+      rtree.VisitIntersectedElements(query, [&n_hits](const Rect&) {
+        ++n_hits;
+        return true;
+      });
+    }
+    benchmark::DoNotOptimize(n_hits);
+  }
+}
+BENCHMARK(BM_VisitIntersectingRectsSeparatelyAlongPath)->Range(8, 16384);
+
+void BM_VisitIntersectingRectsForEachAlongPath(benchmark::State& state) {
+  std::vector<Rect> rects = MakeVectorOfRandomRects(state.range(0));
+  StaticRTree<Rect> rtree(rects, rect_bounds);
+  std::vector<Rect> queries = MakeQueriesAlongPath(256);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    int n_hits = 0;
+    rtree.VisitIntersectedElementsForEach(queries,
+                                          [&n_hits](uint32_t, const Rect&) {
+                                            ++n_hits;
+                                            return true;
+                                          });
+    benchmark::DoNotOptimize(n_hits);
+  }
+}
+BENCHMARK(BM_VisitIntersectingRectsForEachAlongPath)->Range(8, 16384);
+
 }  // namespace
 }  // namespace ink::geometry_internal
@@ -14,14 +14,23 @@
 
 #include "ink/geometry/internal/static_rtree.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/distance.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/internal/intersects_internal.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/rect.h"
 #include "ink/geometry/type_matchers.h"
@@ -35,6 +44,7 @@ using ::testing::Contains;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::Field;
+using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::Matcher;
 using ::testing::Not;
@@ -311,6 +321,164 @@ TEST(StaticRTreeTest, CreateWithNormalBranchingFactor) {
   }
 }
 
+TEST(StaticRTreeTest, ChildBoundsMatchChildren) {
+  std::vector<Point> elements;
+  for (int i = 0; i < 500; ++i) {
+    elements.push_back({static_cast<float>(i % 23), static_cast<float>(i / 7)});
+  }
+
+  StaticRTree<Point> rtree(elements, point_bounds);
+
+  absl::Span<const StaticRTree<Point>::BranchNode> branch_nodes =
+      rtree.BranchNodes();
+  for (const StaticRTree<Point>::BranchNode& node : branch_nodes) {
+    absl::Span<const uint32_t> child_indices = node.child_indices.Values();
+    for (uint32_t i = 0; i < child_indices.size(); ++i) {
+      Rect child_bounds =
+          node.is_leaf_parent
+              ? point_bounds(rtree.Elements()[child_indices[i]])
+              : branch_nodes[child_indices[i]].bounds;
+      EXPECT_EQ(node.child_bounds.x_min[i], child_bounds.XMin());
+      EXPECT_EQ(node.child_bounds.y_min[i], child_bounds.YMin());
+      EXPECT_EQ(node.child_bounds.x_max[i], child_bounds.XMax());
+      EXPECT_EQ(node.child_bounds.y_max[i], child_bounds.YMax());
+    }
+  }
+}
+
+TEST(StaticRTreeTest, CreateFromPrecomputedBounds) {
+  std::vector<Point> elements{{-1, -1}, {0, 2}, {4, 3}, {2, 1}, {-2, 0}};
+  std::vector<Rect> element_bounds;
+  for (Point p : elements) element_bounds.push_back(point_bounds(p));
+
+  PointRTree from_bounds_func(elements, point_bounds);
+  PointRTree from_precomputed_bounds(elements, element_bounds);
+
+  EXPECT_THAT(from_precomputed_bounds.Elements(), ElementsAreArray(elements));
+  ASSERT_EQ(from_precomputed_bounds.BranchNodes().size(),
+            from_bounds_func.BranchNodes().size());
+  for (uint32_t i = 0; i < from_bounds_func.BranchNodes().size(); ++i) {
+    const PointRTree::BranchNode& node = from_bounds_func.BranchNodes()[i];
+    EXPECT_THAT(from_precomputed_bounds.BranchNodes()[i],
+                Branch(node.bounds, node.is_leaf_parent,
+                       node.child_indices.Values()));
+  }
+}
+
+TEST(StaticRTreeTest, RebuildMatchesNewlyConstructedTree) {
+  std::vector<Point> first_elements;
+  for (int i = 0; i < 40; ++i) {
+    first_elements.push_back(
+        {static_cast<float>(i % 7), static_cast<float>(i / 3)});
+  }
+  std::vector<Point> second_elements{{-1, -1}, {0, 2}, {4, 3}, {2, 1}, {-2, 0}};
+
+  PointRTree rtree(first_elements, point_bounds);
+  for (absl::Span<const Point> elements :
+       {absl::MakeConstSpan(second_elements),
+        absl::MakeConstSpan(first_elements)}) {
+    std::vector<Rect> element_bounds;
+    for (Point p : elements) element_bounds.push_back(point_bounds(p));
+    rtree.Rebuild(elements, element_bounds);
+
+    PointRTree expected(elements, point_bounds);
+    EXPECT_THAT(rtree.Elements(), ElementsAreArray(elements));
+    ASSERT_EQ(rtree.BranchNodes().size(), expected.BranchNodes().size());
+    for (uint32_t i = 0; i < expected.BranchNodes().size(); ++i) {
+      const PointRTree::BranchNode& node = expected.BranchNodes()[i];
+      EXPECT_THAT(rtree.BranchNodes()[i],
+                  Branch(node.bounds, node.is_leaf_parent,
+                         node.child_indices.Values()));
+    }
+  }
+
+  rtree.Rebuild({}, {});
+  EXPECT_THAT(rtree.BranchNodes(), IsEmpty());
+  EXPECT_THAT(rtree.Elements(), IsEmpty());
+}
+
+TEST(StaticRTreeTest, CreateWithGeneratorFromPrecomputedBounds) {
+  std::vector<Rect> element_bounds{Rect::FromTwoPoints({0, 0}, {1, 1}),
+                                   Rect::FromTwoPoints({5, 5}, {6, 6}),
+                                   Rect::FromTwoPoints({0, 5}, {1, 6})};
+  StaticRTree<int, 3> rtree([i = 0]() mutable { return i++; },
+                            element_bounds);
+
+  EXPECT_THAT(rtree.Elements(), ElementsAre(0, 1, 2));
+  std::vector<int> visited;
+  rtree.VisitIntersectedElements(Rect::FromTwoPoints({0, 4}, {10, 10}),
+                                 [&visited](int i) {
+                                   visited.push_back(i);
+                                   return true;
+                                 });
+  EXPECT_THAT(visited, UnorderedElementsAre(1, 2));
+}
+
+TEST(StaticRTreeTest, FromBranchNodesRestoresStructure) {
+  std::vector<Point> elements;
+  for (int i = 0; i < 40; ++i) {
+    elements.push_back({static_cast<float>(i % 7), static_cast<float>(i / 3)});
+  }
+  std::vector<Rect> element_bounds;
+  for (Point p : elements) element_bounds.push_back(point_bounds(p));
+  PointRTree original(elements, element_bounds);
+
+  // Only the structure is copied; the bounds should be recomputed.
+  std::vector<PointRTree::BranchNode> structure;
+  for (const PointRTree::BranchNode& node : original.BranchNodes()) {
+    structure.push_back({.is_leaf_parent = node.is_leaf_parent,
+                         .child_indices = node.child_indices});
+  }
+  absl::StatusOr<PointRTree> restored = PointRTree::FromBranchNodes(
+      [it = elements.begin()]() mutable { return *it++; }, element_bounds,
+      std::move(structure));
+  ASSERT_EQ(restored.status(), absl::OkStatus());
+
+  EXPECT_THAT(restored->Elements(), ElementsAreArray(elements));
+  ASSERT_EQ(restored->BranchNodes().size(), original.BranchNodes().size());
+  for (uint32_t i = 0; i < original.BranchNodes().size(); ++i) {
+    const PointRTree::BranchNode& node = original.BranchNodes()[i];
+    EXPECT_THAT(restored->BranchNodes()[i],
+                Branch(node.bounds, node.is_leaf_parent,
+                       node.child_indices.Values()));
+  }
+}
+
+TEST(StaticRTreeTest, FromBranchNodesRejectsInvalidStructure) {
+  std::vector<Rect> element_bounds(4, Rect::FromTwoPoints({0, 0}, {1, 1}));
+  auto generator = []() { return Point{0, 0}; };
+
+  // An element is the child of two nodes.
+  EXPECT_THAT(
+      PointRTree::FromBranchNodes(
+          generator, element_bounds,
+          {{.is_leaf_parent = false,
+            .child_indices = SmallArray<uint32_t, 3>({1, 2})},
+           {.is_leaf_parent = true,
+            .child_indices = SmallArray<uint32_t, 3>({0, 1, 2})},
+           {.is_leaf_parent = true,
+            .child_indices = SmallArray<uint32_t, 3>({2, 3})}})
+          .status(),
+      absl_testing::StatusIs(absl::StatusCode::kInvalidArgument,
+                             HasSubstr("more than one")));
+  // A branch child that precedes its parent.
+  EXPECT_THAT(
+      PointRTree::FromBranchNodes(
+          generator, element_bounds,
+          {{.is_leaf_parent = false,
+            .child_indices = SmallArray<uint32_t, 3>({1})},
+           {.is_leaf_parent = false,
+            .child_indices = SmallArray<uint32_t, 3>({0})}})
+          .status(),
+      absl_testing::StatusIs(absl::StatusCode::kInvalidArgument,
+                             HasSubstr("branch child")));
+  // Elements without branch nodes.
+  absl::StatusOr<PointRTree> no_branch_nodes =
+      PointRTree::FromBranchNodes(generator, element_bounds, {});
+  EXPECT_EQ(no_branch_nodes.status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 TEST(StaticRTree, VisitIntersectedElementsPointsWithRectQuery) {
   // There are 20 points, laid out on an integer grid like so:
   //
@@ -437,6 +605,235 @@ TEST(StaticRTree, VisitIntersectedElementsStopEarly) {
   EXPECT_THAT(visited, Not(Contains(Point{2, 0})));
 }
 
+TEST(StaticRTree, VisitIntersectedLeafBlocksMatchesVisitIntersectedElements) {
+  std::vector<Point> points;
+  for (int x = 0; x < 20; ++x) {
+    for (int y = 0; y < 20; ++y) {
+      points.push_back({static_cast<float>(x), static_cast<float>(y)});
+    }
+  }
+  PointRTree rtree(points, point_bounds);
+  Rect query = Rect::FromTwoPoints({1.5, 0.5}, {12.5, 7.5});
+
+  std::vector<Point> expected;
+  rtree.VisitIntersectedElements(query, [&expected](Point p) {
+    expected.push_back(p);
+    return true;
+  });
+  std::vector<Point> visited;
+  rtree.VisitIntersectedLeafBlocks(
+      query, [&visited](absl::Span<const Point> block) {
+        EXPECT_THAT(block, Not(IsEmpty()));
+        EXPECT_LE(block.size(), PointRTree::kMaxChildrenPerNode);
+        visited.insert(visited.end(), block.begin(), block.end());
+        return true;
+      });
+
+  EXPECT_THAT(visited, ElementsAreArray(expected));
+}
+
+TEST(StaticRTree, VisitIntersectedLeafBlocksStopEarly) {
+  std::vector<Point> points;
+  for (int x = 0; x < 10; ++x) {
+    points.push_back({static_cast<float>(x), 0});
+  }
+  PointRTree rtree(points, point_bounds);
+
+  int n_blocks = 0;
+  rtree.VisitIntersectedLeafBlocks(Rect::FromTwoPoints({-1, -1}, {10, 1}),
+                                   [&n_blocks](absl::Span<const Point>) {
+                                     ++n_blocks;
+                                     return false;
+                                   });
+  EXPECT_EQ(n_blocks, 1);
+}
+
+TEST(StaticRTree, VisitIntersectedElementsForEachMatchesSeparateQueries) {
+  std::vector<Point> points;
+  for (int x = 0; x < 20; ++x) {
+    for (int y = 0; y < 20; ++y) {
+      points.push_back({static_cast<float>(x), static_cast<float>(y)});
+    }
+  }
+  PointRTree rtree(points, point_bounds);
+  std::vector<Rect> queries = {
+      Rect::FromTwoPoints({0.5, 0.5}, {2.5, 1.5}),
+      Rect::FromTwoPoints({-10, -10}, {-5, -5}),
+      Rect::FromTwoPoints({3, 3}, {3, 3}),
+      Rect::FromTwoPoints({1.5, 0.5}, {4.5, 2.5}),
+      Rect::FromTwoPoints({15.5, -1}, {30, 3.5}),
+  };
+
+  std::vector<std::vector<Point>> visited_for_each(queries.size());
+  rtree.VisitIntersectedElementsForEach(
+      queries, [&visited_for_each](uint32_t query_idx, Point p) {
+        visited_for_each[query_idx].push_back(p);
+        return true;
+      });
+
+  for (uint32_t i = 0; i < queries.size(); ++i) {
+    std::vector<Point> expected;
+    rtree.VisitIntersectedElements(queries[i], [&expected](Point p) {
+      expected.push_back(p);
+      return true;
+    });
+    EXPECT_THAT(visited_for_each[i], UnorderedElementsAreArray(expected))
+        << "query " << i;
+  }
+}
+
+TEST(StaticRTree, VisitIntersectedElementsForEachStopsEachQueryIndependently) {
+  std::vector<Point> points{{0, 0}, {2, 0}, {1, 1}, {4, 1},
+                            {3, 2}, {1, 3}, {2, 4}};
+  PointRTree rtree(points, point_bounds);
+  std::vector<Rect> queries = {Rect::FromTwoPoints({1, 1}, {4, 4}),
+                               Rect::FromTwoPoints({-1, -1}, {5, 5})};
+
+  // This visitor stops the first query after one element, and visits all of
+  // the elements for the second.
+  std::vector<Point> first_visited;
+  std::vector<Point> second_visited;
+  rtree.VisitIntersectedElementsForEach(
+      queries,
+      [&first_visited, &second_visited](uint32_t query_idx, Point p) {
+        if (query_idx == 0) {
+          first_visited.push_back(p);
+          return false;
+        }
+        second_visited.push_back(p);
+        return true;
+      });
+
+  EXPECT_EQ(first_visited.size(), 1);
+  EXPECT_THAT(second_visited, UnorderedElementsAreArray(points));
+}
+
+TEST(StaticRTree, VisitIntersectedElementsForEachWithNoQueries) {
+  std::vector<Point> points{{0, 0}, {2, 0}, {1, 1}};
+  PointRTree rtree(points, point_bounds);
+
+  bool visited = false;
+  rtree.VisitIntersectedElementsForEach({}, [&visited](uint32_t, Point) {
+    visited = true;
+    return true;
+  });
+  EXPECT_FALSE(visited);
+}
+
+TEST(StaticRTree, VisitElementsInBoundsDistanceOrder) {
+  std::vector<Point> points;
+  for (int x = 0; x < 10; ++x) {
+    for (int y = 0; y < 10; ++y) {
+      points.push_back({static_cast<float>(x), static_cast<float>(y)});
+    }
+  }
+  PointRTree rtree(points, point_bounds);
+  Point query = {3.2, 6.9};
+
+  std::vector<float> visited_distances;
+  std::vector<Point> visited_points;
+  rtree.VisitElementsInBoundsDistanceOrder(
+      [query](const Rect& r) { return Distance(query, r); },
+      [&visited_distances, &visited_points](float distance, Point p) {
+        visited_distances.push_back(distance);
+        visited_points.push_back(p);
+        return true;
+      });
+
+  EXPECT_THAT(visited_points, UnorderedElementsAreArray(points));
+  EXPECT_TRUE(absl::c_is_sorted(visited_distances));
+  for (size_t i = 0; i < visited_points.size(); ++i) {
+    EXPECT_FLOAT_EQ(visited_distances[i], Distance(query, visited_points[i]));
+  }
+}
+
+TEST(StaticRTree, VisitElementsInBoundsDistanceOrderStopEarly) {
+  std::vector<Point> points{{0, 0}, {2, 0}, {1, 1}, {4, 1},
+                            {3, 2}, {1, 3}, {2, 4}};
+  PointRTree rtree(points, point_bounds);
+  Point query = {4, 4};
+
+  std::vector<Point> visited;
+  rtree.VisitElementsInBoundsDistanceOrder(
+      [query](const Rect& r) { return Distance(query, r); },
+      [&visited](float, Point p) {
+        visited.push_back(p);
+        return visited.size() < 2;
+      });
+
+  // The two points nearest to {4, 4} are {3, 2} and {2, 4}.
+  EXPECT_THAT(visited, UnorderedElementsAre(Point{3, 2}, Point{2, 4}));
+}
+
+TEST(StaticRTree, VisitIntersectedElementPairsMatchesAllPairs) {
+  std::vector<Point> points;
+  for (int x = 0; x < 12; ++x) {
+    for (int y = 0; y < 12; ++y) {
+      points.push_back({static_cast<float>(x), static_cast<float>(y)});
+    }
+  }
+  // The second tree holds indices into `rects`.
+  std::vector<int> rect_indices;
+  std::vector<Rect> rects;
+  for (int i = 0; i < 40; ++i) {
+    rect_indices.push_back(i);
+    rects.push_back(Rect::FromCenterAndDimensions(
+        {0.7f * i - 5, 0.3f * i}, 0.5f + (i % 3), 0.5f + (i % 4)));
+  }
+  PointRTree point_rtree(points, point_bounds);
+  StaticRTree<int, 4> rect_rtree(rect_indices, rects);
+  AffineTransform rect_to_point = AffineTransform::Translate({2, -1}) *
+                                  AffineTransform::Scale(1.5, 0.75);
+
+  std::vector<std::pair<Point, int>> visited;
+  point_rtree.VisitIntersectedElementPairs(
+      rect_rtree, rect_to_point, [&visited](Point p, int rect_index) {
+        visited.push_back({p, rect_index});
+        return true;
+      });
+
+  std::vector<std::pair<Point, int>> expected;
+  for (Point p : points) {
+    for (int i = 0; i < 40; ++i) {
+      if (IntersectsInternal(
+              p, *Envelope(rect_to_point.Apply(rects[i])).AsRect())) {
+        expected.push_back({p, i});
+      }
+    }
+  }
+  ASSERT_THAT(expected, Not(IsEmpty()));
+  EXPECT_THAT(visited, UnorderedElementsAreArray(expected));
+}
+
+TEST(StaticRTree, VisitIntersectedElementPairsStopEarly) {
+  std::vector<Point> points{{0, 0}, {2, 0}, {1, 1}, {4, 1},
+                            {3, 2}, {1, 3}, {2, 4}};
+  PointRTree rtree(points, point_bounds);
+
+  int n_visited = 0;
+  rtree.VisitIntersectedElementPairs(rtree, AffineTransform(),
+                                     [&n_visited](Point, Point) {
+                                       ++n_visited;
+                                       return n_visited < 3;
+                                     });
+  EXPECT_EQ(n_visited, 3);
+}
+
+TEST(StaticRTree, VisitIntersectedElementPairsWithEmptyTree) {
+  std::vector<Point> points{{0, 0}, {2, 0}, {1, 1}};
+  PointRTree rtree(points, point_bounds);
+  PointRTree empty_rtree;
+
+  bool visited = false;
+  auto visitor = [&visited](Point, Point) {
+    visited = true;
+    return true;
+  };
+  rtree.VisitIntersectedElementPairs(empty_rtree, AffineTransform(), visitor);
+  empty_rtree.VisitIntersectedElementPairs(rtree, AffineTransform(), visitor);
+  EXPECT_FALSE(visited);
+}
+
 TEST(StaticRTreeDeathTest, CannotConstructWithNullBoundsFunction) {
   EXPECT_DEATH_IF_SUPPORTED(PointRTree({{0, 0}, {1, 1}}, nullptr),
                             "must be non-null");
@@ -444,5 +841,11 @@ TEST(StaticRTreeDeathTest, CannotConstructWithNullBoundsFunction) {
       PointRTree(3, []() { return Point{0, 0}; }, nullptr), "must be non-null");
 }
 
+TEST(StaticRTreeDeathTest, PrecomputedBoundsSizeMismatch) {
+  std::vector<Point> elements{{0, 0}, {1, 1}};
+  std::vector<Rect> element_bounds{Rect::FromTwoPoints({0, 0}, {0, 0})};
+  EXPECT_DEATH_IF_SUPPORTED(PointRTree(elements, element_bounds), "");
+}
+
 }  // namespace
 }  // namespace ink::geometry_internal
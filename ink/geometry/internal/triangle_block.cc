@@ -0,0 +1,271 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/internal/triangle_block.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "ink/geometry/angle.h"
+#include "ink/geometry/internal/intersects_internal.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+#include "ink/geometry/vec.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+// A per-triangle flag. This is an integer as wide as a coordinate, rather than
+// a `bool`, so that the loops that compute the flags can be vectorized.
+using LaneFlags = std::array<int32_t, kTriangleBlockSize>;
+
+// The per-triangle results of the common case of a scalar test. `hit` is set
+// for the triangles known to intersect the query. `unknown` is set for the
+// triangles that reached a special case of one of the scalar test's steps, for
+// which the result is only known if another step hit.
+//
+// The helpers below use non-short-circuiting operators, and compare points one
+// coordinate at a time, so that the loops that call them have no branches and
+// can be vectorized.
+struct LaneResults {
+  LaneFlags hit = {};
+  LaneFlags unknown = {};
+};
+
+inline Point P0(const TriangleBlock& block, uint32_t i) {
+  return {block.x0[i], block.y0[i]};
+}
+inline Point P1(const TriangleBlock& block, uint32_t i) {
+  return {block.x1[i], block.y1[i]};
+}
+inline Point P2(const TriangleBlock& block, uint32_t i) {
+  return {block.x2[i], block.y2[i]};
+}
+
+inline int32_t Equal(Point a, Point b) { return (a.x == b.x) & (a.y == b.y); }
+
+// The common case of `Triangle{p0, p1, p2}.Contains(point)`, which excludes
+// points on the line of two of the triangle's edges.
+inline void TriangleContains(Point p0, Point p1, Point p2, Point point,
+                             int32_t& hit, int32_t& unknown) {
+  float d0 = Vec::Determinant(point - p0, p1 - p0);
+  float d1 = Vec::Determinant(point - p1, p2 - p1);
+  float d2 = Vec::Determinant(point - p2, p0 - p2);
+  int32_t collinear = (d0 == 0) & (d1 == 0);
+  hit |= (collinear ^ 1) & !(d0 * d1 < 0) & (d1 * d2 >= 0) & (d0 * d2 >= 0);
+  unknown |= collinear;
+}
+
+// The common case of `IntersectsInternal(Segment{a_start, a_end},
+// Segment{b_start, b_end})`, which excludes point-like and parallel segments
+// that don't share an endpoint.
+inline void SegmentsIntersect(Point a_start, Point a_end, Point b_start,
+                              Point b_end, int32_t& hit, int32_t& unknown) {
+  int32_t shared_endpoint = Equal(a_start, b_start) | Equal(a_start, b_end) |
+                            Equal(a_end, b_start) | Equal(a_end, b_end);
+  Vec vec_a = a_end - a_start;
+  Vec vec_b = b_end - b_start;
+  int32_t special = Equal(a_start, a_end) | Equal(b_start, b_end) |
+                    (Vec::Determinant(vec_a, vec_b) == 0);
+  float v1 = Vec::Determinant(vec_a, b_start - a_start);
+  float v2 = Vec::Determinant(vec_a, b_end - a_start);
+  float v3 = Vec::Determinant(vec_b, a_start - b_start);
+  float v4 = Vec::Determinant(vec_b, a_end - b_start);
+  hit |= shared_endpoint |
+         ((special ^ 1) & (v1 * v2 <= 0) & (v3 * v4 <= 0));
+  unknown |= special;
+}
+
+// Tests every triangle of `block` against the edge `edge_start` to
+// `edge_end`, which is the first argument of each segment test.
+void EdgeIntersectsTriangleEdges(Point edge_start, Point edge_end,
+                                 const TriangleBlock& block,
+                                 LaneResults& lanes) {
+  for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+    Point p0 = P0(block, i);
+    Point p1 = P1(block, i);
+    Point p2 = P2(block, i);
+    int32_t hit = lanes.hit[i];
+    int32_t unknown = lanes.unknown[i];
+    SegmentsIntersect(edge_start, edge_end, p0, p1, hit, unknown);
+    SegmentsIntersect(edge_start, edge_end, p1, p2, hit, unknown);
+    SegmentsIntersect(edge_start, edge_end, p2, p0, hit, unknown);
+    lanes.hit[i] = hit;
+    lanes.unknown[i] = unknown;
+  }
+}
+
+// Tests each edge of every triangle of `block` against the edge `edge_start`
+// to `edge_end`, which is the second argument of each segment test.
+void TriangleEdgesIntersectEdge(const TriangleBlock& block, Point edge_start,
+                                Point edge_end, LaneResults& lanes) {
+  for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+    Point p0 = P0(block, i);
+    Point p1 = P1(block, i);
+    Point p2 = P2(block, i);
+    int32_t hit = lanes.hit[i];
+    int32_t unknown = lanes.unknown[i];
+    SegmentsIntersect(p0, p1, edge_start, edge_end, hit, unknown);
+    SegmentsIntersect(p1, p2, edge_start, edge_end, hit, unknown);
+    SegmentsIntersect(p2, p0, edge_start, edge_end, hit, unknown);
+    lanes.hit[i] = hit;
+    lanes.unknown[i] = unknown;
+  }
+}
+
+// Tests whether every triangle of `block` contains `point`.
+void TrianglesContainPoint(const TriangleBlock& block, Point point,
+                           LaneResults& lanes) {
+  for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+    int32_t hit = lanes.hit[i];
+    int32_t unknown = lanes.unknown[i];
+    TriangleContains(P0(block, i), P1(block, i), P2(block, i), point, hit,
+                     unknown);
+    lanes.hit[i] = hit;
+    lanes.unknown[i] = unknown;
+  }
+}
+
+// Returns the results in `lanes`, after calling `scalar_test` for each
+// triangle whose result is unknown, and for each point-like triangle, which
+// every scalar test but the one against a `Point` handles as a special case.
+template <typename ScalarTest>
+TriangleBlockMask Finish(const TriangleBlock& block, const LaneResults& lanes,
+                         ScalarTest scalar_test) {
+  LaneFlags result;
+  LaneFlags needs_scalar_test;
+  for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+    Point p0 = P0(block, i);
+    int32_t point_like = Equal(p0, P1(block, i)) & Equal(p0, P2(block, i));
+    int32_t in_block = i < block.size;
+    result[i] = in_block & (point_like ^ 1) & lanes.hit[i];
+    needs_scalar_test[i] =
+        in_block & (point_like | ((lanes.hit[i] ^ 1) & lanes.unknown[i]));
+  }
+  TriangleBlockMask mask;
+  for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+    mask[i] = needs_scalar_test[i] ? scalar_test(block.Get(i)) : result[i];
+  }
+  return mask;
+}
+
+}  // namespace
+
+TriangleBlockMask IntersectsTriangleBlock(Point query,
+                                          const TriangleBlock& block) {
+  LaneResults lanes;
+  TrianglesContainPoint(block, query, lanes);
+  return Finish(block, lanes, [query](const Triangle& triangle) {
+    return IntersectsInternal(query, triangle);
+  });
+}
+
+TriangleBlockMask IntersectsTriangleBlock(const Segment& query,
+                                          const TriangleBlock& block) {
+  LaneResults lanes;
+  TrianglesContainPoint(block, query.start, lanes);
+  // A point-like segment is tested as its start point.
+  if (query.start != query.end) {
+    EdgeIntersectsTriangleEdges(query.start, query.end, block, lanes);
+  }
+  return Finish(block, lanes, [&query](const Triangle& triangle) {
+    return IntersectsInternal(query, triangle);
+  });
+}
+
+TriangleBlockMask IntersectsTriangleBlock(const Triangle& query,
+                                          const TriangleBlock& block) {
+  LaneResults lanes;
+  TrianglesContainPoint(block, query.p0, lanes);
+  // A point-like query is tested as its first corner.
+  if (query.p0 != query.p1 || query.p0 != query.p2) {
+    for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+      int32_t hit = lanes.hit[i];
+      int32_t unknown = lanes.unknown[i];
+      TriangleContains(query.p0, query.p1, query.p2, P0(block, i), hit,
+                       unknown);
+      lanes.hit[i] = hit;
+      lanes.unknown[i] = unknown;
+    }
+    for (int j = 0; j < 3; ++j) {
+      Segment edge = query.GetEdge(j);
+      EdgeIntersectsTriangleEdges(edge.start, edge.end, block, lanes);
+    }
+  }
+  return Finish(block, lanes, [&query](const Triangle& triangle) {
+    return IntersectsInternal(query, triangle);
+  });
+}
+
+TriangleBlockMask IntersectsTriangleBlock(const Rect& query,
+                                          const TriangleBlock& block) {
+  LaneResults lanes;
+  if (query.Width() == 0 && query.Height() == 0) {
+    // A point-like query is tested as its center.
+    TrianglesContainPoint(block, query.Center(), lanes);
+  } else {
+    for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+      lanes.hit[i] = (query.XMin() <= block.x0[i]) &
+                     (query.XMax() >= block.x0[i]) &
+                     (query.YMin() <= block.y0[i]) &
+                     (query.YMax() >= block.y0[i]);
+    }
+    TrianglesContainPoint(block, query.Center(), lanes);
+    for (int j = 0; j < 4; ++j) {
+      Segment edge = query.GetEdge(j);
+      TriangleEdgesIntersectEdge(block, edge.start, edge.end, lanes);
+    }
+  }
+  return Finish(block, lanes, [&query](const Triangle& triangle) {
+    return IntersectsInternal(query, triangle);
+  });
+}
+
+TriangleBlockMask IntersectsTriangleBlock(const Quad& query,
+                                          const TriangleBlock& block) {
+  LaneResults lanes;
+  if (query.Width() == 0 && query.Height() == 0) {
+    // A point-like query is tested as its center.
+    TrianglesContainPoint(block, query.Center(), lanes);
+  } else {
+    // This is `Quad::Contains`, with the quad's axis and extents computed
+    // once for the whole block.
+    Vec u = {Cos(query.Rotation()), Sin(query.Rotation())};
+    Point center = query.Center();
+    float skew = query.Skew();
+    float half_width = .5f * query.Width();
+    float half_height = .5f * std::abs(query.Height());
+    for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+      Vec q = P0(block, i) - center;
+      float u_cross_q = Vec::Determinant(u, q);
+      float u_dot_q = Vec::DotProduct(u, q);
+      lanes.hit[i] = !(std::abs(u_cross_q) > half_height) &
+                     (std::abs(u_dot_q - skew * u_cross_q) <= half_width);
+    }
+    TrianglesContainPoint(block, query.Center(), lanes);
+    for (int j = 0; j < 4; ++j) {
+      Segment edge = query.GetEdge(j);
+      TriangleEdgesIntersectEdge(block, edge.start, edge.end, lanes);
+    }
+  }
+  return Finish(block, lanes, [&query](const Triangle& triangle) {
+    return IntersectsInternal(query, triangle);
+  });
+}
+
+}  // namespace ink::geometry_internal
@@ -0,0 +1,97 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_GEOMETRY_INTERNAL_TRIANGLE_BLOCK_H_
+#define INK_GEOMETRY_INTERNAL_TRIANGLE_BLOCK_H_
+
+#include <array>
+#include <cstdint>
+
+#include "absl/log/absl_check.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink::geometry_internal {
+
+// The maximum number of triangles in a `TriangleBlock`. This matches the
+// default branching factor of `StaticRTree`, so that the elements of one of its
+// leaf-parent nodes fit in one block.
+inline constexpr uint32_t kTriangleBlockSize = 16;
+
+// A block of triangles, stored as one array per coordinate, so that a query can
+// be tested against all of them with loops that the compiler can vectorize.
+// Only the first `size` entries of each array are meaningful.
+struct TriangleBlock {
+  // Appends `triangle` to the block. This DCHECK-fails if the block is full.
+  void Append(const Triangle& triangle);
+
+  Triangle Get(uint32_t index) const;
+
+  std::array<float, kTriangleBlockSize> x0 = {};
+  std::array<float, kTriangleBlockSize> y0 = {};
+  std::array<float, kTriangleBlockSize> x1 = {};
+  std::array<float, kTriangleBlockSize> y1 = {};
+  std::array<float, kTriangleBlockSize> x2 = {};
+  std::array<float, kTriangleBlockSize> y2 = {};
+  uint32_t size = 0;
+};
+
+// For each of the first `block.size` triangles of `block`, whether it
+// intersects the query; the remaining entries are false.
+using TriangleBlockMask = std::array<bool, kTriangleBlockSize>;
+
+// These give, for each triangle of `block`, exactly the same result as the
+// corresponding `IntersectsInternal` overload. Each triangle is tested with the
+// same arithmetic as the scalar overload's common case, for all of the
+// triangles at once; the few triangles that reach one of its special cases
+// (e.g. a point-like triangle, or an edge parallel to one of the query's) are
+// then tested individually with the scalar overload.
+TriangleBlockMask IntersectsTriangleBlock(Point query,
+                                          const TriangleBlock& block);
+TriangleBlockMask IntersectsTriangleBlock(const Segment& query,
+                                          const TriangleBlock& block);
+TriangleBlockMask IntersectsTriangleBlock(const Triangle& query,
+                                          const TriangleBlock& block);
+TriangleBlockMask IntersectsTriangleBlock(const Rect& query,
+                                          const TriangleBlock& block);
+TriangleBlockMask IntersectsTriangleBlock(const Quad& query,
+                                          const TriangleBlock& block);
+
+// ---------------------------------------------------------------------------
+//                     Implementation details below
+
+inline void TriangleBlock::Append(const Triangle& triangle) {
+  ABSL_DCHECK_LT(size, kTriangleBlockSize);
+  x0[size] = triangle.p0.x;
+  y0[size] = triangle.p0.y;
+  x1[size] = triangle.p1.x;
+  y1[size] = triangle.p1.y;
+  x2[size] = triangle.p2.x;
+  y2[size] = triangle.p2.y;
+  ++size;
+}
+
+inline Triangle TriangleBlock::Get(uint32_t index) const {
+  ABSL_DCHECK_LT(index, size);
+  return {.p0 = {x0[index], y0[index]},
+          .p1 = {x1[index], y1[index]},
+          .p2 = {x2[index], y2[index]}};
+}
+
+}  // namespace ink::geometry_internal
+
+#endif  // INK_GEOMETRY_INTERNAL_TRIANGLE_BLOCK_H_
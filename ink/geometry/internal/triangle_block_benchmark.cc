@@ -0,0 +1,152 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/internal/intersects_internal.h"
+#include "ink/geometry/internal/triangle_block.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+
+// These compare testing a query against the triangles of a full
+// `TriangleBlock` at once with testing them one at a time, which is what
+// `PartitionedMesh` queries did for each leaf of the spatial index before the
+// blocks were introduced. The end-to-end effect on those queries is measured
+// by `BM_IntersectsMesh` and `BM_CoverageOfMesh` in
+// geometry_query_benchmark.cc.
+
+namespace ink::geometry_internal {
+namespace {
+
+// The number of pseudo-random blocks and queries that each benchmark cycles
+// through, so that branch prediction doesn't learn a single fixed answer.
+constexpr int kNumBlocks = 256;
+
+// Generates pseudo-random triangles and queries in the square from (-10, -10)
+// to (10, 10), with sizes of up to 5, so that a query hits some but not all of
+// the triangles of a block, as when visiting a leaf of the spatial index.
+class ShapeGenerator {
+ public:
+  explicit ShapeGenerator(uint64_t seed) : rng_(seed) {}
+
+  template <typename T>
+  T Make();
+
+ private:
+  float Between(float a, float b) {
+    return std::uniform_real_distribution<float>(a, b)(rng_);
+  }
+  Point MakePointNear(Point p) {
+    return {p.x + Between(-2.5, 2.5), p.y + Between(-2.5, 2.5)};
+  }
+
+  std::mt19937_64 rng_;
+};
+
+template <>
+Point ShapeGenerator::Make<Point>() {
+  return {Between(-10, 10), Between(-10, 10)};
+}
+
+template <>
+Segment ShapeGenerator::Make<Segment>() {
+  Point center = Make<Point>();
+  return {MakePointNear(center), MakePointNear(center)};
+}
+
+template <>
+Triangle ShapeGenerator::Make<Triangle>() {
+  Point center = Make<Point>();
+  return {MakePointNear(center), MakePointNear(center), MakePointNear(center)};
+}
+
+template <>
+Rect ShapeGenerator::Make<Rect>() {
+  return Rect::FromCenterAndDimensions(Make<Point>(), Between(0.5, 5),
+                                       Between(0.5, 5));
+}
+
+template <>
+Quad ShapeGenerator::Make<Quad>() {
+  return Quad::FromCenterDimensionsRotationAndSkew(
+      Make<Point>(), Between(0.5, 5), Between(0.5, 5),
+      Angle::Radians(Between(0, 6.28)), Between(-1, 1));
+}
+
+std::vector<TriangleBlock> MakeBlocks(ShapeGenerator& generator) {
+  std::vector<TriangleBlock> blocks(kNumBlocks);
+  for (TriangleBlock& block : blocks) {
+    for (uint32_t i = 0; i < kTriangleBlockSize; ++i) {
+      block.Append(generator.Make<Triangle>());
+    }
+  }
+  return blocks;
+}
+
+template <typename T>
+std::vector<T> MakeQueries(ShapeGenerator& generator) {
+  std::vector<T> queries;
+  for (int i = 0; i < kNumBlocks; ++i) queries.push_back(generator.Make<T>());
+  return queries;
+}
+
+template <typename T>
+void BM_IntersectsTriangleBlock(benchmark::State& state) {
+  ShapeGenerator generator(0);
+  std::vector<TriangleBlock> blocks = MakeBlocks(generator);
+  std::vector<T> queries = MakeQueries<T>(generator);
+  int i = 0;
+  for (auto s : state) {
+    benchmark::DoNotOptimize(IntersectsTriangleBlock(queries[i], blocks[i]));
+    i = (i + 1) % kNumBlocks;
+  }
+  state.SetItemsProcessed(state.iterations() * kTriangleBlockSize);
+}
+BENCHMARK_TEMPLATE(BM_IntersectsTriangleBlock, Point);
+BENCHMARK_TEMPLATE(BM_IntersectsTriangleBlock, Segment);
+BENCHMARK_TEMPLATE(BM_IntersectsTriangleBlock, Triangle);
+BENCHMARK_TEMPLATE(BM_IntersectsTriangleBlock, Rect);
+BENCHMARK_TEMPLATE(BM_IntersectsTriangleBlock, Quad);
+
+template <typename T>
+void BM_IntersectsTrianglesOneAtATime(benchmark::State& state) {
+  ShapeGenerator generator(0);
+  std::vector<TriangleBlock> blocks = MakeBlocks(generator);
+  std::vector<T> queries = MakeQueries<T>(generator);
+  int i = 0;
+  for (auto s : state) {
+    TriangleBlockMask mask = {};
+    for (uint32_t j = 0; j < kTriangleBlockSize; ++j) {
+      mask[j] = IntersectsInternal(queries[i], blocks[i].Get(j));
+    }
+    benchmark::DoNotOptimize(mask);
+    i = (i + 1) % kNumBlocks;
+  }
+  state.SetItemsProcessed(state.iterations() * kTriangleBlockSize);
+}
+BENCHMARK_TEMPLATE(BM_IntersectsTrianglesOneAtATime, Point);
+BENCHMARK_TEMPLATE(BM_IntersectsTrianglesOneAtATime, Segment);
+BENCHMARK_TEMPLATE(BM_IntersectsTrianglesOneAtATime, Triangle);
+BENCHMARK_TEMPLATE(BM_IntersectsTrianglesOneAtATime, Rect);
+BENCHMARK_TEMPLATE(BM_IntersectsTrianglesOneAtATime, Quad);
+
+}  // namespace
+}  // namespace ink::geometry_internal
@@ -0,0 +1,185 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/internal/triangle_block.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/internal/intersects_internal.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+#include "ink/geometry/type_matchers.h"
+
+namespace ink::geometry_internal {
+namespace {
+
+// Generates shapes whose corners lie on a small integer grid, so that shared
+// corners, corners on edges, parallel edges, and point-like shapes, which are
+// the special cases of the scalar tests, are common.
+class GridShapeGenerator {
+ public:
+  explicit GridShapeGenerator(uint64_t seed) : rng_(seed) {}
+
+  Point MakePoint() {
+    std::uniform_int_distribution<int> coord(-3, 3);
+    return {static_cast<float>(coord(rng_)), static_cast<float>(coord(rng_))};
+  }
+  Segment MakeSegment() { return {MakePoint(), MakePoint()}; }
+  Triangle MakeTriangle() { return {MakePoint(), MakePoint(), MakePoint()}; }
+  Rect MakeRect() { return Rect::FromTwoPoints(MakePoint(), MakePoint()); }
+  Quad MakeQuad() {
+    std::uniform_int_distribution<int> quarter_turns(0, 3);
+    std::uniform_int_distribution<int> skew(-1, 1);
+    Point center = MakePoint();
+    Point size = MakePoint();
+    return Quad::FromCenterDimensionsRotationAndSkew(
+        center, std::abs(size.x), size.y,
+        Angle::Degrees(90 * quarter_turns(rng_)), skew(rng_));
+  }
+
+  TriangleBlock MakeBlock(uint32_t size) {
+    TriangleBlock block;
+    for (uint32_t i = 0; i < size; ++i) block.Append(MakeTriangle());
+    return block;
+  }
+
+ private:
+  std::mt19937_64 rng_;
+};
+
+// Expects that `IntersectsTriangleBlock(query, block)` matches the scalar test
+// for each triangle in `block`, and is false for the unused entries.
+template <typename Query>
+void ExpectMatchesScalarTest(const Query& query, const TriangleBlock& block) {
+  TriangleBlockMask mask = IntersectsTriangleBlock(query, block);
+  for (uint32_t i = 0; i < block.size; ++i) {
+    EXPECT_EQ(mask[i], IntersectsInternal(query, block.Get(i)))
+        << "query = " << testing::PrintToString(query)
+        << ", triangle = " << testing::PrintToString(block.Get(i));
+  }
+  for (uint32_t i = block.size; i < kTriangleBlockSize; ++i) {
+    EXPECT_FALSE(mask[i]) << "unused entry " << i;
+  }
+}
+
+TEST(TriangleBlockTest, AppendAndGet) {
+  TriangleBlock block;
+  Triangle first = {{0, 0}, {1, 0}, {0, 1}};
+  Triangle second = {{2, 3}, {4, 5}, {6, 7}};
+  block.Append(first);
+  block.Append(second);
+
+  EXPECT_EQ(block.size, 2);
+  EXPECT_THAT(block.Get(0), TriangleEq(first));
+  EXPECT_THAT(block.Get(1), TriangleEq(second));
+}
+
+TEST(TriangleBlockTest, EmptyBlockHasNoIntersections) {
+  TriangleBlock block;
+  EXPECT_EQ(IntersectsTriangleBlock(Point{0, 0}, block), TriangleBlockMask{});
+  EXPECT_EQ(IntersectsTriangleBlock(Rect::FromTwoPoints({-1, -1}, {1, 1}),
+                                    block),
+            TriangleBlockMask{});
+}
+
+TEST(TriangleBlockTest, IgnoresStaleEntriesPastSize) {
+  GridShapeGenerator generator(0);
+  TriangleBlock block = generator.MakeBlock(kTriangleBlockSize);
+  block.size = 5;
+  ExpectMatchesScalarTest(Rect::FromTwoPoints({-3, -3}, {3, 3}), block);
+}
+
+TEST(TriangleBlockTest, PointMatchesScalarTest) {
+  GridShapeGenerator generator(1);
+  for (int i = 0; i < 200; ++i) {
+    ExpectMatchesScalarTest(generator.MakePoint(),
+                            generator.MakeBlock(kTriangleBlockSize));
+  }
+}
+
+TEST(TriangleBlockTest, SegmentMatchesScalarTest) {
+  GridShapeGenerator generator(2);
+  for (int i = 0; i < 200; ++i) {
+    ExpectMatchesScalarTest(generator.MakeSegment(),
+                            generator.MakeBlock(kTriangleBlockSize));
+  }
+}
+
+TEST(TriangleBlockTest, TriangleMatchesScalarTest) {
+  GridShapeGenerator generator(3);
+  for (int i = 0; i < 200; ++i) {
+    ExpectMatchesScalarTest(generator.MakeTriangle(),
+                            generator.MakeBlock(kTriangleBlockSize));
+  }
+}
+
+TEST(TriangleBlockTest, RectMatchesScalarTest) {
+  GridShapeGenerator generator(4);
+  for (int i = 0; i < 200; ++i) {
+    ExpectMatchesScalarTest(generator.MakeRect(),
+                            generator.MakeBlock(kTriangleBlockSize));
+  }
+}
+
+TEST(TriangleBlockTest, QuadMatchesScalarTest) {
+  GridShapeGenerator generator(5);
+  for (int i = 0; i < 200; ++i) {
+    ExpectMatchesScalarTest(generator.MakeQuad(),
+                            generator.MakeBlock(kTriangleBlockSize));
+  }
+}
+
+TEST(TriangleBlockTest, MatchesScalarTestForPartialBlocks) {
+  GridShapeGenerator generator(6);
+  for (uint32_t size = 0; size <= kTriangleBlockSize; ++size) {
+    TriangleBlock block = generator.MakeBlock(size);
+    ExpectMatchesScalarTest(generator.MakePoint(), block);
+    ExpectMatchesScalarTest(generator.MakeSegment(), block);
+    ExpectMatchesScalarTest(generator.MakeTriangle(), block);
+    ExpectMatchesScalarTest(generator.MakeRect(), block);
+    ExpectMatchesScalarTest(generator.MakeQuad(), block);
+  }
+}
+
+TEST(TriangleBlockTest, MatchesScalarTestForRandomShapes) {
+  std::mt19937_64 rng(7);
+  std::uniform_real_distribution<float> coord(-10, 10);
+  auto point = [&rng, &coord]() { return Point{coord(rng), coord(rng)}; };
+  for (int i = 0; i < 100; ++i) {
+    TriangleBlock block;
+    for (uint32_t j = 0; j < kTriangleBlockSize; ++j) {
+      block.Append({point(), point(), point()});
+    }
+    ExpectMatchesScalarTest(point(), block);
+    ExpectMatchesScalarTest(Segment{point(), point()}, block);
+    ExpectMatchesScalarTest(Triangle{point(), point(), point()}, block);
+    ExpectMatchesScalarTest(Rect::FromTwoPoints(point(), point()), block);
+    ExpectMatchesScalarTest(
+        Quad::FromCenterDimensionsRotationAndSkew(
+            point(), std::abs(coord(rng)), coord(rng),
+            Angle::Radians(coord(rng)), coord(rng) / 10),
+        block);
+  }
+}
+
+}  // namespace
+}  // namespace ink::geometry_internal
@@ -14,9 +14,12 @@
 
 #include "ink/geometry/intersects.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <optional>
 
 #include "ink/geometry/affine_transform.h"
+#include "ink/geometry/envelope.h"
 #include "ink/geometry/internal/algorithms.h"
 #include "ink/geometry/partitioned_mesh.h"
 #include "ink/geometry/point.h"
@@ -87,6 +90,172 @@ bool Intersects(const PartitionedMesh& a,
   return IntersectsPartitionedMesh(a, a_to_b_transform, b);
 }
 
+void IntersectsQueryCache::Clear() {
+  mesh_ = PartitionedMesh();
+  last_hit_.reset();
+  region_.reset();
+  candidates_.clear();
+}
+
+namespace {
+
+// The most triangles that `IntersectsQueryCache` will keep for its region. If
+// more triangles intersect the region, it isn't cached, since testing them all
+// would be no faster than traversing the index.
+constexpr size_t kMaxCachedCandidates = 64;
+
+// The least margin that `IntersectsQueryCache` adds around a query to form its
+// region, as a fraction of the larger dimension of the mesh's bounds. This
+// gives queries with little or no extent, like points, a useful region.
+constexpr float kMinRegionMarginFraction = 1.f / 32;
+
+Triangle GetTriangle(const PartitionedMesh& mesh,
+                     PartitionedMesh::TriangleIndexPair index) {
+  return mesh.Meshes()[index.mesh_index].GetTriangle(index.triangle_index);
+}
+
+}  // namespace
+
+template <typename ObjectType>
+bool IntersectsQueryCache::IntersectsCandidate(
+    const ObjectType& mesh_space_query) {
+  for (PartitionedMesh::TriangleIndexPair index : candidates_) {
+    if (Intersects(mesh_space_query, GetTriangle(mesh_, index))) {
+      last_hit_ = index;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename ObjectType>
+bool IntersectsQueryCache::IntersectsInMeshSpace(
+    const PartitionedMesh& mesh, const ObjectType& mesh_space_query) {
+  // Copies of a `PartitionedMesh` share their meshes, so this identifies the
+  // same mesh data even if `mesh` is a different copy.
+  if (mesh_.Meshes().data() != mesh.Meshes().data()) {
+    Clear();
+    mesh_ = mesh;
+  }
+
+  if (last_hit_.has_value() &&
+      Intersects(mesh_space_query, GetTriangle(mesh_, *last_hit_))) {
+    return true;
+  }
+
+  Rect query_bounds = *Envelope(mesh_space_query).AsRect();
+  if (region_.has_value() && region_->Contains(query_bounds)) {
+    return IntersectsCandidate(mesh_space_query);
+  }
+
+  // Cache a region that is larger than the query, so that the queries that
+  // follow it, which are expected to be nearby, fall inside it.
+  Rect mesh_bounds = *mesh_.Bounds().AsRect();
+  float margin = std::max(
+      {query_bounds.Width(), query_bounds.Height(),
+       kMinRegionMarginFraction *
+           std::max(mesh_bounds.Width(), mesh_bounds.Height())});
+  Rect region = Rect::FromCenterAndDimensions(
+      query_bounds.Center(), query_bounds.Width() + 2 * margin,
+      query_bounds.Height() + 2 * margin);
+  candidates_.clear();
+  bool has_too_many_candidates = false;
+  mesh_.VisitIntersectedTriangles(
+      region, [this, &has_too_many_candidates](
+                  PartitionedMesh::TriangleIndexPair index) {
+        if (candidates_.size() == kMaxCachedCandidates) {
+          has_too_many_candidates = true;
+          return PartitionedMesh::FlowControl::kBreak;
+        }
+        candidates_.push_back(index);
+        return PartitionedMesh::FlowControl::kContinue;
+      });
+  if (!has_too_many_candidates) {
+    region_ = region;
+    return IntersectsCandidate(mesh_space_query);
+  }
+
+  // The mesh is too dense around the query to cache; fall back to a regular
+  // query.
+  region_.reset();
+  candidates_.clear();
+  std::optional<PartitionedMesh::TriangleIndexPair> hit;
+  mesh_.VisitIntersectedTriangles(
+      mesh_space_query, [&hit](PartitionedMesh::TriangleIndexPair index) {
+        hit = index;
+        return PartitionedMesh::FlowControl::kBreak;
+      });
+  if (hit.has_value()) last_hit_ = hit;
+  return hit.has_value();
+}
+
+namespace {
+
+// This is a helper function for the `Intersects` overloads that take a
+// `PartitionedMesh`, a different primitive, and an `IntersectsQueryCache`.
+// `intersects_in_mesh_space` is called with `b` transformed to `a`'s
+// coordinate space.
+template <typename ObjectType, typename IntersectsInMeshSpace>
+bool IntersectsPartitionedMeshWithCache(
+    const PartitionedMesh& a, const AffineTransform& a_to_b_transform,
+    const ObjectType& b, IntersectsInMeshSpace intersects_in_mesh_space) {
+  // An empty shape does not intersect anything.
+  if (a.Meshes().empty()) return false;
+
+  std::optional<AffineTransform> inverse_a_transform =
+      a_to_b_transform.Inverse();
+  // The cache only works in `a`'s coordinate space, so a non-invertible
+  // transform falls back to the uncached query.
+  if (!inverse_a_transform.has_value()) {
+    return IntersectsPartitionedMesh(a, a_to_b_transform, b);
+  }
+  return intersects_in_mesh_space(inverse_a_transform->Apply(b));
+}
+
+}  // namespace
+
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, Point b,
+                IntersectsQueryCache& cache) {
+  return IntersectsPartitionedMeshWithCache(
+      a, a_to_b_transform, b, [&a, &cache](Point mesh_space_b) {
+        return cache.IntersectsInMeshSpace(a, mesh_space_b);
+      });
+}
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, const Segment& b,
+                IntersectsQueryCache& cache) {
+  return IntersectsPartitionedMeshWithCache(
+      a, a_to_b_transform, b, [&a, &cache](const Segment& mesh_space_b) {
+        return cache.IntersectsInMeshSpace(a, mesh_space_b);
+      });
+}
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, const Triangle& b,
+                IntersectsQueryCache& cache) {
+  return IntersectsPartitionedMeshWithCache(
+      a, a_to_b_transform, b, [&a, &cache](const Triangle& mesh_space_b) {
+        return cache.IntersectsInMeshSpace(a, mesh_space_b);
+      });
+}
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, const Rect& b,
+                IntersectsQueryCache& cache) {
+  // `AffineTransform::Apply` maps a `Rect` to a `Quad`.
+  return IntersectsPartitionedMeshWithCache(
+      a, a_to_b_transform, b, [&a, &cache](const Quad& mesh_space_b) {
+        return cache.IntersectsInMeshSpace(a, mesh_space_b);
+      });
+}
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, const Quad& b,
+                IntersectsQueryCache& cache) {
+  return IntersectsPartitionedMeshWithCache(
+      a, a_to_b_transform, b, [&a, &cache](const Quad& mesh_space_b) {
+        return cache.IntersectsInMeshSpace(a, mesh_space_b);
+      });
+}
+
 namespace {
 
 // Attempts to check whether `lhs` intersects `rhs` in `rhs`'s coordinate space.
@@ -15,6 +15,9 @@
 #ifndef INK_GEOMETRY_INTERSECTS_H_
 #define INK_GEOMETRY_INTERSECTS_H_
 
+#include <optional>
+#include <vector>
+
 #include "ink/geometry/affine_transform.h"
 #include "ink/geometry/internal/intersects_internal.h"
 #include "ink/geometry/partitioned_mesh.h"
@@ -90,6 +93,87 @@ bool Intersects(const PartitionedMesh& a,
 bool Intersects(const PartitionedMesh& a,
                 const AffineTransform& a_to_b_transform, Point b);
 
+// Remembers where the last few queries against a `PartitionedMesh` landed, so
+// that a stream of nearby queries against the same mesh (e.g. the successive
+// samples of an eraser gesture) can be answered without walking the mesh's
+// spatial index every time.
+//
+// The cache keeps the triangle that was last hit, which is tested first, and a
+// region around the last query that required an index traversal, along with
+// the (possibly empty) list of triangles that intersect it. A query that lies
+// entirely within that region only needs to be tested against those
+// triangles, and is rejected immediately if there are none.
+//
+// All of this is stored in the mesh's coordinate space, so it stays valid when
+// the transform changes between queries. Querying a different mesh resets the
+// cache. The cache holds a reference to the data of the last mesh it was used
+// with, until `Clear()` is called or it is used with a different mesh.
+//
+// The results are always identical to those of the uncached overloads.
+class IntersectsQueryCache {
+ public:
+  IntersectsQueryCache() = default;
+  IntersectsQueryCache(const IntersectsQueryCache&) = default;
+  IntersectsQueryCache(IntersectsQueryCache&&) = default;
+  IntersectsQueryCache& operator=(const IntersectsQueryCache&) = default;
+  IntersectsQueryCache& operator=(IntersectsQueryCache&&) = default;
+  ~IntersectsQueryCache() = default;
+
+  // Forgets everything about previous queries.
+  void Clear();
+
+ private:
+  friend bool Intersects(const PartitionedMesh& a,
+                         const AffineTransform& a_to_b_transform, Point b,
+                         IntersectsQueryCache& cache);
+  friend bool Intersects(const PartitionedMesh& a,
+                         const AffineTransform& a_to_b_transform,
+                         const Segment& b, IntersectsQueryCache& cache);
+  friend bool Intersects(const PartitionedMesh& a,
+                         const AffineTransform& a_to_b_transform,
+                         const Triangle& b, IntersectsQueryCache& cache);
+  friend bool Intersects(const PartitionedMesh& a,
+                         const AffineTransform& a_to_b_transform,
+                         const Rect& b, IntersectsQueryCache& cache);
+  friend bool Intersects(const PartitionedMesh& a,
+                         const AffineTransform& a_to_b_transform,
+                         const Quad& b, IntersectsQueryCache& cache);
+
+  // Returns whether `mesh_space_query` intersects `mesh`, updating the cache.
+  template <typename ObjectType>
+  bool IntersectsInMeshSpace(const PartitionedMesh& mesh,
+                             const ObjectType& mesh_space_query);
+
+  // Returns whether `mesh_space_query` intersects one of `candidates_`.
+  template <typename ObjectType>
+  bool IntersectsCandidate(const ObjectType& mesh_space_query);
+
+  PartitionedMesh mesh_;
+  std::optional<PartitionedMesh::TriangleIndexPair> last_hit_;
+  // The region around a previous query, and every triangle that intersects
+  // it. This is only set if there were few enough such triangles.
+  std::optional<Rect> region_;
+  std::vector<PartitionedMesh::TriangleIndexPair> candidates_;
+};
+
+// Same as the overloads above, but use and update `cache` to speed up
+// repeated nearby queries against the same `PartitionedMesh`.
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, Point b,
+                IntersectsQueryCache& cache);
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, const Segment& b,
+                IntersectsQueryCache& cache);
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, const Triangle& b,
+                IntersectsQueryCache& cache);
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, const Rect& b,
+                IntersectsQueryCache& cache);
+bool Intersects(const PartitionedMesh& a,
+                const AffineTransform& a_to_b_transform, const Quad& b,
+                IntersectsQueryCache& cache);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Inline function definitions
 ////////////////////////////////////////////////////////////////////////////////
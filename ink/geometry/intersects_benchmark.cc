@@ -0,0 +1,71 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/intersects.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/partitioned_mesh.h"
+
+namespace ink {
+namespace {
+
+// These benchmarks take the number of triangles in each mesh, and the
+// percentage of their lengths that overlap.
+
+// Returns the transform that places a copy of a straight line mesh with
+// `n_triangles` triangles so that it overlaps the original for
+// `overlap_percent` percent of its length. The meshes don't touch at all when
+// `overlap_percent` is 0.
+AffineTransform StraightLineOverlapTransform(int64_t n_triangles,
+                                             int64_t overlap_percent) {
+  // A straight line mesh with `n_triangles` triangles spans [0, n + 1] in x.
+  float length = n_triangles + 1;
+  float offset = overlap_percent == 0 ? length + 1
+                                      : length * (100 - overlap_percent) / 100;
+  return AffineTransform::Translate({offset, 0});
+}
+
+void BM_IntersectsPartitionedMeshWithPartitionedMesh(benchmark::State& state) {
+  PartitionedMesh a = MakeStraightLinePartitionedMesh(state.range(0));
+  PartitionedMesh b = MakeStraightLinePartitionedMesh(state.range(0));
+  AffineTransform b_to_a =
+      StraightLineOverlapTransform(state.range(0), state.range(1));
+  a.InitializeSpatialIndex();
+  b.InitializeSpatialIndex();
+  for (auto s : state) {
+    benchmark::DoNotOptimize(Intersects(a, {}, b, b_to_a));
+  }
+}
+BENCHMARK(BM_IntersectsPartitionedMeshWithPartitionedMesh)
+    ->ArgsProduct({{64, 1024, 16384}, {0, 1, 10, 50, 100}});
+
+void BM_CoverageOfPartitionedMeshByPartitionedMesh(benchmark::State& state) {
+  PartitionedMesh a = MakeStraightLinePartitionedMesh(state.range(0));
+  PartitionedMesh b = MakeStraightLinePartitionedMesh(state.range(0));
+  AffineTransform b_to_a =
+      StraightLineOverlapTransform(state.range(0), state.range(1));
+  a.InitializeSpatialIndex();
+  b.InitializeSpatialIndex();
+  for (auto s : state) {
+    benchmark::DoNotOptimize(a.Coverage(b, b_to_a));
+  }
+}
+BENCHMARK(BM_CoverageOfPartitionedMeshByPartitionedMesh)
+    ->ArgsProduct({{64, 1024, 16384}, {0, 1, 10, 50, 100}});
+
+}  // namespace
+}  // namespace ink
@@ -17,6 +17,7 @@
 #include "gtest/gtest.h"
 #include "ink/geometry/affine_transform.h"
 #include "ink/geometry/angle.h"
+#include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mesh_test_helpers.h"
 #include "ink/geometry/partitioned_mesh.h"
 #include "ink/geometry/point.h"
@@ -1970,5 +1971,81 @@ TEST(IntersectsTest,
   EXPECT_FALSE(Intersects(line_at_origin, transform1, empty, transform0));
 }
 
+TEST(IntersectsTest, PartitionedMeshWithCacheMatchesUncachedQueries) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(100);
+  IntersectsQueryCache cache;
+  for (const AffineTransform& transform :
+       {AffineTransform::Identity(), AffineTransform::Scale(2),
+        AffineTransform::Rotate(Angle::Degrees(30))}) {
+    // Sweep a small eraser back and forth across the line, in and out of it.
+    Point previous = transform.Apply(Point{-2, 2});
+    for (int i = 1; i <= 200; ++i) {
+      Point current = transform.Apply(
+          Point{-2 + 0.3f * i, (i % 20 < 10) ? -0.1f * (i % 10) : 2.0f});
+      Segment segment{previous, current};
+      Rect rect = Rect::FromCenterAndDimensions(current, 0.2, 0.2);
+      EXPECT_EQ(Intersects(shape, transform, current, cache),
+                Intersects(shape, transform, current))
+          << "i = " << i;
+      EXPECT_EQ(Intersects(shape, transform, segment, cache),
+                Intersects(shape, transform, segment))
+          << "i = " << i;
+      EXPECT_EQ(Intersects(shape, transform, rect, cache),
+                Intersects(shape, transform, rect))
+          << "i = " << i;
+      previous = current;
+    }
+  }
+}
+
+TEST(IntersectsTest, PartitionedMeshWithCacheRepeatedQueries) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(3);
+  IntersectsQueryCache cache;
+  Point hit{1, -0.5};
+  Point miss{3, 4};
+
+  EXPECT_TRUE(Intersects(shape, AffineTransform::Identity(), hit, cache));
+  EXPECT_TRUE(Intersects(shape, AffineTransform::Identity(), hit, cache));
+  EXPECT_FALSE(Intersects(shape, AffineTransform::Identity(), miss, cache));
+  EXPECT_FALSE(Intersects(shape, AffineTransform::Identity(), miss, cache));
+  // The cache is in the mesh's coordinate space, so it remains valid when the
+  // transform changes.
+  EXPECT_TRUE(Intersects(shape, AffineTransform::Translate({2, 4.5}), miss,
+                         cache));
+  EXPECT_FALSE(Intersects(shape, AffineTransform::Translate({2, 4.5}), hit,
+                          cache));
+  cache.Clear();
+  EXPECT_TRUE(Intersects(shape, AffineTransform::Identity(), hit, cache));
+}
+
+TEST(IntersectsTest, PartitionedMeshWithCacheResetsForDifferentMesh) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(3);
+  PartitionedMesh moved_shape = MakeStraightLinePartitionedMesh(
+      3, MeshFormat(), AffineTransform::Translate({0, 10}));
+  IntersectsQueryCache cache;
+  Point p{1, -0.5};
+
+  EXPECT_TRUE(Intersects(shape, AffineTransform::Identity(), p, cache));
+  EXPECT_FALSE(Intersects(moved_shape, AffineTransform::Identity(), p, cache));
+  // A copy shares its meshes with the original, so it uses the same cache
+  // entries.
+  PartitionedMesh copy = moved_shape;
+  EXPECT_FALSE(Intersects(copy, AffineTransform::Identity(), p, cache));
+  EXPECT_TRUE(Intersects(shape, AffineTransform::Identity(), p, cache));
+}
+
+TEST(IntersectsTest, PartitionedMeshWithCacheEmptyShapeOrNonInvertible) {
+  PartitionedMesh empty;
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(3);
+  IntersectsQueryCache cache;
+  Point p{3, 4};
+  // This transform collapses the mesh to the segment (1, 4)-(5, 4).
+  AffineTransform collapse{1, 0, 1, 0, 0, 4};
+
+  EXPECT_FALSE(Intersects(empty, AffineTransform::Identity(), p, cache));
+  EXPECT_TRUE(Intersects(shape, collapse, p, cache));
+  EXPECT_FALSE(Intersects(shape, collapse, Point{3, 5}, cache));
+}
+
 }  // namespace
 }  // namespace ink
@@ -0,0 +1,137 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/lasso_selection.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/contains.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/internal/polyline_processing.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/scene_index.h"
+#include "ink/geometry/tessellator.h"
+
+namespace ink {
+namespace {
+
+// Returns the bounds of the part of the scene where the regions enclosed by
+// the closed polygons `old_shape` and `new_shape` may differ.
+//
+// The winding number of a point with respect to `new_shape` differs from the
+// one with respect to `old_shape` by its winding number with respect to the
+// closed loop made of the parts of the two polygons that differ. That loop is
+// made of the vertices after their common prefix, the last vertex of that
+// prefix, and the first vertices, to which both polygons are closed, so the
+// winding number can only change within the bounds of those.
+Envelope ChangedRegion(absl::Span<const Point> old_shape,
+                       absl::Span<const Point> new_shape) {
+  size_t n_common = 0;
+  size_t max_common = std::min(old_shape.size(), new_shape.size());
+  while (n_common < max_common && old_shape[n_common] == new_shape[n_common]) {
+    ++n_common;
+  }
+  size_t first_changed = n_common == 0 ? 0 : n_common - 1;
+  Envelope region(old_shape.subspan(first_changed));
+  region.Add(new_shape.subspan(first_changed));
+  if (!old_shape.empty()) region.Add(old_shape.front());
+  if (!new_shape.empty()) region.Add(new_shape.front());
+  return region;
+}
+
+// Triangulates `closed_shape`, returning an empty mesh if it doesn't enclose
+// any area.
+PartitionedMesh MakeLassoMesh(absl::Span<const Point> closed_shape) {
+  if (closed_shape.size() < 3) return PartitionedMesh();
+  absl::StatusOr<Mesh> mesh = CreateMeshFromPolyline(closed_shape);
+  if (!mesh.ok()) return PartitionedMesh();
+  absl::StatusOr<PartitionedMesh> lasso_mesh =
+      PartitionedMesh::FromMeshes(absl::MakeConstSpan(&*mesh, 1));
+  if (!lasso_mesh.ok()) return PartitionedMesh();
+  return *std::move(lasso_mesh);
+}
+
+}  // namespace
+
+LassoSelection::LassoSelection(const SceneIndex* absl_nonnull scene,
+                               const LassoSelectionOptions& options)
+    : scene_(scene), options_(options) {}
+
+LassoSelection::SelectionChanges LassoSelection::AddPoints(
+    absl::Span<const Point> points) {
+  points_.insert(points_.end(), points.begin(), points.end());
+  geometry_internal::CreateClosedShape(points_, next_closed_shape_);
+  if (next_closed_shape_ == closed_shape_) return {};
+
+  // If the old lasso had no area, nothing was selected, and every shape near
+  // the new lasso needs to be tested.
+  Envelope changed_region = lasso_mesh_.Meshes().empty()
+                                ? Envelope(next_closed_shape_)
+                                : ChangedRegion(closed_shape_,
+                                                next_closed_shape_);
+  std::swap(closed_shape_, next_closed_shape_);
+  lasso_mesh_ = MakeLassoMesh(closed_shape_);
+
+  SelectionChanges changes;
+  if (lasso_mesh_.Meshes().empty()) {
+    // A lasso without area doesn't select anything.
+    changes.deselected.assign(selected_shapes_.begin(), selected_shapes_.end());
+    selected_shapes_.clear();
+    return changes;
+  }
+
+  std::optional<Rect> region = changed_region.AsRect();
+  if (!region.has_value()) return changes;
+  scene_->VisitCandidateShapesAndTransforms(
+      *region, [this, &changes](ShapeId id, const PartitionedMesh& shape,
+                                const AffineTransform& shape_to_scene) {
+        bool is_selected = IsSelected(shape, shape_to_scene);
+        if (is_selected && selected_shapes_.insert(id).second) {
+          changes.selected.push_back(id);
+        } else if (!is_selected && selected_shapes_.erase(id) != 0) {
+          changes.deselected.push_back(id);
+        }
+        return PartitionedMesh::FlowControl::kContinue;
+      });
+  return changes;
+}
+
+void LassoSelection::Reset() {
+  points_.clear();
+  closed_shape_.clear();
+  lasso_mesh_ = PartitionedMesh();
+  selected_shapes_.clear();
+}
+
+bool LassoSelection::IsSelected(const PartitionedMesh& shape,
+                                const AffineTransform& shape_to_scene) const {
+  if (options_.require_containment) {
+    return Contains(lasso_mesh_, AffineTransform(), shape, shape_to_scene);
+  }
+  std::optional<AffineTransform> scene_to_shape = shape_to_scene.Inverse();
+  return scene_to_shape.has_value() &&
+         shape.CoverageIsGreaterThan(lasso_mesh_, options_.coverage_threshold,
+                                     *scene_to_shape);
+}
+
+}  // namespace ink
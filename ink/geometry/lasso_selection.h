@@ -0,0 +1,113 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_GEOMETRY_LASSO_SELECTION_H_
+#define INK_GEOMETRY_LASSO_SELECTION_H_
+
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/scene_index.h"
+
+namespace ink {
+
+// How a `LassoSelection` decides whether a shape is selected.
+struct LassoSelectionOptions {
+  // If true, a shape is selected only if it lies entirely inside the lasso, as
+  // per `Contains`. Otherwise, it is selected if the portion of it covered by
+  // the lasso is greater than `coverage_threshold`, as per
+  // `PartitionedMesh::CoverageIsGreaterThan`.
+  bool require_containment = false;
+  float coverage_threshold = 0;
+};
+
+// Selects the shapes of a `SceneIndex` with a lasso that is drawn one batch of
+// points at a time, e.g. once per frame of the gesture.
+//
+// The lasso's points are closed into a polygon as by
+// `geometry_internal::CreateClosedShape`, which is triangulated into a
+// `PartitionedMesh` as by `CreateMeshFromPolyline`. When points are added, only
+// the part of that polygon after the last of its vertices that is unchanged
+// (and its closing edge) differs from before, and only the shapes whose bounds
+// overlap that part of the scene can change selection, so only those are
+// tested again.
+//
+// The `SceneIndex` must outlive the selection, and must not be changed while
+// the selection is in use; call `Reset()` after changing it.
+class LassoSelection {
+ public:
+  using ShapeId = SceneIndex::ShapeId;
+
+  // The shapes whose selection was changed by a call to `AddPoints()`, each in
+  // arbitrary order.
+  struct SelectionChanges {
+    std::vector<ShapeId> selected;
+    std::vector<ShapeId> deselected;
+  };
+
+  explicit LassoSelection(const SceneIndex* absl_nonnull scene,
+                          const LassoSelectionOptions& options = {});
+
+  LassoSelection(const LassoSelection&) = delete;
+  LassoSelection(LassoSelection&&) = default;
+  LassoSelection& operator=(const LassoSelection&) = delete;
+  LassoSelection& operator=(LassoSelection&&) = default;
+  ~LassoSelection() = default;
+
+  // Appends `points`, in scene coordinates, to the lasso, updates the lasso's
+  // mesh, and re-tests the shapes that are near the part of the lasso that
+  // changed. Returns the shapes whose selection changed.
+  SelectionChanges AddPoints(absl::Span<const Point> points);
+
+  // Removes all points from the lasso, and deselects all shapes.
+  void Reset();
+
+  // The points that have been added to the lasso.
+  absl::Span<const Point> Points() const { return points_; }
+
+  // The closed polygon made from `Points()`.
+  absl::Span<const Point> ClosedShape() const { return closed_shape_; }
+
+  // The triangulation of `ClosedShape()`, in scene coordinates. This is empty
+  // until the lasso has enough points to enclose an area.
+  const PartitionedMesh& LassoMesh() const { return lasso_mesh_; }
+
+  const absl::flat_hash_set<ShapeId>& SelectedShapes() const {
+    return selected_shapes_;
+  }
+
+ private:
+  // Returns true if `shape`, placed by `shape_to_scene`, should be selected by
+  // the current lasso mesh.
+  bool IsSelected(const PartitionedMesh& shape,
+                  const AffineTransform& shape_to_scene) const;
+
+  const SceneIndex* absl_nonnull scene_;
+  LassoSelectionOptions options_;
+  std::vector<Point> points_;
+  std::vector<Point> closed_shape_;
+  // Scratch space for the next `closed_shape_`, kept to reuse its storage.
+  std::vector<Point> next_closed_shape_;
+  PartitionedMesh lasso_mesh_;
+  absl::flat_hash_set<ShapeId> selected_shapes_;
+};
+
+}  // namespace ink
+
+#endif  // INK_GEOMETRY_LASSO_SELECTION_H_
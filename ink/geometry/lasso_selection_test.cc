@@ -0,0 +1,153 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/lasso_selection.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/scene_index.h"
+#include "ink/geometry/vec.h"
+
+namespace ink {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
+using ShapeId = SceneIndex::ShapeId;
+
+// Returns an index containing `n_shapes` two-triangle straight line meshes,
+// where the shape with ID `i` spans [10*i, 10*i + 3]x[-1, 0] in scene
+// coordinates.
+SceneIndex MakeRowOfShapes(uint32_t n_shapes) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(2);
+  SceneIndex index;
+  for (uint32_t i = 0; i < n_shapes; ++i) {
+    index.Insert(i, shape, AffineTransform::Translate(Vec{10.f * i, 0}));
+  }
+  return index;
+}
+
+TEST(LassoSelectionTest, SelectsShapesAsPointsAreAdded) {
+  SceneIndex scene = MakeRowOfShapes(5);
+  LassoSelection selection(&scene);
+
+  LassoSelection::SelectionChanges changes =
+      selection.AddPoints({{-1, -2}, {25, -2}});
+  EXPECT_THAT(changes.selected, IsEmpty());
+  EXPECT_THAT(changes.deselected, IsEmpty());
+  EXPECT_TRUE(selection.LassoMesh().Meshes().empty());
+
+  // This triangle overlaps shapes 1 and 2, but not 0.
+  changes = selection.AddPoints({{25, 1}});
+  EXPECT_THAT(changes.selected, UnorderedElementsAre(1, 2));
+  EXPECT_THAT(changes.deselected, IsEmpty());
+  EXPECT_FALSE(selection.LassoMesh().Meshes().empty());
+
+  // This rectangle overlaps shapes 0, 1 and 2.
+  changes = selection.AddPoints({{-1, 1}});
+  EXPECT_THAT(changes.selected, UnorderedElementsAre(0));
+  EXPECT_THAT(changes.deselected, IsEmpty());
+  EXPECT_THAT(selection.SelectedShapes(), UnorderedElementsAre(0, 1, 2));
+  EXPECT_EQ(selection.Points().size(), 4);
+}
+
+TEST(LassoSelectionTest, SelectsContainedShapes) {
+  SceneIndex scene = MakeRowOfShapes(5);
+  LassoSelection selection(&scene, {.require_containment = true});
+
+  selection.AddPoints({{-1, -2}, {25, -2}});
+  // This triangle contains shape 2, but only overlaps shape 1.
+  LassoSelection::SelectionChanges changes = selection.AddPoints({{25, 1}});
+  EXPECT_THAT(changes.selected, UnorderedElementsAre(2));
+
+  changes = selection.AddPoints({{-1, 1}});
+  EXPECT_THAT(changes.selected, UnorderedElementsAre(0, 1));
+  EXPECT_THAT(selection.SelectedShapes(), UnorderedElementsAre(0, 1, 2));
+}
+
+TEST(LassoSelectionTest, DeselectsShapesLeftOutOfTheLasso) {
+  SceneIndex scene = MakeRowOfShapes(5);
+  LassoSelection selection(&scene);
+
+  selection.AddPoints({{-1, -20}, {25, -20}, {25, 20}, {-1, 20}});
+  ASSERT_THAT(selection.SelectedShapes(), UnorderedElementsAre(0, 1, 2));
+
+  // This cuts a wedge out of the left side of the lasso, which leaves out
+  // shape 0.
+  LassoSelection::SelectionChanges changes = selection.AddPoints({{8, 0}});
+  EXPECT_THAT(changes.selected, IsEmpty());
+  EXPECT_THAT(changes.deselected, UnorderedElementsAre(0));
+  EXPECT_THAT(selection.SelectedShapes(), UnorderedElementsAre(1, 2));
+}
+
+// Draws most of an ellipse around a long row of shapes one point at a time,
+// checking after each point that the incrementally updated selection matches
+// testing every shape against the whole lasso.
+TEST(LassoSelectionTest, MatchesTestingAllShapes) {
+  SceneIndex scene = MakeRowOfShapes(60);
+  constexpr float kCoverageThreshold = 0.3;
+  LassoSelection selection(&scene, {.coverage_threshold = kCoverageThreshold});
+
+  int n_selection_changes = 0;
+  for (int i = 0; i < 100; ++i) {
+    float angle = 2 * M_PI * i / 120;
+    LassoSelection::SelectionChanges changes = selection.AddPoints(
+        {{300 + 320 * std::cos(angle), -0.5f + 60 * std::sin(angle)}});
+    n_selection_changes += changes.selected.size() + changes.deselected.size();
+
+    std::vector<ShapeId> expected;
+    if (!selection.LassoMesh().Meshes().empty()) {
+      scene.VisitShapesWithCoverageGreaterThan(
+          selection.LassoMesh(), kCoverageThreshold, [&expected](ShapeId id) {
+            expected.push_back(id);
+            return PartitionedMesh::FlowControl::kContinue;
+          });
+    }
+    ASSERT_THAT(selection.SelectedShapes(),
+                UnorderedElementsAreArray(expected));
+  }
+  // Each shape is selected once, and never deselected.
+  EXPECT_EQ(n_selection_changes, 60);
+  EXPECT_EQ(selection.SelectedShapes().size(), 60);
+}
+
+TEST(LassoSelectionTest, Reset) {
+  SceneIndex scene = MakeRowOfShapes(5);
+  LassoSelection selection(&scene);
+  selection.AddPoints({{-1, -2}, {25, -2}, {25, 1}, {-1, 1}});
+  ASSERT_THAT(selection.SelectedShapes(), UnorderedElementsAre(0, 1, 2));
+
+  selection.Reset();
+  EXPECT_THAT(selection.Points(), IsEmpty());
+  EXPECT_THAT(selection.ClosedShape(), IsEmpty());
+  EXPECT_TRUE(selection.LassoMesh().Meshes().empty());
+  EXPECT_THAT(selection.SelectedShapes(), IsEmpty());
+
+  LassoSelection::SelectionChanges changes =
+      selection.AddPoints({{19, -2}, {25, -2}, {25, 1}, {19, 1}});
+  EXPECT_THAT(changes.selected, UnorderedElementsAre(2));
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,262 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/merged_partitioned_mesh.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mesh_format.h"
+#include "ink/geometry/mesh_packing_types.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/types/executor.h"
+#include "ink/types/small_array.h"
+
+namespace ink {
+namespace {
+
+bool IsPositionDerivative(MeshFormat::AttributeId id) {
+  return id == MeshFormat::AttributeId::kSideDerivative ||
+         id == MeshFormat::AttributeId::kForwardDerivative;
+}
+
+bool CodingParamsEqual(const MeshAttributeCodingParams& a,
+                       const MeshAttributeCodingParams& b) {
+  absl::Span<const MeshAttributeCodingParams::ComponentCodingParams>
+      a_components = a.components.Values();
+  absl::Span<const MeshAttributeCodingParams::ComponentCodingParams>
+      b_components = b.components.Values();
+  return std::equal(
+      a_components.begin(), a_components.end(), b_components.begin(),
+      b_components.end(),
+      [](MeshAttributeCodingParams::ComponentCodingParams a_component,
+         MeshAttributeCodingParams::ComponentCodingParams b_component) {
+        return a_component.offset == b_component.offset &&
+               a_component.scale == b_component.scale;
+      });
+}
+
+// Returns the packing params to use for each attribute of the merged render
+// group `group_index`: those of the sources if they all agree, or `nullopt` to
+// compute new ones.
+std::vector<std::optional<MeshAttributeCodingParams>> MergedPackingParams(
+    absl::Span<const MergedPartitionedMesh::Source> sources,
+    uint32_t group_index, const MeshFormat& format) {
+  absl::Span<const MeshFormat::Attribute> attributes = format.Attributes();
+  std::vector<std::optional<MeshAttributeCodingParams>> packing_params(
+      attributes.size());
+  for (uint32_t attr_idx = 0; attr_idx < attributes.size(); ++attr_idx) {
+    if (MeshFormat::IsUnpackedType(attributes[attr_idx].type) ||
+        attr_idx == format.PositionAttributeIndex() ||
+        IsPositionDerivative(attributes[attr_idx].id)) {
+      continue;
+    }
+    std::optional<MeshAttributeCodingParams> shared_params;
+    bool all_equal = true;
+    for (const MergedPartitionedMesh::Source& source : sources) {
+      for (const Mesh& mesh : source.shape->RenderGroupMeshes(group_index)) {
+        const MeshAttributeCodingParams& params =
+            mesh.VertexAttributeUnpackingParams(attr_idx);
+        if (!shared_params.has_value()) {
+          shared_params = params;
+        } else if (!CodingParamsEqual(*shared_params, params)) {
+          all_equal = false;
+        }
+      }
+    }
+    if (all_equal) packing_params[attr_idx] = std::move(shared_params);
+  }
+  return packing_params;
+}
+
+// Appends the vertices and triangles of `mesh`, transformed by `transform`, to
+// `merged_mesh`.
+void AppendTransformedMesh(const Mesh& mesh, const AffineTransform& transform,
+                           MutableMesh& merged_mesh) {
+  const MeshFormat& format = mesh.Format();
+  absl::Span<const MeshFormat::Attribute> attributes = format.Attributes();
+  uint32_t position_index = format.PositionAttributeIndex();
+  uint32_t first_vertex = merged_mesh.VertexCount();
+  for (uint32_t v = 0; v < mesh.VertexCount(); ++v) {
+    merged_mesh.AppendVertex(transform.Apply(mesh.VertexPosition(v)));
+    for (uint32_t attr_idx = 0; attr_idx < attributes.size(); ++attr_idx) {
+      if (attr_idx == position_index) continue;
+      SmallArray<float, 4> value = mesh.FloatVertexAttribute(v, attr_idx);
+      if (IsPositionDerivative(attributes[attr_idx].id)) {
+        // Derivatives of position only see the linear part of the transform.
+        float x = value[0];
+        float y = value[1];
+        value[0] = transform.A() * x + transform.B() * y;
+        value[1] = transform.D() * x + transform.E() * y;
+      }
+      merged_mesh.SetFloatVertexAttribute(first_vertex + v, attr_idx, value);
+    }
+  }
+
+  // A mirroring transform reverses the orientation of every triangle, so swap
+  // two of the vertices to restore it.
+  bool is_mirrored =
+      transform.A() * transform.E() - transform.B() * transform.D() < 0;
+  for (uint32_t t = 0; t < mesh.TriangleCount(); ++t) {
+    std::array<uint32_t, 3> indices = mesh.TriangleIndices(t);
+    for (uint32_t& index : indices) index += first_vertex;
+    if (is_mirrored) std::swap(indices[1], indices[2]);
+    merged_mesh.AppendTriangleIndices(indices);
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<MergedPartitionedMesh> MergedPartitionedMesh::Create(
+    absl::Span<const Source> sources, Executor* absl_nullable executor) {
+  if (sources.empty()) return MergedPartitionedMesh();
+
+  uint32_t n_groups = sources.front().shape->RenderGroupCount();
+  for (size_t i = 1; i < sources.size(); ++i) {
+    const PartitionedMesh& shape = *sources[i].shape;
+    if (shape.RenderGroupCount() != n_groups) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "All sources must have the same number of render groups. Source 0 "
+          "has ",
+          n_groups, " render groups, but source ", i, " has ",
+          shape.RenderGroupCount()));
+    }
+    for (uint32_t g = 0; g < n_groups; ++g) {
+      if (shape.RenderGroupFormat(g) !=
+          sources.front().shape->RenderGroupFormat(g)) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Source ", i, " has a different format for render "
+                         "group ", g, " than source 0"));
+      }
+    }
+  }
+
+  std::vector<MutableMesh> merged_meshes;
+  merged_meshes.reserve(n_groups);
+  std::vector<std::vector<std::vector<uint32_t>>> group_outlines(n_groups);
+  std::vector<std::vector<absl::Span<const uint32_t>>> group_outline_spans(
+      n_groups);
+  std::vector<std::vector<std::optional<MeshAttributeCodingParams>>>
+      group_packing_params(n_groups);
+  std::vector<RenderGroupTriangleRanges> group_ranges(n_groups);
+  for (uint32_t g = 0; g < n_groups; ++g) {
+    const MeshFormat& format = sources.front().shape->RenderGroupFormat(g);
+    uint64_t total_vertex_count = 0;
+    for (const Source& source : sources) {
+      for (const Mesh& mesh : source.shape->RenderGroupMeshes(g)) {
+        total_vertex_count += mesh.VertexCount();
+      }
+    }
+    if (format.UnpackedIndexStride() == 2 &&
+        total_vertex_count > std::numeric_limits<uint16_t>::max() + 1) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Render group ", g, " has ", total_vertex_count,
+          " vertices in total, which is more than its 16-bit unpacked index "
+          "format can represent"));
+    }
+
+    MutableMesh& merged_mesh = merged_meshes.emplace_back(format);
+    std::vector<uint32_t>& source_first_triangles =
+        group_ranges[g].source_first_triangles;
+    source_first_triangles.reserve(sources.size() + 1);
+    for (const Source& source : sources) {
+      source_first_triangles.push_back(merged_mesh.TriangleCount());
+      const PartitionedMesh& shape = *source.shape;
+      absl::Span<const Mesh> meshes = shape.RenderGroupMeshes(g);
+      std::vector<uint32_t> mesh_first_vertices;
+      mesh_first_vertices.reserve(meshes.size());
+      for (const Mesh& mesh : meshes) {
+        mesh_first_vertices.push_back(merged_mesh.VertexCount());
+        AppendTransformedMesh(mesh, source.transform, merged_mesh);
+      }
+      for (uint32_t o = 0; o < shape.OutlineCount(g); ++o) {
+        std::vector<uint32_t>& outline = group_outlines[g].emplace_back();
+        for (PartitionedMesh::VertexIndexPair pair : shape.Outline(g, o)) {
+          outline.push_back(mesh_first_vertices[pair.mesh_index] +
+                            pair.vertex_index);
+        }
+      }
+    }
+    source_first_triangles.push_back(merged_mesh.TriangleCount());
+
+    for (const std::vector<uint32_t>& outline : group_outlines[g]) {
+      group_outline_spans[g].push_back(outline);
+    }
+    group_packing_params[g] = MergedPackingParams(sources, g, format);
+  }
+
+  std::vector<PartitionedMesh::MutableMeshGroup> mesh_groups;
+  mesh_groups.reserve(n_groups);
+  for (uint32_t g = 0; g < n_groups; ++g) {
+    mesh_groups.push_back({.mesh = &merged_meshes[g],
+                           .outlines = group_outline_spans[g],
+                           .packing_params = group_packing_params[g]});
+  }
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMeshGroups(mesh_groups, executor);
+  if (!shape.ok()) return shape.status();
+
+  // `AsMeshes()` keeps the triangles in order, splitting them into contiguous
+  // runs for each partition.
+  for (uint32_t g = 0; g < n_groups; ++g) {
+    std::vector<uint32_t>& mesh_first_triangles =
+        group_ranges[g].mesh_first_triangles;
+    uint32_t n_triangles = 0;
+    for (const Mesh& mesh : shape->RenderGroupMeshes(g)) {
+      mesh_first_triangles.push_back(n_triangles);
+      n_triangles += mesh.TriangleCount();
+    }
+    ABSL_DCHECK_EQ(n_triangles, group_ranges[g].source_first_triangles.back());
+  }
+
+  return MergedPartitionedMesh(*std::move(shape), sources.size(),
+                               std::move(group_ranges));
+}
+
+uint32_t MergedPartitionedMesh::SourceIndex(
+    uint32_t group_index, PartitionedMesh::TriangleIndexPair triangle) const {
+  ABSL_CHECK_LT(group_index, group_ranges_.size());
+  const RenderGroupTriangleRanges& ranges = group_ranges_[group_index];
+  ABSL_CHECK_LT(triangle.mesh_index, ranges.mesh_first_triangles.size());
+  uint32_t triangle_index =
+      ranges.mesh_first_triangles[triangle.mesh_index] +
+      triangle.triangle_index;
+  ABSL_CHECK_LT(triangle_index, ranges.source_first_triangles.back());
+  // Find the last source whose first triangle is at or before
+  // `triangle_index`. Sources with no triangles in this group share their first
+  // triangle with the next source, and are skipped by `upper_bound`.
+  auto it = std::upper_bound(ranges.source_first_triangles.begin(),
+                             ranges.source_first_triangles.end(),
+                             triangle_index);
+  return (it - ranges.source_first_triangles.begin()) - 1;
+}
+
+}  // namespace ink
@@ -0,0 +1,129 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_GEOMETRY_MERGED_PARTITIONED_MESH_H_
+#define INK_GEOMETRY_MERGED_PARTITIONED_MESH_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+// A `PartitionedMesh` built by concatenating the meshes of several "source"
+// shapes, each with its own transform applied, along with a mapping from its
+// triangles back to the sources they came from.
+//
+// This is intended for "baking" layers of finished, static strokes: the
+// strokes' shapes are merged into as few partitions as possible, so that
+// drawing the layer takes one draw call per partition instead of at least one
+// per stroke. The sources must be compatible, i.e. have the same number of
+// render groups with the same formats; for strokes, this is the case when they
+// use the same brush family. Since the brush color and per-coat paint are not
+// part of the meshes, strokes should only be merged if those match as well.
+//
+// The merged shape is in the common coordinate space of the source transforms
+// (e.g. canvas space), so it should be drawn with the identity transform. A
+// merged set of strokes can be drawn by wrapping the shape in a `Stroke` with
+// their shared brush, e.g. `Stroke(brush, StrokeInputBatch(), merged.Shape())`.
+class MergedPartitionedMesh {
+ public:
+  struct Source {
+    const PartitionedMesh* absl_nonnull shape;
+    // The transform from the coordinate space of `shape` to that of the merged
+    // shape.
+    AffineTransform transform;
+  };
+
+  // Merges the `sources`, in order. Render group `g` of the result contains
+  // the triangles and outlines of render group `g` of each source. Vertex
+  // positions are transformed by the source's transform, as are the
+  // `kSideDerivative` and `kForwardDerivative` attributes (if present), which
+  // are derivatives of position. Triangles are kept in the same order with the
+  // same orientation, so triangles are re-wound for transforms that mirror.
+  //
+  // The packing params of an attribute that isn't transformed are kept if they
+  // are the same for every source mesh in the render group; otherwise, they
+  // are computed from the merged values. If `executor` is non-null, it is used
+  // to pack the partitions of the merged meshes concurrently.
+  //
+  // If `sources` is empty, the result has no render groups. Returns an error
+  // if:
+  // - The sources have different numbers of render groups, or different
+  //   formats for the same render group.
+  // - A render group's index format can't represent its merged vertex count.
+  // - Packing the merged meshes fails, e.g. because a transform produces
+  //   non-finite positions.
+  static absl::StatusOr<MergedPartitionedMesh> Create(
+      absl::Span<const Source> sources,
+      Executor* absl_nullable executor = nullptr);
+
+  // Constructs an empty merged shape with no sources.
+  MergedPartitionedMesh() = default;
+
+  MergedPartitionedMesh(const MergedPartitionedMesh&) = default;
+  MergedPartitionedMesh(MergedPartitionedMesh&&) = default;
+  MergedPartitionedMesh& operator=(const MergedPartitionedMesh&) = default;
+  MergedPartitionedMesh& operator=(MergedPartitionedMesh&&) = default;
+  ~MergedPartitionedMesh() = default;
+
+  // Returns the merged shape.
+  const PartitionedMesh& Shape() const { return shape_; }
+
+  // Returns the number of sources that were merged.
+  uint32_t SourceCount() const { return source_count_; }
+
+  // Returns the index into the `sources` passed to `Create()` of the source
+  // that the triangle at `triangle` in render group `group_index` of `Shape()`
+  // came from. This can be used to map the results of hit-testing the merged
+  // shape, e.g. with `PartitionedMesh::VisitIntersectedTriangles()`, back to
+  // the individual strokes.
+  //
+  // This CHECK-fails if `group_index` >= `Shape().RenderGroupCount()`, or if
+  // `triangle` does not refer to a triangle in that render group.
+  uint32_t SourceIndex(uint32_t group_index,
+                       PartitionedMesh::TriangleIndexPair triangle) const;
+
+ private:
+  struct RenderGroupTriangleRanges {
+    // The index of the first triangle of each mesh of the render group, when
+    // the triangles of all its meshes are concatenated.
+    std::vector<uint32_t> mesh_first_triangles;
+    // The index of the first triangle from each source, in the same indexing
+    // as `mesh_first_triangles`, followed by the total number of triangles.
+    std::vector<uint32_t> source_first_triangles;
+  };
+
+  MergedPartitionedMesh(PartitionedMesh shape, uint32_t source_count,
+                        std::vector<RenderGroupTriangleRanges> group_ranges)
+      : shape_(std::move(shape)),
+        source_count_(source_count),
+        group_ranges_(std::move(group_ranges)) {}
+
+  PartitionedMesh shape_;
+  uint32_t source_count_ = 0;
+  std::vector<RenderGroupTriangleRanges> group_ranges_;
+};
+
+}  // namespace ink
+
+#endif  // INK_GEOMETRY_MERGED_PARTITIONED_MESH_H_
@@ -0,0 +1,284 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/merged_partitioned_mesh.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mesh_format.h"
+#include "ink/geometry/mesh_packing_types.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/triangle.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/geometry/vec.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Gt;
+using ::testing::HasSubstr;
+using ::testing::Lt;
+
+// Returns the triangle at `triangle_index` within render group `group_index`
+// of `shape`, when the triangles of all of the group's meshes are
+// concatenated.
+Triangle GroupTriangle(const PartitionedMesh& shape, uint32_t group_index,
+                       uint32_t triangle_index) {
+  for (const Mesh& mesh : shape.RenderGroupMeshes(group_index)) {
+    if (triangle_index < mesh.TriangleCount()) {
+      return mesh.GetTriangle(triangle_index);
+    }
+    triangle_index -= mesh.TriangleCount();
+  }
+  ABSL_LOG(FATAL) << "Triangle index out of bounds";
+}
+
+uint32_t GroupTriangleCount(const PartitionedMesh& shape,
+                            uint32_t group_index) {
+  uint32_t count = 0;
+  for (const Mesh& mesh : shape.RenderGroupMeshes(group_index)) {
+    count += mesh.TriangleCount();
+  }
+  return count;
+}
+
+TEST(MergedPartitionedMeshTest, DefaultCtor) {
+  MergedPartitionedMesh merged;
+  EXPECT_EQ(merged.SourceCount(), 0);
+  EXPECT_EQ(merged.Shape().RenderGroupCount(), 0);
+}
+
+TEST(MergedPartitionedMeshTest, CreateWithNoSources) {
+  absl::StatusOr<MergedPartitionedMesh> merged =
+      MergedPartitionedMesh::Create({});
+  ASSERT_THAT(merged, IsOk());
+  EXPECT_EQ(merged->SourceCount(), 0);
+  EXPECT_EQ(merged->Shape().RenderGroupCount(), 0);
+}
+
+TEST(MergedPartitionedMeshTest, CreateTransformsAndConcatenatesTriangles) {
+  PartitionedMesh first = MakeStraightLinePartitionedMesh(4);
+  PartitionedMesh second = MakeCoiledRingPartitionedMesh(6, 12);
+  AffineTransform first_transform = AffineTransform::Translate({10, 0});
+  AffineTransform second_transform =
+      AffineTransform::Rotate(Angle::Degrees(90)) * AffineTransform::Scale(2);
+
+  absl::StatusOr<MergedPartitionedMesh> merged = MergedPartitionedMesh::Create(
+      {{.shape = &first, .transform = first_transform},
+       {.shape = &second, .transform = second_transform}});
+  ASSERT_THAT(merged, IsOk());
+
+  EXPECT_EQ(merged->SourceCount(), 2);
+  const PartitionedMesh& shape = merged->Shape();
+  ASSERT_EQ(shape.RenderGroupCount(), 1);
+  EXPECT_THAT(shape.RenderGroupFormat(0),
+              MeshFormatEq(first.RenderGroupFormat(0)));
+  ASSERT_EQ(shape.RenderGroupMeshes(0).size(), 1);
+  ASSERT_EQ(GroupTriangleCount(shape, 0), 10);
+  for (uint32_t t = 0; t < 4; ++t) {
+    EXPECT_THAT(GroupTriangle(shape, 0, t),
+                TriangleNear(first_transform.Apply(GroupTriangle(first, 0, t)),
+                             1e-4));
+    EXPECT_EQ(merged->SourceIndex(0, {.mesh_index = 0,
+                                      .triangle_index =
+                                          static_cast<uint16_t>(t)}),
+              0);
+  }
+  for (uint32_t t = 0; t < 6; ++t) {
+    EXPECT_THAT(
+        GroupTriangle(shape, 0, 4 + t),
+        TriangleNear(second_transform.Apply(GroupTriangle(second, 0, t)),
+                     1e-4));
+    EXPECT_EQ(merged->SourceIndex(0, {.mesh_index = 0,
+                                      .triangle_index =
+                                          static_cast<uint16_t>(4 + t)}),
+              1);
+  }
+}
+
+TEST(MergedPartitionedMeshTest, CreateKeepsTriangleOrientationWhenMirroring) {
+  PartitionedMesh source = MakeStraightLinePartitionedMesh(6);
+
+  absl::StatusOr<MergedPartitionedMesh> merged = MergedPartitionedMesh::Create(
+      {{.shape = &source, .transform = AffineTransform::Scale(-1, 1)}});
+  ASSERT_THAT(merged, IsOk());
+
+  ASSERT_EQ(GroupTriangleCount(merged->Shape(), 0), 6);
+  for (uint32_t t = 0; t < 6; ++t) {
+    float source_area = GroupTriangle(source, 0, t).SignedArea();
+    float merged_area = GroupTriangle(merged->Shape(), 0, t).SignedArea();
+    EXPECT_FLOAT_EQ(merged_area, source_area);
+  }
+}
+
+TEST(MergedPartitionedMeshTest, CreateRemapsOutlines) {
+  MutableMesh mutable_mesh = MakeStraightLineMutableMesh(8);
+  absl::StatusOr<PartitionedMesh> source = PartitionedMesh::FromMutableMesh(
+      mutable_mesh, {{1, 5, 4, 0}, {5, 9, 8, 4}});
+  ASSERT_THAT(source, IsOk());
+  AffineTransform transform = AffineTransform::Translate({0, 3});
+
+  absl::StatusOr<MergedPartitionedMesh> merged = MergedPartitionedMesh::Create(
+      {{.shape = &*source}, {.shape = &*source, .transform = transform}});
+  ASSERT_THAT(merged, IsOk());
+
+  const PartitionedMesh& shape = merged->Shape();
+  ASSERT_EQ(shape.OutlineCount(0), 4);
+  for (uint32_t o = 0; o < 2; ++o) {
+    ASSERT_EQ(shape.OutlineVertexCount(0, o), 4);
+    ASSERT_EQ(shape.OutlineVertexCount(0, o + 2), 4);
+    for (uint32_t i = 0; i < 4; ++i) {
+      EXPECT_THAT(shape.OutlinePosition(0, o, i),
+                  PointEq(source->OutlinePosition(0, o, i)));
+      EXPECT_THAT(shape.OutlinePosition(0, o + 2, i),
+                  PointEq(transform.Apply(source->OutlinePosition(0, o, i))));
+    }
+  }
+}
+
+TEST(MergedPartitionedMeshTest, CreateTransformsPositionDerivatives) {
+  absl::StatusOr<MeshFormat> format = MeshFormat::Create(
+      {{MeshFormat::AttributeType::kFloat2Unpacked,
+        MeshFormat::AttributeId::kPosition},
+       {MeshFormat::AttributeType::kFloat2Unpacked,
+        MeshFormat::AttributeId::kSideDerivative},
+       {MeshFormat::AttributeType::kFloat1PackedInOneUnsignedByte,
+        MeshFormat::AttributeId::kOpacityShift}},
+      MeshFormat::IndexFormat::k32BitUnpacked16BitPacked);
+  ASSERT_THAT(format, IsOk());
+  MutableMesh mutable_mesh = MakeStraightLineMutableMesh(4, *format);
+  for (uint32_t v = 0; v < mutable_mesh.VertexCount(); ++v) {
+    mutable_mesh.SetFloatVertexAttribute(v, 1, {1, 1});
+    mutable_mesh.SetFloatVertexAttribute(v, 2, {v % 2 == 0 ? -0.5f : 0.5f});
+  }
+  // Use packing params for the opacity shift that differ from the ones that
+  // would be computed from its bounds.
+  MeshAttributeCodingParams opacity_params = {
+      .components = {{.offset = -1, .scale = 2.f / 255}}};
+  absl::StatusOr<PartitionedMesh> source = PartitionedMesh::FromMutableMesh(
+      mutable_mesh, {}, {}, {std::nullopt, std::nullopt, opacity_params});
+  ASSERT_THAT(source, IsOk());
+
+  absl::StatusOr<MergedPartitionedMesh> merged = MergedPartitionedMesh::Create(
+      {{.shape = &*source, .transform = AffineTransform::Scale(2, 3)},
+       {.shape = &*source, .transform = AffineTransform::Translate({5, 5})}});
+  ASSERT_THAT(merged, IsOk());
+
+  ASSERT_EQ(merged->Shape().Meshes().size(), 1);
+  const Mesh& mesh = merged->Shape().Meshes()[0];
+  ASSERT_EQ(mesh.VertexCount(), 2 * mutable_mesh.VertexCount());
+  EXPECT_THAT(mesh.VertexAttributeUnpackingParams(2),
+              MeshAttributeCodingParamsEq(opacity_params));
+  // The first source is scaled, which also scales the derivatives, and the
+  // second is translated, which leaves them unchanged.
+  EXPECT_THAT(mesh.FloatVertexAttribute(0, 1).Values(), ElementsAre(2, 3));
+  EXPECT_THAT(mesh.FloatVertexAttribute(mesh.VertexCount() - 1, 1).Values(),
+              ElementsAre(1, 1));
+}
+
+TEST(MergedPartitionedMeshTest, SourceIndexAcrossPartitions) {
+  // Each source has more than half of the vertices that fit in one partition,
+  // so the merged shape needs more than one mesh.
+  constexpr uint32_t kTrianglesPerSource = 40000;
+  PartitionedMesh source = MakeStraightLinePartitionedMesh(kTrianglesPerSource);
+  absl::StatusOr<PartitionedMesh> empty_source =
+      PartitionedMesh::FromMutableMesh(MutableMesh());
+  ASSERT_THAT(empty_source, IsOk());
+  ThreadPerTaskExecutor executor;
+
+  absl::StatusOr<MergedPartitionedMesh> merged = MergedPartitionedMesh::Create(
+      {{.shape = &source},
+       {.shape = &*empty_source},
+       {.shape = &source, .transform = AffineTransform::Translate({0, 5})},
+       {.shape = &source, .transform = AffineTransform::Translate({0, 10})}},
+      &executor);
+  ASSERT_THAT(merged, IsOk());
+
+  const PartitionedMesh& shape = merged->Shape();
+  ASSERT_THAT(shape.RenderGroupMeshes(0).size(), Gt(1));
+  ASSERT_EQ(GroupTriangleCount(shape, 0), 3 * kTrianglesPerSource);
+  uint32_t first_triangle_in_mesh = 0;
+  for (uint16_t m = 0; m < shape.RenderGroupMeshes(0).size(); ++m) {
+    const Mesh& mesh = shape.RenderGroupMeshes(0)[m];
+    for (uint32_t t = 0; t < mesh.TriangleCount(); t += 997) {
+      uint32_t source_index = merged->SourceIndex(
+          0, {.mesh_index = m, .triangle_index = static_cast<uint16_t>(t)});
+      // The second source has no triangles, so it is never returned.
+      uint32_t expected_source_index =
+          (first_triangle_in_mesh + t) / kTrianglesPerSource;
+      if (expected_source_index > 0) ++expected_source_index;
+      EXPECT_EQ(source_index, expected_source_index);
+      // The sources are separated vertically, so the triangle's position also
+      // tells which source it came from.
+      Point p = mesh.GetTriangle(t).p0;
+      float expected_offset = 5 * (expected_source_index - 1);
+      if (expected_source_index == 0) {
+        EXPECT_THAT(p.y, Lt(5));
+      } else {
+        EXPECT_THAT(p.y, Gt(expected_offset - 2));
+        EXPECT_THAT(p.y, Lt(expected_offset + 2));
+      }
+    }
+    first_triangle_in_mesh += mesh.TriangleCount();
+  }
+}
+
+TEST(MergedPartitionedMeshTest, CreateWithDifferentRenderGroupCounts) {
+  PartitionedMesh one_group = MakeStraightLinePartitionedMesh(4);
+  MutableMesh mutable_mesh = MakeStraightLineMutableMesh(4);
+  absl::StatusOr<PartitionedMesh> two_groups =
+      PartitionedMesh::FromMutableMeshGroups(
+          {{.mesh = &mutable_mesh}, {.mesh = &mutable_mesh}});
+  ASSERT_THAT(two_groups, IsOk());
+
+  EXPECT_THAT(
+      MergedPartitionedMesh::Create({{.shape = &one_group},
+                                     {.shape = &*two_groups}})
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument, HasSubstr("render groups")));
+}
+
+TEST(MergedPartitionedMeshTest, CreateWithDifferentFormats) {
+  PartitionedMesh unpacked = MakeStraightLinePartitionedMesh(4);
+  PartitionedMesh packed =
+      MakeStraightLinePartitionedMesh(4, MakeSinglePackedPositionFormat());
+
+  EXPECT_THAT(
+      MergedPartitionedMesh::Create({{.shape = &unpacked}, {.shape = &packed}})
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument, HasSubstr("format")));
+}
+
+}  // namespace
+}  // namespace ink
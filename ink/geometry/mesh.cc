@@ -14,26 +14,34 @@
 
 #include "ink/geometry/mesh.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/nullability.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/internal/mesh_packing.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mesh_packing_types.h"
+#include "ink/geometry/point.h"
 #include "ink/geometry/triangle.h"
+#include "ink/types/allocator.h"
 #include "ink/types/internal/float.h"
+#include "ink/types/memory_footprint.h"
 #include "ink/types/small_array.h"
+#include "ink/types/trace.h"
 
 namespace ink {
 namespace {
@@ -68,6 +76,55 @@ std::optional<mesh_internal::AttributeBoundsArray> ComputeAttributeBounds(
   return bounds;
 }
 
+// A standard-library allocator for `std::allocate_shared` that appends
+// `trailing_bytes` bytes of storage to the end of the (single) allocation that
+// holds the control block and the object, and reports where that storage
+// begins through `trailing_storage`. The memory comes from an `ink::Allocator`.
+template <typename T>
+class TrailingStorageAllocator {
+ public:
+  using value_type = T;
+
+  TrailingStorageAllocator(Allocator& allocator, size_t trailing_bytes,
+                           std::byte** absl_nonnull trailing_storage)
+      : allocator_(&allocator),
+        trailing_bytes_(trailing_bytes),
+        trailing_storage_(trailing_storage) {}
+
+  template <typename U>
+  explicit TrailingStorageAllocator(const TrailingStorageAllocator<U>& other)
+      : allocator_(other.allocator_),
+        trailing_bytes_(other.trailing_bytes_),
+        trailing_storage_(other.trailing_storage_) {}
+
+  T* absl_nonnull allocate(size_t n) {
+    // `std::allocate_shared` only allocates once, so `trailing_storage_` is
+    // still valid here, even though copies of this allocator outlive it.
+    void* storage = allocator_->Allocate(n * sizeof(T) + trailing_bytes_,
+                                         alignof(T));
+    *trailing_storage_ = static_cast<std::byte*>(storage) + n * sizeof(T);
+    return static_cast<T*>(storage);
+  }
+
+  void deallocate(T* absl_nonnull ptr, size_t n) {
+    allocator_->Deallocate(ptr, n * sizeof(T) + trailing_bytes_, alignof(T));
+  }
+
+  template <typename U>
+  bool operator==(const TrailingStorageAllocator<U>& other) const {
+    return allocator_ == other.allocator_ &&
+           trailing_bytes_ == other.trailing_bytes_;
+  }
+
+ private:
+  template <typename U>
+  friend class TrailingStorageAllocator;
+
+  Allocator* absl_nonnull allocator_;
+  size_t trailing_bytes_;
+  std::byte** absl_nonnull trailing_storage_;
+};
+
 mesh_internal::CodingParamsArray MakeCodingParamsArrayForEmptyMesh(
     const MeshFormat& format) {
   int n_attrs = format.Attributes().size();
@@ -88,7 +145,9 @@ absl::StatusOr<Mesh> Mesh::Create(
     const MeshFormat& format,
     absl::Span<const absl::Span<const float>> vertex_attributes,
     absl::Span<const uint32_t> triangle_indices,
-    absl::Span<const std::optional<MeshAttributeCodingParams>> packing_params) {
+    absl::Span<const std::optional<MeshAttributeCodingParams>> packing_params,
+    Allocator* absl_nullable allocator) {
+  ScopedTraceEvent trace_event("ink::Mesh::Create");
   size_t total_attr_components = format.TotalComponentCount();
   if (total_attr_components != vertex_attributes.size()) {
     return absl::InvalidArgumentError(
@@ -147,20 +206,80 @@ absl::StatusOr<Mesh> Mesh::Create(
   } else {
     coding_params_array = MakeCodingParamsArrayForEmptyMesh(format);
   }
-  std::vector<std::byte> vertex_data =
-      PackVertexByteData(format, vertex_attributes, coding_params_array);
-
-  std::vector<std::byte> index_data;
-  index_data.resize(kBytesPerIndex * triangle_indices.size());
+  // Pack the vertices and triangles straight into the mesh's allocation, so
+  // that each byte is only written once; this allocation may be memory that
+  // the caller will hand to the GPU, see `Allocator`.
   size_t n_triangles = triangle_indices.size() / 3;
+  absl::Span<std::byte> vertex_data;
+  absl::Span<std::byte> index_data;
+  std::shared_ptr<const Data> data = AllocateMeshData(
+      format, std::move(coding_params_array), std::move(attribute_bounds),
+      static_cast<uint32_t>(n_vertices), static_cast<uint32_t>(n_triangles),
+      allocator, vertex_data, index_data);
+  PackVertexByteData(format, vertex_attributes, data->unpacking_params,
+                     vertex_data);
   for (size_t i = 0; i < n_triangles; ++i) {
     mesh_internal::WriteTriangleIndicesToByteArray(
         i, kBytesPerIndex, triangle_indices.subspan(3 * i, 3), index_data);
   }
+  return Mesh(std::move(data));
+}
 
-  return Mesh(format, std::move(coding_params_array),
-              std::move(attribute_bounds), std::move(vertex_data),
-              std::move(index_data));
+std::shared_ptr<const Mesh::Data> Mesh::AllocateMeshData(
+    const MeshFormat& format,
+    mesh_internal::CodingParamsArray unpacking_transforms,
+    std::optional<mesh_internal::AttributeBoundsArray> attribute_bounds,
+    uint32_t vertex_count, uint32_t triangle_count,
+    Allocator* absl_nullable allocator, absl::Span<std::byte>& vertex_data,
+    absl::Span<std::byte>& index_data) {
+  Allocator& data_allocator =
+      allocator == nullptr ? DefaultAllocator() : *allocator;
+  size_t vertex_bytes = size_t{vertex_count} * format.PackedVertexStride();
+  size_t index_bytes = size_t{triangle_count} * 3 * kBytesPerIndex;
+  std::byte* trailing_storage = nullptr;
+  std::shared_ptr<Data> data = std::allocate_shared<Data>(
+      TrailingStorageAllocator<Data>(data_allocator, vertex_bytes + index_bytes,
+                                     &trailing_storage),
+      Data{
+          .format = format,
+          .unpacking_params = std::move(unpacking_transforms),
+          .attribute_bounds = std::move(attribute_bounds),
+          .vertex_count = vertex_count,
+          .triangle_count = triangle_count,
+          .position_cache = PositionCache(data_allocator, vertex_count),
+      });
+  ABSL_DCHECK_NE(trailing_storage, nullptr);
+  vertex_data = absl::MakeSpan(trailing_storage, vertex_bytes);
+  index_data = absl::MakeSpan(trailing_storage + vertex_bytes, index_bytes);
+  data->vertex_data = vertex_data;
+  data->index_data = index_data;
+  return data;
+}
+
+std::shared_ptr<const Mesh::Data> Mesh::CreateMeshData(
+    const MeshFormat& format,
+    mesh_internal::CodingParamsArray unpacking_transforms,
+    std::optional<mesh_internal::AttributeBoundsArray> attribute_bounds,
+    absl::Span<const std::byte> vertex_data,
+    absl::Span<const std::byte> index_data,
+    Allocator* absl_nullable allocator) {
+  absl::Span<std::byte> vertex_storage;
+  absl::Span<std::byte> index_storage;
+  std::shared_ptr<const Data> data = AllocateMeshData(
+      format, std::move(unpacking_transforms), std::move(attribute_bounds),
+      static_cast<uint32_t>(vertex_data.size() / format.PackedVertexStride()),
+      static_cast<uint32_t>(index_data.size() / (3 * kBytesPerIndex)),
+      allocator, vertex_storage, index_storage);
+  ABSL_DCHECK_EQ(vertex_storage.size(), vertex_data.size());
+  ABSL_DCHECK_EQ(index_storage.size(), index_data.size());
+  // `memcpy` must not be given a null pointer, even for zero bytes.
+  if (!vertex_data.empty()) {
+    std::memcpy(vertex_storage.data(), vertex_data.data(), vertex_data.size());
+  }
+  if (!index_data.empty()) {
+    std::memcpy(index_storage.data(), index_data.data(), index_data.size());
+  }
+  return data;
 }
 
 SmallArray<float, 4> Mesh::FloatVertexAttribute(
@@ -174,6 +293,31 @@ SmallArray<float, 4> Mesh::FloatVertexAttribute(
       data_->unpacking_params[attribute_index], absl::MakeSpan(packed_value));
 }
 
+void Mesh::UnpackVertexAttribute(uint32_t attribute_index,
+                                 absl::Span<float> values) const {
+  ABSL_DCHECK_LT(attribute_index, Format().Attributes().size());
+  ABSL_DCHECK_LT(attribute_index, data_->unpacking_params.Size());
+  const MeshFormat::Attribute attr = Format().Attributes()[attribute_index];
+  ABSL_DCHECK_EQ(values.size(),
+                 size_t{MeshFormat::ComponentCount(attr.type)} * VertexCount());
+  mesh_internal::UnpackAttributes(
+      attr.type, data_->unpacking_params[attribute_index], RawVertexData(),
+      VertexStride(), attr.packed_offset, values);
+}
+
+void Mesh::UnpackVertexPositions(absl::Span<Point> positions) const {
+  ABSL_DCHECK_EQ(positions.size(), VertexCount());
+  if (const Point* absl_nullable cached = data_->position_cache.Get()) {
+    std::copy_n(cached, positions.size(), positions.begin());
+    return;
+  }
+  uint32_t attribute_index = VertexPositionAttributeIndex();
+  const MeshFormat::Attribute attr = Format().Attributes()[attribute_index];
+  mesh_internal::UnpackPositions(
+      attr.type, data_->unpacking_params[attribute_index], RawVertexData(),
+      VertexStride(), attr.packed_offset, positions);
+}
+
 SmallArray<uint32_t, 4> Mesh::PackedIntegersForFloatVertexAttribute(
     uint32_t vertex_index, uint32_t attribute_index) const {
   ABSL_DCHECK_LT(attribute_index, Format().Attributes().size());
@@ -201,12 +345,72 @@ Triangle Mesh::GetTriangle(uint32_t index) const {
           .p2 = VertexPosition(vertex_indices[2])};
 }
 
-std::vector<std::byte> Mesh::PackVertexByteData(
+std::optional<AffineTransform> Mesh::PositionToPackedIntegerTransform() const {
+  if (!HasPackedIntegerPositions()) return std::nullopt;
+  const MeshAttributeCodingParams& params =
+      VertexAttributeUnpackingParams(VertexPositionAttributeIndex());
+  ABSL_DCHECK_EQ(params.components.Size(), 2);
+  float x_scale = params.components[0].scale;
+  float y_scale = params.components[1].scale;
+  if (x_scale == 0 || y_scale == 0) return std::nullopt;
+  return AffineTransform(1 / x_scale, 0, -params.components[0].offset / x_scale,
+                         0, 1 / y_scale,
+                         -params.components[1].offset / y_scale);
+}
+
+Triangle Mesh::GetPackedIntegerTriangle(uint32_t index) const {
+  ABSL_DCHECK(HasPackedIntegerPositions());
+  std::array<uint32_t, 3> vertex_indices = TriangleIndices(index);
+  std::array<Point, 3> points;
+  for (int i = 0; i < 3; ++i) {
+    SmallArray<uint32_t, 4> packed = PackedIntegersForFloatVertexAttribute(
+        vertex_indices[i], VertexPositionAttributeIndex());
+    points[i] = {static_cast<float>(packed[0]), static_cast<float>(packed[1])};
+  }
+  return {.p0 = points[0], .p1 = points[1], .p2 = points[2]};
+}
+
+void Mesh::InitializePositionCache() const {
+  data_->position_cache.Initialize(*this);
+}
+
+Mesh::PositionCache::~PositionCache() {
+  if (Point* positions = positions_.load(std::memory_order_relaxed)) {
+    allocator_->Deallocate(positions, vertex_count_ * sizeof(Point),
+                           alignof(Point));
+  }
+}
+
+void Mesh::PositionCache::Initialize(const Mesh& mesh) const {
+  if (Get() != nullptr || vertex_count_ == 0) return;
+  ABSL_DCHECK_EQ(mesh.VertexCount(), vertex_count_);
+  auto* positions = static_cast<Point*>(
+      allocator_->Allocate(vertex_count_ * sizeof(Point), alignof(Point)));
+  std::uninitialized_default_construct_n(positions, vertex_count_);
+  mesh.UnpackVertexPositions(absl::MakeSpan(positions, vertex_count_));
+  Point* expected = nullptr;
+  if (!positions_.compare_exchange_strong(expected, positions,
+                                          std::memory_order_acq_rel)) {
+    // Another thread built the cache first.
+    allocator_->Deallocate(positions, vertex_count_ * sizeof(Point),
+                           alignof(Point));
+  }
+}
+
+void Mesh::AddToMemoryFootprint(MemoryFootprint& footprint) const {
+  if (!footprint.AddShared(data_.get())) return;
+  footprint.AddBytes(sizeof(Data) + data_->vertex_data.size() +
+                     data_->index_data.size() +
+                     data_->position_cache.ByteSize());
+}
+
+void Mesh::PackVertexByteData(
     const MeshFormat& format,
     absl::Span<const absl::Span<const float>> vertex_attributes,
-    const mesh_internal::CodingParamsArray& packing_params_array) {
+    const mesh_internal::CodingParamsArray& packing_params_array,
+    absl::Span<std::byte> vertex_data) {
   size_t n_vertices = vertex_attributes[0].size();
-  std::vector<std::byte> vertex_data(n_vertices * format.PackedVertexStride());
+  ABSL_DCHECK_EQ(vertex_data.size(), n_vertices * format.PackedVertexStride());
 
   int n_attrs = format.Attributes().size();
   for (size_t vertex_idx = 0; vertex_idx < n_vertices; ++vertex_idx) {
@@ -227,8 +431,6 @@ std::vector<std::byte> Mesh::PackVertexByteData(
                                    unpacked, packed_value);
     }
   }
-
-  return vertex_data;
 }
 
 }  // namespace ink
@@ -16,6 +16,7 @@
 #define INK_GEOMETRY_MESH_H_
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -27,12 +28,15 @@
 #include "absl/log/absl_check.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/envelope.h"
 #include "ink/geometry/internal/mesh_packing.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mesh_packing_types.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/triangle.h"
+#include "ink/types/allocator.h"
+#include "ink/types/memory_footprint.h"
 #include "ink/types/small_array.h"
 
 namespace ink {
@@ -44,7 +48,10 @@ namespace ink {
 // see `MeshFormat` for details on attribute packing.
 //
 // `Mesh` stores its data in a `std::shared_ptr`; making a copy only involves
-// copying the `std::shared_ptr`, making it very cheap.
+// copying the `std::shared_ptr`, making it very cheap. The shared pointer's
+// control block, the mesh's metadata, and its vertex and index bytes are all
+// placed in a single allocation, which is made from the `Allocator` given when
+// the mesh is created (or `DefaultAllocator()` if none is given).
 class Mesh {
  public:
   // Constructs a mesh with the given format and unpacked attribute values.
@@ -89,12 +96,17 @@ class Mesh {
   //   values)
   // - Any non-null element of `packing_params` is unable to represent the
   //   minimum and maximum values of the corresponding attribute
+  //
+  // Optional argument `allocator` provides the memory for the mesh's data; if
+  // it is null, `DefaultAllocator()` is used. It must outlive the returned mesh
+  // and all of its copies.
   static absl::StatusOr<Mesh> Create(
       const MeshFormat& format,
       absl::Span<const absl::Span<const float>> vertex_attributes,
       absl::Span<const uint32_t> triangle_indices,
       absl::Span<const std::optional<MeshAttributeCodingParams>>
-          packing_params = {});
+          packing_params = {},
+      Allocator* absl_nullable allocator = nullptr);
 
   // Constructs an empty mesh, with a default-constructed `MeshFormat`. Note
   // that, since `Mesh` is read-only, you can't do much with an empty mesh. See
@@ -103,7 +115,8 @@ class Mesh {
   Mesh()
       : data_(std::make_shared<const Data>(Data{
             .unpacking_params = {
-                {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}}}})) {}
+                {{{.offset = 0, .scale = 1}, {.offset = 0, .scale = 1}}}},
+            .position_cache = PositionCache(DefaultAllocator(), 0)})) {}
 
   // `Mesh` is cheap to copy, as the copies just share the same (immutable)
   // underlying data.
@@ -121,11 +134,32 @@ class Mesh {
   // Returns the position of the vertex at the given index. This DCHECK-fails if
   // `index` >= `VertexCount()`.
   Point VertexPosition(uint32_t index) const {
+    if (const Point* absl_nullable positions = data_->position_cache.Get()) {
+      ABSL_DCHECK_LT(index, VertexCount());
+      return positions[index];
+    }
     SmallArray<float, 4> value =
         FloatVertexAttribute(index, VertexPositionAttributeIndex());
     return {value[0], value[1]};
   }
 
+  // Builds a cache of the mesh's unpacked vertex positions, stored
+  // contiguously. After this, `VertexPosition()` and `GetTriangle()` read from
+  // the cache rather than unpacking the position from the interleaved vertex
+  // data, which makes hit-testing queries on large meshes faster.
+  //
+  // The cache costs `sizeof(Point)` (8) bytes per vertex, and is allocated from
+  // the same `Allocator` as the mesh. It is shared between copies of the mesh,
+  // and is built at most once; this is a no-op if it already exists. This is
+  // thread-safe. `PartitionedMesh` calls this for its meshes when it builds its
+  // spatial index.
+  void InitializePositionCache() const;
+
+  // Returns true if the cache built by `InitializePositionCache()` exists.
+  bool IsPositionCacheInitialized() const {
+    return data_->position_cache.Get() != nullptr;
+  }
+
   // Returns the index of the vertex attribute that contains the vertex's
   // position.
   uint32_t VertexPositionAttributeIndex() const {
@@ -139,12 +173,31 @@ class Mesh {
   SmallArray<float, 4> FloatVertexAttribute(uint32_t vertex_index,
                                             uint32_t attribute_index) const;
 
+  // Writes the (unpacked) value of the attribute at index `attribute_index` on
+  // every vertex to `values`. The N components of the value on the vertex at
+  // index i are written to `values[N * i]` through `values[N * i + N - 1]`,
+  // where N is the attribute's component count. This gives the same values as
+  // calling `FloatVertexAttribute()` for each vertex, but is much faster on
+  // large meshes. DCHECK-fails if:
+  // - `attribute_index` >= `Format().Attributes().size()`
+  // - `values.size()` != N * `VertexCount()`
+  void UnpackVertexAttribute(uint32_t attribute_index,
+                             absl::Span<float> values) const;
+
+  // Writes the position of every vertex to `positions`, copying them from the
+  // cache built by `InitializePositionCache()` if it exists. This gives the
+  // same values as calling `VertexPosition()` for each vertex, but is much
+  // faster on large meshes. DCHECK-fails if `positions.size()` !=
+  // `VertexCount()`.
+  void UnpackVertexPositions(absl::Span<Point> positions) const;
+
   // Returns the packed integer values for the attribute at index
   // `attribute_index` on the vertex at `vertex_index`.
   //
   // This DCHECK-fails if `vertex_index` >= `VertexCount()`, or if
   // `attribute_index` >= `Format().Attributes().size()`, or if the attribute in
-  // question is not packed.
+  // question is not packed into integers (i.e. if it is an unpacked or
+  // half-float type).
   SmallArray<uint32_t, 4> PackedIntegersForFloatVertexAttribute(
       uint32_t vertex_index, uint32_t attribute_index) const;
 
@@ -167,6 +220,34 @@ class Mesh {
   // if `index` >= `TriangleCount()`.
   Triangle GetTriangle(uint32_t index) const;
 
+  // Returns true if the mesh's vertex positions are packed into fixed-precision
+  // integers, which is the case for packed position types other than
+  // half-floats.
+  bool HasPackedIntegerPositions() const {
+    return MeshFormat::PackedBitsPerComponent(
+               Format().Attributes()[VertexPositionAttributeIndex()].type)
+        .has_value();
+  }
+
+  // Returns the transform from the mesh's coordinate space to the space of its
+  // packed integer positions, i.e. the inverse of the position's unpacking
+  // params. Returns `std::nullopt` if `HasPackedIntegerPositions()` is false,
+  // or if the unpacking params can't be inverted (which happens when all of the
+  // positions have the same x- or y-coordinate).
+  //
+  // Together with `GetPackedIntegerTriangle()`, this lets a query be tested
+  // against the mesh without unpacking any vertex positions: transform the
+  // query into the packed space once, and test it against the packed
+  // triangles.
+  std::optional<AffineTransform> PositionToPackedIntegerTransform() const;
+
+  // Returns the triangle at the given index, with the packed integer values of
+  // its vertex positions (see `PackedIntegersForFloatVertexAttribute()`) as its
+  // coordinates. These are exactly representable as floats. This
+  // DCHECK-fails if `index` >= `TriangleCount()`, or if
+  // `HasPackedIntegerPositions()` is false.
+  Triangle GetPackedIntegerTriangle(uint32_t index) const;
+
   // Returns the format of the mesh.
   const MeshFormat& Format() const { return data_->format; }
 
@@ -212,21 +293,69 @@ class Mesh {
 
   // Returns the raw data of the mesh's triangle indices. These are stored
   // unsigned using 2 bytes per index (i.e. as uint16_t).
+  //
+  // Indices are kept at 16 bits because the mesh APIs that Ink renders with
+  // (`SkMesh` and `android.graphics.Mesh`) only accept 16-bit index buffers;
+  // larger shapes are instead split into several meshes by `PartitionedMesh`.
   absl::Span<const std::byte> RawIndexData() const { return data_->index_data; }
 
   // Returns the number of bytes used to represent a triangle index in this
   // mesh, which is always two bytes (i.e. sizeof(uint16_t)).
   uint32_t IndexStride() const { return kBytesPerIndex; }
 
+  // Adds the memory held by this mesh to `footprint`. The mesh data is shared
+  // between copies of the mesh, and so is only counted once per `footprint`.
+  void AddToMemoryFootprint(MemoryFootprint& footprint) const;
+
  private:
+  // A lazily-built array of the mesh's unpacked vertex positions; see
+  // `InitializePositionCache()`. It is published with an atomic pointer, so
+  // that queries can check for it without locking.
+  class PositionCache {
+   public:
+    PositionCache(Allocator& allocator, uint32_t vertex_count)
+        : allocator_(&allocator), vertex_count_(vertex_count) {}
+    // `Data` is only moved while it is being created, before the cache can have
+    // been built.
+    PositionCache(PositionCache&& other)
+        : allocator_(other.allocator_), vertex_count_(other.vertex_count_) {
+      ABSL_DCHECK_EQ(other.Get(), nullptr);
+    }
+    PositionCache& operator=(PositionCache&&) = delete;
+    ~PositionCache();
+
+    // Returns the cached positions, or null if they haven't been built yet.
+    const Point* absl_nullable Get() const {
+      return positions_.load(std::memory_order_acquire);
+    }
+
+    // Builds the cache from `mesh` if it doesn't already exist. If several
+    // threads race to build it, all but one of the copies is discarded.
+    void Initialize(const Mesh& mesh) const;
+
+    // Returns the number of bytes held by the cache, which is zero if it hasn't
+    // been built.
+    size_t ByteSize() const {
+      return Get() == nullptr ? 0 : vertex_count_ * sizeof(Point);
+    }
+
+   private:
+    Allocator* absl_nonnull allocator_;
+    uint32_t vertex_count_;
+    mutable std::atomic<Point*> positions_ = nullptr;
+  };
+
   struct Data {
     MeshFormat format;
     mesh_internal::CodingParamsArray unpacking_params;
     std::optional<mesh_internal::AttributeBoundsArray> attribute_bounds;
-    std::vector<std::byte> vertex_data;
-    std::vector<std::byte> index_data;
+    // These point into the same allocation as this struct; see
+    // `CreateMeshData`.
+    absl::Span<const std::byte> vertex_data;
+    absl::Span<const std::byte> index_data;
     uint32_t vertex_count = 0;
     uint32_t triangle_count = 0;
+    PositionCache position_cache;
   };
 
   // `MutableMesh::AsMeshes` requires access to the private ctor, to avoid
@@ -240,42 +369,53 @@ class Mesh {
   Mesh(const MeshFormat& format,
        mesh_internal::CodingParamsArray unpacking_transforms,
        std::optional<mesh_internal::AttributeBoundsArray> attribute_bounds,
-       std::vector<std::byte> vertex_data, std::vector<std::byte> index_data)
+       absl::Span<const std::byte> vertex_data,
+       absl::Span<const std::byte> index_data,
+       Allocator* absl_nullable allocator)
       : data_(CreateMeshData(format, std::move(unpacking_transforms),
-                             std::move(attribute_bounds),
-                             std::move(vertex_data), std::move(index_data))) {}
+                             std::move(attribute_bounds), vertex_data,
+                             index_data, allocator)) {}
 
-  // Helper function for Create(). Packs the vertex attributes into a vector of
-  // bytes.
-  static std::vector<std::byte> PackVertexByteData(
+  explicit Mesh(absl_nonnull std::shared_ptr<const Data> data)
+      : data_(std::move(data)) {}
+
+  // Helper function for Create(). Packs the vertex attributes into
+  // `vertex_data`, which must be exactly large enough to hold them.
+  static void PackVertexByteData(
       const MeshFormat& format,
       absl::Span<const absl::Span<const float>> vertex_attributes,
-      const mesh_internal::CodingParamsArray& packing_params_array);
+      const mesh_internal::CodingParamsArray& packing_params_array,
+      absl::Span<std::byte> vertex_data);
+
+  // Creates a new Data struct in a single allocation from `allocator` (or
+  // `DefaultAllocator()` if it is null), which also holds the `std::shared_ptr`
+  // control block and room for the vertex and index bytes of `vertex_count`
+  // vertices and `triangle_count` triangles. Sets `vertex_data` and
+  // `index_data` to that room, which the caller must fill in before the Data is
+  // shared.
+  static std::shared_ptr<const Data> AllocateMeshData(
+      const MeshFormat& format,
+      mesh_internal::CodingParamsArray unpacking_transforms,
+      std::optional<mesh_internal::AttributeBoundsArray> attribute_bounds,
+      uint32_t vertex_count, uint32_t triangle_count,
+      Allocator* absl_nullable allocator, absl::Span<std::byte>& vertex_data,
+      absl::Span<std::byte>& index_data);
 
-  // Helper function for the private Mesh constructor. Creates a new Data struct
-  // while avoiding field initialization order issues.
+  // Helper function for the private Mesh constructor. Same as
+  // `AllocateMeshData`, but fills the allocation with copies of `vertex_data`
+  // and `index_data`.
   static std::shared_ptr<const Data> CreateMeshData(
       const MeshFormat& format,
       mesh_internal::CodingParamsArray unpacking_transforms,
       std::optional<mesh_internal::AttributeBoundsArray> attribute_bounds,
-      std::vector<std::byte> vertex_data, std::vector<std::byte> index_data) {
-    uint32_t vertex_count = vertex_data.size() / format.PackedVertexStride();
-    uint32_t triangle_count = index_data.size() / (3 * kBytesPerIndex);
-    return std::make_shared<const Data>(Data{
-        .format = format,
-        .unpacking_params = std::move(unpacking_transforms),
-        .attribute_bounds = std::move(attribute_bounds),
-        .vertex_data = std::move(vertex_data),
-        .index_data = std::move(index_data),
-        .vertex_count = vertex_count,
-        .triangle_count = triangle_count,
-    });
-  }
-
-  // Returns a span into the vector that contains the bytes of the packed floats
-  // that encode the attribute value at index `attribute_index` on the vertex at
-  // `vertex_index`. If the attribute is not packed, this will be the same as
-  // the unpacked values returned by FloatVertexAttribute().
+      absl::Span<const std::byte> vertex_data,
+      absl::Span<const std::byte> index_data,
+      Allocator* absl_nullable allocator);
+
+  // Returns a span into the vertex data that contains the bytes of the packed
+  // floats that encode the attribute value at index `attribute_index` on the
+  // vertex at `vertex_index`. If the attribute is not packed, this will be the
+  // same as the unpacked values returned by FloatVertexAttribute().
   //
   // This DCHECK-fails if `vertex_index` >= `VertexCount()`, or if
   // `attribute_index` >= `Format().Attributes().size()`.
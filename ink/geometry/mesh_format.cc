@@ -53,6 +53,10 @@ bool IsValidAttributeType(MeshFormat::AttributeType type) {
     case MeshFormat::AttributeType::kFloat4PackedInOneFloat:
     case MeshFormat::AttributeType::kFloat4PackedInTwoFloats:
     case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
       return true;
   }
   return false;
@@ -199,6 +203,8 @@ uint8_t MeshFormat::ComponentCount(AttributeType type) {
     case AttributeType::kFloat2PackedInOneFloat:
     case AttributeType::kFloat2PackedInThreeUnsignedBytes_XY12:
     case AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20:
+    case AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case AttributeType::kFloat2PackedInTwoHalfFloats:
       return 2;
     case AttributeType::kFloat3Unpacked:
     case AttributeType::kFloat3PackedInOneFloat:
@@ -209,6 +215,8 @@ uint8_t MeshFormat::ComponentCount(AttributeType type) {
     case AttributeType::kFloat4PackedInOneFloat:
     case AttributeType::kFloat4PackedInTwoFloats:
     case AttributeType::kFloat4PackedInThreeFloats:
+    case AttributeType::kFloat4PackedInFourUnsignedShorts:
+    case AttributeType::kFloat4PackedInFourHalfFloats:
       return 4;
   }
   ABSL_LOG(FATAL) << "Unrecognized AttributeType " << static_cast<int>(type);
@@ -221,6 +229,8 @@ std::optional<SmallArray<uint8_t, 4>> MeshFormat::PackedBitsPerComponent(
     case AttributeType::kFloat2Unpacked:
     case AttributeType::kFloat3Unpacked:
     case AttributeType::kFloat4Unpacked:
+    case AttributeType::kFloat2PackedInTwoHalfFloats:
+    case AttributeType::kFloat4PackedInFourHalfFloats:
       return std::nullopt;
     case AttributeType::kFloat1PackedInOneUnsignedByte:
       return SmallArray<uint8_t, 4>({8});
@@ -241,6 +251,10 @@ std::optional<SmallArray<uint8_t, 4>> MeshFormat::PackedBitsPerComponent(
       return SmallArray<uint8_t, 4>({6, 6, 6, 6});
     case AttributeType::kFloat4PackedInThreeFloats:
       return SmallArray<uint8_t, 4>({18, 18, 18, 18});
+    case AttributeType::kFloat2PackedInTwoUnsignedShorts:
+      return SmallArray<uint8_t, 4>({16, 16});
+    case AttributeType::kFloat4PackedInFourUnsignedShorts:
+      return SmallArray<uint8_t, 4>({16, 16, 16, 16});
   }
   ABSL_LOG(FATAL) << "Unrecognized AttributeType " << static_cast<int>(type);
 }
@@ -266,6 +280,10 @@ bool MeshFormat::IsPackedAsFloat(AttributeType type) {
     case MeshFormat::AttributeType::kFloat2PackedInThreeUnsignedBytes_XY12:
     case MeshFormat::AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20:
     case MeshFormat::AttributeType::kFloat3PackedInFourUnsignedBytes_XYZ10:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
       return false;
   }
   ABSL_LOG(FATAL) << "Unrecognized AttributeType " << static_cast<int>(type);
@@ -283,10 +301,14 @@ uint8_t MeshFormat::PackedAttributeSize(AttributeType type) {
     case AttributeType::kFloat4PackedInOneFloat:
     case AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20:
     case AttributeType::kFloat3PackedInFourUnsignedBytes_XYZ10:
+    case AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case AttributeType::kFloat2PackedInTwoHalfFloats:
       return 4;
     case AttributeType::kFloat2Unpacked:
     case AttributeType::kFloat3PackedInTwoFloats:
     case AttributeType::kFloat4PackedInTwoFloats:
+    case AttributeType::kFloat4PackedInFourUnsignedShorts:
+    case AttributeType::kFloat4PackedInFourHalfFloats:
       return 8;
     case AttributeType::kFloat3Unpacked:
     case AttributeType::kFloat4PackedInThreeFloats:
@@ -426,6 +448,14 @@ std::string ToFormattedString(MeshFormat::AttributeType type) {
       return "kFloat4PackedInTwoFloats";
     case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
       return "kFloat4PackedInThreeFloats";
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+      return "kFloat2PackedInTwoUnsignedShorts";
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+      return "kFloat4PackedInFourUnsignedShorts";
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+      return "kFloat2PackedInTwoHalfFloats";
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
+      return "kFloat4PackedInFourHalfFloats";
   }
   return absl::StrCat("Invalid(", static_cast<int>(type), ")");
 }
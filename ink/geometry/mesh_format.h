@@ -144,6 +144,29 @@ class MeshFormat {
     // [2] : 0x000000, 0x000FFF, 0xFC0000
     // [3] : 0x000000, 0x000000, 0x03FFFF
     kFloat4PackedInThreeFloats,
+    // Two floats, packed into 2 unsigned shorts, using 16 bits each. Each
+    // component is stored as a `uint16_t` in native byte order, so that the GPU
+    // can read the attribute directly as a normalized 16-bit integer vector
+    // (e.g. `VK_FORMAT_R16G16_UNORM`) instead of unpacking it in the shader.
+    kFloat2PackedInTwoUnsignedShorts,
+    // Four floats, packed into 4 unsigned shorts, using 16 bits each. This is
+    // stored like `kFloat2PackedInTwoUnsignedShorts`, e.g. for reading as
+    // `VK_FORMAT_R16G16B16A16_UNORM`.
+    kFloat4PackedInFourUnsignedShorts,
+    // Two floats, each stored as an IEEE 754 half-precision float in native
+    // byte order, so that the GPU can read the attribute directly (e.g. as
+    // `VK_FORMAT_R16G16_SFLOAT`). Unlike the other packed types, this is not
+    // fixed-precision: the coding params are applied as for the other packed
+    // types, but default to an offset of 0 and a scale of 1, and the error is
+    // then relative to the magnitude of the (offset and scaled) value, at most
+    // 2^-11 times that. Values whose magnitude after applying the coding params
+    // is greater than 65504 (the largest finite half-float) can't be
+    // represented.
+    kFloat2PackedInTwoHalfFloats,
+    // Four floats, each stored as a half-precision float, as for
+    // `kFloat2PackedInTwoHalfFloats` (e.g. for reading as
+    // `VK_FORMAT_R16G16B16A16_SFLOAT`).
+    kFloat4PackedInFourHalfFloats,
   };
   // LINT.ThenChange(
   //   fuzz_domains.cc:attribute_types,
@@ -280,10 +303,19 @@ class MeshFormat {
   static uint8_t ComponentCount(AttributeType type);
 
   // Returns the number of bits used to represent each component in the packed
-  // attribute, or std::nullopt if the attribute is not packed.
+  // attribute, or std::nullopt if the attribute is not packed into
+  // fixed-precision integers, i.e. if it is an unpacked type or a half-float
+  // type.
   static std::optional<SmallArray<uint8_t, 4>> PackedBitsPerComponent(
       AttributeType type);
 
+  // Returns true if the attribute type is packed into half-precision floats,
+  // e.g. `kFloat2PackedInTwoHalfFloats`.
+  static bool IsHalfFloatType(AttributeType type) {
+    return type == AttributeType::kFloat2PackedInTwoHalfFloats ||
+           type == AttributeType::kFloat4PackedInFourHalfFloats;
+  }
+
   // Returns true if the attribute type is packed into a float. Returns false
   // for all unpacked types and types that are packed directly into bytes.
   static bool IsPackedAsFloat(AttributeType type);
@@ -291,7 +323,7 @@ class MeshFormat {
   // Returns true if the attribute type is an "unpacked type"; i.e., if the
   // attribute value is always stored unpacked, even in a packed mesh.
   static bool IsUnpackedType(AttributeType type) {
-    return !PackedBitsPerComponent(type).has_value();
+    return !PackedBitsPerComponent(type).has_value() && !IsHalfFloatType(type);
   }
 
   // Returns the size in bytes of the attribute when unpacked.
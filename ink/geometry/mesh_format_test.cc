@@ -57,6 +57,14 @@ TEST(MeshFormatTest, StringifyAttributeType) {
             "kFloat4PackedInTwoFloats");
   EXPECT_EQ(absl::StrCat(AttrType::kFloat4PackedInThreeFloats),
             "kFloat4PackedInThreeFloats");
+  EXPECT_EQ(absl::StrCat(AttrType::kFloat2PackedInTwoUnsignedShorts),
+            "kFloat2PackedInTwoUnsignedShorts");
+  EXPECT_EQ(absl::StrCat(AttrType::kFloat4PackedInFourUnsignedShorts),
+            "kFloat4PackedInFourUnsignedShorts");
+  EXPECT_EQ(absl::StrCat(AttrType::kFloat2PackedInTwoHalfFloats),
+            "kFloat2PackedInTwoHalfFloats");
+  EXPECT_EQ(absl::StrCat(AttrType::kFloat4PackedInFourHalfFloats),
+            "kFloat4PackedInFourHalfFloats");
   EXPECT_EQ(absl::StrCat(static_cast<AttrType>(123)), "Invalid(123)");
 }
 
@@ -338,6 +346,16 @@ TEST(MeshFormatTest, ComponentCount) {
   EXPECT_EQ(MeshFormat::ComponentCount(AttrType::kFloat4PackedInTwoFloats), 4);
   EXPECT_EQ(MeshFormat::ComponentCount(AttrType::kFloat4PackedInThreeFloats),
             4);
+  EXPECT_EQ(
+      MeshFormat::ComponentCount(AttrType::kFloat2PackedInTwoUnsignedShorts),
+      2);
+  EXPECT_EQ(
+      MeshFormat::ComponentCount(AttrType::kFloat4PackedInFourUnsignedShorts),
+      4);
+  EXPECT_EQ(MeshFormat::ComponentCount(AttrType::kFloat2PackedInTwoHalfFloats),
+            2);
+  EXPECT_EQ(
+      MeshFormat::ComponentCount(AttrType::kFloat4PackedInFourHalfFloats), 4);
 }
 
 TEST(MeshFormatTest, PackedBitsPerComponent) {
@@ -379,6 +397,22 @@ TEST(MeshFormatTest, PackedBitsPerComponent) {
           .value()
           .Values(),
       ElementsAre(18, 18, 18, 18));
+  EXPECT_THAT(MeshFormat::PackedBitsPerComponent(
+                  AttrType::kFloat2PackedInTwoUnsignedShorts)
+                  .value()
+                  .Values(),
+              ElementsAre(16, 16));
+  EXPECT_THAT(MeshFormat::PackedBitsPerComponent(
+                  AttrType::kFloat4PackedInFourUnsignedShorts)
+                  .value()
+                  .Values(),
+              ElementsAre(16, 16, 16, 16));
+  EXPECT_EQ(MeshFormat::PackedBitsPerComponent(
+                AttrType::kFloat2PackedInTwoHalfFloats),
+            std::nullopt);
+  EXPECT_EQ(MeshFormat::PackedBitsPerComponent(
+                AttrType::kFloat4PackedInFourHalfFloats),
+            std::nullopt);
 }
 
 TEST(MeshFormatTest, IsUnpackedType) {
@@ -393,6 +427,23 @@ TEST(MeshFormatTest, IsUnpackedType) {
   EXPECT_FALSE(MeshFormat::IsUnpackedType(AttrType::kFloat4PackedInTwoFloats));
   EXPECT_FALSE(
       MeshFormat::IsUnpackedType(AttrType::kFloat4PackedInThreeFloats));
+  EXPECT_FALSE(
+      MeshFormat::IsUnpackedType(AttrType::kFloat2PackedInTwoUnsignedShorts));
+  EXPECT_FALSE(
+      MeshFormat::IsUnpackedType(AttrType::kFloat2PackedInTwoHalfFloats));
+  EXPECT_FALSE(
+      MeshFormat::IsUnpackedType(AttrType::kFloat4PackedInFourHalfFloats));
+}
+
+TEST(MeshFormatTest, IsHalfFloatType) {
+  EXPECT_FALSE(MeshFormat::IsHalfFloatType(AttrType::kFloat2Unpacked));
+  EXPECT_FALSE(MeshFormat::IsHalfFloatType(AttrType::kFloat2PackedInOneFloat));
+  EXPECT_FALSE(
+      MeshFormat::IsHalfFloatType(AttrType::kFloat2PackedInTwoUnsignedShorts));
+  EXPECT_TRUE(
+      MeshFormat::IsHalfFloatType(AttrType::kFloat2PackedInTwoHalfFloats));
+  EXPECT_TRUE(
+      MeshFormat::IsHalfFloatType(AttrType::kFloat4PackedInFourHalfFloats));
 }
 
 TEST(MeshFormatTest, UnpackedAttributeSize) {
@@ -435,6 +486,18 @@ TEST(MeshFormatTest, PackedAttributeSize) {
   EXPECT_EQ(
       MeshFormat::PackedAttributeSize(AttrType::kFloat4PackedInThreeFloats),
       12);
+  EXPECT_EQ(MeshFormat::PackedAttributeSize(
+                AttrType::kFloat2PackedInTwoUnsignedShorts),
+            4);
+  EXPECT_EQ(MeshFormat::PackedAttributeSize(
+                AttrType::kFloat4PackedInFourUnsignedShorts),
+            8);
+  EXPECT_EQ(
+      MeshFormat::PackedAttributeSize(AttrType::kFloat2PackedInTwoHalfFloats),
+      4);
+  EXPECT_EQ(
+      MeshFormat::PackedAttributeSize(AttrType::kFloat4PackedInFourHalfFloats),
+      8);
 }
 
 void PackedVertexStrideIsAtMostUnpackedVertexStride(MeshFormat format) {
@@ -0,0 +1,520 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/mesh_simplification.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mesh_format.h"
+#include "ink/geometry/mesh_packing_types.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/triangle.h"
+#include "ink/types/executor.h"
+#include "ink/types/small_array.h"
+
+namespace ink {
+namespace {
+
+using VertexIndexPair = PartitionedMesh::VertexIndexPair;
+
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+// Simplifies a single `Mesh` by repeatedly collapsing a vertex into one of its
+// neighbors (a "half-edge collapse"). Since no new vertices are created, the
+// surviving vertices keep their original values, including their packed
+// representation.
+class MeshSimplifier {
+ public:
+  MeshSimplifier(const Mesh& mesh, float max_error);
+
+  uint32_t VertexCount() const { return positions_.size(); }
+  Point VertexPosition(uint32_t v) const { return positions_[v]; }
+  bool IsBoundaryVertex(uint32_t v) const { return is_boundary_[v]; }
+
+  // Prevents vertex `v` from being removed; other vertices may still be
+  // collapsed into it. Boundary vertices start out locked.
+  void LockVertex(uint32_t v) { is_locked_[v] = true; }
+
+  // Allows boundary vertex `v` to be removed by collapsing it into `prev` or
+  // `next`, its neighbors on the outline at `outline_index`. This must only be
+  // called for vertices that appear once in the render group's outlines.
+  void AllowOutlineCollapse(uint32_t v, uint32_t prev, uint32_t next,
+                            uint32_t outline_index);
+
+  // Performs collapses until none of the remaining ones are allowed.
+  void Simplify();
+
+  // Returns the simplified mesh, using the same format and packing params as
+  // the original. `new_vertex_indices` is filled with the index of each
+  // original vertex in the simplified mesh, or `kNone` if it was removed.
+  absl::StatusOr<Mesh> BuildMesh(
+      std::vector<uint32_t>& new_vertex_indices) const;
+
+ private:
+  // Returns the neighbors of `v`, in increasing order.
+  absl::InlinedVector<uint32_t, 8> Neighbors(uint32_t v) const;
+
+  // Returns the error bound of `v` after `u` is collapsed into it.
+  float CollapsedError(uint32_t u, uint32_t v) const {
+    return std::max(errors_[v],
+                    errors_[u] + std::hypot(positions_[u].x - positions_[v].x,
+                                            positions_[u].y - positions_[v].y));
+  }
+
+  bool LabelsMatch(uint32_t u, uint32_t v) const;
+  bool CanCollapse(uint32_t u, uint32_t v) const;
+  void Collapse(uint32_t u, uint32_t v);
+
+  const Mesh& mesh_;
+  float max_error_;
+  // Indices of the `kSideLabel` and `kForwardLabel` attributes, if present.
+  absl::InlinedVector<uint32_t, 2> label_attribute_indices_;
+
+  std::vector<Point> positions_;
+  std::vector<std::array<uint32_t, 3>> triangles_;
+  std::vector<bool> is_triangle_alive_;
+  uint32_t alive_triangle_count_;
+  // The triangles that use each vertex. These may include triangles that are
+  // no longer alive, which are skipped.
+  std::vector<absl::InlinedVector<uint32_t, 6>> vertex_triangles_;
+
+  std::vector<bool> is_boundary_;
+  std::vector<bool> is_locked_;
+  std::vector<bool> is_removed_;
+  // The largest distance from each vertex to any vertex that was collapsed
+  // into it, directly or indirectly.
+  std::vector<float> errors_;
+
+  // The outline neighbors of each outline vertex, or `kNone`.
+  std::vector<uint32_t> outline_prev_;
+  std::vector<uint32_t> outline_next_;
+  std::vector<uint32_t> outline_indices_;
+  // The number of remaining vertices of each outline in this mesh.
+  absl::flat_hash_map<uint32_t, uint32_t> outline_vertex_counts_;
+};
+
+MeshSimplifier::MeshSimplifier(const Mesh& mesh, float max_error)
+    : mesh_(mesh),
+      max_error_(max_error),
+      positions_(mesh.VertexCount()),
+      triangles_(mesh.TriangleCount()),
+      is_triangle_alive_(mesh.TriangleCount(), true),
+      alive_triangle_count_(mesh.TriangleCount()),
+      vertex_triangles_(mesh.VertexCount()),
+      is_boundary_(mesh.VertexCount(), false),
+      is_locked_(mesh.VertexCount(), false),
+      is_removed_(mesh.VertexCount(), false),
+      errors_(mesh.VertexCount(), 0),
+      outline_prev_(mesh.VertexCount(), kNone),
+      outline_next_(mesh.VertexCount(), kNone),
+      outline_indices_(mesh.VertexCount(), kNone) {
+  absl::Span<const MeshFormat::Attribute> attributes =
+      mesh.Format().Attributes();
+  for (uint32_t i = 0; i < attributes.size(); ++i) {
+    if (attributes[i].id == MeshFormat::AttributeId::kSideLabel ||
+        attributes[i].id == MeshFormat::AttributeId::kForwardLabel) {
+      label_attribute_indices_.push_back(i);
+    }
+  }
+
+  for (uint32_t v = 0; v < positions_.size(); ++v) {
+    positions_[v] = mesh.VertexPosition(v);
+  }
+
+  // An edge that is used by only one triangle is on the boundary of the mesh.
+  absl::flat_hash_map<std::pair<uint32_t, uint32_t>, int> edge_use_counts;
+  for (uint32_t t = 0; t < triangles_.size(); ++t) {
+    triangles_[t] = mesh.TriangleIndices(t);
+    for (int i = 0; i < 3; ++i) {
+      uint32_t a = triangles_[t][i];
+      uint32_t b = triangles_[t][(i + 1) % 3];
+      vertex_triangles_[a].push_back(t);
+      ++edge_use_counts[{std::min(a, b), std::max(a, b)}];
+    }
+  }
+  for (const auto& [edge, count] : edge_use_counts) {
+    if (count == 1) {
+      is_boundary_[edge.first] = true;
+      is_boundary_[edge.second] = true;
+    }
+  }
+  is_locked_ = is_boundary_;
+}
+
+void MeshSimplifier::AllowOutlineCollapse(uint32_t v, uint32_t prev,
+                                          uint32_t next,
+                                          uint32_t outline_index) {
+  ABSL_DCHECK(is_boundary_[v]);
+  is_locked_[v] = false;
+  outline_prev_[v] = prev;
+  outline_next_[v] = next;
+  outline_indices_[v] = outline_index;
+  ++outline_vertex_counts_[outline_index];
+}
+
+absl::InlinedVector<uint32_t, 8> MeshSimplifier::Neighbors(uint32_t v) const {
+  absl::InlinedVector<uint32_t, 8> neighbors;
+  for (uint32_t t : vertex_triangles_[v]) {
+    if (!is_triangle_alive_[t]) continue;
+    for (uint32_t w : triangles_[t]) {
+      if (w != v) neighbors.push_back(w);
+    }
+  }
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                  neighbors.end());
+  return neighbors;
+}
+
+bool MeshSimplifier::LabelsMatch(uint32_t u, uint32_t v) const {
+  for (uint32_t attribute_index : label_attribute_indices_) {
+    if (mesh_.FloatVertexAttribute(u, attribute_index).Values() !=
+        mesh_.FloatVertexAttribute(v, attribute_index).Values()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MeshSimplifier::CanCollapse(uint32_t u, uint32_t v) const {
+  if (!LabelsMatch(u, v)) return false;
+
+  // Count the triangles that would be removed, i.e. those that use the edge
+  // between `u` and `v`.
+  uint32_t n_shared_triangles = 0;
+  for (uint32_t t : vertex_triangles_[u]) {
+    if (!is_triangle_alive_[t]) continue;
+    const std::array<uint32_t, 3>& triangle = triangles_[t];
+    if (triangle[0] != v && triangle[1] != v && triangle[2] != v) continue;
+    ++n_shared_triangles;
+    // Don't leave the third vertex of a removed triangle without triangles.
+    for (uint32_t w : triangle) {
+      if (w == u || w == v) continue;
+      int n_alive = 0;
+      for (uint32_t w_triangle : vertex_triangles_[w]) {
+        if (is_triangle_alive_[w_triangle]) ++n_alive;
+      }
+      if (n_alive <= 1) return false;
+    }
+  }
+  if (n_shared_triangles == 0 || n_shared_triangles >= alive_triangle_count_) {
+    return false;
+  }
+
+  if (is_boundary_[u]) {
+    // Boundary vertices may only slide along their outline, which must be left
+    // with at least three vertices.
+    if (v != outline_prev_[u] && v != outline_next_[u]) return false;
+    if (n_shared_triangles != 1) return false;
+    if (outline_vertex_counts_.at(outline_indices_[u]) <= 3) return false;
+  }
+
+  // The vertices adjacent to both `u` and `v` must be exactly the third
+  // vertices of the removed triangles; otherwise the collapse would change the
+  // topology of the mesh (e.g. by pinching it).
+  absl::InlinedVector<uint32_t, 8> u_neighbors = Neighbors(u);
+  absl::InlinedVector<uint32_t, 8> v_neighbors = Neighbors(v);
+  absl::InlinedVector<uint32_t, 8> common_neighbors;
+  std::set_intersection(u_neighbors.begin(), u_neighbors.end(),
+                        v_neighbors.begin(), v_neighbors.end(),
+                        std::back_inserter(common_neighbors));
+  if (common_neighbors.size() != n_shared_triangles) return false;
+
+  // None of the remaining triangles may be flipped or made degenerate.
+  for (uint32_t t : vertex_triangles_[u]) {
+    if (!is_triangle_alive_[t]) continue;
+    std::array<uint32_t, 3> triangle = triangles_[t];
+    if (triangle[0] == v || triangle[1] == v || triangle[2] == v) continue;
+    float old_area = Triangle{positions_[triangle[0]], positions_[triangle[1]],
+                              positions_[triangle[2]]}
+                         .SignedArea();
+    for (uint32_t& w : triangle) {
+      if (w == u) w = v;
+    }
+    float new_area = Triangle{positions_[triangle[0]], positions_[triangle[1]],
+                              positions_[triangle[2]]}
+                         .SignedArea();
+    if (!(old_area > 0 && new_area > 0) && !(old_area < 0 && new_area < 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void MeshSimplifier::Collapse(uint32_t u, uint32_t v) {
+  errors_[v] = CollapsedError(u, v);
+  for (uint32_t t : vertex_triangles_[u]) {
+    if (!is_triangle_alive_[t]) continue;
+    std::array<uint32_t, 3>& triangle = triangles_[t];
+    if (triangle[0] == v || triangle[1] == v || triangle[2] == v) {
+      is_triangle_alive_[t] = false;
+      --alive_triangle_count_;
+      continue;
+    }
+    for (uint32_t& w : triangle) {
+      if (w == u) w = v;
+    }
+    vertex_triangles_[v].push_back(t);
+  }
+  vertex_triangles_[u].clear();
+  is_removed_[u] = true;
+
+  if (outline_indices_[u] != kNone) {
+    uint32_t prev = outline_prev_[u];
+    uint32_t next = outline_next_[u];
+    if (outline_next_[prev] == u) outline_next_[prev] = next;
+    if (outline_prev_[next] == u) outline_prev_[next] = prev;
+    --outline_vertex_counts_[outline_indices_[u]];
+  }
+}
+
+void MeshSimplifier::Simplify() {
+  bool collapsed_any = true;
+  while (collapsed_any) {
+    collapsed_any = false;
+    for (uint32_t u = 0; u < positions_.size(); ++u) {
+      if (is_removed_[u] || is_locked_[u]) continue;
+      // Collapse `u` into the neighbor that gives the smallest error, breaking
+      // ties by index so that the result is deterministic.
+      std::optional<uint32_t> best_v;
+      float best_error = std::numeric_limits<float>::infinity();
+      for (uint32_t v : Neighbors(u)) {
+        float error = CollapsedError(u, v);
+        if (error > max_error_ || error >= best_error) continue;
+        if (!CanCollapse(u, v)) continue;
+        best_v = v;
+        best_error = error;
+      }
+      if (best_v.has_value()) {
+        Collapse(u, *best_v);
+        collapsed_any = true;
+      }
+    }
+  }
+}
+
+absl::StatusOr<Mesh> MeshSimplifier::BuildMesh(
+    std::vector<uint32_t>& new_vertex_indices) const {
+  std::vector<bool> is_referenced(positions_.size(), false);
+  for (uint32_t t = 0; t < triangles_.size(); ++t) {
+    if (!is_triangle_alive_[t]) continue;
+    for (uint32_t v : triangles_[t]) is_referenced[v] = true;
+  }
+
+  new_vertex_indices.assign(positions_.size(), kNone);
+  uint32_t n_new_vertices = 0;
+  for (uint32_t v = 0; v < positions_.size(); ++v) {
+    if (is_referenced[v]) new_vertex_indices[v] = n_new_vertices++;
+  }
+
+  const MeshFormat& format = mesh_.Format();
+  absl::Span<const MeshFormat::Attribute> attributes = format.Attributes();
+  std::vector<std::vector<float>> components(format.TotalComponentCount());
+  for (std::vector<float>& component : components) {
+    component.reserve(n_new_vertices);
+  }
+  for (uint32_t v = 0; v < positions_.size(); ++v) {
+    if (!is_referenced[v]) continue;
+    size_t component_index = 0;
+    for (uint32_t attr_idx = 0; attr_idx < attributes.size(); ++attr_idx) {
+      for (float value : mesh_.FloatVertexAttribute(v, attr_idx).Values()) {
+        components[component_index++].push_back(value);
+      }
+    }
+  }
+  std::vector<absl::Span<const float>> component_spans(components.begin(),
+                                                       components.end());
+
+  std::vector<uint32_t> triangle_indices;
+  triangle_indices.reserve(3 * alive_triangle_count_);
+  for (uint32_t t = 0; t < triangles_.size(); ++t) {
+    if (!is_triangle_alive_[t]) continue;
+    for (uint32_t v : triangles_[t]) {
+      triangle_indices.push_back(new_vertex_indices[v]);
+    }
+  }
+
+  // Reusing the original packing params means that the surviving vertices are
+  // packed exactly as they were before.
+  std::vector<std::optional<MeshAttributeCodingParams>> packing_params(
+      attributes.size());
+  for (uint32_t attr_idx = 0; attr_idx < attributes.size(); ++attr_idx) {
+    if (!MeshFormat::IsUnpackedType(attributes[attr_idx].type)) {
+      packing_params[attr_idx] = mesh_.VertexAttributeUnpackingParams(attr_idx);
+    }
+  }
+
+  return Mesh::Create(format, component_spans, triangle_indices,
+                      packing_params);
+}
+
+// Sets up the outline-related constraints for the meshes of render group
+// `group_index` of `shape`.
+void ConfigureOutlines(const PartitionedMesh& shape, uint32_t group_index,
+                       absl::Span<MeshSimplifier> simplifiers) {
+  auto key = [](VertexIndexPair pair) {
+    return (static_cast<uint32_t>(pair.mesh_index) << 16) | pair.vertex_index;
+  };
+  absl::flat_hash_map<uint32_t, int> occurrence_counts;
+  for (uint32_t o = 0; o < shape.OutlineCount(group_index); ++o) {
+    for (VertexIndexPair pair : shape.Outline(group_index, o)) {
+      ++occurrence_counts[key(pair)];
+    }
+  }
+
+  for (uint32_t o = 0; o < shape.OutlineCount(group_index); ++o) {
+    // Outlines are closed, so the last vertex precedes the first, and the first
+    // follows the last.
+    PartitionedMesh::OutlineView outline = shape.Outline(group_index, o);
+    VertexIndexPair prev = outline.back();
+    for (auto it = outline.begin(); it != outline.end();) {
+      VertexIndexPair current = *it;
+      VertexIndexPair next = ++it == outline.end() ? outline.front() : *it;
+      MeshSimplifier& simplifier = simplifiers[current.mesh_index];
+      if (!simplifier.IsBoundaryVertex(current.vertex_index)) {
+        // Only vertices that can't be removed can be left in the outline.
+        simplifier.LockVertex(current.vertex_index);
+      } else if (occurrence_counts[key(current)] == 1 &&
+                 prev.mesh_index == current.mesh_index &&
+                 next.mesh_index == current.mesh_index) {
+        // Vertices that appear more than once, or whose outline neighbors are
+        // in a different mesh, stay locked.
+        simplifier.AllowOutlineCollapse(current.vertex_index, prev.vertex_index,
+                                        next.vertex_index, o);
+      }
+      prev = current;
+    }
+  }
+}
+
+// Locks the boundary vertices that also appear (by position) on the boundary
+// of another mesh in the same render group, so that the seams between meshes
+// don't open up.
+void LockSharedBoundaryVertices(absl::Span<MeshSimplifier> simplifiers) {
+  if (simplifiers.size() < 2) return;
+  absl::flat_hash_map<std::pair<float, float>, uint32_t> position_meshes;
+  for (uint32_t m = 0; m < simplifiers.size(); ++m) {
+    for (uint32_t v = 0; v < simplifiers[m].VertexCount(); ++v) {
+      if (!simplifiers[m].IsBoundaryVertex(v)) continue;
+      Point p = simplifiers[m].VertexPosition(v);
+      auto [it, inserted] = position_meshes.insert({{p.x, p.y}, m});
+      if (!inserted && it->second != m) it->second = kNone;
+    }
+  }
+  for (uint32_t m = 0; m < simplifiers.size(); ++m) {
+    for (uint32_t v = 0; v < simplifiers[m].VertexCount(); ++v) {
+      if (!simplifiers[m].IsBoundaryVertex(v)) continue;
+      Point p = simplifiers[m].VertexPosition(v);
+      if (position_meshes[{p.x, p.y}] == kNone) simplifiers[m].LockVertex(v);
+    }
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<PartitionedMesh> SimplifyPartitionedMesh(
+    const PartitionedMesh& shape, float max_error,
+    Executor* absl_nullable executor) {
+  if (!std::isfinite(max_error) || max_error < 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "`max_error` must be finite and non-negative, got: ", max_error));
+  }
+
+  uint32_t n_groups = shape.RenderGroupCount();
+  std::vector<std::vector<MeshSimplifier>> group_simplifiers(n_groups);
+  for (uint32_t g = 0; g < n_groups; ++g) {
+    absl::Span<const Mesh> meshes = shape.RenderGroupMeshes(g);
+    group_simplifiers[g].reserve(meshes.size());
+    for (const Mesh& mesh : meshes) {
+      group_simplifiers[g].emplace_back(mesh, max_error);
+    }
+    // The seams are locked last, since outline vertices are unlocked by
+    // `ConfigureOutlines`.
+    ConfigureOutlines(shape, g, absl::MakeSpan(group_simplifiers[g]));
+    LockSharedBoundaryVertices(absl::MakeSpan(group_simplifiers[g]));
+  }
+
+  // Each mesh is simplified and rebuilt independently.
+  std::vector<MeshSimplifier*> simplifiers;
+  for (std::vector<MeshSimplifier>& group : group_simplifiers) {
+    for (MeshSimplifier& simplifier : group) simplifiers.push_back(&simplifier);
+  }
+  std::vector<std::optional<absl::StatusOr<Mesh>>> simplified_meshes(
+      simplifiers.size());
+  std::vector<std::vector<uint32_t>> new_vertex_indices(simplifiers.size());
+  ParallelFor(executor, simplifiers.size(), [&](size_t i) {
+    simplifiers[i]->Simplify();
+    simplified_meshes[i] = simplifiers[i]->BuildMesh(new_vertex_indices[i]);
+  });
+
+  std::vector<std::vector<Mesh>> group_meshes(n_groups);
+  std::vector<std::vector<std::vector<VertexIndexPair>>> group_outlines(
+      n_groups);
+  std::vector<std::vector<absl::Span<const VertexIndexPair>>>
+      group_outline_spans(n_groups);
+  std::vector<PartitionedMesh::MeshGroup> mesh_groups(n_groups);
+  size_t first_mesh_in_group = 0;
+  for (uint32_t g = 0; g < n_groups; ++g) {
+    size_t n_meshes = group_simplifiers[g].size();
+    group_meshes[g].reserve(n_meshes);
+    for (size_t m = 0; m < n_meshes; ++m) {
+      absl::StatusOr<Mesh>& mesh = *simplified_meshes[first_mesh_in_group + m];
+      if (!mesh.ok()) return mesh.status();
+      group_meshes[g].push_back(*std::move(mesh));
+    }
+
+    for (uint32_t o = 0; o < shape.OutlineCount(g); ++o) {
+      std::vector<VertexIndexPair> outline;
+      for (VertexIndexPair pair : shape.Outline(g, o)) {
+        uint32_t new_index =
+            new_vertex_indices[first_mesh_in_group + pair.mesh_index]
+                              [pair.vertex_index];
+        if (new_index == kNone) continue;
+        outline.push_back({.mesh_index = pair.mesh_index,
+                           .vertex_index = static_cast<uint16_t>(new_index)});
+      }
+      if (!outline.empty()) group_outlines[g].push_back(std::move(outline));
+    }
+    for (const std::vector<VertexIndexPair>& outline : group_outlines[g]) {
+      group_outline_spans[g].push_back(outline);
+    }
+
+    mesh_groups[g] = {.meshes = group_meshes[g],
+                      .outlines = group_outline_spans[g]};
+    first_mesh_in_group += n_meshes;
+  }
+
+  return PartitionedMesh::FromMeshGroups(mesh_groups);
+}
+
+}  // namespace ink
@@ -0,0 +1,59 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_GEOMETRY_MESH_SIMPLIFICATION_H_
+#define INK_GEOMETRY_MESH_SIMPLIFICATION_H_
+
+#include "absl/base/nullability.h"
+#include "absl/status/statusor.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+// Returns a simplified copy of `shape` with fewer vertices and triangles, for
+// rendering at a reduced level of detail (e.g. for thumbnails, or when zoomed
+// out). This works on the meshes alone, so it can be used for shapes that can
+// no longer be regenerated from their inputs.
+//
+// Each mesh is simplified by repeatedly collapsing a vertex into one of its
+// neighbors, so every vertex of the result is a vertex of `shape`, with its
+// original attribute values. No vertex of `shape` is moved by more than
+// `max_error`, which is in the coordinate space of `shape`; to bound the error
+// on screen, divide the screen-space tolerance by the smallest scale factor of
+// the transform that the shape will be rendered with. The simplification also
+// preserves:
+// - Triangle winding: no triangle is flipped or made degenerate.
+// - Outlines: a vertex on the boundary of a mesh is only removed if it is on an
+//   outline, by collapsing it into its neighbor on that outline, and it is then
+//   removed from the outline. Boundary vertices that aren't on an outline, and
+//   vertices shared between meshes of the same render group, are kept.
+// - Anti-aliasing labels: a vertex is only collapsed into a neighbor with the
+//   same values for the `kSideLabel` and `kForwardLabel` attributes (if
+//   present). Other attributes are not compared, and take the values of the
+//   surviving vertex.
+//
+// The render groups, mesh formats and packing params of `shape` are kept. If
+// `executor` is non-null, it is used to simplify the meshes concurrently; the
+// result is the same either way.
+//
+// Returns an error if `max_error` is negative or non-finite.
+absl::StatusOr<PartitionedMesh> SimplifyPartitionedMesh(
+    const PartitionedMesh& shape, float max_error,
+    Executor* absl_nullable executor = nullptr);
+
+}  // namespace ink
+
+#endif  // INK_GEOMETRY_MESH_SIMPLIFICATION_H_
@@ -0,0 +1,279 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/mesh_simplification.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mesh_format.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/triangle.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Lt;
+
+MeshFormat MakePositionAndSideLabelFormat() {
+  absl::StatusOr<MeshFormat> format = MeshFormat::Create(
+      {{MeshFormat::AttributeType::kFloat2Unpacked,
+        MeshFormat::AttributeId::kPosition},
+       {MeshFormat::AttributeType::kFloat1Unpacked,
+        MeshFormat::AttributeId::kSideLabel}},
+      MeshFormat::IndexFormat::k32BitUnpacked16BitPacked);
+  ABSL_CHECK_OK(format);
+  return *format;
+}
+
+// Returns an `n` by `n` grid of unit squares, each split into two
+// counter-clockwise triangles, with its lower-left corner at the origin. Vertex
+// (i, j) is at index j * (n + 1) + i. The side label of every vertex is
+// `label_fn(vertex_index)`.
+MutableMesh MakeGridMutableMesh(uint32_t n,
+                                float (*label_fn)(uint32_t) = nullptr) {
+  MutableMesh mesh(MakePositionAndSideLabelFormat());
+  for (uint32_t j = 0; j <= n; ++j) {
+    for (uint32_t i = 0; i <= n; ++i) {
+      uint32_t v = mesh.VertexCount();
+      mesh.AppendVertex({static_cast<float>(i), static_cast<float>(j)});
+      mesh.SetFloatVertexAttribute(v, 1, {label_fn ? label_fn(v) : 0.f});
+    }
+  }
+  for (uint32_t j = 0; j < n; ++j) {
+    for (uint32_t i = 0; i < n; ++i) {
+      uint32_t v00 = j * (n + 1) + i;
+      uint32_t v10 = v00 + 1;
+      uint32_t v01 = v00 + n + 1;
+      uint32_t v11 = v01 + 1;
+      mesh.AppendTriangleIndices({v00, v10, v11});
+      mesh.AppendTriangleIndices({v00, v11, v01});
+    }
+  }
+  return mesh;
+}
+
+// Returns the vertex indices of the perimeter of the grid returned by
+// `MakeGridMutableMesh(n)`, counter-clockwise from the origin.
+std::vector<uint32_t> GridPerimeter(uint32_t n) {
+  std::vector<uint32_t> perimeter;
+  for (uint32_t i = 0; i < n; ++i) perimeter.push_back(i);
+  for (uint32_t j = 0; j < n; ++j) perimeter.push_back(j * (n + 1) + n);
+  for (uint32_t i = n; i > 0; --i) perimeter.push_back(n * (n + 1) + i);
+  for (uint32_t j = n; j > 0; --j) perimeter.push_back(j * (n + 1));
+  return perimeter;
+}
+
+uint32_t TotalVertexCount(const PartitionedMesh& shape) {
+  uint32_t count = 0;
+  for (const Mesh& mesh : shape.Meshes()) count += mesh.VertexCount();
+  return count;
+}
+
+uint32_t TotalTriangleCount(const PartitionedMesh& shape) {
+  uint32_t count = 0;
+  for (const Mesh& mesh : shape.Meshes()) count += mesh.TriangleCount();
+  return count;
+}
+
+TEST(MeshSimplificationTest, InvalidMaxError) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(4);
+  EXPECT_THAT(SimplifyPartitionedMesh(shape, -1).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("max_error")));
+  EXPECT_THAT(SimplifyPartitionedMesh(
+                  shape, std::numeric_limits<float>::infinity())
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("max_error")));
+  EXPECT_THAT(
+      SimplifyPartitionedMesh(shape, std::numeric_limits<float>::quiet_NaN())
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument, HasSubstr("max_error")));
+}
+
+TEST(MeshSimplificationTest, ZeroMaxErrorKeepsEveryVertex) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(10);
+
+  absl::StatusOr<PartitionedMesh> simplified =
+      SimplifyPartitionedMesh(shape, 0);
+  ASSERT_THAT(simplified, IsOk());
+
+  EXPECT_EQ(TotalVertexCount(*simplified), TotalVertexCount(shape));
+  EXPECT_EQ(TotalTriangleCount(*simplified), TotalTriangleCount(shape));
+}
+
+TEST(MeshSimplificationTest, SimplifiesGridAlongOutline) {
+  constexpr uint32_t kN = 20;
+  constexpr float kMaxError = 3;
+  std::vector<uint32_t> perimeter = GridPerimeter(kN);
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(MakeGridMutableMesh(kN), {perimeter});
+  ASSERT_THAT(shape, IsOk());
+
+  absl::StatusOr<PartitionedMesh> simplified =
+      SimplifyPartitionedMesh(*shape, kMaxError);
+  ASSERT_THAT(simplified, IsOk());
+
+  EXPECT_THAT(TotalTriangleCount(*simplified),
+              Lt(TotalTriangleCount(*shape) / 2));
+  ASSERT_EQ(simplified->RenderGroupCount(), 1);
+  EXPECT_EQ(simplified->RenderGroupFormat(0), shape->RenderGroupFormat(0));
+
+  // Every vertex of the result is a grid point, and each triangle keeps its
+  // counter-clockwise winding.
+  absl::flat_hash_set<std::pair<float, float>> output_positions;
+  for (const Mesh& mesh : simplified->Meshes()) {
+    for (uint32_t v = 0; v < mesh.VertexCount(); ++v) {
+      Point p = mesh.VertexPosition(v);
+      EXPECT_EQ(p.x, std::round(p.x));
+      EXPECT_EQ(p.y, std::round(p.y));
+      output_positions.insert({p.x, p.y});
+    }
+    for (uint32_t t = 0; t < mesh.TriangleCount(); ++t) {
+      EXPECT_GT(mesh.GetTriangle(t).SignedArea(), 0);
+    }
+  }
+
+  // Every vertex of the original grid is within `kMaxError` of the result.
+  for (const Mesh& mesh : shape->Meshes()) {
+    for (uint32_t v = 0; v < mesh.VertexCount(); ++v) {
+      Point p = mesh.VertexPosition(v);
+      float min_distance = std::numeric_limits<float>::infinity();
+      for (const auto& [x, y] : output_positions) {
+        min_distance = std::min(min_distance, std::hypot(p.x - x, p.y - y));
+      }
+      EXPECT_LE(min_distance, kMaxError);
+    }
+  }
+
+  // The outline has lost some vertices, but still follows the perimeter.
+  ASSERT_EQ(simplified->OutlineCount(0), 1);
+  uint32_t outline_vertex_count = simplified->OutlineVertexCount(0, 0);
+  EXPECT_GE(outline_vertex_count, 3);
+  EXPECT_LT(outline_vertex_count, perimeter.size());
+  for (uint32_t i = 0; i < outline_vertex_count; ++i) {
+    Point p = simplified->OutlinePosition(0, 0, i);
+    EXPECT_TRUE(p.x == 0 || p.x == kN || p.y == 0 || p.y == kN)
+        << "outline position (" << p.x << ", " << p.y << ")";
+  }
+}
+
+TEST(MeshSimplificationTest, KeepsBoundaryVerticesThatAreNotOnAnOutline) {
+  constexpr uint32_t kN = 10;
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(MakeGridMutableMesh(kN));
+  ASSERT_THAT(shape, IsOk());
+
+  absl::StatusOr<PartitionedMesh> simplified =
+      SimplifyPartitionedMesh(*shape, 3);
+  ASSERT_THAT(simplified, IsOk());
+
+  EXPECT_THAT(TotalTriangleCount(*simplified), Lt(TotalTriangleCount(*shape)));
+  absl::flat_hash_set<std::pair<float, float>> output_positions;
+  for (const Mesh& mesh : simplified->Meshes()) {
+    for (uint32_t v = 0; v < mesh.VertexCount(); ++v) {
+      Point p = mesh.VertexPosition(v);
+      output_positions.insert({p.x, p.y});
+    }
+  }
+  for (uint32_t i = 0; i <= kN; ++i) {
+    float f = i;
+    EXPECT_TRUE(output_positions.contains({f, 0}));
+    EXPECT_TRUE(output_positions.contains({f, kN}));
+    EXPECT_TRUE(output_positions.contains({0, f}));
+    EXPECT_TRUE(output_positions.contains({kN, f}));
+  }
+}
+
+TEST(MeshSimplificationTest, DoesNotCollapseVerticesWithDifferentLabels) {
+  constexpr uint32_t kN = 10;
+  absl::StatusOr<PartitionedMesh> shape = PartitionedMesh::FromMutableMesh(
+      MakeGridMutableMesh(kN,
+                          [](uint32_t v) { return static_cast<float>(v); }),
+      {GridPerimeter(kN)});
+  ASSERT_THAT(shape, IsOk());
+
+  absl::StatusOr<PartitionedMesh> simplified =
+      SimplifyPartitionedMesh(*shape, 3);
+  ASSERT_THAT(simplified, IsOk());
+
+  EXPECT_EQ(TotalVertexCount(*simplified), TotalVertexCount(*shape));
+  EXPECT_EQ(TotalTriangleCount(*simplified), TotalTriangleCount(*shape));
+  EXPECT_EQ(simplified->OutlineVertexCount(0, 0),
+            shape->OutlineVertexCount(0, 0));
+}
+
+TEST(MeshSimplificationTest, ExecutorGivesTheSameResult) {
+  constexpr uint32_t kN = 12;
+  MutableMesh grid = MakeGridMutableMesh(kN);
+  std::vector<uint32_t> perimeter = GridPerimeter(kN);
+  std::vector<absl::Span<const uint32_t>> outlines = {perimeter};
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMeshGroups({
+          {.mesh = &grid, .outlines = outlines},
+          {.mesh = &grid, .outlines = outlines},
+      });
+  ASSERT_THAT(shape, IsOk());
+
+  absl::StatusOr<PartitionedMesh> expected =
+      SimplifyPartitionedMesh(*shape, 2.5);
+  ASSERT_THAT(expected, IsOk());
+  ThreadPerTaskExecutor executor;
+  absl::StatusOr<PartitionedMesh> actual =
+      SimplifyPartitionedMesh(*shape, 2.5, &executor);
+  ASSERT_THAT(actual, IsOk());
+
+  ASSERT_EQ(actual->Meshes().size(), expected->Meshes().size());
+  for (size_t m = 0; m < actual->Meshes().size(); ++m) {
+    const Mesh& actual_mesh = actual->Meshes()[m];
+    const Mesh& expected_mesh = expected->Meshes()[m];
+    ASSERT_EQ(actual_mesh.VertexCount(), expected_mesh.VertexCount());
+    ASSERT_EQ(actual_mesh.TriangleCount(), expected_mesh.TriangleCount());
+    for (uint32_t v = 0; v < actual_mesh.VertexCount(); ++v) {
+      EXPECT_EQ(actual_mesh.VertexPosition(v), expected_mesh.VertexPosition(v));
+    }
+    for (uint32_t t = 0; t < actual_mesh.TriangleCount(); ++t) {
+      EXPECT_EQ(actual_mesh.TriangleIndices(t),
+                expected_mesh.TriangleIndices(t));
+    }
+  }
+  EXPECT_EQ(actual->OutlineVertexCount(1, 0),
+            expected->OutlineVertexCount(1, 0));
+}
+
+}  // namespace
+}  // namespace ink
@@ -24,16 +24,21 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/base/nullability.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/internal/mesh_packing.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mesh_packing_types.h"
 #include "ink/geometry/mesh_test_helpers.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/rect.h"
+#include "ink/geometry/triangle.h"
 #include "ink/geometry/type_matchers.h"
+#include "ink/types/allocator.h"
+#include "ink/types/memory_footprint.h"
 
 namespace ink {
 namespace {
@@ -875,6 +880,225 @@ TEST(MeshTest, CloneNonEmptyMesh) {
               ElementsAreArray(original->TriangleIndices(0)));
 }
 
+// An `Allocator` that forwards to `DefaultAllocator()`, and counts the
+// allocations that are currently live.
+class CountingAllocator : public Allocator {
+ public:
+  void* absl_nonnull Allocate(size_t bytes, size_t alignment) override {
+    ++live_allocations_;
+    return DefaultAllocator().Allocate(bytes, alignment);
+  }
+  void Deallocate(void* absl_nonnull ptr, size_t bytes,
+                  size_t alignment) override {
+    --live_allocations_;
+    DefaultAllocator().Deallocate(ptr, bytes, alignment);
+  }
+
+  int LiveAllocations() const { return live_allocations_; }
+
+ private:
+  int live_allocations_ = 0;
+};
+
+TEST(MeshTest, CreateMakesASingleAllocationFromAllocator) {
+  CountingAllocator allocator;
+  {
+    absl::StatusOr<Mesh> mesh =
+        Mesh::Create(MeshFormat(), {{0, 1, 0, 1}, {0, 0, 1, 1}},
+                     {0, 1, 2, 1, 3, 2}, {}, &allocator);
+    ASSERT_EQ(mesh.status(), absl::OkStatus());
+    EXPECT_EQ(allocator.LiveAllocations(), 1);
+
+    Mesh copy = *mesh;
+    EXPECT_EQ(allocator.LiveAllocations(), 1);
+    EXPECT_THAT(copy.VertexPosition(3), PointEq({1, 1}));
+    EXPECT_THAT(copy.TriangleIndices(1), ElementsAre(1, 3, 2));
+  }
+  EXPECT_EQ(allocator.LiveAllocations(), 0);
+}
+
+TEST(MeshTest, CreateWithArenaAllocator) {
+  ArenaAllocator arena;
+  absl::StatusOr<Mesh> mesh =
+      Mesh::Create(MeshFormat(), {{0, 1, 0, 1}, {0, 0, 1, 1}},
+                   {0, 1, 2, 1, 3, 2}, {}, &arena);
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  EXPECT_GT(arena.ReservedBytes(), 0u);
+
+  EXPECT_EQ(mesh->VertexCount(), 4u);
+  EXPECT_EQ(mesh->TriangleCount(), 2u);
+  EXPECT_THAT(mesh->VertexPosition(0), PointEq({0, 0}));
+  EXPECT_THAT(mesh->VertexPosition(1), PointEq({1, 0}));
+  EXPECT_THAT(mesh->VertexPosition(2), PointEq({0, 1}));
+  EXPECT_THAT(mesh->VertexPosition(3), PointEq({1, 1}));
+  EXPECT_THAT(mesh->TriangleIndices(0), ElementsAre(0, 1, 2));
+  EXPECT_THAT(mesh->TriangleIndices(1), ElementsAre(1, 3, 2));
+}
+
+TEST(MeshTest, CreateEmptyMeshWithAllocator) {
+  CountingAllocator allocator;
+  {
+    absl::StatusOr<Mesh> mesh =
+        Mesh::Create(MeshFormat(), {{}, {}}, {}, {}, &allocator);
+    ASSERT_EQ(mesh.status(), absl::OkStatus());
+    EXPECT_EQ(mesh->VertexCount(), 0u);
+    EXPECT_TRUE(mesh->RawVertexData().empty());
+    EXPECT_TRUE(mesh->RawIndexData().empty());
+    EXPECT_EQ(allocator.LiveAllocations(), 1);
+  }
+  EXPECT_EQ(allocator.LiveAllocations(), 0);
+}
+
+TEST(MeshTest, UnpackVertexAttributeMatchesFloatVertexAttribute) {
+  absl::StatusOr<MeshFormat> format =
+      MeshFormat::Create({{MeshFormat::AttributeType::kFloat3PackedInTwoFloats,
+                           MeshFormat::AttributeId::kCustom0},
+                          {MeshFormat::AttributeType::kFloat4PackedInOneFloat,
+                           MeshFormat::AttributeId::kColorShiftHsl},
+                          {MeshFormat::AttributeType::kFloat2PackedInOneFloat,
+                           MeshFormat::AttributeId::kPosition}},
+                         MeshFormat::IndexFormat::k32BitUnpacked16BitPacked);
+  ASSERT_EQ(format.status(), absl::OkStatus());
+  absl::StatusOr<Mesh> mesh = Mesh::Create(*format,
+                                           {{-200, 100, 500},
+                                            {4, 5, 6},
+                                            {.1, 25, -5},
+                                            {0, .5, 1},
+                                            {.9, .5, .1},
+                                            {.5, 1, .5},
+                                            {1, 1, 1},
+                                            {17, -12, 5},
+                                            {123, 456, 789}},
+                                           {0, 1, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+
+  for (uint32_t attribute_index = 0; attribute_index < 3; ++attribute_index) {
+    SCOPED_TRACE(attribute_index);
+    std::vector<float> expected;
+    for (uint32_t i = 0; i < mesh->VertexCount(); ++i) {
+      for (float value :
+           mesh->FloatVertexAttribute(i, attribute_index).Values()) {
+        expected.push_back(value);
+      }
+    }
+    std::vector<float> unpacked(expected.size());
+    mesh->UnpackVertexAttribute(attribute_index, absl::MakeSpan(unpacked));
+    EXPECT_THAT(unpacked, ElementsAreArray(expected));
+  }
+}
+
+TEST(MeshTest, UnpackVertexPositionsMatchesVertexPosition) {
+  absl::StatusOr<Mesh> mesh = Mesh::Create(
+      MakeSinglePackedPositionFormat(),
+      {{0, 1.3, -7.1, 12.5}, {0.2, 4, 1.7, -3}}, {0, 1, 2, 1, 3, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  std::vector<Point> expected;
+  for (uint32_t i = 0; i < mesh->VertexCount(); ++i) {
+    expected.push_back(mesh->VertexPosition(i));
+  }
+
+  std::vector<Point> uncached(mesh->VertexCount());
+  mesh->UnpackVertexPositions(absl::MakeSpan(uncached));
+  EXPECT_THAT(uncached, ElementsAreArray(expected));
+
+  mesh->InitializePositionCache();
+  std::vector<Point> cached(mesh->VertexCount());
+  mesh->UnpackVertexPositions(absl::MakeSpan(cached));
+  EXPECT_THAT(cached, ElementsAreArray(expected));
+}
+
+TEST(MeshTest, PositionCacheMatchesUnpackedPositions) {
+  absl::StatusOr<Mesh> mesh = Mesh::Create(
+      MakeSinglePackedPositionFormat(),
+      {{0, 1.3, -7.1, 12.5}, {0.2, 4, 1.7, -3}}, {0, 1, 2, 1, 3, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  std::vector<Point> uncached_positions;
+  for (uint32_t i = 0; i < mesh->VertexCount(); ++i) {
+    uncached_positions.push_back(mesh->VertexPosition(i));
+  }
+  Triangle uncached_triangle = mesh->GetTriangle(1);
+  EXPECT_FALSE(mesh->IsPositionCacheInitialized());
+
+  mesh->InitializePositionCache();
+
+  EXPECT_TRUE(mesh->IsPositionCacheInitialized());
+  for (uint32_t i = 0; i < mesh->VertexCount(); ++i) {
+    // The cached positions are bit-for-bit the same as the unpacked ones.
+    EXPECT_EQ(mesh->VertexPosition(i).x, uncached_positions[i].x);
+    EXPECT_EQ(mesh->VertexPosition(i).y, uncached_positions[i].y);
+  }
+  EXPECT_THAT(mesh->GetTriangle(1), TriangleEq(uncached_triangle));
+}
+
+TEST(MeshTest, PositionCacheIsSharedBetweenCopies) {
+  absl::StatusOr<Mesh> mesh =
+      Mesh::Create(MeshFormat(), {{0, 1, 0}, {0, 0, 1}}, {0, 1, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  Mesh copy = *mesh;
+
+  copy.InitializePositionCache();
+
+  EXPECT_TRUE(mesh->IsPositionCacheInitialized());
+  EXPECT_TRUE(copy.IsPositionCacheInitialized());
+}
+
+TEST(MeshTest, PositionCacheIsCountedInMemoryFootprint) {
+  absl::StatusOr<Mesh> mesh =
+      Mesh::Create(MeshFormat(), {{0, 1, 0}, {0, 0, 1}}, {0, 1, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  MemoryFootprint uncached_footprint;
+  mesh->AddToMemoryFootprint(uncached_footprint);
+
+  mesh->InitializePositionCache();
+
+  MemoryFootprint cached_footprint;
+  mesh->AddToMemoryFootprint(cached_footprint);
+  EXPECT_EQ(cached_footprint.TotalBytes(),
+            uncached_footprint.TotalBytes() + 3 * sizeof(Point));
+}
+
+TEST(MeshTest, PositionCacheUsesMeshAllocator) {
+  CountingAllocator allocator;
+  {
+    absl::StatusOr<Mesh> mesh = Mesh::Create(
+        MeshFormat(), {{0, 1, 0}, {0, 0, 1}}, {0, 1, 2}, {}, &allocator);
+    ASSERT_EQ(mesh.status(), absl::OkStatus());
+    mesh->InitializePositionCache();
+    mesh->InitializePositionCache();
+    EXPECT_EQ(allocator.LiveAllocations(), 2);
+  }
+  EXPECT_EQ(allocator.LiveAllocations(), 0);
+}
+
+TEST(MeshTest, InitializePositionCacheOnEmptyMeshIsANoOp) {
+  Mesh mesh;
+  mesh.InitializePositionCache();
+  EXPECT_FALSE(mesh.IsPositionCacheInitialized());
+}
+
+TEST(MeshTest, PackedIntegerTrianglesMatchTransformedPositions) {
+  absl::StatusOr<Mesh> mesh = Mesh::Create(
+      MakeSinglePackedPositionFormat(),
+      {{0, 1.3, -7.1, 12.5}, {0.2, 4, 1.7, -3}}, {0, 1, 2, 1, 3, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  EXPECT_TRUE(mesh->HasPackedIntegerPositions());
+  std::optional<AffineTransform> to_packed =
+      mesh->PositionToPackedIntegerTransform();
+  ASSERT_TRUE(to_packed.has_value());
+  for (uint32_t i = 0; i < mesh->TriangleCount(); ++i) {
+    EXPECT_THAT(mesh->GetPackedIntegerTriangle(i),
+                TriangleNear(to_packed->Apply(mesh->GetTriangle(i)), 1e-2));
+  }
+}
+
+TEST(MeshTest, UnpackedPositionsHaveNoPackedIntegerTransform) {
+  absl::StatusOr<Mesh> mesh =
+      Mesh::Create(MeshFormat(), {{0, 1, 0}, {0, 0, 1}}, {0, 1, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  EXPECT_FALSE(mesh->HasPackedIntegerPositions());
+  EXPECT_EQ(mesh->PositionToPackedIntegerTransform(), std::nullopt);
+}
+
 TEST(MeshDeathTest, VertexIndexOutOfBounds) {
   // There is no EXPECT_DEBUG_DEATH_IF_SUPPORTED, so we only run these when
   // compiled in debug mode.
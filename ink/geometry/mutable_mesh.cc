@@ -32,13 +32,16 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/envelope.h"
+#include "ink/geometry/internal/mesh_constants.h"
 #include "ink/geometry/internal/mesh_packing.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
@@ -47,6 +50,8 @@
 #include "ink/geometry/rect.h"
 #include "ink/geometry/triangle.h"
 #include "ink/geometry/vec.h"
+#include "ink/types/allocator.h"
+#include "ink/types/executor.h"
 #include "ink/types/internal/float.h"
 #include "ink/types/small_array.h"
 
@@ -106,6 +111,8 @@ void MutableMesh::SetFloatVertexAttribute(uint32_t vertex_index,
     case MeshFormat::AttributeType::kFloat2PackedInOneFloat:
     case MeshFormat::AttributeType::kFloat2PackedInThreeUnsignedBytes_XY12:
     case MeshFormat::AttributeType::kFloat2PackedInFourUnsignedBytes_X12_Y20:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
       std::memcpy(dst, src, 2 * sizeof(float));
       break;
     case MeshFormat::AttributeType::kFloat3Unpacked:
@@ -118,11 +125,46 @@ void MutableMesh::SetFloatVertexAttribute(uint32_t vertex_index,
     case MeshFormat::AttributeType::kFloat4PackedInOneFloat:
     case MeshFormat::AttributeType::kFloat4PackedInTwoFloats:
     case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
       std::memcpy(dst, src, 4 * sizeof(float));
       break;
   }
 }
 
+void MutableMesh::TransformVertexPositions(const AffineTransform& transform) {
+  const size_t stride = VertexStride();
+  const size_t position_offset =
+      format_.Attributes()[VertexPositionAttributeIndex()].unpacked_offset;
+  // The positions are gathered into a local buffer in chunks, so that they can
+  // be transformed together regardless of what other attributes they are
+  // interleaved with.
+  constexpr uint32_t kChunkSize = 256;
+  std::array<Point, kChunkSize> positions;
+  for (uint32_t chunk_start = 0; chunk_start < vertex_count_;
+       chunk_start += kChunkSize) {
+    const uint32_t chunk_size =
+        std::min(kChunkSize, vertex_count_ - chunk_start);
+    std::byte* chunk_data =
+        vertex_data_.data() + chunk_start * stride + position_offset;
+    if (stride == sizeof(Point)) {
+      std::memcpy(positions.data(), chunk_data, chunk_size * sizeof(Point));
+    } else {
+      for (uint32_t i = 0; i < chunk_size; ++i) {
+        std::memcpy(&positions[i], chunk_data + i * stride, sizeof(Point));
+      }
+    }
+    transform.ApplyInPlace(absl::MakeSpan(positions.data(), chunk_size));
+    if (stride == sizeof(Point)) {
+      std::memcpy(chunk_data, positions.data(), chunk_size * sizeof(Point));
+    } else {
+      for (uint32_t i = 0; i < chunk_size; ++i) {
+        std::memcpy(chunk_data + i * stride, &positions[i], sizeof(Point));
+      }
+    }
+  }
+}
+
 absl::Status MutableMesh::ValidateTriangles() const {
   uint32_t n_triangles = TriangleCount();
   uint32_t n_vertices = VertexCount();
@@ -146,42 +188,102 @@ absl::Status MutableMesh::ValidateTriangles() const {
 
 namespace {
 
-mesh_internal::AttributeBoundsArray ComputeAttributeBoundsForPartition(
-    const MutableMesh& mesh, const mesh_internal::PartitionInfo& partition,
+using ::ink::mesh_internal::kMaxVertexAttributes;
+
+// The location of each float component of the attributes that are being
+// packed, so that they can be read directly from the vertex data without
+// looking up the format or the omitted attributes for each vertex.
+struct PackedComponentLayout {
+  // Indices (in the original format) of the attributes being packed, in order.
+  absl::InlinedVector<uint32_t, kMaxVertexAttributes> attribute_indices;
+  // The number of components of each of the attributes in
+  // `attribute_indices`.
+  absl::InlinedVector<uint8_t, kMaxVertexAttributes> component_counts;
+  // The byte offset within an unpacked vertex of each component of each of the
+  // attributes in `attribute_indices`, in order.
+  absl::InlinedVector<size_t, 4 * kMaxVertexAttributes> component_offsets;
+};
+
+PackedComponentLayout ComputePackedComponentLayout(
+    const MeshFormat& format,
     const absl::flat_hash_set<MeshFormat::AttributeId>& omit_set) {
-  constexpr float kInf = std::numeric_limits<float>::infinity();
-
-  ABSL_CHECK_GE(partition.vertex_indices.size(), 0u);
-  absl::Span<const MeshFormat::Attribute> old_attributes =
-      mesh.Format().Attributes();
-  size_t n_old_attrs = old_attributes.size();
-  ABSL_CHECK_GT(n_old_attrs, omit_set.size());
-  int n_new_attrs = n_old_attrs - omit_set.size();
-  mesh_internal::AttributeBoundsArray bounds_array(n_new_attrs);
-  for (size_t old_attr_idx = 0, new_attr_idx = 0; old_attr_idx < n_old_attrs;
-       ++old_attr_idx) {
-    MeshFormat::Attribute attribute = old_attributes[old_attr_idx];
+  PackedComponentLayout layout;
+  absl::Span<const MeshFormat::Attribute> attributes = format.Attributes();
+  for (uint32_t attr_idx = 0; attr_idx < attributes.size(); ++attr_idx) {
+    MeshFormat::Attribute attribute = attributes[attr_idx];
     if (omit_set.contains(attribute.id)) continue;
-    int n_components = MeshFormat::ComponentCount(attribute.type);
-    MeshAttributeBounds& bounds = bounds_array[new_attr_idx];
-    bounds.minimum = SmallArray<float, 4>(n_components, kInf);
-    bounds.maximum = SmallArray<float, 4>(n_components, -kInf);
-    for (uint32_t vertex_idx : partition.vertex_indices) {
-      SmallArray<float, 4> value =
-          mesh.FloatVertexAttribute(vertex_idx, old_attr_idx);
-      for (int component_idx = 0; component_idx < n_components;
-           ++component_idx) {
-        bounds.minimum[component_idx] =
-            std::min(value[component_idx], bounds.minimum[component_idx]);
-        bounds.maximum[component_idx] =
-            std::max(value[component_idx], bounds.maximum[component_idx]);
-      }
+    uint8_t n_components = MeshFormat::ComponentCount(attribute.type);
+    layout.attribute_indices.push_back(attr_idx);
+    layout.component_counts.push_back(n_components);
+    for (uint8_t component_idx = 0; component_idx < n_components;
+         ++component_idx) {
+      layout.component_offsets.push_back(attribute.unpacked_offset +
+                                         component_idx * sizeof(float));
     }
-    ++new_attr_idx;
+  }
+  return layout;
+}
+
+// Running per-component bounds over a set of vertices, for each component in a
+// `PackedComponentLayout`.
+struct ComponentBounds {
+  explicit ComponentBounds(size_t n_components)
+      : minimum(n_components, std::numeric_limits<float>::infinity()),
+        maximum(n_components, -std::numeric_limits<float>::infinity()) {}
+
+  absl::InlinedVector<float, 4 * kMaxVertexAttributes> minimum;
+  absl::InlinedVector<float, 4 * kMaxVertexAttributes> maximum;
+};
+
+// Expands `bounds` to include the components of the vertex whose unpacked data
+// starts at `vertex_data`, and returns false if any of them are non-finite.
+bool ExpandComponentBounds(const std::byte* vertex_data,
+                           absl::Span<const size_t> component_offsets,
+                           ComponentBounds& bounds) {
+  bool all_finite = true;
+  for (size_t i = 0; i < component_offsets.size(); ++i) {
+    float value;
+    std::memcpy(&value, vertex_data + component_offsets[i], sizeof(float));
+    all_finite &= ink_internal::IsFinite(value);
+    bounds.minimum[i] = std::min(value, bounds.minimum[i]);
+    bounds.maximum[i] = std::max(value, bounds.maximum[i]);
+  }
+  return all_finite;
+}
+
+mesh_internal::AttributeBoundsArray ToAttributeBoundsArray(
+    const PackedComponentLayout& layout, const ComponentBounds& bounds) {
+  mesh_internal::AttributeBoundsArray bounds_array(
+      layout.attribute_indices.size());
+  size_t component_idx = 0;
+  for (size_t attr_idx = 0; attr_idx < layout.attribute_indices.size();
+       ++attr_idx) {
+    absl::Span<const float> minimum =
+        absl::MakeConstSpan(bounds.minimum)
+            .subspan(component_idx, layout.component_counts[attr_idx]);
+    absl::Span<const float> maximum =
+        absl::MakeConstSpan(bounds.maximum)
+            .subspan(component_idx, layout.component_counts[attr_idx]);
+    bounds_array[attr_idx].minimum = SmallArray<float, 4>(minimum);
+    bounds_array[attr_idx].maximum = SmallArray<float, 4>(maximum);
+    component_idx += layout.component_counts[attr_idx];
   }
   return bounds_array;
 }
 
+mesh_internal::AttributeBoundsArray ComputeAttributeBoundsForPartition(
+    const MutableMesh& mesh, const mesh_internal::PartitionInfo& partition,
+    const PackedComponentLayout& layout) {
+  ComponentBounds bounds(layout.component_offsets.size());
+  absl::Span<const std::byte> vertex_data = mesh.RawVertexData();
+  size_t stride = mesh.VertexStride();
+  for (uint32_t vertex_idx : partition.vertex_indices) {
+    ExpandComponentBounds(vertex_data.data() + vertex_idx * stride,
+                          layout.component_offsets, bounds);
+  }
+  return ToAttributeBoundsArray(layout, bounds);
+}
+
 mesh_internal::AttributeBoundsArray ComputeTotalAttributeBounds(
     absl::Span<const mesh_internal::AttributeBoundsArray>
         partition_attribute_bounds) {
@@ -270,6 +372,9 @@ struct FlippedTriangleCorrectionData {
   // packing params outlive this.
   const MutableMesh* absl_nonnull mesh;
   const MeshAttributeCodingParams* absl_nonnull packing_params;
+  // If non-empty, the vertex that each vertex index in the mesh's triangles is
+  // replaced with; see `MutableMesh::ComputeVertexWeldMap`.
+  absl::Span<const uint32_t> vertex_map;
   // The vertex positions of the mesh, rescaled to the range [0, 2^n_bits - 1]
   // and rounded to the nearest integer.
   std::vector<Point> quantized_vertex_positions;
@@ -286,6 +391,17 @@ struct FlippedTriangleCorrectionData {
   absl::flat_hash_map<uint32_t, Point> corrected_vertices;
 };
 
+// Returns the vertex indices of the given triangle of the mesh, after applying
+// `data.vertex_map`.
+std::array<uint32_t, 3> MappedTriangleIndices(
+    const FlippedTriangleCorrectionData& data, uint32_t tri_idx) {
+  std::array<uint32_t, 3> indices = data.mesh->TriangleIndices(tri_idx);
+  if (!data.vertex_map.empty()) {
+    for (uint32_t& index : indices) index = data.vertex_map[index];
+  }
+  return indices;
+}
+
 Point QuantizePoint(Point p, const MeshAttributeCodingParams& packing_params) {
   auto quantize = [](MeshAttributeCodingParams::ComponentCodingParams params,
                      float value) {
@@ -310,7 +426,7 @@ void PopulateFlippedTris(FlippedTriangleCorrectionData& data) {
   uint32_t n_triangles = data.mesh->TriangleCount();
   data.tri_flip_states.resize(n_triangles);
   for (uint32_t i = 0; i < n_triangles; ++i) {
-    std::array<uint32_t, 3> indices = data.mesh->TriangleIndices(i);
+    std::array<uint32_t, 3> indices = MappedTriangleIndices(data, i);
     Triangle t{data.quantized_vertex_positions[indices[0]],
                data.quantized_vertex_positions[indices[1]],
                data.quantized_vertex_positions[indices[2]]};
@@ -332,7 +448,7 @@ void PopulateAdjacentTriangleMap(FlippedTriangleCorrectionData& data) {
   std::vector<absl::InlinedVector<uint32_t, 3>> vertex_to_tris;
   vertex_to_tris.resize(n_vertices);
   for (uint32_t tri_idx = 0; tri_idx < n_triangles; ++tri_idx) {
-    for (uint32_t vtx_idx : data.mesh->TriangleIndices(tri_idx)) {
+    for (uint32_t vtx_idx : MappedTriangleIndices(data, tri_idx)) {
       vertex_to_tris[vtx_idx].push_back(tri_idx);
     }
   }
@@ -340,7 +456,7 @@ void PopulateAdjacentTriangleMap(FlippedTriangleCorrectionData& data) {
   for (uint32_t tri_idx = 0; tri_idx < n_triangles; ++tri_idx) {
     auto inserter = std::inserter(data.adjacent_triangles[tri_idx],
                                   data.adjacent_triangles[tri_idx].end());
-    for (uint32_t vtx_idx : data.mesh->TriangleIndices(tri_idx)) {
+    for (uint32_t vtx_idx : MappedTriangleIndices(data, tri_idx)) {
       absl::c_copy(vertex_to_tris[vtx_idx], inserter);
     }
 
@@ -514,7 +630,7 @@ std::optional<NudgeCandidate> MaybeMakeNudgeCandidate(
   NudgeCandidate candidate{.bitmask = nudge_bitmask};
   for (uint32_t adj_tri_idx : data.adjacent_triangles[tri_idx]) {
     std::array<uint32_t, 3> adj_indices =
-        data.mesh->TriangleIndices(adj_tri_idx);
+        MappedTriangleIndices(data, adj_tri_idx);
     std::optional<Point> corrected_p0 = maybe_get_nudged_vertex(adj_indices[0]);
     std::optional<Point> corrected_p1 = maybe_get_nudged_vertex(adj_indices[1]);
     std::optional<Point> corrected_p2 = maybe_get_nudged_vertex(adj_indices[2]);
@@ -593,14 +709,17 @@ void RecordCorrectionAndAddNewFlippedTrisToQueue(
 // Returns a map from vertex indices to positions for those vertices that need
 // be changed to preserve triangle winding post-quantization. In the event that
 // no correction can be found, this will return an empty map, allowing
-// `MutableMesh::AsMeshes` to continue.
+// `MutableMesh::AsMeshes` to continue. If `vertex_map` is non-empty, the
+// triangles are corrected as if each vertex index `i` were `vertex_map[i]`.
 absl::flat_hash_map<uint32_t, Point> GetCorrectedPackedVertexPositions(
-    const MutableMesh& mesh, const MeshAttributeCodingParams packing_params) {
+    const MutableMesh& mesh, const MeshAttributeCodingParams packing_params,
+    absl::Span<const uint32_t> vertex_map) {
   std::optional<SmallArray<uint8_t, 4>> bits_per_component =
       MeshFormat::PackedBitsPerComponent(
           mesh.Format().Attributes()[mesh.VertexPositionAttributeIndex()].type);
   // Unpacked types are not quantized, and so packing this mesh will not flip
-  // any triangles.
+  // any triangles. Half-float types are not quantized to a fixed grid, so the
+  // correction below doesn't apply to them either.
   if (!bits_per_component.has_value()) return {};
 
   // If the mesh already has triangles with negative area, we don't attempt to
@@ -614,6 +733,7 @@ absl::flat_hash_map<uint32_t, Point> GetCorrectedPackedVertexPositions(
   FlippedTriangleCorrectionData data = {
       .mesh = &mesh,
       .packing_params = &packing_params,
+      .vertex_map = vertex_map,
   };
   PopulateQuantizedVertexPositions(data);
   PopulateFlippedTris(data);
@@ -634,7 +754,7 @@ absl::flat_hash_map<uint32_t, Point> GetCorrectedPackedVertexPositions(
     // adjacent triangle; if so, we don't need to do anything else for this one.
     if (data.tri_flip_states[tri_idx] == TriFlipState::kFixed) continue;
 
-    std::array<uint32_t, 3> indices = mesh.TriangleIndices(tri_idx);
+    std::array<uint32_t, 3> indices = MappedTriangleIndices(data, tri_idx);
     uint16_t already_corrected_bitmask =
         GetBitmaskOfAlreadyCorrectedVertices(data, indices);
     if (already_corrected_bitmask == kNudgeAllComponentsBitmask) {
@@ -689,7 +809,9 @@ absl::flat_hash_map<uint32_t, Point> GetCorrectedPackedVertexPositions(
 
 absl::StatusOr<absl::InlinedVector<Mesh, 1>> MutableMesh::AsMeshes(
     absl::Span<const std::optional<MeshAttributeCodingParams>> packing_params,
-    absl::Span<const MeshFormat::AttributeId> omit_attributes) const {
+    absl::Span<const MeshFormat::AttributeId> omit_attributes,
+    TriangleOrder triangle_order, Executor* absl_nullable executor,
+    Allocator* absl_nullable allocator, VertexWelding vertex_welding) const {
   uint32_t n_triangles = TriangleCount();
   if (n_triangles == 0) {
     // There's nothing to partition, just return an empty list.
@@ -706,11 +828,36 @@ absl::StatusOr<absl::InlinedVector<Mesh, 1>> MutableMesh::AsMeshes(
   absl::flat_hash_set<MeshFormat::AttributeId> omit_set(omit_attributes.begin(),
                                                         omit_attributes.end());
 
+  // Consistency check; the fact that there are valid triangles guarantees that
+  // we have vertices.
   uint32_t n_vertices = VertexCount();
-  uint32_t n_attrs = format_.Attributes().size();
+  ABSL_DCHECK_GT(n_vertices, 0);
+
+  std::vector<uint32_t> vertex_map;
+  if (vertex_welding == VertexWelding::kMergeIdentical) {
+    vertex_map = ComputeVertexWeldMap(omit_attributes);
+  }
+
+  constexpr uint32_t kMaxVerticesPerPartition = 1 << 8 * Mesh::kBytesPerIndex;
+  absl::InlinedVector<mesh_internal::PartitionInfo, 1> partitions =
+      mesh_internal::PartitionTriangles(index_data_, format_.GetIndexFormat(),
+                                        kMaxVerticesPerPartition, vertex_map);
+
+  // Every vertex is checked for non-finite values, and the bounds of all of
+  // them are computed in the same pass. When the mesh fits in a single
+  // partition that uses every vertex (the common case, e.g. for a finished
+  // stroke), those are also the bounds of that partition, so no other pass
+  // over the vertex data is needed.
+  PackedComponentLayout layout =
+      ComputePackedComponentLayout(format_, omit_set);
+  ComponentBounds all_vertex_bounds(layout.component_offsets.size());
+  size_t stride = VertexStride();
   for (uint32_t vertex_idx = 0; vertex_idx < n_vertices; ++vertex_idx) {
-    for (uint32_t attr_idx = 0; attr_idx < n_attrs; ++attr_idx) {
-      if (omit_set.contains(format_.Attributes()[attr_idx].id)) continue;
+    if (ExpandComponentBounds(vertex_data_.data() + vertex_idx * stride,
+                              layout.component_offsets, all_vertex_bounds)) {
+      continue;
+    }
+    for (uint32_t attr_idx : layout.attribute_indices) {
       SmallArray<float, 4> value = FloatVertexAttribute(vertex_idx, attr_idx);
       if (!absl::c_all_of(value.Values(), ink_internal::IsFinite)) {
         return absl::FailedPreconditionError(absl::Substitute(
@@ -721,19 +868,17 @@ absl::StatusOr<absl::InlinedVector<Mesh, 1>> MutableMesh::AsMeshes(
     }
   }
 
-  // Consistency check; the fact that there are valid triangles guarantees that
-  // we have vertices.
-  ABSL_DCHECK_GT(n_vertices, 0);
-
-  constexpr uint32_t kMaxVerticesPerPartition = 1 << 8 * Mesh::kBytesPerIndex;
-  absl::InlinedVector<mesh_internal::PartitionInfo, 1> partitions =
-      mesh_internal::PartitionTriangles(index_data_, format_.GetIndexFormat(),
-                                        kMaxVerticesPerPartition);
   absl::InlinedVector<mesh_internal::AttributeBoundsArray, 1>
       partition_attribute_bounds(partitions.size());
-  for (size_t i = 0; i < partitions.size(); ++i) {
-    partition_attribute_bounds[i] =
-        ComputeAttributeBoundsForPartition(*this, partitions[i], omit_set);
+  if (partitions.size() == 1 &&
+      partitions[0].vertex_indices.size() == n_vertices) {
+    partition_attribute_bounds[0] =
+        ToAttributeBoundsArray(layout, all_vertex_bounds);
+  } else {
+    ParallelFor(executor, partitions.size(), [&](size_t i) {
+      partition_attribute_bounds[i] =
+          ComputeAttributeBoundsForPartition(*this, partitions[i], layout);
+    });
   }
 
   // We use the total bounds to compute the packing params for all partitions so
@@ -751,33 +896,84 @@ absl::StatusOr<absl::InlinedVector<Mesh, 1>> MutableMesh::AsMeshes(
   // for flipped triangles by retrying with a different scaling factor.
   absl::flat_hash_map<uint32_t, Point> corrected_vertex_positions =
       GetCorrectedPackedVertexPositions(
-          *this, (*packing_params_array)[new_format->PositionAttributeIndex()]);
-
-  absl::InlinedVector<Mesh, 1> meshes;
-  for (size_t partition_idx = 0; partition_idx < partitions.size();
-       ++partition_idx) {
-    const mesh_internal::PartitionInfo& partition = partitions[partition_idx];
-    std::vector<std::byte> partition_vertex_data =
+          *this, (*packing_params_array)[new_format->PositionAttributeIndex()],
+          vertex_map);
+
+  // Each partition is packed into its own slot, so that the result doesn't
+  // depend on the order in which the executor runs them.
+  std::vector<std::vector<std::byte>> partition_vertex_data(partitions.size());
+  std::vector<std::vector<std::byte>> partition_index_data(partitions.size());
+  ParallelFor(executor, partitions.size(), [&](size_t partition_idx) {
+    mesh_internal::PartitionInfo& partition = partitions[partition_idx];
+    if (triangle_order == TriangleOrder::kOptimizeForVertexCache) {
+      mesh_internal::OptimizePartitionForVertexCache(partition);
+    }
+    partition_vertex_data[partition_idx] =
         mesh_internal::CopyAndPackPartitionVertices(
             vertex_data_, partition.vertex_indices, format_, omit_set,
             *packing_params_array, corrected_vertex_positions);
 
-    std::vector<std::byte> partition_index_data(3 * partition.triangles.size() *
-                                                Mesh::kBytesPerIndex);
+    std::vector<std::byte>& index_data = partition_index_data[partition_idx];
+    index_data.resize(3 * partition.triangles.size() * Mesh::kBytesPerIndex);
     for (uint32_t tri_idx = 0; tri_idx < partition.triangles.size();
          ++tri_idx) {
       mesh_internal::WriteTriangleIndicesToByteArray(
           tri_idx, Mesh::kBytesPerIndex, partition.triangles[tri_idx],
-          partition_index_data);
+          index_data);
     }
+  });
 
+  absl::InlinedVector<Mesh, 1> meshes;
+  meshes.reserve(partitions.size());
+  for (size_t partition_idx = 0; partition_idx < partitions.size();
+       ++partition_idx) {
     meshes.push_back(Mesh(*new_format, *packing_params_array,
                           std::move(partition_attribute_bounds[partition_idx]),
-                          std::move(partition_vertex_data),
-                          std::move(partition_index_data)));
+                          partition_vertex_data[partition_idx],
+                          partition_index_data[partition_idx], allocator));
   }
 
   return meshes;
 }
 
+std::vector<uint32_t> MutableMesh::ComputeVertexWeldMap(
+    absl::Span<const MeshFormat::AttributeId> omit_attributes) const {
+  absl::flat_hash_set<MeshFormat::AttributeId> omit_set(omit_attributes.begin(),
+                                                        omit_attributes.end());
+  PackedComponentLayout layout =
+      ComputePackedComponentLayout(format_, omit_set);
+  size_t stride = VertexStride();
+  auto component = [this, &layout, stride](uint32_t vertex_idx, size_t i) {
+    float value;
+    std::memcpy(&value,
+                vertex_data_.data() + vertex_idx * stride +
+                    layout.component_offsets[i],
+                sizeof(float));
+    return value;
+  };
+  // Adding zero maps -0 to 0, so that equal values have equal hashes.
+  auto hash = [&layout, &component](uint32_t vertex_idx) {
+    size_t h = 0;
+    for (size_t i = 0; i < layout.component_offsets.size(); ++i) {
+      h = absl::HashOf(h, component(vertex_idx, i) + 0.f);
+    }
+    return h;
+  };
+  auto equal = [&layout, &component](uint32_t a, uint32_t b) {
+    for (size_t i = 0; i < layout.component_offsets.size(); ++i) {
+      if (component(a, i) != component(b, i)) return false;
+    }
+    return true;
+  };
+
+  uint32_t n_vertices = VertexCount();
+  std::vector<uint32_t> vertex_map(n_vertices);
+  absl::flat_hash_set<uint32_t, decltype(hash), decltype(equal)>
+      first_vertices(n_vertices, hash, equal);
+  for (uint32_t vertex_idx = 0; vertex_idx < n_vertices; ++vertex_idx) {
+    vertex_map[vertex_idx] = *first_vertices.insert(vertex_idx).first;
+  }
+  return vertex_map;
+}
+
 }  // namespace ink
@@ -23,17 +23,21 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/nullability.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/internal/mesh_packing.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mesh_packing_types.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/triangle.h"
+#include "ink/types/allocator.h"
+#include "ink/types/executor.h"
 #include "ink/types/small_array.h"
 
 namespace ink {
@@ -45,6 +49,34 @@ namespace ink {
 // precision, never packed; see `MeshFormat` for details on attribute packing.
 class MutableMesh {
  public:
+  // Specifies how `AsMeshes` orders the triangles and vertices of the returned
+  // meshes.
+  enum class TriangleOrder {
+    // Triangles are kept in the same order as in this mesh, and vertices are
+    // ordered by their index in this mesh.
+    kPreserve,
+    // Triangles are reordered to improve the hit rate of the GPU's
+    // post-transform vertex cache, and vertices are reordered to match the
+    // order in which they are first used. This makes `AsMeshes` slower, and so
+    // is best used for meshes that will be rendered many times, e.g. finished
+    // strokes.
+    kOptimizeForVertexCache,
+  };
+
+  // Specifies whether `AsMeshes` merges duplicate vertices.
+  enum class VertexWelding {
+    // Every vertex that is referenced by a triangle is kept, even if it is
+    // identical to another.
+    kNone,
+    // Vertices that have the same value for every attribute that is kept
+    // (i.e. not omitted) are merged into one, and the triangles that referred
+    // to any of them refer to the merged vertex instead. This removes the
+    // duplicate vertices that are emitted, e.g., where the stroke extruder
+    // breaks or repositions the outline, at the cost of an extra pass over the
+    // vertices. The triangles themselves are unchanged.
+    kMergeIdentical,
+  };
+
   // Constructs an empty mesh with a default-constructed `MeshFormat`.
   MutableMesh() = default;
 
@@ -79,6 +111,28 @@ class MutableMesh {
     triangle_count_ = 0;
   }
 
+  // Reserves memory for at least `vertex_count` vertices and `triangle_count`
+  // triangles, so that appending up to that many does not reallocate the
+  // vertex or triangle buffers. This never shrinks the buffers, and does not
+  // change the contents of the mesh.
+  //
+  // This is meant as a one-time hint when the final size of the mesh can be
+  // estimated up front. Reserving slightly more space before every append
+  // would defeat the buffers' geometric growth.
+  void Reserve(uint32_t vertex_count, uint32_t triangle_count) {
+    vertex_data_.reserve(static_cast<size_t>(vertex_count) * VertexStride());
+    index_data_.reserve(static_cast<size_t>(triangle_count) * 3 *
+                        IndexStride());
+  }
+
+  // Releases any memory in the vertex and triangle buffers beyond what is
+  // needed for the current contents of the mesh, e.g. after `Clear()` or
+  // `Resize()`, or once a mesh that was built up incrementally is complete.
+  void ShrinkToFit() {
+    vertex_data_.shrink_to_fit();
+    index_data_.shrink_to_fit();
+  }
+
   // Clears the mesh, as per `Clear`(), and resets the mesh format to
   // the given one.
   void Reset(MeshFormat format) {
@@ -131,6 +185,12 @@ class MutableMesh {
         &position, sizeof(position));
   }
 
+  // Applies `transform` to the position of every vertex in the mesh. This is
+  // equivalent to calling `SetVertexPosition` with the transformed
+  // `VertexPosition` for each vertex, but is faster for large meshes. The
+  // other vertex attributes are unchanged.
+  void TransformVertexPositions(const AffineTransform& transform);
+
   // Returns the index of the vertex attribute that contains the vertex's
   // position. This is equivalent to:
   //   mesh.Format().PositionAttributeIndex();
@@ -275,6 +335,19 @@ class MutableMesh {
   // `MeshFormat::AttributeType`). Note that this does not always succeed, so
   // the result may still contain triangles with negative area.
   //
+  // Optional argument `triangle_order` specifies whether the triangles and
+  // vertices of each returned mesh keep their original relative order; see
+  // `TriangleOrder`. Either way, the winding of each triangle is preserved.
+  //
+  // If `executor` is non-null, it is used to pack the partitions concurrently;
+  // the result is the same either way.
+  //
+  // Optional argument `allocator` provides the memory for the returned meshes;
+  // see `Mesh::Create`.
+  //
+  // Optional argument `vertex_welding` specifies whether duplicate vertices are
+  // merged; see `VertexWelding` and `ComputeVertexWeldMap`.
+  //
   // Returns an error if:
   // - `ValidateTriangleIndices` fails
   // - Any attribute value is non-finite
@@ -290,6 +363,23 @@ class MutableMesh {
   absl::StatusOr<absl::InlinedVector<Mesh, 1>> AsMeshes(
       absl::Span<const std::optional<MeshAttributeCodingParams>>
           packing_params = {},
+      absl::Span<const MeshFormat::AttributeId> omit_attributes = {},
+      TriangleOrder triangle_order = TriangleOrder::kPreserve,
+      Executor* absl_nullable executor = nullptr,
+      Allocator* absl_nullable allocator = nullptr,
+      VertexWelding vertex_welding = VertexWelding::kNone) const;
+
+  // Returns, for each vertex, the index of the first vertex that has the same
+  // value for every attribute not in `omit_attributes`, which is the vertex's
+  // own index if there is no earlier such vertex. This is the mapping that
+  // `AsMeshes` applies to the triangle indices with
+  // `VertexWelding::kMergeIdentical`, and can be used to remap other
+  // references to vertices, e.g. outlines, to match.
+  //
+  // Values are compared exactly (so, e.g., 0 and -0 are the same), rather than
+  // after quantization, since the packing parameters depend on which vertices
+  // are kept.
+  std::vector<uint32_t> ComputeVertexWeldMap(
       absl::Span<const MeshFormat::AttributeId> omit_attributes = {}) const;
 
   // Returns the format of the mesh.
@@ -298,6 +388,15 @@ class MutableMesh {
   // Returns the raw data of the mesh's vertices.
   absl::Span<const std::byte> RawVertexData() const { return vertex_data_; }
 
+  // Returns the raw data of the mesh's vertices for in-place modification.
+  // This allows callers that know the unpacked layout of `Format()` at compile
+  // time to write whole vertices at once, rather than one attribute at a time
+  // via `SetFloatVertexAttribute()`. The span is invalidated by any operation
+  // that changes the vertex count.
+  absl::Span<std::byte> MutableRawVertexData() {
+    return absl::MakeSpan(vertex_data_);
+  }
+
   // Returns the number of bytes used to represent a vertex in this mesh. This
   // is equivalent to:
   //   mesh.Format().UnpackedVertexStride();
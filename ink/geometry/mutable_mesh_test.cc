@@ -14,6 +14,7 @@
 
 #include "ink/geometry/mutable_mesh.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstddef>
@@ -21,6 +22,7 @@
 #include <cstring>
 #include <limits>
 #include <optional>
+#include <tuple>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -31,6 +33,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/fuzz_domains.h"
 #include "ink/geometry/internal/mesh_packing.h"
 #include "ink/geometry/mesh.h"
@@ -42,6 +45,7 @@
 #include "ink/geometry/triangle.h"
 #include "ink/geometry/type_matchers.h"
 #include "ink/types/small_array.h"
+#include "ink/types/test_executor.h"
 
 namespace ink {
 namespace {
@@ -56,6 +60,7 @@ using ::testing::IsEmpty;
 using ::testing::Not;
 using ::testing::Pointwise;
 using ::testing::SizeIs;
+using ::testing::UnorderedElementsAreArray;
 
 MATCHER(MeshTrianglesHaveNonNegativeArea,
         absl::StrCat("the mesh contains ", negation ? "one or more" : "no",
@@ -324,6 +329,43 @@ TEST(MutableMeshTest, ClearNonEmptyMesh) {
   EXPECT_THAT(m.Format(), MeshFormatEq(*format));
 }
 
+TEST(MutableMeshTest, ReserveAvoidsReallocation) {
+  MutableMesh m;
+  m.AppendVertex({1, 2});
+  m.Reserve(100, 50);
+  // Reserving leaves the contents unchanged.
+  ASSERT_EQ(m.VertexCount(), 1);
+  EXPECT_THAT(m.VertexPosition(0), PointEq({1, 2}));
+
+  const std::byte* vertex_data = m.RawVertexData().data();
+  const std::byte* index_data = m.RawIndexData().data();
+  for (uint32_t i = 1; i < 100; ++i) {
+    m.AppendVertex({static_cast<float>(i), 0});
+  }
+  for (uint32_t i = 0; i < 50; ++i) {
+    m.AppendTriangleIndices({i, i + 1, i + 2});
+  }
+  EXPECT_EQ(m.RawVertexData().data(), vertex_data);
+  EXPECT_EQ(m.RawIndexData().data(), index_data);
+}
+
+TEST(MutableMeshTest, ShrinkToFitPreservesContents) {
+  MutableMesh m;
+  m.Reserve(100, 50);
+  m.AppendVertex({1, 2});
+  m.AppendVertex({3, 4});
+  m.AppendVertex({5, 6});
+  m.AppendTriangleIndices({0, 1, 2});
+  m.ShrinkToFit();
+
+  ASSERT_EQ(m.VertexCount(), 3);
+  EXPECT_THAT(m.VertexPosition(0), PointEq({1, 2}));
+  EXPECT_THAT(m.VertexPosition(1), PointEq({3, 4}));
+  EXPECT_THAT(m.VertexPosition(2), PointEq({5, 6}));
+  ASSERT_EQ(m.TriangleCount(), 1);
+  EXPECT_THAT(m.TriangleIndices(0), ElementsAre(0, 1, 2));
+}
+
 TEST(MutableMeshTest, ResetEmptyMesh) {
   absl::StatusOr<MeshFormat> format =
       MeshFormat::Create({{MeshFormat::AttributeType::kFloat4PackedInOneFloat,
@@ -388,6 +430,45 @@ TEST(MutableMeshTest, SetVertexPosition) {
   EXPECT_EQ(m.VertexPosition(2), (Point{20, 30}));
 }
 
+TEST(MutableMeshTest, TransformVertexPositions) {
+  MutableMesh m(
+      *MeshFormat::Create({{MeshFormat::AttributeType::kFloat4PackedInOneFloat,
+                            MeshFormat::AttributeId::kColorShiftHsl},
+                           {MeshFormat::AttributeType::kFloat2PackedInOneFloat,
+                            MeshFormat::AttributeId::kPosition},
+                           {MeshFormat::AttributeType::kFloat1Unpacked,
+                            MeshFormat::AttributeId::kCustom0}},
+                          MeshFormat::IndexFormat::k16BitUnpacked16BitPacked));
+  // Enough vertices to span more than one batch of positions.
+  for (int i = 0; i < 1000; ++i) {
+    m.AppendVertex({1.f * i, -2.f * i});
+    m.SetFloatVertexAttribute(i, 0, {1, 2, 3, 4});
+    m.SetFloatVertexAttribute(i, 2, {5});
+  }
+  AffineTransform transform(2, 1, 3, -1, 4, 5);
+
+  m.TransformVertexPositions(transform);
+
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_THAT(m.VertexPosition(i),
+                PointEq(transform.Apply(Point{1.f * i, -2.f * i})));
+    EXPECT_THAT(m.FloatVertexAttribute(i, 0).Values(),
+                ElementsAre(1, 2, 3, 4));
+    EXPECT_THAT(m.FloatVertexAttribute(i, 2).Values(), ElementsAre(5));
+  }
+}
+
+TEST(MutableMeshTest, TransformVertexPositionsPositionOnlyFormat) {
+  MutableMesh m;
+  m.AppendVertex({3, 4});
+  m.AppendVertex({1, 0});
+
+  m.TransformVertexPositions(AffineTransform::Translate({1, -1}));
+
+  EXPECT_EQ(m.VertexPosition(0), (Point{4, 3}));
+  EXPECT_EQ(m.VertexPosition(1), (Point{2, -1}));
+}
+
 TEST(MutableMeshTest, SetFloatVertexAttribute) {
   MutableMesh m(
       *MeshFormat::Create({{MeshFormat::AttributeType::kFloat4PackedInOneFloat,
@@ -806,6 +887,20 @@ TEST(MutableMeshTest, RawVertexDataWhenNonEmpty) {
   EXPECT_THAT(m.RawVertexData(), ElementsAreArray(vertex_byte_data_2));
 }
 
+TEST(MutableMeshTest, MutableRawVertexData) {
+  MutableMesh m;
+  m.AppendVertex({4, 9});
+  m.AppendVertex({3, 5});
+  std::vector<std::byte> new_vertex_bytes = CopyToBytes<float>({7, 8});
+  absl::Span<std::byte> data = m.MutableRawVertexData();
+  ASSERT_EQ(data.size(), 2 * m.VertexStride());
+  std::copy(new_vertex_bytes.begin(), new_vertex_bytes.end(),
+            data.begin() + m.VertexStride());
+
+  EXPECT_THAT(m.VertexPosition(0), PointEq({4, 9}));
+  EXPECT_THAT(m.VertexPosition(1), PointEq({7, 8}));
+}
+
 TEST(MutableMeshTest, RawVertexDataWhenNonEmptyWithDifferentFormat) {
   MutableMesh m(
       *MeshFormat::Create({{MeshFormat::AttributeType::kFloat4PackedInOneFloat,
@@ -1172,6 +1267,140 @@ TEST(MutableMeshTest, AsMeshes16BitReturnsMultiplePartitionsForLargeMesh) {
               EnvelopeEq(Rect::FromTwoPoints({65534, -1}, {100001, 0})));
 }
 
+TEST(MutableMeshTest, AsMeshesWithExecutorMatchesSequentialResult) {
+  // Enough triangles for five partitions, with a packed format so that the
+  // partitions share coding params.
+  MutableMesh m =
+      MakeStraightLineMutableMesh(3e5, MakeSinglePackedPositionFormat());
+
+  absl::StatusOr<absl::InlinedVector<Mesh, 1>> expected = m.AsMeshes();
+  ASSERT_EQ(expected.status(), absl::OkStatus());
+  ThreadPerTaskExecutor executor;
+  absl::StatusOr<absl::InlinedVector<Mesh, 1>> meshes =
+      m.AsMeshes({}, {}, MutableMesh::TriangleOrder::kPreserve, &executor);
+  ASSERT_EQ(meshes.status(), absl::OkStatus());
+
+  ASSERT_EQ(meshes->size(), 5);
+  ASSERT_EQ(meshes->size(), expected->size());
+  for (size_t i = 0; i < meshes->size(); ++i) {
+    EXPECT_THAT((*meshes)[i].RawVertexData(),
+                ElementsAreArray((*expected)[i].RawVertexData()));
+    EXPECT_THAT((*meshes)[i].RawIndexData(),
+                ElementsAreArray((*expected)[i].RawIndexData()));
+    EXPECT_THAT((*meshes)[i].VertexAttributeUnpackingParams(0),
+                MeshAttributeCodingParamsEq(
+                    (*expected)[i].VertexAttributeUnpackingParams(0)));
+  }
+}
+
+// Returns the vertex positions of each triangle in `mesh`, as {x0, y0, x1, y1,
+// x2, y2}, with each triangle rotated so that its lexicographically smallest
+// vertex comes first; this preserves the winding of the triangle.
+template <typename MeshType>
+std::vector<std::array<float, 6>> TrianglePositionsWithWinding(
+    const MeshType& mesh) {
+  std::vector<std::array<float, 6>> triangles;
+  for (uint32_t t = 0; t < mesh.TriangleCount(); ++t) {
+    std::array<Point, 3> points;
+    for (int i = 0; i < 3; ++i) {
+      points[i] = mesh.VertexPosition(mesh.TriangleIndices(t)[i]);
+    }
+    auto less = [](Point a, Point b) {
+      return std::tie(a.x, a.y) < std::tie(b.x, b.y);
+    };
+    while (less(points[1], points[0]) || less(points[2], points[0])) {
+      points = {points[1], points[2], points[0]};
+    }
+    triangles.push_back({points[0].x, points[0].y, points[1].x, points[1].y,
+                         points[2].x, points[2].y});
+  }
+  return triangles;
+}
+
+TEST(MutableMeshTest, AsMeshesOptimizeForVertexCachePreservesTriangles) {
+  // A grid of 30 by 10 quads, each split into two triangles, in row-major
+  // order.
+  MutableMesh m;
+  for (int row = 0; row <= 10; ++row) {
+    for (int column = 0; column <= 30; ++column) {
+      m.AppendVertex({static_cast<float>(column), static_cast<float>(row)});
+    }
+  }
+  for (uint32_t row = 0; row < 10; ++row) {
+    for (uint32_t column = 0; column < 30; ++column) {
+      uint32_t bottom_left = row * 31 + column;
+      uint32_t top_left = bottom_left + 31;
+      m.AppendTriangleIndices({bottom_left, bottom_left + 1, top_left});
+      m.AppendTriangleIndices({bottom_left + 1, top_left + 1, top_left});
+    }
+  }
+
+  absl::StatusOr<absl::InlinedVector<Mesh, 1>> meshes =
+      m.AsMeshes({}, {}, MutableMesh::TriangleOrder::kOptimizeForVertexCache);
+  ASSERT_EQ(meshes.status(), absl::OkStatus());
+
+  ASSERT_EQ(meshes->size(), 1);
+  EXPECT_EQ((*meshes)[0].VertexCount(), m.VertexCount());
+  EXPECT_THAT(TrianglePositionsWithWinding((*meshes)[0]),
+              UnorderedElementsAreArray(TrianglePositionsWithWinding(m)));
+  // The triangles should actually have been reordered, since emitting them
+  // row-by-row is not cache-friendly.
+  EXPECT_THAT(TrianglePositionsWithWinding((*meshes)[0]),
+              Not(ElementsAreArray(TrianglePositionsWithWinding(m))));
+}
+
+TEST(MutableMeshTest, ComputeVertexWeldMap) {
+  absl::StatusOr<MeshFormat> format =
+      MeshFormat::Create({{MeshFormat::AttributeType::kFloat2Unpacked,
+                           MeshFormat::AttributeId::kPosition},
+                          {MeshFormat::AttributeType::kFloat1Unpacked,
+                           MeshFormat::AttributeId::kCustom0}},
+                         MeshFormat::IndexFormat::k32BitUnpacked16BitPacked);
+  ASSERT_EQ(format.status(), absl::OkStatus());
+  MutableMesh m(*format);
+  m.AppendVertex({0, 0});
+  m.AppendVertex({1, 0});
+  m.AppendVertex({0, 0});
+  m.AppendVertex({-0.f, 0});
+  m.AppendVertex({1, 0});
+  m.SetFloatVertexAttribute(4, 1, {5});
+
+  EXPECT_THAT(m.ComputeVertexWeldMap(), ElementsAre(0, 1, 0, 0, 4));
+  // Vertices that differ only in an omitted attribute are merged.
+  EXPECT_THAT(m.ComputeVertexWeldMap({MeshFormat::AttributeId::kCustom0}),
+              ElementsAre(0, 1, 0, 0, 1));
+}
+
+TEST(MutableMeshTest, AsMeshesWithVertexWeldingMergesIdenticalVertices) {
+  // Two triangles that each have their own copy of the shared edge.
+  MutableMesh m;
+  m.AppendVertex({0, 0});
+  m.AppendVertex({1, 0});
+  m.AppendVertex({0, 1});
+  m.AppendVertex({1, 0});
+  m.AppendVertex({1, 1});
+  m.AppendVertex({0, 1});
+  m.AppendTriangleIndices({0, 1, 2});
+  m.AppendTriangleIndices({3, 4, 5});
+
+  absl::StatusOr<absl::InlinedVector<Mesh, 1>> welded =
+      m.AsMeshes({}, {}, MutableMesh::TriangleOrder::kPreserve, nullptr,
+                 nullptr, MutableMesh::VertexWelding::kMergeIdentical);
+  ASSERT_EQ(welded.status(), absl::OkStatus());
+  ASSERT_EQ(welded->size(), 1);
+  EXPECT_EQ((*welded)[0].VertexCount(), 4u);
+  EXPECT_THAT((*welded)[0].TriangleIndices(0), ElementsAre(0, 1, 2));
+  EXPECT_THAT((*welded)[0].TriangleIndices(1), ElementsAre(1, 3, 2));
+  EXPECT_THAT(TrianglePositionsWithWinding((*welded)[0]),
+              ElementsAreArray(TrianglePositionsWithWinding(m)));
+
+  // Without welding, every vertex is kept.
+  absl::StatusOr<absl::InlinedVector<Mesh, 1>> unwelded = m.AsMeshes();
+  ASSERT_EQ(unwelded.status(), absl::OkStatus());
+  ASSERT_EQ(unwelded->size(), 1);
+  EXPECT_EQ((*unwelded)[0].VertexCount(), 6u);
+}
+
 TEST(MutableMeshTest, AsMeshesPartitionsUseSameUnpackingParams) {
   MutableMesh m =
       MakeStraightLineMutableMesh(1e5, MakeSinglePackedPositionFormat());
@@ -14,17 +14,25 @@
 
 #include "ink/geometry/partitioned_mesh.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <optional>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/nullability.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/function_ref.h"
 #include "absl/log/absl_check.h"
@@ -38,7 +46,10 @@
 #include "ink/geometry/internal/algorithms.h"
 #include "ink/geometry/internal/intersects_internal.h"
 #include "ink/geometry/internal/mesh_packing.h"
+#include "ink/geometry/internal/polyline_simplification.h"
+#include "ink/geometry/internal/query_transform.h"
 #include "ink/geometry/internal/static_rtree.h"
+#include "ink/geometry/internal/triangle_block.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mesh_packing_types.h"
@@ -48,6 +59,11 @@
 #include "ink/geometry/rect.h"
 #include "ink/geometry/segment.h"
 #include "ink/geometry/triangle.h"
+#include "ink/types/allocator.h"
+#include "ink/types/executor.h"
+#include "ink/types/memory_footprint.h"
+#include "ink/types/small_array.h"
+#include "ink/types/trace.h"
 
 namespace ink {
 
@@ -63,18 +79,21 @@ absl::StatusOr<PartitionedMesh> PartitionedMesh::FromMutableMesh(
     const MutableMesh& mesh,
     absl::Span<const absl::Span<const uint32_t>> outlines,
     absl::Span<const MeshFormat::AttributeId> omit_attributes,
-    absl::Span<const std::optional<MeshAttributeCodingParams>> packing_params) {
+    absl::Span<const std::optional<MeshAttributeCodingParams>> packing_params,
+    Executor* absl_nullable executor, Allocator* absl_nullable allocator) {
   MutableMeshGroup group = {
       .mesh = &mesh,
       .outlines = outlines,
       .omit_attributes = omit_attributes,
       .packing_params = packing_params,
   };
-  return PartitionedMesh::FromMutableMeshGroups(absl::MakeConstSpan(&group, 1));
+  return PartitionedMesh::FromMutableMeshGroups(absl::MakeConstSpan(&group, 1),
+                                                executor, allocator);
 }
 
 absl::StatusOr<PartitionedMesh> PartitionedMesh::FromMutableMeshGroups(
-    absl::Span<const MutableMeshGroup> groups) {
+    absl::Span<const MutableMeshGroup> groups,
+    Executor* absl_nullable executor, Allocator* absl_nullable allocator) {
   std::vector<std::vector<std::vector<VertexIndexPair>>>
       all_partitioned_outlines;
   all_partitioned_outlines.reserve(groups.size());
@@ -110,7 +129,9 @@ absl::StatusOr<PartitionedMesh> PartitionedMesh::FromMutableMeshGroups(
     }
 
     absl::StatusOr<absl::InlinedVector<Mesh, 1>> group_meshes =
-        mesh.AsMeshes(group.packing_params, group.omit_attributes);
+        mesh.AsMeshes(group.packing_params, group.omit_attributes,
+                      group.triangle_order, executor, allocator,
+                      group.vertex_welding);
     if (!group_meshes.ok()) {
       return group_meshes.status();
     }
@@ -127,11 +148,24 @@ absl::StatusOr<PartitionedMesh> PartitionedMesh::FromMutableMeshGroups(
     // `MutableMesh` is changed to always use 16-bit indices (b/295166196),
     // there will be no need to do partitioning, and this code can be deleted.
     if (!outlines.empty()) {
+      // This gives the same merged vertices as in `MutableMesh::AsMeshes`.
+      std::vector<uint32_t> vertex_map;
+      if (group.vertex_welding ==
+          MutableMesh::VertexWelding::kMergeIdentical) {
+        vertex_map = mesh.ComputeVertexWeldMap(group.omit_attributes);
+      }
       constexpr uint32_t kMaxVerticesPerPartition = 1 << (8 * sizeof(uint16_t));
       absl::InlinedVector<mesh_internal::PartitionInfo, 1> partitions =
-          mesh_internal::PartitionTriangles(mesh.RawIndexData(),
-                                            mesh.Format().GetIndexFormat(),
-                                            kMaxVerticesPerPartition);
+          mesh_internal::PartitionTriangles(
+              mesh.RawIndexData(), mesh.Format().GetIndexFormat(),
+              kMaxVerticesPerPartition, vertex_map);
+      if (group.triangle_order ==
+          MutableMesh::TriangleOrder::kOptimizeForVertexCache) {
+        // This gives the same vertex order as in `MutableMesh::AsMeshes`.
+        ParallelFor(executor, partitions.size(), [&partitions](size_t i) {
+          mesh_internal::OptimizePartitionForVertexCache(partitions[i]);
+        });
+      }
       absl::flat_hash_map<uint32_t, VertexIndexPair> partition_map;
       partition_map.reserve(mesh.VertexCount());
       for (size_t p_idx = 0; p_idx < partitions.size(); ++p_idx) {
@@ -152,7 +186,14 @@ absl::StatusOr<PartitionedMesh> PartitionedMesh::FromMutableMeshGroups(
         if (outlines[o_idx].empty()) continue;
         std::vector<VertexIndexPair> outline_index_pairs;
         outline_index_pairs.reserve(outlines[o_idx].size());
+        std::optional<uint32_t> previous_index;
         for (uint32_t index : outlines[o_idx]) {
+          if (!vertex_map.empty()) {
+            index = vertex_map[index];
+            // Duplicates of the same vertex collapse into one.
+            if (index == previous_index) continue;
+            previous_index = index;
+          }
           auto it = partition_map.find(index);
           if (it != partition_map.end()) {
             outline_index_pairs.push_back(it->second);
@@ -200,9 +241,13 @@ absl::StatusOr<absl_nonnull std::unique_ptr<PartitionedMesh::Data>>
 PartitionedMesh::Data::FromMeshGroups(absl::Span<const MeshGroup> groups) {
   size_t total_meshes = 0;
   size_t total_outlines = 0;
+  size_t total_outline_vertices = 0;
   for (const MeshGroup& group : groups) {
     total_meshes += group.meshes.size();
     total_outlines += group.outlines.size();
+    for (absl::Span<const VertexIndexPair> outline : group.outlines) {
+      total_outline_vertices += outline.size();
+    }
   }
   if (total_meshes > std::numeric_limits<uint16_t>::max()) {
     return absl::InvalidArgumentError(absl::Substitute(
@@ -267,7 +312,8 @@ PartitionedMesh::Data::FromMeshGroups(absl::Span<const MeshGroup> groups) {
 
   auto data = std::make_unique<PartitionedMesh::Data>();
   data->meshes_.reserve(total_meshes);
-  data->outlines_.reserve(total_outlines);
+  data->outline_vertex_indices_.reserve(total_outline_vertices);
+  data->outline_starts_.reserve(total_outlines + 1);
   data->group_first_mesh_indices_.reserve(groups.size());
   data->group_first_outline_indices_.reserve(groups.size());
   data->group_formats_ = std::move(group_formats);
@@ -277,11 +323,21 @@ PartitionedMesh::Data::FromMeshGroups(absl::Span<const MeshGroup> groups) {
     data->group_first_mesh_indices_.push_back(group_first_mesh_index);
     data->meshes_.insert(data->meshes_.end(), group.meshes.begin(),
                          group.meshes.end());
-    uint32_t group_first_outline_index = data->outlines_.size();
+    uint32_t group_first_outline_index = data->outline_starts_.size() - 1;
     data->group_first_outline_indices_.push_back(group_first_outline_index);
+    std::vector<OutlineView::MeshRun>& mesh_runs = data->outline_mesh_runs_;
     for (absl::Span<const VertexIndexPair> outline : group.outlines) {
-      data->outlines_.push_back(
-          std::vector<VertexIndexPair>(outline.begin(), outline.end()));
+      for (uint32_t i = 0; i < outline.size(); ++i) {
+        if (i == 0 || outline[i].mesh_index != mesh_runs.back().mesh_index) {
+          mesh_runs.push_back({.end = i, .mesh_index = outline[i].mesh_index});
+        }
+        mesh_runs.back().end = i + 1;
+        data->outline_vertex_indices_.push_back(outline[i].vertex_index);
+      }
+      data->outline_starts_.push_back(
+          {.first_vertex =
+               static_cast<uint32_t>(data->outline_vertex_indices_.size()),
+           .first_mesh_run = static_cast<uint32_t>(mesh_runs.size())});
     }
   }
 
@@ -297,8 +353,248 @@ Envelope PartitionedMesh::Bounds() const {
   return bounds;
 }
 
+void PartitionedMesh::SetPackedPositionQueries(
+    PackedPositionQueries packed_position_queries) const {
+  if (Meshes().empty()) return;
+  data_->SetPackedPositionQueries(packed_position_queries);
+}
+
+void PartitionedMesh::InitializeSpatialIndexAsync(
+    Executor& executor, PendingSpatialIndexQueries pending_queries) const {
+  if (Meshes().empty()) return;
+  if (!data_->BeginAsyncSpatialIndexInitialization(pending_queries)) return;
+
+  executor.Schedule(
+      [data = data_]() { data->FinishAsyncSpatialIndexInitialization(); });
+}
+
+PartitionedMesh::SpatialIndexStructure
+PartitionedMesh::GetSpatialIndexStructure() const {
+  SpatialIndexStructure structure;
+  if (Meshes().empty()) return structure;
+
+  absl::Span<const RTree::BranchNode> branch_nodes =
+      data_->SpatialIndex().BranchNodes();
+  structure.node_is_leaf_parent.reserve(branch_nodes.size());
+  structure.node_child_counts.reserve(branch_nodes.size());
+  for (const RTree::BranchNode& node : branch_nodes) {
+    structure.node_is_leaf_parent.push_back(node.is_leaf_parent);
+    structure.node_child_counts.push_back(node.child_indices.Size());
+    absl::c_copy(node.child_indices.Values(),
+                 std::back_inserter(structure.child_indices));
+  }
+  return structure;
+}
+
+absl::Status PartitionedMesh::InitializeSpatialIndexFromStructure(
+    const SpatialIndexStructure& structure) const {
+  const size_t n_nodes = structure.node_is_leaf_parent.size();
+  if (structure.node_child_counts.size() != n_nodes) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "`node_is_leaf_parent` has $0 elements, but `node_child_counts` has $1",
+        n_nodes, structure.node_child_counts.size()));
+  }
+  if (Meshes().empty()) {
+    if (n_nodes != 0) {
+      return absl::InvalidArgumentError(
+          "A `PartitionedMesh` with no meshes cannot have a spatial index");
+    }
+    return absl::OkStatus();
+  }
+
+  std::vector<RTree::BranchNode> branch_nodes(n_nodes);
+  absl::Span<const uint32_t> remaining_child_indices = structure.child_indices;
+  for (size_t i = 0; i < n_nodes; ++i) {
+    uint32_t n_children = structure.node_child_counts[i];
+    if (n_children > RTree::kMaxChildrenPerNode ||
+        n_children > remaining_child_indices.size()) {
+      return absl::InvalidArgumentError(absl::Substitute(
+          "Node $0 has $1 children, but at most $2 are allowed and $3 remain",
+          i, n_children, RTree::kMaxChildrenPerNode,
+          remaining_child_indices.size()));
+    }
+    branch_nodes[i].is_leaf_parent = structure.node_is_leaf_parent[i];
+    branch_nodes[i].child_indices =
+        SmallArray<uint32_t, RTree::kMaxChildrenPerNode>(
+            remaining_child_indices.first(n_children));
+    remaining_child_indices.remove_prefix(n_children);
+  }
+  if (!remaining_child_indices.empty()) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "`child_indices` has $0 more elements than `node_child_counts` uses",
+        remaining_child_indices.size()));
+  }
+  return data_->InitializeSpatialIndexFromBranchNodes(std::move(branch_nodes));
+}
+
 namespace {
 
+// Visits the triangles of `meshes` whose bounds intersect `bounds`, until
+// `visitor` returns false. This uses `rtree` if it is non-null, and otherwise
+// tests every triangle (e.g. while the spatial index is still being built).
+void VisitTrianglesIntersectingBounds(
+    absl::Span<const Mesh> meshes, const RTree* absl_nullable rtree,
+    const Rect& bounds,
+    absl::FunctionRef<bool(PartitionedMesh::TriangleIndexPair)> visitor) {
+  if (rtree != nullptr) {
+    rtree->VisitIntersectedElements(bounds, visitor);
+    return;
+  }
+  for (uint32_t mesh_index = 0; mesh_index < meshes.size(); ++mesh_index) {
+    const Mesh& mesh = meshes[mesh_index];
+    uint32_t n_tris = mesh.TriangleCount();
+    for (uint32_t triangle_index = 0; triangle_index < n_tris;
+         ++triangle_index) {
+      if (!geometry_internal::IntersectsInternal(
+              *Envelope(mesh.GetTriangle(triangle_index)).AsRect(), bounds)) {
+        continue;
+      }
+      if (!visitor({.mesh_index = static_cast<uint16_t>(mesh_index),
+                    .triangle_index = static_cast<uint16_t>(triangle_index)})) {
+        return;
+      }
+    }
+  }
+}
+
+// Like `VisitTrianglesIntersectingBounds`, but visits the triangles a block at
+// a time: the elements of one leaf-parent node of `rtree`, or, if it is null,
+// up to `geometry_internal::kTriangleBlockSize` consecutive triangles.
+void VisitTriangleBlocksIntersectingBounds(
+    absl::Span<const Mesh> meshes, const RTree* absl_nullable rtree,
+    const Rect& bounds,
+    absl::FunctionRef<
+        bool(absl::Span<const PartitionedMesh::TriangleIndexPair>)>
+        visitor) {
+  static_assert(RTree::kMaxChildrenPerNode <=
+                geometry_internal::kTriangleBlockSize);
+  if (rtree != nullptr) {
+    rtree->VisitIntersectedLeafBlocks(bounds, visitor);
+    return;
+  }
+  absl::InlinedVector<PartitionedMesh::TriangleIndexPair,
+                      geometry_internal::kTriangleBlockSize>
+      block;
+  for (uint32_t mesh_index = 0; mesh_index < meshes.size(); ++mesh_index) {
+    const Mesh& mesh = meshes[mesh_index];
+    uint32_t n_tris = mesh.TriangleCount();
+    for (uint32_t triangle_index = 0; triangle_index < n_tris;
+         ++triangle_index) {
+      if (!geometry_internal::IntersectsInternal(
+              *Envelope(mesh.GetTriangle(triangle_index)).AsRect(), bounds)) {
+        continue;
+      }
+      block.push_back(
+          {.mesh_index = static_cast<uint16_t>(mesh_index),
+           .triangle_index = static_cast<uint16_t>(triangle_index)});
+      if (block.size() == geometry_internal::kTriangleBlockSize) {
+        if (!visitor(block)) return;
+        block.clear();
+      }
+    }
+  }
+  if (!block.empty()) visitor(block);
+}
+
+// Visits the triangles of `meshes` that intersect `transformed_query`, which
+// has already been mapped into the meshes' coordinate space.
+template <typename TransformedQueryType>
+void VisitTrianglesIntersectingTransformedQuery(
+    const TransformedQueryType& transformed_query,
+    absl::FunctionRef<
+        PartitionedMesh::FlowControl(PartitionedMesh::TriangleIndexPair)>
+        visitor,
+    absl::Span<const Mesh> meshes, const RTree* absl_nullable rtree) {
+  // For each mesh whose positions are packed into integers and not cached
+  // unpacked, the query in the mesh's packed integer space, so that it can be
+  // tested against the packed positions without unpacking them.
+  using PackedQueryType =
+      decltype(std::declval<AffineTransform>().Apply(transformed_query));
+  absl::InlinedVector<std::optional<PackedQueryType>, 1> packed_queries(
+      meshes.size());
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    if (meshes[i].IsPositionCacheInitialized()) continue;
+    if (std::optional<AffineTransform> to_packed =
+            meshes[i].PositionToPackedIntegerTransform()) {
+      packed_queries[i] = to_packed->Apply(transformed_query);
+    }
+  }
+
+  auto intersects_triangle = [&transformed_query, &packed_queries, &meshes](
+                                 PartitionedMesh::TriangleIndexPair index) {
+    const Mesh& mesh = meshes[index.mesh_index];
+    const std::optional<PackedQueryType>& packed_query =
+        packed_queries[index.mesh_index];
+    return packed_query.has_value()
+               ? geometry_internal::IntersectsInternal(
+                     *packed_query,
+                     mesh.GetPackedIntegerTriangle(index.triangle_index))
+               : geometry_internal::IntersectsInternal(
+                     transformed_query, mesh.GetTriangle(index.triangle_index));
+  };
+
+  // The triangles of each block are tested together, one mesh at a time, since
+  // the query differs between meshes whose positions are tested packed and
+  // those that aren't. Then the ones that intersect are visited in order. A
+  // block test costs about as much as a few scalar tests whatever the block's
+  // size, so small blocks are tested one triangle at a time instead.
+  constexpr size_t kMinTrianglesForBlockTest = 4;
+  geometry_internal::TriangleBlock triangles;
+  auto block_visitor =
+      [&transformed_query, &packed_queries, visitor, &meshes, &triangles,
+       &intersects_triangle](
+          absl::Span<const PartitionedMesh::TriangleIndexPair> block) {
+        if (block.size() < kMinTrianglesForBlockTest) {
+          for (PartitionedMesh::TriangleIndexPair index : block) {
+            if (intersects_triangle(index) &&
+                visitor(index) != PartitionedMesh::FlowControl::kContinue) {
+              return false;
+            }
+          }
+          return true;
+        }
+        geometry_internal::TriangleBlockMask intersects = {};
+        geometry_internal::TriangleBlockMask tested = {};
+        std::array<uint32_t, geometry_internal::kTriangleBlockSize>
+            block_index_of_triangle;
+        for (uint32_t first = 0; first < block.size(); ++first) {
+          if (tested[first]) continue;
+          uint16_t mesh_index = block[first].mesh_index;
+          const Mesh& mesh = meshes[mesh_index];
+          const std::optional<PackedQueryType>& packed_query =
+              packed_queries[mesh_index];
+          triangles.size = 0;
+          for (uint32_t i = first; i < block.size(); ++i) {
+            if (block[i].mesh_index != mesh_index) continue;
+            tested[i] = true;
+            block_index_of_triangle[triangles.size] = i;
+            uint16_t triangle_index = block[i].triangle_index;
+            triangles.Append(packed_query.has_value()
+                                 ? mesh.GetPackedIntegerTriangle(triangle_index)
+                                 : mesh.GetTriangle(triangle_index));
+          }
+          geometry_internal::TriangleBlockMask mesh_intersects =
+              packed_query.has_value()
+                  ? geometry_internal::IntersectsTriangleBlock(*packed_query,
+                                                               triangles)
+                  : geometry_internal::IntersectsTriangleBlock(
+                        transformed_query, triangles);
+          for (uint32_t i = 0; i < triangles.size; ++i) {
+            intersects[block_index_of_triangle[i]] = mesh_intersects[i];
+          }
+        }
+        for (uint32_t i = 0; i < block.size(); ++i) {
+          if (intersects[i] &&
+              visitor(block[i]) != PartitionedMesh::FlowControl::kContinue) {
+            return false;
+          }
+        }
+        return true;
+      };
+  VisitTriangleBlocksIntersectingBounds(
+      meshes, rtree, *Envelope(transformed_query).AsRect(), block_visitor);
+}
+
 // This is a helper function for `VisitIntersectedTriangles` that handles the
 // type-independent logic.
 template <typename QueryType>
@@ -308,21 +604,16 @@ void VisitIntersectedTrianglesHelper(
         PartitionedMesh::FlowControl(PartitionedMesh::TriangleIndexPair)>
         visitor,
     const AffineTransform& query_to_this, absl::Span<const Mesh> meshes,
-    const RTree& rtree) {
-  // This is an `auto` instead of `QueryType` because the `Rect` overload of
-  // `AffineTransform::Apply` returns a `Quad`, not a `Rect`.
-  auto transformed_query = query_to_this.Apply(query);
-  auto visitor_wrapper = [transformed_query, visitor,
-                          &meshes](PartitionedMesh::TriangleIndexPair index) {
-    if (!geometry_internal::IntersectsInternal(
-            transformed_query,
-            meshes[index.mesh_index].GetTriangle(index.triangle_index))) {
-      return true;
-    }
-    return visitor(index) == PartitionedMesh::FlowControl::kContinue;
-  };
-  rtree.VisitIntersectedElements(*Envelope(transformed_query).AsRect(),
-                                 visitor_wrapper);
+    const RTree* absl_nullable rtree) {
+  // Most queries are made with an identity or translation transform, which
+  // can be applied more cheaply than a general one, and which keep a `Rect`
+  // query a `Rect` (the `Rect` overload of `AffineTransform::Apply` returns a
+  // `Quad`).
+  geometry_internal::VisitSpecializedQueryTransform(
+      query_to_this, [&](const auto& transform) {
+        VisitTrianglesIntersectingTransformedQuery(transform.Apply(query),
+                                                   visitor, meshes, rtree);
+      });
 }
 
 }  // namespace
@@ -333,7 +624,8 @@ void PartitionedMesh::VisitIntersectedTriangles(
   if (!data_) return;
 
   VisitIntersectedTrianglesHelper(query, visitor, query_to_this,
-                                  data_->Meshes(), data_->SpatialIndex());
+                                  data_->Meshes(),
+                                  data_->SpatialIndexForQuery());
 }
 
 void PartitionedMesh::VisitIntersectedTriangles(
@@ -343,7 +635,8 @@ void PartitionedMesh::VisitIntersectedTriangles(
   if (!data_) return;
 
   VisitIntersectedTrianglesHelper(query, visitor, query_to_this,
-                                  data_->Meshes(), data_->SpatialIndex());
+                                  data_->Meshes(),
+                                  data_->SpatialIndexForQuery());
 }
 
 void PartitionedMesh::VisitIntersectedTriangles(
@@ -353,7 +646,8 @@ void PartitionedMesh::VisitIntersectedTriangles(
   if (!data_) return;
 
   VisitIntersectedTrianglesHelper(query, visitor, query_to_this,
-                                  data_->Meshes(), data_->SpatialIndex());
+                                  data_->Meshes(),
+                                  data_->SpatialIndexForQuery());
 }
 
 void PartitionedMesh::VisitIntersectedTriangles(
@@ -363,7 +657,8 @@ void PartitionedMesh::VisitIntersectedTriangles(
   if (!data_) return;
 
   VisitIntersectedTrianglesHelper(query, visitor, query_to_this,
-                                  data_->Meshes(), data_->SpatialIndex());
+                                  data_->Meshes(),
+                                  data_->SpatialIndexForQuery());
 }
 
 void PartitionedMesh::VisitIntersectedTriangles(
@@ -373,7 +668,8 @@ void PartitionedMesh::VisitIntersectedTriangles(
   if (!data_) return;
 
   VisitIntersectedTrianglesHelper(query, visitor, query_to_this,
-                                  data_->Meshes(), data_->SpatialIndex());
+                                  data_->Meshes(),
+                                  data_->SpatialIndexForQuery());
 }
 
 namespace {
@@ -382,7 +678,7 @@ namespace {
 // `VisitIntersectedTriangles`, that handles the case in which the given
 // transform is invertible.
 void VisitIntersectedTrianglesWithPartitionedMeshWithInvertibleTransform(
-    absl::Span<const Mesh> meshes, const RTree& rtree,
+    absl::Span<const Mesh> meshes, const RTree* absl_nullable rtree,
     const PartitionedMesh& query, const AffineTransform& query_to_target,
     const AffineTransform& target_to_query,
     absl::FunctionRef<
@@ -417,7 +713,47 @@ void VisitIntersectedTrianglesWithPartitionedMeshWithInvertibleTransform(
     return true;
   };
 
-  rtree.VisitIntersectedElements(query_bounds, visitor_wrapper);
+  VisitTrianglesIntersectingBounds(meshes, rtree, query_bounds,
+                                   visitor_wrapper);
+}
+
+// This is a helper function for the `PartitionedMesh` overload of
+// `VisitIntersectedTriangles`, that handles the case in which the given
+// transform is invertible and both shapes' indices are available. Rather than
+// testing each candidate triangle against the whole of `query`, this walks
+// both indices at once, and tests only the pairs of triangles whose bounds
+// overlap.
+void VisitIntersectedTrianglesWithPartitionedMeshUsingBothIndices(
+    absl::Span<const Mesh> meshes, const RTree& rtree,
+    absl::Span<const Mesh> query_meshes, const RTree& query_rtree,
+    const AffineTransform& query_to_target,
+    const AffineTransform& target_to_query,
+    absl::FunctionRef<
+        PartitionedMesh::FlowControl(PartitionedMesh::TriangleIndexPair)>
+        visitor) {
+  // A target triangle may overlap many query triangles, but should only be
+  // visited once.
+  absl::flat_hash_set<uint32_t> visited_triangles;
+  rtree.VisitIntersectedElementPairs(
+      query_rtree, query_to_target,
+      [&meshes, &query_meshes, &target_to_query, &visited_triangles, visitor](
+          PartitionedMesh::TriangleIndexPair index,
+          PartitionedMesh::TriangleIndexPair query_index) {
+        uint32_t key =
+            (uint32_t{index.mesh_index} << 16) | index.triangle_index;
+        if (visited_triangles.contains(key)) return true;
+        // Test the pair in the query's coordinates, like the path above, so
+        // that triangles that only touch get the same answer either way.
+        if (!geometry_internal::IntersectsInternal(
+                target_to_query.Apply(
+                    meshes[index.mesh_index].GetTriangle(index.triangle_index)),
+                query_meshes[query_index.mesh_index].GetTriangle(
+                    query_index.triangle_index))) {
+          return true;
+        }
+        visited_triangles.insert(key);
+        return visitor(index) == PartitionedMesh::FlowControl::kContinue;
+      });
 }
 
 }  // namespace
@@ -438,9 +774,17 @@ void PartitionedMesh::VisitIntersectedTriangles(
   // approach is different depending on whether the transform is invertible.
   std::optional<AffineTransform> this_to_query = query_to_this.Inverse();
   if (this_to_query.has_value()) {
+    const RTree* absl_nullable rtree = data_->SpatialIndexForQuery();
+    const RTree* absl_nullable query_rtree =
+        query.data_->SpatialIndexForQuery();
+    if (rtree != nullptr && query_rtree != nullptr) {
+      VisitIntersectedTrianglesWithPartitionedMeshUsingBothIndices(
+          data_->Meshes(), *rtree, query.Meshes(), *query_rtree, query_to_this,
+          *this_to_query, visitor);
+      return;
+    }
     VisitIntersectedTrianglesWithPartitionedMeshWithInvertibleTransform(
-        data_->Meshes(), data_->SpatialIndex(), query, query_to_this,
-        *this_to_query, visitor);
+        data_->Meshes(), rtree, query, query_to_this, *this_to_query, visitor);
   } else {
     // Since `query_to_this` is not invertible, it must collapse `query` to
     // either a segment or a point.
@@ -453,6 +797,153 @@ void PartitionedMesh::VisitIntersectedTriangles(
 
 namespace {
 
+// This is a helper function for `FindIntersectingQueries` that handles the
+// logic for each kind of query transform.
+template <typename QueryType, typename QueryTransform>
+std::vector<size_t> FindIntersectingTransformedQueries(
+    absl::Span<const QueryType> queries, const QueryTransform& query_to_this,
+    absl::Span<const Mesh> meshes, const RTree* absl_nullable rtree) {
+  // This isn't `QueryType` because the `Rect` overload of
+  // `AffineTransform::Apply` returns a `Quad`, not a `Rect`.
+  using TransformedQueryType =
+      decltype(query_to_this.Apply(std::declval<QueryType>()));
+  std::vector<TransformedQueryType> transformed_queries;
+  std::vector<Rect> query_bounds;
+  transformed_queries.reserve(queries.size());
+  query_bounds.reserve(queries.size());
+  for (const QueryType& query : queries) {
+    transformed_queries.push_back(query_to_this.Apply(query));
+    query_bounds.push_back(*Envelope(transformed_queries.back()).AsRect());
+  }
+
+  std::vector<bool> is_hit(queries.size(), false);
+  // Records a hit and returns false if query `query_idx` intersects the
+  // triangle at `index`, and returns true otherwise.
+  auto check_triangle = [&transformed_queries, &meshes, &is_hit](
+                            uint32_t query_idx,
+                            PartitionedMesh::TriangleIndexPair index) {
+    if (!geometry_internal::IntersectsInternal(
+            transformed_queries[query_idx],
+            meshes[index.mesh_index].GetTriangle(index.triangle_index))) {
+      return true;
+    }
+    is_hit[query_idx] = true;
+    return false;
+  };
+  if (rtree != nullptr) {
+    rtree->VisitIntersectedElementsForEach(query_bounds, check_triangle);
+  } else {
+    for (uint32_t i = 0; i < queries.size(); ++i) {
+      VisitTrianglesIntersectingBounds(
+          meshes, nullptr, query_bounds[i],
+          [&check_triangle, i](PartitionedMesh::TriangleIndexPair index) {
+            return check_triangle(i, index);
+          });
+    }
+  }
+
+  std::vector<size_t> hits;
+  for (size_t i = 0; i < is_hit.size(); ++i) {
+    if (is_hit[i]) hits.push_back(i);
+  }
+  return hits;
+}
+
+// This is a helper function for `FindIntersectingQueries` that handles the
+// type-independent logic.
+template <typename QueryType>
+std::vector<size_t> FindIntersectingQueriesHelper(
+    absl::Span<const QueryType> queries, const AffineTransform& query_to_this,
+    absl::Span<const Mesh> meshes, const RTree* absl_nullable rtree) {
+  return geometry_internal::VisitSpecializedQueryTransform(
+      query_to_this, [&](const auto& transform) {
+        return FindIntersectingTransformedQueries(queries, transform, meshes,
+                                                  rtree);
+      });
+}
+
+}  // namespace
+
+std::vector<size_t> PartitionedMesh::FindIntersectingQueries(
+    absl::Span<const Point> queries,
+    const AffineTransform& query_to_this) const {
+  if (!data_) return {};
+  return FindIntersectingQueriesHelper(queries, query_to_this, data_->Meshes(),
+                                       data_->SpatialIndexForQuery());
+}
+
+std::vector<size_t> PartitionedMesh::FindIntersectingQueries(
+    absl::Span<const Segment> queries,
+    const AffineTransform& query_to_this) const {
+  if (!data_) return {};
+  return FindIntersectingQueriesHelper(queries, query_to_this, data_->Meshes(),
+                                       data_->SpatialIndexForQuery());
+}
+
+std::vector<size_t> PartitionedMesh::FindIntersectingQueries(
+    absl::Span<const Triangle> queries,
+    const AffineTransform& query_to_this) const {
+  if (!data_) return {};
+  return FindIntersectingQueriesHelper(queries, query_to_this, data_->Meshes(),
+                                       data_->SpatialIndexForQuery());
+}
+
+std::vector<size_t> PartitionedMesh::FindIntersectingQueries(
+    absl::Span<const Rect> queries,
+    const AffineTransform& query_to_this) const {
+  if (!data_) return {};
+  return FindIntersectingQueriesHelper(queries, query_to_this, data_->Meshes(),
+                                       data_->SpatialIndexForQuery());
+}
+
+std::vector<size_t> PartitionedMesh::FindIntersectingQueries(
+    absl::Span<const Quad> queries,
+    const AffineTransform& query_to_this) const {
+  if (!data_) return {};
+  return FindIntersectingQueriesHelper(queries, query_to_this, data_->Meshes(),
+                                       data_->SpatialIndexForQuery());
+}
+
+void PartitionedMesh::VisitTrianglesInBoundsDistanceOrder(
+    absl::FunctionRef<float(const Rect&)> bounds_distance,
+    absl::FunctionRef<FlowControl(TriangleIndexPair, float)> visitor) const {
+  if (!data_) return;
+
+  if (const RTree* absl_nullable rtree = data_->SpatialIndexForQuery();
+      rtree != nullptr) {
+    rtree->VisitElementsInBoundsDistanceOrder(
+        bounds_distance, [visitor](float distance, TriangleIndexPair index) {
+          return visitor(index, distance) == FlowControl::kContinue;
+        });
+    return;
+  }
+
+  // The index is still being built, so we find the distance to every
+  // triangle's bounds, and visit them in sorted order.
+  absl::Span<const Mesh> meshes = data_->Meshes();
+  std::vector<std::pair<float, TriangleIndexPair>> triangles;
+  for (uint32_t mesh_index = 0; mesh_index < meshes.size(); ++mesh_index) {
+    uint32_t n_tris = meshes[mesh_index].TriangleCount();
+    for (uint32_t triangle_index = 0; triangle_index < n_tris;
+         ++triangle_index) {
+      Rect bounds =
+          *Envelope(meshes[mesh_index].GetTriangle(triangle_index)).AsRect();
+      triangles.push_back(
+          {bounds_distance(bounds),
+           {.mesh_index = static_cast<uint16_t>(mesh_index),
+            .triangle_index = static_cast<uint16_t>(triangle_index)}});
+    }
+  }
+  absl::c_sort(triangles, [](const auto& a, const auto& b) {
+    return a.first < b.first;
+  });
+  for (const auto& [distance, index] : triangles) {
+    if (visitor(index, distance) == FlowControl::kBreak) return;
+  }
+}
+
+namespace {
+
 // This is a helper function for `Coverage` that contains the type-independent
 // logic for computing the proportion of the area covered by the query.
 template <typename QueryType>
@@ -568,51 +1059,568 @@ bool PartitionedMesh::CoverageIsGreaterThan(
                                      data_->TotalAbsoluteArea());
 }
 
-const RTree& PartitionedMesh::Data::SpatialIndex() const {
-  ABSL_CHECK(!meshes_.empty());
+namespace {
 
-  absl::MutexLock lock(&cache_mutex_);
+// Returns true if `query` contains all of `rect`. Since `Triangle` and `Quad`
+// are convex, that is the case when it contains all of `rect`'s corners.
+template <typename ConvexQueryType>
+bool ConvexQueryContainsRect(const ConvexQueryType& query, const Rect& rect) {
+  for (Point corner : rect.Corners()) {
+    if (!query.Contains(corner)) return false;
+  }
+  return true;
+}
 
-  // The index is already initialized, there's nothing to do.
-  // NOMUTANTS -- Removing this would not have an observable effect on behavior
-  // (just performance), since recomputating the index would yield the same
-  // result.
-  if (rtree_ != nullptr) return *rtree_;
+// One of the simple shapes, mapped into the target's coordinate space, that is
+// used as a query by `ApproximateCoverage` and the parallel overloads of
+// `CoverageIsGreaterThan`.
+template <typename TransformedQueryType>
+class SimpleCoverageQuery {
+ public:
+  explicit SimpleCoverageQuery(const TransformedQueryType& query)
+      : query_(query) {}
+
+  Rect Bounds() const { return *Envelope(query_).AsRect(); }
+  bool Intersects(const Triangle& triangle) const {
+    return geometry_internal::IntersectsInternal(query_, triangle);
+  }
+  // Returns true if `rect` is known to be inside the query; this may return
+  // false even if it is.
+  bool Contains(const Rect& rect) const {
+    if constexpr (std::is_same_v<TransformedQueryType, Segment>) {
+      return false;
+    } else {
+      return ConvexQueryContainsRect(query_, rect);
+    }
+  }
 
-  uint32_t n_tris = 0;
-  for (const Mesh& mesh : meshes_) n_tris += mesh.TriangleCount();
+ private:
+  TransformedQueryType query_;
+};
+
+// A `PartitionedMesh`, along with an invertible transform from it to the
+// target's coordinate space, used as a query in the same way as
+// `SimpleCoverageQuery`.
+class PartitionedMeshCoverageQuery {
+ public:
+  PartitionedMeshCoverageQuery(const PartitionedMesh& query,
+                               const AffineTransform& query_to_target,
+                               const AffineTransform& target_to_query)
+      : query_(query),
+        query_to_target_(query_to_target),
+        target_to_query_(target_to_query) {}
+
+  Rect Bounds() const {
+    return *Envelope(query_to_target_.Apply(*query_.Bounds().AsRect()))
+                .AsRect();
+  }
+  bool Intersects(const Triangle& triangle) const {
+    bool found_intersection = false;
+    query_.VisitIntersectedTriangles(
+        triangle,
+        [&found_intersection](PartitionedMesh::TriangleIndexPair) {
+          found_intersection = true;
+          return PartitionedMesh::FlowControl::kBreak;
+        },
+        target_to_query_);
+    return found_intersection;
+  }
+  bool Contains(const Rect&) const { return false; }
+
+ private:
+  const PartitionedMesh& query_;
+  AffineTransform query_to_target_;
+  AffineTransform target_to_query_;
+};
+
+// A triangle of the target whose bounds intersect the bounds of a coverage
+// query, but which has not yet been tested against the query itself.
+struct CoverageCandidate {
+  Triangle triangle;
+  float area;
+};
+
+// Finds the triangles of `meshes` whose bounds intersect the bounds of
+// `query`. Those whose bounds are inside `query` are known to be covered, and
+// their area is added to `covered_area`; the rest are returned, and their area
+// is added to `candidate_area`.
+template <typename CoverageQueryType>
+std::vector<CoverageCandidate> FindCoverageCandidates(
+    const CoverageQueryType& query, absl::Span<const Mesh> meshes,
+    const RTree* absl_nullable rtree, float& covered_area,
+    float& candidate_area) {
+  std::vector<CoverageCandidate> candidates;
+  VisitTrianglesIntersectingBounds(
+      meshes, rtree, query.Bounds(),
+      [&query, &meshes, &covered_area, &candidate_area,
+       &candidates](PartitionedMesh::TriangleIndexPair index) {
+        Triangle triangle =
+            meshes[index.mesh_index].GetTriangle(index.triangle_index);
+        float area = std::abs(triangle.SignedArea());
+        if (query.Contains(*Envelope(triangle).AsRect())) {
+          covered_area += area;
+        } else {
+          candidates.push_back({.triangle = triangle, .area = area});
+          candidate_area += area;
+        }
+        return true;
+      });
+  return candidates;
+}
+
+// This is a helper function for `ApproximateCoverage` that contains the
+// type-independent logic.
+template <typename CoverageQueryType>
+float ApproximateCoverageHelper(const CoverageQueryType& query,
+                                absl::Span<const Mesh> meshes,
+                                const RTree* absl_nullable rtree,
+                                float total_absolute_area, float max_error) {
+  float covered_area = 0;
+  float untested_area = 0;
+  std::vector<CoverageCandidate> candidates = FindCoverageCandidates(
+      query, meshes, rtree, covered_area, untested_area);
+
+  // Counting half of the untested area as covered is off by at most half of
+  // it, so we can stop testing once the untested area is within twice the
+  // allowed error.
+  float max_untested_area = 2 * std::max(max_error, 0.f) * total_absolute_area;
+  if (untested_area > max_untested_area) {
+    // Testing the largest triangles first brings the untested area down the
+    // fastest.
+    absl::c_sort(candidates,
+                 [](const CoverageCandidate& a, const CoverageCandidate& b) {
+                   return a.area > b.area;
+                 });
+    for (const CoverageCandidate& candidate : candidates) {
+      if (untested_area <= max_untested_area) break;
+      if (query.Intersects(candidate.triangle)) covered_area += candidate.area;
+      untested_area -= candidate.area;
+    }
+    // If every candidate was tested, `untested_area` may be left with some
+    // rounding error, which should not count towards the result.
+    if (max_untested_area == 0) untested_area = 0;
+  }
+  return (covered_area + untested_area / 2) / total_absolute_area;
+}
+
+// The number of candidate triangles that each task of
+// `ParallelCoverageIsGreaterThanHelper` tests.
+constexpr size_t kCoverageCandidatesPerTask = 256;
+
+// This is a helper function for the parallel overloads of
+// `CoverageIsGreaterThan` that contains the type-independent logic.
+template <typename CoverageQueryType>
+bool ParallelCoverageIsGreaterThanHelper(const CoverageQueryType& query,
+                                         absl::Span<const Mesh> meshes,
+                                         const RTree* absl_nullable rtree,
+                                         float total_absolute_area,
+                                         float coverage_threshold,
+                                         Executor& executor) {
+  float area_threshold = coverage_threshold * total_absolute_area;
+  float initial_covered_area = 0;
+  float initial_untested_area = 0;
+  std::vector<CoverageCandidate> candidates = FindCoverageCandidates(
+      query, meshes, rtree, initial_covered_area, initial_untested_area);
+  if (initial_covered_area > area_threshold) return true;
+  if (initial_covered_area + initial_untested_area <= area_threshold) {
+    return false;
+  }
+
+  std::atomic<float> covered_area = initial_covered_area;
+  std::atomic<float> untested_area = initial_untested_area;
+  size_t n_tasks = (candidates.size() + kCoverageCandidatesPerTask - 1) /
+                   kCoverageCandidatesPerTask;
+  ParallelFor(&executor, n_tasks, [&](size_t task_index) {
+    size_t begin = task_index * kCoverageCandidatesPerTask;
+    size_t end =
+        std::min(begin + kCoverageCandidatesPerTask, candidates.size());
+    for (size_t i = begin; i < end; ++i) {
+      // `untested_area` is loaded first, and reduced only after a triangle's
+      // area has been added to `covered_area`, so that their sum is never
+      // underestimated.
+      float untested = untested_area.load();
+      float covered = covered_area.load();
+      if (covered > area_threshold || covered + untested <= area_threshold) {
+        return;
+      }
+      if (query.Intersects(candidates[i].triangle)) {
+        covered_area.fetch_add(candidates[i].area);
+      }
+      untested_area.fetch_sub(candidates[i].area);
+    }
+  });
+  return covered_area.load() > area_threshold;
+}
+
+}  // namespace
+
+bool PartitionedMesh::CoverageIsGreaterThan(
+    const Triangle& query, float coverage_threshold, Executor& executor,
+    const AffineTransform& query_to_this) const {
+  if (data_ == nullptr) return false;
+  return geometry_internal::VisitSpecializedQueryTransform(
+      query_to_this, [&](const auto& transform) {
+        return ParallelCoverageIsGreaterThanHelper(
+            SimpleCoverageQuery(transform.Apply(query)), data_->Meshes(),
+            data_->SpatialIndexForQuery(), data_->TotalAbsoluteArea(),
+            coverage_threshold, executor);
+      });
+}
+
+bool PartitionedMesh::CoverageIsGreaterThan(
+    const Rect& query, float coverage_threshold, Executor& executor,
+    const AffineTransform& query_to_this) const {
+  if (data_ == nullptr) return false;
+  return geometry_internal::VisitSpecializedQueryTransform(
+      query_to_this, [&](const auto& transform) {
+        return ParallelCoverageIsGreaterThanHelper(
+            SimpleCoverageQuery(transform.Apply(query)), data_->Meshes(),
+            data_->SpatialIndexForQuery(), data_->TotalAbsoluteArea(),
+            coverage_threshold, executor);
+      });
+}
+
+bool PartitionedMesh::CoverageIsGreaterThan(
+    const Quad& query, float coverage_threshold, Executor& executor,
+    const AffineTransform& query_to_this) const {
+  if (data_ == nullptr) return false;
+  return geometry_internal::VisitSpecializedQueryTransform(
+      query_to_this, [&](const auto& transform) {
+        return ParallelCoverageIsGreaterThanHelper(
+            SimpleCoverageQuery(transform.Apply(query)), data_->Meshes(),
+            data_->SpatialIndexForQuery(), data_->TotalAbsoluteArea(),
+            coverage_threshold, executor);
+      });
+}
+
+bool PartitionedMesh::CoverageIsGreaterThan(
+    const PartitionedMesh& query, float coverage_threshold, Executor& executor,
+    const AffineTransform& query_to_this) const {
+  if (data_ == nullptr || query.Meshes().empty()) return false;
+  std::optional<AffineTransform> this_to_query = query_to_this.Inverse();
+  if (!this_to_query.has_value()) {
+    // Since `query_to_this` is not invertible, it collapses `query` to either
+    // a segment or a point.
+    return ParallelCoverageIsGreaterThanHelper(
+        SimpleCoverageQuery(geometry_internal::CalculateCollapsedSegment(
+            query.Meshes(), *query.Bounds().AsRect(), query_to_this)),
+        data_->Meshes(), data_->SpatialIndexForQuery(),
+        data_->TotalAbsoluteArea(), coverage_threshold, executor);
+  }
+  return ParallelCoverageIsGreaterThanHelper(
+      PartitionedMeshCoverageQuery(query, query_to_this, *this_to_query),
+      data_->Meshes(), data_->SpatialIndexForQuery(),
+      data_->TotalAbsoluteArea(), coverage_threshold, executor);
+}
+
+float PartitionedMesh::ApproximateCoverage(
+    const Triangle& query, float max_error,
+    const AffineTransform& query_to_this) const {
+  if (data_ == nullptr) return 0;
+  return geometry_internal::VisitSpecializedQueryTransform(
+      query_to_this, [&](const auto& transform) {
+        return ApproximateCoverageHelper(
+            SimpleCoverageQuery(transform.Apply(query)), data_->Meshes(),
+            data_->SpatialIndexForQuery(), data_->TotalAbsoluteArea(),
+            max_error);
+      });
+}
 
-  // This generates each valid `TriangleIndexPair` for this `PartitionedMesh`,
-  // in order of mesh index, then triangle index.
-  //
+float PartitionedMesh::ApproximateCoverage(
+    const Rect& query, float max_error,
+    const AffineTransform& query_to_this) const {
+  if (data_ == nullptr) return 0;
+  return geometry_internal::VisitSpecializedQueryTransform(
+      query_to_this, [&](const auto& transform) {
+        return ApproximateCoverageHelper(
+            SimpleCoverageQuery(transform.Apply(query)), data_->Meshes(),
+            data_->SpatialIndexForQuery(), data_->TotalAbsoluteArea(),
+            max_error);
+      });
+}
+
+float PartitionedMesh::ApproximateCoverage(
+    const Quad& query, float max_error,
+    const AffineTransform& query_to_this) const {
+  if (data_ == nullptr) return 0;
+  return geometry_internal::VisitSpecializedQueryTransform(
+      query_to_this, [&](const auto& transform) {
+        return ApproximateCoverageHelper(
+            SimpleCoverageQuery(transform.Apply(query)), data_->Meshes(),
+            data_->SpatialIndexForQuery(), data_->TotalAbsoluteArea(),
+            max_error);
+      });
+}
+
+float PartitionedMesh::ApproximateCoverage(
+    const PartitionedMesh& query, float max_error,
+    const AffineTransform& query_to_this) const {
+  if (data_ == nullptr || query.Meshes().empty()) return 0;
+  std::optional<AffineTransform> this_to_query = query_to_this.Inverse();
+  if (!this_to_query.has_value()) {
+    // Since `query_to_this` is not invertible, it collapses `query` to either
+    // a segment or a point.
+    return ApproximateCoverageHelper(
+        SimpleCoverageQuery(geometry_internal::CalculateCollapsedSegment(
+            query.Meshes(), *query.Bounds().AsRect(), query_to_this)),
+        data_->Meshes(), data_->SpatialIndexForQuery(),
+        data_->TotalAbsoluteArea(), max_error);
+  }
+  return ApproximateCoverageHelper(
+      PartitionedMeshCoverageQuery(query, query_to_this, *this_to_query),
+      data_->Meshes(), data_->SpatialIndexForQuery(),
+      data_->TotalAbsoluteArea(), max_error);
+}
+
+namespace {
+
+// Appends the bounding rectangle of each triangle in `mesh` to
+// `triangle_bounds`, in order of triangle index, reading the vertex positions
+// with `position(vertex_index)`.
+template <typename PositionFn>
+void AppendTriangleBounds(const Mesh& mesh, PositionFn position,
+                          std::vector<Rect>& triangle_bounds) {
+  uint32_t n_tris = mesh.TriangleCount();
+  for (uint32_t i = 0; i < n_tris; ++i) {
+    std::array<uint32_t, 3> indices = mesh.TriangleIndices(i);
+    Point p0 = position(indices[0]);
+    Point p1 = position(indices[1]);
+    Point p2 = position(indices[2]);
+    triangle_bounds.push_back(Rect::FromTwoPoints(
+        {std::min({p0.x, p1.x, p2.x}), std::min({p0.y, p1.y, p2.y})},
+        {std::max({p0.x, p1.x, p2.x}), std::max({p0.y, p1.y, p2.y})}));
+  }
+}
+
+// Appends the bounding rectangle of each triangle in `mesh` to
+// `triangle_bounds`, in order of triangle index. If the mesh has a position
+// cache, as it usually does by the time the spatial index is built, the
+// positions are read from it directly. Otherwise, they are decoded once each
+// up front, instead of once for every triangle that uses them.
+void AppendTriangleBounds(const Mesh& mesh,
+                          std::vector<Rect>& triangle_bounds) {
+  if (mesh.IsPositionCacheInitialized()) {
+    AppendTriangleBounds(
+        mesh, [&mesh](uint32_t i) { return mesh.VertexPosition(i); },
+        triangle_bounds);
+    return;
+  }
+  std::vector<Point> positions(mesh.VertexCount());
+  for (uint32_t i = 0; i < positions.size(); ++i) {
+    positions[i] = mesh.VertexPosition(i);
+  }
+  AppendTriangleBounds(
+      mesh, [&positions](uint32_t i) { return positions[i]; },
+      triangle_bounds);
+}
+
+// Returns a generator of each valid `TriangleIndexPair` for `meshes`, in order
+// of mesh index, then triangle index.
+auto MakeTriangleIndexPairGenerator(absl::Span<const Mesh> meshes) {
   // We want to start at mesh_index = 0, triangle_index = 0, but since they're
   // `uint16_t`s, we have to make a copy of the current index, then increment
   // the current value, then return the copy (analogous to the post-increment
   // operator).
-  auto triangle_index_pair_generator =
-      [this, current_index = TriangleIndexPair{.mesh_index = 0,
-                                               .triangle_index = 0}]() mutable {
-        TriangleIndexPair value_before_increment = current_index;
-        ++current_index.triangle_index;
-        if (current_index.triangle_index >=
-            meshes_[current_index.mesh_index].TriangleCount()) {
-          ++current_index.mesh_index;
-          current_index.triangle_index = 0;
-        }
-        return value_before_increment;
-      };
-  // This gets the bounds for a `TriangleIndexPair` by looking up the triangle
-  // in this `PartitionedMesh`'s meshes.
-  auto bounds_func = [&meshes = meshes_](TriangleIndexPair idx) {
-    return *Envelope(meshes[idx.mesh_index].GetTriangle(idx.triangle_index))
-                .AsRect();
+  return [meshes, current_index = PartitionedMesh::TriangleIndexPair{
+                      .mesh_index = 0, .triangle_index = 0}]() mutable {
+    PartitionedMesh::TriangleIndexPair value_before_increment = current_index;
+    ++current_index.triangle_index;
+    if (current_index.triangle_index >=
+        meshes[current_index.mesh_index].TriangleCount()) {
+      ++current_index.mesh_index;
+      current_index.triangle_index = 0;
+    }
+    return value_before_increment;
   };
-  rtree_ = std::make_unique<RTree>(n_tris, triangle_index_pair_generator,
-                                   bounds_func);
+}
+
+// Returns the bounds of each triangle in `meshes`, in the same order as the
+// generator returned by `MakeTriangleIndexPairGenerator`.
+std::vector<Rect> ComputeTriangleBounds(absl::Span<const Mesh> meshes) {
+  uint32_t n_tris = 0;
+  for (const Mesh& mesh : meshes) n_tris += mesh.TriangleCount();
+  std::vector<Rect> triangle_bounds;
+  triangle_bounds.reserve(n_tris);
+  for (const Mesh& mesh : meshes) AppendTriangleBounds(mesh, triangle_bounds);
+  return triangle_bounds;
+}
 
+// Builds the unpacked position cache of each of `meshes`, so that queries
+// using the spatial index (and computing the triangle bounds to build it) read
+// contiguous positions instead of unpacking the interleaved vertex data. See
+// `Mesh::InitializePositionCache`. If `packed_position_queries` is
+// `kTestPackedPositions`, meshes with packed integer positions are skipped,
+// since queries test those positions directly.
+void InitializePositionCaches(
+    absl::Span<const Mesh> meshes,
+    PartitionedMesh::PackedPositionQueries packed_position_queries) {
+  for (const Mesh& mesh : meshes) {
+    if (packed_position_queries ==
+            PartitionedMesh::PackedPositionQueries::kTestPackedPositions &&
+        mesh.HasPackedIntegerPositions()) {
+      continue;
+    }
+    mesh.InitializePositionCache();
+  }
+}
+
+// Returns a newly built spatial index for `meshes`.
+std::unique_ptr<const RTree> BuildSpatialIndex(
+    absl::Span<const Mesh> meshes,
+    PartitionedMesh::PackedPositionQueries packed_position_queries) {
+  ScopedTraceEvent trace_event("ink::PartitionedMesh::InitializeSpatialIndex");
+  InitializePositionCaches(meshes, packed_position_queries);
+  return std::make_unique<RTree>(MakeTriangleIndexPairGenerator(meshes),
+                                 ComputeTriangleBounds(meshes));
+}
+
+}  // namespace
+
+const RTree& PartitionedMesh::Data::SpatialIndex() const {
+  ABSL_CHECK(!meshes_.empty());
+
+  // The index is already initialized, there's nothing to do.
+  if (const RTree* rtree = published_rtree_.load(std::memory_order_acquire)) {
+    return *rtree;
+  }
+
+  absl::MutexLock lock(&cache_mutex_);
+  // NOMUTANTS -- Removing this would not have an observable effect on behavior
+  // (just performance), since recomputating the index would yield the same
+  // result.
+  if (rtree_ != nullptr) return *rtree_;
+
+  if (pending_spatial_index_queries_.has_value()) {
+    // The index is being built in the background; wait for it rather than
+    // building a second copy.
+    cache_mutex_.Await(absl::Condition(
+        +[](std::unique_ptr<const RTree>* rtree) { return *rtree != nullptr; },
+        &rtree_));
+    return *rtree_;
+  }
+
+  SetSpatialIndex(BuildSpatialIndex(meshes_, packed_position_queries_));
   return *rtree_;
 }
 
+const RTree* absl_nullable PartitionedMesh::Data::SpatialIndexForQuery() const {
+  if (const RTree* rtree = published_rtree_.load(std::memory_order_acquire)) {
+    return rtree;
+  }
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    if (rtree_ == nullptr && pending_spatial_index_queries_ ==
+                                 PendingSpatialIndexQueries::kBruteForce) {
+      return nullptr;
+    }
+  }
+  return &SpatialIndex();
+}
+
+void PartitionedMesh::Data::SetPackedPositionQueries(
+    PackedPositionQueries packed_position_queries) const {
+  absl::MutexLock lock(&cache_mutex_);
+  packed_position_queries_ = packed_position_queries;
+}
+
+bool PartitionedMesh::Data::BeginAsyncSpatialIndexInitialization(
+    PendingSpatialIndexQueries pending_queries) const {
+  ABSL_CHECK(!meshes_.empty());
+
+  absl::MutexLock lock(&cache_mutex_);
+  if (rtree_ != nullptr || pending_spatial_index_queries_.has_value()) {
+    return false;
+  }
+  pending_spatial_index_queries_ = pending_queries;
+  return true;
+}
+
+void PartitionedMesh::Data::FinishAsyncSpatialIndexInitialization() const {
+  PackedPositionQueries packed_position_queries;
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    packed_position_queries = packed_position_queries_;
+  }
+  // The index is built without holding the lock, so that queries using the
+  // brute-force fallback aren't blocked in the meantime.
+  std::unique_ptr<const RTree> rtree =
+      BuildSpatialIndex(meshes_, packed_position_queries);
+
+  absl::MutexLock lock(&cache_mutex_);
+  pending_spatial_index_queries_.reset();
+  // The index may have been initialized some other way in the meantime, e.g.
+  // by `InitializeSpatialIndexFromBranchNodes()`.
+  if (rtree_ == nullptr) SetSpatialIndex(std::move(rtree));
+}
+
+void PartitionedMesh::Data::SetSpatialIndex(
+    absl_nonnull std::unique_ptr<const RTree> rtree) const {
+  ABSL_DCHECK(rtree_ == nullptr);
+  rtree_ = std::move(rtree);
+  published_rtree_.store(rtree_.get(), std::memory_order_release);
+}
+
+absl::Status PartitionedMesh::Data::InitializeSpatialIndexFromBranchNodes(
+    std::vector<RTree::BranchNode> branch_nodes) const {
+  ABSL_CHECK(!meshes_.empty());
+
+  absl::MutexLock lock(&cache_mutex_);
+  if (rtree_ != nullptr) return absl::OkStatus();
+
+  ScopedTraceEvent trace_event(
+      "ink::PartitionedMesh::InitializeSpatialIndexFromStructure");
+  InitializePositionCaches(meshes_, packed_position_queries_);
+  absl::StatusOr<RTree> rtree = RTree::FromBranchNodes(
+      MakeTriangleIndexPairGenerator(meshes_), ComputeTriangleBounds(meshes_),
+      std::move(branch_nodes));
+  if (!rtree.ok()) return rtree.status();
+  SetSpatialIndex(std::make_unique<RTree>(*std::move(rtree)));
+  return absl::OkStatus();
+}
+
+namespace {
+
+// Returns the number of bytes `vector` has allocated on the heap, which is
+// zero while its elements fit inline.
+template <typename T, size_t N>
+size_t HeapBytes(const absl::InlinedVector<T, N>& vector) {
+  return vector.capacity() > N ? vector.capacity() * sizeof(T) : 0;
+}
+
+}  // namespace
+
+void PartitionedMesh::Data::AddToMemoryFootprint(
+    MemoryFootprint& footprint) const {
+  if (!footprint.AddShared(this)) return;
+
+  size_t bytes =
+      sizeof(Data) + HeapBytes(meshes_) +
+      outline_vertex_indices_.capacity() * sizeof(uint16_t) +
+      outline_mesh_runs_.capacity() * sizeof(OutlineView::MeshRun) +
+      HeapBytes(outline_starts_) + HeapBytes(group_first_mesh_indices_) +
+      HeapBytes(group_first_outline_indices_) + HeapBytes(group_formats_);
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    if (rtree_ != nullptr) {
+      bytes += sizeof(RTree) +
+               rtree_->BranchNodes().size() * sizeof(RTree::BranchNode) +
+               rtree_->Elements().size() * sizeof(TriangleIndexPair);
+    }
+    bytes += simplified_outlines_.capacity() *
+             sizeof(decltype(simplified_outlines_)::value_type);
+    for (const auto& [key, positions] : simplified_outlines_) {
+      bytes += positions.capacity() * sizeof(Point);
+    }
+  }
+  footprint.AddBytes(bytes);
+
+  // The meshes may also be shared with other `PartitionedMesh`es, so they
+  // count themselves.
+  for (const Mesh& mesh : meshes_) {
+    mesh.AddToMemoryFootprint(footprint);
+  }
+}
+
 float PartitionedMesh::Data::TotalAbsoluteArea() const {
   ABSL_CHECK(!meshes_.empty());
 
@@ -629,4 +1637,47 @@ float PartitionedMesh::Data::TotalAbsoluteArea() const {
   return *cached_total_absolute_area_;
 }
 
+absl::Span<const Point> PartitionedMesh::SimplifiedOutline(
+    uint32_t group_index, uint32_t outline_index, float tolerance) const {
+  ABSL_CHECK_LT(outline_index, OutlineCount(group_index));
+  return data_->SimplifiedOutline(group_index, outline_index, tolerance);
+}
+
+absl::Span<const Point> PartitionedMesh::Data::SimplifiedOutline(
+    uint32_t group_index, uint32_t outline_index, float tolerance) const {
+  // Rounding the tolerance down to a power of two bounds the number of cached
+  // levels, while still honoring the requested tolerance.
+  int level = tolerance > 0 ? std::ilogb(tolerance)
+                            : std::numeric_limits<int>::min();
+  std::pair<uint32_t, int> key = {
+      group_first_outline_indices_[group_index] + outline_index, level};
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    auto it = simplified_outlines_.find(key);
+    if (it != simplified_outlines_.end()) return it->second;
+  }
+
+  // Compute the outline without holding the lock, so that concurrent queries
+  // on other cached values aren't blocked.
+  absl::Span<const Mesh> meshes = RenderGroupMeshes(group_index);
+  OutlineView outline = Outline(key.first);
+  std::vector<Point> positions;
+  positions.reserve(outline.size());
+  for (VertexIndexPair index : outline) {
+    positions.push_back(
+        meshes[index.mesh_index].VertexPosition(index.vertex_index));
+  }
+  if (tolerance > 0) {
+    positions = geometry_internal::SimplifyClosedPolyline(
+        positions, std::ldexp(1.f, level));
+  }
+  positions.shrink_to_fit();
+
+  absl::MutexLock lock(&cache_mutex_);
+  // If another thread got here first, its result is kept, since spans over it
+  // may already have been returned.
+  return simplified_outlines_.try_emplace(key, std::move(positions))
+      .first->second;
+}
+
 }  // namespace ink
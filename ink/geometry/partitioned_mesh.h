@@ -15,8 +15,11 @@
 #ifndef INK_GEOMETRY_PARTITIONED_MESH_H_
 #define INK_GEOMETRY_PARTITIONED_MESH_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -24,9 +27,11 @@
 
 #include "absl/base/nullability.h"
 #include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/function_ref.h"
 #include "absl/log/absl_check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
@@ -42,6 +47,9 @@
 #include "ink/geometry/rect.h"
 #include "ink/geometry/segment.h"
 #include "ink/geometry/triangle.h"
+#include "ink/types/allocator.h"
+#include "ink/types/executor.h"
+#include "ink/types/memory_footprint.h"
 
 namespace ink {
 
@@ -81,6 +89,103 @@ class PartitionedMesh {
     uint16_t triangle_index;
   };
 
+  // A read-only view of the `VertexIndexPair`s of one outline; see `Outline()`.
+  //
+  // Outlines are stored compactly: each vertex index takes 16 bits, and the
+  // mesh index is stored once for each run of consecutive vertices in the same
+  // mesh, of which there is usually only one. Iterating over an outline is
+  // about as cheap as iterating over a span of `VertexIndexPair`s, and should
+  // be preferred to `operator[]`, which is logarithmic in the number of runs.
+  //
+  // A view is only valid while the `PartitionedMesh` that it came from, or a
+  // copy of it, is alive.
+  class OutlineView {
+   public:
+    // The end of a run of consecutive outline vertices in the same mesh, i.e.
+    // the position within the outline of the vertex after the run.
+    struct MeshRun {
+      uint32_t end;
+      uint16_t mesh_index;
+    };
+
+    // A forward iterator over the `VertexIndexPair`s of an outline, which are
+    // returned by value.
+    class Iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = VertexIndexPair;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = VertexIndexPair;
+
+      Iterator() = default;
+
+      VertexIndexPair operator*() const {
+        return {.mesh_index = run_->mesh_index,
+                .vertex_index = vertex_indices_[position_]};
+      }
+      Iterator& operator++() {
+        if (++position_ == run_->end) ++run_;
+        return *this;
+      }
+      Iterator operator++(int) {
+        Iterator copy = *this;
+        ++*this;
+        return copy;
+      }
+
+      friend bool operator==(const Iterator& a, const Iterator& b) {
+        return a.vertex_indices_ + a.position_ ==
+               b.vertex_indices_ + b.position_;
+      }
+
+     private:
+      friend class OutlineView;
+
+      Iterator(const uint16_t* vertex_indices, uint32_t position,
+               const MeshRun* run)
+          : vertex_indices_(vertex_indices), position_(position), run_(run) {}
+
+      const uint16_t* vertex_indices_ = nullptr;
+      uint32_t position_ = 0;
+      const MeshRun* run_ = nullptr;
+    };
+
+    using value_type = VertexIndexPair;
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+    using size_type = size_t;
+
+    // Constructs an empty view.
+    OutlineView() = default;
+
+    size_t size() const { return vertex_indices_.size(); }
+    bool empty() const { return vertex_indices_.empty(); }
+
+    Iterator begin() const {
+      return Iterator(vertex_indices_.data(), 0, mesh_runs_.data());
+    }
+    Iterator end() const {
+      return Iterator(vertex_indices_.data(), vertex_indices_.size(),
+                      mesh_runs_.data() + mesh_runs_.size());
+    }
+
+    // Returns the vertex at `index`, which must be less than `size()`.
+    VertexIndexPair operator[](size_t index) const;
+    VertexIndexPair front() const { return (*this)[0]; }
+    VertexIndexPair back() const { return (*this)[size() - 1]; }
+
+   private:
+    friend class PartitionedMesh;
+
+    OutlineView(absl::Span<const uint16_t> vertex_indices,
+                absl::Span<const MeshRun> mesh_runs)
+        : vertex_indices_(vertex_indices), mesh_runs_(mesh_runs) {}
+
+    absl::Span<const uint16_t> vertex_indices_;
+    absl::Span<const MeshRun> mesh_runs_;
+  };
+
   // One render group for a `PartitionedMesh`, expressed using `MutableMesh`.
   struct MutableMeshGroup {
     // TODO: b/295166196 - Once `MutableMesh` always uses 16-bit indices, change
@@ -92,6 +197,15 @@ class PartitionedMesh {
     // stripped out during construction of the `PartitionedMesh`.
     absl::Span<const MeshFormat::AttributeId> omit_attributes;
     absl::Span<const std::optional<MeshAttributeCodingParams>> packing_params;
+    // How the triangles and vertices of the resulting meshes are ordered; see
+    // `MutableMesh::AsMeshes`. The outlines are remapped to match.
+    MutableMesh::TriangleOrder triangle_order =
+        MutableMesh::TriangleOrder::kPreserve;
+    // Whether duplicate vertices are merged; see `MutableMesh::AsMeshes`. The
+    // outlines are remapped to the merged vertices, dropping any consecutive
+    // repeats of a vertex that this creates.
+    MutableMesh::VertexWelding vertex_welding =
+        MutableMesh::VertexWelding::kNone;
   };
 
   // One render group for a `PartitionedMesh`, expressed using `Mesh`.
@@ -116,7 +230,9 @@ class PartitionedMesh {
   // (non-mutable) `Mesh`es via `mesh.AsMeshes()`. `outlines`, if given, should
   // contain spans of indices into `mesh`, each describing an outline.
   // `packing_params`, if given, will be used instead of the default
-  // MeshAttributeCodingParams. Returns an error if:
+  // MeshAttributeCodingParams. If `executor` is non-null, it is passed to
+  // `mesh.AsMeshes()` to pack the partitions concurrently, and `allocator` is
+  // passed along to provide the memory for the meshes. Returns an error if:
   // - `mesh.AsMeshes()` fails.
   // - `outlines` contains any index >= `mesh.VertexCount()`
   // TODO: b/295166196 - Once `MutableMesh` always uses 16-bit indices, this can
@@ -127,16 +243,22 @@ class PartitionedMesh {
       absl::Span<const absl::Span<const uint32_t>> outlines = {},
       absl::Span<const MeshFormat::AttributeId> omit_attributes = {},
       absl::Span<const std::optional<MeshAttributeCodingParams>>
-          packing_params = {});
-
-  // Constructs a `PartitionedMesh` with zero or more render groups. Returns an
-  // error if:
+          packing_params = {},
+      Executor* absl_nullable executor = nullptr,
+      Allocator* absl_nullable allocator = nullptr);
+
+  // Constructs a `PartitionedMesh` with zero or more render groups. If
+  // `executor` is non-null, it is passed to `AsMeshes()` to pack the
+  // partitions of each mesh concurrently, and `allocator` is passed along to
+  // provide the memory for the meshes. Returns an error if:
   // - `AsMeshes()` fails for any of the meshes.
   // - The total number of `Mesh` objects post-`AsMeshes()` across all groups is
   //   more than 65536 (2^16).
   // - Any outline contains any element that does not correspond to a vertex.
   static absl::StatusOr<PartitionedMesh> FromMutableMeshGroups(
-      absl::Span<const MutableMeshGroup> groups);
+      absl::Span<const MutableMeshGroup> groups,
+      Executor* absl_nullable executor = nullptr,
+      Allocator* absl_nullable allocator = nullptr);
 
   // Constructs a `PartitionedMesh` from a span of `Mesh`es. `outlines`, if
   // given, should contain spans of `VertexIndexPair`s, each describing an
@@ -195,16 +317,17 @@ class PartitionedMesh {
   // This method CHECK-fails if `group_index` >= `RenderGroupCount()`.
   uint32_t OutlineCount(uint32_t group_index) const;
 
-  // Returns a span over the `VertexIndexPair`s specifying the outline at
+  // Returns a view of the `VertexIndexPair`s specifying the outline at
   // `outline_index` within render group `group_index`. The `mesh_index` of each
   // `VertexIndexPair` in the returned outline is an index into the span
-  // returned by `RenderGroupMeshes(group_index)`.
+  // returned by `RenderGroupMeshes(group_index)`. Outlines are stored
+  // compactly, so prefer iterating over the view to indexing into it; see
+  // `OutlineView`.
   //
   // This method CHECK-fails if `group_index` >= `RenderGroupCount()` or if
-  // `outline_index` >= `OutlineCount(group_index)`. The returned span is
+  // `outline_index` >= `OutlineCount(group_index)`. The returned view is
   // guaranteed to be non-empty.
-  absl::Span<const VertexIndexPair> Outline(uint32_t group_index,
-                                            uint32_t outline_index) const;
+  OutlineView Outline(uint32_t group_index, uint32_t outline_index) const;
 
   // Returns the position of the vertex at `vertex_index` in the outline at
   // `outline_index` within render group `group_index`. This is equivalent to:
@@ -228,6 +351,24 @@ class PartitionedMesh {
   uint32_t OutlineVertexCount(uint32_t group_index,
                               uint32_t outline_index) const;
 
+  // Returns the positions of the outline at `outline_index` within render
+  // group `group_index`, simplified so that every dropped vertex lies within
+  // `tolerance` of the simplified outline. This is meant for selection hit
+  // testing, export and path rendering, which rarely need every outline vertex.
+  //
+  // `tolerance` is rounded down to a power of two, and the result for each
+  // such level is computed on first use and cached; the cache is shared
+  // between copies of this `PartitionedMesh`. A `tolerance` of zero or less
+  // gives every outline position, in order. The returned span is non-empty,
+  // and stays valid as long as this `PartitionedMesh` or any copy of it is
+  // alive.
+  //
+  // This method CHECK-fails if `group_index` >= `RenderGroupCount()` or if
+  // `outline_index` >= `OutlineCount(group_index)`.
+  absl::Span<const Point> SimplifiedOutline(uint32_t group_index,
+                                            uint32_t outline_index,
+                                            float tolerance) const;
+
   // Fetches the bounds of the `PartitionedMesh`, i.e. the bounds of its
   // `Mesh`es. The bounds will be empty if the meshes are empty.
   Envelope Bounds() const;
@@ -238,11 +379,107 @@ class PartitionedMesh {
   // explicitly mutable cache fields (i.e. it does not affect behavior, only
   // performance, and is safe to do when changes to the contents are not
   // expected).
+  //
+  // Building the spatial index also builds each mesh's unpacked position cache
+  // (see `Mesh::InitializePositionCache`), so that queries don't have to
+  // unpack interleaved vertex data. This costs an extra 8 bytes per vertex,
+  // which is included in `AddToMemoryFootprint`; see `SetPackedPositionQueries`
+  // to avoid it for meshes with packed positions.
   void InitializeSpatialIndex() const;
 
-  // Returns true if the spatial index has already been initialized.
+  // How queries read the positions of meshes whose vertex positions are packed
+  // into integers (see `Mesh::HasPackedIntegerPositions`).
+  enum class PackedPositionQueries : uint8_t {
+    // Building the spatial index also builds the unpacked position cache of
+    // each mesh, and queries read positions from it. This is the default.
+    kUsePositionCache,
+    // No position cache is built for meshes with packed integer positions.
+    // Instead, each query is transformed into the packed integer space of each
+    // mesh (see `Mesh::PositionToPackedIntegerTransform`), and tested directly
+    // against the packed positions. This saves 8 bytes per vertex, at the cost
+    // of decoding the packed positions in each triangle test, which is still
+    // cheaper than unpacking them.
+    kTestPackedPositions,
+  };
+
+  // Sets how queries read packed vertex positions. This only affects the
+  // position caches built along with the spatial index, so it should be called
+  // before the index is initialized; a mesh whose position cache has already
+  // been built keeps using it. Like the spatial index, this setting is shared
+  // between copies of the `PartitionedMesh`. This is a no-op if the
+  // `PartitionedMesh` contains no meshes.
+  //
+  // Whatever the setting, queries test packed positions directly for meshes
+  // that have no position cache, e.g. while the spatial index is being built
+  // by `InitializeSpatialIndexAsync` with `kBruteForce` pending queries.
+  void SetPackedPositionQueries(
+      PackedPositionQueries packed_position_queries) const;
+
+  // How queries behave while the spatial index is being built in the
+  // background by `InitializeSpatialIndexAsync`.
+  enum class PendingSpatialIndexQueries : uint8_t {
+    // Queries block until the spatial index is ready, then use it.
+    kWait,
+    // Queries don't block, and instead test every triangle until the spatial
+    // index is ready. This is slower per query, but avoids stalling e.g. the UI
+    // thread on the first query.
+    kBruteForce,
+  };
+
+  // Schedules initialization of the spatial index on `executor`, and returns
+  // without waiting for it to finish. `pending_queries` determines how queries
+  // made in the meantime behave. This is a no-op if the spatial index has
+  // already been initialized or scheduled for initialization, or if the
+  // `PartitionedMesh` contains no meshes.
+  //
+  // The scheduled task keeps the underlying data alive, so the
+  // `PartitionedMesh` may be destroyed before the task runs.
+  void InitializeSpatialIndexAsync(
+      Executor& executor, PendingSpatialIndexQueries pending_queries =
+                              PendingSpatialIndexQueries::kWait) const;
+
+  // Returns true if the spatial index has already been initialized. This does
+  // not block, even if the index is being built in the background.
   bool IsSpatialIndexInitialized() const;
 
+  // The structure of the spatial index, in a form that can be stored alongside
+  // the meshes and later passed to `InitializeSpatialIndexFromStructure`, so
+  // that the index doesn't need to be rebuilt after loading.
+  struct SpatialIndexStructure {
+    // For each node of the index, whether its children are triangles (true) or
+    // other nodes (false).
+    std::vector<bool> node_is_leaf_parent;
+    // For each node of the index, the number of children that it has.
+    std::vector<uint32_t> node_child_counts;
+    // The children of every node, concatenated in node order. The children of
+    // a node whose children are triangles are positions in the sequence of all
+    // triangles, ordered by mesh index and then triangle index; the children of
+    // other nodes are node indices.
+    std::vector<uint32_t> child_indices;
+  };
+
+  // Returns the structure of the spatial index, initializing the index first
+  // if needed. The structure will be empty if the `PartitionedMesh` contains no
+  // meshes.
+  SpatialIndexStructure GetSpatialIndexStructure() const;
+
+  // Initializes the spatial index from `structure`, which should have been
+  // returned by `GetSpatialIndexStructure` for a `PartitionedMesh` with the
+  // same meshes. This is much cheaper than building the index from scratch,
+  // since it only needs to compute the bounds of the nodes. This is a no-op if
+  // the spatial index has already been initialized.
+  //
+  // Returns an error if `structure` is not a valid index for the triangles of
+  // this `PartitionedMesh`, in which case the index is left uninitialized.
+  absl::Status InitializeSpatialIndexFromStructure(
+      const SpatialIndexStructure& structure) const;
+
+  // Adds the memory held by this `PartitionedMesh` to `footprint`, including
+  // its meshes, its outlines, and its spatial index if that has been
+  // initialized. This data is shared between copies of the `PartitionedMesh`,
+  // and so is only counted once per `footprint`.
+  void AddToMemoryFootprint(MemoryFootprint& footprint) const;
+
   // This enumerator is returned by visitor functions, indicating
   // whether the search should continue to the next element, or stop.
   enum class FlowControl : uint8_t { kBreak, kContinue };
@@ -282,6 +519,44 @@ class PartitionedMesh {
       absl::FunctionRef<FlowControl(TriangleIndexPair)> visitor,
       const AffineTransform& query_to_this = {}) const;
 
+  // Returns the indices, in increasing order, of the elements of `queries` that
+  // intersect this `PartitionedMesh`, as per the `Intersects` family of
+  // functions. `query_to_this` maps from the queries' coordinate space to this
+  // `PartitionedMesh`'s coordinate space, and applies to all of them.
+  //
+  // This gives the same result as testing each query separately, but is much
+  // faster when there are many queries (e.g. the swept samples of an eraser
+  // gesture): the transform is applied to each query once, and all of the
+  // queries share a single traversal of the index. This will initialize the
+  // index if it has not already been done.
+  std::vector<size_t> FindIntersectingQueries(
+      absl::Span<const Point> queries,
+      const AffineTransform& query_to_this = {}) const;
+  std::vector<size_t> FindIntersectingQueries(
+      absl::Span<const Segment> queries,
+      const AffineTransform& query_to_this = {}) const;
+  std::vector<size_t> FindIntersectingQueries(
+      absl::Span<const Triangle> queries,
+      const AffineTransform& query_to_this = {}) const;
+  std::vector<size_t> FindIntersectingQueries(
+      absl::Span<const Rect> queries,
+      const AffineTransform& query_to_this = {}) const;
+  std::vector<size_t> FindIntersectingQueries(
+      absl::Span<const Quad> queries,
+      const AffineTransform& query_to_this = {}) const;
+
+  // Visits the triangles in increasing order of `bounds_distance` applied to
+  // their bounding boxes, until `visitor` returns `kBreak`. `visitor` is
+  // called with the triangle and that distance. This is the building block for
+  // nearest-triangle searches, such as the `PartitionedMesh` overloads of
+  // `Distance`; see `StaticRTree::VisitElementsInBoundsDistanceOrder` for the
+  // requirements on `bounds_distance`.
+  //
+  // This will initialize the index if it has not already been done.
+  void VisitTrianglesInBoundsDistanceOrder(
+      absl::FunctionRef<float(const Rect&)> bounds_distance,
+      absl::FunctionRef<FlowControl(TriangleIndexPair, float)> visitor) const;
+
   // Computes an approximate measure of what portion of the `PartitionedMesh` is
   // covered by or overlaps with `query`. This is calculated by finding the sum
   // of areas of the triangles that intersect the given object, and dividing
@@ -336,6 +611,47 @@ class PartitionedMesh {
                              float coverage_threshold,
                              const AffineTransform& query_to_this = {}) const;
 
+  // Same as the overloads above, but splits the intersection tests between the
+  // threads of `executor`. The tests stop as soon as the result is known:
+  // either the covered area has passed the threshold, or the triangles not yet
+  // tested are too small to bring it past the threshold. This only pays off
+  // for large meshes; for small ones, the overloads above are faster.
+  bool CoverageIsGreaterThan(const Triangle& query, float coverage_threshold,
+                             Executor& executor,
+                             const AffineTransform& query_to_this = {}) const;
+  bool CoverageIsGreaterThan(const Rect& query, float coverage_threshold,
+                             Executor& executor,
+                             const AffineTransform& query_to_this = {}) const;
+  bool CoverageIsGreaterThan(const Quad& query, float coverage_threshold,
+                             Executor& executor,
+                             const AffineTransform& query_to_this = {}) const;
+  bool CoverageIsGreaterThan(const PartitionedMesh& query,
+                             float coverage_threshold, Executor& executor,
+                             const AffineTransform& query_to_this = {}) const;
+
+  // Returns an approximation of `Coverage(query, query_to_this)` that differs
+  // from it by at most `max_error`. With a larger `max_error`, this runs fewer
+  // exact intersection tests. It is meant for cases like live lasso selection,
+  // where the coverage of many shapes is checked every frame.
+  //
+  // A triangle whose bounding box lies entirely inside `query` must intersect
+  // it, so it counts as covered without an exact test (this applies only to
+  // `Triangle`, `Rect` and `Quad` queries). The remaining triangles whose
+  // bounds overlap the query are tested from the largest down. Once the
+  // untested ones add up to no more than 2 * `max_error` of the total area,
+  // the tests stop, and half of the untested area counts as covered.
+  //
+  // On an empty `PartitionedMesh`, this will always return 0. A `max_error` of
+  // zero or less gives the same result as `Coverage`.
+  float ApproximateCoverage(const Triangle& query, float max_error,
+                            const AffineTransform& query_to_this = {}) const;
+  float ApproximateCoverage(const Rect& query, float max_error,
+                            const AffineTransform& query_to_this = {}) const;
+  float ApproximateCoverage(const Quad& query, float max_error,
+                            const AffineTransform& query_to_this = {}) const;
+  float ApproximateCoverage(const PartitionedMesh& query, float max_error,
+                            const AffineTransform& query_to_this = {}) const;
+
  private:
   // Convenience alias for the R-Tree.
   using RTree = geometry_internal::StaticRTree<TriangleIndexPair>;
@@ -358,19 +674,56 @@ class PartitionedMesh {
     const MeshFormat& RenderGroupFormat(uint32_t group_index) const;
     absl::Span<const Mesh> RenderGroupMeshes(uint32_t group_index) const;
     absl::Span<const Mesh> Meshes() const;
-    absl::Span<const std::vector<VertexIndexPair>> Outlines(
-        uint32_t group_index) const;
-
-    // Fetches the spatial index, initializing it if needed. This CHECK-fails
-    // if `Meshes()` is empty; this is expected to be guaranteed by the caller.
+    uint32_t OutlineCount(uint32_t group_index) const;
+    // Returns the outline at `outline_index` among all of the outlines, i.e.
+    // counting from the first outline of the first group.
+    OutlineView Outline(uint32_t outline_index) const;
+    uint32_t GroupFirstOutlineIndex(uint32_t group_index) const;
+
+    // Fetches the spatial index, initializing it if needed, or waiting for it
+    // if it is being initialized in the background. This CHECK-fails if
+    // `Meshes()` is empty; this is expected to be guaranteed by the caller.
     //
     // The spatial index's structure only depends on the `Mesh`es, which are
     // immutable, so the it never needs to be invalidated.
     const RTree& SpatialIndex() const;
 
+    // Like `SpatialIndex()`, except that this returns null instead of waiting
+    // if the index is being initialized in the background with
+    // `PendingSpatialIndexQueries::kBruteForce`; in that case, the caller
+    // should test every triangle instead.
+    const RTree* absl_nullable SpatialIndexForQuery() const;
+
+    // Sets the value used when building position caches along with the
+    // spatial index; see `PartitionedMesh::SetPackedPositionQueries`.
+    void SetPackedPositionQueries(
+        PackedPositionQueries packed_position_queries) const;
+
+    // Marks the spatial index as being initialized in the background, and
+    // returns true if the caller should go on to call
+    // `FinishAsyncSpatialIndexInitialization()`. Returns false if the index is
+    // already initialized or pending. This CHECK-fails if `Meshes()` is empty.
+    bool BeginAsyncSpatialIndexInitialization(
+        PendingSpatialIndexQueries pending_queries) const;
+
+    // Builds the spatial index that was marked as pending by
+    // `BeginAsyncSpatialIndexInitialization()`, and wakes up any waiting
+    // queries.
+    void FinishAsyncSpatialIndexInitialization() const;
+
     // Returns true if the spatial index has already been initialized.
     bool IsSpatialIndexInitialized() const;
 
+    // Initializes the spatial index from `branch_nodes`, per
+    // `RTree::FromBranchNodes`. This is a no-op if the index has already been
+    // initialized. This CHECK-fails if `Meshes()` is empty.
+    absl::Status InitializeSpatialIndexFromBranchNodes(
+        std::vector<RTree::BranchNode> branch_nodes) const;
+
+    // Adds the memory held by this `Data` to `footprint`, unless it has
+    // already been counted.
+    void AddToMemoryFootprint(MemoryFootprint& footprint) const;
+
     // Fetches the total absolute area of the `PartitionedMesh` (i.e. the sum of
     // the absolute values of the areas of every triangle), for use with
     // `Coverage` and `CoverageIsGreaterThan`.
@@ -380,14 +733,39 @@ class PartitionedMesh {
     // it never needs to be invalidated.
     float TotalAbsoluteArea() const;
 
+    // Fetches the simplified outline for `PartitionedMesh::SimplifiedOutline`,
+    // computing and caching it if needed. Like the other cached values, it
+    // never needs to be invalidated.
+    absl::Span<const Point> SimplifiedOutline(uint32_t group_index,
+                                              uint32_t outline_index,
+                                              float tolerance) const;
+
    private:
+    // Stores `rtree` as the spatial index, and publishes it for lock-free
+    // access by `SpatialIndexForQuery()` and `IsSpatialIndexInitialized()`.
+    void SetSpatialIndex(absl_nonnull std::unique_ptr<const RTree> rtree) const
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(cache_mutex_);
+
+    // Where one outline's data begins in `outline_vertex_indices_` and
+    // `outline_mesh_runs_`.
+    struct OutlineStart {
+      uint32_t first_vertex;
+      uint32_t first_mesh_run;
+    };
+
     absl::InlinedVector<Mesh, 1> meshes_;
-    absl::InlinedVector<std::vector<VertexIndexPair>, 1> outlines_;
+    // The vertex indices of every outline, one outline after the other.
+    std::vector<uint16_t> outline_vertex_indices_;
+    // The mesh index runs of every outline, one outline after the other. The
+    // `end` of each run is relative to the start of its outline.
+    std::vector<OutlineView::MeshRun> outline_mesh_runs_;
+    // The start of each outline, followed by the end of the last one.
+    absl::InlinedVector<OutlineStart, 2> outline_starts_ = {{0, 0}};
     // For each render group, the index into `meshes_` for the first mesh in
     // that group.
     absl::InlinedVector<uint16_t, 1> group_first_mesh_indices_;
-    // For each render group, the index into `outlines_` for the first outline
-    // in that group.
+    // For each render group, the index into `outline_starts_` for the first
+    // outline in that group.
     absl::InlinedVector<uint32_t, 1> group_first_outline_indices_;
     // For each render group, the `MeshFormat` shared by all meshes in that
     // group.
@@ -408,8 +786,24 @@ class PartitionedMesh {
     //   and/or a use-after-free of `Data` even if we mutex-guarded the pointee
     mutable absl_nullable std::unique_ptr<const RTree> rtree_
         ABSL_GUARDED_BY(cache_mutex_);
+    // A copy of `rtree_.get()`, published with release semantics once the
+    // index is initialized, so that queries can find it without locking
+    // `cache_mutex_`.
+    mutable std::atomic<const RTree*> published_rtree_ = nullptr;
+    // Set while the index is being initialized in the background, to the
+    // behavior that was requested for queries made in the meantime.
+    mutable std::optional<PendingSpatialIndexQueries>
+        pending_spatial_index_queries_ ABSL_GUARDED_BY(cache_mutex_);
+    mutable PackedPositionQueries packed_position_queries_ ABSL_GUARDED_BY(
+        cache_mutex_) = PackedPositionQueries::kUsePositionCache;
     mutable std::optional<float> cached_total_absolute_area_
         ABSL_GUARDED_BY(cache_mutex_);
+    // Simplified outline positions, keyed by the index of the outline and
+    // the tolerance level (see `SimplifiedOutline()`). Entries are never
+    // erased, and moving a `std::vector` when the map rehashes keeps its
+    // buffer, so spans over the values stay valid for the life of `Data`.
+    mutable absl::flat_hash_map<std::pair<uint32_t, int>, std::vector<Point>>
+        simplified_outlines_ ABSL_GUARDED_BY(cache_mutex_);
   };
 
   // Constructor used by `FromMeshes` to instantiate the `PartitionedMesh` with
@@ -449,24 +843,39 @@ inline absl::Span<const Mesh> PartitionedMesh::Meshes() const {
   return data_->Meshes();
 }
 
+inline PartitionedMesh::VertexIndexPair
+PartitionedMesh::OutlineView::operator[](size_t index) const {
+  ABSL_DCHECK_LT(index, size());
+  // The first run that ends after `index`. Almost all outlines have one run.
+  const MeshRun* run = mesh_runs_.data();
+  if (mesh_runs_.size() > 1) {
+    run = std::upper_bound(mesh_runs_.begin(), mesh_runs_.end(), index,
+                           [](size_t index, const MeshRun& run) {
+                             return index < run.end;
+                           });
+  }
+  return {.mesh_index = run->mesh_index,
+          .vertex_index = vertex_indices_[index]};
+}
+
 inline uint32_t PartitionedMesh::OutlineCount(uint32_t group_index) const {
   // If data_ is null, then there are zero groups, so group_index is necessarily
   // out of bounds.
   ABSL_CHECK(data_);
-  return data_->Outlines(group_index).size();
+  return data_->OutlineCount(group_index);
 }
 
-inline absl::Span<const PartitionedMesh::VertexIndexPair>
-PartitionedMesh::Outline(uint32_t group_index, uint32_t outline_index) const {
+inline PartitionedMesh::OutlineView PartitionedMesh::Outline(
+    uint32_t group_index, uint32_t outline_index) const {
   ABSL_CHECK_LT(outline_index, OutlineCount(group_index));
-  return data_->Outlines(group_index)[outline_index];
+  return data_->Outline(data_->GroupFirstOutlineIndex(group_index) +
+                        outline_index);
 }
 
 inline Point PartitionedMesh::OutlinePosition(uint32_t group_index,
                                               uint32_t outline_index,
                                               uint32_t vertex_index) const {
-  absl::Span<const VertexIndexPair> outline =
-      Outline(group_index, outline_index);
+  OutlineView outline = Outline(group_index, outline_index);
   ABSL_CHECK_LT(vertex_index, outline.size());
   VertexIndexPair index = outline[vertex_index];
   return data_->RenderGroupMeshes(group_index)[index.mesh_index].VertexPosition(
@@ -488,6 +897,11 @@ inline bool PartitionedMesh::IsSpatialIndexInitialized() const {
   return data_ && data_->IsSpatialIndexInitialized();
 }
 
+inline void PartitionedMesh::AddToMemoryFootprint(
+    MemoryFootprint& footprint) const {
+  if (data_) data_->AddToMemoryFootprint(footprint);
+}
+
 inline PartitionedMesh::PartitionedMesh(absl_nonnull std::unique_ptr<Data> data)
     : data_(std::move(data)) {}
 
@@ -515,19 +929,34 @@ inline absl::Span<const Mesh> PartitionedMesh::Data::Meshes() const {
   return meshes_;
 }
 
-inline absl::Span<const std::vector<PartitionedMesh::VertexIndexPair>>
-PartitionedMesh::Data::Outlines(uint32_t group_index) const {
+inline uint32_t PartitionedMesh::Data::OutlineCount(
+    uint32_t group_index) const {
   ABSL_CHECK_LT(group_index, RenderGroupCount());
-  size_t start = group_first_outline_indices_[group_index];
-  size_t end = group_index + 1 < group_first_outline_indices_.size()
-                   ? group_first_outline_indices_[group_index + 1]
-                   : outlines_.size();
-  return absl::MakeConstSpan(outlines_).subspan(start, end - start);
+  uint32_t end = group_index + 1 < group_first_outline_indices_.size()
+                     ? group_first_outline_indices_[group_index + 1]
+                     : outline_starts_.size() - 1;
+  return end - group_first_outline_indices_[group_index];
+}
+
+inline PartitionedMesh::OutlineView PartitionedMesh::Data::Outline(
+    uint32_t outline_index) const {
+  const OutlineStart& start = outline_starts_[outline_index];
+  const OutlineStart& end = outline_starts_[outline_index + 1];
+  return OutlineView(
+      absl::MakeConstSpan(outline_vertex_indices_)
+          .subspan(start.first_vertex, end.first_vertex - start.first_vertex),
+      absl::MakeConstSpan(outline_mesh_runs_)
+          .subspan(start.first_mesh_run,
+                   end.first_mesh_run - start.first_mesh_run));
+}
+
+inline uint32_t PartitionedMesh::Data::GroupFirstOutlineIndex(
+    uint32_t group_index) const {
+  return group_first_outline_indices_[group_index];
 }
 
 inline bool PartitionedMesh::Data::IsSpatialIndexInitialized() const {
-  absl::MutexLock lock(&cache_mutex_);
-  return rtree_ != nullptr;
+  return published_rtree_.load(std::memory_order_acquire) != nullptr;
 }
 
 }  // namespace ink
@@ -15,6 +15,7 @@
 #include "ink/geometry/partitioned_mesh.h"
 
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <utility>
 #include <vector>
@@ -42,14 +43,18 @@
 #include "ink/geometry/segment.h"
 #include "ink/geometry/triangle.h"
 #include "ink/geometry/type_matchers.h"
+#include "ink/types/memory_footprint.h"
+#include "ink/types/test_executor.h"
 
 namespace ink {
 namespace {
 
 using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
 using ::testing::AllOf;
 using ::testing::AnyOf;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::Eq;
 using ::testing::ExplainMatchResult;
 using ::testing::Field;
@@ -57,8 +62,10 @@ using ::testing::FloatNear;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::Matcher;
+using ::testing::Not;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 
 MATCHER_P(TriangleIndexPairEqMatcher, expected,
           absl::StrCat(negation ? "doesn't equal" : "equals",
@@ -408,6 +415,35 @@ TEST(PartitionedMeshTest, FromMeshesWithOutlines) {
   EXPECT_THAT(shape->OutlinePosition(0, 1, 2), PointNear({9, -1}, 8e-3));
 }
 
+TEST(PartitionedMeshTest, OutlineViewWithSeveralMeshRuns) {
+  std::vector<Mesh> meshes(2);
+  for (int i = 0; i < 2; ++i) {
+    absl::StatusOr<absl::InlinedVector<Mesh, 1>> partitions =
+        MakeStraightLineMutableMesh(20, MakeSinglePackedPositionFormat())
+            .AsMeshes();
+    ASSERT_EQ(partitions.status(), absl::OkStatus());
+    meshes[i] = std::move((*partitions)[0]);
+  }
+  std::vector<PartitionedMesh::VertexIndexPair> outline = {
+      {0, 3}, {0, 4}, {1, 7}, {1, 8}, {1, 9}, {0, 12}, {1, 0}};
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMeshes(meshes, {outline, {{1, 2}}});
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  PartitionedMesh::OutlineView view = shape->Outline(0, 0);
+  ASSERT_EQ(view.size(), outline.size());
+  std::vector<PartitionedMesh::VertexIndexPair> iterated(view.begin(),
+                                                         view.end());
+  for (size_t i = 0; i < outline.size(); ++i) {
+    EXPECT_THAT(iterated[i], VertexIndexPairEq(outline[i])) << i;
+    EXPECT_THAT(view[i], VertexIndexPairEq(outline[i])) << i;
+  }
+  EXPECT_THAT(view.front(), VertexIndexPairEq(outline.front()));
+  EXPECT_THAT(view.back(), VertexIndexPairEq(outline.back()));
+  EXPECT_THAT(shape->Outline(0, 1), ElementsAre(VertexIndexPairEq({1, 2})));
+  EXPECT_THAT(PartitionedMesh::OutlineView(), IsEmpty());
+}
+
 TEST(PartitionedMeshTest, FromMultipleMeshGroupsWithOutlines) {
   constexpr int kMeshCount = 3;
   std::vector<Mesh> meshes(kMeshCount);
@@ -548,6 +584,29 @@ TEST(PartitionedMeshTest, FromMeshesOutlineRefersToNonExistentVertex) {
   EXPECT_THAT(missing_vertex.message(), HasSubstr("non-existent vertex"));
 }
 
+TEST(PartitionedMeshTest, SimplifiedOutline) {
+  absl::StatusOr<PartitionedMesh> shape = PartitionedMesh::FromMutableMesh(
+      MakeStraightLineMutableMesh(4), {{0, 2, 4, 5, 3, 1}});
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  EXPECT_THAT(shape->SimplifiedOutline(0, 0, 0),
+              ElementsAre(PointEq({0, 0}), PointEq({2, 0}), PointEq({4, 0}),
+                          PointEq({5, -1}), PointEq({3, -1}),
+                          PointEq({1, -1})));
+
+  // The collinear vertices in the middle of each long edge are dropped.
+  absl::Span<const Point> simplified = shape->SimplifiedOutline(0, 0, 0.25);
+  EXPECT_THAT(simplified,
+              ElementsAre(PointEq({0, 0}), PointEq({4, 0}), PointEq({5, -1}),
+                          PointEq({1, -1})));
+
+  // Tolerances are rounded down to a power of two, and the result for each is
+  // cached and shared between copies.
+  PartitionedMesh copy = *shape;
+  EXPECT_EQ(copy.SimplifiedOutline(0, 0, 0.3).data(), simplified.data());
+  EXPECT_NE(copy.SimplifiedOutline(0, 0, 0.5).data(), simplified.data());
+}
+
 TEST(PartitionedMeshTest, FromMultipleMutableMeshGroups) {
   MutableMesh mutable_mesh0 = MakeStraightLineMutableMesh(8);
   absl::StatusOr<absl::InlinedVector<Mesh, 1>> meshes0 =
@@ -585,6 +644,65 @@ TEST(PartitionedMeshTest, FromMultipleMutableMeshGroups) {
   EXPECT_FALSE(shape->IsSpatialIndexInitialized());
 }
 
+TEST(PartitionedMeshTest,
+     FromMutableMeshGroupsOptimizedForVertexCacheRemapsOutlines) {
+  MutableMesh mutable_mesh = MakeStraightLineMutableMesh(20);
+  std::vector<uint32_t> outline = {0,  2,  4,  6,  8,  10, 12, 14, 16, 18, 20,
+                                   21, 19, 17, 15, 13, 11, 9,  7,  5,  3,  1};
+  absl::Span<const uint32_t> outline_span = outline;
+
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMeshGroups({PartitionedMesh::MutableMeshGroup{
+          .mesh = &mutable_mesh,
+          .outlines = absl::MakeConstSpan(&outline_span, 1),
+          .triangle_order =
+              MutableMesh::TriangleOrder::kOptimizeForVertexCache,
+      }});
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  ASSERT_EQ(shape->OutlineCount(0), 1u);
+  ASSERT_EQ(shape->OutlineVertexCount(0, 0), outline.size());
+  for (uint32_t i = 0; i < outline.size(); ++i) {
+    EXPECT_THAT(shape->OutlinePosition(0, 0, i),
+                PointEq(mutable_mesh.VertexPosition(outline[i])))
+        << "at outline vertex " << i;
+  }
+}
+
+TEST(PartitionedMeshTest,
+     FromMutableMeshGroupsWithVertexWeldingRemapsOutlines) {
+  // Two triangles that each have their own copy of the shared edge.
+  MutableMesh mutable_mesh;
+  mutable_mesh.AppendVertex({0, 0});
+  mutable_mesh.AppendVertex({1, 0});
+  mutable_mesh.AppendVertex({0, 1});
+  mutable_mesh.AppendVertex({1, 0});
+  mutable_mesh.AppendVertex({1, 1});
+  mutable_mesh.AppendVertex({0, 1});
+  mutable_mesh.AppendTriangleIndices({0, 1, 2});
+  mutable_mesh.AppendTriangleIndices({3, 4, 5});
+  // After welding, consecutive references to the same vertex are collapsed.
+  std::vector<uint32_t> outline = {0, 1, 3, 4, 5, 2};
+  absl::Span<const uint32_t> outline_span = outline;
+
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMeshGroups({PartitionedMesh::MutableMeshGroup{
+          .mesh = &mutable_mesh,
+          .outlines = absl::MakeConstSpan(&outline_span, 1),
+          .vertex_welding = MutableMesh::VertexWelding::kMergeIdentical,
+      }});
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  ASSERT_EQ(shape->Meshes().size(), 1u);
+  EXPECT_EQ(shape->Meshes()[0].VertexCount(), 4u);
+  ASSERT_EQ(shape->OutlineCount(0), 1u);
+  ASSERT_EQ(shape->OutlineVertexCount(0, 0), 4u);
+  EXPECT_THAT(shape->OutlinePosition(0, 0, 0), PointEq({0, 0}));
+  EXPECT_THAT(shape->OutlinePosition(0, 0, 1), PointEq({1, 0}));
+  EXPECT_THAT(shape->OutlinePosition(0, 0, 2), PointEq({1, 1}));
+  EXPECT_THAT(shape->OutlinePosition(0, 0, 3), PointEq({0, 1}));
+}
+
 TEST(PartitionedMeshTest, FromMultipleMeshGroups) {
   absl::StatusOr<absl::InlinedVector<Mesh, 1>> meshes0 =
       MakeStraightLineMutableMesh(8).AsMeshes();
@@ -631,6 +749,61 @@ TEST(PartitionedMeshTest, InitializeSpatialIndex) {
   EXPECT_TRUE(shape->IsSpatialIndexInitialized());
 }
 
+TEST(PartitionedMeshTest, MemoryFootprint) {
+  MemoryFootprint empty_footprint;
+  PartitionedMesh().AddToMemoryFootprint(empty_footprint);
+  EXPECT_EQ(empty_footprint.TotalBytes(), 0u);
+
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(100));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+  MemoryFootprint mesh_footprint;
+  shape->Meshes()[0].AddToMemoryFootprint(mesh_footprint);
+  MemoryFootprint footprint;
+  shape->AddToMemoryFootprint(footprint);
+  EXPECT_GT(footprint.TotalBytes(), mesh_footprint.TotalBytes());
+
+  // A copy shares all of its data with the original.
+  PartitionedMesh copy = *shape;
+  size_t bytes = footprint.TotalBytes();
+  copy.AddToMemoryFootprint(footprint);
+  EXPECT_EQ(footprint.TotalBytes(), bytes);
+
+  // The spatial index is counted once it has been initialized.
+  copy.InitializeSpatialIndex();
+  MemoryFootprint indexed_footprint;
+  shape->AddToMemoryFootprint(indexed_footprint);
+  EXPECT_GT(indexed_footprint.TotalBytes(), bytes);
+}
+
+TEST(PartitionedMeshTest, InitializeSpatialIndexInitializesPositionCaches) {
+  absl::StatusOr<PartitionedMesh> shape = PartitionedMesh::FromMutableMesh(
+      MakeStraightLineMutableMesh(100, MakeSinglePackedPositionFormat()));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+  ASSERT_THAT(shape->Meshes(), Not(IsEmpty()));
+  std::vector<Triangle> uncached_triangles;
+  for (const Mesh& mesh : shape->Meshes()) {
+    EXPECT_FALSE(mesh.IsPositionCacheInitialized());
+    for (uint32_t i = 0; i < mesh.TriangleCount(); ++i) {
+      uncached_triangles.push_back(mesh.GetTriangle(i));
+    }
+  }
+
+  shape->InitializeSpatialIndex();
+
+  std::vector<Triangle> cached_triangles;
+  for (const Mesh& mesh : shape->Meshes()) {
+    EXPECT_TRUE(mesh.IsPositionCacheInitialized());
+    for (uint32_t i = 0; i < mesh.TriangleCount(); ++i) {
+      cached_triangles.push_back(mesh.GetTriangle(i));
+    }
+  }
+  ASSERT_EQ(cached_triangles.size(), uncached_triangles.size());
+  for (size_t i = 0; i < cached_triangles.size(); ++i) {
+    EXPECT_THAT(cached_triangles[i], TriangleEq(uncached_triangles[i]));
+  }
+}
+
 TEST(PartitionedMeshTest, InitializeSpatialIndexWithMultipleMeshes) {
   absl::StatusOr<absl::InlinedVector<Mesh, 1>> first_mesh =
       MakeStraightLineMutableMesh(10).AsMeshes();
@@ -694,6 +867,232 @@ std::vector<PartitionedMesh::TriangleIndexPair> GetAllIntersectedTriangles(
   return tri_index_pairs;
 }
 
+// Returns matchers for the triangles of `shape` that intersect `query`.
+template <typename QueryType>
+std::vector<Matcher<PartitionedMesh::TriangleIndexPair>>
+GetAllIntersectedTriangleMatchers(const PartitionedMesh& shape,
+                                  const QueryType& query,
+                                  const AffineTransform query_to_shape = {}) {
+  std::vector<Matcher<PartitionedMesh::TriangleIndexPair>> matchers;
+  for (PartitionedMesh::TriangleIndexPair idx :
+       GetAllIntersectedTriangles(shape, query, query_to_shape)) {
+    matchers.push_back(TriangleIndexPairEq(idx));
+  }
+  return matchers;
+}
+
+TEST(PartitionedMeshTest, TestPackedPositionsSkipsPositionCaches) {
+  absl::StatusOr<PartitionedMesh> shape = PartitionedMesh::FromMutableMesh(
+      MakeStraightLineMutableMesh(100, MakeSinglePackedPositionFormat()));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+  ASSERT_THAT(shape->Meshes(), Not(IsEmpty()));
+  // Built separately, since the position caches are shared between copies of
+  // a `Mesh`.
+  absl::StatusOr<PartitionedMesh> cached_shape =
+      PartitionedMesh::FromMutableMesh(
+          MakeStraightLineMutableMesh(100, MakeSinglePackedPositionFormat()));
+  ASSERT_EQ(cached_shape.status(), absl::OkStatus());
+
+  shape->SetPackedPositionQueries(
+      PartitionedMesh::PackedPositionQueries::kTestPackedPositions);
+  shape->InitializeSpatialIndex();
+
+  for (const Mesh& mesh : shape->Meshes()) {
+    EXPECT_FALSE(mesh.IsPositionCacheInitialized());
+  }
+
+  // Queries against the packed positions find the same triangles as queries
+  // against the unpacked positions.
+  cached_shape->InitializeSpatialIndex();
+  for (const Mesh& mesh : shape->Meshes()) {
+    ASSERT_FALSE(mesh.IsPositionCacheInitialized());
+  }
+  AffineTransform transform = AffineTransform::Translate({0.5, 0.25});
+  for (float x = -1.25; x < 101; x += 2.5) {
+    Point point = {x, -0.75};
+    Segment segment = {{x, -2}, {x + 1.5, 2}};
+    Rect rect = Rect::FromCenterAndDimensions({x, 0}, 0.5, 3);
+    EXPECT_THAT(GetAllIntersectedTriangles(*shape, point, transform),
+                UnorderedElementsAreArray(GetAllIntersectedTriangleMatchers(
+                    *cached_shape, point, transform)));
+    EXPECT_THAT(GetAllIntersectedTriangles(*shape, segment, transform),
+                UnorderedElementsAreArray(GetAllIntersectedTriangleMatchers(
+                    *cached_shape, segment, transform)));
+    EXPECT_THAT(GetAllIntersectedTriangles(*shape, rect),
+                UnorderedElementsAreArray(
+                    GetAllIntersectedTriangleMatchers(*cached_shape, rect)));
+  }
+}
+
+TEST(PartitionedMeshTest, InitializeSpatialIndexAsyncWithBruteForceQueries) {
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(100));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+  Rect query = Rect::FromTwoPoints({5, -1}, {20, 1});
+  std::vector<Matcher<PartitionedMesh::TriangleIndexPair>> expected_triangles;
+  {
+    absl::StatusOr<PartitionedMesh> indexed =
+        PartitionedMesh::FromMeshes(shape->Meshes());
+    ASSERT_EQ(indexed.status(), absl::OkStatus());
+    for (PartitionedMesh::TriangleIndexPair idx :
+         GetAllIntersectedTriangles(*indexed, query)) {
+      expected_triangles.push_back(TriangleIndexPairEq(idx));
+    }
+  }
+  ASSERT_THAT(expected_triangles, Not(IsEmpty()));
+
+  ManualExecutor executor;
+  shape->InitializeSpatialIndexAsync(
+      executor, PartitionedMesh::PendingSpatialIndexQueries::kBruteForce);
+  EXPECT_EQ(executor.PendingTaskCount(), 1);
+  EXPECT_FALSE(shape->IsSpatialIndexInitialized());
+
+  // Scheduling again while the first is pending does nothing.
+  shape->InitializeSpatialIndexAsync(executor);
+  EXPECT_EQ(executor.PendingTaskCount(), 1);
+
+  // Queries made before the index is built test every triangle, without
+  // building the index themselves.
+  EXPECT_THAT(GetAllIntersectedTriangles(*shape, query),
+              UnorderedElementsAreArray(expected_triangles));
+  EXPECT_FALSE(shape->IsSpatialIndexInitialized());
+
+  executor.RunScheduledTasks();
+  EXPECT_TRUE(shape->IsSpatialIndexInitialized());
+  EXPECT_THAT(GetAllIntersectedTriangles(*shape, query),
+              UnorderedElementsAreArray(expected_triangles));
+
+  // Once the index is initialized, nothing more is scheduled.
+  shape->InitializeSpatialIndexAsync(executor);
+  EXPECT_EQ(executor.PendingTaskCount(), 0);
+}
+
+TEST(PartitionedMeshTest, InitializeSpatialIndexAsyncWithWaitingQueries) {
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(1000));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+  PartitionedMesh copy = *shape;
+
+  {
+    ThreadPerTaskExecutor executor;
+    shape->InitializeSpatialIndexAsync(
+        executor, PartitionedMesh::PendingSpatialIndexQueries::kWait);
+
+    // This waits for the background task if it hasn't finished yet.
+    EXPECT_THAT(GetAllIntersectedTriangles(copy, Point{10.5, -0.25}),
+                Not(IsEmpty()));
+    EXPECT_TRUE(copy.IsSpatialIndexInitialized());
+  }
+  EXPECT_TRUE(shape->IsSpatialIndexInitialized());
+}
+
+TEST(PartitionedMeshTest, InitializeSpatialIndexAsyncOutlivesPartitionedMesh) {
+  ManualExecutor executor;
+  {
+    absl::StatusOr<PartitionedMesh> shape =
+        PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(10));
+    ASSERT_EQ(shape.status(), absl::OkStatus());
+    shape->InitializeSpatialIndexAsync(executor);
+  }
+  EXPECT_EQ(executor.PendingTaskCount(), 1);
+  executor.RunScheduledTasks();
+}
+
+TEST(PartitionedMeshTest, InitializeSpatialIndexAsyncIsNoOpForEmptyMesh) {
+  ManualExecutor executor;
+  PartitionedMesh().InitializeSpatialIndexAsync(executor);
+  EXPECT_EQ(executor.PendingTaskCount(), 0);
+}
+
+TEST(PartitionedMeshTest, InitializeSpatialIndexFromStructure) {
+  absl::StatusOr<PartitionedMesh> original =
+      PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(100));
+  ASSERT_EQ(original.status(), absl::OkStatus());
+  PartitionedMesh::SpatialIndexStructure structure =
+      original->GetSpatialIndexStructure();
+  EXPECT_TRUE(original->IsSpatialIndexInitialized());
+  EXPECT_THAT(structure.node_is_leaf_parent, Not(IsEmpty()));
+  EXPECT_EQ(structure.node_child_counts.size(),
+            structure.node_is_leaf_parent.size());
+
+  absl::StatusOr<PartitionedMesh> restored =
+      PartitionedMesh::FromMeshes(original->Meshes());
+  ASSERT_EQ(restored.status(), absl::OkStatus());
+  ASSERT_EQ(restored->InitializeSpatialIndexFromStructure(structure),
+            absl::OkStatus());
+  EXPECT_TRUE(restored->IsSpatialIndexInitialized());
+
+  PartitionedMesh::SpatialIndexStructure restored_structure =
+      restored->GetSpatialIndexStructure();
+  EXPECT_EQ(restored_structure.node_is_leaf_parent,
+            structure.node_is_leaf_parent);
+  EXPECT_EQ(restored_structure.node_child_counts, structure.node_child_counts);
+  EXPECT_EQ(restored_structure.child_indices, structure.child_indices);
+
+  Rect query = Rect::FromTwoPoints({5, -1}, {20, 1});
+  std::vector<Matcher<PartitionedMesh::TriangleIndexPair>> expected_triangles;
+  for (PartitionedMesh::TriangleIndexPair idx :
+       GetAllIntersectedTriangles(*original, query)) {
+    expected_triangles.push_back(TriangleIndexPairEq(idx));
+  }
+  EXPECT_THAT(expected_triangles, Not(IsEmpty()));
+  EXPECT_THAT(GetAllIntersectedTriangles(*restored, query),
+              UnorderedElementsAreArray(expected_triangles));
+}
+
+TEST(PartitionedMeshTest,
+     InitializeSpatialIndexFromStructureIsNoOpIfInitialized) {
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(10));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+  shape->InitializeSpatialIndex();
+
+  EXPECT_EQ(shape->InitializeSpatialIndexFromStructure({}), absl::OkStatus());
+  EXPECT_TRUE(shape->IsSpatialIndexInitialized());
+}
+
+TEST(PartitionedMeshTest, InitializeSpatialIndexFromInvalidStructure) {
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(10));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+  uint32_t n_tris = shape->Meshes()[0].TriangleCount();
+  ASSERT_GT(n_tris, 2u);
+  ASSERT_LE(n_tris, 16u);
+
+  // A single leaf-parent root that is missing the last triangle.
+  PartitionedMesh::SpatialIndexStructure missing_triangle{
+      .node_is_leaf_parent = {true},
+      .node_child_counts = {n_tris - 1},
+  };
+  for (uint32_t i = 0; i < n_tris - 1; ++i) {
+    missing_triangle.child_indices.push_back(i);
+  }
+  EXPECT_THAT(shape->InitializeSpatialIndexFromStructure(missing_triangle),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Every element")));
+
+  // A root whose only child is itself.
+  PartitionedMesh::SpatialIndexStructure cycle{
+      .node_is_leaf_parent = {false},
+      .node_child_counts = {1},
+      .child_indices = {0},
+  };
+  EXPECT_THAT(shape->InitializeSpatialIndexFromStructure(cycle),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("branch child")));
+
+  // The child counts don't match the number of child indices.
+  PartitionedMesh::SpatialIndexStructure too_few_children{
+      .node_is_leaf_parent = {true},
+      .node_child_counts = {n_tris},
+      .child_indices = {0},
+  };
+  EXPECT_EQ(shape->InitializeSpatialIndexFromStructure(too_few_children).code(),
+            absl::StatusCode::kInvalidArgument);
+
+  EXPECT_FALSE(shape->IsSpatialIndexInitialized());
+}
+
 TEST(PartitionedMeshTest, VisitIntersectedTrianglesPointQuery) {
   // This mesh will wrap around and partially overlap itself.
   PartitionedMesh shape = MakeCoiledRingPartitionedMesh(14, 6);
@@ -1047,6 +1446,36 @@ TEST(PartitionedMeshTest,
       IsEmpty());
 }
 
+TEST(PartitionedMeshTest,
+     VisitIntersectedTrianglesRectQueryMatchesForAxisAlignedTransforms) {
+  // This mesh will wrap around and partially overlap itself.
+  PartitionedMesh shape = MakeCoiledRingPartitionedMesh(14, 6);
+  Rect rect = Rect::FromTwoPoints({.5, .2}, {1, .2});
+
+  // Identity, translation, and scale transforms each have their own path, which
+  // should find the same triangles as the equivalent untransformed query.
+  std::vector<Matcher<PartitionedMesh::TriangleIndexPair>> expected;
+  for (PartitionedMesh::TriangleIndexPair index :
+       GetAllIntersectedTriangles(shape, rect)) {
+    expected.push_back(TriangleIndexPairEq(index));
+  }
+  ASSERT_THAT(expected, Not(IsEmpty()));
+  EXPECT_THAT(GetAllIntersectedTriangles(shape, rect, AffineTransform()),
+              UnorderedElementsAreArray(expected));
+  EXPECT_THAT(GetAllIntersectedTriangles(
+                  shape, Rect::FromTwoPoints({-2.5, 3.2}, {-2, 3.2}),
+                  AffineTransform::Translate({3, -3})),
+              UnorderedElementsAreArray(expected));
+  EXPECT_THAT(GetAllIntersectedTriangles(
+                  shape, Rect::FromTwoPoints({1, .4}, {2, .4}),
+                  AffineTransform::Scale(.5)),
+              UnorderedElementsAreArray(expected));
+  EXPECT_THAT(GetAllIntersectedTriangles(
+                  shape, Rect::FromTwoPoints({-1, -.1}, {-2, -.1}),
+                  AffineTransform::Scale(-.5, -2)),
+              UnorderedElementsAreArray(expected));
+}
+
 TEST(PartitionedMeshTest, VisitIntersectedTrianglesRectQueryMultipleMeshes) {
   absl::StatusOr<absl::InlinedVector<Mesh, 1>> first_mesh =
       MakeStraightLineMutableMesh(3).AsMeshes();
@@ -1392,6 +1821,35 @@ TEST(PartitionedMeshTest,
                   TriangleIndexPairEq({.mesh_index = 0, .triangle_index = 0})));
 }
 
+TEST(PartitionedMeshTest,
+     VisitIntersectedTrianglesPartitionedMeshQueryMatchesWithoutQueryIndex) {
+  PartitionedMesh ring = MakeCoiledRingPartitionedMesh(200, 12);
+  absl::StatusOr<PartitionedMesh> line =
+      PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(50));
+  ASSERT_EQ(line.status(), absl::OkStatus());
+  AffineTransform line_to_ring =
+      AffineTransform::RotateAboutPoint(kQuarterTurn / 3, {0, 0}) *
+      AffineTransform::Scale(0.05);
+
+  // Leaving the line's index unbuilt, with brute force pending queries, means
+  // that its triangles are tested one at a time instead of by walking both
+  // indices at once.
+  ManualExecutor executor;
+  line->InitializeSpatialIndexAsync(
+      executor, PartitionedMesh::PendingSpatialIndexQueries::kBruteForce);
+  std::vector<Matcher<PartitionedMesh::TriangleIndexPair>> expected_triangles;
+  for (PartitionedMesh::TriangleIndexPair idx :
+       GetAllIntersectedTriangles(ring, *line, line_to_ring)) {
+    expected_triangles.push_back(TriangleIndexPairEq(idx));
+  }
+  ASSERT_THAT(expected_triangles, Not(IsEmpty()));
+
+  executor.RunScheduledTasks();
+  ASSERT_TRUE(line->IsSpatialIndexInitialized());
+  EXPECT_THAT(GetAllIntersectedTriangles(ring, *line, line_to_ring),
+              UnorderedElementsAreArray(expected_triangles));
+}
+
 TEST(PartitionedMeshTest, VisitIntersectedTrianglesWithReentrantVisitor) {
   PartitionedMesh shape = MakeStraightLinePartitionedMesh(3);
   Rect query = Rect::FromTwoPoints({3, -2}, {6, 2});
@@ -1405,6 +1863,95 @@ TEST(PartitionedMeshTest, VisitIntersectedTrianglesWithReentrantVisitor) {
   shape.VisitIntersectedTriangles(query, visitor);
 }
 
+// Returns the indices of the elements of `queries` for which
+// `VisitIntersectedTriangles` finds at least one triangle.
+template <typename QueryType>
+std::vector<size_t> GetIntersectingQueriesSeparately(
+    const PartitionedMesh& shape, absl::Span<const QueryType> queries,
+    const AffineTransform& query_to_shape = {}) {
+  std::vector<size_t> hits;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    if (!GetAllIntersectedTriangles(shape, queries[i], query_to_shape)
+             .empty()) {
+      hits.push_back(i);
+    }
+  }
+  return hits;
+}
+
+TEST(PartitionedMeshTest, FindIntersectingQueriesMatchesSeparateQueries) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(100);
+  std::vector<Point> points;
+  std::vector<Segment> segments;
+  std::vector<Triangle> triangles;
+  std::vector<Rect> rects;
+  std::vector<Quad> quads;
+  for (int i = -5; i < 110; ++i) {
+    float x = i;
+    // Alternate between queries that cross the mesh, and ones just above it.
+    float y = i % 2 == 0 ? -0.5f : 0.25f;
+    points.push_back({x, y});
+    segments.push_back({{x, y}, {x + 0.5f, y}});
+    triangles.push_back({{x, y}, {x + 0.5f, y}, {x, y + 0.1f}});
+    rects.push_back(Rect::FromCenterAndDimensions({x, y}, 0.4, 0.2));
+    quads.push_back(Quad::FromCenterAndDimensions({x, y}, 0.4, 0.2));
+  }
+  AffineTransform transform = AffineTransform::Translate({0.25, 0});
+
+  std::vector<size_t> expected_hits =
+      GetIntersectingQueriesSeparately<Point>(shape, points, transform);
+  ASSERT_THAT(expected_hits, Not(IsEmpty()));
+  ASSERT_LT(expected_hits.size(), points.size());
+  EXPECT_THAT(shape.FindIntersectingQueries(points, transform),
+              ElementsAreArray(expected_hits));
+  EXPECT_THAT(shape.FindIntersectingQueries(segments, transform),
+              ElementsAreArray(GetIntersectingQueriesSeparately<Segment>(
+                  shape, segments, transform)));
+  EXPECT_THAT(shape.FindIntersectingQueries(triangles, transform),
+              ElementsAreArray(GetIntersectingQueriesSeparately<Triangle>(
+                  shape, triangles, transform)));
+  EXPECT_THAT(
+      shape.FindIntersectingQueries(rects, transform),
+      ElementsAreArray(
+          GetIntersectingQueriesSeparately<Rect>(shape, rects, transform)));
+  EXPECT_THAT(
+      shape.FindIntersectingQueries(quads, transform),
+      ElementsAreArray(
+          GetIntersectingQueriesSeparately<Quad>(shape, quads, transform)));
+}
+
+TEST(PartitionedMeshTest, FindIntersectingQueriesWithNoHits) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(10);
+  std::vector<Segment> queries = {{{0, 5}, {10, 5}}, {{-5, 0}, {-5, -1}}};
+
+  EXPECT_THAT(shape.FindIntersectingQueries(queries), IsEmpty());
+  EXPECT_THAT(shape.FindIntersectingQueries(absl::Span<const Segment>()),
+              IsEmpty());
+}
+
+TEST(PartitionedMeshTest, FindIntersectingQueriesEmptyShape) {
+  PartitionedMesh shape;
+  std::vector<Point> queries = {{0, 0}, {1, 1}};
+
+  EXPECT_THAT(shape.FindIntersectingQueries(queries), IsEmpty());
+}
+
+TEST(PartitionedMeshTest, FindIntersectingQueriesWhileIndexIsPending) {
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(MakeStraightLineMutableMesh(10));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+  std::vector<Point> queries = {{1, -0.5}, {1, 5}, {5, -0.5}};
+
+  ManualExecutor executor;
+  shape->InitializeSpatialIndexAsync(
+      executor, PartitionedMesh::PendingSpatialIndexQueries::kBruteForce);
+  EXPECT_THAT(shape->FindIntersectingQueries(queries), ElementsAre(0, 2));
+  EXPECT_FALSE(shape->IsSpatialIndexInitialized());
+
+  executor.RunScheduledTasks();
+  EXPECT_THAT(shape->FindIntersectingQueries(queries), ElementsAre(0, 2));
+}
+
 // Returns a `PartitionedMesh` with four triangles in a row along the x-axis,
 // each with a base of one unit, and with heights of 1, 2, 3, and 4 units. Each
 // triangle has a different area (to facilitate testing `Coverage` and
@@ -1822,6 +2369,120 @@ TEST(PartitionedMeshTest,
   EXPECT_FALSE(target.CoverageIsGreaterThan(query, 0.41, transform));
 }
 
+TEST(PartitionedMeshTest, ParallelCoverageIsGreaterThanMatchesSerial) {
+  // This has enough triangles that the tests are split across several tasks.
+  PartitionedMesh shape = MakeCoiledRingPartitionedMesh(2000, 40);
+  Quad quad = Quad::FromCenterDimensionsAndRotation({0.5, 0.25}, 1.5, 0.75,
+                                                    kQuarterTurn / 5);
+  Triangle triangle = {{-1, -1}, {1, -1}, {0, 1}};
+  Rect rect = Rect::FromTwoPoints({-0.3, -2}, {2, 0.1});
+  PartitionedMesh mesh_query = MakeStarPartitionedMesh(6);
+  AffineTransform mesh_query_to_shape = AffineTransform::Scale(0.8);
+
+  ThreadPerTaskExecutor executor;
+  for (float threshold : {0.f, 0.1f, 0.25f, 0.5f, 0.75f, 0.99f, 1.f}) {
+    EXPECT_EQ(shape.CoverageIsGreaterThan(quad, threshold, executor),
+              shape.CoverageIsGreaterThan(quad, threshold))
+        << "threshold " << threshold;
+    EXPECT_EQ(shape.CoverageIsGreaterThan(triangle, threshold, executor),
+              shape.CoverageIsGreaterThan(triangle, threshold))
+        << "threshold " << threshold;
+    EXPECT_EQ(shape.CoverageIsGreaterThan(rect, threshold, executor),
+              shape.CoverageIsGreaterThan(rect, threshold))
+        << "threshold " << threshold;
+    EXPECT_EQ(shape.CoverageIsGreaterThan(mesh_query, threshold, executor,
+                                          mesh_query_to_shape),
+              shape.CoverageIsGreaterThan(mesh_query, threshold,
+                                          mesh_query_to_shape))
+        << "threshold " << threshold;
+  }
+}
+
+TEST(PartitionedMeshTest, ParallelCoverageIsGreaterThanWithTransform) {
+  PartitionedMesh shape = MakeRisingSawtoothShape();
+  ThreadPerTaskExecutor executor;
+
+  // In `shape`'s coordinate space, this covers the last two triangles, which
+  // are 70% of the area.
+  Rect query = Rect::FromTwoPoints({2.5, 0.5}, {4, 4});
+  AffineTransform query_to_shape = AffineTransform::Translate({-1, 0});
+  Rect translated_query = Rect::FromTwoPoints({3.5, 0.5}, {5, 4});
+  EXPECT_TRUE(shape.CoverageIsGreaterThan(query, 0.6, executor));
+  EXPECT_FALSE(shape.CoverageIsGreaterThan(query, 0.8, executor));
+  EXPECT_TRUE(shape.CoverageIsGreaterThan(translated_query, 0.6, executor,
+                                          query_to_shape));
+  EXPECT_FALSE(shape.CoverageIsGreaterThan(translated_query, 0.8, executor,
+                                           query_to_shape));
+}
+
+TEST(PartitionedMeshTest, ParallelCoverageIsGreaterThanEmptyShape) {
+  PartitionedMesh shape;
+  ThreadPerTaskExecutor executor;
+
+  EXPECT_FALSE(shape.CoverageIsGreaterThan(
+      Quad::FromCenterAndDimensions({0, 0}, 10, 10), 0, executor));
+  EXPECT_FALSE(shape.CoverageIsGreaterThan(MakeStarPartitionedMesh(4), 0,
+                                           executor));
+}
+
+TEST(PartitionedMeshTest, ApproximateCoverageWithNoErrorMatchesCoverage) {
+  // The triangles' areas are summed in a different order than in `Coverage`,
+  // so the results may differ by rounding error.
+  PartitionedMesh shape = MakeCoiledRingPartitionedMesh(500, 20);
+  Quad quad = Quad::FromCenterDimensionsAndRotation({0.5, 0.25}, 1.5, 0.75,
+                                                    kQuarterTurn / 5);
+  Triangle triangle = {{-1, -1}, {1, -1}, {0, 1}};
+  Rect rect = Rect::FromTwoPoints({-0.3, -2}, {2, 0.1});
+  PartitionedMesh mesh_query = MakeStarPartitionedMesh(6);
+
+  EXPECT_NEAR(shape.ApproximateCoverage(quad, 0), shape.Coverage(quad), 1e-5);
+  EXPECT_NEAR(shape.ApproximateCoverage(triangle, 0), shape.Coverage(triangle),
+              1e-5);
+  EXPECT_NEAR(shape.ApproximateCoverage(rect, 0), shape.Coverage(rect), 1e-5);
+  EXPECT_NEAR(shape.ApproximateCoverage(mesh_query, 0),
+              shape.Coverage(mesh_query), 1e-5);
+}
+
+TEST(PartitionedMeshTest, ApproximateCoverageIsWithinMaxError) {
+  PartitionedMesh shape = MakeCoiledRingPartitionedMesh(500, 20);
+  Quad quad = Quad::FromCenterDimensionsAndRotation({0.5, 0.25}, 1.5, 0.75,
+                                                    kQuarterTurn / 5);
+  PartitionedMesh mesh_query = MakeStarPartitionedMesh(6);
+  AffineTransform mesh_query_to_shape =
+      AffineTransform::Translate({0.5, 0}) * AffineTransform::Scale(0.8);
+
+  for (float max_error : {0.01f, 0.05f, 0.1f, 0.25f, 0.5f}) {
+    EXPECT_NEAR(shape.ApproximateCoverage(quad, max_error),
+                shape.Coverage(quad), max_error)
+        << "max_error " << max_error;
+    EXPECT_NEAR(shape.ApproximateCoverage(mesh_query, max_error,
+                                          mesh_query_to_shape),
+                shape.Coverage(mesh_query, mesh_query_to_shape), max_error)
+        << "max_error " << max_error;
+  }
+}
+
+TEST(PartitionedMeshTest, ApproximateCoverageCountsTrianglesInsideQuery) {
+  PartitionedMesh shape = MakeRisingSawtoothShape();
+
+  // The bounds of every triangle are inside this query, so even with a large
+  // `max_error`, the result is exact.
+  EXPECT_FLOAT_EQ(
+      shape.ApproximateCoverage(Rect::FromTwoPoints({-1, -1}, {5, 5}), 0.5), 1);
+  EXPECT_EQ(
+      shape.ApproximateCoverage(Rect::FromTwoPoints({10, 10}, {11, 11}), 0.5),
+      0);
+}
+
+TEST(PartitionedMeshTest, ApproximateCoverageEmptyShape) {
+  PartitionedMesh shape;
+
+  EXPECT_EQ(shape.ApproximateCoverage(
+                Quad::FromCenterAndDimensions({0, 0}, 10, 10), 0.1),
+            0);
+  EXPECT_EQ(shape.ApproximateCoverage(MakeStarPartitionedMesh(4), 0.1), 0);
+}
+
 TEST(PartitionedMeshTest, QueryAgainstSelf) {
   PartitionedMesh shape = MakeStraightLinePartitionedMesh(4);
 
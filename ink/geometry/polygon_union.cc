@@ -0,0 +1,184 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/polygon_union.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/triangle.h"
+#include "ink/types/executor.h"
+#include "libtess2/tesselator.h"
+
+namespace ink {
+namespace {
+
+using Polygons = std::vector<std::vector<Point>>;
+
+// The largest coordinate magnitude accepted by libtess2; larger inputs are
+// rejected to avoid overflow.
+constexpr float kMaxTessellatorCoordinate = 1 << 23;
+
+// Accumulates closed contours, and computes the boundary of the region where
+// their winding number is non-zero.
+class BoundaryTessellator {
+ public:
+  BoundaryTessellator() : tess_(tessNewTess(/*alloc=*/nullptr)) {
+    ABSL_CHECK(tess_ != nullptr);
+  }
+  BoundaryTessellator(const BoundaryTessellator&) = delete;
+  BoundaryTessellator& operator=(const BoundaryTessellator&) = delete;
+  ~BoundaryTessellator() { tessDeleteTess(tess_); }
+
+  // Adds the closed polygon `points` as a contour. Polygons with fewer than
+  // three points are ignored, since they don't cover anything.
+  void AddContour(absl::Span<const Point> points) {
+    static_assert(sizeof(Point) == 2 * sizeof(TESSreal));
+    if (points.size() < 3) return;
+    tessAddContour(tess_, /*size=*/2, points.data(), sizeof(Point),
+                   points.size());
+    ++contour_count_;
+  }
+
+  absl::StatusOr<Polygons> NonZeroBoundaries() {
+    // libtess2 fails if it has no contours, rather than giving an empty result.
+    if (contour_count_ == 0) return Polygons();
+
+    // Giving the normal explicitly, rather than letting libtess2 guess it from
+    // the input, makes outer boundaries counter-clockwise and holes clockwise.
+    constexpr TESSreal kNormal[3] = {0, 0, 1};
+    if (!tessTesselate(tess_, TESS_WINDING_NONZERO, TESS_BOUNDARY_CONTOURS,
+                       /*polySize=*/0, /*vertexSize=*/2, kNormal)) {
+      return absl::InternalError(
+          "Could not compute the union of the outlines.");
+    }
+
+    // Each boundary contour is a pair of the index of its first vertex and its
+    // vertex count.
+    const TESSreal* vertices = tessGetVertices(tess_);
+    const TESSindex* contours = tessGetElements(tess_);
+    Polygons polygons(tessGetElementCount(tess_));
+    for (size_t i = 0; i < polygons.size(); ++i) {
+      TESSindex first = contours[2 * i];
+      TESSindex count = contours[2 * i + 1];
+      polygons[i].reserve(count);
+      for (TESSindex v = first; v < first + count; ++v) {
+        polygons[i].push_back({vertices[2 * v], vertices[2 * v + 1]});
+      }
+    }
+    return polygons;
+  }
+
+ private:
+  TESStesselator* absl_nonnull tess_;
+  int contour_count_ = 0;
+};
+
+// Adds the contours covering render group `group_index` of `shape` to
+// `tessellator`: its outlines if it has any, or else each of its triangles.
+void AddRenderGroupContours(const PartitionedMesh& shape, uint32_t group_index,
+                            BoundaryTessellator& tessellator) {
+  std::vector<Point> points;
+  uint32_t outline_count = shape.OutlineCount(group_index);
+  if (outline_count > 0) {
+    for (uint32_t o = 0; o < outline_count; ++o) {
+      points.clear();
+      for (uint32_t v = 0; v < shape.OutlineVertexCount(group_index, o); ++v) {
+        points.push_back(shape.OutlinePosition(group_index, o, v));
+      }
+      tessellator.AddContour(points);
+    }
+    return;
+  }
+
+  for (const Mesh& mesh : shape.RenderGroupMeshes(group_index)) {
+    for (uint32_t t = 0; t < mesh.TriangleCount(); ++t) {
+      Triangle triangle = mesh.GetTriangle(t);
+      // Degenerate triangles don't cover anything.
+      if (triangle.SignedArea() == 0) continue;
+      points = {triangle.p0, triangle.p1, triangle.p2};
+      tessellator.AddContour(points);
+    }
+  }
+}
+
+absl::Status CheckWithinTessellatorRange(const PartitionedMesh& shape,
+                                         size_t shape_index) {
+  std::optional<Rect> bounds = shape.Bounds().AsRect();
+  if (!bounds.has_value()) return absl::OkStatus();
+  if (!(std::abs(bounds->XMin()) <= kMaxTessellatorCoordinate) ||
+      !(std::abs(bounds->XMax()) <= kMaxTessellatorCoordinate) ||
+      !(std::abs(bounds->YMin()) <= kMaxTessellatorCoordinate) ||
+      !(std::abs(bounds->YMax()) <= kMaxTessellatorCoordinate)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The vertices of shapes[", shape_index,
+        "] are too far from the origin to compute a union; coordinates must "
+        "have a magnitude of at most 2^23."));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<Polygons> PolygonUnion(absl::Span<const PartitionedMesh> shapes,
+                                      Executor* absl_nullable executor) {
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    if (absl::Status status = CheckWithinTessellatorRange(shapes[i], i);
+        !status.ok()) {
+      return status;
+    }
+  }
+
+  // A stroke's outlines overlap each other, and themselves, so each shape is
+  // first reduced to its own boundary. Those are usually much simpler, which
+  // keeps the final merge small.
+  std::vector<absl::StatusOr<Polygons>> shape_boundaries(shapes.size());
+  ParallelFor(executor, shapes.size(), [&](size_t i) {
+    BoundaryTessellator tessellator;
+    for (uint32_t g = 0; g < shapes[i].RenderGroupCount(); ++g) {
+      AddRenderGroupContours(shapes[i], g, tessellator);
+    }
+    shape_boundaries[i] = tessellator.NonZeroBoundaries();
+  });
+  for (absl::StatusOr<Polygons>& boundaries : shape_boundaries) {
+    if (!boundaries.ok()) return boundaries.status();
+  }
+  if (shape_boundaries.size() == 1) return *std::move(shape_boundaries[0]);
+
+  // Every point has a winding number of 0 or 1 with respect to each shape's
+  // boundary, so the non-zero rule gives the union.
+  BoundaryTessellator tessellator;
+  for (const absl::StatusOr<Polygons>& boundaries : shape_boundaries) {
+    for (const std::vector<Point>& polygon : *boundaries) {
+      tessellator.AddContour(polygon);
+    }
+  }
+  return tessellator.NonZeroBoundaries();
+}
+
+}  // namespace ink
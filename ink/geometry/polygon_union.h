@@ -0,0 +1,57 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_GEOMETRY_POLYGON_UNION_H_
+#define INK_GEOMETRY_POLYGON_UNION_H_
+
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+// Returns the boundary of the union of the areas covered by `shapes`, as
+// non-overlapping closed polygons (the last point of each implicitly connects
+// back to the first). This is meant for vector export and for converting ink
+// to shapes, where writing out every triangle would be much larger and slower
+// to render.
+//
+// Outer boundaries are counter-clockwise and the boundaries of holes are
+// clockwise, so the result can be filled with either the non-zero or the
+// even-odd rule. Polygons don't cross each other or themselves, though they
+// may touch at vertices. The result may have vertices that aren't vertices of
+// `shapes`, where their outlines cross.
+//
+// Each render group is covered by its outlines (see
+// `PartitionedMesh::Outline()`), filled with the non-zero winding rule, as
+// when rendering with a `PathDrawable`. Since outlines are much shorter than
+// the triangle lists, this is the fast path; render groups that have meshes
+// but no outlines fall back to the union of their triangles. The union of each
+// shape is computed on its own, concurrently if `executor` is non-null, and
+// the results are then merged; the result is the same either way.
+//
+// Returns an error if any vertex of `shapes` has a coordinate with magnitude
+// greater than 2^23, or if the union could not be computed.
+absl::StatusOr<std::vector<std::vector<Point>>> PolygonUnion(
+    absl::Span<const PartitionedMesh> shapes,
+    Executor* absl_nullable executor = nullptr);
+
+}  // namespace ink
+
+#endif  // INK_GEOMETRY_POLYGON_UNION_H_
@@ -0,0 +1,170 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/geometry/polygon_union.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::FloatEq;
+using ::testing::Gt;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+// Returns a shape covering the axis-aligned rectangle from `min` to `max`,
+// whose outline runs counter-clockwise, or clockwise if `reversed` is true.
+PartitionedMesh MakeRectShape(Point min, Point max, bool reversed = false) {
+  MutableMesh mesh;
+  mesh.AppendVertex(min);
+  mesh.AppendVertex({max.x, min.y});
+  mesh.AppendVertex(max);
+  mesh.AppendVertex({min.x, max.y});
+  mesh.AppendTriangleIndices({0, 1, 2});
+  mesh.AppendTriangleIndices({0, 2, 3});
+  std::vector<uint32_t> outline = {0, 1, 2, 3};
+  if (reversed) outline = {3, 2, 1, 0};
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(mesh, {absl::MakeConstSpan(outline)});
+  ABSL_CHECK_OK(shape);
+  return *shape;
+}
+
+float SignedArea(const std::vector<Point>& polygon) {
+  float twice_area = 0;
+  for (size_t i = 0; i < polygon.size(); ++i) {
+    Point a = polygon[i];
+    Point b = polygon[(i + 1) % polygon.size()];
+    twice_area += a.x * b.y - b.x * a.y;
+  }
+  return twice_area / 2;
+}
+
+float TotalSignedArea(const std::vector<std::vector<Point>>& polygons) {
+  float area = 0;
+  for (const std::vector<Point>& polygon : polygons) {
+    area += SignedArea(polygon);
+  }
+  return area;
+}
+
+TEST(PolygonUnionTest, NoShapes) {
+  absl::StatusOr<std::vector<std::vector<Point>>> polygons = PolygonUnion({});
+  ASSERT_THAT(polygons, IsOk());
+  EXPECT_THAT(*polygons, IsEmpty());
+}
+
+TEST(PolygonUnionTest, EmptyShape) {
+  absl::StatusOr<std::vector<std::vector<Point>>> polygons =
+      PolygonUnion({PartitionedMesh()});
+  ASSERT_THAT(polygons, IsOk());
+  EXPECT_THAT(*polygons, IsEmpty());
+}
+
+TEST(PolygonUnionTest, SingleShapeIsCounterClockwise) {
+  absl::StatusOr<std::vector<std::vector<Point>>> polygons =
+      PolygonUnion({MakeRectShape({0, 0}, {2, 1}, /*reversed=*/true)});
+  ASSERT_THAT(polygons, IsOk());
+  ASSERT_THAT(*polygons, SizeIs(1));
+  EXPECT_THAT(SignedArea((*polygons)[0]), FloatEq(2));
+}
+
+TEST(PolygonUnionTest, OverlappingShapesMergeIntoOnePolygon) {
+  absl::StatusOr<std::vector<std::vector<Point>>> polygons = PolygonUnion(
+      {MakeRectShape({0, 0}, {2, 2}), MakeRectShape({1, 1}, {3, 3})});
+  ASSERT_THAT(polygons, IsOk());
+  ASSERT_THAT(*polygons, SizeIs(1));
+  EXPECT_THAT(SignedArea((*polygons)[0]), FloatEq(7));
+}
+
+TEST(PolygonUnionTest, DisjointShapesStaySeparate) {
+  absl::StatusOr<std::vector<std::vector<Point>>> polygons = PolygonUnion(
+      {MakeRectShape({0, 0}, {1, 1}), MakeRectShape({5, 5}, {7, 6})});
+  ASSERT_THAT(polygons, IsOk());
+  ASSERT_THAT(*polygons, SizeIs(2));
+  EXPECT_THAT(SignedArea((*polygons)[0]), Gt(0));
+  EXPECT_THAT(SignedArea((*polygons)[1]), Gt(0));
+  EXPECT_THAT(TotalSignedArea(*polygons), FloatEq(3));
+}
+
+TEST(PolygonUnionTest, EnclosedHoleIsClockwise) {
+  // Four bars forming a square frame around the hole from (1, 1) to (3, 3).
+  absl::StatusOr<std::vector<std::vector<Point>>> polygons = PolygonUnion(
+      {MakeRectShape({0, 0}, {4, 1}), MakeRectShape({3, 0}, {4, 4}),
+       MakeRectShape({0, 3}, {4, 4}), MakeRectShape({0, 0}, {1, 4})});
+  ASSERT_THAT(polygons, IsOk());
+  ASSERT_THAT(*polygons, SizeIs(2));
+  float area0 = SignedArea((*polygons)[0]);
+  float area1 = SignedArea((*polygons)[1]);
+  EXPECT_THAT(std::max(area0, area1), FloatEq(16));
+  EXPECT_THAT(std::min(area0, area1), FloatEq(-4));
+}
+
+TEST(PolygonUnionTest, ShapeWithoutOutlinesUsesItsTriangles) {
+  // A strip of four unit-area triangles along the x-axis.
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(4);
+  ASSERT_EQ(shape.OutlineCount(0), 0);
+  absl::StatusOr<std::vector<std::vector<Point>>> polygons =
+      PolygonUnion({shape});
+  ASSERT_THAT(polygons, IsOk());
+  ASSERT_THAT(*polygons, SizeIs(1));
+  EXPECT_THAT(SignedArea((*polygons)[0]), FloatEq(4));
+}
+
+TEST(PolygonUnionTest, SameResultWithExecutor) {
+  std::vector<PartitionedMesh> shapes;
+  for (int i = 0; i < 8; ++i) {
+    shapes.push_back(MakeRectShape({i * 1.5f, 0}, {i * 1.5f + 2, 1}));
+  }
+  absl::StatusOr<std::vector<std::vector<Point>>> serial =
+      PolygonUnion(shapes);
+  ThreadPerTaskExecutor executor;
+  absl::StatusOr<std::vector<std::vector<Point>>> parallel =
+      PolygonUnion(shapes, &executor);
+  ASSERT_THAT(serial, IsOk());
+  ASSERT_THAT(parallel, IsOk());
+  EXPECT_EQ(*parallel, *serial);
+  ASSERT_THAT(*serial, SizeIs(1));
+  EXPECT_THAT(SignedArea((*serial)[0]), FloatEq(12.5));
+}
+
+TEST(PolygonUnionTest, CoordinatesTooLarge) {
+  EXPECT_THAT(PolygonUnion({MakeRectShape({0, 0}, {1, 1}),
+                            MakeRectShape({0, 0}, {1e8, 1})}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("shapes[1]")));
+}
+
+}  // namespace
+}  // namespace ink
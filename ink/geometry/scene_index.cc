@@ -0,0 +1,353 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/scene_index.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/functional/function_ref.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/distance.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/internal/static_rtree.h"
+#include "ink/geometry/intersects.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink {
+namespace {
+
+using FlowControl = PartitionedMesh::FlowControl;
+
+// The minimum number of changes since the last rebuild before the tree is
+// rebuilt automatically. Below this, checking the unindexed shapes linearly is
+// cheap enough that rebuilding isn't worth it.
+constexpr size_t kMinChangesBeforeRebuild = 32;
+
+std::optional<Rect> ComputeSceneBounds(const PartitionedMesh& shape,
+                                       const AffineTransform& shape_to_scene) {
+  std::optional<Rect> bounds = shape.Bounds().AsRect();
+  if (!bounds.has_value()) return std::nullopt;
+  return Envelope(shape_to_scene.Apply(*bounds)).AsRect();
+}
+
+}  // namespace
+
+void SceneIndex::Insert(ShapeId id, const PartitionedMesh& shape,
+                        const AffineTransform& shape_to_scene) {
+  auto [it, inserted] = entries_.try_emplace(id);
+  if (!inserted) Unlink(id, it->second);
+  it->second = Entry{.shape = shape,
+                     .shape_to_scene = shape_to_scene,
+                     .scene_bounds = ComputeSceneBounds(shape, shape_to_scene),
+                     .in_rtree = false};
+  if (it->second.scene_bounds.has_value()) unindexed_ids_.push_back(id);
+  MaybeRebuild();
+}
+
+bool SceneIndex::Remove(ShapeId id) {
+  auto it = entries_.find(id);
+  if (it == entries_.end()) return false;
+  Unlink(id, it->second);
+  entries_.erase(it);
+  MaybeRebuild();
+  return true;
+}
+
+void SceneIndex::Clear() {
+  entries_.clear();
+  rtree_ = {};
+  stale_rtree_element_count_ = 0;
+  unindexed_ids_.clear();
+}
+
+bool SceneIndex::Contains(ShapeId id) const { return entries_.contains(id); }
+
+size_t SceneIndex::Size() const { return entries_.size(); }
+
+void SceneIndex::Rebuild() {
+  std::vector<ShapeId> ids;
+  std::vector<Rect> bounds;
+  ids.reserve(entries_.size());
+  bounds.reserve(entries_.size());
+  for (auto& [id, entry] : entries_) {
+    entry.in_rtree = entry.scene_bounds.has_value();
+    if (!entry.in_rtree) continue;
+    ids.push_back(id);
+    bounds.push_back(*entry.scene_bounds);
+  }
+  rtree_ = geometry_internal::StaticRTree<ShapeId>(ids, bounds);
+  stale_rtree_element_count_ = 0;
+  unindexed_ids_.clear();
+}
+
+void SceneIndex::Unlink(ShapeId id, const Entry& entry) {
+  if (entry.in_rtree) {
+    ++stale_rtree_element_count_;
+  } else if (entry.scene_bounds.has_value()) {
+    unindexed_ids_.erase(absl::c_find(unindexed_ids_, id));
+  }
+}
+
+void SceneIndex::MaybeRebuild() {
+  size_t n_changes = unindexed_ids_.size() + stale_rtree_element_count_;
+  if (n_changes >=
+      std::max(kMinChangesBeforeRebuild, rtree_.Elements().size() / 4)) {
+    Rebuild();
+  }
+}
+
+void SceneIndex::VisitCandidateEntries(
+    const Rect& scene_bounds,
+    absl::FunctionRef<bool(ShapeId, const Entry&)> visitor) const {
+  bool keep_going = true;
+  if (!rtree_.Elements().empty()) {
+    rtree_.VisitIntersectedElements(
+        scene_bounds, [this, &visitor, &keep_going](ShapeId id) {
+          auto it = entries_.find(id);
+          // Skip elements whose entries have since been removed or replaced.
+          if (it == entries_.end() || !it->second.in_rtree) return true;
+          keep_going = visitor(id, it->second);
+          return keep_going;
+        });
+  }
+  if (!keep_going) return;
+
+  for (ShapeId id : unindexed_ids_) {
+    const Entry& entry = entries_.at(id);
+    if (Intersects(*entry.scene_bounds, scene_bounds) && !visitor(id, entry)) {
+      return;
+    }
+  }
+}
+
+void SceneIndex::VisitCandidateShapes(
+    const Rect& scene_bounds,
+    absl::FunctionRef<FlowControl(ShapeId)> visitor) const {
+  VisitCandidateEntries(scene_bounds, [&visitor](ShapeId id, const Entry&) {
+    return visitor(id) == FlowControl::kContinue;
+  });
+}
+
+void SceneIndex::VisitCandidateShapesAndTransforms(
+    const Rect& scene_bounds,
+    absl::FunctionRef<FlowControl(ShapeId, const PartitionedMesh&,
+                                  const AffineTransform&)>
+        visitor) const {
+  VisitCandidateEntries(scene_bounds,
+                        [&visitor](ShapeId id, const Entry& entry) {
+                          return visitor(id, entry.shape,
+                                         entry.shape_to_scene) ==
+                                 FlowControl::kContinue;
+                        });
+}
+
+void SceneIndex::VisitMatchingShapes(
+    const Rect& scene_bounds, absl::FunctionRef<bool(const Entry&)> matches,
+    absl::FunctionRef<FlowControl(ShapeId)> visitor) const {
+  VisitCandidateEntries(
+      scene_bounds, [&matches, &visitor](ShapeId id, const Entry& entry) {
+        return !matches(entry) || visitor(id) == FlowControl::kContinue;
+      });
+}
+
+void SceneIndex::VisitIntersectedShapes(
+    Point query, absl::FunctionRef<FlowControl(ShapeId)> visitor,
+    const AffineTransform& query_to_scene) const {
+  Point scene_query = query_to_scene.Apply(query);
+  VisitMatchingShapes(
+      *Envelope(scene_query).AsRect(),
+      [scene_query](const Entry& entry) {
+        return Intersects(scene_query, entry.shape, entry.shape_to_scene);
+      },
+      visitor);
+}
+
+void SceneIndex::VisitIntersectedShapes(
+    const Segment& query, absl::FunctionRef<FlowControl(ShapeId)> visitor,
+    const AffineTransform& query_to_scene) const {
+  Segment scene_query = query_to_scene.Apply(query);
+  VisitMatchingShapes(
+      *Envelope(scene_query).AsRect(),
+      [&scene_query](const Entry& entry) {
+        return Intersects(scene_query, entry.shape, entry.shape_to_scene);
+      },
+      visitor);
+}
+
+void SceneIndex::VisitIntersectedShapes(
+    const Triangle& query, absl::FunctionRef<FlowControl(ShapeId)> visitor,
+    const AffineTransform& query_to_scene) const {
+  Triangle scene_query = query_to_scene.Apply(query);
+  VisitMatchingShapes(
+      *Envelope(scene_query).AsRect(),
+      [&scene_query](const Entry& entry) {
+        return Intersects(scene_query, entry.shape, entry.shape_to_scene);
+      },
+      visitor);
+}
+
+void SceneIndex::VisitIntersectedShapes(
+    const Rect& query, absl::FunctionRef<FlowControl(ShapeId)> visitor,
+    const AffineTransform& query_to_scene) const {
+  // A transformed `Rect` is not in general a `Rect`, so this is handled as a
+  // `Quad` once it's in scene coordinates.
+  VisitIntersectedShapes(query_to_scene.Apply(query), visitor);
+}
+
+void SceneIndex::VisitIntersectedShapes(
+    const Quad& query, absl::FunctionRef<FlowControl(ShapeId)> visitor,
+    const AffineTransform& query_to_scene) const {
+  Quad scene_query = query_to_scene.Apply(query);
+  VisitMatchingShapes(
+      *Envelope(scene_query).AsRect(),
+      [&scene_query](const Entry& entry) {
+        return Intersects(scene_query, entry.shape, entry.shape_to_scene);
+      },
+      visitor);
+}
+
+void SceneIndex::VisitIntersectedShapes(
+    const PartitionedMesh& query,
+    absl::FunctionRef<FlowControl(ShapeId)> visitor,
+    const AffineTransform& query_to_scene) const {
+  std::optional<Rect> scene_bounds =
+      ComputeSceneBounds(query, query_to_scene);
+  if (!scene_bounds.has_value()) return;
+  VisitMatchingShapes(
+      *scene_bounds,
+      [&query, &query_to_scene](const Entry& entry) {
+        return Intersects(query, query_to_scene, entry.shape,
+                          entry.shape_to_scene);
+      },
+      visitor);
+}
+
+void SceneIndex::VisitShapesWithCoverageGreaterThan(
+    const Quad& query, float coverage_threshold,
+    absl::FunctionRef<FlowControl(ShapeId)> visitor,
+    const AffineTransform& query_to_scene) const {
+  VisitMatchingShapes(
+      *Envelope(query_to_scene.Apply(query)).AsRect(),
+      [&query, coverage_threshold, &query_to_scene](const Entry& entry) {
+        std::optional<AffineTransform> scene_to_shape =
+            entry.shape_to_scene.Inverse();
+        return scene_to_shape.has_value() &&
+               entry.shape.CoverageIsGreaterThan(
+                   query, coverage_threshold,
+                   *scene_to_shape * query_to_scene);
+      },
+      visitor);
+}
+
+void SceneIndex::VisitShapesWithCoverageGreaterThan(
+    const PartitionedMesh& query, float coverage_threshold,
+    absl::FunctionRef<FlowControl(ShapeId)> visitor,
+    const AffineTransform& query_to_scene) const {
+  std::optional<Rect> scene_bounds =
+      ComputeSceneBounds(query, query_to_scene);
+  if (!scene_bounds.has_value()) return;
+  VisitMatchingShapes(
+      *scene_bounds,
+      [&query, coverage_threshold, &query_to_scene](const Entry& entry) {
+        std::optional<AffineTransform> scene_to_shape =
+            entry.shape_to_scene.Inverse();
+        return scene_to_shape.has_value() &&
+               entry.shape.CoverageIsGreaterThan(
+                   query, coverage_threshold,
+                   *scene_to_shape * query_to_scene);
+      },
+      visitor);
+}
+
+std::vector<SceneIndex::ShapeDistance> SceneIndex::FindNearestShapes(
+    Point query, size_t max_count, float max_distance) const {
+  return FindNearestShapes(
+      [query](const Rect& bounds) { return Distance(query, bounds); },
+      [query](const Entry& entry) {
+        return Distance(query, entry.shape, entry.shape_to_scene);
+      },
+      max_count, max_distance);
+}
+
+std::vector<SceneIndex::ShapeDistance> SceneIndex::FindNearestShapes(
+    const Segment& query, size_t max_count, float max_distance) const {
+  return FindNearestShapes(
+      [&query](const Rect& bounds) { return Distance(query, bounds); },
+      [&query](const Entry& entry) {
+        return Distance(query, entry.shape, entry.shape_to_scene);
+      },
+      max_count, max_distance);
+}
+
+std::vector<SceneIndex::ShapeDistance> SceneIndex::FindNearestShapes(
+    absl::FunctionRef<float(const Rect&)> bounds_distance,
+    absl::FunctionRef<float(const Entry&)> shape_distance, size_t max_count,
+    float max_distance) const {
+  // This is kept sorted by distance, nearest first.
+  std::vector<ShapeDistance> nearest;
+  if (max_count == 0) return nearest;
+
+  // Returns true if nothing at `distance` or farther can be added to
+  // `nearest`. Once there are `max_count` results, a new one must be strictly
+  // nearer than the farthest of them to replace it.
+  auto is_out_of_range = [&nearest, max_count, max_distance](float distance) {
+    return nearest.size() == max_count ? distance >= nearest.back().distance
+                                       : distance > max_distance;
+  };
+  auto consider_shape = [&nearest, &shape_distance, &is_out_of_range,
+                         max_count](ShapeId id, const Entry& entry,
+                                    float bounds_distance) {
+    if (is_out_of_range(bounds_distance)) return;
+    float distance = shape_distance(entry);
+    if (is_out_of_range(distance)) return;
+    if (nearest.size() == max_count) nearest.pop_back();
+    nearest.insert(absl::c_upper_bound(nearest, distance,
+                                       [](float d, const ShapeDistance& s) {
+                                         return d < s.distance;
+                                       }),
+                   {.id = id, .distance = distance});
+  };
+
+  // The unindexed shapes are checked first, so that their results can prune
+  // the search of the tree.
+  for (ShapeId id : unindexed_ids_) {
+    const Entry& entry = entries_.at(id);
+    consider_shape(id, entry, bounds_distance(*entry.scene_bounds));
+  }
+  rtree_.VisitElementsInBoundsDistanceOrder(
+      bounds_distance,
+      [this, &consider_shape, &is_out_of_range](float bounds_distance,
+                                                ShapeId id) {
+        if (is_out_of_range(bounds_distance)) return false;
+        auto it = entries_.find(id);
+        // Skip elements whose entries have since been removed or replaced.
+        if (it == entries_.end() || !it->second.in_rtree) return true;
+        consider_shape(id, it->second, bounds_distance);
+        return true;
+      });
+  return nearest;
+}
+
+}  // namespace ink
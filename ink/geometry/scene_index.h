@@ -0,0 +1,233 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_GEOMETRY_SCENE_INDEX_H_
+#define INK_GEOMETRY_SCENE_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/internal/static_rtree.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+
+namespace ink {
+
+// A spatial index over a collection of `PartitionedMesh`es (e.g. the shapes of
+// the strokes in a document), each of which is placed in a common "scene"
+// coordinate space by its own transform. This allows queries such as eraser or
+// selection hit-tests to find the shapes near the query without checking the
+// bounds of every shape, and then run the per-shape `Intersects` or
+// `CoverageIsGreaterThan` tests on just those.
+//
+// Each shape is identified by a caller-chosen `ShapeId`. Shapes can be inserted
+// and removed at any time. Internally, the index keeps a `StaticRTree` over the
+// scene-space bounds of the shapes, plus a short list of shapes that have been
+// inserted since the tree was last built, which are checked linearly. The tree
+// is rebuilt automatically once enough shapes have been inserted or removed
+// since the last build, so the amortized cost of each change is small.
+//
+// `SceneIndex` is thread-compatible: concurrent queries are safe, but
+// insertions and removals must not happen concurrently with anything else.
+class SceneIndex {
+ public:
+  using ShapeId = uint64_t;
+
+  SceneIndex() = default;
+  SceneIndex(const SceneIndex&) = default;
+  SceneIndex(SceneIndex&&) = default;
+  SceneIndex& operator=(const SceneIndex&) = default;
+  SceneIndex& operator=(SceneIndex&&) = default;
+  ~SceneIndex() = default;
+
+  // Adds `shape` to the index, identified by `id`, where `shape_to_scene` maps
+  // from the shape's coordinate space to scene coordinates. If the index
+  // already contains a shape with the same `id`, it is replaced.
+  //
+  // Because `PartitionedMesh` is cheap to copy, this shares the shape's data
+  // (including its spatial index) rather than copying it. This means that
+  // instances of one shape, such as stamps or pasted duplicates, can each be
+  // inserted under their own `id` and `shape_to_scene`, and they all share a
+  // single copy of the meshes and of the per-shape `StaticRTree`, which is only
+  // built once for all of them.
+  void Insert(ShapeId id, const PartitionedMesh& shape,
+              const AffineTransform& shape_to_scene = {});
+
+  // Removes the shape identified by `id`. Returns false if there was no such
+  // shape.
+  bool Remove(ShapeId id);
+
+  // Removes all shapes.
+  void Clear();
+
+  // Returns true if the index contains a shape identified by `id`.
+  bool Contains(ShapeId id) const;
+
+  // Returns the number of shapes in the index.
+  size_t Size() const;
+
+  // Rebuilds the internal tree over all of the shapes. This happens
+  // automatically as shapes are inserted and removed, but can be called
+  // explicitly to make subsequent queries as fast as possible, e.g. after
+  // loading a document.
+  void Rebuild();
+
+  // Visits the shapes whose scene-space bounding boxes intersect
+  // `scene_bounds`, until `visitor` returns `kBreak`. These are the candidates
+  // that a precise query would need to check. The visitation order is
+  // arbitrary.
+  void VisitCandidateShapes(
+      const Rect& scene_bounds,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor) const;
+
+  // Like `VisitCandidateShapes`, but also passes `visitor` each shape and its
+  // transform to scene coordinates, so that callers can run their own precise
+  // tests on the candidates.
+  void VisitCandidateShapesAndTransforms(
+      const Rect& scene_bounds,
+      absl::FunctionRef<PartitionedMesh::FlowControl(
+          ShapeId, const PartitionedMesh&, const AffineTransform&)>
+          visitor) const;
+
+  // Visits the shapes that intersect `query`, as per the `Intersects` family of
+  // functions, until `visitor` returns `kBreak`. `query_to_scene` maps from
+  // the query's coordinate space to scene coordinates. The visitation order is
+  // arbitrary.
+  void VisitIntersectedShapes(
+      Point query,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor,
+      const AffineTransform& query_to_scene = {}) const;
+  void VisitIntersectedShapes(
+      const Segment& query,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor,
+      const AffineTransform& query_to_scene = {}) const;
+  void VisitIntersectedShapes(
+      const Triangle& query,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor,
+      const AffineTransform& query_to_scene = {}) const;
+  void VisitIntersectedShapes(
+      const Rect& query,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor,
+      const AffineTransform& query_to_scene = {}) const;
+  void VisitIntersectedShapes(
+      const Quad& query,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor,
+      const AffineTransform& query_to_scene = {}) const;
+  void VisitIntersectedShapes(
+      const PartitionedMesh& query,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor,
+      const AffineTransform& query_to_scene = {}) const;
+
+  // Visits the shapes for which the fraction of their area covered by `query`
+  // is greater than `coverage_threshold`, as per
+  // `PartitionedMesh::CoverageIsGreaterThan`, until `visitor` returns
+  // `kBreak`. `query_to_scene` maps from the query's coordinate space to scene
+  // coordinates. Shapes whose transform is not invertible have no area in the
+  // scene, and so are never visited. The visitation order is arbitrary.
+  void VisitShapesWithCoverageGreaterThan(
+      const Quad& query, float coverage_threshold,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor,
+      const AffineTransform& query_to_scene = {}) const;
+  void VisitShapesWithCoverageGreaterThan(
+      const PartitionedMesh& query, float coverage_threshold,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor,
+      const AffineTransform& query_to_scene = {}) const;
+
+  // A shape and its distance from a query, as returned by
+  // `FindNearestShapes`.
+  struct ShapeDistance {
+    ShapeId id;
+    float distance;
+  };
+
+  // Returns the (up to) `max_count` shapes that are nearest to `query` and no
+  // farther than `max_distance` from it, nearest first; e.g. for snapping, or
+  // for selecting the stroke under a tap. `query` and the distances are in
+  // scene coordinates, with each distance as per the `PartitionedMesh`
+  // overloads of `Distance`. Shapes at equal distances are returned in
+  // arbitrary order.
+  //
+  // This is a branch-and-bound search: shapes are considered in order of the
+  // distance to their bounds, and the search stops once that can't beat the
+  // results found so far.
+  std::vector<ShapeDistance> FindNearestShapes(
+      Point query, size_t max_count,
+      float max_distance = std::numeric_limits<float>::infinity()) const;
+  std::vector<ShapeDistance> FindNearestShapes(
+      const Segment& query, size_t max_count,
+      float max_distance = std::numeric_limits<float>::infinity()) const;
+
+ private:
+  struct Entry {
+    PartitionedMesh shape;
+    AffineTransform shape_to_scene;
+    // The bounds of `shape` in scene coordinates, or `std::nullopt` if `shape`
+    // is empty.
+    std::optional<Rect> scene_bounds;
+    // Whether this entry is in `rtree_`; if not, and it is non-empty, its ID is
+    // in `unindexed_ids_`.
+    bool in_rtree = false;
+  };
+
+  // Visits the entries whose scene-space bounds intersect `scene_bounds`,
+  // until `visitor` returns false.
+  void VisitCandidateEntries(
+      const Rect& scene_bounds,
+      absl::FunctionRef<bool(ShapeId, const Entry&)> visitor) const;
+
+  // Visits the shapes whose scene-space bounds intersect `scene_bounds` and
+  // for which `matches` returns true, until `visitor` returns `kBreak`.
+  void VisitMatchingShapes(
+      const Rect& scene_bounds, absl::FunctionRef<bool(const Entry&)> matches,
+      absl::FunctionRef<PartitionedMesh::FlowControl(ShapeId)> visitor) const;
+
+  // Helper for `FindNearestShapes`, where `bounds_distance` returns the
+  // distance from the query to a scene-space rect, and `shape_distance` returns
+  // the distance from the query to an entry's shape.
+  std::vector<ShapeDistance> FindNearestShapes(
+      absl::FunctionRef<float(const Rect&)> bounds_distance,
+      absl::FunctionRef<float(const Entry&)> shape_distance, size_t max_count,
+      float max_distance) const;
+
+  // Marks the entry for `id`, which is about to be replaced or removed, as no
+  // longer being part of the index.
+  void Unlink(ShapeId id, const Entry& entry);
+
+  // Calls `Rebuild()` if enough shapes have been inserted or removed since the
+  // last rebuild.
+  void MaybeRebuild();
+
+  absl::flat_hash_map<ShapeId, Entry> entries_;
+  // A tree over the IDs of non-empty entries as of the last rebuild. Some of
+  // these may since have been removed or replaced, and must be skipped.
+  geometry_internal::StaticRTree<ShapeId> rtree_;
+  // The number of elements of `rtree_` that have been removed or replaced.
+  size_t stale_rtree_element_count_ = 0;
+  // The IDs of non-empty entries that were inserted after the last rebuild.
+  std::vector<ShapeId> unindexed_ids_;
+};
+
+}  // namespace ink
+
+#endif  // INK_GEOMETRY_SCENE_INDEX_H_
@@ -0,0 +1,386 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/scene_index.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/geometry/vec.h"
+
+namespace ink {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
+using ShapeId = SceneIndex::ShapeId;
+using FlowControl = PartitionedMesh::FlowControl;
+
+// Returns a transform that places a two-triangle straight line mesh, which
+// spans [0, 3]x[-1, 0] in its own coordinates, at [10*i, 10*i + 3]x[-1, 0] in
+// scene coordinates.
+AffineTransform ShapeToScene(uint32_t i) {
+  return AffineTransform::Translate(Vec{10.f * i, 0});
+}
+
+// Returns an index containing `n_shapes` two-triangle straight line meshes,
+// where the shape with ID `i` is placed by `ShapeToScene(i)`.
+SceneIndex MakeRowOfShapes(uint32_t n_shapes) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(2);
+  SceneIndex index;
+  for (uint32_t i = 0; i < n_shapes; ++i) {
+    index.Insert(i, shape, ShapeToScene(i));
+  }
+  return index;
+}
+
+std::vector<ShapeId> GetCandidateShapes(const SceneIndex& index,
+                                        const Rect& scene_bounds) {
+  std::vector<ShapeId> ids;
+  index.VisitCandidateShapes(scene_bounds, [&ids](ShapeId id) {
+    ids.push_back(id);
+    return FlowControl::kContinue;
+  });
+  return ids;
+}
+
+template <typename QueryType>
+std::vector<ShapeId> GetIntersectedShapes(
+    const SceneIndex& index, const QueryType& query,
+    const AffineTransform& query_to_scene = {}) {
+  std::vector<ShapeId> ids;
+  index.VisitIntersectedShapes(
+      query,
+      [&ids](ShapeId id) {
+        ids.push_back(id);
+        return FlowControl::kContinue;
+      },
+      query_to_scene);
+  return ids;
+}
+
+template <typename QueryType>
+std::vector<ShapeId> GetShapesWithCoverageGreaterThan(
+    const SceneIndex& index, const QueryType& query, float threshold,
+    const AffineTransform& query_to_scene = {}) {
+  std::vector<ShapeId> ids;
+  index.VisitShapesWithCoverageGreaterThan(
+      query, threshold,
+      [&ids](ShapeId id) {
+        ids.push_back(id);
+        return FlowControl::kContinue;
+      },
+      query_to_scene);
+  return ids;
+}
+
+TEST(SceneIndexTest, DefaultConstructedIsEmpty) {
+  SceneIndex index;
+  EXPECT_EQ(index.Size(), 0);
+  EXPECT_FALSE(index.Contains(0));
+  EXPECT_THAT(GetCandidateShapes(index, Rect::FromTwoPoints({-1e6, -1e6},
+                                                            {1e6, 1e6})),
+              IsEmpty());
+  EXPECT_THAT(GetIntersectedShapes(index, Point{0, 0}), IsEmpty());
+}
+
+TEST(SceneIndexTest, InsertAndRemove) {
+  SceneIndex index;
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(2);
+  index.Insert(5, shape);
+  index.Insert(7, shape, ShapeToScene(1));
+
+  EXPECT_EQ(index.Size(), 2);
+  EXPECT_TRUE(index.Contains(5));
+  EXPECT_TRUE(index.Contains(7));
+  EXPECT_THAT(GetIntersectedShapes(index, Point{1, -0.5}), ElementsAre(5));
+  EXPECT_THAT(GetIntersectedShapes(index, Point{11, -0.5}), ElementsAre(7));
+
+  EXPECT_TRUE(index.Remove(5));
+  EXPECT_FALSE(index.Remove(5));
+  EXPECT_EQ(index.Size(), 1);
+  EXPECT_FALSE(index.Contains(5));
+  EXPECT_THAT(GetIntersectedShapes(index, Point{1, -0.5}), IsEmpty());
+  EXPECT_THAT(GetIntersectedShapes(index, Point{11, -0.5}), ElementsAre(7));
+}
+
+TEST(SceneIndexTest, InsertWithExistingIdReplacesShape) {
+  SceneIndex index;
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(2);
+  index.Insert(3, shape);
+  index.Insert(3, shape, ShapeToScene(2));
+
+  EXPECT_EQ(index.Size(), 1);
+  EXPECT_THAT(GetIntersectedShapes(index, Point{1, -0.5}), IsEmpty());
+  EXPECT_THAT(GetIntersectedShapes(index, Point{21, -0.5}), ElementsAre(3));
+}
+
+TEST(SceneIndexTest, EmptyShapeIsContainedButNeverVisited) {
+  SceneIndex index;
+  index.Insert(1, PartitionedMesh());
+
+  EXPECT_EQ(index.Size(), 1);
+  EXPECT_TRUE(index.Contains(1));
+  EXPECT_THAT(GetCandidateShapes(index, Rect::FromTwoPoints({-1e6, -1e6},
+                                                            {1e6, 1e6})),
+              IsEmpty());
+  EXPECT_TRUE(index.Remove(1));
+}
+
+TEST(SceneIndexTest, Clear) {
+  SceneIndex index = MakeRowOfShapes(100);
+  index.Clear();
+
+  EXPECT_EQ(index.Size(), 0);
+  EXPECT_THAT(GetCandidateShapes(index, Rect::FromTwoPoints({-1e6, -1e6},
+                                                            {1e6, 1e6})),
+              IsEmpty());
+}
+
+TEST(SceneIndexTest, VisitCandidateShapesUsesSceneBounds) {
+  SceneIndex index = MakeRowOfShapes(100);
+
+  EXPECT_THAT(GetCandidateShapes(index, Rect::FromTwoPoints({25, 5}, {48, 6})),
+              IsEmpty());
+  EXPECT_THAT(
+      GetCandidateShapes(index, Rect::FromTwoPoints({25, -0.5}, {48, 0})),
+      UnorderedElementsAre(3, 4));
+}
+
+TEST(SceneIndexTest, VisitCandidateShapesStopsOnBreak) {
+  SceneIndex index = MakeRowOfShapes(100);
+
+  int n_visited = 0;
+  index.VisitCandidateShapes(Rect::FromTwoPoints({-1e6, -1e6}, {1e6, 1e6}),
+                             [&n_visited](ShapeId) {
+                               ++n_visited;
+                               return FlowControl::kBreak;
+                             });
+  EXPECT_EQ(n_visited, 1);
+}
+
+TEST(SceneIndexTest, VisitCandidateShapesAndTransforms) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(2);
+  SceneIndex index;
+  for (uint32_t i = 0; i < 100; ++i) {
+    index.Insert(i, shape, ShapeToScene(i));
+  }
+
+  std::vector<ShapeId> ids;
+  index.VisitCandidateShapesAndTransforms(
+      Rect::FromTwoPoints({25, -0.5}, {48, 0}),
+      [&](ShapeId id, const PartitionedMesh& candidate,
+          const AffineTransform& shape_to_scene) {
+        EXPECT_EQ(candidate.Meshes().data(), shape.Meshes().data());
+        EXPECT_THAT(shape_to_scene, AffineTransformEq(ShapeToScene(id)));
+        ids.push_back(id);
+        return FlowControl::kContinue;
+      });
+  EXPECT_THAT(ids, UnorderedElementsAre(3, 4));
+}
+
+// Exercises the index across many insertions and removals, which cause the
+// internal tree to be rebuilt several times, checking against the expected
+// results after each step.
+TEST(SceneIndexTest, QueriesStayCorrectAcrossRebuilds) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(2);
+  SceneIndex index;
+  for (uint32_t i = 0; i < 500; ++i) {
+    index.Insert(i, shape, ShapeToScene(i));
+    ASSERT_THAT(GetIntersectedShapes(index, Point{10.f * i + 1, -0.5}),
+                ElementsAre(i));
+  }
+  std::vector<ShapeId> expected;
+  for (uint32_t i = 0; i < 500; ++i) {
+    if (i % 3 == 0) {
+      ASSERT_TRUE(index.Remove(i));
+    } else {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_THAT(GetIntersectedShapes(
+                  index, Rect::FromTwoPoints({-1, -0.5}, {5000, -0.25})),
+              UnorderedElementsAreArray(expected));
+
+  index.Rebuild();
+  EXPECT_THAT(GetIntersectedShapes(
+                  index, Rect::FromTwoPoints({-1, -0.5}, {5000, -0.25})),
+              UnorderedElementsAreArray(expected));
+}
+
+TEST(SceneIndexTest, VisitIntersectedShapesWithSimpleQueries) {
+  SceneIndex index = MakeRowOfShapes(10);
+
+  // Each shape covers the region between the lines y = 0 and y = -1 for x in
+  // [10*i + 1, 10*i + 2], but has a notch above (10*i, -1) and below
+  // (10*i + 3, 0).
+  EXPECT_THAT(GetIntersectedShapes(index, Point{31.5, -0.5}), ElementsAre(3));
+  EXPECT_THAT(GetIntersectedShapes(index, Point{30, -1}), IsEmpty());
+  EXPECT_THAT(GetIntersectedShapes(index, Segment{{25, -0.5}, {42, -0.5}}),
+              UnorderedElementsAre(3, 4));
+  EXPECT_THAT(
+      GetIntersectedShapes(index, Triangle{{51, -5}, {52, -5}, {51.5, 5}}),
+      ElementsAre(5));
+  EXPECT_THAT(
+      GetIntersectedShapes(index, Rect::FromTwoPoints({61, -5}, {72, 5})),
+      UnorderedElementsAre(6, 7));
+  EXPECT_THAT(GetIntersectedShapes(
+                  index, Quad::FromCenterAndDimensions({91.5, -0.5}, 1, 1)),
+              ElementsAre(9));
+}
+
+TEST(SceneIndexTest, InstancesShareTheShapeSpatialIndex) {
+  PartitionedMesh shape = MakeStraightLinePartitionedMesh(2);
+  SceneIndex index;
+  for (uint32_t i = 0; i < 10; ++i) {
+    index.Insert(i, shape, ShapeToScene(i));
+  }
+  ASSERT_FALSE(shape.IsSpatialIndexInitialized());
+
+  // Querying one instance builds the spatial index that all of them share.
+  EXPECT_THAT(GetIntersectedShapes(index, Point{31.5, -0.5}), ElementsAre(3));
+  EXPECT_TRUE(shape.IsSpatialIndexInitialized());
+  EXPECT_THAT(GetIntersectedShapes(index, Segment{{25, -0.5}, {42, -0.5}}),
+              UnorderedElementsAre(3, 4));
+}
+
+TEST(SceneIndexTest, VisitIntersectedShapesAppliesQueryToSceneTransform) {
+  SceneIndex index = MakeRowOfShapes(10);
+
+  EXPECT_THAT(GetIntersectedShapes(index, Point{1.5, -0.5},
+                                   AffineTransform::Translate({40, 0})),
+              ElementsAre(4));
+  EXPECT_THAT(
+      GetIntersectedShapes(index, Rect::FromTwoPoints({0.08, -0.1}, {0.19, 0}),
+                           AffineTransform::Scale(150)),
+      UnorderedElementsAre(1, 2));
+}
+
+TEST(SceneIndexTest, VisitIntersectedShapesWithPartitionedMeshQuery) {
+  SceneIndex index = MakeRowOfShapes(10);
+  PartitionedMesh query = MakeStraightLinePartitionedMesh(2);
+
+  EXPECT_THAT(
+      GetIntersectedShapes(index, query, AffineTransform::Translate({20, 0})),
+      ElementsAre(2));
+  EXPECT_THAT(
+      GetIntersectedShapes(index, query, AffineTransform::Translate({5, 0})),
+      IsEmpty());
+  EXPECT_THAT(GetIntersectedShapes(index, PartitionedMesh()), IsEmpty());
+}
+
+TEST(SceneIndexTest, VisitShapesWithCoverageGreaterThan) {
+  SceneIndex index = MakeRowOfShapes(10);
+
+  // This covers all of shape 3, and intersects one of the two triangles of
+  // shape 4.
+  Quad query = Quad::FromRect(Rect::FromTwoPoints({29, -2}, {40.5, 1}));
+  EXPECT_THAT(GetShapesWithCoverageGreaterThan(index, query, 0.1),
+              UnorderedElementsAre(3, 4));
+  EXPECT_THAT(GetShapesWithCoverageGreaterThan(index, query, 0.9),
+              ElementsAre(3));
+  EXPECT_THAT(GetShapesWithCoverageGreaterThan(
+                  index, query, 0.9, AffineTransform::Translate({10, 0})),
+              ElementsAre(4));
+
+  PartitionedMesh mesh_query = MakeStraightLinePartitionedMesh(2);
+  EXPECT_THAT(GetShapesWithCoverageGreaterThan(
+                  index, mesh_query, 0.9, AffineTransform::Translate({60, 0})),
+              ElementsAre(6));
+}
+
+TEST(SceneIndexTest, CoverageSkipsShapesWithNonInvertibleTransform) {
+  SceneIndex index;
+  index.Insert(1, MakeStraightLinePartitionedMesh(2),
+               AffineTransform::ScaleY(0));
+
+  EXPECT_THAT(GetShapesWithCoverageGreaterThan(
+                  index, Quad::FromCenterAndDimensions({0, 0}, 10, 10), 0),
+              IsEmpty());
+}
+
+std::vector<ShapeId> GetIds(
+    const std::vector<SceneIndex::ShapeDistance>& shape_distances) {
+  std::vector<ShapeId> ids;
+  for (const SceneIndex::ShapeDistance& shape_distance : shape_distances) {
+    ids.push_back(shape_distance.id);
+  }
+  return ids;
+}
+
+TEST(SceneIndexTest, FindNearestShapesToPoint) {
+  SceneIndex index = MakeRowOfShapes(5);
+
+  std::vector<SceneIndex::ShapeDistance> nearest =
+      index.FindNearestShapes(Point{25, -0.5}, 2);
+  ASSERT_THAT(GetIds(nearest), ElementsAre(2, 3));
+  // The nearest points are the corner (23, -1) of shape 2 and the corner
+  // (30, 0) of shape 3.
+  EXPECT_FLOAT_EQ(nearest[0].distance, std::hypot(2.f, 0.5f));
+  EXPECT_FLOAT_EQ(nearest[1].distance, std::hypot(5.f, 0.5f));
+
+  EXPECT_THAT(GetIds(index.FindNearestShapes(Point{25, -0.5}, 5)),
+              ElementsAre(2, 3, 1, 4, 0));
+  EXPECT_THAT(GetIds(index.FindNearestShapes(Point{25, -0.5}, 5, 6)),
+              ElementsAre(2, 3));
+  EXPECT_THAT(GetIds(index.FindNearestShapes(Point{25, -0.5}, 0)), IsEmpty());
+  EXPECT_THAT(GetIds(SceneIndex().FindNearestShapes(Point{25, -0.5}, 1)),
+              IsEmpty());
+}
+
+TEST(SceneIndexTest, FindNearestShapesToSegment) {
+  SceneIndex index = MakeRowOfShapes(5);
+  Segment query = {{15, -0.5}, {16, -0.5}};
+
+  std::vector<SceneIndex::ShapeDistance> nearest =
+      index.FindNearestShapes(query, 2);
+  ASSERT_THAT(GetIds(nearest), ElementsAre(1, 2));
+  // The nearest points are the corner (13, -1) of shape 1 and the corner
+  // (20, 0) of shape 2.
+  EXPECT_FLOAT_EQ(nearest[0].distance, std::hypot(2.f, 0.5f));
+  EXPECT_FLOAT_EQ(nearest[1].distance, std::hypot(4.f, 0.5f));
+}
+
+TEST(SceneIndexTest, FindNearestShapesSeesUnindexedChanges) {
+  SceneIndex index = MakeRowOfShapes(5);
+  index.Rebuild();
+  ASSERT_TRUE(index.Remove(1));
+  // Moves shape 4 to overlap the query.
+  index.Insert(4, MakeStraightLinePartitionedMesh(2),
+               AffineTransform::Translate(Vec{14, 0}));
+
+  std::vector<SceneIndex::ShapeDistance> nearest =
+      index.FindNearestShapes(Segment{{15, -0.5}, {16, -0.5}}, 3);
+  ASSERT_THAT(GetIds(nearest), ElementsAre(4, 2, 0));
+  EXPECT_FLOAT_EQ(nearest[0].distance, 0);
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,131 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/sweep_intersection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/log/absl_check.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/distance.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/internal/static_rtree.h"
+#include "ink/geometry/intersects.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+
+namespace ink {
+namespace {
+
+using ::ink::geometry_internal::StaticRTree;
+
+// Returns the indices of the `targets` for which `element_hits_target` returns
+// true for at least one element of the sweep, where `element_bounds[i]` is the
+// bounding rectangle of the i-th element of the sweep.
+std::vector<size_t> FindTargetsHitBySweepElements(
+    absl::Span<const Rect> element_bounds,
+    absl::Span<const SweepTarget> targets,
+    absl::FunctionRef<bool(uint32_t, const SweepTarget&)> element_hits_target) {
+  std::vector<size_t> hit_targets;
+  if (element_bounds.empty()) return hit_targets;
+
+  Rect sweep_bounds = *Envelope(element_bounds).AsRect();
+  uint32_t next_element = 0;
+  StaticRTree<uint32_t> rtree([&next_element]() { return next_element++; },
+                              element_bounds);
+
+  for (size_t i = 0; i < targets.size(); ++i) {
+    const SweepTarget& target = targets[i];
+    std::optional<Rect> shape_bounds = target.shape->Bounds().AsRect();
+    if (!shape_bounds.has_value()) continue;
+    Rect target_bounds =
+        *Envelope(target.shape_to_sweep.Apply(*shape_bounds)).AsRect();
+    if (!Intersects(target_bounds, sweep_bounds)) continue;
+
+    bool is_hit = false;
+    rtree.VisitIntersectedElements(
+        target_bounds, [&](uint32_t element_index) {
+          is_hit = element_hits_target(element_index, target);
+          return !is_hit;
+        });
+    if (is_hit) hit_targets.push_back(i);
+  }
+  return hit_targets;
+}
+
+}  // namespace
+
+std::vector<size_t> FindTargetsIntersectingSweep(
+    absl::Span<const Quad> sweep, absl::Span<const SweepTarget> targets) {
+  std::vector<Rect> element_bounds;
+  element_bounds.reserve(sweep.size());
+  for (const Quad& quad : sweep) {
+    element_bounds.push_back(*Envelope(quad).AsRect());
+  }
+  return FindTargetsHitBySweepElements(
+      element_bounds, targets,
+      [sweep](uint32_t element_index, const SweepTarget& target) {
+        return Intersects(sweep[element_index], *target.shape,
+                          target.shape_to_sweep);
+      });
+}
+
+std::vector<size_t> FindTargetsIntersectingSweep(
+    absl::Span<const Point> path, float radius,
+    absl::Span<const SweepTarget> targets) {
+  ABSL_CHECK(radius >= 0) << "radius must be non-negative, got " << radius;
+  if (path.empty()) return {};
+
+  // Each element of the sweep is a segment of the path; a single point is
+  // treated as a degenerate segment.
+  size_t n_segments = path.size() == 1 ? 1 : path.size() - 1;
+  auto get_segment = [path](uint32_t index) {
+    return path.size() == 1 ? Segment{path[0], path[0]}
+                            : Segment{path[index], path[index + 1]};
+  };
+  std::vector<Rect> element_bounds;
+  element_bounds.reserve(n_segments);
+  for (uint32_t i = 0; i < n_segments; ++i) {
+    Segment segment = get_segment(i);
+    Rect bounds = Rect::FromTwoPoints(segment.start, segment.end);
+    bounds.Offset(radius);
+    element_bounds.push_back(bounds);
+  }
+  return FindTargetsHitBySweepElements(
+      element_bounds, targets,
+      [&get_segment, radius](uint32_t element_index,
+                             const SweepTarget& target) {
+        Segment segment = get_segment(element_index);
+        if (radius == 0) {
+          return Intersects(segment, *target.shape, target.shape_to_sweep);
+        }
+        if (segment.start == segment.end) {
+          return Distance(segment.start, *target.shape,
+                          target.shape_to_sweep) <= radius;
+        }
+        return Distance(segment, *target.shape, target.shape_to_sweep) <=
+               radius;
+      });
+}
+
+}  // namespace ink
@@ -0,0 +1,68 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_GEOMETRY_SWEEP_INTERSECTION_H_
+#define INK_GEOMETRY_SWEEP_INTERSECTION_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+
+namespace ink {
+
+// A shape to be tested against a sweep, along with the transform that maps
+// from the shape's coordinate space to the sweep's. The shape must outlive any
+// call that it is passed to.
+struct SweepTarget {
+  const PartitionedMesh* absl_nonnull shape;
+  AffineTransform shape_to_sweep;
+};
+
+// Returns the indices of the `targets` whose shapes intersect any of the quads
+// of `sweep`, in increasing order; e.g. the strokes hit by the swept path of an
+// eraser since the last input. Each hit is as per the `Quad` overload of
+// `Intersects`.
+//
+// This answers the whole query in one pass: targets whose bounds don't overlap
+// the sweep are culled without looking at their meshes, the quads near each
+// remaining target are found with a spatial index over the sweep, and those
+// quads are tested against the target's own spatial index, stopping at the
+// first hit. This will initialize the spatial index of each shape that needs a
+// precise test if it has not already been done.
+std::vector<size_t> FindTargetsIntersectingSweep(
+    absl::Span<const Quad> sweep, absl::Span<const SweepTarget> targets);
+
+// Returns the indices of the `targets` whose shapes come within `radius` of the
+// polyline through `path`, in increasing order; i.e. the shapes hit by a circle
+// of `radius` swept along `path`, such as a round eraser. Distances are
+// measured in the sweep's coordinate space, as per the `PartitionedMesh`
+// overloads of `Distance`. A `path` with a single point is treated as a circle
+// around that point, and an empty `path` hits nothing. This works in the same
+// way as the `Quad` overload above.
+//
+// This CHECK-fails if `radius` is negative or NaN.
+std::vector<size_t> FindTargetsIntersectingSweep(
+    absl::Span<const Point> path, float radius,
+    absl::Span<const SweepTarget> targets);
+
+}  // namespace ink
+
+#endif  // INK_GEOMETRY_SWEEP_INTERSECTION_H_
@@ -0,0 +1,122 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/geometry/sweep_intersection.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+
+namespace ink {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// The shape used here is a straight line mesh of 10 triangles, which covers the
+// rect from (0, -1) to (11, 0); see `MakeStraightLinePartitionedMesh`.
+class SweepIntersectionTest : public ::testing::Test {
+ protected:
+  PartitionedMesh line_ = MakeStraightLinePartitionedMesh(10);
+  PartitionedMesh empty_;
+  std::vector<SweepTarget> targets_ = {
+      {.shape = &line_, .shape_to_sweep = {}},
+      {.shape = &line_,
+       .shape_to_sweep = AffineTransform::Translate({100, 0})},
+      {.shape = &empty_, .shape_to_sweep = {}},
+      {.shape = &line_,
+       .shape_to_sweep = AffineTransform::Translate({200, 0})},
+  };
+};
+
+TEST_F(SweepIntersectionTest, EmptySweepHitsNothing) {
+  EXPECT_THAT(FindTargetsIntersectingSweep(std::vector<Quad>(), targets_),
+              IsEmpty());
+  EXPECT_THAT(FindTargetsIntersectingSweep(std::vector<Point>(), 5, targets_),
+              IsEmpty());
+}
+
+TEST_F(SweepIntersectionTest, NoTargets) {
+  EXPECT_THAT(FindTargetsIntersectingSweep(
+                  {Quad::FromRect(Rect::FromTwoPoints({0, 0}, {10, 10}))}, {}),
+              IsEmpty());
+}
+
+TEST_F(SweepIntersectionTest, QuadSweepReturnsHitTargetsInOrder) {
+  std::vector<Quad> sweep = {
+      Quad::FromRect(Rect::FromTwoPoints({205, -3}, {206, 3})),
+      Quad::FromRect(Rect::FromTwoPoints({50, -3}, {51, 3})),
+      Quad::FromRect(Rect::FromTwoPoints({5, -3}, {6, 3})),
+  };
+  EXPECT_THAT(FindTargetsIntersectingSweep(sweep, targets_),
+              ElementsAre(0, 3));
+}
+
+TEST_F(SweepIntersectionTest, QuadSweepWhoseBoundsOverlapButMissesShape) {
+  // This quad is a thin diagonal strip whose bounds contain the start of the
+  // line mesh, but which doesn't touch any of its triangles.
+  Quad quad = Quad::FromCenterDimensionsRotationAndSkew(
+      {-1, 1}, 4, 0.1, Angle::Degrees(45), 0);
+  EXPECT_THAT(FindTargetsIntersectingSweep({quad}, targets_), IsEmpty());
+}
+
+TEST_F(SweepIntersectionTest, PathSweepUsesRadius) {
+  // This path runs parallel to the top of the first and second shapes, at a
+  // distance of 0.5.
+  std::vector<Point> path = {{2, 0.5}, {50, 0.5}, {105, 0.5}};
+  EXPECT_THAT(FindTargetsIntersectingSweep(path, 0.4, targets_), IsEmpty());
+  EXPECT_THAT(FindTargetsIntersectingSweep(path, 0.6, targets_),
+              ElementsAre(0, 1));
+}
+
+TEST_F(SweepIntersectionTest, PathSweepWithZeroRadius) {
+  std::vector<Point> path = {{105, 5}, {105, -5}};
+  EXPECT_THAT(FindTargetsIntersectingSweep(path, 0, targets_), ElementsAre(1));
+}
+
+TEST_F(SweepIntersectionTest, PathSweepWithSinglePoint) {
+  std::vector<Point> path = {{205, 1}};
+  EXPECT_THAT(FindTargetsIntersectingSweep(path, 0.9, targets_), IsEmpty());
+  EXPECT_THAT(FindTargetsIntersectingSweep(path, 1.1, targets_),
+              ElementsAre(3));
+}
+
+TEST_F(SweepIntersectionTest, AppliesTargetTransforms) {
+  std::vector<SweepTarget> targets = {
+      {.shape = &line_, .shape_to_sweep = AffineTransform::Scale(10)},
+  };
+  // The scaled shape covers the rect from (0, -10) to (110, 0).
+  std::vector<Point> path = {{50, -5}};
+  EXPECT_THAT(FindTargetsIntersectingSweep(path, 0.1, targets),
+              ElementsAre(0));
+  EXPECT_THAT(FindTargetsIntersectingSweep(path, 0.1, targets_), IsEmpty());
+}
+
+TEST_F(SweepIntersectionTest, NegativeRadiusDies) {
+  std::vector<Point> path = {{0, 0}};
+  EXPECT_DEATH_IF_SUPPORTED(FindTargetsIntersectingSweep(path, -1, targets_),
+                            "radius");
+}
+
+}  // namespace
+}  // namespace ink
@@ -14,6 +14,9 @@
 
 #include "ink/geometry/tessellator.h"
 
+#include <cmath>
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -22,26 +25,33 @@
 #include "absl/types/span.h"
 #include "ink/geometry/internal/generic_tessellator.h"
 #include "ink/geometry/internal/point_tessellation_helper.h"  // IWYU pragma: keep
+#include "ink/geometry/internal/polygon_triangulation.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/point.h"
 
 namespace ink {
+namespace {
 
-absl::StatusOr<Mesh> CreateMeshFromPolyline(absl::Span<const Point> points) {
-  if (points.size() < 3) {
-    return absl::InvalidArgumentError(
-        absl::StrCat("Can not tessellate polyline with size: ", points.size(),
-                     ". The polyline must have at least three points."));
-  }
-  geometry_internal::TessellationResult<Point> result =
-      geometry_internal::Tessellate<geometry_internal::PointTessellationHelper>(
-          points);
-  if (result.indices.empty()) {
-    return absl::InternalError("Could not tessellate polyline.");
+// The largest coordinate magnitude accepted by libtess2; larger inputs are
+// rejected to avoid overflow.
+constexpr float kMaxTessellatorCoordinate = 1 << 23;
+
+// Returns true if every coordinate of `points` is within the range accepted by
+// libtess2. Inputs outside of it are not given to the fast path either, so that
+// they fail the same way regardless of whether the polyline is simple.
+bool IsWithinTessellatorRange(absl::Span<const Point> points) {
+  for (Point p : points) {
+    if (!(std::abs(p.x) <= kMaxTessellatorCoordinate) ||
+        !(std::abs(p.y) <= kMaxTessellatorCoordinate)) {
+      return false;
+    }
   }
+  return true;
+}
 
-  const auto& vertices = result.vertices;
+absl::StatusOr<Mesh> CreateMesh(absl::Span<const Point> vertices,
+                                absl::Span<const uint32_t> indices) {
   std::vector<float> vertex_position_x;
   std::vector<float> vertex_position_y;
   vertex_position_x.reserve(vertices.size());
@@ -53,7 +63,35 @@ absl::StatusOr<Mesh> CreateMeshFromPolyline(absl::Span<const Point> points) {
   }
 
   return Mesh::Create(MeshFormat(), {vertex_position_x, vertex_position_y},
-                      result.indices);
+                      indices);
+}
+
+}  // namespace
+
+absl::StatusOr<Mesh> CreateMeshFromPolyline(absl::Span<const Point> points) {
+  if (points.size() < 3) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Can not tessellate polyline with size: ", points.size(),
+                     ". The polyline must have at least three points."));
+  }
+
+  // Most polylines we tessellate (e.g. lassos and shapes) are simple polygons,
+  // which can be triangulated much more cheaply than by libtess2.
+  if (IsWithinTessellatorRange(points)) {
+    if (std::optional<std::vector<uint32_t>> indices =
+            geometry_internal::TriangulateSimplePolygon(points);
+        indices.has_value()) {
+      return CreateMesh(points, *indices);
+    }
+  }
+
+  geometry_internal::TessellationResult<Point> result =
+      geometry_internal::Tessellate<geometry_internal::PointTessellationHelper>(
+          points);
+  if (result.indices.empty()) {
+    return absl::InternalError("Could not tessellate polyline.");
+  }
+  return CreateMesh(result.vertices, result.indices);
 }
 
 }  // namespace ink
@@ -31,6 +31,11 @@ namespace ink {
 // `points`. For example, the method might add extra vertices in the mesh for
 // the intersecting points in self-intersecting polyline.
 //
+// Simple polygons (those that don't touch or intersect themselves) are
+// triangulated by a fast ear-clipping path that uses exactly the vertices of
+// `points`, with every triangle wound the same way as the polyline. Other
+// polylines go through the general tessellator.
+//
 // This method throws an error when `points` has less than three elements, or
 // when all elements of `points` are collinear.
 absl::StatusOr<Mesh> CreateMeshFromPolyline(absl::Span<const Point> points);
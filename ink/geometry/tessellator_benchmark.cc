@@ -0,0 +1,92 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cmath>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ink/geometry/internal/generic_tessellator.h"
+#include "ink/geometry/internal/point_tessellation_helper.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/tessellator.h"
+#include "ink/types/numbers.h"
+
+namespace ink {
+namespace {
+
+// Returns a simple, non-convex polygon with `n_points` vertices, shaped like a
+// wavy circle, similar to a hand-drawn lasso.
+std::vector<Point> MakeWavyCircle(int n_points) {
+  std::vector<Point> points;
+  points.reserve(n_points);
+  for (int i = 0; i < n_points; ++i) {
+    float theta = 2 * numbers::kPi * i / n_points;
+    float radius = 100 + 30 * std::sin(17 * theta);
+    points.push_back({radius * std::cos(theta), radius * std::sin(theta)});
+  }
+  return points;
+}
+
+// Returns a convex polygon with `n_points` vertices.
+std::vector<Point> MakeCircle(int n_points) {
+  std::vector<Point> points;
+  points.reserve(n_points);
+  for (int i = 0; i < n_points; ++i) {
+    float theta = 2 * numbers::kPi * i / n_points;
+    points.push_back({100 * std::cos(theta), 100 * std::sin(theta)});
+  }
+  return points;
+}
+
+// Uses the ear-clipping fast path for simple polygons.
+void BM_CreateMeshFromPolylineWavyCircle(benchmark::State& state) {
+  std::vector<Point> points = MakeWavyCircle(state.range(0));
+  for (auto s : state) {
+    benchmark::DoNotOptimize(CreateMeshFromPolyline(points));
+  }
+}
+BENCHMARK(BM_CreateMeshFromPolylineWavyCircle)->Range(8, 4096);
+
+// Tessellates the same polygon with libtess2, for comparison.
+void BM_Libtess2WavyCircle(benchmark::State& state) {
+  std::vector<Point> points = MakeWavyCircle(state.range(0));
+  for (auto s : state) {
+    benchmark::DoNotOptimize(
+        geometry_internal::Tessellate<
+            geometry_internal::PointTessellationHelper>(points));
+  }
+}
+BENCHMARK(BM_Libtess2WavyCircle)->Range(8, 4096);
+
+void BM_CreateMeshFromPolylineCircle(benchmark::State& state) {
+  std::vector<Point> points = MakeCircle(state.range(0));
+  for (auto s : state) {
+    benchmark::DoNotOptimize(CreateMeshFromPolyline(points));
+  }
+}
+BENCHMARK(BM_CreateMeshFromPolylineCircle)->Range(8, 4096);
+
+void BM_Libtess2Circle(benchmark::State& state) {
+  std::vector<Point> points = MakeCircle(state.range(0));
+  for (auto s : state) {
+    benchmark::DoNotOptimize(
+        geometry_internal::Tessellate<
+            geometry_internal::PointTessellationHelper>(points));
+  }
+}
+BENCHMARK(BM_Libtess2Circle)->Range(8, 4096);
+
+}  // namespace
+}  // namespace ink
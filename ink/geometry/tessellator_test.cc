@@ -14,6 +14,10 @@
 
 #include "ink/geometry/tessellator.h"
 
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
@@ -22,7 +26,9 @@
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/point.h"
+#include "ink/geometry/triangle.h"
 #include "ink/geometry/type_matchers.h"
+#include "ink/types/numbers.h"
 
 namespace ink {
 
@@ -98,9 +104,9 @@ TEST(TessellatorTest, ReturnsMeshForSingleTriangle) {
   EXPECT_EQ(mesh->VertexPosition(1), (Point{10, 0}));
   EXPECT_EQ(mesh->VertexPosition(2), (Point{0, 10}));
 
-  EXPECT_THAT(mesh->TriangleIndices(0), ElementsAre(1, 2, 0));
+  EXPECT_THAT(mesh->TriangleIndices(0), ElementsAre(2, 0, 1));
 
-  EXPECT_THAT(mesh->GetTriangle(0), TriangleEq({{10, 0}, {0, 10}, {0, 0}}));
+  EXPECT_THAT(mesh->GetTriangle(0), TriangleEq({{0, 10}, {0, 0}, {10, 0}}));
 }
 
 TEST(TessellatorTest, ReturnsMeshForConcaveLoop) {
@@ -124,13 +130,69 @@ TEST(TessellatorTest, ReturnsMeshForConcaveLoop) {
   EXPECT_EQ(mesh->VertexPosition(2), (Point{2, 2}));
   EXPECT_EQ(mesh->VertexPosition(3), (Point{0, 10}));
 
-  EXPECT_THAT(mesh->TriangleIndices(0), ElementsAre(2, 0, 1));
+  EXPECT_THAT(mesh->TriangleIndices(0), ElementsAre(0, 1, 2));
   EXPECT_THAT(mesh->TriangleIndices(1), ElementsAre(0, 2, 3));
 
-  EXPECT_THAT(mesh->GetTriangle(0), TriangleEq({{2, 2}, {0, 0}, {10, 0}}));
+  EXPECT_THAT(mesh->GetTriangle(0), TriangleEq({{0, 0}, {10, 0}, {2, 2}}));
   EXPECT_THAT(mesh->GetTriangle(1), TriangleEq({{0, 0}, {2, 2}, {0, 10}}));
 }
 
+TEST(TessellatorTest, KeepsWindingOfClockwiseLoop) {
+  absl::StatusOr<Mesh> mesh = CreateMeshFromPolyline(
+      {Point{0, 0}, Point{0, 10}, Point{10, 10}, Point{10, 0}});
+  ASSERT_THAT(mesh, IsOk());
+
+  EXPECT_THAT(mesh->VertexCount(), Eq(4));
+  ASSERT_THAT(mesh->TriangleCount(), Eq(2));
+  EXPECT_LT(mesh->GetTriangle(0).SignedArea(), 0);
+  EXPECT_LT(mesh->GetTriangle(1).SignedArea(), 0);
+  EXPECT_FLOAT_EQ(
+      mesh->GetTriangle(0).SignedArea() + mesh->GetTriangle(1).SignedArea(),
+      -100);
+}
+
+TEST(TessellatorTest, SkipsStraightVerticesOfSimpleLoop) {
+  // The loop goes straight on through (5, 0), so a triangle using it would be
+  // degenerate.
+  absl::StatusOr<Mesh> mesh = CreateMeshFromPolyline(
+      {Point{5, 0}, Point{10, 0}, Point{10, 10}, Point{0, 10}, Point{0, 0}});
+  ASSERT_THAT(mesh, IsOk());
+
+  EXPECT_THAT(mesh->VertexCount(), Eq(5));
+  ASSERT_THAT(mesh->TriangleCount(), Eq(2));
+  float total_area = 0;
+  for (uint32_t t = 0; t < mesh->TriangleCount(); ++t) {
+    EXPECT_GT(mesh->GetTriangle(t).SignedArea(), 0);
+    total_area += mesh->GetTriangle(t).SignedArea();
+  }
+  EXPECT_FLOAT_EQ(total_area, 100);
+}
+
+TEST(TessellatorTest, ReturnsMeshForLargeSimpleLoop) {
+  // A wavy circle, which is simple but far from convex.
+  constexpr int kNumPoints = 1000;
+  std::vector<Point> points;
+  for (int i = 0; i < kNumPoints; ++i) {
+    float theta = 2 * numbers::kPi * i / kNumPoints;
+    float radius = 1 + 0.3f * std::sin(17 * theta);
+    points.push_back({radius * std::cos(theta), radius * std::sin(theta)});
+  }
+
+  absl::StatusOr<Mesh> mesh = CreateMeshFromPolyline(points);
+  ASSERT_THAT(mesh, IsOk());
+
+  // No vertices are added, and a simple polygon with n vertices has n - 2
+  // triangles.
+  ASSERT_THAT(mesh->VertexCount(), Eq(kNumPoints));
+  EXPECT_THAT(mesh->TriangleCount(), Eq(kNumPoints - 2));
+  for (int i = 0; i < kNumPoints; ++i) {
+    EXPECT_EQ(mesh->VertexPosition(i), points[i]);
+  }
+  for (uint32_t t = 0; t < mesh->TriangleCount(); ++t) {
+    EXPECT_GT(mesh->GetTriangle(t).SignedArea(), 0);
+  }
+}
+
 // Verifies that the tessellation succeeds and CreateMeshForPolyline() preserves
 // the duplicate vertices for polyline:
 //   \  |\
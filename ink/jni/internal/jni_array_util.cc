@@ -0,0 +1,82 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/jni/internal/jni_array_util.h"
+
+#include <jni.h>
+
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+
+namespace ink::jni {
+namespace {
+
+absl::Status TooSmallError(jlong capacity, jint size) {
+  return absl::InvalidArgumentError(
+      absl::StrCat("Destination holds ", capacity, " values, but ", size,
+                   " are needed."));
+}
+
+template <typename T>
+absl::Status WriteToArray(JNIEnv* env, jarray array, jint size,
+                          absl::FunctionRef<void(absl::Span<T>)> write) {
+  ABSL_CHECK(array != nullptr);
+  ABSL_CHECK_GE(size, 0);
+  jsize length = env->GetArrayLength(array);
+  if (length < size) return TooSmallError(length, size);
+  void* elements = env->GetPrimitiveArrayCritical(array, nullptr);
+  ABSL_CHECK(elements != nullptr);
+  write(absl::MakeSpan(static_cast<T*>(elements), size));
+  env->ReleasePrimitiveArrayCritical(array, elements, 0);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status WriteToFloatBufferOrArray(
+    JNIEnv* env, jobject direct_float_buffer, jfloatArray float_array,
+    jint size, absl::FunctionRef<void(absl::Span<jfloat>)> write) {
+  if (direct_float_buffer == nullptr) {
+    return WriteToArray<jfloat>(env, float_array, size, write);
+  }
+  ABSL_CHECK_GE(size, 0);
+  // For a FloatBuffer, the capacity is in floats, not bytes.
+  jlong capacity = env->GetDirectBufferCapacity(direct_float_buffer);
+  if (capacity < size) return TooSmallError(capacity, size);
+  void* addr = env->GetDirectBufferAddress(direct_float_buffer);
+  ABSL_CHECK(addr != nullptr);
+  write(absl::MakeSpan(static_cast<jfloat*>(addr), size));
+  return absl::OkStatus();
+}
+
+absl::Status WriteToIntArray(JNIEnv* env, jintArray int_array, jint size,
+                             absl::FunctionRef<void(absl::Span<jint>)> write) {
+  return WriteToArray<jint>(env, int_array, size, write);
+}
+
+void ForEachNativePointer(JNIEnv* env, jlongArray native_pointers,
+                          absl::FunctionRef<void(jlong)> fn) {
+  ABSL_CHECK(native_pointers != nullptr);
+  std::vector<jlong> pointers(env->GetArrayLength(native_pointers));
+  env->GetLongArrayRegion(native_pointers, 0, pointers.size(),
+                          pointers.data());
+  for (jlong pointer : pointers) fn(pointer);
+}
+
+}  // namespace ink::jni
@@ -0,0 +1,50 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_JNI_INTERNAL_JNI_ARRAY_UTIL_H_
+#define INK_JNI_INTERNAL_JNI_ARRAY_UTIL_H_
+
+#include <jni.h>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+
+namespace ink::jni {
+
+// Gives `write` direct access to the first `size` floats of either a direct
+// java.nio.FloatBuffer or a jfloatArray, one of which must be non-null, so that
+// bulk data can be returned to the JVM in a single JNI call. Returns an error
+// without calling `write` if the destination holds fewer than `size` floats.
+//
+// A jfloatArray is accessed as a critical region, to avoid copying it, so
+// `write` must not make any JNI calls.
+absl::Status WriteToFloatBufferOrArray(
+    JNIEnv* env, jobject direct_float_buffer, jfloatArray float_array,
+    jint size, absl::FunctionRef<void(absl::Span<jfloat>)> write);
+
+// Same as `WriteToFloatBufferOrArray()`, for a non-null jintArray.
+absl::Status WriteToIntArray(JNIEnv* env, jintArray int_array, jint size,
+                             absl::FunctionRef<void(absl::Span<jint>)> write);
+
+// Calls `fn` with each of the native pointers in `native_pointers`, after
+// copying them out of the array, so `fn` may make JNI calls. This is for
+// entry points that free a whole batch of Kotlin objects' native state in one
+// call.
+void ForEachNativePointer(JNIEnv* env, jlongArray native_pointers,
+                          absl::FunctionRef<void(jlong)> fn);
+
+}  // namespace ink::jni
+
+#endif  // INK_JNI_INTERNAL_JNI_ARRAY_UTIL_H_
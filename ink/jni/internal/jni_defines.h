@@ -25,4 +25,12 @@
 #define JNI_METHOD_INNER(module, clazz, inner_clazz, return_type, method_name) \
   JNI_METHOD(module, clazz##_00024##inner_clazz, return_type, method_name)
 
+// A `JNINativeMethod` for registering a method defined with `JNI_METHOD` with
+// `RegisterNatives`. The casts are for JDK headers that declare the name and
+// signature as non-const.
+#define JNI_NATIVE_METHOD(module, clazz, method_name, signature) \
+  {const_cast<char*>(#method_name), const_cast<char*>(signature), \
+   reinterpret_cast<void*>(                                       \
+       &Java_androidx_ink_##module##_##clazz##_##method_name)}
+
 #endif  // INK_JNI_INTERNAL_JNI_DEFINES_H_
@@ -23,6 +23,20 @@ namespace ink::jni {
 
 namespace {
 
+constexpr char kImmutableVecClassName[] = INK_PACKAGE "/geometry/ImmutableVec";
+constexpr char kMutableVecClassName[] = INK_PACKAGE "/geometry/MutableVec";
+constexpr char kImmutableBoxClassName[] = INK_PACKAGE "/geometry/ImmutableBox";
+constexpr char kMutableBoxClassName[] = INK_PACKAGE "/geometry/MutableBox";
+constexpr char kBoxAccumulatorClassName[] =
+    INK_PACKAGE "/geometry/BoxAccumulator";
+constexpr char kImmutableParallelogramClassName[] =
+    INK_PACKAGE "/geometry/ImmutableParallelogram";
+constexpr char kMutableParallelogramClassName[] =
+    INK_PACKAGE "/geometry/MutableParallelogram";
+constexpr char kBrushNativeClassName[] = INK_PACKAGE "/brush/BrushNative";
+constexpr char kInputToolTypeClassName[] = INK_PACKAGE "/brush/InputToolType";
+constexpr char kStrokeInputClassName[] = INK_PACKAGE "/strokes/StrokeInput";
+
 static jclass class_illegal_state_exception = nullptr;
 static jclass class_illegal_argument_exception = nullptr;
 static jclass class_no_such_element_exception = nullptr;
@@ -88,6 +102,22 @@ jclass FindAndCacheClass(JNIEnv* env, const char* class_name) {
   return static_cast<jclass>(env->NewGlobalRef(cached_class));
 }
 
+// Like `FindAndCacheClass()`, but only if `cached_class` isn't set yet, and
+// without failing if the class doesn't exist. Returns whether the class is
+// cached.
+bool TryFindAndCacheClass(JNIEnv* env, const char* class_name,
+                          jclass& cached_class) {
+  if (cached_class != nullptr) return true;
+  jclass found_class = env->FindClass(class_name);
+  if (found_class == nullptr) {
+    env->ExceptionClear();
+    return false;
+  }
+  cached_class = static_cast<jclass>(env->NewGlobalRef(found_class));
+  env->DeleteLocalRef(found_class);
+  return true;
+}
+
 void DeleteCachedClass(JNIEnv* env, jclass& cached_class) {
   if (cached_class != nullptr) {
     env->DeleteGlobalRef(cached_class);
@@ -97,11 +127,57 @@ void DeleteCachedClass(JNIEnv* env, jclass& cached_class) {
 
 }  // namespace
 
+void LoadJvmInterface(JNIEnv* env) {
+  ClassIllegalStateException(env);
+  ClassIllegalArgumentException(env);
+  ClassNoSuchElementException(env);
+  ClassIndexOutOfBoundsException(env);
+  ClassUnsupportedOperationException(env);
+  ClassRuntimeException(env);
+
+  // This library is monolithic, but the library that consumes it is more
+  // modular, so some of these classes may not be defined. Those are skipped
+  // here, and still looked up lazily.
+  if (TryFindAndCacheClass(env, kImmutableVecClassName, class_immutable_vec)) {
+    MethodImmutableVecInitXY(env);
+  }
+  if (TryFindAndCacheClass(env, kMutableVecClassName, class_mutable_vec)) {
+    MethodMutableVecSetX(env);
+    MethodMutableVecSetY(env);
+  }
+  if (TryFindAndCacheClass(env, kImmutableBoxClassName, class_immutable_box)) {
+    MethodImmutableBoxFromTwoPoints(env);
+  }
+  if (TryFindAndCacheClass(env, kMutableBoxClassName, class_mutable_box)) {
+    MethodMutableBoxSetXBounds(env);
+    MethodMutableBoxSetYBounds(env);
+  }
+  if (TryFindAndCacheClass(env, kBoxAccumulatorClassName,
+                           class_box_accumulator)) {
+    MethodBoxAccumulatorReset(env);
+    MethodBoxAccumulatorPopulateFrom(env);
+  }
+  if (TryFindAndCacheClass(env, kImmutableParallelogramClassName,
+                           class_immutable_parallelogram)) {
+    MethodImmutableParallelogramFromCenterDimensionsRotationAndSkew(env);
+  }
+  if (TryFindAndCacheClass(env, kMutableParallelogramClassName,
+                           class_mutable_parallelogram)) {
+    MethodMutableParallelogramSetCenterDimensionsRotationAndSkew(env);
+  }
+  if (TryFindAndCacheClass(env, kBrushNativeClassName, class_brush_native)) {
+    MethodBrushNativeComposeColorLongFromComponents(env);
+  }
+  if (TryFindAndCacheClass(env, kInputToolTypeClassName,
+                           class_input_tool_type)) {
+    MethodInputToolTypeFromInt(env);
+  }
+  if (TryFindAndCacheClass(env, kStrokeInputClassName, class_stroke_input)) {
+    MethodStrokeInputUpdate(env);
+  }
+}
+
 void UnloadJvmInterface(JNIEnv* env) {
-  // There's not a corresponding LoadJvmInterface because loading is done
-  // lazily. This library is monolithic, but the library that consumes it is
-  // more modular. This avoids needing to attempt to load classes that are not
-  // actually defined.
 
   DeleteCachedClass(env, class_illegal_state_exception);
   DeleteCachedClass(env, class_illegal_argument_exception);
@@ -194,8 +270,7 @@ jclass ClassRuntimeException(JNIEnv* env) {
 
 jclass ClassImmutableVec(JNIEnv* env) {
   if (class_immutable_vec == nullptr) {
-    class_immutable_vec =
-        FindAndCacheClass(env, INK_PACKAGE "/geometry/ImmutableVec");
+    class_immutable_vec = FindAndCacheClass(env, kImmutableVecClassName);
   }
   return class_immutable_vec;
 }
@@ -210,8 +285,7 @@ jmethodID MethodImmutableVecInitXY(JNIEnv* env) {
 
 jclass ClassMutableVec(JNIEnv* env) {
   if (class_mutable_vec == nullptr) {
-    class_mutable_vec =
-        FindAndCacheClass(env, INK_PACKAGE "/geometry/MutableVec");
+    class_mutable_vec = FindAndCacheClass(env, kMutableVecClassName);
   }
   return class_mutable_vec;
 }
@@ -234,8 +308,7 @@ jmethodID MethodMutableVecSetY(JNIEnv* env) {
 
 jclass ClassImmutableBox(JNIEnv* env) {
   if (class_immutable_box == nullptr) {
-    class_immutable_box =
-        FindAndCacheClass(env, INK_PACKAGE "/geometry/ImmutableBox");
+    class_immutable_box = FindAndCacheClass(env, kImmutableBoxClassName);
   }
   return class_immutable_box;
 }
@@ -252,8 +325,7 @@ jmethodID MethodImmutableBoxFromTwoPoints(JNIEnv* env) {
 
 jclass ClassMutableBox(JNIEnv* env) {
   if (class_mutable_box == nullptr) {
-    class_mutable_box =
-        FindAndCacheClass(env, INK_PACKAGE "/geometry/MutableBox");
+    class_mutable_box = FindAndCacheClass(env, kMutableBoxClassName);
   }
   return class_mutable_box;
 }
@@ -278,8 +350,7 @@ jmethodID MethodMutableBoxSetYBounds(JNIEnv* env) {
 
 jclass ClassBoxAccumulator(JNIEnv* env) {
   if (class_box_accumulator == nullptr) {
-    class_box_accumulator =
-        FindAndCacheClass(env, INK_PACKAGE "/geometry/BoxAccumulator");
+    class_box_accumulator = FindAndCacheClass(env, kBoxAccumulatorClassName);
   }
   return class_box_accumulator;
 }
@@ -305,7 +376,7 @@ jmethodID MethodBoxAccumulatorPopulateFrom(JNIEnv* env) {
 jclass ClassImmutableParallelogram(JNIEnv* env) {
   if (class_immutable_parallelogram == nullptr) {
     class_immutable_parallelogram =
-        FindAndCacheClass(env, INK_PACKAGE "/geometry/ImmutableParallelogram");
+        FindAndCacheClass(env, kImmutableParallelogramClassName);
   }
   return class_immutable_parallelogram;
 }
@@ -325,7 +396,7 @@ jmethodID MethodImmutableParallelogramFromCenterDimensionsRotationAndSkew(
 jclass ClassMutableParallelogram(JNIEnv* env) {
   if (class_mutable_parallelogram == nullptr) {
     class_mutable_parallelogram =
-        FindAndCacheClass(env, INK_PACKAGE "/geometry/MutableParallelogram");
+        FindAndCacheClass(env, kMutableParallelogramClassName);
   }
   return class_mutable_parallelogram;
 }
@@ -343,8 +414,7 @@ jmethodID MethodMutableParallelogramSetCenterDimensionsRotationAndSkew(
 
 jclass ClassBrushNative(JNIEnv* env) {
   if (class_brush_native == nullptr) {
-    class_brush_native =
-        FindAndCacheClass(env, INK_PACKAGE "/brush/BrushNative");
+    class_brush_native = FindAndCacheClass(env, kBrushNativeClassName);
   }
   return class_brush_native;
 }
@@ -360,8 +430,7 @@ jmethodID MethodBrushNativeComposeColorLongFromComponents(JNIEnv* env) {
 
 jclass ClassInputToolType(JNIEnv* env) {
   if (class_input_tool_type == nullptr) {
-    class_input_tool_type =
-        FindAndCacheClass(env, INK_PACKAGE "/brush/InputToolType");
+    class_input_tool_type = FindAndCacheClass(env, kInputToolTypeClassName);
   }
   return class_input_tool_type;
 }
@@ -377,8 +446,7 @@ jmethodID MethodInputToolTypeFromInt(JNIEnv* env) {
 
 jclass ClassStrokeInput(JNIEnv* env) {
   if (class_stroke_input == nullptr) {
-    class_stroke_input =
-        FindAndCacheClass(env, INK_PACKAGE "/strokes/StrokeInput");
+    class_stroke_input = FindAndCacheClass(env, kStrokeInputClassName);
   }
   return class_stroke_input;
 }
@@ -20,9 +20,10 @@
 // This file contains logic to handle caching of JVM classes and methods called
 // back to from Ink's JNI code.
 //
-// The classes and methods are cached lazily the first time they are needed.
-// Classes can be looked up with Class[JavaClassName](env). Methods can be
-// looked up with Method[JVMClassName][JVMMethodName](env).
+// The classes and methods are cached eagerly by JNI_OnLoad, if they exist, and
+// otherwise lazily the first time they are needed. Classes can be looked up
+// with Class[JavaClassName](env). Methods can be looked up with
+// Method[JVMClassName][JVMMethodName](env).
 //
 // Caching classes or the corresponding methods requires holding a global
 // reference to the cached classes. JNI_OnUnload should call UnloadJvmInterface
@@ -30,9 +31,13 @@
 
 namespace ink::jni {
 
-// There's no corresponding OnLoad because loading of this interface is
-// done lazily. It's still good practice to have a JNI_OnUnload that cleans up
-// global references to the cached classes.
+// Caches all of the classes and methods that exist, so that the first calls
+// that need them don't pay for the lookup, and so that they are looked up with
+// the class loader that loaded the library. Classes that don't exist are left
+// to be looked up lazily. This is called from JNI_OnLoad.
+void LoadJvmInterface(JNIEnv* env);
+
+// Deletes the global references to the cached classes.
 void UnloadJvmInterface(JNIEnv* env);
 
 jclass ClassIllegalStateException(JNIEnv* env);
@@ -0,0 +1,64 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/jni/internal/jni_native_registration.h"
+
+#include <jni.h>
+
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace ink::jni {
+namespace {
+
+// Function-local, so that it is constructed before the static initializers
+// that add to it.
+std::vector<NativeRegistrationFunction>& NativeRegistrations() {
+  static std::vector<NativeRegistrationFunction>* const kRegistrations =
+      new std::vector<NativeRegistrationFunction>();
+  return *kRegistrations;
+}
+
+}  // namespace
+
+bool AddNativeRegistration(NativeRegistrationFunction function) {
+  NativeRegistrations().push_back(function);
+  return true;
+}
+
+void RunNativeRegistrations(JNIEnv* env) {
+  for (NativeRegistrationFunction function : NativeRegistrations()) {
+    function(env);
+  }
+}
+
+bool TryRegisterNatives(JNIEnv* env, const char* class_name,
+                        absl::Span<const JNINativeMethod> methods) {
+  jclass native_class = env->FindClass(class_name);
+  if (native_class == nullptr) {
+    env->ExceptionClear();
+    return false;
+  }
+  jint result = env->RegisterNatives(native_class, methods.data(),
+                                     static_cast<jint>(methods.size()));
+  env->DeleteLocalRef(native_class);
+  if (result != JNI_OK) {
+    env->ExceptionClear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace ink::jni
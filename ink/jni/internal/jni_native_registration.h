@@ -0,0 +1,67 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_JNI_INTERNAL_JNI_NATIVE_REGISTRATION_H_
+#define INK_JNI_INTERNAL_JNI_NATIVE_REGISTRATION_H_
+
+#include <jni.h>
+
+#include "absl/types/span.h"
+
+// This file contains logic to register native methods with `RegisterNatives`
+// when the library is loaded, instead of having the JVM look each one up by its
+// exported `JNI_METHOD` symbol name the first time it is called.
+//
+// Each module that wants its methods registered eagerly defines a registration
+// function, and adds it with `AddNativeRegistration` from a static initializer
+// in a library with `alwayslink = 1`:
+//
+//   namespace {
+//   void RegisterFooNatives(JNIEnv* env) {
+//     static const JNINativeMethod kMethods[] = {
+//         JNI_NATIVE_METHOD(foo, FooNative, getCount, "(J)I"),
+//     };
+//     ink::jni::TryRegisterNatives(env, INK_PACKAGE "/foo/FooNative",
+//                                  kMethods);
+//   }
+//   [[maybe_unused]] const bool kFooNativesAdded =
+//       ink::jni::AddNativeRegistration(&RegisterFooNatives);
+//   }  // namespace
+//
+// Registration is only an optimization: the `JNI_METHOD` symbols are still
+// exported, so any method that isn't registered, because its class or
+// signature doesn't match, is still found by name.
+
+namespace ink::jni {
+
+using NativeRegistrationFunction = void (*)(JNIEnv* env);
+
+// Adds `function` to the functions called by `RunNativeRegistrations()`.
+// Returns true, so that it can be used to initialize a static variable.
+bool AddNativeRegistration(NativeRegistrationFunction function);
+
+// Calls every function added with `AddNativeRegistration()`. This is called
+// from `JNI_OnLoad`.
+void RunNativeRegistrations(JNIEnv* env);
+
+// Registers `methods` as native methods of the class named `class_name`.
+// Returns false, and clears the pending exception, if the class or any of the
+// methods can't be found. The library consuming this one may not include every
+// class, and methods that aren't registered are still found by name.
+bool TryRegisterNatives(JNIEnv* env, const char* class_name,
+                        absl::Span<const JNINativeMethod> methods);
+
+}  // namespace ink::jni
+
+#endif  // INK_JNI_INTERNAL_JNI_NATIVE_REGISTRATION_H_
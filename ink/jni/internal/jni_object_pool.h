@@ -0,0 +1,118 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_JNI_INTERNAL_JNI_OBJECT_POOL_H_
+#define INK_JNI_INTERNAL_JNI_OBJECT_POOL_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "ink/types/memory_trim.h"
+
+namespace ink::jni {
+
+// A free list of storage for native objects of type `T` that back Kotlin
+// wrapper objects.
+//
+// Erasing and splitting strokes creates and frees many short-lived wrappers,
+// often with the frees happening in bulk on a cleaner thread. Rather than
+// returning each object's storage to the allocator, the pool keeps up to
+// `kMaxFreeCount` blocks around for reuse by the next `New()`. Only the
+// storage of the `T` itself is reused; any memory that it owns is released
+// when it is destroyed, as usual.
+//
+// The storage kept by the process-wide pools from `GetNativeObjectPool()` is
+// released by `TrimMemory()` with `MemoryTrimLevel::kPooledMemory` or higher.
+//
+// This is thread-safe.
+template <typename T>
+class NativeObjectPool {
+ public:
+  static constexpr size_t kMaxFreeCount = 1024;
+
+  static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+  NativeObjectPool() = default;
+  NativeObjectPool(const NativeObjectPool&) = delete;
+  NativeObjectPool& operator=(const NativeObjectPool&) = delete;
+
+  // Constructs a `T` from `args` in pooled storage, if there is any, and
+  // returns a pointer to it that must be freed with `Delete()`.
+  template <typename... Args>
+  T* New(Args&&... args) {
+    void* storage = nullptr;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!free_storage_.empty()) {
+        storage = free_storage_.back();
+        free_storage_.pop_back();
+      }
+    }
+    if (storage == nullptr) storage = ::operator new(sizeof(T));
+    return new (storage) T(std::forward<Args>(args)...);
+  }
+
+  // Destroys `object`, which must have been returned by `New()`, and keeps its
+  // storage for reuse unless the pool is already full. Does nothing if
+  // `object` is null.
+  void Delete(T* object) {
+    if (object == nullptr) return;
+    object->~T();
+    {
+      absl::MutexLock lock(&mutex_);
+      if (free_storage_.size() < kMaxFreeCount) {
+        free_storage_.push_back(object);
+        return;
+      }
+    }
+    ::operator delete(object);
+  }
+
+  // Releases all of the storage kept for reuse, and returns its size in bytes.
+  size_t ReleaseFreeStorage() {
+    std::vector<void*> free_storage;
+    {
+      absl::MutexLock lock(&mutex_);
+      free_storage.swap(free_storage_);
+    }
+    for (void* storage : free_storage) ::operator delete(storage);
+    return free_storage.size() * sizeof(T) +
+           free_storage.capacity() * sizeof(void*);
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<void*> free_storage_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns the process-wide pool for native objects of type `T`.
+template <typename T>
+NativeObjectPool<T>& GetNativeObjectPool() {
+  static NativeObjectPool<T>* const kPool = new NativeObjectPool<T>();
+  // Intentionally leaked, like the pool, so that it stays registered until
+  // exit.
+  [[maybe_unused]] static MemoryTrimRegistration* const kTrimRegistration =
+      new MemoryTrimRegistration(RegisterMemoryTrimCallback(
+          MemoryTrimLevel::kPooledMemory,
+          [] { return kPool->ReleaseFreeStorage(); }));
+  return *kPool;
+}
+
+}  // namespace ink::jni
+
+#endif  // INK_JNI_INTERNAL_JNI_OBJECT_POOL_H_
@@ -17,6 +17,8 @@
 #include <jni.h>
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
@@ -35,13 +37,14 @@ absl::Status ParseProtoFromByteArray(JNIEnv* env, jbyteArray serialized_proto,
 absl::Status ParseProtoFromByteArray(JNIEnv* env, jbyteArray serialized_proto,
                                      jint offset, jint size,
                                      google::protobuf::MessageLite& dest) {
-  // TODO(b/290213178): See how often this copies using the isCopy pointer
-  //   argument, and consider using critical arrays to minimize copying.
   ABSL_CHECK(serialized_proto != nullptr);
-  jbyte* bytes = env->GetByteArrayElements(serialized_proto, nullptr);
+  // Parsing makes no JNI calls, so the array can be accessed as a critical
+  // region, which avoids copying it on VMs that would otherwise do so.
+  void* bytes = env->GetPrimitiveArrayCritical(serialized_proto, nullptr);
   ABSL_CHECK(bytes);
-  bool success = dest.ParseFromArray(bytes + offset, size);
-  env->ReleaseByteArrayElements(serialized_proto, bytes, 0);
+  bool success =
+      dest.ParseFromArray(static_cast<jbyte*>(bytes) + offset, size);
+  env->ReleasePrimitiveArrayCritical(serialized_proto, bytes, JNI_ABORT);
   if (!success) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Failed to parse ", dest.GetTypeName(), " proto from byte[]."));
@@ -85,13 +88,33 @@ jbyteArray SerializeProto(JNIEnv* env, const google::protobuf::MessageLite& src)
   size_t size = src.ByteSizeLong();
   jbyteArray serialized_proto = env->NewByteArray(size);
   ABSL_CHECK(serialized_proto);
-  jbyte* bytes = env->GetByteArrayElements(serialized_proto, nullptr);
+  // Serializing makes no JNI calls; see `ParseProtoFromByteArray()`.
+  void* bytes = env->GetPrimitiveArrayCritical(serialized_proto, nullptr);
   ABSL_CHECK(bytes);
   bool success = src.SerializeToArray(bytes, size);
-  env->ReleaseByteArrayElements(serialized_proto, bytes, 0);
+  env->ReleasePrimitiveArrayCritical(serialized_proto, bytes, 0);
   ABSL_CHECK(success);
   return serialized_proto;
 }
 
+jint SerializeProtoToBuffer(JNIEnv* env,
+                            const google::protobuf::MessageLite& src,
+                            jobject dest_direct_buffer, jint offset,
+                            jint capacity) {
+  ABSL_CHECK(dest_direct_buffer != nullptr);
+  size_t size = src.ByteSizeLong();
+  ABSL_CHECK_LE(size, static_cast<size_t>(std::numeric_limits<jint>::max()));
+  if (size > static_cast<size_t>(capacity)) return static_cast<jint>(size);
+  void* addr = env->GetDirectBufferAddress(dest_direct_buffer);
+  ABSL_CHECK(addr != nullptr);
+  ABSL_CHECK_LE(static_cast<jlong>(offset) + capacity,
+                env->GetDirectBufferCapacity(dest_direct_buffer));
+  uint8_t* start = static_cast<uint8_t*>(addr) + offset;
+  // `ByteSizeLong()` was just called, so the cached sizes are up to date.
+  uint8_t* end = src.SerializeWithCachedSizesToArray(start);
+  ABSL_CHECK_EQ(static_cast<size_t>(end - start), size);
+  return static_cast<jint>(size);
+}
+
 }  // namespace jni
 }  // namespace ink
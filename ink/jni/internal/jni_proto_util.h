@@ -62,6 +62,15 @@ absl::Status ParseProtoFromBuffer(JNIEnv* env,
 [[nodiscard]] jbyteArray SerializeProto(JNIEnv* env,
                                         const google::protobuf::MessageLite& src);
 
+// Serializes a proto directly into a caller-provided direct
+// java.nio.ByteBuffer, starting at `offset`, without any intermediate copy.
+// Returns the serialized size of the proto. If that is greater than
+// `capacity`, nothing is written, and the caller can retry with a buffer of at
+// least the returned size.
+[[nodiscard]] jint SerializeProtoToBuffer(
+    JNIEnv* env, const google::protobuf::MessageLite& src,
+    jobject dest_direct_buffer, jint offset, jint capacity);
+
 }  // namespace jni
 }  // namespace ink
 
@@ -0,0 +1,180 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/jni/internal/jni_thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "ink/types/executor.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace ink::jni {
+namespace {
+
+class ThreadPoolExecutor : public Executor {
+ public:
+  // If `cpus` is non-empty, the pool threads are pinned to those CPUs.
+  ThreadPoolExecutor(unsigned num_threads, std::vector<int> cpus) {
+    for (unsigned i = 0; i < num_threads; ++i) {
+      // The executor is never destroyed, so neither are its threads.
+      std::thread([this, cpus]() {
+        PinCurrentThread(cpus);
+        RunWorker();
+      }).detach();
+    }
+  }
+
+  void ParallelFor(size_t count,
+                   absl::FunctionRef<void(size_t)> task) override {
+    absl::MutexLock call_lock(&call_mutex_);
+    {
+      absl::MutexLock lock(&mutex_);
+      task_.emplace(task);
+      count_ = count;
+      next_index_ = 0;
+      completed_count_ = 0;
+      ++generation_;
+    }
+    RunClaimedTasks(task);
+    absl::MutexLock lock(&mutex_);
+    // `task` refers to the caller's state, so wait for every worker to stop
+    // using it, and not just for every index to be done.
+    mutex_.Await(absl::Condition(this, &ThreadPoolExecutor::JobDone));
+    task_.reset();
+  }
+
+ private:
+  static void PinCurrentThread(absl::Span<const int> cpus) {
+#ifdef __linux__
+    if (cpus.empty()) return;
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &cpu_set);
+    }
+    // Failure just leaves the thread unpinned, which is still correct.
+    sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+#endif
+  }
+
+  bool JobDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return completed_count_ == count_ && active_workers_ == 0;
+  }
+
+  // Claims and runs indices of the current job until there are none left.
+  void RunClaimedTasks(absl::FunctionRef<void(size_t)> task) {
+    while (true) {
+      size_t index;
+      {
+        absl::MutexLock lock(&mutex_);
+        if (next_index_ == count_) return;
+        index = next_index_++;
+      }
+      task(index);
+      absl::MutexLock lock(&mutex_);
+      ++completed_count_;
+    }
+  }
+
+  void RunWorker() {
+    uint64_t seen_generation = 0;
+    auto has_new_job = [this, &seen_generation]()
+                           ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+                             return task_.has_value() &&
+                                    generation_ != seen_generation;
+                           };
+    while (true) {
+      std::optional<absl::FunctionRef<void(size_t)>> task;
+      {
+        absl::MutexLock lock(&mutex_);
+        mutex_.Await(absl::Condition(&has_new_job));
+        seen_generation = generation_;
+        task.emplace(*task_);
+        ++active_workers_;
+      }
+      RunClaimedTasks(*task);
+      absl::MutexLock lock(&mutex_);
+      --active_workers_;
+    }
+  }
+
+  // Held for the duration of each `ParallelFor()` call, so that only one job
+  // runs at a time.
+  absl::Mutex call_mutex_;
+  absl::Mutex mutex_;
+  std::optional<absl::FunctionRef<void(size_t)>> task_ ABSL_GUARDED_BY(mutex_);
+  size_t count_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t next_index_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t completed_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int active_workers_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// The configuration of the built-in pool, which is fixed once it is created.
+struct PoolConfig {
+  absl::Mutex mutex;
+  bool pool_created ABSL_GUARDED_BY(mutex) = false;
+  std::vector<int> cpus ABSL_GUARDED_BY(mutex);
+};
+
+PoolConfig& GetPoolConfig() {
+  static PoolConfig* const kConfig = new PoolConfig();
+  return *kConfig;
+}
+
+Executor& BuiltInPool() {
+  static Executor* const kExecutor = []() {
+    PoolConfig& config = GetPoolConfig();
+    absl::MutexLock lock(&config.mutex);
+    config.pool_created = true;
+    unsigned pool_size =
+        config.cpus.empty()
+            ? std::max(std::thread::hardware_concurrency(), 1u)
+            : static_cast<unsigned>(config.cpus.size());
+    return new ThreadPoolExecutor(pool_size - 1, config.cpus);
+  }();
+  return *kExecutor;
+}
+
+}  // namespace
+
+Executor& JniThreadPool() {
+  if (Executor* process_executor = GetProcessExecutor();
+      process_executor != nullptr) {
+    return *process_executor;
+  }
+  return BuiltInPool();
+}
+
+bool SetJniThreadPoolCpus(absl::Span<const int> cpus) {
+  PoolConfig& config = GetPoolConfig();
+  absl::MutexLock lock(&config.mutex);
+  if (config.pool_created) return false;
+  config.cpus.assign(cpus.begin(), cpus.end());
+  return true;
+}
+
+}  // namespace ink::jni
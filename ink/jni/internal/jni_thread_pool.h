@@ -0,0 +1,53 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_JNI_INTERNAL_JNI_THREAD_POOL_H_
+#define INK_JNI_INTERNAL_JNI_THREAD_POOL_H_
+
+#include "absl/types/span.h"
+#include "ink/types/executor.h"
+
+namespace ink::jni {
+
+// Returns an `Executor` whose `ParallelFor()` spreads its tasks across a pool
+// of native threads, one fewer than the number of hardware threads, with the
+// calling thread taking tasks too. `Schedule()` runs its task on the calling
+// thread.
+//
+// This is for JNI entry points that answer a large batch of independent
+// queries in one call. Calls to `ParallelFor()` from different threads take
+// turns, so tasks must not themselves call `ParallelFor()` on this executor.
+// As with `JniWorkerThread()`, the pool threads are never attached to the JVM,
+// so tasks must not make JNI calls.
+//
+// If the host has installed an executor with `SetProcessExecutor()`, that is
+// returned instead, so that apps can run Ink's work on their own thread pool.
+Executor& JniThreadPool();
+
+// Pins the threads of the built-in pool returned by `JniThreadPool()` to the
+// CPUs with the given indices, and sizes the pool to match, e.g. to keep batch
+// queries on the big cores of a big.LITTLE device. The calling thread of
+// `ParallelFor()` is not pinned, but still counts towards the pool size, so the
+// pool has one thread fewer than `cpus.size()`. An empty `cpus` restores the
+// default of one thread per hardware thread, unpinned.
+//
+// This must be called before the first call to `JniThreadPool()`, since the
+// pool threads are created then; returns false and has no effect otherwise.
+// Pinning is only supported on Linux (including Android); elsewhere only the
+// pool size is applied.
+bool SetJniThreadPoolCpus(absl::Span<const int> cpus);
+
+}  // namespace ink::jni
+
+#endif  // INK_JNI_INTERNAL_JNI_THREAD_POOL_H_
@@ -0,0 +1,78 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/jni/internal/jni_worker_thread.h"
+
+#include <cstddef>
+#include <deque>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "ink/types/executor.h"
+
+namespace ink::jni {
+namespace {
+
+class WorkerThreadExecutor : public Executor {
+ public:
+  WorkerThreadExecutor() : thread_([this]() { RunTasks(); }) {
+    // The executor is never destroyed, so neither is the thread.
+    thread_.detach();
+  }
+
+  void ParallelFor(size_t count,
+                   absl::FunctionRef<void(size_t)> task) override {
+    for (size_t i = 0; i < count; ++i) task(i);
+  }
+
+  void Schedule(absl::AnyInvocable<void() &&> task) override {
+    absl::MutexLock lock(&mutex_);
+    tasks_.push_back(std::move(task));
+  }
+
+ private:
+  bool HasTasks() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !tasks_.empty();
+  }
+
+  void RunTasks() {
+    while (true) {
+      absl::AnyInvocable<void() &&> task;
+      {
+        absl::MutexLock lock(&mutex_);
+        mutex_.Await(absl::Condition(this, &WorkerThreadExecutor::HasTasks));
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      std::move(task)();
+    }
+  }
+
+  absl::Mutex mutex_;
+  std::deque<absl::AnyInvocable<void() &&>> tasks_ ABSL_GUARDED_BY(mutex_);
+  std::thread thread_;
+};
+
+}  // namespace
+
+Executor& JniWorkerThread() {
+  static Executor* const kExecutor = new WorkerThreadExecutor();
+  return *kExecutor;
+}
+
+}  // namespace ink::jni
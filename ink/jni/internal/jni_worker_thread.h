@@ -0,0 +1,35 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_JNI_INTERNAL_JNI_WORKER_THREAD_H_
+#define INK_JNI_INTERNAL_JNI_WORKER_THREAD_H_
+
+#include "ink/types/executor.h"
+
+namespace ink::jni {
+
+// Returns an `Executor` whose `Schedule()` runs tasks one at a time, in the
+// order they were scheduled, on a single native worker thread shared by all
+// callers. `ParallelFor()` runs its tasks on the calling thread.
+//
+// The core library never creates threads, but the JNI layer has no host
+// executor to hand it, so this is what it uses to take work off the calling
+// (usually UI) thread. The thread is created on first use and lives for the
+// rest of the process. It is never attached to the JVM, so tasks must not make
+// JNI calls.
+Executor& JniWorkerThread();
+
+}  // namespace ink::jni
+
+#endif  // INK_JNI_INTERNAL_JNI_WORKER_THREAD_H_
@@ -16,15 +16,26 @@
 
 #include "absl/log/absl_check.h"
 #include "ink/jni/internal/jni_jvm_interface.h"
+#include "ink/jni/internal/jni_native_registration.h"
 
 extern "C" {
 
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+  JNIEnv* env;
+  if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+    return JNI_ERR;
+  }
+  // Do the lookups up front, rather than on the first stroke after the process
+  // starts.
+  ink::jni::LoadJvmInterface(env);
+  ink::jni::RunNativeRegistrations(env);
+  return JNI_VERSION_1_6;
+}
+
 JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
   JNIEnv* env;
   vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
   ABSL_CHECK_NE(env, nullptr);
-  // There's no corresponding OnLoad because loading of this interface is
-  // done lazily.
   ink::jni::UnloadJvmInterface(env);
 }
 
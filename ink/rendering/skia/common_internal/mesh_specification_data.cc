@@ -15,6 +15,7 @@
 #include "ink/rendering/skia/common_internal/mesh_specification_data.h"
 
 #include <optional>
+#include <string>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/log/absl_check.h"
@@ -56,7 +57,8 @@ constexpr absl::string_view kNumTextureAnimationRowsName =
 constexpr absl::string_view kNumTextureAnimationColumnsName =
     "uNumTextureAnimationColumns";
 
-// Shared fragment shader used for both InProgressStroke and Stroke.
+// Shared fragment shaders used for both InProgressStroke and Stroke, with and
+// without texture coordinates for the paint's shader.
 constexpr absl::string_view kFragmentMain = R"(
   float2 main(const Varyings varyings, out float4 color) {
     color =
@@ -65,9 +67,111 @@ constexpr absl::string_view kFragmentMain = R"(
                                               varyings.outsetPixelsLRFB);
     return varyings.textureCoords;
   })";
+constexpr absl::string_view kFragmentMainWithoutTextureCoords = R"(
+  void main(const Varyings varyings, out float4 color) {
+    color =
+      varyings.color * simulatedPixelCoverage(varyings.pixelsPerDimension,
+                                              varyings.normalizedToEdgeLRFB,
+                                              varyings.outsetPixelsLRFB);
+  })";
+
+// Vertex shader source for texture coordinates with `kTiling` mapping, which
+// is applied by the paint's shader to the canvas position.
+constexpr absl::string_view kVertexMainTilingTextureUv = R"(
+        varyings.textureCoords = varyings.position;
+  )";
+
+bool UsesTextureMappingUniform(const StrokeShaderFeatures& features) {
+  return features.texture_coordinates && !features.texture_mapping.has_value();
+}
+
+bool UsesTextureAnimationUniforms(const StrokeShaderFeatures& features) {
+  return features.texture_coordinates &&
+         features.texture_mapping != BrushPaint::TextureMapping::kTiling;
+}
+
+// Returns the SkSL declarations of the texture uniforms used by `features`.
+std::string TextureUniformDeclarations(const StrokeShaderFeatures& features) {
+  static_assert(kTextureMappingName == "uTextureMapping");
+  static_assert(kTextureAnimationProgressName == "uTextureAnimationProgress");
+  static_assert(kNumTextureAnimationFramesName == "uNumTextureAnimationFrames");
+  static_assert(kNumTextureAnimationRowsName == "uNumTextureAnimationRows");
+  static_assert(kNumTextureAnimationColumnsName ==
+                "uNumTextureAnimationColumns");
+  std::string declarations;
+  if (UsesTextureMappingUniform(features)) {
+    absl::StrAppend(&declarations, R"(
+      uniform int uTextureMapping;)");
+  }
+  if (UsesTextureAnimationUniforms(features)) {
+    absl::StrAppend(&declarations, R"(
+      uniform float uTextureAnimationProgress;
+      uniform int uNumTextureAnimationFrames;
+      uniform int uNumTextureAnimationRows;
+      uniform int uNumTextureAnimationColumns;)");
+  }
+  return declarations;
+}
+
+// Appends the texture uniforms used by `features` to `uniforms`, in the same
+// order as `TextureUniformDeclarations()`.
+void AppendTextureUniforms(
+    const StrokeShaderFeatures& features,
+    absl::InlinedVector<MeshSpecificationData::Uniform,
+                        MeshSpecificationData::kMaxUniforms>& uniforms) {
+  using UniformId = MeshSpecificationData::UniformId;
+  using UniformType = MeshSpecificationData::UniformType;
+  if (UsesTextureMappingUniform(features)) {
+    uniforms.push_back(
+        {.type = UniformType::kInt, .id = UniformId::kTextureMapping});
+  }
+  if (UsesTextureAnimationUniforms(features)) {
+    uniforms.push_back({.type = UniformType::kFloat,
+                        .id = UniformId::kTextureAnimationProgress});
+    uniforms.push_back({.type = UniformType::kInt,
+                        .id = UniformId::kNumTextureAnimationFrames});
+    uniforms.push_back(
+        {.type = UniformType::kInt, .id = UniformId::kNumTextureAnimationRows});
+    uniforms.push_back({.type = UniformType::kInt,
+                        .id = UniformId::kNumTextureAnimationColumns});
+  }
+}
+
+// Returns the vertex shader source that calculates texture coordinates for
+// `features`, given the source that does so for `kStamping` mapping.
+std::string TextureUvSource(const StrokeShaderFeatures& features,
+                            absl::string_view stamping_texture_uv) {
+  if (!features.texture_coordinates) return "";
+  if (features.texture_mapping.has_value()) {
+    switch (*features.texture_mapping) {
+      case BrushPaint::TextureMapping::kTiling:
+        return std::string(kVertexMainTilingTextureUv);
+      case BrushPaint::TextureMapping::kStamping:
+        return std::string(stamping_texture_uv);
+    }
+  }
+  static_assert(static_cast<int>(BrushPaint::TextureMapping::kStamping) == 1);
+  return absl::StrCat(R"(
+        if (uTextureMapping == 1) {)",
+                      stamping_texture_uv, R"(
+        } else {)",
+                      kVertexMainTilingTextureUv, R"(
+        }
+  )");
+}
 
 }  // namespace
 
+StrokeShaderFeatures StrokeShaderFeatures::ForPaint(const BrushPaint& paint) {
+  // TODO: b/375203215 - Mixed texture mapping modes in a single `BrushPaint`
+  // aren't supported yet, so the first layer's mapping applies to all of them.
+  if (paint.texture_layers.empty()) {
+    return {.texture_coordinates = false, .texture_mapping = std::nullopt};
+  }
+  return {.texture_coordinates = true,
+          .texture_mapping = paint.texture_layers.front().mapping};
+}
+
 absl::string_view MeshSpecificationData::GetUniformName(UniformId uniform_id) {
   switch (uniform_id) {
     case UniformId::kObjectToCanvasLinearComponent:
@@ -96,35 +200,26 @@ absl::string_view MeshSpecificationData::GetUniformName(UniformId uniform_id) {
 
 absl::StatusOr<MeshSpecificationData>
 MeshSpecificationData::CreateForInProgressStroke(
-    const MeshFormat& mesh_format) {
+    const MeshFormat& mesh_format, const StrokeShaderFeatures& features) {
   if (mesh_format != StrokeVertex::FullMeshFormat()) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Got a `mesh_format` not from an `InProgressStroke`: ", mesh_format));
   }
-  return CreateForInProgressStroke();
+  return CreateForInProgressStroke(features);
 }
 
-MeshSpecificationData MeshSpecificationData::CreateForInProgressStroke() {
+MeshSpecificationData MeshSpecificationData::CreateForInProgressStroke(
+    const StrokeShaderFeatures& features) {
   static_assert(kUniformBrushColorName == "uBrushColor");
   static_assert(kObjectToCanvasLinearComponentName ==
                 "uObjectToCanvasLinearComponent");
-  static_assert(kTextureMappingName == "uTextureMapping");
-  static_assert(kTextureAnimationProgressName == "uTextureAnimationProgress");
-  static_assert(kNumTextureAnimationFramesName == "uNumTextureAnimationFrames");
-  static_assert(kNumTextureAnimationRowsName == "uNumTextureAnimationRows");
-  static_assert(kNumTextureAnimationColumnsName ==
-                "uNumTextureAnimationColumns");
   // Do not use `layout(color)` for uBrushColor, as the color is being converted
   // into the shader color space manually rather than relying on the implicit
   // conversion of setColorUniform.
-  constexpr absl::string_view kVertexMain = R"(
+  constexpr absl::string_view kVertexUniforms = R"(
       uniform float4 uObjectToCanvasLinearComponent;
-      uniform float4 uBrushColor;
-      uniform int uTextureMapping;
-      uniform float uTextureAnimationProgress;
-      uniform int uNumTextureAnimationFrames;
-      uniform int uNumTextureAnimationRows;
-      uniform int uNumTextureAnimationColumns;
+      uniform float4 uBrushColor;)";
+  constexpr absl::string_view kVertexMainStart = R"(
 
       Varyings main(const Attributes attributes) {
         Varyings varyings;
@@ -142,8 +237,8 @@ MeshSpecificationData MeshSpecificationData::CreateForInProgressStroke() {
             attributes.hslShift, attributes.positionAndOpacityShift.z,
             uBrushColor);
         varyings.color.rgb *= varyings.color.a;
-
-        if (uTextureMapping == 1) {
+  )";
+  constexpr absl::string_view kVertexMainStampingTextureUv = R"(
           varyings.textureCoords = calculateStampingTextureUv(
               unpackSurfaceUv(attributes.surfaceUvAndAnimationOffset.xy),
               unpackAnimationOffset(attributes.surfaceUvAndAnimationOffset.z),
@@ -151,14 +246,11 @@ MeshSpecificationData MeshSpecificationData::CreateForInProgressStroke() {
               uNumTextureAnimationFrames,
               uNumTextureAnimationRows,
               uNumTextureAnimationColumns);
-        } else {
-          varyings.textureCoords = varyings.position;
-        }
-
+  )";
+  constexpr absl::string_view kVertexMainEnd = R"(
         return varyings;
       }
   )";
-  static_assert(static_cast<int>(BrushPaint::TextureMapping::kStamping) == 1);
 
   // Translate from `MeshFormat` to `MeshSpecificationData` attributes. Where
   // applicable below, multiple `MeshFormat` attributes are combined into one
@@ -212,32 +304,37 @@ MeshSpecificationData MeshSpecificationData::CreateForInProgressStroke() {
       .offset = format_attributes[kAttributeIndices.surface_uv].unpacked_offset,
       .name = "surfaceUvAndAnimationOffset"};
 
+  absl::InlinedVector<Varying, kMaxVaryings> varyings = {
+      {.type = VaryingType::kFloat4, .name = "color"}};
+  if (features.texture_coordinates) {
+    varyings.push_back({.type = VaryingType::kFloat2, .name = "textureCoords"});
+  }
+  varyings.insert(
+      varyings.end(),
+      {{.type = VaryingType::kFloat2, .name = "pixelsPerDimension"},
+       {.type = VaryingType::kFloat4, .name = "normalizedToEdgeLRFB"},
+       {.type = VaryingType::kFloat4, .name = "outsetPixelsLRFB"}});
+
+  absl::InlinedVector<Uniform, kMaxUniforms> uniforms = {
+      {.type = UniformType::kFloat4,
+       .id = UniformId::kObjectToCanvasLinearComponent},
+      {.type = UniformType::kFloat4, .id = UniformId::kBrushColor}};
+  AppendTextureUniforms(features, uniforms);
+
   return MeshSpecificationData{
       .attributes = rendering_attributes,
       .vertex_stride = kInProgressStrokeFormat.UnpackedVertexStride(),
-      .varyings = {{.type = VaryingType::kFloat4, .name = "color"},
-                   {.type = VaryingType::kFloat2, .name = "textureCoords"},
-                   {.type = VaryingType::kFloat2, .name = "pixelsPerDimension"},
-                   {.type = VaryingType::kFloat4,
-                    .name = "normalizedToEdgeLRFB"},
-                   {.type = VaryingType::kFloat4, .name = "outsetPixelsLRFB"}},
-      .uniforms = {{.type = UniformType::kFloat4,
-                    .id = UniformId::kObjectToCanvasLinearComponent},
-                   {.type = UniformType::kFloat4, .id = UniformId::kBrushColor},
-                   {.type = UniformType::kInt,
-                    .id = UniformId::kTextureMapping},
-                   {.type = UniformType::kFloat,
-                    .id = UniformId::kTextureAnimationProgress},
-                   {.type = UniformType::kInt,
-                    .id = UniformId::kNumTextureAnimationFrames},
-                   {.type = UniformType::kInt,
-                    .id = UniformId::kNumTextureAnimationRows},
-                   {.type = UniformType::kInt,
-                    .id = UniformId::kNumTextureAnimationColumns}},
+      .varyings = SmallArray<Varying, kMaxVaryings>(absl::MakeSpan(varyings)),
+      .uniforms = SmallArray<Uniform, kMaxUniforms>(absl::MakeSpan(uniforms)),
       .vertex_shader_source = absl::StrCat(
-          kSkSLCommonShaderHelpers, kSkSLVertexShaderHelpers, kVertexMain),
+          kSkSLCommonShaderHelpers, kSkSLVertexShaderHelpers, kVertexUniforms,
+          TextureUniformDeclarations(features), kVertexMainStart,
+          TextureUvSource(features, kVertexMainStampingTextureUv),
+          kVertexMainEnd),
       .fragment_shader_source = absl::StrCat(
-          kSkSLCommonShaderHelpers, kSkSLFragmentShaderHelpers, kFragmentMain),
+          kSkSLCommonShaderHelpers, kSkSLFragmentShaderHelpers,
+          features.texture_coordinates ? kFragmentMain
+                                       : kFragmentMainWithoutTextureCoords),
   };
 }
 
@@ -476,7 +573,7 @@ GetValidatedStrokeAttributeTypesAndOffsets(
 }  // namespace
 
 absl::StatusOr<MeshSpecificationData> MeshSpecificationData::CreateForStroke(
-    const MeshFormat& mesh_format) {
+    const MeshFormat& mesh_format, const StrokeShaderFeatures& features) {
   StrokeVertex::FormatAttributeIndices attribute_indices =
       StrokeVertex::FindAttributeIndices(mesh_format);
   absl::StatusOr<SkiaStrokeAttributeTypesAndOffsets> types_and_offsets =
@@ -493,26 +590,16 @@ absl::StatusOr<MeshSpecificationData> MeshSpecificationData::CreateForStroke(
                 "uSideUnpackingTransform");
   static_assert(kUniformForwardDerivativeUnpackingTransformName ==
                 "uForwardUnpackingTransform");
-  static_assert(kTextureMappingName == "uTextureMapping");
-  static_assert(kTextureAnimationProgressName == "uTextureAnimationProgress");
-  static_assert(kNumTextureAnimationFramesName == "uNumTextureAnimationFrames");
-  static_assert(kNumTextureAnimationRowsName == "uNumTextureAnimationRows");
-  static_assert(kNumTextureAnimationColumnsName ==
-                "uNumTextureAnimationColumns");
   // Do not use `layout(color)` for uBrushColor, as the color is being converted
   // into the shader color space manually rather than relying on the implicit
   // conversion of setColorUniform.
-  constexpr absl::string_view kVertexMainStart = R"(
+  constexpr absl::string_view kVertexUniforms = R"(
       uniform float4 uObjectToCanvasLinearComponent;
       uniform float4 uBrushColor;
       uniform float4 uPositionUnpackingTransform;
       uniform float4 uSideUnpackingTransform;
-      uniform float4 uForwardUnpackingTransform;
-      uniform int uTextureMapping;
-      uniform float uTextureAnimationProgress;
-      uniform int uNumTextureAnimationFrames;
-      uniform int uNumTextureAnimationRows;
-      uniform int uNumTextureAnimationColumns;
+      uniform float4 uForwardUnpackingTransform;)";
+  constexpr absl::string_view kVertexMainStart = R"(
 
       Varyings main(const Attributes attributes) {
         Varyings varyings;
@@ -542,15 +629,13 @@ absl::StatusOr<MeshSpecificationData> MeshSpecificationData::CreateForStroke(
         varyings.color = float4(uBrushColor.rgb * a, a);
   )";
 
-  // There are three cases for computing texture coordinates in the shader.
+  // There are three cases for computing `kStamping` texture coordinates in the
+  // shader.
   //
   // Case 1: 12-bit surface U and V and 8-bit animation offset. This is used for
   // particle-based meshes to support (potentially-animated) "stamping" textured
   // particles.
-  static_assert(static_cast<int>(BrushPaint::TextureMapping::kStamping) == 1);
-  constexpr absl::string_view
-      kVertexMainTextureUvWithSurfaceUvAndAnimationOffset = R"(
-        if (uTextureMapping == 1) {
+  constexpr absl::string_view kVertexMainStampingTextureUv = R"(
           varyings.textureCoords = calculateStampingTextureUv(
               unpackSurfaceUv(attributes.surfaceUvAndAnimationOffset.xyz),
               unpackAnimationOffset(attributes.surfaceUvAndAnimationOffset.w),
@@ -558,9 +643,6 @@ absl::StatusOr<MeshSpecificationData> MeshSpecificationData::CreateForStroke(
               uNumTextureAnimationFrames,
               uNumTextureAnimationRows,
               uNumTextureAnimationColumns);
-        } else {
-          varyings.textureCoords = varyings.position;
-        }
   )";
   // Case 2: 12-bit surface U, 20-bit surface V, and no animation offset. This
   // is used for extruded (non-particle-based) meshes to support winding
@@ -569,10 +651,8 @@ absl::StatusOr<MeshSpecificationData> MeshSpecificationData::CreateForStroke(
   // TODO: b/330511293 - Support this case.
   //
   // Case 3: No surface UV or animation offset attribute is available at all;
-  // stamping/winding textures are not supported for this mesh.
-  constexpr absl::string_view kVertexMainTextureUvWithoutSurfaceUv = R"(
-        varyings.textureCoords = varyings.position;
-  )";
+  // stamping/winding textures are not supported for this mesh, and the tiling
+  // texture coordinates are used instead.
 
   constexpr absl::string_view kVertexMainEnd = R"(
         return varyings;
@@ -603,51 +683,54 @@ absl::StatusOr<MeshSpecificationData> MeshSpecificationData::CreateForStroke(
          .name = "surfaceUvAndAnimationOffset"});
   }
 
+  absl::InlinedVector<Varying, kMaxVaryings> varyings = {
+      {.type = VaryingType::kFloat4, .name = "color"},
+      {.type = VaryingType::kFloat2, .name = "pixelsPerDimension"},
+      {.type = VaryingType::kFloat4, .name = "normalizedToEdgeLRFB"},
+      {.type = VaryingType::kFloat4, .name = "outsetPixelsLRFB"}};
+  if (features.texture_coordinates) {
+    varyings.push_back({.type = VaryingType::kFloat2, .name = "textureCoords"});
+  }
+
+  absl::InlinedVector<Uniform, kMaxUniforms> uniforms = {
+      {.type = UniformType::kFloat4,
+       .id = UniformId::kObjectToCanvasLinearComponent},
+      {.type = UniformType::kFloat4, .id = UniformId::kBrushColor},
+      {.type = UniformType::kFloat4,
+       .id = UniformId::kPositionUnpackingTransform,
+       .unpacking_attribute_index = attribute_indices.position},
+      {.type = UniformType::kFloat4,
+       .id = UniformId::kSideDerivativeUnpackingTransform,
+       .unpacking_attribute_index = attribute_indices.side_derivative},
+      {.type = UniformType::kFloat4,
+       .id = UniformId::kForwardDerivativeUnpackingTransform,
+       .unpacking_attribute_index = attribute_indices.forward_derivative}};
+  AppendTextureUniforms(features, uniforms);
+
   return MeshSpecificationData{
       .attributes = SmallArray<Attribute, kMaxAttributes>(
           absl::MakeSpan(mesh_specification_attributes)),
       .vertex_stride = mesh_format.PackedVertexStride(),
-      .varyings = {{.type = VaryingType::kFloat4, .name = "color"},
-                   {.type = VaryingType::kFloat2, .name = "pixelsPerDimension"},
-                   {.type = VaryingType::kFloat4,
-                    .name = "normalizedToEdgeLRFB"},
-                   {.type = VaryingType::kFloat4, .name = "outsetPixelsLRFB"},
-                   {.type = VaryingType::kFloat2, .name = "textureCoords"}},
-      .uniforms =
-          {{.type = UniformType::kFloat4,
-            .id = UniformId::kObjectToCanvasLinearComponent},
-           {.type = UniformType::kFloat4, .id = UniformId::kBrushColor},
-           {.type = UniformType::kFloat4,
-            .id = UniformId::kPositionUnpackingTransform,
-            .unpacking_attribute_index = attribute_indices.position},
-           {.type = UniformType::kFloat4,
-            .id = UniformId::kSideDerivativeUnpackingTransform,
-            .unpacking_attribute_index = attribute_indices.side_derivative},
-           {.type = UniformType::kFloat4,
-            .id = UniformId::kForwardDerivativeUnpackingTransform,
-            .unpacking_attribute_index = attribute_indices.forward_derivative},
-           {.type = UniformType::kInt, .id = UniformId::kTextureMapping},
-           {.type = UniformType::kFloat,
-            .id = UniformId::kTextureAnimationProgress},
-           {.type = UniformType::kInt,
-            .id = UniformId::kNumTextureAnimationFrames},
-           {.type = UniformType::kInt,
-            .id = UniformId::kNumTextureAnimationRows},
-           {.type = UniformType::kInt,
-            .id = UniformId::kNumTextureAnimationColumns}},
+      .varyings = SmallArray<Varying, kMaxVaryings>(absl::MakeSpan(varyings)),
+      .uniforms = SmallArray<Uniform, kMaxUniforms>(absl::MakeSpan(uniforms)),
       .vertex_shader_source = absl::StrCat(
-          kSkSLCommonShaderHelpers, kSkSLVertexShaderHelpers, kVertexMainStart,
+          kSkSLCommonShaderHelpers, kSkSLVertexShaderHelpers, kVertexUniforms,
+          TextureUniformDeclarations(features), kVertexMainStart,
           types_and_offsets->hsl_shift.has_value()
               ? kVertexMainColorWithHslShift
               : kVertexMainColorWithoutHslShift,
-          types_and_offsets->surface_uv_and_animation_offset.has_value()
-              // TODO: b/330511293 - If there's a surface UV, but no animation
-              // offset, use `kVertexMainTextureUvWithSurfaceUvOnly` here.
-              ? kVertexMainTextureUvWithSurfaceUvAndAnimationOffset
-              : kVertexMainTextureUvWithoutSurfaceUv,
+          TextureUvSource(
+              features,
+              types_and_offsets->surface_uv_and_animation_offset.has_value()
+                  // TODO: b/330511293 - If there's a surface UV, but no
+                  // animation offset, use the winding texture UV here.
+                  ? kVertexMainStampingTextureUv
+                  : kVertexMainTilingTextureUv),
           kVertexMainEnd),
       .fragment_shader_source = absl::StrCat(
-          kSkSLCommonShaderHelpers, kSkSLFragmentShaderHelpers, kFragmentMain)};
+          kSkSLCommonShaderHelpers, kSkSLFragmentShaderHelpers,
+          features.texture_coordinates ? kFragmentMain
+                                       : kFragmentMainWithoutTextureCoords)};
 }
 
 }  // namespace ink::skia_common_internal
@@ -18,14 +18,45 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "ink/brush/brush_paint.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/types/small_array.h"
 
 namespace ink::skia_common_internal {
 
+// The optional parts of the stroke shaders, which can be left out of a mesh
+// specification when the `BrushPaint` it is used with doesn't need them. Each
+// left out part saves per-vertex or per-fragment work.
+//
+// The default value includes everything, so a specification created with it
+// can be used with any `BrushPaint`.
+struct StrokeShaderFeatures {
+  // Returns the features needed to draw a stroke coat with `paint`.
+  static StrokeShaderFeatures ForPaint(const BrushPaint& paint);
+
+  // Whether the shaders calculate texture coordinates for the paint's shader.
+  // These are only used by a `BrushPaint` with texture layers.
+  bool texture_coordinates = true;
+  // If set, the shaders only support this texture mapping, and take no
+  // `kTextureMapping` uniform. The texture animation uniforms are also left
+  // out if this is `kTiling`, which doesn't support animation. Ignored if
+  // `texture_coordinates` is false.
+  std::optional<BrushPaint::TextureMapping> texture_mapping;
+
+  friend bool operator==(const StrokeShaderFeatures&,
+                         const StrokeShaderFeatures&) = default;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const StrokeShaderFeatures& features) {
+    return H::combine(std::move(h), features.texture_coordinates,
+                      features.texture_mapping);
+  }
+};
+
 // Platform-independent data that roughly mirrors, and can be used to create, an
 // Android `graphics.MeshSpecification` or a C++ `SkMeshSpecification`.
 //
@@ -130,12 +161,14 @@ struct MeshSpecificationData {
   // `const BrushFamily&` parameter to determine texture mapping and other
   // rendering options that may use two identical `MeshFormat`s differently.
 
-  // Returns the mesh specification data for an `InProgressStroke`.
+  // Returns the mesh specification data for an `InProgressStroke`, with the
+  // shader parts given by `features`.
   //
   // This function should be the preferred way to get the specification data for
   // native C++ Skia rendering, where we will be sure that we are drawing an
   // `InProgressStroke`.
-  static MeshSpecificationData CreateForInProgressStroke();
+  static MeshSpecificationData CreateForInProgressStroke(
+      const StrokeShaderFeatures& features = {});
 
   // Returns data for rendering a `MutableMesh` created by an
   // `InProgressStroke`.
@@ -147,9 +180,10 @@ struct MeshSpecificationData {
   // Returns an invalid argument error if `mesh_format` is not the format used
   // by `InProgressStroke`.
   static absl::StatusOr<MeshSpecificationData> CreateForInProgressStroke(
-      const MeshFormat& mesh_format);
+      const MeshFormat& mesh_format, const StrokeShaderFeatures& features = {});
 
-  // Returns data for rendering a `PartitionedMesh` created for a `Stroke`.
+  // Returns data for rendering a `PartitionedMesh` created for a `Stroke`, with
+  // the shader parts given by `features`.
   //
   // Unlike the two overloads for `InProgressStroke`, this function accepting a
   // `MeshFormat` is the only way to get specification data for a `Stroke`.
@@ -173,7 +207,7 @@ struct MeshSpecificationData {
   // The packed representation of the `MeshFormat` used by `InProgressStroke`
   // will always be supported.
   static absl::StatusOr<MeshSpecificationData> CreateForStroke(
-      const MeshFormat& mesh_format);
+      const MeshFormat& mesh_format, const StrokeShaderFeatures& features = {});
 
   SmallArray<Attribute, kMaxAttributes> attributes;
   int32_t vertex_stride;
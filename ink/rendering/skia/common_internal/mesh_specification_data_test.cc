@@ -26,8 +26,10 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush.h"
+#include "ink/brush/brush_paint.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/type_matchers.h"
 #include "ink/strokes/input/stroke_input_batch.h"
@@ -40,11 +42,16 @@ namespace {
 
 using ::absl_testing::IsOk;
 using ::ink::strokes_internal::StrokeVertex;
+using ::testing::AllOf;
+using ::testing::Contains;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
+using ::testing::IsSupersetOf;
 using ::testing::Not;
 
+using UniformId = MeshSpecificationData::UniformId;
+
 bool IsValidAttributeType(MeshSpecificationData::AttributeType type) {
   switch (type) {
     case MeshSpecificationData::AttributeType::kFloat2:
@@ -651,5 +658,129 @@ TEST(MeshSpecificationDataTest,
   }
 }
 
+std::vector<absl::string_view> VaryingNames(const MeshSpecificationData& data) {
+  std::vector<absl::string_view> names;
+  for (const MeshSpecificationData::Varying& varying : data.varyings.Values()) {
+    names.push_back(varying.name);
+  }
+  return names;
+}
+
+std::vector<MeshSpecificationData::UniformId> UniformIds(
+    const MeshSpecificationData& data) {
+  std::vector<MeshSpecificationData::UniformId> ids;
+  for (const MeshSpecificationData::Uniform& uniform : data.uniforms.Values()) {
+    ids.push_back(uniform.id);
+  }
+  return ids;
+}
+
+BrushPaint MakePaintWithMapping(BrushPaint::TextureMapping mapping) {
+  return {.texture_layers = {{.client_texture_id = "foo", .mapping = mapping}}};
+}
+
+TEST(StrokeShaderFeaturesTest, ForPaint) {
+  EXPECT_EQ(StrokeShaderFeatures::ForPaint(BrushPaint{}),
+            StrokeShaderFeatures{.texture_coordinates = false});
+  EXPECT_EQ(StrokeShaderFeatures::ForPaint(
+                MakePaintWithMapping(BrushPaint::TextureMapping::kTiling)),
+            (StrokeShaderFeatures{
+                .texture_coordinates = true,
+                .texture_mapping = BrushPaint::TextureMapping::kTiling}));
+  EXPECT_EQ(StrokeShaderFeatures::ForPaint(
+                MakePaintWithMapping(BrushPaint::TextureMapping::kStamping)),
+            (StrokeShaderFeatures{
+                .texture_coordinates = true,
+                .texture_mapping = BrushPaint::TextureMapping::kStamping}));
+}
+
+TEST(MeshSpecificationDataTest, DefaultFeaturesSupportAnyTextureMapping) {
+  absl::StatusOr<MeshSpecificationData> data =
+      MeshSpecificationData::CreateForStroke(StrokeVertex::FullMeshFormat());
+  ASSERT_THAT(data, IsOk());
+  EXPECT_THAT(VaryingNames(*data), Contains("textureCoords"));
+  EXPECT_THAT(UniformIds(*data),
+              IsSupersetOf({UniformId::kTextureMapping,
+                            UniformId::kTextureAnimationProgress,
+                            UniformId::kNumTextureAnimationFrames,
+                            UniformId::kNumTextureAnimationRows,
+                            UniformId::kNumTextureAnimationColumns}));
+  EXPECT_THAT(data->fragment_shader_source, HasSubstr("float2 main"));
+}
+
+TEST(MeshSpecificationDataTest, CreateForStrokeWithoutTextureCoordinates) {
+  absl::StatusOr<MeshSpecificationData> data =
+      MeshSpecificationData::CreateForStroke(
+          StrokeVertex::FullMeshFormat(),
+          StrokeShaderFeatures{.texture_coordinates = false});
+  ASSERT_THAT(data, IsOk());
+  EXPECT_THAT(VaryingNames(*data), Not(Contains("textureCoords")));
+  EXPECT_THAT(UniformIds(*data),
+              ElementsAre(UniformId::kObjectToCanvasLinearComponent,
+                          UniformId::kBrushColor,
+                          UniformId::kPositionUnpackingTransform,
+                          UniformId::kSideDerivativeUnpackingTransform,
+                          UniformId::kForwardDerivativeUnpackingTransform));
+  EXPECT_THAT(data->vertex_shader_source, Not(HasSubstr("textureCoords")));
+  EXPECT_THAT(data->fragment_shader_source, HasSubstr("void main"));
+  EXPECT_THAT(*data, SpecificationDataHasValidShaderVariableValues(
+                         StrokeVertex::FullMeshFormat()));
+}
+
+TEST(MeshSpecificationDataTest, CreateForInProgressStrokeWithoutTextureCoords) {
+  MeshSpecificationData data = MeshSpecificationData::CreateForInProgressStroke(
+      StrokeShaderFeatures{.texture_coordinates = false});
+  EXPECT_THAT(VaryingNames(data), Not(Contains("textureCoords")));
+  EXPECT_THAT(UniformIds(data),
+              ElementsAre(UniformId::kObjectToCanvasLinearComponent,
+                          UniformId::kBrushColor));
+  EXPECT_THAT(data.vertex_shader_source, Not(HasSubstr("textureCoords")));
+  EXPECT_THAT(data.fragment_shader_source, HasSubstr("void main"));
+}
+
+TEST(MeshSpecificationDataTest, CreateWithTilingTextureMapping) {
+  StrokeShaderFeatures features = {
+      .texture_coordinates = true,
+      .texture_mapping = BrushPaint::TextureMapping::kTiling};
+  absl::StatusOr<MeshSpecificationData> data =
+      MeshSpecificationData::CreateForStroke(StrokeVertex::FullMeshFormat(),
+                                             features);
+  ASSERT_THAT(data, IsOk());
+  EXPECT_THAT(VaryingNames(*data), Contains("textureCoords"));
+  EXPECT_THAT(UniformIds(*data),
+              AllOf(Not(Contains(UniformId::kTextureMapping)),
+                    Not(Contains(UniformId::kTextureAnimationProgress))));
+  EXPECT_THAT(data->vertex_shader_source,
+              Not(HasSubstr("textureCoords = calculateStampingTextureUv")));
+
+  MeshSpecificationData in_progress_data =
+      MeshSpecificationData::CreateForInProgressStroke(features);
+  EXPECT_THAT(UniformIds(in_progress_data),
+              ElementsAre(UniformId::kObjectToCanvasLinearComponent,
+                          UniformId::kBrushColor));
+}
+
+TEST(MeshSpecificationDataTest, CreateWithStampingTextureMapping) {
+  StrokeShaderFeatures features = {
+      .texture_coordinates = true,
+      .texture_mapping = BrushPaint::TextureMapping::kStamping};
+  absl::StatusOr<MeshSpecificationData> data =
+      MeshSpecificationData::CreateForStroke(StrokeVertex::FullMeshFormat(),
+                                             features);
+  ASSERT_THAT(data, IsOk());
+  EXPECT_THAT(UniformIds(*data),
+              AllOf(Not(Contains(UniformId::kTextureMapping)),
+                    Contains(UniformId::kTextureAnimationProgress)));
+  EXPECT_THAT(data->vertex_shader_source, Not(HasSubstr("uTextureMapping")));
+
+  MeshSpecificationData in_progress_data =
+      MeshSpecificationData::CreateForInProgressStroke(features);
+  EXPECT_THAT(UniformIds(in_progress_data),
+              AllOf(Not(Contains(UniformId::kTextureMapping)),
+                    Contains(UniformId::kTextureAnimationProgress)));
+  EXPECT_THAT(in_progress_data.vertex_shader_source,
+              HasSubstr("textureCoords = calculateStampingTextureUv"));
+}
+
 }  // namespace
 }  // namespace ink::skia_common_internal
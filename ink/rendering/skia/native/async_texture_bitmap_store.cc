@@ -0,0 +1,109 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/async_texture_bitmap_store.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "ink/types/executor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink {
+
+struct AsyncTextureBitmapStore::State {
+  explicit State(Loader loader, OnLoaded on_loaded)
+      : loader(std::move(loader)), on_loaded(std::move(on_loaded)) {}
+
+  // Returns true if the texture for `texture_id` had not been requested yet,
+  // in which case the caller must schedule its load.
+  bool StartLoad(absl::string_view texture_id) {
+    absl::MutexLock lock(&mutex);
+    return results.try_emplace(texture_id, std::nullopt).second;
+  }
+
+  void Load(absl::string_view texture_id) {
+    absl::StatusOr<sk_sp<SkImage>> image = loader(texture_id);
+    if (image.ok() && *image == nullptr) {
+      image = absl::NotFoundError(
+          absl::StrCat("Texture loader returned null for: ", texture_id));
+    }
+    {
+      absl::MutexLock lock(&mutex);
+      results[texture_id] = std::move(image);
+    }
+    absl::MutexLock lock(&on_loaded_mutex);
+    if (on_loaded != nullptr) on_loaded(texture_id);
+  }
+
+  const Loader loader;
+
+  absl::Mutex mutex;
+  // The result of each requested texture, or `std::nullopt` while it is still
+  // loading.
+  absl::flat_hash_map<std::string,
+                      std::optional<absl::StatusOr<sk_sp<SkImage>>>>
+      results ABSL_GUARDED_BY(mutex);
+
+  // Held while calling `on_loaded`, so that the store can reset it when it is
+  // destroyed without racing with a call. This is separate from `mutex` so
+  // that `on_loaded` can request textures.
+  absl::Mutex on_loaded_mutex;
+  OnLoaded on_loaded ABSL_GUARDED_BY(on_loaded_mutex);
+};
+
+AsyncTextureBitmapStore::AsyncTextureBitmapStore(
+    Executor* absl_nonnull executor, Loader loader, OnLoaded on_loaded)
+    : executor_(executor),
+      state_(std::make_shared<State>(std::move(loader),
+                                     std::move(on_loaded))) {}
+
+AsyncTextureBitmapStore::~AsyncTextureBitmapStore() {
+  absl::MutexLock lock(&state_->on_loaded_mutex);
+  state_->on_loaded = nullptr;
+}
+
+absl::StatusOr<sk_sp<SkImage>> AsyncTextureBitmapStore::GetTextureBitmap(
+    absl::string_view texture_id) const {
+  Preload(texture_id);
+  // The executor may have already run the load synchronously.
+  absl::MutexLock lock(&state_->mutex);
+  const std::optional<absl::StatusOr<sk_sp<SkImage>>>& result =
+      state_->results.at(texture_id);
+  if (!result.has_value()) {
+    return absl::UnavailableError(
+        absl::StrCat("Texture is still loading: ", texture_id));
+  }
+  return *result;
+}
+
+void AsyncTextureBitmapStore::Preload(absl::string_view texture_id) const {
+  if (!state_->StartLoad(texture_id)) return;
+  executor_->Schedule([state = state_, texture_id = std::string(texture_id)] {
+    state->Load(texture_id);
+  });
+}
+
+}  // namespace ink
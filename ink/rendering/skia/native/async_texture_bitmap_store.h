@@ -0,0 +1,76 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_ASYNC_TEXTURE_BITMAP_STORE_H_
+#define INK_RENDERING_SKIA_NATIVE_ASYNC_TEXTURE_BITMAP_STORE_H_
+
+#include <memory>
+
+#include "absl/base/nullability.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ink/rendering/skia/native/texture_bitmap_store.h"
+#include "ink/types/executor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink {
+
+// A `TextureBitmapStore` that loads textures in the background, so that
+// rendering never waits on loading or decoding a texture file.
+//
+// The first request for a texture schedules a call to the `loader` on the
+// `executor`, and returns an `absl::StatusCode::kUnavailable` error until the
+// load has finished. `SkiaRenderer` draws strokes using the texture without it
+// in the meantime. Once the load finishes, `on_loaded` is called with the
+// texture ID on the executor's thread, e.g. so that the app can invalidate its
+// view, and later requests return the result of the load, including any error.
+//
+// This type is thread-safe. Loads that are still pending when the store is
+// destroyed finish without calling `on_loaded`.
+class AsyncTextureBitmapStore : public TextureBitmapStore {
+ public:
+  using Loader = absl::AnyInvocable<absl::StatusOr<sk_sp<SkImage>>(
+      absl::string_view) const>;
+  using OnLoaded = absl::AnyInvocable<void(absl::string_view) const>;
+
+  // The `executor` must outlive every load that it is asked to run. The
+  // `loader` and `on_loaded` may be called concurrently for different texture
+  // IDs, and `on_loaded` must not destroy the store.
+  AsyncTextureBitmapStore(Executor* absl_nonnull executor, Loader loader,
+                          OnLoaded on_loaded = nullptr);
+
+  AsyncTextureBitmapStore(const AsyncTextureBitmapStore&) = delete;
+  AsyncTextureBitmapStore& operator=(const AsyncTextureBitmapStore&) = delete;
+  ~AsyncTextureBitmapStore() override;
+
+  absl::StatusOr<sk_sp<SkImage>> GetTextureBitmap(
+      absl::string_view texture_id) const override;
+
+  // Schedules loading the texture for `texture_id` if it hasn't been requested
+  // yet, e.g. for every texture of a document's brushes while it is opened.
+  void Preload(absl::string_view texture_id) const;
+
+ private:
+  struct State;
+
+  Executor* absl_nonnull executor_;
+  // Shared with pending loads, which may outlive the store.
+  absl_nonnull std::shared_ptr<State> state_;
+};
+
+}  // namespace ink
+
+#endif  // INK_RENDERING_SKIA_NATIVE_ASYNC_TEXTURE_BITMAP_STORE_H_
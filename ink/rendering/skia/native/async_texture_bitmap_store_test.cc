@@ -0,0 +1,145 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/async_texture_bitmap_store.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ink/types/executor.h"
+#include "ink/types/test_executor.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+sk_sp<SkImage> MakeTestImage() {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(2, 1);
+  bitmap.eraseColor(SK_ColorWHITE);
+  bitmap.setImmutable();
+  return bitmap.asImage();
+}
+
+TEST(AsyncTextureBitmapStoreTest, ReturnsUnavailableUntilLoaded) {
+  ManualExecutor executor;
+  sk_sp<SkImage> image = MakeTestImage();
+  std::vector<std::string> loaded;
+  AsyncTextureBitmapStore store(
+      &executor, [&image](absl::string_view) { return image; },
+      [&loaded](absl::string_view id) { loaded.emplace_back(id); });
+
+  absl::StatusOr<sk_sp<SkImage>> result = store.GetTextureBitmap("a");
+  EXPECT_EQ(result.status().code(), absl::StatusCode::kUnavailable);
+  EXPECT_THAT(result.status().message(), HasSubstr("a"));
+  EXPECT_EQ(executor.PendingTaskCount(), 1);
+
+  // Asking again while the load is pending doesn't schedule another one.
+  EXPECT_EQ(store.GetTextureBitmap("a").status().code(),
+            absl::StatusCode::kUnavailable);
+  EXPECT_EQ(executor.PendingTaskCount(), 1);
+  EXPECT_THAT(loaded, IsEmpty());
+
+  executor.RunScheduledTasks();
+  EXPECT_THAT(loaded, ElementsAre("a"));
+  result = store.GetTextureBitmap("a");
+  ASSERT_EQ(result.status(), absl::OkStatus());
+  EXPECT_EQ(*result, image);
+  EXPECT_EQ(executor.PendingTaskCount(), 0);
+}
+
+TEST(AsyncTextureBitmapStoreTest, LoaderErrorIsReturnedAfterLoad) {
+  ManualExecutor executor;
+  AsyncTextureBitmapStore store(&executor, [](absl::string_view id) {
+    return absl::StatusOr<sk_sp<SkImage>>(absl::NotFoundError(id));
+  });
+  EXPECT_EQ(store.GetTextureBitmap("missing").status().code(),
+            absl::StatusCode::kUnavailable);
+  executor.RunScheduledTasks();
+  EXPECT_EQ(store.GetTextureBitmap("missing").status(),
+            absl::NotFoundError("missing"));
+}
+
+TEST(AsyncTextureBitmapStoreTest, NullImageIsAnError) {
+  ManualExecutor executor;
+  AsyncTextureBitmapStore store(
+      &executor, [](absl::string_view) { return sk_sp<SkImage>(); });
+  store.Preload("a");
+  executor.RunScheduledTasks();
+  EXPECT_EQ(store.GetTextureBitmap("a").status().code(),
+            absl::StatusCode::kNotFound);
+}
+
+TEST(AsyncTextureBitmapStoreTest, PreloadSchedulesEachTextureOnce) {
+  ManualExecutor executor;
+  int load_count = 0;
+  AsyncTextureBitmapStore store(&executor,
+                                [&load_count](absl::string_view) {
+                                  ++load_count;
+                                  return MakeTestImage();
+                                });
+  store.Preload("a");
+  store.Preload("b");
+  store.Preload("a");
+  EXPECT_EQ(executor.PendingTaskCount(), 2);
+  executor.RunScheduledTasks();
+  EXPECT_EQ(load_count, 2);
+  EXPECT_EQ(store.GetTextureBitmap("a").status(), absl::OkStatus());
+  EXPECT_EQ(store.GetTextureBitmap("b").status(), absl::OkStatus());
+  EXPECT_EQ(load_count, 2);
+}
+
+TEST(AsyncTextureBitmapStoreTest, SynchronousExecutorLoadsOnFirstRequest) {
+  // The default `Executor::Schedule()` runs the task right away.
+  class InlineExecutor : public Executor {
+   public:
+    void ParallelFor(size_t count,
+                     absl::FunctionRef<void(size_t)> task) override {
+      for (size_t i = 0; i < count; ++i) task(i);
+    }
+  };
+  InlineExecutor executor;
+  AsyncTextureBitmapStore store(
+      &executor, [](absl::string_view) { return MakeTestImage(); });
+  EXPECT_EQ(store.GetTextureBitmap("a").status(), absl::OkStatus());
+}
+
+TEST(AsyncTextureBitmapStoreTest, LoadFinishingAfterDestructionIsIgnored) {
+  ManualExecutor executor;
+  int on_loaded_count = 0;
+  {
+    AsyncTextureBitmapStore store(
+        &executor, [](absl::string_view) { return MakeTestImage(); },
+        [&on_loaded_count](absl::string_view) { ++on_loaded_count; });
+    store.Preload("a");
+  }
+  executor.RunScheduledTasks();
+  EXPECT_EQ(on_loaded_count, 0);
+}
+
+}  // namespace
+}  // namespace ink
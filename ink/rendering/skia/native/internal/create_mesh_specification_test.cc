@@ -22,6 +22,7 @@
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "ink/brush/brush_paint.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/rendering/skia/common_internal/mesh_specification_data.h"
 #include "ink/strokes/internal/stroke_vertex.h"
@@ -32,6 +33,7 @@ namespace ink::skia_native_internal {
 namespace {
 
 using ::ink::skia_common_internal::MeshSpecificationData;
+using ::ink::skia_common_internal::StrokeShaderFeatures;
 using ::ink::strokes_internal::StrokeVertex;
 using ::testing::HasSubstr;
 using ::testing::NotNull;
@@ -54,6 +56,38 @@ TEST(CreateMeshSpecificationTest, MakeForStrokeWithFullMeshFormat) {
   EXPECT_THAT(*specification, Pointer(NotNull()));
 }
 
+std::vector<StrokeShaderFeatures> AllPaintFeatures() {
+  return {StrokeShaderFeatures{.texture_coordinates = false},
+          StrokeShaderFeatures{
+              .texture_coordinates = true,
+              .texture_mapping = BrushPaint::TextureMapping::kTiling},
+          StrokeShaderFeatures{
+              .texture_coordinates = true,
+              .texture_mapping = BrushPaint::TextureMapping::kStamping}};
+}
+
+TEST(CreateMeshSpecificationTest, MakeForInProgressStrokeWithPaintFeatures) {
+  for (const StrokeShaderFeatures& features : AllPaintFeatures()) {
+    absl::StatusOr<sk_sp<SkMeshSpecification>> specification =
+        CreateMeshSpecification(
+            MeshSpecificationData::CreateForInProgressStroke(features));
+    ASSERT_EQ(specification.status(), absl::OkStatus());
+    EXPECT_THAT(*specification, Pointer(NotNull()));
+  }
+}
+
+TEST(CreateMeshSpecificationTest, MakeForStrokeWithPaintFeatures) {
+  for (const StrokeShaderFeatures& features : AllPaintFeatures()) {
+    absl::StatusOr<MeshSpecificationData> data =
+        MeshSpecificationData::CreateForStroke(StrokeVertex::FullMeshFormat(),
+                                               features);
+    ASSERT_EQ(data.status(), absl::OkStatus());
+    auto specification = CreateMeshSpecification(*data);
+    ASSERT_EQ(specification.status(), absl::OkStatus());
+    EXPECT_THAT(*specification, Pointer(NotNull()));
+  }
+}
+
 // Returns a format identical to `starting_format` except that an attribute with
 // `attribute_id_to_skip` will be removed.
 MeshFormat MakeFormatWithSkippedAttribute(
@@ -0,0 +1,117 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/growable_mesh_buffers.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkRefCnt.h"
+#include "include/gpu/ganesh/GrDirectContext.h"
+#include "include/gpu/ganesh/SkMeshGanesh.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+// Skia requires buffer update offsets and sizes to be multiples of 4 bytes.
+constexpr size_t kAlignment = 4;
+
+size_t AlignDown(size_t size) { return size / kAlignment * kAlignment; }
+size_t AlignUp(size_t size) { return AlignDown(size + kAlignment - 1); }
+
+template <typename Buffer>
+sk_sp<Buffer> MakeBuffer(GrDirectContext* absl_nullable context, size_t size) {
+  if constexpr (std::is_same_v<Buffer, SkMesh::VertexBuffer>) {
+    return SkMeshes::MakeVertexBuffer(context, nullptr, size);
+  } else {
+    return SkMeshes::MakeIndexBuffer(context, nullptr, size);
+  }
+}
+
+// Makes `buffer` hold `data`, of which the first `unchanged_bytes` are already
+// in the buffer, reallocating it with at least twice its previous capacity if
+// it is too small. Adds the number of bytes written to `upload_bytes`.
+template <typename Buffer>
+absl::Status UpdateBuffer(GrDirectContext* absl_nullable context,
+                          absl::Span<const std::byte> data,
+                          size_t unchanged_bytes, sk_sp<Buffer>& buffer,
+                          std::vector<std::byte>& padded_tail,
+                          size_t& upload_bytes) {
+  size_t aligned_size = AlignUp(data.size());
+  if (aligned_size == 0) return absl::OkStatus();
+
+  if (buffer == nullptr || buffer->size() < aligned_size) {
+    size_t capacity =
+        buffer == nullptr ? aligned_size
+                          : std::max(aligned_size, AlignUp(2 * buffer->size()));
+    buffer = MakeBuffer<Buffer>(context, capacity);
+    if (buffer == nullptr) {
+      return absl::InternalError(
+          absl::StrCat("Failed to allocate a mesh buffer of ", capacity,
+                       " bytes"));
+    }
+    unchanged_bytes = 0;
+  }
+
+  if (unchanged_bytes >= data.size()) return absl::OkStatus();
+  size_t offset = AlignDown(unchanged_bytes);
+  const void* source = data.data() + offset;
+  if (aligned_size != data.size()) {
+    padded_tail.assign(data.begin() + offset, data.end());
+    padded_tail.resize(aligned_size - offset);
+    source = padded_tail.data();
+  }
+  if (!buffer->update(context, source, offset, aligned_size - offset)) {
+    return absl::InternalError(
+        absl::StrCat("Failed to update ", aligned_size - offset,
+                     " bytes of a mesh buffer at offset ", offset));
+  }
+  upload_bytes += aligned_size - offset;
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status GrowableMeshBuffers::Update(
+    GrDirectContext* absl_nullable context,
+    absl::Span<const std::byte> vertex_data, size_t unchanged_vertex_bytes,
+    absl::Span<const std::byte> index_data, size_t unchanged_index_bytes) {
+  if (context != context_) {
+    vertex_buffer_ = nullptr;
+    index_buffer_ = nullptr;
+    context_ = context;
+  }
+  last_upload_bytes_ = 0;
+  absl::Status status =
+      UpdateBuffer(context, vertex_data, unchanged_vertex_bytes, vertex_buffer_,
+                   padded_tail_, last_upload_bytes_);
+  if (status.ok()) {
+    status = UpdateBuffer(context, index_data, unchanged_index_bytes,
+                          index_buffer_, padded_tail_, last_upload_bytes_);
+  }
+  if (!status.ok()) {
+    vertex_buffer_ = nullptr;
+    index_buffer_ = nullptr;
+  }
+  return status;
+}
+
+}  // namespace ink::skia_native_internal
@@ -0,0 +1,89 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_INTERNAL_GROWABLE_MESH_BUFFERS_H_
+#define INK_RENDERING_SKIA_NATIVE_INTERNAL_GROWABLE_MESH_BUFFERS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkRefCnt.h"
+#include "include/gpu/ganesh/GrDirectContext.h"
+
+namespace ink::skia_native_internal {
+
+// A vertex buffer and an index buffer for a mesh that is mostly modified at
+// its end, such as the mesh of one coat of an `InProgressStroke`.
+//
+// The buffers are allocated with spare capacity, which grows geometrically,
+// and each update only writes the data that has changed since the previous
+// one. This keeps the upload cost of each frame proportional to the amount of
+// new geometry, rather than to the size of the whole mesh.
+//
+// Copies share the same underlying buffers.
+class GrowableMeshBuffers {
+ public:
+  GrowableMeshBuffers() = default;
+  GrowableMeshBuffers(const GrowableMeshBuffers&) = default;
+  GrowableMeshBuffers(GrowableMeshBuffers&&) = default;
+  GrowableMeshBuffers& operator=(const GrowableMeshBuffers&) = default;
+  GrowableMeshBuffers& operator=(GrowableMeshBuffers&&) = default;
+  ~GrowableMeshBuffers() = default;
+
+  // Updates the buffers to hold `vertex_data` and `index_data`, given that the
+  // first `unchanged_vertex_bytes` and `unchanged_index_bytes` are the same as
+  // in the previous call. Either count may exceed the size of its data.
+  //
+  // A buffer is reallocated, and filled with all of its data, if it is too
+  // small, or if `context` differs from the one used in the previous call.
+  // Buffers are CPU-backed if `context` is null.
+  //
+  // Returns an error if Skia fails to create or update a buffer, in which case
+  // the buffers are reset, so that the next call uploads all of the data.
+  absl::Status Update(GrDirectContext* absl_nullable context,
+                      absl::Span<const std::byte> vertex_data,
+                      size_t unchanged_vertex_bytes,
+                      absl::Span<const std::byte> index_data,
+                      size_t unchanged_index_bytes);
+
+  // Returns the buffers, which are null before the first successful call to
+  // `Update()`. They may be larger than the data most recently passed in.
+  const sk_sp<SkMesh::VertexBuffer>& VertexBuffer() const {
+    return vertex_buffer_;
+  }
+  const sk_sp<SkMesh::IndexBuffer>& IndexBuffer() const {
+    return index_buffer_;
+  }
+
+  // Returns the number of bytes written to the buffers by the most recent call
+  // to `Update()`.
+  size_t LastUploadBytes() const { return last_upload_bytes_; }
+
+ private:
+  GrDirectContext* absl_nullable context_ = nullptr;
+  sk_sp<SkMesh::VertexBuffer> vertex_buffer_;
+  sk_sp<SkMesh::IndexBuffer> index_buffer_;
+  size_t last_upload_bytes_ = 0;
+  // Holds the end of the data to upload when its size is not a multiple of
+  // the 4-byte alignment that Skia requires, so that it can be zero-padded.
+  std::vector<std::byte> padded_tail_;
+};
+
+}  // namespace ink::skia_native_internal
+
+#endif  // INK_RENDERING_SKIA_NATIVE_INTERNAL_GROWABLE_MESH_BUFFERS_H_
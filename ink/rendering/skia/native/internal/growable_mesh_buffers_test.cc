@@ -0,0 +1,130 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/growable_mesh_buffers.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "include/core/SkMesh.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+std::vector<std::byte> MakeData(size_t size) {
+  std::vector<std::byte> data(size);
+  for (size_t i = 0; i < size; ++i) data[i] = static_cast<std::byte>(i);
+  return data;
+}
+
+TEST(GrowableMeshBuffersTest, DefaultConstructedHasNoBuffers) {
+  GrowableMeshBuffers buffers;
+  EXPECT_EQ(buffers.VertexBuffer(), nullptr);
+  EXPECT_EQ(buffers.IndexBuffer(), nullptr);
+  EXPECT_EQ(buffers.LastUploadBytes(), 0u);
+}
+
+TEST(GrowableMeshBuffersTest, FirstUpdateUploadsAllData) {
+  GrowableMeshBuffers buffers;
+  std::vector<std::byte> vertices = MakeData(64);
+  std::vector<std::byte> indices = MakeData(12);
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 0, indices, 0),
+            absl::OkStatus());
+  ASSERT_NE(buffers.VertexBuffer(), nullptr);
+  ASSERT_NE(buffers.IndexBuffer(), nullptr);
+  EXPECT_EQ(buffers.VertexBuffer()->size(), 64u);
+  EXPECT_EQ(buffers.IndexBuffer()->size(), 12u);
+  EXPECT_EQ(buffers.LastUploadBytes(), 76u);
+}
+
+TEST(GrowableMeshBuffersTest, PadsDataToFourBytes) {
+  GrowableMeshBuffers buffers;
+  std::vector<std::byte> vertices = MakeData(64);
+  // Index data for a single triangle with 16-bit indices.
+  std::vector<std::byte> indices = MakeData(6);
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 0, indices, 0),
+            absl::OkStatus());
+  EXPECT_EQ(buffers.IndexBuffer()->size(), 8u);
+  EXPECT_EQ(buffers.LastUploadBytes(), 72u);
+}
+
+TEST(GrowableMeshBuffersTest, AppendingWithinCapacityUploadsOnlyTheTail) {
+  GrowableMeshBuffers buffers;
+  std::vector<std::byte> vertices = MakeData(64);
+  std::vector<std::byte> indices = MakeData(12);
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 0, indices, 0),
+            absl::OkStatus());
+
+  // Growing past the initial size reallocates with double the capacity.
+  vertices = MakeData(96);
+  indices = MakeData(18);
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 64, indices, 12),
+            absl::OkStatus());
+  sk_sp<SkMesh::VertexBuffer> vertex_buffer = buffers.VertexBuffer();
+  sk_sp<SkMesh::IndexBuffer> index_buffer = buffers.IndexBuffer();
+  EXPECT_EQ(vertex_buffer->size(), 128u);
+  EXPECT_EQ(index_buffer->size(), 24u);
+  EXPECT_EQ(buffers.LastUploadBytes(), 96u + 20u);
+
+  // Further appends fit in the spare capacity, so the buffers are kept and
+  // only the changed bytes are written, starting from a 4-byte boundary.
+  vertices = MakeData(112);
+  indices = MakeData(24);
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 96, indices, 18),
+            absl::OkStatus());
+  EXPECT_EQ(buffers.VertexBuffer(), vertex_buffer);
+  EXPECT_EQ(buffers.IndexBuffer(), index_buffer);
+  EXPECT_EQ(buffers.LastUploadBytes(), 16u + 8u);
+}
+
+TEST(GrowableMeshBuffersTest, UnchangedDataUploadsNothing) {
+  GrowableMeshBuffers buffers;
+  std::vector<std::byte> vertices = MakeData(64);
+  std::vector<std::byte> indices = MakeData(12);
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 0, indices, 0),
+            absl::OkStatus());
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 1000, indices, 1000),
+            absl::OkStatus());
+  EXPECT_EQ(buffers.LastUploadBytes(), 0u);
+}
+
+TEST(GrowableMeshBuffersTest, ShrinkingKeepsBuffers) {
+  GrowableMeshBuffers buffers;
+  std::vector<std::byte> vertices = MakeData(64);
+  std::vector<std::byte> indices = MakeData(12);
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 0, indices, 0),
+            absl::OkStatus());
+  sk_sp<SkMesh::VertexBuffer> vertex_buffer = buffers.VertexBuffer();
+
+  vertices = MakeData(32);
+  indices = MakeData(6);
+  ASSERT_EQ(buffers.Update(nullptr, vertices, 16, indices, 6),
+            absl::OkStatus());
+  EXPECT_EQ(buffers.VertexBuffer(), vertex_buffer);
+  EXPECT_EQ(buffers.LastUploadBytes(), 16u);
+}
+
+TEST(GrowableMeshBuffersTest, EmptyDataUploadsNothing) {
+  GrowableMeshBuffers buffers;
+  ASSERT_EQ(buffers.Update(nullptr, {}, 0, {}, 0), absl::OkStatus());
+  EXPECT_EQ(buffers.VertexBuffer(), nullptr);
+  EXPECT_EQ(buffers.IndexBuffer(), nullptr);
+  EXPECT_EQ(buffers.LastUploadBytes(), 0u);
+}
+
+}  // namespace
+}  // namespace ink::skia_native_internal
@@ -0,0 +1,207 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/mesh_buffer_cache.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/types/span.h"
+#include "ink/geometry/mesh.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkRefCnt.h"
+#include "include/gpu/ganesh/GrDirectContext.h"
+#include "include/gpu/ganesh/SkMeshGanesh.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+// Skia requires buffer update offsets and sizes to be multiples of 4 bytes.
+constexpr size_t kAlignment = 4;
+
+size_t AlignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+MeshBufferCache::Buffers MakeOwnBuffers(GrDirectContext* absl_nullable context,
+                                        const Mesh& mesh) {
+  absl::Span<const std::byte> vertex_data = mesh.RawVertexData();
+  absl::Span<const std::byte> index_data = mesh.RawIndexData();
+  return {
+      .vertex_buffer = SkMeshes::MakeVertexBuffer(context, vertex_data.data(),
+                                                  vertex_data.size()),
+      .index_buffer = SkMeshes::MakeIndexBuffer(context, index_data.data(),
+                                                index_data.size()),
+  };
+}
+
+// Writes `data` to `buffer` at `offset`, which is aligned, zero-padding the end
+// of the data up to the alignment that Skia requires. The buffer must have
+// room for the padding.
+template <typename Buffer>
+bool Upload(GrDirectContext* absl_nullable context, Buffer& buffer,
+            size_t offset, absl::Span<const std::byte> data) {
+  size_t aligned_size = data.size() / kAlignment * kAlignment;
+  if (aligned_size != 0 &&
+      !buffer.update(context, data.data(), offset, aligned_size)) {
+    return false;
+  }
+  if (aligned_size == data.size()) return true;
+  std::array<std::byte, kAlignment> padded_tail = {};
+  std::memcpy(padded_tail.data(), data.data() + aligned_size,
+              data.size() - aligned_size);
+  return buffer.update(context, padded_tail.data(), offset + aligned_size,
+                       kAlignment);
+}
+
+}  // namespace
+
+MeshBufferCache::Buffers MeshBufferCache::GetOrCreate(
+    GrDirectContext* absl_nullable context, const Mesh& mesh) {
+  if (context != context_ ||
+      (context_ != nullptr && context_->abandoned())) {
+    Clear();
+    context_ = context;
+  }
+
+  absl::Span<const std::byte> vertex_data = mesh.RawVertexData();
+  absl::Span<const std::byte> index_data = mesh.RawIndexData();
+  if (auto it = entries_by_data_.find(vertex_data.data());
+      it != entries_by_data_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->buffers;
+  }
+
+  size_t bytes = vertex_data.size() + index_data.size();
+  if (vertex_data.empty() || bytes > max_bytes_) {
+    return MakeOwnBuffers(context, mesh);
+  }
+
+  EvictToFit(max_bytes_ - bytes);
+  Entry entry = {.mesh = mesh, .bytes = bytes};
+  if (!Suballocate(entry)) entry.buffers = MakeOwnBuffers(context, mesh);
+  entries_.push_front(std::move(entry));
+  entries_by_data_[vertex_data.data()] = entries_.begin();
+  total_bytes_ += bytes;
+  return entries_.front().buffers;
+}
+
+void MeshBufferCache::SetMaxBytes(size_t max_bytes) {
+  max_bytes_ = max_bytes;
+  EvictToFit(max_bytes_);
+}
+
+void MeshBufferCache::Clear() {
+  entries_by_data_.clear();
+  entries_.clear();
+  slabs_.clear();
+  total_bytes_ = 0;
+}
+
+bool MeshBufferCache::Suballocate(Entry& entry) {
+  absl::Span<const std::byte> vertex_data = entry.mesh.RawVertexData();
+  absl::Span<const std::byte> index_data = entry.mesh.RawIndexData();
+  // `SkMesh` requires the vertex offset to be a multiple of the vertex stride.
+  size_t vertex_alignment = std::lcm(kAlignment, entry.mesh.VertexStride());
+  size_t vertex_bytes = AlignUp(vertex_data.size(), kAlignment);
+  size_t index_bytes = AlignUp(index_data.size(), kAlignment);
+  if (vertex_bytes > kSlabVertexBytes / kMaxSuballocationFraction ||
+      index_bytes > kSlabIndexBytes / kMaxSuballocationFraction) {
+    return false;
+  }
+
+  Slab* slab = slabs_.empty() ? nullptr : &slabs_.back();
+  size_t vertex_offset = 0;
+  if (slab != nullptr) {
+    vertex_offset = AlignUp(slab->used_vertex_bytes, vertex_alignment);
+    if (vertex_offset + vertex_bytes > kSlabVertexBytes ||
+        slab->used_index_bytes + index_bytes > kSlabIndexBytes) {
+      slab = nullptr;
+    }
+  }
+  if (slab == nullptr) {
+    sk_sp<SkMesh::VertexBuffer> vertex_buffer =
+        SkMeshes::MakeVertexBuffer(context_, nullptr, kSlabVertexBytes);
+    sk_sp<SkMesh::IndexBuffer> index_buffer =
+        SkMeshes::MakeIndexBuffer(context_, nullptr, kSlabIndexBytes);
+    if (vertex_buffer == nullptr || index_buffer == nullptr) return false;
+    slab = &slabs_.emplace_back(Slab{.vertex_buffer = std::move(vertex_buffer),
+                                     .index_buffer = std::move(index_buffer)});
+    vertex_offset = 0;
+  }
+
+  size_t index_offset = slab->used_index_bytes;
+  if (!Upload(context_, *slab->vertex_buffer, vertex_offset, vertex_data) ||
+      !Upload(context_, *slab->index_buffer, index_offset, index_data)) {
+    if (slab->entry_count == 0) slabs_.pop_back();
+    return false;
+  }
+
+  size_t slab_bytes = vertex_offset + vertex_bytes - slab->used_vertex_bytes +
+                      index_bytes;
+  slab->used_vertex_bytes = vertex_offset + vertex_bytes;
+  slab->used_index_bytes = index_offset + index_bytes;
+  slab->live_bytes += slab_bytes;
+  slab->entry_count += 1;
+  entry.buffers = {.vertex_buffer = slab->vertex_buffer,
+                   .index_buffer = slab->index_buffer,
+                   .vertex_offset = vertex_offset,
+                   .index_offset = index_offset};
+  entry.slab = slab;
+  entry.slab_bytes = slab_bytes;
+  return true;
+}
+
+void MeshBufferCache::ReleaseFromSlab(const Entry& entry) {
+  Slab* slab = entry.slab;
+  if (slab == nullptr) return;
+  slab->live_bytes -= entry.slab_bytes;
+  slab->entry_count -= 1;
+  if (slab->entry_count == 0) {
+    slabs_.remove_if([slab](const Slab& s) { return &s == slab; });
+  } else if (slab != &slabs_.back() &&
+             2 * slab->live_bytes <
+                 slab->used_vertex_bytes + slab->used_index_bytes) {
+    Compact(*slab);
+  }
+}
+
+void MeshBufferCache::Compact(Slab& slab) {
+  for (Entry& entry : entries_) {
+    if (entry.slab != &slab) continue;
+    // The mesh fit in a slab before, so this only fails if Skia does.
+    if (!Suballocate(entry)) {
+      entry.buffers = MakeOwnBuffers(context_, entry.mesh);
+      entry.slab = nullptr;
+      entry.slab_bytes = 0;
+    }
+  }
+  slabs_.remove_if([&slab](const Slab& s) { return &s == &slab; });
+}
+
+void MeshBufferCache::EvictToFit(size_t max_bytes) {
+  while (total_bytes_ > max_bytes) {
+    Entry entry = std::move(entries_.back());
+    entries_.pop_back();
+    entries_by_data_.erase(entry.mesh.RawVertexData().data());
+    total_bytes_ -= entry.bytes;
+    ReleaseFromSlab(entry);
+  }
+}
+
+}  // namespace ink::skia_native_internal
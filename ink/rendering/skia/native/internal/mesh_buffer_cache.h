@@ -0,0 +1,171 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_INTERNAL_MESH_BUFFER_CACHE_H_
+#define INK_RENDERING_SKIA_NATIVE_INTERNAL_MESH_BUFFER_CACHE_H_
+
+#include <cstddef>
+#include <list>
+
+#include "absl/base/nullability.h"
+#include "absl/container/flat_hash_map.h"
+#include "ink/geometry/mesh.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkRefCnt.h"
+#include "include/gpu/ganesh/GrDirectContext.h"
+
+namespace ink::skia_native_internal {
+
+// A bounded cache of the Skia vertex and index buffers created for immutable
+// `Mesh` objects.
+//
+// A `Mesh` shares its data between copies and never changes, so its buffers
+// only need to be uploaded once. Entries are keyed on the identity of the
+// mesh's data, and each entry holds a copy of its `Mesh`, so that the data
+// cannot be freed and its address reused while the entry exists.
+//
+// Most meshes are small, so rather than creating a pair of buffers for each
+// one, the cache suballocates them from a pool of large shared buffers
+// ("slabs"), and returns the offsets of each mesh's data within them. Meshes
+// that would take up more than `kMaxSuballocationFraction` of a slab get
+// buffers of their own.
+//
+// A slab is filled from front to back, and space in it is never reused, since
+// drawables created earlier may still refer to the data of evicted entries.
+// Instead, when eviction leaves less than half of the used space of a slab
+// live, the slab is compacted: its remaining entries are copied into the
+// newest slab, and the cache drops the slab. Its buffers are freed once no
+// drawable refers to them anymore.
+//
+// Buffers belong to the `GrDirectContext` that created them, so the cache is
+// cleared whenever it is used with a different context than before, or once
+// its context has been abandoned.
+//
+// The cache counts the bytes of vertex and index data in its entries, and
+// evicts the least recently used entries to stay within `MaxBytes()`. The
+// unused and evicted space in the slabs is not counted; it is at most about
+// one slab, plus half of each of the others.
+//
+// This type is thread-compatible, and must only be used on the thread on which
+// its context is active.
+class MeshBufferCache {
+ public:
+  struct Buffers {
+    sk_sp<SkMesh::VertexBuffer> vertex_buffer;
+    sk_sp<SkMesh::IndexBuffer> index_buffer;
+    // The offsets, in bytes, of the mesh's data in the buffers above, which may
+    // be shared with other meshes; see `SkMesh::MakeIndexed()`.
+    size_t vertex_offset = 0;
+    size_t index_offset = 0;
+  };
+
+  // The sizes of the vertex and index buffers of each slab.
+  static constexpr size_t kSlabVertexBytes = 256 * 1024;
+  static constexpr size_t kSlabIndexBytes = 128 * 1024;
+  // Meshes whose vertex or index data is larger than this fraction of the
+  // corresponding slab buffer get buffers of their own.
+  static constexpr size_t kMaxSuballocationFraction = 4;
+
+  explicit MeshBufferCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+  MeshBufferCache(const MeshBufferCache&) = delete;
+  MeshBufferCache(MeshBufferCache&&) = default;
+  MeshBufferCache& operator=(const MeshBufferCache&) = delete;
+  MeshBufferCache& operator=(MeshBufferCache&&) = default;
+  ~MeshBufferCache() = default;
+
+  // Returns the buffers holding the vertex and index data of `mesh`, marking
+  // them as the most recently used entry. On a miss, the data is uploaded to a
+  // slab, or to new buffers, created with `context`, and added to the cache,
+  // then entries are evicted as needed to stay within `MaxBytes()`. Buffers
+  // for a mesh with no vertices, or that are larger than `MaxBytes()` on their
+  // own, are created but not cached.
+  //
+  // If `context` is null, the buffers are CPU-backed.
+  Buffers GetOrCreate(GrDirectContext* absl_nullable context, const Mesh& mesh);
+
+  // Sets the maximum number of bytes used by entries, evicting the least
+  // recently used entries if needed.
+  void SetMaxBytes(size_t max_bytes);
+  size_t MaxBytes() const { return max_bytes_; }
+
+  // Returns the number of bytes of vertex and index data in all entries.
+  size_t TotalBytes() const { return total_bytes_; }
+
+  // Returns the number of entries currently in the cache.
+  size_t EntryCount() const { return entries_.size(); }
+
+  // Returns the number of slabs currently held by the cache.
+  size_t SlabCount() const { return slabs_.size(); }
+
+  // Removes all entries.
+  void Clear();
+
+ private:
+  struct Slab {
+    sk_sp<SkMesh::VertexBuffer> vertex_buffer;
+    sk_sp<SkMesh::IndexBuffer> index_buffer;
+    // The number of bytes at the front of each buffer that have been handed
+    // out, including padding.
+    size_t used_vertex_bytes = 0;
+    size_t used_index_bytes = 0;
+    // The number of bytes, including padding, handed out to entries that are
+    // still in the cache.
+    size_t live_bytes = 0;
+    size_t entry_count = 0;
+  };
+
+  struct Entry {
+    // Keeps the mesh data, and so the key, alive.
+    Mesh mesh;
+    Buffers buffers;
+    size_t bytes;
+    // The slab that holds the entry's data, or null if it has buffers of its
+    // own.
+    Slab* absl_nullable slab = nullptr;
+    // The number of bytes of `slab`, including padding, that the entry uses.
+    size_t slab_bytes = 0;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  // Uploads the data of `entry.mesh` to the newest slab, or to a new slab if it
+  // doesn't fit, and points `entry` at it. Returns false, leaving `entry`
+  // unchanged, if the mesh is too large to be suballocated or Skia fails to
+  // create or update a buffer.
+  bool Suballocate(Entry& entry);
+
+  // Accounts for `entry` leaving its slab, and releases or compacts the slab
+  // if that leaves it mostly unused.
+  void ReleaseFromSlab(const Entry& entry);
+
+  // Moves the entries of `slab` into the newest slab, and drops `slab`.
+  void Compact(Slab& slab);
+
+  void EvictToFit(size_t max_bytes);
+
+  size_t max_bytes_;
+  size_t total_bytes_ = 0;
+  GrDirectContext* absl_nullable context_ = nullptr;
+  // Entries ordered from most to least recently used.
+  EntryList entries_;
+  // Maps the address of each entry's vertex data to the entry.
+  absl::flat_hash_map<const std::byte*, EntryList::iterator> entries_by_data_;
+  // Slabs ordered from oldest to newest. Only the newest slab is allocated
+  // from.
+  std::list<Slab> slabs_;
+};
+
+}  // namespace ink::skia_native_internal
+
+#endif  // INK_RENDERING_SKIA_NATIVE_INTERNAL_MESH_BUFFER_CACHE_H_
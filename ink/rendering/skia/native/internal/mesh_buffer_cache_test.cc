@@ -0,0 +1,209 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/mesh_buffer_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+Mesh MakeTestMesh(uint32_t n_triangles) {
+  return MakeStraightLinePartitionedMesh(n_triangles).Meshes().front();
+}
+
+size_t MeshBytes(const Mesh& mesh) {
+  return mesh.RawVertexData().size() + mesh.RawIndexData().size();
+}
+
+bool SameVertexData(const MeshBufferCache::Buffers& a,
+                    const MeshBufferCache::Buffers& b) {
+  return a.vertex_buffer == b.vertex_buffer &&
+         a.vertex_offset == b.vertex_offset;
+}
+
+TEST(MeshBufferCacheTest, ReusesBuffersForSameMeshData) {
+  MeshBufferCache cache(1024 * 1024);
+  Mesh mesh = MakeTestMesh(4);
+
+  MeshBufferCache::Buffers first = cache.GetOrCreate(nullptr, mesh);
+  ASSERT_NE(first.vertex_buffer, nullptr);
+  ASSERT_NE(first.index_buffer, nullptr);
+  EXPECT_EQ(cache.EntryCount(), 1u);
+  EXPECT_EQ(cache.TotalBytes(), MeshBytes(mesh));
+
+  // A copy of a `Mesh` shares its data, and so its buffers.
+  Mesh copy = mesh;
+  MeshBufferCache::Buffers second = cache.GetOrCreate(nullptr, copy);
+  EXPECT_EQ(second.vertex_buffer, first.vertex_buffer);
+  EXPECT_EQ(second.index_buffer, first.index_buffer);
+  EXPECT_EQ(cache.EntryCount(), 1u);
+}
+
+TEST(MeshBufferCacheTest, SuballocatesSmallMeshesFromSharedBuffers) {
+  MeshBufferCache cache(1024 * 1024);
+  Mesh mesh_a = MakeTestMesh(4);
+  Mesh mesh_b = MakeTestMesh(4);
+
+  MeshBufferCache::Buffers a = cache.GetOrCreate(nullptr, mesh_a);
+  MeshBufferCache::Buffers b = cache.GetOrCreate(nullptr, mesh_b);
+  EXPECT_EQ(a.vertex_buffer, b.vertex_buffer);
+  EXPECT_EQ(a.index_buffer, b.index_buffer);
+  EXPECT_EQ(a.vertex_offset, 0u);
+  EXPECT_EQ(a.index_offset, 0u);
+  EXPECT_GE(b.vertex_offset, mesh_a.RawVertexData().size());
+  EXPECT_EQ(b.vertex_offset % mesh_b.VertexStride(), 0u);
+  EXPECT_GE(b.index_offset, mesh_a.RawIndexData().size());
+  EXPECT_EQ(b.index_offset % 4, 0u);
+  EXPECT_EQ(cache.EntryCount(), 2u);
+  EXPECT_EQ(cache.SlabCount(), 1u);
+  EXPECT_EQ(cache.TotalBytes(), MeshBytes(mesh_a) + MeshBytes(mesh_b));
+}
+
+TEST(MeshBufferCacheTest, CreatesOwnBuffersForLargeMeshes) {
+  MeshBufferCache cache(16 * 1024 * 1024);
+  Mesh small_mesh = MakeTestMesh(4);
+  Mesh large_mesh = MakeTestMesh(20000);
+  ASSERT_GT(large_mesh.RawIndexData().size(),
+            MeshBufferCache::kSlabIndexBytes /
+                MeshBufferCache::kMaxSuballocationFraction);
+
+  MeshBufferCache::Buffers small = cache.GetOrCreate(nullptr, small_mesh);
+  MeshBufferCache::Buffers large = cache.GetOrCreate(nullptr, large_mesh);
+  EXPECT_NE(large.vertex_buffer, small.vertex_buffer);
+  EXPECT_EQ(large.vertex_offset, 0u);
+  EXPECT_EQ(large.index_offset, 0u);
+  EXPECT_EQ(cache.EntryCount(), 2u);
+  EXPECT_EQ(cache.SlabCount(), 1u);
+  EXPECT_TRUE(SameVertexData(cache.GetOrCreate(nullptr, large_mesh), large));
+}
+
+TEST(MeshBufferCacheTest, CompactsSlabsOnEviction) {
+  MeshBufferCache cache(16 * 1024 * 1024);
+  // Fill the first slab, until a mesh spills over into a second one.
+  std::vector<Mesh> meshes;
+  while (cache.SlabCount() < 2) {
+    meshes.push_back(MakeTestMesh(4));
+    cache.GetOrCreate(nullptr, meshes.back());
+  }
+  ASSERT_GT(meshes.size(), 4u);
+  sk_sp<SkMesh::VertexBuffer> first_slab =
+      cache.GetOrCreate(nullptr, meshes.front()).vertex_buffer;
+  sk_sp<SkMesh::VertexBuffer> second_slab =
+      cache.GetOrCreate(nullptr, meshes.back()).vertex_buffer;
+  ASSERT_NE(first_slab, second_slab);
+
+  // Use the last few meshes of the first slab again, and then evict all but
+  // those, which leaves the first slab mostly unused.
+  size_t kept_count = 3;
+  size_t kept_bytes = MeshBytes(meshes.back());
+  for (size_t i = meshes.size() - 1 - kept_count; i < meshes.size() - 1; ++i) {
+    EXPECT_EQ(cache.GetOrCreate(nullptr, meshes[i]).vertex_buffer, first_slab);
+    kept_bytes += MeshBytes(meshes[i]);
+  }
+  cache.GetOrCreate(nullptr, meshes.back());
+  cache.SetMaxBytes(kept_bytes);
+  EXPECT_EQ(cache.EntryCount(), kept_count + 1);
+
+  // The remaining entries of the first slab were moved to the second one.
+  EXPECT_EQ(cache.SlabCount(), 1u);
+  for (size_t i = meshes.size() - 1 - kept_count; i < meshes.size(); ++i) {
+    EXPECT_EQ(cache.GetOrCreate(nullptr, meshes[i]).vertex_buffer,
+              second_slab);
+  }
+  EXPECT_EQ(cache.EntryCount(), kept_count + 1);
+}
+
+TEST(MeshBufferCacheTest, ReleasesEmptySlabs) {
+  MeshBufferCache cache(1024 * 1024);
+  Mesh mesh = MakeTestMesh(4);
+  cache.GetOrCreate(nullptr, mesh);
+  ASSERT_EQ(cache.SlabCount(), 1u);
+
+  cache.SetMaxBytes(0);
+  EXPECT_EQ(cache.SlabCount(), 0u);
+}
+
+TEST(MeshBufferCacheTest, EvictsLeastRecentlyUsedEntries) {
+  Mesh mesh_a = MakeTestMesh(4);
+  Mesh mesh_b = MakeTestMesh(4);
+  Mesh mesh_c = MakeTestMesh(4);
+  MeshBufferCache cache(MeshBytes(mesh_a) + MeshBytes(mesh_b));
+
+  MeshBufferCache::Buffers a = cache.GetOrCreate(nullptr, mesh_a);
+  MeshBufferCache::Buffers b = cache.GetOrCreate(nullptr, mesh_b);
+  // Use `mesh_a` again, so that `mesh_b` is the least recently used.
+  cache.GetOrCreate(nullptr, mesh_a);
+  cache.GetOrCreate(nullptr, mesh_c);
+  EXPECT_EQ(cache.EntryCount(), 2u);
+
+  EXPECT_TRUE(SameVertexData(cache.GetOrCreate(nullptr, mesh_a), a));
+  EXPECT_FALSE(SameVertexData(cache.GetOrCreate(nullptr, mesh_b), b));
+}
+
+TEST(MeshBufferCacheTest, DoesNotCacheMeshesLargerThanMaxBytes) {
+  Mesh mesh = MakeTestMesh(4);
+  MeshBufferCache cache(MeshBytes(mesh) - 1);
+
+  MeshBufferCache::Buffers first = cache.GetOrCreate(nullptr, mesh);
+  EXPECT_NE(first.vertex_buffer, nullptr);
+  EXPECT_EQ(cache.EntryCount(), 0u);
+  EXPECT_NE(cache.GetOrCreate(nullptr, mesh).vertex_buffer,
+            first.vertex_buffer);
+}
+
+TEST(MeshBufferCacheTest, ZeroMaxBytesDisablesCaching) {
+  MeshBufferCache cache(0);
+  Mesh mesh = MakeTestMesh(4);
+
+  EXPECT_NE(cache.GetOrCreate(nullptr, mesh).vertex_buffer, nullptr);
+  EXPECT_EQ(cache.EntryCount(), 0u);
+  EXPECT_EQ(cache.TotalBytes(), 0u);
+}
+
+TEST(MeshBufferCacheTest, SetMaxBytesEvicts) {
+  MeshBufferCache cache(1024 * 1024);
+  Mesh mesh_a = MakeTestMesh(4);
+  Mesh mesh_b = MakeTestMesh(4);
+  cache.GetOrCreate(nullptr, mesh_a);
+  cache.GetOrCreate(nullptr, mesh_b);
+
+  cache.SetMaxBytes(MeshBytes(mesh_b));
+  EXPECT_EQ(cache.MaxBytes(), MeshBytes(mesh_b));
+  EXPECT_EQ(cache.EntryCount(), 1u);
+  EXPECT_EQ(cache.TotalBytes(), MeshBytes(mesh_b));
+}
+
+TEST(MeshBufferCacheTest, Clear) {
+  MeshBufferCache cache(1024 * 1024);
+  Mesh mesh = MakeTestMesh(4);
+  MeshBufferCache::Buffers first = cache.GetOrCreate(nullptr, mesh);
+
+  cache.Clear();
+  EXPECT_EQ(cache.EntryCount(), 0u);
+  EXPECT_EQ(cache.TotalBytes(), 0u);
+  EXPECT_NE(cache.GetOrCreate(nullptr, mesh).vertex_buffer,
+            first.vertex_buffer);
+}
+
+}  // namespace
+}  // namespace ink::skia_native_internal
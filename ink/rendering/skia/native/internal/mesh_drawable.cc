@@ -14,6 +14,7 @@
 
 #include "ink/rendering/skia/native/internal/mesh_drawable.h"
 
+#include <cstddef>
 #include <optional>
 #include <utility>
 
@@ -23,21 +24,27 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/rendering/skia/native/internal/mesh_uniform_data.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkBlender.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
+#include "include/core/SkData.h"
 #include "include/core/SkMesh.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/effects/SkImageFilters.h"
 
 namespace ink::skia_native_internal {
 namespace {
 
-// Calls `SkMesh::MakeIndexed()` with a default mode and offsets.
+// Calls `SkMesh::MakeIndexed()` with a default mode.
 //
 // This wrapper helps to make it clear that certain parameters are the same for
 // both initial validation and drawing.
@@ -46,21 +53,20 @@ SkMesh::Result MakeSkiaMesh(sk_sp<SkMeshSpecification> specification,
                             sk_sp<const SkData> uniforms) {
   return SkMesh::MakeIndexed(std::move(specification), SkMesh::Mode::kTriangles,
                              partition.vertex_buffer, partition.vertex_count,
-                             /* vertexOffset = */ 0, partition.index_buffer,
-                             partition.index_count,
-                             /* indexOffset = */ 0, std::move(uniforms),
+                             partition.vertex_offset, partition.index_buffer,
+                             partition.index_count, partition.index_offset,
+                             std::move(uniforms),
                              /* children= */ {}, partition.bounds);
 }
 
-// Validates that `SkMesh::MakeIndexed()` will succeed for every partition.
-//
-// Creating an `SkMesh` is a relatively inexpensive operation that is
-// analogous to gathering every setting for the graphics pipeline, so we are
-// ok creating the `SkMesh` and "throwing away" the results here.
-absl::Status ValidatePartitions(
+// Returns the `SkMesh` of every partition, or an invalid-argument error if
+// `SkMesh::MakeIndexed()` fails for any of them.
+absl::StatusOr<absl::InlinedVector<SkMesh, 1>> MakeValidatedMeshes(
     sk_sp<SkMeshSpecification> specification,
     absl::Span<const MeshDrawable::Partition> partitions,
     sk_sp<const SkData> uniform_data) {
+  absl::InlinedVector<SkMesh, 1> meshes;
+  meshes.reserve(partitions.size());
   for (const MeshDrawable::Partition& partition : partitions) {
     ABSL_CHECK_NE(partition.vertex_buffer, nullptr);
     ABSL_CHECK_NE(partition.index_buffer, nullptr);
@@ -72,9 +78,10 @@ absl::Status ValidatePartitions(
           "`SkMesh::MakeIndex()` returned error: ",
           absl::string_view(result.error.data(), result.error.size())));
     }
+    meshes.push_back(std::move(result.mesh));
   }
 
-  return absl::OkStatus();
+  return meshes;
 }
 
 }  // namespace
@@ -88,22 +95,82 @@ absl::StatusOr<MeshDrawable> MeshDrawable::Create(
   MeshUniformData uniform_data = starting_uniforms.has_value()
                                      ? *std::move(starting_uniforms)
                                      : MeshUniformData(*specification);
-  absl::Status status =
-      ValidatePartitions(specification, partitions, uniform_data.Get());
-  if (!status.ok()) return status;
+  absl::StatusOr<absl::InlinedVector<SkMesh, 1>> meshes =
+      MakeValidatedMeshes(specification, partitions, uniform_data.Get());
+  if (!meshes.ok()) return meshes.status();
 
   return MeshDrawable(std::move(specification), std::move(blender),
                       std::move(shader), std::move(partitions),
-                      std::move(uniform_data));
+                      *std::move(meshes), std::move(uniform_data));
+}
+
+void MeshDrawable::SetBrushColor(const Color& color) {
+  MeshUniformData uniform_data = uniform_data_;
+  uniform_data.SetBrushColor(color);
+  UpdateUniformData(std::move(uniform_data));
+}
+
+void MeshDrawable::SetTextureMapping(BrushPaint::TextureMapping mapping) {
+  MeshUniformData uniform_data = uniform_data_;
+  uniform_data.SetTextureMapping(mapping);
+  UpdateUniformData(std::move(uniform_data));
+}
+
+void MeshDrawable::SetTextureAnimation(const BrushPaint::TextureLayer& layer) {
+  MeshUniformData uniform_data = uniform_data_;
+  uniform_data.SetTextureAnimationFrames(
+      layer.animation_frames, layer.animation_rows, layer.animation_columns);
+  uniform_data.SetTextureAnimationProgress(0);
+  texture_animation_duration_ = layer.animation_frames > 1
+                                    ? layer.animation_duration
+                                    : absl::ZeroDuration();
+  UpdateUniformData(std::move(uniform_data));
+}
+
+void MeshDrawable::SetTextureAnimationTime(absl::Duration time) {
+  if (texture_animation_duration_ <= absl::ZeroDuration()) return;
+  absl::Duration elapsed = time % texture_animation_duration_;
+  if (elapsed < absl::ZeroDuration()) elapsed += texture_animation_duration_;
+  MeshUniformData uniform_data = uniform_data_;
+  uniform_data.SetTextureAnimationProgress(static_cast<float>(
+      absl::FDivDuration(elapsed, texture_animation_duration_)));
+  UpdateUniformData(std::move(uniform_data));
+}
+
+void MeshDrawable::SetObjectToCanvas(const AffineTransform& transform) {
+  MeshUniformData uniform_data = uniform_data_;
+  uniform_data.SetObjectToCanvasLinearComponent(transform);
+  UpdateUniformData(std::move(uniform_data));
+}
+
+void MeshDrawable::UpdateUniformData(MeshUniformData uniform_data) {
+  // The copy of `uniform_data_` that was modified shares its data with the
+  // original and with `meshes_` until a uniform actually changes.
+  if (uniform_data.Get() == uniform_data_.Get()) return;
+
+  uniform_data_ = std::move(uniform_data);
+  sk_sp<const SkData> data = uniform_data_.Get();
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    // Only the uniform values differ from the meshes validated by `Create()`,
+    // so this always succeeds.
+    meshes_[i] = MakeSkiaMesh(specification_, partitions_[i], data).mesh;
+    ABSL_DCHECK(meshes_[i].isValid());
+  }
+}
+
+SkRect MeshDrawable::Bounds() const {
+  SkRect bounds = SkRect::MakeEmpty();
+  for (const Partition& partition : partitions_) {
+    bounds.join(partition.bounds);
+  }
+  return bounds;
 }
 
-void MeshDrawable::Draw(SkCanvas& canvas) const {
-  // We do not cache an `SkMesh` for each partition inside of the drawable
-  // object. Instead, we create them on the stack inside this function, because:
-  //   * Creating an `SkMesh` is a light-weight operation.
-  //   * The `SkMesh` must be recreated if any uniform values must change.
-  //   * In order to support shader-based antialiasing, we will need to update
-  //     a uniform value anytime the object-to-canvas transformation changes.
+MeshDrawable::DrawCounts MeshDrawable::Draw(SkCanvas& canvas) const {
+  // The `SkMesh` of each partition is created up front, and recreated only when
+  // a uniform value changes, since `SkMesh::MakeIndexed()` validates all of its
+  // arguments every time. Drawing unchanged uniforms, e.g. while panning, only
+  // records the draws.
 
   // TODO: b/267164444 - Use shader uniforms instead of `SkPaint`, once that's
   // exposed on Android. (We could do it here in the native renderer right now,
@@ -122,21 +189,29 @@ void MeshDrawable::Draw(SkCanvas& canvas) const {
   paint.setShader(shader_);
   paint.setColor(SK_ColorWHITE);
   paint.setImageFilter(image_filter_);
-  sk_sp<const SkData> uniform_data = uniform_data_.Get();
-  for (const Partition& partition : partitions_) {
-    SkMesh mesh = MakeSkiaMesh(specification_, partition, uniform_data).mesh;
-    canvas.drawMesh(mesh, blender_, paint);
+  DrawCounts counts;
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    // `quickReject()` tests against the clip using the current matrix.
+    if (image_filter_ == nullptr && canvas.quickReject(partitions_[i].bounds)) {
+      ++counts.culled_partitions;
+      continue;
+    }
+    canvas.drawMesh(meshes_[i], blender_, paint);
+    ++counts.drawn_partitions;
   }
+  return counts;
 }
 
 MeshDrawable::MeshDrawable(sk_sp<SkMeshSpecification> specification,
                            sk_sp<SkBlender> blender, sk_sp<SkShader> shader,
                            absl::InlinedVector<Partition, 1> partitions,
+                           absl::InlinedVector<SkMesh, 1> meshes,
                            MeshUniformData uniform_data)
     : specification_(std::move(specification)),
       blender_(std::move(blender)),
       shader_(std::move(shader)),
       partitions_(std::move(partitions)),
+      meshes_(std::move(meshes)),
       uniform_data_(std::move(uniform_data)) {}
 
 }  // namespace ink::skia_native_internal
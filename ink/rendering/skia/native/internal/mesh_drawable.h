@@ -15,12 +15,14 @@
 #ifndef INK_RENDERING_SKIA_NATIVE_INTERNAL_MESH_DRAWABLE_H_
 #define INK_RENDERING_SKIA_NATIVE_INTERNAL_MESH_DRAWABLE_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "ink/brush/brush_paint.h"
 #include "ink/color/color.h"
 #include "ink/geometry/affine_transform.h"
@@ -46,13 +48,16 @@ class MeshDrawable {
   // A single partition of the mesh.
   //
   // The members correspond to a subset of parameters of `SkMesh::MakeIndexed()`
-  // with implicit `Mode::kTriangles` and vertex and index offsets of 0.
+  // with implicit `Mode::kTriangles`. The offsets are nonzero when the buffers
+  // are shared with other meshes; see `MeshBufferCache`.
   struct Partition {
     sk_sp<SkMesh::VertexBuffer> vertex_buffer;
     sk_sp<SkMesh::IndexBuffer> index_buffer;
     int32_t vertex_count;
     int32_t index_count;
     SkRect bounds;
+    size_t vertex_offset = 0;
+    size_t index_offset = 0;
   };
 
   // Creates and returns a new `MeshDrawable` with the given `specification`,
@@ -79,6 +84,10 @@ class MeshDrawable {
 
   // Sets the value of the brush-color uniform.
   //
+  // Like the other uniform setters below, this recreates the `SkMesh` of each
+  // partition with the new uniform values, unless the uniform already has the
+  // given value. Drawing only reuses those meshes.
+  //
   // CHECK-fails if the drawable was created with an `SkMeshSpecification` that
   // does not have this uniform.
   void SetBrushColor(const Color& color);
@@ -98,6 +107,24 @@ class MeshDrawable {
   // different texture mapping modes in a single `BrushPaint`.
   void SetTextureMapping(BrushPaint::TextureMapping mapping);
 
+  // Returns true if the drawable has the texture-animation uniforms.
+  bool HasTextureAnimation() const;
+
+  // Sets the frame layout of the texture-animation uniforms from `layer`, and
+  // keeps its `animation_duration` for `SetTextureAnimationTime()`. Animation
+  // is disabled if `layer.animation_frames` is 1.
+  //
+  // CHECK-fails if the drawable was created with an `SkMeshSpecification` that
+  // does not have these uniforms.
+  void SetTextureAnimation(const BrushPaint::TextureLayer& layer);
+
+  // Sets the texture-animation progress uniform for the given animation clock
+  // `time`, which wraps around every `animation_duration` of the layer passed
+  // to `SetTextureAnimation()`. The frame of each particle is then selected in
+  // the shaders, offset by its per-vertex animation offset, so that animating
+  // a drawable needs no mesh updates. Does nothing if animation is disabled.
+  void SetTextureAnimationTime(absl::Duration time);
+
   // Returns true if the drawable has an object-to-canvas uniform.
   bool HasObjectToCanvas() const;
 
@@ -109,20 +136,43 @@ class MeshDrawable {
 
   void SetImageFilter(sk_sp<SkImageFilter> image_filter);
 
+  // Returns the union of the bounds of every partition.
+  SkRect Bounds() const;
+
+  // The number of partitions that were drawn by a call to `Draw()`, and the
+  // number that were skipped because they were outside of the canvas clip.
+  struct DrawCounts {
+    int drawn_partitions = 0;
+    int culled_partitions = 0;
+  };
+
   // Draws the mesh-drawable into the provided `canvas`.
-  void Draw(SkCanvas& canvas) const;
+  //
+  // Partitions whose bounds are outside of the clip of the `canvas`, given its
+  // current matrix, are skipped. This is not done if the drawable has an image
+  // filter, which may draw outside of the bounds.
+  DrawCounts Draw(SkCanvas& canvas) const;
 
  private:
   MeshDrawable(sk_sp<SkMeshSpecification> specification,
                sk_sp<SkBlender> blender, sk_sp<SkShader> shader,
                absl::InlinedVector<Partition, 1> partitions,
+               absl::InlinedVector<SkMesh, 1> meshes,
                MeshUniformData uniform_data);
 
+  // Replaces `uniform_data_` with `uniform_data` and recreates `meshes_` with
+  // it, unless it holds the same data.
+  void UpdateUniformData(MeshUniformData uniform_data);
+
   sk_sp<SkMeshSpecification> specification_;
   sk_sp<SkBlender> blender_;
   sk_sp<SkShader> shader_;
   absl::InlinedVector<Partition, 1> partitions_;
+  // The `SkMesh` of each partition, made with the current `uniform_data_`.
+  absl::InlinedVector<SkMesh, 1> meshes_;
   MeshUniformData uniform_data_;
+  // The period of the texture animation, or zero if it is disabled.
+  absl::Duration texture_animation_duration_ = absl::ZeroDuration();
   sk_sp<SkImageFilter> image_filter_;
 };
 
@@ -133,27 +183,18 @@ inline bool MeshDrawable::HasBrushColor() const {
   return uniform_data_.HasBrushColor();
 }
 
-inline void MeshDrawable::SetBrushColor(const Color& color) {
-  uniform_data_.SetBrushColor(color);
-}
-
 inline bool MeshDrawable::HasTextureMapping() const {
   return uniform_data_.HasTextureMapping();
 }
 
-inline void MeshDrawable::SetTextureMapping(
-    BrushPaint::TextureMapping mapping) {
-  uniform_data_.SetTextureMapping(mapping);
+inline bool MeshDrawable::HasTextureAnimation() const {
+  return uniform_data_.HasTextureAnimation();
 }
 
 inline bool MeshDrawable::HasObjectToCanvas() const {
   return uniform_data_.HasObjectToCanvasLinearComponent();
 }
 
-inline void MeshDrawable::SetObjectToCanvas(const AffineTransform& transform) {
-  uniform_data_.SetObjectToCanvasLinearComponent(transform);
-}
-
 inline void MeshDrawable::SetImageFilter(sk_sp<SkImageFilter> image_filter) {
   image_filter_ = image_filter;
 }
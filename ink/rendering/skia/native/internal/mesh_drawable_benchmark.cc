@@ -0,0 +1,112 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/rendering/skia/common_internal/mesh_specification_data.h"
+#include "ink/rendering/skia/native/internal/create_mesh_specification.h"
+#include "ink/rendering/skia/native/internal/mesh_drawable.h"
+#include "ink/strokes/internal/stroke_vertex.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+using ::ink::skia_common_internal::MeshSpecificationData;
+using ::ink::strokes_internal::StrokeVertex;
+
+// Returns a drawable for a full-format `Stroke` mesh, which has the brush-color
+// and object-to-canvas uniforms, with `partition_count` placeholder partitions
+// with CPU-backed buffers.
+MeshDrawable MakeStrokeDrawable(int64_t partition_count) {
+  absl::StatusOr<MeshSpecificationData> data =
+      MeshSpecificationData::CreateForStroke(StrokeVertex::FullMeshFormat());
+  ABSL_CHECK_OK(data);
+  absl::StatusOr<sk_sp<SkMeshSpecification>> spec =
+      CreateMeshSpecification(*data);
+  ABSL_CHECK_OK(spec);
+
+  int32_t vertex_count = 300;
+  int32_t index_count = 900;
+  std::vector<std::byte> vertex_data(vertex_count * (*spec)->stride());
+  std::vector<std::byte> index_data(index_count * sizeof(uint16_t));
+  absl::InlinedVector<MeshDrawable::Partition, 1> partitions;
+  for (int64_t i = 0; i < partition_count; ++i) {
+    partitions.push_back({
+        .vertex_buffer =
+            SkMeshes::MakeVertexBuffer(vertex_data.data(), vertex_data.size()),
+        .index_buffer =
+            SkMeshes::MakeIndexBuffer(index_data.data(), index_data.size()),
+        .vertex_count = vertex_count,
+        .index_count = index_count,
+        .bounds = SkRect::MakeLTRB(0, 0, 100, 100),
+    });
+  }
+  absl::StatusOr<MeshDrawable> drawable =
+      MeshDrawable::Create(*std::move(spec), /* blender= */ nullptr,
+                           /* shader= */ nullptr, std::move(partitions));
+  ABSL_CHECK_OK(drawable);
+  return *std::move(drawable);
+}
+
+// The benchmarks below draw into a canvas without pixels, so that only the work
+// done by `MeshDrawable` itself is measured.
+
+// Setting the uniforms to the values they already have, as happens when
+// redrawing or panning over a retained drawable.
+void BM_DrawWithUnchangedUniforms(benchmark::State& state) {
+  MeshDrawable drawable = MakeStrokeDrawable(state.range(0));
+  // A canvas with bounds but without pixels, which discards every draw.
+  SkCanvas canvas(1000, 1000);
+  AffineTransform transform = AffineTransform::Scale(2);
+  for (auto s : state) {
+    drawable.SetObjectToCanvas(transform);
+    drawable.SetBrushColor(Color::Red());
+    benchmark::DoNotOptimize(drawable.Draw(canvas));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DrawWithUnchangedUniforms)->Arg(1)->Arg(8)->Arg(64);
+
+// Changing the object-to-canvas uniform on every draw, as happens while
+// pinch-zooming.
+void BM_DrawWithChangedTransform(benchmark::State& state) {
+  MeshDrawable drawable = MakeStrokeDrawable(state.range(0));
+  // A canvas with bounds but without pixels, which discards every draw.
+  SkCanvas canvas(1000, 1000);
+  float scale = 1;
+  for (auto s : state) {
+    scale = scale < 4 ? scale * 1.01f : 1;
+    drawable.SetObjectToCanvas(AffineTransform::Scale(scale));
+    drawable.SetBrushColor(Color::Red());
+    benchmark::DoNotOptimize(drawable.Draw(canvas));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DrawWithChangedTransform)->Arg(1)->Arg(8)->Arg(64);
+
+}  // namespace
+}  // namespace ink::skia_native_internal
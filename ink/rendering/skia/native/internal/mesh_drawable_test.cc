@@ -23,10 +23,16 @@
 #include "gtest/gtest.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/rendering/skia/common_internal/mesh_specification_data.h"
 #include "ink/rendering/skia/native/internal/create_mesh_specification.h"
 #include "ink/rendering/skia/native/internal/mesh_uniform_data.h"
 #include "ink/strokes/internal/stroke_vertex.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkMesh.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
@@ -55,7 +61,8 @@ sk_sp<SkMeshSpecification> SpecificationForFullFormatStroke() {
 }
 
 // Returns a placeholder partition with CPU-backed vertex and index buffers.
-MeshDrawable::Partition MakeNonEmptyTestPartition(int vertex_stride) {
+MeshDrawable::Partition MakeNonEmptyTestPartition(
+    int vertex_stride, const SkRect& bounds = SkRect::MakeLTRB(0, 0, 1, 1)) {
   int32_t vertex_count = 6;
   int32_t index_count = 9;
   std::vector<std::byte> placeholder_vertex_data(vertex_count * vertex_stride);
@@ -67,7 +74,7 @@ MeshDrawable::Partition MakeNonEmptyTestPartition(int vertex_stride) {
                                                 placeholder_index_data.size()),
       .vertex_count = vertex_count,
       .index_count = index_count,
-      .bounds = SkRect::MakeLTRB(0, 0, 1, 1),
+      .bounds = bounds,
   };
 }
 
@@ -75,6 +82,7 @@ TEST(MeshDrawableTest, DefaultConstructed) {
   MeshDrawable drawable;
   EXPECT_FALSE(drawable.HasObjectToCanvas());
   EXPECT_FALSE(drawable.HasBrushColor());
+  EXPECT_FALSE(drawable.HasTextureAnimation());
 }
 
 TEST(MeshDrawableTest, CreateWithoutPartitionsIsNotAnError) {
@@ -128,6 +136,99 @@ TEST(MeshDrawableTest, ReturnsSkiaError) {
               HasSubstr("`SkMesh::MakeIndex()` returned error:"));
 }
 
+TEST(MeshDrawableTest, BoundsIsUnionOfPartitionBounds) {
+  sk_sp<SkMeshSpecification> spec = SpecificationForInProgressStroke();
+  auto drawable = MeshDrawable::Create(
+      spec, /* blender= */ nullptr, /* shader= */ nullptr,
+      {MakeNonEmptyTestPartition(spec->stride(), SkRect::MakeLTRB(0, 0, 1, 1)),
+       MakeNonEmptyTestPartition(spec->stride(),
+                                 SkRect::MakeLTRB(5, -2, 6, 0))});
+  ASSERT_EQ(absl::OkStatus(), drawable.status());
+  EXPECT_EQ(drawable->Bounds(), SkRect::MakeLTRB(0, -2, 6, 1));
+  EXPECT_TRUE(MeshDrawable().Bounds().isEmpty());
+}
+
+TEST(MeshDrawableTest, DrawCullsPartitionsOutsideClip) {
+  sk_sp<SkMeshSpecification> spec = SpecificationForInProgressStroke();
+  auto drawable = MeshDrawable::Create(
+      spec, /* blender= */ nullptr, /* shader= */ nullptr,
+      {MakeNonEmptyTestPartition(spec->stride(), SkRect::MakeLTRB(0, 0, 1, 1)),
+       MakeNonEmptyTestPartition(spec->stride(),
+                                 SkRect::MakeLTRB(50, 50, 60, 60))});
+  ASSERT_EQ(absl::OkStatus(), drawable.status());
+
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(10, 10);
+  SkCanvas canvas(bitmap);
+  MeshDrawable::DrawCounts counts = drawable->Draw(canvas);
+  EXPECT_EQ(counts.drawn_partitions, 1);
+  EXPECT_EQ(counts.culled_partitions, 1);
+
+  // Culling uses the current matrix of the canvas.
+  canvas.translate(-50, -50);
+  counts = drawable->Draw(canvas);
+  EXPECT_EQ(counts.drawn_partitions, 1);
+  EXPECT_EQ(counts.culled_partitions, 1);
+  canvas.translate(100, 100);
+  counts = drawable->Draw(canvas);
+  EXPECT_EQ(counts.drawn_partitions, 0);
+  EXPECT_EQ(counts.culled_partitions, 2);
+}
+
+TEST(MeshDrawableTest, DrawAfterSettingUniforms) {
+  sk_sp<SkMeshSpecification> spec = SpecificationForFullFormatStroke();
+  auto drawable = MeshDrawable::Create(
+      spec, /* blender= */ nullptr, /* shader= */ nullptr,
+      {MakeNonEmptyTestPartition(spec->stride()),
+       MakeNonEmptyTestPartition(spec->stride())});
+  ASSERT_EQ(absl::OkStatus(), drawable.status());
+  ASSERT_TRUE(drawable->HasObjectToCanvas());
+  ASSERT_TRUE(drawable->HasBrushColor());
+
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(10, 10);
+  SkCanvas canvas(bitmap);
+  // Setting a uniform to a new value and then to the same value again.
+  for (int i = 0; i < 2; ++i) {
+    drawable->SetObjectToCanvas(AffineTransform::Scale(2));
+    drawable->SetBrushColor(Color::Red());
+    MeshDrawable::DrawCounts counts = drawable->Draw(canvas);
+    EXPECT_EQ(counts.drawn_partitions, 2);
+  }
+
+  // A copy keeps its own uniforms.
+  MeshDrawable copy = *drawable;
+  copy.SetBrushColor(Color::Blue());
+  EXPECT_EQ(copy.Draw(canvas).drawn_partitions, 2);
+  EXPECT_EQ(drawable->Draw(canvas).drawn_partitions, 2);
+}
+
+TEST(MeshDrawableTest, DrawWithTextureAnimation) {
+  sk_sp<SkMeshSpecification> spec = SpecificationForFullFormatStroke();
+  auto drawable = MeshDrawable::Create(
+      spec, /* blender= */ nullptr, /* shader= */ nullptr,
+      {MakeNonEmptyTestPartition(spec->stride())});
+  ASSERT_EQ(absl::OkStatus(), drawable.status());
+  ASSERT_TRUE(drawable->HasTextureAnimation());
+
+  drawable->SetTextureAnimation({
+      .mapping = BrushPaint::TextureMapping::kStamping,
+      .animation_frames = 6,
+      .animation_rows = 2,
+      .animation_columns = 3,
+      .animation_duration = absl::Seconds(2),
+  });
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(10, 10);
+  SkCanvas canvas(bitmap);
+  // Times before zero and past the duration wrap around.
+  for (absl::Duration time : {absl::ZeroDuration(), absl::Milliseconds(500),
+                              absl::Seconds(5), absl::Seconds(-1)}) {
+    drawable->SetTextureAnimationTime(time);
+    EXPECT_EQ(drawable->Draw(canvas).drawn_partitions, 1);
+  }
+}
+
 TEST(MeshDrawableDeathTest, CreateWithNullSpecification) {
   EXPECT_DEATH_IF_SUPPORTED(auto drawable = MeshDrawable::Create(
                                 /* specification= */ nullptr,
@@ -14,47 +14,64 @@
 
 #include "ink/rendering/skia/native/internal/mesh_specification_cache.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/base/nullability.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/partitioned_mesh.h"
 #include "ink/rendering/skia/common_internal/mesh_specification_data.h"
 #include "ink/rendering/skia/native/internal/create_mesh_specification.h"
 #include "ink/strokes/in_progress_stroke.h"
+#include "ink/types/executor.h"
 #include "include/core/SkMesh.h"
 #include "include/core/SkRefCnt.h"
 
 namespace ink::skia_native_internal {
 
 using ::ink::skia_common_internal::MeshSpecificationData;
+using ::ink::skia_common_internal::StrokeShaderFeatures;
+
+namespace {
+
+sk_sp<SkMeshSpecification> CreateSpecification(
+    const MeshSpecificationData& data) {
+  absl::StatusOr<sk_sp<SkMeshSpecification>> specification =
+      CreateMeshSpecification(data);
+  // TODO: b/284117747 - At least for now, if creating the
+  // `MeshSpecificationData` succeeded, then creating the `SkMeshSpecification`
+  // should always succeed. This may change, depending on where `BrushFamily`
+  // is used during specification creation.
+  ABSL_CHECK_OK(specification);
+  return *std::move(specification);
+}
+
+}  // namespace
+
+MeshSpecificationCache::MeshSpecificationCache()
+    : specifications_(std::make_shared<Specifications>()) {}
 
 absl::StatusOr<sk_sp<SkMeshSpecification>> MeshSpecificationCache::GetFor(
-    const InProgressStroke& stroke) {
+    const InProgressStroke& stroke,
+    const StrokeShaderFeatures& features) const {
   if (stroke.GetBrush() == nullptr) {
     return absl::InvalidArgumentError("`stroke.Start()` has not been called.");
   }
-
-  if (in_progress_stroke_specification_ == nullptr) {
-    absl::StatusOr<sk_sp<SkMeshSpecification>> specification =
-        CreateMeshSpecification(
-            MeshSpecificationData::CreateForInProgressStroke());
-    // TODO: b/284117747 - At least for now, if creating the
-    // `MeshSpecificationData` succeeded, then creating the
-    // `SkMeshSpecification` should always succeed. This may change, depending
-    // on where `BrushFamily` is used during specification creation.
-    ABSL_CHECK_OK(specification);
-    in_progress_stroke_specification_ = *std::move(specification);
-  }
-  return in_progress_stroke_specification_;
+  return GetOrCreateForInProgressStroke(*specifications_, features);
 }
 
 absl::StatusOr<sk_sp<SkMeshSpecification>> MeshSpecificationCache::GetForStroke(
-    const PartitionedMesh& stroke_shape, uint32_t coat_index) {
+    const PartitionedMesh& stroke_shape, uint32_t coat_index,
+    const StrokeShaderFeatures& features) const {
   if (stroke_shape.RenderGroupCount() <= coat_index) {
     return absl::InvalidArgumentError(absl::StrCat(
         "`stroke_shape` has only ", stroke_shape.RenderGroupCount(),
@@ -66,23 +83,103 @@ absl::StatusOr<sk_sp<SkMeshSpecification>> MeshSpecificationCache::GetForStroke(
   }
 
   const MeshFormat& format = stroke_shape.RenderGroupFormat(coat_index);
-  sk_sp<SkMeshSpecification>& cached_specification =
-      stroke_specifications_[format];
-  if (cached_specification == nullptr) {
-    absl::StatusOr<MeshSpecificationData> specification_data =
-        MeshSpecificationData::CreateForStroke(format);
-    if (!specification_data.ok()) return specification_data.status();
-
-    absl::StatusOr<sk_sp<SkMeshSpecification>> specification =
-        CreateMeshSpecification(*specification_data);
-    // TODO: b/284117747 - At least for now, if creating the
-    // `MeshSpecificationData` succeeded, then creating the
-    // `SkMeshSpecification` should always succeed. This may change, depending
-    // on where `BrushFamily` is used during specification creation.
-    ABSL_CHECK_OK(specification);
-    cached_specification = *std::move(specification);
+  {
+    absl::MutexLock lock(&specifications_->mutex);
+    auto it = specifications_->strokes.find(std::make_pair(format, features));
+    if (it != specifications_->strokes.end()) return it->second;
+  }
+
+  absl::StatusOr<MeshSpecificationData> specification_data =
+      MeshSpecificationData::CreateForStroke(format, features);
+  if (!specification_data.ok()) return specification_data.status();
+  return GetOrCreateForStroke(*specifications_, format, features,
+                              *specification_data);
+}
+
+absl::Status MeshSpecificationCache::Prewarm(
+    absl::Span<const MeshFormat> stroke_formats,
+    absl::Span<const StrokeShaderFeatures> features,
+    Executor* absl_nullable executor) {
+  // Generating the SkSL source is cheap compared to compiling it, so it is done
+  // up front to report unsupported formats.
+  struct StrokeSpecification {
+    MeshFormat format;
+    StrokeShaderFeatures features;
+    MeshSpecificationData data;
+  };
+  std::vector<StrokeSpecification> stroke_specifications;
+  stroke_specifications.reserve(stroke_formats.size() * features.size());
+  for (const MeshFormat& format : stroke_formats) {
+    for (const StrokeShaderFeatures& format_features : features) {
+      absl::StatusOr<MeshSpecificationData> specification_data =
+          MeshSpecificationData::CreateForStroke(format, format_features);
+      if (!specification_data.ok()) return specification_data.status();
+      stroke_specifications.push_back({.format = format,
+                                       .features = format_features,
+                                       .data = *std::move(specification_data)});
+    }
   }
-  return cached_specification;
+
+  auto task = [specifications = specifications_,
+               in_progress_features = std::vector<StrokeShaderFeatures>(
+                   features.begin(), features.end()),
+               stroke_specifications = std::move(stroke_specifications)]() {
+    for (const StrokeShaderFeatures& features : in_progress_features) {
+      GetOrCreateForInProgressStroke(*specifications, features);
+    }
+    for (const StrokeSpecification& stroke : stroke_specifications) {
+      GetOrCreateForStroke(*specifications, stroke.format, stroke.features,
+                           stroke.data);
+    }
+  };
+  if (executor == nullptr) {
+    task();
+  } else {
+    executor->Schedule(std::move(task));
+  }
+  return absl::OkStatus();
+}
+
+void MeshSpecificationCache::Clear() {
+  absl::MutexLock lock(&specifications_->mutex);
+  specifications_->in_progress_strokes.clear();
+  specifications_->strokes.clear();
+}
+
+sk_sp<SkMeshSpecification>
+MeshSpecificationCache::GetOrCreateForInProgressStroke(
+    Specifications& specifications, const StrokeShaderFeatures& features) {
+  {
+    absl::MutexLock lock(&specifications.mutex);
+    auto it = specifications.in_progress_strokes.find(features);
+    if (it != specifications.in_progress_strokes.end()) return it->second;
+  }
+
+  // The specification is created without holding the lock, since compiling
+  // its SkSL is slow. If another thread races to create the same one, the
+  // first to finish wins.
+  sk_sp<SkMeshSpecification> specification = CreateSpecification(
+      MeshSpecificationData::CreateForInProgressStroke(features));
+  absl::MutexLock lock(&specifications.mutex);
+  return specifications.in_progress_strokes
+      .try_emplace(features, std::move(specification))
+      .first->second;
+}
+
+sk_sp<SkMeshSpecification> MeshSpecificationCache::GetOrCreateForStroke(
+    Specifications& specifications, const MeshFormat& format,
+    const StrokeShaderFeatures& features, const MeshSpecificationData& data) {
+  {
+    absl::MutexLock lock(&specifications.mutex);
+    auto it = specifications.strokes.find(std::make_pair(format, features));
+    if (it != specifications.strokes.end()) return it->second;
+  }
+
+  sk_sp<SkMeshSpecification> specification = CreateSpecification(data);
+  absl::MutexLock lock(&specifications.mutex);
+  return specifications.strokes
+      .try_emplace(std::make_pair(format, features), std::move(specification))
+      .first->second;
 }
 
 }  // namespace ink::skia_native_internal
@@ -16,12 +16,21 @@
 #define INK_RENDERING_SKIA_NATIVE_INTERNAL_MESH_SPECIFICATION_CACHE_H_
 
 #include <cstdint>
+#include <memory>
+#include <utility>
 
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/rendering/skia/common_internal/mesh_specification_data.h"
 #include "ink/strokes/in_progress_stroke.h"
+#include "ink/types/executor.h"
 #include "include/core/SkMesh.h"
 #include "include/core/SkRefCnt.h"
 
@@ -32,42 +41,92 @@ namespace ink::skia_native_internal {
 // The specification includes a large portion of the SkSL for rendering meshes,
 // so it is an important optimization to reuse them and prevent redundant shader
 // compilation.
+//
+// This type is thread-safe, so that specifications can be looked up by
+// renderers recording on different threads, and created in the background by
+// `Prewarm()`. A specification that is missing is created without holding the
+// lock, so threads only wait for each other to look up the map.
 class MeshSpecificationCache {
  public:
   // TODO: b/284117747 - The cache should be constructible with `SkColorSpace`
   // and `SkAlphaType` information.
 
-  MeshSpecificationCache() = default;
+  MeshSpecificationCache();
   MeshSpecificationCache(const MeshSpecificationCache&) = delete;
   MeshSpecificationCache(MeshSpecificationCache&&) = default;
   MeshSpecificationCache& operator=(const MeshSpecificationCache&) = delete;
   MeshSpecificationCache& operator=(MeshSpecificationCache&&) = default;
   ~MeshSpecificationCache() = default;
 
-  // Returns the specification for an `InProgressStroke`.
+  // Returns the specification for an `InProgressStroke`, with the shader parts
+  // given by `features`. Use `StrokeShaderFeatures::ForPaint()` to get a
+  // specification with only the parts needed for a given coat's paint.
   //
   // An invalid-argument error is returned if `stroke.Start()` has not been
   // called.
   absl::StatusOr<sk_sp<SkMeshSpecification>> GetFor(
-      const InProgressStroke& stroke);
+      const InProgressStroke& stroke,
+      const skia_common_internal::StrokeShaderFeatures& features = {}) const;
 
-  // Returns the specification for a `PartitionedMesh` created for a `Stroke`.
+  // Returns the specification for a `PartitionedMesh` created for a `Stroke`,
+  // with the shader parts given by `features`.
   //
   // An invalid-argument error is returned if `stroke_shape` either has no
   // meshes, or has an unsupported `MeshFormat`.
-  // TODO: b/284117747 - Update to also take a `const BrushFamily&`.
   absl::StatusOr<sk_sp<SkMeshSpecification>> GetForStroke(
-      const PartitionedMesh& stroke_shape, uint32_t coat_index);
+      const PartitionedMesh& stroke_shape, uint32_t coat_index,
+      const skia_common_internal::StrokeShaderFeatures& features = {}) const;
+
+  // Creates the specifications for an `InProgressStroke`, and the ones for
+  // `Stroke` meshes with each of `stroke_formats`, with each of `features`,
+  // ahead of time, so that the SkSL compilation doesn't happen on the first
+  // `GetFor()` or `GetForStroke()` call that needs them.
+  //
+  // If `executor` is null, the specifications are created before returning.
+  // Otherwise, they are created in a task passed to `executor->Schedule()`, and
+  // this may return before they are ready; the cache remains usable meanwhile,
+  // and creates any specification it needs that isn't ready yet itself.
+  //
+  // An invalid-argument error is returned, and nothing is created, if any of
+  // `stroke_formats` is unsupported.
+  absl::Status Prewarm(
+      absl::Span<const MeshFormat> stroke_formats,
+      absl::Span<const skia_common_internal::StrokeShaderFeatures> features,
+      Executor* absl_nullable executor = nullptr);
+
+  // Removes every cached specification, so that each one is created again the
+  // next time it is needed. Specifications that are still referenced, e.g. by
+  // a drawable, stay alive until they are no longer used.
+  void Clear();
 
  private:
-  // TODO: b/284117747 - Update the in-progress stroke cache to a hash map if we
-  // move to using Skia shader-uniforms in C++, which means the `BrushPaint`
-  // would be included as an input to the specification. Similarly, the key to
-  // the stroke hash map would need to be made of both the `MeshFormat` and the
-  // `BrushPaint`.
-  sk_sp<SkMeshSpecification> in_progress_stroke_specification_;
-  absl::flat_hash_map<MeshFormat, sk_sp<SkMeshSpecification>>
-      stroke_specifications_;
+  // The cached specifications, which are shared with any tasks scheduled by
+  // `Prewarm()`, since those may outlive the cache.
+  struct Specifications {
+    absl::Mutex mutex;
+    absl::flat_hash_map<skia_common_internal::StrokeShaderFeatures,
+                        sk_sp<SkMeshSpecification>>
+        in_progress_strokes ABSL_GUARDED_BY(mutex);
+    absl::flat_hash_map<
+        std::pair<MeshFormat, skia_common_internal::StrokeShaderFeatures>,
+        sk_sp<SkMeshSpecification>>
+        strokes ABSL_GUARDED_BY(mutex);
+  };
+
+  // Returns the specification for an `InProgressStroke` with `features` in
+  // `specifications`, creating and adding it first if needed.
+  static sk_sp<SkMeshSpecification> GetOrCreateForInProgressStroke(
+      Specifications& specifications,
+      const skia_common_internal::StrokeShaderFeatures& features);
+
+  // Returns the specification for `Stroke` meshes with `format` and `features`
+  // in `specifications`, creating and adding it from `data` first if needed.
+  static sk_sp<SkMeshSpecification> GetOrCreateForStroke(
+      Specifications& specifications, const MeshFormat& format,
+      const skia_common_internal::StrokeShaderFeatures& features,
+      const skia_common_internal::MeshSpecificationData& data);
+
+  absl_nonnull std::shared_ptr<Specifications> specifications_;
 };
 
 }  // namespace ink::skia_native_internal
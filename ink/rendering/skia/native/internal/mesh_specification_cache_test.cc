@@ -27,18 +27,24 @@
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mesh_test_helpers.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/rendering/skia/common_internal/mesh_specification_data.h"
 #include "ink/strokes/in_progress_stroke.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/stroke_vertex.h"
 #include "ink/strokes/stroke.h"
 #include "ink/types/duration.h"
+#include "ink/types/test_executor.h"
 #include "include/core/SkMesh.h"
 #include "include/core/SkRefCnt.h"
 
 namespace ink::skia_native_internal {
 namespace {
 
+using ::ink::skia_common_internal::StrokeShaderFeatures;
+using ::ink::strokes_internal::StrokeVertex;
 using ::testing::Eq;
 using ::testing::HasSubstr;
+using ::testing::Ne;
 using ::testing::NotNull;
 using ::testing::Pointer;
 
@@ -190,5 +196,105 @@ TEST(MeshSpecificationCacheTest, GetForProvidedUnsupportedShape) {
   EXPECT_THAT(missing_required_attr.message(), HasSubstr("are required"));
 }
 
+TEST(MeshSpecificationCacheTest, GetForStrokeWithDifferentFeatures) {
+  MeshSpecificationCache cache;
+  Stroke stroke(GetTestBrush(), GetSingleValueTestBatch());
+  absl::StatusOr<sk_sp<SkMeshSpecification>> general_spec =
+      cache.GetForStroke(stroke.GetShape(), 0);
+  ASSERT_EQ(general_spec.status(), absl::OkStatus());
+  StrokeShaderFeatures untextured = {.texture_coordinates = false};
+  absl::StatusOr<sk_sp<SkMeshSpecification>> untextured_spec =
+      cache.GetForStroke(stroke.GetShape(), 0, untextured);
+  ASSERT_EQ(untextured_spec.status(), absl::OkStatus());
+  EXPECT_THAT(*untextured_spec, Pointer(NotNull()));
+  EXPECT_THAT(*untextured_spec, Ne(*general_spec));
+
+  absl::StatusOr<sk_sp<SkMeshSpecification>> second_untextured_spec =
+      cache.GetForStroke(stroke.GetShape(), 0, untextured);
+  ASSERT_EQ(second_untextured_spec.status(), absl::OkStatus());
+  EXPECT_THAT(*second_untextured_spec, Eq(*untextured_spec));
+}
+
+TEST(MeshSpecificationCacheTest, GetForInProgressStrokeWithDifferentFeatures) {
+  MeshSpecificationCache cache;
+  InProgressStroke stroke;
+  stroke.Start(GetTestBrush());
+  StrokeShaderFeatures untextured =
+      StrokeShaderFeatures::ForPaint(stroke.GetBrush()->GetCoats()[0].paint);
+  absl::StatusOr<sk_sp<SkMeshSpecification>> untextured_spec =
+      cache.GetFor(stroke, untextured);
+  ASSERT_EQ(untextured_spec.status(), absl::OkStatus());
+  absl::StatusOr<sk_sp<SkMeshSpecification>> general_spec =
+      cache.GetFor(stroke);
+  ASSERT_EQ(general_spec.status(), absl::OkStatus());
+  EXPECT_THAT(*general_spec, Ne(*untextured_spec));
+  absl::StatusOr<sk_sp<SkMeshSpecification>> second_untextured_spec =
+      cache.GetFor(stroke, untextured);
+  ASSERT_EQ(second_untextured_spec.status(), absl::OkStatus());
+  EXPECT_THAT(*second_untextured_spec, Eq(*untextured_spec));
+}
+
+TEST(MeshSpecificationCacheTest, PrewarmCreatesSpecificationsForStrokes) {
+  MeshSpecificationCache cache;
+  ASSERT_EQ(
+      cache.Prewarm({StrokeVertex::FullMeshFormat()}, {StrokeShaderFeatures()}),
+      absl::OkStatus());
+
+  Stroke stroke(GetTestBrush(), GetSingleValueTestBatch());
+  absl::StatusOr<sk_sp<SkMeshSpecification>> specification =
+      cache.GetForStroke(stroke.GetShape(), 0);
+  ASSERT_EQ(specification.status(), absl::OkStatus());
+  EXPECT_THAT(*specification, Pointer(NotNull()));
+
+  InProgressStroke in_progress_stroke;
+  in_progress_stroke.Start(GetTestBrush());
+  absl::StatusOr<sk_sp<SkMeshSpecification>> in_progress_specification =
+      cache.GetFor(in_progress_stroke);
+  ASSERT_EQ(in_progress_specification.status(), absl::OkStatus());
+  EXPECT_THAT(*in_progress_specification, Pointer(NotNull()));
+}
+
+TEST(MeshSpecificationCacheTest, PrewarmOnExecutorKeepsExistingSpecifications) {
+  MeshSpecificationCache cache;
+  ManualExecutor executor;
+  ASSERT_EQ(cache.Prewarm({StrokeVertex::FullMeshFormat()},
+                          {StrokeShaderFeatures()}, &executor),
+            absl::OkStatus());
+  EXPECT_EQ(executor.PendingTaskCount(), 1u);
+
+  // The cache is usable before the scheduled task has run.
+  Stroke stroke(GetTestBrush(), GetSingleValueTestBatch());
+  absl::StatusOr<sk_sp<SkMeshSpecification>> original_spec =
+      cache.GetForStroke(stroke.GetShape(), 0);
+  ASSERT_EQ(original_spec.status(), absl::OkStatus());
+
+  executor.RunScheduledTasks();
+  absl::StatusOr<sk_sp<SkMeshSpecification>> new_spec =
+      cache.GetForStroke(stroke.GetShape(), 0);
+  ASSERT_EQ(new_spec.status(), absl::OkStatus());
+  EXPECT_THAT(*new_spec, Eq(*original_spec));
+}
+
+TEST(MeshSpecificationCacheTest, PrewarmTaskCanOutliveCache) {
+  ManualExecutor executor;
+  {
+    MeshSpecificationCache cache;
+    ASSERT_EQ(cache.Prewarm({StrokeVertex::FullMeshFormat()},
+                            {StrokeShaderFeatures()}, &executor),
+              absl::OkStatus());
+  }
+  executor.RunScheduledTasks();
+}
+
+TEST(MeshSpecificationCacheTest, PrewarmUnsupportedFormat) {
+  MeshSpecificationCache cache;
+  ManualExecutor executor;
+  absl::Status unsupported =
+      cache.Prewarm({MeshFormat()}, {StrokeShaderFeatures()}, &executor);
+  EXPECT_EQ(unsupported.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(unsupported.message(), HasSubstr("are required"));
+  EXPECT_EQ(executor.PendingTaskCount(), 0u);
+}
+
 }  // namespace
 }  // namespace ink::skia_native_internal
@@ -14,6 +14,7 @@
 
 #include "ink/rendering/skia/native/internal/mesh_uniform_data.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <optional>
@@ -38,9 +39,23 @@ namespace {
 
 using ::ink::skia_common_internal::MeshSpecificationData;
 
-sk_sp<SkData> MakeUninitializedIfNonZeroSize(const SkMeshSpecification& spec) {
+sk_sp<SkData> MakeZeroedIfNonZeroSize(const SkMeshSpecification& spec) {
   if (spec.uniformSize() == 0) return nullptr;
-  return SkData::MakeUninitialized(spec.uniformSize());
+  return SkData::MakeZeroInitialized(spec.uniformSize());
+}
+
+// Copies `size` bytes of `value` into `data` at `offset`, first replacing
+// `data` with a copy if it is shared, e.g. with an `SkMesh`. Does nothing if
+// the bytes already hold `value`, so that `MeshUniformData::Get()` keeps
+// returning the same data, and meshes made with it can be kept, when a uniform
+// is set to the value it already has.
+void WriteUniform(sk_sp<SkData>& data, int16_t offset, const void* value,
+                  size_t size) {
+  if (std::memcmp(data->bytes() + offset, value, size) == 0) return;
+  if (!data->unique()) {
+    data = SkData::MakeWithCopy(data->bytes(), data->size());
+  }
+  std::memcpy(static_cast<char*>(data->writable_data()) + offset, value, size);
 }
 
 SkMeshSpecification::Uniform::Type ExpectedSkiaUniformType(
@@ -97,14 +112,23 @@ std::optional<MeshSpecificationData::UniformId> FindUnpackingTransformUniformId(
 }  // namespace
 
 MeshUniformData::MeshUniformData(const SkMeshSpecification& spec)
-    : data_(MakeUninitializedIfNonZeroSize(spec)),
+    : data_(MakeZeroedIfNonZeroSize(spec)),
       object_to_canvas_linear_component_offset_(FindUniformOffset(
           spec,
           MeshSpecificationData::UniformId::kObjectToCanvasLinearComponent)),
       brush_color_offset_(FindUniformOffset(
           spec, MeshSpecificationData::UniformId::kBrushColor)),
       texture_mapping_offset_(FindUniformOffset(
-          spec, MeshSpecificationData::UniformId::kTextureMapping)) {}
+          spec, MeshSpecificationData::UniformId::kTextureMapping)),
+      texture_animation_progress_offset_(FindUniformOffset(
+          spec, MeshSpecificationData::UniformId::kTextureAnimationProgress)),
+      num_texture_animation_frames_offset_(FindUniformOffset(
+          spec, MeshSpecificationData::UniformId::kNumTextureAnimationFrames)),
+      num_texture_animation_rows_offset_(FindUniformOffset(
+          spec, MeshSpecificationData::UniformId::kNumTextureAnimationRows)),
+      num_texture_animation_columns_offset_(FindUniformOffset(
+          spec,
+          MeshSpecificationData::UniformId::kNumTextureAnimationColumns)) {}
 
 namespace {
 
@@ -173,37 +197,43 @@ MeshUniformData::MeshUniformData(
 
 void MeshUniformData::SetBrushColor(const Color& color) {
   ABSL_CHECK(HasBrushColor());
-  if (!data_->unique()) {
-    data_ = SkData::MakeWithCopy(data_->bytes(), data_->size());
-  }
   Color::RgbaFloat rgba =
       color.InColorSpace(ColorSpace::kSrgb).AsFloat(Color::Format::kLinear);
   static_assert(sizeof(rgba) == 4 * sizeof(float));
-  std::memcpy(static_cast<char*>(data_->writable_data()) + brush_color_offset_,
-              &rgba, sizeof(rgba));
+  WriteUniform(data_, brush_color_offset_, &rgba, sizeof(rgba));
 }
 
 void MeshUniformData::SetTextureMapping(BrushPaint::TextureMapping mapping) {
   ABSL_CHECK(HasTextureMapping());
-  if (!data_->unique()) {
-    data_ = SkData::MakeWithCopy(data_->bytes(), data_->size());
-  }
   int mapping_int = static_cast<int>(mapping);
-  std::memcpy(
-      static_cast<char*>(data_->writable_data()) + texture_mapping_offset_,
-      &mapping_int, sizeof(int));
+  WriteUniform(data_, texture_mapping_offset_, &mapping_int, sizeof(int));
+}
+
+void MeshUniformData::SetTextureAnimationFrames(int frames, int rows,
+                                                int columns) {
+  ABSL_CHECK(HasTextureAnimation());
+  ABSL_DCHECK_GE(frames, 1);
+  ABSL_DCHECK_GE(rows, 1);
+  ABSL_DCHECK_GE(columns, 1);
+  WriteUniform(data_, num_texture_animation_frames_offset_, &frames,
+               sizeof(int));
+  WriteUniform(data_, num_texture_animation_rows_offset_, &rows, sizeof(int));
+  WriteUniform(data_, num_texture_animation_columns_offset_, &columns,
+               sizeof(int));
+}
+
+void MeshUniformData::SetTextureAnimationProgress(float progress) {
+  ABSL_CHECK(HasTextureAnimation());
+  WriteUniform(data_, texture_animation_progress_offset_, &progress,
+               sizeof(float));
 }
 
 void MeshUniformData::SetObjectToCanvasLinearComponent(
     const AffineTransform& transform) {
   ABSL_CHECK(HasObjectToCanvasLinearComponent());
-  if (!data_->unique()) {
-    data_ = SkData::MakeWithCopy(data_->bytes(), data_->size());
-  }
   float values[] = {transform.A(), transform.D(), transform.B(), transform.E()};
-  std::memcpy(static_cast<char*>(data_->writable_data()) +
-                  object_to_canvas_linear_component_offset_,
-              values, 4 * sizeof(float));
+  WriteUniform(data_, object_to_canvas_linear_component_offset_, values,
+               4 * sizeof(float));
 }
 
 }  // namespace ink::skia_native_internal
@@ -46,8 +46,8 @@ class MeshUniformData {
  public:
   // Constructs the data to hold the uniforms in `spec`.
   //
-  // This allocates the data necessary to hold uniform values, but does not set
-  // them.
+  // This allocates the data necessary to hold uniform values, but only sets
+  // them to zero.
   explicit MeshUniformData(const SkMeshSpecification& spec);
 
   // Constructs the data to hold the uniforms in `spec` and initializes the
@@ -79,15 +79,24 @@ class MeshUniformData {
   bool HasObjectToCanvasLinearComponent() const;
   bool HasBrushColor() const;
   bool HasTextureMapping() const;
+  bool HasTextureAnimation() const;
 
   // The following setters update the values for each uniform.
   //
   // A call to set a value CHECK-validates that the uniform is present, which
-  // can be verified by calling the appropriate "Has" function above.
+  // can be verified by calling the appropriate "Has" function above. Setting a
+  // uniform to the value it already has leaves the data returned by `Get()`
+  // unchanged, so callers can compare it to tell whether anything changed.
 
   void SetObjectToCanvasLinearComponent(const AffineTransform& transform);
   void SetBrushColor(const Color& color);
   void SetTextureMapping(BrushPaint::TextureMapping mapping);
+  // Sets the layout of the animation frames in the texture atlas, which must
+  // each be at least 1.
+  void SetTextureAnimationFrames(int frames, int rows, int columns);
+  // Sets the animation progress of the whole mesh, in [0, 1), to which the
+  // per-vertex animation offset is added.
+  void SetTextureAnimationProgress(float progress);
 
   // Returns the data for `SkMesh` creation. This function returns `nullptr` if
   // this uniform data was either default-constructed, or constructed from a
@@ -106,6 +115,10 @@ class MeshUniformData {
   int16_t object_to_canvas_linear_component_offset_ = -1;
   int16_t brush_color_offset_ = -1;
   int16_t texture_mapping_offset_ = -1;
+  int16_t texture_animation_progress_offset_ = -1;
+  int16_t num_texture_animation_frames_offset_ = -1;
+  int16_t num_texture_animation_rows_offset_ = -1;
+  int16_t num_texture_animation_columns_offset_ = -1;
 };
 
 // ---------------------------------------------------------------------------
@@ -123,6 +136,13 @@ inline bool MeshUniformData::HasTextureMapping() const {
   return texture_mapping_offset_ != -1;
 }
 
+inline bool MeshUniformData::HasTextureAnimation() const {
+  return texture_animation_progress_offset_ != -1 &&
+         num_texture_animation_frames_offset_ != -1 &&
+         num_texture_animation_rows_offset_ != -1 &&
+         num_texture_animation_columns_offset_ != -1;
+}
+
 }  // namespace ink::skia_native_internal
 
 #endif  // INK_RENDERING_SKIA_NATIVE_INTERNAL_MESH_UNIFORM_DATA_H_
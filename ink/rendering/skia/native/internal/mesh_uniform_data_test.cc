@@ -44,6 +44,7 @@ TEST(MeshUniformDataTest, DefaultConstructed) {
 
   EXPECT_FALSE(data.HasObjectToCanvasLinearComponent());
   EXPECT_FALSE(data.HasBrushColor());
+  EXPECT_FALSE(data.HasTextureAnimation());
   EXPECT_EQ(data.Get(), nullptr);
 }
 
@@ -210,6 +211,10 @@ TEST(MeshUniformDataTest, WithBrushColor) {
   EXPECT_THAT(GetStoredColor(second_get_data->bytes() +
                              result.specification->uniforms()[0].offset),
               ColorNearlyEquals(Color::Blue()));
+
+  // Setting the same value again keeps the same data, even while it is shared.
+  data.SetBrushColor(Color::Blue());
+  EXPECT_EQ(data.Get(), second_get_data);
 }
 
 MeshAttributeCodingParams GetStoredCodingParams(const uint8_t* data) {
@@ -292,6 +297,89 @@ TEST(MeshUniformDataTest, WithPositionUnpackingTransform) {
               MeshAttributeCodingParamsEq(position_params));
 }
 
+// Returns the value of type `T` stored at `data`.
+template <typename T>
+T GetStored(const uint8_t* data) {
+  T stored;
+  std::memcpy(&stored, data, sizeof(T));
+  return stored;
+}
+
+TEST(MeshUniformDataTest, WithTextureAnimation) {
+  SkMeshSpecification::Result result = SkMeshSpecification::Make(
+      {{.type = SkMeshSpecification::Attribute::Type::kFloat2,
+        .offset = 0,
+        .name = SkString("position")}},
+      /* vertexStride = */ 8,
+      /* varyings = */ {}, SkString(R"(
+        uniform float uTextureAnimationProgress;
+        uniform int uNumTextureAnimationFrames;
+        uniform int uNumTextureAnimationRows;
+        uniform int uNumTextureAnimationColumns;
+
+        Varyings main(const Attributes attributes) {
+          Varyings varyings;
+          varyings.position = attributes.position;
+          // Use the uniforms in some way in case at some point Skia will
+          // optimize away inactive uniforms.
+          varyings.position.x += uTextureAnimationProgress +
+                                 float(uNumTextureAnimationFrames);
+          varyings.position.y += float(uNumTextureAnimationRows) +
+                                 float(uNumTextureAnimationColumns);
+          return varyings;
+        }
+      )"),
+      SkString(R"(
+        float2 main(const Varyings varyings) {
+          return varyings.position;
+        }
+      )"));
+
+  ASSERT_NE(result.specification, nullptr);
+  ASSERT_EQ(result.specification->uniforms().size(), 4);
+  const SkMeshSpecification::Uniform* progress_uniform =
+      result.specification->findUniform("uTextureAnimationProgress");
+  const SkMeshSpecification::Uniform* frames_uniform =
+      result.specification->findUniform("uNumTextureAnimationFrames");
+  const SkMeshSpecification::Uniform* rows_uniform =
+      result.specification->findUniform("uNumTextureAnimationRows");
+  const SkMeshSpecification::Uniform* columns_uniform =
+      result.specification->findUniform("uNumTextureAnimationColumns");
+  ASSERT_NE(progress_uniform, nullptr);
+  ASSERT_NE(frames_uniform, nullptr);
+  ASSERT_NE(rows_uniform, nullptr);
+  ASSERT_NE(columns_uniform, nullptr);
+
+  MeshUniformData data(*result.specification);
+
+  EXPECT_FALSE(data.HasBrushColor());
+  ASSERT_TRUE(data.HasTextureAnimation());
+
+  data.SetTextureAnimationFrames(7, 2, 4);
+  data.SetTextureAnimationProgress(0.25);
+  sk_sp<const SkData> first_get_data = data.Get();
+  ASSERT_NE(first_get_data, nullptr);
+  const uint8_t* bytes = first_get_data->bytes();
+  EXPECT_EQ(GetStored<float>(bytes + progress_uniform->offset), 0.25);
+  EXPECT_EQ(GetStored<int>(bytes + frames_uniform->offset), 7);
+  EXPECT_EQ(GetStored<int>(bytes + rows_uniform->offset), 2);
+  EXPECT_EQ(GetStored<int>(bytes + columns_uniform->offset), 4);
+
+  // Setting the same progress again keeps the data, and setting a new progress
+  // leaves the first data and the frame layout unchanged.
+  data.SetTextureAnimationProgress(0.25);
+  EXPECT_EQ(data.Get(), first_get_data);
+  data.SetTextureAnimationProgress(0.5);
+  sk_sp<const SkData> second_get_data = data.Get();
+  ASSERT_NE(second_get_data, first_get_data);
+  EXPECT_EQ(GetStored<float>(bytes + progress_uniform->offset), 0.25);
+  EXPECT_EQ(
+      GetStored<float>(second_get_data->bytes() + progress_uniform->offset),
+      0.5);
+  EXPECT_EQ(GetStored<int>(second_get_data->bytes() + frames_uniform->offset),
+            7);
+}
+
 TEST(MeshUniformDataTest, WithAllMutableUniforms) {
   SkMeshSpecification::Result result = SkMeshSpecification::Make(
       {{.type = SkMeshSpecification::Attribute::Type::kFloat2,
@@ -381,6 +469,13 @@ TEST(MeshUniformDataDeathTest, SetBrushColorWithoutUniformPresent) {
   EXPECT_DEATH_IF_SUPPORTED(data.SetBrushColor(Color::Blue()), "");
 }
 
+TEST(MeshUniformDataDeathTest, SetTextureAnimationWithoutUniformsPresent) {
+  MeshUniformData data;
+  ASSERT_FALSE(data.HasTextureAnimation());
+  EXPECT_DEATH_IF_SUPPORTED(data.SetTextureAnimationFrames(1, 1, 1), "");
+  EXPECT_DEATH_IF_SUPPORTED(data.SetTextureAnimationProgress(0), "");
+}
+
 TEST(MeshUniformDataDeathTest,
      GetUnpackingTransformReturnsMismatchedComponentCount) {
   MeshFormatAndSpecification format_and_spec =
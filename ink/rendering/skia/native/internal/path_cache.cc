@@ -0,0 +1,162 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/path_cache.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/rendering/skia/native/internal/path_drawable.h"
+#include "ink/types/executor.h"
+#include "include/core/SkPath.h"
+
+namespace ink::skia_native_internal {
+
+PathCache::PathCache(size_t max_bytes) : state_(std::make_shared<State>()) {
+  absl::MutexLock lock(&state_->mutex);
+  state_->max_bytes = max_bytes;
+}
+
+namespace {
+
+// Rounds `outline_tolerance` down to a power of two, or to zero if it isn't
+// positive, matching the levels cached by `PartitionedMesh`.
+float RoundOutlineTolerance(float outline_tolerance) {
+  if (!(outline_tolerance > 0)) return 0;
+  return std::ldexp(1.f, std::ilogb(outline_tolerance));
+}
+
+}  // namespace
+
+absl::InlinedVector<SkPath, 1> PathCache::GetOrCreate(
+    const PartitionedMesh& shape, uint32_t render_group_index,
+    float outline_tolerance) const {
+  return GetOrCreate(*state_, shape, render_group_index,
+                     RoundOutlineTolerance(outline_tolerance));
+}
+
+void PathCache::Prewarm(absl::Span<const PartitionedMesh> shapes,
+                        Executor* absl_nullable executor) {
+  auto task = [state = state_, shapes = std::vector<PartitionedMesh>(
+                                   shapes.begin(), shapes.end())]() {
+    for (const PartitionedMesh& shape : shapes) {
+      for (uint32_t i = 0; i < shape.RenderGroupCount(); ++i) {
+        GetOrCreate(*state, shape, i, 0);
+      }
+    }
+  };
+  if (executor == nullptr) {
+    task();
+  } else {
+    executor->Schedule(std::move(task));
+  }
+}
+
+void PathCache::SetMaxBytes(size_t max_bytes) {
+  absl::MutexLock lock(&state_->mutex);
+  state_->max_bytes = max_bytes;
+  EvictToFit(*state_, max_bytes);
+}
+
+size_t PathCache::MaxBytes() const {
+  absl::MutexLock lock(&state_->mutex);
+  return state_->max_bytes;
+}
+
+size_t PathCache::TotalBytes() const {
+  absl::MutexLock lock(&state_->mutex);
+  return state_->total_bytes;
+}
+
+size_t PathCache::EntryCount() const {
+  absl::MutexLock lock(&state_->mutex);
+  return state_->entries.size();
+}
+
+void PathCache::Clear() {
+  absl::MutexLock lock(&state_->mutex);
+  state_->entries_by_key.clear();
+  state_->entries.clear();
+  state_->total_bytes = 0;
+}
+
+absl::InlinedVector<SkPath, 1> PathCache::GetOrCreate(
+    State& state, const PartitionedMesh& shape, uint32_t render_group_index,
+    float outline_tolerance) {
+  absl::Span<const Mesh> meshes = shape.Meshes();
+  if (meshes.empty()) {
+    return MakeOutlinePaths(shape, render_group_index, outline_tolerance);
+  }
+
+  Key key = {&meshes.front(), render_group_index, outline_tolerance};
+  {
+    absl::MutexLock lock(&state.mutex);
+    if (auto it = state.entries_by_key.find(key);
+        it != state.entries_by_key.end()) {
+      state.entries.splice(state.entries.begin(), state.entries, it->second);
+      return it->second->paths;
+    }
+    if (state.max_bytes == 0) {
+      return MakeOutlinePaths(shape, render_group_index, outline_tolerance);
+    }
+  }
+
+  // The paths are built without holding the lock. If another thread races to
+  // build the same ones, the first to finish wins.
+  absl::InlinedVector<SkPath, 1> paths =
+      MakeOutlinePaths(shape, render_group_index, outline_tolerance);
+  // Each entry also counts its own size, so that the number of entries for
+  // groups without outlines is bounded as well.
+  size_t bytes = sizeof(Entry);
+  for (const SkPath& path : paths) bytes += path.approximateBytesUsed();
+
+  absl::MutexLock lock(&state.mutex);
+  if (auto it = state.entries_by_key.find(key);
+      it != state.entries_by_key.end()) {
+    return it->second->paths;
+  }
+  if (bytes > state.max_bytes) return paths;
+
+  EvictToFit(state, state.max_bytes - bytes);
+  state.entries.push_front({.shape = shape,
+                            .render_group_index = render_group_index,
+                            .outline_tolerance = outline_tolerance,
+                            .paths = paths,
+                            .bytes = bytes});
+  state.entries_by_key[key] = state.entries.begin();
+  state.total_bytes += bytes;
+  return paths;
+}
+
+void PathCache::EvictToFit(State& state, size_t max_bytes) {
+  while (state.total_bytes > max_bytes) {
+    const Entry& entry = state.entries.back();
+    state.entries_by_key.erase(Key{&entry.shape.Meshes().front(),
+                                   entry.render_group_index,
+                                   entry.outline_tolerance});
+    state.total_bytes -= entry.bytes;
+    state.entries.pop_back();
+  }
+}
+
+}  // namespace ink::skia_native_internal
@@ -0,0 +1,138 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_INTERNAL_PATH_CACHE_H_
+#define INK_RENDERING_SKIA_NATIVE_INTERNAL_PATH_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <tuple>
+
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/types/executor.h"
+#include "include/core/SkPath.h"
+
+namespace ink::skia_native_internal {
+
+// A bounded cache of the `SkPath`s built from the outlines of immutable
+// `PartitionedMesh` render groups, for drawing with a `PathDrawable`.
+//
+// A `PartitionedMesh` shares its data between copies and never changes, so its
+// paths only need to be built once, and can be drawn with any transform.
+// Entries are keyed on the identity of the shape's data and the render group
+// index, and each entry holds a copy of its `PartitionedMesh`, so that the data
+// cannot be freed and its address reused while the entry exists.
+//
+// The cache counts the approximate bytes used by the paths in its entries, plus
+// the size of each entry itself, and evicts the least recently used entries to
+// stay within `MaxBytes()`.
+//
+// This type is thread-safe, so that paths can be built in the background by
+// `Prewarm()` while the cache is in use.
+class PathCache {
+ public:
+  explicit PathCache(size_t max_bytes);
+  PathCache(const PathCache&) = delete;
+  PathCache(PathCache&&) = default;
+  PathCache& operator=(const PathCache&) = delete;
+  PathCache& operator=(PathCache&&) = default;
+  ~PathCache() = default;
+
+  // Returns the paths of the outlines of the render group of `shape` at
+  // `render_group_index`, simplified to `outline_tolerance` as per
+  // `MakeOutlinePaths()`, marking them as the most recently used entry. On a
+  // miss, the paths are built and added to the cache, then entries are evicted
+  // as needed to stay within `MaxBytes()`. Paths for a shape with no meshes, or
+  // that are larger than `MaxBytes()` on their own, are built but not cached.
+  //
+  // Like `PartitionedMesh::SimplifiedOutline()`, tolerances are rounded down to
+  // a power of two, so that each shape has a handful of entries at most.
+  absl::InlinedVector<SkPath, 1> GetOrCreate(
+      const PartitionedMesh& shape, uint32_t render_group_index,
+      float outline_tolerance = 0) const;
+
+  // Builds the paths of every render group of each of `shapes` ahead of time,
+  // e.g. before rasterizing thumbnails of a whole document, so that drawing
+  // them later only has to look them up.
+  //
+  // If `executor` is null, the paths are built before returning. Otherwise,
+  // they are built in a task passed to `executor->Schedule()`, and this may
+  // return before they are ready; the cache remains usable meanwhile, and
+  // builds any paths it needs that aren't ready yet itself.
+  void Prewarm(absl::Span<const PartitionedMesh> shapes,
+               Executor* absl_nullable executor = nullptr);
+
+  // Sets the maximum number of bytes used by entries, evicting the least
+  // recently used entries if needed.
+  void SetMaxBytes(size_t max_bytes);
+  size_t MaxBytes() const;
+
+  // Returns the approximate number of bytes used by all entries.
+  size_t TotalBytes() const;
+
+  // Returns the number of entries currently in the cache.
+  size_t EntryCount() const;
+
+  // Removes all entries.
+  void Clear();
+
+ private:
+  struct Entry {
+    // Keeps the shape data, and so the key, alive.
+    PartitionedMesh shape;
+    uint32_t render_group_index;
+    float outline_tolerance;
+    absl::InlinedVector<SkPath, 1> paths;
+    size_t bytes;
+  };
+
+  using EntryList = std::list<Entry>;
+  // The address of the first `Mesh` of a shape, a render group index, and a
+  // rounded outline tolerance.
+  using Key = std::tuple<const Mesh*, uint32_t, float>;
+
+  // The cached paths, which are shared with any tasks scheduled by
+  // `Prewarm()`, since those may outlive the cache.
+  struct State {
+    mutable absl::Mutex mutex;
+    size_t max_bytes ABSL_GUARDED_BY(mutex);
+    size_t total_bytes ABSL_GUARDED_BY(mutex) = 0;
+    // Entries ordered from most to least recently used.
+    EntryList entries ABSL_GUARDED_BY(mutex);
+    absl::flat_hash_map<Key, EntryList::iterator> entries_by_key
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  static absl::InlinedVector<SkPath, 1> GetOrCreate(
+      State& state, const PartitionedMesh& shape, uint32_t render_group_index,
+      float outline_tolerance);
+
+  static void EvictToFit(State& state, size_t max_bytes)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(state.mutex);
+
+  absl_nonnull std::shared_ptr<State> state_;
+};
+
+}  // namespace ink::skia_native_internal
+
+#endif  // INK_RENDERING_SKIA_NATIVE_INTERNAL_PATH_CACHE_H_
@@ -0,0 +1,144 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/path_cache.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/types/test_executor.h"
+#include "include/core/SkPath.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+PartitionedMesh MakeTestShape() {
+  std::vector<uint32_t> outline = {0, 2, 4, 5, 3, 1};
+  absl::StatusOr<PartitionedMesh> shape = PartitionedMesh::FromMutableMesh(
+      MakeStraightLineMutableMesh(4), {absl::MakeConstSpan(outline)});
+  ABSL_CHECK_OK(shape);
+  return *shape;
+}
+
+TEST(PathCacheTest, ReusesPathsForSameShapeData) {
+  PathCache cache(1024 * 1024);
+  PartitionedMesh shape = MakeTestShape();
+
+  absl::InlinedVector<SkPath, 1> first = cache.GetOrCreate(shape, 0);
+  ASSERT_EQ(first.size(), 1u);
+  EXPECT_EQ(cache.EntryCount(), 1u);
+  EXPECT_GT(cache.TotalBytes(), 0u);
+
+  // A copy of a `PartitionedMesh` shares its data, and so its paths.
+  PartitionedMesh copy = shape;
+  absl::InlinedVector<SkPath, 1> second = cache.GetOrCreate(copy, 0);
+  ASSERT_EQ(second.size(), 1u);
+  EXPECT_EQ(second[0].getGenerationID(), first[0].getGenerationID());
+  EXPECT_EQ(cache.EntryCount(), 1u);
+}
+
+TEST(PathCacheTest, BuildsSeparatePathsForDifferentShapes) {
+  PathCache cache(1024 * 1024);
+  absl::InlinedVector<SkPath, 1> a = cache.GetOrCreate(MakeTestShape(), 0);
+  absl::InlinedVector<SkPath, 1> b = cache.GetOrCreate(MakeTestShape(), 0);
+  ASSERT_EQ(a.size(), 1u);
+  ASSERT_EQ(b.size(), 1u);
+  EXPECT_NE(a[0].getGenerationID(), b[0].getGenerationID());
+  EXPECT_EQ(cache.EntryCount(), 2u);
+}
+
+TEST(PathCacheTest, ZeroMaxBytesBuildsPathsWithoutCaching) {
+  PathCache cache(0);
+  absl::InlinedVector<SkPath, 1> paths = cache.GetOrCreate(MakeTestShape(), 0);
+  EXPECT_EQ(paths.size(), 1u);
+  EXPECT_EQ(cache.EntryCount(), 0u);
+  EXPECT_EQ(cache.TotalBytes(), 0u);
+}
+
+TEST(PathCacheTest, EvictsLeastRecentlyUsed) {
+  PathCache cache(1024 * 1024);
+  PartitionedMesh shape_a = MakeTestShape();
+  PartitionedMesh shape_b = MakeTestShape();
+  absl::InlinedVector<SkPath, 1> a = cache.GetOrCreate(shape_a, 0);
+  cache.SetMaxBytes(cache.TotalBytes());
+
+  cache.GetOrCreate(shape_b, 0);
+  EXPECT_EQ(cache.EntryCount(), 1u);
+
+  // The paths of `shape_a` were evicted, so they are built again.
+  absl::InlinedVector<SkPath, 1> a_again = cache.GetOrCreate(shape_a, 0);
+  EXPECT_NE(a_again[0].getGenerationID(), a[0].getGenerationID());
+  EXPECT_EQ(cache.EntryCount(), 1u);
+
+  cache.Clear();
+  EXPECT_EQ(cache.EntryCount(), 0u);
+  EXPECT_EQ(cache.TotalBytes(), 0u);
+}
+
+TEST(PathCacheTest, CachesSimplifiedPathsPerToleranceLevel) {
+  PathCache cache(1024 * 1024);
+  PartitionedMesh shape = MakeTestShape();
+
+  absl::InlinedVector<SkPath, 1> full = cache.GetOrCreate(shape, 0);
+  absl::InlinedVector<SkPath, 1> simplified = cache.GetOrCreate(shape, 0, 0.25);
+  ASSERT_EQ(full.size(), 1u);
+  ASSERT_EQ(simplified.size(), 1u);
+  EXPECT_EQ(full[0].countPoints(), 6);
+  EXPECT_EQ(simplified[0].countPoints(), 4);
+  EXPECT_EQ(cache.EntryCount(), 2u);
+
+  // A tolerance that rounds down to the same power of two reuses the entry.
+  absl::InlinedVector<SkPath, 1> same_level = cache.GetOrCreate(shape, 0, 0.3);
+  ASSERT_EQ(same_level.size(), 1u);
+  EXPECT_EQ(same_level[0].getGenerationID(), simplified[0].getGenerationID());
+  EXPECT_EQ(cache.EntryCount(), 2u);
+}
+
+TEST(PathCacheTest, PrewarmWithoutExecutor) {
+  PathCache cache(1024 * 1024);
+  PartitionedMesh shape = MakeTestShape();
+  cache.Prewarm({shape});
+  EXPECT_EQ(cache.EntryCount(), 1u);
+}
+
+TEST(PathCacheTest, PrewarmWithExecutor) {
+  PathCache cache(1024 * 1024);
+  PartitionedMesh shape = MakeTestShape();
+  ManualExecutor executor;
+  cache.Prewarm({shape}, &executor);
+  EXPECT_EQ(cache.EntryCount(), 0u);
+  EXPECT_EQ(executor.PendingTaskCount(), 1u);
+
+  executor.RunScheduledTasks();
+  EXPECT_EQ(cache.EntryCount(), 1u);
+}
+
+TEST(PathCacheTest, PrewarmTaskOutlivesCache) {
+  ManualExecutor executor;
+  {
+    PathCache cache(1024 * 1024);
+    cache.Prewarm({MakeTestShape()}, &executor);
+  }
+  executor.RunScheduledTasks();
+}
+
+}  // namespace
+}  // namespace ink::skia_native_internal
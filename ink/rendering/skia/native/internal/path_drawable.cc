@@ -15,7 +15,9 @@
 #include "ink/rendering/skia/native/internal/path_drawable.h"
 
 #include <cstdint>
+#include <utility>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/absl_check.h"
 #include "absl/types/span.h"
 #include "ink/color/color.h"
@@ -27,7 +29,9 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
 #include "include/core/SkPathTypes.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 
 namespace ink::skia_native_internal {
@@ -57,23 +61,37 @@ SkPath MakePolygonPath(const MutableMesh& mesh,
 
 // Creates an `SkPath` using `group_outline_indices` to retrieve path positions
 // from the meshes in `mesh_group`.
-SkPath MakePolygonPath(
-    absl::Span<const Mesh> mesh_group,
-    absl::Span<const PartitionedMesh::VertexIndexPair> group_outline_indices) {
+SkPath MakePolygonPath(absl::Span<const Mesh> mesh_group,
+                       PartitionedMesh::OutlineView group_outline_indices) {
   ABSL_DCHECK(!group_outline_indices.empty());
 
   SkPath path;
   path.setFillType(SkPathFillType::kWinding);
 
-  Point position =
-      mesh_group[group_outline_indices.front().mesh_index].VertexPosition(
-          group_outline_indices.front().vertex_index);
-  group_outline_indices.remove_prefix(1);
-
-  path.moveTo(position.x, position.y);
+  bool first = true;
   for (PartitionedMesh::VertexIndexPair index_pair : group_outline_indices) {
-    position = mesh_group[index_pair.mesh_index].VertexPosition(
+    Point position = mesh_group[index_pair.mesh_index].VertexPosition(
         index_pair.vertex_index);
+    if (first) {
+      path.moveTo(position.x, position.y);
+      first = false;
+    } else {
+      path.lineTo(position.x, position.y);
+    }
+  }
+  path.close();
+
+  return path;
+}
+
+// Creates an `SkPath` through `positions`.
+SkPath MakePolygonPath(absl::Span<const Point> positions) {
+  ABSL_DCHECK(!positions.empty());
+
+  SkPath path;
+  path.setFillType(SkPathFillType::kWinding);
+  path.moveTo(positions.front().x, positions.front().y);
+  for (Point position : positions.subspan(1)) {
     path.lineTo(position.x, position.y);
   }
   path.close();
@@ -104,17 +122,14 @@ PathDrawable::PathDrawable(
 
 PathDrawable::PathDrawable(const PartitionedMesh& shape,
                            uint32_t render_group_index, const Color& color,
-                           float opacity_multiplier)
-    : opacity_multiplier_(opacity_multiplier) {
-  absl::Span<const Mesh> mesh_group =
-      shape.RenderGroupMeshes(render_group_index);
-  for (uint32_t i = 0; i < shape.OutlineCount(render_group_index); ++i) {
-    absl::Span<const PartitionedMesh::VertexIndexPair> indices =
-        shape.Outline(render_group_index, i);
-    if (indices.empty()) continue;
-
-    paths_.push_back(MakePolygonPath(mesh_group, indices));
-  }
+                           float opacity_multiplier, float outline_tolerance)
+    : PathDrawable(
+          MakeOutlinePaths(shape, render_group_index, outline_tolerance),
+          color, opacity_multiplier) {}
+
+PathDrawable::PathDrawable(absl::InlinedVector<SkPath, 1> paths,
+                           const Color& color, float opacity_multiplier)
+    : paths_(std::move(paths)), opacity_multiplier_(opacity_multiplier) {
   SetPaintDefaultsForPath(paint_);
   SetPaintColor(color);
 }
@@ -132,10 +147,41 @@ void PathDrawable::SetImageFilter(sk_sp<SkImageFilter> image_filter) {
   paint_.setImageFilter(image_filter);
 }
 
+SkRect PathDrawable::Bounds() const {
+  SkRect bounds = SkRect::MakeEmpty();
+  for (const SkPath& path : paths_) {
+    bounds.join(path.getBounds());
+  }
+  return bounds;
+}
+
 void PathDrawable::Draw(SkCanvas& canvas) const {
   for (const SkPath& path : paths_) {
     canvas.drawPath(path, paint_);
   }
 }
 
+absl::InlinedVector<SkPath, 1> MakeOutlinePaths(const PartitionedMesh& shape,
+                                                uint32_t render_group_index,
+                                                float outline_tolerance) {
+  absl::InlinedVector<SkPath, 1> paths;
+  if (outline_tolerance > 0) {
+    for (uint32_t i = 0; i < shape.OutlineCount(render_group_index); ++i) {
+      paths.push_back(MakePolygonPath(
+          shape.SimplifiedOutline(render_group_index, i, outline_tolerance)));
+    }
+    return paths;
+  }
+
+  absl::Span<const Mesh> mesh_group =
+      shape.RenderGroupMeshes(render_group_index);
+  for (uint32_t i = 0; i < shape.OutlineCount(render_group_index); ++i) {
+    PartitionedMesh::OutlineView indices = shape.Outline(render_group_index, i);
+    if (indices.empty()) continue;
+
+    paths.push_back(MakePolygonPath(mesh_group, indices));
+  }
+  return paths;
+}
+
 }  // namespace ink::skia_native_internal
@@ -16,6 +16,7 @@
 #define INK_RENDERING_SKIA_NATIVE_INTERNAL_PATH_DRAWABLE_H_
 
 #include <cstdint>
+#include <utility>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
@@ -26,6 +27,7 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPath.h"
+#include "include/core/SkRect.h"
 
 namespace ink::skia_native_internal {
 
@@ -47,12 +49,24 @@ class PathDrawable {
                absl::Span<const absl::Span<const uint32_t>> index_outlines,
                const Color& color, float opacity_multiplier);
 
-  // Constructs the drawable from one render group of a `PartitionedMesh`.
+  // Constructs the drawable from one render group of a `PartitionedMesh`,
+  // with its outlines simplified to `outline_tolerance` as per
+  // `MakeOutlinePaths()`.
   //
   // The `opacity multiplier` is combined with the `color` to set the color of
   // the `SkPaint`.
   PathDrawable(const PartitionedMesh& shape, uint32_t render_group_index,
-               const Color& color, float opacity_multiplier);
+               const Color& color, float opacity_multiplier,
+               float outline_tolerance = 0);
+
+  // Constructs the drawable from `paths` that were already built, e.g. by
+  // `MakeOutlinePaths()`. Copies of an `SkPath` share its point data, so this
+  // is cheap.
+  //
+  // The `opacity multiplier` is combined with the `color` to set the color of
+  // the `SkPaint`.
+  PathDrawable(absl::InlinedVector<SkPath, 1> paths, const Color& color,
+               float opacity_multiplier);
 
   PathDrawable() = default;
   PathDrawable(const PathDrawable&) = default;
@@ -67,6 +81,9 @@ class PathDrawable {
 
   void SetImageFilter(sk_sp<SkImageFilter> image_filter);
 
+  // Returns the union of the bounds of every path.
+  SkRect Bounds() const;
+
   void Draw(SkCanvas& canvas) const;
 
  private:
@@ -75,6 +92,19 @@ class PathDrawable {
   float opacity_multiplier_;
 };
 
+// Returns one closed `SkPath` for each non-empty outline of the render group of
+// `shape` at `render_group_index`, as drawn by a `PathDrawable` constructed
+// from the same group.
+//
+// If `outline_tolerance` is greater than zero, the paths are built from
+// `PartitionedMesh::SimplifiedOutline()`, which drops outline vertices within
+// that distance of the simplified outline and is cached on the shape. This
+// gives much smaller paths for zoomed-out rendering, where `outline_tolerance`
+// would be a fraction of a device pixel in the shape's coordinates.
+absl::InlinedVector<SkPath, 1> MakeOutlinePaths(const PartitionedMesh& shape,
+                                                uint32_t render_group_index,
+                                                float outline_tolerance = 0);
+
 }  // namespace ink::skia_native_internal
 
 #endif  // INK_RENDERING_SKIA_NATIVE_INTERNAL_PATH_DRAWABLE_H_
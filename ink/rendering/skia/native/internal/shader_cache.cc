@@ -1,19 +1,34 @@
 #include "ink/rendering/skia/native/internal/shader_cache.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/nullability.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "ink/brush/brush_paint.h"
+#include "ink/brush/texture_handle.h"
 #include "ink/color/color.h"
 #include "ink/color/color_space.h"
 #include "ink/geometry/affine_transform.h"
+#include "ink/geometry/vec.h"
+#include "ink/rendering/skia/native/internal/texture_atlas.h"
 #include "ink/rendering/skia/native/texture_bitmap_store.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/memory_trim.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkBlender.h"
@@ -21,6 +36,7 @@
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkShader.h"
@@ -43,37 +59,6 @@ SkTileMode ToSkTileMode(BrushPaint::TextureWrap wrap) {
                   << static_cast<int>(wrap);
 }
 
-SkBlendMode ToSkBlendMode(BrushPaint::BlendMode blend_mode) {
-  switch (blend_mode) {
-    case BrushPaint::BlendMode::kModulate:
-      return SkBlendMode::kModulate;
-    case BrushPaint::BlendMode::kDstIn:
-      return SkBlendMode::kDstIn;
-    case BrushPaint::BlendMode::kDstOut:
-      return SkBlendMode::kDstOut;
-    case BrushPaint::BlendMode::kSrcAtop:
-      return SkBlendMode::kSrcATop;
-    case BrushPaint::BlendMode::kSrcIn:
-      return SkBlendMode::kSrcIn;
-    case BrushPaint::BlendMode::kSrcOver:
-      return SkBlendMode::kSrcOver;
-    case BrushPaint::BlendMode::kDstOver:
-      return SkBlendMode::kDstOver;
-    case BrushPaint::BlendMode::kSrc:
-      return SkBlendMode::kSrc;
-    case BrushPaint::BlendMode::kDst:
-      return SkBlendMode::kDst;
-    case BrushPaint::BlendMode::kSrcOut:
-      return SkBlendMode::kSrcOut;
-    case BrushPaint::BlendMode::kDstAtop:
-      return SkBlendMode::kDstATop;
-    case BrushPaint::BlendMode::kXor:
-      return SkBlendMode::kXor;
-  }
-  ABSL_LOG(FATAL) << "invalid `BrushPaint::BlendMode` value: "
-                  << static_cast<int>(blend_mode);
-}
-
 sk_sp<SkColorSpace> CreateColorSpace(ColorSpace color_space,
                                      Color::Format format) {
   bool is_linear = format != Color::Format::kGammaEncoded;
@@ -165,10 +150,67 @@ AffineTransform ComputeSizeUnitToStrokeSpaceTransform(
   return stroke_space_offset * size_unit_to_stroke;
 }
 
+// Returns `image` with a full chain of mipmap levels attached, or `image`
+// itself if it already has them or they can't be built for it.
+sk_sp<SkImage> WithMipmaps(sk_sp<SkImage> image) {
+  if (image->hasMipmaps()) return image;
+  sk_sp<SkImage> mipmapped = image->withDefaultMipmaps();
+  return mipmapped != nullptr ? mipmapped : image;
+}
+
+// Returns the number of bytes of pixel data of `image`, including its mipmap
+// levels, if any.
+size_t ImageByteSize(const SkImage& image) {
+  const SkImageInfo& info = image.imageInfo();
+  size_t bytes = info.computeMinByteSize();
+  if (!image.hasMipmaps()) return bytes;
+  int width = info.width();
+  int height = info.height();
+  while (width > 1 || height > 1) {
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+    bytes += info.makeWH(width, height).computeMinByteSize();
+  }
+  return bytes;
+}
+
 }  // namespace
 
+SkBlendMode ToSkBlendMode(BrushPaint::BlendMode blend_mode) {
+  switch (blend_mode) {
+    case BrushPaint::BlendMode::kModulate:
+      return SkBlendMode::kModulate;
+    case BrushPaint::BlendMode::kDstIn:
+      return SkBlendMode::kDstIn;
+    case BrushPaint::BlendMode::kDstOut:
+      return SkBlendMode::kDstOut;
+    case BrushPaint::BlendMode::kSrcAtop:
+      return SkBlendMode::kSrcATop;
+    case BrushPaint::BlendMode::kSrcIn:
+      return SkBlendMode::kSrcIn;
+    case BrushPaint::BlendMode::kSrcOver:
+      return SkBlendMode::kSrcOver;
+    case BrushPaint::BlendMode::kDstOver:
+      return SkBlendMode::kDstOver;
+    case BrushPaint::BlendMode::kSrc:
+      return SkBlendMode::kSrc;
+    case BrushPaint::BlendMode::kDst:
+      return SkBlendMode::kDst;
+    case BrushPaint::BlendMode::kSrcOut:
+      return SkBlendMode::kSrcOut;
+    case BrushPaint::BlendMode::kDstAtop:
+      return SkBlendMode::kDstATop;
+    case BrushPaint::BlendMode::kXor:
+      return SkBlendMode::kXor;
+  }
+  ABSL_LOG(FATAL) << "invalid `BrushPaint::BlendMode` value: "
+                  << static_cast<int>(blend_mode);
+}
+
 ShaderCache::ShaderCache(const TextureBitmapStore* absl_nullable provider)
-    : texture_provider_(provider) {}
+    : texture_provider_(provider),
+      trim_registration_(RegisterMemoryTrimCallback(
+          MemoryTrimLevel::kAll, [this] { return EvictAllImages(); })) {}
 
 sk_sp<SkBlender> ShaderCache::GetBlenderForPaint(const BrushPaint& paint) {
   if (paint.texture_layers.empty()) return nullptr;
@@ -178,13 +220,16 @@ sk_sp<SkBlender> ShaderCache::GetBlenderForPaint(const BrushPaint& paint) {
 }
 
 absl::StatusOr<sk_sp<SkShader>> ShaderCache::GetShaderForPaint(
-    const BrushPaint& paint, float brush_size, const StrokeInputBatch& inputs) {
+    const BrushPaint& paint, absl::Span<const TextureHandle> texture_handles,
+    float brush_size, const StrokeInputBatch& inputs) {
+  ABSL_DCHECK_EQ(texture_handles.size(), paint.texture_layers.size());
   if (paint.texture_layers.empty()) return nullptr;
   SkBlendMode blend_mode;
   sk_sp<SkShader> paint_shader = nullptr;
-  for (const BrushPaint::TextureLayer& layer : paint.texture_layers) {
+  for (size_t i = 0; i < paint.texture_layers.size(); ++i) {
+    const BrushPaint::TextureLayer& layer = paint.texture_layers[i];
     absl::StatusOr<sk_sp<SkShader>> layer_shader =
-        GetShaderForLayer(layer, brush_size, inputs);
+        GetShaderForLayer(layer, texture_handles[i], brush_size, inputs);
     if (!layer_shader.ok()) return layer_shader.status();
     if (paint_shader == nullptr) {
       paint_shader = *std::move(layer_shader);
@@ -197,52 +242,262 @@ absl::StatusOr<sk_sp<SkShader>> ShaderCache::GetShaderForPaint(
   return paint_shader;
 }
 
-absl::StatusOr<sk_sp<SkShader>> ShaderCache::GetShaderForLayer(
-    const BrushPaint::TextureLayer& layer, float brush_size,
-    const StrokeInputBatch& inputs) {
-  sk_sp<SkShader>& cached_shader = layer_shaders_[layer];
-  if (cached_shader == nullptr) {
-    absl::StatusOr<sk_sp<SkShader>> shader = CreateBaseShaderForLayer(layer);
+absl::StatusOr<sk_sp<SkShader>> ShaderCache::GetShaderForPaint(
+    const BrushPaint& paint, float brush_size, const StrokeInputBatch& inputs) {
+  absl::InlinedVector<TextureHandle, 1> texture_handles;
+  texture_handles.reserve(paint.texture_layers.size());
+  for (const BrushPaint::TextureLayer& layer : paint.texture_layers) {
+    texture_handles.push_back(TextureHandle::Intern(layer.client_texture_id));
+  }
+  return GetShaderForPaint(paint, texture_handles, brush_size, inputs);
+}
+
+absl::Status ShaderCache::Prewarm(const BrushPaint& paint) {
+  for (const BrushPaint::TextureLayer& layer : paint.texture_layers) {
+    absl::StatusOr<sk_sp<SkShader>> shader = GetBaseShaderForLayer(
+        layer, TextureHandle::Intern(layer.client_texture_id));
     if (!shader.ok()) return shader.status();
-    cached_shader = *std::move(shader);
   }
-  return cached_shader->makeWithLocalMatrix(ToSkMatrix(
-      ComputeSizeUnitToStrokeSpaceTransform(layer, brush_size, inputs)));
+  return absl::OkStatus();
+}
+
+absl::Status ShaderCache::BuildTextureAtlas(
+    absl::Span<const std::string> texture_ids,
+    const TextureAtlasOptions& options) {
+  absl::Status status;
+  std::vector<std::pair<std::string, sk_sp<SkImage>>> textures;
+  textures.reserve(texture_ids.size());
+  for (const std::string& texture_id : texture_ids) {
+    absl::StatusOr<sk_sp<SkImage>> image =
+        GetImageForTexture(TextureHandle::Intern(texture_id));
+    if (!image.ok()) {
+      status.Update(image.status());
+      continue;
+    }
+    textures.emplace_back(texture_id, *std::move(image));
+  }
+  auto atlas = std::make_shared<const TextureAtlas>(
+      TextureAtlas::Create(textures, options));
+
+  absl::MutexLock lock(&mutex_);
+  atlas_ = std::move(atlas);
+  // Shaders for stamping layers may now need to sample from a page.
+  absl::erase_if(layer_shaders_, [](const auto& entry) {
+    return entry.first.mapping == BrushPaint::TextureMapping::kStamping;
+  });
+  return status;
+}
+
+absl::StatusOr<ShaderCache::StampImage> ShaderCache::GetStampImage(
+    absl::string_view texture_id) {
+  return GetStampImage(TextureHandle::Intern(texture_id));
+}
+
+absl::StatusOr<ShaderCache::StampImage> ShaderCache::GetStampImage(
+    TextureHandle texture) {
+  std::shared_ptr<const TextureAtlas> atlas;
+  {
+    absl::MutexLock lock(&mutex_);
+    atlas = atlas_;
+  }
+  if (atlas != nullptr) {
+    if (std::optional<TextureAtlas::Region> region =
+            atlas->Find(texture.TextureId());
+        region.has_value()) {
+      return StampImage{.image = std::move(region->page),
+                        .texel_bounds = region->bounds};
+    }
+  }
+
+  absl::StatusOr<sk_sp<SkImage>> image = GetImageForTexture(texture);
+  if (!image.ok()) return image.status();
+  SkIRect texel_bounds = SkIRect::MakeSize((*image)->dimensions());
+  return StampImage{.image = *std::move(image), .texel_bounds = texel_bounds};
+}
+
+void ShaderCache::SetMaxImageBytes(size_t max_bytes) {
+  absl::MutexLock lock(&mutex_);
+  max_image_bytes_ = max_bytes;
+  EvictImagesToFit(max_image_bytes_);
+}
+
+size_t ShaderCache::MaxImageBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return max_image_bytes_;
+}
+
+size_t ShaderCache::ImageBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return image_bytes_;
+}
+
+size_t ShaderCache::EvictAllImages() {
+  absl::MutexLock lock(&mutex_);
+  size_t bytes = image_bytes_;
+  EvictImagesToFit(0);
+  return bytes;
+}
+
+void ShaderCache::SetMipmapsEnabled(bool enabled) {
+  absl::MutexLock lock(&mutex_);
+  if (mipmaps_enabled_ == enabled) return;
+  mipmaps_enabled_ = enabled;
+  EvictImagesToFit(0);
+}
+
+bool ShaderCache::MipmapsEnabled() const {
+  absl::MutexLock lock(&mutex_);
+  return mipmaps_enabled_;
+}
+
+absl::StatusOr<sk_sp<SkShader>> ShaderCache::GetShaderForLayer(
+    const BrushPaint::TextureLayer& layer, TextureHandle texture,
+    float brush_size, const StrokeInputBatch& inputs) {
+  absl::StatusOr<sk_sp<SkShader>> base_shader =
+      GetBaseShaderForLayer(layer, texture);
+  if (!base_shader.ok()) return base_shader.status();
+  return (*base_shader)
+      ->makeWithLocalMatrix(ToSkMatrix(
+          ComputeSizeUnitToStrokeSpaceTransform(layer, brush_size, inputs)));
+}
+
+absl::StatusOr<sk_sp<SkShader>> ShaderCache::GetBaseShaderForLayer(
+    const BrushPaint::TextureLayer& layer, TextureHandle texture) {
+  BaseShaderKey key = {.texture = texture,
+                       .mapping = layer.mapping,
+                       .wrap_x = layer.wrap_x,
+                       .wrap_y = layer.wrap_y,
+                       .size = layer.size,
+                       .offset = layer.offset};
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = layer_shaders_.find(key); it != layer_shaders_.end()) {
+      TouchImage(texture);
+      return it->second;
+    }
+  }
+
+  // The shader is created without holding the lock, since that may fetch the
+  // texture image from the provider.
+  absl::StatusOr<sk_sp<SkShader>> shader =
+      CreateBaseShaderForLayer(layer, texture);
+  if (!shader.ok()) return shader.status();
+
+  absl::MutexLock lock(&mutex_);
+  // Only cache the shader while its image is cached, so that evicting the
+  // image actually frees its pixels.
+  if (!texture_images_.contains(texture)) return shader;
+  // Another thread may have created the same shader in the meantime.
+  return layer_shaders_.try_emplace(key, *std::move(shader)).first->second;
 }
 
 absl::StatusOr<sk_sp<SkShader>> ShaderCache::CreateBaseShaderForLayer(
-    const BrushPaint::TextureLayer& layer) {
-  absl::StatusOr<sk_sp<SkImage>> image =
-      GetImageForTexture(layer.client_texture_id);
+    const BrushPaint::TextureLayer& layer, TextureHandle texture) {
+  if (layer.mapping == BrushPaint::TextureMapping::kStamping) {
+    std::shared_ptr<const TextureAtlas> atlas;
+    {
+      absl::MutexLock lock(&mutex_);
+      atlas = atlas_;
+    }
+    std::optional<TextureAtlas::Region> region =
+        atlas == nullptr ? std::nullopt : atlas->Find(texture.TextureId());
+    if (region.has_value()) {
+      // Texels of the page are offset from those of the texture by the origin
+      // of its region.
+      SkMatrix matrix = ToSkMatrix(
+          ComputeTexelToSizeUnitTransform(layer, region->bounds.width(),
+                                          region->bounds.height()) *
+          AffineTransform::Translate(
+              Vec{-static_cast<float>(region->bounds.left()),
+                  -static_cast<float>(region->bounds.top())}));
+      return SkShaders::Image(std::move(region->page), SkTileMode::kClamp,
+                              SkTileMode::kClamp, SkSamplingOptions(),
+                              &matrix);
+    }
+  }
+
+  absl::StatusOr<sk_sp<SkImage>> image = GetImageForTexture(texture);
   if (!image.ok()) return image.status();
   SkISize size = (*image)->dimensions();
   SkMatrix matrix = ToSkMatrix(
       ComputeTexelToSizeUnitTransform(layer, size.width(), size.height()));
+  // Only sample from mipmap levels if the image actually has them, since
+  // mipmapping may have failed for this image.
+  SkSamplingOptions sampling =
+      (*image)->hasMipmaps()
+          ? SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kLinear)
+          : SkSamplingOptions();
   return SkShaders::Image(*std::move(image), ToSkTileMode(layer.wrap_x),
-                          ToSkTileMode(layer.wrap_y), SkSamplingOptions(),
-                          &matrix);
+                          ToSkTileMode(layer.wrap_y), sampling, &matrix);
 }
 
 absl::StatusOr<sk_sp<SkImage>> ShaderCache::GetImageForTexture(
-    absl::string_view texture_id) {
+    TextureHandle texture) {
   if (texture_provider_ == nullptr) {
     return absl::FailedPreconditionError(absl::StrCat(
         "`TextureBitmapStore` is null, but asked to render texture: ",
-        texture_id));
+        texture.TextureId()));
   }
-  sk_sp<SkImage>& cached_image = texture_images_[texture_id];
-  if (cached_image == nullptr) {
-    absl::StatusOr<sk_sp<SkImage>> image =
-        texture_provider_->GetTextureBitmap(texture_id);
-    if (!image.ok()) return image.status();
-    // Since cached_image is a shared pointer, assigning it populates the cache.
-    cached_image = *std::move(image);
+  bool mipmaps_enabled;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = texture_images_.find(texture);
+        it != texture_images_.end()) {
+      image_lru_.splice(image_lru_.begin(), image_lru_,
+                        it->second.lru_position);
+      return it->second.image;
+    }
+    mipmaps_enabled = mipmaps_enabled_;
+  }
+
+  // The provider may be slow, and building mipmaps takes about as long as
+  // reading every pixel, so both are done without holding the lock.
+  absl::StatusOr<sk_sp<SkImage>> image =
+      texture_provider_->GetTextureBitmap(texture.TextureId());
+  if (!image.ok()) return image.status();
+  if (mipmaps_enabled) *image = WithMipmaps(*std::move(image));
+
+  absl::MutexLock lock(&mutex_);
+  if (auto it = texture_images_.find(texture); it != texture_images_.end()) {
+    // Another thread fetched the same texture in the meantime.
+    return it->second.image;
+  }
+  // Don't cache an image made for a previous setting.
+  if (mipmaps_enabled != mipmaps_enabled_) return image;
+  size_t bytes = ImageByteSize(**image);
+  if (bytes > max_image_bytes_) return image;
+  EvictImagesToFit(max_image_bytes_ - bytes);
+  image_lru_.push_front(texture);
+  texture_images_.emplace(
+      texture, CachedImage{.image = *image,
+                              .bytes = bytes,
+                              .lru_position = image_lru_.begin()});
+  image_bytes_ += bytes;
+  return image;
+}
+
+void ShaderCache::TouchImage(TextureHandle texture) {
+  if (auto it = texture_images_.find(texture); it != texture_images_.end()) {
+    image_lru_.splice(image_lru_.begin(), image_lru_, it->second.lru_position);
+  }
+}
+
+void ShaderCache::EvictImagesToFit(size_t max_bytes) {
+  while (image_bytes_ > max_bytes) {
+    TextureHandle texture = image_lru_.back();
+    absl::erase_if(layer_shaders_, [texture](const auto& entry) {
+      return entry.first.texture == texture;
+    });
+    auto it = texture_images_.find(texture);
+    image_bytes_ -= it->second.bytes;
+    texture_images_.erase(it);
+    image_lru_.pop_back();
   }
-  return cached_image;
 }
 
 sk_sp<SkColorSpace> ShaderCache::GetColorSpace(ColorSpace color_space,
                                                Color::Format format) {
+  absl::MutexLock lock(&mutex_);
   sk_sp<SkColorSpace>& cached_color_space =
       color_spaces_[std::make_pair(color_space, format)];
   if (cached_color_space == nullptr) {
@@ -15,35 +15,62 @@
 #ifndef INK_RENDERING_SKIA_NATIVE_INTERNAL_SHADER_CACHE_H_
 #define INK_RENDERING_SKIA_NATIVE_INTERNAL_SHADER_CACHE_H_
 
+#include <cstddef>
+#include <limits>
+#include <list>
+#include <memory>
 #include <string>
 #include <utility>
 
 #include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "ink/brush/brush_paint.h"
+#include "ink/brush/texture_handle.h"
 #include "ink/color/color.h"
 #include "ink/color/color_space.h"
+#include "ink/geometry/vec.h"
+#include "ink/rendering/skia/native/internal/texture_atlas.h"
 #include "ink/rendering/skia/native/texture_bitmap_store.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/memory_trim.h"
+#include "include/core/SkBlendMode.h"
 #include "include/core/SkBlender.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkShader.h"
 
 namespace ink::skia_native_internal {
 
+// Returns the `SkBlendMode` for `blend_mode`, which blends a texture as the
+// source with the brush color, or with the result of the previous texture
+// layers, as the destination.
+SkBlendMode ToSkBlendMode(BrushPaint::BlendMode blend_mode);
+
+// A cache of the `SkImage`s fetched from a `TextureBitmapStore`, and of the
+// `SkShader`s and other Skia objects created for them.
+//
+// This type is thread-safe, so a single instance can be shared by renderers on
+// different threads. Texture images are evicted in least recently used order
+// to keep the bytes of their pixel data within `MaxImageBytes()`, along with
+// the shaders that reference them. Every cached image is also evicted by
+// `TrimMemory()` with `MemoryTrimLevel::kAll`.
 class ShaderCache {
  public:
   // If non-null, `texture_provider` must outlive the `ShaderCache`.
   explicit ShaderCache(const TextureBitmapStore* absl_nullable provider);
 
   ShaderCache(const ShaderCache&) = delete;
-  ShaderCache(ShaderCache&&) = default;
+  ShaderCache(ShaderCache&&) = delete;
   ShaderCache& operator=(const ShaderCache&) = delete;
-  ShaderCache& operator=(ShaderCache&&) = default;
+  ShaderCache& operator=(ShaderCache&&) = delete;
   ~ShaderCache() = default;
 
   // Returns the `SkBlender` object (which may be nullptr) that should be used
@@ -51,30 +78,140 @@ class ShaderCache {
   sk_sp<SkBlender> GetBlenderForPaint(const BrushPaint& paint);
 
   // Returns the `SkShader` object (which may be nullptr) that should be used
-  // for the given `BrushPaint` and stroke properties.
+  // for the given `BrushPaint` and stroke properties. `texture_handles` must
+  // hold the interned `client_texture_id` of each of the paint's texture
+  // layers, in order, as returned by `BrushFamily::GetTextureHandles()`, so
+  // that cached textures and shaders are found without hashing the IDs.
+  absl::StatusOr<sk_sp<SkShader>> GetShaderForPaint(
+      const BrushPaint& paint, absl::Span<const TextureHandle> texture_handles,
+      float brush_size, const StrokeInputBatch& inputs);
+
+  // Same as above, but interns the texture IDs of `paint` first. Prefer the
+  // overload above when drawing strokes, whose families have already
+  // interned them.
   absl::StatusOr<sk_sp<SkShader>> GetShaderForPaint(
       const BrushPaint& paint, float brush_size,
       const StrokeInputBatch& inputs);
 
+  // Fetches the texture images and creates the shaders for every texture layer
+  // of `paint` ahead of time, so that the first call to `GetShaderForPaint()`
+  // for it doesn't have to. Returns the first error encountered, if any.
+  absl::Status Prewarm(const BrushPaint& paint);
+
+  // Packs the texture images for `texture_ids` into a `TextureAtlas`, replacing
+  // any previous atlas, and uses it for texture layers with `kStamping`
+  // mapping from then on. Returns the first error encountered fetching a
+  // texture, after packing every texture that could be fetched.
+  //
+  // A stamping layer draws one copy of its texture per particle, so its texture
+  // coordinates stay within the texture, and it can be sampled from a region of
+  // a shared page image without changing how it is drawn. Meshes using
+  // different textures of the same page can then be batched together by Skia.
+  // Other layers rely on wrapping at the edges of their texture image, and keep
+  // using it on its own.
+  absl::Status BuildTextureAtlas(absl::Span<const std::string> texture_ids,
+                                 const TextureAtlasOptions& options);
+
+  // The image from which a `kStamping` texture is drawn onto the quads of
+  // `SkiaRenderer::DrawStampedCoat()`, and the texels of the texture within it.
+  struct StampImage {
+    sk_sp<SkImage> image;
+    SkIRect texel_bounds;
+  };
+
+  // Returns the page and region of the texture atlas holding `texture`, if
+  // any, or else the texture image on its own.
+  absl::StatusOr<StampImage> GetStampImage(TextureHandle texture);
+  absl::StatusOr<StampImage> GetStampImage(absl::string_view texture_id);
+
+  // Sets the maximum number of bytes of pixel data of cached texture images,
+  // evicting the least recently used images if needed. An image larger than
+  // this on its own is still returned, but not cached. Defaults to no limit.
+  void SetMaxImageBytes(size_t max_bytes);
+  size_t MaxImageBytes() const;
+
+  // Returns the number of bytes of pixel data of all cached texture images,
+  // including their mipmap levels. This does not include the pages of the
+  // texture atlas, if any.
+  size_t ImageBytes() const;
+
+  // Evicts every cached texture image, and the shaders that use them, and
+  // returns the number of bytes of pixel data released. The texture atlas, if
+  // any, is kept, since it is only rebuilt by `BuildTextureAtlas()`.
+  size_t EvictAllImages();
+
+  // Sets whether texture images are cached with a full chain of mipmap levels,
+  // and sampled with trilinear filtering. This keeps textures from aliasing
+  // and reading far more texels than are drawn when they are minified, e.g.
+  // tiled textures on a zoomed-out canvas, at the cost of about a third more
+  // memory per image, which counts toward `MaxImageBytes()`. Changing this
+  // evicts every cached image and shader.
+  //
+  // Pages of the texture atlas are not mipmapped, since their levels would
+  // blend neighboring textures together. Disabled by default, in which case
+  // textures are sampled from the image as is, with nearest filtering.
+  void SetMipmapsEnabled(bool enabled);
+  bool MipmapsEnabled() const;
+
  private:
+  struct CachedImage {
+    sk_sp<SkImage> image;
+    size_t bytes;
+    // The position of this image's texture in `image_lru_`.
+    std::list<TextureHandle>::iterator lru_position;
+  };
+
+  // The properties of a `TextureLayer` that its base shader depends on; see
+  // `CreateBaseShaderForLayer()`. Layers that differ only in other properties
+  // share their base shader.
+  struct BaseShaderKey {
+    TextureHandle texture;
+    BrushPaint::TextureMapping mapping;
+    BrushPaint::TextureWrap wrap_x;
+    BrushPaint::TextureWrap wrap_y;
+    Vec size;
+    Vec offset;
+
+    friend bool operator==(const BaseShaderKey&,
+                           const BaseShaderKey&) = default;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const BaseShaderKey& key) {
+      return H::combine(std::move(h), key.texture, key.mapping, key.wrap_x,
+                        key.wrap_y, key.size, key.offset);
+    }
+  };
+
   // Returns the texture shader that should be used for the given `TextureLayer`
-  // and stroke properties, including the full local matrix needed.
+  // and stroke properties, including the full local matrix needed. `texture`
+  // is the interned `client_texture_id` of `layer`.
   absl::StatusOr<sk_sp<SkShader>> GetShaderForLayer(
-      const BrushPaint::TextureLayer& layer, float brush_size,
-      const StrokeInputBatch& inputs);
+      const BrushPaint::TextureLayer& layer, TextureHandle texture,
+      float brush_size, const StrokeInputBatch& inputs);
+
+  // Returns the cached result of `CreateBaseShaderForLayer()`, creating it if
+  // needed.
+  absl::StatusOr<sk_sp<SkShader>> GetBaseShaderForLayer(
+      const BrushPaint::TextureLayer& layer, TextureHandle texture);
 
   // Helper method for `GetShaderForLayer`. Creates a new `SkShader` object for
   // the given `TextureLayer`, with a local matrix consisting of the portion of
   // the transform that is inherent to the `TextureLayer` and doesn't depend on
   // the properties of a particular stroke (and thus can be cached).
   absl::StatusOr<sk_sp<SkShader>> CreateBaseShaderForLayer(
-      const BrushPaint::TextureLayer& layer);
+      const BrushPaint::TextureLayer& layer, TextureHandle texture);
+
+  // Returns an `SkImage` object with the bitmap data for the given texture.
+  // The `SkImage` object will be cached, so that the same instance is returned
+  // for the same texture until it is evicted.
+  absl::StatusOr<sk_sp<SkImage>> GetImageForTexture(TextureHandle texture);
+
+  // Marks the image for `texture`, if cached, as the most recently used.
+  void TouchImage(TextureHandle texture) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
-  // Returns an `SkImage` object with the bitmap data for the given texture
-  // ID. The `SkImage` object will be cached, so that the same instance is
-  // returned for the same texture ID.
-  absl::StatusOr<sk_sp<SkImage>> GetImageForTexture(
-      absl::string_view texture_id);
+  // Evicts the least recently used images, and the shaders that use them,
+  // until the cached images take at most `max_bytes`.
+  void EvictImagesToFit(size_t max_bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   // Returns the `SkColorSpace` corresponding to the given Ink `ColorSpace` and
   // `Color::Format`. The `SkColorSpace` object will be cached, so that the same
@@ -83,10 +220,26 @@ class ShaderCache {
                                     Color::Format format);
 
   const TextureBitmapStore* absl_nullable texture_provider_ = nullptr;
+  mutable absl::Mutex mutex_;
   absl::flat_hash_map<std::pair<ColorSpace, Color::Format>, sk_sp<SkColorSpace>>
-      color_spaces_;
-  absl::flat_hash_map<std::string, sk_sp<SkImage>> texture_images_;
-  absl::flat_hash_map<BrushPaint::TextureLayer, sk_sp<SkShader>> layer_shaders_;
+      color_spaces_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<TextureHandle, CachedImage> texture_images_
+      ABSL_GUARDED_BY(mutex_);
+  // Textures of `texture_images_`, from most to least recently used.
+  std::list<TextureHandle> image_lru_ ABSL_GUARDED_BY(mutex_);
+  size_t image_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t max_image_bytes_ ABSL_GUARDED_BY(mutex_) =
+      std::numeric_limits<size_t>::max();
+  bool mipmaps_enabled_ ABSL_GUARDED_BY(mutex_) = false;
+  // Set by `BuildTextureAtlas()`. Shared so that it can be used without holding
+  // the lock.
+  std::shared_ptr<const TextureAtlas> atlas_ ABSL_GUARDED_BY(mutex_);
+  // Only holds shaders for layers whose texture image is in `texture_images_`.
+  absl::flat_hash_map<BaseShaderKey, sk_sp<SkShader>> layer_shaders_
+      ABSL_GUARDED_BY(mutex_);
+  // Declared last, so that the callback is unregistered before anything it
+  // uses is destroyed.
+  MemoryTrimRegistration trim_registration_;
 };
 
 }  // namespace ink::skia_native_internal
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -33,12 +34,14 @@
 #include "ink/rendering/skia/native/texture_bitmap_store.h"
 #include "ink/strokes/input/fuzz_domains.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/memory_trim.h"
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkShader.h"
 
@@ -60,11 +63,16 @@ class FakeBitmapStore : public TextureBitmapStore {
 
   absl::StatusOr<sk_sp<SkImage>> GetTextureBitmap(
       absl::string_view texture_id) const override {
+    ++fetch_count_;
     return image_;
   }
 
+  // Returns the number of calls to `GetTextureBitmap()`.
+  int FetchCount() const { return fetch_count_; }
+
  private:
   sk_sp<SkImage> image_;
+  mutable int fetch_count_ = 0;
 };
 
 absl::StatusOr<sk_sp<SkImage>> CreateImageFromSrgbLinearPixelData(
@@ -125,6 +133,221 @@ TEST(ShaderCacheTest, GetShaderForTexturedBrushPaint) {
   EXPECT_FALSE(image->colorSpace()->isSRGB());
 }
 
+// Returns a 2x1 RGBA image, which takes 8 bytes.
+sk_sp<SkImage> MakeTestImage() {
+  auto image = CreateImageFromSrgbLinearPixelData(
+      /*width=*/2, /*height=*/1,
+      std::vector<uint8_t>{0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff});
+  ABSL_CHECK_OK(image);
+  return *image;
+}
+
+BrushPaint MakeTexturedPaint(absl::string_view texture_id) {
+  return BrushPaint{{{.client_texture_id = std::string(texture_id)}}};
+}
+
+TEST(ShaderCacheTest, PrewarmFetchesTextureBeforeFirstUse) {
+  FakeBitmapStore provider(MakeTestImage());
+  ShaderCache cache(&provider);
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  EXPECT_EQ(provider.FetchCount(), 1);
+  EXPECT_EQ(cache.ImageBytes(), 8u);
+
+  absl::StatusOr<sk_sp<SkShader>> shader =
+      cache.GetShaderForPaint(MakeTexturedPaint("a"), 10, StrokeInputBatch());
+  ASSERT_EQ(shader.status(), absl::OkStatus());
+  EXPECT_THAT(*shader, NotNull());
+  EXPECT_EQ(provider.FetchCount(), 1);
+}
+
+TEST(ShaderCacheTest, PrewarmWithoutTextureProvider) {
+  ShaderCache cache(nullptr);
+  EXPECT_EQ(cache.Prewarm(BrushPaint{}), absl::OkStatus());
+  EXPECT_EQ(cache.Prewarm(MakeTexturedPaint("a")).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST(ShaderCacheTest, EvictsLeastRecentlyUsedImage) {
+  FakeBitmapStore provider(MakeTestImage());
+  ShaderCache cache(&provider);
+  cache.SetMaxImageBytes(16);
+  EXPECT_EQ(cache.MaxImageBytes(), 16u);
+
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("b")), absl::OkStatus());
+  // Using "a" again makes "b" the least recently used.
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("c")), absl::OkStatus());
+  EXPECT_EQ(provider.FetchCount(), 3);
+  EXPECT_EQ(cache.ImageBytes(), 16u);
+
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  EXPECT_EQ(provider.FetchCount(), 3);
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("b")), absl::OkStatus());
+  EXPECT_EQ(provider.FetchCount(), 4);
+}
+
+TEST(ShaderCacheTest, ShrinkingMaxImageBytesEvicts) {
+  FakeBitmapStore provider(MakeTestImage());
+  ShaderCache cache(&provider);
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("b")), absl::OkStatus());
+  EXPECT_EQ(cache.ImageBytes(), 16u);
+
+  cache.SetMaxImageBytes(8);
+  EXPECT_EQ(cache.ImageBytes(), 8u);
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("b")), absl::OkStatus());
+  EXPECT_EQ(provider.FetchCount(), 2);
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  EXPECT_EQ(provider.FetchCount(), 3);
+}
+
+TEST(ShaderCacheTest, TrimMemoryEvictsAllImages) {
+  FakeBitmapStore provider(MakeTestImage());
+  ShaderCache cache(&provider);
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("b")), absl::OkStatus());
+
+  // Textures are only trimmed at the highest level.
+  TrimMemory(MemoryTrimLevel::kCaches);
+  EXPECT_EQ(cache.ImageBytes(), 16u);
+
+  EXPECT_EQ(TrimMemory(MemoryTrimLevel::kAll), 16u);
+  EXPECT_EQ(cache.ImageBytes(), 0u);
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  EXPECT_EQ(provider.FetchCount(), 3);
+}
+
+TEST(ShaderCacheTest, ImageLargerThanMaxIsNotCached) {
+  FakeBitmapStore provider(MakeTestImage());
+  ShaderCache cache(&provider);
+  cache.SetMaxImageBytes(4);
+  for (int i = 0; i < 2; ++i) {
+    absl::StatusOr<sk_sp<SkShader>> shader =
+        cache.GetShaderForPaint(MakeTexturedPaint("a"), 10, StrokeInputBatch());
+    ASSERT_EQ(shader.status(), absl::OkStatus());
+    EXPECT_THAT(*shader, NotNull());
+  }
+  EXPECT_EQ(provider.FetchCount(), 2);
+  EXPECT_EQ(cache.ImageBytes(), 0u);
+}
+
+TEST(ShaderCacheTest, MipmapsCountTowardImageBytes) {
+  FakeBitmapStore provider(MakeTestImage());
+  ShaderCache cache(&provider);
+  EXPECT_FALSE(cache.MipmapsEnabled());
+  cache.SetMipmapsEnabled(true);
+  EXPECT_TRUE(cache.MipmapsEnabled());
+
+  absl::StatusOr<sk_sp<SkShader>> shader =
+      cache.GetShaderForPaint(MakeTexturedPaint("a"), 10, StrokeInputBatch());
+  ASSERT_EQ(shader.status(), absl::OkStatus());
+  EXPECT_THAT(*shader, NotNull());
+  // The 2x1 image plus its 1x1 mipmap level.
+  EXPECT_EQ(cache.ImageBytes(), 12u);
+  absl::StatusOr<ShaderCache::StampImage> stamp_image =
+      cache.GetStampImage("a");
+  ASSERT_EQ(stamp_image.status(), absl::OkStatus());
+  EXPECT_TRUE(stamp_image->image->hasMipmaps());
+
+  // Changing the setting evicts the images built for the old one.
+  cache.SetMipmapsEnabled(false);
+  EXPECT_EQ(cache.ImageBytes(), 0u);
+  ASSERT_EQ(cache.Prewarm(MakeTexturedPaint("a")), absl::OkStatus());
+  EXPECT_EQ(provider.FetchCount(), 2);
+  EXPECT_EQ(cache.ImageBytes(), 8u);
+}
+
+TEST(ShaderCacheTest, UnavailableTextureIsFetchedAgain) {
+  // A store whose texture is still loading the first time it is asked for.
+  class LoadingBitmapStore : public TextureBitmapStore {
+   public:
+    absl::StatusOr<sk_sp<SkImage>> GetTextureBitmap(
+        absl::string_view texture_id) const override {
+      if (++fetch_count_ == 1) return absl::UnavailableError("loading");
+      return MakeTestImage();
+    }
+
+   private:
+    mutable int fetch_count_ = 0;
+  };
+  LoadingBitmapStore provider;
+  ShaderCache cache(&provider);
+  EXPECT_EQ(
+      cache.GetShaderForPaint(MakeTexturedPaint("a"), 10, StrokeInputBatch())
+          .status()
+          .code(),
+      absl::StatusCode::kUnavailable);
+  absl::StatusOr<sk_sp<SkShader>> shader =
+      cache.GetShaderForPaint(MakeTexturedPaint("a"), 10, StrokeInputBatch());
+  ASSERT_EQ(shader.status(), absl::OkStatus());
+  EXPECT_THAT(*shader, NotNull());
+}
+
+BrushPaint MakeStampingPaint(absl::string_view texture_id) {
+  return BrushPaint{{{.client_texture_id = std::string(texture_id),
+                      .mapping = BrushPaint::TextureMapping::kStamping}}};
+}
+
+TEST(ShaderCacheTest, StampingLayersShareAtlasPage) {
+  FakeBitmapStore provider(MakeTestImage());
+  ShaderCache cache(&provider);
+  std::vector<std::string> texture_ids = {"a", "b"};
+  ASSERT_EQ(cache.BuildTextureAtlas(texture_ids, {.page_size = 16}),
+            absl::OkStatus());
+
+  absl::StatusOr<sk_sp<SkShader>> shader_a =
+      cache.GetShaderForPaint(MakeStampingPaint("a"), 10, StrokeInputBatch());
+  absl::StatusOr<sk_sp<SkShader>> shader_b =
+      cache.GetShaderForPaint(MakeStampingPaint("b"), 10, StrokeInputBatch());
+  ASSERT_EQ(shader_a.status(), absl::OkStatus());
+  ASSERT_EQ(shader_b.status(), absl::OkStatus());
+  SkImage* image_a = (*shader_a)->isAImage(nullptr, nullptr);
+  ASSERT_THAT(image_a, NotNull());
+  EXPECT_EQ(image_a->width(), 16);
+  EXPECT_EQ(image_a, (*shader_b)->isAImage(nullptr, nullptr));
+
+  // Tiling layers keep using their own image, since they wrap at its edges.
+  absl::StatusOr<sk_sp<SkShader>> tiling_shader =
+      cache.GetShaderForPaint(MakeTexturedPaint("a"), 10, StrokeInputBatch());
+  ASSERT_EQ(tiling_shader.status(), absl::OkStatus());
+  SkImage* tiling_image = (*tiling_shader)->isAImage(nullptr, nullptr);
+  ASSERT_THAT(tiling_image, NotNull());
+  EXPECT_EQ(tiling_image->width(), 2);
+}
+
+TEST(ShaderCacheTest, GetStampImageUsesAtlasPage) {
+  FakeBitmapStore provider(MakeTestImage());
+  ShaderCache cache(&provider);
+
+  absl::StatusOr<ShaderCache::StampImage> own_image = cache.GetStampImage("a");
+  ASSERT_EQ(own_image.status(), absl::OkStatus());
+  ASSERT_THAT(own_image->image, NotNull());
+  EXPECT_EQ(own_image->image->width(), 2);
+  EXPECT_EQ(own_image->texel_bounds,
+            SkIRect::MakeSize(own_image->image->dimensions()));
+
+  std::vector<std::string> texture_ids = {"a"};
+  ASSERT_EQ(cache.BuildTextureAtlas(texture_ids, {.page_size = 16}),
+            absl::OkStatus());
+  absl::StatusOr<ShaderCache::StampImage> page = cache.GetStampImage("a");
+  ASSERT_EQ(page.status(), absl::OkStatus());
+  ASSERT_THAT(page->image, NotNull());
+  EXPECT_EQ(page->image->width(), 16);
+  EXPECT_EQ(page->texel_bounds.width(), own_image->texel_bounds.width());
+  EXPECT_EQ(page->texel_bounds.height(), own_image->texel_bounds.height());
+}
+
+TEST(ShaderCacheTest, BuildTextureAtlasReturnsFetchErrors) {
+  ShaderCache cache(nullptr);
+  std::vector<std::string> texture_ids = {"a"};
+  EXPECT_EQ(cache.BuildTextureAtlas(texture_ids, {}).code(),
+            absl::StatusCode::kFailedPrecondition);
+  absl::StatusOr<sk_sp<SkShader>> shader =
+      cache.GetShaderForPaint(MakeStampingPaint("a"), 10, StrokeInputBatch());
+  EXPECT_EQ(shader.status().code(), absl::StatusCode::kFailedPrecondition);
+}
+
 void CanGetShaderForAnyValidInputs(const BrushPaint& brush_paint,
                                    float brush_size,
                                    const StrokeInputBatch& inputs) {
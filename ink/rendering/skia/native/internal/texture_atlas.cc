@@ -0,0 +1,190 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/texture_atlas.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+// The number of texels around each packed texture that repeat its edge.
+constexpr int kGutter = 1;
+
+struct PageBuilder {
+  SkBitmap bitmap;
+  // The top of the shelf that textures are being added to.
+  int shelf_top = 0;
+  int shelf_height = 0;
+  // The left of the free space on the current shelf.
+  int shelf_cursor = 0;
+};
+
+// Reserves a `width` by `height` slot in `page`, starting a new shelf if the
+// current one is full, and returns its top-left corner, or `std::nullopt` if
+// there is no room left.
+std::optional<SkIPoint> AllocateSlot(PageBuilder& page, int width, int height) {
+  int page_size = page.bitmap.width();
+  if (page.shelf_cursor + width > page_size) {
+    page.shelf_top += page.shelf_height;
+    page.shelf_height = 0;
+    page.shelf_cursor = 0;
+  }
+  if (width > page_size || page.shelf_top + height > page_size) {
+    return std::nullopt;
+  }
+  SkIPoint slot = SkIPoint::Make(page.shelf_cursor, page.shelf_top);
+  page.shelf_cursor += width;
+  page.shelf_height = std::max(page.shelf_height, height);
+  return slot;
+}
+
+// Copies the texels of `image` into `bounds` of `page`, and fills the gutter
+// around `bounds` with copies of the nearest edge texels. Returns false if the
+// texels of `image` could not be read.
+bool CopyWithGutter(const SkImage& image, const SkIRect& bounds,
+                    SkBitmap& page) {
+  SkPixmap page_pixels;
+  SkPixmap destination;
+  if (!page.peekPixels(&page_pixels) ||
+      !page_pixels.extractSubset(&destination, bounds) ||
+      !image.readPixels(nullptr, destination, 0, 0)) {
+    return false;
+  }
+
+  size_t bytes_per_texel = page_pixels.info().bytesPerPixel();
+  auto copy_texel = [&page_pixels, bytes_per_texel](int from_x, int from_y,
+                                                    int to_x, int to_y) {
+    std::memcpy(page_pixels.writable_addr(to_x, to_y),
+                page_pixels.addr(from_x, from_y), bytes_per_texel);
+  };
+  for (int g = 1; g <= kGutter; ++g) {
+    for (int y = bounds.top(); y < bounds.bottom(); ++y) {
+      copy_texel(bounds.left(), y, bounds.left() - g, y);
+      copy_texel(bounds.right() - 1, y, bounds.right() - 1 + g, y);
+    }
+  }
+  // The rows above and below also cover the corners.
+  for (int g = 1; g <= kGutter; ++g) {
+    for (int x = bounds.left() - kGutter; x < bounds.right() + kGutter; ++x) {
+      copy_texel(x, bounds.top(), x, bounds.top() - g);
+      copy_texel(x, bounds.bottom() - 1, x, bounds.bottom() - 1 + g);
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TextureAtlas TextureAtlas::Create(
+    absl::Span<const std::pair<std::string, sk_sp<SkImage>>> textures,
+    const TextureAtlasOptions& options) {
+  // Packing the tallest textures first keeps the shelves full.
+  std::vector<size_t> order(textures.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [textures](size_t a, size_t b) {
+    return textures[a].second->height() > textures[b].second->height();
+  });
+
+  std::vector<PageBuilder> pages;
+  TextureAtlas atlas;
+  for (size_t index : order) {
+    const auto& [texture_id, image] = textures[index];
+    if (image->isTextureBacked() ||
+        image->colorType() == kUnknown_SkColorType ||
+        image->width() > options.max_texture_size ||
+        image->height() > options.max_texture_size ||
+        atlas.placements_.contains(texture_id)) {
+      continue;
+    }
+    int slot_width = image->width() + 2 * kGutter;
+    int slot_height = image->height() + 2 * kGutter;
+
+    std::optional<SkIPoint> slot;
+    size_t page_index = 0;
+    for (; page_index < pages.size(); ++page_index) {
+      if (pages[page_index].bitmap.info().colorInfo() !=
+          image->imageInfo().colorInfo()) {
+        continue;
+      }
+      slot = AllocateSlot(pages[page_index], slot_width, slot_height);
+      if (slot.has_value()) break;
+    }
+    if (!slot.has_value()) {
+      if (pages.size() >= static_cast<size_t>(options.max_pages)) continue;
+      PageBuilder page;
+      if (!page.bitmap.tryAllocPixels(SkImageInfo::Make(
+              SkISize::Make(options.page_size, options.page_size),
+              image->imageInfo().colorInfo()))) {
+        continue;
+      }
+      page.bitmap.eraseColor(SK_ColorTRANSPARENT);
+      slot = AllocateSlot(page, slot_width, slot_height);
+      if (!slot.has_value()) continue;
+      page_index = pages.size();
+      pages.push_back(std::move(page));
+    }
+
+    SkIRect bounds = SkIRect::MakeXYWH(slot->x() + kGutter,
+                                       slot->y() + kGutter, image->width(),
+                                       image->height());
+    if (!CopyWithGutter(*image, bounds, pages[page_index].bitmap)) continue;
+    atlas.placements_.emplace(
+        texture_id, Placement{.page_index = page_index, .bounds = bounds});
+  }
+
+  atlas.pages_.reserve(pages.size());
+  for (PageBuilder& page : pages) {
+    page.bitmap.setImmutable();
+    atlas.pages_.push_back(page.bitmap.asImage());
+  }
+  return atlas;
+}
+
+std::optional<TextureAtlas::Region> TextureAtlas::Find(
+    absl::string_view texture_id) const {
+  auto it = placements_.find(texture_id);
+  if (it == placements_.end()) return std::nullopt;
+  return Region{.page = pages_[it->second.page_index],
+                .bounds = it->second.bounds};
+}
+
+size_t TextureAtlas::Bytes() const {
+  size_t bytes = 0;
+  for (const sk_sp<SkImage>& page : pages_) {
+    bytes += page->imageInfo().computeMinByteSize();
+  }
+  return bytes;
+}
+
+}  // namespace ink::skia_native_internal
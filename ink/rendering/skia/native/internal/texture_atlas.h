@@ -0,0 +1,96 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_INTERNAL_TEXTURE_ATLAS_H_
+#define INK_RENDERING_SKIA_NATIVE_INTERNAL_TEXTURE_ATLAS_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink::skia_native_internal {
+
+struct TextureAtlasOptions {
+  // The width and height of each page image.
+  int page_size = 1024;
+  // Textures wider or taller than this are not packed.
+  int max_texture_size = 256;
+  // Textures that don't fit into this many pages are not packed.
+  int max_pages = 4;
+};
+
+// An immutable set of raster "page" images, each holding several small
+// texture images, so that meshes textured with different textures can be
+// drawn with the same image and batched together by Skia.
+//
+// Textures are packed into rows ("shelves") of a page, tallest first, with a
+// one texel gutter around each that repeats its edge texels, so that bilinear
+// sampling at the edge of a texture doesn't blend in its neighbors. A page only
+// holds textures with the same color type, alpha type, and color space, whose
+// pixels are copied without conversion. Textures that can't be packed, because
+// they are too large, don't fit, or aren't readable on the CPU, are simply left
+// out, and should be drawn from their own image.
+class TextureAtlas {
+ public:
+  // The location of a packed texture.
+  struct Region {
+    sk_sp<SkImage> page;
+    // The texels of the texture within `page`, not including the gutter.
+    SkIRect bounds;
+  };
+
+  // Packs as many of `textures`, given as pairs of texture ID and non-null
+  // image, as fit within `options`.
+  static TextureAtlas Create(
+      absl::Span<const std::pair<std::string, sk_sp<SkImage>>> textures,
+      const TextureAtlasOptions& options);
+
+  TextureAtlas() = default;
+  TextureAtlas(const TextureAtlas&) = delete;
+  TextureAtlas(TextureAtlas&&) = default;
+  TextureAtlas& operator=(const TextureAtlas&) = delete;
+  TextureAtlas& operator=(TextureAtlas&&) = default;
+  ~TextureAtlas() = default;
+
+  // Returns the region of the texture for `texture_id`, or `std::nullopt` if
+  // it was not packed.
+  std::optional<Region> Find(absl::string_view texture_id) const;
+
+  size_t PageCount() const { return pages_.size(); }
+
+  // Returns the number of bytes of pixel data of all pages.
+  size_t Bytes() const;
+
+ private:
+  struct Placement {
+    size_t page_index;
+    SkIRect bounds;
+  };
+
+  std::vector<sk_sp<SkImage>> pages_;
+  absl::flat_hash_map<std::string, Placement> placements_;
+};
+
+}  // namespace ink::skia_native_internal
+
+#endif  // INK_RENDERING_SKIA_NATIVE_INTERNAL_TEXTURE_ATLAS_H_
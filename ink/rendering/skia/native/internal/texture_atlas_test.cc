@@ -0,0 +1,134 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/texture_atlas.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorType.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Field;
+using ::testing::Optional;
+
+sk_sp<SkImage> MakeSolidImage(int width, int height, SkColor color) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(width, height);
+  bitmap.eraseColor(color);
+  bitmap.setImmutable();
+  return bitmap.asImage();
+}
+
+TEST(TextureAtlasTest, EmptyAtlas) {
+  TextureAtlas atlas = TextureAtlas::Create({}, {});
+  EXPECT_EQ(atlas.PageCount(), 0u);
+  EXPECT_EQ(atlas.Bytes(), 0u);
+  EXPECT_EQ(atlas.Find("a"), std::nullopt);
+}
+
+TEST(TextureAtlasTest, PacksTexturesIntoOnePage) {
+  std::vector<std::pair<std::string, sk_sp<SkImage>>> textures = {
+      {"a", MakeSolidImage(4, 2, SK_ColorRED)},
+      {"b", MakeSolidImage(3, 5, SK_ColorBLUE)},
+  };
+  TextureAtlas atlas = TextureAtlas::Create(textures, {.page_size = 16});
+  EXPECT_EQ(atlas.PageCount(), 1u);
+  EXPECT_EQ(atlas.Bytes(), 16u * 16u * 4u);
+
+  std::optional<TextureAtlas::Region> a = atlas.Find("a");
+  std::optional<TextureAtlas::Region> b = atlas.Find("b");
+  ASSERT_TRUE(a.has_value());
+  ASSERT_TRUE(b.has_value());
+  EXPECT_EQ(a->page, b->page);
+  // The taller texture is packed first, and each has a one texel gutter.
+  EXPECT_EQ(b->bounds, SkIRect::MakeXYWH(1, 1, 3, 5));
+  EXPECT_EQ(a->bounds, SkIRect::MakeXYWH(6, 1, 4, 2));
+
+  SkBitmap page;
+  ASSERT_TRUE(a->page->asLegacyBitmap(&page));
+  EXPECT_EQ(page.getColor(7, 2), SK_ColorRED);
+  EXPECT_EQ(page.getColor(2, 3), SK_ColorBLUE);
+  // The gutter repeats the edge texels, including at the corners.
+  EXPECT_EQ(page.getColor(5, 2), SK_ColorRED);
+  EXPECT_EQ(page.getColor(10, 3), SK_ColorRED);
+  EXPECT_EQ(page.getColor(0, 0), SK_ColorBLUE);
+  EXPECT_EQ(page.getColor(4, 6), SK_ColorBLUE);
+  EXPECT_EQ(page.getColor(12, 12), SK_ColorTRANSPARENT);
+}
+
+TEST(TextureAtlasTest, StartsNewShelvesAndPages) {
+  std::vector<std::pair<std::string, sk_sp<SkImage>>> textures;
+  for (int i = 0; i < 5; ++i) {
+    textures.emplace_back(std::to_string(i),
+                          MakeSolidImage(6, 6, SK_ColorGREEN));
+  }
+  // Each 8x8 page holds one 6x6 texture with its gutter.
+  TextureAtlas atlas =
+      TextureAtlas::Create(textures, {.page_size = 8, .max_pages = 3});
+  EXPECT_EQ(atlas.PageCount(), 3u);
+  EXPECT_NE(atlas.Find("0"), std::nullopt);
+  EXPECT_NE(atlas.Find("2"), std::nullopt);
+  EXPECT_EQ(atlas.Find("3"), std::nullopt);
+  EXPECT_EQ(atlas.Find("4"), std::nullopt);
+
+  // A 16x16 page holds four of them on two shelves.
+  atlas = TextureAtlas::Create(textures, {.page_size = 16});
+  EXPECT_EQ(atlas.PageCount(), 2u);
+  EXPECT_THAT(
+      atlas.Find("3"),
+      Optional(Field(&TextureAtlas::Region::bounds,
+                     Eq(SkIRect::MakeXYWH(9, 9, 6, 6)))));
+}
+
+TEST(TextureAtlasTest, SkipsLargeTextures) {
+  std::vector<std::pair<std::string, sk_sp<SkImage>>> textures = {
+      {"large", MakeSolidImage(10, 1, SK_ColorRED)},
+      {"small", MakeSolidImage(1, 1, SK_ColorRED)},
+  };
+  TextureAtlas atlas = TextureAtlas::Create(
+      textures, {.page_size = 64, .max_texture_size = 8});
+  EXPECT_EQ(atlas.Find("large"), std::nullopt);
+  EXPECT_NE(atlas.Find("small"), std::nullopt);
+}
+
+TEST(TextureAtlasTest, SeparatesPagesByColorInfo) {
+  SkBitmap alpha_bitmap;
+  alpha_bitmap.allocPixels(SkImageInfo::MakeA8(2, 2));
+  alpha_bitmap.eraseColor(SK_ColorBLACK);
+  std::vector<std::pair<std::string, sk_sp<SkImage>>> textures = {
+      {"color", MakeSolidImage(2, 2, SK_ColorRED)},
+      {"alpha", alpha_bitmap.asImage()},
+  };
+  TextureAtlas atlas = TextureAtlas::Create(textures, {.page_size = 16});
+  EXPECT_EQ(atlas.PageCount(), 2u);
+  ASSERT_NE(atlas.Find("alpha"), std::nullopt);
+  EXPECT_EQ(atlas.Find("alpha")->page->colorType(), kAlpha_8_SkColorType);
+}
+
+}  // namespace
+}  // namespace ink::skia_native_internal
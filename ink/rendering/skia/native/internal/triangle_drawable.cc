@@ -0,0 +1,113 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/triangle_drawable.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/types/span.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/vec.h"
+#include "ink/rendering/skia/native/internal/triangle_rasterizer.h"
+#include "ink/types/executor.h"
+#include "include/core/SkAlphaType.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkColorType.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+// Device pixels by which the mapped bounds are outset to cover the vertices
+// that the rasterizer moves outward to make room for antialiasing.
+constexpr int kAntialiasingOutset = 2;
+
+}  // namespace
+
+TriangleDrawable::TriangleDrawable(absl::Span<const Mesh> meshes,
+                                   const Color& color,
+                                   Executor* absl_nullable executor)
+    : meshes_(meshes.begin(), meshes.end()),
+      color_(color),
+      executor_(executor) {}
+
+void TriangleDrawable::SetImageFilter(sk_sp<SkImageFilter> image_filter) {
+  paint_.setImageFilter(std::move(image_filter));
+}
+
+SkRect TriangleDrawable::Bounds() const {
+  SkRect bounds = SkRect::MakeEmpty();
+  for (const Mesh& mesh : meshes_) {
+    std::optional<Rect> rect = mesh.Bounds().AsRect();
+    if (!rect.has_value()) continue;
+    bounds.join(SkRect::MakeLTRB(rect->XMin(), rect->YMin(), rect->XMax(),
+                                 rect->YMax()));
+  }
+  return bounds;
+}
+
+void TriangleDrawable::Draw(SkCanvas& canvas) const {
+  SkMatrix matrix = canvas.getTotalMatrix();
+  SkIRect device_bounds =
+      matrix.mapRect(Bounds()).roundOut().makeOutset(kAntialiasingOutset,
+                                                     kAntialiasingOutset);
+  if (!device_bounds.intersect(canvas.getDeviceClipBounds())) return;
+
+  SkBitmap bitmap;
+  if (!bitmap.tryAllocPixels(SkImageInfo::Make(
+          device_bounds.width(), device_bounds.height(),
+          kRGBA_8888_SkColorType, kPremul_SkAlphaType,
+          SkColorSpace::MakeSRGB()))) {
+    return;
+  }
+  bitmap.eraseColor(SK_ColorTRANSPARENT);
+
+  AffineTransform object_to_bitmap =
+      AffineTransform::Translate({-static_cast<float>(device_bounds.left()),
+                                  -static_cast<float>(device_bounds.top())}) *
+      AffineTransform(matrix.getScaleX(), matrix.getSkewX(),
+                      matrix.getTranslateX(), matrix.getSkewY(),
+                      matrix.getScaleY(), matrix.getTranslateY());
+  RasterizeStrokeTriangles(
+      meshes_, object_to_bitmap, color_,
+      {.pixels = static_cast<uint8_t*>(bitmap.getPixels()),
+       .width = bitmap.width(),
+       .height = bitmap.height(),
+       .row_bytes = bitmap.rowBytes()},
+      executor_);
+  bitmap.setImmutable();
+
+  canvas.save();
+  canvas.resetMatrix();
+  canvas.drawImage(bitmap.asImage(), device_bounds.left(), device_bounds.top(),
+                   SkSamplingOptions(), &paint_);
+  canvas.restore();
+}
+
+}  // namespace ink::skia_native_internal
@@ -0,0 +1,74 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_INTERNAL_TRIANGLE_DRAWABLE_H_
+#define INK_RENDERING_SKIA_NATIVE_INTERNAL_TRIANGLE_DRAWABLE_H_
+
+#include "absl/base/nullability.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/types/span.h"
+#include "ink/color/color.h"
+#include "ink/geometry/mesh.h"
+#include "ink/types/executor.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkImageFilter.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink::skia_native_internal {
+
+// A drawable object that rasterizes the triangles of stroke meshes on the CPU
+// with `RasterizeStrokeTriangles()`, for drawing into a raster `SkCanvas`.
+//
+// Unlike a `PathDrawable`, this draws antialiasing, color shifts and
+// self-overlap like the `SkMesh` shaders do, but it doesn't draw textures.
+// The triangles are rasterized into an image covering the part of the
+// drawable within the device clip, which is then drawn with the canvas matrix
+// reset. The perspective part of the canvas matrix is ignored.
+class TriangleDrawable {
+ public:
+  // Constructs the drawable from the meshes of one render group of a stroke
+  // shape. Copies of a `Mesh` share its data, so this is cheap. Tiles of the
+  // image are rasterized on `executor` if it is non-null, in which case it
+  // must outlive the drawable.
+  TriangleDrawable(absl::Span<const Mesh> meshes, const Color& color,
+                   Executor* absl_nullable executor = nullptr);
+
+  TriangleDrawable() = default;
+  TriangleDrawable(const TriangleDrawable&) = default;
+  TriangleDrawable(TriangleDrawable&&) = default;
+  TriangleDrawable& operator=(const TriangleDrawable&) = default;
+  TriangleDrawable& operator=(TriangleDrawable&&) = default;
+  ~TriangleDrawable() = default;
+
+  void SetBrushColor(const Color& color) { color_ = color; }
+
+  void SetImageFilter(sk_sp<SkImageFilter> image_filter);
+
+  // Returns the union of the bounds of every mesh.
+  SkRect Bounds() const;
+
+  void Draw(SkCanvas& canvas) const;
+
+ private:
+  absl::InlinedVector<Mesh, 1> meshes_;
+  Color color_;
+  Executor* absl_nullable executor_ = nullptr;
+  SkPaint paint_;
+};
+
+}  // namespace ink::skia_native_internal
+
+#endif  // INK_RENDERING_SKIA_NATIVE_INTERNAL_TRIANGLE_DRAWABLE_H_
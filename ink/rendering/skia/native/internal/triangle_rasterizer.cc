@@ -0,0 +1,634 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/triangle_rasterizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/types/span.h"
+#include "ink/color/color.h"
+#include "ink/color/color_space.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/vec.h"
+#include "ink/strokes/internal/stroke_vertex.h"
+#include "ink/types/executor.h"
+#include "ink/types/numbers.h"
+#include "ink/types/small_array.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+using ::ink::strokes_internal::StrokeVertex;
+
+// Tiles are the unit of parallel work, and are blended in a floating point
+// buffer of `kTileSize` by `kTileSize` pixels.
+constexpr int kTileSize = 64;
+
+// Coverage tests are done on vertex positions snapped to 1/256th of a pixel,
+// in 64-bit integers, so that they are exact. Limiting positions to within
+// `kMaxPixelsOutsideTarget` of the target keeps the products in edge functions
+// from overflowing.
+constexpr int64_t kSubpixelScale = 256;
+constexpr float kMaxPixelsOutsideTarget = 1 << 20;
+
+// The varyings of the stroke mesh shaders, which are interpolated linearly
+// across each triangle. See `MeshSpecificationData::CreateForStroke()`.
+enum Varying {
+  // The premultiplied color in linear sRGB.
+  kColorR,
+  kColorG,
+  kColorB,
+  kColorA,
+  // `pixelsPerDimension`.
+  kPixelsPerSide,
+  kPixelsPerForward,
+  // `normalizedToEdgeLRFB`.
+  kNormalizedToLeft,
+  kNormalizedToRight,
+  kNormalizedToFront,
+  kNormalizedToBack,
+  // `outsetPixelsLRFB`.
+  kOutsetPixelsLeft,
+  kOutsetPixelsRight,
+  kOutsetPixelsFront,
+  kOutsetPixelsBack,
+  kVaryingCount,
+};
+
+using Varyings = std::array<float, kVaryingCount>;
+
+// The output of the vertex shader for one vertex.
+struct ShadedVertex {
+  // The outset position, in target pixel coordinates.
+  Point position;
+  Varyings varyings;
+};
+
+float Saturate(float value) { return std::clamp(value, 0.f, 1.f); }
+
+float Mix(float a, float b, float t) { return a + (b - a) * t; }
+
+float Sign(float value) { return (value > 0) - (value < 0); }
+
+float Dot(Vec a, Vec b) { return a.x * b.x + a.y * b.y; }
+
+// The helper functions below are ports of the SkSL helpers of the same names in
+// ink/rendering/skia/common_internal, and should be kept in sync with them.
+
+float TargetAntialiasingPixelOutset(float width_in_pixels) {
+  return Mix(0.5f, 0.707107f, Saturate(2.f * (width_in_pixels - 0.5f)));
+}
+
+float DecodeMargin(float label) {
+  return (4.f / 126.f) * std::max(std::abs(label) - 1.f, 0.f);
+}
+
+// Takes and returns an unpremultiplied color in linear sRGB.
+Color::RgbaFloat ApplyHslAndOpacityShift(std::array<float, 3> hsl_shift,
+                                         float opacity_shift,
+                                         Color::RgbaFloat color) {
+  float y = 0.299f * color.r + 0.587f * color.g + 0.114f * color.b;
+  float i = 0.596f * color.r - 0.275f * color.g - 0.321f * color.b;
+  float q = 0.212f * color.r - 0.523f * color.g + 0.311f * color.b;
+
+  float hue_radians =
+      color.r == 0 && color.g == 0 && color.b == 0 ? 0 : std::atan2(q, i);
+  float chroma = std::sqrt(i * i + q * q);
+
+  hue_radians -= hsl_shift[0] * static_cast<float>(2 * numbers::kPi);
+  chroma *= hsl_shift[1] + 1;
+  y += hsl_shift[2];
+  i = chroma * std::cos(hue_radians);
+  q = chroma * std::sin(hue_radians);
+
+  return {.r = y + 0.956f * i + 0.621f * q,
+          .g = y - 0.272f * i - 0.647f * q,
+          .b = y - 1.107f * i + 1.704f * q,
+          .a = Saturate((opacity_shift + 1) * color.a)};
+}
+
+float SimulatedPixelCoverage(float pixels_per_side, float pixels_per_forward,
+                             float normalized_to_left,
+                             float normalized_to_right,
+                             float normalized_to_front,
+                             float normalized_to_back, float outset_left,
+                             float outset_right, float outset_front,
+                             float outset_back) {
+  float target_outset = TargetAntialiasingPixelOutset(pixels_per_side);
+  auto outset = [target_outset](float outset_pixels, float normalized) {
+    return std::min(outset_pixels / std::max(1.f - normalized, 0.000001f),
+                    target_outset);
+  };
+  float adjusted_side = pixels_per_side +
+                        outset(outset_left, normalized_to_left) +
+                        outset(outset_right, normalized_to_right);
+  float adjusted_forward = pixels_per_forward +
+                           outset(outset_front, normalized_to_front) +
+                           outset(outset_back, normalized_to_back);
+  float to_edge_scale = 1.f / (2.f * target_outset);
+  float to_left = Saturate(adjusted_side * normalized_to_left * to_edge_scale);
+  float to_right =
+      Saturate(adjusted_side * normalized_to_right * to_edge_scale);
+  float to_front =
+      Saturate(adjusted_forward * normalized_to_front * to_edge_scale);
+  float to_back =
+      Saturate(adjusted_forward * normalized_to_back * to_edge_scale);
+  float side_coverage = normalized_to_left + normalized_to_right >= 1.9999f
+                            ? 1.f
+                            : std::max(to_left + to_right - 1.f, 0.f);
+  float forward_coverage = normalized_to_front + normalized_to_back >= 1.9999f
+                               ? 1.f
+                               : std::max(to_front + to_back - 1.f, 0.f);
+  return side_coverage * forward_coverage;
+}
+
+// Reads the stroke vertex attributes that the shaders use from a mesh, treating
+// missing ones as zero.
+class VertexAttributeReader {
+ public:
+  explicit VertexAttributeReader(const Mesh& mesh)
+      : mesh_(mesh),
+        indices_(StrokeVertex::FindAttributeIndices(mesh.Format())) {}
+
+  bool HasHslShift() const { return indices_.hsl_shift >= 0; }
+
+  float OpacityShift(uint32_t vertex) const {
+    return Component(vertex, indices_.opacity_shift, 0);
+  }
+  std::array<float, 3> HslShift(uint32_t vertex) const {
+    if (!HasHslShift()) return {0, 0, 0};
+    SmallArray<float, 4> value =
+        mesh_.FloatVertexAttribute(vertex, indices_.hsl_shift);
+    return {value[0], value[1], value[2]};
+  }
+  Vec SideDerivative(uint32_t vertex) const {
+    return {Component(vertex, indices_.side_derivative, 0),
+            Component(vertex, indices_.side_derivative, 1)};
+  }
+  float SideLabel(uint32_t vertex) const {
+    return Component(vertex, indices_.side_label, 0);
+  }
+  Vec ForwardDerivative(uint32_t vertex) const {
+    return {Component(vertex, indices_.forward_derivative, 0),
+            Component(vertex, indices_.forward_derivative, 1)};
+  }
+  float ForwardLabel(uint32_t vertex) const {
+    return Component(vertex, indices_.forward_label, 0);
+  }
+
+ private:
+  float Component(uint32_t vertex, int8_t attribute_index,
+                  uint8_t component) const {
+    if (attribute_index < 0) return 0;
+    return mesh_.FloatVertexAttribute(vertex, attribute_index)[component];
+  }
+
+  const Mesh& mesh_;
+  StrokeVertex::FormatAttributeIndices indices_;
+};
+
+// Computes what the vertex shader does for `vertex`; see
+// `calculateAntialiasingAndPositionOutset()` in particular.
+ShadedVertex ShadeVertex(const VertexAttributeReader& attributes,
+                         const Mesh& mesh, uint32_t vertex,
+                         const AffineTransform& object_to_target,
+                         const Color::RgbaFloat& brush_color) {
+  const float a = object_to_target.A();
+  const float b = object_to_target.B();
+  const float d = object_to_target.D();
+  const float e = object_to_target.E();
+  auto pixels_per_dimension = [a, b, d, e](Vec derivative) {
+    Vec orthogonal = {-derivative.y, derivative.x};
+    float mapped_length = std::hypot(a * orthogonal.x + b * orthogonal.y,
+                                     d * orthogonal.x + e * orthogonal.y);
+    return std::abs(a * e - b * d) * Dot(derivative, derivative) /
+           std::max(0.000001f, mapped_length);
+  };
+
+  Vec side_derivative = attributes.SideDerivative(vertex);
+  Vec forward_derivative = attributes.ForwardDerivative(vertex);
+  float side_label = attributes.SideLabel(vertex);
+  float forward_label = attributes.ForwardLabel(vertex);
+  float pixels_per_side = pixels_per_dimension(side_derivative);
+  float pixels_per_forward = pixels_per_dimension(forward_derivative);
+
+  float normalized_to_left = side_label > -0.005f ? 1 : 0;
+  float normalized_to_right = side_label < 0.005f ? 1 : 0;
+  float normalized_to_front = forward_label > -0.005f ? 1 : 0;
+  float normalized_to_back = forward_label < 0.005f ? 1 : 0;
+
+  // The shader divides by the pixels per dimension unguarded; they are only
+  // zero for degenerate derivatives, whose outsets are zero either way.
+  float target_outset = TargetAntialiasingPixelOutset(pixels_per_side);
+  float side_target = target_outset / std::max(pixels_per_side, 0.000001f);
+  float forward_target =
+      target_outset / std::max(pixels_per_forward, 0.000001f);
+  float side_outset = std::min(side_target, DecodeMargin(side_label));
+  float forward_outset = std::min(forward_target, DecodeMargin(forward_label));
+  side_outset =
+      Mix(side_target, side_outset, Saturate(4.f * pixels_per_side - 1.f));
+  float side_ratio = side_outset / side_target;
+  float forward_ratio = forward_outset / forward_target;
+
+  Vec side_offset = Sign(side_label) * side_outset * side_derivative;
+  Vec forward_offset =
+      Sign(forward_label) * forward_outset * forward_derivative;
+  float common_forward_magnitude =
+      Saturate(Dot(side_offset, forward_offset) /
+               std::max(0.000001f, Dot(forward_offset, forward_offset)));
+  Point position = mesh.VertexPosition(vertex) + side_offset +
+                   (1 - common_forward_magnitude) * forward_offset;
+
+  Color::RgbaFloat color = brush_color;
+  if (attributes.HasHslShift()) {
+    color = ApplyHslAndOpacityShift(attributes.HslShift(vertex),
+                                    attributes.OpacityShift(vertex), color);
+  } else {
+    color.a = Saturate((attributes.OpacityShift(vertex) + 1) * color.a);
+  }
+
+  ShadedVertex shaded = {.position = object_to_target.Apply(position),
+                         .varyings = {}};
+  shaded.varyings[kColorR] = color.r * color.a;
+  shaded.varyings[kColorG] = color.g * color.a;
+  shaded.varyings[kColorB] = color.b * color.a;
+  shaded.varyings[kColorA] = color.a;
+  shaded.varyings[kPixelsPerSide] = pixels_per_side;
+  shaded.varyings[kPixelsPerForward] = pixels_per_forward;
+  shaded.varyings[kNormalizedToLeft] = normalized_to_left;
+  shaded.varyings[kNormalizedToRight] = normalized_to_right;
+  shaded.varyings[kNormalizedToFront] = normalized_to_front;
+  shaded.varyings[kNormalizedToBack] = normalized_to_back;
+  shaded.varyings[kOutsetPixelsLeft] =
+      target_outset * (1 - normalized_to_left) * side_ratio;
+  shaded.varyings[kOutsetPixelsRight] =
+      target_outset * (1 - normalized_to_right) * side_ratio;
+  shaded.varyings[kOutsetPixelsFront] =
+      target_outset * (1 - normalized_to_front) * forward_ratio;
+  shaded.varyings[kOutsetPixelsBack] =
+      target_outset * (1 - normalized_to_back) * forward_ratio;
+  return shaded;
+}
+
+int64_t FloorDiv(int64_t numerator, int64_t positive_denominator) {
+  int64_t quotient = numerator / positive_denominator;
+  if (numerator % positive_denominator != 0 && numerator < 0) --quotient;
+  return quotient;
+}
+
+int64_t CeilDiv(int64_t numerator, int64_t positive_denominator) {
+  return -FloorDiv(-numerator, positive_denominator);
+}
+
+// A triangle ready to be rasterized.
+struct TriangleSetup {
+  // An edge from `a` to `a + delta`, in subpixel units. With the vertices in
+  // the winding order for which the edge function below is positive inside,
+  // a pixel center `p` is covered by the triangle if, for every edge:
+  //   delta.x * (p.y - a.y) - delta.y * (p.x - a.x) >= bias
+  // The bias of 0 or 1 breaks ties so that an edge shared by two triangles
+  // covers its pixels in exactly one of them; it only depends on the direction
+  // of the edge, which is opposite in the two triangles.
+  struct Edge {
+    int64_t ax;
+    int64_t ay;
+    int64_t dx;
+    int64_t dy;
+    int64_t bias;
+  };
+  std::array<Edge, 3> edges;
+  // The inclusive range of pixels that may be covered, clipped to the target.
+  int x_min;
+  int y_min;
+  int x_max;
+  int y_max;
+  // Each varying at pixel coordinates (x, y) is
+  // `at_origin + ddx * x + ddy * y`.
+  Varyings at_origin;
+  Varyings ddx;
+  Varyings ddy;
+};
+
+std::optional<TriangleSetup> SetUpTriangle(
+    std::array<const ShadedVertex*, 3> vertices, const RasterTarget& target) {
+  std::array<int64_t, 3> x;
+  std::array<int64_t, 3> y;
+  for (int i = 0; i < 3; ++i) {
+    Point p = vertices[i]->position;
+    // This is also false for NaN.
+    if (!(p.x >= -kMaxPixelsOutsideTarget &&
+          p.x <= target.width + kMaxPixelsOutsideTarget &&
+          p.y >= -kMaxPixelsOutsideTarget &&
+          p.y <= target.height + kMaxPixelsOutsideTarget)) {
+      return std::nullopt;
+    }
+    x[i] = std::llround(p.x * kSubpixelScale);
+    y[i] = std::llround(p.y * kSubpixelScale);
+  }
+  int64_t doubled_area = (x[1] - x[0]) * (y[2] - y[0]) -
+                         (y[1] - y[0]) * (x[2] - x[0]);
+  if (doubled_area == 0) return std::nullopt;
+  if (doubled_area < 0) {
+    std::swap(vertices[1], vertices[2]);
+    std::swap(x[1], x[2]);
+    std::swap(y[1], y[2]);
+  }
+
+  TriangleSetup setup;
+  for (int i = 0; i < 3; ++i) {
+    int next = (i + 1) % 3;
+    int64_t dx = x[next] - x[i];
+    int64_t dy = y[next] - y[i];
+    setup.edges[i] = {.ax = x[i],
+                      .ay = y[i],
+                      .dx = dx,
+                      .dy = dy,
+                      .bias = dy > 0 || (dy == 0 && dx < 0) ? 0 : 1};
+  }
+
+  // Pixel `px` has its center at `px * kSubpixelScale + kSubpixelScale / 2`.
+  constexpr int64_t kHalf = kSubpixelScale / 2;
+  auto [x_min, x_max] = std::minmax({x[0], x[1], x[2]});
+  auto [y_min, y_max] = std::minmax({y[0], y[1], y[2]});
+  setup.x_min = std::max<int64_t>(0, CeilDiv(x_min - kHalf, kSubpixelScale));
+  setup.y_min = std::max<int64_t>(0, CeilDiv(y_min - kHalf, kSubpixelScale));
+  setup.x_max = std::min<int64_t>(target.width - 1,
+                                  FloorDiv(x_max - kHalf, kSubpixelScale));
+  setup.y_max = std::min<int64_t>(target.height - 1,
+                                  FloorDiv(y_max - kHalf, kSubpixelScale));
+  if (setup.x_min > setup.x_max || setup.y_min > setup.y_max) {
+    return std::nullopt;
+  }
+
+  Point p0 = vertices[0]->position;
+  Vec e1 = vertices[1]->position - p0;
+  Vec e2 = vertices[2]->position - p0;
+  float denominator = e1.x * e2.y - e2.x * e1.y;
+  if (denominator == 0) return std::nullopt;
+  for (int k = 0; k < kVaryingCount; ++k) {
+    float f0 = vertices[0]->varyings[k];
+    float df1 = vertices[1]->varyings[k] - f0;
+    float df2 = vertices[2]->varyings[k] - f0;
+    setup.ddx[k] = (df1 * e2.y - df2 * e1.y) / denominator;
+    setup.ddy[k] = (df2 * e1.x - df1 * e2.x) / denominator;
+    setup.at_origin[k] = f0 - setup.ddx[k] * p0.x - setup.ddy[k] * p0.y;
+  }
+  return setup;
+}
+
+// Narrows [`first`, `last`] to the pixels of row `y` covered by `triangle`.
+// Returns false if there are none.
+bool NarrowToCoveredSpan(const TriangleSetup& triangle, int y, int& first,
+                         int& last) {
+  constexpr int64_t kHalf = kSubpixelScale / 2;
+  int64_t center_y = y * kSubpixelScale + kHalf;
+  int64_t span_first = first;
+  int64_t span_last = last;
+  for (const TriangleSetup::Edge& edge : triangle.edges) {
+    // The edge function at the center of pixel `px` in this row is
+    // `constant + slope * px`.
+    int64_t constant =
+        edge.dx * (center_y - edge.ay) - edge.dy * (kHalf - edge.ax);
+    int64_t slope = -edge.dy * kSubpixelScale;
+    if (slope == 0) {
+      if (constant < edge.bias) return false;
+    } else if (slope > 0) {
+      span_first = std::max(span_first, CeilDiv(edge.bias - constant, slope));
+    } else {
+      span_last = std::min(span_last, FloorDiv(constant - edge.bias, -slope));
+    }
+  }
+  if (span_first > span_last) return false;
+  first = span_first;
+  last = span_last;
+  return true;
+}
+
+// Premultiplied linear sRGB pixels of one tile, blended in floating point.
+// Channels are stored in separate planes so that span loops vectorize.
+struct TilePixels {
+  std::array<float, kTileSize * kTileSize> r;
+  std::array<float, kTileSize * kTileSize> g;
+  std::array<float, kTileSize * kTileSize> b;
+  std::array<float, kTileSize * kTileSize> a;
+};
+
+// Blends `triangle` over `count` pixels of one row of a tile, starting at pixel
+// `x` of row `y` of the target, and at `offset` in the tile.
+void ShadeSpan(const TriangleSetup& triangle, int x, int y, int count,
+               int offset, TilePixels& pixels) {
+  Varyings start;
+  for (int k = 0; k < kVaryingCount; ++k) {
+    start[k] = triangle.at_origin[k] + triangle.ddx[k] * (x + 0.5f) +
+               triangle.ddy[k] * (y + 0.5f);
+  }
+  const Varyings& ddx = triangle.ddx;
+  float* absl_nonnull r = pixels.r.data() + offset;
+  float* absl_nonnull g = pixels.g.data() + offset;
+  float* absl_nonnull b = pixels.b.data() + offset;
+  float* absl_nonnull a = pixels.a.data() + offset;
+  // This loop is branch-free so that it can be vectorized.
+  for (int i = 0; i < count; ++i) {
+    float step = i;
+    auto varying = [&start, &ddx, step](int k) {
+      return start[k] + ddx[k] * step;
+    };
+    float coverage = SimulatedPixelCoverage(
+        varying(kPixelsPerSide), varying(kPixelsPerForward),
+        varying(kNormalizedToLeft), varying(kNormalizedToRight),
+        varying(kNormalizedToFront), varying(kNormalizedToBack),
+        varying(kOutsetPixelsLeft), varying(kOutsetPixelsRight),
+        varying(kOutsetPixelsFront), varying(kOutsetPixelsBack));
+    float source_alpha = varying(kColorA) * coverage;
+    float inverse_alpha = 1.f - source_alpha;
+    r[i] = varying(kColorR) * coverage + r[i] * inverse_alpha;
+    g[i] = varying(kColorG) * coverage + g[i] * inverse_alpha;
+    b[i] = varying(kColorB) * coverage + b[i] * inverse_alpha;
+    a[i] = source_alpha + a[i] * inverse_alpha;
+  }
+}
+
+float SrgbToLinear(float encoded) {
+  return encoded <= 0.04045f ? encoded / 12.92f
+                             : std::pow((encoded + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSrgb(float linear) {
+  return linear <= 0.0031308f ? linear * 12.92f
+                              : 1.055f * std::pow(linear, 1 / 2.4f) - 0.055f;
+}
+
+// Lookup tables for the sRGB transfer function, indexed by an 8-bit encoded
+// value, and by a linear value scaled to `kLinearToSrgbSteps`.
+constexpr int kLinearToSrgbSteps = 16384;
+
+const std::array<float, 256>& SrgbToLinearTable() {
+  static const std::array<float, 256>* table = [] {
+    auto* table = new std::array<float, 256>;
+    for (int i = 0; i < 256; ++i) (*table)[i] = SrgbToLinear(i / 255.f);
+    return table;
+  }();
+  return *table;
+}
+
+const std::array<float, kLinearToSrgbSteps + 1>& LinearToSrgbTable() {
+  static const std::array<float, kLinearToSrgbSteps + 1>* table = [] {
+    auto* table = new std::array<float, kLinearToSrgbSteps + 1>;
+    for (int i = 0; i <= kLinearToSrgbSteps; ++i) {
+      (*table)[i] =
+          LinearToSrgb(static_cast<float>(i) / kLinearToSrgbSteps);
+    }
+    return table;
+  }();
+  return *table;
+}
+
+void LoadTile(const RasterTarget& target, int tile_x, int tile_y, int width,
+              int height, TilePixels& pixels) {
+  const std::array<float, 256>& to_linear = SrgbToLinearTable();
+  for (int row = 0; row < height; ++row) {
+    const uint8_t* source =
+        target.pixels + (tile_y + row) * target.row_bytes + tile_x * 4;
+    for (int column = 0; column < width; ++column, source += 4) {
+      int i = row * kTileSize + column;
+      int alpha = source[3];
+      if (alpha == 0) {
+        pixels.r[i] = pixels.g[i] = pixels.b[i] = pixels.a[i] = 0;
+        continue;
+      }
+      auto unpremultiplied_linear = [alpha, &to_linear](int channel) {
+        return to_linear[std::min(255, (channel * 255 + alpha / 2) / alpha)];
+      };
+      float a = alpha / 255.f;
+      pixels.r[i] = unpremultiplied_linear(source[0]) * a;
+      pixels.g[i] = unpremultiplied_linear(source[1]) * a;
+      pixels.b[i] = unpremultiplied_linear(source[2]) * a;
+      pixels.a[i] = a;
+    }
+  }
+}
+
+void StoreTile(const TilePixels& pixels, int tile_x, int tile_y, int width,
+               int height, const RasterTarget& target) {
+  const std::array<float, kLinearToSrgbSteps + 1>& to_srgb =
+      LinearToSrgbTable();
+  for (int row = 0; row < height; ++row) {
+    uint8_t* destination =
+        target.pixels + (tile_y + row) * target.row_bytes + tile_x * 4;
+    for (int column = 0; column < width; ++column, destination += 4) {
+      int i = row * kTileSize + column;
+      int alpha = std::lround(Saturate(pixels.a[i]) * 255);
+      if (alpha == 0) {
+        destination[0] = destination[1] = destination[2] = destination[3] = 0;
+        continue;
+      }
+      // Premultiply in gamma-encoded space, as the target format requires.
+      float inverse_alpha = 1.f / pixels.a[i];
+      auto encode = [inverse_alpha, alpha, &to_srgb](float premultiplied) {
+        float linear = Saturate(premultiplied * inverse_alpha);
+        return static_cast<uint8_t>(std::lround(
+            to_srgb[std::lround(linear * kLinearToSrgbSteps)] * alpha));
+      };
+      destination[0] = encode(pixels.r[i]);
+      destination[1] = encode(pixels.g[i]);
+      destination[2] = encode(pixels.b[i]);
+      destination[3] = alpha;
+    }
+  }
+}
+
+}  // namespace
+
+void RasterizeStrokeTriangles(absl::Span<const Mesh> meshes,
+                              const AffineTransform& object_to_target,
+                              const Color& brush_color,
+                              const RasterTarget& target,
+                              Executor* absl_nullable executor) {
+  if (target.width <= 0 || target.height <= 0) return;
+  Color::RgbaFloat color = brush_color.InColorSpace(ColorSpace::kSrgb)
+                               .AsFloat(Color::Format::kLinear);
+
+  std::vector<TriangleSetup> triangles;
+  std::vector<ShadedVertex> vertices;
+  for (const Mesh& mesh : meshes) {
+    VertexAttributeReader attributes(mesh);
+    vertices.clear();
+    vertices.reserve(mesh.VertexCount());
+    for (uint32_t i = 0; i < mesh.VertexCount(); ++i) {
+      vertices.push_back(
+          ShadeVertex(attributes, mesh, i, object_to_target, color));
+    }
+    for (uint32_t i = 0; i < mesh.TriangleCount(); ++i) {
+      std::array<uint32_t, 3> indices = mesh.TriangleIndices(i);
+      if (std::optional<TriangleSetup> triangle = SetUpTriangle(
+              {&vertices[indices[0]], &vertices[indices[1]],
+               &vertices[indices[2]]},
+              target)) {
+        triangles.push_back(*triangle);
+      }
+    }
+  }
+
+  // Bin the triangles by the tiles they may cover, keeping them in draw order.
+  int tile_columns = (target.width + kTileSize - 1) / kTileSize;
+  int tile_rows = (target.height + kTileSize - 1) / kTileSize;
+  std::vector<std::vector<uint32_t>> tile_triangles(tile_columns * tile_rows);
+  for (uint32_t i = 0; i < triangles.size(); ++i) {
+    const TriangleSetup& triangle = triangles[i];
+    for (int row = triangle.y_min / kTileSize;
+         row <= triangle.y_max / kTileSize; ++row) {
+      for (int column = triangle.x_min / kTileSize;
+           column <= triangle.x_max / kTileSize; ++column) {
+        tile_triangles[row * tile_columns + column].push_back(i);
+      }
+    }
+  }
+
+  ParallelFor(executor, tile_triangles.size(), [&](size_t tile_index) {
+    const std::vector<uint32_t>& binned = tile_triangles[tile_index];
+    if (binned.empty()) return;
+    int tile_x = (tile_index % tile_columns) * kTileSize;
+    int tile_y = (tile_index / tile_columns) * kTileSize;
+    int width = std::min(kTileSize, target.width - tile_x);
+    int height = std::min(kTileSize, target.height - tile_y);
+    auto pixels = std::make_unique<TilePixels>();
+    LoadTile(target, tile_x, tile_y, width, height, *pixels);
+    for (uint32_t triangle_index : binned) {
+      const TriangleSetup& triangle = triangles[triangle_index];
+      int y_begin = std::max(triangle.y_min, tile_y);
+      int y_end = std::min(triangle.y_max, tile_y + height - 1);
+      for (int y = y_begin; y <= y_end; ++y) {
+        int first = std::max(triangle.x_min, tile_x);
+        int last = std::min(triangle.x_max, tile_x + width - 1);
+        if (!NarrowToCoveredSpan(triangle, y, first, last)) continue;
+        ShadeSpan(triangle, first, y, last - first + 1,
+                  (y - tile_y) * kTileSize + (first - tile_x), *pixels);
+      }
+    }
+    StoreTile(*pixels, tile_x, tile_y, width, height, target);
+  });
+}
+
+}  // namespace ink::skia_native_internal
@@ -0,0 +1,67 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_INTERNAL_TRIANGLE_RASTERIZER_H_
+#define INK_RENDERING_SKIA_NATIVE_INTERNAL_TRIANGLE_RASTERIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/base/nullability.h"
+#include "absl/types/span.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh.h"
+#include "ink/types/executor.h"
+
+namespace ink::skia_native_internal {
+
+// Pixels with 8-bit R, G, B, and A channels, in that order in memory, holding
+// premultiplied, gamma-encoded sRGB colors. These are the pixels of an
+// `SkPixmap` with `kRGBA_8888_SkColorType`, `kPremul_SkAlphaType`, and an sRGB
+// color space.
+struct RasterTarget {
+  uint8_t* absl_nonnull pixels;
+  int width = 0;
+  int height = 0;
+  size_t row_bytes = 0;
+};
+
+// Draws the triangles of `meshes`, which must be stroke meshes (see
+// `StrokeVertex`), into `target`, blending each one source-over in order.
+// `object_to_target` maps mesh positions to pixel coordinates of `target`, with
+// pixel centers at half-integer coordinates.
+//
+// This computes the same coverage and color as the `SkMesh` shaders of
+// `MeshSpecificationData::CreateForStroke()`, without textures: vertices are
+// outset from the mesh along their derivatives to make room for antialiasing,
+// coverage is derived from the derivatives and margins encoded in the vertex
+// labels, and `brush_color` is shifted by the opacity and HSL shift of each
+// vertex. Blending happens in linear sRGB within a pixel, and the result is
+// stored gamma-encoded. Shared triangle edges are rasterized exactly once, so
+// partially transparent strokes accumulate opacity only where they really
+// overlap themselves, as on the GPU.
+//
+// The target is split into tiles, which are rasterized in parallel on
+// `executor` if it is non-null. Triangles with a vertex more than 2^20 pixels
+// outside of the target are skipped.
+void RasterizeStrokeTriangles(absl::Span<const Mesh> meshes,
+                              const AffineTransform& object_to_target,
+                              const Color& brush_color,
+                              const RasterTarget& target,
+                              Executor* absl_nullable executor = nullptr);
+
+}  // namespace ink::skia_native_internal
+
+#endif  // INK_RENDERING_SKIA_NATIVE_INTERNAL_TRIANGLE_RASTERIZER_H_
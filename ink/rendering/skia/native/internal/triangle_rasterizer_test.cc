@@ -0,0 +1,232 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/internal/triangle_rasterizer.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/vec.h"
+#include "ink/strokes/internal/stroke_vertex.h"
+#include "ink/types/test_executor.h"
+
+namespace ink::skia_native_internal {
+namespace {
+
+using ::ink::strokes_internal::StrokeVertex;
+
+// RGBA8888 pixels of a target with `width` by `height` pixels.
+class TestTarget {
+ public:
+  TestTarget(int width, int height)
+      : width_(width), height_(height), pixels_(4 * width * height, 0) {}
+
+  RasterTarget Target() {
+    return {.pixels = pixels_.data(),
+            .width = width_,
+            .height = height_,
+            .row_bytes = static_cast<size_t>(4 * width_)};
+  }
+
+  std::array<uint8_t, 4> Pixel(int x, int y) const {
+    const uint8_t* pixel = &pixels_[4 * (y * width_ + x)];
+    return {pixel[0], pixel[1], pixel[2], pixel[3]};
+  }
+
+  uint8_t Alpha(int x, int y) const { return Pixel(x, y)[3]; }
+
+  const std::vector<uint8_t>& Pixels() const { return pixels_; }
+
+ private:
+  int width_;
+  int height_;
+  std::vector<uint8_t> pixels_;
+};
+
+Mesh MakeStrokeMesh(const MutableMesh& mutable_mesh) {
+  StrokeVertex::CustomPackingArray packing_params =
+      StrokeVertex::MakeCustomPackingArray(mutable_mesh.Format());
+  absl::StatusOr<absl::InlinedVector<Mesh, 1>> meshes =
+      mutable_mesh.AsMeshes(packing_params.Values());
+  ABSL_CHECK_OK(meshes);
+  ABSL_CHECK_EQ(meshes->size(), 1u);
+  return meshes->front();
+}
+
+// Returns a rectangle made of two triangles sharing the diagonal from
+// `min` to `max`, with every vertex in the interior of the stroke, so that
+// nothing is antialiased.
+Mesh MakeInteriorRectangle(Point min, Point max, float opacity_shift = 0) {
+  MutableMesh mesh(StrokeVertex::FullMeshFormat());
+  for (Point position : {min, Point{max.x, min.y}, max, Point{min.x, max.y}}) {
+    StrokeVertex::AppendToMesh(
+        mesh, {.position = position,
+               .non_position_attributes = {.opacity_shift = opacity_shift}});
+  }
+  mesh.AppendTriangleIndices({0, 1, 2});
+  mesh.AppendTriangleIndices({0, 2, 3});
+  return MakeStrokeMesh(mesh);
+}
+
+// Returns a horizontal band from `x_min` to `x_max` between `y_min` and
+// `y_max`, shaded like a straight stroke segment whose left and right edges
+// are the top and bottom of the band.
+Mesh MakeHorizontalBand(float x_min, float x_max, float y_min, float y_max) {
+  MutableMesh mesh(StrokeVertex::FullMeshFormat());
+  Vec side_derivative = {0, y_max - y_min};
+  Vec forward_derivative = {x_max - x_min, 0};
+  for (float x : {x_min, x_max}) {
+    StrokeVertex::AppendToMesh(
+        mesh, {.position = {x, y_min},
+               .non_position_attributes = {
+                   .side_derivative = side_derivative,
+                   .side_label = StrokeVertex::kExteriorLeftLabel,
+                   .forward_derivative = forward_derivative}});
+    StrokeVertex::AppendToMesh(
+        mesh, {.position = {x, y_max},
+               .non_position_attributes = {
+                   .side_derivative = side_derivative,
+                   .side_label = StrokeVertex::kExteriorRightLabel,
+                   .forward_derivative = forward_derivative}});
+  }
+  mesh.AppendTriangleIndices({0, 2, 1});
+  mesh.AppendTriangleIndices({1, 2, 3});
+  return MakeStrokeMesh(mesh);
+}
+
+TEST(TriangleRasterizerTest, SharedEdgesAreDrawnOnce) {
+  TestTarget target(24, 16);
+  std::vector<Mesh> meshes = {MakeInteriorRectangle({2.3, 2.1}, {20.7, 12.6})};
+  Color color = Color::FromFloat(1, 0, 0, 0.5, Color::Format::kGammaEncoded);
+
+  RasterizeStrokeTriangles(meshes, AffineTransform(), color, target.Target());
+
+  // Pixels are covered if their centers are inside the rectangle, and are all
+  // blended exactly once, including along the shared diagonal.
+  for (int y = 0; y < 16; ++y) {
+    for (int x = 0; x < 24; ++x) {
+      bool inside = x >= 2 && x <= 20 && y >= 2 && y <= 12;
+      if (inside) {
+        EXPECT_EQ(target.Pixel(x, y), (std::array<uint8_t, 4>{128, 0, 0, 128}))
+            << "at (" << x << ", " << y << ")";
+      } else {
+        EXPECT_EQ(target.Alpha(x, y), 0) << "at (" << x << ", " << y << ")";
+      }
+    }
+  }
+}
+
+TEST(TriangleRasterizerTest, OverlappingMeshesAccumulateOpacity) {
+  TestTarget target(16, 16);
+  Mesh rectangle = MakeInteriorRectangle({2, 2}, {14, 14});
+  std::vector<Mesh> meshes = {rectangle, rectangle};
+  Color color = Color::FromFloat(0, 0, 0, 0.5, Color::Format::kGammaEncoded);
+
+  RasterizeStrokeTriangles(meshes, AffineTransform(), color, target.Target());
+
+  EXPECT_NEAR(target.Alpha(8, 8), 191, 1);
+}
+
+TEST(TriangleRasterizerTest, ExteriorEdgesAreAntialiased) {
+  TestTarget target(80, 30);
+  std::vector<Mesh> meshes = {MakeHorizontalBand(4, 60, 10, 18)};
+
+  RasterizeStrokeTriangles(meshes, AffineTransform(), Color::Black(),
+                           target.Target());
+
+  EXPECT_EQ(target.Alpha(30, 14), 255);
+  EXPECT_EQ(target.Alpha(30, 7), 0);
+  EXPECT_EQ(target.Alpha(30, 21), 0);
+  // The pixels straddling the top and bottom edges of the band are partially
+  // covered, symmetrically.
+  EXPECT_GT(target.Alpha(30, 9), 0);
+  EXPECT_LT(target.Alpha(30, 10), 255);
+  EXPECT_EQ(target.Alpha(30, 9), target.Alpha(30, 18));
+  EXPECT_EQ(target.Alpha(30, 10), target.Alpha(30, 17));
+}
+
+TEST(TriangleRasterizerTest, OpacityShiftScalesAlpha) {
+  TestTarget unshifted(16, 16);
+  TestTarget shifted(16, 16);
+  std::vector<Mesh> unshifted_meshes = {
+      MakeInteriorRectangle({2, 2}, {14, 14})};
+  std::vector<Mesh> shifted_meshes = {
+      MakeInteriorRectangle({2, 2}, {14, 14}, /*opacity_shift=*/-0.5)};
+
+  RasterizeStrokeTriangles(unshifted_meshes, AffineTransform(), Color::Blue(),
+                           unshifted.Target());
+  RasterizeStrokeTriangles(shifted_meshes, AffineTransform(), Color::Blue(),
+                           shifted.Target());
+
+  EXPECT_EQ(unshifted.Alpha(8, 8), 255);
+  EXPECT_NEAR(shifted.Alpha(8, 8), 128, 1);
+}
+
+TEST(TriangleRasterizerTest, AppliesObjectToTargetTransform) {
+  TestTarget target(32, 32);
+  std::vector<Mesh> meshes = {MakeInteriorRectangle({0, 0}, {1, 1})};
+
+  RasterizeStrokeTriangles(
+      meshes,
+      AffineTransform::Translate({8, 4}) * AffineTransform::Scale(10, 20),
+      Color::Black(), target.Target());
+
+  EXPECT_EQ(target.Alpha(8, 4), 255);
+  EXPECT_EQ(target.Alpha(17, 23), 255);
+  EXPECT_EQ(target.Alpha(7, 4), 0);
+  EXPECT_EQ(target.Alpha(18, 23), 0);
+  EXPECT_EQ(target.Alpha(17, 24), 0);
+}
+
+TEST(TriangleRasterizerTest, ParallelTilesMatchSerialRasterization) {
+  std::vector<Mesh> meshes = {MakeHorizontalBand(4, 60, 10, 18),
+                              MakeInteriorRectangle({2.3, 2.1}, {20.7, 12.6})};
+  AffineTransform transform = AffineTransform::Scale(4.5) *
+                              AffineTransform::Rotate(Angle::Degrees(10));
+  Color color = Color::FromFloat(0.2, 0.6, 0.4, 0.7);
+  TestTarget serial(300, 200);
+  TestTarget parallel(300, 200);
+  ThreadPerTaskExecutor executor;
+
+  RasterizeStrokeTriangles(meshes, transform, color, serial.Target());
+  RasterizeStrokeTriangles(meshes, transform, color, parallel.Target(),
+                           &executor);
+
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+  EXPECT_EQ(serial.Pixels(), parallel.Pixels());
+}
+
+TEST(TriangleRasterizerTest, SkipsTrianglesFarOutsideTheTarget) {
+  TestTarget target(16, 16);
+  std::vector<Mesh> meshes = {MakeInteriorRectangle({0, 0}, {1, 1})};
+
+  RasterizeStrokeTriangles(meshes, AffineTransform::Scale(1e9),
+                           Color::Black(), target.Target());
+
+  EXPECT_EQ(target.Pixels(), std::vector<uint8_t>(4 * 16 * 16, 0));
+}
+
+}  // namespace
+}  // namespace ink::skia_native_internal
@@ -0,0 +1,132 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/persistent_pipeline_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+
+namespace ink {
+namespace {
+
+// The serialized format is this magic string, followed by each entry as its
+// key and then its data, each of which is a little-endian 32-bit length
+// followed by that many bytes.
+constexpr absl::string_view kMagic = "InkPipelineCache1";
+
+absl::string_view ToStringView(const SkData& data) {
+  return absl::string_view(static_cast<const char*>(data.data()), data.size());
+}
+
+void AppendChunk(absl::string_view chunk, std::string& out) {
+  uint32_t size = static_cast<uint32_t>(chunk.size());
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>((size >> (8 * i)) & 0xff));
+  }
+  out.append(chunk.data(), chunk.size());
+}
+
+// Reads the next chunk from the front of `in` into `chunk`, and removes it
+// from `in`. Returns false if `in` is too short.
+bool ReadChunk(absl::string_view& in, absl::string_view& chunk) {
+  if (in.size() < 4) return false;
+  uint32_t size = 0;
+  for (int i = 0; i < 4; ++i) {
+    size |= static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+  }
+  in.remove_prefix(4);
+  if (in.size() < size) return false;
+  chunk = in.substr(0, size);
+  in.remove_prefix(size);
+  return true;
+}
+
+}  // namespace
+
+sk_sp<SkData> PersistentPipelineCache::load(const SkData& key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(ToStringView(key));
+  if (it == entries_.end()) return nullptr;
+  return it->second;
+}
+
+void PersistentPipelineCache::store(const SkData& key, const SkData& data,
+                                    const SkString& description) {
+  sk_sp<SkData> copy = SkData::MakeWithCopy(data.data(), data.size());
+  absl::MutexLock lock(&mutex_);
+  entries_.insert_or_assign(std::string(ToStringView(key)), std::move(copy));
+  has_unsaved_changes_ = true;
+}
+
+std::string PersistentPipelineCache::Serialize() const {
+  absl::MutexLock lock(&mutex_);
+  std::string out(kMagic);
+  for (const auto& [key, data] : entries_) {
+    AppendChunk(key, out);
+    AppendChunk(ToStringView(*data), out);
+  }
+  has_unsaved_changes_ = false;
+  return out;
+}
+
+absl::Status PersistentPipelineCache::Deserialize(
+    absl::string_view serialized) {
+  if (!absl::ConsumePrefix(&serialized, kMagic)) {
+    return absl::InvalidArgumentError(
+        "Serialized pipeline cache has an unrecognized header");
+  }
+  std::vector<std::pair<absl::string_view, absl::string_view>> entries;
+  while (!serialized.empty()) {
+    absl::string_view key;
+    absl::string_view data;
+    if (!ReadChunk(serialized, key) || !ReadChunk(serialized, data)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Serialized pipeline cache is truncated after ",
+                       entries.size(), " entries"));
+    }
+    entries.emplace_back(key, data);
+  }
+
+  absl::MutexLock lock(&mutex_);
+  for (const auto& [key, data] : entries) {
+    entries_.insert_or_assign(std::string(key),
+                              SkData::MakeWithCopy(data.data(), data.size()));
+  }
+  has_unsaved_changes_ = false;
+  return absl::OkStatus();
+}
+
+size_t PersistentPipelineCache::EntryCount() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+bool PersistentPipelineCache::HasUnsavedChanges() const {
+  absl::MutexLock lock(&mutex_);
+  return has_unsaved_changes_;
+}
+
+}  // namespace ink
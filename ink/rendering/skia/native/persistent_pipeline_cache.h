@@ -0,0 +1,86 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_PERSISTENT_PIPELINE_CACHE_H_
+#define INK_RENDERING_SKIA_NATIVE_PERSISTENT_PIPELINE_CACHE_H_
+
+#include <cstddef>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+#include "include/gpu/ganesh/GrContextOptions.h"
+
+namespace ink {
+
+// An in-memory implementation of Skia's persistent cache for compiled GPU
+// programs, which can be saved and restored across launches of an app.
+//
+// Pass a pointer to an instance as `GrContextOptions::fPersistentCache` when
+// creating the `GrDirectContext` used with a `SkiaRenderer`. Skia stores the
+// programs it compiles for Ink's mesh specifications and shaders, and loads
+// them instead of compiling them again. To keep them across launches, write
+// the result of `Serialize()` to disk, e.g. when the app is backgrounded, and
+// pass it to `Deserialize()` before creating the context on the next launch.
+//
+// The serialized data is only meaningful for the same GPU driver and Skia
+// version; Skia detects stale programs itself and recompiles them.
+//
+// This type is thread-safe, and must outlive any context it is passed to.
+class PersistentPipelineCache : public GrContextOptions::PersistentCache {
+ public:
+  PersistentPipelineCache() = default;
+  PersistentPipelineCache(const PersistentPipelineCache&) = delete;
+  PersistentPipelineCache& operator=(const PersistentPipelineCache&) = delete;
+  ~PersistentPipelineCache() override = default;
+
+  // `GrContextOptions::PersistentCache` overrides, called by Skia.
+  sk_sp<SkData> load(const SkData& key) override;
+  using GrContextOptions::PersistentCache::store;
+  void store(const SkData& key, const SkData& data,
+             const SkString& description) override;
+
+  // Returns every entry in a format that can be passed to `Deserialize()`.
+  std::string Serialize() const;
+
+  // Adds the entries in `serialized`, which must have been returned by
+  // `Serialize()`, replacing any existing entries with the same keys.
+  //
+  // Returns an invalid-argument error, and adds nothing, if `serialized` is
+  // malformed.
+  absl::Status Deserialize(absl::string_view serialized);
+
+  // Returns the number of cached programs.
+  size_t EntryCount() const;
+
+  // Returns true if an entry has been stored since the last call to
+  // `Serialize()` or `Deserialize()`, i.e. if the cache needs saving again.
+  bool HasUnsavedChanges() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, sk_sp<SkData>> entries_
+      ABSL_GUARDED_BY(mutex_);
+  mutable bool has_unsaved_changes_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace ink
+
+#endif  // INK_RENDERING_SKIA_NATIVE_PERSISTENT_PIPELINE_CACHE_H_
@@ -0,0 +1,108 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/persistent_pipeline_cache.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
+
+namespace ink {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::IsNull;
+
+sk_sp<SkData> MakeData(absl::string_view value) {
+  return SkData::MakeWithCopy(value.data(), value.size());
+}
+
+std::string ToString(const sk_sp<SkData>& data) {
+  return std::string(static_cast<const char*>(data->data()), data->size());
+}
+
+TEST(PersistentPipelineCacheTest, LoadMissingKey) {
+  PersistentPipelineCache cache;
+  EXPECT_THAT(cache.load(*MakeData("key")), IsNull());
+  EXPECT_EQ(cache.EntryCount(), 0u);
+  EXPECT_FALSE(cache.HasUnsavedChanges());
+}
+
+TEST(PersistentPipelineCacheTest, StoreThenLoad) {
+  PersistentPipelineCache cache;
+  cache.store(*MakeData("key"), *MakeData("program"), SkString("description"));
+  EXPECT_EQ(cache.EntryCount(), 1u);
+  EXPECT_TRUE(cache.HasUnsavedChanges());
+
+  sk_sp<SkData> loaded = cache.load(*MakeData("key"));
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(ToString(loaded), "program");
+
+  cache.store(*MakeData("key"), *MakeData("new program"), SkString());
+  EXPECT_EQ(cache.EntryCount(), 1u);
+  EXPECT_EQ(ToString(cache.load(*MakeData("key"))), "new program");
+}
+
+TEST(PersistentPipelineCacheTest, SerializeRoundTrip) {
+  PersistentPipelineCache cache;
+  cache.store(*MakeData("a"), *MakeData("first"), SkString());
+  cache.store(*MakeData(std::string("b\0c", 3)),
+              *MakeData(std::string(300, 'x')), SkString());
+  cache.store(*MakeData("empty"), *MakeData(""), SkString());
+  std::string serialized = cache.Serialize();
+  EXPECT_FALSE(cache.HasUnsavedChanges());
+
+  PersistentPipelineCache restored;
+  ASSERT_EQ(restored.Deserialize(serialized), absl::OkStatus());
+  EXPECT_EQ(restored.EntryCount(), 3u);
+  EXPECT_FALSE(restored.HasUnsavedChanges());
+  EXPECT_EQ(ToString(restored.load(*MakeData("a"))), "first");
+  EXPECT_EQ(ToString(restored.load(*MakeData(std::string("b\0c", 3)))),
+            std::string(300, 'x'));
+  EXPECT_EQ(ToString(restored.load(*MakeData("empty"))), "");
+}
+
+TEST(PersistentPipelineCacheTest, SerializeEmpty) {
+  PersistentPipelineCache cache;
+  PersistentPipelineCache restored;
+  ASSERT_EQ(restored.Deserialize(cache.Serialize()), absl::OkStatus());
+  EXPECT_EQ(restored.EntryCount(), 0u);
+}
+
+TEST(PersistentPipelineCacheTest, DeserializeMalformed) {
+  PersistentPipelineCache source;
+  source.store(*MakeData("key"), *MakeData("program"), SkString());
+  std::string serialized = source.Serialize();
+
+  PersistentPipelineCache cache;
+  absl::Status bad_header = cache.Deserialize("not a pipeline cache");
+  EXPECT_EQ(bad_header.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(bad_header.message(), HasSubstr("header"));
+
+  absl::Status truncated =
+      cache.Deserialize(absl::string_view(serialized).substr(
+          0, serialized.size() - 1));
+  EXPECT_EQ(truncated.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(truncated.message(), HasSubstr("truncated"));
+  EXPECT_EQ(cache.EntryCount(), 0u);
+}
+
+}  // namespace
+}  // namespace ink
@@ -14,52 +14,99 @@
 
 #include "ink/rendering/skia/native/skia_renderer.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/nullability.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/overload.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush.h"
+#include "ink/brush/brush_behavior.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
 #include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/brush/texture_handle.h"
 #include "ink/color/color.h"
+#include "ink/color/color_space.h"
 #include "ink/geometry/affine_transform.h"
+#include "ink/geometry/envelope.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_packing_types.h"
 #include "ink/geometry/mutable_mesh.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
 #include "ink/geometry/rect.h"
+#include "ink/geometry/scene_index.h"
+#include "ink/rendering/skia/common_internal/mesh_specification_data.h"
+#include "ink/rendering/skia/native/internal/growable_mesh_buffers.h"
+#include "ink/rendering/skia/native/internal/mesh_buffer_cache.h"
 #include "ink/rendering/skia/native/internal/mesh_drawable.h"
 #include "ink/rendering/skia/native/internal/mesh_uniform_data.h"
+#include "ink/rendering/skia/native/internal/path_cache.h"
 #include "ink/rendering/skia/native/internal/path_drawable.h"
+#include "ink/rendering/skia/native/internal/shader_cache.h"
+#include "ink/rendering/skia/native/internal/texture_atlas.h"
+#include "ink/rendering/skia/native/internal/triangle_drawable.h"
 #include "ink/rendering/skia/native/texture_bitmap_store.h"
 #include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/brush_tip_state.h"
+#include "ink/strokes/internal/particle_stamps.h"
+#include "ink/strokes/internal/stroke_vertex.h"
+#include "ink/strokes/performance_profile.h"
 #include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkBlender.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
 #include "include/core/SkM44.h"
 #include "include/core/SkMesh.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkTileMode.h"
+#include "include/core/SkVertices.h"
 #include "include/gpu/ganesh/GrDirectContext.h"
 #include "include/gpu/ganesh/SkMeshGanesh.h"
+#include "ink/types/trace.h"
 
 namespace ink {
 namespace {
 
+using ::ink::skia_common_internal::StrokeShaderFeatures;
+using ::ink::skia_native_internal::GrowableMeshBuffers;
+using ::ink::skia_native_internal::MeshBufferCache;
 using ::ink::skia_native_internal::MeshDrawable;
 using ::ink::skia_native_internal::MeshUniformData;
 using ::ink::skia_native_internal::PathDrawable;
+using ::ink::skia_native_internal::ShaderCache;
+using ::ink::skia_native_internal::TextureAtlasOptions;
+using ::ink::skia_native_internal::ToSkBlendMode;
+using ::ink::skia_native_internal::TriangleDrawable;
+using ::ink::strokes_internal::BrushTipState;
+using ::ink::strokes_internal::StrokeVertex;
 
 void FillTemporaryIndices(const MutableMesh& mesh,
                           std::vector<uint16_t>& temporary_indices) {
@@ -77,13 +124,13 @@ SkRect ToSkiaRect(const Rect& rect) {
 }
 
 // Returns true if the renderer should use `SkPath` instead of `SkMesh` for
-// rendering.
+// rendering, given whether the strokes are going to be rasterized on the CPU.
 //
 // TODO: b/346530293 - Also use the `BrushPaint` for the decision once the paint
 // has a setting for opacity behavior on self-overlap. This would make it
 // possible that a single `Drawable` holds a mix of meshes and paths.
-bool UsePathRendering(GrDirectContext* context, const BrushPaint&) {
-  return context == nullptr;
+bool UsePathRendering(bool cpu_rendering, const BrushPaint&) {
+  return cpu_rendering;
 }
 
 // Returns the color opacity multiplier when `SkPath` should be used for
@@ -107,28 +154,173 @@ BrushPaint::TextureMapping GetBrushPaintTextureMapping(
                                        : BrushPaint::TextureMapping::kTiling;
 }
 
+// Sets the texture-animation uniforms of `drawable`, if it has them, from the
+// texture layers of `paint`, which all share the same animation settings.
+void SetTextureAnimation(const BrushPaint& paint, MeshDrawable& drawable) {
+  if (!drawable.HasTextureAnimation() || paint.texture_layers.empty()) return;
+  drawable.SetTextureAnimation(paint.texture_layers[0]);
+}
+
+// The Skia objects and shader features for drawing a brush coat as a mesh.
+struct CoatShading {
+  sk_sp<SkShader> shader;
+  sk_sp<SkBlender> blender;
+  StrokeShaderFeatures features;
+  // True if the coat is drawn without its textures, because one of them is not
+  // loaded yet.
+  bool missing_textures = false;
+};
+
+// Returns the shading for a coat with the given `paint`. While a texture of the
+// paint is not loaded yet, as signaled by the texture provider with an
+// unavailable error, the coat is shaded as if the paint had no texture layers.
+absl::StatusOr<CoatShading> GetCoatShading(
+    ShaderCache& shader_cache, const BrushPaint& paint,
+    absl::Span<const TextureHandle> texture_handles, float brush_size,
+    const StrokeInputBatch& inputs) {
+  absl::StatusOr<sk_sp<SkShader>> shader = shader_cache.GetShaderForPaint(
+      paint, texture_handles, brush_size, inputs);
+  if (absl::IsUnavailable(shader.status())) {
+    return CoatShading{.features = StrokeShaderFeatures::ForPaint(BrushPaint{}),
+                       .missing_textures = true};
+  }
+  if (!shader.ok()) return shader.status();
+  return CoatShading{.shader = *std::move(shader),
+                     .blender = shader_cache.GetBlenderForPaint(paint),
+                     .features = StrokeShaderFeatures::ForPaint(paint)};
+}
+
 }  // namespace
 
 SkiaRenderer::SkiaRenderer(
     absl_nullable std::shared_ptr<TextureBitmapStore> texture_provider)
     : texture_provider_(std::move(texture_provider)),
-      shader_cache_(texture_provider_.get()) {}
+      shader_cache_(std::make_shared<ShaderCache>(texture_provider_.get())) {}
+
+SkiaRenderer::SkiaRenderer(
+    absl_nullable std::shared_ptr<TextureBitmapStore> texture_provider,
+    absl_nonnull std::shared_ptr<ShaderCache> shader_cache)
+    : texture_provider_(std::move(texture_provider)),
+      shader_cache_(std::move(shader_cache)) {}
+
+SkiaRenderer SkiaRenderer::CreateRendererSharingTextures() const {
+  return SkiaRenderer(texture_provider_, shader_cache_);
+}
+
+absl::Status SkiaRenderer::PrewarmMeshSpecifications(
+    Executor* absl_nullable executor) {
+  // Every `Stroke` built by Ink has meshes with this format, and every
+  // `BrushPaint` needs one of these sets of features.
+  return specification_cache_.Prewarm(
+      {StrokeVertex::FullMeshFormat()},
+      {StrokeShaderFeatures::ForPaint(BrushPaint{}),
+       StrokeShaderFeatures{
+           .texture_coordinates = true,
+           .texture_mapping = BrushPaint::TextureMapping::kTiling},
+       StrokeShaderFeatures{
+           .texture_coordinates = true,
+           .texture_mapping = BrushPaint::TextureMapping::kStamping}},
+      executor);
+}
+
+void SkiaRenderer::SetTextureCacheMaxBytes(size_t max_bytes) {
+  shader_cache_->SetMaxImageBytes(max_bytes);
+}
+
+void SkiaRenderer::SetTextureMipmapsEnabled(bool enabled) {
+  shader_cache_->SetMipmapsEnabled(enabled);
+}
+
+void SkiaRenderer::SetCpuTriangleRasterizationEnabled(
+    bool enabled, Executor* absl_nullable executor) {
+  if (enabled != cpu_triangle_rasterization_enabled_ ||
+      executor != cpu_triangle_rasterization_executor_) {
+    // Retained drawables for CPU rendering hold paths or triangles depending on
+    // this setting.
+    ClearDrawableCache();
+  }
+  cpu_triangle_rasterization_enabled_ = enabled;
+  cpu_triangle_rasterization_executor_ = executor;
+}
+
+absl::Status SkiaRenderer::PrewarmBrushFamilies(
+    absl::Span<const BrushFamily> families) {
+  absl::Status status;
+  for (const BrushFamily& family : families) {
+    for (const BrushCoat& coat : family.GetCoats()) {
+      status.Update(shader_cache_->Prewarm(coat.paint));
+    }
+  }
+  return status;
+}
+
+absl::Status SkiaRenderer::BuildTextureAtlas(
+    absl::Span<const BrushFamily> families, int page_size) {
+  std::vector<std::string> texture_ids;
+  absl::flat_hash_set<std::string> seen_texture_ids;
+  for (const BrushFamily& family : families) {
+    for (const BrushCoat& coat : family.GetCoats()) {
+      for (const BrushPaint::TextureLayer& layer : coat.paint.texture_layers) {
+        if (layer.mapping == BrushPaint::TextureMapping::kStamping &&
+            seen_texture_ids.insert(layer.client_texture_id).second) {
+          texture_ids.push_back(layer.client_texture_id);
+        }
+      }
+    }
+  }
+  return shader_cache_->BuildTextureAtlas(
+      texture_ids, TextureAtlasOptions{.page_size = page_size,
+                                       .max_texture_size = page_size / 4});
+}
 
 absl::StatusOr<SkiaRenderer::Drawable> SkiaRenderer::CreateDrawable(
     GrDirectContext* context, const InProgressStroke& stroke,
     const AffineTransform& object_to_canvas) {
+  Drawable drawable(object_to_canvas, {});
+  if (absl::Status status =
+          FillDrawable(context, stroke, /*incremental=*/false, drawable);
+      !status.ok()) {
+    return status;
+  }
+  return drawable;
+}
+
+absl::Status SkiaRenderer::UpdateDrawable(GrDirectContext* context,
+                                          const InProgressStroke& stroke,
+                                          Drawable& drawable) {
+  return FillDrawable(context, stroke, /*incremental=*/true, drawable);
+}
+
+absl::Status SkiaRenderer::FillDrawable(GrDirectContext* context,
+                                        const InProgressStroke& stroke,
+                                        bool incremental, Drawable& drawable) {
   const Brush* brush = stroke.GetBrush();
   if (brush == nullptr) {
-    return Drawable(object_to_canvas, {});
+    drawable.drawable_implementations_.clear();
+    drawable.coat_buffers_.clear();
+    return absl::OkStatus();
   }
 
   uint32_t num_coats = brush->CoatCount();
+  if (drawable.coat_buffers_.size() != num_coats) {
+    drawable.coat_buffers_.clear();
+    drawable.coat_buffers_.resize(num_coats);
+    incremental = false;
+  }
+
   absl::InlinedVector<Drawable::Implementation, 1> drawables;
   drawables.reserve(num_coats);
+  bool missing_textures = false;
   for (uint32_t coat_index = 0; coat_index < num_coats; ++coat_index) {
-    if (stroke.GetMeshBounds(coat_index).IsEmpty()) continue;
+    GrowableMeshBuffers& buffers = drawable.coat_buffers_[coat_index];
+    if (stroke.GetMeshBounds(coat_index).IsEmpty()) {
+      buffers = GrowableMeshBuffers();
+      continue;
+    }
 
-    if (UsePathRendering(context, brush->GetCoats()[coat_index].paint)) {
+    if (UsePathRendering(context == nullptr,
+                         brush->GetCoats()[coat_index].paint)) {
+      buffers = GrowableMeshBuffers();
       drawables.push_back(PathDrawable(
           stroke.GetMesh(coat_index), stroke.GetCoatOutlines(coat_index),
           brush->GetColor(), OpacityMultiplierForPath(*brush, coat_index)));
@@ -136,12 +328,15 @@ absl::StatusOr<SkiaRenderer::Drawable> SkiaRenderer::CreateDrawable(
     }
 
     const BrushPaint& brush_paint = brush->GetCoats()[coat_index].paint;
-    absl::StatusOr<sk_sp<SkShader>> shader = shader_cache_.GetShaderForPaint(
-        brush_paint, brush->GetSize(), stroke.GetInputs());
-    if (!shader.ok()) return shader.status();
+    absl::StatusOr<CoatShading> shading = GetCoatShading(
+        *shader_cache_, brush_paint,
+        brush->GetFamily().GetTextureHandles(coat_index), brush->GetSize(),
+        stroke.GetInputs());
+    if (!shading.ok()) return shading.status();
+    missing_textures |= shading->missing_textures;
 
     absl::StatusOr<sk_sp<SkMeshSpecification>> specification =
-        specification_cache_.GetFor(stroke);
+        specification_cache_.GetFor(stroke, shading->features);
     if (!specification.ok()) return specification.status();
 
     const MutableMesh& mesh = stroke.GetMesh(coat_index);
@@ -150,18 +345,42 @@ absl::StatusOr<SkiaRenderer::Drawable> SkiaRenderer::CreateDrawable(
           "Strokes requiring at least 2^16 indices are not supported yet.");
     }
 
-    absl::Span<const std::byte> vertex_data = mesh.RawVertexData();
+    // Data before the first updated vertex and triangle is already in the
+    // buffers, unless they are being created from scratch.
+    size_t unchanged_vertex_bytes = 0;
+    size_t unchanged_index_bytes = 0;
+    if (incremental) {
+      std::optional<uint32_t> first_vertex =
+          stroke.GetCoatFirstUpdatedVertex(coat_index);
+      std::optional<uint32_t> first_triangle =
+          stroke.GetCoatFirstUpdatedTriangle(coat_index);
+      unchanged_vertex_bytes =
+          first_vertex.has_value()
+              ? *first_vertex * mesh.Format().UnpackedVertexStride()
+              : std::numeric_limits<size_t>::max();
+      unchanged_index_bytes =
+          first_triangle.has_value()
+              ? *first_triangle * 3 * sizeof(uint16_t)
+              : std::numeric_limits<size_t>::max();
+    }
+
     FillTemporaryIndices(mesh, temporary_indices_);
+    if (absl::Status status = buffers.Update(
+            context, mesh.RawVertexData(), unchanged_vertex_bytes,
+            absl::MakeConstSpan(
+                reinterpret_cast<const std::byte*>(temporary_indices_.data()),
+                temporary_indices_.size() * sizeof(uint16_t)),
+            unchanged_index_bytes);
+        !status.ok()) {
+      return status;
+    }
 
     absl::StatusOr<MeshDrawable> mesh_drawable = MeshDrawable::Create(
-        *std::move(specification),
-        shader_cache_.GetBlenderForPaint(brush_paint), *std::move(shader),
+        *std::move(specification), std::move(shading->blender),
+        std::move(shading->shader),
         {{
-            .vertex_buffer = SkMeshes::MakeVertexBuffer(
-                context, vertex_data.data(), vertex_data.size()),
-            .index_buffer = SkMeshes::MakeIndexBuffer(
-                context, temporary_indices_.data(),
-                temporary_indices_.size() * sizeof(uint16_t)),
+            .vertex_buffer = buffers.VertexBuffer(),
+            .index_buffer = buffers.IndexBuffer(),
             .vertex_count = static_cast<int32_t>(mesh.VertexCount()),
             .index_count = static_cast<int32_t>(3 * mesh.TriangleCount()),
             .bounds = ToSkiaRect(*stroke.GetMeshBounds(coat_index).AsRect()),
@@ -169,17 +388,40 @@ absl::StatusOr<SkiaRenderer::Drawable> SkiaRenderer::CreateDrawable(
     if (!mesh_drawable.ok()) return mesh_drawable.status();
 
     mesh_drawable->SetBrushColor(brush->GetColor());
-    mesh_drawable->SetTextureMapping(GetBrushPaintTextureMapping(brush_paint));
+    if (mesh_drawable->HasTextureMapping()) {
+      mesh_drawable->SetTextureMapping(
+          GetBrushPaintTextureMapping(brush_paint));
+    }
+    SetTextureAnimation(brush_paint, *mesh_drawable);
     drawables.push_back(*std::move(mesh_drawable));
   }
 
-  return Drawable(object_to_canvas, std::move(drawables));
+  drawable.drawable_implementations_ = std::move(drawables);
+  drawable.missing_textures_ = missing_textures;
+  drawable.SetObjectToCanvas(drawable.object_to_canvas_);
+  drawable.SetTextureAnimationTime(drawable.texture_animation_time_);
+  if (drawable.image_filter_ != nullptr) {
+    drawable.SetImageFilter(drawable.image_filter_);
+  }
+  return absl::OkStatus();
 }
 
 absl::StatusOr<SkiaRenderer::Drawable> SkiaRenderer::CreateDrawable(
     GrDirectContext* context, const Stroke& stroke,
-    const AffineTransform& object_to_canvas) {
-  const PartitionedMesh& stroke_shape = stroke.GetShape();
+    const AffineTransform& object_to_canvas, uint32_t level_of_detail) {
+  bool cpu_rendering = context == nullptr;
+  return CreateStrokeDrawable(
+      context, cpu_rendering,
+      cpu_rendering && cpu_triangle_rasterization_enabled_, &mesh_buffer_cache_,
+      stroke, object_to_canvas, level_of_detail);
+}
+
+absl::StatusOr<SkiaRenderer::Drawable> SkiaRenderer::CreateStrokeDrawable(
+    GrDirectContext* context, bool cpu_rendering, bool rasterize_triangles,
+    MeshBufferCache* absl_nullable mesh_buffer_cache, const Stroke& stroke,
+    const AffineTransform& object_to_canvas, uint32_t level_of_detail) const {
+  const PartitionedMesh& stroke_shape =
+      stroke.GetShapeAtLevelOfDetail(level_of_detail);
   if (stroke_shape.RenderGroupCount() == 0) {
     return Drawable(object_to_canvas, {});
   }
@@ -191,41 +433,61 @@ absl::StatusOr<SkiaRenderer::Drawable> SkiaRenderer::CreateDrawable(
 
   absl::InlinedVector<Drawable::Implementation, 1> drawables;
   drawables.reserve(num_coats);
+  bool missing_textures = false;
   for (uint32_t coat_index = 0; coat_index < num_coats; ++coat_index) {
     absl::Span<const Mesh> meshes = stroke_shape.RenderGroupMeshes(coat_index);
     if (meshes.empty()) continue;
 
-    if (UsePathRendering(context, brush.GetCoats()[coat_index].paint)) {
+    if (UsePathRendering(cpu_rendering, brush.GetCoats()[coat_index].paint)) {
+      if (rasterize_triangles) {
+        drawables.push_back(TriangleDrawable(
+            meshes, brush.GetColor(), cpu_triangle_rasterization_executor_));
+        continue;
+      }
       drawables.push_back(
-          PathDrawable(stroke_shape, coat_index, brush.GetColor(),
+          PathDrawable(path_cache_.GetOrCreate(stroke_shape, coat_index),
+                       brush.GetColor(),
                        OpacityMultiplierForPath(brush, coat_index)));
       continue;
     }
 
     const BrushPaint& brush_paint = brush.GetCoats()[coat_index].paint;
-    absl::StatusOr<sk_sp<SkShader>> shader = shader_cache_.GetShaderForPaint(
-        brush_paint, brush.GetSize(), stroke.GetInputs());
-    if (!shader.ok()) return shader.status();
+    absl::StatusOr<CoatShading> shading = GetCoatShading(
+        *shader_cache_, brush_paint,
+        brush.GetFamily().GetTextureHandles(coat_index), brush.GetSize(),
+        stroke.GetInputs());
+    if (!shading.ok()) return shading.status();
+    missing_textures |= shading->missing_textures;
 
-    // TODO: b/284117747 - Pass `brush.GetCoats()[coat_index].paint` to the
-    // `specification_cache_`.
     absl::StatusOr<sk_sp<SkMeshSpecification>> specification =
-        specification_cache_.GetForStroke(stroke_shape, coat_index);
+        specification_cache_.GetForStroke(stroke_shape, coat_index,
+                                          shading->features);
     if (!specification.ok()) return specification.status();
 
     absl::InlinedVector<MeshDrawable::Partition, 1> partitions;
     partitions.reserve(meshes.size());
     for (const Mesh& mesh : meshes) {
-      absl::Span<const std::byte> vertex_data = mesh.RawVertexData();
-      absl::Span<const std::byte> index_data = mesh.RawIndexData();
+      MeshBufferCache::Buffers buffers;
+      if (mesh_buffer_cache != nullptr) {
+        buffers = mesh_buffer_cache->GetOrCreate(context, mesh);
+      } else {
+        buffers = {
+            .vertex_buffer = SkMeshes::MakeVertexBuffer(
+                context, mesh.RawVertexData().data(),
+                mesh.RawVertexData().size()),
+            .index_buffer = SkMeshes::MakeIndexBuffer(
+                context, mesh.RawIndexData().data(),
+                mesh.RawIndexData().size()),
+        };
+      }
       partitions.push_back({
-          .vertex_buffer = SkMeshes::MakeVertexBuffer(
-              context, vertex_data.data(), vertex_data.size()),
-          .index_buffer = SkMeshes::MakeIndexBuffer(context, index_data.data(),
-                                                    index_data.size()),
+          .vertex_buffer = std::move(buffers.vertex_buffer),
+          .index_buffer = std::move(buffers.index_buffer),
           .vertex_count = static_cast<int32_t>(mesh.VertexCount()),
           .index_count = static_cast<int32_t>(3 * mesh.TriangleCount()),
           .bounds = ToSkiaRect(*mesh.Bounds().AsRect()),
+          .vertex_offset = buffers.vertex_offset,
+          .index_offset = buffers.index_offset,
       });
     }
 
@@ -239,17 +501,39 @@ absl::StatusOr<SkiaRenderer::Drawable> SkiaRenderer::CreateDrawable(
                                  first_mesh.Format().Attributes(),
                                  get_attribute_unpacking_transform);
     absl::StatusOr<MeshDrawable> mesh_drawable = MeshDrawable::Create(
-        *std::move(specification),
-        shader_cache_.GetBlenderForPaint(brush_paint), *std::move(shader),
-        std::move(partitions), std::move(uniform_data));
+        *std::move(specification), std::move(shading->blender),
+        std::move(shading->shader), std::move(partitions),
+        std::move(uniform_data));
     if (!mesh_drawable.ok()) return mesh_drawable.status();
 
     mesh_drawable->SetBrushColor(brush.GetColor());
-    mesh_drawable->SetTextureMapping(GetBrushPaintTextureMapping(brush_paint));
+    if (mesh_drawable->HasTextureMapping()) {
+      mesh_drawable->SetTextureMapping(
+          GetBrushPaintTextureMapping(brush_paint));
+    }
+    SetTextureAnimation(brush_paint, *mesh_drawable);
     drawables.push_back(*std::move(mesh_drawable));
   }
 
-  return Drawable(object_to_canvas, std::move(drawables));
+  Drawable drawable(object_to_canvas, std::move(drawables));
+  drawable.missing_textures_ = missing_textures;
+  return drawable;
+}
+
+void SkiaRenderer::SetMeshBufferCacheMaxBytes(size_t max_bytes) {
+  mesh_buffer_cache_.SetMaxBytes(max_bytes);
+}
+
+void SkiaRenderer::SetPathCacheMaxBytes(size_t max_bytes) {
+  path_cache_.SetMaxBytes(max_bytes);
+}
+
+void SkiaRenderer::PrewarmPaths(absl::Span<const Stroke> strokes,
+                                Executor* absl_nullable executor) {
+  std::vector<PartitionedMesh> shapes;
+  shapes.reserve(strokes.size());
+  for (const Stroke& stroke : strokes) shapes.push_back(stroke.GetShape());
+  path_cache_.Prewarm(shapes, executor);
 }
 
 absl::Status SkiaRenderer::Draw(GrDirectContext* context,
@@ -261,7 +545,7 @@ absl::Status SkiaRenderer::Draw(GrDirectContext* context,
 
   auto drawable = CreateDrawable(context, stroke, object_to_canvas);
   if (!drawable.ok()) return drawable.status();
-  drawable->Draw(canvas);
+  drawable->Draw(canvas, &cull_stats_);
   return absl::OkStatus();
 }
 
@@ -271,9 +555,135 @@ absl::Status SkiaRenderer::Draw(GrDirectContext* context, const Stroke& stroke,
   // TODO: b/286547863 - Implement `RenderCache` to save and update the created
   // drawable inside the stroke.
 
-  auto drawable = CreateDrawable(context, stroke, object_to_canvas);
+  return DrawStrokeInstances(context, stroke, /*level_of_detail=*/0,
+                             {&object_to_canvas, 1}, canvas);
+}
+
+absl::Status SkiaRenderer::DrawInstances(
+    GrDirectContext* context, const Stroke& stroke,
+    absl::Span<const AffineTransform> instances_to_canvas, SkCanvas& canvas) {
+  return DrawStrokeInstances(context, stroke, /*level_of_detail=*/0,
+                             instances_to_canvas, canvas);
+}
+
+void SkiaRenderer::SetDrawableCacheMaxEntries(size_t max_entries) {
+  drawable_cache_max_entries_ = max_entries;
+  while (retained_drawables_.size() > drawable_cache_max_entries_) {
+    retained_drawables_by_mesh_.erase(
+        &retained_drawables_.back().shape.Meshes().front());
+    retained_drawables_.pop_back();
+  }
+}
+
+void SkiaRenderer::SetPerformanceProfile(const PerformanceProfile& profile) {
+  SetMeshBufferCacheMaxBytes(profile.mesh_buffer_cache_max_bytes);
+  SetPathCacheMaxBytes(profile.path_cache_max_bytes);
+  SetTextureCacheMaxBytes(profile.texture_cache_max_bytes);
+  SetTextureMipmapsEnabled(profile.texture_mipmaps_enabled);
+  SetDrawableCacheMaxEntries(profile.drawable_cache_max_entries);
+}
+
+size_t SkiaRenderer::TrimMemory(MemoryTrimLevel level) {
+  size_t bytes = 0;
+  if (level >= MemoryTrimLevel::kCaches) {
+    bytes += mesh_buffer_cache_.TotalBytes() + path_cache_.TotalBytes();
+    mesh_buffer_cache_.Clear();
+    path_cache_.Clear();
+    // Retained drawables mostly refer to buffers and specifications owned by
+    // the other caches, so they are not counted separately.
+    ClearDrawableCache();
+  }
+  if (level >= MemoryTrimLevel::kAll) {
+    bytes += shader_cache_->EvictAllImages();
+    specification_cache_.Clear();
+  }
+  return bytes;
+}
+
+void SkiaRenderer::ClearDrawableCache() {
+  retained_drawables_by_mesh_.clear();
+  retained_drawables_.clear();
+}
+
+absl::StatusOr<SkiaRenderer::Drawable*>
+SkiaRenderer::GetRetainedDrawable(GrDirectContext* context,
+                                  const Stroke& stroke,
+                                  uint32_t level_of_detail) {
+  if (drawable_cache_max_entries_ == 0) return nullptr;
+  if (context != drawable_cache_context_ ||
+      (drawable_cache_context_ != nullptr &&
+       drawable_cache_context_->abandoned())) {
+    ClearDrawableCache();
+    drawable_cache_context_ = context;
+  }
+
+  const PartitionedMesh& shape =
+      stroke.GetShapeAtLevelOfDetail(level_of_detail);
+  if (shape.Meshes().empty()) return nullptr;
+  const Mesh* key = &shape.Meshes().front();
+
+  const Brush& brush = stroke.GetBrush();
+  auto paints_match = [&brush](const RetainedDrawable& entry) {
+    if (entry.paints.size() != brush.CoatCount()) return false;
+    for (uint32_t i = 0; i < brush.CoatCount(); ++i) {
+      if (entry.paints[i] != brush.GetCoats()[i].paint) return false;
+    }
+    return true;
+  };
+
+  if (auto it = retained_drawables_by_mesh_.find(key);
+      it != retained_drawables_by_mesh_.end()) {
+    retained_drawables_.splice(retained_drawables_.begin(), retained_drawables_,
+                               it->second);
+    // A drawable missing textures is recreated until they are all loaded.
+    if (paints_match(*it->second) &&
+        !it->second->drawable.IsMissingTextures()) {
+      return &it->second->drawable;
+    }
+    retained_drawables_by_mesh_.erase(it);
+    retained_drawables_.pop_front();
+  }
+
+  absl::StatusOr<Drawable> drawable = CreateDrawable(
+      context, stroke, AffineTransform::Identity(), level_of_detail);
   if (!drawable.ok()) return drawable.status();
-  drawable->Draw(canvas);
+
+  if (retained_drawables_.size() >= drawable_cache_max_entries_) {
+    retained_drawables_by_mesh_.erase(
+        &retained_drawables_.back().shape.Meshes().front());
+    retained_drawables_.pop_back();
+  }
+  RetainedDrawable& entry = retained_drawables_.emplace_front();
+  entry.shape = shape;
+  for (const BrushCoat& coat : brush.GetCoats()) {
+    entry.paints.push_back(coat.paint);
+  }
+  entry.drawable = *std::move(drawable);
+  retained_drawables_by_mesh_[key] = retained_drawables_.begin();
+  return &entry.drawable;
+}
+
+absl::Status SkiaRenderer::DrawStrokeInstances(
+    GrDirectContext* context, const Stroke& stroke, uint32_t level_of_detail,
+    absl::Span<const AffineTransform> instances_to_canvas, SkCanvas& canvas) {
+  if (instances_to_canvas.empty()) return absl::OkStatus();
+
+  absl::StatusOr<Drawable*> retained =
+      GetRetainedDrawable(context, stroke, level_of_detail);
+  if (!retained.ok()) return retained.status();
+  if (*retained != nullptr) {
+    Drawable& drawable = **retained;
+    if (drawable.HasBrushColor()) {
+      drawable.SetBrushColor(stroke.GetBrush().GetColor());
+    }
+    drawable.DrawInstances(canvas, instances_to_canvas, &cull_stats_);
+    return absl::OkStatus();
+  }
+
+  auto drawable = CreateDrawable(context, stroke, instances_to_canvas.front(),
+                                 level_of_detail);
+  if (!drawable.ok()) return drawable.status();
+  drawable->DrawInstances(canvas, instances_to_canvas, &cull_stats_);
   return absl::OkStatus();
 }
 
@@ -289,14 +699,292 @@ SkM44 ToSkiaM44(const AffineTransform& t) {
 
 }  // namespace
 
-void SkiaRenderer::Drawable::Draw(SkCanvas& canvas) const {
+absl::Status SkiaRenderer::DrawStrokes(
+    GrDirectContext* context, absl::Span<const StrokeAndTransform> strokes,
+    SkCanvas& canvas) {
+  ScopedTraceEvent trace_event("ink::SkiaRenderer::DrawStrokes");
+  for (const StrokeAndTransform& item : strokes) {
+    std::optional<Rect> bounds =
+        item.stroke->GetShapeAtLevelOfDetail(item.level_of_detail)
+            .Bounds()
+            .AsRect();
+    if (!bounds.has_value()) continue;
+
+    // `quickReject()` tests against the clip using the current matrix.
+    canvas.setMatrix(ToSkiaM44(item.object_to_canvas));
+    if (canvas.quickReject(ToSkiaRect(*bounds))) {
+      ++cull_stats_.culled_drawables;
+      continue;
+    }
+
+    if (absl::Status status = DrawStrokeInstances(
+            context, *item.stroke, item.level_of_detail,
+            {&item.object_to_canvas, 1}, canvas);
+        !status.ok()) {
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SkiaRenderer::DrawDirtyRegion(
+    GrDirectContext* context, const Rect& dirty_rect,
+    absl::Span<const StrokeAndTransform> strokes, const SceneIndex& scene_index,
+    const AffineTransform& scene_to_canvas, SkCanvas& canvas) {
+  ScopedTraceEvent trace_event("ink::SkiaRenderer::DrawDirtyRegion");
+  std::optional<AffineTransform> canvas_to_scene = scene_to_canvas.Inverse();
+  // Nothing in the scene is visible through a degenerate transform.
+  if (!canvas_to_scene.has_value()) return absl::OkStatus();
+
+  std::vector<SceneIndex::ShapeId> ids;
+  bool has_invalid_id = false;
+  scene_index.VisitCandidateShapes(
+      *Envelope(canvas_to_scene->Apply(dirty_rect)).AsRect(),
+      [&](SceneIndex::ShapeId id) {
+        if (id >= strokes.size()) {
+          has_invalid_id = true;
+          return PartitionedMesh::FlowControl::kBreak;
+        }
+        ids.push_back(id);
+        return PartitionedMesh::FlowControl::kContinue;
+      });
+  if (has_invalid_id) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "`scene_index` has an ID that is not an index into `strokes`, which "
+        "has size ",
+        strokes.size()));
+  }
+  // The index visits candidates in arbitrary order, but overlapping strokes
+  // must blend in the order of `strokes`.
+  absl::c_sort(ids);
+
+  std::vector<StrokeAndTransform> dirty_strokes;
+  dirty_strokes.reserve(ids.size());
+  for (SceneIndex::ShapeId id : ids) dirty_strokes.push_back(strokes[id]);
+
+  canvas.save();
+  canvas.resetMatrix();
+  canvas.clipRect(ToSkiaRect(dirty_rect));
+  absl::Status status = DrawStrokes(context, dirty_strokes, canvas);
+  canvas.restore();
+  return status;
+}
+
+absl::StatusOr<sk_sp<SkPicture>> SkiaRenderer::RecordStrokes(
+    absl::Span<const StrokeAndTransform> strokes, const Rect& cull_rect,
+    PlaybackTarget target) const {
+  ScopedTraceEvent trace_event("ink::SkiaRenderer::RecordStrokes");
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(ToSkiaRect(cull_rect));
+  for (const StrokeAndTransform& item : strokes) {
+    std::optional<Rect> bounds =
+        item.stroke->GetShapeAtLevelOfDetail(item.level_of_detail)
+            .Bounds()
+            .AsRect();
+    if (!bounds.has_value()) continue;
+
+    canvas->setMatrix(ToSkiaM44(item.object_to_canvas));
+    if (canvas->quickReject(ToSkiaRect(*bounds))) continue;
+
+    // Without a `GrDirectContext`, mesh buffers are CPU-backed. The mesh
+    // buffer cache is keyed on the context of the thread that owns it, so it
+    // isn't used here. Triangles aren't rasterized either, since that would
+    // bake pixels at the recording canvas's resolution into the picture.
+    absl::StatusOr<Drawable> drawable = CreateStrokeDrawable(
+        nullptr, target == PlaybackTarget::kRaster,
+        /*rasterize_triangles=*/false, nullptr, *item.stroke,
+        item.object_to_canvas, item.level_of_detail);
+    if (!drawable.ok()) return drawable.status();
+    drawable->Draw(*canvas);
+  }
+  return recorder.finishRecordingAsPicture();
+}
+
+namespace {
+
+bool HasColorShiftBehavior(const BrushTip& tip) {
+  for (const BrushBehavior& behavior : tip.behaviors) {
+    for (const BrushBehavior::Node& node : behavior.nodes) {
+      const auto* target_node = std::get_if<BrushBehavior::TargetNode>(&node);
+      if (target_node == nullptr) continue;
+      switch (target_node->target) {
+        case BrushBehavior::Target::kHueOffsetInRadians:
+        case BrushBehavior::Target::kSaturationMultiplier:
+        case BrushBehavior::Target::kLuminosity:
+          return true;
+        default:
+          break;
+      }
+    }
+  }
+  return false;
+}
+
+// Returns the color of a stamp with the given brush color and tip opacity
+// multiplier, as the non-premultiplied sRGB color used by `SkVertices`.
+SkColor StampColor(const Color& brush_color, float opacity_multiplier) {
+  Color::RgbaUint8 rgba =
+      brush_color
+          .WithAlphaFloat(std::clamp(
+              brush_color.GetAlphaFloat() * opacity_multiplier, 0.f, 1.f))
+          .InColorSpace(ColorSpace::kSrgb)
+          .AsUint8(Color::Format::kGammaEncoded);
+  return SkColorSetARGB(rgba.a, rgba.r, rgba.g, rgba.b);
+}
+
+// The most stamps whose vertices can be indexed by a single `SkVertices`.
+constexpr size_t kMaxStampsPerVertices =
+    (std::numeric_limits<uint16_t>::max() + 1) / 4;
+
+}  // namespace
+
+bool SkiaRenderer::CanDrawStampedCoat(const BrushCoat& coat) {
+  return strokes_internal::IsStampingParticleCoat(coat) &&
+         coat.paint.texture_layers[0].animation_frames == 1 &&
+         !HasColorShiftBehavior(coat.tip);
+}
+
+absl::Status SkiaRenderer::DrawStampedCoat(
+    const Stroke& stroke, uint32_t coat_index,
+    const AffineTransform& object_to_canvas, SkCanvas& canvas) {
+  ScopedTraceEvent trace_event("ink::SkiaRenderer::DrawStampedCoat");
+  const Brush& brush = stroke.GetBrush();
+  if (coat_index >= brush.CoatCount()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`coat_index` is ", coat_index, ", but the brush has ",
+                     brush.CoatCount(), " coats"));
+  }
+  const BrushCoat& coat = brush.GetCoats()[coat_index];
+  if (!CanDrawStampedCoat(coat)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("coat ", coat_index,
+                     " can't be drawn as stamps; see `CanDrawStampedCoat()`"));
+  }
+  const BrushPaint::TextureLayer& layer = coat.paint.texture_layers[0];
+  absl::StatusOr<ShaderCache::StampImage> stamp_image =
+      shader_cache_->GetStampImage(
+          brush.GetFamily().GetTextureHandles(coat_index)[0]);
+  if (!stamp_image.ok()) return stamp_image.status();
+
+  std::vector<BrushTipState> stamps;
+  strokes_internal::AppendParticleStamps(brush, coat_index, stroke.GetInputs(),
+                                         stamps);
+  if (stamps.empty()) return absl::OkStatus();
+
+  // The vertex at each corner of a stamp has the position of the particle's
+  // surface UV in the corner of the unit square, and the texel at the same UV
+  // in `texel_bounds`.
+  constexpr Point kCornerUvs[] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  const SkIRect& bounds = stamp_image->texel_bounds;
+  SkPoint corner_texels[4];
+  for (int i = 0; i < 4; ++i) {
+    corner_texels[i] =
+        SkPoint::Make(bounds.left() + kCornerUvs[i].x * bounds.width(),
+                      bounds.top() + kCornerUvs[i].y * bounds.height());
+  }
+
+  SkPaint paint;
+  paint.setShader(SkShaders::Image(
+      stamp_image->image, SkTileMode::kClamp, SkTileMode::kClamp,
+      SkSamplingOptions(SkFilterMode::kLinear), nullptr));
+  SkBlendMode blend_mode = ToSkBlendMode(layer.blend_mode);
+  canvas.setMatrix(ToSkiaM44(object_to_canvas));
+
+  std::vector<SkPoint> positions;
+  std::vector<SkPoint> texels;
+  std::vector<SkColor> colors;
+  std::vector<uint16_t> indices;
+  for (size_t first = 0; first < stamps.size();
+       first += kMaxStampsPerVertices) {
+    absl::Span<const BrushTipState> batch =
+        absl::MakeConstSpan(stamps).subspan(first, kMaxStampsPerVertices);
+    positions.clear();
+    texels.clear();
+    colors.clear();
+    indices.clear();
+    for (const BrushTipState& stamp : batch) {
+      // The inverse of the transform from position to particle surface UV used
+      // by the `BrushTipExtruder`.
+      AffineTransform uv_to_position =
+          AffineTransform::Translate(stamp.position.Offset()) *
+          AffineTransform::Rotate(stamp.rotation) *
+          AffineTransform::Scale(stamp.width, stamp.height) *
+          AffineTransform::Translate({-0.5, -0.5});
+      SkColor color = StampColor(brush.GetColor(), stamp.opacity_multiplier);
+      auto first_vertex = static_cast<uint16_t>(positions.size());
+      for (int i = 0; i < 4; ++i) {
+        Point position = uv_to_position.Apply(kCornerUvs[i]);
+        positions.push_back(SkPoint::Make(position.x, position.y));
+        texels.push_back(corner_texels[i]);
+        colors.push_back(color);
+      }
+      for (int corner : {0, 1, 2, 0, 2, 3}) {
+        indices.push_back(static_cast<uint16_t>(first_vertex + corner));
+      }
+    }
+    canvas.drawVertices(
+        SkVertices::MakeCopy(SkVertices::kTriangles_VertexMode,
+                             static_cast<int>(positions.size()),
+                             positions.data(), texels.data(), colors.data(),
+                             static_cast<int>(indices.size()), indices.data()),
+        blend_mode, paint);
+  }
+  return absl::OkStatus();
+}
+
+void SkiaRenderer::Drawable::Draw(SkCanvas& canvas,
+                                  CullStats* absl_nullable cull_stats) const {
+  ScopedTraceEvent trace_event("ink::SkiaRenderer::Drawable::Draw");
+  if (drawable_implementations_.empty()) return;
   canvas.setMatrix(ToSkiaM44(object_to_canvas_));
+  // `quickReject()` tests against the clip using the current matrix.
+  if (image_filter_ == nullptr && canvas.quickReject(Bounds())) {
+    if (cull_stats != nullptr) ++cull_stats->culled_drawables;
+    return;
+  }
   for (const Implementation& impl : drawable_implementations_) {
-    std::visit([&canvas](const auto& drawable) { drawable.Draw(canvas); },
+    std::visit(absl::Overload(
+                   [&canvas, cull_stats](const MeshDrawable& drawable) {
+                     MeshDrawable::DrawCounts counts = drawable.Draw(canvas);
+                     if (cull_stats == nullptr) return;
+                     cull_stats->drawn_mesh_partitions +=
+                         counts.drawn_partitions;
+                     cull_stats->culled_mesh_partitions +=
+                         counts.culled_partitions;
+                   },
+                   [&canvas](const PathDrawable& drawable) {
+                     drawable.Draw(canvas);
+                   },
+                   [&canvas](const TriangleDrawable& drawable) {
+                     drawable.Draw(canvas);
+                   }),
                impl);
   }
 }
 
+SkRect SkiaRenderer::Drawable::Bounds() const {
+  SkRect bounds = SkRect::MakeEmpty();
+  for (const Implementation& impl : drawable_implementations_) {
+    bounds.join(std::visit(
+        [](const auto& drawable) { return drawable.Bounds(); }, impl));
+  }
+  return bounds;
+}
+
+void SkiaRenderer::Drawable::DrawInstances(
+    SkCanvas& canvas, absl::Span<const AffineTransform> instances_to_canvas,
+    CullStats* absl_nullable cull_stats) {
+  ScopedTraceEvent trace_event("ink::SkiaRenderer::Drawable::DrawInstances");
+  AffineTransform object_to_canvas = object_to_canvas_;
+  for (const AffineTransform& instance_to_canvas : instances_to_canvas) {
+    // This updates the uniforms that depend on the transform, but leaves the
+    // vertex and index buffers untouched.
+    SetObjectToCanvas(instance_to_canvas);
+    Draw(canvas, cull_stats);
+  }
+  SetObjectToCanvas(object_to_canvas);
+}
+
 SkiaRenderer::Drawable::Drawable(
     const AffineTransform& object_to_canvas,
     absl::InlinedVector<Implementation, 1> drawable_impls)
@@ -321,7 +1009,8 @@ bool SkiaRenderer::Drawable::HasBrushColor() const {
                        [](const MeshDrawable& drawable) {
                          return drawable.HasBrushColor();
                        },
-                       [](const PathDrawable& drawable) { return true; }),
+                       [](const PathDrawable& drawable) { return true; },
+                       [](const TriangleDrawable& drawable) { return true; }),
                    drawable_impl)) {
       return true;
     }
@@ -342,13 +1031,39 @@ void SkiaRenderer::Drawable::SetBrushColor(const Color& color) {
                    [&color, &has_color](PathDrawable& drawable) {
                      drawable.SetPaintColor(color);
                      has_color = true;
+                   },
+                   [&color, &has_color](TriangleDrawable& drawable) {
+                     drawable.SetBrushColor(color);
+                     has_color = true;
                    }),
                drawable_impl);
   }
   ABSL_CHECK(has_color);
 }
 
+bool SkiaRenderer::Drawable::HasTextureAnimation() const {
+  for (const Implementation& drawable_impl : drawable_implementations_) {
+    if (const MeshDrawable* drawable =
+            std::get_if<MeshDrawable>(&drawable_impl);
+        drawable != nullptr && drawable->HasTextureAnimation()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SkiaRenderer::Drawable::SetTextureAnimationTime(absl::Duration time) {
+  texture_animation_time_ = time;
+  for (Implementation& drawable_impl : drawable_implementations_) {
+    if (MeshDrawable* drawable = std::get_if<MeshDrawable>(&drawable_impl);
+        drawable != nullptr && drawable->HasTextureAnimation()) {
+      drawable->SetTextureAnimationTime(time);
+    }
+  }
+}
+
 void SkiaRenderer::Drawable::SetImageFilter(sk_sp<SkImageFilter> image_filter) {
+  image_filter_ = image_filter;
   for (Implementation& drawable_impl : drawable_implementations_) {
     std::visit(absl::Overload(
                    [&image_filter](MeshDrawable& drawable) {
@@ -356,6 +1071,9 @@ void SkiaRenderer::Drawable::SetImageFilter(sk_sp<SkImageFilter> image_filter) {
                    },
                    [&image_filter](PathDrawable& drawable) {
                      drawable.SetImageFilter(image_filter);
+                   },
+                   [&image_filter](TriangleDrawable& drawable) {
+                     drawable.SetImageFilter(image_filter);
                    }),
                drawable_impl);
   }
@@ -15,27 +15,49 @@
 #ifndef INK_RENDERING_SKIA_NATIVE_SKIA_RENDERER_H_
 #define INK_RENDERING_SKIA_NATIVE_SKIA_RENDERER_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <variant>
 #include <vector>
 
 #include "absl/base/nullability.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
 #include "ink/color/color.h"
 #include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/scene_index.h"
+#include "ink/rendering/skia/native/internal/growable_mesh_buffers.h"
+#include "ink/rendering/skia/native/internal/mesh_buffer_cache.h"
 #include "ink/rendering/skia/native/internal/mesh_drawable.h"
 #include "ink/rendering/skia/native/internal/mesh_specification_cache.h"
+#include "ink/rendering/skia/native/internal/path_cache.h"
 #include "ink/rendering/skia/native/internal/path_drawable.h"
 #include "ink/rendering/skia/native/internal/shader_cache.h"
+#include "ink/rendering/skia/native/internal/triangle_drawable.h"
 #include "ink/rendering/skia/native/texture_bitmap_store.h"
 #include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/performance_profile.h"
 #include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+#include "ink/types/memory_trim.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkMesh.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
 #include "include/gpu/ganesh/GrDirectContext.h"
 
 namespace ink {
@@ -43,7 +65,8 @@ namespace ink {
 // A helper renderer for drawing Ink objects into an `SkCanvas`.
 //
 // This type is thread-compatible, but *not* thread-safe: all non-const access
-// to a renderer object must be externally synchronized.
+// to a renderer object must be externally synchronized. The exception is
+// `RecordStrokes()`, which may be called from several threads at once.
 //
 // The renderer is intended for hardware accelerated drawing using one of Skia's
 // GPU backends. This requires every function that takes in a `GrDirectContext*`
@@ -73,15 +96,31 @@ namespace ink {
 // The renderer supports a feature-limited CPU rendering fallback. Matching
 // Skia's API patterns, CPU rendering is triggered by calling `Draw()` or
 // `CreateDrawable()` with a null `GrDirectContext`. Note that CPU rasterized
-// strokes are drawn as filled paths, and this results in some visual
-// differences and limitations:
+// strokes are drawn as filled paths by default, and this results in some
+// visual differences and limitations:
 //   * `BrushBehavior`s targeting color and opacity are ignored.
 //   * Individual strokes with a partially transparent brush color do not
 //     accumulate opacity when overlapping themselves.
+// Finished strokes can instead have their mesh triangles rasterized directly,
+// which avoids these; see `SetCpuTriangleRasterizationEnabled()`.
 class SkiaRenderer {
  public:
   class Drawable;
 
+  // Counts of the drawing work done and skipped by culling against the canvas
+  // clip, accumulated over calls to `Drawable::Draw()` and related functions.
+  struct CullStats {
+    // Drawables whose bounds were entirely outside of the clip, and so were
+    // skipped without drawing anything, counting each instance separately.
+    // This includes the strokes skipped by `SkiaRenderer::DrawStrokes()`.
+    int64_t culled_drawables = 0;
+    // Partitions of meshes that were drawn, and that were skipped because
+    // they were outside of the clip, in drawables that were not culled as a
+    // whole.
+    int64_t drawn_mesh_partitions = 0;
+    int64_t culled_mesh_partitions = 0;
+  };
+
   explicit SkiaRenderer(absl_nullable std::shared_ptr<TextureBitmapStore>
                             texture_provider = nullptr);
 
@@ -108,6 +147,126 @@ class SkiaRenderer {
   absl::Status Draw(GrDirectContext* context, const Stroke& stroke,
                     const AffineTransform& object_to_canvas, SkCanvas& canvas);
 
+  // Draws `stroke` once for each transform in `instances_to_canvas`, e.g. for
+  // stamps or pasted duplicates that share the same geometry. This creates the
+  // drawable data (including any GPU buffers) once, and reuses it for every
+  // instance; see `Drawable::DrawInstances()`.
+  //
+  // NOTE: Like `Draw()`, this calls `canvas.setMatrix()`.
+  absl::Status DrawInstances(
+      GrDirectContext* context, const Stroke& stroke,
+      absl::Span<const AffineTransform> instances_to_canvas, SkCanvas& canvas);
+
+  // A finished stroke to draw with `DrawStrokes()`, along with its transform
+  // and the level of detail passed to `CreateDrawable()`.
+  struct StrokeAndTransform {
+    const Stroke* absl_nonnull stroke;
+    AffineTransform object_to_canvas;
+    uint32_t level_of_detail = 0;
+  };
+
+  // Draws each of `strokes` in order into the `canvas`, as if by calling
+  // `Draw()` for each one, but skips the strokes whose bounds are outside of
+  // the canvas clip before creating any drawable data or GPU buffers for them.
+  // This makes drawing a page that is mostly scrolled or zoomed out of view
+  // cost about as much as drawing only its visible strokes. Combine with
+  // `SetMeshBufferCacheMaxBytes()` so that visible strokes are not re-uploaded
+  // on every frame.
+  //
+  // Strokes are not reordered or merged into fewer draw calls: each mesh has
+  // its own attribute unpacking uniforms, and reordering would change how
+  // overlapping strokes blend.
+  //
+  // NOTE: Like `Draw()`, this calls `canvas.setMatrix()`.
+  absl::Status DrawStrokes(GrDirectContext* context,
+                           absl::Span<const StrokeAndTransform> strokes,
+                           SkCanvas& canvas);
+
+  // Redraws the part of a scene of finished strokes that lies within
+  // `dirty_rect`, in canvas coordinates, e.g. the area covered by the updated
+  // region of an `InProgressStroke` when rendering into a front buffer. Only
+  // the strokes whose bounds intersect `dirty_rect` are visited, so the cost of
+  // a partial redraw does not grow with the number of strokes on the page.
+  //
+  // `scene_index` must hold the shape of each of `strokes`, identified by its
+  // index into `strokes`, and `scene_to_canvas` must map the coordinates of
+  // `scene_index` to canvas coordinates; i.e. each `object_to_canvas` is
+  // `scene_to_canvas` times the transform its shape was inserted with. The
+  // strokes that are picked are drawn in the order of `strokes`, clipped to
+  // `dirty_rect`. This does not clear `dirty_rect` first. Returns an
+  // invalid-argument error without drawing anything if `scene_index` holds an
+  // ID that is not an index into `strokes`.
+  //
+  // The matrix and clip of `canvas` are restored before returning.
+  absl::Status DrawDirtyRegion(GrDirectContext* context, const Rect& dirty_rect,
+                               absl::Span<const StrokeAndTransform> strokes,
+                               const SceneIndex& scene_index,
+                               const AffineTransform& scene_to_canvas,
+                               SkCanvas& canvas);
+
+  // How a picture returned by `RecordStrokes()` is going to be played back.
+  enum class PlaybackTarget {
+    // Into a CPU raster canvas, e.g. to export or print. Strokes are recorded
+    // as filled paths, as when drawing without a `GrDirectContext`.
+    kRaster,
+    // Into a GPU-backed canvas. Strokes are recorded as meshes with CPU-side
+    // vertex and index buffers, which Skia uploads when the picture is played
+    // back.
+    kGpu,
+  };
+
+  // Records `strokes` into a new `SkPicture`, in order, as `DrawStrokes()`
+  // would draw them into a canvas whose clip is `cull_rect`. Strokes whose
+  // bounds are outside of `cull_rect` are skipped. The picture can then be
+  // drawn with `SkCanvas::drawPicture()` on the thread that owns the target
+  // canvas, e.g. the `GrDirectContext` thread.
+  //
+  // Unlike the other drawing functions, this may be called concurrently from
+  // any number of threads on the same renderer, e.g. to record the tiles of a
+  // page or the pages of a document in parallel for thumbnails and export. The
+  // texture, specification, and path caches are shared by all of the calls.
+  // Retained drawables and cull stats are neither used nor updated. Brush coats
+  // whose textures are not loaded yet are recorded without them, so call
+  // `PrewarmBrushFamilies()` first to record them with their textures.
+  //
+  // Returns the first error encountered creating the drawable of a stroke, as
+  // per `CreateDrawable()`, in which case no picture is returned.
+  absl::StatusOr<sk_sp<SkPicture>> RecordStrokes(
+      absl::Span<const StrokeAndTransform> strokes, const Rect& cull_rect,
+      PlaybackTarget target) const;
+
+  // Returns true if `coat` can be drawn by `DrawStampedCoat()`: it has a single
+  // texture layer with `kStamping` mapping and no animation frames, its tip
+  // emits particles, and none of its tip behaviors target hue, saturation, or
+  // luminosity.
+  static bool CanDrawStampedCoat(const BrushCoat& coat);
+
+  // Draws coat `coat_index` of `stroke` as one textured quad per particle,
+  // batched into a single draw call, instead of drawing the coat's mesh. The
+  // particles are modeled from the brush and inputs of `stroke` without
+  // extruding any geometry, so this neither uses nor generates the shape of
+  // `stroke`, e.g. of one created with `Stroke::WithLazyShape()`. This makes
+  // particle brushes that spray many small stamps much cheaper to draw than
+  // their meshes, which outline every particle with many vertices.
+  //
+  // Each quad covers the whole texture, or its region of the texture atlas, in
+  // the rectangle that the particle's surface UVs span in its mesh. Its color
+  // is the brush color with the particle's opacity multiplier applied, and is
+  // combined with the texture by the layer's blend mode. Unlike the mesh, the
+  // quad is not clipped to a rounded or slanted tip shape, and its edges are
+  // not anti-aliased, so the result only matches the mesh for textures that
+  // are transparent towards their edges.
+  //
+  // Returns an invalid-argument error if `coat_index` is out of range or if the
+  // coat fails `CanDrawStampedCoat()`, and any error fetching the texture,
+  // including an unavailable error while it is not loaded yet. Nothing is drawn
+  // if an error is returned, so that the coat's mesh can be drawn instead.
+  //
+  // NOTE: Like `Draw()`, this calls `canvas.setMatrix()`.
+  absl::Status DrawStampedCoat(const Stroke& stroke, uint32_t coat_index,
+                               const AffineTransform& object_to_canvas,
+                               SkCanvas& canvas);
+
   // Return a new `Drawable` created from an `InProgressStroke`.
   //
   // The returned drawable will have its transform set to `object_to_canvas` and
@@ -119,7 +278,7 @@ class SkiaRenderer {
   // `Brush`.
   //
   // NOTE: the drawable will not automatically track changes to the `stroke` and
-  // must be manually recreated and/or updated.
+  // must be manually recreated, or updated with `UpdateDrawable()`.
   absl::StatusOr<Drawable> CreateDrawable(
       GrDirectContext* context, const InProgressStroke& stroke,
       const AffineTransform& object_to_canvas);
@@ -136,18 +295,242 @@ class SkiaRenderer {
   // invalid-argument error if rendering would fail due to an unsupported
   // `Brush`.
   //
+  // The drawable uses `stroke.GetShapeAtLevelOfDetail(level_of_detail)`. To
+  // draw fewer triangles for strokes that are drawn scaled down, pass the
+  // result of `Stroke::LevelOfDetailForScale()` for the scale of
+  // `object_to_canvas`.
+  //
   // NOTE: the drawable will not automatically track changes to the `stroke` and
   // must be manually recreated and/or updated.
   absl::StatusOr<Drawable> CreateDrawable(
       GrDirectContext* context, const Stroke& stroke,
-      const AffineTransform& object_to_canvas);
+      const AffineTransform& object_to_canvas, uint32_t level_of_detail = 0);
+
+  // Updates `drawable` to the current shape of the in-progress `stroke`,
+  // reusing its vertex and index buffers where possible.
+  //
+  // `drawable` must have been returned by `CreateDrawable()` for the same
+  // `stroke`, or been passed to this function with it, and every change made to
+  // the `stroke` since then must be reported by its
+  // `GetCoatFirstUpdatedVertex()` and `GetCoatFirstUpdatedTriangle()`. The
+  // simplest way to ensure this is to call `stroke.ResetUpdatedRegion()` after
+  // each call to `CreateDrawable()` or `UpdateDrawable()`. Only the vertices
+  // and triangles reported as updated are then uploaded, into buffers that have
+  // spare capacity for the stroke to grow into, which makes the cost of each
+  // frame proportional to the new input rather than to the whole stroke.
+  //
+  // The transform and image filter of `drawable` are kept, and its brush-color
+  // is set to that of the stroke, as in `CreateDrawable()`. Passing a different
+  // `context` than before re-uploads all of the data. If an error is returned,
+  // `drawable` is left in a valid but unspecified state.
+  absl::Status UpdateDrawable(GrDirectContext* context,
+                              const InProgressStroke& stroke,
+                              Drawable& drawable);
+
+  // Sets the maximum number of bytes of vertex and index data for which the
+  // GPU buffers created for the meshes of a `Stroke` are kept, and reused by
+  // later calls to `Draw()` and `CreateDrawable()` for any stroke sharing the
+  // same `PartitionedMesh` data. With a large enough budget, drawing a finished
+  // stroke again uploads nothing to the GPU. The least recently drawn meshes
+  // are evicted first. Small meshes share large GPU buffers, so that many short
+  // strokes don't need many small buffer objects.
+  //
+  // Defaults to zero, which disables the cache. The cache holds a copy of each
+  // cached `Mesh`, and so keeps its CPU memory alive as well. Buffers belong to
+  // the `GrDirectContext` they were created with, so the cache is cleared when
+  // a different context is passed in.
+  void SetMeshBufferCacheMaxBytes(size_t max_bytes);
+
+  // Sets the maximum number of bytes of `SkPath` data built from the outlines
+  // of a `Stroke` that are kept, and reused by later calls to `Draw()` and
+  // `CreateDrawable()` without a `GrDirectContext` for any stroke sharing the
+  // same `PartitionedMesh` data, with any transform. This makes rasterizing the
+  // same strokes again, e.g. for thumbnails at several sizes or for printing,
+  // skip rebuilding their paths. The least recently drawn paths are evicted
+  // first.
+  //
+  // Defaults to zero, which disables the cache. The cache holds a copy of each
+  // cached `PartitionedMesh`, and so keeps its memory alive as well.
+  void SetPathCacheMaxBytes(size_t max_bytes);
+
+  // Builds the `SkPath`s used to draw `strokes` without a `GrDirectContext`
+  // ahead of time, e.g. before generating thumbnails of a whole document, so
+  // that drawing them later only has to rasterize. The paths are kept in the
+  // cache sized by `SetPathCacheMaxBytes()`, so this does nothing useful while
+  // it is disabled. If `executor` is non-null, the work is scheduled on it and
+  // this returns right away.
+  void PrewarmPaths(absl::Span<const Stroke> strokes,
+                    Executor* absl_nullable executor = nullptr);
+
+  // Sets whether finished strokes drawn without a `GrDirectContext` have the
+  // triangles of their meshes rasterized on the CPU, instead of being drawn as
+  // filled `SkPath`s of their outlines. This matches GPU rendering closely,
+  // including antialiasing, color and opacity behaviors, and opacity
+  // accumulating where a stroke overlaps itself, and it skips building paths.
+  // Brush textures are not drawn. If `executor` is non-null, tiles of each
+  // stroke are rasterized in parallel on it, and it must outlive the renderer
+  // and the drawables it creates.
+  //
+  // This applies to `Draw()` and `CreateDrawable()` of a `Stroke`, but not to
+  // in-progress strokes or to `RecordStrokes()`. Disabled by default.
+  void SetCpuTriangleRasterizationEnabled(
+      bool enabled, Executor* absl_nullable executor = nullptr);
+
+  // Returns a new renderer that uses the same texture provider as this one, and
+  // shares its cache of texture images and texture shaders, so that textures
+  // are only fetched and kept in memory once. The two renderers may be used on
+  // different threads.
+  SkiaRenderer CreateRendererSharingTextures() const;
+
+  // Sets the maximum number of bytes of pixel data of the texture images kept
+  // by this renderer, and by any renderers it shares textures with. The least
+  // recently used images, and the shaders made from them, are evicted first.
+  // Defaults to no limit.
+  void SetTextureCacheMaxBytes(size_t max_bytes);
 
-  // TODO: b/284117747 - Add functions to "update" a `Drawable`.
+  // Sets whether texture images are kept with mipmap levels and sampled with
+  // trilinear filtering, for this renderer and any renderers it shares
+  // textures with. This avoids aliasing and wasted texture bandwidth when
+  // textures are drawn minified, e.g. on a zoomed-out canvas, and the extra
+  // memory of the mipmap levels counts toward `SetTextureCacheMaxBytes()`.
+  // Changing this evicts every cached texture. Disabled by default.
+  void SetTextureMipmapsEnabled(bool enabled);
+
+  // Fetches the textures and creates the texture shaders for every brush coat
+  // of `families` ahead of time, e.g. while loading a document, so that the
+  // first stroke drawn with each brush doesn't stall on them. Returns the
+  // first error encountered, such as a texture that the provider fails to
+  // return, after attempting every family.
+  absl::Status PrewarmBrushFamilies(absl::Span<const BrushFamily> families);
+
+  // Packs the textures of the brush coats of `families` whose texture layers
+  // use `kStamping` mapping into shared atlas images, replacing any previous
+  // atlas, so that strokes stamped with different textures can be drawn with
+  // the same image and batched together by Skia. Textures are packed into
+  // `page_size` by `page_size` pages, as long as they are at most a quarter of
+  // that size, and otherwise keep being drawn from their own image. The atlas
+  // is shared with renderers from `CreateRendererSharingTextures()`.
+  //
+  // Returns the first error encountered, such as a texture that the provider
+  // fails to return, after packing every texture that could be fetched.
+  // Textures that are not loaded yet can be packed by calling this again.
+  absl::Status BuildTextureAtlas(absl::Span<const BrushFamily> families,
+                                 int page_size = 1024);
+
+  // Creates the Skia mesh specifications for in-progress strokes and for
+  // finished strokes ahead of time, compiling their SkSL, so that the first
+  // stroke drawn after startup doesn't have to. If `executor` is non-null, the
+  // work is scheduled on it and this returns right away.
+  //
+  // This does not compile GPU programs, which Skia does on first draw. To reuse
+  // those across launches, create the `GrDirectContext` with a
+  // `PersistentPipelineCache`.
+  absl::Status PrewarmMeshSpecifications(
+      Executor* absl_nullable executor = nullptr);
+
+  // Returns the culling statistics of the drawing done by this renderer's
+  // `Draw()`, `DrawInstances()`, and `DrawStrokes()`, since it was created or
+  // since the last call to `ResetCullStats()`.
+  const CullStats& GetCullStats() const { return cull_stats_; }
+  void ResetCullStats() { cull_stats_ = CullStats(); }
+
+  // Sets the maximum number of `Drawable`s for finished strokes that are
+  // retained, and reused by later calls to `Draw()`, `DrawInstances()` and
+  // `DrawStrokes()` for the same stroke. A retained drawable only has its
+  // transform and brush-color updated before it is drawn, which skips the
+  // shader, specification, and mesh validation work of `CreateDrawable()`, so
+  // that e.g. a frame of panning over unchanged strokes is cheap. The least
+  // recently drawn are evicted first.
+  //
+  // Defaults to zero, which disables the cache. Entries are keyed on the
+  // identity of the `PartitionedMesh` data of the drawn level of detail, and
+  // hold a copy of it, so an entry is never used again once the stroke's shape
+  // is regenerated. An entry is also recreated if the stroke's brush paints
+  // have changed, or if it was drawn without textures that had not loaded yet.
+  // Like the mesh buffer cache, this cache is cleared when a different
+  // `GrDirectContext` is passed in.
+  void SetDrawableCacheMaxEntries(size_t max_entries);
+
+  // Sets the sizes of the mesh buffer, path, texture, and drawable caches, and
+  // whether textures use mipmaps, from the corresponding fields of `profile`,
+  // as if by calling each setter above. To draw at the level of detail chosen
+  // by `profile`, pass `Stroke::LevelOfDetailForScale()` with `profile` to
+  // `CreateDrawable()` or in `StrokeAndTransform::level_of_detail`.
+  void SetPerformanceProfile(const PerformanceProfile& profile);
+
+  // Releases the memory of this renderer's caches that belongs to `level`, and
+  // returns an estimate of the number of bytes released. The mesh buffer, path
+  // and drawable caches are cleared from `MemoryTrimLevel::kCaches`, and the
+  // texture images, which are shared with any renderers sharing textures, and
+  // mesh specifications at `MemoryTrimLevel::kAll`. The cache size limits are
+  // unchanged, so the caches fill up again as strokes are drawn.
+  //
+  // Only the texture images are also released by `ink::TrimMemory()`, since
+  // the other caches may only be used on the renderer's own thread. Call this
+  // on that thread when trimming, e.g. from a task posted to it.
+  size_t TrimMemory(MemoryTrimLevel level);
 
  private:
+  struct RetainedDrawable;
+
+  // Draws `stroke` once for each of `instances_to_canvas`, using a retained
+  // drawable if the drawable cache is enabled.
+  absl::Status DrawStrokeInstances(
+      GrDirectContext* context, const Stroke& stroke, uint32_t level_of_detail,
+      absl::Span<const AffineTransform> instances_to_canvas, SkCanvas& canvas);
+
+  // Returns the retained drawable for `stroke`, creating it if needed, or null
+  // if the drawable cache is disabled or `stroke` has an empty shape.
+  absl::StatusOr<Drawable*> GetRetainedDrawable(
+      GrDirectContext* context, const Stroke& stroke, uint32_t level_of_detail);
+
+  void ClearDrawableCache();
+
+  // Implements `CreateDrawable()` for a `Stroke` without touching any state
+  // that isn't thread-safe. Coats are drawn with paths if `cpu_rendering` is
+  // true, or with CPU rasterized triangles if `rasterize_triangles` is also
+  // true. Mesh buffers are created with `context`, or taken from
+  // `mesh_buffer_cache` if it is non-null.
+  absl::StatusOr<Drawable> CreateStrokeDrawable(
+      GrDirectContext* context, bool cpu_rendering, bool rasterize_triangles,
+      skia_native_internal::MeshBufferCache* absl_nullable mesh_buffer_cache,
+      const Stroke& stroke, const AffineTransform& object_to_canvas,
+      uint32_t level_of_detail) const;
+
+  // Replaces the contents of `drawable` with the current shape of `stroke`,
+  // writing only the updated data into the drawable's existing buffers if
+  // `incremental` is true.
+  absl::Status FillDrawable(GrDirectContext* context,
+                            const InProgressStroke& stroke, bool incremental,
+                            Drawable& drawable);
+
+  SkiaRenderer(
+      absl_nullable std::shared_ptr<TextureBitmapStore> texture_provider,
+      absl_nonnull std::shared_ptr<skia_native_internal::ShaderCache>
+          shader_cache);
+
   absl_nullable std::shared_ptr<TextureBitmapStore> texture_provider_;
-  skia_native_internal::ShaderCache shader_cache_;
+  // Shared with renderers from `CreateRendererSharingTextures()`. Declared
+  // after `texture_provider_`, which it refers to, so that it is destroyed
+  // first.
+  absl_nonnull std::shared_ptr<skia_native_internal::ShaderCache>
+      shader_cache_;
   skia_native_internal::MeshSpecificationCache specification_cache_;
+  skia_native_internal::MeshBufferCache mesh_buffer_cache_{0};
+  skia_native_internal::PathCache path_cache_{0};
+
+  // Retained drawables in order of most to least recently used, and indexed by
+  // the address of the first `Mesh` of their shape.
+  std::list<RetainedDrawable> retained_drawables_;
+  absl::flat_hash_map<const Mesh*, std::list<RetainedDrawable>::iterator>
+      retained_drawables_by_mesh_;
+  size_t drawable_cache_max_entries_ = 0;
+  GrDirectContext* absl_nullable drawable_cache_context_ = nullptr;
+
+  bool cpu_triangle_rasterization_enabled_ = false;
+  Executor* absl_nullable cpu_triangle_rasterization_executor_ = nullptr;
+
+  CullStats cull_stats_;
 
   // Buffer of 16-bit integers used during index buffer creation when the
   // incoming mesh holds 32-bit indices.
@@ -183,11 +566,38 @@ class SkiaRenderer::Drawable {
   // Draws the mesh-drawable into the provided `canvas` with the currently set
   // object-to-canvas transform.
   //
+  // Nothing is drawn if the bounds of the drawable are outside of the clip of
+  // the `canvas`, and mesh partitions outside of the clip are skipped before
+  // any Skia objects are created for them, so that drawing strokes that are
+  // mostly off-screen, e.g. when zoomed in, is cheap. Culling is not done if
+  // the drawable has an image filter, which may draw outside of its bounds. If
+  // `cull_stats` is non-null, the culling statistics of this call are added
+  // to it.
+  //
   // NOTE: This function calls `canvas.setMatrix()`, overwriting any current
   // matrix state. Callers who wish to make use of the `SkCanvas` matrix state
   // should wrap calls to this function with calls to `canvas.save()` and
   // `canvas.restore()`.
-  void Draw(SkCanvas& canvas) const;
+  void Draw(SkCanvas& canvas,
+            CullStats* absl_nullable cull_stats = nullptr) const;
+
+  // Draws the drawable into `canvas` once for each transform in
+  // `instances_to_canvas`, which are used in place of the object-to-canvas
+  // transform. The vertex and index buffers are shared by every instance, so
+  // this is much cheaper than creating a drawable per instance. Afterwards,
+  // `ObjectToCanvas()` is unchanged.
+  //
+  // Skia's mesh API has no hardware instancing, so this still issues one draw
+  // call per instance and mesh partition.
+  //
+  // NOTE: Like `Draw()`, this calls `canvas.setMatrix()`.
+  void DrawInstances(SkCanvas& canvas,
+                     absl::Span<const AffineTransform> instances_to_canvas,
+                     CullStats* absl_nullable cull_stats = nullptr);
+
+  // Returns the bounds of the drawable in object coordinates, or an empty rect
+  // if it draws nothing.
+  SkRect Bounds() const;
 
   // Returns true if the drawable has a brush-color property.
   //
@@ -202,6 +612,28 @@ class SkiaRenderer::Drawable {
 
   void SetImageFilter(sk_sp<SkImageFilter> image_filter);
 
+  // Returns true if any brush coat of the drawable has an animated texture,
+  // i.e. one with `BrushPaint::TextureLayer::animation_frames` greater than 1.
+  bool HasTextureAnimation() const;
+
+  // Sets the time of the animation clock used to select the frames of animated
+  // textures, e.g. the time since the app started, which only needs to keep
+  // increasing from frame to frame. Each animation loops every
+  // `animation_duration` of its texture layer, offset per particle by the
+  // `kTextureAnimationProgressOffset` behavior target.
+  //
+  // The frame selection is done entirely in the shaders, so animating a
+  // drawable only updates one uniform per mesh and never touches its mesh
+  // data. The time is kept when `SkiaRenderer::UpdateDrawable()` recreates the
+  // drawable's meshes. It is zero by default.
+  void SetTextureAnimationTime(absl::Duration time);
+
+  // Returns true if some brush coats are drawn without their textures, because
+  // the texture provider signaled that a texture is not loaded yet; see
+  // `TextureBitmapStore::GetTextureBitmap()`. Such a drawable should be
+  // recreated once the texture has loaded.
+  bool IsMissingTextures() const;
+
  private:
   friend SkiaRenderer;
 
@@ -210,22 +642,42 @@ class SkiaRenderer::Drawable {
   // A `variant` is used instead of inheritance to save extra allocations /
   // indirections since a drawable can hold multiple meshes or paths.
   using Implementation = std::variant<skia_native_internal::MeshDrawable,
-                                      skia_native_internal::PathDrawable>;
+                                      skia_native_internal::PathDrawable,
+                                      skia_native_internal::TriangleDrawable>;
 
   Drawable(const AffineTransform& object_to_canvas,
            absl::InlinedVector<Implementation, 1> drawable_impls);
 
   AffineTransform object_to_canvas_;
   absl::InlinedVector<Implementation, 1> drawable_implementations_;
+  sk_sp<SkImageFilter> image_filter_;
+  absl::Duration texture_animation_time_ = absl::ZeroDuration();
+  // The buffers of each brush coat of a drawable created from an
+  // `InProgressStroke`, kept for `SkiaRenderer::UpdateDrawable()`.
+  absl::InlinedVector<skia_native_internal::GrowableMeshBuffers, 1>
+      coat_buffers_;
+  bool missing_textures_ = false;
 };
 
 // ---------------------------------------------------------------------------
 //                     Implementation details below
 
+struct SkiaRenderer::RetainedDrawable {
+  // Keeps the mesh data alive, so that its address cannot be reused while the
+  // entry exists.
+  PartitionedMesh shape;
+  absl::InlinedVector<BrushPaint, 1> paints;
+  Drawable drawable;
+};
+
 inline const AffineTransform& SkiaRenderer::Drawable::ObjectToCanvas() const {
   return object_to_canvas_;
 }
 
+inline bool SkiaRenderer::Drawable::IsMissingTextures() const {
+  return missing_textures_;
+}
+
 }  // namespace ink
 
 #endif  // INK_RENDERING_SKIA_NATIVE_SKIA_RENDERER_H_
@@ -0,0 +1,323 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/rect.h"
+#include "ink/rendering/skia/native/skia_renderer.h"
+#include "ink/rendering/skia/native/texture_bitmap_store.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/recorded_test_inputs.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkBlender.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkMesh.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkVertices.h"
+
+namespace ink {
+namespace {
+
+// The benchmarks below draw on the CPU, into a raster canvas, by passing a null
+// `GrDirectContext`. Each iteration is one frame, and the draw calls issued to
+// the canvas per frame are reported in the `draw_calls` counter.
+
+constexpr int kCanvasSize = 512;
+// Strokes are laid out in a grid of cells of this size, in canvas units at a
+// zoom of 100%.
+constexpr float kCellSize = 64;
+
+// A canvas that counts the stroke draw calls that reach it, and rasterizes them
+// into its bitmap as usual.
+class DrawCountingCanvas : public SkCanvas {
+ public:
+  explicit DrawCountingCanvas(const SkBitmap& bitmap) : SkCanvas(bitmap) {}
+
+  int64_t DrawCount() const { return draw_count_; }
+
+ protected:
+  void onDrawPath(const SkPath& path, const SkPaint& paint) override {
+    ++draw_count_;
+    SkCanvas::onDrawPath(path, paint);
+  }
+  void onDrawMesh(const SkMesh& mesh, sk_sp<SkBlender> blender,
+                  const SkPaint& paint) override {
+    ++draw_count_;
+    SkCanvas::onDrawMesh(mesh, std::move(blender), paint);
+  }
+  void onDrawVerticesObject(const SkVertices* vertices, SkBlendMode mode,
+                            const SkPaint& paint) override {
+    ++draw_count_;
+    SkCanvas::onDrawVerticesObject(vertices, mode, paint);
+  }
+
+ private:
+  int64_t draw_count_ = 0;
+};
+
+// A `TextureBitmapStore` that returns the same small image for every texture.
+class FakeTextureStore : public TextureBitmapStore {
+ public:
+  FakeTextureStore() {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(16, 16);
+    bitmap.eraseColor(SK_ColorGRAY);
+    bitmap.setImmutable();
+    image_ = bitmap.asImage();
+  }
+
+  absl::StatusOr<sk_sp<SkImage>> GetTextureBitmap(
+      absl::string_view texture_id) const override {
+    return image_;
+  }
+
+ private:
+  sk_sp<SkImage> image_;
+};
+
+// The kinds of brushes benchmarked, passed as a benchmark argument.
+enum BrushKind : int64_t {
+  kSolid = 0,
+  kTextured = 1,
+  kMultiCoat = 2,
+};
+
+Brush MakeBrush(int64_t kind) {
+  BrushPaint textured_paint{
+      {{.client_texture_id = "texture",
+        .mapping = BrushPaint::TextureMapping::kTiling,
+        .size_unit = BrushPaint::TextureSizeUnit::kBrushSize}}};
+  std::vector<BrushCoat> coats;
+  switch (kind) {
+    case kSolid:
+      coats = {{.tip = BrushTip()}};
+      break;
+    case kTextured:
+      coats = {{.tip = BrushTip(), .paint = textured_paint}};
+      break;
+    case kMultiCoat:
+      coats = {{.tip = BrushTip{.scale = {1.5, 1.5},
+                                .opacity_multiplier = 0.5}},
+               {.tip = BrushTip(), .paint = textured_paint},
+               {.tip = BrushTip{.scale = {0.5, 0.5}}}};
+      break;
+  }
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(coats);
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush =
+      Brush::Create(*family, Color::Blue(), /* size = */ 4,
+                    /* epsilon = */ 0.05);
+  ABSL_CHECK_OK(brush);
+  return *std::move(brush);
+}
+
+// Returns `count` finished strokes, each filling a cell of a square grid, so
+// that the page is `ceil(sqrt(count)) * kCellSize` wide.
+std::vector<Stroke> MakeStrokes(int64_t count, int64_t brush_kind) {
+  Brush brush = MakeBrush(brush_kind);
+  int64_t columns = 1;
+  while (columns * columns < count) ++columns;
+  std::vector<Stroke> strokes;
+  strokes.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    float x = (i % columns) * kCellSize;
+    float y = (i / columns) * kCellSize;
+    strokes.emplace_back(
+        brush, MakeCompleteSpringShapeInputs(Rect::FromTwoPoints(
+                   {x, y}, {x + kCellSize * 0.8f, y + kCellSize * 0.8f})));
+  }
+  return strokes;
+}
+
+// Returns the transform for a zoom level given as a percentage, about the
+// origin of the page. Zooming in moves most strokes out of the canvas.
+AffineTransform ZoomTransform(int64_t zoom_percent) {
+  return AffineTransform::Scale(zoom_percent / 100.f);
+}
+
+SkBitmap MakeBitmap() {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(kCanvasSize, kCanvasSize);
+  return bitmap;
+}
+
+void BM_CreateDrawables(benchmark::State& state) {
+  SkiaRenderer renderer(std::make_shared<FakeTextureStore>());
+  std::vector<Stroke> strokes = MakeStrokes(state.range(0), state.range(1));
+  for (auto s : state) {
+    for (const Stroke& stroke : strokes) {
+      absl::StatusOr<SkiaRenderer::Drawable> drawable =
+          renderer.CreateDrawable(nullptr, stroke, AffineTransform());
+      ABSL_CHECK_OK(drawable);
+      benchmark::DoNotOptimize(drawable);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CreateDrawables)
+    ->ArgNames({"strokes", "brush"})
+    ->ArgsProduct({{1, 64, 512}, {kSolid, kTextured, kMultiCoat}});
+
+// Draws drawables created ahead of time, as a client that retains them would.
+void BM_DrawDrawables(benchmark::State& state) {
+  SkiaRenderer renderer(std::make_shared<FakeTextureStore>());
+  std::vector<Stroke> strokes = MakeStrokes(state.range(0), state.range(1));
+  AffineTransform zoom = ZoomTransform(state.range(2));
+  std::vector<SkiaRenderer::Drawable> drawables;
+  for (const Stroke& stroke : strokes) {
+    absl::StatusOr<SkiaRenderer::Drawable> drawable =
+        renderer.CreateDrawable(nullptr, stroke, zoom);
+    ABSL_CHECK_OK(drawable);
+    drawables.push_back(*std::move(drawable));
+  }
+  SkBitmap bitmap = MakeBitmap();
+  DrawCountingCanvas canvas(bitmap);
+  SkiaRenderer::CullStats cull_stats;
+  for (auto s : state) {
+    canvas.clear(SK_ColorWHITE);
+    for (const SkiaRenderer::Drawable& drawable : drawables) {
+      drawable.Draw(canvas, &cull_stats);
+    }
+  }
+  state.counters["draw_calls"] = benchmark::Counter(
+      canvas.DrawCount(), benchmark::Counter::kAvgIterations);
+  state.counters["culled_strokes"] = benchmark::Counter(
+      cull_stats.culled_drawables, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_DrawDrawables)
+    ->ArgNames({"strokes", "brush", "zoom"})
+    ->ArgsProduct(
+        {{1, 64, 512}, {kSolid, kTextured, kMultiCoat}, {25, 100, 400}});
+
+// Draws finished strokes with `SkiaRenderer::DrawStrokes()`, which culls before
+// creating drawables, optionally with the caches of the renderer enabled.
+void BM_DrawStrokes(benchmark::State& state) {
+  SkiaRenderer renderer(std::make_shared<FakeTextureStore>());
+  bool use_caches = state.range(3) != 0;
+  if (use_caches) {
+    renderer.SetDrawableCacheMaxEntries(state.range(0));
+    renderer.SetPathCacheMaxBytes(64 << 20);
+  }
+  std::vector<Stroke> strokes = MakeStrokes(state.range(0), state.range(1));
+  AffineTransform zoom = ZoomTransform(state.range(2));
+  std::vector<SkiaRenderer::StrokeAndTransform> items;
+  for (const Stroke& stroke : strokes) {
+    items.push_back({.stroke = &stroke, .object_to_canvas = zoom});
+  }
+  SkBitmap bitmap = MakeBitmap();
+  DrawCountingCanvas canvas(bitmap);
+  for (auto s : state) {
+    canvas.clear(SK_ColorWHITE);
+    ABSL_CHECK_OK(renderer.DrawStrokes(nullptr, items, canvas));
+  }
+  state.counters["draw_calls"] = benchmark::Counter(
+      canvas.DrawCount(), benchmark::Counter::kAvgIterations);
+  state.counters["culled_strokes"] =
+      benchmark::Counter(renderer.GetCullStats().culled_drawables,
+                         benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_DrawStrokes)
+    ->ArgNames({"strokes", "brush", "zoom", "caches"})
+    ->ArgsProduct({{64, 512}, {kSolid, kMultiCoat}, {25, 100, 400}, {0, 1}});
+
+// Draws finished strokes without a `GrDirectContext`, either as filled paths
+// or with their mesh triangles rasterized on the CPU.
+void BM_DrawStrokesOnCpu(benchmark::State& state) {
+  SkiaRenderer renderer(std::make_shared<FakeTextureStore>());
+  renderer.SetCpuTriangleRasterizationEnabled(state.range(3) != 0);
+  std::vector<Stroke> strokes = MakeStrokes(state.range(0), state.range(1));
+  AffineTransform zoom = ZoomTransform(state.range(2));
+  std::vector<SkiaRenderer::StrokeAndTransform> items;
+  for (const Stroke& stroke : strokes) {
+    items.push_back({.stroke = &stroke, .object_to_canvas = zoom});
+  }
+  SkBitmap bitmap = MakeBitmap();
+  SkCanvas canvas(bitmap);
+  for (auto s : state) {
+    canvas.clear(SK_ColorWHITE);
+    ABSL_CHECK_OK(renderer.DrawStrokes(nullptr, items, canvas));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DrawStrokesOnCpu)
+    ->ArgNames({"strokes", "brush", "zoom", "triangles"})
+    ->ArgsProduct({{1, 64}, {kSolid, kMultiCoat}, {100, 400}, {0, 1}});
+
+// Draws an in-progress stroke after every update of its inputs, as while the
+// user is drawing it. The drawable is either recreated on every frame, or
+// updated with only the new geometry.
+void BM_DrawInProgressStroke(benchmark::State& state) {
+  SkiaRenderer renderer(std::make_shared<FakeTextureStore>());
+  Brush brush = MakeBrush(state.range(0));
+  bool incremental = state.range(1) != 0;
+  auto inputs = MakeIncrementalSpringShapeInputs(
+      Rect::FromTwoPoints({0, 0}, {kCanvasSize, kCanvasSize}));
+  SkBitmap bitmap = MakeBitmap();
+  DrawCountingCanvas canvas(bitmap);
+  InProgressStroke stroke;
+  for (auto s : state) {
+    stroke.Start(brush);
+    SkiaRenderer::Drawable drawable;
+    bool has_drawable = false;
+    for (const auto& [real_inputs, predicted_inputs] : inputs) {
+      ABSL_CHECK_OK(stroke.EnqueueInputs(real_inputs, predicted_inputs));
+      ABSL_CHECK_OK(stroke.UpdateShape(
+          real_inputs.Get(real_inputs.Size() - 1).elapsed_time));
+      if (incremental && has_drawable) {
+        ABSL_CHECK_OK(renderer.UpdateDrawable(nullptr, stroke, drawable));
+      } else {
+        absl::StatusOr<SkiaRenderer::Drawable> new_drawable =
+            renderer.CreateDrawable(nullptr, stroke, AffineTransform());
+        ABSL_CHECK_OK(new_drawable);
+        drawable = *std::move(new_drawable);
+        has_drawable = true;
+      }
+      stroke.ResetUpdatedRegion();
+      canvas.clear(SK_ColorWHITE);
+      drawable.Draw(canvas);
+    }
+  }
+  // Report the time per frame, rather than per stroke.
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+  state.counters["draw_calls"] = benchmark::Counter(
+      canvas.DrawCount(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_DrawInProgressStroke)
+    ->ArgNames({"brush", "incremental"})
+    ->ArgsProduct({{kSolid, kTextured, kMultiCoat}, {0, 1}});
+
+}  // namespace
+}  // namespace ink
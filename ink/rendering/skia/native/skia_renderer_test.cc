@@ -14,12 +14,40 @@
 
 #include "ink/rendering/skia/native/skia_renderer.h"
 
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_behavior.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
 #include "ink/color/color.h"
 #include "ink/geometry/affine_transform.h"
 #include "ink/geometry/angle.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/scene_index.h"
 #include "ink/geometry/type_matchers.h"
+#include "ink/rendering/skia/native/texture_bitmap_store.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/memory_trim.h"
+#include "ink/types/test_executor.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkRefCnt.h"
 
 namespace ink {
 namespace {
@@ -29,6 +57,7 @@ namespace {
 TEST(SkiaRendererDrawableTest, DefaultConstructed) {
   SkiaRenderer::Drawable drawable;
   EXPECT_FALSE(drawable.HasBrushColor());
+  EXPECT_FALSE(drawable.IsMissingTextures());
   EXPECT_THAT(drawable.ObjectToCanvas(),
               AffineTransformEq(AffineTransform::Identity()));
 }
@@ -44,6 +73,414 @@ TEST(SkiaRendererDrawableTest, SetObjectToCanvas) {
   EXPECT_THAT(drawable.ObjectToCanvas(), AffineTransformEq(transform));
 }
 
+TEST(SkiaRendererDrawableTest, DrawInstancesKeepsObjectToCanvas) {
+  SkiaRenderer::Drawable drawable;
+  AffineTransform transform = AffineTransform::Translate({5, -9});
+  drawable.SetObjectToCanvas(transform);
+
+  SkCanvas canvas;
+  std::vector<AffineTransform> instances = {
+      AffineTransform::Scale(2),
+      AffineTransform::RotateAboutPoint(kFullTurn / 8, {1, 2})};
+  drawable.DrawInstances(canvas, instances);
+
+  EXPECT_THAT(drawable.ObjectToCanvas(), AffineTransformEq(transform));
+}
+
+TEST(SkiaRendererTest, DrawStrokesWithNoStrokes) {
+  SkiaRenderer renderer;
+  SkCanvas canvas;
+  EXPECT_EQ(renderer.DrawStrokes(nullptr, {}, canvas), absl::OkStatus());
+}
+
+TEST(SkiaRendererTest, DrawStrokesSkipsEmptyStroke) {
+  SkiaRenderer renderer;
+  SkCanvas canvas;
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  Stroke stroke(*brush);
+  std::vector<SkiaRenderer::StrokeAndTransform> strokes = {
+      {.stroke = &stroke, .object_to_canvas = AffineTransform::Scale(2)}};
+  EXPECT_EQ(renderer.DrawStrokes(nullptr, strokes, canvas), absl::OkStatus());
+}
+
+TEST(SkiaRendererTest, BuildTextureAtlasWithoutStampingTextures) {
+  SkiaRenderer renderer;
+  EXPECT_EQ(renderer.BuildTextureAtlas({}), absl::OkStatus());
+}
+
+TEST(SkiaRendererTest, CullStatsCountStrokesOutsideClip) {
+  SkiaRenderer renderer;
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(100, 100);
+  SkCanvas canvas(bitmap);
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 10}, .elapsed_time = Duration32::Zero()},
+       {.position = {20, 15}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+
+  std::vector<SkiaRenderer::StrokeAndTransform> strokes = {
+      {.stroke = &stroke, .object_to_canvas = AffineTransform::Identity()},
+      {.stroke = &stroke,
+       .object_to_canvas = AffineTransform::Translate({1000, 1000})}};
+  EXPECT_EQ(renderer.DrawStrokes(nullptr, strokes, canvas), absl::OkStatus());
+  EXPECT_EQ(renderer.GetCullStats().culled_drawables, 1);
+
+  EXPECT_EQ(renderer.Draw(nullptr, stroke,
+                          AffineTransform::Translate({-500, 0}), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(renderer.GetCullStats().culled_drawables, 2);
+
+  renderer.ResetCullStats();
+  EXPECT_EQ(renderer.GetCullStats().culled_drawables, 0);
+}
+
+TEST(SkiaRendererTest, DrawDirtyRegionDrawsOnlyIntersectingStrokes) {
+  SkiaRenderer renderer;
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(100, 100);
+  bitmap.eraseColor(SK_ColorTRANSPARENT);
+  SkCanvas canvas(bitmap);
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 10}, .elapsed_time = Duration32::Zero()},
+       {.position = {30, 10}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+
+  AffineTransform scene_to_canvas = AffineTransform::Translate({0, 20});
+  std::vector<AffineTransform> object_to_scene = {
+      AffineTransform::Identity(), AffineTransform::Translate({0, 1000})};
+  SceneIndex scene_index;
+  std::vector<SkiaRenderer::StrokeAndTransform> strokes;
+  for (int i = 0; i < 2; ++i) {
+    scene_index.Insert(i, stroke.GetShape(), object_to_scene[i]);
+    strokes.push_back(
+        {.stroke = &stroke,
+         .object_to_canvas = scene_to_canvas * object_to_scene[i]});
+  }
+
+  // The second stroke is not even visited, so it isn't counted as culled.
+  EXPECT_EQ(renderer.DrawDirtyRegion(
+                nullptr, Rect::FromTwoPoints({0, 0}, {20, 50}), strokes,
+                scene_index, scene_to_canvas, canvas),
+            absl::OkStatus());
+  EXPECT_EQ(renderer.GetCullStats().culled_drawables, 0);
+  // Only the part of the first stroke inside the dirty rect is drawn.
+  EXPECT_EQ(bitmap.getColor(15, 30), SK_ColorRED);
+  EXPECT_EQ(bitmap.getColor(25, 30), SK_ColorTRANSPARENT);
+}
+
+TEST(SkiaRendererTest, DrawDirtyRegionWithIdOutsideStrokes) {
+  SkiaRenderer renderer;
+  SkCanvas canvas;
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 10}, .elapsed_time = Duration32::Zero()},
+       {.position = {30, 10}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+  SceneIndex scene_index;
+  scene_index.Insert(1, stroke.GetShape());
+  std::vector<SkiaRenderer::StrokeAndTransform> strokes = {
+      {.stroke = &stroke, .object_to_canvas = AffineTransform::Identity()}};
+
+  EXPECT_EQ(renderer
+                .DrawDirtyRegion(nullptr,
+                                 Rect::FromTwoPoints({0, 0}, {100, 100}),
+                                 strokes, scene_index,
+                                 AffineTransform::Identity(), canvas)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(SkiaRendererTest, DrawWithDrawableCacheEnabled) {
+  SkiaRenderer renderer;
+  renderer.SetDrawableCacheMaxEntries(4);
+  SkCanvas canvas;
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+       {.position = {10, 5}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+
+  // The second draw reuses the drawable retained by the first, and the third
+  // picks up the new brush color.
+  EXPECT_EQ(renderer.Draw(nullptr, stroke, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(renderer.Draw(nullptr, stroke, AffineTransform::Scale(2), canvas),
+            absl::OkStatus());
+  stroke.SetBrushColor(Color::GoogleBlue());
+  EXPECT_EQ(renderer.Draw(nullptr, stroke, AffineTransform::Scale(2), canvas),
+            absl::OkStatus());
+  renderer.SetDrawableCacheMaxEntries(0);
+}
+
+TEST(SkiaRendererTest, DrawWithPrewarmedPaths) {
+  SkiaRenderer renderer;
+  renderer.SetPathCacheMaxBytes(1024 * 1024);
+  SkCanvas canvas;
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+       {.position = {10, 5}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  std::vector<Stroke> strokes = {Stroke(*brush, *inputs)};
+
+  renderer.PrewarmPaths(strokes);
+  EXPECT_EQ(
+      renderer.Draw(nullptr, strokes[0], AffineTransform::Identity(), canvas),
+      absl::OkStatus());
+  EXPECT_EQ(renderer.Draw(nullptr, strokes[0], AffineTransform::Scale(2),
+                          canvas),
+            absl::OkStatus());
+  renderer.SetPathCacheMaxBytes(0);
+}
+
+TEST(SkiaRendererTest, TrimMemoryReleasesPathCache) {
+  SkiaRenderer renderer;
+  renderer.SetPathCacheMaxBytes(1024 * 1024);
+  SkCanvas canvas;
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+       {.position = {10, 5}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  std::vector<Stroke> strokes = {Stroke(*brush, *inputs)};
+  renderer.PrewarmPaths(strokes);
+
+  EXPECT_EQ(renderer.TrimMemory(MemoryTrimLevel::kPooledMemory), 0u);
+  EXPECT_GT(renderer.TrimMemory(MemoryTrimLevel::kCaches), 0u);
+  EXPECT_EQ(renderer.TrimMemory(MemoryTrimLevel::kAll), 0u);
+
+  // The renderer keeps drawing, and caching, as usual afterwards.
+  EXPECT_EQ(
+      renderer.Draw(nullptr, strokes[0], AffineTransform::Identity(), canvas),
+      absl::OkStatus());
+}
+
+TEST(SkiaRendererTest, DrawWithCpuTriangleRasterization) {
+  ThreadPerTaskExecutor executor;
+  SkiaRenderer renderer;
+  renderer.SetCpuTriangleRasterizationEnabled(true, &executor);
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(100, 100);
+  bitmap.eraseColor(SK_ColorTRANSPARENT);
+  SkCanvas canvas(bitmap);
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 10}, .elapsed_time = Duration32::Zero()},
+       {.position = {30, 10}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+
+  EXPECT_EQ(renderer.Draw(nullptr, stroke, AffineTransform::Translate({0, 20}),
+                          canvas),
+            absl::OkStatus());
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+  EXPECT_EQ(bitmap.getColor(20, 30), SK_ColorRED);
+  EXPECT_EQ(bitmap.getColor(20, 60), SK_ColorTRANSPARENT);
+}
+
+TEST(SkiaRendererTest, RecordStrokesForRasterPlayback) {
+  SkiaRenderer renderer;
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 10}, .elapsed_time = Duration32::Zero()},
+       {.position = {30, 10}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+  std::vector<SkiaRenderer::StrokeAndTransform> strokes = {
+      {.stroke = &stroke, .object_to_canvas = AffineTransform::Identity()},
+      {.stroke = &stroke,
+       .object_to_canvas = AffineTransform::Translate({1000, 1000})}};
+
+  absl::StatusOr<sk_sp<SkPicture>> picture = renderer.RecordStrokes(
+      strokes, Rect::FromTwoPoints({0, 0}, {100, 100}),
+      SkiaRenderer::PlaybackTarget::kRaster);
+  ASSERT_EQ(picture.status(), absl::OkStatus());
+  ASSERT_NE(*picture, nullptr);
+  // Recording neither updates nor is counted in the renderer's stats.
+  EXPECT_EQ(renderer.GetCullStats().culled_drawables, 0);
+
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(100, 100);
+  bitmap.eraseColor(SK_ColorTRANSPARENT);
+  SkCanvas canvas(bitmap);
+  canvas.drawPicture(*picture);
+  EXPECT_EQ(bitmap.getColor(20, 10), SK_ColorRED);
+  EXPECT_EQ(bitmap.getColor(20, 50), SK_ColorTRANSPARENT);
+}
+
+TEST(SkiaRendererTest, RecordStrokesForGpuPlayback) {
+  SkiaRenderer renderer;
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 10}, .elapsed_time = Duration32::Zero()},
+       {.position = {30, 10}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+  std::vector<SkiaRenderer::StrokeAndTransform> strokes = {
+      {.stroke = &stroke, .object_to_canvas = AffineTransform::Identity()}};
+
+  absl::StatusOr<sk_sp<SkPicture>> picture = renderer.RecordStrokes(
+      strokes, Rect::FromTwoPoints({0, 0}, {100, 100}),
+      SkiaRenderer::PlaybackTarget::kGpu);
+  ASSERT_EQ(picture.status(), absl::OkStatus());
+  EXPECT_NE(*picture, nullptr);
+}
+
+TEST(SkiaRendererTest, RecordStrokesConcurrently) {
+  SkiaRenderer renderer;
+  renderer.SetPathCacheMaxBytes(1024 * 1024);
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 10}, .elapsed_time = Duration32::Zero()},
+       {.position = {90, 90}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+  std::vector<SkiaRenderer::StrokeAndTransform> strokes = {
+      {.stroke = &stroke, .object_to_canvas = AffineTransform::Identity()}};
+
+  // Each thread records a different tile of the same strokes, sharing the
+  // renderer's caches.
+  constexpr int kThreadCount = 4;
+  std::vector<absl::StatusOr<sk_sp<SkPicture>>> pictures(
+      kThreadCount, absl::UnknownError("not recorded"));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&renderer, &strokes, &pictures, i]() {
+      float x = (i % 2) * 50;
+      float y = (i / 2) * 50;
+      pictures[i] = renderer.RecordStrokes(
+          strokes, Rect::FromTwoPoints({x, y}, {x + 50, y + 50}),
+          i % 2 == 0 ? SkiaRenderer::PlaybackTarget::kRaster
+                     : SkiaRenderer::PlaybackTarget::kGpu);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (const absl::StatusOr<sk_sp<SkPicture>>& picture : pictures) {
+    EXPECT_EQ(picture.status(), absl::OkStatus());
+  }
+  renderer.SetPathCacheMaxBytes(0);
+}
+
+// A `TextureBitmapStore` that returns the same opaque white image for every
+// texture ID.
+class WhiteTextureStore : public TextureBitmapStore {
+ public:
+  absl::StatusOr<sk_sp<SkImage>> GetTextureBitmap(
+      absl::string_view texture_id) const override {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(4, 4);
+    bitmap.eraseColor(SK_ColorWHITE);
+    bitmap.setImmutable();
+    return bitmap.asImage();
+  }
+};
+
+Brush MakeStampingParticleBrush() {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(
+      BrushTip{.corner_rounding = 0, .particle_gap_distance_scale = 1},
+      BrushPaint{{{.client_texture_id = "stamp",
+                   .mapping = BrushPaint::TextureMapping::kStamping}}});
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush = Brush::Create(*family, Color::Red(), 10, 0.1);
+  ABSL_CHECK_OK(brush);
+  return *brush;
+}
+
+TEST(SkiaRendererTest, CanDrawStampedCoat) {
+  BrushCoat coat = MakeStampingParticleBrush().GetCoats()[0];
+  EXPECT_TRUE(SkiaRenderer::CanDrawStampedCoat(coat));
+
+  BrushCoat animated = coat;
+  animated.paint.texture_layers[0].animation_frames = 4;
+  EXPECT_FALSE(SkiaRenderer::CanDrawStampedCoat(animated));
+
+  BrushCoat hue_shifted = coat;
+  hue_shifted.tip.behaviors.push_back(BrushBehavior{{
+      BrushBehavior::ConstantNode{.value = 1},
+      BrushBehavior::TargetNode{
+          .target = BrushBehavior::Target::kHueOffsetInRadians,
+          .target_modifier_range = {0, 1}},
+  }});
+  EXPECT_FALSE(SkiaRenderer::CanDrawStampedCoat(hue_shifted));
+
+  BrushCoat not_particles = coat;
+  not_particles.tip.particle_gap_distance_scale = 0;
+  EXPECT_FALSE(SkiaRenderer::CanDrawStampedCoat(not_particles));
+}
+
+TEST(SkiaRendererTest, DrawStampedCoat) {
+  SkiaRenderer renderer(std::make_shared<WhiteTextureStore>());
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(100, 100);
+  bitmap.eraseColor(SK_ColorTRANSPARENT);
+  SkCanvas canvas(bitmap);
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 50}, .elapsed_time = Duration32::Zero()},
+       {.position = {90, 50}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke = Stroke::WithLazyShape(MakeStampingParticleBrush(), *inputs);
+
+  EXPECT_EQ(renderer.DrawStampedCoat(stroke, 0, AffineTransform::Identity(),
+                                     canvas),
+            absl::OkStatus());
+  // The stamps are as tall as the brush size, and touch along the stroke.
+  EXPECT_EQ(bitmap.getColor(50, 50), SK_ColorRED);
+  EXPECT_EQ(bitmap.getColor(50, 70), SK_ColorTRANSPARENT);
+
+  EXPECT_EQ(renderer
+                .DrawStampedCoat(stroke, 1, AffineTransform::Identity(), canvas)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(SkiaRendererTest, DrawStampedCoatWithUnsupportedCoat) {
+  SkiaRenderer renderer(std::make_shared<WhiteTextureStore>());
+  SkCanvas canvas;
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+       {.position = {10, 5}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+
+  EXPECT_EQ(renderer
+                .DrawStampedCoat(stroke, 0, AffineTransform::Identity(), canvas)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(SkiaRendererTest, DrawStampedCoatWithoutTextureProvider) {
+  SkiaRenderer renderer;
+  SkCanvas canvas;
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {0, 0}, .elapsed_time = Duration32::Zero()}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(MakeStampingParticleBrush(), *inputs);
+
+  EXPECT_EQ(renderer
+                .DrawStampedCoat(stroke, 0, AffineTransform::Identity(), canvas)
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
 TEST(SkiaRendererDrawableDeathTest, SetObjectToCanvas) {
   SkiaRenderer::Drawable drawable;
   ASSERT_FALSE(drawable.HasBrushColor());
@@ -0,0 +1,258 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/stroke_tile_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/intersects.h"
+#include "ink/geometry/rect.h"
+#include "ink/rendering/skia/native/skia_renderer.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/trace.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkSurface.h"
+#include "include/gpu/GpuTypes.h"
+#include "include/gpu/ganesh/GrDirectContext.h"
+#include "include/gpu/ganesh/SkSurfaceGanesh.h"
+
+namespace ink {
+namespace {
+
+// The range of zoom levels that tiles are rendered at. Views zoomed in or out
+// further than this resample the tiles of the nearest level.
+constexpr int kMinLevel = -16;
+constexpr int kMaxLevel = 16;
+
+SkM44 ToSkiaM44(const AffineTransform& t) {
+  // The constructor parameters are documented to be in row-major order.
+  return SkM44(t.A(), t.B(), 0, t.C(),  //
+               t.D(), t.E(), 0, t.F(),  //
+               0, 0, 1, 0,              //
+               0, 0, 0, 1);             //
+}
+
+}  // namespace
+
+StrokeTileCache::StrokeTileCache(SkiaRenderer* absl_nonnull renderer,
+                                 int tile_size, size_t max_tiles)
+    : renderer_(renderer), tile_size_(tile_size), max_tiles_(max_tiles) {
+  ABSL_CHECK_GT(tile_size_, 0);
+}
+
+void StrokeTileCache::SetStroke(StrokeId id, const Stroke& stroke,
+                                const AffineTransform& object_to_world) {
+  if (auto it = strokes_.find(id);
+      it != strokes_.end() && it->second.world_bounds.has_value()) {
+    InvalidateTilesOverlapping(*it->second.world_bounds);
+  }
+  std::optional<Rect> world_bounds;
+  if (std::optional<Rect> bounds = stroke.GetShape().Bounds().AsRect();
+      bounds.has_value()) {
+    world_bounds = Envelope(object_to_world.Apply(*bounds)).AsRect();
+    InvalidateTilesOverlapping(*world_bounds);
+  }
+  strokes_.insert_or_assign(id, StrokeEntry{.stroke = stroke,
+                                            .object_to_world = object_to_world,
+                                            .world_bounds = world_bounds});
+}
+
+void StrokeTileCache::RemoveStroke(StrokeId id) {
+  auto it = strokes_.find(id);
+  if (it == strokes_.end()) return;
+  if (it->second.world_bounds.has_value()) {
+    InvalidateTilesOverlapping(*it->second.world_bounds);
+  }
+  strokes_.erase(it);
+}
+
+void StrokeTileCache::InvalidateTiles() {
+  tiles_by_key_.clear();
+  tiles_.clear();
+}
+
+absl::Status StrokeTileCache::Draw(GrDirectContext* absl_nullable context,
+                                   const AffineTransform& world_to_canvas,
+                                   SkCanvas& canvas) {
+  ScopedTraceEvent trace_event("ink::StrokeTileCache::Draw");
+  if (context != tile_context_ ||
+      (tile_context_ != nullptr && tile_context_->abandoned())) {
+    InvalidateTiles();
+    tile_context_ = context;
+  }
+
+  SkIRect clip = canvas.getDeviceClipBounds();
+  std::optional<AffineTransform> canvas_to_world = world_to_canvas.Inverse();
+  if (clip.isEmpty() || !canvas_to_world.has_value()) return absl::OkStatus();
+  Rect visible_world_bounds =
+      *Envelope(canvas_to_world->Apply(Rect::FromTwoPoints(
+                    {static_cast<float>(clip.left()),
+                     static_cast<float>(clip.top())},
+                    {static_cast<float>(clip.right()),
+                     static_cast<float>(clip.bottom())})))
+           .AsRect();
+
+  float scale_x = world_to_canvas.A();
+  float scale_y = world_to_canvas.E();
+  if (world_to_canvas.B() != 0 || world_to_canvas.D() != 0 || scale_x <= 0 ||
+      scale_y <= 0) {
+    return DrawStrokesDirectly(context, world_to_canvas, visible_world_bounds,
+                               canvas);
+  }
+
+  int level = std::clamp(
+      static_cast<int>(std::lround(std::log2(std::max(scale_x, scale_y)))),
+      kMinLevel, kMaxLevel);
+  float tile_world_size = std::ldexp(static_cast<float>(tile_size_), -level);
+  // The maximum edges of the clip are exclusive.
+  double x_min = std::floor(visible_world_bounds.XMin() / tile_world_size);
+  double x_max = std::ceil(visible_world_bounds.XMax() / tile_world_size) - 1;
+  double y_min = std::floor(visible_world_bounds.YMin() / tile_world_size);
+  double y_max = std::ceil(visible_world_bounds.YMax() / tile_world_size) - 1;
+  if ((x_max - x_min + 1) * (y_max - y_min + 1) >
+      static_cast<double>(max_tiles_)) {
+    return DrawStrokesDirectly(context, world_to_canvas, visible_world_bounds,
+                               canvas);
+  }
+
+  AffineTransform tile_to_world_scale =
+      AffineTransform::Scale(std::ldexp(1.0f, -level));
+  for (int y = static_cast<int>(y_min); y <= static_cast<int>(y_max); ++y) {
+    for (int x = static_cast<int>(x_min); x <= static_cast<int>(x_max); ++x) {
+      TileKey key = {.level = level, .x = x, .y = y};
+      absl::StatusOr<sk_sp<SkImage>> image = GetTileImage(context, key);
+      if (!image.ok()) return image.status();
+      // Tiles without any strokes have no image.
+      if (*image == nullptr) continue;
+
+      canvas.setMatrix(ToSkiaM44(
+          world_to_canvas *
+          AffineTransform::Translate({x * tile_world_size,
+                                      y * tile_world_size}) *
+          tile_to_world_scale));
+      canvas.drawImage(*image, 0, 0, SkSamplingOptions(SkFilterMode::kLinear));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Rect StrokeTileCache::TileWorldBounds(const TileKey& key) const {
+  float tile_world_size =
+      std::ldexp(static_cast<float>(tile_size_), -key.level);
+  Rect bounds = Rect::FromTwoPoints(
+      {key.x * tile_world_size, key.y * tile_world_size},
+      {(key.x + 1) * tile_world_size, (key.y + 1) * tile_world_size});
+  bounds.Offset(std::ldexp(1.0f, -key.level));
+  return bounds;
+}
+
+void StrokeTileCache::InvalidateTilesOverlapping(const Rect& world_bounds) {
+  for (auto it = tiles_.begin(); it != tiles_.end();) {
+    if (Intersects(TileWorldBounds(it->key), world_bounds)) {
+      tiles_by_key_.erase(it->key);
+      it = tiles_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+absl::StatusOr<sk_sp<SkImage>> StrokeTileCache::GetTileImage(
+    GrDirectContext* context, const TileKey& key) {
+  if (auto it = tiles_by_key_.find(key); it != tiles_by_key_.end()) {
+    tiles_.splice(tiles_.begin(), tiles_, it->second);
+    return it->second->image;
+  }
+
+  Rect tile_world_bounds = TileWorldBounds(key);
+  float tile_world_size =
+      std::ldexp(static_cast<float>(tile_size_), -key.level);
+  AffineTransform world_to_tile =
+      AffineTransform::Scale(std::ldexp(1.0f, key.level)) *
+      AffineTransform::Translate(
+          {-key.x * tile_world_size, -key.y * tile_world_size});
+  std::vector<SkiaRenderer::StrokeAndTransform> tile_strokes;
+  for (const auto& [id, entry] : strokes_) {
+    if (entry.world_bounds.has_value() &&
+        Intersects(tile_world_bounds, *entry.world_bounds)) {
+      tile_strokes.push_back(
+          {.stroke = &entry.stroke,
+           .object_to_canvas = world_to_tile * entry.object_to_world});
+    }
+  }
+
+  sk_sp<SkImage> image;
+  if (!tile_strokes.empty()) {
+    SkImageInfo info = SkImageInfo::MakeN32Premul(tile_size_, tile_size_);
+    sk_sp<SkSurface> surface =
+        context != nullptr
+            ? SkSurfaces::RenderTarget(context, skgpu::Budgeted::kYes, info)
+            : SkSurfaces::Raster(info);
+    if (surface == nullptr) {
+      return absl::InternalError("Failed to create a surface for a tile");
+    }
+    surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+    if (absl::Status status = renderer_->DrawStrokes(context, tile_strokes,
+                                                     *surface->getCanvas());
+        !status.ok()) {
+      return status;
+    }
+    image = surface->makeImageSnapshot();
+    ++rendered_tile_count_;
+  }
+
+  if (max_tiles_ == 0) return image;
+  if (tiles_.size() >= max_tiles_) {
+    tiles_by_key_.erase(tiles_.back().key);
+    tiles_.pop_back();
+  }
+  tiles_.push_front({.key = key, .image = image});
+  tiles_by_key_[key] = tiles_.begin();
+  return image;
+}
+
+absl::Status StrokeTileCache::DrawStrokesDirectly(
+    GrDirectContext* context, const AffineTransform& world_to_canvas,
+    const Rect& visible_world_bounds, SkCanvas& canvas) {
+  std::vector<SkiaRenderer::StrokeAndTransform> visible_strokes;
+  for (const auto& [id, entry] : strokes_) {
+    if (entry.world_bounds.has_value() &&
+        Intersects(visible_world_bounds, *entry.world_bounds)) {
+      visible_strokes.push_back(
+          {.stroke = &entry.stroke,
+           .object_to_canvas = world_to_canvas * entry.object_to_world});
+    }
+  }
+  return renderer_->DrawStrokes(context, visible_strokes, canvas);
+}
+
+}  // namespace ink
@@ -0,0 +1,163 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_STROKE_TILE_CACHE_H_
+#define INK_RENDERING_SKIA_NATIVE_STROKE_TILE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <optional>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/rect.h"
+#include "ink/rendering/skia/native/skia_renderer.h"
+#include "ink/strokes/stroke.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkRefCnt.h"
+#include "include/gpu/ganesh/GrDirectContext.h"
+
+namespace ink {
+
+// A cache of raster tiles of finished strokes drawn with a `SkiaRenderer`, so
+// that redrawing a page of unchanging strokes while panning or zooming costs
+// about the same no matter how many strokes it has.
+//
+// Strokes are added with a transform from their object coordinates to "world"
+// coordinates. `Draw()` covers the visible part of the world with square tiles
+// rendered at the power-of-two zoom level nearest to the scale of the
+// world-to-canvas transform, and draws them resampled to that exact transform.
+// Each tile is rendered once, by drawing the strokes that overlap it, and is
+// reused by later frames until it is evicted, or invalidated by setting or
+// removing a stroke that overlaps it. Tiles are GPU textures when drawing with
+// a `GrDirectContext`, and raster images otherwise.
+//
+// Live and in-progress strokes should be drawn on top of the tiles directly
+// with the renderer, after calling `Draw()`.
+//
+// Tiles are resampled, so strokes can look slightly softer than when drawn
+// directly. Transforms with rotation, skew, or reflection can't reuse
+// axis-aligned tiles, and neither can views that need more tiles than the
+// cache can hold. For those, `Draw()` draws the visible strokes directly with
+// `SkiaRenderer::DrawStrokes()` instead.
+//
+// Like `SkiaRenderer`, this type is thread-compatible. Tiles belong to the
+// `GrDirectContext` they were rendered with, so they are discarded when a
+// different context is passed in.
+class StrokeTileCache {
+ public:
+  // Identifies a stroke in the cache. Strokes are drawn in increasing order of
+  // their IDs.
+  using StrokeId = uint64_t;
+
+  // `renderer` must outlive the cache. Tiles are `tile_size` by `tile_size`
+  // pixels, and at most `max_tiles` of them are kept, evicting the least
+  // recently drawn first.
+  explicit StrokeTileCache(SkiaRenderer* absl_nonnull renderer,
+                           int tile_size = 256, size_t max_tiles = 256);
+
+  StrokeTileCache(const StrokeTileCache&) = delete;
+  StrokeTileCache& operator=(const StrokeTileCache&) = delete;
+  ~StrokeTileCache() = default;
+
+  // Adds the stroke with the given `id`, or replaces it if there already is
+  // one, and invalidates the tiles that overlap its old or new bounds.
+  void SetStroke(StrokeId id, const Stroke& stroke,
+                 const AffineTransform& object_to_world);
+
+  // Removes the stroke with the given `id`, if any, and invalidates the tiles
+  // that overlap it.
+  void RemoveStroke(StrokeId id);
+
+  // Invalidates every tile without removing any stroke, e.g. once a texture
+  // that was missing has loaded.
+  void InvalidateTiles();
+
+  // Draws the strokes with the given `world_to_canvas` transform into the
+  // `canvas`, rendering any visible tiles that are not cached yet. Returns the
+  // first error encountered drawing a stroke, if any.
+  //
+  // NOTE: Like `SkiaRenderer::Draw()`, this calls `canvas.setMatrix()`.
+  absl::Status Draw(GrDirectContext* absl_nullable context,
+                    const AffineTransform& world_to_canvas, SkCanvas& canvas);
+
+  size_t StrokeCount() const { return strokes_.size(); }
+  size_t TileCount() const { return tiles_.size(); }
+
+  // Returns the number of tiles rendered since the cache was created.
+  int64_t RenderedTileCount() const { return rendered_tile_count_; }
+
+ private:
+  struct StrokeEntry {
+    Stroke stroke;
+    AffineTransform object_to_world;
+    // Empty if the stroke has no shape.
+    std::optional<Rect> world_bounds;
+  };
+
+  struct TileKey {
+    // The tile is rendered at a scale of 2^level pixels per world unit.
+    int level;
+    int x;
+    int y;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const TileKey& key) {
+      return H::combine(std::move(h), key.level, key.x, key.y);
+    }
+    friend bool operator==(const TileKey&, const TileKey&) = default;
+  };
+
+  struct Tile {
+    TileKey key;
+    sk_sp<SkImage> image;
+  };
+
+  // Returns the area of the world covered by the tile with `key`, outset by a
+  // pixel so that it includes the antialiasing of strokes just outside of it.
+  Rect TileWorldBounds(const TileKey& key) const;
+
+  void InvalidateTilesOverlapping(const Rect& world_bounds);
+
+  // Returns the cached image of the tile with `key`, rendering it if needed.
+  absl::StatusOr<sk_sp<SkImage>> GetTileImage(GrDirectContext* context,
+                                              const TileKey& key);
+
+  // Draws the strokes overlapping the visible part of the world directly.
+  absl::Status DrawStrokesDirectly(GrDirectContext* context,
+                                   const AffineTransform& world_to_canvas,
+                                   const Rect& visible_world_bounds,
+                                   SkCanvas& canvas);
+
+  SkiaRenderer* absl_nonnull renderer_;
+  int tile_size_;
+  size_t max_tiles_;
+  std::map<StrokeId, StrokeEntry> strokes_;
+  // Tiles in order of most to least recently drawn.
+  std::list<Tile> tiles_;
+  absl::flat_hash_map<TileKey, std::list<Tile>::iterator> tiles_by_key_;
+  GrDirectContext* absl_nullable tile_context_ = nullptr;
+  int64_t rendered_tile_count_ = 0;
+};
+
+}  // namespace ink
+
+#endif  // INK_RENDERING_SKIA_NATIVE_STROKE_TILE_CACHE_H_
@@ -0,0 +1,184 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/stroke_tile_cache.h"
+
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/rendering/skia/native/skia_renderer.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+
+namespace ink {
+namespace {
+
+// These tests draw without a `GrDirectContext`, so tiles are raster images.
+
+Stroke MakeStroke() {
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 12, 1);
+  ABSL_CHECK_OK(brush);
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {10, 10}, .elapsed_time = Duration32::Zero()},
+       {.position = {20, 15}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ABSL_CHECK_OK(inputs);
+  return Stroke(*brush, *inputs);
+}
+
+class StrokeTileCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override { bitmap_.allocN32Pixels(512, 512); }
+
+  SkiaRenderer renderer_;
+  SkBitmap bitmap_;
+};
+
+TEST_F(StrokeTileCacheTest, DrawWithNoStrokesRendersNoTiles) {
+  StrokeTileCache cache(&renderer_, 256);
+  SkCanvas canvas(bitmap_);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.StrokeCount(), 0);
+  EXPECT_EQ(cache.TileCount(), 4);
+  EXPECT_EQ(cache.RenderedTileCount(), 0);
+}
+
+TEST_F(StrokeTileCacheTest, DrawReusesTiles) {
+  StrokeTileCache cache(&renderer_, 256);
+  cache.SetStroke(1, MakeStroke(), AffineTransform::Identity());
+  SkCanvas canvas(bitmap_);
+
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.TileCount(), 4);
+  EXPECT_EQ(cache.RenderedTileCount(), 1);
+
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.TileCount(), 4);
+  EXPECT_EQ(cache.RenderedTileCount(), 1);
+
+  // Zooming in by less than half a level still uses the same tiles.
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Scale(1.2), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.RenderedTileCount(), 1);
+
+  // Zooming in by a whole level renders the stroke into a new tile.
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Scale(2), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.RenderedTileCount(), 2);
+}
+
+TEST_F(StrokeTileCacheTest, SetStrokeInvalidatesOnlyOverlappingTiles) {
+  StrokeTileCache cache(&renderer_, 256);
+  cache.SetStroke(1, MakeStroke(), AffineTransform::Identity());
+  cache.SetStroke(2, MakeStroke(), AffineTransform::Translate({300, 300}));
+  SkCanvas canvas(bitmap_);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.RenderedTileCount(), 2);
+
+  // Moving the second stroke invalidates the tile it left, which is now empty,
+  // and the tile it moved to, but not the tile of the first stroke.
+  cache.SetStroke(2, MakeStroke(), AffineTransform::Translate({300, 0}));
+  EXPECT_EQ(cache.StrokeCount(), 2);
+  EXPECT_EQ(cache.TileCount(), 2);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.TileCount(), 4);
+  EXPECT_EQ(cache.RenderedTileCount(), 3);
+}
+
+TEST_F(StrokeTileCacheTest, RemoveStrokeInvalidatesOverlappingTiles) {
+  StrokeTileCache cache(&renderer_, 256);
+  cache.SetStroke(1, MakeStroke(), AffineTransform::Identity());
+  SkCanvas canvas(bitmap_);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.TileCount(), 4);
+
+  cache.RemoveStroke(1);
+  EXPECT_EQ(cache.StrokeCount(), 0);
+  EXPECT_EQ(cache.TileCount(), 3);
+  // Removing a stroke that isn't there does nothing.
+  cache.RemoveStroke(1);
+  EXPECT_EQ(cache.TileCount(), 3);
+}
+
+TEST_F(StrokeTileCacheTest, InvalidateTiles) {
+  StrokeTileCache cache(&renderer_, 256);
+  cache.SetStroke(1, MakeStroke(), AffineTransform::Identity());
+  SkCanvas canvas(bitmap_);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+
+  cache.InvalidateTiles();
+  EXPECT_EQ(cache.StrokeCount(), 1);
+  EXPECT_EQ(cache.TileCount(), 0);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.RenderedTileCount(), 2);
+}
+
+TEST_F(StrokeTileCacheTest, RotatedTransformDrawsStrokesDirectly) {
+  StrokeTileCache cache(&renderer_, 256);
+  cache.SetStroke(1, MakeStroke(), AffineTransform::Identity());
+  SkCanvas canvas(bitmap_);
+  EXPECT_EQ(cache.Draw(nullptr,
+                       AffineTransform::RotateAboutPoint(kFullTurn / 8,
+                                                         {256, 256}),
+                       canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.TileCount(), 0);
+  EXPECT_EQ(cache.RenderedTileCount(), 0);
+}
+
+TEST_F(StrokeTileCacheTest, TooManyVisibleTilesDrawsStrokesDirectly) {
+  StrokeTileCache cache(&renderer_, 256, /*max_tiles=*/2);
+  cache.SetStroke(1, MakeStroke(), AffineTransform::Identity());
+  SkCanvas canvas(bitmap_);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.TileCount(), 0);
+  EXPECT_EQ(cache.RenderedTileCount(), 0);
+}
+
+TEST_F(StrokeTileCacheTest, EvictsLeastRecentlyDrawnTiles) {
+  StrokeTileCache cache(&renderer_, 256, /*max_tiles=*/4);
+  cache.SetStroke(1, MakeStroke(), AffineTransform::Identity());
+  SkCanvas canvas(bitmap_);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.RenderedTileCount(), 1);
+
+  // Panning away evicts the tile with the stroke, so it is rendered again when
+  // panning back.
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Translate({-1024, 0}), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.TileCount(), 4);
+  EXPECT_EQ(cache.Draw(nullptr, AffineTransform::Identity(), canvas),
+            absl::OkStatus());
+  EXPECT_EQ(cache.RenderedTileCount(), 2);
+}
+
+}  // namespace
+}  // namespace ink
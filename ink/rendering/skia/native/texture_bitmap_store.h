@@ -34,6 +34,13 @@ class TextureBitmapStore {
   // decoding them into bitmap data should be done in advance. The result may be
   // cached by consumers, so this should return a deterministic result for a
   // given input.
+  //
+  // The exception is an `absl::StatusCode::kUnavailable` error, which signals
+  // that the texture is not loaded yet, e.g. because it is being decoded in
+  // the background. Such errors are never cached. `SkiaRenderer` draws the
+  // brush coats using the texture without their textures in the meantime, and
+  // asks again the next time they are drawn. See `AsyncTextureBitmapStore` for
+  // an implementation that loads textures on an `Executor`.
   virtual absl::StatusOr<sk_sp<SkImage>> GetTextureBitmap(
       absl::string_view texture_id) const = 0;
 };
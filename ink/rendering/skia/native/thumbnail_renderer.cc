@@ -0,0 +1,112 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/thumbnail_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/vec.h"
+#include "ink/rendering/skia/native/skia_renderer.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+#include "ink/types/trace.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSurface.h"
+
+namespace ink {
+namespace {
+
+// Returns the largest factor by which `transform` scales lengths, ignoring
+// skew, which is enough to pick a level of detail.
+float MaxScale(const AffineTransform& transform) {
+  return std::max(std::hypot(transform.A(), transform.D()),
+                  std::hypot(transform.B(), transform.E()));
+}
+
+absl::StatusOr<sk_sp<SkImage>> RenderThumbnail(
+    const SkiaRenderer& renderer, const ThumbnailPage& page,
+    const ThumbnailOptions& options) {
+  ScopedTraceEvent trace_event("ink::RenderThumbnail");
+  if (options.max_width <= 0 || options.max_height <= 0) {
+    return absl::InvalidArgumentError(
+        "Thumbnail maximum width and height must be positive");
+  }
+  if (!(page.bounds.Width() > 0 && page.bounds.Height() > 0)) {
+    return absl::InvalidArgumentError("Page bounds must have a positive area");
+  }
+
+  float scale = std::min(options.max_width / page.bounds.Width(),
+                         options.max_height / page.bounds.Height());
+  int width = std::clamp(
+      static_cast<int>(std::lround(page.bounds.Width() * scale)), 1,
+      options.max_width);
+  int height = std::clamp(
+      static_cast<int>(std::lround(page.bounds.Height() * scale)), 1,
+      options.max_height);
+  sk_sp<SkSurface> surface =
+      SkSurfaces::Raster(SkImageInfo::MakeN32Premul(width, height));
+  if (surface == nullptr) {
+    return absl::ResourceExhaustedError(
+        "Failed to allocate the thumbnail pixels");
+  }
+  SkCanvas* canvas = surface->getCanvas();
+  canvas->clear(options.background_color);
+
+  AffineTransform page_to_thumbnail =
+      AffineTransform::Scale(scale) *
+      AffineTransform::Translate(Vec{-page.bounds.XMin(), -page.bounds.YMin()});
+  std::vector<SkiaRenderer::StrokeAndTransform> strokes;
+  strokes.reserve(page.strokes.size());
+  for (const ThumbnailStroke& item : page.strokes) {
+    AffineTransform object_to_canvas = page_to_thumbnail * item.object_to_page;
+    strokes.push_back({.stroke = item.stroke,
+                       .object_to_canvas = object_to_canvas,
+                       .level_of_detail = Stroke::LevelOfDetailForScale(
+                           MaxScale(object_to_canvas))});
+  }
+
+  SkiaRenderer page_renderer = renderer.CreateRendererSharingTextures();
+  page_renderer.SetCpuTriangleRasterizationEnabled(options.rasterize_triangles);
+  absl::Status status = page_renderer.DrawStrokes(nullptr, strokes, *canvas);
+  if (!status.ok()) return status;
+  return surface->makeImageSnapshot();
+}
+
+}  // namespace
+
+std::vector<absl::StatusOr<sk_sp<SkImage>>> RenderThumbnails(
+    const SkiaRenderer& renderer, absl::Span<const ThumbnailPage> pages,
+    const ThumbnailOptions& options, Executor* absl_nullable executor) {
+  ScopedTraceEvent trace_event("ink::RenderThumbnails");
+  std::vector<absl::StatusOr<sk_sp<SkImage>>> thumbnails(
+      pages.size(), absl::UnknownError("Thumbnail was not rendered"));
+  ParallelFor(executor, pages.size(), [&](size_t i) {
+    thumbnails[i] = RenderThumbnail(renderer, pages[i], options);
+  });
+  return thumbnails;
+}
+
+}  // namespace ink
@@ -0,0 +1,82 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SKIA_NATIVE_THUMBNAIL_RENDERER_H_
+#define INK_RENDERING_SKIA_NATIVE_THUMBNAIL_RENDERER_H_
+
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/rect.h"
+#include "ink/rendering/skia/native/skia_renderer.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink {
+
+// A finished stroke on a page, with the transform from its object coordinates
+// to the coordinates of the page.
+struct ThumbnailStroke {
+  const Stroke* absl_nonnull stroke;
+  AffineTransform object_to_page;
+};
+
+// A page of strokes to render a thumbnail of. `bounds` is the area of the page
+// shown in the thumbnail, in page coordinates. Strokes are drawn in order.
+struct ThumbnailPage {
+  absl::Span<const ThumbnailStroke> strokes;
+  Rect bounds;
+};
+
+struct ThumbnailOptions {
+  // Each thumbnail is as large as fits within `max_width` by `max_height`
+  // pixels while keeping the aspect ratio of its page bounds, and at least one
+  // pixel in each dimension.
+  int max_width = 256;
+  int max_height = 256;
+  SkColor background_color = SK_ColorWHITE;
+  // Whether strokes have their mesh triangles rasterized instead of being
+  // drawn as filled paths; see
+  // `SkiaRenderer::SetCpuTriangleRasterizationEnabled()`.
+  bool rasterize_triangles = true;
+};
+
+// Renders a raster thumbnail image of each of `pages`, without a
+// `GrDirectContext`, and returns them in the same order.
+//
+// Each stroke is drawn at the coarsest level of detail that looks the same at
+// the thumbnail's scale, per `Stroke::LevelOfDetailForScale()`, which makes
+// long strokes much cheaper to draw small. Pages are rendered with renderers
+// from `renderer.CreateRendererSharingTextures()`, so brush textures are only
+// fetched and kept once for every page, and in parallel on `executor` if it is
+// non-null. `renderer` and the strokes must not be modified until this
+// returns.
+//
+// The result for a page is an invalid-argument error if its bounds have no
+// area or `options` has a non-positive size, or else the first error from
+// drawing one of its strokes.
+std::vector<absl::StatusOr<sk_sp<SkImage>>> RenderThumbnails(
+    const SkiaRenderer& renderer, absl::Span<const ThumbnailPage> pages,
+    const ThumbnailOptions& options = {},
+    Executor* absl_nullable executor = nullptr);
+
+}  // namespace ink
+
+#endif  // INK_RENDERING_SKIA_NATIVE_THUMBNAIL_RENDERER_H_
@@ -0,0 +1,140 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/skia/native/thumbnail_renderer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/rect.h"
+#include "ink/rendering/skia/native/skia_renderer.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/test_executor.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRefCnt.h"
+
+namespace ink {
+namespace {
+
+// A horizontal red stroke, 20 units wide, from (20, 50) to (180, 50).
+Stroke MakeStroke() {
+  absl::StatusOr<Brush> brush = Brush::Create({}, Color::Red(), 20, 0.1);
+  ABSL_CHECK_OK(brush);
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {20, 50}, .elapsed_time = Duration32::Zero()},
+       {.position = {180, 50}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ABSL_CHECK_OK(inputs);
+  return Stroke(*brush, *inputs);
+}
+
+SkColor GetColor(const sk_sp<SkImage>& image, int x, int y) {
+  SkPixmap pixmap;
+  ABSL_CHECK(image->peekPixels(&pixmap));
+  return pixmap.getColor(x, y);
+}
+
+TEST(ThumbnailRendererTest, FitsPageBoundsInMaxSize) {
+  SkiaRenderer renderer;
+  Stroke stroke = MakeStroke();
+  std::vector<ThumbnailStroke> strokes = {
+      {.stroke = &stroke, .object_to_page = AffineTransform::Identity()}};
+  std::vector<ThumbnailPage> pages = {
+      {.strokes = strokes, .bounds = Rect::FromTwoPoints({0, 0}, {200, 100})}};
+
+  std::vector<absl::StatusOr<sk_sp<SkImage>>> thumbnails =
+      RenderThumbnails(renderer, pages, {.max_width = 100, .max_height = 100});
+
+  ASSERT_EQ(thumbnails.size(), 1u);
+  ASSERT_EQ(thumbnails[0].status(), absl::OkStatus());
+  const sk_sp<SkImage>& image = *thumbnails[0];
+  EXPECT_EQ(image->width(), 100);
+  EXPECT_EQ(image->height(), 50);
+  EXPECT_EQ(GetColor(image, 50, 25), SK_ColorRED);
+  EXPECT_EQ(GetColor(image, 50, 5), SK_ColorWHITE);
+  EXPECT_EQ(GetColor(image, 2, 25), SK_ColorWHITE);
+}
+
+TEST(ThumbnailRendererTest, AppliesObjectToPageTransformAndPageOrigin) {
+  SkiaRenderer renderer;
+  Stroke stroke = MakeStroke();
+  std::vector<ThumbnailStroke> strokes = {
+      {.stroke = &stroke,
+       .object_to_page = AffineTransform::Translate({1000, 1000})}};
+  std::vector<ThumbnailPage> pages = {
+      {.strokes = strokes,
+       .bounds = Rect::FromTwoPoints({1000, 1000}, {1200, 1200})}};
+
+  std::vector<absl::StatusOr<sk_sp<SkImage>>> thumbnails = RenderThumbnails(
+      renderer, pages,
+      {.max_width = 200, .max_height = 200, .rasterize_triangles = false});
+
+  ASSERT_EQ(thumbnails[0].status(), absl::OkStatus());
+  EXPECT_EQ(GetColor(*thumbnails[0], 100, 50), SK_ColorRED);
+  EXPECT_EQ(GetColor(*thumbnails[0], 100, 150), SK_ColorWHITE);
+}
+
+TEST(ThumbnailRendererTest, RendersPagesInParallel) {
+  SkiaRenderer renderer;
+  Stroke stroke = MakeStroke();
+  std::vector<ThumbnailStroke> strokes = {
+      {.stroke = &stroke, .object_to_page = AffineTransform::Identity()}};
+  std::vector<ThumbnailPage> pages(
+      8,
+      {.strokes = strokes, .bounds = Rect::FromTwoPoints({0, 0}, {200, 100})});
+  pages[3].strokes = {};
+  ThreadPerTaskExecutor executor;
+
+  std::vector<absl::StatusOr<sk_sp<SkImage>>> thumbnails = RenderThumbnails(
+      renderer, pages, {.max_width = 64, .max_height = 64}, &executor);
+
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+  ASSERT_EQ(thumbnails.size(), pages.size());
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_EQ(thumbnails[i].status(), absl::OkStatus());
+    EXPECT_EQ(GetColor(*thumbnails[i], 32, 16),
+              i == 3 ? SK_ColorWHITE : SK_ColorRED);
+  }
+}
+
+TEST(ThumbnailRendererTest, ReturnsErrorsPerPage) {
+  SkiaRenderer renderer;
+  std::vector<ThumbnailPage> pages = {
+      {.bounds = Rect::FromTwoPoints({0, 0}, {100, 0})},
+      {.bounds = Rect::FromTwoPoints({0, 0}, {100, 100})}};
+
+  std::vector<absl::StatusOr<sk_sp<SkImage>>> thumbnails =
+      RenderThumbnails(renderer, pages);
+
+  ASSERT_EQ(thumbnails.size(), 2u);
+  EXPECT_EQ(thumbnails[0].status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(thumbnails[1].status(), absl::OkStatus());
+
+  EXPECT_EQ(RenderThumbnails(renderer, pages, {.max_width = 0})[1]
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,193 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/svg/svg_export.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/color/color.h"
+#include "ink/color/color_space.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/cancellation_token.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+namespace {
+
+// Documents rarely use more than a handful of brush colors, but the cache of
+// fill attributes is cleared when it reaches this size, to bound its memory.
+constexpr size_t kMaxCachedFillAttributes = 256;
+
+bool IsIdentity(const AffineTransform& transform) {
+  return transform.A() == 1 && transform.B() == 0 && transform.C() == 0 &&
+         transform.D() == 0 && transform.E() == 1 && transform.F() == 0;
+}
+
+void AppendPoint(Point point, std::string& out) {
+  absl::StrAppend(&out, point.x, " ", point.y);
+}
+
+}  // namespace
+
+SvgStreamWriter::SvgStreamWriter(const SvgExportOptions& options,
+                                 SvgSink sink)
+    : options_(options), sink_(std::move(sink)) {}
+
+absl::Status SvgStreamWriter::AddStroke(
+    const Stroke& stroke, const AffineTransform& stroke_to_document) {
+  if (absl::Status status = WriteHeaderIfNeeded(); !status.ok()) return status;
+  if (finished_) {
+    return absl::FailedPreconditionError(
+        "Cannot add a stroke after `Finish()`.");
+  }
+
+  const PartitionedMesh& shape = stroke.GetShape();
+  const Brush& brush = stroke.GetBrush();
+  absl::Span<const BrushCoat> coats = brush.GetCoats();
+  for (uint32_t coat_index = 0; coat_index < shape.RenderGroupCount();
+       ++coat_index) {
+    uint32_t outline_count = shape.OutlineCount(coat_index);
+    if (outline_count == 0) continue;
+
+    float opacity_multiplier =
+        coat_index < coats.size() ? coats[coat_index].tip.opacity_multiplier
+                                  : 1.f;
+    absl::StrAppend(&buffer_, "<path ",
+                    FillAttributes(brush.GetColor(), opacity_multiplier));
+    if (!IsIdentity(stroke_to_document)) {
+      // SVG's matrix(a b c d e f) maps (x, y) to
+      // (a x + c y + e, b x + d y + f).
+      absl::StrAppend(&buffer_, " transform=\"matrix(", stroke_to_document.A(),
+                      " ", stroke_to_document.D(), " ", stroke_to_document.B(),
+                      " ", stroke_to_document.E(), " ", stroke_to_document.C(),
+                      " ", stroke_to_document.F(), ")\"");
+    }
+    buffer_.append(" d=\"");
+    for (uint32_t outline_index = 0; outline_index < outline_count;
+         ++outline_index) {
+      if (options_.outline_tolerance > 0) {
+        absl::Span<const Point> positions = shape.SimplifiedOutline(
+            coat_index, outline_index, options_.outline_tolerance);
+        for (size_t i = 0; i < positions.size(); ++i) {
+          buffer_.append(i == 0 ? "M" : "L");
+          AppendPoint(positions[i], buffer_);
+        }
+      } else {
+        uint32_t vertex_count =
+            shape.OutlineVertexCount(coat_index, outline_index);
+        for (uint32_t i = 0; i < vertex_count; ++i) {
+          buffer_.append(i == 0 ? "M" : "L");
+          AppendPoint(shape.OutlinePosition(coat_index, outline_index, i),
+                      buffer_);
+        }
+      }
+      buffer_.append("Z");
+    }
+    buffer_.append("\"/>\n");
+  }
+  return Flush();
+}
+
+absl::Status SvgStreamWriter::Finish() {
+  if (absl::Status status = WriteHeaderIfNeeded(); !status.ok()) return status;
+  if (finished_) {
+    return absl::FailedPreconditionError("`Finish()` was already called.");
+  }
+  finished_ = true;
+  buffer_.append("</svg>\n");
+  return Flush();
+}
+
+const std::string& SvgStreamWriter::FillAttributes(const Color& brush_color,
+                                                   float opacity_multiplier) {
+  std::pair<Color, float> key = {brush_color, opacity_multiplier};
+  if (auto it = fill_attributes_.find(key); it != fill_attributes_.end()) {
+    return it->second;
+  }
+  if (fill_attributes_.size() >= kMaxCachedFillAttributes) {
+    fill_attributes_.clear();
+  }
+
+  Color color = options_.color_function(brush_color);
+  Color::RgbaUint8 rgba = color.InColorSpace(ColorSpace::kSrgb)
+                              .AsUint8(Color::Format::kGammaEncoded);
+  std::string attributes =
+      absl::StrFormat("fill=\"#%02x%02x%02x\"", rgba.r, rgba.g, rgba.b);
+  float opacity = color.GetAlphaFloat() * opacity_multiplier;
+  if (opacity < 1) {
+    absl::StrAppend(&attributes, " fill-opacity=\"", opacity, "\"");
+  }
+  return fill_attributes_.try_emplace(key, std::move(attributes))
+      .first->second;
+}
+
+absl::Status SvgStreamWriter::Flush() {
+  if (buffer_.empty()) return absl::OkStatus();
+  status_ = sink_(buffer_);
+  buffer_.clear();
+  return status_;
+}
+
+absl::Status SvgStreamWriter::WriteHeaderIfNeeded() {
+  if (!status_.ok() || wrote_header_) return status_;
+  wrote_header_ = true;
+  const Rect& box = options_.view_box;
+  absl::StrAppend(
+      &buffer_, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"",
+      box.Width(), "\" height=\"", box.Height(), "\" viewBox=\"",
+      box.XMin(), " ", box.YMin(), " ", box.Width(), " ", box.Height(),
+      "\">\n");
+  return Flush();
+}
+
+void ExportSvgAsync(const SvgExportOptions& options,
+                    absl::AnyInvocable<std::optional<Stroke>()> next_stroke,
+                    SvgSink sink, Executor& executor,
+                    CancellationToken cancellation,
+                    absl::AnyInvocable<void(absl::Status)> on_done) {
+  executor.Schedule([writer = SvgStreamWriter(options, std::move(sink)),
+                     next_stroke = std::move(next_stroke),
+                     cancellation = std::move(cancellation),
+                     on_done = std::move(on_done)]() mutable {
+    while (!cancellation.IsCancelled()) {
+      // Each stroke is released before the next one is pulled.
+      std::optional<Stroke> stroke = next_stroke();
+      if (!stroke.has_value()) {
+        std::move(on_done)(writer.Finish());
+        return;
+      }
+      if (absl::Status status = writer.AddStroke(*stroke); !status.ok()) {
+        std::move(on_done)(std::move(status));
+        return;
+      }
+    }
+    std::move(on_done)(absl::CancelledError("The SVG export was cancelled."));
+  });
+}
+
+}  // namespace ink
@@ -0,0 +1,123 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_RENDERING_SVG_SVG_EXPORT_H_
+#define INK_RENDERING_SVG_SVG_EXPORT_H_
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "ink/brush/color_function.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/rect.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/cancellation_token.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+// Receives an exported document in consecutive chunks. Returning an error stops
+// the export, and the error is passed on to the caller.
+using SvgSink = absl::AnyInvocable<absl::Status(absl::string_view chunk)>;
+
+struct SvgExportOptions {
+  // The region of the document, in the coordinates that strokes are written
+  // in, to show. This is written as the `viewBox` of the `<svg>` element, and
+  // its size as the element's `width` and `height`.
+  Rect view_box = Rect::FromTwoPoints({0, 0}, {1, 1});
+  // If greater than zero, each outline is written as
+  // `PartitionedMesh::SimplifiedOutline()` with this tolerance, in stroke
+  // coordinates, rather than with every one of its vertices.
+  float outline_tolerance = 0;
+  // Applied to the color of each brush, e.g. to adjust the colors for print.
+  ColorFunction color_function;
+};
+
+// Writes strokes to an SVG document as they are added, without building the
+// document in memory. Each coat of each stroke is written as a `<path>`
+// element through its outlines, filled with the brush color and the coat's
+// tip opacity, as when the stroke is drawn with `SkPath`s by the Skia
+// renderer. Brush textures are not exported.
+//
+// Memory use does not depend on the number of strokes: the text for each
+// stroke is passed to the sink before the next stroke is added, and the fill
+// attributes are only cached for a bounded number of distinct colors.
+//
+// Once a call fails, every later call returns the same error without writing
+// anything more.
+class SvgStreamWriter {
+ public:
+  SvgStreamWriter(const SvgExportOptions& options, SvgSink sink);
+  SvgStreamWriter(const SvgStreamWriter&) = delete;
+  SvgStreamWriter(SvgStreamWriter&&) = default;
+  SvgStreamWriter& operator=(const SvgStreamWriter&) = delete;
+  SvgStreamWriter& operator=(SvgStreamWriter&&) = default;
+  ~SvgStreamWriter() = default;
+
+  // Writes the paths of `stroke`, whose shape is mapped into the document by
+  // `stroke_to_document`. The opening `<svg>` tag is written before the
+  // first stroke.
+  absl::Status AddStroke(const Stroke& stroke,
+                         const AffineTransform& stroke_to_document = {});
+
+  // Writes the closing `</svg>` tag (and the opening one, if no strokes were
+  // added). Nothing may be added afterwards.
+  absl::Status Finish();
+
+ private:
+  // Returns the `fill` and `fill-opacity` attributes for a coat of a brush
+  // with `brush_color` and `opacity_multiplier`.
+  const std::string& FillAttributes(const Color& brush_color,
+                                    float opacity_multiplier);
+
+  // Passes `buffer_` to the sink and clears it.
+  absl::Status Flush();
+
+  absl::Status WriteHeaderIfNeeded();
+
+  SvgExportOptions options_;
+  SvgSink sink_;
+  absl::Status status_;
+  bool wrote_header_ = false;
+  bool finished_ = false;
+  std::string buffer_;
+  absl::flat_hash_map<std::pair<Color, float>, std::string> fill_attributes_;
+};
+
+// Exports an SVG document in the background, in a single task passed to
+// `executor.Schedule()`, so that exporting a large document doesn't block the
+// calling thread.
+//
+// The task pulls strokes from `next_stroke` until it returns `std::nullopt`,
+// and writes each to `sink` with an `SvgStreamWriter`; since strokes are
+// pulled one at a time, the host application can load them lazily. Each stroke
+// is written in document coordinates. `on_done` is then called exactly once
+// with the result: an error from `sink`, a `kCancelled` error if
+// `cancellation` was cancelled before every stroke was written, or OK. All of
+// the callbacks are called on the executor's thread.
+void ExportSvgAsync(const SvgExportOptions& options,
+                    absl::AnyInvocable<std::optional<Stroke>()> next_stroke,
+                    SvgSink sink, Executor& executor,
+                    CancellationToken cancellation,
+                    absl::AnyInvocable<void(absl::Status)> on_done);
+
+}  // namespace ink
+
+#endif  // INK_RENDERING_SVG_SVG_EXPORT_H_
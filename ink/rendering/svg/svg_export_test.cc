@@ -0,0 +1,201 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/rendering/svg/svg_export.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/color_function.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/rect.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/cancellation_token.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+
+constexpr absl::string_view kHeader =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"10\" height=\"5\" "
+    "viewBox=\"0 0 10 5\">\n";
+
+Stroke MakeStroke(const MutableMesh& mesh, std::vector<uint32_t> outline,
+                  const Color& color = Color::Red()) {
+  absl::StatusOr<Brush> brush = Brush::Create({}, color, 1, 0.1);
+  ABSL_CHECK_OK(brush);
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMutableMesh(mesh, {absl::MakeConstSpan(outline)});
+  ABSL_CHECK_OK(shape);
+  return Stroke(*brush, StrokeInputBatch(), *shape);
+}
+
+// Returns a stroke covering the rectangle from (0, 0) to (2, 1).
+Stroke MakeRectStroke(const Color& color = Color::Red()) {
+  MutableMesh mesh;
+  mesh.AppendVertex({0, 0});
+  mesh.AppendVertex({2, 0});
+  mesh.AppendVertex({2, 1});
+  mesh.AppendVertex({0, 1});
+  mesh.AppendTriangleIndices({0, 1, 2});
+  mesh.AppendTriangleIndices({0, 2, 3});
+  return MakeStroke(mesh, {0, 1, 2, 3}, color);
+}
+
+SvgExportOptions TestOptions() {
+  return {.view_box = Rect::FromTwoPoints({0, 0}, {10, 5})};
+}
+
+// Returns a sink that appends each chunk to `chunks`.
+SvgSink CollectChunks(std::vector<std::string>& chunks) {
+  return [&chunks](absl::string_view chunk) {
+    chunks.emplace_back(chunk);
+    return absl::OkStatus();
+  };
+}
+
+TEST(SvgExportTest, WritesEachStrokeAsItIsAdded) {
+  std::vector<std::string> chunks;
+  SvgStreamWriter writer(TestOptions(), CollectChunks(chunks));
+
+  ASSERT_EQ(writer.AddStroke(MakeRectStroke()), absl::OkStatus());
+  EXPECT_THAT(chunks,
+              ElementsAre(kHeader, "<path fill=\"#ff0000\" "
+                                   "d=\"M0 0L2 0L2 1L0 1Z\"/>\n"));
+
+  ASSERT_EQ(writer.AddStroke(MakeRectStroke(Color::Blue())), absl::OkStatus());
+  ASSERT_EQ(writer.Finish(), absl::OkStatus());
+  EXPECT_THAT(chunks, SizeIs(4));
+  EXPECT_EQ(chunks[2], "<path fill=\"#0000ff\" d=\"M0 0L2 0L2 1L0 1Z\"/>\n");
+  EXPECT_EQ(chunks[3], "</svg>\n");
+}
+
+TEST(SvgExportTest, EmptyDocument) {
+  std::vector<std::string> chunks;
+  SvgStreamWriter writer(TestOptions(), CollectChunks(chunks));
+  ASSERT_EQ(writer.Finish(), absl::OkStatus());
+  EXPECT_THAT(chunks, ElementsAre(kHeader, "</svg>\n"));
+  EXPECT_THAT(writer.Finish(), StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT(writer.AddStroke(MakeRectStroke()),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(SvgExportTest, AppliesColorFunctionAndTransform) {
+  SvgExportOptions options = TestOptions();
+  options.color_function = {ColorFunction::OpacityMultiplier{0.5}};
+  std::vector<std::string> chunks;
+  SvgStreamWriter writer(options, CollectChunks(chunks));
+
+  ASSERT_EQ(writer.AddStroke(MakeRectStroke(),
+                             AffineTransform::Translate({1, 2})),
+            absl::OkStatus());
+  ASSERT_THAT(chunks, SizeIs(2));
+  EXPECT_EQ(chunks[1],
+            "<path fill=\"#ff0000\" fill-opacity=\"0.5\" "
+            "transform=\"matrix(1 0 0 1 1 2)\" d=\"M0 0L2 0L2 1L0 1Z\"/>\n");
+}
+
+TEST(SvgExportTest, WritesSimplifiedOutlines) {
+  SvgExportOptions options = TestOptions();
+  options.outline_tolerance = 0.25;
+  std::vector<std::string> chunks;
+  SvgStreamWriter writer(options, CollectChunks(chunks));
+
+  // The middle vertices of each long edge of the strip are collinear.
+  ASSERT_EQ(writer.AddStroke(MakeStroke(MakeStraightLineMutableMesh(4),
+                                        {0, 2, 4, 5, 3, 1})),
+            absl::OkStatus());
+  ASSERT_THAT(chunks, SizeIs(2));
+  EXPECT_EQ(chunks[1],
+            "<path fill=\"#ff0000\" d=\"M0 0L4 0L5 -1L1 -1Z\"/>\n");
+}
+
+TEST(SvgExportTest, SinkErrorStopsTheExport) {
+  int calls = 0;
+  SvgStreamWriter writer(TestOptions(), [&calls](absl::string_view) {
+    ++calls;
+    return calls < 2 ? absl::OkStatus() : absl::DataLossError("disk full");
+  });
+  EXPECT_THAT(writer.AddStroke(MakeRectStroke()),
+              StatusIs(absl::StatusCode::kDataLoss, "disk full"));
+  EXPECT_THAT(writer.AddStroke(MakeRectStroke()),
+              StatusIs(absl::StatusCode::kDataLoss, "disk full"));
+  EXPECT_THAT(writer.Finish(),
+              StatusIs(absl::StatusCode::kDataLoss, "disk full"));
+  EXPECT_EQ(calls, 2);
+}
+
+// Returns a source of `count` strokes.
+absl::AnyInvocable<std::optional<Stroke>()> StrokeSource(int count) {
+  return [count]() mutable -> std::optional<Stroke> {
+    if (count == 0) return std::nullopt;
+    --count;
+    return MakeRectStroke();
+  };
+}
+
+TEST(SvgExportTest, ExportSvgAsync) {
+  ManualExecutor executor;
+  std::vector<std::string> chunks;
+  std::optional<absl::Status> result;
+  ExportSvgAsync(TestOptions(), StrokeSource(3), CollectChunks(chunks),
+                 executor, CancellationToken(),
+                 [&result](absl::Status status) { result = status; });
+  EXPECT_THAT(chunks, SizeIs(0));
+  EXPECT_EQ(executor.PendingTaskCount(), 1u);
+
+  executor.RunScheduledTasks();
+  ASSERT_EQ(result, absl::OkStatus());
+  EXPECT_THAT(chunks, SizeIs(5));
+}
+
+TEST(SvgExportTest, ExportSvgAsyncCancelled) {
+  ManualExecutor executor;
+  std::vector<std::string> chunks;
+  std::optional<absl::Status> result;
+  CancellationToken cancellation;
+  ExportSvgAsync(TestOptions(), StrokeSource(3), CollectChunks(chunks),
+                 executor, cancellation,
+                 [&result](absl::Status status) { result = status; });
+  cancellation.Cancel();
+
+  executor.RunScheduledTasks();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_THAT(*result, StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_THAT(chunks, SizeIs(0));
+}
+
+}  // namespace
+}  // namespace ink
@@ -39,6 +39,7 @@
 #include "ink/geometry/point.h"
 #include "ink/geometry/vec.h"
 #include "ink/storage/color.h"
+#include "ink/storage/decode_options.h"
 #include "ink/storage/proto/brush.pb.h"
 #include "ink/storage/proto/brush_family.pb.h"
 #include "ink/storage/proto/stroke_input_batch.pb.h"
@@ -973,19 +974,6 @@ void EncodeBrushBehavior(const BrushBehavior& behavior,
   }
 }
 
-absl::StatusOr<BrushBehavior> DecodeBrushBehavior(
-    const proto::BrushBehavior& behavior_proto) {
-  std::vector<BrushBehavior::Node> nodes;
-  nodes.reserve(behavior_proto.nodes_size());
-  for (const proto::BrushBehavior::Node& node_proto : behavior_proto.nodes()) {
-    absl::StatusOr<BrushBehavior::Node> node =
-        DecodeBrushBehaviorNode(node_proto);
-    if (!node.ok()) return node.status();
-    nodes.push_back(*std::move(node));
-  }
-  return BrushBehavior{.nodes = std::move(nodes)};
-}
-
 proto::BrushPaint::TextureLayer::Mapping EncodeBrushPaintTextureMapping(
     BrushPaint::TextureMapping mapping) {
   switch (mapping) {
@@ -1182,9 +1170,10 @@ void EncodeBrushPaintTextureLayer(
   layer_proto_out.set_blend_mode(EncodeBrushPaintBlendMode(layer.blend_mode));
 }
 
+// Decodes a texture layer, validating it only if `validate_layer` is true.
 absl::StatusOr<BrushPaint::TextureLayer> DecodeBrushPaintTextureLayer(
     const proto::BrushPaint::TextureLayer& layer_proto,
-    ClientTextureIdProvider get_client_texture_id) {
+    ClientTextureIdProvider get_client_texture_id, bool validate_layer) {
   auto mapping = DecodeBrushPaintTextureMapping(layer_proto.mapping());
   if (!mapping.ok()) {
     return mapping.status();
@@ -1227,10 +1216,12 @@ absl::StatusOr<BrushPaint::TextureLayer> DecodeBrushPaintTextureLayer(
       .rotation = Angle::Radians(layer_proto.rotation_in_radians()),
       .opacity = layer_proto.opacity(),
       .blend_mode = *blend_mode};
-  if (absl::Status status =
-          brush_internal::ValidateBrushPaintTextureLayer(texture_layer);
-      !status.ok()) {
-    return status;
+  if (validate_layer) {
+    if (absl::Status status =
+            brush_internal::ValidateBrushPaintTextureLayer(texture_layer);
+        !status.ok()) {
+      return status;
+    }
   }
   return std::move(texture_layer);
 }
@@ -1248,6 +1239,13 @@ void EncodeBrushFamilyInputModel(
       .mutable_experimental_raw_position_model();  // no fields to set
 }
 
+void EncodeBrushFamilyInputModel(
+    const BrushFamily::ExperimentalAdaptiveSamplingModel& model,
+    proto::BrushFamily::InputModel& model_proto_out) {
+  model_proto_out
+      .mutable_experimental_adaptive_sampling_model();  // no fields to set
+}
+
 void EncodeBrushFamilyInputModel(
     const BrushFamily::InputModel& input_model,
     proto::BrushFamily::InputModel& model_proto_out) {
@@ -1265,6 +1263,8 @@ absl::StatusOr<BrushFamily::InputModel> DecodeBrushFamilyInputModel(
       return BrushFamily::SpringModel{};
     case proto::BrushFamily::InputModel::kExperimentalRawPositionModel:
       return BrushFamily::ExperimentalRawPositionModel{};
+    case proto::BrushFamily::InputModel::kExperimentalAdaptiveSamplingModel:
+      return BrushFamily::ExperimentalAdaptiveSamplingModel{};
     case proto::BrushFamily::InputModel::INPUT_MODEL_NOT_SET:
       break;
   }
@@ -1332,6 +1332,26 @@ absl::StatusOr<BrushBehavior::Node> DecodeBrushBehaviorNode(
   return *node;
 }
 
+namespace {
+
+// Decodes a behavior, validating each of its nodes only if `validate_nodes` is
+// true. The node list as a whole is validated by `ValidateBrushTip()`.
+absl::StatusOr<BrushBehavior> DecodeBrushBehavior(
+    const proto::BrushBehavior& behavior_proto, bool validate_nodes) {
+  std::vector<BrushBehavior::Node> nodes;
+  nodes.reserve(behavior_proto.nodes_size());
+  for (const proto::BrushBehavior::Node& node_proto : behavior_proto.nodes()) {
+    absl::StatusOr<BrushBehavior::Node> node =
+        validate_nodes ? DecodeBrushBehaviorNode(node_proto)
+                       : DecodeBrushBehaviorNodeUnvalidated(node_proto);
+    if (!node.ok()) return node.status();
+    nodes.push_back(*std::move(node));
+  }
+  return BrushBehavior{.nodes = std::move(nodes)};
+}
+
+}  // namespace
+
 void EncodeBrushPaint(const BrushPaint& paint,
                       proto::BrushPaint& paint_proto_out) {
   paint_proto_out.mutable_texture_layers()->Clear();
@@ -1342,28 +1362,43 @@ void EncodeBrushPaint(const BrushPaint& paint,
   }
 }
 
+namespace {
+
+// Decodes a paint, validating it only if `validate_paint` is true.
 absl::StatusOr<BrushPaint> DecodeBrushPaint(
     const proto::BrushPaint& paint_proto,
-    ClientTextureIdProvider get_client_texture_id) {
+    ClientTextureIdProvider get_client_texture_id, bool validate_paint) {
   std::vector<BrushPaint::TextureLayer> layers;
   layers.reserve(paint_proto.texture_layers_size());
   for (const proto::BrushPaint::TextureLayer& layer_proto :
        paint_proto.texture_layers()) {
     absl::StatusOr<BrushPaint::TextureLayer> layer =
-        DecodeBrushPaintTextureLayer(layer_proto, get_client_texture_id);
+        DecodeBrushPaintTextureLayer(layer_proto, get_client_texture_id,
+                                     validate_paint);
     if (!layer.ok()) {
       return layer.status();
     }
     layers.push_back(*std::move(layer));
   }
   BrushPaint paint{.texture_layers = std::move(layers)};
-  if (absl::Status status = brush_internal::ValidateBrushPaintTopLevel(paint);
-      !status.ok()) {
-    return status;
+  if (validate_paint) {
+    if (absl::Status status = brush_internal::ValidateBrushPaintTopLevel(paint);
+        !status.ok()) {
+      return status;
+    }
   }
   return std::move(paint);
 }
 
+}  // namespace
+
+absl::StatusOr<BrushPaint> DecodeBrushPaint(
+    const proto::BrushPaint& paint_proto,
+    ClientTextureIdProvider get_client_texture_id) {
+  return DecodeBrushPaint(paint_proto, get_client_texture_id,
+                          /*validate_paint=*/true);
+}
+
 void EncodeBrushTip(const BrushTip& tip, proto::BrushTip& tip_proto_out) {
   tip_proto_out.set_scale_x(tip.scale.x);
   tip_proto_out.set_scale_y(tip.scale.y);
@@ -1384,12 +1419,16 @@ void EncodeBrushTip(const BrushTip& tip, proto::BrushTip& tip_proto_out) {
   }
 }
 
-absl::StatusOr<BrushTip> DecodeBrushTip(const proto::BrushTip& tip_proto) {
+namespace {
+
+// Decodes a tip, validating it only if `validate_tip` is true.
+absl::StatusOr<BrushTip> DecodeBrushTip(const proto::BrushTip& tip_proto,
+                                        bool validate_tip) {
   std::vector<BrushBehavior> behaviors;
   behaviors.reserve(tip_proto.behaviors_size());
   for (const proto::BrushBehavior& behavior_proto : tip_proto.behaviors()) {
     absl::StatusOr<BrushBehavior> behavior =
-        DecodeBrushBehavior(behavior_proto);
+        DecodeBrushBehavior(behavior_proto, validate_tip);
     if (!behavior.ok()) {
       return behavior.status();
     }
@@ -1424,27 +1463,39 @@ absl::StatusOr<BrushTip> DecodeBrushTip(const proto::BrushTip& tip_proto) {
     tip.particle_gap_duration =
         Duration32::Seconds(tip_proto.particle_gap_duration_seconds());
   }
-  if (absl::Status status = brush_internal::ValidateBrushTip(tip);
-      !status.ok()) {
-    return status;
+  if (validate_tip) {
+    if (absl::Status status = brush_internal::ValidateBrushTip(tip);
+        !status.ok()) {
+      return status;
+    }
   }
   return tip;
 }
 
+}  // namespace
+
+absl::StatusOr<BrushTip> DecodeBrushTip(const proto::BrushTip& tip_proto) {
+  return DecodeBrushTip(tip_proto, /*validate_tip=*/true);
+}
+
 void EncodeBrushCoat(const BrushCoat& coat, proto::BrushCoat& coat_proto_out) {
   EncodeBrushTip(coat.tip, *coat_proto_out.mutable_tip());
   EncodeBrushPaint(coat.paint, *coat_proto_out.mutable_paint());
 }
 
+namespace {
+
+// Decodes a coat, validating it only if `validate_coat` is true.
 absl::StatusOr<BrushCoat> DecodeBrushCoat(
     const proto::BrushCoat& coat_proto,
-    ClientTextureIdProvider get_client_texture_id) {
-  absl::StatusOr<BrushTip> tip = DecodeBrushTip(coat_proto.tip());
+    ClientTextureIdProvider get_client_texture_id, bool validate_coat) {
+  absl::StatusOr<BrushTip> tip =
+      DecodeBrushTip(coat_proto.tip(), validate_coat);
   if (!tip.ok()) {
     return tip.status();
   }
-  absl::StatusOr<BrushPaint> paint =
-      DecodeBrushPaint(coat_proto.paint(), get_client_texture_id);
+  absl::StatusOr<BrushPaint> paint = DecodeBrushPaint(
+      coat_proto.paint(), get_client_texture_id, validate_coat);
   if (!paint.ok()) {
     return paint.status();
   }
@@ -1453,6 +1504,15 @@ absl::StatusOr<BrushCoat> DecodeBrushCoat(
   return BrushCoat{.tip = *std::move(tip), .paint = *std::move(paint)};
 }
 
+}  // namespace
+
+absl::StatusOr<BrushCoat> DecodeBrushCoat(
+    const proto::BrushCoat& coat_proto,
+    ClientTextureIdProvider get_client_texture_id) {
+  return DecodeBrushCoat(coat_proto, get_client_texture_id,
+                         /*validate_coat=*/true);
+}
+
 void EncodeBrushFamilyTextureMap(
     const BrushFamily& family,
     ::google::protobuf::Map<std::string, std::string>& texture_id_to_bitmap_out,
@@ -1480,6 +1540,14 @@ void EncodeBrushFamilyTextureMap(
 void EncodeBrushFamily(const BrushFamily& family,
                        proto::BrushFamily& family_proto_out,
                        TextureBitmapProvider get_bitmap) {
+  EncodeBrushFamily(family, family_proto_out, std::move(get_bitmap),
+                    BrushEncodingOptions());
+}
+
+void EncodeBrushFamily(const BrushFamily& family,
+                       proto::BrushFamily& family_proto_out,
+                       TextureBitmapProvider get_bitmap,
+                       const BrushEncodingOptions& options) {
   family_proto_out.Clear();
   EncodeBrushFamilyTextureMap(
       family, *family_proto_out.mutable_texture_id_to_bitmap(), get_bitmap);
@@ -1498,17 +1566,22 @@ void EncodeBrushFamily(const BrushFamily& family,
 
   EncodeBrushFamilyInputModel(family.GetInputModel(),
                               *family_proto_out.mutable_input_model());
+
+  if (options.record_validation) {
+    family_proto_out.mutable_validation_record()->set_validation_version(
+        BrushFamily::kValidationVersion);
+  }
 }
 
 absl::StatusOr<std::vector<BrushCoat>> DecodeBrushFamilyCoats(
     const proto::BrushFamily& family_proto,
-    ClientTextureIdProvider get_client_texture_id) {
+    ClientTextureIdProvider get_client_texture_id, bool validate_coats) {
   std::vector<BrushCoat> coats;
 
   coats.reserve(family_proto.coats_size());
   for (const proto::BrushCoat& coat_proto : family_proto.coats()) {
     absl::StatusOr<BrushCoat> coat =
-        DecodeBrushCoat(coat_proto, get_client_texture_id);
+        DecodeBrushCoat(coat_proto, get_client_texture_id, validate_coats);
     if (!coat.ok()) {
       return coat.status();
     }
@@ -1520,6 +1593,14 @@ absl::StatusOr<std::vector<BrushCoat>> DecodeBrushFamilyCoats(
 absl::StatusOr<BrushFamily> DecodeBrushFamily(
     const proto::BrushFamily& family_proto,
     ClientTextureIdProviderAndBitmapReceiver get_client_texture_id) {
+  return DecodeBrushFamily(family_proto, std::move(get_client_texture_id),
+                           DecodeOptions());
+}
+
+absl::StatusOr<BrushFamily> DecodeBrushFamily(
+    const proto::BrushFamily& family_proto,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id,
+    const DecodeOptions& options) {
   // ID map that also serves as a record of the IDs for which we've already
   // called `get_client_texture_id`.
   std::map<std::string, std::string> old_to_new_id = {};
@@ -1546,8 +1627,11 @@ absl::StatusOr<BrushFamily> DecodeBrushFamily(
     return *new_id;
   };
 
-  absl::StatusOr<std::vector<BrushCoat>> coats =
-      DecodeBrushFamilyCoats(family_proto, texture_callback);
+  // `BrushFamily::Create()` below validates every coat, so for trusted input
+  // there's no need to also validate each part of each coat as it's decoded.
+  absl::StatusOr<std::vector<BrushCoat>> coats = DecodeBrushFamilyCoats(
+      family_proto, texture_callback,
+      /*validate_coats=*/!options.trusted_input);
   if (!coats.ok()) {
     return coats.status();
   }
@@ -1559,6 +1643,13 @@ absl::StatusOr<BrushFamily> DecodeBrushFamily(
   if (!input_model.ok()) {
     return input_model.status();
   }
+  if (options.trusted_input && family_proto.has_validation_record() &&
+      family_proto.validation_record().validation_version() ==
+          BrushFamily::kValidationVersion) {
+    return BrushFamily::CreatePreviouslyValidated(
+        absl::MakeConstSpan(*coats), family_proto.client_brush_family_id(),
+        *input_model);
+  }
   // BrushFamily::Create() validates the BrushFamily.
   return BrushFamily::Create(absl::MakeConstSpan(*coats),
                              family_proto.client_brush_family_id(),
@@ -1567,11 +1658,18 @@ absl::StatusOr<BrushFamily> DecodeBrushFamily(
 
 void EncodeBrush(const Brush& brush, proto::Brush& brush_proto_out,
                  TextureBitmapProvider get_bitmap) {
+  EncodeBrush(brush, brush_proto_out, std::move(get_bitmap),
+              BrushEncodingOptions());
+}
+
+void EncodeBrush(const Brush& brush, proto::Brush& brush_proto_out,
+                 TextureBitmapProvider get_bitmap,
+                 const BrushEncodingOptions& options) {
   EncodeColor(brush.GetColor(), *brush_proto_out.mutable_color());
   brush_proto_out.set_size_stroke_space(brush.GetSize());
   brush_proto_out.set_epsilon_stroke_space(brush.GetEpsilon());
   EncodeBrushFamily(brush.GetFamily(), *brush_proto_out.mutable_brush_family(),
-                    get_bitmap);
+                    std::move(get_bitmap), options);
 }
 
 absl::StatusOr<Brush> DecodeBrush(
@@ -26,6 +26,7 @@
 #include "ink/brush/brush_family.h"
 #include "ink/brush/brush_paint.h"
 #include "ink/brush/brush_tip.h"
+#include "ink/storage/decode_options.h"
 #include "ink/storage/proto/brush.pb.h"
 #include "ink/storage/proto/brush_family.pb.h"
 
@@ -63,6 +64,25 @@ void EncodeBrushFamily(
     TextureBitmapProvider get_bitmap = [](const std::string& id) {
       return std::nullopt;
     });
+
+// Options for the overloads of `EncodeBrush()` and `EncodeBrushFamily()` below.
+struct BrushEncodingOptions {
+  // Whether to record in `proto::BrushFamily.validation_record` that the family
+  // was validated, as every `BrushFamily` is, so that decoding the proto with
+  // `DecodeOptions::trusted_input` can skip validating it again.
+  bool record_validation = false;
+};
+
+// Same as `EncodeBrush()` and `EncodeBrushFamily()` above, except that the
+// family is encoded according to `options`.
+void EncodeBrush(const Brush& brush, proto::Brush& brush_proto_out,
+                 TextureBitmapProvider get_bitmap,
+                 const BrushEncodingOptions& options);
+void EncodeBrushFamily(const BrushFamily& family,
+                       proto::BrushFamily& family_proto_out,
+                       TextureBitmapProvider get_bitmap,
+                       const BrushEncodingOptions& options);
+
 void EncodeBrushFamilyTextureMap(
     const BrushFamily& family,
     google::protobuf::Map<std::string, std::string>& texture_id_to_bitmap_out,
@@ -88,6 +108,16 @@ absl::StatusOr<BrushFamily> DecodeBrushFamily(
         [](const std::string& encoded_id, const std::string& bitmap) {
           return encoded_id;
         });
+// Same as `DecodeBrushFamily()` above. If `options.trusted_input` is true, the
+// individual tips, paints, and behavior nodes aren't validated as they are
+// decoded, and the family is only validated once, by `BrushFamily::Create()`.
+// If the proto also has a `validation_record` whose version matches
+// `BrushFamily::kValidationVersion`, that validation is skipped too, and the
+// family is created with `BrushFamily::CreatePreviouslyValidated()`.
+absl::StatusOr<BrushFamily> DecodeBrushFamily(
+    const proto::BrushFamily& family_proto,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id,
+    const DecodeOptions& options);
 absl::StatusOr<BrushCoat> DecodeBrushCoat(
     const proto::BrushCoat& coat_proto,
     ClientTextureIdProvider get_client_texture_id =
@@ -0,0 +1,182 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/storage/brush_family_decode_cache.h"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/attributes.h"
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_family.h"
+#include "ink/storage/brush.h"
+#include "ink/storage/color.h"
+#include "ink/storage/proto/brush.pb.h"
+#include "ink/storage/proto/brush_family.pb.h"
+#include "ink/types/memory_trim.h"
+
+namespace ink {
+namespace {
+
+ABSL_CONST_INIT absl::Mutex process_cache_mutex(absl::kConstInit);
+
+std::shared_ptr<BrushFamilyDecodeCache>& ProcessCache()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(process_cache_mutex) {
+  // Intentionally leaked to avoid destruction order issues at exit.
+  static auto* cache = new std::shared_ptr<BrushFamilyDecodeCache>();
+  return *cache;
+}
+
+// Registers the process-wide cache to be cleared by `TrimMemory()`, the first
+// time this is called. This must not be called while holding
+// `process_cache_mutex`, which the trim callback acquires.
+void RegisterProcessCacheForTrim() {
+  // Intentionally leaked, so that the callback stays registered until exit.
+  [[maybe_unused]] static auto* registration =
+      new MemoryTrimRegistration(RegisterMemoryTrimCallback(
+          MemoryTrimLevel::kCaches, []() -> size_t {
+            std::shared_ptr<BrushFamilyDecodeCache> cache =
+                BrushFamilyDecodeCache::GetProcessCache();
+            if (cache == nullptr) return 0;
+            size_t bytes = cache->ApproximateBytes();
+            cache->Clear();
+            return bytes;
+          }));
+}
+
+}  // namespace
+
+std::shared_ptr<BrushFamilyDecodeCache>
+BrushFamilyDecodeCache::GetProcessCache() {
+  absl::MutexLock lock(&process_cache_mutex);
+  return ProcessCache();
+}
+
+void BrushFamilyDecodeCache::SetProcessCache(
+    std::shared_ptr<BrushFamilyDecodeCache> cache) {
+  RegisterProcessCacheForTrim();
+  absl::MutexLock lock(&process_cache_mutex);
+  ProcessCache() = std::move(cache);
+}
+
+absl::StatusOr<BrushFamily> BrushFamilyDecodeCache::DecodeBrushFamily(
+    const proto::BrushFamily& family_proto,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id) {
+  std::string serialized_family = family_proto.SerializeAsString();
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = entries_by_key_.find(serialized_family);
+        it != entries_by_key_.end()) {
+      // Move the entry to the front of the list. This does not invalidate any
+      // iterators, or the keys that point into the entries.
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->family;
+    }
+  }
+
+  // Decode without holding the lock, so that concurrent misses don't wait on
+  // each other. If two threads decode the same family at once, the second one
+  // to finish finds the first one's entry below and leaves it in place.
+  bool called_texture_callback = false;
+  absl::StatusOr<BrushFamily> family = ink::DecodeBrushFamily(
+      family_proto,
+      [&called_texture_callback, &get_client_texture_id](
+          const std::string& encoded_id,
+          const std::string& bitmap) -> absl::StatusOr<std::string> {
+        called_texture_callback = true;
+        return get_client_texture_id(encoded_id, bitmap);
+      });
+  if (!family.ok() || called_texture_callback) return family;
+
+  absl::MutexLock lock(&mutex_);
+  if (max_entries_ == 0 || entries_by_key_.contains(serialized_family)) {
+    return family;
+  }
+  EvictToFit(max_entries_ - 1);
+  entries_.push_front(Entry{.serialized_family = std::move(serialized_family),
+                            .family = *family});
+  entries_by_key_.emplace(entries_.front().serialized_family,
+                          entries_.begin());
+  return family;
+}
+
+absl::StatusOr<Brush> BrushFamilyDecodeCache::DecodeBrush(
+    const proto::Brush& brush_proto,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id) {
+  absl::StatusOr<BrushFamily> brush_family =
+      DecodeBrushFamily(brush_proto.brush_family(), get_client_texture_id);
+  if (!brush_family.ok()) {
+    return brush_family.status();
+  }
+  // Brush::Create() validates the brush.
+  return Brush::Create(
+      *std::move(brush_family), DecodeColor(brush_proto.color()),
+      brush_proto.size_stroke_space(), brush_proto.epsilon_stroke_space());
+}
+
+bool BrushFamilyDecodeCache::Contains(
+    const proto::BrushFamily& family_proto) const {
+  std::string serialized_family = family_proto.SerializeAsString();
+  absl::MutexLock lock(&mutex_);
+  return entries_by_key_.contains(serialized_family);
+}
+
+void BrushFamilyDecodeCache::SetMaxEntries(size_t max_entries) {
+  absl::MutexLock lock(&mutex_);
+  max_entries_ = max_entries;
+  EvictToFit(max_entries_);
+}
+
+size_t BrushFamilyDecodeCache::MaxEntries() const {
+  absl::MutexLock lock(&mutex_);
+  return max_entries_;
+}
+
+size_t BrushFamilyDecodeCache::EntryCount() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+size_t BrushFamilyDecodeCache::ApproximateBytes() const {
+  absl::MutexLock lock(&mutex_);
+  size_t bytes = 0;
+  for (const Entry& entry : entries_) {
+    bytes += sizeof(Entry) + entry.serialized_family.capacity();
+  }
+  return bytes;
+}
+
+void BrushFamilyDecodeCache::Clear() {
+  absl::MutexLock lock(&mutex_);
+  entries_by_key_.clear();
+  entries_.clear();
+}
+
+void BrushFamilyDecodeCache::EvictToFit(size_t max_entries) {
+  while (entries_.size() > max_entries) {
+    EntryList::iterator last = std::prev(entries_.end());
+    entries_by_key_.erase(last->serialized_family);
+    entries_.erase(last);
+  }
+}
+
+}  // namespace ink
@@ -0,0 +1,132 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_STORAGE_BRUSH_FAMILY_DECODE_CACHE_H_
+#define INK_STORAGE_BRUSH_FAMILY_DECODE_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_family.h"
+#include "ink/storage/brush.h"
+#include "ink/storage/proto/brush.pb.h"
+#include "ink/storage/proto/brush_family.pb.h"
+
+namespace ink {
+
+// A bounded cache of decoded brush families, keyed on the serialized bytes of
+// their `proto::BrushFamily`.
+//
+// The same serialized brush is often decoded many times, for example when
+// pasting from the clipboard, when receiving brushes over IPC, or when loading
+// older files that store a full brush with every stroke. Decoding validates the
+// whole family, including every behavior graph, so a cache hit skips most of
+// the work of `DecodeBrushFamily()`.
+//
+// Only families whose decoding never called the `get_client_texture_id`
+// callback are cached, i.e. those without any texture layers. Decoding the
+// same bytes again would not call it either, so returning a cached family is
+// indistinguishable from decoding it, even for callbacks with side effects.
+// Decoding errors are not cached.
+//
+// The cache holds at most `MaxEntries()` families, evicting the least recently
+// used ones as needed.
+//
+// This type is thread-safe.
+class BrushFamilyDecodeCache {
+ public:
+  explicit BrushFamilyDecodeCache(size_t max_entries)
+      : max_entries_(max_entries) {}
+  BrushFamilyDecodeCache(const BrushFamilyDecodeCache&) = delete;
+  BrushFamilyDecodeCache& operator=(const BrushFamilyDecodeCache&) = delete;
+  ~BrushFamilyDecodeCache() = default;
+
+  // Returns the process-wide cache used by the serialization JNI bindings, or
+  // null if none has been installed, which is the default.
+  static std::shared_ptr<BrushFamilyDecodeCache> GetProcessCache();
+
+  // Installs `cache` as the process-wide cache, replacing any previous one.
+  // Passing null disables caching. The process-wide cache is cleared by
+  // `TrimMemory()` with `MemoryTrimLevel::kCaches` or higher.
+  static void SetProcessCache(std::shared_ptr<BrushFamilyDecodeCache> cache);
+
+  // Equivalent to `ink::DecodeBrushFamily()`, but returns a copy of the cached
+  // family if `family_proto` has been decoded before.
+  absl::StatusOr<BrushFamily> DecodeBrushFamily(
+      const proto::BrushFamily& family_proto,
+      ClientTextureIdProviderAndBitmapReceiver get_client_texture_id =
+          [](const std::string& encoded_id, const std::string& bitmap) {
+            return encoded_id;
+          });
+
+  // Equivalent to `ink::DecodeBrush()`, but decodes the brush family through
+  // this cache.
+  absl::StatusOr<Brush> DecodeBrush(
+      const proto::Brush& brush_proto,
+      ClientTextureIdProviderAndBitmapReceiver get_client_texture_id =
+          [](const std::string& encoded_id, const std::string& bitmap) {
+            return encoded_id;
+          });
+
+  // Returns true if the family encoded by `family_proto` is in the cache. This
+  // does not count as a use of the entry.
+  bool Contains(const proto::BrushFamily& family_proto) const;
+
+  // Sets the maximum number of cached families, evicting the least recently
+  // used entries if needed.
+  void SetMaxEntries(size_t max_entries);
+  size_t MaxEntries() const;
+
+  // Returns the number of families currently in the cache.
+  size_t EntryCount() const;
+
+  // Returns an estimate of the number of bytes held by the cached entries. This
+  // counts the serialized key and the inline size of each entry, but not the
+  // memory owned by the decoded families.
+  size_t ApproximateBytes() const;
+
+  // Removes all entries.
+  void Clear();
+
+ private:
+  struct Entry {
+    std::string serialized_family;
+    BrushFamily family;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  void EvictToFit(size_t max_entries) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  size_t max_entries_ ABSL_GUARDED_BY(mutex_);
+  // Entries ordered from most to least recently used.
+  EntryList entries_ ABSL_GUARDED_BY(mutex_);
+  // Maps the serialized family of each entry, which it owns, to the entry.
+  absl::flat_hash_map<absl::string_view, EntryList::iterator> entries_by_key_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace ink
+
+#endif  // INK_STORAGE_BRUSH_FAMILY_DECODE_CACHE_H_
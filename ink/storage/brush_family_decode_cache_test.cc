@@ -0,0 +1,234 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/storage/brush_family_decode_cache.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_behavior.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/brush/type_matchers.h"
+#include "ink/storage/brush.h"
+#include "ink/storage/proto/brush.pb.h"
+#include "ink/storage/proto/brush_family.pb.h"
+#include "ink/types/memory_trim.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+proto::BrushFamily EncodeFamily(const BrushTip& tip,
+                                const BrushPaint& paint = {}) {
+  absl::StatusOr<BrushFamily> family =
+      BrushFamily::Create(tip, paint, "//test/brush-family:cached");
+  ABSL_CHECK_OK(family);
+  proto::BrushFamily family_proto;
+  EncodeBrushFamily(*family, family_proto);
+  return family_proto;
+}
+
+proto::BrushFamily EncodeFamilyWithBehavior(float corner_rounding) {
+  return EncodeFamily(
+      {.corner_rounding = corner_rounding,
+       .behaviors = {BrushBehavior{{
+           BrushBehavior::SourceNode{
+               .source = BrushBehavior::Source::kNormalizedPressure,
+               .source_value_range = {0, 1},
+           },
+           BrushBehavior::TargetNode{
+               .target = BrushBehavior::Target::kSizeMultiplier,
+               .target_modifier_range = {0.5, 1.5},
+           },
+       }}}});
+}
+
+TEST(BrushFamilyDecodeCacheTest, DecodeMatchesUncachedDecode) {
+  BrushFamilyDecodeCache cache(10);
+  proto::BrushFamily family_proto = EncodeFamilyWithBehavior(0.5);
+  absl::StatusOr<BrushFamily> expected = DecodeBrushFamily(family_proto);
+  ASSERT_THAT(expected, IsOk());
+
+  absl::StatusOr<BrushFamily> first = cache.DecodeBrushFamily(family_proto);
+  ASSERT_THAT(first, IsOk());
+  EXPECT_THAT(*first, BrushFamilyEq(*expected));
+  EXPECT_TRUE(cache.Contains(family_proto));
+
+  absl::StatusOr<BrushFamily> second = cache.DecodeBrushFamily(family_proto);
+  ASSERT_THAT(second, IsOk());
+  EXPECT_THAT(*second, BrushFamilyEq(*expected));
+  EXPECT_EQ(cache.EntryCount(), 1u);
+}
+
+TEST(BrushFamilyDecodeCacheTest, DistinctFamiliesGetDistinctEntries) {
+  BrushFamilyDecodeCache cache(10);
+  proto::BrushFamily family_proto_a = EncodeFamilyWithBehavior(0);
+  proto::BrushFamily family_proto_b = EncodeFamilyWithBehavior(1);
+
+  absl::StatusOr<BrushFamily> family_a =
+      cache.DecodeBrushFamily(family_proto_a);
+  ASSERT_THAT(family_a, IsOk());
+  absl::StatusOr<BrushFamily> family_b =
+      cache.DecodeBrushFamily(family_proto_b);
+  ASSERT_THAT(family_b, IsOk());
+
+  EXPECT_EQ(cache.EntryCount(), 2u);
+  EXPECT_EQ(family_a->GetCoats()[0].tip.corner_rounding, 0);
+  EXPECT_EQ(family_b->GetCoats()[0].tip.corner_rounding, 1);
+}
+
+TEST(BrushFamilyDecodeCacheTest, EvictsLeastRecentlyUsedEntries) {
+  BrushFamilyDecodeCache cache(2);
+  proto::BrushFamily family_proto_a = EncodeFamilyWithBehavior(0);
+  proto::BrushFamily family_proto_b = EncodeFamilyWithBehavior(0.5);
+  proto::BrushFamily family_proto_c = EncodeFamilyWithBehavior(1);
+
+  ASSERT_THAT(cache.DecodeBrushFamily(family_proto_a), IsOk());
+  ASSERT_THAT(cache.DecodeBrushFamily(family_proto_b), IsOk());
+  // Using `a` again makes `b` the least recently used entry.
+  ASSERT_THAT(cache.DecodeBrushFamily(family_proto_a), IsOk());
+  ASSERT_THAT(cache.DecodeBrushFamily(family_proto_c), IsOk());
+
+  EXPECT_EQ(cache.EntryCount(), 2u);
+  EXPECT_TRUE(cache.Contains(family_proto_a));
+  EXPECT_FALSE(cache.Contains(family_proto_b));
+  EXPECT_TRUE(cache.Contains(family_proto_c));
+
+  cache.SetMaxEntries(1);
+  EXPECT_EQ(cache.MaxEntries(), 1u);
+  EXPECT_EQ(cache.EntryCount(), 1u);
+  EXPECT_TRUE(cache.Contains(family_proto_c));
+}
+
+TEST(BrushFamilyDecodeCacheTest, ZeroMaxEntriesCachesNothing) {
+  BrushFamilyDecodeCache cache(0);
+  EXPECT_THAT(cache.DecodeBrushFamily(EncodeFamilyWithBehavior(0)), IsOk());
+  EXPECT_EQ(cache.EntryCount(), 0u);
+}
+
+TEST(BrushFamilyDecodeCacheTest, FamiliesWithTexturesAreNotCached) {
+  BrushFamilyDecodeCache cache(10);
+  proto::BrushFamily family_proto = EncodeFamily(
+      {}, {.texture_layers = {{.client_texture_id = "old-texture",
+                               .mapping = BrushPaint::TextureMapping::kTiling,
+                               .size = {1, 1}}}});
+  int callback_count = 0;
+  ClientTextureIdProviderAndBitmapReceiver get_client_texture_id =
+      [&callback_count](const std::string& encoded_id,
+                        const std::string& bitmap) {
+        ++callback_count;
+        return "new-texture";
+      };
+
+  for (int i = 0; i < 2; ++i) {
+    absl::StatusOr<BrushFamily> family =
+        cache.DecodeBrushFamily(family_proto, get_client_texture_id);
+    ASSERT_THAT(family, IsOk());
+    EXPECT_EQ(family->GetCoats()[0].paint.texture_layers[0].client_texture_id,
+              "new-texture");
+  }
+  // The callback must see every decode, so nothing can be cached.
+  EXPECT_EQ(callback_count, 2);
+  EXPECT_EQ(cache.EntryCount(), 0u);
+}
+
+TEST(BrushFamilyDecodeCacheTest, DecodeErrorsAreNotCached) {
+  BrushFamilyDecodeCache cache(10);
+  proto::BrushFamily family_proto = EncodeFamilyWithBehavior(0);
+  family_proto.mutable_coats(0)->mutable_tip()->set_corner_rounding(2);
+
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_THAT(cache.DecodeBrushFamily(family_proto),
+                StatusIs(absl::StatusCode::kInvalidArgument,
+                         HasSubstr("corner_rounding")));
+  }
+  EXPECT_EQ(cache.EntryCount(), 0u);
+}
+
+TEST(BrushFamilyDecodeCacheTest, DecodeBrush) {
+  BrushFamilyDecodeCache cache(10);
+  proto::Brush brush_proto;
+  *brush_proto.mutable_brush_family() = EncodeFamilyWithBehavior(0.5);
+  brush_proto.set_size_stroke_space(10);
+  brush_proto.set_epsilon_stroke_space(0.1);
+  absl::StatusOr<Brush> expected = DecodeBrush(brush_proto);
+  ASSERT_THAT(expected, IsOk());
+
+  for (int i = 0; i < 2; ++i) {
+    absl::StatusOr<Brush> brush = cache.DecodeBrush(brush_proto);
+    ASSERT_THAT(brush, IsOk());
+    EXPECT_THAT(*brush, BrushEq(*expected));
+  }
+  EXPECT_TRUE(cache.Contains(brush_proto.brush_family()));
+  EXPECT_EQ(cache.EntryCount(), 1u);
+
+  // A different size doesn't need a new entry.
+  brush_proto.set_size_stroke_space(20);
+  absl::StatusOr<Brush> brush = cache.DecodeBrush(brush_proto);
+  ASSERT_THAT(brush, IsOk());
+  EXPECT_EQ(brush->GetSize(), 20);
+  EXPECT_EQ(cache.EntryCount(), 1u);
+}
+
+TEST(BrushFamilyDecodeCacheTest, Clear) {
+  BrushFamilyDecodeCache cache(10);
+  proto::BrushFamily family_proto = EncodeFamilyWithBehavior(0);
+  ASSERT_THAT(cache.DecodeBrushFamily(family_proto), IsOk());
+  cache.Clear();
+  EXPECT_EQ(cache.EntryCount(), 0u);
+  EXPECT_FALSE(cache.Contains(family_proto));
+}
+
+TEST(BrushFamilyDecodeCacheTest, ProcessCache) {
+  EXPECT_EQ(BrushFamilyDecodeCache::GetProcessCache(), nullptr);
+  auto cache = std::make_shared<BrushFamilyDecodeCache>(10);
+  BrushFamilyDecodeCache::SetProcessCache(cache);
+  EXPECT_EQ(BrushFamilyDecodeCache::GetProcessCache(), cache);
+  BrushFamilyDecodeCache::SetProcessCache(nullptr);
+  EXPECT_EQ(BrushFamilyDecodeCache::GetProcessCache(), nullptr);
+}
+
+TEST(BrushFamilyDecodeCacheTest, TrimMemoryClearsProcessCache) {
+  auto cache = std::make_shared<BrushFamilyDecodeCache>(10);
+  BrushFamilyDecodeCache::SetProcessCache(cache);
+  ASSERT_THAT(cache->DecodeBrushFamily(EncodeFamilyWithBehavior(0)), IsOk());
+  size_t bytes = cache->ApproximateBytes();
+  EXPECT_GT(bytes, 0u);
+
+  // Pooled memory is trimmed before caches, so this keeps the entry.
+  TrimMemory(MemoryTrimLevel::kPooledMemory);
+  EXPECT_EQ(cache->EntryCount(), 1u);
+
+  EXPECT_GE(TrimMemory(MemoryTrimLevel::kCaches), bytes);
+  EXPECT_EQ(cache->EntryCount(), 0u);
+  EXPECT_EQ(cache->ApproximateBytes(), 0u);
+  BrushFamilyDecodeCache::SetProcessCache(nullptr);
+}
+
+}  // namespace
+}  // namespace ink
@@ -337,6 +337,18 @@ void DecodeBrushFamilyDoesNotCrashOnArbitraryInput(
 }
 FUZZ_TEST(BrushTest, DecodeBrushFamilyDoesNotCrashOnArbitraryInput);
 
+void DecodeTrustedBrushFamilyDoesNotCrashOnArbitraryInput(
+    const proto::BrushFamily& family_proto) {
+  DecodeBrushFamily(
+      family_proto,
+      [](const std::string& encoded_id, const std::string& bitmap) {
+        return encoded_id;
+      },
+      {.trusted_input = true})
+      .IgnoreError();
+}
+FUZZ_TEST(BrushTest, DecodeTrustedBrushFamilyDoesNotCrashOnArbitraryInput);
+
 void DecodeBrushTipDoesNotCrashOnArbitraryInput(
     const proto::BrushTip& tip_proto) {
   DecodeBrushTip(tip_proto).IgnoreError();
@@ -619,6 +631,114 @@ TEST(BrushTest, EncodeDecodeBrushFamilyWithRawPositionInputModel) {
   EXPECT_TRUE(family_proto.input_model().has_experimental_raw_position_model());
 }
 
+TEST(BrushTest, EncodeDecodeBrushFamilyWithAdaptiveSamplingInputModel) {
+  absl::StatusOr<BrushFamily> family =
+      BrushFamily::Create(BrushTip{}, BrushPaint{}, "test_id",
+                          BrushFamily::ExperimentalAdaptiveSamplingModel{});
+  ASSERT_THAT(family, IsOk());
+  proto::BrushFamily family_proto;
+  EncodeBrushFamily(*family, family_proto);
+  EXPECT_TRUE(
+      family_proto.input_model().has_experimental_adaptive_sampling_model());
+
+  absl::StatusOr<BrushFamily> decoded = DecodeBrushFamily(family_proto);
+  ASSERT_THAT(decoded, IsOk());
+  EXPECT_TRUE(
+      std::holds_alternative<BrushFamily::ExperimentalAdaptiveSamplingModel>(
+          decoded->GetInputModel()));
+}
+
+TEST(BrushTest, DecodeTrustedBrushFamilyStillValidatesFamily) {
+  auto keep_id = [](const std::string& encoded_id, const std::string& bitmap) {
+    return encoded_id;
+  };
+
+  proto::BrushFamily invalid_tip_proto;
+  invalid_tip_proto.add_coats()->mutable_tip()->set_corner_rounding(2.f);
+  EXPECT_THAT(
+      DecodeBrushFamily(invalid_tip_proto, keep_id, {.trusted_input = true}),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("corner_rounding")));
+
+  // A behavior whose nodes don't form a valid graph.
+  proto::BrushFamily invalid_behavior_proto;
+  invalid_behavior_proto.add_coats()
+      ->mutable_tip()
+      ->add_behaviors()
+      ->add_nodes()
+      ->mutable_constant_node()
+      ->set_value(1.f);
+  EXPECT_THAT(DecodeBrushFamily(invalid_behavior_proto, keep_id,
+                                {.trusted_input = true}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must consume all generated values")));
+}
+
+TEST(BrushTest, EncodeBrushFamilyRecordsValidationWhenRequested) {
+  absl::StatusOr<BrushFamily> family =
+      BrushFamily::Create(BrushTip{}, BrushPaint{});
+  ASSERT_THAT(family, IsOk());
+  TextureBitmapProvider no_bitmaps = [](const std::string& id) {
+    return std::nullopt;
+  };
+
+  proto::BrushFamily family_proto;
+  EncodeBrushFamily(*family, family_proto);
+  EXPECT_FALSE(family_proto.has_validation_record());
+
+  EncodeBrushFamily(*family, family_proto, no_bitmaps,
+                    {.record_validation = true});
+  EXPECT_EQ(family_proto.validation_record().validation_version(),
+            BrushFamily::kValidationVersion);
+
+  proto::Brush brush_proto;
+  EncodeBrush(Brush(), brush_proto, no_bitmaps, {.record_validation = true});
+  EXPECT_EQ(brush_proto.brush_family().validation_record().validation_version(),
+            BrushFamily::kValidationVersion);
+}
+
+TEST(BrushTest, DecodeTrustedBrushFamilyWithValidationRecordSkipsValidation) {
+  auto keep_id = [](const std::string& encoded_id, const std::string& bitmap) {
+    return encoded_id;
+  };
+
+  // This tip would fail validation, so decoding it only succeeds if validation
+  // is skipped.
+  proto::BrushFamily family_proto;
+  family_proto.add_coats()->mutable_tip()->set_corner_rounding(2.f);
+  family_proto.mutable_validation_record()->set_validation_version(
+      BrushFamily::kValidationVersion);
+  absl::StatusOr<BrushFamily> family =
+      DecodeBrushFamily(family_proto, keep_id, {.trusted_input = true});
+  ASSERT_THAT(family, IsOk());
+  EXPECT_EQ(family->GetCoats()[0].tip.corner_rounding, 2.f);
+
+  // The record is ignored for untrusted input, and if its version differs.
+  EXPECT_THAT(DecodeBrushFamily(family_proto, keep_id, {}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  family_proto.mutable_validation_record()->set_validation_version(
+      BrushFamily::kValidationVersion + 1);
+  EXPECT_THAT(
+      DecodeBrushFamily(family_proto, keep_id, {.trusted_input = true}),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("corner_rounding")));
+
+  // The structure of behavior graphs is still checked.
+  proto::BrushFamily invalid_behavior_proto;
+  invalid_behavior_proto.add_coats()
+      ->mutable_tip()
+      ->add_behaviors()
+      ->add_nodes()
+      ->mutable_constant_node()
+      ->set_value(1.f);
+  invalid_behavior_proto.mutable_validation_record()->set_validation_version(
+      BrushFamily::kValidationVersion);
+  EXPECT_THAT(DecodeBrushFamily(invalid_behavior_proto, keep_id,
+                                {.trusted_input = true}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must consume all generated values")));
+}
+
 TEST(BrushTest, DecodeBrushFamilyReturnsErrorStatusFromCallback) {
   absl::Status error_status = absl::InternalError("test error");
   ClientTextureIdProviderAndBitmapReceiver callback =
@@ -808,6 +928,15 @@ void EncodeDecodeBrushFamilyRoundTrip(const BrushFamily& family_in) {
   ASSERT_EQ(family_out.status(), absl::OkStatus());
   EXPECT_THAT(*family_out, BrushFamilyEq(family_in));
 
+  absl::StatusOr<BrushFamily> trusted_family_out = DecodeBrushFamily(
+      family_proto_in,
+      [](const std::string& encoded_id, const std::string& bitmap) {
+        return encoded_id;
+      },
+      {.trusted_input = true});
+  ASSERT_EQ(trusted_family_out.status(), absl::OkStatus());
+  EXPECT_THAT(*trusted_family_out, BrushFamilyEq(family_in));
+
   proto::BrushFamily family_proto_out;
   EncodeBrushFamily(*family_out, family_proto_out);
   EXPECT_THAT(family_proto_out, EqualsProto(family_proto_in));
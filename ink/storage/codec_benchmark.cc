@@ -0,0 +1,731 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Benchmarks for the storage codecs.
+//
+// Each benchmark reports, alongside wall time:
+//   * `bytes_per_second`: encoded bytes produced or consumed per second.
+//   * `encoded_bytes`: the size of the encoding produced or consumed by one
+//     iteration.
+//   * `allocs_per_iter` and `alloc_bytes_per_iter`: heap allocations, and bytes
+//     allocated, per iteration.
+//
+// The synthetic benchmarks take the number of values, inputs, triangles, or
+// brush behaviors being encoded or decoded. The recorded document benchmarks
+// take the number of strokes in a document whose strokes are drawn from
+// recorded pen input, and so reflect the data that apps actually store.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "google/protobuf/arena.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_behavior.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mesh_test_helpers.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/vec.h"
+#include "ink/storage/brush.h"
+#include "ink/storage/mesh.h"
+#include "ink/storage/numeric_run.h"
+#include "ink/storage/partitioned_mesh.h"
+#include "ink/storage/proto/brush.pb.h"
+#include "ink/storage/proto/brush_family.pb.h"
+#include "ink/storage/proto/coded_numeric_run.pb.h"
+#include "ink/storage/proto/mesh.pb.h"
+#include "ink/storage/proto/stroke_document.pb.h"
+#include "ink/storage/proto/stroke_input_batch.pb.h"
+#include "ink/storage/stroke_document.h"
+#include "ink/storage/stroke_input_batch.h"
+#include "ink/strokes/input/recorded_test_inputs.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/internal/allocation_counter.h"
+#include "ink/types/iterator_range.h"
+
+namespace ink {
+namespace {
+
+// Reports the counters described at the top of this file. Construct this just
+// before the benchmark loop, and call `Report()` just after it.
+class CodecMetrics {
+ public:
+  explicit CodecMetrics(benchmark::State& state)
+      : state_(state), allocation_counters_(state) {}
+
+  void Report(size_t encoded_bytes) {
+    allocation_counters_.Report();
+    state_.SetBytesProcessed(state_.iterations() * encoded_bytes);
+    state_.counters["encoded_bytes"] = encoded_bytes;
+  }
+
+ private:
+  benchmark::State& state_;
+  ink_internal::ScopedAllocationCounters allocation_counters_;
+};
+
+proto::CodedNumericRun MakeNumericRun(int64_t size) {
+  proto::CodedNumericRun run;
+  run.set_scale(1.f / 4096);
+  run.set_offset(10);
+  run.mutable_deltas()->Reserve(size);
+  for (int64_t i = 0; i < size; ++i) {
+    // A small delta that wiggles up and down, roughly like quantized input.
+    run.add_deltas(static_cast<int32_t>(i % 7) - 3);
+  }
+  return run;
+}
+
+void BM_DecodeFloatNumericRunByIterator(benchmark::State& state) {
+  proto::CodedNumericRun run = MakeNumericRun(state.range(0));
+  std::vector<float> values(state.range(0));
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>> range =
+        DecodeFloatNumericRun(run);
+    ABSL_CHECK_OK(range);
+    values.assign(range->begin(), range->end());
+    benchmark::DoNotOptimize(values.data());
+  }
+  metrics.Report(run.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeFloatNumericRunByIterator)->Range(64, 64 << 10);
+
+void BM_DecodeFloatNumericRunInto(benchmark::State& state) {
+  proto::CodedNumericRun run = MakeNumericRun(state.range(0));
+  std::vector<float> values(state.range(0));
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    ABSL_CHECK_OK(DecodeFloatNumericRunInto(run, absl::MakeSpan(values)));
+    benchmark::DoNotOptimize(values.data());
+  }
+  metrics.Report(run.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeFloatNumericRunInto)->Range(64, 64 << 10);
+
+void BM_DecodeBitPackedFloatNumericRunInto(benchmark::State& state) {
+  proto::CodedNumericRun run = MakeNumericRun(state.range(0));
+  BitPackNumericRun(run);
+  std::vector<float> values(state.range(0));
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    ABSL_CHECK_OK(DecodeFloatNumericRunInto(run, absl::MakeSpan(values)));
+    benchmark::DoNotOptimize(values.data());
+  }
+  metrics.Report(run.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeBitPackedFloatNumericRunInto)->Range(64, 64 << 10);
+
+void BM_DecodeIntNumericRunInto(benchmark::State& state) {
+  proto::CodedNumericRun run = MakeNumericRun(state.range(0));
+  run.clear_scale();
+  run.clear_offset();
+  std::vector<int32_t> values(state.range(0));
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    ABSL_CHECK_OK(DecodeIntNumericRunInto(run, absl::MakeSpan(values)));
+    benchmark::DoNotOptimize(values.data());
+  }
+  metrics.Report(run.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeIntNumericRunInto)->Range(64, 64 << 10);
+
+void BM_EncodeIntNumericRun(benchmark::State& state) {
+  std::vector<int32_t> values(state.range(0));
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    values[i] = static_cast<int32_t>(i % 7) - 3;
+  }
+  proto::CodedNumericRun run;
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    EncodeIntNumericRun(values.begin(), values.end(), &run);
+    benchmark::DoNotOptimize(run);
+  }
+  metrics.Report(run.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeIntNumericRun)->Range(64, 64 << 10);
+
+void BM_BitPackNumericRun(benchmark::State& state) {
+  const proto::CodedNumericRun unpacked = MakeNumericRun(state.range(0));
+  proto::CodedNumericRun run;
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    run = unpacked;
+    BitPackNumericRun(run);
+    benchmark::DoNotOptimize(run);
+  }
+  metrics.Report(run.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BitPackNumericRun)->Range(64, 64 << 10);
+
+// Returns a stylus stroke with `n_inputs` inputs along a spiral, reporting
+// pressure, tilt, and orientation.
+StrokeInputBatch MakeSpiralInputBatch(int64_t n_inputs) {
+  std::vector<StrokeInput> inputs;
+  inputs.reserve(n_inputs);
+  for (int64_t i = 0; i < n_inputs; ++i) {
+    float t = 0.01f * i;
+    inputs.push_back({.tool_type = StrokeInput::ToolType::kStylus,
+                      .position = {t * std::cos(t), t * std::sin(t)},
+                      .elapsed_time = Duration32::Millis(4 * i),
+                      .pressure = 0.5f + 0.25f * std::sin(t),
+                      .tilt = Angle::Radians(0.5f),
+                      .orientation = Angle::Radians(std::fmod(t, 6.f))});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *std::move(batch);
+}
+
+void BM_EncodeStrokeInputBatch(benchmark::State& state) {
+  StrokeInputBatch batch = MakeSpiralInputBatch(state.range(0));
+  proto::CodedStrokeInputBatch coded;
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    EncodeStrokeInputBatch(batch, coded);
+    benchmark::DoNotOptimize(coded);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeStrokeInputBatch)->Range(64, 16 << 10);
+
+void BM_DecodeStrokeInputBatch(benchmark::State& state) {
+  proto::CodedStrokeInputBatch coded;
+  EncodeStrokeInputBatch(MakeSpiralInputBatch(state.range(0)), coded);
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<StrokeInputBatch> batch = DecodeStrokeInputBatch(coded);
+    ABSL_CHECK_OK(batch);
+    benchmark::DoNotOptimize(batch);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeStrokeInputBatch)->Range(64, 16 << 10);
+
+void BM_DecodeTrustedStrokeInputBatch(benchmark::State& state) {
+  proto::CodedStrokeInputBatch coded;
+  EncodeStrokeInputBatch(MakeSpiralInputBatch(state.range(0)), coded);
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<StrokeInputBatch> batch =
+        DecodeStrokeInputBatch(coded, {.trusted_input = true});
+    ABSL_CHECK_OK(batch);
+    benchmark::DoNotOptimize(batch);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeTrustedStrokeInputBatch)->Range(64, 16 << 10);
+
+void BM_EncodeMesh(benchmark::State& state) {
+  PartitionedMesh shape = MakeCoiledRingPartitionedMesh(state.range(0), 100);
+  const Mesh& mesh = shape.RenderGroupMeshes(0).front();
+  proto::CodedMesh coded;
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    EncodeMesh(mesh, coded);
+    benchmark::DoNotOptimize(coded);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeMesh)->Range(64, 16 << 10);
+
+void BM_DecodeMesh(benchmark::State& state) {
+  PartitionedMesh shape = MakeCoiledRingPartitionedMesh(state.range(0), 100);
+  proto::CodedMesh coded;
+  EncodeMesh(shape.RenderGroupMeshes(0).front(), coded);
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<Mesh> mesh = DecodeMesh(coded);
+    ABSL_CHECK_OK(mesh);
+    benchmark::DoNotOptimize(mesh);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeMesh)->Range(64, 16 << 10);
+
+void BM_DecodeMeshWithCompressedTriangleIndex(benchmark::State& state) {
+  PartitionedMesh shape = MakeCoiledRingPartitionedMesh(state.range(0), 100);
+  proto::CodedMesh coded;
+  ABSL_CHECK_OK(EncodeMesh(shape.RenderGroupMeshes(0).front(),
+                           {.compress_triangle_index = true}, coded));
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<Mesh> mesh = DecodeMesh(coded);
+    ABSL_CHECK_OK(mesh);
+    benchmark::DoNotOptimize(mesh);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeMeshWithCompressedTriangleIndex)->Range(64, 16 << 10);
+
+void BM_EncodePartitionedMesh(benchmark::State& state) {
+  PartitionedMesh shape = MakeCoiledRingPartitionedMesh(state.range(0), 100);
+  proto::CodedModeledShape coded;
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    EncodePartitionedMesh(shape, coded);
+    benchmark::DoNotOptimize(coded);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodePartitionedMesh)->Range(64, 16 << 10);
+
+void BM_DecodePartitionedMesh(benchmark::State& state) {
+  proto::CodedModeledShape coded;
+  EncodePartitionedMesh(MakeCoiledRingPartitionedMesh(state.range(0), 100),
+                        coded);
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<PartitionedMesh> shape = DecodePartitionedMesh(coded);
+    ABSL_CHECK_OK(shape);
+    benchmark::DoNotOptimize(shape);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodePartitionedMesh)->Range(64, 16 << 10);
+
+// Returns a single-coat brush family whose tip has `n_behaviors` behaviors,
+// each mapping pressure to size.
+BrushFamily MakeBrushFamilyWithBehaviors(int64_t n_behaviors) {
+  BrushTip tip;
+  for (int64_t i = 0; i < n_behaviors; ++i) {
+    tip.behaviors.push_back(BrushBehavior{{
+        BrushBehavior::SourceNode{
+            .source = BrushBehavior::Source::kNormalizedPressure,
+            .source_value_range = {0, 1},
+        },
+        BrushBehavior::TargetNode{
+            .target = BrushBehavior::Target::kSizeMultiplier,
+            .target_modifier_range = {0.5, 1.5},
+        },
+    }});
+  }
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(tip, BrushPaint{});
+  ABSL_CHECK_OK(family);
+  return *std::move(family);
+}
+
+void BM_EncodeBrushFamily(benchmark::State& state) {
+  BrushFamily family = MakeBrushFamilyWithBehaviors(state.range(0));
+  proto::BrushFamily family_proto;
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    EncodeBrushFamily(family, family_proto);
+    benchmark::DoNotOptimize(family_proto);
+  }
+  metrics.Report(family_proto.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeBrushFamily)->Range(1, 64);
+
+void BM_DecodeBrushFamily(benchmark::State& state) {
+  proto::BrushFamily family_proto;
+  EncodeBrushFamily(MakeBrushFamilyWithBehaviors(state.range(0)),
+                    family_proto);
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<BrushFamily> family = DecodeBrushFamily(family_proto);
+    ABSL_CHECK_OK(family);
+    benchmark::DoNotOptimize(family);
+  }
+  metrics.Report(family_proto.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeBrushFamily)->Range(1, 64);
+
+void BM_DecodeTrustedBrushFamily(benchmark::State& state) {
+  proto::BrushFamily family_proto;
+  EncodeBrushFamily(MakeBrushFamilyWithBehaviors(state.range(0)),
+                    family_proto);
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<BrushFamily> family = DecodeBrushFamily(
+        family_proto,
+        [](const std::string& encoded_id, const std::string& bitmap) {
+          return encoded_id;
+        },
+        {.trusted_input = true});
+    ABSL_CHECK_OK(family);
+    benchmark::DoNotOptimize(family);
+  }
+  metrics.Report(family_proto.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeTrustedBrushFamily)->Range(1, 64);
+
+// The recorded document benchmarks take the number of strokes in the document.
+constexpr int64_t kMinDocumentStrokes = 1;
+constexpr int64_t kMaxDocumentStrokes = 256;
+
+constexpr float kRecordedStrokeSize = 100;
+constexpr int kRecordedStrokesPerRow = 16;
+
+Brush MakeRecordedDocumentBrush(const BrushTip& tip) {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(tip, BrushPaint{});
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush =
+      Brush::Create(*std::move(family), Color::Black(), 5, 0.01);
+  ABSL_CHECK_OK(brush);
+  return *std::move(brush);
+}
+
+// Returns brushes approximating the kinds of stock brush families that apps
+// ship with, as in //ink/strokes:recorded_inputs_benchmark: a marker, a
+// pressure pen, and a highlighter.
+std::vector<Brush> MakeRecordedDocumentBrushes() {
+  return {
+      MakeRecordedDocumentBrush({.scale = {1, 1}, .corner_rounding = 1}),
+      MakeRecordedDocumentBrush(
+          {.scale = {1, 1},
+           .corner_rounding = 1,
+           .behaviors = {BrushBehavior{{
+               BrushBehavior::SourceNode{
+                   .source = BrushBehavior::Source::kNormalizedPressure,
+                   .source_value_range = {0, 1},
+               },
+               BrushBehavior::DampingNode{
+                   .damping_source =
+                       BrushBehavior::DampingSource::kTimeInSeconds,
+                   .damping_gap = 0.02,
+               },
+               BrushBehavior::TargetNode{
+                   .target = BrushBehavior::Target::kSizeMultiplier,
+                   .target_modifier_range = {0.5, 1.5},
+               },
+           }}}}),
+      MakeRecordedDocumentBrush({.scale = {0.25, 1}, .corner_rounding = 0.3}),
+  };
+}
+
+// Returns a document of `n_strokes` strokes laid out in a grid. The strokes
+// alternate between the recorded straight line and spring shape inputs, and
+// cycle through the brushes of `MakeRecordedDocumentBrushes()`.
+std::vector<Stroke> MakeRecordedDocument(int64_t n_strokes) {
+  Rect bounds =
+      Rect::FromTwoPoints({0, 0}, {kRecordedStrokeSize, kRecordedStrokeSize});
+  const StrokeInputBatch sources[] = {
+      MakeCompleteStraightLineInputs(bounds),
+      MakeCompleteSpringShapeInputs(bounds),
+  };
+  const std::vector<Brush> brushes = MakeRecordedDocumentBrushes();
+  std::vector<Stroke> strokes;
+  strokes.reserve(n_strokes);
+  for (int64_t i = 0; i < n_strokes; ++i) {
+    StrokeInputBatch inputs = sources[i % 2];
+    inputs.Transform(AffineTransform::Translate(
+        Vec{kRecordedStrokeSize * (i % kRecordedStrokesPerRow),
+            kRecordedStrokeSize * (i / kRecordedStrokesPerRow)}));
+    strokes.emplace_back(brushes[i % brushes.size()], inputs);
+  }
+  return strokes;
+}
+
+void BM_EncodeRecordedStrokeInputs(benchmark::State& state) {
+  std::vector<Stroke> strokes = MakeRecordedDocument(state.range(0));
+  std::vector<proto::CodedStrokeInputBatch> coded(strokes.size());
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    for (size_t i = 0; i < strokes.size(); ++i) {
+      EncodeStrokeInputBatch(strokes[i].GetInputs(), coded[i]);
+    }
+    benchmark::DoNotOptimize(coded);
+  }
+  size_t encoded_bytes = 0;
+  for (const proto::CodedStrokeInputBatch& batch : coded) {
+    encoded_bytes += batch.ByteSizeLong();
+  }
+  metrics.Report(encoded_bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeRecordedStrokeInputs)
+    ->Range(kMinDocumentStrokes, kMaxDocumentStrokes);
+
+void BM_DecodeRecordedStrokeInputs(benchmark::State& state) {
+  std::vector<Stroke> strokes = MakeRecordedDocument(state.range(0));
+  std::vector<proto::CodedStrokeInputBatch> coded(strokes.size());
+  size_t encoded_bytes = 0;
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    EncodeStrokeInputBatch(strokes[i].GetInputs(), coded[i]);
+    encoded_bytes += coded[i].ByteSizeLong();
+  }
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    for (const proto::CodedStrokeInputBatch& batch_proto : coded) {
+      absl::StatusOr<StrokeInputBatch> batch =
+          DecodeStrokeInputBatch(batch_proto);
+      ABSL_CHECK_OK(batch);
+      benchmark::DoNotOptimize(batch);
+    }
+  }
+  metrics.Report(encoded_bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeRecordedStrokeInputs)
+    ->Range(kMinDocumentStrokes, kMaxDocumentStrokes);
+
+// Returns the meshes of every stroke shape in `strokes`.
+std::vector<Mesh> RecordedDocumentMeshes(absl::Span<const Stroke> strokes) {
+  std::vector<Mesh> meshes;
+  for (const Stroke& stroke : strokes) {
+    const PartitionedMesh& shape = stroke.GetShape();
+    for (uint32_t group = 0; group < shape.RenderGroupCount(); ++group) {
+      for (const Mesh& mesh : shape.RenderGroupMeshes(group)) {
+        meshes.push_back(mesh);
+      }
+    }
+  }
+  return meshes;
+}
+
+void BM_EncodeRecordedMeshes(benchmark::State& state) {
+  std::vector<Mesh> meshes =
+      RecordedDocumentMeshes(MakeRecordedDocument(state.range(0)));
+  std::vector<proto::CodedMesh> coded(meshes.size());
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    for (size_t i = 0; i < meshes.size(); ++i) {
+      EncodeMesh(meshes[i], coded[i]);
+    }
+    benchmark::DoNotOptimize(coded);
+  }
+  size_t encoded_bytes = 0;
+  for (const proto::CodedMesh& mesh : coded) {
+    encoded_bytes += mesh.ByteSizeLong();
+  }
+  metrics.Report(encoded_bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeRecordedMeshes)
+    ->Range(kMinDocumentStrokes, kMaxDocumentStrokes);
+
+void BM_DecodeRecordedMeshes(benchmark::State& state) {
+  std::vector<Mesh> meshes =
+      RecordedDocumentMeshes(MakeRecordedDocument(state.range(0)));
+  std::vector<proto::CodedMesh> coded(meshes.size());
+  size_t encoded_bytes = 0;
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    EncodeMesh(meshes[i], coded[i]);
+    encoded_bytes += coded[i].ByteSizeLong();
+  }
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    for (const proto::CodedMesh& mesh_proto : coded) {
+      absl::StatusOr<Mesh> mesh = DecodeMesh(mesh_proto);
+      ABSL_CHECK_OK(mesh);
+      benchmark::DoNotOptimize(mesh);
+    }
+  }
+  metrics.Report(encoded_bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeRecordedMeshes)
+    ->Range(kMinDocumentStrokes, kMaxDocumentStrokes);
+
+void BM_EncodeRecordedPartitionedMeshes(benchmark::State& state) {
+  std::vector<Stroke> strokes = MakeRecordedDocument(state.range(0));
+  std::vector<proto::CodedModeledShape> coded(strokes.size());
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    for (size_t i = 0; i < strokes.size(); ++i) {
+      EncodePartitionedMesh(strokes[i].GetShape(), coded[i]);
+    }
+    benchmark::DoNotOptimize(coded);
+  }
+  size_t encoded_bytes = 0;
+  for (const proto::CodedModeledShape& shape : coded) {
+    encoded_bytes += shape.ByteSizeLong();
+  }
+  metrics.Report(encoded_bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeRecordedPartitionedMeshes)
+    ->Range(kMinDocumentStrokes, kMaxDocumentStrokes);
+
+void BM_DecodeRecordedPartitionedMeshes(benchmark::State& state) {
+  std::vector<Stroke> strokes = MakeRecordedDocument(state.range(0));
+  std::vector<proto::CodedModeledShape> coded(strokes.size());
+  size_t encoded_bytes = 0;
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    EncodePartitionedMesh(strokes[i].GetShape(), coded[i]);
+    encoded_bytes += coded[i].ByteSizeLong();
+  }
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    for (const proto::CodedModeledShape& shape_proto : coded) {
+      absl::StatusOr<PartitionedMesh> shape =
+          DecodePartitionedMesh(shape_proto);
+      ABSL_CHECK_OK(shape);
+      benchmark::DoNotOptimize(shape);
+    }
+  }
+  metrics.Report(encoded_bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeRecordedPartitionedMeshes)
+    ->Range(kMinDocumentStrokes, kMaxDocumentStrokes);
+
+void BM_EncodeRecordedBrushes(benchmark::State& state) {
+  std::vector<Stroke> strokes = MakeRecordedDocument(state.range(0));
+  std::vector<proto::Brush> coded(strokes.size());
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    for (size_t i = 0; i < strokes.size(); ++i) {
+      EncodeBrush(strokes[i].GetBrush(), coded[i]);
+    }
+    benchmark::DoNotOptimize(coded);
+  }
+  size_t encoded_bytes = 0;
+  for (const proto::Brush& brush : coded) {
+    encoded_bytes += brush.ByteSizeLong();
+  }
+  metrics.Report(encoded_bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeRecordedBrushes)
+    ->Range(kMinDocumentStrokes, kMaxDocumentStrokes);
+
+void BM_DecodeRecordedBrushes(benchmark::State& state) {
+  std::vector<Stroke> strokes = MakeRecordedDocument(state.range(0));
+  std::vector<proto::Brush> coded(strokes.size());
+  size_t encoded_bytes = 0;
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    EncodeBrush(strokes[i].GetBrush(), coded[i]);
+    encoded_bytes += coded[i].ByteSizeLong();
+  }
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    for (const proto::Brush& brush_proto : coded) {
+      absl::StatusOr<Brush> brush = DecodeBrush(brush_proto);
+      ABSL_CHECK_OK(brush);
+      benchmark::DoNotOptimize(brush);
+    }
+  }
+  metrics.Report(encoded_bytes);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeRecordedBrushes)
+    ->Range(kMinDocumentStrokes, kMaxDocumentStrokes);
+
+// The whole-document benchmarks store each brush family once, and take the
+// second argument as whether stroke shapes are stored.
+void BM_EncodeRecordedStrokeDocument(benchmark::State& state) {
+  std::vector<Stroke> strokes = MakeRecordedDocument(state.range(0));
+  bool include_shapes = state.range(1) != 0;
+  proto::CodedStrokeDocument coded;
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    EncodeStrokeDocument(strokes, coded, include_shapes);
+    benchmark::DoNotOptimize(coded);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EncodeRecordedStrokeDocument)
+    ->ArgNames({"strokes", "shapes"})
+    ->ArgsProduct({benchmark::CreateRange(kMinDocumentStrokes,
+                                          kMaxDocumentStrokes, 8),
+                   {0, 1}});
+
+void BM_DecodeRecordedStrokeDocument(benchmark::State& state) {
+  proto::CodedStrokeDocument coded;
+  EncodeStrokeDocument(MakeRecordedDocument(state.range(0)), coded,
+                       state.range(1) != 0);
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    absl::StatusOr<std::vector<Stroke>> strokes = DecodeStrokeDocument(coded);
+    ABSL_CHECK_OK(strokes);
+    benchmark::DoNotOptimize(strokes);
+  }
+  metrics.Report(coded.ByteSizeLong());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeRecordedStrokeDocument)
+    ->ArgNames({"strokes", "shapes"})
+    ->ArgsProduct({benchmark::CreateRange(kMinDocumentStrokes,
+                                          kMaxDocumentStrokes, 8),
+                   {0, 1}});
+
+// Parses a serialized document and decodes its strokes, which is what loading
+// a document from storage takes. The third argument is whether the document
+// proto is allocated on a `google::protobuf::Arena` rather than on the heap.
+void BM_ParseAndDecodeRecordedStrokeDocument(benchmark::State& state) {
+  proto::CodedStrokeDocument coded;
+  EncodeStrokeDocument(MakeRecordedDocument(state.range(0)), coded,
+                       state.range(1) != 0);
+  std::string serialized = coded.SerializeAsString();
+  bool use_arena = state.range(2) != 0;
+  CodecMetrics metrics(state);
+  for (auto s : state) {
+    std::optional<google::protobuf::Arena> arena;
+    std::optional<proto::CodedStrokeDocument> heap_document;
+    proto::CodedStrokeDocument* document;
+    if (use_arena) {
+      arena.emplace();
+      document =
+          google::protobuf::Arena::Create<proto::CodedStrokeDocument>(&*arena);
+    } else {
+      document = &heap_document.emplace();
+    }
+    ABSL_CHECK(document->ParseFromString(serialized));
+    absl::StatusOr<std::vector<Stroke>> strokes =
+        DecodeStrokeDocument(*document);
+    ABSL_CHECK_OK(strokes);
+    benchmark::DoNotOptimize(strokes);
+  }
+  metrics.Report(serialized.size());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ParseAndDecodeRecordedStrokeDocument)
+    ->ArgNames({"strokes", "shapes", "arena"})
+    ->ArgsProduct({benchmark::CreateRange(kMinDocumentStrokes,
+                                          kMaxDocumentStrokes, 8),
+                   {0, 1},
+                   {0, 1}});
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,57 @@
+// Copyright 2024-2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STORAGE_DECODE_OPTIONS_H_
+#define INK_STORAGE_DECODE_OPTIONS_H_
+
+#include "absl/base/nullability.h"
+#include "ink/types/allocator.h"
+
+namespace ink {
+
+// Options shared by the decoders that accept them, such as
+// `DecodeStrokeInputBatch()` and `DecodeBrushFamily()`.
+struct DecodeOptions {
+  // Whether the proto is known to have been produced by this library's encoder
+  // from a valid object, e.g. because it was read back from the app's own
+  // local storage. If true, the decoder may skip checks that would already
+  // hold for such a proto; see each decoder for which checks are skipped.
+  //
+  // Checks that protect memory safety, such as run lengths, index bounds, and
+  // the structure of brush behavior graphs, are always performed, so decoding
+  // arbitrary bytes with this set is still safe, but may produce an object
+  // that doesn't satisfy all of its documented invariants. Protos from
+  // untrusted sources, such as files shared between users, should be decoded
+  // with this left false.
+  bool trusted_input = false;
+
+  // Whether `DecodePartitionedMesh()` initializes the spatial index of the
+  // decoded `PartitionedMesh`, as `PartitionedMesh::InitializeSpatialIndex()`
+  // would, but while decoding. The position cache of each mesh is built right
+  // after the mesh is decoded, while its vertex data is still in the CPU
+  // cache, and the index is then built from the position caches, so that the
+  // interleaved vertex data is only read once. This suits shapes that will be
+  // hit-tested soon after loading. Ignored by the other decoders.
+  bool initialize_spatial_index = false;
+
+  // The allocator that provides the memory for the vertex and index data of
+  // each decoded `Mesh`, which `DecodePartitionedMesh()` packs directly into
+  // that memory; see `DecodeMesh()`. If null, `DefaultAllocator()` is used. It
+  // must outlive the decoded object. Ignored by the other decoders.
+  Allocator* absl_nullable allocator = nullptr;
+};
+
+}  // namespace ink
+
+#endif  // INK_STORAGE_DECODE_OPTIONS_H_
@@ -0,0 +1,113 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/storage/hibernated_stroke.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "google/protobuf/arena.h"
+#include "ink/brush/brush.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/storage/decode_options.h"
+#include "ink/storage/partitioned_mesh.h"
+#include "ink/storage/proto/mesh.pb.h"
+#include "ink/storage/proto/stroke_input_batch.pb.h"
+#include "ink/storage/stroke_input_batch.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+#include "ink/types/memory_footprint.h"
+#include "ink/types/trace.h"
+
+namespace ink {
+
+HibernatedStroke HibernatedStroke::Hibernate(const Stroke& stroke,
+                                             bool keep_shape) {
+  ScopedTraceEvent trace_event("ink::HibernatedStroke::Hibernate");
+  auto data = std::make_shared<EncodedData>();
+  const PartitionedMesh& shape = stroke.GetShape();
+  data->bounds = shape.Bounds();
+
+  google::protobuf::Arena arena;
+  proto::CodedStrokeInputBatch& inputs_proto =
+      *google::protobuf::Arena::Create<proto::CodedStrokeInputBatch>(&arena);
+  EncodeStrokeInputBatch(stroke.GetInputs(), inputs_proto);
+  inputs_proto.SerializeToString(&data->inputs);
+  if (keep_shape) {
+    proto::CodedModeledShape& shape_proto =
+        *google::protobuf::Arena::Create<proto::CodedModeledShape>(&arena);
+    EncodePartitionedMesh(shape, shape_proto);
+    shape_proto.SerializeToString(&data->shape);
+  }
+  return HibernatedStroke(stroke.GetBrush(), std::move(data));
+}
+
+HibernatedStroke::HibernatedStroke(const Brush& brush,
+                                   std::shared_ptr<const EncodedData> data)
+    : brush_(brush), data_(std::move(data)) {}
+
+absl::StatusOr<Stroke> HibernatedStroke::Rehydrate() const {
+  return Decode(brush_, *data_);
+}
+
+void HibernatedStroke::RehydrateAsync(
+    Executor& executor,
+    absl::AnyInvocable<void(absl::StatusOr<Stroke> stroke) &&> on_done) const {
+  // The task holds its own reference to the encoded data, so that this
+  // hibernated stroke may be destroyed before the task runs.
+  executor.Schedule([brush = brush_, data = data_,
+                     on_done = std::move(on_done)]() mutable {
+    absl::StatusOr<Stroke> stroke = Decode(brush, *data);
+    if (stroke.ok()) stroke->PrefetchShape();
+    std::move(on_done)(std::move(stroke));
+  });
+}
+
+void HibernatedStroke::AddToMemoryFootprint(MemoryFootprint& footprint) const {
+  brush_.GetFamily().AddToMemoryFootprint(footprint);
+  if (!footprint.AddShared(data_.get())) return;
+  footprint.AddBytes(sizeof(EncodedData) + data_->inputs.capacity() +
+                     data_->shape.capacity());
+}
+
+absl::StatusOr<Stroke> HibernatedStroke::Decode(const Brush& brush,
+                                                const EncodedData& data) {
+  ScopedTraceEvent trace_event("ink::HibernatedStroke::Decode");
+  google::protobuf::Arena arena;
+  proto::CodedStrokeInputBatch& inputs_proto =
+      *google::protobuf::Arena::Create<proto::CodedStrokeInputBatch>(&arena);
+  if (!inputs_proto.ParseFromString(data.inputs)) {
+    return absl::DataLossError("failed to parse hibernated stroke inputs");
+  }
+  // The inputs were encoded by `Hibernate()` from a valid batch.
+  absl::StatusOr<StrokeInputBatch> inputs =
+      DecodeStrokeInputBatch(inputs_proto, {.trusted_input = true});
+  if (!inputs.ok()) return inputs.status();
+
+  if (data.shape.empty()) return Stroke::WithLazyShape(brush, *inputs);
+  proto::CodedModeledShape& shape_proto =
+      *google::protobuf::Arena::Create<proto::CodedModeledShape>(&arena);
+  if (!shape_proto.ParseFromString(data.shape)) {
+    return absl::DataLossError("failed to parse hibernated stroke shape");
+  }
+  absl::StatusOr<PartitionedMesh> shape = DecodePartitionedMesh(shape_proto);
+  if (!shape.ok()) return shape.status();
+  return Stroke(brush, *inputs, *shape);
+}
+
+}  // namespace ink
@@ -0,0 +1,117 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STORAGE_HIBERNATED_STROKE_H_
+#define INK_STORAGE_HIBERNATED_STROKE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush.h"
+#include "ink/geometry/envelope.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+#include "ink/types/memory_footprint.h"
+
+namespace ink {
+
+// A `Stroke` kept in its encoded form, for strokes that are not going to be
+// drawn or queried for a while, such as the offscreen strokes of a large
+// document.
+//
+// A hibernated stroke holds its brush, the bounds of its shape, and the
+// serialized `proto::CodedStrokeInputBatch` of its inputs, plus optionally the
+// serialized `proto::CodedModeledShape` of its shape. These are several times
+// smaller than the decoded `StrokeInputBatch` and `PartitionedMesh`. The stroke
+// is decoded again with `Rehydrate()` or `RehydrateAsync()` when it is needed,
+// e.g. once its bounds come into view.
+//
+// The encoding quantizes the inputs, and the shape if it is kept, as described
+// for `EncodeStrokeInputBatch()` and `EncodePartitionedMesh()`, so a
+// rehydrated stroke may differ from the original by that error.
+//
+// Copies of a hibernated stroke share its encoded data. This type is
+// thread-compatible, and its const methods may be called concurrently.
+class HibernatedStroke {
+ public:
+  // Encodes `stroke`. If `keep_shape` is true, its shape is encoded as well, so
+  // that rehydrating it doesn't need to regenerate the shape, at the cost of a
+  // larger encoding. This gets the shape of `stroke` for its bounds, so it
+  // generates the shape of a stroke created by `Stroke::WithLazyShape()`.
+  static HibernatedStroke Hibernate(const Stroke& stroke,
+                                    bool keep_shape = false);
+
+  HibernatedStroke(const HibernatedStroke&) = default;
+  HibernatedStroke(HibernatedStroke&&) = default;
+  HibernatedStroke& operator=(const HibernatedStroke&) = default;
+  HibernatedStroke& operator=(HibernatedStroke&&) = default;
+  ~HibernatedStroke() = default;
+
+  const Brush& GetBrush() const { return brush_; }
+
+  // Returns the bounds of the shape of the stroke when it was hibernated.
+  const Envelope& Bounds() const { return data_->bounds; }
+
+  // Returns true if the shape of the stroke was encoded as well.
+  bool HasShape() const { return !data_->shape.empty(); }
+
+  // Returns the number of bytes of encoded inputs and shape.
+  size_t EncodedBytes() const {
+    return data_->inputs.size() + data_->shape.size();
+  }
+
+  // Decodes the stroke. If its shape was not kept, the stroke is created with
+  // `Stroke::WithLazyShape()`, so its shape is regenerated on first use.
+  // Returns an error if decoding fails, which is not expected for data
+  // encoded by `Hibernate()`.
+  absl::StatusOr<Stroke> Rehydrate() const;
+
+  // Decodes the stroke in a task scheduled on `executor`, and passes it to
+  // `on_done` from that task. Unlike `Rehydrate()`, the task also generates
+  // the shape of the stroke if it was not kept, so that the stroke is ready to
+  // draw once `on_done` is called.
+  void RehydrateAsync(
+      Executor& executor,
+      absl::AnyInvocable<void(absl::StatusOr<Stroke> stroke) &&> on_done) const;
+
+  // Adds an estimate of the memory held by this hibernated stroke to
+  // `footprint`, counting its encoded data once per `footprint`, as for
+  // `Stroke::AddToMemoryFootprint()`.
+  void AddToMemoryFootprint(MemoryFootprint& footprint) const;
+
+ private:
+  struct EncodedData {
+    std::string inputs;
+    // Empty if the shape was not kept.
+    std::string shape;
+    Envelope bounds;
+  };
+
+  HibernatedStroke(const Brush& brush,
+                   std::shared_ptr<const EncodedData> data);
+
+  static absl::StatusOr<Stroke> Decode(const Brush& brush,
+                                       const EncodedData& data);
+
+  Brush brush_;
+  // Never null.
+  std::shared_ptr<const EncodedData> data_;
+};
+
+}  // namespace ink
+
+#endif  // INK_STORAGE_HIBERNATED_STROKE_H_
@@ -0,0 +1,134 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/storage/hibernated_stroke.h"
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/type_matchers.h"
+#include "ink/color/color.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/memory_footprint.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+
+Stroke MakeStroke() {
+  absl::StatusOr<Brush> brush =
+      Brush::Create(BrushFamily(), Color::Red(), 10, 0.1);
+  ABSL_CHECK_OK(brush);
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 200; ++i) {
+    inputs.push_back({.position = {static_cast<float>(i), (i % 20) * 2.f},
+                      .elapsed_time = Duration32::Millis(8 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return Stroke(*brush, *batch);
+}
+
+TEST(HibernatedStrokeTest, RehydrateWithoutShape) {
+  Stroke stroke = MakeStroke();
+  HibernatedStroke hibernated = HibernatedStroke::Hibernate(stroke);
+
+  EXPECT_FALSE(hibernated.HasShape());
+  EXPECT_THAT(hibernated.GetBrush(), BrushEq(stroke.GetBrush()));
+  ASSERT_TRUE(hibernated.Bounds().AsRect().has_value());
+  EXPECT_THAT(*hibernated.Bounds().AsRect(),
+              RectEq(*stroke.GetShape().Bounds().AsRect()));
+
+  absl::StatusOr<Stroke> rehydrated = hibernated.Rehydrate();
+  ASSERT_THAT(rehydrated, IsOk());
+  EXPECT_THAT(rehydrated->GetBrush(), BrushEq(stroke.GetBrush()));
+  EXPECT_EQ(rehydrated->GetInputs().Size(), stroke.GetInputs().Size());
+  ASSERT_TRUE(rehydrated->GetShape().Bounds().AsRect().has_value());
+  EXPECT_THAT(*rehydrated->GetShape().Bounds().AsRect(),
+              RectNear(*stroke.GetShape().Bounds().AsRect(), 0.1));
+}
+
+TEST(HibernatedStrokeTest, RehydrateWithShape) {
+  Stroke stroke = MakeStroke();
+  HibernatedStroke hibernated =
+      HibernatedStroke::Hibernate(stroke, /*keep_shape=*/true);
+
+  EXPECT_TRUE(hibernated.HasShape());
+  EXPECT_GT(hibernated.EncodedBytes(),
+            HibernatedStroke::Hibernate(stroke).EncodedBytes());
+
+  absl::StatusOr<Stroke> rehydrated = hibernated.Rehydrate();
+  ASSERT_THAT(rehydrated, IsOk());
+  EXPECT_EQ(rehydrated->GetShape().Meshes().size(),
+            stroke.GetShape().Meshes().size());
+  EXPECT_THAT(*rehydrated->GetShape().Bounds().AsRect(),
+              RectNear(*stroke.GetShape().Bounds().AsRect(), 0.1));
+}
+
+TEST(HibernatedStrokeTest, HoldsLessMemoryThanStroke) {
+  Stroke stroke = MakeStroke();
+  HibernatedStroke hibernated = HibernatedStroke::Hibernate(stroke);
+
+  MemoryFootprint stroke_footprint;
+  stroke.AddToMemoryFootprint(stroke_footprint);
+  MemoryFootprint hibernated_footprint;
+  hibernated.AddToMemoryFootprint(hibernated_footprint);
+  EXPECT_LT(hibernated_footprint.TotalBytes(), stroke_footprint.TotalBytes());
+
+  // Copies share the encoded data.
+  HibernatedStroke copy = hibernated;
+  size_t bytes = hibernated_footprint.TotalBytes();
+  copy.AddToMemoryFootprint(hibernated_footprint);
+  EXPECT_EQ(hibernated_footprint.TotalBytes(), bytes);
+}
+
+TEST(HibernatedStrokeTest, RehydrateAsync) {
+  Stroke stroke = MakeStroke();
+  std::optional<absl::StatusOr<Stroke>> result;
+  absl::Notification done;
+  {
+    ThreadPerTaskExecutor executor;
+    // The hibernated stroke is destroyed before the task runs.
+    HibernatedStroke::Hibernate(stroke).RehydrateAsync(
+        executor, [&](absl::StatusOr<Stroke> rehydrated) {
+          result = std::move(rehydrated);
+          done.Notify();
+        });
+  }
+  ASSERT_TRUE(done.HasBeenNotified());
+  ASSERT_THAT(*result, IsOk());
+  EXPECT_EQ((*result)->GetShape().Meshes().size(),
+            stroke.GetShape().Meshes().size());
+}
+
+}  // namespace
+}  // namespace ink
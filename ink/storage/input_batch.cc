@@ -76,38 +76,44 @@ void CodedStrokeInputBatchIterator::UpdateValue() {
 
 absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>>
 DecodeStrokeInputBatchProto(const proto::CodedStrokeInputBatch& input) {
-  size_t num_input_points = input.x_stroke_space().deltas_size();
-  if (input.y_stroke_space().deltas_size() != num_input_points ||
-      input.elapsed_time_seconds().deltas_size() != num_input_points ||
+  return DecodeStrokeInputBatchProtoFrom(input, 0);
+}
+
+absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>>
+DecodeStrokeInputBatchProtoFrom(const proto::CodedStrokeInputBatch& input,
+                                size_t start) {
+  size_t num_input_points = NumericRunSize(input.x_stroke_space());
+  if (NumericRunSize(input.y_stroke_space()) != num_input_points ||
+      NumericRunSize(input.elapsed_time_seconds()) != num_input_points ||
       (input.has_pressure() &&
-       input.pressure().deltas_size() != num_input_points) ||
-      (input.has_tilt() && input.tilt().deltas_size() != num_input_points) ||
+       NumericRunSize(input.pressure()) != num_input_points) ||
+      (input.has_tilt() && NumericRunSize(input.tilt()) != num_input_points) ||
       (input.has_orientation() &&
-       input.orientation().deltas_size() != num_input_points)) {
+       NumericRunSize(input.orientation()) != num_input_points)) {
     return absl::InvalidArgumentError(
         "invalid StrokeInputBatch: mismatched numeric run lengths");
   }
 
   absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
-      x_stroke_space = DecodeFloatNumericRun(input.x_stroke_space());
+      x_stroke_space = DecodeFloatNumericRunFrom(input.x_stroke_space(), start);
   if (!x_stroke_space.ok()) {
     return x_stroke_space.status();
   }
   absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
-      y_stroke_space = DecodeFloatNumericRun(input.y_stroke_space());
+      y_stroke_space = DecodeFloatNumericRunFrom(input.y_stroke_space(), start);
   if (!y_stroke_space.ok()) {
     return y_stroke_space.status();
   }
   absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
       elapsed_time_seconds =
-          DecodeFloatNumericRun(input.elapsed_time_seconds());
+          DecodeFloatNumericRunFrom(input.elapsed_time_seconds(), start);
   if (!elapsed_time_seconds.ok()) {
     return elapsed_time_seconds.status();
   }
 
   iterator_range<CodedNumericRunIterator<float>> pressure;
   if (input.has_pressure()) {
-    auto result = DecodeFloatNumericRun(input.pressure());
+    auto result = DecodeFloatNumericRunFrom(input.pressure(), start);
     if (!result.ok()) {
       return result.status();
     }
@@ -116,7 +122,7 @@ DecodeStrokeInputBatchProto(const proto::CodedStrokeInputBatch& input) {
 
   iterator_range<CodedNumericRunIterator<float>> tilt;
   if (input.has_tilt()) {
-    auto result = DecodeFloatNumericRun(input.tilt());
+    auto result = DecodeFloatNumericRunFrom(input.tilt(), start);
     if (!result.ok()) {
       return result.status();
     }
@@ -125,7 +131,7 @@ DecodeStrokeInputBatchProto(const proto::CodedStrokeInputBatch& input) {
 
   iterator_range<CodedNumericRunIterator<float>> orientation;
   if (input.has_orientation()) {
-    auto result = DecodeFloatNumericRun(input.orientation());
+    auto result = DecodeFloatNumericRunFrom(input.orientation(), start);
     if (!result.ok()) {
       return result.status();
     }
@@ -98,7 +98,8 @@ class CodedStrokeInputBatchIterator {
   ValueType value_;
 
   friend absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>>
-  DecodeStrokeInputBatchProto(const proto::CodedStrokeInputBatch& input);
+  DecodeStrokeInputBatchProtoFrom(const proto::CodedStrokeInputBatch& input,
+                                  size_t start);
 };
 
 // Given a CodedStrokeInputBatch proto, returns an iterator range over the
@@ -108,6 +109,16 @@ class CodedStrokeInputBatchIterator {
 absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>>
 DecodeStrokeInputBatchProto(const proto::CodedStrokeInputBatch& input);
 
+// Same as `DecodeStrokeInputBatchProto`, except that the returned range starts
+// at the input point with index `start`. This is much faster than skipping
+// over the points before `start` if the numeric runs of the proto have
+// checkpoints (see `StrokeInputBatchEncodingOptions::checkpoint_interval`),
+// e.g. for replaying only the end of a long stroke. Also returns an error if
+// `start` is greater than the number of input points.
+absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>>
+DecodeStrokeInputBatchProtoFrom(const proto::CodedStrokeInputBatch& input,
+                                size_t start);
+
 }  // namespace ink
 
 #endif  // INK_STORAGE_INPUT_BATCH_H_
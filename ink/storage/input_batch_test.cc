@@ -195,5 +195,42 @@ TEST(CodedStrokeInputBatchIteratorTest,
   EXPECT_THAT(non_finite_scale.message(), HasSubstr("non-finite scale"));
 }
 
+TEST(CodedStrokeInputBatchIteratorTest, DecodeStrokeInputBatchFromStart) {
+  proto::CodedStrokeInputBatch coded;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      R"pb(
+        x_stroke_space {
+          deltas: [ 1, 2, 1, 3 ]
+          checkpoints { interval: 2 cumulative_deltas: [ 3, 7 ] }
+        }
+        y_stroke_space { deltas: [ 1, -1, 1, 2 ] }
+        elapsed_time_seconds { deltas: [ 0, 1, 1, 1 ] }
+        pressure { deltas: [ 1, 1, 1, 1 ] }
+      )pb",
+      &coded));
+
+  absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>> range =
+      DecodeStrokeInputBatchProtoFrom(coded, 1);
+  ASSERT_EQ(range.status(), absl::OkStatus());
+  std::vector<CodedStrokeInputBatchIterator::ValueType> values(range->begin(),
+                                                               range->end());
+  ASSERT_EQ(values.size(), 3);
+  EXPECT_THAT(values[0].position_stroke_space, PointEq({3, 0}));
+  EXPECT_THAT(values[1].position_stroke_space, PointEq({4, 1}));
+  EXPECT_THAT(values[2].position_stroke_space, PointEq({7, 3}));
+  EXPECT_THAT(values[2].elapsed_time, Duration32Seconds(FloatEq(3)));
+  EXPECT_THAT(values[2].pressure, Optional(FloatEq(4)));
+
+  absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>> end =
+      DecodeStrokeInputBatchProtoFrom(coded, 4);
+  ASSERT_EQ(end.status(), absl::OkStatus());
+  EXPECT_THAT(*end, ElementsAre());
+
+  absl::Status past_the_end =
+      DecodeStrokeInputBatchProtoFrom(coded, 5).status();
+  EXPECT_EQ(past_the_end.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(past_the_end.message(), HasSubstr("past the end"));
+}
+
 }  // namespace
 }  // namespace ink
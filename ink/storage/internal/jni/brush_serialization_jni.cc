@@ -15,6 +15,7 @@
 #include <jni.h>
 
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -22,6 +23,7 @@
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "google/protobuf/arena.h"
 #include "ink/brush/brush.h"
 #include "ink/brush/brush_coat.h"
 #include "ink/brush/brush_family.h"
@@ -33,6 +35,7 @@
 #include "ink/jni/internal/jni_string_util.h"
 #include "ink/jni/internal/jni_throw_util.h"
 #include "ink/storage/brush.h"
+#include "ink/storage/brush_family_decode_cache.h"
 #include "ink/storage/proto/brush.pb.h"
 #include "ink/storage/proto/brush_family.pb.h"
 
@@ -41,6 +44,7 @@ namespace {
 using ::ink::Brush;
 using ::ink::BrushCoat;
 using ::ink::BrushFamily;
+using ::ink::BrushFamilyDecodeCache;
 using ::ink::BrushPaint;
 using ::ink::BrushTip;
 using ::ink::DecodeBrush;
@@ -67,23 +71,16 @@ using ::ink::jni::NewNativeBrushPaint;
 using ::ink::jni::NewNativeBrushTip;
 using ::ink::jni::ParseProtoFromEither;
 using ::ink::jni::SerializeProto;
+using ::ink::jni::SerializeProtoToBuffer;
 using ::ink::jni::StdStringToJByteArray;
 using ::ink::jni::ThrowExceptionFromStatus;
 
-}  // namespace
-
-extern "C" {
-
-JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrush)
-(JNIEnv* env, jobject object, jlong brush_native_pointer) {
-  ink::proto::Brush brush_proto;
-  EncodeBrush(CastToBrush(brush_native_pointer), brush_proto);
-  return SerializeProto(env, brush_proto);
-}
-
-JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrushFamily)
-(JNIEnv* env, jobject object, jlong brush_family_native_pointer,
- jobjectArray texture_map_keys, jobjectArray texture_map_values) {
+// Encodes the brush family, with the PNG bytes of its textures given as
+// parallel arrays of texture IDs and byte arrays.
+void EncodeBrushFamilyWithTextureMap(
+    JNIEnv* env, jlong brush_family_native_pointer,
+    jobjectArray texture_map_keys, jobjectArray texture_map_values,
+    ink::proto::BrushFamily& family_proto_out) {
   std::map<std::string, std::string> texture_map = {};
 
   jsize key_length = env->GetArrayLength(texture_map_keys);
@@ -113,29 +110,87 @@ JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrushFamily)
     return std::nullopt;
   };
 
-  ink::proto::BrushFamily brush_family_proto;
   EncodeBrushFamily(CastToBrushFamily(brush_family_native_pointer),
-                    brush_family_proto, texture_bitmap_provider);
+                    family_proto_out, texture_bitmap_provider);
+}
+
+}  // namespace
+
+extern "C" {
+
+JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrush)
+(JNIEnv* env, jobject object, jlong brush_native_pointer) {
+  google::protobuf::Arena arena;
+  ink::proto::Brush& brush_proto =
+      *google::protobuf::Arena::Create<ink::proto::Brush>(&arena);
+  EncodeBrush(CastToBrush(brush_native_pointer), brush_proto);
+  return SerializeProto(env, brush_proto);
+}
+
+JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrushFamily)
+(JNIEnv* env, jobject object, jlong brush_family_native_pointer,
+ jobjectArray texture_map_keys, jobjectArray texture_map_values) {
+  google::protobuf::Arena arena;
+  ink::proto::BrushFamily& brush_family_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushFamily>(&arena);
+  EncodeBrushFamilyWithTextureMap(env, brush_family_native_pointer,
+                                  texture_map_keys, texture_map_values,
+                                  brush_family_proto);
   return SerializeProto(env, brush_family_proto);
 }
 
+// The `serialize*ToBuffer` methods serialize straight into the given direct
+// `ByteBuffer`, starting at `offset`, and return the serialized size. If that
+// is greater than `capacity`, nothing is written.
+JNI_METHOD(storage, BrushSerializationNative, jint, serializeBrushToBuffer)
+(JNIEnv* env, jobject object, jlong brush_native_pointer,
+ jobject direct_byte_buffer, jint offset, jint capacity) {
+  google::protobuf::Arena arena;
+  ink::proto::Brush& brush_proto =
+      *google::protobuf::Arena::Create<ink::proto::Brush>(&arena);
+  EncodeBrush(CastToBrush(brush_native_pointer), brush_proto);
+  return SerializeProtoToBuffer(env, brush_proto, direct_byte_buffer, offset,
+                                capacity);
+}
+
+JNI_METHOD(storage, BrushSerializationNative, jint,
+           serializeBrushFamilyToBuffer)
+(JNIEnv* env, jobject object, jlong brush_family_native_pointer,
+ jobjectArray texture_map_keys, jobjectArray texture_map_values,
+ jobject direct_byte_buffer, jint offset, jint capacity) {
+  google::protobuf::Arena arena;
+  ink::proto::BrushFamily& brush_family_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushFamily>(&arena);
+  EncodeBrushFamilyWithTextureMap(env, brush_family_native_pointer,
+                                  texture_map_keys, texture_map_values,
+                                  brush_family_proto);
+  return SerializeProtoToBuffer(env, brush_family_proto, direct_byte_buffer,
+                                offset, capacity);
+}
+
 JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrushCoat)
 (JNIEnv* env, jobject object, jlong brush_coat_native_pointer) {
-  ink::proto::BrushCoat brush_coat_proto;
+  google::protobuf::Arena arena;
+  ink::proto::BrushCoat& brush_coat_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushCoat>(&arena);
   EncodeBrushCoat(CastToBrushCoat(brush_coat_native_pointer), brush_coat_proto);
   return SerializeProto(env, brush_coat_proto);
 }
 
 JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrushTip)
 (JNIEnv* env, jobject object, jlong brush_tip_native_pointer) {
-  ink::proto::BrushTip brush_tip_proto;
+  google::protobuf::Arena arena;
+  ink::proto::BrushTip& brush_tip_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushTip>(&arena);
   EncodeBrushTip(CastToBrushTip(brush_tip_native_pointer), brush_tip_proto);
   return SerializeProto(env, brush_tip_proto);
 }
 
 JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrushPaint)
 (JNIEnv* env, jobject object, jlong brush_paint_native_pointer) {
-  ink::proto::BrushPaint brush_paint_proto;
+  google::protobuf::Arena arena;
+  ink::proto::BrushPaint& brush_paint_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushPaint>(&arena);
   EncodeBrushPaint(CastToBrushPaint(brush_paint_native_pointer),
                    brush_paint_proto);
   return SerializeProto(env, brush_paint_proto);
@@ -144,7 +199,9 @@ JNI_METHOD(storage, BrushSerializationNative, jbyteArray, serializeBrushPaint)
 JNI_METHOD(storage, BrushSerializationNative, jlong, newBrushFromProto)
 (JNIEnv* env, jobject object, jobject brush_direct_byte_buffer,
  jbyteArray brush_byte_array, jint offset, jint length) {
-  ink::proto::Brush brush_proto;
+  google::protobuf::Arena arena;
+  ink::proto::Brush& brush_proto =
+      *google::protobuf::Arena::Create<ink::proto::Brush>(&arena);
   if (absl::Status status =
           ParseProtoFromEither(env, brush_direct_byte_buffer, brush_byte_array,
                                offset, length, brush_proto);
@@ -152,7 +209,11 @@ JNI_METHOD(storage, BrushSerializationNative, jlong, newBrushFromProto)
     ThrowExceptionFromStatus(env, status);
     return 0;
   }
-  absl::StatusOr<Brush> brush = DecodeBrush(brush_proto);
+  std::shared_ptr<BrushFamilyDecodeCache> decode_cache =
+      BrushFamilyDecodeCache::GetProcessCache();
+  absl::StatusOr<Brush> brush = decode_cache != nullptr
+                                    ? decode_cache->DecodeBrush(brush_proto)
+                                    : DecodeBrush(brush_proto);
   if (!brush.ok()) {
     ThrowExceptionFromStatus(env, brush.status());
     return 0;
@@ -165,7 +226,9 @@ JNI_METHOD(storage, BrushSerializationNative, jlong,
 (JNIEnv* env, jobject object, jobject brush_family_direct_byte_buffer,
  jbyteArray brush_family_byte_array, jint offset, jint length,
  jobject callback) {
-  ink::proto::BrushFamily brush_family_proto;
+  google::protobuf::Arena arena;
+  ink::proto::BrushFamily& brush_family_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushFamily>(&arena);
   if (absl::Status status = ParseProtoFromEither(
           env, brush_family_direct_byte_buffer, brush_family_byte_array, offset,
           length, brush_family_proto);
@@ -209,8 +272,13 @@ JNI_METHOD(storage, BrushSerializationNative, jlong,
     env->DeleteLocalRef(new_id_jstring);
     return new_id;
   };
+  std::shared_ptr<BrushFamilyDecodeCache> decode_cache =
+      BrushFamilyDecodeCache::GetProcessCache();
   absl::StatusOr<BrushFamily> brush_family =
-      DecodeBrushFamily(brush_family_proto, decode_texture_jni_wrapper);
+      decode_cache != nullptr
+          ? decode_cache->DecodeBrushFamily(brush_family_proto,
+                                            decode_texture_jni_wrapper)
+          : DecodeBrushFamily(brush_family_proto, decode_texture_jni_wrapper);
   if (!brush_family.ok()) {
     // If the callback raised an exception we want to raise that as-is
     // instead of replacing it with the status.
@@ -225,7 +293,9 @@ JNI_METHOD(storage, BrushSerializationNative, jlong,
 JNI_METHOD(storage, BrushSerializationNative, jlong, newBrushCoatFromProto)
 (JNIEnv* env, jobject object, jobject brush_coat_direct_byte_buffer,
  jbyteArray brush_coat_byte_array, jint offset, jint length) {
-  ink::proto::BrushCoat brush_coat_proto;
+  google::protobuf::Arena arena;
+  ink::proto::BrushCoat& brush_coat_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushCoat>(&arena);
   if (absl::Status status = ParseProtoFromEither(
           env, brush_coat_direct_byte_buffer, brush_coat_byte_array, offset,
           length, brush_coat_proto);
@@ -245,7 +315,9 @@ JNI_METHOD(storage, BrushSerializationNative, jlong, newBrushTipFromProto)
 (JNIEnv* env, jobject object, jobject brush_tip_direct_byte_buffer,
  jbyteArray brush_tip_byte_array, jint offset, jint length,
  jboolean throw_on_parse_error) {
-  ink::proto::BrushTip brush_tip_proto;
+  google::protobuf::Arena arena;
+  ink::proto::BrushTip& brush_tip_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushTip>(&arena);
   if (absl::Status status = ParseProtoFromEither(
           env, brush_tip_direct_byte_buffer, brush_tip_byte_array, offset,
           length, brush_tip_proto);
@@ -264,7 +336,9 @@ JNI_METHOD(storage, BrushSerializationNative, jlong, newBrushTipFromProto)
 JNI_METHOD(storage, BrushSerializationNative, jlong, newBrushPaintFromProto)
 (JNIEnv* env, jobject object, jobject brush_paint_direct_byte_buffer,
  jbyteArray brush_paint_byte_array, jint offset, jint length) {
-  ink::proto::BrushPaint brush_paint_proto;
+  google::protobuf::Arena arena;
+  ink::proto::BrushPaint& brush_paint_proto =
+      *google::protobuf::Arena::Create<ink::proto::BrushPaint>(&arena);
   if (absl::Status status = ParseProtoFromEither(
           env, brush_paint_direct_byte_buffer, brush_paint_byte_array, offset,
           length, brush_paint_proto);
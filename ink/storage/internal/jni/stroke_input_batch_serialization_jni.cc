@@ -18,6 +18,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "google/protobuf/arena.h"
 #include "ink/jni/internal/jni_defines.h"
 #include "ink/jni/internal/jni_proto_util.h"
 #include "ink/jni/internal/jni_throw_util.h"
@@ -35,6 +36,7 @@ using ::ink::jni::CastToStrokeInputBatch;
 using ::ink::jni::NewNativeStrokeInputBatch;
 using ::ink::jni::ParseProtoFromEither;
 using ::ink::jni::SerializeProto;
+using ::ink::jni::SerializeProtoToBuffer;
 using ::ink::jni::ThrowExceptionFromStatus;
 using ::ink::proto::CodedStrokeInputBatch;
 
@@ -49,7 +51,9 @@ extern "C" {
 JNI_METHOD(storage, StrokeInputBatchSerializationNative, jlong, newFromProto)
 (JNIEnv* env, jclass klass, jobject direct_byte_buffer, jbyteArray byte_array,
  jint offset, jint length) {
-  CodedStrokeInputBatch coded_input;
+  google::protobuf::Arena arena;
+  CodedStrokeInputBatch& coded_input =
+      *google::protobuf::Arena::Create<CodedStrokeInputBatch>(&arena);
   if (absl::Status status = ParseProtoFromEither(
           env, direct_byte_buffer, byte_array, offset, length, coded_input);
       !status.ok()) {
@@ -66,10 +70,28 @@ JNI_METHOD(storage, StrokeInputBatchSerializationNative, jlong, newFromProto)
 
 JNI_METHOD(storage, StrokeInputBatchSerializationNative, jbyteArray, serialize)
 (JNIEnv* env, jclass klass, jlong stroke_input_batch_native_pointer) {
-  CodedStrokeInputBatch coded_input;
+  google::protobuf::Arena arena;
+  CodedStrokeInputBatch& coded_input =
+      *google::protobuf::Arena::Create<CodedStrokeInputBatch>(&arena);
   EncodeStrokeInputBatch(
       CastToStrokeInputBatch(stroke_input_batch_native_pointer), coded_input);
   return SerializeProto(env, coded_input);
 }
 
+// Serializes straight into the given direct `ByteBuffer`, starting at `offset`,
+// and returns the serialized size. If that is greater than `capacity`, nothing
+// is written.
+JNI_METHOD(storage, StrokeInputBatchSerializationNative, jint,
+           serializeToBuffer)
+(JNIEnv* env, jclass klass, jlong stroke_input_batch_native_pointer,
+ jobject direct_byte_buffer, jint offset, jint capacity) {
+  google::protobuf::Arena arena;
+  CodedStrokeInputBatch& coded_input =
+      *google::protobuf::Arena::Create<CodedStrokeInputBatch>(&arena);
+  EncodeStrokeInputBatch(
+      CastToStrokeInputBatch(stroke_input_batch_native_pointer), coded_input);
+  return SerializeProtoToBuffer(env, coded_input, direct_byte_buffer, offset,
+                                capacity);
+}
+
 }  // extern "C"
@@ -14,17 +14,22 @@
 
 #include "ink/storage/mesh.h"
 
+#include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <optional>
+#include <utility>
 #include <vector>
 
+#include "absl/base/nullability.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
+#include "google/protobuf/repeated_field.h"
 #include "ink/geometry/internal/mesh_packing.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
@@ -34,8 +39,10 @@
 #include "ink/storage/numeric_run.h"
 #include "ink/storage/proto/coded_numeric_run.pb.h"
 #include "ink/storage/proto/mesh.pb.h"
-#include "ink/types/iterator_range.h"
+#include "ink/storage/triangle_index_codec.h"
+#include "ink/types/allocator.h"
 #include "ink/types/small_array.h"
+#include "ink/types/trace.h"
 
 namespace ink {
 namespace {
@@ -100,32 +107,15 @@ void EncodePackedMeshAttribute(const Mesh& mesh, uint32_t attribute_index,
   }
 }
 
-void EncodeUnpackedMeshAttribute(const Mesh& mesh, uint32_t attribute_index,
-                                 CodedMesh& coded_mesh) {
-  // TODO: b/294865374 - Handle flipped-triangle correction.  Possibly this
-  // function could work by (1) creating an equivalent MeshFormat using only
-  // packed attributes, (2) creating a new MutableMesh with the same data as the
-  // Mesh, but with the new format, (3) calling MutableMesh::AsMeshes to perform
-  // the packing and flipped-triangle correction, and (4) calling
-  // EncodePackedMeshPositions().
+void EncodeQuantizedMeshAttribute(
+    const Mesh& mesh, uint32_t attribute_index,
+    const MeshAttributeCodingParams& coding_params, CodedMesh& coded_mesh) {
   uint32_t vertex_count = mesh.VertexCount();
-  ABSL_DCHECK_GT(vertex_count, 0);
-  std::optional<MeshAttributeBounds> attribute_bounds =
-      mesh.AttributeBounds(attribute_index);
-  ABSL_CHECK(attribute_bounds.has_value());  // we know mesh is non-empty
-
   const MeshFormat::Attribute& attribute =
       mesh.Format().Attributes()[attribute_index];
   uint8_t component_count = MeshFormat::ComponentCount(attribute.type);
-
-  absl::StatusOr<MeshAttributeCodingParams> coding_params =
-      mesh_internal::ComputeCodingParamsForBitSizes(
-          SmallArray<uint8_t, 4>(component_count, kBitsPerUnpackedComponent),
-          *attribute_bounds);
-  ABSL_CHECK_OK(coding_params);  // Mesh type guarantees valid bounds
-
   SmallArray<CodedNumericRun*, 4> coded_components =
-      InitCodedAttributeComponents(attribute.id, *coding_params, vertex_count,
+      InitCodedAttributeComponents(attribute.id, coding_params, vertex_count,
                                    coded_mesh);
   SmallArray<int, 4> previous_integers(component_count, 0);
   for (uint32_t v = 0; v < vertex_count; ++v) {
@@ -133,17 +123,115 @@ void EncodeUnpackedMeshAttribute(const Mesh& mesh, uint32_t attribute_index,
         mesh.FloatVertexAttribute(v, attribute_index);
     for (uint8_t c = 0; c < component_count; ++c) {
       int next_integer = mesh_internal::PackSingleFloat(
-          coding_params->components[c], next_floats[c]);
+          coding_params.components[c], next_floats[c]);
       coded_components[c]->add_deltas(next_integer - previous_integers[c]);
       previous_integers[c] = next_integer;
     }
   }
 }
 
+// Returns the coding params used to quantize an attribute that isn't packed
+// into fixed-precision integers (i.e. an unpacked or half-float attribute).
+MeshAttributeCodingParams UnpackedAttributeCodingParams(
+    const Mesh& mesh, uint32_t attribute_index) {
+  ABSL_DCHECK_GT(mesh.VertexCount(), 0);
+  std::optional<MeshAttributeBounds> attribute_bounds =
+      mesh.AttributeBounds(attribute_index);
+  ABSL_CHECK(attribute_bounds.has_value());  // we know mesh is non-empty
+
+  uint8_t component_count = MeshFormat::ComponentCount(
+      mesh.Format().Attributes()[attribute_index].type);
+  absl::StatusOr<MeshAttributeCodingParams> coding_params =
+      mesh_internal::ComputeCodingParamsForBitSizes(
+          SmallArray<uint8_t, 4>(component_count, kBitsPerUnpackedComponent),
+          *attribute_bounds);
+  ABSL_CHECK_OK(coding_params);  // Mesh type guarantees valid bounds
+  return *std::move(coding_params);
+}
+
+void EncodeUnpackedMeshAttribute(const Mesh& mesh, uint32_t attribute_index,
+                                 CodedMesh& coded_mesh) {
+  // TODO: b/294865374 - Handle flipped-triangle correction.  Possibly this
+  // function could work by (1) creating an equivalent MeshFormat using only
+  // packed attributes, (2) creating a new MutableMesh with the same data as the
+  // Mesh, but with the new format, (3) calling MutableMesh::AsMeshes to perform
+  // the packing and flipped-triangle correction, and (4) calling
+  // EncodePackedMeshPositions().
+  EncodeQuantizedMeshAttribute(
+      mesh, attribute_index,
+      UnpackedAttributeCodingParams(mesh, attribute_index), coded_mesh);
+}
+
+// Encodes the attribute with the same offsets as the default encoding, but
+// with each scale widened to `max_error` if it is finer than that. Values are
+// rounded to the nearest multiple of the scale, so each decoded component is
+// within `max_error / 2` of the original.
+void EncodeMeshAttributeWithMaxError(const Mesh& mesh,
+                                     uint32_t attribute_index, float max_error,
+                                     CodedMesh& coded_mesh) {
+  const MeshFormat::Attribute& attribute =
+      mesh.Format().Attributes()[attribute_index];
+  bool is_packed =
+      MeshFormat::PackedBitsPerComponent(attribute.type).has_value();
+  MeshAttributeCodingParams coding_params =
+      is_packed ? mesh.VertexAttributeUnpackingParams(attribute_index)
+                : UnpackedAttributeCodingParams(mesh, attribute_index);
+  bool is_coarsened = false;
+  for (MeshAttributeCodingParams::ComponentCodingParams& component :
+       coding_params.components.Values()) {
+    if (component.scale < max_error) {
+      component.scale = max_error;
+      is_coarsened = true;
+    }
+  }
+  if (!is_coarsened && is_packed) {
+    // The packed integers can be copied as-is.
+    EncodePackedMeshAttribute(mesh, attribute_index, coded_mesh);
+    return;
+  }
+  EncodeQuantizedMeshAttribute(mesh, attribute_index, coding_params,
+                               coded_mesh);
+}
+
+void EncodeMeshTriangleIndexCodes(
+    const Mesh& mesh, google::protobuf::RepeatedField<uint32_t>& codes) {
+  const uint32_t triangle_count = mesh.TriangleCount();
+  std::vector<uint32_t> triangle_indices;
+  triangle_indices.reserve(triangle_count * 3);
+  for (uint32_t i = 0; i < triangle_count; ++i) {
+    std::array<uint32_t, 3> triangle = mesh.TriangleIndices(i);
+    triangle_indices.insert(triangle_indices.end(), triangle.begin(),
+                            triangle.end());
+  }
+  std::vector<uint32_t> encoded_codes;
+  EncodeTriangleIndexCodes(triangle_indices, encoded_codes);
+  codes.Assign(encoded_codes.begin(), encoded_codes.end());
+}
+
+absl::Status ValidateMeshEncodingOptions(const MeshEncodingOptions& options) {
+  if (options.max_position_error.has_value() &&
+      !(std::isfinite(*options.max_position_error) &&
+        *options.max_position_error > 0)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`max_position_error` must be finite and positive; got ",
+                     *options.max_position_error));
+  }
+  if (options.max_other_attribute_error.has_value() &&
+      !(std::isfinite(*options.max_other_attribute_error) &&
+        *options.max_other_attribute_error > 0)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "`max_other_attribute_error` must be finite and positive; got ",
+        *options.max_other_attribute_error));
+  }
+  return absl::OkStatus();
+}
+
 void EncodeMeshTriangleIndex(const Mesh& mesh,
                              CodedNumericRun& triangle_indices) {
   const uint32_t triangle_count = mesh.TriangleCount();
   triangle_indices.mutable_deltas()->Clear();
+  triangle_indices.clear_bit_packed_deltas();
+  triangle_indices.clear_checkpoints();
   triangle_indices.mutable_deltas()->Reserve(triangle_count * 3);
   int prev_triangle_index = 0;
   for (size_t i = 0; i < triangle_count; ++i) {
@@ -155,10 +243,10 @@ void EncodeMeshTriangleIndex(const Mesh& mesh,
   }
 }
 
-}  // namespace
-
-void EncodeMeshOmittingFormat(const Mesh& mesh,
-                              ink::proto::CodedMesh& coded_mesh) {
+void EncodeMeshOmittingFormatImpl(const Mesh& mesh,
+                                  const MeshEncodingOptions& options,
+                                  CodedMesh& coded_mesh) {
+  ScopedTraceEvent trace_event("ink::EncodeMesh");
   coded_mesh.Clear();
 
   const uint32_t vertex_count = mesh.VertexCount();
@@ -173,14 +261,57 @@ void EncodeMeshOmittingFormat(const Mesh& mesh,
       non_position_component_count);
   absl::Span<const MeshFormat::Attribute> attributes = format.Attributes();
   for (size_t i = 0; i < attributes.size(); ++i) {
-    if (MeshFormat::IsUnpackedType(attributes[i].type)) {
+    std::optional<float> max_error =
+        attributes[i].id == MeshFormat::AttributeId::kPosition
+            ? options.max_position_error
+            : options.max_other_attribute_error;
+    if (max_error.has_value()) {
+      EncodeMeshAttributeWithMaxError(mesh, i, *max_error, coded_mesh);
+    } else if (!MeshFormat::PackedBitsPerComponent(attributes[i].type)
+                    .has_value()) {
+      // Attributes that aren't packed into fixed-precision integers (i.e.
+      // unpacked and half-float attributes) are quantized for encoding.
       EncodeUnpackedMeshAttribute(mesh, i, coded_mesh);
     } else {
       EncodePackedMeshAttribute(mesh, i, coded_mesh);
     }
   }
 
-  EncodeMeshTriangleIndex(mesh, *coded_mesh.mutable_triangle_index());
+  if (options.vertex_checkpoint_interval > 0) {
+    AddNumericRunCheckpoints(*coded_mesh.mutable_x_stroke_space(),
+                             options.vertex_checkpoint_interval);
+    AddNumericRunCheckpoints(*coded_mesh.mutable_y_stroke_space(),
+                             options.vertex_checkpoint_interval);
+    for (CodedNumericRun& run :
+         *coded_mesh.mutable_other_attribute_components()) {
+      AddNumericRunCheckpoints(run, options.vertex_checkpoint_interval);
+    }
+  }
+
+  if (options.compress_triangle_index) {
+    EncodeMeshTriangleIndexCodes(mesh,
+                                 *coded_mesh.mutable_triangle_index_codes());
+  } else {
+    EncodeMeshTriangleIndex(mesh, *coded_mesh.mutable_triangle_index());
+  }
+}
+
+}  // namespace
+
+void EncodeMeshOmittingFormat(const Mesh& mesh,
+                              ink::proto::CodedMesh& coded_mesh) {
+  EncodeMeshOmittingFormatImpl(mesh, MeshEncodingOptions(), coded_mesh);
+}
+
+absl::Status EncodeMeshOmittingFormat(const Mesh& mesh,
+                                      const MeshEncodingOptions& options,
+                                      ink::proto::CodedMesh& coded_mesh) {
+  if (absl::Status status = ValidateMeshEncodingOptions(options);
+      !status.ok()) {
+    return status;
+  }
+  EncodeMeshOmittingFormatImpl(mesh, options, coded_mesh);
+  return absl::OkStatus();
 }
 
 void EncodeMesh(const Mesh& mesh, CodedMesh& coded_mesh) {
@@ -188,7 +319,18 @@ void EncodeMesh(const Mesh& mesh, CodedMesh& coded_mesh) {
   EncodeMeshFormat(mesh.Format(), *coded_mesh.mutable_format());
 }
 
-absl::StatusOr<Mesh> DecodeMesh(const ink::proto::CodedMesh& coded_mesh) {
+absl::Status EncodeMesh(const Mesh& mesh, const MeshEncodingOptions& options,
+                        CodedMesh& coded_mesh) {
+  if (absl::Status status = EncodeMeshOmittingFormat(mesh, options, coded_mesh);
+      !status.ok()) {
+    return status;
+  }
+  EncodeMeshFormat(mesh.Format(), *coded_mesh.mutable_format());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Mesh> DecodeMesh(const ink::proto::CodedMesh& coded_mesh,
+                                Allocator* absl_nullable allocator) {
   absl::StatusOr<MeshFormat> format = MeshFormat();
   if (coded_mesh.has_format()) {
     // TODO: b/295166196 - `IndexFormat`s will be removed soon; until then, just
@@ -199,11 +341,13 @@ absl::StatusOr<Mesh> DecodeMesh(const ink::proto::CodedMesh& coded_mesh) {
   }
   if (!format.ok()) return format.status();
 
-  return DecodeMeshUsingFormat(*format, coded_mesh);
+  return DecodeMeshUsingFormat(*format, coded_mesh, allocator);
 }
 
 absl::StatusOr<Mesh> DecodeMeshUsingFormat(
-    const MeshFormat& format, const ink::proto::CodedMesh& coded_mesh) {
+    const MeshFormat& format, const ink::proto::CodedMesh& coded_mesh,
+    Allocator* absl_nullable allocator) {
+  ScopedTraceEvent trace_event("ink::DecodeMesh");
   int total_component_count = format.TotalComponentCount();
   int non_position_component_count = total_component_count - 2;
   if (coded_mesh.other_attribute_components_size() !=
@@ -217,38 +361,34 @@ absl::StatusOr<Mesh> DecodeMeshUsingFormat(
 
   std::vector<std::vector<float>> component_vectors;
   component_vectors.reserve(total_component_count);
+  auto decode_component = [&component_vectors](
+                              const ink::proto::CodedNumericRun& run) {
+    std::vector<float>& component =
+        component_vectors.emplace_back(NumericRunSize(run));
+    return DecodeFloatNumericRunInto(run, absl::MakeSpan(component));
+  };
   int non_position_component_index = 0;
   for (const MeshFormat::Attribute& attribute : format.Attributes()) {
     if (attribute.id == MeshFormat::AttributeId::kPosition) {
       ABSL_DCHECK_EQ(MeshFormat::ComponentCount(attribute.type), 2);
 
-      absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
-          x_stroke_space = DecodeFloatNumericRun(coded_mesh.x_stroke_space());
-      if (!x_stroke_space.ok()) {
-        return x_stroke_space.status();
+      if (absl::Status status = decode_component(coded_mesh.x_stroke_space());
+          !status.ok()) {
+        return status;
       }
-      component_vectors.push_back(
-          std::vector<float>(x_stroke_space->begin(), x_stroke_space->end()));
-
-      absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
-          y_stroke_space = DecodeFloatNumericRun(coded_mesh.y_stroke_space());
-      if (!y_stroke_space.ok()) {
-        return y_stroke_space.status();
+      if (absl::Status status = decode_component(coded_mesh.y_stroke_space());
+          !status.ok()) {
+        return status;
       }
-      component_vectors.push_back(
-          std::vector<float>(y_stroke_space->begin(), y_stroke_space->end()));
     } else {
       int component_count = MeshFormat::ComponentCount(attribute.type);
       for (int i = 0; i < component_count; ++i) {
-        absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
-            component =
-                DecodeFloatNumericRun(coded_mesh.other_attribute_components(
+        if (absl::Status status =
+                decode_component(coded_mesh.other_attribute_components(
                     non_position_component_index));
-        if (!component.ok()) {
-          return component.status();
+            !status.ok()) {
+          return status;
         }
-        component_vectors.push_back(
-            std::vector<float>(component->begin(), component->end()));
         non_position_component_index += 1;
       }
     }
@@ -260,15 +400,30 @@ absl::StatusOr<Mesh> DecodeMeshUsingFormat(
     component_spans.push_back(component_vector);
   }
 
-  absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>>
-      triangle_range = DecodeIntNumericRun(coded_mesh.triangle_index());
-  if (!triangle_range.ok()) {
-    return triangle_range.status();
+  std::vector<uint32_t> triangle_indices;
+  if (!coded_mesh.triangle_index_codes().empty()) {
+    if (NumericRunSize(coded_mesh.triangle_index()) != 0) {
+      return absl::InvalidArgumentError(
+          "CodedMesh has both triangle_index and triangle_index_codes");
+    }
+    if (absl::Status status = DecodeTriangleIndexCodes(
+            coded_mesh.triangle_index_codes(), triangle_indices);
+        !status.ok()) {
+      return status;
+    }
+  } else {
+    std::vector<int32_t> decoded_indices(
+        NumericRunSize(coded_mesh.triangle_index()));
+    if (absl::Status status = DecodeIntNumericRunInto(
+            coded_mesh.triangle_index(), absl::MakeSpan(decoded_indices));
+        !status.ok()) {
+      return status;
+    }
+    triangle_indices.assign(decoded_indices.begin(), decoded_indices.end());
   }
-  std::vector<uint32_t> triangle_indices(triangle_range->begin(),
-                                         triangle_range->end());
 
-  return ink::Mesh::Create(format, component_spans, triangle_indices);
+  return ink::Mesh::Create(format, component_spans, triangle_indices,
+                           /* packing_params = */ {}, allocator);
 }
 
 }  // namespace ink
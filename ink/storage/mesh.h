@@ -15,10 +15,16 @@
 #ifndef INK_STORAGE_MESH_H_
 #define INK_STORAGE_MESH_H_
 
+#include <cstdint>
+#include <optional>
+
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/storage/proto/mesh.pb.h"
+#include "ink/types/allocator.h"
 
 namespace ink {
 
@@ -38,19 +44,67 @@ void EncodeMesh(const Mesh& mesh, ink::proto::CodedMesh& coded_mesh);
 void EncodeMeshOmittingFormat(const Mesh& mesh,
                               ink::proto::CodedMesh& coded_mesh);
 
+// Options controlling how `EncodeMesh` trades off the size of the encoding
+// against precision and compatibility. Coarser precision yields smaller
+// deltas, and so a smaller serialized proto, e.g. for thumbnails or
+// low-priority history.
+//
+// Each `max_*_error` field, if set, is the maximum absolute error of each
+// component of the corresponding encoded attribute values, relative to the
+// values returned by `Mesh::FloatVertexAttribute`. If unset, or if the default
+// encoding is already more precise than requested, attributes are encoded with
+// their default precision, which is lossless for packed attributes. Note that
+// `DecodeMesh` re-packs the decoded values according to the mesh format, which
+// may quantize them further.
+struct MeshEncodingOptions {
+  // The maximum error of each coordinate of the vertex positions, in stroke
+  // units.
+  std::optional<float> max_position_error;
+  // The maximum error of each component of every non-position attribute.
+  std::optional<float> max_other_attribute_error;
+  // Whether to encode the triangles into `CodedMesh.triangle_index_codes`,
+  // which is typically several times smaller than `CodedMesh.triangle_index`,
+  // but can't be read by `DecodeMesh` implementations that predate it.
+  bool compress_triangle_index = false;
+  // If nonzero, checkpoints are added to the numeric run of each vertex
+  // attribute component every this many vertices, so that the vertices can be
+  // decoded starting from partway through the mesh with
+  // `DecodeMeshVerticesFrom`.
+  uint32_t vertex_checkpoint_interval = 0;
+};
+
+// Same as `EncodeMesh` above, except that the mesh is encoded according to
+// `options`. Returns an error, and leaves the `CodedMesh` unchanged, if any
+// `max_*_error` field of `options` that is set is not finite and positive.
+absl::Status EncodeMesh(const Mesh& mesh, const MeshEncodingOptions& options,
+                        ink::proto::CodedMesh& coded_mesh);
+
+// Same as `EncodeMeshOmittingFormat` above, except that the mesh is encoded
+// according to `options`, as for `EncodeMesh`.
+absl::Status EncodeMeshOmittingFormat(const Mesh& mesh,
+                                      const MeshEncodingOptions& options,
+                                      ink::proto::CodedMesh& coded_mesh);
+
 // Decodes the `CodedMesh` into a Mesh. Returns an error if the proto is
 // invalid.
 //
+// The packed vertex and index bytes of the mesh are written directly into
+// memory from `allocator` (or `DefaultAllocator()` if it is null), e.g. a pool
+// owned by the renderer, or memory that is mapped for upload to the GPU. As
+// with `Mesh::Create`, it must outlive the returned mesh and all of its copies.
+//
 // This currently only handles positions, but will be expanded to more vertex
 // attributes going forward.
-absl::StatusOr<Mesh> DecodeMesh(const ink::proto::CodedMesh& coded_mesh);
+absl::StatusOr<Mesh> DecodeMesh(const ink::proto::CodedMesh& coded_mesh,
+                                Allocator* absl_nullable allocator = nullptr);
 
 // Same as `DecodeMesh` above, except that the `CodedMesh.format` field is
 // ignored, and the given MeshFormat is assumed instead. This can be used as the
 // inverse of the `EncodeMeshOmittingFormat` function above for contexts where
 // the mesh format can be deduced by other means.
 absl::StatusOr<Mesh> DecodeMeshUsingFormat(
-    const MeshFormat& format, const ink::proto::CodedMesh& coded_mesh);
+    const MeshFormat& format, const ink::proto::CodedMesh& coded_mesh,
+    Allocator* absl_nullable allocator = nullptr);
 
 }  // namespace ink
 
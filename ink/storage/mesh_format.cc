@@ -59,6 +59,14 @@ proto::MeshFormat::AttributeType EncodeMeshAttributeType(
       return proto::MeshFormat::ATTR_TYPE_FLOAT4_PACKED_IN_TWO_FLOATS;
     case MeshFormat::AttributeType::kFloat4PackedInThreeFloats:
       return proto::MeshFormat::ATTR_TYPE_FLOAT4_PACKED_IN_THREE_FLOATS;
+    case MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts:
+      return proto::MeshFormat::ATTR_TYPE_FLOAT2_PACKED_IN_TWO_UNSIGNED_SHORTS;
+    case MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts:
+      return proto::MeshFormat::ATTR_TYPE_FLOAT4_PACKED_IN_FOUR_UNSIGNED_SHORTS;
+    case MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats:
+      return proto::MeshFormat::ATTR_TYPE_FLOAT2_PACKED_IN_TWO_HALF_FLOATS;
+    case MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats:
+      return proto::MeshFormat::ATTR_TYPE_FLOAT4_PACKED_IN_FOUR_HALF_FLOATS;
   }
   ABSL_LOG(FATAL) << "Invalid AttributeType value: " << static_cast<int>(type);
 }
@@ -95,6 +103,14 @@ absl::StatusOr<MeshFormat::AttributeType> DecodeMeshAttributeType(
       return MeshFormat::AttributeType::kFloat4PackedInTwoFloats;
     case proto::MeshFormat::ATTR_TYPE_FLOAT4_PACKED_IN_THREE_FLOATS:
       return MeshFormat::AttributeType::kFloat4PackedInThreeFloats;
+    case proto::MeshFormat::ATTR_TYPE_FLOAT2_PACKED_IN_TWO_UNSIGNED_SHORTS:
+      return MeshFormat::AttributeType::kFloat2PackedInTwoUnsignedShorts;
+    case proto::MeshFormat::ATTR_TYPE_FLOAT4_PACKED_IN_FOUR_UNSIGNED_SHORTS:
+      return MeshFormat::AttributeType::kFloat4PackedInFourUnsignedShorts;
+    case proto::MeshFormat::ATTR_TYPE_FLOAT2_PACKED_IN_TWO_HALF_FLOATS:
+      return MeshFormat::AttributeType::kFloat2PackedInTwoHalfFloats;
+    case proto::MeshFormat::ATTR_TYPE_FLOAT4_PACKED_IN_FOUR_HALF_FLOATS:
+      return MeshFormat::AttributeType::kFloat4PackedInFourHalfFloats;
     default:
       return absl::InvalidArgumentError(absl::StrCat(
           "invalid ink.proto.MeshFormat.AttributeType value: ", type_proto));
@@ -15,6 +15,8 @@
 #include "ink/storage/mesh.h"
 
 #include <cstdint>
+#include <limits>
+#include <string>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -31,6 +33,7 @@
 #include "ink/geometry/type_matchers.h"
 #include "ink/storage/numeric_run.h"
 #include "ink/storage/proto/mesh.pb.h"
+#include "ink/types/allocator.h"
 #include "ink/types/iterator_range.h"
 #include "google/protobuf/text_format.h"
 
@@ -43,6 +46,7 @@ using ::ink::proto::CodedMesh;
 using ::google::protobuf::TextFormat;
 using ::testing::ElementsAre;
 using ::testing::FloatNear;
+using ::testing::HasSubstr;
 
 TEST(MeshTest, EncodeEmptyMesh) {
   // Start with a non-empty CodedMesh.
@@ -236,6 +240,200 @@ TEST(MeshTest, EncodeAndDecodeMeshWithCustomFormat) {
   EXPECT_EQ(decoded->FloatVertexAttribute(2, 1)[0], 3);
 }
 
+absl::StatusOr<Mesh> MakeMeshWithCustomAttribute(int vertex_count) {
+  absl::StatusOr<MeshFormat> format =
+      MeshFormat::Create({{MeshFormat::AttributeType::kFloat2Unpacked,
+                           MeshFormat::AttributeId::kPosition},
+                          {MeshFormat::AttributeType::kFloat1Unpacked,
+                           MeshFormat::AttributeId::kCustom0}},
+                         MeshFormat::IndexFormat::k32BitUnpacked16BitPacked);
+  if (!format.ok()) return format.status();
+  std::vector<float> position_x;
+  std::vector<float> position_y;
+  std::vector<float> custom_attr;
+  std::vector<uint32_t> triangles;
+  for (int i = 0; i < vertex_count; ++i) {
+    position_x.push_back(0.37f * i);
+    position_y.push_back(0.11f * i * (i % 2 == 0 ? 1 : -1));
+    custom_attr.push_back(1.3f * (i % 7));
+    if (i >= 2) {
+      triangles.insert(triangles.end(), {static_cast<uint32_t>(i - 2),
+                                         static_cast<uint32_t>(i - 1),
+                                         static_cast<uint32_t>(i)});
+    }
+  }
+  return Mesh::Create(*format, {position_x, position_y, custom_attr},
+                      triangles);
+}
+
+TEST(MeshTest, EncodeWithDefaultOptionsMatchesDefaultEncoding) {
+  absl::StatusOr<Mesh> mesh = MakeMeshWithCustomAttribute(50);
+  ASSERT_THAT(mesh, IsOk());
+
+  CodedMesh default_encoding;
+  EncodeMesh(*mesh, default_encoding);
+  CodedMesh encoding_with_options;
+  ASSERT_THAT(EncodeMesh(*mesh, MeshEncodingOptions(), encoding_with_options),
+              IsOk());
+  EXPECT_EQ(encoding_with_options.SerializeAsString(),
+            default_encoding.SerializeAsString());
+}
+
+TEST(MeshTest, EncodeWithMaxErrors) {
+  absl::StatusOr<Mesh> mesh = MakeMeshWithCustomAttribute(50);
+  ASSERT_THAT(mesh, IsOk());
+
+  MeshEncodingOptions options = {.max_position_error = 0.05f,
+                                 .max_other_attribute_error = 0.5f};
+  CodedMesh coarse_encoding;
+  ASSERT_THAT(EncodeMesh(*mesh, options, coarse_encoding), IsOk());
+  CodedMesh default_encoding;
+  EncodeMesh(*mesh, default_encoding);
+  EXPECT_LT(coarse_encoding.ByteSizeLong(), default_encoding.ByteSizeLong());
+
+  absl::StatusOr<Mesh> decoded = DecodeMesh(coarse_encoding);
+  ASSERT_THAT(decoded, IsOk());
+  ASSERT_EQ(decoded->VertexCount(), mesh->VertexCount());
+  for (uint32_t v = 0; v < mesh->VertexCount(); ++v) {
+    EXPECT_THAT(decoded->VertexPosition(v),
+                PointNear(mesh->VertexPosition(v), *options.max_position_error))
+        << "vertex " << v;
+    EXPECT_NEAR(decoded->FloatVertexAttribute(v, 1)[0],
+                mesh->FloatVertexAttribute(v, 1)[0],
+                *options.max_other_attribute_error)
+        << "vertex " << v;
+  }
+}
+
+TEST(MeshTest, EncodeWithMaxErrorFinerThanPackedPrecision) {
+  std::vector<float> position_x = {1, 3, 5};
+  std::vector<float> position_y = {2, 4, 6};
+  std::vector<uint32_t> triangles = {0, 1, 2};
+  absl::StatusOr<MeshFormat> format =
+      MeshFormat::Create({{MeshFormat::AttributeType::kFloat2PackedInOneFloat,
+                           MeshFormat::AttributeId::kPosition}},
+                         MeshFormat::IndexFormat::k16BitUnpacked16BitPacked);
+  ASSERT_THAT(format, IsOk());
+  absl::StatusOr<Mesh> mesh =
+      Mesh::Create(*format, {position_x, position_y}, triangles);
+  ASSERT_THAT(mesh, IsOk());
+
+  // The packed positions are already encoded losslessly by default, so a finer
+  // bound doesn't change the encoding.
+  CodedMesh default_encoding;
+  EncodeMesh(*mesh, default_encoding);
+  CodedMesh fine_encoding;
+  ASSERT_THAT(EncodeMesh(*mesh, {.max_position_error = 1e-9f}, fine_encoding),
+              IsOk());
+  EXPECT_EQ(fine_encoding.SerializeAsString(),
+            default_encoding.SerializeAsString());
+}
+
+TEST(MeshTest, EncodeWithVertexCheckpoints) {
+  absl::StatusOr<Mesh> mesh = MakeMeshWithCustomAttribute(50);
+  ASSERT_THAT(mesh, IsOk());
+
+  CodedMesh coded;
+  ASSERT_THAT(EncodeMesh(*mesh, {.vertex_checkpoint_interval = 8}, coded),
+              IsOk());
+  EXPECT_EQ(coded.x_stroke_space().checkpoints().interval(), 8);
+  EXPECT_EQ(coded.y_stroke_space().checkpoints().interval(), 8);
+  ASSERT_GT(coded.other_attribute_components_size(), 0);
+  EXPECT_EQ(coded.other_attribute_components(0).checkpoints().interval(), 8);
+
+  CodedMesh without_checkpoints;
+  EncodeMesh(*mesh, without_checkpoints);
+  absl::StatusOr<Mesh> decoded = DecodeMesh(coded);
+  ASSERT_THAT(decoded, IsOk());
+  absl::StatusOr<Mesh> decoded_without_checkpoints =
+      DecodeMesh(without_checkpoints);
+  ASSERT_THAT(decoded_without_checkpoints, IsOk());
+  ASSERT_EQ(decoded->VertexCount(), decoded_without_checkpoints->VertexCount());
+  for (uint32_t v = 0; v < decoded->VertexCount(); ++v) {
+    EXPECT_EQ(decoded->VertexPosition(v),
+              decoded_without_checkpoints->VertexPosition(v))
+        << "vertex " << v;
+  }
+}
+
+TEST(MeshTest, EncodeWithInvalidMaxErrors) {
+  absl::StatusOr<Mesh> mesh = MakeMeshWithCustomAttribute(10);
+  ASSERT_THAT(mesh, IsOk());
+  CodedMesh coded_mesh;
+  EncodeMesh(*mesh, coded_mesh);
+  std::string coded_bytes = coded_mesh.SerializeAsString();
+
+  absl::Status zero_position =
+      EncodeMesh(*mesh, {.max_position_error = 0}, coded_mesh);
+  EXPECT_EQ(zero_position.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(zero_position.message(), HasSubstr("max_position_error"));
+
+  absl::Status nan_other = EncodeMesh(
+      *mesh,
+      {.max_other_attribute_error = std::numeric_limits<float>::quiet_NaN()},
+      coded_mesh);
+  EXPECT_EQ(nan_other.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(nan_other.message(), HasSubstr("max_other_attribute_error"));
+
+  EXPECT_EQ(coded_mesh.SerializeAsString(), coded_bytes);
+}
+
+TEST(MeshTest, EncodeAndDecodeWithCompressedTriangleIndex) {
+  absl::StatusOr<Mesh> mesh = MakeMeshWithCustomAttribute(50);
+  ASSERT_THAT(mesh, IsOk());
+
+  CodedMesh compressed;
+  ASSERT_THAT(
+      EncodeMesh(*mesh, {.compress_triangle_index = true}, compressed), IsOk());
+  EXPECT_FALSE(compressed.has_triangle_index());
+  EXPECT_FALSE(compressed.triangle_index_codes().empty());
+  CodedMesh uncompressed;
+  EncodeMesh(*mesh, uncompressed);
+  EXPECT_LT(compressed.ByteSizeLong(), uncompressed.ByteSizeLong());
+
+  absl::StatusOr<Mesh> decoded = DecodeMesh(compressed);
+  ASSERT_THAT(decoded, IsOk());
+  ASSERT_EQ(decoded->TriangleCount(), mesh->TriangleCount());
+  for (uint32_t i = 0; i < mesh->TriangleCount(); ++i) {
+    EXPECT_EQ(decoded->TriangleIndices(i), mesh->TriangleIndices(i))
+        << "triangle " << i;
+  }
+}
+
+TEST(MeshTest, DecodeMeshWithBothTriangleIndexEncodings) {
+  absl::StatusOr<Mesh> mesh = MakeMeshWithCustomAttribute(10);
+  ASSERT_THAT(mesh, IsOk());
+  CodedMesh coded_mesh;
+  ASSERT_THAT(
+      EncodeMesh(*mesh, {.compress_triangle_index = true}, coded_mesh), IsOk());
+  coded_mesh.mutable_triangle_index()->add_deltas(0);
+
+  absl::Status status = DecodeMesh(coded_mesh).status();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("triangle_index_codes"));
+}
+
+TEST(MeshTest, DecodeMeshWithInvalidTriangleIndexCodes) {
+  absl::StatusOr<Mesh> mesh = MakeMeshWithCustomAttribute(10);
+  ASSERT_THAT(mesh, IsOk());
+  CodedMesh coded_mesh;
+  ASSERT_THAT(
+      EncodeMesh(*mesh, {.compress_triangle_index = true}, coded_mesh), IsOk());
+
+  // A triangle that refers to an edge that doesn't exist.
+  coded_mesh.add_triangle_index_codes(95);
+  EXPECT_EQ(DecodeMesh(coded_mesh).status().code(),
+            absl::StatusCode::kInvalidArgument);
+
+  // A triangle that refers to a vertex that doesn't exist.
+  coded_mesh.clear_triangle_index_codes();
+  for (uint32_t code : {0, 0, 0, 100}) {
+    coded_mesh.add_triangle_index_codes(code);
+  }
+  EXPECT_EQ(DecodeMesh(coded_mesh).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 TEST(MeshTest, DecodeEmptyMesh) {
   CodedMesh coded_mesh;
   absl::StatusOr<Mesh> mesh = DecodeMesh(coded_mesh);
@@ -244,6 +442,30 @@ TEST(MeshTest, DecodeEmptyMesh) {
   EXPECT_THAT(mesh->TriangleCount(), 0);
 }
 
+TEST(MeshTest, DecodeMeshIntoAllocator) {
+  absl::StatusOr<Mesh> mesh = MakeMeshWithCustomAttribute(10);
+  ASSERT_THAT(mesh, IsOk());
+  CodedMesh coded_mesh;
+  EncodeMesh(*mesh, coded_mesh);
+
+  ArenaAllocator arena;
+  absl::StatusOr<Mesh> decoded = DecodeMesh(coded_mesh, &arena);
+  ASSERT_THAT(decoded, IsOk());
+  EXPECT_GE(arena.ReservedBytes(), decoded->RawVertexData().size() +
+                                       decoded->RawIndexData().size());
+  ASSERT_EQ(decoded->VertexCount(), mesh->VertexCount());
+  for (uint32_t i = 0; i < mesh->VertexCount(); ++i) {
+    EXPECT_THAT(decoded->VertexPosition(i),
+                PointNear(mesh->VertexPosition(i), 1e-5))
+        << "vertex " << i;
+  }
+  ASSERT_EQ(decoded->TriangleCount(), mesh->TriangleCount());
+  for (uint32_t i = 0; i < mesh->TriangleCount(); ++i) {
+    EXPECT_EQ(decoded->TriangleIndices(i), mesh->TriangleIndices(i))
+        << "triangle " << i;
+  }
+}
+
 TEST(MeshTest, DecodeTriangleMesh) {
   CodedMesh coded_mesh;
   ASSERT_TRUE(TextFormat::ParseFromString(
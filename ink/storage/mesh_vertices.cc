@@ -14,6 +14,8 @@
 
 #include "ink/storage/mesh_vertices.h"
 
+#include <cstddef>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "ink/storage/numeric_run.h"
@@ -46,19 +48,24 @@ void CodedMeshVertexIterator::UpdateValue() {
 
 absl::StatusOr<iterator_range<CodedMeshVertexIterator>> DecodeMeshVertices(
     const CodedMesh& mesh) {
-  int num_vertices = mesh.x_stroke_space().deltas_size();
-  if (mesh.y_stroke_space().deltas_size() != num_vertices) {
+  return DecodeMeshVerticesFrom(mesh, 0);
+}
+
+absl::StatusOr<iterator_range<CodedMeshVertexIterator>> DecodeMeshVerticesFrom(
+    const CodedMesh& mesh, size_t start) {
+  size_t num_vertices = NumericRunSize(mesh.x_stroke_space());
+  if (NumericRunSize(mesh.y_stroke_space()) != num_vertices) {
     return absl::InvalidArgumentError(
         "invalid mesh: mismatched numeric run lengths");
   }
 
   absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
-      x_stroke_space = DecodeFloatNumericRun(mesh.x_stroke_space());
+      x_stroke_space = DecodeFloatNumericRunFrom(mesh.x_stroke_space(), start);
   if (!x_stroke_space.ok()) {
     return x_stroke_space.status();
   }
   absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
-      y_stroke_space = DecodeFloatNumericRun(mesh.y_stroke_space());
+      y_stroke_space = DecodeFloatNumericRunFrom(mesh.y_stroke_space(), start);
   if (!y_stroke_space.ok()) {
     return y_stroke_space.status();
   }
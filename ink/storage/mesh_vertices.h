@@ -77,7 +77,7 @@ class CodedMeshVertexIterator {
   strokes_internal::LegacyVertex vertex_;
 
   friend absl::StatusOr<iterator_range<CodedMeshVertexIterator>>
-  DecodeMeshVertices(const proto::CodedMesh& mesh);
+  DecodeMeshVerticesFrom(const proto::CodedMesh& mesh, size_t start);
 };
 
 // Given a CodedMesh proto, returns an iterator range over the decoded vertices.
@@ -90,6 +90,14 @@ class CodedMeshVertexIterator {
 absl::StatusOr<iterator_range<CodedMeshVertexIterator>> DecodeMeshVertices(
     const proto::CodedMesh& mesh);
 
+// Same as `DecodeMeshVertices`, except that the returned range starts at the
+// vertex with index `start`. This is much faster than skipping over the
+// vertices before `start` if the position runs of the proto have checkpoints
+// (see `MeshEncodingOptions::vertex_checkpoint_interval`). Also returns an
+// error if `start` is greater than the number of vertices.
+absl::StatusOr<iterator_range<CodedMeshVertexIterator>> DecodeMeshVerticesFrom(
+    const proto::CodedMesh& mesh, size_t start);
+
 }  // namespace ink
 
 #endif  // INK_STORAGE_MESH_VERTICES_H_
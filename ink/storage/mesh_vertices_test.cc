@@ -103,5 +103,31 @@ TEST(CodedMeshVertexIteratorTest, IteratorPostIncrement) {
   EXPECT_EQ(iter, range->end());
 }
 
+TEST(CodedMeshVertexIteratorTest, DecodeMeshVerticesFromStart) {
+  CodedMesh coded;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      R"pb(
+        triangle_index { deltas: [ 0, 1, 1 ] }
+        x_stroke_space {
+          deltas: [ 1, 2, 1 ]
+          checkpoints { interval: 2 cumulative_deltas: [ 3 ] }
+        }
+        y_stroke_space { deltas: [ 1, -1, 1 ] }
+      )pb",
+      &coded));
+
+  absl::StatusOr<iterator_range<CodedMeshVertexIterator>> range =
+      DecodeMeshVerticesFrom(coded, 2);
+  ASSERT_EQ(range.status(), absl::OkStatus());
+  std::vector<strokes_internal::LegacyVertex> vertices(range->begin(),
+                                                       range->end());
+  ASSERT_EQ(vertices.size(), 1);
+  EXPECT_THAT(vertices[0].position, PointEq({4, 1}));
+
+  absl::Status past_the_end = DecodeMeshVerticesFrom(coded, 4).status();
+  EXPECT_EQ(past_the_end.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(past_the_end.message(), HasSubstr("past the end"));
+}
+
 }  // namespace
 }  // namespace ink
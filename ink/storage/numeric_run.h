@@ -21,12 +21,52 @@
 #include <iterator>
 #include <limits>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "ink/storage/proto/coded_numeric_run.pb.h"
 #include "ink/types/iterator_range.h"
 
 namespace ink {
 
+namespace numeric_run_internal {
+
+// The number of deltas in each block of a `BitPackedDeltas` proto.
+inline constexpr size_t kBitPackedBlockSize = 128;
+
+}  // namespace numeric_run_internal
+
+// Returns the number of values in the sequence represented by `run`, whether
+// its deltas are stored in `deltas` or in `bit_packed_deltas`.
+//
+// This does not check that `run` is valid, but it never returns more values
+// than could be stored in the bytes of `run`, so it is safe to use to size a
+// buffer for decoding into before the run has been validated.
+inline size_t NumericRunSize(const proto::CodedNumericRun& run) {
+  if (!run.has_bit_packed_deltas()) return run.deltas_size();
+  // Every block takes at least one byte, and holds at most a full block of
+  // deltas.
+  return std::min<size_t>(run.bit_packed_deltas().count(),
+                          run.bit_packed_deltas().blocks().size() *
+                              numeric_run_internal::kBitPackedBlockSize);
+}
+
+namespace numeric_run_internal {
+
+// Returns the number of bytes taken up by a `BitPackedDeltas` block holding
+// `count` deltas of `bit_width` bits each, including its width byte.
+inline size_t BitPackedBlockByteSize(size_t count, int bit_width) {
+  return 1 + (count * bit_width + 7) / 8;
+}
+
+// Reads the zigzag-encoded `bit_width`-bit field that starts `bit_offset` bits
+// into `fields`, and returns the delta that it encodes. Reads only the bytes
+// that overlap the field.
+int32_t ReadBitPackedDelta(const char* fields, size_t bit_offset,
+                           int bit_width);
+
+}  // namespace numeric_run_internal
+
 // An iterator over the sequence of values represented by a CodedNumericRun
 // proto. It is expected to be used via the DecodeFloatNumericRun and
 // DecodeIntNumericRun functions below.
@@ -74,18 +114,42 @@ class CodedNumericRunIterator {
 
   // Returns true iff this iterator can be dereferenced.
   bool HasValue() const {
-    return run_ != nullptr && index_ < run_->deltas_size();
+    return run_ != nullptr && index_ < NumericRunSize(*run_);
   }
 
  private:
-  CodedNumericRunIterator(const proto::CodedNumericRun* run, size_t index)
-      : run_(run), index_(index), value_() {
+  // Creates an iterator at `index`, where `cumulative_delta` must be the sum of
+  // the deltas before `index`.
+  CodedNumericRunIterator(const proto::CodedNumericRun* run, size_t index,
+                          int64_t cumulative_delta = 0)
+      : run_(run),
+        cumulative_delta_(cumulative_delta),
+        index_(index),
+        value_() {
+    SeekBlock();
     UpdateDeltaAndValue();
   }
 
+  // When starting partway through a run with `bit_packed_deltas`, points
+  // `block_` and `bit_width_` at the block that `NextDelta()` expects to have
+  // read from last, by skipping over the blocks before it. The blocks must
+  // already have been validated.
+  void SeekBlock() {
+    if (!HasValue() || index_ == 0 || !run_->has_bit_packed_deltas()) return;
+    using numeric_run_internal::kBitPackedBlockSize;
+    // At the start of a block, `NextDelta()` moves on from the previous one.
+    size_t block_index = (index_ - 1) / kBitPackedBlockSize;
+    block_ = run_->bit_packed_deltas().blocks().data();
+    for (size_t i = 0; i < block_index; ++i) {
+      block_ += numeric_run_internal::BitPackedBlockByteSize(
+          kBitPackedBlockSize, static_cast<uint8_t>(*block_));
+    }
+    bit_width_ = static_cast<uint8_t>(*block_);
+  }
+
   void UpdateDeltaAndValue() {
     if (!HasValue()) return;
-    cumulative_delta_ += run_->deltas(index_);
+    cumulative_delta_ += NextDelta();
     if constexpr (std::numeric_limits<T>::is_integer) {
       int64_t value = static_cast<int64_t>(run_->offset()) +
                       static_cast<int64_t>(run_->scale()) * cumulative_delta_;
@@ -99,15 +163,42 @@ class CodedNumericRunIterator {
     }
   }
 
+  // Returns the delta at `index_`, which must be either 0 or one past that of
+  // the last call.
+  int32_t NextDelta() {
+    if (!run_->has_bit_packed_deltas()) return run_->deltas(index_);
+    using numeric_run_internal::kBitPackedBlockSize;
+    size_t index_in_block = index_ % kBitPackedBlockSize;
+    if (index_in_block == 0) {
+      if (index_ == 0) {
+        block_ = run_->bit_packed_deltas().blocks().data();
+      } else {
+        // Every block before the last one is full.
+        block_ += numeric_run_internal::BitPackedBlockByteSize(
+            kBitPackedBlockSize, bit_width_);
+      }
+      bit_width_ = static_cast<uint8_t>(*block_);
+    }
+    return numeric_run_internal::ReadBitPackedDelta(
+        block_ + 1, index_in_block * bit_width_, bit_width_);
+  }
+
   const proto::CodedNumericRun* run_;
   int64_t cumulative_delta_ = 0;
   size_t index_;
   T value_;
+  // The start of the current block, when reading `bit_packed_deltas`.
+  const char* block_ = nullptr;
+  int bit_width_ = 0;
 
   friend absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
   DecodeFloatNumericRun(const proto::CodedNumericRun& run);
+  friend absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
+  DecodeFloatNumericRunFrom(const proto::CodedNumericRun& run, size_t start);
   friend absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>>
   DecodeIntNumericRun(const proto::CodedNumericRun& run);
+  friend absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>>
+  DecodeIntNumericRunFrom(const proto::CodedNumericRun& run, size_t start);
 };
 
 // Given a CodedNumericRun proto representing a sequence of floating point
@@ -117,6 +208,26 @@ class CodedNumericRunIterator {
 absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
 DecodeFloatNumericRun(const proto::CodedNumericRun& run);
 
+// Same as `DecodeFloatNumericRun`, except that the returned range starts at
+// index `start` of the sequence. If `run` has `checkpoints`, decoding starts
+// from the last checkpoint at or before `start`, which is usually fewer than
+// `checkpoints.interval` values before `start`; otherwise, decoding starts from
+// the beginning of the run. Either way, the values are the same as
+// those produced by `DecodeFloatNumericRun`. Returns an error if `start` is
+// greater than `NumericRunSize(run)`, or under the same conditions as
+// `DecodeFloatNumericRun`.
+absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
+DecodeFloatNumericRunFrom(const proto::CodedNumericRun& run, size_t start);
+
+// Given a CodedNumericRun proto representing a sequence of floating point
+// numbers, decodes the whole sequence into `values`, which must have exactly
+// `NumericRunSize(run)` elements. The values are the same as those produced by
+// `DecodeFloatNumericRun`, but are computed in one tight loop, which is much
+// faster for long runs. Returns an error, leaving `values` unspecified, under
+// the same conditions as `DecodeFloatNumericRun`.
+absl::Status DecodeFloatNumericRunInto(const proto::CodedNumericRun& run,
+                                       absl::Span<float> values);
+
 // Given a CodedNumericRun proto representing a sequence of integers, returns an
 // iterator range over the decoded sequence.  The proto object must outlive the
 // returned range.  Returns an error if the proto is invalid (e.g. if it has
@@ -124,6 +235,35 @@ DecodeFloatNumericRun(const proto::CodedNumericRun& run);
 absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>>
 DecodeIntNumericRun(const proto::CodedNumericRun& run);
 
+// Same as `DecodeIntNumericRun`, except that the returned range starts at
+// index `start` of the sequence, as with `DecodeFloatNumericRunFrom`.
+absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>>
+DecodeIntNumericRunFrom(const proto::CodedNumericRun& run, size_t start);
+
+// Given a CodedNumericRun proto representing a sequence of integers, decodes
+// the whole sequence into `values`, which must have exactly
+// `NumericRunSize(run)` elements. The values are the same as those produced by
+// `DecodeIntNumericRun`. Returns an error, leaving `values` unspecified, under
+// the same conditions as `DecodeIntNumericRun`.
+absl::Status DecodeIntNumericRunInto(const proto::CodedNumericRun& run,
+                                     absl::Span<int32_t> values);
+
+// Re-encodes the deltas of `run` as `bit_packed_deltas`, without changing the
+// sequence that it represents. This typically makes the run smaller and faster
+// to decode, but readers that predate `bit_packed_deltas` will see an empty
+// run, so this should only be used for data that is known to be read by
+// up-to-date code. Does nothing if `run` has no deltas or is already bit
+// packed.
+void BitPackNumericRun(proto::CodedNumericRun& run);
+
+// Sets the `checkpoints` of `run` to record the running sum of its deltas after
+// every `interval` deltas, replacing any existing checkpoints, so that it can
+// be decoded from partway through with `DecodeFloatNumericRunFrom` or
+// `DecodeIntNumericRunFrom`. Each checkpoint takes a few bytes, so an interval
+// of a few hundred values adds little to the size of the run. CHECK-fails if
+// `interval` is zero or if the deltas of `run` are malformed.
+void AddNumericRunCheckpoints(proto::CodedNumericRun& run, uint32_t interval);
+
 // Given a pair of iterators defining a sequence of integers, populates the
 // given CodedNumericRun proto to encode that sequence.
 template <typename InputIter>
@@ -132,6 +272,8 @@ void EncodeIntNumericRun(InputIter begin, InputIter end,
   out->clear_offset();
   out->clear_scale();
   out->clear_deltas();
+  out->clear_bit_packed_deltas();
+  out->clear_checkpoints();
   out->mutable_deltas()->Reserve(std::distance(begin, end));
   int32_t previous = 0;
   while (begin != end) {
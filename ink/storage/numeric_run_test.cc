@@ -14,15 +14,22 @@
 
 #include "ink/storage/numeric_run.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <string>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
+#include "absl/base/casts.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "ink/storage/proto/coded_numeric_run.pb.h"
 #include "ink/types/iterator_range.h"
 
@@ -120,6 +127,125 @@ void DecodeFloatNumericRunDoesNotCrashOnArbitraryInput(
 }
 FUZZ_TEST(NumericRunTest, DecodeFloatNumericRunDoesNotCrashOnArbitraryInput);
 
+TEST(NumericRunTest, DecodeFloatNumericRunIntoMatchesIterator) {
+  proto::CodedNumericRun coded;
+  coded.set_scale(0.5f);
+  coded.set_offset(7.f);
+  coded.add_deltas(1);
+  coded.add_deltas(-2);
+  coded.add_deltas(3);
+  coded.add_deltas(4);
+  coded.add_deltas(5);
+  std::vector<float> values(coded.deltas_size());
+  ASSERT_EQ(DecodeFloatNumericRunInto(coded, absl::MakeSpan(values)),
+            absl::OkStatus());
+  EXPECT_THAT(values, ElementsAre(7.5, 6.5, 8, 10, 12.5));
+}
+
+TEST(NumericRunTest, DecodeFloatNumericRunIntoWithNonFiniteOffsetOrScale) {
+  for (float invalid : kNonFiniteFloats) {
+    proto::CodedNumericRun coded;
+    coded.add_deltas(1);
+    coded.set_offset(invalid);
+    std::vector<float> values(1);
+    absl::Status non_finite_offset =
+        DecodeFloatNumericRunInto(coded, absl::MakeSpan(values));
+    EXPECT_EQ(non_finite_offset.code(), absl::StatusCode::kInvalidArgument);
+    EXPECT_THAT(non_finite_offset.message(), HasSubstr("non-finite offset"));
+
+    coded.set_offset(0);
+    coded.set_scale(invalid);
+    absl::Status non_finite_scale =
+        DecodeFloatNumericRunInto(coded, absl::MakeSpan(values));
+    EXPECT_EQ(non_finite_scale.code(), absl::StatusCode::kInvalidArgument);
+    EXPECT_THAT(non_finite_scale.message(), HasSubstr("non-finite scale"));
+  }
+}
+
+void DecodeFloatNumericRunIntoMatchesIteratorOnArbitraryInput(
+    const proto::CodedNumericRun& coded) {
+  absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>> range =
+      DecodeFloatNumericRun(coded);
+  std::vector<float> values(NumericRunSize(coded));
+  absl::Status status =
+      DecodeFloatNumericRunInto(coded, absl::MakeSpan(values));
+  ASSERT_EQ(status, range.status());
+  if (!status.ok()) return;
+  std::vector<float> expected(range->begin(), range->end());
+  // Compare bit patterns, so that e.g. -0 and +0 are not considered equal.
+  ASSERT_EQ(values.size(), expected.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(absl::bit_cast<uint32_t>(values[i]),
+              absl::bit_cast<uint32_t>(expected[i]));
+  }
+}
+FUZZ_TEST(NumericRunTest,
+          DecodeFloatNumericRunIntoMatchesIteratorOnArbitraryInput);
+
+TEST(NumericRunTest, DecodeIntNumericRunIntoMatchesIterator) {
+  proto::CodedNumericRun coded;
+  coded.set_scale(2);
+  coded.set_offset(-3);
+  coded.add_deltas(1);
+  coded.add_deltas(-2);
+  coded.add_deltas(3);
+  coded.add_deltas(4);
+  coded.add_deltas(5);
+  std::vector<int32_t> values(coded.deltas_size());
+  ASSERT_EQ(DecodeIntNumericRunInto(coded, absl::MakeSpan(values)),
+            absl::OkStatus());
+  EXPECT_THAT(values, ElementsAre(-1, -5, 1, 9, 19));
+}
+
+TEST(NumericRunTest, DecodeIntNumericRunIntoClampsToInt32) {
+  proto::CodedNumericRun coded;
+  coded.add_deltas(std::numeric_limits<int32_t>::max());
+  coded.add_deltas(std::numeric_limits<int32_t>::max());
+  coded.add_deltas(std::numeric_limits<int32_t>::min());
+  coded.add_deltas(std::numeric_limits<int32_t>::min());
+  coded.add_deltas(std::numeric_limits<int32_t>::min());
+  coded.add_deltas(std::numeric_limits<int32_t>::min());
+  std::vector<int32_t> values(coded.deltas_size());
+  ASSERT_EQ(DecodeIntNumericRunInto(coded, absl::MakeSpan(values)),
+            absl::OkStatus());
+  EXPECT_THAT(values, ElementsAre(std::numeric_limits<int32_t>::max(),
+                                  std::numeric_limits<int32_t>::max(),
+                                  std::numeric_limits<int32_t>::max() - 1,
+                                  -2, std::numeric_limits<int32_t>::min(),
+                                  std::numeric_limits<int32_t>::min()));
+}
+
+TEST(NumericRunTest, DecodeIntNumericRunIntoWithNonIntegerOffsetOrScale) {
+  proto::CodedNumericRun coded;
+  coded.add_deltas(1);
+  coded.set_offset(2.5);
+  std::vector<int32_t> values(1);
+  absl::Status non_integer_offset =
+      DecodeIntNumericRunInto(coded, absl::MakeSpan(values));
+  EXPECT_EQ(non_integer_offset.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(non_integer_offset.message(), HasSubstr("non-integer offset"));
+
+  coded.set_offset(0);
+  coded.set_scale(0.5);
+  absl::Status non_integer_scale =
+      DecodeIntNumericRunInto(coded, absl::MakeSpan(values));
+  EXPECT_EQ(non_integer_scale.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(non_integer_scale.message(), HasSubstr("non-integer scale"));
+}
+
+void DecodeIntNumericRunIntoMatchesIteratorOnArbitraryInput(
+    const proto::CodedNumericRun& coded) {
+  absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>> range =
+      DecodeIntNumericRun(coded);
+  std::vector<int32_t> values(NumericRunSize(coded));
+  absl::Status status = DecodeIntNumericRunInto(coded, absl::MakeSpan(values));
+  ASSERT_EQ(status, range.status());
+  if (!status.ok()) return;
+  EXPECT_THAT(values, ElementsAreArray(range->begin(), range->end()));
+}
+FUZZ_TEST(NumericRunTest,
+          DecodeIntNumericRunIntoMatchesIteratorOnArbitraryInput);
+
 TEST(NumericRunTest, DecodeIntNumericRunWithNonIntegerOffset) {
   for (float invalid : kNonInt32Floats) {
     proto::CodedNumericRun coded;
@@ -166,6 +292,241 @@ TEST(NumericRunTest, IteratorPostIncrement) {
   EXPECT_EQ(iter, range->end());
 }
 
+TEST(NumericRunTest, BitPackNumericRunPreservesValues) {
+  proto::CodedNumericRun coded;
+  coded.set_scale(0.25f);
+  coded.set_offset(-2);
+  // Several blocks, including a partial one and one whose deltas are all zero.
+  for (int i = 0; i < 300; ++i) {
+    coded.add_deltas(i < 128 ? (i % 5) - 2 : i < 256 ? 0 : -i * 1000);
+  }
+  coded.add_deltas(std::numeric_limits<int32_t>::min());
+  coded.add_deltas(std::numeric_limits<int32_t>::max());
+  absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>> float_run =
+      DecodeFloatNumericRun(coded);
+  ASSERT_EQ(float_run.status(), absl::OkStatus());
+  std::vector<float> expected(float_run->begin(), float_run->end());
+
+  BitPackNumericRun(coded);
+  EXPECT_EQ(coded.deltas_size(), 0);
+  EXPECT_TRUE(coded.has_bit_packed_deltas());
+  EXPECT_EQ(NumericRunSize(coded), expected.size());
+
+  float_run = DecodeFloatNumericRun(coded);
+  ASSERT_EQ(float_run.status(), absl::OkStatus());
+  EXPECT_THAT(*float_run, ElementsAreArray(expected));
+  std::vector<float> values(NumericRunSize(coded));
+  ASSERT_EQ(DecodeFloatNumericRunInto(coded, absl::MakeSpan(values)),
+            absl::OkStatus());
+  EXPECT_THAT(values, ElementsAreArray(expected));
+}
+
+TEST(NumericRunTest, BitPackNumericRunUsesPerBlockWidths) {
+  proto::CodedNumericRun coded;
+  // One block of deltas that each fit in two bits once zigzag-encoded, then
+  // one block of zeros.
+  for (int i = 0; i < 128; ++i) coded.add_deltas(i % 2 == 0 ? 1 : -1);
+  for (int i = 0; i < 128; ++i) coded.add_deltas(0);
+  BitPackNumericRun(coded);
+  // Width byte plus 128 two-bit fields, then just a width byte.
+  EXPECT_EQ(coded.bit_packed_deltas().blocks().size(), 1 + 32 + 1);
+  EXPECT_EQ(coded.bit_packed_deltas().blocks()[0], 2);
+  EXPECT_EQ(coded.bit_packed_deltas().blocks()[33], 0);
+
+  std::vector<int32_t> values(NumericRunSize(coded));
+  ASSERT_EQ(DecodeIntNumericRunInto(coded, absl::MakeSpan(values)),
+            absl::OkStatus());
+  for (int i = 0; i < 256; ++i) {
+    EXPECT_EQ(values[i], i < 128 ? 1 - i % 2 : 0) << "at index " << i;
+  }
+}
+
+TEST(NumericRunTest, BitPackEmptyNumericRunDoesNothing) {
+  proto::CodedNumericRun coded;
+  BitPackNumericRun(coded);
+  EXPECT_FALSE(coded.has_bit_packed_deltas());
+}
+
+TEST(NumericRunTest, DecodeMalformedBitPackedDeltas) {
+  auto expect_invalid = [](const proto::CodedNumericRun& coded,
+                           absl::string_view message) {
+    absl::Status float_status = DecodeFloatNumericRun(coded).status();
+    EXPECT_EQ(float_status.code(), absl::StatusCode::kInvalidArgument);
+    EXPECT_THAT(float_status.message(), HasSubstr(message));
+    absl::Status int_status = DecodeIntNumericRun(coded).status();
+    EXPECT_EQ(int_status.code(), absl::StatusCode::kInvalidArgument);
+    EXPECT_THAT(int_status.message(), HasSubstr(message));
+  };
+
+  proto::CodedNumericRun both;
+  both.add_deltas(1);
+  both.mutable_bit_packed_deltas()->set_count(1);
+  both.mutable_bit_packed_deltas()->set_blocks(std::string(1, '\0'));
+  expect_invalid(both, "both `deltas` and `bit_packed_deltas` are set");
+
+  proto::CodedNumericRun truncated;
+  truncated.mutable_bit_packed_deltas()->set_count(129);
+  truncated.mutable_bit_packed_deltas()->set_blocks(std::string(1, '\0'));
+  expect_invalid(truncated, "truncated");
+  EXPECT_EQ(NumericRunSize(truncated), 128);
+
+  proto::CodedNumericRun too_wide;
+  too_wide.mutable_bit_packed_deltas()->set_count(1);
+  too_wide.mutable_bit_packed_deltas()->set_blocks(std::string(6, '\x21'));
+  expect_invalid(too_wide, "wider than 32 bits");
+
+  proto::CodedNumericRun trailing_bytes;
+  trailing_bytes.mutable_bit_packed_deltas()->set_count(1);
+  trailing_bytes.mutable_bit_packed_deltas()->set_blocks(std::string(3, '\1'));
+  expect_invalid(trailing_bytes, "does not match its count");
+}
+
+void BitPackNumericRunRoundTrip(const std::vector<int32_t>& deltas) {
+  proto::CodedNumericRun coded;
+  for (int32_t delta : deltas) coded.add_deltas(delta);
+  std::vector<int32_t> expected(NumericRunSize(coded));
+  ASSERT_EQ(DecodeIntNumericRunInto(coded, absl::MakeSpan(expected)),
+            absl::OkStatus());
+
+  BitPackNumericRun(coded);
+  absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>> int_run =
+      DecodeIntNumericRun(coded);
+  ASSERT_EQ(int_run.status(), absl::OkStatus());
+  EXPECT_THAT(*int_run, ElementsAreArray(expected));
+  std::vector<int32_t> values(NumericRunSize(coded));
+  ASSERT_EQ(DecodeIntNumericRunInto(coded, absl::MakeSpan(values)),
+            absl::OkStatus());
+  EXPECT_THAT(values, ElementsAreArray(expected));
+}
+FUZZ_TEST(NumericRunTest, BitPackNumericRunRoundTrip);
+
+TEST(NumericRunTest, AddNumericRunCheckpoints) {
+  proto::CodedNumericRun coded;
+  for (int32_t delta : {1, 2, 3, 4, 5, 6, 7}) coded.add_deltas(delta);
+  AddNumericRunCheckpoints(coded, 3);
+  EXPECT_EQ(coded.checkpoints().interval(), 3);
+  EXPECT_THAT(coded.checkpoints().cumulative_deltas(), ElementsAre(6, 21));
+
+  // Adding checkpoints again replaces the old ones.
+  AddNumericRunCheckpoints(coded, 7);
+  EXPECT_EQ(coded.checkpoints().interval(), 7);
+  EXPECT_THAT(coded.checkpoints().cumulative_deltas(), ElementsAre(28));
+}
+
+// Returns a run of `size` values whose deltas vary in magnitude, optionally
+// with checkpoints every `checkpoint_interval` values and bit-packed deltas.
+proto::CodedNumericRun MakeSeekTestRun(int size, uint32_t checkpoint_interval,
+                                       bool bit_packed) {
+  proto::CodedNumericRun coded;
+  coded.set_scale(2);
+  coded.set_offset(3);
+  for (int i = 0; i < size; ++i) {
+    coded.add_deltas((i % 11) * (i % 3 == 0 ? -100 : 7));
+  }
+  if (bit_packed) BitPackNumericRun(coded);
+  if (checkpoint_interval > 0) {
+    AddNumericRunCheckpoints(coded, checkpoint_interval);
+  }
+  return coded;
+}
+
+TEST(NumericRunTest, DecodeNumericRunFromMatchesFullDecoding) {
+  for (uint32_t checkpoint_interval : {0u, 1u, 7u, 128u, 1000u}) {
+    for (bool bit_packed : {false, true}) {
+      SCOPED_TRACE(absl::StrCat("checkpoint_interval=", checkpoint_interval,
+                                " bit_packed=", bit_packed));
+      proto::CodedNumericRun coded =
+          MakeSeekTestRun(300, checkpoint_interval, bit_packed);
+      std::vector<float> floats(NumericRunSize(coded));
+      ASSERT_EQ(DecodeFloatNumericRunInto(coded, absl::MakeSpan(floats)),
+                absl::OkStatus());
+      std::vector<int32_t> ints(NumericRunSize(coded));
+      ASSERT_EQ(DecodeIntNumericRunInto(coded, absl::MakeSpan(ints)),
+                absl::OkStatus());
+
+      for (size_t start : {0, 1, 6, 7, 8, 127, 128, 129, 256, 299, 300}) {
+        absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>>
+            float_run = DecodeFloatNumericRunFrom(coded, start);
+        ASSERT_EQ(float_run.status(), absl::OkStatus());
+        EXPECT_THAT(*float_run, ElementsAreArray(absl::MakeConstSpan(floats)
+                                                     .subspan(start)))
+            << "from " << start;
+        absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>>
+            int_run = DecodeIntNumericRunFrom(coded, start);
+        ASSERT_EQ(int_run.status(), absl::OkStatus());
+        EXPECT_THAT(*int_run,
+                    ElementsAreArray(absl::MakeConstSpan(ints).subspan(start)))
+            << "from " << start;
+      }
+    }
+  }
+}
+
+TEST(NumericRunTest, DecodeNumericRunFromWithAppendedDeltas) {
+  // Checkpoints remain valid for the start of a run that has since grown.
+  proto::CodedNumericRun coded = MakeSeekTestRun(100, 10, false);
+  for (int i = 0; i < 50; ++i) coded.add_deltas(i);
+  std::vector<float> floats(NumericRunSize(coded));
+  ASSERT_EQ(DecodeFloatNumericRunInto(coded, absl::MakeSpan(floats)),
+            absl::OkStatus());
+
+  absl::StatusOr<iterator_range<CodedNumericRunIterator<float>>> float_run =
+      DecodeFloatNumericRunFrom(coded, 135);
+  ASSERT_EQ(float_run.status(), absl::OkStatus());
+  EXPECT_THAT(*float_run,
+              ElementsAreArray(absl::MakeConstSpan(floats).subspan(135)));
+}
+
+TEST(NumericRunTest, DecodeNumericRunFromPastTheEnd) {
+  proto::CodedNumericRun coded = MakeSeekTestRun(10, 5, false);
+  absl::Status float_status = DecodeFloatNumericRunFrom(coded, 11).status();
+  EXPECT_EQ(float_status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(float_status.message(), HasSubstr("past the end"));
+  absl::Status int_status = DecodeIntNumericRunFrom(coded, 11).status();
+  EXPECT_EQ(int_status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(int_status.message(), HasSubstr("past the end"));
+}
+
+TEST(NumericRunTest, DecodeMalformedCheckpoints) {
+  proto::CodedNumericRun zero_interval = MakeSeekTestRun(10, 5, false);
+  zero_interval.mutable_checkpoints()->set_interval(0);
+  absl::Status status = DecodeFloatNumericRun(zero_interval).status();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("interval is zero"));
+
+  proto::CodedNumericRun too_many = MakeSeekTestRun(10, 5, false);
+  too_many.mutable_checkpoints()->add_cumulative_deltas(0);
+  status = DecodeIntNumericRunFrom(too_many, 0).status();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("more checkpoints"));
+}
+
+void DecodeNumericRunFromMatchesFullDecodingOnArbitraryInput(
+    const std::vector<int32_t>& deltas, uint32_t checkpoint_interval,
+    bool bit_packed, size_t start) {
+  proto::CodedNumericRun coded;
+  for (int32_t delta : deltas) coded.add_deltas(delta);
+  if (bit_packed) BitPackNumericRun(coded);
+  if (checkpoint_interval > 0) {
+    AddNumericRunCheckpoints(coded, checkpoint_interval);
+  }
+  std::vector<int32_t> ints(NumericRunSize(coded));
+  ASSERT_EQ(DecodeIntNumericRunInto(coded, absl::MakeSpan(ints)),
+            absl::OkStatus());
+  start = std::min(start, ints.size());
+  absl::StatusOr<iterator_range<CodedNumericRunIterator<int32_t>>> int_run =
+      DecodeIntNumericRunFrom(coded, start);
+  ASSERT_EQ(int_run.status(), absl::OkStatus());
+  EXPECT_THAT(*int_run,
+              ElementsAreArray(absl::MakeConstSpan(ints).subspan(start)));
+}
+FUZZ_TEST(NumericRunTest,
+          DecodeNumericRunFromMatchesFullDecodingOnArbitraryInput)
+    .WithDomains(fuzztest::Arbitrary<std::vector<int32_t>>(),
+                 fuzztest::InRange<uint32_t>(0, 300),
+                 fuzztest::Arbitrary<bool>(),
+                 fuzztest::InRange<size_t>(0, 1000));
+
 TEST(NumericRunTest, EncodeEmptyIntNumericRun) {
   std::vector<int32_t> values = {};
   proto::CodedNumericRun coded;
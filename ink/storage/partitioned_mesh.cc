@@ -18,23 +18,26 @@
 #include <utility>
 #include <vector>
 
+#include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
+#include "ink/storage/decode_options.h"
 #include "ink/storage/mesh.h"
 #include "ink/storage/mesh_format.h"
 #include "ink/storage/numeric_run.h"
 #include "ink/storage/partitioned_mesh.h"
 #include "ink/storage/proto/coded_numeric_run.pb.h"
 #include "ink/storage/proto/mesh.pb.h"
+#include "ink/types/trace.h"
 
 namespace ink {
 namespace {
 
-void EncodeOutline(absl::Span<const PartitionedMesh::VertexIndexPair> outline,
+void EncodeOutline(PartitionedMesh::OutlineView outline,
                    ink::proto::CodedNumericRun* outline_proto) {
   std::vector<uint32_t> outline_vector;
   outline_vector.reserve(outline.size());
@@ -48,12 +51,16 @@ void EncodeOutline(absl::Span<const PartitionedMesh::VertexIndexPair> outline,
 
 absl::StatusOr<std::vector<PartitionedMesh::VertexIndexPair>> DecodeOutline(
     const ink::proto::CodedNumericRun& outline_proto) {
-  auto range = DecodeIntNumericRun(outline_proto);
-  if (!range.ok()) return range.status();
+  std::vector<int32_t> decoded(NumericRunSize(outline_proto));
+  if (absl::Status status =
+          DecodeIntNumericRunInto(outline_proto, absl::MakeSpan(decoded));
+      !status.ok()) {
+    return status;
+  }
 
   std::vector<PartitionedMesh::VertexIndexPair> outline;
-  outline.reserve(outline_proto.deltas_size());
-  for (uint32_t packed : *range) {
+  outline.reserve(decoded.size());
+  for (uint32_t packed : decoded) {
     outline.push_back(PartitionedMesh::VertexIndexPair{
         .mesh_index = static_cast<uint16_t>(packed >> 16),
         .vertex_index = static_cast<uint16_t>(packed & 0xffff),
@@ -62,17 +69,35 @@ absl::StatusOr<std::vector<PartitionedMesh::VertexIndexPair>> DecodeOutline(
   return std::move(outline);
 }
 
+// Decodes `coded_mesh` with `format`, as `DecodeMeshUsingFormat()` does, into
+// memory from `options.allocator`. If `options.initialize_spatial_index` is
+// true, the mesh's position cache is built right away, while its vertex data is
+// still in the CPU cache.
+absl::StatusOr<Mesh> DecodeMeshForShape(const MeshFormat& format,
+                                        const ink::proto::CodedMesh& coded_mesh,
+                                        const DecodeOptions& options) {
+  absl::StatusOr<Mesh> mesh =
+      DecodeMeshUsingFormat(format, coded_mesh, options.allocator);
+  if (mesh.ok() && options.initialize_spatial_index) {
+    mesh->InitializePositionCache();
+  }
+  return mesh;
+}
+
 // Decodes a CodedModeledShape proto using the deprecated schema (that is,
 // specifying the `format` field for a single-group `PartitionedMesh`, rather
-// than using the `group_*` fields).
+// than using the `group_*` fields). See `DecodeMeshForShape()` for how
+// `options` is used.
 absl::StatusOr<PartitionedMesh> DecodePartitionedMeshGroupless(
-    const ink::proto::CodedModeledShape& shape_proto) {
+    const ink::proto::CodedModeledShape& shape_proto,
+    const DecodeOptions& options) {
   absl::StatusOr<MeshFormat> format = MeshFormat();
 
   std::vector<Mesh> meshes;
   meshes.reserve(shape_proto.meshes_size());
   for (const ink::proto::CodedMesh& coded_mesh : shape_proto.meshes()) {
-    absl::StatusOr<Mesh> mesh = DecodeMeshUsingFormat(*format, coded_mesh);
+    absl::StatusOr<Mesh> mesh =
+        DecodeMeshForShape(*format, coded_mesh, options);
     if (!mesh.ok()) return mesh.status();
     meshes.push_back(*std::move(mesh));
   }
@@ -96,44 +121,12 @@ absl::StatusOr<PartitionedMesh> DecodePartitionedMeshGroupless(
   return PartitionedMesh::FromMeshes(absl::MakeSpan(meshes), outline_spans);
 }
 
-}  // namespace
-
-void EncodePartitionedMesh(const PartitionedMesh& shape,
-                           ink::proto::CodedModeledShape& shape_proto) {
-  uint32_t num_groups = shape.RenderGroupCount();
-
-  uint32_t total_meshes = 0;
-  uint32_t total_outlines = 0;
-  for (uint32_t group_index = 0; group_index < num_groups; ++group_index) {
-    total_meshes += shape.RenderGroupMeshes(group_index).size();
-    total_outlines += shape.OutlineCount(group_index);
-  }
-
-  shape_proto.Clear();
-  shape_proto.mutable_meshes()->Reserve(total_meshes);
-  shape_proto.mutable_outlines()->Reserve(total_outlines);
-  shape_proto.mutable_group_formats()->Reserve(num_groups);
-  shape_proto.mutable_group_first_mesh_indices()->Reserve(num_groups);
-  shape_proto.mutable_group_first_outline_indices()->Reserve(num_groups);
-  for (uint32_t group_index = 0; group_index < num_groups; ++group_index) {
-    shape_proto.add_group_first_mesh_indices(shape_proto.meshes_size());
-    shape_proto.add_group_first_outline_indices(shape_proto.outlines_size());
-    EncodeMeshFormat(shape.RenderGroupFormat(group_index),
-                     *shape_proto.add_group_formats());
-    for (const Mesh& mesh : shape.RenderGroupMeshes(group_index)) {
-      EncodeMeshOmittingFormat(mesh, *shape_proto.add_meshes());
-    }
-    const uint32_t num_outlines = shape.OutlineCount(group_index);
-    for (uint32_t outline_index = 0; outline_index < num_outlines;
-         ++outline_index) {
-      EncodeOutline(shape.Outline(group_index, outline_index),
-                    shape_proto.add_outlines());
-    }
-  }
-}
-
-absl::StatusOr<PartitionedMesh> DecodePartitionedMesh(
-    const ink::proto::CodedModeledShape& shape_proto) {
+// Decodes the `CodedModeledShape` proto into a `PartitionedMesh`, without
+// initializing its spatial index. See `DecodeMeshForShape()` for how `options`
+// is used.
+absl::StatusOr<PartitionedMesh> DecodePartitionedMeshIgnoringSpatialIndex(
+    const ink::proto::CodedModeledShape& shape_proto,
+    const DecodeOptions& options) {
   const int num_groups = shape_proto.group_formats_size();
   const int num_meshes = shape_proto.meshes_size();
   const int num_outlines = shape_proto.outlines_size();
@@ -148,7 +141,7 @@ absl::StatusOr<PartitionedMesh> DecodePartitionedMesh(
     if (num_meshes > 0) {
       // There are meshes, but no render groups, so use the deprecated `format`
       // field and put all meshes into a single render group with that format.
-      return DecodePartitionedMeshGroupless(shape_proto);
+      return DecodePartitionedMeshGroupless(shape_proto, options);
     }
   } else {
     if (shape_proto.group_first_mesh_indices(0) != 0) {
@@ -215,7 +208,7 @@ absl::StatusOr<PartitionedMesh> DecodePartitionedMesh(
     for (uint32_t mesh_index = mesh_index_start; mesh_index < mesh_index_end;
          ++mesh_index) {
       absl::StatusOr<Mesh> mesh =
-          DecodeMeshUsingFormat(*format, shape_proto.meshes(mesh_index));
+          DecodeMeshForShape(*format, shape_proto.meshes(mesh_index), options);
       if (!mesh.ok()) return mesh.status();
       meshes.push_back(*std::move(mesh));
     }
@@ -244,4 +237,136 @@ absl::StatusOr<PartitionedMesh> DecodePartitionedMesh(
   return PartitionedMesh::FromMeshGroups(absl::MakeConstSpan(groups));
 }
 
+// Initializes the spatial index of `shape` from `index_proto`. Returns an error
+// if `index_proto` does not describe a valid index for `shape`.
+absl::Status DecodeSpatialIndex(
+    const ink::proto::CodedSpatialIndex& index_proto,
+    const PartitionedMesh& shape) {
+  PartitionedMesh::SpatialIndexStructure structure;
+  structure.node_is_leaf_parent.assign(
+      index_proto.node_is_leaf_parent().begin(),
+      index_proto.node_is_leaf_parent().end());
+  structure.node_child_counts.assign(index_proto.node_child_counts().begin(),
+                                     index_proto.node_child_counts().end());
+  structure.child_indices.assign(index_proto.child_indices().begin(),
+                                 index_proto.child_indices().end());
+  if (absl::Status status =
+          shape.InitializeSpatialIndexFromStructure(structure);
+      !status.ok()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid `CodedModeledShape.spatial_index`: ", status.message()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+namespace {
+
+// Encodes `shape` into `shape_proto`, encoding each mesh according to
+// `options`, which must already be valid.
+void EncodePartitionedMeshImpl(const PartitionedMesh& shape,
+                               const MeshEncodingOptions& options,
+                               ink::proto::CodedModeledShape& shape_proto) {
+  ScopedTraceEvent trace_event("ink::EncodePartitionedMesh");
+  uint32_t num_groups = shape.RenderGroupCount();
+
+  uint32_t total_meshes = 0;
+  uint32_t total_outlines = 0;
+  for (uint32_t group_index = 0; group_index < num_groups; ++group_index) {
+    total_meshes += shape.RenderGroupMeshes(group_index).size();
+    total_outlines += shape.OutlineCount(group_index);
+  }
+
+  shape_proto.Clear();
+  shape_proto.mutable_meshes()->Reserve(total_meshes);
+  shape_proto.mutable_outlines()->Reserve(total_outlines);
+  shape_proto.mutable_group_formats()->Reserve(num_groups);
+  shape_proto.mutable_group_first_mesh_indices()->Reserve(num_groups);
+  shape_proto.mutable_group_first_outline_indices()->Reserve(num_groups);
+  for (uint32_t group_index = 0; group_index < num_groups; ++group_index) {
+    shape_proto.add_group_first_mesh_indices(shape_proto.meshes_size());
+    shape_proto.add_group_first_outline_indices(shape_proto.outlines_size());
+    EncodeMeshFormat(shape.RenderGroupFormat(group_index),
+                     *shape_proto.add_group_formats());
+    for (const Mesh& mesh : shape.RenderGroupMeshes(group_index)) {
+      absl::Status status =
+          EncodeMeshOmittingFormat(mesh, options, *shape_proto.add_meshes());
+      ABSL_DCHECK_OK(status);
+    }
+    const uint32_t num_outlines = shape.OutlineCount(group_index);
+    for (uint32_t outline_index = 0; outline_index < num_outlines;
+         ++outline_index) {
+      EncodeOutline(shape.Outline(group_index, outline_index),
+                    shape_proto.add_outlines());
+    }
+  }
+}
+
+}  // namespace
+
+void EncodePartitionedMesh(const PartitionedMesh& shape,
+                           ink::proto::CodedModeledShape& shape_proto) {
+  EncodePartitionedMeshImpl(shape, MeshEncodingOptions(), shape_proto);
+}
+
+absl::Status EncodePartitionedMesh(const PartitionedMesh& shape,
+                                   const MeshEncodingOptions& options,
+                                   ink::proto::CodedModeledShape& shape_proto) {
+  // Validate the options up front by encoding an empty mesh, so that
+  // `shape_proto` is left unchanged if they are invalid.
+  ink::proto::CodedMesh empty_mesh_proto;
+  if (absl::Status status =
+          EncodeMeshOmittingFormat(Mesh(), options, empty_mesh_proto);
+      !status.ok()) {
+    return status;
+  }
+  EncodePartitionedMeshImpl(shape, options, shape_proto);
+  return absl::OkStatus();
+}
+
+void EncodePartitionedMeshSpatialIndex(
+    const PartitionedMesh& shape, ink::proto::CodedModeledShape& shape_proto) {
+  ScopedTraceEvent trace_event("ink::EncodePartitionedMeshSpatialIndex");
+  PartitionedMesh::SpatialIndexStructure structure =
+      shape.GetSpatialIndexStructure();
+  ink::proto::CodedSpatialIndex* index_proto =
+      shape_proto.mutable_spatial_index();
+  index_proto->Clear();
+  index_proto->mutable_node_is_leaf_parent()->Reserve(
+      structure.node_is_leaf_parent.size());
+  for (bool is_leaf_parent : structure.node_is_leaf_parent) {
+    index_proto->add_node_is_leaf_parent(is_leaf_parent);
+  }
+  index_proto->mutable_node_child_counts()->Add(
+      structure.node_child_counts.begin(), structure.node_child_counts.end());
+  index_proto->mutable_child_indices()->Add(structure.child_indices.begin(),
+                                            structure.child_indices.end());
+}
+
+absl::StatusOr<PartitionedMesh> DecodePartitionedMesh(
+    const ink::proto::CodedModeledShape& shape_proto) {
+  return DecodePartitionedMesh(shape_proto, DecodeOptions());
+}
+
+absl::StatusOr<PartitionedMesh> DecodePartitionedMesh(
+    const ink::proto::CodedModeledShape& shape_proto,
+    const DecodeOptions& options) {
+  ScopedTraceEvent trace_event("ink::DecodePartitionedMesh");
+  absl::StatusOr<PartitionedMesh> shape =
+      DecodePartitionedMeshIgnoringSpatialIndex(shape_proto, options);
+  if (!shape.ok()) return shape.status();
+
+  if (shape_proto.has_spatial_index()) {
+    if (absl::Status status =
+            DecodeSpatialIndex(shape_proto.spatial_index(), *shape);
+        !status.ok()) {
+      return status;
+    }
+  } else if (options.initialize_spatial_index) {
+    shape->InitializeSpatialIndex();
+  }
+  return shape;
+}
+
 }  // namespace ink
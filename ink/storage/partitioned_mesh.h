@@ -15,8 +15,11 @@
 #ifndef INK_STORAGE_PARTITIONED_MESH_H_
 #define INK_STORAGE_PARTITIONED_MESH_H_
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/storage/decode_options.h"
+#include "ink/storage/mesh.h"
 #include "ink/storage/proto/mesh.pb.h"
 
 namespace ink {
@@ -29,11 +32,36 @@ namespace ink {
 void EncodePartitionedMesh(const PartitionedMesh& shape,
                            ink::proto::CodedModeledShape& shape_proto);
 
-// Decodes the `CodedModeledShape` proto into a `PartitionedMesh`. Returns an
-// error if the proto is invalid.
+// Same as `EncodePartitionedMesh` above, except that each mesh is encoded
+// according to `options`, as for `EncodeMesh`. Returns an error, and leaves the
+// `CodedModeledShape` proto unchanged, if `options` is invalid.
+absl::Status EncodePartitionedMesh(const PartitionedMesh& shape,
+                                   const MeshEncodingOptions& options,
+                                   ink::proto::CodedModeledShape& shape_proto);
+
+// Populates `shape_proto.spatial_index` with the structure of the spatial
+// index of `shape`, initializing the index first if needed. This is meant to be
+// called after `EncodePartitionedMesh`, so that `DecodePartitionedMesh` can
+// restore the index instead of rebuilding it the first time the shape is
+// queried, at the cost of a larger encoding.
+void EncodePartitionedMeshSpatialIndex(
+    const PartitionedMesh& shape, ink::proto::CodedModeledShape& shape_proto);
+
+// Decodes the `CodedModeledShape` proto into a `PartitionedMesh`. If
+// `shape_proto.spatial_index` is present, the decoded `PartitionedMesh`'s
+// spatial index is initialized from it. Returns an error if the proto is
+// invalid.
 absl::StatusOr<PartitionedMesh> DecodePartitionedMesh(
     const ink::proto::CodedModeledShape& shape_proto);
 
+// Same as `DecodePartitionedMesh()` above. If
+// `options.initialize_spatial_index` is true, the spatial index is initialized
+// while decoding, from `shape_proto.spatial_index` if present and otherwise by
+// building it; see `DecodeOptions`.
+absl::StatusOr<PartitionedMesh> DecodePartitionedMesh(
+    const ink::proto::CodedModeledShape& shape_proto,
+    const DecodeOptions& options);
+
 }  // namespace ink
 
 #endif  // INK_STORAGE_PARTITIONED_MESH_H_
@@ -25,11 +25,16 @@
 #include "absl/types/span.h"
 #include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/rect.h"
 #include "ink/geometry/type_matchers.h"
+#include "ink/storage/decode_options.h"
+#include "ink/storage/mesh.h"
 #include "ink/storage/mesh_format.h"
 #include "ink/storage/numeric_run.h"
 #include "ink/storage/partitioned_mesh.h"
 #include "ink/storage/proto/mesh.pb.h"
+#include "ink/types/allocator.h"
 #include "ink/types/iterator_range.h"
 #include "google/protobuf/text_format.h"
 
@@ -39,8 +44,10 @@ namespace {
 using ::ink::proto::CodedModeledShape;
 using ::google::protobuf::TextFormat;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
+using ::testing::Not;
 using ::testing::SizeIs;
 
 MATCHER_P2(VertexIndexPairEq, mesh_index, vertex_index, "") {
@@ -395,6 +402,174 @@ TEST(PartitionedMeshTest, DecodePartitionedMeshWithTwoGroups) {
                           VertexIndexPairEq(0, 1)));
 }
 
+TEST(PartitionedMeshTest, EncodeAndDecodePartitionedMeshWithSpatialIndex) {
+  MeshFormat format;
+  absl::StatusOr<Mesh> mesh0 =
+      Mesh::Create(format, {{0, 1, 1, 2}, {0, 0, 1, 1}}, {0, 1, 2, 1, 3, 2});
+  ASSERT_EQ(mesh0.status(), absl::OkStatus());
+  absl::StatusOr<Mesh> mesh1 =
+      Mesh::Create(format, {{5, 6, 6}, {5, 5, 6}}, {0, 1, 2});
+  ASSERT_EQ(mesh1.status(), absl::OkStatus());
+  std::vector<Mesh> meshes;
+  meshes.push_back(*std::move(mesh0));
+  meshes.push_back(*std::move(mesh1));
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMeshes(absl::MakeSpan(meshes));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  CodedModeledShape shape_proto;
+  EncodePartitionedMesh(*shape, shape_proto);
+  EXPECT_FALSE(shape_proto.has_spatial_index());
+  EncodePartitionedMeshSpatialIndex(*shape, shape_proto);
+  ASSERT_TRUE(shape_proto.has_spatial_index());
+
+  PartitionedMesh::SpatialIndexStructure structure =
+      shape->GetSpatialIndexStructure();
+  EXPECT_THAT(shape_proto.spatial_index().node_is_leaf_parent(),
+              ElementsAreArray(structure.node_is_leaf_parent));
+  EXPECT_THAT(shape_proto.spatial_index().node_child_counts(),
+              ElementsAreArray(structure.node_child_counts));
+  EXPECT_THAT(shape_proto.spatial_index().child_indices(),
+              ElementsAreArray(structure.child_indices));
+
+  absl::StatusOr<PartitionedMesh> decoded = DecodePartitionedMesh(shape_proto);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_TRUE(decoded->IsSpatialIndexInitialized());
+  EXPECT_GT(decoded->Coverage(
+                Rect::FromCenterAndDimensions(Point{5.75, 5.25}, 0.1, 0.1)),
+            0);
+  EXPECT_EQ(
+      decoded->Coverage(Rect::FromCenterAndDimensions(Point{3, 3}, 0.1, 0.1)),
+      0);
+}
+
+TEST(PartitionedMeshTest, EncodeAndDecodeWithCompressedTriangleIndex) {
+  MeshFormat format;
+  absl::StatusOr<Mesh> mesh0 =
+      Mesh::Create(format, {{0, 1, 1, 2}, {0, 0, 1, 1}}, {0, 1, 2, 1, 3, 2});
+  ASSERT_EQ(mesh0.status(), absl::OkStatus());
+  absl::StatusOr<Mesh> mesh1 =
+      Mesh::Create(format, {{5, 6, 6}, {5, 5, 6}}, {0, 1, 2});
+  ASSERT_EQ(mesh1.status(), absl::OkStatus());
+  std::vector<Mesh> meshes;
+  meshes.push_back(*std::move(mesh0));
+  meshes.push_back(*std::move(mesh1));
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMeshes(absl::MakeSpan(meshes));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  CodedModeledShape shape_proto;
+  ASSERT_EQ(EncodePartitionedMesh(*shape, {.compress_triangle_index = true},
+                                  shape_proto),
+            absl::OkStatus());
+  ASSERT_THAT(shape_proto.meshes(), SizeIs(2));
+  for (const proto::CodedMesh& mesh_proto : shape_proto.meshes()) {
+    EXPECT_FALSE(mesh_proto.has_triangle_index());
+    EXPECT_THAT(mesh_proto.triangle_index_codes(), Not(IsEmpty()));
+  }
+
+  absl::StatusOr<PartitionedMesh> decoded = DecodePartitionedMesh(shape_proto);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  ASSERT_THAT(decoded->Meshes(), SizeIs(2));
+  EXPECT_THAT(decoded->Meshes()[0], MeshEq(shape->Meshes()[0]));
+  EXPECT_THAT(decoded->Meshes()[1], MeshEq(shape->Meshes()[1]));
+}
+
+TEST(PartitionedMeshTest, EncodePartitionedMeshWithInvalidOptions) {
+  CodedModeledShape shape_proto;
+  shape_proto.add_meshes();
+  absl::Status status = EncodePartitionedMesh(
+      PartitionedMesh(), {.max_position_error = -1}, shape_proto);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("max_position_error"));
+  EXPECT_THAT(shape_proto.meshes(), SizeIs(1));
+}
+
+TEST(PartitionedMeshTest, DecodePartitionedMeshWithoutSpatialIndex) {
+  absl::StatusOr<Mesh> mesh =
+      Mesh::Create(MeshFormat(), {{0, 1, 1}, {0, 0, 1}}, {0, 1, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMeshes(absl::MakeSpan(&*mesh, 1));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  CodedModeledShape shape_proto;
+  EncodePartitionedMesh(*shape, shape_proto);
+
+  absl::StatusOr<PartitionedMesh> decoded = DecodePartitionedMesh(shape_proto);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_FALSE(decoded->IsSpatialIndexInitialized());
+}
+
+TEST(PartitionedMeshTest, DecodePartitionedMeshInitializingSpatialIndex) {
+  absl::StatusOr<Mesh> mesh =
+      Mesh::Create(MeshFormat(), {{0, 1, 1}, {0, 0, 1}}, {0, 1, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMeshes(absl::MakeSpan(&*mesh, 1));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  CodedModeledShape shape_proto;
+  EncodePartitionedMesh(*shape, shape_proto);
+
+  absl::StatusOr<PartitionedMesh> decoded =
+      DecodePartitionedMesh(shape_proto, {.initialize_spatial_index = true});
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_TRUE(decoded->IsSpatialIndexInitialized());
+  ASSERT_THAT(decoded->Meshes(), SizeIs(1));
+  EXPECT_TRUE(decoded->Meshes()[0].IsPositionCacheInitialized());
+  EXPECT_GT(decoded->Coverage(
+                Rect::FromCenterAndDimensions(Point{0.75, 0.25}, 0.1, 0.1)),
+            0);
+  EXPECT_EQ(
+      decoded->Coverage(Rect::FromCenterAndDimensions(Point{3, 3}, 0.1, 0.1)),
+      0);
+}
+
+TEST(PartitionedMeshTest, DecodePartitionedMeshIntoAllocator) {
+  absl::StatusOr<Mesh> mesh =
+      Mesh::Create(MeshFormat(), {{0, 1, 1}, {0, 0, 1}}, {0, 1, 2});
+  ASSERT_EQ(mesh.status(), absl::OkStatus());
+  absl::StatusOr<PartitionedMesh> shape =
+      PartitionedMesh::FromMeshes(absl::MakeSpan(&*mesh, 1));
+  ASSERT_EQ(shape.status(), absl::OkStatus());
+
+  CodedModeledShape shape_proto;
+  EncodePartitionedMesh(*shape, shape_proto);
+
+  ArenaAllocator arena;
+  absl::StatusOr<PartitionedMesh> decoded =
+      DecodePartitionedMesh(shape_proto, {.allocator = &arena});
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  ASSERT_THAT(decoded->Meshes(), SizeIs(1));
+  EXPECT_GE(arena.ReservedBytes(),
+            decoded->Meshes()[0].RawVertexData().size() +
+                decoded->Meshes()[0].RawIndexData().size());
+  EXPECT_EQ(decoded->Meshes()[0].VertexPosition(1), (Point{1, 0}));
+}
+
+TEST(PartitionedMeshTest, DecodePartitionedMeshWithInvalidSpatialIndex) {
+  CodedModeledShape shape_proto;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      R"pb(
+        meshes {
+          x_stroke_space { deltas: [ 0, 1, 0 ] }
+          y_stroke_space { deltas: [ 0, 0, 1 ] }
+          triangle_index { deltas: [ 0, 1, 1 ] }
+        }
+        spatial_index {
+          node_is_leaf_parent: true
+          node_child_counts: 1
+          child_indices: 1
+        }
+      )pb",
+      &shape_proto));
+
+  absl::StatusOr<PartitionedMesh> shape = DecodePartitionedMesh(shape_proto);
+  EXPECT_EQ(shape.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(shape.status().message(), HasSubstr("spatial_index"));
+}
+
 void DecodePartitionedMeshDoesNotCrashOnArbitraryInput(
     const CodedModeledShape& shape_proto) {
   DecodePartitionedMesh(shape_proto).IgnoreError();
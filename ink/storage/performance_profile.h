@@ -0,0 +1,36 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STORAGE_PERFORMANCE_PROFILE_H_
+#define INK_STORAGE_PERFORMANCE_PROFILE_H_
+
+#include "ink/storage/mesh.h"
+#include "ink/storage/stroke_input_batch.h"
+#include "ink/strokes/performance_profile.h"
+
+namespace ink {
+
+// Returns the options for `EncodeMesh()` and `EncodePartitionedMesh()` given by
+// the storage settings of `profile`.
+MeshEncodingOptions MeshEncodingOptionsForProfile(
+    const PerformanceProfile& profile);
+
+// Returns the options for `EncodeStrokeInputBatch()` given by the storage
+// settings of `profile`.
+StrokeInputBatchEncodingOptions StrokeInputBatchEncodingOptionsForProfile(
+    const PerformanceProfile& profile);
+
+}  // namespace ink
+
+#endif  // INK_STORAGE_PERFORMANCE_PROFILE_H_
@@ -0,0 +1,55 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/storage/performance_profile.h"
+
+#include "gtest/gtest.h"
+#include "ink/storage/mesh.h"
+#include "ink/storage/stroke_input_batch.h"
+#include "ink/strokes/performance_profile.h"
+
+namespace ink {
+namespace {
+
+TEST(PerformanceProfileTest, DefaultProfileGivesDefaultOptions) {
+  PerformanceProfile profile;
+
+  MeshEncodingOptions mesh_options = MeshEncodingOptionsForProfile(profile);
+  EXPECT_FALSE(mesh_options.max_position_error.has_value());
+  EXPECT_FALSE(mesh_options.max_other_attribute_error.has_value());
+  EXPECT_FALSE(mesh_options.compress_triangle_index);
+  EXPECT_EQ(mesh_options.vertex_checkpoint_interval, 0);
+
+  StrokeInputBatchEncodingOptions input_options =
+      StrokeInputBatchEncodingOptionsForProfile(profile);
+  EXPECT_FALSE(input_options.max_position_error.has_value());
+  EXPECT_EQ(input_options.checkpoint_interval, 0);
+}
+
+TEST(PerformanceProfileTest, OptionsFollowStorageSettings) {
+  PerformanceProfile profile;
+  profile.max_encoded_position_error = 0.01f;
+  profile.compress_triangle_index = true;
+
+  MeshEncodingOptions mesh_options = MeshEncodingOptionsForProfile(profile);
+  EXPECT_EQ(mesh_options.max_position_error, 0.01f);
+  EXPECT_TRUE(mesh_options.compress_triangle_index);
+
+  EXPECT_EQ(StrokeInputBatchEncodingOptionsForProfile(profile)
+                .max_position_error,
+            0.01f);
+}
+
+}  // namespace
+}  // namespace ink
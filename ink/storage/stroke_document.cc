@@ -0,0 +1,640 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/storage/stroke_document.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream.h"
+#include "google/protobuf/map.h"
+#include "google/protobuf/repeated_field.h"
+#include "google/protobuf/repeated_ptr_field.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_family.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/rect.h"
+#include "ink/storage/brush.h"
+#include "ink/storage/color.h"
+#include "ink/storage/partitioned_mesh.h"
+#include "ink/storage/proto/brush_family.pb.h"
+#include "ink/storage/proto/coded_numeric_run.pb.h"
+#include "ink/storage/proto/mesh.pb.h"
+#include "ink/storage/proto/stroke_document.pb.h"
+#include "ink/storage/proto/stroke_input_batch.pb.h"
+#include "ink/storage/stroke_input_batch.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+#include "ink/types/trace.h"
+
+namespace ink {
+namespace {
+
+// The number of strokes encoded or decoded by each task on an `Executor`.
+constexpr size_t kStrokesPerTask = 8;
+
+// The number of strokes that `WriteStrokeDocument()` encodes before writing
+// them out.
+constexpr size_t kStrokesPerWriteBatch = 256;
+
+// Calls `task(i)` for each `i` in [0, `count`), in tasks of `kStrokesPerTask`
+// consecutive indices.
+void ParallelForStrokes(Executor* absl_nullable executor, size_t count,
+                        absl::FunctionRef<void(size_t)> task) {
+  size_t n_tasks = (count + kStrokesPerTask - 1) / kStrokesPerTask;
+  ParallelFor(executor, n_tasks, [count, task](size_t task_index) {
+    size_t begin = task_index * kStrokesPerTask;
+    size_t end = std::min(begin + kStrokesPerTask, count);
+    for (size_t i = begin; i < end; ++i) task(i);
+  });
+}
+
+// Adds each distinct brush family used by `strokes` to `families_out`, and
+// the bitmaps of their textures to `bitmaps_out`, and returns the index in
+// `families_out` of the family of each stroke.
+std::vector<uint32_t> EncodeDistinctBrushFamilies(
+    absl::Span<const Stroke> strokes,
+    google::protobuf::RepeatedPtrField<proto::BrushFamily>& families_out,
+    google::protobuf::Map<std::string, std::string>& bitmaps_out,
+    const TextureBitmapProvider& get_bitmap) {
+  // Each bitmap is only requested for the first family that uses it.
+  TextureBitmapProvider get_new_bitmap =
+      [&bitmaps_out, &get_bitmap](
+          const std::string& id) -> std::optional<std::string> {
+    if (bitmaps_out.contains(id)) return std::nullopt;
+    return get_bitmap(id);
+  };
+  // Strokes drawn with the same brush share their family's data, so keying by
+  // family mostly just compares pointers, and each family is only encoded
+  // once.
+  absl::flat_hash_map<BrushFamily, uint32_t> family_indices;
+  std::vector<uint32_t> stroke_family_indices;
+  stroke_family_indices.reserve(strokes.size());
+  for (const Stroke& stroke : strokes) {
+    const BrushFamily& family = stroke.GetBrush().GetFamily();
+    auto [it, inserted] =
+        family_indices.try_emplace(family, families_out.size());
+    if (inserted) {
+      proto::BrushFamily& family_proto = *families_out.Add();
+      EncodeBrushFamily(family, family_proto, get_new_bitmap);
+      for (auto& [id, bitmap] : *family_proto.mutable_texture_id_to_bitmap()) {
+        bitmaps_out.try_emplace(id, std::move(bitmap));
+      }
+      family_proto.clear_texture_id_to_bitmap();
+    }
+    stroke_family_indices.push_back(it->second);
+  }
+  return stroke_family_indices;
+}
+
+void EncodeDocumentStroke(const Stroke& stroke, uint32_t brush_family_index,
+                          bool include_shapes,
+                          proto::CodedDocumentStroke& stroke_proto_out) {
+  const Brush& brush = stroke.GetBrush();
+  stroke_proto_out.set_brush_family_index(brush_family_index);
+  EncodeColor(brush.GetColor(), *stroke_proto_out.mutable_color());
+  stroke_proto_out.set_size_stroke_space(brush.GetSize());
+  stroke_proto_out.set_epsilon_stroke_space(brush.GetEpsilon());
+  EncodeStrokeInputBatch(stroke.GetInputs(),
+                         *stroke_proto_out.mutable_inputs());
+  const PartitionedMesh& shape = stroke.GetShape();
+  if (include_shapes) {
+    EncodePartitionedMesh(shape, *stroke_proto_out.mutable_shape());
+  }
+  if (const std::optional<Rect>& bounds = shape.Bounds().AsRect();
+      bounds.has_value()) {
+    proto::CodedDocumentStroke::Bounds& bounds_proto =
+        *stroke_proto_out.mutable_bounds();
+    bounds_proto.set_x_min(bounds->XMin());
+    bounds_proto.set_y_min(bounds->YMin());
+    bounds_proto.set_x_max(bounds->XMax());
+    bounds_proto.set_y_max(bounds->YMax());
+  }
+}
+
+using SharedPayload = proto::CodedDocumentStroke::SharedPayload;
+
+// Returns the position runs of `inputs` or `shape`, in the order of
+// `SharedPayload.position_offsets`.
+std::vector<proto::CodedNumericRun*> PositionRuns(
+    proto::CodedStrokeInputBatch& inputs) {
+  std::vector<proto::CodedNumericRun*> runs;
+  if (inputs.has_x_stroke_space()) {
+    runs.push_back(inputs.mutable_x_stroke_space());
+  }
+  if (inputs.has_y_stroke_space()) {
+    runs.push_back(inputs.mutable_y_stroke_space());
+  }
+  return runs;
+}
+
+std::vector<proto::CodedNumericRun*> PositionRuns(
+    proto::CodedModeledShape& shape) {
+  std::vector<proto::CodedNumericRun*> runs;
+  for (proto::CodedMesh& mesh : *shape.mutable_meshes()) {
+    if (mesh.has_x_stroke_space()) {
+      runs.push_back(mesh.mutable_x_stroke_space());
+    }
+    if (mesh.has_y_stroke_space()) {
+      runs.push_back(mesh.mutable_y_stroke_space());
+    }
+  }
+  return runs;
+}
+
+// Returns the serialization of `payload` with the offsets of its position runs
+// cleared, which is the same for payloads that differ only by a translation.
+// `payload` is left unchanged.
+template <typename Payload>
+std::string SerializeUntranslated(Payload& payload) {
+  std::vector<proto::CodedNumericRun*> runs = PositionRuns(payload);
+  std::vector<std::optional<float>> offsets;
+  offsets.reserve(runs.size());
+  for (proto::CodedNumericRun* run : runs) {
+    offsets.push_back(run->has_offset() ? std::optional(run->offset())
+                                        : std::nullopt);
+    run->clear_offset();
+  }
+  std::string bytes = payload.SerializeAsString();
+  for (size_t i = 0; i < runs.size(); ++i) {
+    if (offsets[i].has_value()) runs[i]->set_offset(*offsets[i]);
+  }
+  return bytes;
+}
+
+// Moves each payload (input batch or shape) that several of `strokes` have in
+// common, up to a translation, into `shared_out`, and replaces it in each of
+// those strokes with a reference to the shared payload. `payload_of()` returns
+// a stroke's payload, or null if it has none; `reference_of()` returns the
+// stroke's reference to a shared payload, creating it if needed; and
+// `clear_payload()` clears the stroke's own payload.
+//
+// Payloads are grouped by a hash of their untranslated serialization, computed
+// in parallel on `executor`, and then compared in full within each group.
+template <typename Payload>
+void DeduplicatePayloads(
+    google::protobuf::RepeatedPtrField<proto::CodedDocumentStroke>& strokes,
+    absl::FunctionRef<Payload* absl_nullable(proto::CodedDocumentStroke&)>
+        payload_of,
+    absl::FunctionRef<SharedPayload&(proto::CodedDocumentStroke&)>
+        reference_of,
+    absl::FunctionRef<void(proto::CodedDocumentStroke&)> clear_payload,
+    Executor* absl_nullable executor,
+    google::protobuf::RepeatedPtrField<Payload>& shared_out) {
+  std::vector<std::optional<size_t>> fingerprints(strokes.size());
+  ParallelForStrokes(executor, strokes.size(), [&](size_t i) {
+    if (Payload* payload = payload_of(*strokes.Mutable(i))) {
+      fingerprints[i] = absl::HashOf(SerializeUntranslated(*payload));
+    }
+  });
+
+  // Assign each stroke with a payload to a group of strokes with equal
+  // payloads, each represented by its first stroke.
+  constexpr size_t kNoGroup = std::numeric_limits<size_t>::max();
+  std::vector<size_t> stroke_groups(strokes.size(), kNoGroup);
+  std::vector<size_t> group_first_strokes;
+  std::vector<size_t> group_sizes;
+  absl::flat_hash_map<size_t, std::vector<size_t>> groups_by_fingerprint;
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    if (!fingerprints[i].has_value()) continue;
+    std::vector<size_t>& candidate_groups =
+        groups_by_fingerprint[*fingerprints[i]];
+    std::optional<std::string> bytes;
+    for (size_t group : candidate_groups) {
+      if (!bytes.has_value()) {
+        bytes = SerializeUntranslated(*payload_of(*strokes.Mutable(i)));
+      }
+      if (*bytes == SerializeUntranslated(*payload_of(
+                        *strokes.Mutable(group_first_strokes[group])))) {
+        stroke_groups[i] = group;
+        break;
+      }
+    }
+    if (stroke_groups[i] == kNoGroup) {
+      stroke_groups[i] = group_first_strokes.size();
+      candidate_groups.push_back(group_first_strokes.size());
+      group_first_strokes.push_back(i);
+      group_sizes.push_back(0);
+    }
+    ++group_sizes[stroke_groups[i]];
+  }
+
+  // The first stroke of each group is always the first to be visited, so it
+  // moves its payload into `shared_out` before the others reference it.
+  std::vector<uint32_t> group_shared_indices(group_sizes.size());
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    size_t group = stroke_groups[i];
+    if (group == kNoGroup || group_sizes[group] < 2) continue;
+    proto::CodedDocumentStroke& stroke = *strokes.Mutable(i);
+    Payload& payload = *payload_of(stroke);
+    std::vector<proto::CodedNumericRun*> runs = PositionRuns(payload);
+    SharedPayload& reference = reference_of(stroke);
+    for (const proto::CodedNumericRun* run : runs) {
+      reference.add_position_offsets(run->offset());
+    }
+    if (i == group_first_strokes[group]) {
+      group_shared_indices[group] = shared_out.size();
+      for (proto::CodedNumericRun* run : runs) run->clear_offset();
+      shared_out.Add()->Swap(&payload);
+    }
+    reference.set_index(group_shared_indices[group]);
+    clear_payload(stroke);
+  }
+}
+
+// Moves the input batches and shapes that several strokes of `document_proto`
+// have in common into its `shared_inputs` and `shared_shapes`.
+void DeduplicateDocumentPayloads(proto::CodedStrokeDocument& document_proto,
+                                 Executor* absl_nullable executor) {
+  DeduplicatePayloads<proto::CodedStrokeInputBatch>(
+      *document_proto.mutable_strokes(),
+      [](proto::CodedDocumentStroke& stroke) {
+        return stroke.has_inputs() ? stroke.mutable_inputs() : nullptr;
+      },
+      [](proto::CodedDocumentStroke& stroke) -> SharedPayload& {
+        return *stroke.mutable_shared_inputs();
+      },
+      [](proto::CodedDocumentStroke& stroke) { stroke.clear_inputs(); },
+      executor, *document_proto.mutable_shared_inputs());
+  DeduplicatePayloads<proto::CodedModeledShape>(
+      *document_proto.mutable_strokes(),
+      [](proto::CodedDocumentStroke& stroke) {
+        return stroke.has_shape() ? stroke.mutable_shape() : nullptr;
+      },
+      [](proto::CodedDocumentStroke& stroke) -> SharedPayload& {
+        return *stroke.mutable_shared_shape();
+      },
+      [](proto::CodedDocumentStroke& stroke) { stroke.clear_shape(); },
+      executor, *document_proto.mutable_shared_shapes());
+}
+
+// Replaces the contents of `strokes_out` with the encodings of `strokes`,
+// whose brush families are at `family_indices`.
+void EncodeDocumentStrokes(
+    absl::Span<const Stroke> strokes, absl::Span<const uint32_t> family_indices,
+    bool include_shapes, Executor* absl_nullable executor,
+    google::protobuf::RepeatedPtrField<proto::CodedDocumentStroke>&
+        strokes_out) {
+  strokes_out.Clear();
+  strokes_out.Reserve(strokes.size());
+  // Add all of the stroke protos up front, so that tasks only modify existing
+  // elements.
+  for (size_t i = 0; i < strokes.size(); ++i) strokes_out.Add();
+  ParallelForStrokes(executor, strokes.size(), [&](size_t i) {
+    EncodeDocumentStroke(strokes[i], family_indices[i], include_shapes,
+                         *strokes_out.Mutable(i));
+  });
+}
+
+// Returns a copy of the `shared` payload translated by the position offsets of
+// `reference`, or an error if `shared` is null, since the reference is out of
+// range, or if the number of offsets doesn't match the payload.
+template <typename Payload>
+absl::StatusOr<Payload> TranslateSharedPayload(
+    const SharedPayload& reference, const Payload* absl_nullable shared,
+    absl::string_view field_name) {
+  if (shared == nullptr) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid CodedStrokeDocument: ", field_name, " index ",
+                     reference.index(), " is out of range"));
+  }
+  Payload payload = *shared;
+  std::vector<proto::CodedNumericRun*> runs = PositionRuns(payload);
+  if (runs.size() != static_cast<size_t>(reference.position_offsets_size())) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "invalid CodedStrokeDocument: ", field_name, " ", reference.index(),
+        " has ", runs.size(), " position runs, but the stroke has ",
+        reference.position_offsets_size(), " position offsets"));
+  }
+  for (size_t i = 0; i < runs.size(); ++i) {
+    runs[i]->set_offset(reference.position_offsets(i));
+  }
+  return payload;
+}
+
+absl::StatusOr<StrokeInputBatch> DecodeSharedInputs(
+    const SharedPayload& reference,
+    const proto::CodedStrokeInputBatch* absl_nullable shared) {
+  absl::StatusOr<proto::CodedStrokeInputBatch> inputs_proto =
+      TranslateSharedPayload(reference, shared, "shared_inputs");
+  if (!inputs_proto.ok()) return inputs_proto.status();
+  return DecodeStrokeInputBatch(*inputs_proto);
+}
+
+absl::StatusOr<PartitionedMesh> DecodeSharedShape(
+    const SharedPayload& reference,
+    const proto::CodedModeledShape* absl_nullable shared) {
+  absl::StatusOr<proto::CodedModeledShape> shape_proto =
+      TranslateSharedPayload(reference, shared, "shared_shapes");
+  if (!shape_proto.ok()) return shape_proto.status();
+  return DecodePartitionedMesh(*shape_proto);
+}
+
+// Returns the element of `payloads` that `reference` refers to, or null if it
+// is out of range.
+template <typename Payload>
+const Payload* absl_nullable FindSharedPayload(
+    const SharedPayload& reference,
+    const google::protobuf::RepeatedPtrField<Payload>& payloads) {
+  if (reference.index() >= static_cast<uint32_t>(payloads.size())) {
+    return nullptr;
+  }
+  return &payloads.Get(reference.index());
+}
+
+// Decodes each distinct reference to a shared payload made by the strokes of
+// `document_proto` once, so that the strokes with equal references share the
+// decoded object. `reference_of()` returns a stroke's reference, or null if it
+// has none. Returns the index within `decoded_out` of the decoded payload of
+// each stroke, or `std::nullopt` for strokes without a reference.
+template <typename Decoded, typename Payload>
+std::vector<std::optional<size_t>> DecodeSharedPayloads(
+    const proto::CodedStrokeDocument& document_proto,
+    const google::protobuf::RepeatedPtrField<Payload>& shared_payloads,
+    absl::FunctionRef<const SharedPayload* absl_nullable(
+        const proto::CodedDocumentStroke&)>
+        reference_of,
+    absl::FunctionRef<absl::StatusOr<Decoded>(
+        const SharedPayload&, const Payload* absl_nullable)>
+        decode,
+    Executor* absl_nullable executor,
+    std::vector<absl::StatusOr<Decoded>>& decoded_out) {
+  using ReferenceKey = std::pair<uint32_t, std::vector<float>>;
+  absl::flat_hash_map<ReferenceKey, size_t> reference_indices;
+  std::vector<const SharedPayload*> distinct_references;
+  std::vector<std::optional<size_t>> stroke_indices(
+      document_proto.strokes_size());
+  for (int i = 0; i < document_proto.strokes_size(); ++i) {
+    const SharedPayload* reference = reference_of(document_proto.strokes(i));
+    if (reference == nullptr) continue;
+    ReferenceKey key(reference->index(),
+                     std::vector<float>(reference->position_offsets().begin(),
+                                        reference->position_offsets().end()));
+    auto [it, inserted] = reference_indices.try_emplace(
+        std::move(key), distinct_references.size());
+    if (inserted) distinct_references.push_back(reference);
+    stroke_indices[i] = it->second;
+  }
+
+  decoded_out.assign(distinct_references.size(),
+                     absl::InternalError("not decoded"));
+  ParallelForStrokes(executor, distinct_references.size(), [&](size_t i) {
+    decoded_out[i] =
+        decode(*distinct_references[i],
+               FindSharedPayload(*distinct_references[i], shared_payloads));
+  });
+  return stroke_indices;
+}
+
+// Decodes the stroke of `stroke_proto`, whose shared inputs and shape, if it
+// references any, are decoded by `decode_shared_inputs()` and
+// `decode_shared_shape()`.
+absl::StatusOr<Stroke> DecodeDocumentStrokeImpl(
+    const proto::CodedDocumentStroke& stroke_proto,
+    absl::Span<const BrushFamily> families,
+    absl::FunctionRef<absl::StatusOr<StrokeInputBatch>()> decode_shared_inputs,
+    absl::FunctionRef<absl::StatusOr<PartitionedMesh>()> decode_shared_shape) {
+  if (stroke_proto.brush_family_index() >= families.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid CodedStrokeDocument: brush_family_index ",
+                     stroke_proto.brush_family_index(), " is out of range ",
+                     "for ", families.size(), " brush families"));
+  }
+  // Brush::Create() validates the brush.
+  absl::StatusOr<Brush> brush = Brush::Create(
+      families[stroke_proto.brush_family_index()],
+      DecodeColor(stroke_proto.color()), stroke_proto.size_stroke_space(),
+      stroke_proto.epsilon_stroke_space());
+  if (!brush.ok()) return brush.status();
+
+  absl::StatusOr<StrokeInputBatch> inputs =
+      stroke_proto.has_shared_inputs()
+          ? decode_shared_inputs()
+          : DecodeStrokeInputBatch(stroke_proto.inputs());
+  if (!inputs.ok()) return inputs.status();
+
+  if (!stroke_proto.has_shape() && !stroke_proto.has_shared_shape()) {
+    return Stroke::WithLazyShape(*brush, *inputs);
+  }
+  absl::StatusOr<PartitionedMesh> shape =
+      stroke_proto.has_shared_shape()
+          ? decode_shared_shape()
+          : DecodePartitionedMesh(stroke_proto.shape());
+  if (!shape.ok()) return shape.status();
+  if (shape->RenderGroupCount() != brush->CoatCount()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "invalid CodedStrokeDocument: stroke shape has ",
+        shape->RenderGroupCount(), " render groups, but its brush has ",
+        brush->CoatCount(), " coats"));
+  }
+  return Stroke(*brush, *inputs, *shape);
+}
+
+}  // namespace
+
+void EncodeStrokeDocument(absl::Span<const Stroke> strokes,
+                          proto::CodedStrokeDocument& document_proto_out,
+                          bool include_shapes,
+                          TextureBitmapProvider get_bitmap,
+                          Executor* absl_nullable executor,
+                          bool deduplicate_payloads) {
+  ScopedTraceEvent trace_event("ink::EncodeStrokeDocument");
+  document_proto_out.Clear();
+  std::vector<uint32_t> family_indices = EncodeDistinctBrushFamilies(
+      strokes, *document_proto_out.mutable_brush_families(),
+      *document_proto_out.mutable_texture_id_to_bitmap(), get_bitmap);
+  EncodeDocumentStrokes(strokes, family_indices, include_shapes, executor,
+                        *document_proto_out.mutable_strokes());
+  if (deduplicate_payloads) {
+    DeduplicateDocumentPayloads(document_proto_out, executor);
+  }
+}
+
+absl::Status WriteStrokeDocument(
+    absl::Span<const Stroke> strokes,
+    google::protobuf::io::ZeroCopyOutputStream& output, bool include_shapes,
+    TextureBitmapProvider get_bitmap, Executor* absl_nullable executor) {
+  ScopedTraceEvent trace_event("ink::WriteStrokeDocument");
+  google::protobuf::io::CodedOutputStream coded_output(&output);
+  coded_output.SetSerializationDeterministic(true);
+
+  // A serialized proto is its fields in field number order, and concatenating
+  // serialized protos merges them. So serializing the brush families on their
+  // own, followed by each batch of strokes on its own, followed by the texture
+  // bitmaps, produces the same bytes as serializing the whole document at
+  // once.
+  //
+  // Each partial document is allocated on an arena of its own, so that its
+  // many small messages are allocated cheaply and freed all at once after
+  // they are written.
+  std::vector<uint32_t> family_indices;
+  proto::CodedStrokeDocument bitmaps_document;
+  {
+    google::protobuf::Arena arena;
+    proto::CodedStrokeDocument& partial_document =
+        *google::protobuf::Arena::Create<proto::CodedStrokeDocument>(&arena);
+    family_indices = EncodeDistinctBrushFamilies(
+        strokes, *partial_document.mutable_brush_families(),
+        *bitmaps_document.mutable_texture_id_to_bitmap(), get_bitmap);
+    partial_document.SerializeToCodedStream(&coded_output);
+  }
+
+  for (size_t begin = 0; begin < strokes.size();
+       begin += kStrokesPerWriteBatch) {
+    size_t size = std::min(kStrokesPerWriteBatch, strokes.size() - begin);
+    google::protobuf::Arena arena;
+    proto::CodedStrokeDocument& partial_document =
+        *google::protobuf::Arena::Create<proto::CodedStrokeDocument>(&arena);
+    EncodeDocumentStrokes(strokes.subspan(begin, size),
+                          absl::MakeConstSpan(family_indices).subspan(begin),
+                          include_shapes, executor,
+                          *partial_document.mutable_strokes());
+    partial_document.SerializeToCodedStream(&coded_output);
+    if (coded_output.HadError()) break;
+  }
+  bitmaps_document.SerializeToCodedStream(&coded_output);
+
+  coded_output.Trim();
+  if (coded_output.HadError()) {
+    return absl::DataLossError(
+        "failed to write CodedStrokeDocument to the output stream");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Stroke>> DecodeStrokeDocument(
+    const proto::CodedStrokeDocument& document_proto,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id,
+    Executor* absl_nullable executor) {
+  ScopedTraceEvent trace_event("ink::DecodeStrokeDocument");
+  absl::StatusOr<std::vector<BrushFamily>> families =
+      DecodeStrokeDocumentBrushFamilies(document_proto,
+                                        std::move(get_client_texture_id));
+  if (!families.ok()) return families.status();
+
+  // Each distinct shared payload and translation is only decoded once, so that
+  // the strokes that use it share the decoded inputs' storage and
+  // `PartitionedMesh`.
+  std::vector<absl::StatusOr<StrokeInputBatch>> shared_inputs;
+  std::vector<std::optional<size_t>> shared_input_indices =
+      DecodeSharedPayloads<StrokeInputBatch, proto::CodedStrokeInputBatch>(
+          document_proto, document_proto.shared_inputs(),
+          [](const proto::CodedDocumentStroke& stroke) {
+            return stroke.has_shared_inputs() ? &stroke.shared_inputs()
+                                              : nullptr;
+          },
+          DecodeSharedInputs, executor, shared_inputs);
+  std::vector<absl::StatusOr<PartitionedMesh>> shared_shapes;
+  std::vector<std::optional<size_t>> shared_shape_indices =
+      DecodeSharedPayloads<PartitionedMesh, proto::CodedModeledShape>(
+          document_proto, document_proto.shared_shapes(),
+          [](const proto::CodedDocumentStroke& stroke) {
+            return stroke.has_shared_shape() ? &stroke.shared_shape()
+                                             : nullptr;
+          },
+          DecodeSharedShape, executor, shared_shapes);
+
+  std::vector<absl::StatusOr<Stroke>> decoded_strokes(
+      document_proto.strokes_size());
+  ParallelForStrokes(executor, decoded_strokes.size(), [&](size_t i) {
+    decoded_strokes[i] = DecodeDocumentStrokeImpl(
+        document_proto.strokes(i), *families,
+        [&]() { return shared_inputs[*shared_input_indices[i]]; },
+        [&]() { return shared_shapes[*shared_shape_indices[i]]; });
+  });
+
+  std::vector<Stroke> strokes;
+  strokes.reserve(decoded_strokes.size());
+  for (absl::StatusOr<Stroke>& stroke : decoded_strokes) {
+    if (!stroke.ok()) return stroke.status();
+    strokes.push_back(*std::move(stroke));
+  }
+  return strokes;
+}
+
+absl::StatusOr<std::vector<BrushFamily>> DecodeStrokeDocumentBrushFamilies(
+    const proto::CodedStrokeDocument& document_proto,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id) {
+  // The new ID of each texture, so that `get_client_texture_id` is called once
+  // per texture rather than once per family that uses it.
+  absl::flat_hash_map<std::string, std::string> old_to_new_id;
+  ClientTextureIdProviderAndBitmapReceiver get_document_texture_id =
+      [&document_proto, &old_to_new_id, &get_client_texture_id](
+          const std::string& encoded_id,
+          const std::string& bitmap) -> absl::StatusOr<std::string> {
+    if (auto it = old_to_new_id.find(encoded_id); it != old_to_new_id.end()) {
+      return it->second;
+    }
+    // Older documents store bitmaps in each family instead of in the document.
+    const std::string* document_bitmap = &bitmap;
+    if (bitmap.empty()) {
+      if (auto it = document_proto.texture_id_to_bitmap().find(encoded_id);
+          it != document_proto.texture_id_to_bitmap().end()) {
+        document_bitmap = &it->second;
+      }
+    }
+    absl::StatusOr<std::string> new_id =
+        get_client_texture_id(encoded_id, *document_bitmap);
+    if (!new_id.ok()) return new_id.status();
+    old_to_new_id.emplace(encoded_id, *new_id);
+    return new_id;
+  };
+
+  std::vector<BrushFamily> families;
+  families.reserve(document_proto.brush_families_size());
+  for (const proto::BrushFamily& family_proto :
+       document_proto.brush_families()) {
+    absl::StatusOr<BrushFamily> family =
+        DecodeBrushFamily(family_proto, get_document_texture_id);
+    if (!family.ok()) return family.status();
+    families.push_back(*std::move(family));
+  }
+  return families;
+}
+
+absl::StatusOr<Stroke> DecodeDocumentStroke(
+    const proto::CodedDocumentStroke& stroke_proto,
+    absl::Span<const BrushFamily> families,
+    const proto::CodedStrokeInputBatch* absl_nullable shared_inputs,
+    const proto::CodedModeledShape* absl_nullable shared_shape) {
+  return DecodeDocumentStrokeImpl(
+      stroke_proto, families,
+      [&]() {
+        return DecodeSharedInputs(stroke_proto.shared_inputs(), shared_inputs);
+      },
+      [&]() {
+        return DecodeSharedShape(stroke_proto.shared_shape(), shared_shape);
+      });
+}
+
+}  // namespace ink
@@ -0,0 +1,138 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_STORAGE_STROKE_DOCUMENT_H_
+#define INK_STORAGE_STROKE_DOCUMENT_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "google/protobuf/io/zero_copy_stream.h"
+#include "ink/brush/brush_family.h"
+#include "ink/storage/brush.h"
+#include "ink/storage/proto/stroke_document.pb.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+// Populates `document_proto_out` with `strokes`, storing each distinct brush
+// family only once. Brush families are considered the same if they encode to
+// the same `proto::BrushFamily`. The bitmap of each texture is requested from
+// `get_bitmap` and stored only once, in `texture_id_to_bitmap` of the document
+// rather than of each family. If `include_shapes` is true, the shape of each
+// stroke is stored as well, so that decoding doesn't need to regenerate it, at
+// the cost of a much larger encoding. The bounds of each stroke's shape are
+// always stored, so strokes whose shape generation was deferred by
+// `Stroke::WithLazyShape()` have their shapes generated by encoding.
+//
+// If `executor` is non-null, the strokes are encoded in parallel on it. The
+// result is the same either way. Brush families are always encoded on the
+// calling thread, so `get_bitmap` is never called concurrently.
+//
+// If `deduplicate_payloads` is true, input batches and shapes whose encodings
+// are the same for several strokes, up to a translation, are stored only once,
+// in `shared_inputs` and `shared_shapes` of the document, and referenced by
+// those strokes. This makes documents with many copied or duplicated strokes
+// much smaller, and lets `DecodeStrokeDocument()` share the decoded inputs and
+// shapes between them. It is off by default, since readers older than these
+// fields would lose the shared strokes' inputs and shapes.
+//
+// The proto need not be empty before calling this; it will effectively clear
+// the proto first. If it is allocated on a `google::protobuf::Arena`, so are
+// all of the messages added to it, which makes building and destroying the
+// encoding of a large document much cheaper.
+void EncodeStrokeDocument(
+    absl::Span<const Stroke> strokes,
+    proto::CodedStrokeDocument& document_proto_out, bool include_shapes = false,
+    TextureBitmapProvider get_bitmap =
+        [](const std::string& id) { return std::nullopt; },
+    Executor* absl_nullable executor = nullptr,
+    bool deduplicate_payloads = false);
+
+// Like `EncodeStrokeDocument()`, but serializes the document to `output`
+// without building the whole `proto::CodedStrokeDocument` in memory. Strokes
+// are encoded and written in batches, so only one batch of encoded strokes is
+// held at a time.
+//
+// The bytes written are the deterministic serialization of the proto that
+// `EncodeStrokeDocument()` would produce for the same arguments, regardless of
+// `executor`, without `deduplicate_payloads`, which would need every stroke to
+// be encoded before the first is written. Returns an error if writing to
+// `output` fails.
+absl::Status WriteStrokeDocument(
+    absl::Span<const Stroke> strokes,
+    google::protobuf::io::ZeroCopyOutputStream& output,
+    bool include_shapes = false,
+    TextureBitmapProvider get_bitmap =
+        [](const std::string& id) { return std::nullopt; },
+    Executor* absl_nullable executor = nullptr);
+
+// Decodes the proto into a sequence of strokes. Each brush family is decoded
+// only once, and shared by all of the strokes that use it, and likewise each
+// shared input batch and shape, for the strokes that use it at the same
+// position. Strokes whose shapes
+// were not stored are created with `Stroke::WithLazyShape()`, so that loading a
+// document doesn't generate the shapes of strokes that are never drawn. Returns
+// an error if the proto is invalid; if several strokes are invalid, the error
+// is the one for the first of them.
+//
+// If `executor` is non-null, the strokes are decoded in parallel on it. Brush
+// families are always decoded on the calling thread, so
+// `get_client_texture_id` is never called concurrently.
+//
+// Documents have many small messages, so parsing `document_proto` into a
+// message allocated on a `google::protobuf::Arena` makes loading them
+// considerably faster; see `BM_ParseAndDecodeRecordedStrokeDocument`.
+absl::StatusOr<std::vector<Stroke>> DecodeStrokeDocument(
+    const proto::CodedStrokeDocument& document_proto,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id =
+        [](const std::string& encoded_id, const std::string& bitmap) {
+          return encoded_id;
+        },
+    Executor* absl_nullable executor = nullptr);
+
+// Decodes the brush families of `document_proto`, as `DecodeStrokeDocument()`
+// does, without decoding its strokes. `get_client_texture_id` is called once
+// for each distinct texture, with its bitmap from either the document or the
+// family.
+absl::StatusOr<std::vector<BrushFamily>> DecodeStrokeDocumentBrushFamilies(
+    const proto::CodedStrokeDocument& document_proto,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id =
+        [](const std::string& encoded_id, const std::string& bitmap) {
+          return encoded_id;
+        });
+
+// Decodes a single stroke of a `proto::CodedStrokeDocument` whose brush
+// families have already been decoded into `families`, as by
+// `DecodeStrokeDocument()`. If the stroke references a shared input batch or
+// shape, `shared_inputs` or `shared_shape` must be the element of the
+// document's `shared_inputs` or `shared_shapes` that it references, or null if
+// that is out of range. Returns an error if the stroke is invalid or
+// references a family or shared payload that is out of range.
+absl::StatusOr<Stroke> DecodeDocumentStroke(
+    const proto::CodedDocumentStroke& stroke_proto,
+    absl::Span<const BrushFamily> families,
+    const proto::CodedStrokeInputBatch* absl_nullable shared_inputs = nullptr,
+    const proto::CodedModeledShape* absl_nullable shared_shape = nullptr);
+
+}  // namespace ink
+
+#endif  // INK_STORAGE_STROKE_DOCUMENT_H_
@@ -0,0 +1,383 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/storage/stroke_document_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+#include "ink/brush/brush_family.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/intersects.h"
+#include "ink/geometry/rect.h"
+#include "ink/storage/brush.h"
+#include "ink/storage/proto/mesh.pb.h"
+#include "ink/storage/proto/stroke_document.pb.h"
+#include "ink/storage/proto/stroke_input_batch.pb.h"
+#include "ink/storage/stroke_document.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+#include "ink/types/trace.h"
+
+namespace ink {
+
+using ::google::protobuf::internal::WireFormatLite;
+
+class StrokeDocumentReader::MappedFile {
+ public:
+  static absl::StatusOr<std::shared_ptr<const MappedFile>> Map(
+      const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return absl::ErrnoToStatus(errno, absl::StrCat("failed to open ", path));
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+      absl::Status status =
+          absl::ErrnoToStatus(errno, absl::StrCat("failed to stat ", path));
+      close(fd);
+      return status;
+    }
+    size_t size = static_cast<size_t>(file_stat.st_size);
+    void* data = nullptr;
+    // Empty files can't be mapped, but are empty documents.
+    if (size > 0) {
+      data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        absl::Status status =
+            absl::ErrnoToStatus(errno, absl::StrCat("failed to map ", path));
+        close(fd);
+        return status;
+      }
+    }
+    // The mapping stays valid after the file is closed.
+    close(fd);
+    return std::shared_ptr<const MappedFile>(new MappedFile(data, size));
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() {
+    if (data_ != nullptr) munmap(data_, size_);
+  }
+
+  absl::string_view Bytes() const {
+    return absl::string_view(static_cast<const char*>(data_), size_);
+  }
+
+ private:
+  MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+
+  void* data_;
+  size_t size_;
+};
+
+namespace {
+
+absl::Status TruncatedDocumentError() {
+  return absl::InvalidArgumentError(
+      "invalid CodedStrokeDocument: the encoding is truncated or malformed");
+}
+
+google::protobuf::io::CodedInputStream MakeInputStream(
+    absl::string_view bytes) {
+  return google::protobuf::io::CodedInputStream(
+      reinterpret_cast<const uint8_t*>(bytes.data()),
+      static_cast<int>(bytes.size()));
+}
+
+// Reads the length of a length-delimited field whose tag was just read from
+// `input`, and returns the field's contents within `bytes`, which `input` reads
+// from. Advances `input` past the field.
+absl::StatusOr<absl::string_view> ReadLengthDelimitedField(
+    google::protobuf::io::CodedInputStream& input, absl::string_view bytes) {
+  uint32_t length;
+  if (!input.ReadVarint32(&length)) return TruncatedDocumentError();
+  size_t offset = input.CurrentPosition();
+  if (length > bytes.size() - offset || !input.Skip(length)) {
+    return TruncatedDocumentError();
+  }
+  return bytes.substr(offset, length);
+}
+
+bool IsLengthDelimited(uint32_t tag) {
+  return WireFormatLite::GetTagWireType(tag) ==
+         WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+}
+
+Envelope DecodeBounds(const proto::CodedDocumentStroke::Bounds& bounds_proto) {
+  if (!bounds_proto.has_x_min() || !bounds_proto.has_y_min() ||
+      !bounds_proto.has_x_max() || !bounds_proto.has_y_max()) {
+    return Envelope();
+  }
+  for (float value : {bounds_proto.x_min(), bounds_proto.y_min(),
+                      bounds_proto.x_max(), bounds_proto.y_max()}) {
+    if (!std::isfinite(value)) return Envelope();
+  }
+  return Envelope(
+      Rect::FromTwoPoints({bounds_proto.x_min(), bounds_proto.y_min()},
+                          {bounds_proto.x_max(), bounds_proto.y_max()}));
+}
+
+// Reads the brush family index and bounds of the `CodedDocumentStroke` in
+// `record`, skipping over its other fields without parsing them.
+absl::StatusOr<StrokeDocumentReader::StrokeRecord> IndexStroke(
+    absl::string_view record, size_t offset, size_t family_count) {
+  StrokeDocumentReader::StrokeRecord stroke_record = {.offset = offset,
+                                                      .size = record.size()};
+  google::protobuf::io::CodedInputStream input = MakeInputStream(record);
+  while (uint32_t tag = input.ReadTag()) {
+    int field_number = WireFormatLite::GetTagFieldNumber(tag);
+    if (field_number ==
+            proto::CodedDocumentStroke::kBrushFamilyIndexFieldNumber &&
+        WireFormatLite::GetTagWireType(tag) ==
+            WireFormatLite::WIRETYPE_VARINT) {
+      if (!input.ReadVarint32(&stroke_record.brush_family_index)) {
+        return TruncatedDocumentError();
+      }
+    } else if (field_number ==
+                   proto::CodedDocumentStroke::kBoundsFieldNumber &&
+               IsLengthDelimited(tag)) {
+      absl::StatusOr<absl::string_view> bounds_bytes =
+          ReadLengthDelimitedField(input, record);
+      if (!bounds_bytes.ok()) return bounds_bytes.status();
+      proto::CodedDocumentStroke::Bounds bounds_proto;
+      if (!bounds_proto.ParseFromArray(bounds_bytes->data(),
+                                       bounds_bytes->size())) {
+        return TruncatedDocumentError();
+      }
+      stroke_record.bounds = DecodeBounds(bounds_proto);
+    } else if (!WireFormatLite::SkipField(&input, tag)) {
+      return TruncatedDocumentError();
+    }
+  }
+  if (input.CurrentPosition() != static_cast<int>(record.size())) {
+    return TruncatedDocumentError();
+  }
+  if (stroke_record.brush_family_index >= family_count) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "invalid CodedStrokeDocument: brush_family_index ",
+        stroke_record.brush_family_index, " is out of range for ",
+        family_count, " brush families"));
+  }
+  return stroke_record;
+}
+
+// Parses the encoding within `payloads` that `reference` refers to into a
+// message on `arena`. Returns null if the reference is out of range, which
+// `DecodeDocumentStroke()` reports.
+template <typename Payload>
+absl::StatusOr<const Payload*> ParseSharedPayload(
+    const proto::CodedDocumentStroke::SharedPayload& reference,
+    absl::Span<const absl::string_view> payloads,
+    google::protobuf::Arena& arena) {
+  if (reference.index() >= payloads.size()) return nullptr;
+  absl::string_view bytes = payloads[reference.index()];
+  Payload& payload = *google::protobuf::Arena::Create<Payload>(&arena);
+  if (!payload.ParseFromArray(bytes.data(), static_cast<int>(bytes.size()))) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid CodedStrokeDocument: failed to parse shared ",
+                     "payload ", reference.index()));
+  }
+  return &payload;
+}
+
+}  // namespace
+
+absl::StatusOr<StrokeDocumentReader> StrokeDocumentReader::OpenFile(
+    const std::string& path,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id) {
+  absl::StatusOr<std::shared_ptr<const MappedFile>> file =
+      MappedFile::Map(path);
+  if (!file.ok()) return file.status();
+  absl::string_view bytes = (*file)->Bytes();
+  return Index(*std::move(file), bytes, get_client_texture_id);
+}
+
+absl::StatusOr<StrokeDocumentReader> StrokeDocumentReader::Open(
+    absl::string_view bytes,
+    ClientTextureIdProviderAndBitmapReceiver get_client_texture_id) {
+  return Index(nullptr, bytes, get_client_texture_id);
+}
+
+absl::StatusOr<StrokeDocumentReader> StrokeDocumentReader::Index(
+    std::shared_ptr<const MappedFile> file, absl::string_view bytes,
+    const ClientTextureIdProviderAndBitmapReceiver& get_client_texture_id) {
+  ScopedTraceEvent trace_event("ink::StrokeDocumentReader::Index");
+  if (bytes.size() > INT_MAX) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "CodedStrokeDocument of ", bytes.size(), " bytes is too large"));
+  }
+  auto state = std::make_shared<State>();
+  state->file = std::move(file);
+  state->bytes = bytes;
+
+  // Everything but the strokes and shared payloads is copied into
+  // `document_bytes` and parsed
+  // once the whole document has been read, since the texture bitmaps that the
+  // brush families reference follow the strokes. Strokes may also precede the
+  // families in a valid encoding, so their family indices are checked once all
+  // families are known.
+  std::string document_bytes;
+  std::vector<absl::string_view> stroke_bytes;
+  google::protobuf::io::CodedInputStream input = MakeInputStream(bytes);
+  int field_begin = 0;
+  while (uint32_t tag = input.ReadTag()) {
+    int field_number = WireFormatLite::GetTagFieldNumber(tag);
+    if (field_number == proto::CodedStrokeDocument::kStrokesFieldNumber &&
+        IsLengthDelimited(tag)) {
+      absl::StatusOr<absl::string_view> record =
+          ReadLengthDelimitedField(input, bytes);
+      if (!record.ok()) return record.status();
+      stroke_bytes.push_back(*record);
+    } else if ((field_number ==
+                    proto::CodedStrokeDocument::kSharedInputsFieldNumber ||
+                field_number ==
+                    proto::CodedStrokeDocument::kSharedShapesFieldNumber) &&
+               IsLengthDelimited(tag)) {
+      absl::StatusOr<absl::string_view> payload =
+          ReadLengthDelimitedField(input, bytes);
+      if (!payload.ok()) return payload.status();
+      (field_number == proto::CodedStrokeDocument::kSharedInputsFieldNumber
+           ? state->shared_inputs
+           : state->shared_shapes)
+          .push_back(*payload);
+    } else if (WireFormatLite::SkipField(&input, tag)) {
+      absl::StrAppend(&document_bytes,
+                      bytes.substr(field_begin,
+                                   input.CurrentPosition() - field_begin));
+    } else {
+      return TruncatedDocumentError();
+    }
+    field_begin = input.CurrentPosition();
+  }
+  if (input.CurrentPosition() != static_cast<int>(bytes.size())) {
+    return TruncatedDocumentError();
+  }
+
+  {
+    google::protobuf::Arena arena;
+    proto::CodedStrokeDocument& document_proto =
+        *google::protobuf::Arena::Create<proto::CodedStrokeDocument>(&arena);
+    if (!document_proto.ParseFromString(document_bytes)) {
+      return TruncatedDocumentError();
+    }
+    absl::StatusOr<std::vector<BrushFamily>> families =
+        DecodeStrokeDocumentBrushFamilies(document_proto,
+                                          get_client_texture_id);
+    if (!families.ok()) return families.status();
+    state->families = *std::move(families);
+  }
+
+  state->records.reserve(stroke_bytes.size());
+  for (absl::string_view record : stroke_bytes) {
+    absl::StatusOr<StrokeRecord> stroke_record =
+        IndexStroke(record, record.data() - bytes.data(),
+                    state->families.size());
+    if (!stroke_record.ok()) return stroke_record.status();
+    state->records.push_back(*std::move(stroke_record));
+  }
+  return StrokeDocumentReader(std::move(state));
+}
+
+const StrokeDocumentReader::StrokeRecord&
+StrokeDocumentReader::GetStrokeRecord(size_t index) const {
+  ABSL_CHECK_LT(index, state_->records.size());
+  return state_->records[index];
+}
+
+std::vector<size_t> StrokeDocumentReader::StrokesIntersecting(
+    const Rect& region) const {
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < state_->records.size(); ++i) {
+    const Envelope& bounds = state_->records[i].bounds;
+    if (bounds.IsEmpty() || Intersects(region, *bounds.AsRect())) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+absl::StatusOr<Stroke> StrokeDocumentReader::DecodeStroke(size_t index) const {
+  const StrokeRecord& record = GetStrokeRecord(index);
+  // A stroke has many small messages, which are much cheaper to allocate and
+  // free together on an arena.
+  google::protobuf::Arena arena;
+  proto::CodedDocumentStroke& stroke_proto =
+      *google::protobuf::Arena::Create<proto::CodedDocumentStroke>(&arena);
+  if (!stroke_proto.ParseFromArray(state_->bytes.data() + record.offset,
+                                   record.size)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "invalid CodedStrokeDocument: failed to parse stroke ", index));
+  }
+  const proto::CodedStrokeInputBatch* shared_inputs = nullptr;
+  if (stroke_proto.has_shared_inputs()) {
+    absl::StatusOr<const proto::CodedStrokeInputBatch*> parsed =
+        ParseSharedPayload<proto::CodedStrokeInputBatch>(
+            stroke_proto.shared_inputs(), state_->shared_inputs, arena);
+    if (!parsed.ok()) return parsed.status();
+    shared_inputs = *parsed;
+  }
+  const proto::CodedModeledShape* shared_shape = nullptr;
+  if (stroke_proto.has_shared_shape()) {
+    absl::StatusOr<const proto::CodedModeledShape*> parsed =
+        ParseSharedPayload<proto::CodedModeledShape>(
+            stroke_proto.shared_shape(), state_->shared_shapes, arena);
+    if (!parsed.ok()) return parsed.status();
+    shared_shape = *parsed;
+  }
+  return DecodeDocumentStroke(stroke_proto, state_->families, shared_inputs,
+                              shared_shape);
+}
+
+absl::StatusOr<std::vector<Stroke>> StrokeDocumentReader::DecodeStrokes(
+    absl::Span<const size_t> indices, Executor* absl_nullable executor) const {
+  ScopedTraceEvent trace_event("ink::StrokeDocumentReader::DecodeStrokes");
+  std::vector<absl::StatusOr<Stroke>> decoded_strokes(indices.size());
+  ParallelFor(executor, indices.size(), [&](size_t i) {
+    decoded_strokes[i] = DecodeStroke(indices[i]);
+  });
+
+  std::vector<Stroke> strokes;
+  strokes.reserve(decoded_strokes.size());
+  for (absl::StatusOr<Stroke>& stroke : decoded_strokes) {
+    if (!stroke.ok()) return stroke.status();
+    strokes.push_back(*std::move(stroke));
+  }
+  return strokes;
+}
+
+}  // namespace ink
@@ -0,0 +1,150 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STORAGE_STROKE_DOCUMENT_READER_H_
+#define INK_STORAGE_STROKE_DOCUMENT_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush_family.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/rect.h"
+#include "ink/storage/brush.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+// Reads the strokes of a serialized `proto::CodedStrokeDocument` on demand,
+// without parsing the whole document into memory first.
+//
+// Opening a document decodes its brush families, and indexes each stroke by
+// the location of its encoding, its brush family, and its bounds, but leaves
+// the strokes' inputs and shapes encoded. Strokes are then decoded
+// individually, so that a client can decode the strokes that are visible
+// before the rest, and never needs to hold both the parsed document and the
+// decoded strokes.
+//
+// The bounds are those stored by `EncodeStrokeDocument()` and
+// `WriteStrokeDocument()`; strokes from documents written without them have
+// empty bounds in the index, and are treated as intersecting every region.
+//
+// A reader is immutable once opened, so its const methods are safe to call
+// concurrently. Copies share the underlying bytes.
+class StrokeDocumentReader {
+ public:
+  // The index entry of one stroke of the document.
+  struct StrokeRecord {
+    // The position and size in bytes of the stroke's `CodedDocumentStroke`
+    // within the document.
+    size_t offset = 0;
+    size_t size = 0;
+    // The index of the stroke's family within `BrushFamilies()`.
+    uint32_t brush_family_index = 0;
+    Envelope bounds;
+  };
+
+  // Memory-maps the file at `path` and indexes the document that it contains.
+  // The mapping is kept until the reader and all of its copies are destroyed.
+  // Returns an error if the file can't be mapped, if the document is
+  // malformed, or if a brush family is invalid or a stroke references one that
+  // is out of range. Other errors in the encodings of individual strokes are
+  // only found when those strokes are decoded.
+  static absl::StatusOr<StrokeDocumentReader> OpenFile(
+      const std::string& path,
+      ClientTextureIdProviderAndBitmapReceiver get_client_texture_id =
+          [](const std::string& encoded_id, const std::string& bitmap) {
+            return encoded_id;
+          });
+
+  // Like `OpenFile()`, but reads the document from `bytes`, which must outlive
+  // the reader and all of its copies.
+  static absl::StatusOr<StrokeDocumentReader> Open(
+      absl::string_view bytes,
+      ClientTextureIdProviderAndBitmapReceiver get_client_texture_id =
+          [](const std::string& encoded_id, const std::string& bitmap) {
+            return encoded_id;
+          });
+
+  StrokeDocumentReader(const StrokeDocumentReader&) = default;
+  StrokeDocumentReader(StrokeDocumentReader&&) = default;
+  StrokeDocumentReader& operator=(const StrokeDocumentReader&) = default;
+  StrokeDocumentReader& operator=(StrokeDocumentReader&&) = default;
+  ~StrokeDocumentReader() = default;
+
+  // The distinct brush families of the document, in order.
+  absl::Span<const BrushFamily> BrushFamilies() const {
+    return state_->families;
+  }
+
+  size_t StrokeCount() const { return state_->records.size(); }
+
+  // Returns the index entry of the stroke at `index`, which must be less than
+  // `StrokeCount()`.
+  const StrokeRecord& GetStrokeRecord(size_t index) const;
+
+  // Returns the indices of the strokes whose bounds intersect `region`, in
+  // document order, without decoding any strokes.
+  std::vector<size_t> StrokesIntersecting(const Rect& region) const;
+
+  // Decodes the stroke at `index`, which must be less than `StrokeCount()`,
+  // as `DecodeStrokeDocument()` would. Returns an error if its encoding is
+  // invalid.
+  absl::StatusOr<Stroke> DecodeStroke(size_t index) const;
+
+  // Decodes the strokes at `indices`, in the given order. Returns an error if
+  // any of them is invalid; if several are, the error is the one for the first
+  // of them. If `executor` is non-null, the strokes are decoded in parallel on
+  // it.
+  absl::StatusOr<std::vector<Stroke>> DecodeStrokes(
+      absl::Span<const size_t> indices,
+      Executor* absl_nullable executor = nullptr) const;
+
+ private:
+  // Releases a memory mapping when destroyed.
+  class MappedFile;
+
+  struct State {
+    std::shared_ptr<const MappedFile> file;
+    absl::string_view bytes;
+    std::vector<BrushFamily> families;
+    std::vector<StrokeRecord> records;
+    // The encodings of the document's `shared_inputs` and `shared_shapes`,
+    // which are parsed again for each stroke that references them.
+    std::vector<absl::string_view> shared_inputs;
+    std::vector<absl::string_view> shared_shapes;
+  };
+
+  explicit StrokeDocumentReader(std::shared_ptr<const State> state)
+      : state_(std::move(state)) {}
+
+  static absl::StatusOr<StrokeDocumentReader> Index(
+      std::shared_ptr<const MappedFile> file, absl::string_view bytes,
+      const ClientTextureIdProviderAndBitmapReceiver& get_client_texture_id);
+
+  std::shared_ptr<const State> state_;
+};
+
+}  // namespace ink
+
+#endif  // INK_STORAGE_STROKE_DOCUMENT_READER_H_
@@ -0,0 +1,337 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/storage/stroke_document_reader.h"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/brush/type_matchers.h"
+#include "ink/color/color.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/storage/proto/stroke_document.pb.h"
+#include "ink/storage/stroke_document.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/input/type_matchers.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+
+BrushFamily CreateFamily(float corner_rounding) {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(
+      {BrushCoat{.tip = {.corner_rounding = corner_rounding}}},
+      absl::StrCat("//test/brush-family:", corner_rounding));
+  ABSL_CHECK_OK(family);
+  return *family;
+}
+
+// Returns `count` strokes in a row along the x-axis, 20 units apart, drawn
+// with alternating brush families.
+std::vector<Stroke> CreateStrokes(int count = 10) {
+  std::vector<BrushFamily> families = {CreateFamily(0), CreateFamily(1)};
+  std::vector<Stroke> strokes;
+  for (int i = 0; i < count; ++i) {
+    absl::StatusOr<Brush> brush =
+        Brush::Create(families[i % 2], Color::Blue(), 2, 0.1);
+    ABSL_CHECK_OK(brush);
+    float x = 20 * i;
+    absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+        {{.position = {x, 0}, .elapsed_time = Duration32::Zero()},
+         {.position = {x + 5, 3}, .elapsed_time = Duration32::Seconds(1)},
+         {.position = {x + 9, -2}, .elapsed_time = Duration32::Seconds(2)}});
+    ABSL_CHECK_OK(inputs);
+    strokes.emplace_back(*brush, *inputs);
+  }
+  return strokes;
+}
+
+std::string WriteDocument(const std::vector<Stroke>& strokes,
+                          bool include_shapes = false) {
+  std::string bytes;
+  {
+    google::protobuf::io::StringOutputStream output(&bytes);
+    ABSL_CHECK_OK(WriteStrokeDocument(strokes, output, include_shapes));
+  }
+  return bytes;
+}
+
+TEST(StrokeDocumentReaderTest, IndexesStrokesWithoutDecodingThem) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  std::string bytes = WriteDocument(strokes);
+
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::Open(bytes);
+  ASSERT_THAT(reader, IsOk());
+  EXPECT_THAT(reader->BrushFamilies(), SizeIs(2));
+  ASSERT_EQ(reader->StrokeCount(), strokes.size());
+  size_t previous_end = 0;
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    const StrokeDocumentReader::StrokeRecord& record =
+        reader->GetStrokeRecord(i);
+    EXPECT_EQ(record.brush_family_index, i % 2);
+    EXPECT_THAT(record.bounds, EnvelopeEq(strokes[i].GetShape().Bounds()));
+    EXPECT_GE(record.offset, previous_end);
+    EXPECT_LE(record.offset + record.size, bytes.size());
+    previous_end = record.offset + record.size;
+  }
+}
+
+TEST(StrokeDocumentReaderTest, DecodeStrokeMatchesDecodeStrokeDocument) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  std::string bytes = WriteDocument(strokes, /*include_shapes=*/true);
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::Open(bytes);
+  ASSERT_THAT(reader, IsOk());
+
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    absl::StatusOr<Stroke> stroke = reader->DecodeStroke(i);
+    ASSERT_THAT(stroke, IsOk());
+    EXPECT_THAT(stroke->GetBrush(), BrushEq(strokes[i].GetBrush()));
+    EXPECT_THAT(stroke->GetInputs(),
+                StrokeInputBatchEq(strokes[i].GetInputs()));
+    EXPECT_EQ(stroke->GetShape().RenderGroupCount(), 1u);
+  }
+}
+
+TEST(StrokeDocumentReaderTest, DecodeStrokeWithSharedPayloads) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  strokes.push_back(strokes[0]);
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(
+      strokes, document_proto, /*include_shapes=*/true,
+      [](const std::string& id) { return std::nullopt; },
+      /*executor=*/nullptr, /*deduplicate_payloads=*/true);
+  ASSERT_GT(document_proto.shared_inputs_size(), 0);
+  std::string bytes = document_proto.SerializeAsString();
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::Open(bytes);
+  ASSERT_THAT(reader, IsOk());
+
+  absl::StatusOr<std::vector<Stroke>> expected =
+      DecodeStrokeDocument(document_proto);
+  ASSERT_THAT(expected, IsOk());
+  ASSERT_EQ(reader->StrokeCount(), expected->size());
+  for (size_t i = 0; i < expected->size(); ++i) {
+    absl::StatusOr<Stroke> stroke = reader->DecodeStroke(i);
+    ASSERT_THAT(stroke, IsOk());
+    EXPECT_THAT(stroke->GetInputs(),
+                StrokeInputBatchEq((*expected)[i].GetInputs()));
+    EXPECT_THAT(stroke->GetShape().Bounds(),
+                EnvelopeEq((*expected)[i].GetShape().Bounds()));
+  }
+}
+
+TEST(StrokeDocumentReaderTest, DecodeSharedPayloadIndexOutOfRange) {
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(
+      CreateStrokes(), document_proto, /*include_shapes=*/false,
+      [](const std::string& id) { return std::nullopt; },
+      /*executor=*/nullptr, /*deduplicate_payloads=*/true);
+  document_proto.mutable_strokes(2)->mutable_shared_inputs()->set_index(7);
+  std::string bytes = document_proto.SerializeAsString();
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::Open(bytes);
+  ASSERT_THAT(reader, IsOk());
+
+  EXPECT_THAT(reader->DecodeStroke(1), IsOk());
+  EXPECT_THAT(reader->DecodeStroke(2),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("out of range")));
+}
+
+TEST(StrokeDocumentReaderTest, OpenReceivesTextureBitmapsStoredAfterStrokes) {
+  std::vector<Stroke> strokes;
+  for (float corner_rounding : {0.f, 1.f}) {
+    absl::StatusOr<BrushFamily> family = BrushFamily::Create(
+        BrushTip{.corner_rounding = corner_rounding},
+        BrushPaint{.texture_layers = {{.client_texture_id = "texture"}}});
+    ASSERT_THAT(family, IsOk());
+    absl::StatusOr<Brush> brush =
+        Brush::Create(*family, Color::Black(), 2, 0.1);
+    ASSERT_THAT(brush, IsOk());
+    strokes.emplace_back(*brush, CreateStrokes(1)[0].GetInputs());
+  }
+  std::string bytes;
+  {
+    google::protobuf::io::StringOutputStream output(&bytes);
+    ASSERT_THAT(WriteStrokeDocument(
+                    strokes, output, /*include_shapes=*/false,
+                    [](const std::string& id) { return "bitmap"; }),
+                IsOk());
+  }
+
+  std::vector<std::string> bitmaps;
+  absl::StatusOr<StrokeDocumentReader> reader = StrokeDocumentReader::Open(
+      bytes,
+      [&bitmaps](const std::string& encoded_id, const std::string& bitmap) {
+        bitmaps.push_back(bitmap);
+        return absl::StrCat("new-", encoded_id);
+      });
+  ASSERT_THAT(reader, IsOk());
+  EXPECT_THAT(bitmaps, ElementsAre("bitmap"));
+  ASSERT_THAT(reader->BrushFamilies(), SizeIs(2));
+  EXPECT_EQ(reader->BrushFamilies()[1]
+                .GetCoats()[0]
+                .paint.texture_layers[0]
+                .client_texture_id,
+            "new-texture");
+}
+
+TEST(StrokeDocumentReaderTest, StrokesIntersectingRegion) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  std::string bytes = WriteDocument(strokes);
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::Open(bytes);
+  ASSERT_THAT(reader, IsOk());
+
+  EXPECT_THAT(
+      reader->StrokesIntersecting(Rect::FromTwoPoints({35, -10}, {65, 10})),
+      ElementsAre(2, 3));
+  EXPECT_THAT(
+      reader->StrokesIntersecting(Rect::FromTwoPoints({0, 50}, {200, 60})),
+      SizeIs(0));
+}
+
+TEST(StrokeDocumentReaderTest, StrokesWithoutBoundsIntersectEverything) {
+  std::vector<Stroke> strokes = CreateStrokes(3);
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+  document_proto.mutable_strokes(1)->clear_bounds();
+  std::string bytes = document_proto.SerializeAsString();
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::Open(bytes);
+  ASSERT_THAT(reader, IsOk());
+
+  EXPECT_TRUE(reader->GetStrokeRecord(1).bounds.IsEmpty());
+  EXPECT_THAT(
+      reader->StrokesIntersecting(Rect::FromTwoPoints({0, 50}, {200, 60})),
+      ElementsAre(1));
+}
+
+TEST(StrokeDocumentReaderTest, DecodeStrokesWithExecutor) {
+  std::vector<Stroke> strokes = CreateStrokes(50);
+  std::string bytes = WriteDocument(strokes);
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::Open(bytes);
+  ASSERT_THAT(reader, IsOk());
+
+  ThreadPerTaskExecutor executor;
+  std::vector<size_t> indices = {40, 3, 17};
+  absl::StatusOr<std::vector<Stroke>> decoded =
+      reader->DecodeStrokes(indices, &executor);
+  ASSERT_THAT(decoded, IsOk());
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+  ASSERT_THAT(*decoded, SizeIs(indices.size()));
+  for (size_t i = 0; i < indices.size(); ++i) {
+    EXPECT_THAT((*decoded)[i].GetInputs(),
+                StrokeInputBatchEq(strokes[indices[i]].GetInputs()));
+  }
+}
+
+TEST(StrokeDocumentReaderTest, OpenFile) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  std::string path =
+      absl::StrCat(::testing::TempDir(), "/stroke_document_reader_test.ink");
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << WriteDocument(strokes);
+  }
+
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::OpenFile(path);
+  ASSERT_THAT(reader, IsOk());
+  ASSERT_EQ(reader->StrokeCount(), strokes.size());
+  absl::StatusOr<Stroke> stroke = reader->DecodeStroke(7);
+  ASSERT_THAT(stroke, IsOk());
+  EXPECT_THAT(stroke->GetInputs(), StrokeInputBatchEq(strokes[7].GetInputs()));
+}
+
+TEST(StrokeDocumentReaderTest, OpenEmptyFile) {
+  std::string path =
+      absl::StrCat(::testing::TempDir(), "/stroke_document_reader_empty.ink");
+  { std::ofstream file(path, std::ios::binary); }
+
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::OpenFile(path);
+  ASSERT_THAT(reader, IsOk());
+  EXPECT_EQ(reader->StrokeCount(), 0u);
+}
+
+TEST(StrokeDocumentReaderTest, OpenMissingFile) {
+  EXPECT_THAT(StrokeDocumentReader::OpenFile(absl::StrCat(
+                  ::testing::TempDir(), "/no_such_stroke_document.ink")),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(StrokeDocumentReaderTest, OpenTruncatedDocument) {
+  std::string bytes = WriteDocument(CreateStrokes());
+  bytes.resize(bytes.size() - 5);
+  EXPECT_THAT(StrokeDocumentReader::Open(bytes),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("truncated")));
+}
+
+TEST(StrokeDocumentReaderTest, OpenBrushFamilyIndexOutOfRange) {
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(CreateStrokes(), document_proto);
+  document_proto.mutable_strokes(4)->set_brush_family_index(2);
+  std::string bytes = document_proto.SerializeAsString();
+  EXPECT_THAT(StrokeDocumentReader::Open(bytes),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("brush_family_index")));
+}
+
+TEST(StrokeDocumentReaderTest, DecodeInvalidStroke) {
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(CreateStrokes(), document_proto);
+  document_proto.mutable_strokes(2)->set_size_stroke_space(-1);
+  std::string bytes = document_proto.SerializeAsString();
+  absl::StatusOr<StrokeDocumentReader> reader =
+      StrokeDocumentReader::Open(bytes);
+  ASSERT_THAT(reader, IsOk());
+
+  EXPECT_THAT(reader->DecodeStroke(1), IsOk());
+  EXPECT_THAT(reader->DecodeStroke(2),
+              StatusIs(absl::StatusCode::kInvalidArgument, HasSubstr("size")));
+  EXPECT_THAT(reader->DecodeStrokes({1, 2, 3}),
+              StatusIs(absl::StatusCode::kInvalidArgument, HasSubstr("size")));
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,542 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/storage/stroke_document.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "google/protobuf/message_lite.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/brush/type_matchers.h"
+#include "ink/color/color.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/storage/proto/brush_family.pb.h"
+#include "ink/storage/proto/stroke_document.pb.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/input/type_matchers.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Pair;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+BrushFamily CreateFamily(float corner_rounding, int coat_count = 1) {
+  std::vector<BrushCoat> coats(
+      coat_count, BrushCoat{.tip = {.corner_rounding = corner_rounding}});
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(
+      coats, absl::StrCat("//test/brush-family:", corner_rounding));
+  ABSL_CHECK_OK(family);
+  return *family;
+}
+
+Brush CreateBrush(const BrushFamily& family, const Color& color, float size) {
+  absl::StatusOr<Brush> brush = Brush::Create(family, color, size, 0.1);
+  ABSL_CHECK_OK(brush);
+  return *brush;
+}
+
+StrokeInputBatch CreateInputs(float offset) {
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {offset, 0}, .elapsed_time = Duration32::Zero()},
+       {.position = {offset + 5, 3}, .elapsed_time = Duration32::Seconds(1)},
+       {.position = {offset + 9, -2}, .elapsed_time = Duration32::Seconds(2)}});
+  ABSL_CHECK_OK(inputs);
+  return *inputs;
+}
+
+std::vector<Stroke> CreateStrokes(int count = 10) {
+  std::vector<BrushFamily> families = {CreateFamily(0), CreateFamily(0.5),
+                                       CreateFamily(1)};
+  std::vector<Stroke> strokes;
+  for (int i = 0; i < count; ++i) {
+    strokes.emplace_back(CreateBrush(families[i % families.size()],
+                                     i % 2 == 0 ? Color::Red() : Color::Blue(),
+                                     5 + i),
+                         CreateInputs(i * 10));
+  }
+  return strokes;
+}
+
+std::string SerializeDeterministically(
+    const google::protobuf::MessageLite& message) {
+  std::string bytes;
+  {
+    google::protobuf::io::StringOutputStream output(&bytes);
+    google::protobuf::io::CodedOutputStream coded_output(&output);
+    coded_output.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&coded_output);
+  }
+  return bytes;
+}
+
+TEST(StrokeDocumentTest, EncodeEmptyDocument) {
+  proto::CodedStrokeDocument document_proto;
+  document_proto.add_strokes();
+  EncodeStrokeDocument({}, document_proto);
+  EXPECT_EQ(document_proto.brush_families_size(), 0);
+  EXPECT_EQ(document_proto.strokes_size(), 0);
+
+  absl::StatusOr<std::vector<Stroke>> strokes =
+      DecodeStrokeDocument(document_proto);
+  ASSERT_THAT(strokes, IsOk());
+  EXPECT_THAT(*strokes, SizeIs(0));
+}
+
+TEST(StrokeDocumentTest, EncodeStoresEachBrushFamilyOnce) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+
+  EXPECT_EQ(document_proto.brush_families_size(), 3);
+  ASSERT_EQ(document_proto.strokes_size(), 10);
+  for (int i = 0; i < document_proto.strokes_size(); ++i) {
+    EXPECT_EQ(document_proto.strokes(i).brush_family_index(), i % 3);
+    EXPECT_FALSE(document_proto.strokes(i).has_shape());
+  }
+}
+
+TEST(StrokeDocumentTest, EncodeDistinguishesFamiliesByContent) {
+  // Two families with the same ID but different tips are not the same family.
+  absl::StatusOr<BrushFamily> family_a = BrushFamily::Create(
+      BrushTip{.corner_rounding = 0}, BrushPaint{}, "//test/brush-family:same");
+  ASSERT_THAT(family_a, IsOk());
+  absl::StatusOr<BrushFamily> family_b = BrushFamily::Create(
+      BrushTip{.corner_rounding = 1}, BrushPaint{}, "//test/brush-family:same");
+  ASSERT_THAT(family_b, IsOk());
+  std::vector<Stroke> strokes = {
+      Stroke(CreateBrush(*family_a, Color::Black(), 3), CreateInputs(0)),
+      Stroke(CreateBrush(*family_b, Color::Black(), 3), CreateInputs(0))};
+
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+  EXPECT_EQ(document_proto.brush_families_size(), 2);
+}
+
+TEST(StrokeDocumentTest, RoundTrip) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+
+  absl::StatusOr<std::vector<Stroke>> decoded =
+      DecodeStrokeDocument(document_proto);
+  ASSERT_THAT(decoded, IsOk());
+  ASSERT_EQ(decoded->size(), strokes.size());
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    EXPECT_THAT((*decoded)[i].GetBrush(), BrushEq(strokes[i].GetBrush()));
+    EXPECT_THAT((*decoded)[i].GetInputs(),
+                StrokeInputBatchEq(strokes[i].GetInputs()));
+    EXPECT_EQ((*decoded)[i].GetShape().RenderGroupCount(),
+              strokes[i].GetShape().RenderGroupCount());
+  }
+}
+
+// Returns strokes drawn with two families that both use the texture
+// "shared-texture".
+std::vector<Stroke> CreateTexturedStrokes() {
+  std::vector<Stroke> strokes;
+  for (float corner_rounding : {0.f, 1.f}) {
+    absl::StatusOr<BrushFamily> family =
+        BrushFamily::Create(BrushTip{.corner_rounding = corner_rounding},
+                            BrushPaint{.texture_layers = {
+                                           {.client_texture_id =
+                                                "shared-texture"}}});
+    ABSL_CHECK_OK(family);
+    strokes.emplace_back(CreateBrush(*family, Color::Black(), 3),
+                         CreateInputs(corner_rounding * 10));
+  }
+  return strokes;
+}
+
+TEST(StrokeDocumentTest, EncodeStoresEachTextureBitmapOnce) {
+  std::vector<Stroke> strokes = CreateTexturedStrokes();
+  int get_bitmap_calls = 0;
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto, /*include_shapes=*/false,
+                       [&get_bitmap_calls](const std::string& id) {
+                         ++get_bitmap_calls;
+                         return absl::StrCat("bitmap:", id);
+                       });
+
+  EXPECT_EQ(get_bitmap_calls, 1);
+  ASSERT_EQ(document_proto.brush_families_size(), 2);
+  for (const proto::BrushFamily& family_proto :
+       document_proto.brush_families()) {
+    EXPECT_EQ(family_proto.texture_id_to_bitmap_size(), 0);
+  }
+  EXPECT_THAT(document_proto.texture_id_to_bitmap(),
+              UnorderedElementsAre(
+                  Pair("shared-texture", "bitmap:shared-texture")));
+}
+
+TEST(StrokeDocumentTest, DecodeReceivesEachTextureBitmapOnce) {
+  std::vector<Stroke> strokes = CreateTexturedStrokes();
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(
+      strokes, document_proto, /*include_shapes=*/false,
+      [](const std::string& id) { return absl::StrCat("bitmap:", id); });
+
+  std::vector<std::pair<std::string, std::string>> received;
+  absl::StatusOr<std::vector<Stroke>> decoded = DecodeStrokeDocument(
+      document_proto,
+      [&received](const std::string& encoded_id, const std::string& bitmap) {
+        received.emplace_back(encoded_id, bitmap);
+        return absl::StrCat("new:", encoded_id);
+      });
+  ASSERT_THAT(decoded, IsOk());
+  EXPECT_THAT(received,
+              ElementsAre(Pair("shared-texture", "bitmap:shared-texture")));
+  ASSERT_THAT(*decoded, SizeIs(2));
+  for (const Stroke& stroke : *decoded) {
+    EXPECT_EQ(stroke.GetBrush()
+                  .GetCoats()[0]
+                  .paint.texture_layers[0]
+                  .client_texture_id,
+              "new:shared-texture");
+  }
+}
+
+TEST(StrokeDocumentTest, DecodeTextureBitmapStoredInFamily) {
+  // Documents written before bitmaps were stored per document have them in
+  // each family instead.
+  std::vector<Stroke> strokes = CreateTexturedStrokes();
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+  (*document_proto.mutable_brush_families(0)
+        ->mutable_texture_id_to_bitmap())["shared-texture"] = "family-bitmap";
+
+  std::vector<std::string> bitmaps;
+  absl::StatusOr<std::vector<BrushFamily>> families =
+      DecodeStrokeDocumentBrushFamilies(
+          document_proto,
+          [&bitmaps](const std::string& encoded_id, const std::string& bitmap) {
+            bitmaps.push_back(bitmap);
+            return encoded_id;
+          });
+  ASSERT_THAT(families, IsOk());
+  EXPECT_THAT(*families, SizeIs(2));
+  EXPECT_THAT(bitmaps, ElementsAre("family-bitmap"));
+}
+
+TEST(StrokeDocumentTest, RoundTripWithShapes) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto, /*include_shapes=*/true);
+  for (const proto::CodedDocumentStroke& stroke_proto :
+       document_proto.strokes()) {
+    EXPECT_TRUE(stroke_proto.has_shape());
+  }
+
+  absl::StatusOr<std::vector<Stroke>> decoded =
+      DecodeStrokeDocument(document_proto);
+  ASSERT_THAT(decoded, IsOk());
+  ASSERT_EQ(decoded->size(), strokes.size());
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    EXPECT_THAT((*decoded)[i].GetBrush(), BrushEq(strokes[i].GetBrush()));
+    EXPECT_THAT((*decoded)[i].GetShape().Bounds(),
+                EnvelopeEq(strokes[i].GetShape().Bounds()));
+  }
+}
+
+TEST(StrokeDocumentTest, EncodeWithExecutorMatchesSerialEncode) {
+  std::vector<Stroke> strokes = CreateStrokes(50);
+  proto::CodedStrokeDocument serial_proto;
+  EncodeStrokeDocument(strokes, serial_proto, /*include_shapes=*/true);
+
+  ThreadPerTaskExecutor executor;
+  proto::CodedStrokeDocument parallel_proto;
+  EncodeStrokeDocument(
+      strokes, parallel_proto, /*include_shapes=*/true,
+      [](const std::string& id) { return std::nullopt; }, &executor);
+
+  EXPECT_GT(executor.ParallelForCalls(), 0);
+  EXPECT_EQ(SerializeDeterministically(parallel_proto),
+            SerializeDeterministically(serial_proto));
+}
+
+TEST(StrokeDocumentTest, WriteMatchesSerializedEncoding) {
+  // Enough strokes to be written in more than one batch.
+  std::vector<Stroke> strokes = CreateStrokes(600);
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+  std::string expected_bytes = SerializeDeterministically(document_proto);
+
+  std::string serial_bytes;
+  {
+    google::protobuf::io::StringOutputStream output(&serial_bytes);
+    ASSERT_THAT(WriteStrokeDocument(strokes, output), IsOk());
+  }
+  EXPECT_EQ(serial_bytes, expected_bytes);
+
+  ThreadPerTaskExecutor executor;
+  std::string parallel_bytes;
+  {
+    google::protobuf::io::StringOutputStream output(&parallel_bytes);
+    ASSERT_THAT(WriteStrokeDocument(
+                    strokes, output, /*include_shapes=*/false,
+                    [](const std::string& id) { return std::nullopt; },
+                    &executor),
+                IsOk());
+  }
+  EXPECT_EQ(parallel_bytes, expected_bytes);
+
+  proto::CodedStrokeDocument parsed_proto;
+  ASSERT_TRUE(parsed_proto.ParseFromString(parallel_bytes));
+  absl::StatusOr<std::vector<Stroke>> decoded =
+      DecodeStrokeDocument(parsed_proto);
+  ASSERT_THAT(decoded, IsOk());
+  EXPECT_THAT(*decoded, SizeIs(strokes.size()));
+}
+
+TEST(StrokeDocumentTest, WriteWithTexturesMatchesSerializedEncoding) {
+  std::vector<Stroke> strokes = CreateTexturedStrokes();
+  TextureBitmapProvider get_bitmap = [](const std::string& id) {
+    return absl::StrCat("bitmap:", id);
+  };
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto, /*include_shapes=*/false,
+                       get_bitmap);
+
+  std::string bytes;
+  {
+    google::protobuf::io::StringOutputStream output(&bytes);
+    ASSERT_THAT(WriteStrokeDocument(strokes, output, /*include_shapes=*/false,
+                                    get_bitmap),
+                IsOk());
+  }
+  EXPECT_EQ(bytes, SerializeDeterministically(document_proto));
+}
+
+TEST(StrokeDocumentTest, WriteToFullOutput) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  char buffer[16];
+  google::protobuf::io::ArrayOutputStream output(buffer, sizeof(buffer));
+  EXPECT_THAT(WriteStrokeDocument(strokes, output),
+              StatusIs(absl::StatusCode::kDataLoss, HasSubstr("write")));
+}
+
+proto::CodedStrokeDocument EncodeDeduplicated(absl::Span<const Stroke> strokes,
+                                              bool include_shapes) {
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(
+      strokes, document_proto, include_shapes,
+      [](const std::string& id) { return std::nullopt; },
+      /*executor=*/nullptr, /*deduplicate_payloads=*/true);
+  return document_proto;
+}
+
+TEST(StrokeDocumentTest, DeduplicateStoresTranslatedInputsOnce) {
+  // The strokes from `CreateStrokes()` have the same inputs, translated.
+  std::vector<Stroke> strokes = CreateStrokes();
+  absl::StatusOr<StrokeInputBatch> other_inputs = StrokeInputBatch::Create(
+      {{.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+       {.position = {1, 7}, .elapsed_time = Duration32::Seconds(1)}});
+  ASSERT_THAT(other_inputs, IsOk());
+  strokes.emplace_back(CreateBrush(CreateFamily(0), Color::Red(), 5),
+                       *other_inputs);
+  proto::CodedStrokeDocument document_proto =
+      EncodeDeduplicated(strokes, /*include_shapes=*/false);
+
+  ASSERT_EQ(document_proto.shared_inputs_size(), 1);
+  EXPECT_EQ(document_proto.shared_shapes_size(), 0);
+  EXPECT_FALSE(document_proto.shared_inputs(0).x_stroke_space().has_offset());
+  ASSERT_EQ(document_proto.strokes_size(), 11);
+  for (int i = 0; i < 10; ++i) {
+    const proto::CodedDocumentStroke& stroke_proto = document_proto.strokes(i);
+    EXPECT_FALSE(stroke_proto.has_inputs());
+    EXPECT_EQ(stroke_proto.shared_inputs().index(), 0);
+    EXPECT_THAT(stroke_proto.shared_inputs().position_offsets(), SizeIs(2));
+  }
+  EXPECT_TRUE(document_proto.strokes(10).has_inputs());
+  EXPECT_FALSE(document_proto.strokes(10).has_shared_inputs());
+
+  proto::CodedStrokeDocument full_document_proto;
+  EncodeStrokeDocument(strokes, full_document_proto);
+  EXPECT_LT(document_proto.ByteSizeLong(), full_document_proto.ByteSizeLong());
+
+  // The decoded inputs are the same as without deduplication.
+  absl::StatusOr<std::vector<Stroke>> decoded =
+      DecodeStrokeDocument(document_proto);
+  ASSERT_THAT(decoded, IsOk());
+  absl::StatusOr<std::vector<Stroke>> full_decoded =
+      DecodeStrokeDocument(full_document_proto);
+  ASSERT_THAT(full_decoded, IsOk());
+  ASSERT_EQ(decoded->size(), full_decoded->size());
+  for (size_t i = 0; i < decoded->size(); ++i) {
+    EXPECT_THAT((*decoded)[i].GetBrush(), BrushEq(strokes[i].GetBrush()));
+    EXPECT_THAT((*decoded)[i].GetInputs(),
+                StrokeInputBatchEq((*full_decoded)[i].GetInputs()));
+  }
+}
+
+TEST(StrokeDocumentTest, DeduplicateSharesIdenticalShapes) {
+  Stroke stroke(CreateBrush(CreateFamily(0), Color::Red(), 5),
+                CreateInputs(0));
+  Stroke other_stroke(
+      CreateBrush(CreateFamily(1, /*coat_count=*/2), Color::Blue(), 3),
+      CreateInputs(7));
+  std::vector<Stroke> strokes = {stroke, other_stroke, stroke, stroke};
+  proto::CodedStrokeDocument document_proto =
+      EncodeDeduplicated(strokes, /*include_shapes=*/true);
+
+  EXPECT_EQ(document_proto.shared_shapes_size(), 1);
+  for (int i : {0, 2, 3}) {
+    EXPECT_FALSE(document_proto.strokes(i).has_shape());
+    EXPECT_EQ(document_proto.strokes(i).shared_shape().index(), 0);
+  }
+  EXPECT_TRUE(document_proto.strokes(1).has_shape());
+
+  absl::StatusOr<std::vector<Stroke>> decoded =
+      DecodeStrokeDocument(document_proto);
+  ASSERT_THAT(decoded, IsOk());
+  ASSERT_EQ(decoded->size(), strokes.size());
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    EXPECT_THAT((*decoded)[i].GetShape().Bounds(),
+                EnvelopeEq(strokes[i].GetShape().Bounds()));
+  }
+  // The copies at the same position share the decoded shape.
+  EXPECT_EQ((*decoded)[0].GetShape().Meshes().data(),
+            (*decoded)[2].GetShape().Meshes().data());
+  EXPECT_EQ((*decoded)[0].GetShape().Meshes().data(),
+            (*decoded)[3].GetShape().Meshes().data());
+}
+
+TEST(StrokeDocumentTest, DecodeSharedInputsIndexOutOfRange) {
+  proto::CodedStrokeDocument document_proto =
+      EncodeDeduplicated(CreateStrokes(), /*include_shapes=*/false);
+  document_proto.mutable_strokes(3)->mutable_shared_inputs()->set_index(1);
+
+  EXPECT_THAT(DecodeStrokeDocument(document_proto),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("shared_inputs index 1 is out of range")));
+}
+
+TEST(StrokeDocumentTest, DecodeSharedInputsWithWrongOffsetCount) {
+  proto::CodedStrokeDocument document_proto =
+      EncodeDeduplicated(CreateStrokes(), /*include_shapes=*/false);
+  document_proto.mutable_strokes(3)
+      ->mutable_shared_inputs()
+      ->add_position_offsets(0);
+
+  EXPECT_THAT(DecodeStrokeDocument(document_proto),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("position offsets")));
+}
+
+TEST(StrokeDocumentTest, DecodeWithExecutor) {
+  std::vector<Stroke> strokes = CreateStrokes(50);
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+
+  ThreadPerTaskExecutor executor;
+  absl::StatusOr<std::vector<Stroke>> decoded = DecodeStrokeDocument(
+      document_proto,
+      [](const std::string& encoded_id, const std::string& bitmap) {
+        return encoded_id;
+      },
+      &executor);
+  ASSERT_THAT(decoded, IsOk());
+  EXPECT_GT(executor.ParallelForCalls(), 0);
+  ASSERT_EQ(decoded->size(), strokes.size());
+  for (size_t i = 0; i < strokes.size(); ++i) {
+    EXPECT_THAT((*decoded)[i].GetBrush(), BrushEq(strokes[i].GetBrush()));
+    EXPECT_THAT((*decoded)[i].GetInputs(),
+                StrokeInputBatchEq(strokes[i].GetInputs()));
+  }
+}
+
+TEST(StrokeDocumentTest, DecodeReturnsErrorForFirstInvalidStroke) {
+  std::vector<Stroke> strokes = CreateStrokes(50);
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+  document_proto.mutable_strokes(12)->set_brush_family_index(3);
+  document_proto.mutable_strokes(40)->set_size_stroke_space(-1);
+
+  ThreadPerTaskExecutor executor;
+  EXPECT_THAT(DecodeStrokeDocument(
+                  document_proto,
+                  [](const std::string& encoded_id, const std::string& bitmap) {
+                    return encoded_id;
+                  },
+                  &executor),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("brush_family_index")));
+}
+
+TEST(StrokeDocumentTest, DecodeBrushFamilyIndexOutOfRange) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+  document_proto.mutable_strokes(4)->set_brush_family_index(3);
+
+  EXPECT_THAT(DecodeStrokeDocument(document_proto),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("brush_family_index")));
+}
+
+TEST(StrokeDocumentTest, DecodeInvalidBrush) {
+  std::vector<Stroke> strokes = CreateStrokes();
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto);
+  document_proto.mutable_strokes(2)->set_size_stroke_space(-1);
+
+  EXPECT_THAT(DecodeStrokeDocument(document_proto),
+              StatusIs(absl::StatusCode::kInvalidArgument, HasSubstr("size")));
+}
+
+TEST(StrokeDocumentTest, DecodeShapeWithWrongRenderGroupCount) {
+  std::vector<Stroke> strokes = {
+      Stroke(CreateBrush(CreateFamily(0, 1), Color::Red(), 5), CreateInputs(0)),
+      Stroke(CreateBrush(CreateFamily(0, 2), Color::Red(), 5),
+             CreateInputs(0))};
+  proto::CodedStrokeDocument document_proto;
+  EncodeStrokeDocument(strokes, document_proto, /*include_shapes=*/true);
+  *document_proto.mutable_strokes(1)->mutable_shape() =
+      document_proto.strokes(0).shape();
+
+  EXPECT_THAT(DecodeStrokeDocument(document_proto),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("render groups")));
+}
+
+}  // namespace
+}  // namespace ink
@@ -15,22 +15,28 @@
 #include "ink/storage/stroke_input_batch.h"
 
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <optional>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/rect.h"
-#include "ink/storage/input_batch.h"
+#include "ink/storage/decode_options.h"
+#include "ink/storage/numeric_run.h"
 #include "ink/storage/proto/coded_numeric_run.pb.h"
 #include "ink/storage/proto/stroke_input_batch.pb.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
-#include "ink/types/duration.h"
-#include "ink/types/iterator_range.h"
 #include "ink/types/physical_distance.h"
+#include "ink/types/trace.h"
 
 namespace ink {
 
@@ -62,24 +68,95 @@ CodedStrokeInputBatch::ToolType ToProtoToolType(StrokeInput::ToolType type) {
   }
 }
 
-}  // namespace
+// The largest magnitude of a scaled value that we allow to be converted to an
+// integer for encoding. (Using INT_MAX here doesn't prevent overflow problems
+// because of float rounding, so instead we use INT_MAX/2 to give ourselves some
+// headroom.)
+constexpr float kMaxScaledValue = std::numeric_limits<int32_t>::max() / 2;
 
-void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
-                            CodedStrokeInputBatch& input_proto) {
+// Returns `inverse_scale`, reduced if necessary so that values in the range
+// [0, `max_value`] can be encoded with it without overflowing the encoded
+// integers.
+float ClampInverseScale(float inverse_scale, float max_value) {
+  if (max_value > 0.f) {
+    inverse_scale = std::fmin(inverse_scale, kMaxScaledValue / max_value);
+  }
+  return inverse_scale;
+}
+
+// Like `ClampInverseScale()`, but for positions in a range of semi-extent
+// `semi_extent` relative to its minimum, which avoids computing the full extent
+// since it may overflow.
+float ClampPositionInverseScale(float inverse_scale, float semi_extent) {
+  if (semi_extent > 0.f) {
+    inverse_scale =
+        std::fmin(inverse_scale, (0.5f * kMaxScaledValue) / semi_extent);
+  }
+  return inverse_scale;
+}
+
+bool IsValidMaxError(float max_error) {
+  return std::isfinite(max_error) && max_error > 0.f;
+}
+
+absl::Status ValidateEncodingOptions(
+    const StrokeInputBatchEncodingOptions& options) {
+  if (options.max_position_error.has_value() &&
+      !IsValidMaxError(*options.max_position_error)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "`max_position_error` must be finite and positive; got ",
+        *options.max_position_error));
+  }
+  if (options.max_elapsed_time_error.has_value() &&
+      !IsValidMaxError(options.max_elapsed_time_error->ToSeconds())) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "`max_elapsed_time_error` must be finite and positive; got ",
+        *options.max_elapsed_time_error));
+  }
+  if (options.max_pressure_error.has_value() &&
+      !IsValidMaxError(*options.max_pressure_error)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "`max_pressure_error` must be finite and positive; got ",
+        *options.max_pressure_error));
+  }
+  if (options.max_tilt_error.has_value() &&
+      !IsValidMaxError(options.max_tilt_error->ValueInRadians())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`max_tilt_error` must be finite and positive; got ",
+                     *options.max_tilt_error));
+  }
+  if (options.max_orientation_error.has_value() &&
+      !IsValidMaxError(options.max_orientation_error->ValueInRadians())) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "`max_orientation_error` must be finite and positive; got ",
+        *options.max_orientation_error));
+  }
+  return absl::OkStatus();
+}
+
+void EncodeStrokeInputBatchImpl(const StrokeInputBatch& input_batch,
+                                const StrokeInputBatchEncodingOptions& options,
+                                CodedStrokeInputBatch& input_proto) {
   if (input_batch.Size() == 0) {
     input_proto.Clear();
     input_proto.set_noise_seed(input_batch.GetNoiseSeed());
     return;
   }
+  absl::Span<const float> xs = input_batch.GetXPositions();
+  absl::Span<const float> ys = input_batch.GetYPositions();
+  absl::Span<const float> times = input_batch.GetElapsedTimesInSeconds();
+  absl::Span<const float> pressures = input_batch.GetPressures();
+  absl::Span<const float> tilts = input_batch.GetTiltsInRadians();
+  absl::Span<const float> orientations = input_batch.GetOrientationsInRadians();
+
   // Determine the envelope for the input positions and the maximum input time
   // value.
-  Rect stroke_space_bounds =
-      Rect::FromCenterAndDimensions(input_batch.Get(0).position, 0, 0);
+  Rect stroke_space_bounds = Rect::FromTwoPoints(
+      {*absl::c_min_element(xs), *absl::c_min_element(ys)},
+      {*absl::c_max_element(xs), *absl::c_max_element(ys)});
   float elapsed_time_seconds_max = 0.0f;
-  for (auto input : input_batch) {
-    stroke_space_bounds.Join(input.position);
-    elapsed_time_seconds_max =
-        std::fmax(elapsed_time_seconds_max, input.elapsed_time.ToSeconds());
+  for (float time : times) {
+    elapsed_time_seconds_max = std::fmax(elapsed_time_seconds_max, time);
   }
 
   // The encoded x-positions are offset and scaled relative to the envelope
@@ -91,12 +168,17 @@ void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
   CodedNumericRun* x_stroke_space = input_proto.mutable_x_stroke_space();
   const float bounds_semi_width = stroke_space_bounds.SemiWidth();
   const float inverse_x_scale =
-      bounds_semi_width > 0.f
+      options.max_position_error.has_value()
+          ? ClampPositionInverseScale(1.f / *options.max_position_error,
+                                      bounds_semi_width)
+      : bounds_semi_width > 0.f
           ? (0.5f * kInverseEnvelopeXScale) / bounds_semi_width
           : 1.f;
   x_stroke_space->set_scale(1.f / inverse_x_scale);
   x_stroke_space->set_offset(stroke_space_bounds.XMin());
   x_stroke_space->mutable_deltas()->Clear();
+  x_stroke_space->clear_bit_packed_deltas();
+  x_stroke_space->clear_checkpoints();
   x_stroke_space->mutable_deltas()->Reserve(input_batch.Size());
 
   // Likewise, the encoded Y-positions are also offset and scaled to the
@@ -104,12 +186,17 @@ void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
   CodedNumericRun* y_stroke_space = input_proto.mutable_y_stroke_space();
   const float bounds_semi_height = stroke_space_bounds.SemiHeight();
   const float inverse_y_scale =
-      bounds_semi_height > 0.f
+      options.max_position_error.has_value()
+          ? ClampPositionInverseScale(1.f / *options.max_position_error,
+                                      bounds_semi_height)
+      : bounds_semi_height > 0.f
           ? (0.5f * kInverseEnvelopeYScale) / bounds_semi_height
           : 1.f;
   y_stroke_space->set_scale(1.f / inverse_y_scale);
   y_stroke_space->set_offset(stroke_space_bounds.YMin());
   y_stroke_space->mutable_deltas()->Clear();
+  y_stroke_space->clear_bit_packed_deltas();
+  y_stroke_space->clear_checkpoints();
   y_stroke_space->mutable_deltas()->Reserve(input_batch.Size());
 
   // In most cases, we can use a fixed offset/scale for time, since the
@@ -120,23 +207,39 @@ void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
   //
   // However, if for some reason the maximum time value is larger than expected,
   // we need to calculate a less-precise scaling factor to prevent float-to-int
-  // conversion from overflowing.  (Using INT_MAX in the below calculation
-  // doesn't prevent the overflow problem because of float rounding, so instead
-  // we use INT_MAX/2 to give ourselves some headroom there.)
-  float inverse_time_scale =
-      elapsed_time_seconds_max > 0.f
-          ? std::fmin(
-                kDefaultInverseTimeScale,
-                static_cast<float>(std::numeric_limits<int32_t>::max() / 2) /
-                    elapsed_time_seconds_max)
-          : kDefaultInverseTimeScale;
+  // conversion from overflowing.
+  float inverse_time_scale = ClampInverseScale(
+      options.max_elapsed_time_error.has_value()
+          ? 1.f / options.max_elapsed_time_error->ToSeconds()
+          : kDefaultInverseTimeScale,
+      elapsed_time_seconds_max);
   CodedNumericRun* elapsed_time_seconds =
       input_proto.mutable_elapsed_time_seconds();
   elapsed_time_seconds->set_scale(1.f / inverse_time_scale);
   elapsed_time_seconds->clear_offset();
   elapsed_time_seconds->mutable_deltas()->Clear();
+  elapsed_time_seconds->clear_bit_packed_deltas();
+  elapsed_time_seconds->clear_checkpoints();
   elapsed_time_seconds->mutable_deltas()->Reserve(input_batch.Size());
 
+  // Pressure, tilt and orientation values each have a fixed range, so their
+  // scales only depend on the requested precision.
+  const float inverse_pressure_scale =
+      options.max_pressure_error.has_value()
+          ? ClampInverseScale(1.f / *options.max_pressure_error, 1.f)
+          : kInversePressureScale;
+  const float inverse_tilt_scale =
+      options.max_tilt_error.has_value()
+          ? ClampInverseScale(1.f / options.max_tilt_error->ValueInRadians(),
+                              kQuarterTurn.ValueInRadians())
+          : kInverseTiltScale;
+  const float inverse_orientation_scale =
+      options.max_orientation_error.has_value()
+          ? ClampInverseScale(
+                1.f / options.max_orientation_error->ValueInRadians(),
+                kFullTurn.ValueInRadians())
+          : kInverseOrientationScale;
+
   // If the input_batch doesn't have pressure data, then we can omit pressure
   // data from the CodedStrokeInputBatch, clearing possible existing data.
   // Otherwise, set up for recording the pressure data.
@@ -147,9 +250,11 @@ void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
     pressure = input_proto.mutable_pressure();
     // Pressure values always range from 0 to 1, so we can just use a fixed
     // offset/scale for the CodedNumericRun.
-    pressure->set_scale(1.f / kInversePressureScale);
+    pressure->set_scale(1.f / inverse_pressure_scale);
     pressure->clear_offset();
     pressure->mutable_deltas()->Clear();
+    pressure->clear_bit_packed_deltas();
+    pressure->clear_checkpoints();
     pressure->mutable_deltas()->Reserve(input_batch.Size());
   }
 
@@ -163,9 +268,11 @@ void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
     tilt = input_proto.mutable_tilt();
     // Tilt values always range from 0 to pi/2, so we can just use a fixed
     // offset/scale for the CodedNumericRun.
-    tilt->set_scale(1.f / kInverseTiltScale);
+    tilt->set_scale(1.f / inverse_tilt_scale);
     tilt->clear_offset();
     tilt->mutable_deltas()->Clear();
+    tilt->clear_bit_packed_deltas();
+    tilt->clear_checkpoints();
     tilt->mutable_deltas()->Reserve(input_batch.Size());
   }
 
@@ -179,9 +286,11 @@ void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
     orientation = input_proto.mutable_orientation();
     // Orientation values always range from 0 to 2pi, so we can just use a fixed
     // offset/scale for the CodedNumericRun.
-    orientation->set_scale(1.f / kInverseOrientationScale);
+    orientation->set_scale(1.f / inverse_orientation_scale);
     orientation->clear_offset();
     orientation->mutable_deltas()->Clear();
+    orientation->clear_bit_packed_deltas();
+    orientation->clear_checkpoints();
     orientation->mutable_deltas()->Reserve(input_batch.Size());
   }
 
@@ -196,36 +305,50 @@ void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
   int last_int_pressure = 0;
   int last_int_tilt = 0;
   int last_int_orientation = 0;
-  for (auto input : input_batch) {
-    int int_x =
-        static_cast<int>(input.position.x * inverse_x_scale - scaled_x_origin);
-    int int_y =
-        static_cast<int>(input.position.y * inverse_y_scale - scaled_y_origin);
+  // Values are normally truncated to integers. When a channel has a requested
+  // maximum error, they are instead rounded to the nearest integer (all of the
+  // scaled values are non-negative, so adding 0.5 before truncating suffices),
+  // which keeps the error within half the scale, and so comfortably within the
+  // bound despite float rounding.
+  const float position_rounding =
+      options.max_position_error.has_value() ? 0.5f : 0.f;
+  const float time_rounding =
+      options.max_elapsed_time_error.has_value() ? 0.5f : 0.f;
+  const float pressure_rounding =
+      options.max_pressure_error.has_value() ? 0.5f : 0.f;
+  const float tilt_rounding = options.max_tilt_error.has_value() ? 0.5f : 0.f;
+  const float orientation_rounding =
+      options.max_orientation_error.has_value() ? 0.5f : 0.f;
+  for (size_t i = 0; i < input_batch.Size(); ++i) {
+    int int_x = static_cast<int>(xs[i] * inverse_x_scale - scaled_x_origin +
+                                 position_rounding);
+    int int_y = static_cast<int>(ys[i] * inverse_y_scale - scaled_y_origin +
+                                 position_rounding);
     x_stroke_space->add_deltas(int_x - last_int_x);
     y_stroke_space->add_deltas(int_y - last_int_y);
     last_int_x = int_x;
     last_int_y = int_y;
 
-    int32_t int_time = static_cast<int32_t>(input.elapsed_time.ToSeconds() *
-                                            inverse_time_scale);
+    int32_t int_time =
+        static_cast<int32_t>(times[i] * inverse_time_scale + time_rounding);
     elapsed_time_seconds->add_deltas(int_time - last_int_time);
     last_int_time = int_time;
 
     if (input_batch.HasPressure()) {
-      int int_pressure =
-          static_cast<int>(input.pressure * kInversePressureScale);
+      int int_pressure = static_cast<int>(
+          pressures[i] * inverse_pressure_scale + pressure_rounding);
       pressure->add_deltas(int_pressure - last_int_pressure);
       last_int_pressure = int_pressure;
     }
     if (input_batch.HasTilt()) {
       int int_tilt =
-          static_cast<int>(input.tilt.ValueInRadians() * kInverseTiltScale);
+          static_cast<int>(tilts[i] * inverse_tilt_scale + tilt_rounding);
       tilt->add_deltas(int_tilt - last_int_tilt);
       last_int_tilt = int_tilt;
     }
     if (input_batch.HasOrientation()) {
       int int_orientation = static_cast<int>(
-          input.orientation.ValueInRadians() * kInverseOrientationScale);
+          orientations[i] * inverse_orientation_scale + orientation_rounding);
       orientation->add_deltas(int_orientation - last_int_orientation);
       last_int_orientation = int_orientation;
     }
@@ -241,6 +364,47 @@ void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
   input_proto.set_noise_seed(input_batch.GetNoiseSeed());
 }
 
+}  // namespace
+
+void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
+                            CodedStrokeInputBatch& input_proto) {
+  ScopedTraceEvent trace_event("ink::EncodeStrokeInputBatch");
+  EncodeStrokeInputBatchImpl(input_batch, StrokeInputBatchEncodingOptions(),
+                             input_proto);
+}
+
+absl::Status EncodeStrokeInputBatch(
+    const StrokeInputBatch& input_batch,
+    const StrokeInputBatchEncodingOptions& options,
+    CodedStrokeInputBatch& input_proto) {
+  ScopedTraceEvent trace_event("ink::EncodeStrokeInputBatch");
+  if (absl::Status status = ValidateEncodingOptions(options); !status.ok()) {
+    return status;
+  }
+  EncodeStrokeInputBatchImpl(input_batch, options, input_proto);
+  if (options.checkpoint_interval > 0) {
+    AddNumericRunCheckpoints(*input_proto.mutable_x_stroke_space(),
+                             options.checkpoint_interval);
+    AddNumericRunCheckpoints(*input_proto.mutable_y_stroke_space(),
+                             options.checkpoint_interval);
+    AddNumericRunCheckpoints(*input_proto.mutable_elapsed_time_seconds(),
+                             options.checkpoint_interval);
+    if (input_proto.has_pressure()) {
+      AddNumericRunCheckpoints(*input_proto.mutable_pressure(),
+                               options.checkpoint_interval);
+    }
+    if (input_proto.has_tilt()) {
+      AddNumericRunCheckpoints(*input_proto.mutable_tilt(),
+                               options.checkpoint_interval);
+    }
+    if (input_proto.has_orientation()) {
+      AddNumericRunCheckpoints(*input_proto.mutable_orientation(),
+                               options.checkpoint_interval);
+    }
+  }
+  return absl::OkStatus();
+}
+
 namespace {
 
 StrokeInput::ToolType ToStrokeInputToolType(
@@ -262,45 +426,344 @@ StrokeInput::ToolType ToStrokeInputToolType(
 
 absl::StatusOr<StrokeInputBatch> DecodeStrokeInputBatch(
     const CodedStrokeInputBatch& input_proto) {
-  absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>> range =
-      DecodeStrokeInputBatchProto(input_proto);
-  if (!range.ok()) {
-    return range.status();
+  return DecodeStrokeInputBatch(input_proto, DecodeOptions());
+}
+
+absl::StatusOr<StrokeInputBatch> DecodeStrokeInputBatch(
+    const CodedStrokeInputBatch& input_proto, const DecodeOptions& options) {
+  ScopedTraceEvent trace_event("ink::DecodeStrokeInputBatch");
+  const size_t num_inputs = NumericRunSize(input_proto.x_stroke_space());
+  if (NumericRunSize(input_proto.y_stroke_space()) != num_inputs ||
+      NumericRunSize(input_proto.elapsed_time_seconds()) != num_inputs ||
+      (input_proto.has_pressure() &&
+       NumericRunSize(input_proto.pressure()) != num_inputs) ||
+      (input_proto.has_tilt() &&
+       NumericRunSize(input_proto.tilt()) != num_inputs) ||
+      (input_proto.has_orientation() &&
+       NumericRunSize(input_proto.orientation()) != num_inputs)) {
+    return absl::InvalidArgumentError(
+        "invalid StrokeInputBatch: mismatched numeric run lengths");
   }
 
-  StrokeInput::ToolType tool_type =
-      ToStrokeInputToolType(input_proto.tool_type());
-  PhysicalDistance stroke_unit_length = PhysicalDistance::Centimeters(
-      input_proto.stroke_unit_length_in_centimeters());
+  // Each numeric run is decoded straight into its own column, which is then
+  // handed to the batch in one bulk append, rather than going through a
+  // `StrokeInput` per point.
+  std::vector<float> xs(num_inputs);
+  std::vector<float> ys(num_inputs);
+  std::vector<float> times(num_inputs);
+  std::vector<float> pressures;
+  std::vector<float> tilts;
+  std::vector<float> orientations;
+  if (absl::Status status = DecodeFloatNumericRunInto(
+          input_proto.x_stroke_space(), absl::MakeSpan(xs));
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = DecodeFloatNumericRunInto(
+          input_proto.y_stroke_space(), absl::MakeSpan(ys));
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = DecodeFloatNumericRunInto(
+          input_proto.elapsed_time_seconds(), absl::MakeSpan(times));
+      !status.ok()) {
+    return status;
+  }
+  auto decode_optional_column = [num_inputs](
+                                    bool has_run, const CodedNumericRun& run,
+                                    std::vector<float>& column) {
+    if (!has_run) return absl::OkStatus();
+    column.resize(num_inputs);
+    return DecodeFloatNumericRunInto(run, absl::MakeSpan(column));
+  };
+  if (absl::Status status = decode_optional_column(
+          input_proto.has_pressure(), input_proto.pressure(), pressures);
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = decode_optional_column(
+          input_proto.has_tilt(), input_proto.tilt(), tilts);
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = decode_optional_column(
+          input_proto.has_orientation(), input_proto.orientation(),
+          orientations);
+      !status.ok()) {
+    return status;
+  }
 
-  StrokeInputBatch batch;
-  // TODO: b/355637257 - Add a StrokeInputBatch::Reserve member function.
-  for (const auto& input : *range) {
-    if (!batch.IsEmpty()) {
-      StrokeInput previous = batch.Get(batch.Size() - 1);
-      if (input.position_stroke_space == previous.position &&
-          input.elapsed_time == previous.elapsed_time) {
-        continue;
-      }
+  // Drop each input whose position and time are the same as those of the last
+  // input kept, compacting all of the columns in place.
+  size_t num_kept = 0;
+  for (size_t i = 0; i < num_inputs; ++i) {
+    if (num_kept > 0 && xs[i] == xs[num_kept - 1] &&
+        ys[i] == ys[num_kept - 1] && times[i] == times[num_kept - 1]) {
+      continue;
     }
-
-    absl::Status status = batch.Append(
-        {.tool_type = tool_type,
-         .position = input.position_stroke_space,
-         .elapsed_time = input.elapsed_time,
-         .stroke_unit_length = stroke_unit_length,
-         .pressure = input.pressure.value_or(StrokeInput::kNoPressure),
-         .tilt = input.tilt.has_value() ? Angle::Radians(*input.tilt)
-                                        : StrokeInput::kNoTilt,
-         .orientation = input.orientation.has_value()
-                            ? Angle::Radians(*input.orientation)
-                            : StrokeInput::kNoOrientation});
-    if (!status.ok()) {
-      return status;
+    xs[num_kept] = xs[i];
+    ys[num_kept] = ys[i];
+    times[num_kept] = times[i];
+    if (!pressures.empty()) pressures[num_kept] = pressures[i];
+    if (!tilts.empty()) tilts[num_kept] = tilts[i];
+    if (!orientations.empty()) orientations[num_kept] = orientations[i];
+    ++num_kept;
+  }
+  // An optional run that decodes to nothing but the "not reported" sentinel is
+  // treated as missing, just as it would be when appending input by input.
+  auto kept_column = [num_kept](const std::vector<float>& column,
+                                float sentinel) -> absl::Span<const float> {
+    if (column.empty()) return {};
+    absl::Span<const float> kept = absl::MakeConstSpan(column).first(num_kept);
+    if (absl::c_all_of(kept, [sentinel](float v) { return v == sentinel; })) {
+      return {};
     }
+    return kept;
+  };
+
+  StrokeInputBatch::InputColumns columns = {
+      .tool_type = ToStrokeInputToolType(input_proto.tool_type()),
+      .stroke_unit_length = PhysicalDistance::Centimeters(
+          input_proto.stroke_unit_length_in_centimeters()),
+      .x = absl::MakeConstSpan(xs).first(num_kept),
+      .y = absl::MakeConstSpan(ys).first(num_kept),
+      .elapsed_seconds = absl::MakeConstSpan(times).first(num_kept),
+      .pressure = kept_column(pressures, StrokeInput::kNoPressure),
+      .tilt_radians = kept_column(tilts, StrokeInput::kNoTilt.ValueInRadians()),
+      .orientation_radians = kept_column(
+          orientations, StrokeInput::kNoOrientation.ValueInRadians()),
+  };
+  StrokeInputBatch batch;
+  if (absl::Status status = options.trusted_input
+                                ? batch.AppendTrustedColumns(columns)
+                                : batch.AppendColumns(columns);
+      !status.ok()) {
+    return status;
   }
   batch.SetNoiseSeed(input_proto.noise_seed());
   return batch;
 }
 
+namespace {
+
+// Returns false if `value` is too large in magnitude to be encoded as an
+// `int32_t` delta. As in `EncodeStrokeInputBatch()`, this leaves some headroom
+// below the limits of `int32_t`, since the deltas between two encodable values
+// must also be encodable.
+bool IsEncodable(float value) {
+  constexpr float kMaxEncodable = std::numeric_limits<int32_t>::max() / 2;
+  return std::abs(value) <= kMaxEncodable;
+}
+
+void InitChunkRun(float offset, float scale, size_t size,
+                  CodedNumericRun& run) {
+  run.set_scale(scale);
+  if (offset == 0) {
+    run.clear_offset();
+  } else {
+    run.set_offset(offset);
+  }
+  run.mutable_deltas()->Clear();
+  run.clear_bit_packed_deltas();
+  run.clear_checkpoints();
+  run.mutable_deltas()->Reserve(size);
+}
+
+bool ChunkRunContinues(bool has_run, const CodedNumericRun& run,
+                       bool has_chunk_run, const CodedNumericRun& chunk_run) {
+  if (has_run != has_chunk_run) return false;
+  if (!has_run) return true;
+  return run.offset() == chunk_run.offset() &&
+         run.scale() == chunk_run.scale() && !run.has_bit_packed_deltas() &&
+         !chunk_run.has_bit_packed_deltas();
+}
+
+}  // namespace
+
+StrokeInputBatchChunkEncoder::StrokeInputBatchChunkEncoder(
+    float position_resolution)
+    : position_resolution_(position_resolution) {
+  ABSL_CHECK(std::isfinite(position_resolution) && position_resolution > 0)
+      << "`position_resolution` must be finite and positive; got "
+      << position_resolution;
+}
+
+absl::Status StrokeInputBatchChunkEncoder::EncodeNewInputs(
+    const StrokeInputBatch& inputs, size_t input_count,
+    CodedStrokeInputBatch& chunk_out) {
+  ScopedTraceEvent trace_event("ink::StrokeInputBatchChunkEncoder");
+  if (input_count < encoded_input_count_ || input_count > inputs.Size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "`input_count` must be in the range [", encoded_input_count_, ", ",
+        inputs.Size(), "]; got ", input_count));
+  }
+  if (input_count == encoded_input_count_) {
+    chunk_out.Clear();
+    return absl::OkStatus();
+  }
+  // The optional properties of the batch are fixed by its first input, so they
+  // can only change if this is a different batch.
+  if (encoded_input_count_ > 0 &&
+      (inputs.HasPressure() != has_pressure_ ||
+       inputs.HasTilt() != has_tilt_ ||
+       inputs.HasOrientation() != has_orientation_)) {
+    return absl::InvalidArgumentError(
+        "`inputs` must have the same optional properties as the inputs that "
+        "were already encoded");
+  }
+
+  absl::Span<const float> xs = inputs.GetXPositions();
+  absl::Span<const float> ys = inputs.GetYPositions();
+  absl::Span<const float> times = inputs.GetElapsedTimesInSeconds();
+  absl::Span<const float> pressures = inputs.GetPressures();
+  absl::Span<const float> tilts = inputs.GetTiltsInRadians();
+  absl::Span<const float> orientations = inputs.GetOrientationsInRadians();
+
+  RunState state = state_;
+  if (encoded_input_count_ == 0) {
+    state = {.x_offset = xs[0], .y_offset = ys[0]};
+  }
+  const float inverse_position_scale = 1.f / position_resolution_;
+  const float scaled_x_origin = state.x_offset * inverse_position_scale;
+  const float scaled_y_origin = state.y_offset * inverse_position_scale;
+
+  const size_t chunk_size = input_count - encoded_input_count_;
+  CodedNumericRun* x_stroke_space = chunk_out.mutable_x_stroke_space();
+  InitChunkRun(state.x_offset, position_resolution_, chunk_size,
+               *x_stroke_space);
+  CodedNumericRun* y_stroke_space = chunk_out.mutable_y_stroke_space();
+  InitChunkRun(state.y_offset, position_resolution_, chunk_size,
+               *y_stroke_space);
+  CodedNumericRun* elapsed_time_seconds =
+      chunk_out.mutable_elapsed_time_seconds();
+  InitChunkRun(0, 1.f / kDefaultInverseTimeScale, chunk_size,
+               *elapsed_time_seconds);
+  CodedNumericRun* pressure = nullptr;
+  if (!inputs.HasPressure()) {
+    chunk_out.clear_pressure();
+  } else {
+    pressure = chunk_out.mutable_pressure();
+    InitChunkRun(0, 1.f / kInversePressureScale, chunk_size, *pressure);
+  }
+  CodedNumericRun* tilt = nullptr;
+  if (!inputs.HasTilt()) {
+    chunk_out.clear_tilt();
+  } else {
+    tilt = chunk_out.mutable_tilt();
+    InitChunkRun(0, 1.f / kInverseTiltScale, chunk_size, *tilt);
+  }
+  CodedNumericRun* orientation = nullptr;
+  if (!inputs.HasOrientation()) {
+    chunk_out.clear_orientation();
+  } else {
+    orientation = chunk_out.mutable_orientation();
+    InitChunkRun(0, 1.f / kInverseOrientationScale, chunk_size, *orientation);
+  }
+
+  for (size_t i = encoded_input_count_; i < input_count; ++i) {
+    float scaled_x = xs[i] * inverse_position_scale - scaled_x_origin;
+    float scaled_y = ys[i] * inverse_position_scale - scaled_y_origin;
+    if (!IsEncodable(scaled_x) || !IsEncodable(scaled_y)) {
+      chunk_out.Clear();
+      return absl::OutOfRangeError(absl::StrCat(
+          "input ", i, " is too far from the first input to be encoded with "
+          "`position_resolution` ", position_resolution_));
+    }
+    float scaled_time = times[i] * kDefaultInverseTimeScale;
+    if (!IsEncodable(scaled_time)) {
+      chunk_out.Clear();
+      return absl::OutOfRangeError(absl::StrCat(
+          "input ", i, " has an elapsed time of ", times[i],
+          " seconds, which is too late to be encoded"));
+    }
+
+    int32_t int_x = static_cast<int32_t>(scaled_x);
+    int32_t int_y = static_cast<int32_t>(scaled_y);
+    x_stroke_space->add_deltas(int_x - state.last_x);
+    y_stroke_space->add_deltas(int_y - state.last_y);
+    state.last_x = int_x;
+    state.last_y = int_y;
+
+    int32_t int_time = static_cast<int32_t>(scaled_time);
+    elapsed_time_seconds->add_deltas(int_time - state.last_time);
+    state.last_time = int_time;
+
+    if (pressure != nullptr) {
+      int32_t int_pressure =
+          static_cast<int32_t>(pressures[i] * kInversePressureScale);
+      pressure->add_deltas(int_pressure - state.last_pressure);
+      state.last_pressure = int_pressure;
+    }
+    if (tilt != nullptr) {
+      int32_t int_tilt = static_cast<int32_t>(tilts[i] * kInverseTiltScale);
+      tilt->add_deltas(int_tilt - state.last_tilt);
+      state.last_tilt = int_tilt;
+    }
+    if (orientation != nullptr) {
+      int32_t int_orientation =
+          static_cast<int32_t>(orientations[i] * kInverseOrientationScale);
+      orientation->add_deltas(int_orientation - state.last_orientation);
+      state.last_orientation = int_orientation;
+    }
+  }
+
+  chunk_out.set_tool_type(ToProtoToolType(inputs.GetToolType()));
+  if (std::optional<PhysicalDistance> stroke_unit_length =
+          inputs.GetStrokeUnitLength();
+      stroke_unit_length.has_value()) {
+    chunk_out.set_stroke_unit_length_in_centimeters(
+        stroke_unit_length->ToCentimeters());
+  } else {
+    chunk_out.clear_stroke_unit_length_in_centimeters();
+  }
+  chunk_out.set_noise_seed(inputs.GetNoiseSeed());
+
+  encoded_input_count_ = input_count;
+  has_pressure_ = inputs.HasPressure();
+  has_tilt_ = inputs.HasTilt();
+  has_orientation_ = inputs.HasOrientation();
+  state_ = state;
+  return absl::OkStatus();
+}
+
+void StrokeInputBatchChunkEncoder::Reset() {
+  encoded_input_count_ = 0;
+  has_pressure_ = false;
+  has_tilt_ = false;
+  has_orientation_ = false;
+  state_ = {};
+}
+
+absl::Status AppendStrokeInputBatchChunk(
+    const CodedStrokeInputBatch& chunk_proto,
+    CodedStrokeInputBatch& input_proto) {
+  // An empty chunk, or an empty batch, imposes no constraints on the runs of
+  // the other.
+  if (chunk_proto.has_x_stroke_space() && input_proto.has_x_stroke_space() &&
+      !(ChunkRunContinues(true, input_proto.x_stroke_space(), true,
+                          chunk_proto.x_stroke_space()) &&
+        ChunkRunContinues(input_proto.has_y_stroke_space(),
+                          input_proto.y_stroke_space(),
+                          chunk_proto.has_y_stroke_space(),
+                          chunk_proto.y_stroke_space()) &&
+        ChunkRunContinues(input_proto.has_elapsed_time_seconds(),
+                          input_proto.elapsed_time_seconds(),
+                          chunk_proto.has_elapsed_time_seconds(),
+                          chunk_proto.elapsed_time_seconds()) &&
+        ChunkRunContinues(input_proto.has_pressure(), input_proto.pressure(),
+                          chunk_proto.has_pressure(), chunk_proto.pressure()) &&
+        ChunkRunContinues(input_proto.has_tilt(), input_proto.tilt(),
+                          chunk_proto.has_tilt(), chunk_proto.tilt()) &&
+        ChunkRunContinues(input_proto.has_orientation(),
+                          input_proto.orientation(),
+                          chunk_proto.has_orientation(),
+                          chunk_proto.orientation()))) {
+    return absl::InvalidArgumentError(
+        "invalid StrokeInputBatch chunk: numeric runs do not continue those "
+        "of the previous chunks");
+  }
+  input_proto.MergeFrom(chunk_proto);
+  return absl::OkStatus();
+}
+
 }  // namespace ink
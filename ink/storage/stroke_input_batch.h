@@ -15,9 +15,17 @@
 #ifndef INK_STORAGE_STROKE_INPUT_BATCH_H_
 #define INK_STORAGE_STROKE_INPUT_BATCH_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "ink/geometry/angle.h"
+#include "ink/storage/decode_options.h"
 #include "ink/storage/proto/stroke_input_batch.pb.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/duration.h"
 
 namespace ink {
 
@@ -29,11 +37,151 @@ namespace ink {
 void EncodeStrokeInputBatch(const StrokeInputBatch& input_batch,
                             ink::proto::CodedStrokeInputBatch& input_proto);
 
+// Options controlling how `EncodeStrokeInputBatch()` encodes the inputs, most
+// notably the precision with which it quantizes each channel. Coarser precision
+// yields smaller deltas, and so a smaller serialized proto, e.g. for thumbnails
+// or low-priority history.
+//
+// Each `max_*_error` field, if set, is the maximum absolute error of the
+// corresponding decoded values; if unset, the channel is encoded with its
+// default precision. A bound is only loosened if meeting it would overflow the
+// encoded integers, which requires values spanning over a billion multiples of
+// the bound.
+struct StrokeInputBatchEncodingOptions {
+  // The maximum error of each coordinate of the input positions, in stroke
+  // units. By default, positions are encoded relative to the bounds of the
+  // batch, with an error of at most 1/4096 of the bounds' width or height.
+  std::optional<float> max_position_error;
+  // The maximum error of the input elapsed times. By default, times are encoded
+  // with microsecond precision.
+  std::optional<Duration32> max_elapsed_time_error;
+  // The maximum error of the input pressures. Defaults to 1/4096.
+  std::optional<float> max_pressure_error;
+  // The maximum error of the input tilts. Defaults to 1/4096 radians.
+  std::optional<Angle> max_tilt_error;
+  // The maximum error of the input orientations. Defaults to 1/4096 radians.
+  std::optional<Angle> max_orientation_error;
+  // If nonzero, checkpoints are added to each numeric run every this many
+  // inputs, so that the inputs can be decoded starting from partway through the
+  // batch with `DecodeStrokeInputBatchProtoFrom()`.
+  uint32_t checkpoint_interval = 0;
+};
+
+// Same as `EncodeStrokeInputBatch()` above, except that the precision of each
+// channel is chosen according to `options`. Returns an error, and leaves the
+// CodedStrokeInputBatch unchanged, if any field of `options` that is set is not
+// finite and positive.
+absl::Status EncodeStrokeInputBatch(
+    const StrokeInputBatch& input_batch,
+    const StrokeInputBatchEncodingOptions& options,
+    ink::proto::CodedStrokeInputBatch& input_proto);
+
 // Decodes the CodedStrokeInputBatch into a StrokeInputBatch. Returns an error
 // if the proto is invalid.
 absl::StatusOr<StrokeInputBatch> DecodeStrokeInputBatch(
     const ink::proto::CodedStrokeInputBatch& input_proto);
 
+// Same as `DecodeStrokeInputBatch()` above. If `options.trusted_input` is true,
+// the decoded inputs are appended with
+// `StrokeInputBatch::AppendTrustedColumns()`, skipping the per-input checks
+// that positions are finite, that elapsed times are non-decreasing, and that
+// pressure, tilt, and orientation are in range. The numeric runs and their
+// lengths are still validated.
+absl::StatusOr<StrokeInputBatch> DecodeStrokeInputBatch(
+    const ink::proto::CodedStrokeInputBatch& input_proto,
+    const DecodeOptions& options);
+
+// Incrementally encodes a growing `StrokeInputBatch`, such as the inputs of an
+// in-progress stroke, as a sequence of `CodedStrokeInputBatch` chunks that
+// each hold only the inputs that are new since the previous chunk.
+//
+// Every chunk uses the same offset and scale for each numeric run, and the
+// first delta of each run in a chunk continues from the last value of the
+// previous chunk. As a result, the chunks can be combined with
+// `AppendStrokeInputBatchChunk()`, or simply by concatenating their serialized
+// bytes and parsing the result as a single `CodedStrokeInputBatch`. This way,
+// periodically persisting a stroke while it is being drawn only needs to write
+// out its new inputs, rather than re-encoding the whole stroke.
+//
+// Since the extent of the stroke isn't known up front, positions are encoded
+// relative to the first input, on a grid of fixed `position_resolution` in
+// stroke units, rather than relative to the stroke's bounds as with
+// `EncodeStrokeInputBatch()`. Times are encoded with microsecond resolution.
+class StrokeInputBatchChunkEncoder {
+ public:
+  // The default spacing of the grid that positions are rounded to, in stroke
+  // units. This is comparable to the precision of `EncodeStrokeInputBatch()`
+  // for a stroke a few hundred stroke units across.
+  static constexpr float kDefaultPositionResolution = 1.f / 64;
+
+  // Constructs an encoder for a new stroke. `position_resolution` must be
+  // finite and positive.
+  explicit StrokeInputBatchChunkEncoder(
+      float position_resolution = kDefaultPositionResolution);
+
+  // Populates `chunk_out` with the inputs in `inputs` from index
+  // `EncodedInputCount()` up to (but not including) `input_count`, and marks
+  // them as encoded. Each call must pass the same batch, extended by appending
+  // inputs since the previous call. For an in-progress stroke, pass its
+  // `GetInputs()` and `RealInputCount()`, so that predicted inputs are not
+  // encoded.
+  //
+  // If there are no new inputs, `chunk_out` is cleared, and appending it is a
+  // no-op. Returns an error and leaves the encoder unchanged if
+  // `input_count` is less than `EncodedInputCount()` or greater than
+  // `inputs.Size()`, if the batch no longer has the same optional properties
+  // (pressure, tilt and orientation) as before, or if an input is too far from
+  // the first input, or too late, to be encoded at the chosen resolution.
+  //
+  // The chunk need not be empty before calling this; this will effectively
+  // clear the chunk first.
+  absl::Status EncodeNewInputs(const StrokeInputBatch& inputs,
+                               size_t input_count,
+                               proto::CodedStrokeInputBatch& chunk_out);
+
+  // Returns the number of inputs encoded into chunks so far.
+  size_t EncodedInputCount() const { return encoded_input_count_; }
+
+  // Resets the encoder to start encoding a new stroke.
+  void Reset();
+
+ private:
+  // The state of each numeric run that carries over from one chunk to the
+  // next.
+  struct RunState {
+    float x_offset = 0;
+    float y_offset = 0;
+    int32_t last_x = 0;
+    int32_t last_y = 0;
+    int32_t last_time = 0;
+    int32_t last_pressure = 0;
+    int32_t last_tilt = 0;
+    int32_t last_orientation = 0;
+  };
+
+  float position_resolution_;
+  size_t encoded_input_count_ = 0;
+  bool has_pressure_ = false;
+  bool has_tilt_ = false;
+  bool has_orientation_ = false;
+  RunState state_;
+};
+
+// Appends the inputs encoded in `chunk_proto`, as produced by
+// `StrokeInputBatchChunkEncoder`, to those in `input_proto`, which should
+// be either empty or the result of appending the previous chunks for the same
+// stroke. The resulting proto can be decoded with `DecodeStrokeInputBatch()`.
+// The tool type, stroke unit length and noise seed are taken from
+// `chunk_proto` if it sets them.
+//
+// Returns an error and leaves `input_proto` unchanged if the chunk's numeric
+// runs don't continue those of `input_proto`, i.e. if a run is present in one
+// and not the other, or has a different offset or scale, or uses bit-packed
+// deltas.
+absl::Status AppendStrokeInputBatchChunk(
+    const proto::CodedStrokeInputBatch& chunk_proto,
+    proto::CodedStrokeInputBatch& input_proto);
+
 }  // namespace ink
 
 #endif  // INK_STORAGE_STROKE_INPUT_BATCH_H_
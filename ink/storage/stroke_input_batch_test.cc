@@ -14,18 +14,26 @@
 
 #include "ink/storage/stroke_input_batch.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
 #include <utility>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
+#include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/rect.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/storage/input_batch.h"
 #include "ink/storage/numeric_run.h"
+#include "ink/storage/proto/coded_numeric_run.pb.h"
 #include "ink/storage/proto/stroke_input_batch.pb.h"
 #include "ink/strokes/input/fuzz_domains.h"
 #include "ink/strokes/input/stroke_input.h"
@@ -42,6 +50,7 @@ using ::ink::proto::CodedStrokeInputBatch;
 using ::testing::ElementsAre;
 using ::testing::FloatEq;
 using ::testing::FloatNear;
+using ::testing::HasSubstr;
 
 class StrokeInputBatchTest : public ::testing::Test {
  public:
@@ -123,6 +132,124 @@ TEST_F(StrokeInputBatchTest, DecodeEmptyInputs) {
   EXPECT_THAT(*input_batch, StrokeInputBatchEq(StrokeInputBatch()));
 }
 
+TEST_F(StrokeInputBatchTest, DecodeBitPackedInputs) {
+  for (proto::CodedNumericRun* run :
+       {input_proto_.mutable_x_stroke_space(),
+        input_proto_.mutable_y_stroke_space(),
+        input_proto_.mutable_elapsed_time_seconds(),
+        input_proto_.mutable_pressure(), input_proto_.mutable_tilt(),
+        input_proto_.mutable_orientation()}) {
+    BitPackNumericRun(*run);
+  }
+  absl::StatusOr<StrokeInputBatch> decoded =
+      DecodeStrokeInputBatch(input_proto_);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_THAT(*decoded, StrokeInputBatchEq(input_batch_));
+}
+
+TEST_F(StrokeInputBatchTest, DecodeMismatchedRunLengths) {
+  input_proto_.mutable_tilt()->add_deltas(1);
+  absl::Status status = DecodeStrokeInputBatch(input_proto_).status();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("mismatched numeric run lengths"));
+}
+
+TEST_F(StrokeInputBatchTest, DecodeNonFiniteRun) {
+  input_proto_.mutable_y_stroke_space()->set_scale(
+      std::numeric_limits<float>::infinity());
+  absl::Status status = DecodeStrokeInputBatch(input_proto_).status();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("non-finite scale"));
+}
+
+TEST_F(StrokeInputBatchTest, DecodeRunOfSentinelValuesAsUnreported) {
+  // A pressure run that decodes to nothing but `kNoPressure` means the same
+  // thing as a missing pressure run.
+  proto::CodedNumericRun* pressure = input_proto_.mutable_pressure();
+  pressure->set_offset(StrokeInput::kNoPressure);
+  for (int i = 0; i < pressure->deltas_size(); ++i) pressure->set_deltas(i, 0);
+
+  absl::StatusOr<StrokeInputBatch> decoded =
+      DecodeStrokeInputBatch(input_proto_);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_FALSE(decoded->HasPressure());
+  EXPECT_TRUE(decoded->HasTilt());
+  EXPECT_EQ(decoded->Size(), 3);
+}
+
+TEST_F(StrokeInputBatchTest, DecodeTrustedInputs) {
+  absl::StatusOr<StrokeInputBatch> decoded =
+      DecodeStrokeInputBatch(input_proto_, {.trusted_input = true});
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_THAT(*decoded, StrokeInputBatchEq(input_batch_));
+}
+
+TEST_F(StrokeInputBatchTest, DecodeTrustedInputsSkipsValueValidation) {
+  // Make the second input's elapsed time go backwards.
+  input_proto_.mutable_elapsed_time_seconds()->set_deltas(1, -500);
+
+  absl::Status untrusted_status = DecodeStrokeInputBatch(input_proto_).status();
+  EXPECT_EQ(untrusted_status.code(), absl::StatusCode::kInvalidArgument);
+
+  absl::StatusOr<StrokeInputBatch> decoded =
+      DecodeStrokeInputBatch(input_proto_, {.trusted_input = true});
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_EQ(decoded->Size(), 3);
+}
+
+TEST_F(StrokeInputBatchTest, DecodeTrustedInputsStillValidatesRuns) {
+  input_proto_.mutable_tilt()->add_deltas(1);
+  absl::Status mismatched_status =
+      DecodeStrokeInputBatch(input_proto_, {.trusted_input = true}).status();
+  EXPECT_EQ(mismatched_status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(mismatched_status.message(),
+              HasSubstr("mismatched numeric run lengths"));
+
+  input_proto_.mutable_tilt()->mutable_deltas()->RemoveLast();
+  input_proto_.mutable_y_stroke_space()->set_scale(
+      std::numeric_limits<float>::infinity());
+  absl::Status non_finite_status =
+      DecodeStrokeInputBatch(input_proto_, {.trusted_input = true}).status();
+  EXPECT_EQ(non_finite_status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(non_finite_status.message(), HasSubstr("non-finite scale"));
+}
+
+TEST_F(StrokeInputBatchTest, DecodeDropsEveryRepeatedPositionAndTime) {
+  // Repeat the last input twice with new pressure, tilt, and orientation
+  // values, and then add a fourth distinct input.
+  input_proto_.mutable_x_stroke_space()->add_deltas(0);
+  input_proto_.mutable_x_stroke_space()->add_deltas(0);
+  input_proto_.mutable_x_stroke_space()->add_deltas(1);
+  input_proto_.mutable_y_stroke_space()->add_deltas(0);
+  input_proto_.mutable_y_stroke_space()->add_deltas(0);
+  input_proto_.mutable_y_stroke_space()->add_deltas(0);
+  input_proto_.mutable_elapsed_time_seconds()->add_deltas(0);
+  input_proto_.mutable_elapsed_time_seconds()->add_deltas(0);
+  input_proto_.mutable_elapsed_time_seconds()->add_deltas(500);
+  for (proto::CodedNumericRun* run :
+       {input_proto_.mutable_pressure(), input_proto_.mutable_tilt(),
+        input_proto_.mutable_orientation()}) {
+    run->add_deltas(-1);
+    run->add_deltas(-1);
+    run->add_deltas(-1);
+  }
+
+  absl::StatusOr<StrokeInputBatch> decoded =
+      DecodeStrokeInputBatch(input_proto_);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  ASSERT_EQ(decoded->Size(), 4);
+  EXPECT_THAT(decoded->Get(2), StrokeInputEq(input_batch_.Get(2)));
+  EXPECT_THAT(decoded->Get(3),
+              StrokeInputEq({.tool_type = StrokeInput::ToolType::kStylus,
+                             .position = {9, 2},
+                             .elapsed_time = Duration32::Seconds(1.5f),
+                             .stroke_unit_length =
+                                 PhysicalDistance::Centimeters(0.1),
+                             .pressure = 0.3,
+                             .tilt = Angle::Radians(0.2),
+                             .orientation = Angle::Radians(0.4)}));
+}
+
 TEST_F(StrokeInputBatchTest, EncodeInputs) {
   CodedStrokeInputBatch encoded_input_proto;
   EncodeStrokeInputBatch(input_batch_, encoded_input_proto);
@@ -366,6 +493,311 @@ TEST_F(StrokeInputBatchTest, ClearPressureTiltOrientation) {
   EXPECT_FALSE(input_batch.has_orientation());
 }
 
+StrokeInputBatch MakeSpiralInputBatch(int num_inputs) {
+  StrokeInputBatch batch;
+  for (int i = 0; i < num_inputs; ++i) {
+    float radius = 10 + i;
+    Angle angle = Angle::Radians(0.1f * i);
+    ABSL_CHECK_OK(batch.Append(
+        {.tool_type = StrokeInput::ToolType::kStylus,
+         .position = {500 + radius * Cos(angle), -200 + radius * Sin(angle)},
+         .elapsed_time = Duration32::Seconds(0.004f * i),
+         .stroke_unit_length = PhysicalDistance::Centimeters(0.1),
+         .pressure = 0.5f + 0.4f * Sin(angle),
+         .tilt = Angle::Radians(0.3),
+         .orientation = Angle::Radians(1 + 0.01f * i)}));
+  }
+  return batch;
+}
+
+TEST_F(StrokeInputBatchTest, ChunkedEncodingRoundTrip) {
+  StrokeInputBatch inputs = MakeSpiralInputBatch(100);
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch appended;
+  CodedStrokeInputBatch chunk;
+  for (size_t input_count : {size_t{1}, size_t{1}, size_t{30}, size_t{100}}) {
+    ASSERT_EQ(encoder.EncodeNewInputs(inputs, input_count, chunk),
+              absl::OkStatus());
+    EXPECT_EQ(encoder.EncodedInputCount(), input_count);
+    ASSERT_EQ(AppendStrokeInputBatchChunk(chunk, appended), absl::OkStatus());
+  }
+
+  absl::StatusOr<StrokeInputBatch> decoded = DecodeStrokeInputBatch(appended);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  ASSERT_EQ(decoded->Size(), inputs.Size());
+  EXPECT_EQ(decoded->GetToolType(), inputs.GetToolType());
+  EXPECT_EQ(decoded->GetStrokeUnitLength(), inputs.GetStrokeUnitLength());
+  EXPECT_EQ(decoded->GetNoiseSeed(), inputs.GetNoiseSeed());
+  for (size_t i = 0; i < inputs.Size(); ++i) {
+    StrokeInput expected = inputs.Get(i);
+    StrokeInput actual = decoded->Get(i);
+    EXPECT_THAT(actual.position,
+                PointNear(expected.position,
+                          StrokeInputBatchChunkEncoder::
+                              kDefaultPositionResolution));
+    EXPECT_NEAR(actual.elapsed_time.ToSeconds(),
+                expected.elapsed_time.ToSeconds(), 2e-6);
+    EXPECT_NEAR(actual.pressure, expected.pressure, 1.f / 4096);
+    EXPECT_NEAR(actual.tilt.ValueInRadians(), expected.tilt.ValueInRadians(),
+                1.f / 4096);
+    EXPECT_NEAR(actual.orientation.ValueInRadians(),
+                expected.orientation.ValueInRadians(), 1.f / 4096);
+  }
+}
+
+TEST_F(StrokeInputBatchTest, ChunksCanBeConcatenatedAsBytes) {
+  StrokeInputBatch inputs = MakeSpiralInputBatch(50);
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch appended;
+  std::string concatenated_bytes;
+  for (size_t input_count : {size_t{10}, size_t{25}, size_t{50}}) {
+    CodedStrokeInputBatch chunk;
+    ASSERT_EQ(encoder.EncodeNewInputs(inputs, input_count, chunk),
+              absl::OkStatus());
+    ASSERT_EQ(AppendStrokeInputBatchChunk(chunk, appended), absl::OkStatus());
+    concatenated_bytes += chunk.SerializeAsString();
+  }
+
+  CodedStrokeInputBatch parsed;
+  ASSERT_TRUE(parsed.ParseFromString(concatenated_bytes));
+  EXPECT_EQ(parsed.SerializeAsString(), appended.SerializeAsString());
+}
+
+TEST_F(StrokeInputBatchTest, ChunkedEncodingOnlyEncodesUpToInputCount) {
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch chunk;
+  // For example, leaving out the predicted inputs of an in-progress stroke.
+  ASSERT_EQ(encoder.EncodeNewInputs(input_batch_, 2, chunk), absl::OkStatus());
+  EXPECT_EQ(encoder.EncodedInputCount(), 2u);
+  EXPECT_EQ(chunk.x_stroke_space().deltas_size(), 2);
+
+  absl::StatusOr<StrokeInputBatch> decoded = DecodeStrokeInputBatch(chunk);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_EQ(decoded->Size(), 2u);
+  EXPECT_THAT(decoded->Get(1).position, PointEq({7, 4}));
+}
+
+TEST_F(StrokeInputBatchTest, ChunkedEncodingWithNoNewInputs) {
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch chunk;
+  ASSERT_EQ(encoder.EncodeNewInputs(input_batch_, 3, chunk), absl::OkStatus());
+  CodedStrokeInputBatch appended = chunk;
+
+  ASSERT_EQ(encoder.EncodeNewInputs(input_batch_, 3, chunk), absl::OkStatus());
+  EXPECT_FALSE(chunk.has_x_stroke_space());
+  std::string appended_bytes = appended.SerializeAsString();
+  ASSERT_EQ(AppendStrokeInputBatchChunk(chunk, appended), absl::OkStatus());
+  EXPECT_EQ(appended.SerializeAsString(), appended_bytes);
+}
+
+TEST_F(StrokeInputBatchTest, ChunkedEncodingInvalidInputCount) {
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch chunk;
+  absl::Status too_many = encoder.EncodeNewInputs(input_batch_, 4, chunk);
+  EXPECT_EQ(too_many.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(too_many.message(), HasSubstr("input_count"));
+
+  ASSERT_EQ(encoder.EncodeNewInputs(input_batch_, 2, chunk), absl::OkStatus());
+  absl::Status too_few = encoder.EncodeNewInputs(input_batch_, 1, chunk);
+  EXPECT_EQ(too_few.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(too_few.message(), HasSubstr("input_count"));
+  EXPECT_EQ(encoder.EncodedInputCount(), 2u);
+}
+
+TEST_F(StrokeInputBatchTest, ChunkedEncodingChangedOptionalProperties) {
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch chunk;
+  ASSERT_EQ(encoder.EncodeNewInputs(input_batch_, 1, chunk), absl::OkStatus());
+
+  absl::StatusOr<StrokeInputBatch> other_batch = StrokeInputBatch::Create(
+      {{.position = {10, 3}, .elapsed_time = Duration32::Zero()},
+       {.position = {7, 4}, .elapsed_time = Duration32::Seconds(0.5f)}});
+  ASSERT_EQ(other_batch.status(), absl::OkStatus());
+  absl::Status status = encoder.EncodeNewInputs(*other_batch, 2, chunk);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("optional properties"));
+
+  encoder.Reset();
+  EXPECT_EQ(encoder.EncodedInputCount(), 0u);
+  EXPECT_EQ(encoder.EncodeNewInputs(*other_batch, 2, chunk), absl::OkStatus());
+}
+
+TEST_F(StrokeInputBatchTest, ChunkedEncodingInputTooFarAway) {
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+       {.position = {1e8, 0}, .elapsed_time = Duration32::Seconds(0.5f)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch chunk;
+  ASSERT_EQ(encoder.EncodeNewInputs(*inputs, 1, chunk), absl::OkStatus());
+  absl::Status status = encoder.EncodeNewInputs(*inputs, 2, chunk);
+  EXPECT_EQ(status.code(), absl::StatusCode::kOutOfRange);
+  EXPECT_THAT(status.message(), HasSubstr("too far"));
+  EXPECT_EQ(encoder.EncodedInputCount(), 1u);
+
+  // With a coarser resolution, the input can be encoded.
+  StrokeInputBatchChunkEncoder coarse_encoder(/*position_resolution=*/1);
+  EXPECT_EQ(coarse_encoder.EncodeNewInputs(*inputs, 2, chunk),
+            absl::OkStatus());
+}
+
+TEST_F(StrokeInputBatchTest, AppendChunkThatDoesNotContinueRuns) {
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch appended;
+  ASSERT_EQ(encoder.EncodeNewInputs(input_batch_, 2, appended),
+            absl::OkStatus());
+  CodedStrokeInputBatch chunk;
+  ASSERT_EQ(encoder.EncodeNewInputs(input_batch_, 3, chunk), absl::OkStatus());
+  chunk.mutable_x_stroke_space()->set_offset(
+      chunk.x_stroke_space().offset() + 1);
+
+  std::string appended_bytes = appended.SerializeAsString();
+  absl::Status status = AppendStrokeInputBatchChunk(chunk, appended);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("do not continue"));
+  EXPECT_EQ(appended.SerializeAsString(), appended_bytes);
+
+  // A full encoding uses different offsets and scales, and so can't be
+  // continued either.
+  CodedStrokeInputBatch full_encoding;
+  EncodeStrokeInputBatch(input_batch_, full_encoding);
+  EXPECT_EQ(AppendStrokeInputBatchChunk(chunk, full_encoding).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(StrokeInputBatchTest, EncodeWithDefaultOptionsMatchesDefaultEncoding) {
+  StrokeInputBatch inputs = MakeSpiralInputBatch(100);
+  CodedStrokeInputBatch default_encoding;
+  EncodeStrokeInputBatch(inputs, default_encoding);
+  CodedStrokeInputBatch encoding_with_options;
+  ASSERT_EQ(EncodeStrokeInputBatch(inputs, StrokeInputBatchEncodingOptions(),
+                                   encoding_with_options),
+            absl::OkStatus());
+  EXPECT_EQ(encoding_with_options.SerializeAsString(),
+            default_encoding.SerializeAsString());
+}
+
+TEST_F(StrokeInputBatchTest, EncodeWithMaxErrors) {
+  StrokeInputBatch inputs = MakeSpiralInputBatch(100);
+  StrokeInputBatchEncodingOptions options = {
+      .max_position_error = 0.5f,
+      .max_elapsed_time_error = Duration32::Millis(1),
+      .max_pressure_error = 0.05f,
+      .max_tilt_error = Angle::Radians(0.05f),
+      .max_orientation_error = Angle::Radians(0.02f),
+  };
+  CodedStrokeInputBatch coarse_encoding;
+  ASSERT_EQ(EncodeStrokeInputBatch(inputs, options, coarse_encoding),
+            absl::OkStatus());
+  CodedStrokeInputBatch default_encoding;
+  EncodeStrokeInputBatch(inputs, default_encoding);
+  EXPECT_LT(coarse_encoding.ByteSizeLong(), default_encoding.ByteSizeLong());
+
+  absl::StatusOr<StrokeInputBatch> decoded =
+      DecodeStrokeInputBatch(coarse_encoding);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  ASSERT_EQ(decoded->Size(), inputs.Size());
+  for (size_t i = 0; i < inputs.Size(); ++i) {
+    StrokeInput expected = inputs.Get(i);
+    StrokeInput actual = decoded->Get(i);
+    EXPECT_THAT(actual.position,
+                PointNear(expected.position, *options.max_position_error));
+    EXPECT_NEAR(actual.elapsed_time.ToSeconds(),
+                expected.elapsed_time.ToSeconds(),
+                options.max_elapsed_time_error->ToSeconds());
+    EXPECT_NEAR(actual.pressure, expected.pressure,
+                *options.max_pressure_error);
+    EXPECT_NEAR(actual.tilt.ValueInRadians(), expected.tilt.ValueInRadians(),
+                options.max_tilt_error->ValueInRadians());
+    EXPECT_NEAR(actual.orientation.ValueInRadians(),
+                expected.orientation.ValueInRadians(),
+                options.max_orientation_error->ValueInRadians());
+  }
+}
+
+TEST_F(StrokeInputBatchTest, EncodeWithFinerPositionErrorThanDefault) {
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {{.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+       {.position = {300.003f, 0}, .elapsed_time = Duration32::Seconds(1)},
+       {.position = {1000, 0}, .elapsed_time = Duration32::Seconds(2)}});
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  CodedStrokeInputBatch coded;
+  // By default, positions in this batch are encoded with an error of up to
+  // 1000/4096 stroke units.
+  ASSERT_EQ(EncodeStrokeInputBatch(*inputs, {.max_position_error = 0.005f},
+                                   coded),
+            absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> decoded = DecodeStrokeInputBatch(coded);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_THAT(decoded->Get(1).position,
+              PointNear(inputs->Get(1).position, 0.005f));
+}
+
+TEST_F(StrokeInputBatchTest, EncodeWithCheckpoints) {
+  StrokeInputBatch inputs = MakeSpiralInputBatch(100);
+  CodedStrokeInputBatch coded;
+  ASSERT_EQ(EncodeStrokeInputBatch(inputs, {.checkpoint_interval = 16}, coded),
+            absl::OkStatus());
+  EXPECT_EQ(coded.x_stroke_space().checkpoints().interval(), 16);
+  EXPECT_EQ(coded.x_stroke_space().checkpoints().cumulative_deltas_size(), 6);
+  EXPECT_EQ(coded.elapsed_time_seconds().checkpoints().interval(), 16);
+
+  absl::StatusOr<StrokeInputBatch> decoded = DecodeStrokeInputBatch(coded);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  CodedStrokeInputBatch without_checkpoints;
+  EncodeStrokeInputBatch(inputs, without_checkpoints);
+  absl::StatusOr<StrokeInputBatch> decoded_without_checkpoints =
+      DecodeStrokeInputBatch(without_checkpoints);
+  ASSERT_EQ(decoded_without_checkpoints.status(), absl::OkStatus());
+  ASSERT_EQ(decoded->Size(), decoded_without_checkpoints->Size());
+  for (size_t i = 0; i < decoded->Size(); ++i) {
+    EXPECT_THAT(decoded->Get(i),
+                StrokeInputEq(decoded_without_checkpoints->Get(i)));
+  }
+
+  // Re-encoding into the same proto without checkpoints clears them.
+  EncodeStrokeInputBatch(inputs, coded);
+  EXPECT_FALSE(coded.x_stroke_space().has_checkpoints());
+}
+
+TEST_F(StrokeInputBatchTest, EncodeWithInvalidMaxErrors) {
+  CodedStrokeInputBatch coded;
+  EncodeStrokeInputBatch(input_batch_, coded);
+  std::string coded_bytes = coded.SerializeAsString();
+
+  absl::Status negative_position = EncodeStrokeInputBatch(
+      input_batch_, {.max_position_error = -1}, coded);
+  EXPECT_EQ(negative_position.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(negative_position.message(), HasSubstr("max_position_error"));
+
+  absl::Status zero_time = EncodeStrokeInputBatch(
+      input_batch_, {.max_elapsed_time_error = Duration32::Zero()}, coded);
+  EXPECT_EQ(zero_time.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(zero_time.message(), HasSubstr("max_elapsed_time_error"));
+
+  absl::Status nan_pressure = EncodeStrokeInputBatch(
+      input_batch_,
+      {.max_pressure_error = std::numeric_limits<float>::quiet_NaN()}, coded);
+  EXPECT_EQ(nan_pressure.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(nan_pressure.message(), HasSubstr("max_pressure_error"));
+
+  absl::Status infinite_tilt = EncodeStrokeInputBatch(
+      input_batch_,
+      {.max_tilt_error =
+           Angle::Radians(std::numeric_limits<float>::infinity())},
+      coded);
+  EXPECT_EQ(infinite_tilt.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(infinite_tilt.message(), HasSubstr("max_tilt_error"));
+
+  absl::Status negative_orientation = EncodeStrokeInputBatch(
+      input_batch_, {.max_orientation_error = Angle::Radians(-0.1f)}, coded);
+  EXPECT_EQ(negative_orientation.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(negative_orientation.message(),
+              HasSubstr("max_orientation_error"));
+
+  EXPECT_EQ(coded.SerializeAsString(), coded_bytes);
+}
+
 void DecodeStrokeInputBatchDoesNotCrashOnArbitraryInput(
     const CodedStrokeInputBatch& proto) {
   DecodeStrokeInputBatch(proto).IgnoreError();
@@ -373,6 +805,55 @@ void DecodeStrokeInputBatchDoesNotCrashOnArbitraryInput(
 FUZZ_TEST(StrokeInputBatchFuzzTest,
           DecodeStrokeInputBatchDoesNotCrashOnArbitraryInput);
 
+// Decodes `proto` one input at a time, as a reference for the column-wise
+// decoding done by `DecodeStrokeInputBatch`.
+absl::StatusOr<StrokeInputBatch> DecodeStrokeInputBatchInputByInput(
+    const CodedStrokeInputBatch& proto, StrokeInput::ToolType tool_type) {
+  absl::StatusOr<iterator_range<CodedStrokeInputBatchIterator>> range =
+      DecodeStrokeInputBatchProto(proto);
+  if (!range.ok()) return range.status();
+  StrokeInputBatch batch;
+  for (const auto& input : *range) {
+    if (!batch.IsEmpty()) {
+      StrokeInput previous = batch.Get(batch.Size() - 1);
+      if (input.position_stroke_space == previous.position &&
+          input.elapsed_time == previous.elapsed_time) {
+        continue;
+      }
+    }
+    absl::Status status = batch.Append(
+        {.tool_type = tool_type,
+         .position = input.position_stroke_space,
+         .elapsed_time = input.elapsed_time,
+         .stroke_unit_length = PhysicalDistance::Centimeters(
+             proto.stroke_unit_length_in_centimeters()),
+         .pressure = input.pressure.value_or(StrokeInput::kNoPressure),
+         .tilt = input.tilt.has_value() ? Angle::Radians(*input.tilt)
+                                        : StrokeInput::kNoTilt,
+         .orientation = input.orientation.has_value()
+                            ? Angle::Radians(*input.orientation)
+                            : StrokeInput::kNoOrientation});
+    if (!status.ok()) return status;
+  }
+  batch.SetNoiseSeed(proto.noise_seed());
+  return batch;
+}
+
+void DecodeStrokeInputBatchMatchesInputByInputDecoding(
+    const CodedStrokeInputBatch& proto) {
+  absl::StatusOr<StrokeInputBatch> decoded = DecodeStrokeInputBatch(proto);
+  absl::StatusOr<StrokeInputBatch> expected =
+      DecodeStrokeInputBatchInputByInput(
+          proto, decoded.ok() ? decoded->GetToolType()
+                              : StrokeInput::ToolType::kUnknown);
+  ASSERT_EQ(decoded.status().code(), expected.status().code());
+  if (decoded.ok()) {
+    EXPECT_THAT(*decoded, StrokeInputBatchEq(*expected));
+  }
+}
+FUZZ_TEST(StrokeInputBatchFuzzTest,
+          DecodeStrokeInputBatchMatchesInputByInputDecoding);
+
 void EncodeStrokeInputBatchDoesNotCrashOnArbitraryInput(
     const StrokeInputBatch& inputs) {
   CodedStrokeInputBatch proto;
@@ -395,6 +876,12 @@ void StrokeInputBatchRoundTrip(const StrokeInputBatch& inputs) {
   EXPECT_EQ(decoded->GetToolType(), inputs.GetToolType());
   EXPECT_EQ(decoded->GetStrokeUnitLength(), inputs.GetStrokeUnitLength());
   EXPECT_EQ(decoded->GetNoiseSeed(), inputs.GetNoiseSeed());
+
+  // Such a proto is also trusted input, which should decode the same way.
+  absl::StatusOr<StrokeInputBatch> trusted_decoded =
+      DecodeStrokeInputBatch(proto, {.trusted_input = true});
+  ASSERT_EQ(trusted_decoded.status(), absl::OkStatus());
+  EXPECT_THAT(*trusted_decoded, StrokeInputBatchEq(*decoded));
 }
 FUZZ_TEST(StrokeInputBatchFuzzTest, StrokeInputBatchRoundTrip)
     // TODO: b/349965543 - Currently, extreme input position values sometimes
@@ -404,5 +891,33 @@ FUZZ_TEST(StrokeInputBatchFuzzTest, StrokeInputBatchRoundTrip)
     .WithDomains(StrokeInputBatchInRect(
         Rect::FromCenterAndDimensions(kOrigin, 1e30f, 1e30f)));
 
+void ChunkedStrokeInputBatchRoundTrip(const StrokeInputBatch& inputs,
+                                      size_t first_chunk_size) {
+  StrokeInputBatchChunkEncoder encoder;
+  CodedStrokeInputBatch appended;
+  CodedStrokeInputBatch chunk;
+  for (size_t input_count :
+       {std::min(first_chunk_size, inputs.Size()), inputs.Size()}) {
+    absl::Status status = encoder.EncodeNewInputs(inputs, input_count, chunk);
+    // Inputs that are too far apart, or too late, can't be encoded.
+    if (status.code() == absl::StatusCode::kOutOfRange) return;
+    ASSERT_EQ(status, absl::OkStatus());
+    ASSERT_EQ(AppendStrokeInputBatchChunk(chunk, appended), absl::OkStatus());
+  }
+
+  absl::StatusOr<StrokeInputBatch> decoded = DecodeStrokeInputBatch(appended);
+  ASSERT_EQ(decoded.status(), absl::OkStatus());
+  EXPECT_LE(decoded->Size(), inputs.Size());
+  if (!inputs.IsEmpty()) {
+    EXPECT_EQ(decoded->GetToolType(), inputs.GetToolType());
+    EXPECT_EQ(decoded->GetStrokeUnitLength(), inputs.GetStrokeUnitLength());
+    EXPECT_EQ(decoded->GetNoiseSeed(), inputs.GetNoiseSeed());
+  }
+}
+FUZZ_TEST(StrokeInputBatchFuzzTest, ChunkedStrokeInputBatchRoundTrip)
+    .WithDomains(StrokeInputBatchInRect(
+                     Rect::FromCenterAndDimensions(kOrigin, 1e4f, 1e4f)),
+                 fuzztest::InRange<size_t>(0, 10));
+
 }  // namespace
 }  // namespace ink
@@ -0,0 +1,229 @@
+// Copyright 2024-2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/storage/triangle_index_codec.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+
+namespace ink {
+namespace {
+
+// The number of recently seen edges that a triangle can be coded against.
+// This is small enough that every header code fits in a one-byte varint.
+constexpr int kEdgeFifoSize = 8;
+
+// The header code for a triangle that isn't coded against a recent edge. It is
+// followed by three explicit vertex codes.
+constexpr uint32_t kExplicitTriangleCode = 0;
+
+// Any other header code is one more than
+//   ((edge_age * 3 + third_slot) * 2 + same_direction) * 2 + third_is_next
+// where `edge_age` is the position of the shared edge in the FIFO (0 being
+// the most recently added), `third_slot` is the position within the triangle
+// of the vertex that isn't on the shared edge, `same_direction` is whether the
+// triangle traverses the shared edge in the same direction as the triangle
+// that added it, and `third_is_next` is whether the third vertex is the next
+// unreferenced vertex. If `third_is_next` is false, the header is followed by
+// an explicit vertex code for the third vertex.
+constexpr uint32_t kCodesPerEdge = 3 * 2 * 2;
+
+uint32_t ZigZagEncode(int32_t value) {
+  return (static_cast<uint32_t>(value) << 1) ^
+         static_cast<uint32_t>(value >> 31);
+}
+
+int32_t ZigZagDecode(uint32_t value) {
+  return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+struct Edge {
+  uint32_t from;
+  uint32_t to;
+};
+
+// The state that the encoder and decoder each build up as they go through the
+// triangles, which must evolve identically on both sides.
+class CodecState {
+ public:
+  int EdgeCount() const { return edge_count_; }
+
+  // Returns the edge that was added `age` edges ago, where 0 is the most
+  // recently added edge. `age` must be less than `EdgeCount()`.
+  Edge GetEdge(int age) const {
+    ABSL_DCHECK_LT(age, edge_count_);
+    return edges_[(next_edge_slot_ + kEdgeFifoSize - 1 - age) % kEdgeFifoSize];
+  }
+
+  // Returns one more than the largest vertex index referenced so far, or zero
+  // if there are none.
+  uint32_t NextVertex() const { return next_vertex_; }
+
+  // Explicit vertex codes are the zigzag-encoded difference from
+  // `NextVertex()`, wrapping around modulo 2^32.
+  uint32_t EncodeVertex(uint32_t vertex) {
+    uint32_t code = ZigZagEncode(static_cast<int32_t>(vertex - next_vertex_));
+    ReferenceVertex(vertex);
+    return code;
+  }
+  uint32_t DecodeVertex(uint32_t code) {
+    uint32_t vertex = next_vertex_ + static_cast<uint32_t>(ZigZagDecode(code));
+    ReferenceVertex(vertex);
+    return vertex;
+  }
+
+  void ReferenceVertex(uint32_t vertex) {
+    if (vertex >= next_vertex_) next_vertex_ = vertex + 1;
+  }
+
+  // Adds the edges of `triangle` to the FIFO, except for the edge starting at
+  // `shared_edge_slot`, if it is in [0, 2].
+  void AddTriangleEdges(const std::array<uint32_t, 3>& triangle,
+                        int shared_edge_slot) {
+    for (int slot = 0; slot < 3; ++slot) {
+      if (slot == shared_edge_slot) continue;
+      edges_[next_edge_slot_] = {triangle[slot], triangle[(slot + 1) % 3]};
+      next_edge_slot_ = (next_edge_slot_ + 1) % kEdgeFifoSize;
+      if (edge_count_ < kEdgeFifoSize) ++edge_count_;
+    }
+  }
+
+ private:
+  std::array<Edge, kEdgeFifoSize> edges_;
+  int next_edge_slot_ = 0;
+  int edge_count_ = 0;
+  uint32_t next_vertex_ = 0;
+};
+
+}  // namespace
+
+void EncodeTriangleIndexCodes(absl::Span<const uint32_t> triangle_indices,
+                              std::vector<uint32_t>& codes) {
+  ABSL_DCHECK_EQ(triangle_indices.size() % 3, 0u);
+  codes.reserve(codes.size() + triangle_indices.size() / 3);
+  CodecState state;
+  for (size_t i = 0; i + 2 < triangle_indices.size(); i += 3) {
+    std::array<uint32_t, 3> triangle = {
+        triangle_indices[i], triangle_indices[i + 1], triangle_indices[i + 2]};
+
+    // Look for a recent edge that the triangle shares, preferring one whose
+    // third vertex is the next unreferenced vertex, since that needs no
+    // explicit vertex code.
+    int best_header = -1;
+    int best_third_slot = 0;
+    bool found_next = false;
+    for (int age = 0; age < state.EdgeCount() && !found_next; ++age) {
+      Edge edge = state.GetEdge(age);
+      for (int third_slot = 0; third_slot < 3; ++third_slot) {
+        uint32_t first = triangle[(third_slot + 1) % 3];
+        uint32_t second = triangle[(third_slot + 2) % 3];
+        int same_direction;
+        if (first == edge.to && second == edge.from) {
+          same_direction = 0;
+        } else if (first == edge.from && second == edge.to) {
+          same_direction = 1;
+        } else {
+          continue;
+        }
+        bool third_is_next = triangle[third_slot] == state.NextVertex();
+        int header = 1 + ((age * 3 + third_slot) * 2 + same_direction) * 2 +
+                     (third_is_next ? 1 : 0);
+        if (best_header < 0 || third_is_next) {
+          best_header = header;
+          best_third_slot = third_slot;
+        }
+        if (third_is_next) {
+          found_next = true;
+          break;
+        }
+      }
+    }
+
+    if (best_header < 0) {
+      codes.push_back(kExplicitTriangleCode);
+      for (uint32_t vertex : triangle) {
+        codes.push_back(state.EncodeVertex(vertex));
+      }
+      state.AddTriangleEdges(triangle, -1);
+      continue;
+    }
+
+    codes.push_back(best_header);
+    if (found_next) {
+      state.ReferenceVertex(triangle[best_third_slot]);
+    } else {
+      codes.push_back(state.EncodeVertex(triangle[best_third_slot]));
+    }
+    state.AddTriangleEdges(triangle, (best_third_slot + 1) % 3);
+  }
+}
+
+absl::Status DecodeTriangleIndexCodes(absl::Span<const uint32_t> codes,
+                                      std::vector<uint32_t>& triangle_indices) {
+  // Every triangle takes at least one code.
+  triangle_indices.reserve(triangle_indices.size() + codes.size() * 3);
+  CodecState state;
+  size_t i = 0;
+  auto truncated_error = [&codes]() {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "triangle index codes are truncated after ", codes.size(), " codes"));
+  };
+  while (i < codes.size()) {
+    uint32_t header = codes[i++];
+    std::array<uint32_t, 3> triangle;
+
+    if (header == kExplicitTriangleCode) {
+      if (codes.size() - i < 3) return truncated_error();
+      for (uint32_t& vertex : triangle) {
+        vertex = state.DecodeVertex(codes[i++]);
+      }
+      state.AddTriangleEdges(triangle, -1);
+    } else {
+      uint32_t value = header - 1;
+      uint32_t age = value / kCodesPerEdge;
+      if (age >= static_cast<uint32_t>(state.EdgeCount())) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "triangle index code ", header, " at position ", i - 1,
+            " refers to edge ", age, ", but only ", state.EdgeCount(),
+            " edges are available"));
+      }
+      int third_slot = (value / 4) % 3;
+      bool same_direction = (value / 2) % 2 == 1;
+      bool third_is_next = value % 2 == 1;
+      Edge edge = state.GetEdge(age);
+      triangle[(third_slot + 1) % 3] = same_direction ? edge.from : edge.to;
+      triangle[(third_slot + 2) % 3] = same_direction ? edge.to : edge.from;
+      if (third_is_next) {
+        triangle[third_slot] = state.NextVertex();
+        state.ReferenceVertex(triangle[third_slot]);
+      } else {
+        if (i == codes.size()) return truncated_error();
+        triangle[third_slot] = state.DecodeVertex(codes[i++]);
+      }
+      state.AddTriangleEdges(triangle, (third_slot + 1) % 3);
+    }
+    triangle_indices.insert(triangle_indices.end(), triangle.begin(),
+                            triangle.end());
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace ink
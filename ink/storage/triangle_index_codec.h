@@ -0,0 +1,49 @@
+// Copyright 2024-2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STORAGE_TRIANGLE_INDEX_CODEC_H_
+#define INK_STORAGE_TRIANGLE_INDEX_CODEC_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+
+namespace ink {
+
+// Encodes a triangle list (three vertex indices per triangle) into the
+// topology-aware code stream stored in `CodedMesh.triangle_index_codes`, and
+// appends the codes to `codes`. `triangle_indices.size()` must be a multiple of
+// three.
+//
+// Each triangle is coded relative to a small FIFO of recently seen edges, and
+// to the next vertex that hasn't been referenced yet. A triangle that shares an
+// edge with a recent triangle and introduces a new vertex, as is typical of the
+// strips and fans of extruded stroke meshes, takes a single one-byte code.
+// Other triangles fall back to explicit, delta-coded vertex indices. The exact
+// triangle order and vertex order within each triangle are preserved.
+void EncodeTriangleIndexCodes(absl::Span<const uint32_t> triangle_indices,
+                              std::vector<uint32_t>& codes);
+
+// Decodes a code stream produced by `EncodeTriangleIndexCodes()` and appends
+// the resulting triangle indices to `triangle_indices`. Returns an error if
+// `codes` is malformed, in which case the contents of `triangle_indices` are
+// unspecified. This does not check the decoded indices against a vertex count.
+absl::Status DecodeTriangleIndexCodes(absl::Span<const uint32_t> codes,
+                                      std::vector<uint32_t>& triangle_indices);
+
+}  // namespace ink
+
+#endif  // INK_STORAGE_TRIANGLE_INDEX_CODEC_H_
@@ -0,0 +1,182 @@
+// Copyright 2024-2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/storage/triangle_index_codec.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "fuzztest/fuzztest.h"
+#include "absl/status/status.h"
+
+namespace ink {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Lt;
+
+// Returns the triangles of a strip along the vertices 0, 1, 2, ..., alternating
+// sides, with consistent winding.
+std::vector<uint32_t> MakeStrip(uint32_t vertex_count) {
+  std::vector<uint32_t> indices;
+  for (uint32_t i = 0; i + 2 < vertex_count; ++i) {
+    if (i % 2 == 0) {
+      indices.insert(indices.end(), {i, i + 1, i + 2});
+    } else {
+      indices.insert(indices.end(), {i + 1, i, i + 2});
+    }
+  }
+  return indices;
+}
+
+std::vector<uint32_t> RoundTrip(const std::vector<uint32_t>& indices) {
+  std::vector<uint32_t> codes;
+  EncodeTriangleIndexCodes(indices, codes);
+  std::vector<uint32_t> decoded;
+  EXPECT_EQ(DecodeTriangleIndexCodes(codes, decoded), absl::OkStatus());
+  return decoded;
+}
+
+TEST(TriangleIndexCodecTest, EncodeEmpty) {
+  std::vector<uint32_t> codes;
+  EncodeTriangleIndexCodes({}, codes);
+  EXPECT_THAT(codes, IsEmpty());
+
+  std::vector<uint32_t> decoded;
+  EXPECT_EQ(DecodeTriangleIndexCodes(codes, decoded), absl::OkStatus());
+  EXPECT_THAT(decoded, IsEmpty());
+}
+
+TEST(TriangleIndexCodecTest, SingleTriangle) {
+  std::vector<uint32_t> codes;
+  EncodeTriangleIndexCodes({0, 1, 2}, codes);
+  // A header code followed by three explicit vertex codes.
+  EXPECT_THAT(codes, ElementsAre(0, 0, 0, 0));
+
+  std::vector<uint32_t> decoded;
+  EXPECT_EQ(DecodeTriangleIndexCodes(codes, decoded), absl::OkStatus());
+  EXPECT_THAT(decoded, ElementsAre(0, 1, 2));
+}
+
+TEST(TriangleIndexCodecTest, StripTakesOneSmallCodePerTriangle) {
+  std::vector<uint32_t> strip = MakeStrip(100);
+  std::vector<uint32_t> codes;
+  EncodeTriangleIndexCodes(strip, codes);
+  // The first triangle takes four codes, and every other triangle takes one.
+  EXPECT_EQ(codes.size(), 4 + (strip.size() / 3 - 1));
+  // Every code fits in a one-byte varint.
+  EXPECT_THAT(codes, Each(Lt(128u)));
+  EXPECT_EQ(RoundTrip(strip), strip);
+}
+
+TEST(TriangleIndexCodecTest, FanTakesOneSmallCodePerTriangle) {
+  std::vector<uint32_t> fan;
+  for (uint32_t i = 1; i < 50; ++i) {
+    fan.insert(fan.end(), {0, i, i + 1});
+  }
+  std::vector<uint32_t> codes;
+  EncodeTriangleIndexCodes(fan, codes);
+  EXPECT_EQ(codes.size(), 4 + (fan.size() / 3 - 1));
+  EXPECT_THAT(codes, Each(Lt(128u)));
+  EXPECT_EQ(RoundTrip(fan), fan);
+}
+
+TEST(TriangleIndexCodecTest, PreservesTriangleAndVertexOrder) {
+  // Triangles that share edges in either direction and at any position within
+  // the triangle, that reuse old vertices, and that share no edges at all.
+  std::vector<uint32_t> indices = {
+      0, 1, 2,  //
+      1, 3, 2,  //
+      3, 2, 1,  //
+      2, 0, 3,  //
+      9, 7, 8,  //
+      7, 9, 4,  //
+      4, 4, 4,  //
+      8, 9, 0,  //
+  };
+  EXPECT_EQ(RoundTrip(indices), indices);
+}
+
+TEST(TriangleIndexCodecTest, LargeVertexIndices) {
+  std::vector<uint32_t> indices = {
+      0xffffffff, 0, 0x80000000,  //
+      0x80000000, 0, 0x7fffffff,  //
+      0x7fffffff, 0, 0xfffffffe,  //
+  };
+  EXPECT_EQ(RoundTrip(indices), indices);
+}
+
+TEST(TriangleIndexCodecTest, DecodeAppendsToExistingIndices) {
+  std::vector<uint32_t> codes;
+  EncodeTriangleIndexCodes({0, 1, 2}, codes);
+  std::vector<uint32_t> decoded = {5, 6, 7};
+  EXPECT_EQ(DecodeTriangleIndexCodes(codes, decoded), absl::OkStatus());
+  EXPECT_THAT(decoded, ElementsAre(5, 6, 7, 0, 1, 2));
+}
+
+TEST(TriangleIndexCodecTest, DecodeTruncatedCodes) {
+  std::vector<uint32_t> decoded;
+  absl::Status truncated_triangle =
+      DecodeTriangleIndexCodes({0, 0, 0}, decoded);
+  EXPECT_EQ(truncated_triangle.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(truncated_triangle.message(), HasSubstr("truncated"));
+
+  // A triangle sharing the first edge of the first triangle, whose third
+  // vertex is coded explicitly, but is missing.
+  decoded.clear();
+  absl::Status truncated_vertex =
+      DecodeTriangleIndexCodes({0, 0, 0, 0, 1}, decoded);
+  EXPECT_EQ(truncated_vertex.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(truncated_vertex.message(), HasSubstr("truncated"));
+}
+
+TEST(TriangleIndexCodecTest, DecodeReferenceToMissingEdge) {
+  std::vector<uint32_t> decoded;
+  absl::Status no_edges = DecodeTriangleIndexCodes({1}, decoded);
+  EXPECT_EQ(no_edges.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(no_edges.message(), HasSubstr("edges are available"));
+
+  decoded.clear();
+  absl::Status too_old = DecodeTriangleIndexCodes({0, 0, 0, 0, 100}, decoded);
+  EXPECT_EQ(too_old.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(too_old.message(), HasSubstr("edges are available"));
+}
+
+void TriangleIndexCodesRoundTrip(std::vector<uint32_t> indices) {
+  indices.resize(indices.size() - indices.size() % 3);
+  EXPECT_EQ(RoundTrip(indices), indices);
+}
+FUZZ_TEST(TriangleIndexCodecTest, TriangleIndexCodesRoundTrip);
+
+void SmallTriangleIndexCodesRoundTrip(std::vector<uint32_t> indices) {
+  TriangleIndexCodesRoundTrip(indices);
+}
+FUZZ_TEST(TriangleIndexCodecTest, SmallTriangleIndexCodesRoundTrip)
+    .WithDomains(fuzztest::VectorOf(fuzztest::InRange<uint32_t>(0, 10)));
+
+void DecodeTriangleIndexCodesDoesNotCrashOnArbitraryInput(
+    const std::vector<uint32_t>& codes) {
+  std::vector<uint32_t> decoded;
+  DecodeTriangleIndexCodes(codes, decoded).IgnoreError();
+}
+FUZZ_TEST(TriangleIndexCodecTest,
+          DecodeTriangleIndexCodesDoesNotCrashOnArbitraryInput);
+
+}  // namespace
+}  // namespace ink
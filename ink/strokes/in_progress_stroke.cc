@@ -14,36 +14,142 @@
 
 #include "ink/strokes/in_progress_stroke.h"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <optional>
+#include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/base/nullability.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush.h"
 #include "ink/brush/brush_coat.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mutable_mesh.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
 #include "ink/strokes/input/internal/stroke_input_validation_helpers.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/stroke_shape_builder_pool.h"
+#include "ink/strokes/internal/stroke_shape_stats_timer.h"
 #include "ink/strokes/internal/stroke_shape_update.h"
 #include "ink/strokes/internal/stroke_vertex.h"
 #include "ink/strokes/stroke.h"
+#include "ink/strokes/stroke_shape_stats.h"
+#include "ink/strokes/stroke_update_histograms.h"
 #include "ink/types/duration.h"
+#include "ink/types/executor.h"
+#include "ink/types/trace.h"
 
 namespace ink {
 
 using ::ink::stroke_input_internal::ValidateConsecutiveInputs;
+using ::ink::strokes_internal::StrokeShapeBuilderPool;
 using ::ink::strokes_internal::StrokeShapeUpdate;
 using ::ink::strokes_internal::StrokeVertex;
 
+namespace {
+
+// Moves the first `count` inputs of `from` to the end of `to`. The inputs of
+// `from` must form a valid continuation of those in `to`.
+absl::Status MoveLeadingInputs(StrokeInputBatch& from, size_t count,
+                               StrokeInputBatch& to) {
+  auto leading = [count](absl::Span<const float> column) {
+    return column.subspan(0, count);
+  };
+  StrokeInputBatch::InputColumns columns = {
+      .tool_type = from.GetToolType(),
+      .stroke_unit_length = from.GetStrokeUnitLength().value_or(
+          StrokeInput::kNoStrokeUnitLength),
+      .x = leading(from.GetXPositions()),
+      .y = leading(from.GetYPositions()),
+      .elapsed_seconds = leading(from.GetElapsedTimesInSeconds()),
+      .pressure = leading(from.GetPressures()),
+      .tilt_radians = leading(from.GetTiltsInRadians()),
+      .orientation_radians = leading(from.GetOrientationsInRadians()),
+  };
+  // The inputs were already validated when they were enqueued.
+  if (absl::Status status = to.AppendTrustedColumns(columns); !status.ok()) {
+    return status;
+  }
+  from.Erase(0, count);
+  return absl::OkStatus();
+}
+
+// Returns true if any vertex of `mesh`, which must have the full stroke vertex
+// format, has a non-zero HSL color shift.
+bool HasNonZeroHslShift(const MutableMesh& mesh) {
+  for (uint32_t i = 0; i < mesh.VertexCount(); ++i) {
+    for (float component :
+         StrokeVertex::GetFromMesh(mesh, i).non_position_attributes.hsl_shift) {
+      if (component != 0) return true;
+    }
+  }
+  return false;
+}
+
+// The geometry of one coat with its separate tail appended, which is packed
+// into the shape of a `Stroke` in place of the coat's stable geometry.
+struct CoatWithTail {
+  MutableMesh mesh;
+  std::vector<std::vector<uint32_t>> outline_indices;
+  std::vector<absl::Span<const uint32_t>> outlines;
+};
+
+// Sets `merged` to the vertices and triangles of `mesh` followed by those of
+// `tail`, which must have the same format, and to the outlines of both.
+void AppendTail(const MutableMesh& mesh,
+                absl::Span<const absl::Span<const uint32_t>> outlines,
+                const MutableMesh& tail,
+                absl::Span<const absl::Span<const uint32_t>> tail_outlines,
+                CoatWithTail& merged) {
+  ABSL_DCHECK(mesh.Format() == tail.Format());
+  uint32_t vertex_offset = mesh.VertexCount();
+  uint32_t triangle_offset = mesh.TriangleCount();
+  merged.mesh = mesh.Clone();
+  merged.mesh.Resize(vertex_offset + tail.VertexCount(),
+                     triangle_offset + tail.TriangleCount());
+  absl::c_copy(tail.RawVertexData(),
+               merged.mesh.MutableRawVertexData().begin() +
+                   vertex_offset * mesh.VertexStride());
+  for (uint32_t i = 0; i < tail.TriangleCount(); ++i) {
+    std::array<uint32_t, 3> triangle = tail.TriangleIndices(i);
+    for (uint32_t& index : triangle) index += vertex_offset;
+    merged.mesh.SetTriangleIndices(triangle_offset + i, triangle);
+  }
+
+  merged.outline_indices.clear();
+  for (absl::Span<const uint32_t> outline : outlines) {
+    merged.outline_indices.emplace_back(outline.begin(), outline.end());
+  }
+  for (absl::Span<const uint32_t> outline : tail_outlines) {
+    std::vector<uint32_t>& indices = merged.outline_indices.emplace_back();
+    indices.reserve(outline.size());
+    for (uint32_t index : outline) indices.push_back(index + vertex_offset);
+  }
+  merged.outlines.assign(merged.outline_indices.begin(),
+                         merged.outline_indices.end());
+}
+
+}  // namespace
+
 void InProgressStroke::Clear() {
   brush_.reset();
   queued_real_inputs_.Clear();
@@ -52,6 +158,10 @@ void InProgressStroke::Clear() {
   real_input_count_ = 0;
   current_elapsed_time_ = Duration32::Zero();
   updated_region_.Reset();
+  accumulated_coat_updates_.clear();
+  coat_mesh_indices_.clear();
+  unindexed_coat_updates_.clear();
+  last_update_stats_ = {};
   inputs_are_finished_ = true;
 }
 
@@ -63,16 +173,91 @@ void InProgressStroke::Start(const Brush& brush, uint32_t noise_seed) {
 
   absl::Span<const BrushCoat> coats = brush_->GetCoats();
   uint32_t num_coats = coats.size();
-  // If necessary, expand the builders vector to the number of brush coats. In
-  // order to cache all the allocations within, we never shrink this vector.
+  PrepareCoats(num_coats);
+
+  input_modeler_.StartStroke(brush_->GetFamily().GetInputModel(),
+                             brush_->GetEpsilon());
+  input_decimator_.StartStroke(
+      input_decimation_enabled_ ? brush_->GetEpsilon() : 0);
+  for (uint32_t i = 0; i < num_coats; ++i) {
+    shape_builders_[i].StartStroke(coats[i], brush_->GetSize(),
+                                   brush_->GetEpsilon(), noise_seed, budget_,
+                                   separate_tail_enabled_);
+  }
+}
+
+void InProgressStroke::PrepareCoats(uint32_t num_coats) {
+  // If necessary, expand the builders vector to the number of brush coats,
+  // borrowing already-warmed builders from this thread's pool where possible.
+  // In order to cache all the allocations within, we never shrink this vector.
   if (shape_builders_.size() < num_coats) {
-    shape_builders_.resize(num_coats);
+    StrokeShapeBuilderPool& builder_pool =
+        StrokeShapeBuilderPool::ForCurrentThread();
+    while (shape_builders_.size() < num_coats) {
+      shape_builders_.push_back(builder_pool.Acquire());
+    }
+  }
+
+  accumulated_coat_updates_.resize(num_coats);
+  unindexed_coat_updates_.resize(num_coats);
+  // The brush size is on the order of the size of the stroke's triangles, which
+  // makes it a good cell size for the spatial indices.
+  coat_mesh_indices_.resize(num_coats);
+  for (geometry_internal::MeshGridIndex& index : coat_mesh_indices_) {
+    index.Reset(brush_->GetSize());
+  }
+}
+
+void InProgressStroke::CopyFrom(const InProgressStroke& other) {
+  if (this == &other) return;
+
+  // The meshes being replaced must be redrawn as well as the copied ones.
+  Envelope replaced_region = updated_region_;
+  for (uint32_t i = 0; i < BrushCoatCount(); ++i) {
+    replaced_region.Add(GetMeshBounds(i));
+    replaced_region.Add(GetTailMeshBounds(i));
   }
 
+  Clear();
+  budget_ = other.budget_;
+  prediction_horizon_ = other.prediction_horizon_;
+  input_decimation_enabled_ = other.input_decimation_enabled_;
+  separate_tail_enabled_ = other.separate_tail_enabled_;
+  vertex_welding_enabled_ = other.vertex_welding_enabled_;
+  updated_region_ = replaced_region;
+  if (!other.brush_.has_value()) return;
+
+  brush_ = other.brush_;
+  queued_real_inputs_ = other.queued_real_inputs_;
+  queued_predicted_inputs_ = other.queued_predicted_inputs_;
+  processed_inputs_ = other.processed_inputs_;
+  real_input_count_ = other.real_input_count_;
+  current_elapsed_time_ = other.current_elapsed_time_;
+  input_decimator_ = other.input_decimator_;
+  inputs_are_finished_ = other.inputs_are_finished_;
+  last_update_stats_ = other.last_update_stats_;
+
+  absl::Span<const BrushCoat> coats = brush_->GetCoats();
+  uint32_t num_coats = coats.size();
+  PrepareCoats(num_coats);
+
+  input_modeler_.CopyStateFrom(
+      other.input_modeler_,
+      other.processed_inputs_.Slice(0, other.real_input_count_));
+  coat_updates_ = other.coat_updates_;
+  // Report every coat as updated in full, and leave the spatial indices to be
+  // rebuilt from scratch when they are next queried.
   for (uint32_t i = 0; i < num_coats; ++i) {
-    shape_builders_[i].StartStroke(brush_->GetFamily().GetInputModel(),
-                                   coats[i], brush_->GetSize(),
-                                   brush_->GetEpsilon(), noise_seed);
+    shape_builders_[i].CopyStateFrom(other.shape_builders_[i], coats[i]);
+    strokes_internal::StrokeShapeUpdate full_update = {
+        .region = GetMeshBounds(i),
+        .first_index_offset = 0,
+        .first_vertex_offset = 0,
+    };
+    full_update.region.Add(GetTailMeshBounds(i));
+    updated_region_.Add(full_update.region);
+    accumulated_coat_updates_[i] = full_update;
+    unindexed_coat_updates_[i] = full_update;
   }
 }
 
@@ -99,7 +284,11 @@ absl::Status InProgressStroke::EnqueueInputs(
     return status;
   }
 
-  if (absl::Status status = queued_real_inputs_.Append(real_inputs);
+  if (absl::Status status =
+          input_decimator_.IsEnabled()
+              ? input_decimator_.AppendKeptInputs(real_inputs,
+                                                  queued_real_inputs_)
+              : queued_real_inputs_.Append(real_inputs);
       !status.ok()) {
     ABSL_LOG(ERROR) << "Failed to append new real inputs to queued real inputs "
                        "after validation: "
@@ -111,7 +300,20 @@ absl::Status InProgressStroke::EnqueueInputs(
   return absl::OkStatus();
 }
 
-absl::Status InProgressStroke::UpdateShape(Duration32 current_elapsed_time) {
+absl::Status InProgressStroke::UpdateShape(
+    Duration32 current_elapsed_time, Executor* absl_nullable coat_executor) {
+  return UpdateShapeWithinBudget(current_elapsed_time,
+                                 std::numeric_limits<uint32_t>::max(),
+                                 coat_executor);
+}
+
+absl::Status InProgressStroke::UpdateShapeWithinBudget(
+    Duration32 current_elapsed_time, uint32_t max_real_inputs,
+    Executor* absl_nullable coat_executor) {
+  ScopedTraceEvent trace_event("ink::InProgressStroke::UpdateShape");
+  // Only read the clock if the duration will be recorded.
+  int64_t start_nanos =
+      update_histograms_ != nullptr ? absl::GetCurrentTimeNanos() : 0;
   if (!brush_.has_value()) {
     return absl::FailedPreconditionError(
         "`Start()` must be called at least once prior to calling "
@@ -128,7 +330,26 @@ absl::Status InProgressStroke::UpdateShape(Duration32 current_elapsed_time) {
     processed_inputs_.Erase(real_input_count_);
   }
 
-  if (absl::Status status = processed_inputs_.Append(queued_real_inputs_);
+  // If not all of the queued real inputs fit in this update, the rest stay
+  // queued for the next one, along with the predicted inputs, which continue
+  // from the last queued real input.
+  bool defers_real_inputs = queued_real_inputs_.Size() > max_real_inputs;
+  const StrokeInputBatch* real_inputs = &queued_real_inputs_;
+  const StrokeInputBatch* predicted_inputs = &queued_predicted_inputs_;
+  if (defers_real_inputs) {
+    partial_real_inputs_.Clear();
+    if (absl::Status status = MoveLeadingInputs(
+            queued_real_inputs_, max_real_inputs, partial_real_inputs_);
+        !status.ok()) {
+      ABSL_LOG(ERROR) << "Failed to split queued real inputs after validation: "
+                      << status;
+      return status;
+    }
+    real_inputs = &partial_real_inputs_;
+    predicted_inputs = &partial_predicted_inputs_;
+  }
+
+  if (absl::Status status = processed_inputs_.Append(*real_inputs);
       !status.ok()) {
     ABSL_LOG(ERROR)
         << "Failed to appened queued real inputs to processed inputs "
@@ -136,9 +357,9 @@ absl::Status InProgressStroke::UpdateShape(Duration32 current_elapsed_time) {
         << status;
     return status;
   }
-  real_input_count_ += queued_real_inputs_.Size();
+  real_input_count_ += real_inputs->Size();
 
-  if (absl::Status status = processed_inputs_.Append(queued_predicted_inputs_);
+  if (absl::Status status = processed_inputs_.Append(*predicted_inputs);
       !status.ok()) {
     ABSL_LOG(ERROR)
         << "Failed to appened queued predicted inputs to processed inputs "
@@ -149,16 +370,50 @@ absl::Status InProgressStroke::UpdateShape(Duration32 current_elapsed_time) {
 
   current_elapsed_time_ = current_elapsed_time;
 
+  last_update_stats_ = {};
+  // Modeled inputs past this count are regenerated by `ExtendStroke()`.
+  size_t stable_modeled_input_count =
+      input_modeler_.GetState().stable_input_count;
+  {
+    strokes_internal::ScopedStatsTimer timer(
+        last_update_stats_.input_modeling_nanos);
+    input_modeler_.ExtendStroke(
+        *real_inputs, *predicted_inputs, current_elapsed_time,
+        inputs_are_finished_ ? Duration32::Zero() : prediction_horizon_);
+  }
+
+  // Each builder only writes to its own mesh and outlines, and only reads from
+  // the shared `input_modeler_`, so the coats can be extended concurrently.
   uint32_t num_coats = BrushCoatCount();
+  coat_updates_.resize(num_coats);
+  ParallelFor(coat_executor, num_coats, [this](size_t i) {
+    coat_updates_[i] = shape_builders_[i].ExtendStroke(input_modeler_);
+  });
   for (uint32_t i = 0; i < num_coats; ++i) {
-    StrokeShapeUpdate update = shape_builders_[i].ExtendStroke(
-        queued_real_inputs_, queued_predicted_inputs_, current_elapsed_time);
+    updated_region_.Add(coat_updates_[i].region);
+    accumulated_coat_updates_[i].Add(coat_updates_[i]);
+    unindexed_coat_updates_[i].Add(coat_updates_[i]);
+    if constexpr (kStrokeShapeStatsEnabled) {
+      last_update_stats_.Add(shape_builders_[i].GetLastUpdateStats());
+    }
+  }
 
-    updated_region_.Add(update.region);
-    // TODO: b/286547863 - Pass `update.first_vertex_offset` and
-    // `update.first_index_offset` to a `RenderCache` member once implemented.
+  if (update_histograms_ != nullptr) {
+    int64_t update_nanos = absl::GetCurrentTimeNanos() - start_nanos;
+    update_histograms_->update_shape_nanos.Record(update_nanos);
+    update_histograms_->inputs_per_update.Record(real_inputs->Size());
+    update_histograms_->modeled_inputs_per_update.Record(
+        input_modeler_.GetModeledInputs().size() - stable_modeled_input_count);
+    if (!real_inputs->IsEmpty()) {
+      Duration32 input_age =
+          current_elapsed_time -
+          real_inputs->Get(real_inputs->Size() - 1).elapsed_time;
+      update_histograms_->input_latency_nanos.Record(
+          static_cast<int64_t>(input_age.ToSeconds() * 1e9) + update_nanos);
+    }
   }
 
+  if (defers_real_inputs) return absl::OkStatus();
   queued_real_inputs_.Clear();
   queued_predicted_inputs_.Clear();
   return absl::OkStatus();
@@ -174,13 +429,22 @@ bool InProgressStroke::NeedsUpdate() const {
 bool InProgressStroke::ChangesWithTime() const {
   uint32_t num_coats = BrushCoatCount();
   for (uint32_t coat_index = 0; coat_index < num_coats; ++coat_index) {
-    if (shape_builders_[coat_index].HasUnfinishedTimeBehaviors()) {
+    if (shape_builders_[coat_index].HasUnfinishedTimeBehaviors(
+            input_modeler_)) {
       return true;
     }
   }
   return false;
 }
 
+bool InProgressStroke::ExceededBudget() const {
+  uint32_t num_coats = BrushCoatCount();
+  for (uint32_t coat_index = 0; coat_index < num_coats; ++coat_index) {
+    if (shape_builders_[coat_index].ExceededBudget()) return true;
+  }
+  return false;
+}
+
 absl::Status InProgressStroke::ValidateNewInputs(
     const StrokeInputBatch& real_inputs,
     const StrokeInputBatch& predicted_inputs) const {
@@ -235,10 +499,74 @@ absl::Status InProgressStroke::ValidateNewElapsedTime(
   return absl::OkStatus();
 }
 
+template <typename QueryType>
+void InProgressStroke::VisitIntersectedTrianglesImpl(
+    uint32_t coat_index, const QueryType& query,
+    absl::FunctionRef<bool(uint32_t)> visitor) const {
+  ABSL_CHECK_LT(coat_index, BrushCoatCount());
+  const MutableMesh& mesh = GetMesh(coat_index);
+  strokes_internal::StrokeShapeUpdate& update =
+      unindexed_coat_updates_[coat_index];
+  coat_mesh_indices_[coat_index].Update(mesh, update.first_index_offset,
+                                        update.first_vertex_offset);
+  update = {};
+  coat_mesh_indices_[coat_index].VisitIntersectedTriangles(mesh, query,
+                                                           visitor);
+}
+
+void InProgressStroke::VisitIntersectedTriangles(
+    uint32_t coat_index, Point query,
+    absl::FunctionRef<bool(uint32_t)> visitor) const {
+  VisitIntersectedTrianglesImpl(coat_index, query, visitor);
+}
+
+void InProgressStroke::VisitIntersectedTriangles(
+    uint32_t coat_index, const Segment& query,
+    absl::FunctionRef<bool(uint32_t)> visitor) const {
+  VisitIntersectedTrianglesImpl(coat_index, query, visitor);
+}
+
+void InProgressStroke::VisitIntersectedTriangles(
+    uint32_t coat_index, const Triangle& query,
+    absl::FunctionRef<bool(uint32_t)> visitor) const {
+  VisitIntersectedTrianglesImpl(coat_index, query, visitor);
+}
+
+void InProgressStroke::VisitIntersectedTriangles(
+    uint32_t coat_index, const Rect& query,
+    absl::FunctionRef<bool(uint32_t)> visitor) const {
+  VisitIntersectedTrianglesImpl(coat_index, query, visitor);
+}
+
+void InProgressStroke::VisitIntersectedTriangles(
+    uint32_t coat_index, const Quad& query,
+    absl::FunctionRef<bool(uint32_t)> visitor) const {
+  VisitIntersectedTrianglesImpl(coat_index, query, visitor);
+}
+
 Stroke InProgressStroke::CopyToStroke(
     RetainAttributes retain_attributes) const {
   const Brush* brush = GetBrush();
   ABSL_CHECK(brush);
+  return Stroke(*brush, processed_inputs_.MakeDeepCopy(),
+                MakeStrokeShape(retain_attributes));
+}
+
+Stroke InProgressStroke::MoveToStroke(RetainAttributes retain_attributes) {
+  const Brush* brush = GetBrush();
+  ABSL_CHECK(brush);
+  // Copying `processed_inputs_` only shares its copy-on-write storage. The
+  // call to `Clear()` then drops this stroke's reference to that storage,
+  // leaving the new `Stroke` as its sole owner.
+  Stroke stroke(*brush, processed_inputs_, MakeStrokeShape(retain_attributes));
+  Clear();
+  return stroke;
+}
+
+PartitionedMesh InProgressStroke::MakeStrokeShape(
+    RetainAttributes retain_attributes) const {
+  const Brush* brush = GetBrush();
+  ABSL_DCHECK(brush);
 
   uint32_t num_coats = BrushCoatCount();
   absl::InlinedVector<absl::InlinedVector<MeshFormat::AttributeId,
@@ -249,17 +577,34 @@ Stroke InProgressStroke::CopyToStroke(
   mesh_groups.reserve(num_coats);
   absl::InlinedVector<StrokeVertex::CustomPackingArray, 1>
       custom_packing_arrays(num_coats);
+  absl::InlinedVector<CoatWithTail, 1> coats_with_tail(num_coats);
 
   for (uint32_t coat_index = 0; coat_index < num_coats; ++coat_index) {
+    const MutableMesh* mesh = &GetMesh(coat_index);
+    absl::Span<const absl::Span<const uint32_t>> outlines =
+        GetCoatOutlines(coat_index);
+    if (GetTailMesh(coat_index).TriangleCount() != 0) {
+      AppendTail(*mesh, outlines, GetTailMesh(coat_index),
+                 GetTailCoatOutlines(coat_index), coats_with_tail[coat_index]);
+      mesh = &coats_with_tail[coat_index].mesh;
+      outlines = coats_with_tail[coat_index].outlines;
+    }
+
     switch (retain_attributes) {
       case RetainAttributes::kAll:
         break;
-      case RetainAttributes::kUsedByThisBrush: {
+      case RetainAttributes::kUsedByThisBrush:
+      case RetainAttributes::kUsedByThisStroke: {
         absl::flat_hash_set<MeshFormat::AttributeId> required_attributes =
             brush_internal::GetRequiredAttributeIds(
                 brush->GetFamily().GetCoats()[coat_index]);
-        for (MeshFormat::Attribute attribute :
-             GetMesh(coat_index).Format().Attributes()) {
+        // Of the attributes the renderer can do without, only the color shift
+        // depends on the inputs as well as on the brush.
+        if (retain_attributes == RetainAttributes::kUsedByThisStroke &&
+            !HasNonZeroHslShift(*mesh)) {
+          required_attributes.erase(MeshFormat::AttributeId::kColorShiftHsl);
+        }
+        for (MeshFormat::Attribute attribute : mesh->Format().Attributes()) {
           if (!required_attributes.contains(attribute.id)) {
             omit_attributes[coat_index].push_back(attribute.id);
           }
@@ -269,26 +614,27 @@ Stroke InProgressStroke::CopyToStroke(
     }
 
     custom_packing_arrays[coat_index] = StrokeVertex::MakeCustomPackingArray(
-        GetMesh(coat_index).Format(), omit_attributes[coat_index]);
+        mesh->Format(), omit_attributes[coat_index]);
 
     mesh_groups.push_back({
-        .mesh = &GetMesh(coat_index),
-        .outlines = GetCoatOutlines(coat_index),
+        .mesh = mesh,
+        .outlines = outlines,
         .omit_attributes = omit_attributes[coat_index],
         .packing_params = custom_packing_arrays[coat_index].Values(),
+        .vertex_welding = vertex_welding_enabled_
+                              ? MutableMesh::VertexWelding::kMergeIdentical
+                              : MutableMesh::VertexWelding::kNone,
     });
   }
   absl::StatusOr<PartitionedMesh> partitioned_mesh =
       PartitionedMesh::FromMutableMeshGroups(mesh_groups);
-  if (partitioned_mesh.ok()) {
-    return Stroke(*brush, processed_inputs_.MakeDeepCopy(), *partitioned_mesh);
-  } else {
+  if (!partitioned_mesh.ok()) {
     ABSL_LOG(WARNING)
         << "Failed to create PartitionedMesh for InProgressStroke: "
         << partitioned_mesh.status();
-    return Stroke(*brush, processed_inputs_.MakeDeepCopy(),
-                  PartitionedMesh::WithEmptyGroups(brush->CoatCount()));
+    return PartitionedMesh::WithEmptyGroups(brush->CoatCount());
   }
+  return *std::move(partitioned_mesh);
 }
 
 }  // namespace ink
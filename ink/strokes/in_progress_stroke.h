@@ -15,22 +15,39 @@
 #ifndef INK_STROKES_IN_PROGRESS_STROKE_H_
 #define INK_STROKES_IN_PROGRESS_STROKE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 
 #include "absl/base/nullability.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush.h"
 #include "ink/geometry/envelope.h"
+#include "ink/geometry/internal/mesh_grid_index.h"
 #include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/quad.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/triangle.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/stroke_input_decimator.h"
+#include "ink/strokes/internal/stroke_input_modeler.h"
 #include "ink/strokes/internal/stroke_shape_builder.h"
+#include "ink/strokes/internal/stroke_shape_update.h"
+#include "ink/strokes/performance_profile.h"
 #include "ink/strokes/stroke.h"
+#include "ink/strokes/stroke_shape_budget.h"
+#include "ink/strokes/stroke_shape_stats.h"
+#include "ink/strokes/stroke_update_histograms.h"
 #include "ink/types/duration.h"
+#include "ink/types/executor.h"
 
 namespace ink {
 
@@ -57,7 +74,8 @@ namespace ink {
 //   4. Continuing to call `UpdateShape()` and render after `FinishInputs()`
 //      until `NeedsUpdate()` returns false (to allow any lingering brush
 //      animations to complete).
-//   5. Extracting the completed stroke by calling `CopyToStroke()`.
+//   5. Extracting the completed stroke by calling `CopyToStroke()`, or
+//      `MoveToStroke()` if the `InProgressStroke` is about to be reused.
 //   6. Preferably, reusing the allocations in this object by persisting it and
 //      going back to step 1.
 class InProgressStroke {
@@ -73,6 +91,12 @@ class InProgressStroke {
     // brush. This saves on memory, but means that the mesh may need to be
     // regenerated if the brush paint is changed.
     kUsedByThisBrush,
+    // Like `kUsedByThisBrush`, but additionally omits attributes that the
+    // brush could use but that this stroke's mesh leaves at their default
+    // value everywhere (for example, a color shift behavior that never took
+    // effect). This gives the smallest mesh for the stroke as drawn, but means
+    // that the same brush may produce differently formatted meshes.
+    kUsedByThisStroke,
   };
 
   InProgressStroke() = default;
@@ -98,6 +122,94 @@ class InProgressStroke {
   // before starting to call `EnqueueInputs()` or `UpdateShape()`.
   void Start(const Brush& brush, uint32_t noise_seed = 0);
 
+  // Replaces this stroke with a copy of `other`, including its brush, inputs,
+  // shape, and settings (other than `SetUpdateHistograms()`), so that the two
+  // can then be updated independently. If `other` has not been started, this
+  // only copies its settings, and is otherwise equivalent to `Clear()`.
+  //
+  // This is meant for saving and restoring checkpoints of a stroke, as done by
+  // `StrokeReplay`: it costs time proportional to the size of the meshes, but
+  // does not extrude the stroke again. Both the replaced and the copied shapes
+  // are reported as updated by `GetUpdatedRegion()`,
+  // `GetCoatFirstUpdatedVertex()`, and `GetCoatFirstUpdatedTriangle()`.
+  void CopyFrom(const InProgressStroke& other);
+
+  // Sets the limits on the mesh size and per-update work for each brush coat
+  // of strokes started by subsequent calls to `Start()`. See
+  // `StrokeShapeBudget` for how the stroke degrades when a limit is reached.
+  // The budget is unlimited by default, and is not reset by `Clear()`.
+  void SetBudget(const StrokeShapeBudget& budget);
+  const StrokeShapeBudget& GetBudget() const;
+
+  // Sets whether strokes started by subsequent calls to `Start()` drop real
+  // inputs that would not visibly change the stroke, which saves modeling and
+  // extrusion work for high-rate styluses. When enabled, a real input is
+  // dropped if it is closer than the brush epsilon to the previous kept input,
+  // and has nearly the same pressure, tilt, and orientation. Dropped inputs are
+  // not included in `GetInputs()`, so a `Stroke` regenerated from those inputs
+  // has the same shape. Predicted inputs are never dropped.
+  //
+  // Disabled by default, and not reset by `Clear()`.
+  void SetInputDecimationEnabled(bool enabled);
+  bool InputDecimationEnabled() const;
+
+  // Sets how far ahead of the real inputs to predict the stroke when no
+  // predicted inputs are passed to `EnqueueInputs()`. When positive, each call
+  // to `UpdateShape()` that has no predicted inputs extends the stroke by
+  // extrapolating its modeled motion up to `horizon` past the last real input,
+  // which hides some input latency without the caller running its own
+  // predictor. The predicted part of the stroke is replaced on each update,
+  // and is dropped once `FinishInputs()` is called. It is not included in
+  // `GetInputs()`, so `PredictedInputCount()` stays zero. Explicit predicted
+  // inputs passed to `EnqueueInputs()` take precedence.
+  //
+  // Zero (disabled) by default, and not reset by `Clear()`. Takes effect on the
+  // next call to `UpdateShape()`. A negative `horizon` is treated as zero.
+  void SetPredictionHorizon(Duration32 horizon);
+  Duration32 GetPredictionHorizon() const;
+
+  // Sets whether strokes started by subsequent calls to `Start()` keep the
+  // geometry of the stroke's tail in a separate, small mesh for each coat,
+  // returned by `GetTailMesh()`. The tail covers the predicted inputs and the
+  // most recent real inputs, whose modeled shape may still change. Without it,
+  // every update reverts and re-extrudes the tail within `GetMesh()`; with it,
+  // `GetMesh()` is append-only, or nearly so, and only the tail mesh is rebuilt
+  // on each update. This lets a renderer keep the stable geometry of each coat
+  // in a GPU buffer that it only appends to, and re-upload just the tail.
+  //
+  // The tail mesh of each coat is meant to be drawn right after (on top of)
+  // `GetMesh()` for the same coat. For continuous coats it overlaps the end of
+  // the stable geometry, so a translucent coat is blended twice where they
+  // overlap, unless the renderer draws both into the same layer first.
+  // `CopyToStroke()` and `MoveToStroke()` include the tail in the stroke shape.
+  // Once `FinishInputs()` has been called and the stroke is fully updated, the
+  // tail is empty.
+  //
+  // Disabled by default, and not reset by `Clear()`.
+  void SetSeparateTailEnabled(bool enabled);
+  bool SeparateTailEnabled() const;
+
+  // Sets whether `CopyToStroke()` and `MoveToStroke()` merge duplicate
+  // vertices of the stroke's meshes, such as those the extruder emits where it
+  // breaks the extrusion or repositions the outline, into one vertex each; see
+  // `MutableMesh::VertexWelding::kMergeIdentical`. This reduces the vertex
+  // count and memory of the stroke shape, at the cost of an extra pass over
+  // the vertices when the stroke is copied. Vertices are only merged if they
+  // are identical in every attribute that the stroke shape keeps.
+  //
+  // Disabled by default, and not reset by `Clear()`.
+  void SetVertexWeldingEnabled(bool enabled);
+  bool VertexWeldingEnabled() const;
+
+  // Sets the budget, input decimation, prediction horizon, separate tail, and
+  // vertex welding from the corresponding fields of `profile`, as if by calling
+  // each setter above.
+  void SetPerformanceProfile(const PerformanceProfile& profile);
+
+  // Returns true if the shape of any brush coat of the current stroke has
+  // reached a limit of the budget set by `SetBudget()`, and so has degraded.
+  bool ExceededBudget() const;
+
   // Enqueues the incremental `real_inputs` and sets the prediction to
   // `predicted_inputs`, overwriting any previous prediction. Queued inputs will
   // be processed on the next call to `UpdateShape()`.
@@ -136,7 +248,28 @@ class InProgressStroke {
   //
   // If the above requirements are not satisfied, an error is returned and this
   // object is left in the state it had prior to the call.
-  absl::Status UpdateShape(Duration32 current_elapsed_time);
+  //
+  // If `coat_executor` is non-null and the brush has more than one coat, the
+  // geometry for each coat is built concurrently by tasks run on
+  // `coat_executor`. Inputs are still modeled only once, on the calling thread,
+  // and this method does not return until all of the coats are updated.
+  absl::Status UpdateShape(Duration32 current_elapsed_time,
+                           Executor* absl_nullable coat_executor = nullptr);
+
+  // Like `UpdateShape()`, but processes at most `max_real_inputs` of the queued
+  // real inputs, so that a burst of queued inputs (e.g. after the app stalls)
+  // can be spread over several frames. Any remaining real inputs, and the
+  // queued predicted inputs, stay queued for the next update, so
+  // `NeedsUpdate()` keeps returning true until they are all processed. The
+  // geometry after each partial update is a valid rendering of the inputs
+  // processed so far, as if no further inputs had been enqueued yet.
+  //
+  // With a `max_real_inputs` of zero, only the passage of time is applied. If
+  // the update time per input is measured, e.g. with `GetLastUpdateStats()`,
+  // this can be used to stay within a time budget.
+  absl::Status UpdateShapeWithinBudget(
+      Duration32 current_elapsed_time, uint32_t max_real_inputs,
+      Executor* absl_nullable coat_executor = nullptr);
 
   // Returns true if `FinishInputs()` has been called since the last call to
   // `Start()`, or if `Start()` hasn't been called yet. If this returns true, it
@@ -203,7 +336,9 @@ class InProgressStroke {
   // includes geometry generated from all of the real inputs and the current
   // predicted inputs as of the last call to `Start()` or `UpdateShape()`. This
   // geometry will *not* reflect any inputs that have been passed to
-  // `EnqueueInputs()` since the last call to `UpdateShape()`.
+  // `EnqueueInputs()` since the last call to `UpdateShape()`. If the stroke was
+  // started with `SeparateTailEnabled()`, the geometry of the stroke's tail is
+  // returned by `GetTailMesh()` instead.
   //
   // TODO: b/295166196 - Once `MutableMesh` always uses 16-bit indices, rename
   // this method to `GetMeshes` and change it to return an `absl::Span<const
@@ -232,10 +367,91 @@ class InProgressStroke {
   absl::Span<const absl::Span<const uint32_t>> GetCoatOutlines(
       uint32_t coat_index) const;
 
+  // Returns the separate tail geometry for the specified coat of paint, its
+  // bounds, and its outlines, which index into `GetTailMesh()`. These are
+  // empty unless the stroke was started with `SeparateTailEnabled()`; see
+  // `SetSeparateTailEnabled()`. The tail mesh is rebuilt in full by every call
+  // to `UpdateShape()`, so it is not covered by `GetCoatFirstUpdatedVertex()`
+  // and `GetCoatFirstUpdatedTriangle()`, but its old and new bounds are
+  // included in `GetUpdatedRegion()`.
+  //
+  // CHECK-fails if `coat_index` is not less than `BrushCoatCount()`.
+  const MutableMesh& GetTailMesh(uint32_t coat_index) const;
+  const Envelope& GetTailMeshBounds(uint32_t coat_index) const;
+  absl::Span<const absl::Span<const uint32_t>> GetTailCoatOutlines(
+      uint32_t coat_index) const;
+
+  // Visits the index of each triangle of `GetMesh(coat_index)` that intersects
+  // `query`, as per the `Intersects` family of functions, in an unspecified
+  // order. `visitor` returns whether to continue the visit. This is meant for
+  // hit-testing the stroke while it is being drawn, e.g. to snap to it or to
+  // erase part of it.
+  //
+  // The triangles are found with a spatial index over each coat's mesh, which
+  // is built on the first call. After that, each call only re-indexes the
+  // triangles that were added or changed by `UpdateShape()` since the previous
+  // call; since updates mostly revert and re-extrude the end of the stroke,
+  // this is usually a small part of the mesh. The triangles of `GetTailMesh()`
+  // are not visited; that mesh is small enough to test directly.
+  //
+  // CHECK-fails if `coat_index` is not less than `BrushCoatCount()`.
+  void VisitIntersectedTriangles(
+      uint32_t coat_index, Point query,
+      absl::FunctionRef<bool(uint32_t)> visitor) const;
+  void VisitIntersectedTriangles(
+      uint32_t coat_index, const Segment& query,
+      absl::FunctionRef<bool(uint32_t)> visitor) const;
+  void VisitIntersectedTriangles(
+      uint32_t coat_index, const Triangle& query,
+      absl::FunctionRef<bool(uint32_t)> visitor) const;
+  void VisitIntersectedTriangles(
+      uint32_t coat_index, const Rect& query,
+      absl::FunctionRef<bool(uint32_t)> visitor) const;
+  void VisitIntersectedTriangles(
+      uint32_t coat_index, const Quad& query,
+      absl::FunctionRef<bool(uint32_t)> visitor) const;
+
   // Returns the bounding rectangle of mesh positions added, modified, or
   // removed by calls to `UpdateShape()` since the most recent call to `Start()`
   // or `ResetUpdatedRegion()`.
   const Envelope& GetUpdatedRegion() const;
+
+  // Returns the index of the first vertex or triangle in `GetMesh(coat_index)`
+  // that was added or modified by calls to `UpdateShape()` since the most
+  // recent call to `Start()` or `ResetUpdatedRegion()`, or `std::nullopt` if
+  // there were no such changes.
+  //
+  // Every vertex or triangle before the returned index is unchanged, so a
+  // renderer that keeps a copy of the mesh data only needs to re-upload data
+  // from this index onward. The returned index may be greater than or equal to
+  // the current count if vertices or triangles were only removed from the end
+  // of the mesh.
+  //
+  // CHECK-fails if `coat_index` is not less than `BrushCoatCount()`.
+  std::optional<uint32_t> GetCoatFirstUpdatedVertex(uint32_t coat_index) const;
+  std::optional<uint32_t> GetCoatFirstUpdatedTriangle(
+      uint32_t coat_index) const;
+
+  // Returns timings and counters for the work done by the most recent call to
+  // `UpdateShape()`, summed over all brush coats, or all zeros if there has
+  // been no such call since the last call to `Start()` or `Clear()`.
+  //
+  // These are only collected if `kStrokeShapeStatsEnabled` is true; otherwise
+  // every value is always zero.
+  const StrokeShapeStats& GetLastUpdateStats() const;
+
+  // Sets the histograms to which each successful call to `UpdateShape()` adds
+  // its duration, input counts, and input latency, or stops recording if
+  // `histograms` is null. The histograms are not owned, and must outlive their
+  // use by this object; they may be shared with other `InProgressStroke`s.
+  //
+  // Null (disabled) by default, and not reset by `Clear()`.
+  void SetUpdateHistograms(StrokeUpdateHistograms* absl_nullable histograms);
+  StrokeUpdateHistograms* absl_nullable GetUpdateHistograms() const;
+
+  // Resets the value returned by `GetUpdatedRegion()` to an empty envelope,
+  // and the values returned by `GetCoatFirstUpdatedVertex()` and
+  // `GetCoatFirstUpdatedTriangle()` to `std::nullopt`.
   void ResetUpdatedRegion();
 
   // Copies the current input, brush, and geometry as of the last call to
@@ -248,6 +464,20 @@ class InProgressStroke {
   Stroke CopyToStroke(
       RetainAttributes retain_attributes = RetainAttributes::kAll) const;
 
+  // Like `CopyToStroke()`, but hands the current inputs over to the new
+  // `Stroke` instead of copying them, and then clears this `InProgressStroke`
+  // as if by `Clear()`, ready for the next call to `Start()`.
+  //
+  // This avoids copying the inputs when a finished stroke is about to be
+  // replaced by the next one. The mesh for each coat is packed directly from
+  // this stroke's buffers, whose allocations are kept for the next stroke.
+  // Because the input storage is handed over as-is, the returned `Stroke` may
+  // hold some unused input capacity that `CopyToStroke()` would have trimmed.
+  //
+  // CHECK-fails if `Start()` has not been called since the last `Clear()`.
+  Stroke MoveToStroke(
+      RetainAttributes retain_attributes = RetainAttributes::kAll);
+
  private:
   absl::Status ValidateNewInputs(
       const StrokeInputBatch& real_inputs,
@@ -255,11 +485,30 @@ class InProgressStroke {
 
   absl::Status ValidateNewElapsedTime(Duration32 current_elapsed_time) const;
 
+  // Sizes the per-coat state for `num_coats` coats of the current brush,
+  // acquiring more shape builders if needed, and resets the spatial indices.
+  void PrepareCoats(uint32_t num_coats);
+
+  // Packs the current mesh of each coat into the shape for a new `Stroke`.
+  PartitionedMesh MakeStrokeShape(RetainAttributes retain_attributes) const;
+
+  // Brings the spatial index of the coat's mesh up to date, and visits the
+  // triangles that intersect `query`.
+  template <typename QueryType>
+  void VisitIntersectedTrianglesImpl(
+      uint32_t coat_index, const QueryType& query,
+      absl::FunctionRef<bool(uint32_t)> visitor) const;
+
   std::optional<Brush> brush_;
   // Real and predicted inputs that have been queued by calls to
   // `EnqueueInputs()` since the last call to `UpdateShape()`.
   StrokeInputBatch queued_real_inputs_;
   StrokeInputBatch queued_predicted_inputs_;
+  // The real inputs processed by a call to `UpdateShapeWithinBudget()` that
+  // could not process all of `queued_real_inputs_`, and the (always empty)
+  // predicted inputs for it. Kept as members to reuse their allocations.
+  StrokeInputBatch partial_real_inputs_;
+  StrokeInputBatch partial_predicted_inputs_;
   // Inputs (combined real and predicted) that have already been processed by a
   // call to `UpdateShape()`, and are reflected in the current
   // `StrokeShapeBuilder` geometry.
@@ -270,6 +519,10 @@ class InProgressStroke {
   // The largest elapsed time passed to `UpdateShape()` since the last call to
   // `Start()`.
   Duration32 current_elapsed_time_ = Duration32::Zero();
+  // The input modeler shared by all of the `shape_builders_`. Every coat of a
+  // brush uses the same `BrushFamily::InputModel` and brush epsilon, so the
+  // inputs only need to be modeled once per call to `UpdateShape()`.
+  strokes_internal::StrokeInputModeler input_modeler_;
   // A vector with at least one `StrokeShapeBuilder` for each `BrushCoat` in the
   // current brush (and potentially more; in order to cache allocations, we
   // never shrink this vector).
@@ -277,6 +530,32 @@ class InProgressStroke {
   // The region updated by `UpdateShape()` since the last call to `Start()` or
   // `ResetUpdatedRegion()`.
   Envelope updated_region_;
+  // The update from each coat during the most recent call to `UpdateShape()`,
+  // kept as a member to reuse its allocation.
+  absl::InlinedVector<strokes_internal::StrokeShapeUpdate, 1> coat_updates_;
+  // For each brush coat, the combined updates to its mesh by `UpdateShape()`
+  // since the last call to `Start()` or `ResetUpdatedRegion()`. The size of
+  // this vector always matches `BrushCoatCount()`.
+  absl::InlinedVector<strokes_internal::StrokeShapeUpdate, 1>
+      accumulated_coat_updates_;
+  // For each brush coat, a spatial index over its mesh, and the combined
+  // updates to the mesh since the index was last brought up to date. The
+  // indices are only updated when they are queried. The sizes of these vectors
+  // always match `BrushCoatCount()`.
+  mutable absl::InlinedVector<geometry_internal::MeshGridIndex, 1>
+      coat_mesh_indices_;
+  mutable absl::InlinedVector<strokes_internal::StrokeShapeUpdate, 1>
+      unindexed_coat_updates_;
+  // The stats for the most recent call to `UpdateShape()`.
+  StrokeShapeStats last_update_stats_;
+  StrokeUpdateHistograms* absl_nullable update_histograms_ = nullptr;
+  StrokeShapeBudget budget_;
+  Duration32 prediction_horizon_ = Duration32::Zero();
+  bool input_decimation_enabled_ = false;
+  bool separate_tail_enabled_ = false;
+  bool vertex_welding_enabled_ = false;
+  // Used by `EnqueueInputs()` when `input_decimation_enabled_` is true.
+  strokes_internal::StrokeInputDecimator input_decimator_;
   // True if `FinishInputs()` has been called since the last call to `Start()`,
   // or if `Start()` hasn't been called yet.
   bool inputs_are_finished_ = true;
@@ -285,6 +564,55 @@ class InProgressStroke {
 // ---------------------------------------------------------------------------
 //                     Implementation details below
 
+inline void InProgressStroke::SetBudget(const StrokeShapeBudget& budget) {
+  budget_ = budget;
+}
+
+inline const StrokeShapeBudget& InProgressStroke::GetBudget() const {
+  return budget_;
+}
+
+inline void InProgressStroke::SetInputDecimationEnabled(bool enabled) {
+  input_decimation_enabled_ = enabled;
+}
+
+inline bool InProgressStroke::InputDecimationEnabled() const {
+  return input_decimation_enabled_;
+}
+
+inline void InProgressStroke::SetPredictionHorizon(Duration32 horizon) {
+  prediction_horizon_ = std::max(horizon, Duration32::Zero());
+}
+
+inline Duration32 InProgressStroke::GetPredictionHorizon() const {
+  return prediction_horizon_;
+}
+
+inline void InProgressStroke::SetSeparateTailEnabled(bool enabled) {
+  separate_tail_enabled_ = enabled;
+}
+
+inline bool InProgressStroke::SeparateTailEnabled() const {
+  return separate_tail_enabled_;
+}
+
+inline void InProgressStroke::SetVertexWeldingEnabled(bool enabled) {
+  vertex_welding_enabled_ = enabled;
+}
+
+inline bool InProgressStroke::VertexWeldingEnabled() const {
+  return vertex_welding_enabled_;
+}
+
+inline void InProgressStroke::SetPerformanceProfile(
+    const PerformanceProfile& profile) {
+  SetBudget(profile.budget);
+  SetInputDecimationEnabled(profile.input_decimation_enabled);
+  SetPredictionHorizon(profile.prediction_horizon);
+  SetSeparateTailEnabled(profile.separate_tail_enabled);
+  SetVertexWeldingEnabled(profile.vertex_welding_enabled);
+}
+
 inline void InProgressStroke::FinishInputs() {
   inputs_are_finished_ = true;
   queued_predicted_inputs_.Clear();
@@ -323,11 +651,65 @@ InProgressStroke::GetCoatOutlines(uint32_t coat_index) const {
   return shape_builders_[coat_index].GetOutlines();
 }
 
+inline const MutableMesh& InProgressStroke::GetTailMesh(
+    uint32_t coat_index) const {
+  ABSL_CHECK_LT(coat_index, BrushCoatCount());
+  return shape_builders_[coat_index].GetVolatileMesh();
+}
+
+inline const Envelope& InProgressStroke::GetTailMeshBounds(
+    uint32_t coat_index) const {
+  ABSL_CHECK_LT(coat_index, BrushCoatCount());
+  return shape_builders_[coat_index].GetVolatileMeshBounds();
+}
+
+inline absl::Span<const absl::Span<const uint32_t>>
+InProgressStroke::GetTailCoatOutlines(uint32_t coat_index) const {
+  ABSL_CHECK_LT(coat_index, BrushCoatCount());
+  return shape_builders_[coat_index].GetVolatileOutlines();
+}
+
 inline const Envelope& InProgressStroke::GetUpdatedRegion() const {
   return updated_region_;
 }
 
-inline void InProgressStroke::ResetUpdatedRegion() { updated_region_.Reset(); }
+inline const StrokeShapeStats& InProgressStroke::GetLastUpdateStats() const {
+  return last_update_stats_;
+}
+
+inline void InProgressStroke::SetUpdateHistograms(
+    StrokeUpdateHistograms* absl_nullable histograms) {
+  update_histograms_ = histograms;
+}
+
+inline StrokeUpdateHistograms* absl_nullable
+InProgressStroke::GetUpdateHistograms() const {
+  return update_histograms_;
+}
+
+inline std::optional<uint32_t> InProgressStroke::GetCoatFirstUpdatedVertex(
+    uint32_t coat_index) const {
+  ABSL_CHECK_LT(coat_index, BrushCoatCount());
+  return accumulated_coat_updates_[coat_index].first_vertex_offset;
+}
+
+inline std::optional<uint32_t> InProgressStroke::GetCoatFirstUpdatedTriangle(
+    uint32_t coat_index) const {
+  ABSL_CHECK_LT(coat_index, BrushCoatCount());
+  const std::optional<uint32_t>& first_index_offset =
+      accumulated_coat_updates_[coat_index].first_index_offset;
+  if (!first_index_offset.has_value()) return std::nullopt;
+  constexpr uint32_t kIndicesPerTriangle = 3;
+  return *first_index_offset / kIndicesPerTriangle;
+}
+
+inline void InProgressStroke::ResetUpdatedRegion() {
+  updated_region_.Reset();
+  for (strokes_internal::StrokeShapeUpdate& update :
+       accumulated_coat_updates_) {
+    update = {};
+  }
+}
 
 }  // namespace ink
 
@@ -0,0 +1,141 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/in_progress_stroke_group.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
+#include "absl/strings/substitute.h"
+#include "ink/brush/brush.h"
+#include "ink/geometry/envelope.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/duration.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+InProgressStrokeGroup::StrokeId InProgressStrokeGroup::StartStroke(
+    const Brush& brush, Duration32 start_time, uint32_t noise_seed) {
+  StrokeId id;
+  if (idle_ids_.empty()) {
+    id = slots_.size();
+    slots_.emplace_back();
+  } else {
+    // Take the most recently released stroke, whose allocations are the most
+    // likely to still be warm in cache.
+    id = idle_ids_.back();
+    idle_ids_.pop_back();
+  }
+  Slot& slot = slots_[id];
+  slot.stroke.Start(brush, noise_seed);
+  slot.start_time = start_time;
+  slot.is_active = true;
+  ++active_stroke_count_;
+  return id;
+}
+
+void InProgressStrokeGroup::ReleaseStroke(StrokeId id) {
+  Slot& slot = GetActiveSlot(id);
+  released_region_.Add(slot.stroke.GetUpdatedRegion());
+  // `Clear()` keeps the stroke's shape builders and their allocations, which
+  // are reused when this slot is handed out again by `StartStroke()`.
+  slot.stroke.Clear();
+  slot.is_active = false;
+  idle_ids_.push_back(id);
+  --active_stroke_count_;
+}
+
+absl::Status InProgressStrokeGroup::EnqueueInputs(
+    StrokeId id, const StrokeInputBatch& real_inputs,
+    const StrokeInputBatch& predicted_inputs) {
+  return GetActiveSlot(id).stroke.EnqueueInputs(real_inputs, predicted_inputs);
+}
+
+void InProgressStrokeGroup::FinishInputs(StrokeId id) {
+  GetActiveSlot(id).stroke.FinishInputs();
+}
+
+absl::Status InProgressStrokeGroup::UpdateShapes(
+    Duration32 current_time, Executor* absl_nullable executor) {
+  if (current_time < current_time_) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "`current_time` must be non-decreasing. Got $0 after $1",
+        current_time.ToSeconds(), current_time_.ToSeconds()));
+  }
+  current_time_ = current_time;
+
+  ids_to_update_.clear();
+  for (StrokeId id = 0; id < slots_.size(); ++id) {
+    const Slot& slot = slots_[id];
+    if (slot.is_active && slot.stroke.NeedsUpdate()) {
+      ids_to_update_.push_back(id);
+    }
+  }
+  update_statuses_.assign(ids_to_update_.size(), absl::OkStatus());
+
+  // Each task only touches its own slot and status, so the tasks are
+  // independent. The coats of each stroke are built on the task's thread, to
+  // keep the number of tasks, and the parallelism, bounded by the stroke count.
+  ParallelFor(executor, ids_to_update_.size(), [this](size_t i) {
+    Slot& slot = slots_[ids_to_update_[i]];
+    Duration32 elapsed_time = slot.start_time < current_time_
+                                  ? current_time_ - slot.start_time
+                                  : Duration32::Zero();
+    update_statuses_[i] = slot.stroke.UpdateShape(elapsed_time);
+  });
+
+  for (const absl::Status& status : update_statuses_) {
+    if (!status.ok()) return status;
+  }
+  return absl::OkStatus();
+}
+
+bool InProgressStrokeGroup::NeedsUpdate() const {
+  for (const Slot& slot : slots_) {
+    if (slot.is_active && slot.stroke.NeedsUpdate()) return true;
+  }
+  return false;
+}
+
+std::vector<InProgressStrokeGroup::StrokeId>
+InProgressStrokeGroup::GetActiveStrokeIds() const {
+  std::vector<StrokeId> ids;
+  ids.reserve(active_stroke_count_);
+  for (StrokeId id = 0; id < slots_.size(); ++id) {
+    if (slots_[id].is_active) ids.push_back(id);
+  }
+  return ids;
+}
+
+Envelope InProgressStrokeGroup::GetUpdatedRegion() const {
+  Envelope region = released_region_;
+  for (const Slot& slot : slots_) {
+    if (slot.is_active) region.Add(slot.stroke.GetUpdatedRegion());
+  }
+  return region;
+}
+
+void InProgressStrokeGroup::ResetUpdatedRegion() {
+  released_region_.Reset();
+  for (Slot& slot : slots_) {
+    if (slot.is_active) slot.stroke.ResetUpdatedRegion();
+  }
+}
+
+}  // namespace ink
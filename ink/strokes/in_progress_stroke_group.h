@@ -0,0 +1,173 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_IN_PROGRESS_STROKE_GROUP_H_
+#define INK_STROKES_IN_PROGRESS_STROKE_GROUP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "ink/brush/brush.h"
+#include "ink/geometry/envelope.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/duration.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+// Owns several `InProgressStroke`s that are drawn at the same time, such as
+// the strokes of a multi-touch gesture or of several collaborators, and
+// updates their shapes together.
+//
+// Each stroke is identified by the `StrokeId` returned from `StartStroke()`,
+// which stays valid until the stroke is passed to `ReleaseStroke()`. Released
+// strokes are kept idle and reused by later calls to `StartStroke()`, so that
+// new strokes reuse the mesh and modeling allocations of finished ones.
+//
+// The group keeps its own clock: each stroke records the group time at which
+// it was started, and `UpdateShapes()` converts the current group time into
+// the elapsed time since the start of each stroke. The `elapsed_time` values of
+// inputs passed to `EnqueueInputs()` are relative to the start of that stroke,
+// as for `InProgressStroke`.
+//
+// This type is not thread-safe, but `UpdateShapes()` can update the strokes
+// concurrently on an `Executor`.
+class InProgressStrokeGroup {
+ public:
+  using StrokeId = uint32_t;
+
+  InProgressStrokeGroup() = default;
+  InProgressStrokeGroup(const InProgressStrokeGroup&) = delete;
+  InProgressStrokeGroup& operator=(const InProgressStrokeGroup&) = delete;
+  InProgressStrokeGroup(InProgressStrokeGroup&&) = default;
+  InProgressStrokeGroup& operator=(InProgressStrokeGroup&&) = default;
+  ~InProgressStrokeGroup() = default;
+
+  // Starts a new stroke with the given `brush` at group time `start_time`, and
+  // returns its id. See `InProgressStroke::Start()`.
+  StrokeId StartStroke(const Brush& brush, Duration32 start_time,
+                       uint32_t noise_seed = 0);
+
+  // Ends the stroke with the given `id` and returns it to the group's idle
+  // strokes for reuse. The region it covered is still included in
+  // `GetUpdatedRegion()` until the next call to `ResetUpdatedRegion()`, so that
+  // the caller can redraw the area once the stroke is replaced by a finished
+  // `Stroke`. CHECK-fails if `id` is not an active stroke.
+  void ReleaseStroke(StrokeId id);
+
+  // Forwards to `InProgressStroke::EnqueueInputs()` and
+  // `InProgressStroke::FinishInputs()` for the stroke with the given `id`.
+  // CHECK-fails if `id` is not an active stroke.
+  absl::Status EnqueueInputs(StrokeId id, const StrokeInputBatch& real_inputs,
+                             const StrokeInputBatch& predicted_inputs);
+  void FinishInputs(StrokeId id);
+
+  // Calls `InProgressStroke::UpdateShape()` for every active stroke that
+  // `NeedsUpdate()`, with the time elapsed since its start according to
+  // `current_time`.
+  //
+  // If `executor` is non-null the strokes are updated concurrently as tasks on
+  // `executor`, so that the time taken tracks the slowest stroke rather than
+  // the sum of all of them. Each stroke is updated entirely within one task,
+  // and the number of threads used is bounded by the `executor`.
+  //
+  // The values of `current_time` passed over the lifetime of the group must be
+  // non-decreasing. If any stroke fails to update, an error is returned for the
+  // failing stroke with the lowest id, and the others are still updated.
+  absl::Status UpdateShapes(Duration32 current_time,
+                            Executor* absl_nullable executor = nullptr);
+
+  // Returns true if calling `UpdateShapes()` would have any effect on any of
+  // the active strokes.
+  bool NeedsUpdate() const;
+
+  // Returns the active stroke with the given `id`. CHECK-fails if `id` is not
+  // an active stroke.
+  const InProgressStroke& GetStroke(StrokeId id) const;
+
+  // Returns true if `id` was returned by `StartStroke()` and has not since been
+  // released.
+  bool IsActive(StrokeId id) const;
+
+  // Returns the ids of all active strokes, in increasing order.
+  std::vector<StrokeId> GetActiveStrokeIds() const;
+  size_t ActiveStrokeCount() const { return active_stroke_count_; }
+
+  // Returns the union of `InProgressStroke::GetUpdatedRegion()` of every active
+  // stroke, and of the regions of any strokes released since the last call to
+  // `ResetUpdatedRegion()`.
+  Envelope GetUpdatedRegion() const;
+
+  // Resets the updated region of the group and of every active stroke.
+  void ResetUpdatedRegion();
+
+ private:
+  struct Slot {
+    InProgressStroke stroke;
+    // The group time passed to `StartStroke()`.
+    Duration32 start_time = Duration32::Zero();
+    bool is_active = false;
+  };
+
+  Slot& GetActiveSlot(StrokeId id);
+  const Slot& GetActiveSlot(StrokeId id) const;
+
+  // Indexed by `StrokeId`. Slots are never removed, so that idle strokes keep
+  // their allocations for reuse.
+  std::vector<Slot> slots_;
+  // Ids of the inactive entries of `slots_`, most recently released last.
+  std::vector<StrokeId> idle_ids_;
+  size_t active_stroke_count_ = 0;
+  // The largest time passed to `UpdateShapes()`.
+  Duration32 current_time_ = Duration32::Zero();
+  // The combined updated regions of strokes released since the last call to
+  // `ResetUpdatedRegion()`.
+  Envelope released_region_;
+  // Scratch space for `UpdateShapes()`, kept to reuse allocations.
+  std::vector<StrokeId> ids_to_update_;
+  std::vector<absl::Status> update_statuses_;
+};
+
+// ---------------------------------------------------------------------------
+//                     Implementation details below
+
+inline bool InProgressStrokeGroup::IsActive(StrokeId id) const {
+  return id < slots_.size() && slots_[id].is_active;
+}
+
+inline const InProgressStroke& InProgressStrokeGroup::GetStroke(
+    StrokeId id) const {
+  return GetActiveSlot(id).stroke;
+}
+
+inline InProgressStrokeGroup::Slot& InProgressStrokeGroup::GetActiveSlot(
+    StrokeId id) {
+  ABSL_CHECK(IsActive(id)) << "Not an active stroke: " << id;
+  return slots_[id];
+}
+
+inline const InProgressStrokeGroup::Slot& InProgressStrokeGroup::GetActiveSlot(
+    StrokeId id) const {
+  ABSL_CHECK(IsActive(id)) << "Not an active stroke: " << id;
+  return slots_[id];
+}
+
+}  // namespace ink
+
+#endif  // INK_STROKES_IN_PROGRESS_STROKE_GROUP_H_
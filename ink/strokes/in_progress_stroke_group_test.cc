@@ -0,0 +1,221 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/in_progress_stroke_group.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_family.h"
+#include "ink/color/color.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/duration.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::HasSubstr;
+
+Brush CreateTestBrush() {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(
+      {.scale = {0.5, 0.5}, .corner_rounding = 1}, {}, "");
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush = Brush::Create(*family, Color(),
+                                              /*size=*/2, /*epsilon=*/0.01);
+  ABSL_CHECK_OK(brush);
+  return *brush;
+}
+
+// Returns a short horizontal line of real inputs starting at (`x`, `y`).
+StrokeInputBatch MakeLineInputs(float x, float y) {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 5; ++i) {
+    inputs.push_back({.position = {x + i, y},
+                      .elapsed_time = Duration32::Seconds(0.01 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *batch;
+}
+
+TEST(InProgressStrokeGroupTest, DefaultConstructed) {
+  InProgressStrokeGroup group;
+  EXPECT_EQ(group.ActiveStrokeCount(), 0);
+  EXPECT_TRUE(group.GetActiveStrokeIds().empty());
+  EXPECT_FALSE(group.NeedsUpdate());
+  EXPECT_TRUE(group.GetUpdatedRegion().IsEmpty());
+  EXPECT_EQ(group.UpdateShapes(Duration32::Seconds(1)), absl::OkStatus());
+}
+
+TEST(InProgressStrokeGroupTest, StartAndReleaseStrokes) {
+  Brush brush = CreateTestBrush();
+  InProgressStrokeGroup group;
+  InProgressStrokeGroup::StrokeId first =
+      group.StartStroke(brush, Duration32::Zero());
+  InProgressStrokeGroup::StrokeId second =
+      group.StartStroke(brush, Duration32::Zero());
+  EXPECT_NE(first, second);
+  EXPECT_TRUE(group.IsActive(first));
+  EXPECT_TRUE(group.IsActive(second));
+  EXPECT_EQ(group.ActiveStrokeCount(), 2);
+  EXPECT_THAT(group.GetActiveStrokeIds(), ElementsAre(first, second));
+  EXPECT_EQ(group.GetStroke(first).GetBrush()->GetSize(), brush.GetSize());
+
+  group.ReleaseStroke(first);
+  EXPECT_FALSE(group.IsActive(first));
+  EXPECT_EQ(group.ActiveStrokeCount(), 1);
+  EXPECT_THAT(group.GetActiveStrokeIds(), ElementsAre(second));
+
+  // The released stroke is reused for the next new stroke.
+  EXPECT_EQ(group.StartStroke(brush, Duration32::Zero()), first);
+  EXPECT_EQ(group.ActiveStrokeCount(), 2);
+  EXPECT_EQ(group.GetStroke(first).InputCount(), 0);
+}
+
+TEST(InProgressStrokeGroupTest, UpdateShapesUsesTimeSinceEachStrokeStarted) {
+  Brush brush = CreateTestBrush();
+  InProgressStrokeGroup group;
+  InProgressStrokeGroup::StrokeId early =
+      group.StartStroke(brush, Duration32::Seconds(1));
+  InProgressStrokeGroup::StrokeId late =
+      group.StartStroke(brush, Duration32::Seconds(3));
+  ASSERT_EQ(group.EnqueueInputs(early, MakeLineInputs(0, 0), {}),
+            absl::OkStatus());
+  ASSERT_EQ(group.EnqueueInputs(late, MakeLineInputs(0, 10), {}),
+            absl::OkStatus());
+  EXPECT_TRUE(group.NeedsUpdate());
+
+  ASSERT_EQ(group.UpdateShapes(Duration32::Seconds(2)), absl::OkStatus());
+  EXPECT_FALSE(group.NeedsUpdate());
+  EXPECT_EQ(group.GetStroke(early).InputCount(), 5);
+  EXPECT_EQ(group.GetStroke(late).InputCount(), 5);
+
+  // The late stroke had not started yet at group time 2 seconds, so it was
+  // updated with an elapsed time of zero, and can still be updated with its
+  // own elapsed time of zero.
+  InProgressStroke reference;
+  reference.Start(brush);
+  ASSERT_EQ(reference.EnqueueInputs(MakeLineInputs(0, 10), {}),
+            absl::OkStatus());
+  ASSERT_EQ(reference.UpdateShape(Duration32::Zero()), absl::OkStatus());
+  EXPECT_THAT(group.GetStroke(late).GetMesh(0).RawVertexData(),
+              ElementsAreArray(reference.GetMesh(0).RawVertexData()));
+}
+
+TEST(InProgressStrokeGroupTest, ParallelUpdateMatchesSequentialUpdate) {
+  Brush brush = CreateTestBrush();
+  ThreadPerTaskExecutor executor;
+  InProgressStrokeGroup parallel_group;
+  InProgressStrokeGroup sequential_group;
+  std::vector<InProgressStrokeGroup::StrokeId> ids;
+  for (int i = 0; i < 5; ++i) {
+    InProgressStrokeGroup::StrokeId id =
+        parallel_group.StartStroke(brush, Duration32::Zero());
+    ASSERT_EQ(id, sequential_group.StartStroke(brush, Duration32::Zero()));
+    ASSERT_EQ(parallel_group.EnqueueInputs(id, MakeLineInputs(0, 5 * i), {}),
+              absl::OkStatus());
+    ASSERT_EQ(sequential_group.EnqueueInputs(id, MakeLineInputs(0, 5 * i), {}),
+              absl::OkStatus());
+    ids.push_back(id);
+  }
+
+  ASSERT_EQ(parallel_group.UpdateShapes(Duration32::Seconds(1), &executor),
+            absl::OkStatus());
+  ASSERT_EQ(sequential_group.UpdateShapes(Duration32::Seconds(1)),
+            absl::OkStatus());
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+
+  for (InProgressStrokeGroup::StrokeId id : ids) {
+    EXPECT_THAT(
+        parallel_group.GetStroke(id).GetMesh(0).RawVertexData(),
+        ElementsAreArray(
+            sequential_group.GetStroke(id).GetMesh(0).RawVertexData()));
+    EXPECT_THAT(parallel_group.GetStroke(id).GetMesh(0).RawIndexData(),
+                ElementsAreArray(
+                    sequential_group.GetStroke(id).GetMesh(0).RawIndexData()));
+  }
+  EXPECT_THAT(parallel_group.GetUpdatedRegion(),
+              EnvelopeEq(sequential_group.GetUpdatedRegion()));
+}
+
+TEST(InProgressStrokeGroupTest, UpdatedRegionIsUnionOfStrokeRegions) {
+  Brush brush = CreateTestBrush();
+  InProgressStrokeGroup group;
+  InProgressStrokeGroup::StrokeId first =
+      group.StartStroke(brush, Duration32::Zero());
+  InProgressStrokeGroup::StrokeId second =
+      group.StartStroke(brush, Duration32::Zero());
+  ASSERT_EQ(group.EnqueueInputs(first, MakeLineInputs(0, 0), {}),
+            absl::OkStatus());
+  ASSERT_EQ(group.EnqueueInputs(second, MakeLineInputs(20, 20), {}),
+            absl::OkStatus());
+  ASSERT_EQ(group.UpdateShapes(Duration32::Seconds(1)), absl::OkStatus());
+
+  Envelope expected = group.GetStroke(first).GetUpdatedRegion();
+  expected.Add(group.GetStroke(second).GetUpdatedRegion());
+  ASSERT_FALSE(expected.IsEmpty());
+  EXPECT_THAT(group.GetUpdatedRegion(), EnvelopeEq(expected));
+
+  // Releasing a stroke does not remove its region until it is reset.
+  group.ReleaseStroke(first);
+  EXPECT_THAT(group.GetUpdatedRegion(), EnvelopeEq(expected));
+
+  group.ResetUpdatedRegion();
+  EXPECT_TRUE(group.GetUpdatedRegion().IsEmpty());
+  EXPECT_TRUE(group.GetStroke(second).GetUpdatedRegion().IsEmpty());
+}
+
+TEST(InProgressStrokeGroupTest, UpdateShapesWithDecreasingTime) {
+  InProgressStrokeGroup group;
+  ASSERT_EQ(group.UpdateShapes(Duration32::Seconds(2)), absl::OkStatus());
+  absl::Status status = group.UpdateShapes(Duration32::Seconds(1));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("non-decreasing"));
+}
+
+TEST(InProgressStrokeGroupTest, EnqueueInputsAfterFinishInputs) {
+  InProgressStrokeGroup group;
+  InProgressStrokeGroup::StrokeId id =
+      group.StartStroke(CreateTestBrush(), Duration32::Zero());
+  group.FinishInputs(id);
+  EXPECT_TRUE(group.GetStroke(id).InputsAreFinished());
+  EXPECT_EQ(group.EnqueueInputs(id, MakeLineInputs(0, 0), {}).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST(InProgressStrokeGroupDeathTest, InactiveStroke) {
+  InProgressStrokeGroup group;
+  InProgressStrokeGroup::StrokeId id =
+      group.StartStroke(CreateTestBrush(), Duration32::Zero());
+  group.ReleaseStroke(id);
+  EXPECT_DEATH_IF_SUPPORTED(group.GetStroke(id), "");
+  EXPECT_DEATH_IF_SUPPORTED(group.ReleaseStroke(id), "");
+  EXPECT_DEATH_IF_SUPPORTED(group.FinishInputs(id + 1), "");
+}
+
+}  // namespace
+}  // namespace ink
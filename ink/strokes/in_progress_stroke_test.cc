@@ -14,6 +14,7 @@
 
 #include "ink/strokes/in_progress_stroke.h"
 
+#include <array>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -28,22 +29,34 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush.h"
+#include "ink/brush/brush_behavior.h"
+#include "ink/brush/brush_coat.h"
 #include "ink/brush/brush_family.h"
 #include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
 #include "ink/brush/type_matchers.h"
 #include "ink/color/color.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/envelope.h"
 #include "ink/geometry/internal/algorithms.h"
+#include "ink/geometry/intersects.h"
+#include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
 #include "ink/geometry/rect.h"
 #include "ink/geometry/type_matchers.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
 #include "ink/strokes/input/type_matchers.h"
+#include "ink/strokes/performance_profile.h"
 #include "ink/strokes/stroke.h"
+#include "ink/strokes/stroke_shape_budget.h"
+#include "ink/strokes/stroke_shape_stats.h"
+#include "ink/strokes/stroke_update_histograms.h"
 #include "ink/types/duration.h"
+#include "ink/types/test_executor.h"
 
 namespace ink {
 namespace {
@@ -60,6 +73,8 @@ using ::testing::Not;
 using ::testing::Optional;
 using ::testing::Pointee;
 using ::testing::Property;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAreArray;
 
 constexpr absl::string_view kTestTextureId = "test-texture";
 
@@ -430,6 +445,520 @@ TEST(InProgressStrokeTest, NonEmptyInputs) {
                   Rect::FromTwoPoints({-0.88, -2.88}, {5.88, 5.87}), 0.01)));
 }
 
+TEST(InProgressStrokeTest, LastUpdateStats) {
+  InProgressStroke stroke;
+  stroke.Start(CreateCircularTestBrush());
+  EXPECT_EQ(stroke.GetLastUpdateStats(), StrokeShapeStats{});
+
+  absl::StatusOr<StrokeInputBatch> real_inputs = StrokeInputBatch::Create({
+      {.position = {1, 2}, .elapsed_time = Duration32::Seconds(0.0)},
+      {.position = {3, 2}, .elapsed_time = Duration32::Seconds(0.1)},
+  });
+  ASSERT_EQ(real_inputs.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> predicted_inputs = StrokeInputBatch::Create(
+      {{.position = {3, 4}, .elapsed_time = Duration32::Seconds(0.2)}});
+  ASSERT_EQ(predicted_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(),
+            stroke.EnqueueInputs(*real_inputs, *predicted_inputs));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.15)));
+
+  if constexpr (!kStrokeShapeStatsEnabled) {
+    EXPECT_EQ(stroke.GetLastUpdateStats(), StrokeShapeStats{});
+    return;
+  }
+
+  StrokeShapeStats stats = stroke.GetLastUpdateStats();
+  EXPECT_EQ(stats.vertices_appended - stats.vertices_reverted,
+            stroke.GetMesh(0).VertexCount());
+  EXPECT_EQ(stats.triangles_appended - stats.triangles_reverted,
+            stroke.GetMesh(0).TriangleCount());
+
+  // The geometry for the previous predicted input gets reverted by the next
+  // update.
+  uint32_t vertex_count = stroke.GetMesh(0).VertexCount();
+  real_inputs = StrokeInputBatch::Create(
+      {{.position = {3, 0}, .elapsed_time = Duration32::Seconds(0.2)}});
+  ASSERT_EQ(real_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.2)));
+
+  stats = stroke.GetLastUpdateStats();
+  EXPECT_GT(stats.vertices_reverted, 0);
+  EXPECT_GT(stats.triangles_reverted, 0);
+  EXPECT_EQ(stats.vertices_appended - stats.vertices_reverted,
+            static_cast<int64_t>(stroke.GetMesh(0).VertexCount()) -
+                vertex_count);
+
+  stroke.Start(CreateCircularTestBrush());
+  EXPECT_EQ(stroke.GetLastUpdateStats(), StrokeShapeStats{});
+}
+
+TEST(InProgressStrokeTest, UpdateHistograms) {
+  StrokeUpdateHistograms histograms;
+  InProgressStroke stroke;
+  EXPECT_EQ(stroke.GetUpdateHistograms(), nullptr);
+  stroke.SetUpdateHistograms(&histograms);
+  EXPECT_EQ(stroke.GetUpdateHistograms(), &histograms);
+  stroke.Start(CreateCircularTestBrush());
+
+  absl::StatusOr<StrokeInputBatch> real_inputs = StrokeInputBatch::Create({
+      {.position = {1, 2}, .elapsed_time = Duration32::Seconds(0.0)},
+      {.position = {3, 2}, .elapsed_time = Duration32::Seconds(0.1)},
+  });
+  ASSERT_EQ(real_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.15)));
+
+  EXPECT_EQ(histograms.update_shape_nanos.Count(), 1);
+  EXPECT_EQ(histograms.inputs_per_update.Count(), 1);
+  EXPECT_EQ(histograms.inputs_per_update.Max(), 2);
+  EXPECT_EQ(histograms.modeled_inputs_per_update.Count(), 1);
+  EXPECT_GT(histograms.modeled_inputs_per_update.Max(), 0);
+  // The last input is 50ms old when the update starts.
+  EXPECT_EQ(histograms.input_latency_nanos.Count(), 1);
+  EXPECT_GE(histograms.input_latency_nanos.Max(), 49'000'000);
+
+  // An update without new inputs has no input latency to record.
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.2)));
+  EXPECT_EQ(histograms.update_shape_nanos.Count(), 2);
+  EXPECT_EQ(histograms.inputs_per_update.Percentile(0), 0);
+  EXPECT_EQ(histograms.input_latency_nanos.Count(), 1);
+
+  // Failed updates are not recorded, and the histograms stay set across
+  // strokes.
+  EXPECT_NE(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.1)));
+  stroke.Clear();
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Zero()));
+  EXPECT_EQ(histograms.update_shape_nanos.Count(), 3);
+
+  stroke.SetUpdateHistograms(nullptr);
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Zero()));
+  EXPECT_EQ(histograms.update_shape_nanos.Count(), 3);
+}
+
+// Returns `count` inputs zig-zagging back and forth across the x-axis.
+StrokeInputBatch MakeZigZagInputs(int count) {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < count; ++i) {
+    inputs.push_back({.position = {5.f * i, i % 2 == 0 ? 0.f : 20.f},
+                      .elapsed_time = Duration32::Seconds(0.01f * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *std::move(batch);
+}
+
+uint32_t VertexCountForInputs(const StrokeShapeBudget& budget,
+                              const StrokeInputBatch& inputs) {
+  InProgressStroke stroke;
+  stroke.SetBudget(budget);
+  stroke.Start(CreateCircularTestBrush());
+  ABSL_CHECK_OK(stroke.EnqueueInputs(inputs, {}));
+  ABSL_CHECK_OK(stroke.UpdateShape(inputs.GetDuration()));
+  return stroke.GetMesh(0).VertexCount();
+}
+
+TEST(InProgressStrokeTest, BudgetIsUnlimitedByDefault) {
+  InProgressStroke stroke;
+  EXPECT_EQ(stroke.GetBudget(), StrokeShapeBudget{});
+
+  StrokeInputBatch inputs = MakeZigZagInputs(100);
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(inputs.GetDuration()));
+  EXPECT_FALSE(stroke.ExceededBudget());
+}
+
+TEST(InProgressStrokeTest, SetPerformanceProfileSetsEachSetting) {
+  PerformanceProfile profile =
+      PerformanceProfile::ForTier(PerformanceProfile::Tier::kLow);
+  profile.prediction_horizon = Duration32::Millis(20);
+  profile.separate_tail_enabled = true;
+
+  InProgressStroke stroke;
+  stroke.SetPerformanceProfile(profile);
+  EXPECT_EQ(stroke.GetBudget(), profile.budget);
+  EXPECT_TRUE(stroke.InputDecimationEnabled());
+  EXPECT_EQ(stroke.GetPredictionHorizon(), Duration32::Millis(20));
+  EXPECT_TRUE(stroke.SeparateTailEnabled());
+  EXPECT_TRUE(stroke.VertexWeldingEnabled());
+
+  // The default profile restores the default of each setting.
+  stroke.SetPerformanceProfile(PerformanceProfile());
+  EXPECT_EQ(stroke.GetBudget(), StrokeShapeBudget{});
+  EXPECT_FALSE(stroke.InputDecimationEnabled());
+  EXPECT_EQ(stroke.GetPredictionHorizon(), Duration32::Zero());
+  EXPECT_FALSE(stroke.SeparateTailEnabled());
+  EXPECT_FALSE(stroke.VertexWeldingEnabled());
+}
+
+TEST(InProgressStrokeTest, BudgetLimitsVerticesPerCoat) {
+  StrokeInputBatch inputs = MakeZigZagInputs(100);
+  StrokeShapeBudget budget = {.max_vertices_per_coat = 40};
+  uint32_t unlimited_vertex_count = VertexCountForInputs({}, inputs);
+
+  InProgressStroke stroke;
+  stroke.SetBudget(budget);
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(inputs.GetDuration()));
+  EXPECT_TRUE(stroke.ExceededBudget());
+  EXPECT_GT(stroke.GetMesh(0).VertexCount(), 0);
+  EXPECT_LT(stroke.GetMesh(0).VertexCount(), unlimited_vertex_count);
+
+  // The stroke stops growing once the budget has been reached.
+  uint32_t vertex_count = stroke.GetMesh(0).VertexCount();
+  absl::StatusOr<StrokeInputBatch> more_inputs = StrokeInputBatch::Create(
+      {{.position = {0, 100}, .elapsed_time = Duration32::Seconds(2)}});
+  ASSERT_EQ(more_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*more_inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(2)));
+  EXPECT_EQ(stroke.GetMesh(0).VertexCount(), vertex_count);
+
+  // Starting a new stroke keeps the budget, but resets whether it was reached.
+  stroke.Start(CreateCircularTestBrush());
+  EXPECT_EQ(stroke.GetBudget(), budget);
+  EXPECT_FALSE(stroke.ExceededBudget());
+}
+
+TEST(InProgressStrokeTest, BudgetLimitsOutlinesPerCoat) {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(
+      {.scale = {0.5, 0.5},
+       .corner_rounding = 1,
+       .particle_gap_distance_scale = 2},
+      BrushPaint{});
+  ASSERT_EQ(family.status(), absl::OkStatus());
+  absl::StatusOr<Brush> brush = Brush::Create(*family, Color(), 5, 0.01);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create({
+      {.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+      {.position = {100, 0}, .elapsed_time = Duration32::Seconds(1)},
+  });
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+
+  InProgressStroke stroke;
+  stroke.Start(*brush);
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(1)));
+  ASSERT_GT(stroke.GetCoatOutlines(0).size(), 3);
+
+  stroke.SetBudget({.max_outlines_per_coat = 3});
+  stroke.Start(*brush);
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(1)));
+  EXPECT_TRUE(stroke.ExceededBudget());
+  EXPECT_THAT(stroke.GetCoatOutlines(0), SizeIs(3));
+}
+
+TEST(InProgressStrokeTest, BudgetLimitsTipStatesPerUpdate) {
+  StrokeInputBatch inputs = MakeZigZagInputs(100);
+
+  // Exceeding the work budget disables intersection handling instead of
+  // truncating the stroke.
+  InProgressStroke stroke;
+  stroke.SetBudget({.max_tip_states_per_update = 1});
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(inputs.GetDuration()));
+  EXPECT_TRUE(stroke.ExceededBudget());
+  EXPECT_GT(stroke.GetMesh(0).VertexCount(), 0);
+  std::optional<Rect> bounds = stroke.GetMeshBounds(0).AsRect();
+  ASSERT_TRUE(bounds.has_value());
+  EXPECT_GT(bounds->Width(), 400);
+}
+
+TEST(InProgressStrokeTest, UpdateShapeWithinBudgetSpreadsInputsOverUpdates) {
+  StrokeInputBatch inputs = MakeZigZagInputs(100);
+  absl::StatusOr<StrokeInputBatch> predicted_inputs = StrokeInputBatch::Create(
+      {{.position = {500, 0}, .elapsed_time = Duration32::Seconds(1)}});
+  ASSERT_EQ(predicted_inputs.status(), absl::OkStatus());
+
+  InProgressStroke reference;
+  reference.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(),
+            reference.EnqueueInputs(inputs, *predicted_inputs));
+  ASSERT_EQ(absl::OkStatus(), reference.UpdateShape(inputs.GetDuration()));
+
+  InProgressStroke stroke;
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(inputs, *predicted_inputs));
+  ASSERT_EQ(absl::OkStatus(),
+            stroke.UpdateShapeWithinBudget(inputs.GetDuration(), 30));
+  // Only part of the real inputs are processed, without the prediction, and
+  // the rest remain queued.
+  EXPECT_EQ(stroke.RealInputCount(), 30);
+  EXPECT_EQ(stroke.PredictedInputCount(), 0);
+  EXPECT_TRUE(stroke.NeedsUpdate());
+  EXPECT_GT(stroke.GetMesh(0).VertexCount(), 0);
+  std::optional<Rect> partial_bounds = stroke.GetMeshBounds(0).AsRect();
+  ASSERT_TRUE(partial_bounds.has_value());
+  EXPECT_LT(partial_bounds->XMax(), 200);
+
+  int update_count = 1;
+  while (stroke.NeedsUpdate()) {
+    ASSERT_EQ(absl::OkStatus(),
+              stroke.UpdateShapeWithinBudget(inputs.GetDuration(), 30));
+    ++update_count;
+  }
+  EXPECT_EQ(update_count, 4);
+  EXPECT_EQ(stroke.RealInputCount(), 100);
+  EXPECT_EQ(stroke.PredictedInputCount(), 1);
+  EXPECT_THAT(stroke.GetInputs(), StrokeInputBatchEq(reference.GetInputs()));
+  ASSERT_TRUE(reference.GetMeshBounds(0).AsRect().has_value());
+  EXPECT_THAT(stroke.GetMeshBounds(0).AsRect(),
+              Optional(RectNear(*reference.GetMeshBounds(0).AsRect(),
+                                /* tolerance = */ 0.01)));
+}
+
+TEST(InProgressStrokeTest, InputDecimationDropsSubEpsilonRealInputs) {
+  // The test brush has an epsilon of 0.01, so every other input is dropped.
+  std::vector<StrokeInput> real_inputs;
+  for (int i = 0; i < 20; ++i) {
+    real_inputs.push_back({.position = {0.006f * i, 0},
+                           .elapsed_time = Duration32::Millis(2 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> real_batch =
+      StrokeInputBatch::Create(real_inputs);
+  ASSERT_EQ(real_batch.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> predicted_batch = StrokeInputBatch::Create(
+      {{.position = {0.2, 0}, .elapsed_time = Duration32::Millis(40)},
+       {.position = {0.201, 0}, .elapsed_time = Duration32::Millis(41)}});
+  ASSERT_EQ(predicted_batch.status(), absl::OkStatus());
+
+  InProgressStroke stroke;
+  EXPECT_FALSE(stroke.InputDecimationEnabled());
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(),
+            stroke.EnqueueInputs(*real_batch, *predicted_batch));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(40)));
+  EXPECT_EQ(stroke.RealInputCount(), 20);
+  std::optional<Rect> full_bounds = stroke.GetMeshBounds(0).AsRect();
+  ASSERT_TRUE(full_bounds.has_value());
+
+  stroke.SetInputDecimationEnabled(true);
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(),
+            stroke.EnqueueInputs(*real_batch, *predicted_batch));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(40)));
+  EXPECT_EQ(stroke.RealInputCount(), 10);
+  // Predicted inputs are never dropped.
+  EXPECT_EQ(stroke.PredictedInputCount(), 2);
+  EXPECT_THAT(stroke.GetMeshBounds(0).AsRect(),
+              Optional(RectNear(*full_bounds, /* tolerance = */ 0.02)));
+
+  // The kept inputs are what the resulting stroke is made from.
+  stroke.FinishInputs();
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(40)));
+  EXPECT_EQ(stroke.CopyToStroke().GetInputs().Size(), 10);
+}
+
+TEST(InProgressStrokeTest, PredictionHorizonExtendsStrokeAheadOfRealInputs) {
+  std::vector<StrokeInput> real_inputs;
+  for (int i = 0; i < 20; ++i) {
+    real_inputs.push_back({.position = {0.5f * i, 0},
+                           .elapsed_time = Duration32::Millis(10 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> real_batch =
+      StrokeInputBatch::Create(real_inputs);
+  ASSERT_EQ(real_batch.status(), absl::OkStatus());
+
+  InProgressStroke stroke;
+  EXPECT_EQ(stroke.GetPredictionHorizon(), Duration32::Zero());
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_batch, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(190)));
+  std::optional<Rect> unpredicted_bounds = stroke.GetMeshBounds(0).AsRect();
+  ASSERT_TRUE(unpredicted_bounds.has_value());
+  stroke.FinishInputs();
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(190)));
+  std::optional<Rect> finished_bounds = stroke.GetMeshBounds(0).AsRect();
+  ASSERT_TRUE(finished_bounds.has_value());
+
+  stroke.SetPredictionHorizon(Duration32::Millis(100));
+  EXPECT_EQ(stroke.GetPredictionHorizon(), Duration32::Millis(100));
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_batch, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(190)));
+  // The stroke extends past the last real input in the direction of motion,
+  // without adding any predicted inputs.
+  std::optional<Rect> predicted_bounds = stroke.GetMeshBounds(0).AsRect();
+  ASSERT_TRUE(predicted_bounds.has_value());
+  EXPECT_GT(predicted_bounds->XMax(), unpredicted_bounds->XMax() + 1);
+  EXPECT_EQ(stroke.RealInputCount(), 20);
+  EXPECT_EQ(stroke.PredictedInputCount(), 0);
+
+  // The prediction is dropped once the inputs are finished.
+  stroke.FinishInputs();
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(190)));
+  EXPECT_THAT(stroke.GetMeshBounds(0).AsRect(),
+              Optional(RectNear(*finished_bounds, /* tolerance = */ 0.001)));
+
+  // A negative horizon disables prediction.
+  stroke.SetPredictionHorizon(Duration32::Millis(-5));
+  EXPECT_EQ(stroke.GetPredictionHorizon(), Duration32::Zero());
+}
+
+TEST(InProgressStrokeTest, SeparateTailKeepsPredictedGeometryOutOfMesh) {
+  std::vector<StrokeInput> real_inputs;
+  for (int i = 0; i < 20; ++i) {
+    real_inputs.push_back({.position = {0.5f * i, 0},
+                           .elapsed_time = Duration32::Millis(10 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> real_batch =
+      StrokeInputBatch::Create(real_inputs);
+  ASSERT_EQ(real_batch.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> predicted_batch = StrokeInputBatch::Create({
+      {.position = {12, 0}, .elapsed_time = Duration32::Millis(240)},
+      {.position = {15, 0}, .elapsed_time = Duration32::Millis(300)},
+  });
+  ASSERT_EQ(predicted_batch.status(), absl::OkStatus());
+
+  InProgressStroke stroke;
+  EXPECT_FALSE(stroke.SeparateTailEnabled());
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_batch, {}));
+  stroke.FinishInputs();
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(190)));
+  EXPECT_EQ(stroke.GetTailMesh(0).VertexCount(), 0u);
+  EXPECT_THAT(stroke.GetTailCoatOutlines(0), IsEmpty());
+  std::optional<Rect> finished_bounds = stroke.GetMeshBounds(0).AsRect();
+  ASSERT_TRUE(finished_bounds.has_value());
+
+  stroke.SetSeparateTailEnabled(true);
+  EXPECT_TRUE(stroke.SeparateTailEnabled());
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(),
+            stroke.EnqueueInputs(*real_batch, *predicted_batch));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(190)));
+
+  // The predicted geometry is only in the tail, which overlaps the end of the
+  // stable mesh and is covered by the updated region.
+  std::optional<Rect> stable_bounds = stroke.GetMeshBounds(0).AsRect();
+  std::optional<Rect> tail_bounds = stroke.GetTailMeshBounds(0).AsRect();
+  ASSERT_TRUE(stable_bounds.has_value());
+  ASSERT_TRUE(tail_bounds.has_value());
+  EXPECT_GT(stroke.GetTailMesh(0).TriangleCount(), 0u);
+  EXPECT_THAT(stroke.GetTailCoatOutlines(0), Not(IsEmpty()));
+  EXPECT_GT(tail_bounds->XMax(), stable_bounds->XMax() + 1);
+  EXPECT_LE(tail_bounds->XMin(), stable_bounds->XMax());
+  std::optional<Rect> updated_region = stroke.GetUpdatedRegion().AsRect();
+  ASSERT_TRUE(updated_region.has_value());
+  EXPECT_GE(updated_region->XMax(), tail_bounds->XMax());
+
+  // Copying the stroke includes the tail.
+  Stroke copied_stroke = stroke.CopyToStroke();
+  std::optional<Rect> copied_bounds =
+      copied_stroke.GetShape().Bounds().AsRect();
+  ASSERT_TRUE(copied_bounds.has_value());
+  EXPECT_FLOAT_EQ(copied_bounds->XMax(), tail_bounds->XMax());
+  EXPECT_EQ(copied_stroke.GetShape().OutlineCount(0),
+            stroke.GetCoatOutlines(0).size() +
+                stroke.GetTailCoatOutlines(0).size());
+
+  // Once the inputs are finished, the tail is empty and the stable mesh has
+  // the same shape as without a separate tail.
+  stroke.FinishInputs();
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(190)));
+  EXPECT_EQ(stroke.GetTailMesh(0).VertexCount(), 0u);
+  EXPECT_THAT(stroke.GetTailCoatOutlines(0), IsEmpty());
+  EXPECT_THAT(stroke.GetMeshBounds(0).AsRect(),
+              Optional(RectNear(*finished_bounds, /* tolerance = */ 0.001)));
+}
+
+TEST(InProgressStrokeTest, VertexWeldingDoesNotIncreaseCopiedVertexCount) {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 20; ++i) {
+    inputs.push_back({.position = {0.5f * i, 0.1f * i * i},
+                      .elapsed_time = Duration32::Millis(10 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  InProgressStroke stroke;
+  EXPECT_FALSE(stroke.VertexWeldingEnabled());
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*batch, {}));
+  stroke.FinishInputs();
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(190)));
+  Stroke unwelded = stroke.CopyToStroke();
+
+  stroke.SetVertexWeldingEnabled(true);
+  EXPECT_TRUE(stroke.VertexWeldingEnabled());
+  Stroke welded = stroke.CopyToStroke();
+
+  const PartitionedMesh& unwelded_shape = unwelded.GetShape();
+  const PartitionedMesh& welded_shape = welded.GetShape();
+  uint32_t unwelded_vertex_count = 0;
+  uint32_t unwelded_triangle_count = 0;
+  for (const Mesh& mesh : unwelded_shape.RenderGroupMeshes(0)) {
+    unwelded_vertex_count += mesh.VertexCount();
+    unwelded_triangle_count += mesh.TriangleCount();
+  }
+  uint32_t welded_vertex_count = 0;
+  uint32_t welded_triangle_count = 0;
+  for (const Mesh& mesh : welded_shape.RenderGroupMeshes(0)) {
+    welded_vertex_count += mesh.VertexCount();
+    welded_triangle_count += mesh.TriangleCount();
+  }
+  EXPECT_LE(welded_vertex_count, unwelded_vertex_count);
+  EXPECT_EQ(welded_triangle_count, unwelded_triangle_count);
+  EXPECT_EQ(welded_shape.OutlineCount(0), unwelded_shape.OutlineCount(0));
+}
+
+TEST(InProgressStrokeTest, VisitIntersectedTrianglesMatchesMesh) {
+  InProgressStroke stroke;
+  stroke.Start(CreateCircularTestBrush());
+
+  // Returns the triangles of the mesh that intersect `query`, found by the
+  // stroke's index and by testing every triangle.
+  auto find_intersected = [&stroke](const Rect& query) {
+    std::vector<uint32_t> found;
+    stroke.VisitIntersectedTriangles(0, query, [&found](uint32_t index) {
+      found.push_back(index);
+      return true;
+    });
+    return found;
+  };
+  auto find_intersected_by_brute_force = [&stroke](const Rect& query) {
+    std::vector<uint32_t> found;
+    const MutableMesh& mesh = stroke.GetMesh(0);
+    for (uint32_t i = 0; i < mesh.TriangleCount(); ++i) {
+      if (Intersects(query, mesh.GetTriangle(i))) found.push_back(i);
+    }
+    return found;
+  };
+
+  // Each update reverts and re-extrudes the predicted end of the stroke, and
+  // the index is only queried after some of them.
+  for (int i = 0; i < 30; ++i) {
+    absl::StatusOr<StrokeInputBatch> real_batch = StrokeInputBatch::Create(
+        {{.position = {0.5f * i, (i % 10 < 5) ? 0.2f * i : 0.f},
+          .elapsed_time = Duration32::Millis(10 * i)}});
+    ASSERT_EQ(real_batch.status(), absl::OkStatus());
+    absl::StatusOr<StrokeInputBatch> predicted_batch = StrokeInputBatch::Create(
+        {{.position = {0.5f * i + 2, 1},
+          .elapsed_time = Duration32::Millis(10 * i + 20)}});
+    ASSERT_EQ(predicted_batch.status(), absl::OkStatus());
+    ASSERT_EQ(absl::OkStatus(),
+              stroke.EnqueueInputs(*real_batch, *predicted_batch));
+    ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Millis(10 * i)));
+    if (i % 3 != 0) continue;
+
+    for (float x = -1; x < 18; x += 0.75) {
+      for (float y = -2; y < 6; y += 0.75) {
+        Rect query = Rect::FromCenterAndDimensions({x, y}, 0.5, 0.5);
+        EXPECT_THAT(find_intersected(query),
+                    UnorderedElementsAreArray(
+                        find_intersected_by_brute_force(query)))
+            << "i = " << i << ", x = " << x << ", y = " << y;
+      }
+    }
+  }
+  EXPECT_THAT(find_intersected(Rect::FromCenterAndDimensions({100, 100}, 1, 1)),
+              IsEmpty());
+}
+
 TEST(InProgressStrokeTest, ExtendWithEmptyPredictedButNonEmptyReal) {
   InProgressStroke stroke;
   stroke.Start(CreateCircularTestBrush());
@@ -705,6 +1234,8 @@ TEST(InProgressStrokeTest, ResetUpdateRegionAfterStart) {
   ASSERT_TRUE(stroke.GetUpdatedRegion().IsEmpty());
   stroke.ResetUpdatedRegion();
   EXPECT_TRUE(stroke.GetUpdatedRegion().IsEmpty());
+  EXPECT_EQ(stroke.GetCoatFirstUpdatedVertex(0), std::nullopt);
+  EXPECT_EQ(stroke.GetCoatFirstUpdatedTriangle(0), std::nullopt);
 }
 
 TEST(InProgressStrokeTest, ResetUpdatedRegionAfterExtendingStroke) {
@@ -725,8 +1256,68 @@ TEST(InProgressStrokeTest, ResetUpdatedRegionAfterExtendingStroke) {
   ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.15)));
 
   ASSERT_FALSE(stroke.GetUpdatedRegion().IsEmpty());
+  ASSERT_THAT(stroke.GetCoatFirstUpdatedVertex(0), Optional(0u));
+  ASSERT_THAT(stroke.GetCoatFirstUpdatedTriangle(0), Optional(0u));
   stroke.ResetUpdatedRegion();
   EXPECT_TRUE(stroke.GetUpdatedRegion().IsEmpty());
+  EXPECT_EQ(stroke.GetCoatFirstUpdatedVertex(0), std::nullopt);
+  EXPECT_EQ(stroke.GetCoatFirstUpdatedTriangle(0), std::nullopt);
+}
+
+TEST(InProgressStrokeTest, FirstUpdatedVertexAndTriangleBoundMeshChanges) {
+  InProgressStroke stroke;
+  stroke.Start(CreateCircularTestBrush());
+
+  absl::StatusOr<StrokeInputBatch> real_inputs_0 = StrokeInputBatch::Create({
+      {.position = {1, 2}, .elapsed_time = Duration32::Seconds(0.0)},
+      {.position = {3, 2}, .elapsed_time = Duration32::Seconds(0.1)},
+      {.position = {5, 3}, .elapsed_time = Duration32::Seconds(0.2)},
+  });
+  ASSERT_EQ(real_inputs_0.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_inputs_0, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.2)));
+  EXPECT_THAT(stroke.GetCoatFirstUpdatedVertex(0), Optional(0u));
+  EXPECT_THAT(stroke.GetCoatFirstUpdatedTriangle(0), Optional(0u));
+
+  const MutableMesh& mesh = stroke.GetMesh(0);
+  std::vector<Point> positions_before;
+  for (uint32_t i = 0; i < mesh.VertexCount(); ++i) {
+    positions_before.push_back(mesh.VertexPosition(i));
+  }
+  std::vector<std::array<uint32_t, 3>> triangles_before;
+  for (uint32_t i = 0; i < mesh.TriangleCount(); ++i) {
+    triangles_before.push_back(mesh.TriangleIndices(i));
+  }
+  stroke.ResetUpdatedRegion();
+
+  absl::StatusOr<StrokeInputBatch> real_inputs_1 = StrokeInputBatch::Create({
+      {.position = {7, 5}, .elapsed_time = Duration32::Seconds(0.3)},
+      {.position = {9, 8}, .elapsed_time = Duration32::Seconds(0.4)},
+  });
+  ASSERT_EQ(real_inputs_1.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_inputs_1, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.4)));
+
+  // Everything before the reported indices should be untouched.
+  std::optional<uint32_t> first_vertex = stroke.GetCoatFirstUpdatedVertex(0);
+  std::optional<uint32_t> first_triangle =
+      stroke.GetCoatFirstUpdatedTriangle(0);
+  ASSERT_TRUE(first_vertex.has_value());
+  ASSERT_TRUE(first_triangle.has_value());
+  for (uint32_t i = 0; i < *first_vertex && i < positions_before.size(); ++i) {
+    EXPECT_EQ(mesh.VertexPosition(i), positions_before[i]) << "vertex " << i;
+  }
+  for (uint32_t i = 0; i < *first_triangle && i < triangles_before.size();
+       ++i) {
+    EXPECT_EQ(mesh.TriangleIndices(i), triangles_before[i]) << "triangle " << i;
+  }
+}
+
+TEST(InProgressStrokeDeathTest, FirstUpdatedVertexAndTriangleRequireValidCoat) {
+  InProgressStroke stroke;
+  EXPECT_DEATH_IF_SUPPORTED(stroke.GetCoatFirstUpdatedVertex(0), "");
+  stroke.Start(CreateCircularTestBrush());
+  EXPECT_DEATH_IF_SUPPORTED(stroke.GetCoatFirstUpdatedTriangle(1), "");
 }
 
 TEST(InProgressStrokeTest, StartAfterExtendingStroke) {
@@ -767,6 +1358,63 @@ TEST(InProgressStrokeTest, StartAfterExtendingStroke) {
   EXPECT_TRUE(stroke.GetUpdatedRegion().IsEmpty());
 }
 
+TEST(InProgressStrokeTest, CopyFromThenExtendMatchesOriginal) {
+  StrokeInputBatch inputs = MakeZigZagInputs(20);
+  InProgressStroke original;
+  original.SetSeparateTailEnabled(true);
+  original.Start(CreateCircularTestBrush(), /*noise_seed=*/7);
+  ASSERT_EQ(absl::OkStatus(),
+            original.EnqueueInputs(inputs.Slice(0, 10), {}));
+  ASSERT_EQ(absl::OkStatus(), original.UpdateShape(Duration32::Seconds(0.1)));
+
+  InProgressStroke copy;
+  copy.Start(CreateRectangularTestBrush());
+  copy.CopyFrom(original);
+  EXPECT_THAT(copy.GetBrush(), Pointee(BrushEq(*original.GetBrush())));
+  EXPECT_TRUE(copy.SeparateTailEnabled());
+  EXPECT_THAT(copy.GetInputs(), StrokeInputBatchEq(original.GetInputs()));
+  ASSERT_EQ(copy.BrushCoatCount(), 1u);
+  EXPECT_EQ(copy.GetMesh(0).VertexCount(), original.GetMesh(0).VertexCount());
+  EXPECT_THAT(copy.GetMeshBounds(0), EnvelopeEq(original.GetMeshBounds(0)));
+  // The whole copied shape is reported as updated.
+  EXPECT_THAT(copy.GetCoatFirstUpdatedVertex(0), Optional(0));
+  EXPECT_THAT(copy.GetCoatFirstUpdatedTriangle(0), Optional(0));
+
+  // Extending both strokes in the same way gives the same shape.
+  for (InProgressStroke* stroke : {&original, &copy}) {
+    ASSERT_EQ(absl::OkStatus(), stroke->EnqueueInputs(inputs.Slice(10), {}));
+    stroke->FinishInputs();
+    ASSERT_EQ(absl::OkStatus(), stroke->UpdateShape(inputs.GetDuration()));
+  }
+  EXPECT_THAT(copy.GetInputs(), StrokeInputBatchEq(original.GetInputs()));
+  EXPECT_EQ(copy.GetMesh(0).VertexCount(), original.GetMesh(0).VertexCount());
+  EXPECT_EQ(copy.GetMesh(0).TriangleCount(),
+            original.GetMesh(0).TriangleCount());
+  EXPECT_THAT(copy.GetMeshBounds(0), EnvelopeEq(original.GetMeshBounds(0)));
+  EXPECT_EQ(copy.GetTailMesh(0).VertexCount(),
+            original.GetTailMesh(0).VertexCount());
+}
+
+TEST(InProgressStrokeTest, CopyFromUnstartedStrokeClears) {
+  InProgressStroke unstarted;
+  unstarted.SetVertexWeldingEnabled(true);
+
+  InProgressStroke stroke;
+  stroke.Start(CreateCircularTestBrush());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(MakeZigZagInputs(5), {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Zero()));
+  Envelope old_region = stroke.GetUpdatedRegion();
+  old_region.Add(stroke.GetMeshBounds(0));
+
+  stroke.CopyFrom(unstarted);
+  EXPECT_EQ(stroke.GetBrush(), nullptr);
+  EXPECT_EQ(stroke.BrushCoatCount(), 0u);
+  EXPECT_TRUE(stroke.GetInputs().IsEmpty());
+  EXPECT_TRUE(stroke.VertexWeldingEnabled());
+  // The replaced shape must still be redrawn.
+  EXPECT_THAT(stroke.GetUpdatedRegion(), EnvelopeEq(old_region));
+}
+
 TEST(InProgressStrokeTest, InputCount) {
   Brush brush = CreateRectangularTestBrush();
   InProgressStroke stroke;
@@ -881,5 +1529,200 @@ TEST(InProgressStrokeTest, CopyToStrokeOmitUnneededAttributes) {
       EnvelopeNear(Rect::FromTwoPoints({-0.875, 0.125}, {4.868, 3.875}), 0.01));
 }
 
+Brush CreatePressureLuminosityTestBrush() {
+  auto family = BrushFamily::Create(
+      BrushTip{
+          .corner_rounding = 1,
+          .behaviors = {BrushBehavior{{
+              BrushBehavior::SourceNode{
+                  .source = BrushBehavior::Source::kNormalizedPressure,
+                  .source_value_range = {0, 1},
+              },
+              BrushBehavior::TargetNode{
+                  .target = BrushBehavior::Target::kLuminosity,
+                  .target_modifier_range = {0, 0.5},
+              },
+          }}},
+      },
+      BrushPaint{});
+  ABSL_CHECK_OK(family);
+  auto brush = Brush::Create(*family, Color(), /* size = */ 5,
+                             /* epsilon = */ 0.01);
+  ABSL_CHECK_OK(brush);
+  return *brush;
+}
+
+TEST(InProgressStrokeTest, CopyToStrokeOmitAttributesUnusedByThisStroke) {
+  InProgressStroke stroke;
+  stroke.Start(CreatePressureLuminosityTestBrush());
+  // Without pressure data, the luminosity behavior never takes effect.
+  absl::StatusOr<StrokeInputBatch> real_inputs = StrokeInputBatch::Create({
+      {.position = {1, 2}, .elapsed_time = Duration32::Seconds(0.0)},
+      {.position = {3, 2}, .elapsed_time = Duration32::Seconds(0.1)},
+  });
+  ASSERT_EQ(real_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.15)));
+
+  // The brush can shift color, so `kUsedByThisBrush` keeps the attribute, but
+  // this stroke never does.
+  Stroke brush_stroke =
+      stroke.CopyToStroke(InProgressStroke::RetainAttributes::kUsedByThisBrush);
+  ASSERT_EQ(brush_stroke.GetShape().RenderGroupCount(), 1u);
+  EXPECT_THAT(GetAttributeIds(brush_stroke.GetShape().RenderGroupFormat(0)),
+              Contains(MeshFormat::AttributeId::kColorShiftHsl));
+  Stroke finished_stroke = stroke.CopyToStroke(
+      InProgressStroke::RetainAttributes::kUsedByThisStroke);
+  ASSERT_EQ(finished_stroke.GetShape().RenderGroupCount(), 1u);
+  EXPECT_THAT(GetAttributeIds(finished_stroke.GetShape().RenderGroupFormat(0)),
+              Not(Contains(MeshFormat::AttributeId::kColorShiftHsl)));
+  EXPECT_THAT(GetAttributeIds(finished_stroke.GetShape().RenderGroupFormat(0)),
+              Contains(MeshFormat::AttributeId::kOpacityShift));
+  EXPECT_THAT(finished_stroke.GetShape().Bounds(),
+              EnvelopeNear(*brush_stroke.GetShape().Bounds().AsRect(), 0.01));
+}
+
+TEST(InProgressStrokeTest, CopyToStrokeRetainAttributesUsedByThisStroke) {
+  InProgressStroke stroke;
+  stroke.Start(CreatePressureLuminosityTestBrush());
+  absl::StatusOr<StrokeInputBatch> real_inputs = StrokeInputBatch::Create({
+      {.position = {1, 2},
+       .elapsed_time = Duration32::Seconds(0.0),
+       .pressure = 1},
+      {.position = {3, 2},
+       .elapsed_time = Duration32::Seconds(0.1),
+       .pressure = 1},
+  });
+  ASSERT_EQ(real_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.15)));
+
+  Stroke finished_stroke = stroke.CopyToStroke(
+      InProgressStroke::RetainAttributes::kUsedByThisStroke);
+  ASSERT_EQ(finished_stroke.GetShape().RenderGroupCount(), 1u);
+  EXPECT_THAT(GetAttributeIds(finished_stroke.GetShape().RenderGroupFormat(0)),
+              Contains(MeshFormat::AttributeId::kColorShiftHsl));
+}
+
+TEST(InProgressStrokeTest, MoveToStrokeMatchesCopyToStrokeAndClears) {
+  InProgressStroke stroke;
+  Brush original_brush = CreateCircularTestBrush();
+  stroke.Start(original_brush);
+  absl::StatusOr<StrokeInputBatch> real_inputs = StrokeInputBatch::Create({
+      {.position = {1, 2}, .elapsed_time = Duration32::Seconds(0.0)},
+      {.position = {3, 2}, .elapsed_time = Duration32::Seconds(0.1)},
+  });
+  ASSERT_EQ(real_inputs.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> predicted_inputs = StrokeInputBatch::Create(
+      {{.position = {3, 4}, .elapsed_time = Duration32::Seconds(0.2)}});
+  ASSERT_EQ(predicted_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(),
+            stroke.EnqueueInputs(*real_inputs, *predicted_inputs));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.15)));
+
+  Stroke copied_stroke = stroke.CopyToStroke();
+  Stroke moved_stroke = stroke.MoveToStroke();
+
+  EXPECT_THAT(moved_stroke.GetBrush(), BrushEq(original_brush));
+  EXPECT_THAT(moved_stroke.GetInputs(),
+              StrokeInputBatchEq(copied_stroke.GetInputs()));
+  EXPECT_THAT(moved_stroke.GetShape(),
+              PartitionedMeshDeepEq(copied_stroke.GetShape()));
+
+  // The `InProgressStroke` is left cleared.
+  EXPECT_EQ(stroke.GetBrush(), nullptr);
+  EXPECT_EQ(stroke.InputCount(), 0);
+  EXPECT_TRUE(stroke.InputsAreFinished());
+  EXPECT_TRUE(stroke.GetUpdatedRegion().IsEmpty());
+
+  // Starting and updating the next stroke does not affect the moved stroke.
+  stroke.Start(CreateRectangularTestBrush());
+  absl::StatusOr<StrokeInputBatch> next_inputs = StrokeInputBatch::Create(
+      {{.position = {10, 0}, .elapsed_time = Duration32::Seconds(0)},
+       {.position = {20, 0}, .elapsed_time = Duration32::Seconds(0.1)}});
+  ASSERT_EQ(next_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*next_inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.1)));
+
+  EXPECT_THAT(moved_stroke.GetBrush(), BrushEq(original_brush));
+  EXPECT_THAT(moved_stroke.GetInputs(),
+              StrokeInputBatchEq(copied_stroke.GetInputs()));
+  EXPECT_THAT(moved_stroke.GetShape(),
+              PartitionedMeshDeepEq(copied_stroke.GetShape()));
+}
+
+TEST(InProgressStrokeTest, MoveToStrokeOmitUnneededAttributes) {
+  InProgressStroke stroke;
+  stroke.Start(CreateCircularTestBrush());
+  absl::StatusOr<StrokeInputBatch> real_inputs = StrokeInputBatch::Create({
+      {.position = {1, 2}, .elapsed_time = Duration32::Seconds(0.0)},
+      {.position = {3, 2}, .elapsed_time = Duration32::Seconds(0.1)},
+  });
+  ASSERT_EQ(real_inputs.status(), absl::OkStatus());
+  ASSERT_EQ(absl::OkStatus(), stroke.EnqueueInputs(*real_inputs, {}));
+  ASSERT_EQ(absl::OkStatus(), stroke.UpdateShape(Duration32::Seconds(0.15)));
+
+  Stroke finished_stroke =
+      stroke.MoveToStroke(InProgressStroke::RetainAttributes::kUsedByThisBrush);
+  ASSERT_EQ(finished_stroke.GetShape().RenderGroupCount(), 1u);
+  EXPECT_THAT(GetAttributeIds(finished_stroke.GetShape().RenderGroupFormat(0)),
+              Not(Contains(MeshFormat::AttributeId::kColorShiftHsl)));
+}
+
+TEST(InProgressStrokeDeathTest, MoveToStrokeWithoutStart) {
+  InProgressStroke stroke;
+  EXPECT_DEATH_IF_SUPPORTED(stroke.MoveToStroke(), "");
+}
+
+TEST(InProgressStrokeTest, UpdateShapeWithCoatExecutorMatchesSequential) {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create({
+      BrushCoat{.tip = BrushTip()},
+      BrushCoat{.tip = BrushTip{.scale = {0.5, 1}, .corner_rounding = 0}},
+      BrushCoat{.tip = BrushTip{.scale = {1, 0.25}}},
+  });
+  ASSERT_EQ(family.status(), absl::OkStatus());
+  absl::StatusOr<Brush> brush = Brush::Create(*family, Color::White(), 5, 0.01);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+
+  absl::StatusOr<StrokeInputBatch> real_inputs = StrokeInputBatch::Create({
+      {.position = {1, 2}, .elapsed_time = Duration32::Seconds(0.0)},
+      {.position = {3, 2}, .elapsed_time = Duration32::Seconds(0.1)},
+  });
+  ASSERT_EQ(real_inputs.status(), absl::OkStatus());
+  absl::StatusOr<StrokeInputBatch> predicted_inputs = StrokeInputBatch::Create(
+      {{.position = {3, 4}, .elapsed_time = Duration32::Seconds(0.2)}});
+  ASSERT_EQ(predicted_inputs.status(), absl::OkStatus());
+
+  ThreadPerTaskExecutor executor;
+  InProgressStroke parallel_stroke;
+  InProgressStroke sequential_stroke;
+  parallel_stroke.Start(*brush);
+  sequential_stroke.Start(*brush);
+  ASSERT_EQ(absl::OkStatus(),
+            parallel_stroke.EnqueueInputs(*real_inputs, *predicted_inputs));
+  ASSERT_EQ(absl::OkStatus(),
+            sequential_stroke.EnqueueInputs(*real_inputs, *predicted_inputs));
+  ASSERT_EQ(absl::OkStatus(),
+            parallel_stroke.UpdateShape(Duration32::Seconds(0.1), &executor));
+  ASSERT_EQ(absl::OkStatus(),
+            sequential_stroke.UpdateShape(Duration32::Seconds(0.1)));
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+
+  ASSERT_EQ(parallel_stroke.BrushCoatCount(), 3u);
+  for (uint32_t coat_index = 0; coat_index < 3; ++coat_index) {
+    EXPECT_THAT(parallel_stroke.GetMesh(coat_index).RawVertexData(),
+                ElementsAreArray(
+                    sequential_stroke.GetMesh(coat_index).RawVertexData()));
+    EXPECT_THAT(parallel_stroke.GetMesh(coat_index).RawIndexData(),
+                ElementsAreArray(
+                    sequential_stroke.GetMesh(coat_index).RawIndexData()));
+    EXPECT_THAT(parallel_stroke.GetMeshBounds(coat_index),
+                EnvelopeEq(sequential_stroke.GetMeshBounds(coat_index)));
+  }
+  ASSERT_FALSE(parallel_stroke.GetUpdatedRegion().IsEmpty());
+  EXPECT_THAT(parallel_stroke.GetUpdatedRegion(),
+              EnvelopeEq(sequential_stroke.GetUpdatedRegion()));
+}
+
 }  // namespace
 }  // namespace ink
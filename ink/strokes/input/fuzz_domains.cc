@@ -69,16 +69,18 @@ std::vector<std::pair<Point, Duration32>> XytsSortedByTime(
 // A domain over sequences of (position, time) pairs such that (1) time values
 // are non-decreasing, and (2) all (position, time) pairs are unique.
 fuzztest::Domain<std::vector<std::pair<Point, Duration32>>> ValidXytSequence(
-    const fuzztest::Domain<Point>& position_domain, size_t min_size) {
+    const fuzztest::Domain<Point>& position_domain,
+    const fuzztest::Domain<Duration32>& time_domain, size_t min_size) {
   return fuzztest::Map(
       &XytsSortedByTime,
       fuzztest::UniqueElementsVectorOf(
-          fuzztest::PairOf(position_domain, FiniteNonNegativeDuration32()))
+          fuzztest::PairOf(position_domain, time_domain))
           .WithMinSize(min_size));
 }
 
 fuzztest::Domain<StrokeInputBatch> StrokeInputBatchWithPositionsAndMinSize(
-    const fuzztest::Domain<Point>& position_domain, size_t min_size) {
+    const fuzztest::Domain<Point>& position_domain,
+    const fuzztest::Domain<Duration32>& time_domain, size_t min_size) {
   return fuzztest::FlatMap(
       [](const std::vector<std::pair<Point, Duration32>>& xyts) {
         return fuzztest::Map(
@@ -118,7 +120,7 @@ fuzztest::Domain<StrokeInputBatch> StrokeInputBatchWithPositionsAndMinSize(
             fuzztest::OptionalOf(
                 fuzztest::VectorOf(ValidOrientation()).WithSize(xyts.size())));
       },
-      ValidXytSequence(position_domain, min_size));
+      ValidXytSequence(position_domain, time_domain, min_size));
 }
 
 }  // namespace
@@ -152,11 +154,20 @@ fuzztest::Domain<StrokeInputBatch> ArbitraryStrokeInputBatch() {
 
 fuzztest::Domain<StrokeInputBatch> StrokeInputBatchWithMinSize(
     size_t min_size) {
-  return StrokeInputBatchWithPositionsAndMinSize(FinitePoint(), min_size);
+  return StrokeInputBatchWithPositionsAndMinSize(
+      FinitePoint(), FiniteNonNegativeDuration32(), min_size);
 }
 
 fuzztest::Domain<StrokeInputBatch> StrokeInputBatchInRect(Rect rect) {
-  return StrokeInputBatchWithPositionsAndMinSize(PointInRect(rect), 0);
+  return StrokeInputBatchWithPositionsAndMinSize(
+      PointInRect(rect), FiniteNonNegativeDuration32(), 0);
+}
+
+fuzztest::Domain<StrokeInputBatch> StrokeInputBatchInRectAndDuration(
+    Rect rect, Duration32 max_duration) {
+  return StrokeInputBatchWithPositionsAndMinSize(
+      PointInRect(rect), Duration32InRange(Duration32::Zero(), max_duration),
+      0);
 }
 
 }  // namespace ink
@@ -21,6 +21,7 @@
 #include "ink/geometry/rect.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/duration.h"
 
 namespace ink {
 
@@ -42,6 +43,11 @@ fuzztest::Domain<StrokeInputBatch> StrokeInputBatchWithMinSize(size_t min_size);
 // given rectangle.
 fuzztest::Domain<StrokeInputBatch> StrokeInputBatchInRect(Rect rect);
 
+// The domain of StrokeInputBatches whose input positions are all within the
+// given rectangle, and whose elapsed times are all at most `max_duration`.
+fuzztest::Domain<StrokeInputBatch> StrokeInputBatchInRectAndDuration(
+    Rect rect, Duration32 max_duration);
+
 }  // namespace ink
 
 #endif  // INK_STROKES_INPUT_FUZZ_DOMAINS_H_
@@ -0,0 +1,94 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/input/internal/stroke_input_ring_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+
+namespace ink::stroke_input_internal {
+
+StrokeInputRingBuffer::StrokeInputRingBuffer(size_t min_capacity)
+    : capacity_(std::bit_ceil(min_capacity)),
+      slots_(std::make_unique<StrokeInput[]>(capacity_)) {
+  ABSL_CHECK_GT(min_capacity, 0u);
+  pop_scratch_.reserve(capacity_);
+}
+
+size_t StrokeInputRingBuffer::Size() const {
+  // Load the read index first: the write index can only have grown since, so
+  // the difference can't underflow.
+  uint64_t read_index = read_index_.load(std::memory_order_acquire);
+  uint64_t write_index = write_index_.load(std::memory_order_acquire);
+  return write_index - read_index;
+}
+
+size_t StrokeInputRingBuffer::Push(absl::Span<const StrokeInput> inputs) {
+  uint64_t write_index = write_index_.load(std::memory_order_relaxed);
+  // Acquire, so that the consumer is done reading the slots it has released
+  // before they are overwritten below.
+  uint64_t read_index = read_index_.load(std::memory_order_acquire);
+  size_t free_slots = capacity_ - (write_index - read_index);
+  size_t count = std::min(inputs.size(), free_slots);
+  for (size_t i = 0; i < count; ++i) {
+    slots_[(write_index + i) & (capacity_ - 1)] = inputs[i];
+  }
+  if (count < inputs.size()) {
+    rejected_count_.fetch_add(inputs.size() - count,
+                              std::memory_order_relaxed);
+  }
+  // Release, so that the consumer sees the slots written above.
+  write_index_.store(write_index + count, std::memory_order_release);
+  return count;
+}
+
+absl::Status StrokeInputRingBuffer::PopAllInto(StrokeInputBatch& batch) {
+  uint64_t read_index = read_index_.load(std::memory_order_relaxed);
+  uint64_t write_index = write_index_.load(std::memory_order_acquire);
+  if (read_index == write_index) return absl::OkStatus();
+
+  size_t start = read_index & (capacity_ - 1);
+  size_t count = write_index - read_index;
+  absl::Status status;
+  if (start + count <= capacity_) {
+    status = batch.Append(absl::MakeConstSpan(&slots_[start], count));
+  } else {
+    // The inputs wrap around the end of `slots_`. This never allocates, since
+    // the scratch space was reserved for a full queue.
+    pop_scratch_.assign(&slots_[start], &slots_[capacity_]);
+    pop_scratch_.insert(pop_scratch_.end(), &slots_[0],
+                        &slots_[start + count - capacity_]);
+    status = batch.Append(pop_scratch_);
+  }
+  // Release, so that the producer only reuses the slots after they were read.
+  read_index_.store(write_index, std::memory_order_release);
+  return status;
+}
+
+void StrokeInputRingBuffer::Clear() {
+  read_index_.store(write_index_.load(std::memory_order_acquire),
+                    std::memory_order_release);
+}
+
+}  // namespace ink::stroke_input_internal
@@ -0,0 +1,100 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_INPUT_INTERNAL_STROKE_INPUT_RING_BUFFER_H_
+#define INK_STROKES_INPUT_INTERNAL_STROKE_INPUT_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+
+namespace ink::stroke_input_internal {
+
+// A fixed-capacity queue of `StrokeInput`s that hands inputs from one producer
+// thread, e.g. the thread on which the platform delivers input events, to one
+// consumer thread, e.g. the thread that builds the stroke's shape.
+//
+// Neither side takes a lock or allocates: the storage is allocated once, at
+// construction, and the two sides only share a pair of atomic indices.
+//
+// Backpressure: `Push()` never blocks and never overwrites inputs that have not
+// been popped yet. When the queue is full, it accepts as many of the given
+// inputs as fit, in order, and rejects the rest, which the producer should
+// hold on to and push again later. Rejected inputs are counted by
+// `RejectedCount()`.
+//
+// `Push()` must only be called from one thread at a time, and likewise the
+// consumer methods, `PopAllInto()` and `Clear()`. The other methods may be
+// called from any thread.
+class StrokeInputRingBuffer {
+ public:
+  // Constructs a queue that holds at least `min_capacity` inputs, which must
+  // be positive. The capacity is rounded up to a power of two.
+  explicit StrokeInputRingBuffer(size_t min_capacity);
+
+  StrokeInputRingBuffer(const StrokeInputRingBuffer&) = delete;
+  StrokeInputRingBuffer& operator=(const StrokeInputRingBuffer&) = delete;
+  ~StrokeInputRingBuffer() = default;
+
+  size_t Capacity() const { return capacity_; }
+
+  // Returns the number of inputs waiting to be popped. This is a snapshot,
+  // which may already be out of date if the other side is running.
+  size_t Size() const;
+
+  // Producer only. Appends the longest prefix of `inputs` that fits, and
+  // returns its length.
+  size_t Push(absl::Span<const StrokeInput> inputs);
+
+  // Consumer only. Pops all of the inputs that are waiting, and appends them
+  // to `batch`. If they fail validation against `batch`, they are still
+  // popped, but `batch` is left unchanged and the error is returned.
+  absl::Status PopAllInto(StrokeInputBatch& batch);
+
+  // Consumer only. Drops all of the inputs that are waiting.
+  void Clear();
+
+  // The total number of inputs that `Push()` has rejected because the queue
+  // was full.
+  uint64_t RejectedCount() const {
+    return rejected_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  size_t capacity_;
+  std::unique_ptr<StrokeInput[]> slots_;
+  // Where `PopAllInto()` gathers inputs that wrap around the end of `slots_`,
+  // so that they can be appended to the batch in one validated step. Only used
+  // by the consumer.
+  std::vector<StrokeInput> pop_scratch_;
+
+  // The indices only ever increase; the slot of index `i` is
+  // `i & (capacity_ - 1)`. The producer writes `write_index_` and
+  // `rejected_count_`, and the consumer writes `read_index_`, which is kept on
+  // a separate cache line so that the two sides don't contend for one.
+  alignas(64) std::atomic<uint64_t> write_index_ = 0;
+  std::atomic<uint64_t> rejected_count_ = 0;
+  alignas(64) std::atomic<uint64_t> read_index_ = 0;
+};
+
+}  // namespace ink::stroke_input_internal
+
+#endif  // INK_STROKES_INPUT_INTERNAL_STROKE_INPUT_RING_BUFFER_H_
@@ -0,0 +1,155 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/input/internal/stroke_input_ring_buffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/input/type_matchers.h"
+#include "ink/types/duration.h"
+
+namespace ink::stroke_input_internal {
+namespace {
+
+// Returns `count` valid consecutive inputs, starting with the `first`-th input
+// of an infinite sequence.
+std::vector<StrokeInput> MakeInputs(int first, int count) {
+  std::vector<StrokeInput> inputs;
+  for (int i = first; i < first + count; ++i) {
+    inputs.push_back({.tool_type = StrokeInput::ToolType::kTouch,
+                      .position = {static_cast<float>(i), 0},
+                      .elapsed_time = Duration32::Millis(i)});
+  }
+  return inputs;
+}
+
+TEST(StrokeInputRingBufferTest, RoundsCapacityUpToPowerOfTwo) {
+  EXPECT_EQ(StrokeInputRingBuffer(1).Capacity(), 1);
+  EXPECT_EQ(StrokeInputRingBuffer(8).Capacity(), 8);
+  EXPECT_EQ(StrokeInputRingBuffer(100).Capacity(), 128);
+}
+
+TEST(StrokeInputRingBufferTest, PopsPushedInputsInOrder) {
+  StrokeInputRingBuffer queue(8);
+  std::vector<StrokeInput> inputs = MakeInputs(0, 5);
+
+  EXPECT_EQ(queue.Push(absl::MakeConstSpan(inputs).first(2)), 2);
+  EXPECT_EQ(queue.Push(absl::MakeConstSpan(inputs).subspan(2)), 3);
+  EXPECT_EQ(queue.Size(), 5);
+
+  StrokeInputBatch batch;
+  EXPECT_EQ(queue.PopAllInto(batch), absl::OkStatus());
+  EXPECT_THAT(batch, StrokeInputBatchIsArray(inputs));
+  EXPECT_EQ(queue.Size(), 0);
+
+  // Popping again appends nothing.
+  EXPECT_EQ(queue.PopAllInto(batch), absl::OkStatus());
+  EXPECT_EQ(batch.Size(), 5);
+}
+
+TEST(StrokeInputRingBufferTest, PopsInputsThatWrapAround) {
+  StrokeInputRingBuffer queue(4);
+  StrokeInputBatch batch;
+  ASSERT_EQ(queue.Push(MakeInputs(0, 3)), 3);
+  ASSERT_EQ(queue.PopAllInto(batch), absl::OkStatus());
+
+  // These occupy the last slot, and then the first three.
+  std::vector<StrokeInput> inputs = MakeInputs(3, 4);
+  EXPECT_EQ(queue.Push(inputs), 4);
+  batch.Clear();
+  EXPECT_EQ(queue.PopAllInto(batch), absl::OkStatus());
+  EXPECT_THAT(batch, StrokeInputBatchIsArray(inputs));
+}
+
+TEST(StrokeInputRingBufferTest, RejectsInputsThatDontFit) {
+  StrokeInputRingBuffer queue(4);
+  std::vector<StrokeInput> inputs = MakeInputs(0, 6);
+
+  // Only the first four inputs fit, and the queue is never overwritten.
+  EXPECT_EQ(queue.Push(inputs), 4);
+  EXPECT_EQ(queue.RejectedCount(), 2);
+  EXPECT_EQ(queue.Push(absl::MakeConstSpan(inputs).subspan(4)), 0);
+  EXPECT_EQ(queue.RejectedCount(), 4);
+
+  StrokeInputBatch batch;
+  ASSERT_EQ(queue.PopAllInto(batch), absl::OkStatus());
+  EXPECT_THAT(batch,
+              StrokeInputBatchIsArray(absl::MakeConstSpan(inputs).first(4)));
+
+  // The producer can push the rejected inputs again once there is room.
+  EXPECT_EQ(queue.Push(absl::MakeConstSpan(inputs).subspan(4)), 2);
+}
+
+TEST(StrokeInputRingBufferTest, PopsInvalidInputsWithoutChangingBatch) {
+  StrokeInputRingBuffer queue(4);
+  StrokeInputBatch batch;
+  ASSERT_EQ(batch.Append(MakeInputs(10, 1)), absl::OkStatus());
+
+  // These inputs go back in time from the one in `batch`.
+  ASSERT_EQ(queue.Push(MakeInputs(0, 2)), 2);
+  EXPECT_EQ(queue.PopAllInto(batch).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(batch.Size(), 1);
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+TEST(StrokeInputRingBufferTest, ClearDropsWaitingInputs) {
+  StrokeInputRingBuffer queue(4);
+  ASSERT_EQ(queue.Push(MakeInputs(0, 3)), 3);
+
+  queue.Clear();
+  EXPECT_EQ(queue.Size(), 0);
+  StrokeInputBatch batch;
+  EXPECT_EQ(queue.PopAllInto(batch), absl::OkStatus());
+  EXPECT_TRUE(batch.IsEmpty());
+  EXPECT_EQ(queue.Push(MakeInputs(3, 4)), 4);
+}
+
+TEST(StrokeInputRingBufferTest, HandsInputsBetweenThreads) {
+  constexpr int kInputCount = 2000;
+  std::vector<StrokeInput> inputs = MakeInputs(0, kInputCount);
+  StrokeInputRingBuffer queue(16);
+
+  std::thread producer([&queue, &inputs]() {
+    absl::Span<const StrokeInput> remaining = inputs;
+    while (!remaining.empty()) {
+      // Push a few inputs at a time, as an input thread would, and retry the
+      // ones that didn't fit.
+      size_t pushed = queue.Push(remaining.first(std::min<size_t>(
+          remaining.size(), 1 + remaining.size() % 5)));
+      remaining.remove_prefix(pushed);
+      if (pushed == 0) std::this_thread::yield();
+    }
+  });
+
+  StrokeInputBatch batch;
+  while (batch.Size() < kInputCount) {
+    ASSERT_EQ(queue.PopAllInto(batch), absl::OkStatus());
+  }
+  producer.join();
+
+  EXPECT_THAT(batch, StrokeInputBatchIsArray(inputs));
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+}  // namespace
+}  // namespace ink::stroke_input_internal
@@ -14,6 +14,7 @@
 
 #include "ink/strokes/input/recorded_test_inputs.h"
 
+#include <cstddef>
 #include <utility>
 #include <vector>
 
@@ -22,9 +23,11 @@
 #include "ink/geometry/envelope.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/rect.h"
+#include "ink/geometry/vec.h"
 #include "ink/strokes/input/recorded_test_inputs_data.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/duration.h"
 
 namespace ink {
 
@@ -124,4 +127,31 @@ StrokeInputBatch MakeCompleteSpringShapeInputs(const Rect& bounds) {
   return combined_batch;
 }
 
+StrokeInputBatch MakeLongRecordedInputs(const Rect& bounds,
+                                        size_t min_input_count,
+                                        float input_rate_hz) {
+  const StrokeInputBatch sources[] = {
+      MakeCompleteStraightLineInputs(bounds),
+      MakeCompleteSpringShapeInputs(bounds),
+  };
+
+  StrokeInputBatch result;
+  Point end = {bounds.XMin(), bounds.YMin()};
+  for (size_t copy = 0; result.Size() < min_input_count; ++copy) {
+    const StrokeInputBatch& source = sources[copy % 2];
+    Vec offset = end - source.Get(0).position;
+    // Skip the first input of each subsequent copy, since it would otherwise
+    // duplicate the previous copy's last position.
+    for (size_t i = copy == 0 ? 0 : 1; i < source.Size(); ++i) {
+      StrokeInput input = source.Get(i);
+      input.position += offset;
+      input.elapsed_time = Duration32::Seconds(
+          static_cast<float>(result.Size()) / input_rate_hz);
+      ABSL_CHECK_OK(result.Append(input));
+    }
+    end = result.Get(result.Size() - 1).position;
+  }
+  return result;
+}
+
 }  // namespace ink
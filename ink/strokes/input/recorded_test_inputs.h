@@ -15,6 +15,7 @@
 #ifndef INK_STROKES_INPUT_RECORDED_TEST_INPUTS_H_
 #define INK_STROKES_INPUT_RECORDED_TEST_INPUTS_H_
 
+#include <cstddef>
 #include <utility>
 #include <vector>
 
@@ -45,6 +46,15 @@ std::vector<std::pair<StrokeInputBatch, StrokeInputBatch>>
 MakeIncrementalSpringShapeInputs(const Rect& bounds);
 StrokeInputBatch MakeCompleteSpringShapeInputs(const Rect& bounds);
 
+// Returns at least `min_input_count` inputs made by alternately chaining the
+// complete straight line and spring shape inputs, scaled to fit within
+// `bounds`, with each copy starting where the previous one ended. The inputs
+// are re-timed to arrive at `input_rate_hz`, so that strokes of any length can
+// be drawn from real pen motion.
+StrokeInputBatch MakeLongRecordedInputs(const Rect& bounds,
+                                        size_t min_input_count,
+                                        float input_rate_hz);
+
 }  // namespace ink
 
 #endif  // INK_STROKES_INPUT_RECORDED_TEST_INPUTS_H_
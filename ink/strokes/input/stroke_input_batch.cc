@@ -18,6 +18,7 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -26,6 +27,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
 #include "ink/geometry/affine_transform.h"
@@ -35,23 +37,28 @@
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/types/duration.h"
 #include "ink/types/internal/copy_on_write.h"
+#include "ink/types/memory_footprint.h"
 #include "ink/types/physical_distance.h"
 
 namespace ink {
 
 StrokeInputBatch::ConstIterator& StrokeInputBatch::ConstIterator::operator++() {
-  ABSL_DCHECK(!batch_subdata_.empty())
+  ABSL_DCHECK(batch_ != nullptr && index_ < batch_->Size())
       << "Attempted to dereference singular or past-the-end iterator";
-  ABSL_DCHECK_EQ(batch_subdata_.size() % FloatsPerInput(value_), 0);
 
-  batch_subdata_.remove_prefix(FloatsPerInput(value_));
-  if (!batch_subdata_.empty()) {
-    auto iter = batch_subdata_.begin();
-    value_.position = {.x = *iter++, .y = *iter++};
-    value_.elapsed_time = Duration32::Seconds(*iter++);
-    if (value_.HasPressure()) value_.pressure = *iter++;
-    if (value_.HasTilt()) value_.tilt = Angle::Radians(*iter++);
-    if (value_.HasOrientation()) value_.orientation = Angle::Radians(*iter++);
+  ++index_;
+  if (index_ < batch_->Size()) {
+    const Channels& data = batch_->data_.Value();
+    size_t i = batch_->offset_ + index_;
+    value_.position = {.x = data.x[i], .y = data.y[i]};
+    value_.elapsed_time = Duration32::Seconds(data.elapsed_seconds[i]);
+    if (value_.HasPressure()) value_.pressure = data.pressure[i];
+    if (value_.HasTilt()) {
+      value_.tilt = Angle::Radians(data.tilt_radians[i]);
+    }
+    if (value_.HasOrientation()) {
+      value_.orientation = Angle::Radians(data.orientation_radians[i]);
+    }
   }
   return *this;
 }
@@ -64,10 +71,17 @@ StrokeInputBatch::ConstIterator StrokeInputBatch::ConstIterator::operator++(
 }
 
 void StrokeInputBatch::Clear() {
+  offset_ = 0;
   if (data_.IsShared()) {
     data_.Reset();
   } else if (data_.HasValue()) {
-    data_.MutableValue().clear();
+    Channels& data = data_.MutableValue();
+    data.x.clear();
+    data.y.clear();
+    data.elapsed_seconds.clear();
+    data.pressure.clear();
+    data.tilt_radians.clear();
+    data.orientation_radians.clear();
   }
 
   size_ = 0;
@@ -82,11 +96,69 @@ void StrokeInputBatch::Clear() {
 StrokeInputBatch StrokeInputBatch::MakeDeepCopy() const {
   StrokeInputBatch new_batch(*this);
   if (new_batch.data_.HasValue()) {
-    new_batch.data_.Emplace(new_batch.data_->begin(), new_batch.data_->end());
+    new_batch.data_.Emplace(CopyChannelRange());
+    new_batch.offset_ = 0;
   }
   return new_batch;
 }
 
+StrokeInputBatch StrokeInputBatch::Slice(size_t start, size_t count) const {
+  ABSL_CHECK_LE(start, Size());
+  StrokeInputBatch slice(*this);
+  slice.Erase(0, start);
+  slice.Erase(std::min(count, slice.Size()));
+  // Erasing every input clears the format and seed, which a slice keeps.
+  if (slice.IsEmpty()) {
+    slice.tool_type_ = tool_type_;
+    slice.stroke_unit_length_ = stroke_unit_length_;
+    slice.has_pressure_ = has_pressure_;
+    slice.has_tilt_ = has_tilt_;
+    slice.has_orientation_ = has_orientation_;
+    slice.noise_seed_ = noise_seed_;
+  }
+  return slice;
+}
+
+StrokeInputBatch::Channels& StrokeInputBatch::MutableChannels() {
+  ABSL_DCHECK(data_.HasValue());
+  size_t end = offset_ + size_;
+  if (offset_ == 0 && data_->x.size() == end) return data_.MutableValue();
+
+  if (data_.IsShared()) {
+    data_.Emplace(CopyChannelRange());
+  } else {
+    Channels& data = data_.MutableValue();
+    auto trim = [this, end](std::vector<float>& channel) {
+      if (channel.empty()) return;
+      channel.erase(channel.begin() + end, channel.end());
+      channel.erase(channel.begin(), channel.begin() + offset_);
+    };
+    trim(data.x);
+    trim(data.y);
+    trim(data.elapsed_seconds);
+    trim(data.pressure);
+    trim(data.tilt_radians);
+    trim(data.orientation_radians);
+  }
+  offset_ = 0;
+  return data_.MutableValue();
+}
+
+StrokeInputBatch::Channels StrokeInputBatch::CopyChannelRange() const {
+  auto copy = [this](const std::vector<float>& channel) {
+    absl::Span<const float> range = ChannelRange(channel);
+    return std::vector<float>(range.begin(), range.end());
+  };
+  return Channels{
+      .x = copy(data_->x),
+      .y = copy(data_->y),
+      .elapsed_seconds = copy(data_->elapsed_seconds),
+      .pressure = copy(data_->pressure),
+      .tilt_radians = copy(data_->tilt_radians),
+      .orientation_radians = copy(data_->orientation_radians),
+  };
+}
+
 namespace {
 
 using ::ink::stroke_input_internal::ValidateConsecutiveInputs;
@@ -177,6 +249,104 @@ absl::Status ValidateInputSequence(absl::Span<const StrokeInput> inputs) {
   return absl::OkStatus();
 }
 
+// Returns the `i`-th input described by `columns`, which must have consistent
+// column sizes.
+StrokeInput GetColumnsInput(const StrokeInputBatch::InputColumns& columns,
+                            size_t i) {
+  return {.tool_type = columns.tool_type,
+          .position = {.x = columns.x[i], .y = columns.y[i]},
+          .elapsed_time = Duration32::Seconds(columns.elapsed_seconds[i]),
+          .stroke_unit_length = columns.stroke_unit_length,
+          .pressure = columns.pressure.empty() ? StrokeInput::kNoPressure
+                                               : columns.pressure[i],
+          .tilt = columns.tilt_radians.empty()
+                      ? StrokeInput::kNoTilt
+                      : Angle::Radians(columns.tilt_radians[i]),
+          .orientation = columns.orientation_radians.empty()
+                             ? StrokeInput::kNoOrientation
+                             : Angle::Radians(columns.orientation_radians[i])};
+}
+
+absl::Status ValidateColumnSize(absl::string_view name,
+                                absl::Span<const float> column, size_t size) {
+  if (column.empty() || column.size() == size) return absl::OkStatus();
+  return absl::InvalidArgumentError(
+      absl::Substitute("`InputColumns::$0` must be empty or have the same size "
+                       "as `InputColumns::x`. Got $1 and $2",
+                       name, column.size(), size));
+}
+
+// Returns true if every value in `values` is in the range [`min`, `max`]. NaN
+// values are never in range.
+bool AllInRange(absl::Span<const float> values, float min, float max) {
+  // Accumulate without short-circuiting so that the loop can be vectorized.
+  bool all_in_range = true;
+  for (float value : values) {
+    all_in_range &= (value >= min) & (value <= max);
+  }
+  return all_in_range;
+}
+
+// Returns true if `elapsed_seconds` is non-decreasing and no two consecutive
+// inputs share the same x-y-t triplet.
+bool AreConsecutiveColumnValuesValid(
+    const StrokeInputBatch::InputColumns& columns) {
+  absl::Span<const float> x = columns.x;
+  absl::Span<const float> y = columns.y;
+  absl::Span<const float> t = columns.elapsed_seconds;
+  bool all_valid = true;
+  for (size_t i = 1; i < t.size(); ++i) {
+    all_valid &= t[i - 1] <= t[i];
+    all_valid &= (x[i - 1] != x[i]) | (y[i - 1] != y[i]) | (t[i - 1] != t[i]);
+  }
+  return all_valid;
+}
+
+// Validates `columns`, which must have consistent and non-zero column sizes.
+// This checks the same requirements as `ValidateInputSequence()`, but one
+// property at a time.
+absl::Status ValidateColumns(const StrokeInputBatch::InputColumns& columns) {
+  // The first input carries the tool type and stroke unit length that are
+  // shared by all of the inputs.
+  if (absl::Status status = ValidateSingleInput(GetColumnsInput(columns, 0));
+      !status.ok()) {
+    return status;
+  }
+
+  constexpr float kMaxFinite = std::numeric_limits<float>::max();
+  if (AllInRange(columns.x, -kMaxFinite, kMaxFinite) &&
+      AllInRange(columns.y, -kMaxFinite, kMaxFinite) &&
+      AllInRange(columns.elapsed_seconds, 0, kMaxFinite) &&
+      AllInRange(columns.pressure, 0, 1) &&
+      AllInRange(columns.tilt_radians, 0, kQuarterTurn.ValueInRadians()) &&
+      AllInRange(columns.orientation_radians, 0,
+                 kFullTurn.ValueInRadians()) &&
+      AreConsecutiveColumnValuesValid(columns)) {
+    return absl::OkStatus();
+  }
+
+  // Something is invalid, so fall back to validating input by input in order
+  // to report the first failure with the same message as `Append()`.
+  StrokeInput previous = GetColumnsInput(columns, 0);
+  for (size_t i = 1; i < columns.x.size(); ++i) {
+    StrokeInput input = GetColumnsInput(columns, i);
+    if (absl::Status status = ValidateSingleInput(input); !status.ok()) {
+      return status;
+    }
+    if (absl::Status status = ValidateConsecutiveInputs(previous, input);
+        !status.ok()) {
+      return status;
+    }
+    previous = input;
+  }
+  // The only way to get here is for a non-empty optional column to contain
+  // nothing but its sentinel value.
+  return absl::InvalidArgumentError(
+      "Non-empty `InputColumns` optional property columns must not contain "
+      "sentinel values. Use an empty column to indicate that a property is "
+      "not reported.");
+}
+
 }  // namespace
 
 void StrokeInputBatch::SetInlineFormatMetadata(const StrokeInput& input) {
@@ -188,22 +358,18 @@ void StrokeInputBatch::SetInlineFormatMetadata(const StrokeInput& input) {
   has_orientation_ = input.HasOrientation();
 }
 
-namespace {
-
-void AppendInputToFloatVector(const StrokeInput& input,
-                              std::vector<float>& data) {
-  data.push_back(input.position.x);
-  data.push_back(input.position.y);
-  data.push_back(input.elapsed_time.ToSeconds());
-  if (input.HasPressure()) data.push_back(input.pressure);
-  if (input.HasTilt()) data.push_back(input.tilt.ValueInRadians());
-  if (input.HasOrientation()) {
-    data.push_back(input.orientation.ValueInRadians());
+void StrokeInputBatch::AppendInputData(const StrokeInput& input) {
+  Channels& data = MutableChannels();
+  data.x.push_back(input.position.x);
+  data.y.push_back(input.position.y);
+  data.elapsed_seconds.push_back(input.elapsed_time.ToSeconds());
+  if (has_pressure_) data.pressure.push_back(input.pressure);
+  if (has_tilt_) data.tilt_radians.push_back(input.tilt.ValueInRadians());
+  if (has_orientation_) {
+    data.orientation_radians.push_back(input.orientation.ValueInRadians());
   }
 }
 
-}  // namespace
-
 absl::Status StrokeInputBatch::Set(size_t i, const StrokeInput& input) {
   ABSL_CHECK_LT(i, Size());
   absl::Status status = ValidateSingleInput(input);
@@ -215,7 +381,7 @@ absl::Status StrokeInputBatch::Set(size_t i, const StrokeInput& input) {
     Clear();
     if (!data_.HasValue()) data_.Emplace();
     SetInlineFormatMetadata(input);
-    AppendInputToFloatVector(input, data_.MutableValue());
+    AppendInputData(input);
     size_ = 1;
     return absl::OkStatus();
   }
@@ -231,15 +397,15 @@ absl::Status StrokeInputBatch::Set(size_t i, const StrokeInput& input) {
     }
   }
 
-  auto data =
-      absl::MakeSpan(data_.MutableValue()).subspan(i * FloatsPerInput());
-  auto iter = data.begin();
-  *iter++ = input.position.x;
-  *iter++ = input.position.y;
-  *iter++ = input.elapsed_time.ToSeconds();
-  if (HasPressure()) *iter++ = input.pressure;
-  if (HasTilt()) *iter++ = input.tilt.ValueInRadians();
-  if (HasOrientation()) *iter++ = input.orientation.ValueInRadians();
+  Channels& data = MutableChannels();
+  data.x[i] = input.position.x;
+  data.y[i] = input.position.y;
+  data.elapsed_seconds[i] = input.elapsed_time.ToSeconds();
+  if (HasPressure()) data.pressure[i] = input.pressure;
+  if (HasTilt()) data.tilt_radians[i] = input.tilt.ValueInRadians();
+  if (HasOrientation()) {
+    data.orientation_radians[i] = input.orientation.ValueInRadians();
+  }
 
   return absl::OkStatus();
 }
@@ -247,16 +413,19 @@ absl::Status StrokeInputBatch::Set(size_t i, const StrokeInput& input) {
 StrokeInput StrokeInputBatch::Get(size_t i) const {
   ABSL_CHECK_LT(i, Size());
 
-  auto data = absl::MakeSpan(data_.Value()).subspan(i * FloatsPerInput());
-  auto iter = data.begin();
+  const Channels& data = data_.Value();
+  i += offset_;
   return {.tool_type = tool_type_,
-          .position = {.x = *iter++, .y = *iter++},
-          .elapsed_time = Duration32::Seconds(*iter++),
+          .position = {.x = data.x[i], .y = data.y[i]},
+          .elapsed_time = Duration32::Seconds(data.elapsed_seconds[i]),
           .stroke_unit_length = stroke_unit_length_,
-          .pressure = HasPressure() ? *iter++ : StrokeInput::kNoPressure,
-          .tilt = HasTilt() ? Angle::Radians(*iter++) : StrokeInput::kNoTilt,
-          .orientation = HasOrientation() ? Angle::Radians(*iter++)
-                                          : StrokeInput::kNoOrientation};
+          .pressure =
+              HasPressure() ? data.pressure[i] : StrokeInput::kNoPressure,
+          .tilt = HasTilt() ? Angle::Radians(data.tilt_radians[i])
+                            : StrokeInput::kNoTilt,
+          .orientation = HasOrientation()
+                             ? Angle::Radians(data.orientation_radians[i])
+                             : StrokeInput::kNoOrientation};
 }
 
 absl::Status StrokeInputBatch::Append(const StrokeInput& input) {
@@ -275,7 +444,7 @@ absl::Status StrokeInputBatch::Append(const StrokeInput& input) {
     SetInlineFormatMetadata(input);
   }
 
-  AppendInputToFloatVector(input, data_.MutableValue());
+  AppendInputData(input);
   ++size_;
 
   return absl::OkStatus();
@@ -305,11 +474,96 @@ absl::Status StrokeInputBatch::Append(absl::Span<const StrokeInput> inputs) {
   // this function will be called repeatedly with relatively small batches of
   // new inputs.
 
-  std::vector<float>& data = data_.MutableValue();
   for (const StrokeInput& input : inputs) {
-    AppendInputToFloatVector(input, data);
+    AppendInputData(input);
+    ++size_;
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status StrokeInputBatch::AppendColumns(const InputColumns& columns) {
+  return AppendColumnsImpl(columns, /*validate_values=*/true);
+}
+
+absl::Status StrokeInputBatch::AppendTrustedColumns(
+    const InputColumns& columns) {
+  return AppendColumnsImpl(columns, /*validate_values=*/false);
+}
+
+absl::Status StrokeInputBatch::AppendColumnsImpl(const InputColumns& columns,
+                                                 bool validate_values) {
+  const size_t count = columns.x.size();
+  if (columns.y.size() != count || columns.elapsed_seconds.size() != count) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "`InputColumns::x`, `y`, and `elapsed_seconds` must have the same "
+        "size. Got $0, $1, and $2",
+        count, columns.y.size(), columns.elapsed_seconds.size()));
   }
-  size_ += inputs.size();
+  if (absl::Status status =
+          ValidateColumnSize("pressure", columns.pressure, count);
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status =
+          ValidateColumnSize("tilt_radians", columns.tilt_radians, count);
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status = ValidateColumnSize(
+          "orientation_radians", columns.orientation_radians, count);
+      !status.ok()) {
+    return status;
+  }
+  if (count == 0) return absl::OkStatus();
+
+  StrokeInput first = GetColumnsInput(columns, 0);
+  if (validate_values) {
+    if (absl::Status status = ValidateColumns(columns); !status.ok()) {
+      return status;
+    }
+  } else {
+    // The first input still carries the tool type and stroke unit length that
+    // are shared by all of the inputs, which is cheap to check.
+    if (absl::Status status = ValidateSingleInput(first); !status.ok()) {
+      return status;
+    }
+  }
+  if (!IsEmpty()) {
+    if (absl::Status status = ValidateConsecutiveInputs(Get(Size() - 1), first);
+        !status.ok()) {
+      return status;
+    }
+  }
+  // Without validated values, a sentinel value in the first row could make the
+  // format disagree with which columns are present, so check that directly to
+  // keep the size of each channel consistent with the format.
+  if (columns.pressure.empty() == first.HasPressure() ||
+      columns.tilt_radians.empty() == first.HasTilt() ||
+      columns.orientation_radians.empty() == first.HasOrientation()) {
+    return absl::InvalidArgumentError(
+        "Non-empty `InputColumns` optional property columns must not contain "
+        "sentinel values. Use an empty column to indicate that a property is "
+        "not reported.");
+  }
+  if (IsEmpty()) {
+    if (!data_.HasValue()) data_.Emplace();
+    SetInlineFormatMetadata(first);
+  }
+
+  // Inserting a whole range grows each vector at most once, while keeping the
+  // geometric capacity growth that repeated appends rely on.
+  Channels& data = MutableChannels();
+  auto append = [](std::vector<float>& to, absl::Span<const float> from) {
+    to.insert(to.end(), from.begin(), from.end());
+  };
+  append(data.x, columns.x);
+  append(data.y, columns.y);
+  append(data.elapsed_seconds, columns.elapsed_seconds);
+  append(data.pressure, columns.pressure);
+  append(data.tilt_radians, columns.tilt_radians);
+  append(data.orientation_radians, columns.orientation_radians);
+  size_ += count;
 
   return absl::OkStatus();
 }
@@ -319,8 +573,16 @@ absl::StatusOr<StrokeInputBatch> StrokeInputBatch::Create(
   StrokeInputBatch batch;
 
   if (!inputs.empty()) {
-    batch.data_.Emplace().reserve(inputs.size() *
-                                  FloatsPerInput(inputs.front()));
+    const StrokeInput& first = inputs.front();
+    Channels& data = batch.data_.Emplace();
+    data.x.reserve(inputs.size());
+    data.y.reserve(inputs.size());
+    data.elapsed_seconds.reserve(inputs.size());
+    if (first.HasPressure()) data.pressure.reserve(inputs.size());
+    if (first.HasTilt()) data.tilt_radians.reserve(inputs.size());
+    if (first.HasOrientation()) {
+      data.orientation_radians.reserve(inputs.size());
+    }
     if (absl::Status status = batch.Append(inputs); !status.ok()) {
       return status;
     }
@@ -349,9 +611,16 @@ absl::Status StrokeInputBatch::Append(const StrokeInputBatch& inputs) {
   // this function will be called repeatedly with relatively small batches of
   // new inputs.
 
-  std::vector<float>& data = data_.MutableValue();
-  const std::vector<float>& append_data = inputs.data_.Value();
-  data.insert(data.end(), append_data.begin(), append_data.end());
+  Channels& data = MutableChannels();
+  auto append = [](std::vector<float>& to, absl::Span<const float> from) {
+    to.insert(to.end(), from.begin(), from.end());
+  };
+  append(data.x, inputs.GetXPositions());
+  append(data.y, inputs.GetYPositions());
+  append(data.elapsed_seconds, inputs.GetElapsedTimesInSeconds());
+  append(data.pressure, inputs.GetPressures());
+  append(data.tilt_radians, inputs.GetTiltsInRadians());
+  append(data.orientation_radians, inputs.GetOrientationsInRadians());
   size_ += inputs.Size();
 
   return absl::OkStatus();
@@ -366,17 +635,47 @@ void StrokeInputBatch::Erase(size_t start, size_t count) {
     Clear();
     return;
   }
+  // Erasing from either end only narrows the range of the channels that this
+  // batch uses, so that the remaining inputs keep sharing their storage.
+  if (start == 0) {
+    offset_ += count;
+    size_ -= count;
+    return;
+  }
+  if (start + count == Size()) {
+    size_ -= count;
+    return;
+  }
 
-  std::vector<float>& data = data_.MutableValue();
-  int stride = FloatsPerInput();
-  data.erase(data.begin() + start * stride,
-             data.begin() + (start + count) * stride);
+  Channels& data = MutableChannels();
+  auto erase = [start, count](std::vector<float>& channel) {
+    if (channel.empty()) return;
+    channel.erase(channel.begin() + start, channel.begin() + start + count);
+  };
+  erase(data.x);
+  erase(data.y);
+  erase(data.elapsed_seconds);
+  erase(data.pressure);
+  erase(data.tilt_radians);
+  erase(data.orientation_radians);
   size_ -= count;
 }
 
 Duration32 StrokeInputBatch::GetDuration() const {
   if (IsEmpty()) return Duration32::Zero();
-  return Get(Size() - 1).elapsed_time - Get(0).elapsed_time;
+  absl::Span<const float> elapsed_seconds = GetElapsedTimesInSeconds();
+  return Duration32::Seconds(elapsed_seconds.back()) -
+         Duration32::Seconds(elapsed_seconds.front());
+}
+
+void StrokeInputBatch::AddToMemoryFootprint(MemoryFootprint& footprint) const {
+  if (!data_.HasValue() || !footprint.AddShared(&*data_)) return;
+  footprint.AddBytes(
+      sizeof(Channels) +
+      (data_->x.capacity() + data_->y.capacity() +
+       data_->elapsed_seconds.capacity() + data_->pressure.capacity() +
+       data_->tilt_radians.capacity() + data_->orientation_radians.capacity()) *
+          sizeof(float));
 }
 
 void StrokeInputBatch::Transform(const AffineTransform& transform,
@@ -389,13 +688,20 @@ void StrokeInputBatch::Transform(const AffineTransform& transform,
 
 void StrokeInputBatch::TransformPreservingDuration(
     const AffineTransform& transform) {
-  auto data = absl::MakeSpan(data_.MutableValue());
-  int stride = FloatsPerInput();
-  for (auto iter = data.begin(); iter != data.end(); iter += stride) {
-    Point old_position = {*iter, *(iter + 1)};
-    Point new_position = transform.Apply(old_position);
-    *iter = new_position.x;
-    *(iter + 1) = new_position.y;
+  Channels& data = MutableChannels();
+  float a = transform.A();
+  float b = transform.B();
+  float c = transform.C();
+  float d = transform.D();
+  float e = transform.E();
+  float f = transform.F();
+  // Written out over the contiguous position arrays, rather than calling
+  // `AffineTransform::Apply()` per point, so that the loop can be vectorized.
+  for (size_t i = 0; i < size_; ++i) {
+    float x = data.x[i];
+    float y = data.y[i];
+    data.x[i] = a * x + b * y + c;
+    data.y[i] = d * x + e * y + f;
   }
 }
 
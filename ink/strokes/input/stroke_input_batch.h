@@ -31,6 +31,7 @@
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/types/duration.h"
 #include "ink/types/internal/copy_on_write.h"
+#include "ink/types/memory_footprint.h"
 #include "ink/types/physical_distance.h"
 
 namespace ink {
@@ -44,7 +45,10 @@ namespace ink {
 //
 // The `StrokeInputBatch` implements copy-on-write, making it cheap to copy
 // independent of batch size. This design supports efficiently sharing the same
-// input data between multiple `Stroke` objects.
+// input data between multiple `Stroke` objects. A batch returned by `Slice()`,
+// or one whose first or last inputs were erased, also shares the data of the
+// batch it came from, so taking a sub-range of inputs copies nothing until one
+// of the batches is modified.
 //
 // Validation requirements:
 //
@@ -96,6 +100,18 @@ class StrokeInputBatch {
   // behavior.
   StrokeInputBatch MakeDeepCopy() const;
 
+  // Returns a batch holding the `count` inputs of this batch beginning at
+  // `start`, with the same format and noise seed, which shares this batch's
+  // storage rather than copying the inputs. The inputs are only copied if
+  // either batch is later modified, and then only the inputs of the modified
+  // batch.
+  //
+  // If `start` + `count` is greater than `Size()`, then all elements from
+  // `start` until the end of the batch are included. CHECK-fails if `start` is
+  // greater than `Size()`.
+  StrokeInputBatch Slice(
+      size_t start, size_t count = std::numeric_limits<size_t>::max()) const;
+
   // Validates and sets the value of the i-th input.
   //
   // In the special case that this will overwrite the only held `StrokeInput`,
@@ -120,11 +136,54 @@ class StrokeInputBatch {
   absl::Status Append(absl::Span<const StrokeInput> inputs);
   absl::Status Append(const StrokeInputBatch& inputs);
 
+  // The properties of a sequence of inputs, stored as one array per property.
+  //
+  // `x`, `y`, and `elapsed_seconds` must all have the same size, which is the
+  // number of inputs. Each of `pressure`, `tilt_radians`, and
+  // `orientation_radians` must either also have that size, or be empty to
+  // indicate that the inputs do not report that property. Sentinel values such
+  // as `StrokeInput::kNoPressure` are not permitted in a non-empty column.
+  struct InputColumns {
+    StrokeInput::ToolType tool_type = StrokeInput::ToolType::kUnknown;
+    PhysicalDistance stroke_unit_length = StrokeInput::kNoStrokeUnitLength;
+    absl::Span<const float> x;
+    absl::Span<const float> y;
+    absl::Span<const float> elapsed_seconds;
+    absl::Span<const float> pressure;
+    absl::Span<const float> tilt_radians;
+    absl::Span<const float> orientation_radians;
+  };
+
+  // Validates and appends the sequence of inputs described by `columns`.
+  //
+  // This is equivalent to calling `Append()` with the corresponding
+  // `StrokeInput` values, but validates each property in a single pass over its
+  // array and grows storage at most once per property. It is intended for
+  // platform integrations that receive input history as parallel arrays.
+  //
+  // Returns an error and does not modify the batch if validation fails.
+  absl::Status AppendColumns(const InputColumns& columns);
+
+  // Same as `AppendColumns()`, but skips validating the individual values in
+  // `columns`, e.g. that positions are finite and that elapsed times are
+  // non-decreasing. The sizes of the columns, the tool type and stroke unit
+  // length, and the compatibility of `columns` with the inputs already in the
+  // batch are still checked, so the batch remains internally consistent.
+  //
+  // This is intended for re-loading inputs that were previously validated,
+  // such as those decoded from a proto that was encoded from a
+  // `StrokeInputBatch`. If any value is out of range, the batch will not
+  // satisfy the invariants documented on `StrokeInput`.
+  absl::Status AppendTrustedColumns(const InputColumns& columns);
+
   // Erases `count` elements beginning at `start`.
   //
   // If `start` + `count` is greater than `Size()`, then all elements from
   // `start` until the end of the input batch are erased. CHECK-fails if `start`
   // is not less than or equal to `Size()`.
+  //
+  // Erasing inputs from the beginning or the end of the batch does not copy or
+  // move the remaining inputs, which keep sharing their storage; see `Slice()`.
   void Erase(size_t start, size_t count = std::numeric_limits<size_t>::max());
 
   // Returns the current input tool type or `StrokeInput::ToolType::kUnknown`
@@ -150,6 +209,21 @@ class StrokeInputBatch {
   bool HasTilt() const;
   bool HasOrientation() const;
 
+  // Each of the following returns the values of one property of every input in
+  // the batch, in order, as a contiguous array of `Size()` floats. This allows
+  // bulk operations over a property without constructing a `StrokeInput` for
+  // each element.
+  //
+  // The pressure, tilt, and orientation accessors return an empty span if the
+  // batch does not have that property. The returned spans are invalidated by
+  // calling any non-const member function of this batch.
+  absl::Span<const float> GetXPositions() const;
+  absl::Span<const float> GetYPositions() const;
+  absl::Span<const float> GetElapsedTimesInSeconds() const;
+  absl::Span<const float> GetPressures() const;
+  absl::Span<const float> GetTiltsInRadians() const;
+  absl::Span<const float> GetOrientationsInRadians() const;
+
   // Returns the seed value that should be used for seeding any noise generators
   // for brush behaviors when a full stroke is regenerated with this input
   // batch. If no seed value has yet been set for this input batch, returns the
@@ -179,28 +253,63 @@ class StrokeInputBatch {
       const AffineTransform& transform,
       TransformInvariant invariant = TransformInvariant::kPreserveDuration);
 
+  // Adds the memory held by this batch to `footprint`. The input data is
+  // shared between copies of the batch until one of them is modified, and is
+  // only counted once per `footprint` while it is shared.
+  void AddToMemoryFootprint(MemoryFootprint& footprint) const;
+
   template <typename Sink>
   friend void AbslStringify(Sink& sink, const StrokeInputBatch& batch) {
     sink.Append(batch.ToFormattedString());
   }
 
  private:
+  // Input property data, stored as one array of `size_` floats per property.
+  // The arrays for pressure, tilt, and orientation are empty if the inputs do
+  // not have that property.
+  struct Channels {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> elapsed_seconds;
+    std::vector<float> pressure;
+    std::vector<float> tilt_radians;
+    std::vector<float> orientation_radians;
+  };
+
   void DebugCheckSizeAndFormatAreConsistent() const {
-    ABSL_DCHECK_EQ(size_ * FloatsPerInput(),
-                   data_.HasValue() ? data_->size() : 0);
+    if (!data_.HasValue()) {
+      ABSL_DCHECK_EQ(size_, 0);
+      ABSL_DCHECK_EQ(offset_, 0);
+      return;
+    }
+    size_t end = offset_ + size_;
+    ABSL_DCHECK_GE(data_->x.size(), end);
+    ABSL_DCHECK_EQ(data_->y.size(), data_->x.size());
+    ABSL_DCHECK_EQ(data_->elapsed_seconds.size(), data_->x.size());
+    ABSL_DCHECK_EQ(data_->pressure.size(),
+                   has_pressure_ ? data_->x.size() : 0);
+    ABSL_DCHECK_EQ(data_->tilt_radians.size(), has_tilt_ ? data_->x.size() : 0);
+    ABSL_DCHECK_EQ(data_->orientation_radians.size(),
+                   has_orientation_ ? data_->x.size() : 0);
   }
 
-  // The following helpers return the number of floats needed to store the
-  // numeric properties of a single `StrokeInput` when the missing optional
-  // properties are skipped instead of being stored as sentinel values.
-  //
-  // The returned value will be at least 3 - the case when storing only position
-  // and elapsed time. It will be no more than 6, which is the number required
-  // to store an input with all of pressure, tilt, and orientation present.
-  static int FloatsPerInput(bool has_pressure, bool has_tilt,
-                            bool has_orientation);
-  static int FloatsPerInput(const StrokeInput& input);
-  int FloatsPerInput() const;
+  // Returns the part of `channel`, one of the channels of `data_`, that holds
+  // the inputs of this batch, or an empty span if `channel` is empty.
+  absl::Span<const float> ChannelRange(
+      const std::vector<float>& channel) const {
+    if (channel.empty()) return {};
+    return absl::MakeConstSpan(channel.data() + offset_, size_);
+  }
+
+  // Returns the channels of this batch for modification, which must have a
+  // value. Shared channels are copied first, as by `CopyOnWrite`, and channels
+  // that hold inputs outside of this batch are trimmed or copied so that they
+  // hold exactly the `size_` inputs of this batch, and `offset_` is zero.
+  Channels& MutableChannels();
+
+  // Returns a copy of just the part of the channels that holds the inputs of
+  // this batch.
+  Channels CopyChannelRange() const;
 
   // Transforms the input points in place, applying the `AffineTransform` while
   // keeping the stroke total elapsed time the same.
@@ -211,24 +320,27 @@ class StrokeInputBatch {
   // This function should only be called when the batch is empty.
   void SetInlineFormatMetadata(const StrokeInput& input);
 
+  // Appends the property values of `input` to `data_`, which must have a
+  // value. The format metadata must already match `input`. Does not update
+  // `size_`.
+  void AppendInputData(const StrokeInput& input);
+
+  // Implementation of `AppendColumns()` and `AppendTrustedColumns()`.
+  absl::Status AppendColumnsImpl(const InputColumns& columns,
+                                 bool validate_values);
+
   // Implementation helper for AbslStringify.
   std::string ToFormattedString() const;
 
-  // Input property data stored as raw floats, using `FloatsPerInput()` values
-  // per `StrokeInput`.
-  //
-  // Values for each input are stored at adjacent indices in the following
-  // order:
-  //   * position x
-  //   * position y
-  //   * elapsed time in seconds
-  //   * pressure, only if `has_pressure_`
-  //   * tilt in radians, only if `has_tilt_`
-  //   * orientation in radians, only if `has_orientation_`
-  //
-  // TODO: b/295885521 - Replace with either `CopyOnWrite<T[]>` or a
-  // `CopyOnWriteArray` to remove the extra indirection.
-  ink_internal::CopyOnWrite<std::vector<float>> data_;
+  // TODO: b/295885521 - Consider replacing with a single allocation holding
+  // every channel to remove the extra indirections.
+  ink_internal::CopyOnWrite<Channels> data_;
+
+  // The inputs of this batch are the `size_` elements of each channel of
+  // `data_` beginning at `offset_`. The channels may hold more inputs, before
+  // or after those, when the storage is shared with other batches, or when
+  // inputs were erased from the beginning or end of this batch.
+  size_t offset_ = 0;
 
   // Store metadata inline so that simple getters do not need an extra branch
   // and pointer indirection:
@@ -276,16 +388,15 @@ class StrokeInputBatch::ConstIterator {
  private:
   friend class StrokeInputBatch;
 
-  ConstIterator(const StrokeInputBatch& inputs, size_t index) {
-    if (!inputs.data_.HasValue()) return;
-    batch_subdata_ = absl::MakeSpan(inputs.data_.Value())
-                         .subspan(index * inputs.FloatsPerInput());
+  ConstIterator(const StrokeInputBatch& inputs, size_t index)
+      : batch_(&inputs), index_(index) {
     if (index < inputs.Size()) value_ = inputs.Get(index);
   }
 
-  // Subspan of batch `data_` from the current position of the iterator to the
-  // end of the container.
-  absl::Span<const float> batch_subdata_;
+  // The batch being iterated over and the index of the current input, or null
+  // and zero for a default-constructed iterator.
+  const StrokeInputBatch* batch_ = nullptr;
+  size_t index_ = 0;
 
   // In order to have operator-> work in a sensible manner, it needs to return
   // a pointer to the value type. To accomplish this, since the value type is
@@ -347,9 +458,41 @@ inline bool StrokeInputBatch::HasOrientation() const {
   return has_orientation_;
 }
 
+inline absl::Span<const float> StrokeInputBatch::GetXPositions() const {
+  if (!data_.HasValue()) return {};
+  return ChannelRange(data_->x);
+}
+
+inline absl::Span<const float> StrokeInputBatch::GetYPositions() const {
+  if (!data_.HasValue()) return {};
+  return ChannelRange(data_->y);
+}
+
+inline absl::Span<const float> StrokeInputBatch::GetElapsedTimesInSeconds()
+    const {
+  if (!data_.HasValue()) return {};
+  return ChannelRange(data_->elapsed_seconds);
+}
+
+inline absl::Span<const float> StrokeInputBatch::GetPressures() const {
+  if (!data_.HasValue()) return {};
+  return ChannelRange(data_->pressure);
+}
+
+inline absl::Span<const float> StrokeInputBatch::GetTiltsInRadians() const {
+  if (!data_.HasValue()) return {};
+  return ChannelRange(data_->tilt_radians);
+}
+
+inline absl::Span<const float> StrokeInputBatch::GetOrientationsInRadians()
+    const {
+  if (!data_.HasValue()) return {};
+  return ChannelRange(data_->orientation_radians);
+}
+
 inline StrokeInputBatch::ConstIterator::pointer
 StrokeInputBatch::ConstIterator::operator->() const {
-  ABSL_DCHECK(!batch_subdata_.empty())
+  ABSL_DCHECK(batch_ != nullptr && index_ < batch_->Size())
       << "Attempted to dereference singular or past-the-end iterator";
   return &value_;
 }
@@ -362,24 +505,7 @@ StrokeInputBatch::ConstIterator::operator*() const {
 
 inline bool operator==(const StrokeInputBatch::ConstIterator& lhs,
                        const StrokeInputBatch::ConstIterator& rhs) {
-  return lhs.batch_subdata_.data() == rhs.batch_subdata_.data();
-}
-
-inline int StrokeInputBatch::FloatsPerInput(bool has_pressure, bool has_tilt,
-                                            bool has_orientation) {
-  // Minimum of 3 floats (two for position and one elapsed time) plus one for
-  // each present optional property:
-  return 3 + static_cast<int>(has_pressure) + static_cast<int>(has_tilt) +
-         static_cast<int>(has_orientation);
-}
-
-inline int StrokeInputBatch::FloatsPerInput(const StrokeInput& input) {
-  return FloatsPerInput(input.HasPressure(), input.HasTilt(),
-                        input.HasOrientation());
-}
-
-inline int StrokeInputBatch::FloatsPerInput() const {
-  return FloatsPerInput(has_pressure_, has_tilt_, has_orientation_);
+  return lhs.batch_ == rhs.batch_ && lhs.index_ == rhs.index_;
 }
 
 }  // namespace ink
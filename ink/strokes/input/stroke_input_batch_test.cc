@@ -15,7 +15,9 @@
 #include "ink/strokes/input/stroke_input_batch.h"
 
 #include <cmath>
+#include <cstddef>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -25,16 +27,19 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/angle.h"
 #include "ink/strokes/input/fuzz_domains.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/type_matchers.h"
 #include "ink/types/duration.h"
+#include "ink/types/memory_footprint.h"
 #include "ink/types/physical_distance.h"
 
 namespace ink {
 namespace {
 
+using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
 
 std::vector<StrokeInput> MakeValidTestInputSequence(
@@ -1552,6 +1557,117 @@ TEST(StrokeInputBatch, DeepCopy) {
   EXPECT_TRUE(batch->IsEmpty());
 }
 
+TEST(StrokeInputBatchTest, SliceSharesStorage) {
+  std::vector<StrokeInput> input_vector = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(input_vector, /*noise_seed=*/42);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  StrokeInputBatch slice = batch->Slice(1, 3);
+  EXPECT_THAT(slice, StrokeInputBatchIsArray(absl::MakeConstSpan(
+                         input_vector.data() + 1, 3)));
+  EXPECT_EQ(slice.GetNoiseSeed(), 42);
+  EXPECT_EQ(slice.GetXPositions().data(), batch->GetXPositions().data() + 1);
+  EXPECT_EQ(slice.GetPressures().data(), batch->GetPressures().data() + 1);
+  EXPECT_EQ(slice.GetDuration(), Duration32::Seconds(2));
+
+  // The shared storage is only counted once.
+  MemoryFootprint footprint;
+  batch->AddToMemoryFootprint(footprint);
+  size_t batch_bytes = footprint.TotalBytes();
+  slice.AddToMemoryFootprint(footprint);
+  EXPECT_EQ(footprint.TotalBytes(), batch_bytes);
+}
+
+TEST(StrokeInputBatchTest, SliceWithCountPastEnd) {
+  std::vector<StrokeInput> input_vector = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(input_vector);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  EXPECT_THAT(batch->Slice(3), StrokeInputBatchIsArray({input_vector[3],
+                                                        input_vector[4]}));
+  EXPECT_THAT(batch->Slice(0), StrokeInputBatchEq(*batch));
+}
+
+TEST(StrokeInputBatchTest, EmptySliceKeepsFormat) {
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(MakeValidTestInputSequence(), /*noise_seed=*/7);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  StrokeInputBatch slice = batch->Slice(2, 0);
+  EXPECT_TRUE(slice.IsEmpty());
+  EXPECT_EQ(slice.GetToolType(), StrokeInput::ToolType::kStylus);
+  EXPECT_TRUE(slice.HasPressure());
+  EXPECT_EQ(slice.GetNoiseSeed(), 7);
+  EXPECT_TRUE(slice.GetXPositions().empty());
+}
+
+TEST(StrokeInputBatchTest, ModifyingSliceCopiesOnlyItsInputs) {
+  std::vector<StrokeInput> input_vector = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(input_vector);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  StrokeInputBatch slice = batch->Slice(1, 2);
+  StrokeInput next = input_vector[2];
+  next.position = {20, 30};
+  next.elapsed_time = Duration32::Seconds(10);
+  ASSERT_EQ(slice.Append(next), absl::OkStatus());
+
+  EXPECT_THAT(slice, StrokeInputBatchIsArray(
+                         {input_vector[1], input_vector[2], next}));
+  EXPECT_THAT(*batch, StrokeInputBatchIsArray(input_vector));
+  MemoryFootprint footprint;
+  slice.AddToMemoryFootprint(footprint);
+  MemoryFootprint batch_footprint;
+  batch->AddToMemoryFootprint(batch_footprint);
+  EXPECT_LT(footprint.TotalBytes(), batch_footprint.TotalBytes());
+
+  // Modifying the original batch leaves an unmodified slice intact, too.
+  StrokeInputBatch other_slice = batch->Slice(3);
+  batch->Transform(AffineTransform::Translate({1, 1}));
+  EXPECT_THAT(other_slice,
+              StrokeInputBatchIsArray({input_vector[3], input_vector[4]}));
+}
+
+TEST(StrokeInputBatchTest, EraseFromEndsKeepsSharingStorage) {
+  std::vector<StrokeInput> input_vector = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(input_vector);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  StrokeInputBatch copy = *batch;
+  copy.Erase(0, 1);
+  copy.Erase(3);
+  EXPECT_THAT(copy, StrokeInputBatchIsArray(
+                        {input_vector[1], input_vector[2], input_vector[3]}));
+  EXPECT_EQ(copy.GetXPositions().data(), batch->GetXPositions().data() + 1);
+
+  // Appending to a uniquely owned batch reuses its storage.
+  batch->Erase(0, 2);
+  batch->Erase(2);
+  StrokeInput next = input_vector[4];
+  next.elapsed_time = Duration32::Seconds(10);
+  ASSERT_EQ(batch->Append(next), absl::OkStatus());
+  EXPECT_THAT(*batch, StrokeInputBatchIsArray(
+                          {input_vector[2], input_vector[3], next}));
+  EXPECT_THAT(copy, StrokeInputBatchIsArray(
+                        {input_vector[1], input_vector[2], input_vector[3]}));
+}
+
+TEST(StrokeInputBatchTest, DeepCopyOfSlice) {
+  std::vector<StrokeInput> input_vector = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(input_vector);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  StrokeInputBatch copy = batch->Slice(2, 2).MakeDeepCopy();
+  EXPECT_THAT(copy,
+              StrokeInputBatchIsArray({input_vector[2], input_vector[3]}));
+  EXPECT_NE(copy.GetXPositions().data(), batch->GetXPositions().data() + 2);
+}
+
 TEST(StrokeInputBatchDeathTest, SetWithIndexOutOfBounds) {
   absl::StatusOr<StrokeInputBatch> batch =
       StrokeInputBatch::Create(MakeValidTestInputSequence());
@@ -1573,5 +1689,376 @@ TEST(StrokeInputBatchDeathTest, EraseWithStartOutOfBounds) {
   EXPECT_DEATH_IF_SUPPORTED(batch->Erase(batch->Size() + 1, 1), "");
 }
 
+// Checks that each column span agrees with the corresponding field of every
+// input returned by `Get()`.
+void ExpectSpansMatchInputs(const StrokeInputBatch& batch) {
+  ASSERT_EQ(batch.GetXPositions().size(), batch.Size());
+  ASSERT_EQ(batch.GetYPositions().size(), batch.Size());
+  ASSERT_EQ(batch.GetElapsedTimesInSeconds().size(), batch.Size());
+  ASSERT_EQ(batch.GetPressures().size(),
+            batch.HasPressure() ? batch.Size() : 0);
+  ASSERT_EQ(batch.GetTiltsInRadians().size(),
+            batch.HasTilt() ? batch.Size() : 0);
+  ASSERT_EQ(batch.GetOrientationsInRadians().size(),
+            batch.HasOrientation() ? batch.Size() : 0);
+  for (int i = 0; i < batch.Size(); ++i) {
+    StrokeInput input = batch.Get(i);
+    EXPECT_EQ(batch.GetXPositions()[i], input.position.x);
+    EXPECT_EQ(batch.GetYPositions()[i], input.position.y);
+    EXPECT_EQ(batch.GetElapsedTimesInSeconds()[i],
+              input.elapsed_time.ToSeconds());
+    if (batch.HasPressure()) {
+      EXPECT_EQ(batch.GetPressures()[i], input.pressure);
+    }
+    if (batch.HasTilt()) {
+      EXPECT_EQ(batch.GetTiltsInRadians()[i], input.tilt.ValueInRadians());
+    }
+    if (batch.HasOrientation()) {
+      EXPECT_EQ(batch.GetOrientationsInRadians()[i],
+                input.orientation.ValueInRadians());
+    }
+  }
+}
+
+TEST(StrokeInputBatchTest, SpansAreEmptyForEmptyBatch) {
+  StrokeInputBatch batch;
+  EXPECT_TRUE(batch.GetXPositions().empty());
+  EXPECT_TRUE(batch.GetYPositions().empty());
+  EXPECT_TRUE(batch.GetElapsedTimesInSeconds().empty());
+  EXPECT_TRUE(batch.GetPressures().empty());
+  EXPECT_TRUE(batch.GetTiltsInRadians().empty());
+  EXPECT_TRUE(batch.GetOrientationsInRadians().empty());
+}
+
+TEST(StrokeInputBatchTest, SpansMatchInputs) {
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(MakeValidTestInputSequence());
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+  ExpectSpansMatchInputs(*batch);
+}
+
+TEST(StrokeInputBatchTest, SpansForAbsentOptionalPropertiesAreEmpty) {
+  std::vector<StrokeInput> inputs = MakeValidTestInputSequence();
+  for (StrokeInput& input : inputs) {
+    input.pressure = StrokeInput::kNoPressure;
+    input.tilt = StrokeInput::kNoTilt;
+    input.orientation = StrokeInput::kNoOrientation;
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+  EXPECT_EQ(batch->GetXPositions().size(), inputs.size());
+  EXPECT_TRUE(batch->GetPressures().empty());
+  EXPECT_TRUE(batch->GetTiltsInRadians().empty());
+  EXPECT_TRUE(batch->GetOrientationsInRadians().empty());
+  ExpectSpansMatchInputs(*batch);
+}
+
+TEST(StrokeInputBatchTest, SpansMatchInputsAfterAppendEraseAndTransform) {
+  std::vector<StrokeInput> inputs = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(
+      absl::MakeConstSpan(inputs).subspan(0, 2));
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  ASSERT_EQ(batch->Append(absl::MakeConstSpan(inputs).subspan(2)),
+            absl::OkStatus());
+  ExpectSpansMatchInputs(*batch);
+
+  batch->Erase(1, 2);
+  EXPECT_EQ(batch->Size(), inputs.size() - 2);
+  ExpectSpansMatchInputs(*batch);
+
+  batch->Transform(AffineTransform::Translate({3, -4}));
+  EXPECT_EQ(batch->GetXPositions()[0], inputs[0].position.x + 3);
+  EXPECT_EQ(batch->GetYPositions()[0], inputs[0].position.y - 4);
+  ExpectSpansMatchInputs(*batch);
+}
+
+TEST(StrokeInputBatchTest, SpansOfCopyAreUnchangedByWritesToOriginal) {
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(MakeValidTestInputSequence());
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+  StrokeInputBatch copy = *batch;
+  float original_x = copy.GetXPositions()[0];
+
+  batch->Transform(AffineTransform::Translate({100, 0}));
+  EXPECT_EQ(copy.GetXPositions()[0], original_x);
+  EXPECT_EQ(batch->GetXPositions()[0], original_x + 100);
+}
+
+TEST(StrokeInputBatchTest, MemoryFootprint) {
+  MemoryFootprint empty_footprint;
+  StrokeInputBatch().AddToMemoryFootprint(empty_footprint);
+  EXPECT_EQ(empty_footprint.TotalBytes(), 0u);
+
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(MakeValidTestInputSequence());
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+  MemoryFootprint footprint;
+  batch->AddToMemoryFootprint(footprint);
+  size_t bytes = footprint.TotalBytes();
+  EXPECT_GE(bytes, batch->Size() * 3 * sizeof(float));
+
+  // A copy shares its data with the original until one of them is modified.
+  StrokeInputBatch copy = *batch;
+  copy.AddToMemoryFootprint(footprint);
+  EXPECT_EQ(footprint.TotalBytes(), bytes);
+  copy.Transform(AffineTransform::Translate({100, 0}));
+  copy.AddToMemoryFootprint(footprint);
+  EXPECT_GT(footprint.TotalBytes(), bytes);
+}
+
+// Owns the per-property arrays for a sequence of inputs, for use with
+// `StrokeInputBatch::AppendColumns()`.
+struct TestColumns {
+  explicit TestColumns(absl::Span<const StrokeInput> inputs) {
+    if (!inputs.empty()) {
+      tool_type = inputs.front().tool_type;
+      stroke_unit_length = inputs.front().stroke_unit_length;
+    }
+    for (const StrokeInput& input : inputs) {
+      x.push_back(input.position.x);
+      y.push_back(input.position.y);
+      elapsed_seconds.push_back(input.elapsed_time.ToSeconds());
+      if (input.HasPressure()) pressure.push_back(input.pressure);
+      if (input.HasTilt()) tilt.push_back(input.tilt.ValueInRadians());
+      if (input.HasOrientation()) {
+        orientation.push_back(input.orientation.ValueInRadians());
+      }
+    }
+  }
+
+  StrokeInputBatch::InputColumns Columns() const {
+    return {.tool_type = tool_type,
+            .stroke_unit_length = stroke_unit_length,
+            .x = x,
+            .y = y,
+            .elapsed_seconds = elapsed_seconds,
+            .pressure = pressure,
+            .tilt_radians = tilt,
+            .orientation_radians = orientation};
+  }
+
+  StrokeInput::ToolType tool_type = StrokeInput::ToolType::kUnknown;
+  PhysicalDistance stroke_unit_length = StrokeInput::kNoStrokeUnitLength;
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> elapsed_seconds;
+  std::vector<float> pressure;
+  std::vector<float> tilt;
+  std::vector<float> orientation;
+};
+
+TEST(StrokeInputBatchTest, AppendColumnsToEmpty) {
+  std::vector<StrokeInput> inputs = MakeValidTestInputSequence();
+  TestColumns columns(inputs);
+
+  StrokeInputBatch batch;
+  ASSERT_EQ(batch.AppendColumns(columns.Columns()), absl::OkStatus());
+  EXPECT_THAT(batch, StrokeInputBatchIsArray(inputs));
+  ExpectSpansMatchInputs(batch);
+}
+
+TEST(StrokeInputBatchTest, AppendColumnsToNonEmpty) {
+  std::vector<StrokeInput> inputs = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(
+      absl::MakeConstSpan(inputs).subspan(0, 2));
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  TestColumns columns(absl::MakeConstSpan(inputs).subspan(2));
+  ASSERT_EQ(batch->AppendColumns(columns.Columns()), absl::OkStatus());
+  EXPECT_THAT(*batch, StrokeInputBatchIsArray(inputs));
+}
+
+TEST(StrokeInputBatchTest, AppendColumnsWithoutOptionalProperties) {
+  std::vector<StrokeInput> inputs =
+      MakeValidTestInputSequence(StrokeInput::ToolType::kMouse);
+  for (StrokeInput& input : inputs) {
+    input.stroke_unit_length = StrokeInput::kNoStrokeUnitLength;
+    input.pressure = StrokeInput::kNoPressure;
+    input.tilt = StrokeInput::kNoTilt;
+    input.orientation = StrokeInput::kNoOrientation;
+  }
+  TestColumns columns(inputs);
+
+  StrokeInputBatch batch;
+  ASSERT_EQ(batch.AppendColumns(columns.Columns()), absl::OkStatus());
+  EXPECT_THAT(batch, StrokeInputBatchIsArray(inputs));
+  EXPECT_EQ(batch.GetToolType(), StrokeInput::ToolType::kMouse);
+  EXPECT_FALSE(batch.HasStrokeUnitLength());
+  EXPECT_FALSE(batch.HasPressure());
+  EXPECT_FALSE(batch.HasTilt());
+  EXPECT_FALSE(batch.HasOrientation());
+}
+
+TEST(StrokeInputBatchTest, AppendColumnsWithNoInputs) {
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(MakeValidTestInputSequence());
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+  StrokeInputBatch original = batch->MakeDeepCopy();
+
+  ASSERT_EQ(batch->AppendColumns({}), absl::OkStatus());
+  EXPECT_THAT(*batch, StrokeInputBatchEq(original));
+}
+
+TEST(StrokeInputBatchTest, AppendColumnsWithMismatchedSizes) {
+  TestColumns columns(MakeValidTestInputSequence());
+  {
+    TestColumns short_y = columns;
+    short_y.y.pop_back();
+    StrokeInputBatch batch;
+    absl::Status status = batch.AppendColumns(short_y.Columns());
+    EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+    EXPECT_THAT(status.message(), HasSubstr("same size"));
+    EXPECT_TRUE(batch.IsEmpty());
+  }
+  {
+    TestColumns short_pressure = columns;
+    short_pressure.pressure.pop_back();
+    StrokeInputBatch batch;
+    absl::Status status = batch.AppendColumns(short_pressure.Columns());
+    EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+    EXPECT_THAT(status.message(), HasSubstr("pressure"));
+    EXPECT_TRUE(batch.IsEmpty());
+  }
+}
+
+TEST(StrokeInputBatchTest, AppendColumnsReportsSameErrorsAsAppend) {
+  std::vector<StrokeInput> valid_inputs = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> prefix = StrokeInputBatch::Create(
+      absl::MakeConstSpan(valid_inputs).subspan(0, 1));
+  ASSERT_EQ(prefix.status(), absl::OkStatus());
+
+  std::vector<std::vector<StrokeInput>> invalid_sequences;
+  {
+    std::vector<StrokeInput> inputs = valid_inputs;
+    inputs[3].position.x = std::numeric_limits<float>::infinity();
+    invalid_sequences.push_back(inputs);
+  }
+  {
+    std::vector<StrokeInput> inputs = valid_inputs;
+    inputs[2].elapsed_time = Duration32::Seconds(1);
+    invalid_sequences.push_back(inputs);
+  }
+  {
+    std::vector<StrokeInput> inputs = valid_inputs;
+    inputs[4] = inputs[3];
+    invalid_sequences.push_back(inputs);
+  }
+  {
+    std::vector<StrokeInput> inputs = valid_inputs;
+    inputs[2].pressure = 1.5;
+    invalid_sequences.push_back(inputs);
+  }
+  {
+    std::vector<StrokeInput> inputs = valid_inputs;
+    inputs[1].tilt = Angle::Radians(2);
+    invalid_sequences.push_back(inputs);
+  }
+  {
+    std::vector<StrokeInput> inputs = valid_inputs;
+    inputs[4].orientation = Angle::Radians(std::nanf(""));
+    invalid_sequences.push_back(inputs);
+  }
+
+  for (const std::vector<StrokeInput>& inputs : invalid_sequences) {
+    absl::Span<const StrokeInput> appended =
+        absl::MakeConstSpan(inputs).subspan(1);
+    StrokeInputBatch append_batch = prefix->MakeDeepCopy();
+    absl::Status append_status = append_batch.Append(appended);
+    ASSERT_EQ(append_status.code(), absl::StatusCode::kInvalidArgument);
+
+    StrokeInputBatch columns_batch = prefix->MakeDeepCopy();
+    TestColumns columns(appended);
+    EXPECT_EQ(columns_batch.AppendColumns(columns.Columns()), append_status);
+    EXPECT_THAT(columns_batch, StrokeInputBatchEq(*prefix));
+  }
+}
+
+TEST(StrokeInputBatchTest, AppendColumnsWithInconsistentFormat) {
+  absl::StatusOr<StrokeInputBatch> batch =
+      StrokeInputBatch::Create(MakeValidTestInputSequence());
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+  StrokeInput next = batch->Get(batch->Size() - 1);
+  next.elapsed_time += Duration32::Seconds(1);
+
+  TestColumns columns({next});
+  columns.pressure.clear();
+  absl::Status status = batch->AppendColumns(columns.Columns());
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("pressure"));
+  EXPECT_EQ(batch->Size(), MakeValidTestInputSequence().size());
+}
+
+TEST(StrokeInputBatchTest, AppendColumnsWithSentinelValuesInColumn) {
+  TestColumns columns(MakeValidTestInputSequence());
+  for (float& pressure : columns.pressure) {
+    pressure = StrokeInput::kNoPressure;
+  }
+
+  StrokeInputBatch batch;
+  absl::Status status = batch.AppendColumns(columns.Columns());
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("sentinel"));
+  EXPECT_TRUE(batch.IsEmpty());
+}
+
+TEST(StrokeInputBatchTest, AppendTrustedColumnsMatchesAppendColumns) {
+  std::vector<StrokeInput> inputs = MakeValidTestInputSequence();
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(
+      absl::MakeConstSpan(inputs).subspan(0, 2));
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  TestColumns columns(absl::MakeConstSpan(inputs).subspan(2));
+  ASSERT_EQ(batch->AppendTrustedColumns(columns.Columns()), absl::OkStatus());
+  EXPECT_THAT(*batch, StrokeInputBatchIsArray(inputs));
+  ExpectSpansMatchInputs(*batch);
+}
+
+TEST(StrokeInputBatchTest, AppendTrustedColumnsSkipsValueValidation) {
+  TestColumns columns(MakeValidTestInputSequence());
+  std::swap(columns.elapsed_seconds[1], columns.elapsed_seconds[2]);
+
+  StrokeInputBatch batch;
+  EXPECT_EQ(batch.AppendColumns(columns.Columns()).code(),
+            absl::StatusCode::kInvalidArgument);
+  ASSERT_EQ(batch.AppendTrustedColumns(columns.Columns()), absl::OkStatus());
+  EXPECT_EQ(batch.Size(), columns.x.size());
+  EXPECT_THAT(batch.GetElapsedTimesInSeconds(),
+              ElementsAreArray(columns.elapsed_seconds));
+}
+
+TEST(StrokeInputBatchTest, AppendTrustedColumnsStillChecksFormat) {
+  TestColumns columns(MakeValidTestInputSequence());
+  {
+    TestColumns short_x = columns;
+    short_x.x.pop_back();
+    StrokeInputBatch batch;
+    absl::Status status = batch.AppendTrustedColumns(short_x.Columns());
+    EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+    EXPECT_THAT(status.message(), HasSubstr("same size"));
+    EXPECT_TRUE(batch.IsEmpty());
+  }
+  {
+    // A sentinel in the first row would otherwise make the batch think that
+    // pressure isn't reported, while still appending the pressure column.
+    TestColumns first_pressure_missing = columns;
+    first_pressure_missing.pressure[0] = StrokeInput::kNoPressure;
+    StrokeInputBatch batch;
+    absl::Status status =
+        batch.AppendTrustedColumns(first_pressure_missing.Columns());
+    EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+    EXPECT_THAT(status.message(), HasSubstr("sentinel"));
+    EXPECT_TRUE(batch.IsEmpty());
+  }
+  {
+    TestColumns bad_unit_length = columns;
+    bad_unit_length.stroke_unit_length = PhysicalDistance::Centimeters(-1);
+    StrokeInputBatch batch;
+    EXPECT_EQ(batch.AppendTrustedColumns(bad_unit_length.Columns()).code(),
+              absl::StatusCode::kInvalidArgument);
+    EXPECT_TRUE(batch.IsEmpty());
+  }
+}
+
 }  // namespace
 }  // namespace ink
@@ -29,6 +29,7 @@
 #include "ink/geometry/envelope.h"
 #include "ink/geometry/mutable_mesh.h"
 #include "ink/geometry/point.h"
+#include "ink/strokes/internal/brush_tip_extruder/extruded_vertex.h"
 #include "ink/strokes/internal/brush_tip_extruder/geometry.h"
 #include "ink/strokes/internal/brush_tip_extruder/mutable_mesh_view.h"
 #include "ink/strokes/internal/brush_tip_extruder/side.h"
@@ -38,11 +39,14 @@
 #include "ink/strokes/internal/constrain_brush_tip_extrusion.h"
 #include "ink/strokes/internal/extrusion_points.h"
 #include "ink/strokes/internal/stroke_outline.h"
+#include "ink/strokes/internal/stroke_shape_stats_timer.h"
 #include "ink/strokes/internal/stroke_shape_update.h"
+#include "ink/strokes/stroke_shape_stats.h"
 
 namespace ink::strokes_internal {
 namespace {
 
+using ::ink::brush_tip_extruder_internal::ExtrudedVertex;
 using ::ink::brush_tip_extruder_internal::Geometry;
 using ::ink::brush_tip_extruder_internal::MutableMeshView;
 using ::ink::brush_tip_extruder_internal::Side;
@@ -55,6 +59,12 @@ float GetSimplificationThreshold(float brush_epsilon) { return brush_epsilon; }
 
 }  // namespace
 
+void BrushTipExtruder::CopyStateFrom(const BrushTipExtruder& other,
+                                     MutableMesh& mesh) {
+  *this = other;
+  geometry_.RebindMesh(mesh);
+}
+
 void BrushTipExtruder::StartStroke(float brush_epsilon,
                                    bool is_stamping_texture_particle_brush,
                                    MutableMesh& mesh) {
@@ -66,8 +76,24 @@ void BrushTipExtruder::StartStroke(float brush_epsilon,
   extrusions_.clear();
   saved_extrusion_data_count_ = 0;
   deleted_save_point_extrusions_.clear();
+  extruding_volatile_states_ = false;
+  volatile_extrusion_color_sources_.clear();
+  last_volatile_states_.clear();
+  volatile_extrusions_are_recolorable_ = false;
   geometry_.Reset(MutableMeshView(mesh));
+  if (budget_.max_retriangulated_triangles_per_tip_state ==
+      StrokeShapeBudget::kUnlimited) {
+    geometry_.SetIntersectionHandling(Geometry::IntersectionHandling::kEnabled);
+  } else {
+    geometry_.SetAdaptiveRetriangulationBudget(
+        budget_.max_retriangulated_triangles_per_tip_state);
+    geometry_.SetIntersectionHandling(
+        Geometry::IntersectionHandling::kAdaptive);
+  }
+  exceeded_geometry_budget_ = false;
+  exceeded_work_budget_ = false;
   bounds_ = {};
+  extrusion_break_bounds_.clear();
   // Pre-allocate the first outline.
   num_outlines_ = 1;
   if (outlines_.empty()) {
@@ -114,9 +140,42 @@ StrokeShapeUpdate BrushTipExtruder::ExtendStroke(
       geometry_.GetMeshView().TriangleCount();
   uint32_t vertex_count_before_update = geometry_.GetMeshView().VertexCount();
 
+  last_update_stats_ = {};
+  {
+    ScopedStatsTimer timer(last_update_stats_.extrusion_nanos);
+    ExtendGeometry(new_fixed_states, volatile_states);
+  }
+  RecordLastUpdateStats(triangle_count_before_update,
+                        vertex_count_before_update);
+
+  return ConstructUpdate(geometry_, triangle_count_before_update,
+                         vertex_count_before_update);
+}
+
+void BrushTipExtruder::ExtendGeometry(
+    absl::Span<const BrushTipState> new_fixed_states,
+    absl::Span<const BrushTipState> volatile_states) {
+  if (CanRecolorVolatileExtrusions(new_fixed_states, volatile_states)) {
+    // Positions and triangles are unchanged, so the bounds, outlines, and
+    // derivatives are too.
+    RecolorVolatileExtrusions(volatile_states);
+    return;
+  }
+
   Restore();
 
+  if (!exceeded_work_budget_ &&
+      new_fixed_states.size() + volatile_states.size() >
+          budget_.max_tip_states_per_update) {
+    // This is done after `Restore()` and before `Save()`, so that neither the
+    // reverted nor the saved state has an ongoing self-intersection.
+    exceeded_work_budget_ = true;
+    geometry_.SetIntersectionHandling(
+        Geometry::IntersectionHandling::kDisabled);
+  }
+
   for (size_t i = 0; i < new_fixed_states.size(); ++i) {
+    if (!HasGeometryBudgetRemaining()) break;
     const BrushTipState& tip_state = new_fixed_states[i];
     Extrude(tip_state, /* is_volatile_state = */ false,
             volatile_states.empty() && i == new_fixed_states.size() - 1);
@@ -125,23 +184,77 @@ StrokeShapeUpdate BrushTipExtruder::ExtendStroke(
   UpdateCachedPartialBounds();
   Save();
 
+  extruding_volatile_states_ = true;
+  volatile_extrusions_are_recolorable_ = true;
   for (size_t i = 0; i < volatile_states.size(); ++i) {
+    if (!HasGeometryBudgetRemaining()) break;
     const BrushTipState& tip_state = volatile_states[i];
+    current_volatile_state_index_ = i;
     Extrude(tip_state, /* is_volatile_state = */ true,
             i == volatile_states.size() - 1);
   }
 
   ExtrudeBreakPoint();
-  geometry_.UpdateMeshDerivatives();
+  extruding_volatile_states_ = false;
+  last_volatile_states_.assign(volatile_states.begin(), volatile_states.end());
+  volatile_extrusions_are_recolorable_ =
+      volatile_extrusions_are_recolorable_ &&
+      geometry_.CanRecolorSinceSavePoint();
+
+  {
+    ScopedStatsTimer timer(last_update_stats_.derivative_update_nanos);
+    geometry_.UpdateMeshDerivatives();
+  }
   UpdateCurrentBounds();
-  return ConstructUpdate(geometry_, triangle_count_before_update,
-                         vertex_count_before_update);
+}
+
+bool BrushTipExtruder::HasGeometryBudgetRemaining() {
+  if (exceeded_geometry_budget_) return false;
+  if (geometry_.GetMeshView().VertexCount() < budget_.max_vertices_per_coat &&
+      geometry_.ExtrusionBreakCount() < budget_.max_outlines_per_coat) {
+    return true;
+  }
+  exceeded_geometry_budget_ = true;
+  return false;
+}
+
+void BrushTipExtruder::RecordLastUpdateStats(
+    uint32_t triangle_count_before_update,
+    uint32_t vertex_count_before_update) {
+  if constexpr (!kStrokeShapeStatsEnabled) return;
+
+  const StrokeShapeStats& geometry_stats = geometry_.GetStats();
+  const MutableMeshView& mesh_view = geometry_.GetMeshView();
+  StrokeShapeStats& stats = last_update_stats_;
+  // The extrusion timer also covered the derivative update.
+  stats.extrusion_nanos -= stats.derivative_update_nanos;
+  stats.intersection_handling_nanos =
+      geometry_stats.intersection_handling_nanos;
+  stats.simplification_nanos = geometry_stats.simplification_nanos;
+  stats.vertices_reverted = geometry_stats.vertices_reverted;
+  stats.triangles_reverted = geometry_stats.triangles_reverted;
+  stats.vertices_simplified_away = geometry_stats.vertices_simplified_away;
+  stats.intersection_handling_fallbacks =
+      geometry_stats.intersection_handling_fallbacks;
+  stats.vertices_appended = static_cast<int64_t>(mesh_view.VertexCount()) -
+                            vertex_count_before_update +
+                            stats.vertices_reverted;
+  stats.triangles_appended = static_cast<int64_t>(mesh_view.TriangleCount()) -
+                             triangle_count_before_update +
+                             stats.triangles_reverted;
 }
 
 void BrushTipExtruder::ClearCachedPartialBounds() {
+  ABSL_DCHECK_EQ(extrusion_break_bounds_.size(),
+                 geometry_.ExtrusionBreakCount());
   bounds_.cached_partial_bounds.Reset();
-  bounds_.cached_partial_bounds_left_index_count = 0;
-  bounds_.cached_partial_bounds_right_index_count = 0;
+  for (const Envelope& break_bounds : extrusion_break_bounds_) {
+    bounds_.cached_partial_bounds.Add(break_bounds);
+  }
+  Geometry::IndexCounts counts_at_last_break =
+      geometry_.IndexCountsAtLastExtrusionBreak();
+  bounds_.cached_partial_bounds_left_index_count = counts_at_last_break.left;
+  bounds_.cached_partial_bounds_right_index_count = counts_at_last_break.right;
 }
 
 namespace {
@@ -216,9 +329,82 @@ void BrushTipExtruder::UpdateCurrentBounds() {
 void BrushTipExtruder::Save() {
   saved_extrusion_data_count_ = extrusions_.size();
   deleted_save_point_extrusions_.clear();
+  volatile_extrusion_color_sources_.clear();
   geometry_.SetSavePoint();
 }
 
+namespace {
+
+// Returns true if `a` and `b` would be extruded into the same geometry, i.e.
+// they are equal except possibly in their color attributes.
+bool DifferOnlyInColor(const BrushTipState& a, const BrushTipState& b) {
+  return a.position == b.position && a.width == b.width &&
+         a.height == b.height && a.percent_radius == b.percent_radius &&
+         a.rotation == b.rotation && a.slant == b.slant && a.pinch == b.pinch &&
+         a.texture_animation_progress_offset ==
+             b.texture_animation_progress_offset;
+}
+
+// Calculates color "shift" values, each within the range [-1, 1] (for the sake
+// of simplier vertex packing). The color shift components that actually
+// represent [0, 2] multipliers will be decoded in the shader.
+Geometry::VertexColorShift ComputeVertexColorShift(
+    const BrushTipState& tip_state) {
+  return {.opacity_shift = tip_state.opacity_multiplier - 1.f,
+          .hsl_shift = {tip_state.hue_offset_in_full_turns,
+                        tip_state.saturation_multiplier - 1.f,
+                        tip_state.luminosity_shift}};
+}
+
+}  // namespace
+
+bool BrushTipExtruder::CanRecolorVolatileExtrusions(
+    absl::Span<const BrushTipState> new_fixed_states,
+    absl::Span<const BrushTipState> volatile_states) const {
+  if (!volatile_extrusions_are_recolorable_ || !new_fixed_states.empty() ||
+      volatile_states.size() != last_volatile_states_.size()) {
+    return false;
+  }
+  bool colors_changed = false;
+  for (size_t i = 0; i < volatile_states.size(); ++i) {
+    const BrushTipState& a = volatile_states[i];
+    const BrushTipState& b = last_volatile_states_[i];
+    if (!DifferOnlyInColor(a, b)) return false;
+    colors_changed = colors_changed ||
+                     a.hue_offset_in_full_turns != b.hue_offset_in_full_turns ||
+                     a.saturation_multiplier != b.saturation_multiplier ||
+                     a.luminosity_shift != b.luminosity_shift ||
+                     a.opacity_multiplier != b.opacity_multiplier;
+  }
+  // Updates that repeat the same states exactly are left to the regular path.
+  return colors_changed;
+}
+
+void BrushTipExtruder::RecolorVolatileExtrusions(
+    absl::Span<const BrushTipState> volatile_states) {
+  recolor_color_shifts_.clear();
+  for (const BrushTipState& tip_state : volatile_states) {
+    recolor_color_shifts_.push_back(ComputeVertexColorShift(tip_state));
+  }
+  geometry_.RecolorSinceSavePoint(recolor_color_shifts_);
+  last_volatile_states_.assign(volatile_states.begin(), volatile_states.end());
+}
+
+uint32_t BrushTipExtruder::ColorSourceOfExtrusion(
+    size_t extrusion_index) const {
+  if (!extruding_volatile_states_ ||
+      extrusion_index < saved_extrusion_data_count_) {
+    return ExtrudedVertex::kFixedColorSource;
+  }
+  size_t offset = extrusion_index - saved_extrusion_data_count_;
+  if (offset >= volatile_extrusion_color_sources_.size()) {
+    // This can only happen if extrusions from before the save point were
+    // erased, in which case the volatile geometry is not recolorable anyway.
+    return ExtrudedVertex::kMixedColorSource;
+  }
+  return volatile_extrusion_color_sources_[offset];
+}
+
 void BrushTipExtruder::TruncateOutlines() {
   ABSL_DCHECK_LE(geometry_.ExtrusionBreakCount(), outlines_.size());
   // Prune the outline after the last break point to the first mutation.
@@ -250,6 +436,7 @@ void BrushTipExtruder::Restore() {
   absl::c_copy(deleted_save_point_extrusions_,
                extrusions_.end() - deleted_save_point_extrusions_.size());
   geometry_.RevertToSavePoint();
+  extrusion_break_bounds_.resize(geometry_.ExtrusionBreakCount());
   TruncateOutlines();
 }
 
@@ -285,6 +472,10 @@ void BrushTipExtruder::ClearSinceLastExtrusionBreak(
               std::back_inserter(deleted_save_point_extrusions_));
   }
 
+  // The color sources of any volatile extrusions can no longer be matched up
+  // with `extrusions_` by index.
+  if (extruding_volatile_states_) volatile_extrusions_are_recolorable_ = false;
+
   extrusions_.erase(first_extrusion_to_erase, extrusions_.end());
   geometry_.ClearSinceLastExtrusionBreak();
   TruncateOutlines();
@@ -408,10 +599,15 @@ AffineTransform ComputeParticleSurfaceUvTransform(
 }
 
 // Appends and processes new "left" and "right" vertices in `geometry`.
+//
+// `handle_self_intersections` can be false when the new vertices are known not
+// to intersect any earlier geometry since the last extrusion break; see
+// `Geometry::ProcessNewVertices()`.
 void ExtrudeGeometry(const ExtrusionPoints& points,
-                     const BrushTipState& tip_state,
+                     const BrushTipState& tip_state, uint32_t color_source,
                      float simplification_threshold,
                      bool apply_particle_surface_uv,
+                     bool handle_self_intersections,
                      brush_tip_extruder_internal::Geometry& geometry) {
   // TODO: b/271837965 - Add calculation of winding texture coordinates.
 
@@ -419,13 +615,7 @@ void ExtrudeGeometry(const ExtrusionPoints& points,
   // color-shifts between adjacent tip states instead of feeding the same values
   // for every vertex per call to this function.
 
-  // Calculate color "shift" values, each within the range [-1, 1] (for the sake
-  // of simplier vertex packing). The color shift components that actually
-  // represent [0, 2] multipliers will be decoded in the shader.
-  float opacity_shift = tip_state.opacity_multiplier - 1.f;
-  std::array<float, 3> hsl_shift = {tip_state.hue_offset_in_full_turns,
-                                    tip_state.saturation_multiplier - 1.f,
-                                    tip_state.luminosity_shift};
+  Geometry::VertexColorShift color_shift = ComputeVertexColorShift(tip_state);
 
   AffineTransform position_to_particle_surface_uv =
       ComputeParticleSurfaceUvTransform(tip_state);
@@ -446,16 +636,19 @@ void ExtrudeGeometry(const ExtrusionPoints& points,
   };
 
   for (Point point : points.left) {
-    geometry.AppendLeftVertex(point, opacity_shift, hsl_shift,
-                              compute_surface_uv(point),
-                              tip_state.texture_animation_progress_offset);
+    geometry.AppendLeftVertex(point, color_shift.opacity_shift,
+                              color_shift.hsl_shift, compute_surface_uv(point),
+                              tip_state.texture_animation_progress_offset,
+                              color_source);
   }
   for (Point point : points.right) {
-    geometry.AppendRightVertex(point, opacity_shift, hsl_shift,
-                               compute_surface_uv(point),
-                               tip_state.texture_animation_progress_offset);
+    geometry.AppendRightVertex(point, color_shift.opacity_shift,
+                               color_shift.hsl_shift, compute_surface_uv(point),
+                               tip_state.texture_animation_progress_offset,
+                               color_source);
   }
-  geometry.ProcessNewVertices(simplification_threshold, tip_state);
+  geometry.ProcessNewVertices(simplification_threshold, tip_state,
+                              handle_self_intersections);
 }
 
 }  // namespace
@@ -469,6 +662,9 @@ void BrushTipExtruder::Extrude(const BrushTipState& tip_state,
 
   if (!TryAppendNonBreakPointState(tip_state, is_volatile_state, is_last_state))
     return;
+  if (extruding_volatile_states_) {
+    volatile_extrusion_color_sources_.push_back(current_volatile_state_index_);
+  }
 
   auto end_iter = extrusions_.end();
   if (extrusions_.size() < 2 || (end_iter - 1)->IsBreakPoint() ||
@@ -498,8 +694,10 @@ void BrushTipExtruder::Extrude(const BrushTipState& tip_state,
 
   const BrushTipState& extruded_state = (end_iter - 2)->GetState();
   ExtrudeGeometry(current_extrusion_points_, extruded_state,
+                  ColorSourceOfExtrusion(extrusions_.size() - 2),
                   simplification_threshold_,
-                  is_stamping_texture_particle_brush_, geometry_);
+                  is_stamping_texture_particle_brush_,
+                  /* handle_self_intersections = */ true, geometry_);
 }
 
 void BrushTipExtruder::ExtrudeBreakPoint() {
@@ -510,7 +708,13 @@ void BrushTipExtruder::ExtrudeBreakPoint() {
 
   current_extrusion_points_.left.clear();
   current_extrusion_points_.right.clear();
-  if (extrusions_.size() > 1 && !(end_iter - 2)->IsBreakPoint()) {
+  // An isolated tip state, e.g. one particle of a particle brush, is outlined
+  // all at once. Its outline is convex, so its left and right sides can't
+  // intersect each other, and there is no earlier geometry since the extrusion
+  // break for them to intersect, so intersection handling can be skipped.
+  bool is_isolated_state =
+      extrusions_.size() == 1 || (end_iter - 2)->IsBreakPoint();
+  if (!is_isolated_state) {
     BrushTipShape::AppendEndcapExtrusionPoints(
         (end_iter - 2)->GetShape(), (end_iter - 1)->GetShape(),
         max_chord_height_, current_extrusion_points_);
@@ -526,8 +730,11 @@ void BrushTipExtruder::ExtrudeBreakPoint() {
   }
 
   ExtrudeGeometry(current_extrusion_points_, extrusions_.back().GetState(),
+                  ColorSourceOfExtrusion(extrusions_.size() - 1),
                   simplification_threshold_,
-                  is_stamping_texture_particle_brush_, geometry_);
+                  is_stamping_texture_particle_brush_,
+                  /* handle_self_intersections = */ !is_isolated_state,
+                  geometry_);
 
   // If no new geometry was added after the last breakpoint, we don't need to
   // do anything.
@@ -562,7 +769,22 @@ void BrushTipExtruder::ExtrudeBreakPoint() {
   }
 
   geometry_.AddExtrusionBreak();
+  ABSL_DCHECK_EQ(extrusion_break_bounds_.size() + 1,
+                 geometry_.ExtrusionBreakCount());
+  Envelope& break_bounds = extrusion_break_bounds_.emplace_back();
+  AddPositionsToEnvelope(geometry_.GetMeshView(),
+                         absl::MakeSpan(geometry_.LeftSide().indices)
+                             .subspan(counts_at_last_break.left),
+                         break_bounds);
+  AddPositionsToEnvelope(geometry_.GetMeshView(),
+                         absl::MakeSpan(geometry_.RightSide().indices)
+                             .subspan(counts_at_last_break.right),
+                         break_bounds);
   extrusions_.emplace_back(BrushTipExtrusion::BreakPoint{});
+  if (extruding_volatile_states_) {
+    volatile_extrusion_color_sources_.push_back(
+        ExtrudedVertex::kFixedColorSource);
+  }
 
   StrokeOutline& outline = outlines_[num_outlines_ - 1];
   ABSL_DCHECK_EQ(geometry_.ExtrusionBreakCount(), num_outlines_);
@@ -29,6 +29,8 @@
 #include "ink/strokes/internal/extrusion_points.h"
 #include "ink/strokes/internal/stroke_outline.h"
 #include "ink/strokes/internal/stroke_shape_update.h"
+#include "ink/strokes/stroke_shape_budget.h"
+#include "ink/strokes/stroke_shape_stats.h"
 
 namespace ink::strokes_internal {
 
@@ -51,12 +53,17 @@ namespace ink::strokes_internal {
 class BrushTipExtruder {
  public:
   BrushTipExtruder() = default;
-  BrushTipExtruder(const BrushTipExtruder&) = delete;
-  BrushTipExtruder& operator=(const BrushTipExtruder&) = delete;
   BrushTipExtruder(BrushTipExtruder&&) = default;
   BrushTipExtruder& operator=(BrushTipExtruder&&) = default;
   ~BrushTipExtruder() = default;
 
+  // Replaces the state of this extruder, including the stroke in progress and
+  // the budget, with a copy of the state of `other`. The copy extrudes into
+  // `mesh`, which must hold a copy of the target mesh of `other`, e.g. from
+  // `MutableMesh::Clone()`, and must outlive the stroke like the mesh passed to
+  // `StartStroke()`.
+  void CopyStateFrom(const BrushTipExtruder& other, MutableMesh& mesh);
+
   // Starts a new stroke.
   //
   // The value of `brush_epsilon` must be greater than zero and represents the
@@ -80,6 +87,16 @@ class BrushTipExtruder {
   void StartStroke(float brush_epsilon, bool is_stamping_texture_particle_brush,
                    MutableMesh& mesh);
 
+  // Sets the limits on the geometry and work of subsequent calls to
+  // `ExtendStroke()`. See `StrokeShapeBudget` for how extrusion degrades when
+  // a limit is reached. The budget persists across calls to `StartStroke()`,
+  // and is unlimited by default.
+  void SetBudget(const StrokeShapeBudget& budget);
+
+  // Returns true if any limit of the budget has been reached since the last
+  // call to `StartStroke()`.
+  bool ExceededBudget() const;
+
   // Extends the stroke by extruding geometry using new "fixed" and "volatile"
   // tip states.
   //
@@ -90,6 +107,12 @@ class BrushTipExtruder {
   // This function first reverts any past "volatile" extrusions. The returned
   // update covers both the reverted extruded geometry and changes based on the
   // new tip states.
+  //
+  // As a fast path, if there are no new fixed states and the volatile states
+  // only differ from those of the previous call in their color attributes
+  // (which is typical of time-based behaviors such as fading opacity when only
+  // the elapsed time has advanced), the existing volatile geometry is kept and
+  // its per-vertex colors are patched in place instead of being re-extruded.
   StrokeShapeUpdate ExtendStroke(
       absl::Span<const BrushTipState> new_fixed_states,
       absl::Span<const BrushTipState> volatile_states);
@@ -97,12 +120,28 @@ class BrushTipExtruder {
   // Returns the bounding region of positions extruded into the current mesh.
   const Envelope& GetBounds() const;
 
+  // Returns the bounding region of the positions of each non-empty outline,
+  // i.e. of the geometry between consecutive extrusion breaks, in the same
+  // order as `GetOutlines()`. Their union is `GetBounds()`.
+  absl::Span<const Envelope> GetExtrusionBreakBounds() const;
+
+  // Returns the extrusion, intersection handling, simplification, and
+  // derivative update times, and the mesh counters, for the most recent call
+  // to `ExtendStroke()`. The input and tip modeling times are always zero. See
+  // also `kStrokeShapeStatsEnabled`.
+  const StrokeShapeStats& GetLastUpdateStats() const;
+
   // Returns the outlines for the current brush tip. This can include empty
   // outlines. (In particular, we greedily allocate the first outline, so
   // that is empty if the stroke is empty.)
   absl::Span<const StrokeOutline> GetOutlines() const;
 
  private:
+  // Copies are only made by `CopyStateFrom()`, which also rebinds the copy to
+  // its own mesh.
+  BrushTipExtruder(const BrushTipExtruder&) = default;
+  BrushTipExtruder& operator=(const BrushTipExtruder&) = default;
+
   // Data used to incrementally update the bounds of geometry extruded into the
   // current mesh.
   struct Bounds {
@@ -125,12 +164,27 @@ class BrushTipExtruder {
     Envelope current;
   };
 
-  // Clears the value of `bounds_.cached_partial_bounds`.
+  // Returns false if the budget for vertices or outlines has been reached, in
+  // which case no more tip states should be extruded for the current stroke.
+  bool HasGeometryBudgetRemaining();
+
+  // Resets the value of `bounds_.cached_partial_bounds` to the bounds of the
+  // geometry before the last extrusion break, which is never modified.
   //
   // This must be called if any of the vertices that contributed to the cached
   // partial bounds were mutated or deleted.
   void ClearCachedPartialBounds();
 
+  // Implements `ExtendStroke()`, other than resetting mutation tracking and
+  // constructing the returned update.
+  void ExtendGeometry(absl::Span<const BrushTipState> new_fixed_states,
+                      absl::Span<const BrushTipState> volatile_states);
+
+  // Fills in `last_update_stats_` from the state of `geometry_` at the end of
+  // `ExtendStroke()`.
+  void RecordLastUpdateStats(uint32_t triangle_count_before_update,
+                             uint32_t vertex_count_before_update);
+
   // Updates the value of `bounds_.cached_partial_bounds`.
   //
   // This function expects to be called right after `ExtendStroke()` has
@@ -154,6 +208,22 @@ class BrushTipExtruder {
   // Truncate outlines to match the current geometry.
   void TruncateOutlines();
 
+  // Returns true if the geometry extruded from the volatile states of the last
+  // call to `ExtendStroke()` can be updated for the given new tip states by
+  // calling `RecolorVolatileExtrusions()`.
+  bool CanRecolorVolatileExtrusions(
+      absl::Span<const BrushTipState> new_fixed_states,
+      absl::Span<const BrushTipState> volatile_states) const;
+
+  // Replaces the per-vertex colors of the geometry extruded from the last
+  // volatile states with the colors of `volatile_states`.
+  void RecolorVolatileExtrusions(
+      absl::Span<const BrushTipState> volatile_states);
+
+  // Returns the `ExtrudedVertex::color_source` to use for vertices extruded
+  // from `extrusions_[extrusion_index]`.
+  uint32_t ColorSourceOfExtrusion(size_t extrusion_index) const;
+
   // Clears the geometry, extrusions, and outline indices since the last break
   // in extrusion. This is either since the last explicitly added break-point,
   // or since the implicit break-point at start of the stroke.
@@ -206,6 +276,22 @@ class BrushTipExtruder {
   // have since been deleted.
   std::vector<BrushTipExtrusion> deleted_save_point_extrusions_;
 
+  // Whether volatile states are currently being extruded, and if so, the index
+  // of the current one. Used to set the color source of extruded vertices.
+  bool extruding_volatile_states_ = false;
+  uint32_t current_volatile_state_index_ = 0;
+  // For each extrusion appended after `saved_extrusion_data_count_` while
+  // extruding volatile states, the index of the volatile state it was made
+  // from, or `ExtrudedVertex::kFixedColorSource` for break-points.
+  std::vector<uint32_t> volatile_extrusion_color_sources_;
+  // The volatile states passed to the last call to `ExtendStroke()`, and
+  // whether the geometry extruded from them can be recolored.
+  std::vector<BrushTipState> last_volatile_states_;
+  bool volatile_extrusions_are_recolorable_ = false;
+  // Scratch storage for `RecolorVolatileExtrusions()`.
+  std::vector<brush_tip_extruder_internal::Geometry::VertexColorShift>
+      recolor_color_shifts_;
+
   float brush_epsilon_ = 0;
   // Parameter controlling the number of points created to approximate arcs.
   float max_chord_height_ = 0;
@@ -219,11 +305,23 @@ class BrushTipExtruder {
   ExtrusionPoints current_extrusion_points_;
   brush_tip_extruder_internal::Geometry geometry_;
   Bounds bounds_;
+  // The bounds of the geometry completed by each extrusion break in
+  // `geometry_`, so that the bounds of everything before the last break never
+  // need to be recalculated from the mesh.
+  std::vector<Envelope> extrusion_break_bounds_;
 
   // Store a separate count of the number of used outlines so that storage can
   // be reused when outlines are discarded.
   uint32_t num_outlines_ = 1;
   absl::InlinedVector<StrokeOutline, 1> outlines_;
+
+  StrokeShapeStats last_update_stats_;
+
+  StrokeShapeBudget budget_;
+  // Whether the vertex or outline budget, or the per-update work budget, has
+  // been reached during the current stroke.
+  bool exceeded_geometry_budget_ = false;
+  bool exceeded_work_budget_ = false;
 };
 
 // ---------------------------------------------------------------------------
@@ -233,6 +331,23 @@ inline const Envelope& BrushTipExtruder::GetBounds() const {
   return bounds_.current;
 }
 
+inline absl::Span<const Envelope> BrushTipExtruder::GetExtrusionBreakBounds()
+    const {
+  return extrusion_break_bounds_;
+}
+
+inline const StrokeShapeStats& BrushTipExtruder::GetLastUpdateStats() const {
+  return last_update_stats_;
+}
+
+inline void BrushTipExtruder::SetBudget(const StrokeShapeBudget& budget) {
+  budget_ = budget;
+}
+
+inline bool BrushTipExtruder::ExceededBudget() const {
+  return exceeded_geometry_budget_ || exceeded_work_budget_;
+}
+
 inline absl::Span<const StrokeOutline> BrushTipExtruder::GetOutlines() const {
   return absl::MakeSpan(outlines_).subspan(0, num_outlines_);
 }
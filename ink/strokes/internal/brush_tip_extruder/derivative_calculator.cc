@@ -68,6 +68,7 @@ void DerivativeCalculator::UpdateMesh(
   ABSL_CHECK(mesh.HasMeshData());
 
   ResetTrackedValues(left_indices_to_update, right_indices_to_update, mesh);
+  CollectTrackedTriangles(mesh);
 
   AccumulateDerivatives(mesh);
   UpdateMeshDerivatives(left_indices_to_update, mesh);
@@ -121,43 +122,30 @@ void DerivativeCalculator::SaveForwardDerivative(
   }
 }
 
-namespace {
-
-// Iterates over the triangles in the stroke `mesh` that have indices greater
-// than or equal to `minimum_tracked_index` and calls `f` with `mesh` and a
-// triplet of vertex indices. `Function` is expected to have a signature of
-// `(const MutableMesh&, const std::array<uint32_t, 3>) -> void`. It accepts the
-// vertex indices rather than the index of the triangle to avoid duplicate look
-// up of the indices that make up the triangle.
-template <typename Function>
-void ForEachTriangleWithTrackedIndices(const MutableMeshView& mesh,
-                                       uint32_t minimum_tracked_index,
-                                       Function&& f) {
+void DerivativeCalculator::CollectTrackedTriangles(
+    const MutableMeshView& mesh) {
+  tracked_triangle_indices_.clear();
   for (uint32_t i = mesh.TriangleCount(); i > 0; --i) {
     std::array<uint32_t, 3> triangle_indices = mesh.GetTriangleIndices(i - 1);
 
     // The triangle indices produced by `brush_tip_extruder_internal::Geometry`
     // are expected to be in a sorted order such that once all indices of a
     // triangle are below the minimum tracked index, we can exit early.
-    if (triangle_indices[0] < minimum_tracked_index &&
-        triangle_indices[1] < minimum_tracked_index &&
-        triangle_indices[2] < minimum_tracked_index) {
+    if (triangle_indices[0] < minimum_tracked_index_ &&
+        triangle_indices[1] < minimum_tracked_index_ &&
+        triangle_indices[2] < minimum_tracked_index_) {
       break;
     }
 
-    f(mesh, triangle_indices);
+    tracked_triangle_indices_.push_back(triangle_indices);
   }
 }
 
-}  // namespace
-
 void DerivativeCalculator::AccumulateDerivatives(const MutableMeshView& mesh) {
-  ForEachTriangleWithTrackedIndices(
-      mesh, minimum_tracked_index_,
-      [&](const MutableMeshView& mesh,
-          const std::array<uint32_t, 3>& triangle_indices) {
-        AddDerivativesForTriangle(mesh, triangle_indices);
-      });
+  for (const std::array<uint32_t, 3>& triangle_indices :
+       tracked_triangle_indices_) {
+    AddDerivativesForTriangle(mesh, triangle_indices);
+  }
 }
 
 namespace {
@@ -340,12 +328,10 @@ void DerivativeCalculator::UpdateMeshDerivatives(
 }
 
 void DerivativeCalculator::AccumulateMargins(const MutableMeshView& mesh) {
-  ForEachTriangleWithTrackedIndices(
-      mesh, minimum_tracked_index_,
-      [&](const MutableMeshView& mesh,
-          const std::array<uint32_t, 3>& triangle_indices) {
-        AddMarginUpperBoundsForTriangle(mesh, triangle_indices);
-      });
+  for (const std::array<uint32_t, 3>& triangle_indices :
+       tracked_triangle_indices_) {
+    AddMarginUpperBoundsForTriangle(mesh, triangle_indices);
+  }
 }
 
 void DerivativeCalculator::SaveSideMarginUpperBound(uint32_t index,
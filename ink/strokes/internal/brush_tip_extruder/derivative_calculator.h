@@ -98,8 +98,15 @@ class DerivativeCalculator {
   void SaveForwardDerivative(const std::array<uint32_t, 3>& indices,
                              Vec derivative);
 
-  // Iterates over `mesh` triangles, calculates derivatives, and adds them to
-  // associated tracked average values.
+  // Collects the indices of every `mesh` triangle that contains at least one
+  // tracked vertex into `tracked_triangle_indices_`.
+  //
+  // These are the triangles in the one-ring of the vertices being updated, and
+  // the only ones that can contribute to their derivatives and margins.
+  void CollectTrackedTriangles(const MutableMeshView& mesh);
+
+  // Iterates over the tracked triangles, calculates derivatives, and adds them
+  // to associated tracked average values.
   void AccumulateDerivatives(const MutableMeshView& mesh);
 
   // Calculates and saves the values of derivatives for a single triplet of
@@ -113,7 +120,7 @@ class DerivativeCalculator {
   void UpdateMeshDerivatives(absl::Span<const uint32_t> indices_to_update,
                              MutableMeshView& mesh);
 
-  // Iterates over `mesh` triangles, calculates margins, and updates the
+  // Iterates over the tracked triangles, calculates margins, and updates the
   // associated tracked upper bounds.
   void AccumulateMargins(const MutableMeshView& mesh);
 
@@ -146,6 +153,9 @@ class DerivativeCalculator {
   // each vertex, and there can up to two of these segments per vertex.
   std::vector<AverageVertexDerivatives> tracked_average_derivatives_;
   std::vector<float> tracked_side_margin_upper_bounds_;
+  // Vertex indices of the triangles found by `CollectTrackedTriangles()`, so
+  // that the derivative and margin passes do not each need to walk the mesh.
+  std::vector<std::array<uint32_t, 3>> tracked_triangle_indices_;
 };
 
 }  // namespace ink::brush_tip_extruder_internal
@@ -40,6 +40,9 @@ ExtrudedVertex Lerp(const ExtrudedVertex& a, const ExtrudedVertex& b, float t) {
       .texture_coords = Lerp(a.texture_coords, b.texture_coords, t),
       .secondary_texture_coords =
           Lerp(a.secondary_texture_coords, b.secondary_texture_coords, t),
+      .color_source = a.color_source == b.color_source
+                          ? a.color_source
+                          : ExtrudedVertex::kMixedColorSource,
   };
 }
 
@@ -82,6 +85,10 @@ ExtrudedVertex BarycentricLerp(const ExtrudedVertex& a, const ExtrudedVertex& b,
       .secondary_texture_coords = CalculateNewTextureCoords(
           a.secondary_texture_coords, b.secondary_texture_coords,
           c.secondary_texture_coords, *coords),
+      .color_source =
+          a.color_source == b.color_source && a.color_source == c.color_source
+              ? a.color_source
+              : ExtrudedVertex::kMixedColorSource,
   };
 }
 
@@ -15,6 +15,9 @@
 #ifndef INK_STROKES_INTERNAL_BRUSH_TIP_EXTRUDER_EXTRUDED_VERTEX_H_
 #define INK_STROKES_INTERNAL_BRUSH_TIP_EXTRUDER_EXTRUDED_VERTEX_H_
 
+#include <cstdint>
+#include <limits>
+
 #include "ink/color/color.h"
 #include "ink/geometry/point.h"
 #include "ink/strokes/internal/legacy_vertex.h"
@@ -38,12 +41,30 @@ struct ExtrudedVertex {
   Point texture_coords = {0, 0};
   Point secondary_texture_coords = {0, 0};
 
+  // Identifies where the `opacity_shift` and `hsl_shift` values in
+  // `new_non_position_attributes` came from, so that they can be replaced
+  // without re-extruding when only the colors of the source tip states change.
+  //
+  // This is either an index chosen by the caller that appended the vertex to a
+  // `Geometry`, `kFixedColorSource` for colors that are not expected to
+  // change, or `kMixedColorSource` for colors that were interpolated between
+  // vertices with different sources. It is not stored in the mesh, and is not
+  // considered by `operator==`.
+  static constexpr uint32_t kFixedColorSource =
+      std::numeric_limits<uint32_t>::max();
+  static constexpr uint32_t kMixedColorSource = kFixedColorSource - 1;
+  uint32_t color_source = kFixedColorSource;
+
   static ExtrudedVertex FromLegacy(
       const strokes_internal::LegacyVertex& vertex);
   strokes_internal::LegacyVertex ToLegacy() const;
 
-  friend bool operator==(const ExtrudedVertex&,
-                         const ExtrudedVertex&) = default;
+  friend bool operator==(const ExtrudedVertex& a, const ExtrudedVertex& b) {
+    return a.position == b.position &&
+           a.new_non_position_attributes == b.new_non_position_attributes &&
+           a.color == b.color && a.texture_coords == b.texture_coords &&
+           a.secondary_texture_coords == b.secondary_texture_coords;
+  }
 };
 
 // Computes the linear interpolation between `a` and `b` when `t` is in the
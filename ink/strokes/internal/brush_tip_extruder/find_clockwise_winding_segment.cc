@@ -31,7 +31,7 @@ namespace ink {
 namespace brush_tip_extruder_internal {
 
 std::optional<Segment> FindLastClockwiseWindingTriangleFanSegment(
-    const MutableMeshView& mesh,
+    absl::Span<const Point> vertex_positions,
     absl::Span<const MutableMeshView::IndexType> outer_indices,
     SideId outer_side_identifier, Point central_position) {
   if (outer_indices.size() < 2) return std::nullopt;
@@ -40,9 +40,9 @@ std::optional<Segment> FindLastClockwiseWindingTriangleFanSegment(
   // none of them would have negative signed area, which indicates clockwise
   // winding. Degenerate triangles are ok. Left vs right `outline_side`
   // determines the order of positions in the proposed triangle.
-  Point last_position = mesh.GetPosition(outer_indices.back());
+  Point last_position = vertex_positions[outer_indices.back()];
   for (uint32_t i = outer_indices.size() - 1; i > 0; --i) {
-    Point current_position = mesh.GetPosition(outer_indices[i - 1]);
+    Point current_position = vertex_positions[outer_indices[i - 1]];
     if (current_position == last_position) continue;
     Triangle triangle = {
         .p0 = central_position, .p1 = current_position, .p2 = last_position};
@@ -57,20 +57,32 @@ std::optional<Segment> FindLastClockwiseWindingTriangleFanSegment(
 }
 
 std::optional<Segment> FindLastClockwiseWindingMultiTriangleFanSegment(
-    const MutableMeshView& mesh, const Side& outer_side,
+    absl::Span<const Point> vertex_positions, const Side& outer_side,
     Side::IndexOffsetRange outer_index_offset_range, Point central_position) {
   if (outer_side.indices.empty() ||
       outer_index_offset_range.last <= outer_index_offset_range.first) {
     return std::nullopt;
   }
 
-  uint32_t upper_bound = outer_side.indices.size() - 1;
-  for (uint32_t i = outer_side.intersection_discontinuities.size(); i > 0;
-       --i) {
+  // The discontinuities are ordered by offset, so the ones that end past the
+  // range can be skipped with a binary search instead of a backward walk. A
+  // tightly winding stroke can accumulate many of them, while the range of a
+  // triangle fan usually only reaches back past the last few.
+  const std::vector<Side::IndexOffsetRange>& discontinuities =
+      outer_side.intersection_discontinuities;
+  auto first_past_range = std::partition_point(
+      discontinuities.begin(), discontinuities.end(),
+      [last = outer_index_offset_range.last](
+          const Side::IndexOffsetRange& discontinuity_range) {
+        return discontinuity_range.last <= last;
+      });
+  uint32_t upper_bound = first_past_range == discontinuities.end()
+                             ? outer_side.indices.size() - 1
+                             : first_past_range->first;
+  for (uint32_t i = first_past_range - discontinuities.begin(); i > 0; --i) {
     if (upper_bound < outer_index_offset_range.first) return std::nullopt;
 
-    const Side::IndexOffsetRange& discontinuity_range =
-        outer_side.intersection_discontinuities[i - 1];
+    const Side::IndexOffsetRange& discontinuity_range = discontinuities[i - 1];
     uint32_t lower_bound = discontinuity_range.last;
     uint32_t first = std::max(lower_bound, outer_index_offset_range.first);
     uint32_t last = std::min(upper_bound, outer_index_offset_range.last);
@@ -80,14 +92,14 @@ std::optional<Segment> FindLastClockwiseWindingMultiTriangleFanSegment(
     auto indices =
         absl::MakeSpan(outer_side.indices.data() + first, last - first + 1);
     std::optional<Segment> segment = FindLastClockwiseWindingTriangleFanSegment(
-        mesh, indices, outer_side.self_id, central_position);
+        vertex_positions, indices, outer_side.self_id, central_position);
     if (segment.has_value()) return segment;
 
     // Test the triangle connecting the first and last indices if necessary:
     if (outer_index_offset_range.first <= discontinuity_range.first) {
       std::optional<Segment> outer_segment =
           FindLastClockwiseWindingTriangleFanSegment(
-              mesh,
+              vertex_positions,
               {outer_side.indices[discontinuity_range.first],
                outer_side.indices[discontinuity_range.last]},
               outer_side.self_id, central_position);
@@ -101,7 +113,7 @@ std::optional<Segment> FindLastClockwiseWindingMultiTriangleFanSegment(
   auto indices =
       absl::MakeConstSpan(outer_side.indices.data() + first, last - first + 1);
   return FindLastClockwiseWindingTriangleFanSegment(
-      mesh, indices, outer_side.self_id, central_position);
+      vertex_positions, indices, outer_side.self_id, central_position);
 }
 
 }  // namespace brush_tip_extruder_internal
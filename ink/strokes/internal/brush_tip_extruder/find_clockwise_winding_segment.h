@@ -31,12 +31,13 @@ namespace brush_tip_extruder_internal {
 //
 // The triangle fan constructed from the positions of `outer_indices` and a
 // `central_position` assumed to be in the interior of the stroke.
-// `outer_indices` is expected to consist of indices into `vertices` and
+// `outer_indices` is expected to consist of indices into `vertex_positions`,
+// which holds the position of each vertex of the mesh, and
 // represents a portion of either the "left" or "right" outline of the stroke,
 // as given by `outer_side_identifier`. The indices in `outer_indices` are
 // assumed to be ordered from the back of the stroke to the front.
 std::optional<Segment> FindLastClockwiseWindingTriangleFanSegment(
-    const MutableMeshView& mesh,
+    absl::Span<const Point> vertex_positions,
     absl::Span<const MutableMeshView::IndexType> outer_indices,
     SideId outer_side_identifier, Point central_position);
 
@@ -52,7 +53,7 @@ std::optional<Segment> FindLastClockwiseWindingTriangleFanSegment(
 // `outer_side.indices` separated by the offset ranges in
 // `outer_side.intersection_discontinuities`.
 std::optional<Segment> FindLastClockwiseWindingMultiTriangleFanSegment(
-    const MutableMeshView& mesh, const Side& outer_side,
+    absl::Span<const Point> vertex_positions, const Side& outer_side,
     Side::IndexOffsetRange outer_index_offset_range, Point central_position);
 
 }  // namespace brush_tip_extruder_internal
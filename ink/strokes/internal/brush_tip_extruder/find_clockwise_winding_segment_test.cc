@@ -37,7 +37,9 @@ using ::testing::Optional;
 class FindLastClockwiseWindingTriangleFanSegmentTest : public testing::Test {
  protected:
   void SetUp() override {
-    mesh_ = MutableMeshView(vertices_, triangle_indices_);
+    for (const LegacyVertex& vertex : vertices_) {
+      positions_.push_back(vertex.position);
+    }
   }
 
   // A square lightbulb, with some repeated vertices:
@@ -61,8 +63,7 @@ class FindLastClockwiseWindingTriangleFanSegmentTest : public testing::Test {
                                                            4, 3, 2, 1, 0};
   std::vector<MutableMeshView::IndexType> right_indices_ = {0, 1, 2, 3, 4,
                                                             5, 6, 7, 8, 9};
-  std::vector<MutableMeshView::IndexType> triangle_indices_;
-  MutableMeshView mesh_;
+  std::vector<Point> positions_;
 };
 
 TEST_F(FindLastClockwiseWindingTriangleFanSegmentTest,
@@ -79,11 +80,11 @@ TEST_F(FindLastClockwiseWindingTriangleFanSegmentTest,
   //
   // x =     -2  -1     1   2
 
-  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(mesh_, left_indices_,
-                                                         SideId::kLeft, {0, 2}),
+  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
+                  positions_, left_indices_, SideId::kLeft, {0, 2}),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, right_indices_, SideId::kRight, {0, 2}),
+                  positions_, right_indices_, SideId::kRight, {0, 2}),
               Eq(std::nullopt));
 }
 
@@ -102,31 +103,31 @@ TEST_F(FindLastClockwiseWindingTriangleFanSegmentTest,
   // x =     -2  -1     1   2
 
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, left_indices_, SideId::kLeft, {-1, 2}),
+                  positions_, left_indices_, SideId::kLeft, {-1, 2}),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, right_indices_, SideId::kRight, {-1, 2}),
+                  positions_, right_indices_, SideId::kRight, {-1, 2}),
               Eq(std::nullopt));
 
-  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(mesh_, left_indices_,
-                                                         SideId::kLeft, {1, 2}),
+  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
+                  positions_, left_indices_, SideId::kLeft, {1, 2}),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, right_indices_, SideId::kRight, {1, 2}),
+                  positions_, right_indices_, SideId::kRight, {1, 2}),
               Eq(std::nullopt));
 
-  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(mesh_, left_indices_,
-                                                         SideId::kLeft, {0, 3}),
+  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
+                  positions_, left_indices_, SideId::kLeft, {0, 3}),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, right_indices_, SideId::kRight, {0, 3}),
+                  positions_, right_indices_, SideId::kRight, {0, 3}),
               Eq(std::nullopt));
 
-  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(mesh_, left_indices_,
-                                                         SideId::kLeft, {0, 1}),
+  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
+                  positions_, left_indices_, SideId::kLeft, {0, 1}),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, right_indices_, SideId::kRight, {0, 1}),
+                  positions_, right_indices_, SideId::kRight, {0, 1}),
               Eq(std::nullopt));
 }
 
@@ -144,33 +145,33 @@ TEST_F(FindLastClockwiseWindingTriangleFanSegmentTest, ClockwiseTriangles) {
   // x =     -2  -1     1   2
 
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, left_indices_, SideId::kLeft, {-1.5, 2}),
+                  positions_, left_indices_, SideId::kLeft, {-1.5, 2}),
               Optional(SegmentEq({.start = {-1, 1}, .end = {-1, 0}})));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, right_indices_, SideId::kRight, {-1.5, 2}),
+                  positions_, right_indices_, SideId::kRight, {-1.5, 2}),
               Optional(SegmentEq({.start = {-1, 1}, .end = {-1, 0}})));
 
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, left_indices_, SideId::kLeft, {1.5, 2}),
+                  positions_, left_indices_, SideId::kLeft, {1.5, 2}),
               Optional(SegmentEq({.start = {1, 0}, .end = {1, 1}})));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, right_indices_, SideId::kRight, {1.5, 2}),
+                  positions_, right_indices_, SideId::kRight, {1.5, 2}),
               Optional(SegmentEq({.start = {1, 0}, .end = {1, 1}})));
 
-  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(mesh_, left_indices_,
-                                                         SideId::kLeft, {0, 0}),
+  EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
+                  positions_, left_indices_, SideId::kLeft, {0, 0}),
               Optional(SegmentEq({.start = {1, 1}, .end = {2, 1}})));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, right_indices_, SideId::kRight, {0, 0}),
+                  positions_, right_indices_, SideId::kRight, {0, 0}),
               Optional(SegmentEq({.start = {-2, 1}, .end = {-1, 1}})));
 }
 
 TEST_F(FindLastClockwiseWindingTriangleFanSegmentTest, EmptyOutline) {
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, {}, SideId::kLeft, {10, 10}),
+                  positions_, {}, SideId::kLeft, {10, 10}),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, {}, SideId::kRight, {10, 10}),
+                  positions_, {}, SideId::kRight, {10, 10}),
               Eq(std::nullopt));
 }
 
@@ -178,10 +179,10 @@ TEST_F(FindLastClockwiseWindingTriangleFanSegmentTest, SinglePosition) {
   ASSERT_EQ(vertices_[0].position, vertices_[1].position);
 
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, {1, 0}, SideId::kLeft, {10, 10}),
+                  positions_, {1, 0}, SideId::kLeft, {10, 10}),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, {0, 1}, SideId::kRight, {10, 10}),
+                  positions_, {0, 1}, SideId::kRight, {10, 10}),
               Eq(std::nullopt));
 }
 
@@ -217,14 +218,15 @@ class FindLastClockwiseWindingMultiTriangleFanSegmentTest
         Side::IndexOffsetRange{.first = 1, .last = 4});
     left_side_indices_ = left_side_.indices;
 
-    mesh_ = MutableMeshView(vertices_, triangle_indices_);
+    for (const LegacyVertex& vertex : vertices_) {
+      positions_.push_back(vertex.position);
+    }
   }
 
   std::vector<LegacyVertex> vertices_;
   Side left_side_;
   absl::Span<const MutableMeshView::IndexType> left_side_indices_;
-  std::vector<MutableMeshView::IndexType> triangle_indices_;
-  MutableMeshView mesh_;
+  std::vector<Point> positions_;
 };
 
 TEST_F(FindLastClockwiseWindingMultiTriangleFanSegmentTest, EntireRange) {
@@ -246,10 +248,10 @@ TEST_F(FindLastClockwiseWindingMultiTriangleFanSegmentTest, EntireRange) {
   // does not.
   Point test_position = {2, 2.5};
   EXPECT_THAT(FindLastClockwiseWindingTriangleFanSegment(
-                  mesh_, left_side_indices_, SideId::kLeft, test_position),
+                  positions_, left_side_indices_, SideId::kLeft, test_position),
               Optional(SegmentEq({.start = {1, 2}, .end = {1, 3}})));
   EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
-                  mesh_, left_side_,
+                  positions_, left_side_,
                   Side::IndexOffsetRange{.first = 0, .last = 5}, test_position),
               Eq(std::nullopt));
 }
@@ -274,34 +276,65 @@ TEST_F(FindLastClockwiseWindingMultiTriangleFanSegmentTest,
 
   Point test_position = {0, 2.5};
   EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
-                  mesh_, left_side_,
+                  positions_, left_side_,
                   Side::IndexOffsetRange{.first = 0, .last = 3}, test_position),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
-                  mesh_, left_side_,
+                  positions_, left_side_,
                   Side::IndexOffsetRange{.first = 0, .last = 4}, test_position),
               Optional(SegmentEq({.start = {1, 2}, .end = {0, 1}})));
 
   EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
-                  mesh_, left_side_,
+                  positions_, left_side_,
                   Side::IndexOffsetRange{.first = 2, .last = 5}, test_position),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
-                  mesh_, left_side_,
+                  positions_, left_side_,
                   Side::IndexOffsetRange{.first = 1, .last = 5}, test_position),
               Optional(SegmentEq({.start = {1, 2}, .end = {0, 1}})));
 
   test_position = {-1, 1};
   EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
-                  mesh_, left_side_,
+                  positions_, left_side_,
                   Side::IndexOffsetRange{.first = 1, .last = 3}, test_position),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
-                  mesh_, left_side_,
+                  positions_, left_side_,
+                  Side::IndexOffsetRange{.first = 2, .last = 4}, test_position),
+              Eq(std::nullopt));
+  EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
+                  positions_, left_side_,
+                  Side::IndexOffsetRange{.first = 1, .last = 4}, test_position),
+              Optional(SegmentEq({.start = {1, 2}, .end = {0, 1}})));
+}
+
+TEST_F(FindLastClockwiseWindingMultiTriangleFanSegmentTest,
+       DiscontinuitiesAfterRange) {
+  // Extend the side past the loop with more discontinuities, which should not
+  // affect any range that ends before them.
+  left_side_.indices.insert(left_side_.indices.end(), {8, 8, 8, 8, 8, 8});
+  left_side_.intersection_discontinuities.push_back(
+      Side::IndexOffsetRange{.first = 5, .last = 7});
+  left_side_.intersection_discontinuities.push_back(
+      Side::IndexOffsetRange{.first = 8, .last = 10});
+
+  Point test_position = {0, 2.5};
+  EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
+                  positions_, left_side_,
+                  Side::IndexOffsetRange{.first = 0, .last = 3}, test_position),
+              Eq(std::nullopt));
+  EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
+                  positions_, left_side_,
+                  Side::IndexOffsetRange{.first = 0, .last = 4}, test_position),
+              Optional(SegmentEq({.start = {1, 2}, .end = {0, 1}})));
+
+  test_position = {-1, 1};
+  EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
+                  positions_, left_side_,
                   Side::IndexOffsetRange{.first = 2, .last = 4}, test_position),
               Eq(std::nullopt));
   EXPECT_THAT(FindLastClockwiseWindingMultiTriangleFanSegment(
-                  mesh_, left_side_,
+                  positions_, left_side_,
                   Side::IndexOffsetRange{.first = 1, .last = 4}, test_position),
               Optional(SegmentEq({.start = {1, 2}, .end = {0, 1}})));
 }
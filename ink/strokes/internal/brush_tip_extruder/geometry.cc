@@ -47,6 +47,7 @@
 #include "ink/strokes/internal/brush_tip_extruder/simplify.h"
 #include "ink/strokes/internal/brush_tip_state.h"
 #include "ink/strokes/internal/legacy_vertex.h"
+#include "ink/strokes/internal/stroke_shape_stats_timer.h"
 #include "ink/strokes/internal/stroke_vertex.h"
 
 namespace ink {
@@ -55,8 +56,10 @@ namespace {
 
 using ::ink::geometry_internal::LegacyIntersects;
 using ::ink::geometry_internal::LegacyTriangleContains;
+using ::ink::strokes_internal::AddToStatsCounter;
 using ::ink::strokes_internal::BrushTipState;
 using ::ink::strokes_internal::LegacyVertex;
+using ::ink::strokes_internal::ScopedStatsTimer;
 using ::ink::strokes_internal::StrokeVertex;
 
 // This is the special value assigned to `Vertex::texture_coords` for vertices
@@ -105,6 +108,9 @@ void Geometry::SetSavePoint() {
   save_point_state_.saved_vertices.clear();
   save_point_state_.saved_triangle_indices.clear();
   save_point_state_.saved_opposite_side_offsets.clear();
+  save_point_state_.vertex_journal.clear();
+  save_point_state_.triangle_indices_journal.clear();
+  save_point_state_.opposite_side_offset_journal.clear();
   set_side_state(left_side_, save_point_state_.left_side_state);
   set_side_state(right_side_, save_point_state_.right_side_state);
   save_point_state_.saved_last_extrusion_break = last_extrusion_break_;
@@ -188,17 +194,23 @@ Envelope Geometry::CalculateVisuallyUpdatedRegion() const {
 void Geometry::RevertToSavePoint() {
   if (!save_point_state_.is_active || !mesh_.HasMeshData()) return;
 
+  AddToStatsCounter(
+      stats_.vertices_reverted,
+      mesh_.VertexCount() -
+          std::min(mesh_.VertexCount(), save_point_state_.n_mesh_vertices));
+  AddToStatsCounter(
+      stats_.triangles_reverted,
+      mesh_.TriangleCount() -
+          std::min(mesh_.TriangleCount(), save_point_state_.n_mesh_triangles));
+
   // Before we mutate the mesh, Record the envelope of triangles past the start
   // of the save point, all of which are about to be erased or changed.
   envelope_of_removed_geometry_.Add(
       EnvelopeOfTriangles(mesh_, save_point_state_.n_mesh_triangles));
 
-  uint32_t old_vertex_count = mesh_.VertexCount();
-  uint32_t old_triangle_count = mesh_.TriangleCount();
-
   // If we're shrinking the mesh, truncate any extra triangles/vertices. (If
-  // we're growing the mesh, the missing vertices/triangles will be added by the
-  // for-loops below.)
+  // we're growing the mesh, the missing vertices/triangles will be re-appended
+  // from the captured chunks below.)
   mesh_.TruncateTriangles(save_point_state_.n_mesh_triangles);
   mesh_.TruncateVertices(save_point_state_.n_mesh_vertices);
 
@@ -207,35 +219,86 @@ void Geometry::RevertToSavePoint() {
   vertex_side_ids_.resize(save_point_state_.n_mesh_vertices);
   side_offsets_.resize(save_point_state_.n_mesh_vertices);
   opposite_side_offsets_.resize(save_point_state_.n_mesh_vertices);
+  vertex_color_sources_.resize(save_point_state_.n_mesh_vertices);
+  vertex_positions_.resize(save_point_state_.n_mesh_vertices);
+
+  // Undo mutations in the reverse of the order in which they were made, so
+  // that the oldest value recorded for each vertex, triangle, or offset wins.
+  // If geometry present at the save point was deleted, the journal entries
+  // recorded after that are undone first, then the deleted geometry is
+  // restored, then the older entries are undone.
+  //
+  // Entries recorded after the deletion can refer to elements that no longer
+  // exist after the truncation above; those would be overwritten by the
+  // captured chunks anyway, so they are skipped.
+  GeometrySavePointState& state = save_point_state_;
+  auto undo_vertex = [this](const auto& entry) {
+    const auto& [index, vertex] = entry;
+    if (index >= mesh_.VertexCount()) return;
+    SetVertex(index, vertex, /* update_save_state = */ false,
+              /* update_envelope_of_removed_geometry = */ true);
+  };
+  auto undo_triangle = [this](const auto& entry) {
+    const auto& [triangle, indices] = entry;
+    if (triangle >= mesh_.TriangleCount()) return;
+    mesh_.SetTriangleIndices(triangle, indices);
+  };
+  auto undo_opposite_side_offset = [this](const auto& entry) {
+    opposite_side_offsets_[entry.first] = entry.second;
+  };
+  // Undoes and drops every entry of `journal` past `journal_begin`, from newest
+  // to oldest.
+  auto unwind = [](auto& journal, size_t journal_begin, const auto& undo) {
+    for (size_t i = journal.size(); i > journal_begin; --i) {
+      undo(journal[i - 1]);
+    }
+    journal.erase(journal.begin() + journal_begin, journal.end());
+  };
 
-  // Revert mutated/removed vertices. Note that `saved_vertices` is an ordered
-  // map, so any new vertices will get appended in order.
-  for (const auto& [index, vertex] : save_point_state_.saved_vertices) {
-    if (index < old_vertex_count) {
-      SetVertex(index, vertex, /* update_save_state = */ false,
-                /* update_envelope_of_removed_geometry = */ true);
-    } else {
-      ABSL_DCHECK_EQ(index, mesh_.VertexCount());
-      mesh_.AppendVertex(vertex);
+  if (state.contains_all_geometry_since_last_extrusion_break) {
+    unwind(state.vertex_journal, state.vertex_journal_size_at_capture,
+           undo_vertex);
+    unwind(state.triangle_indices_journal,
+           state.triangle_indices_journal_size_at_capture, undo_triangle);
+    unwind(state.opposite_side_offset_journal,
+           state.opposite_side_offset_journal_size_at_capture,
+           undo_opposite_side_offset);
+
+    // Restore the captured chunks. Any elements that were deleted are
+    // re-appended in order.
+    uint32_t first_saved_vertex =
+        state.n_mesh_vertices - state.saved_vertices.size();
+    for (uint32_t i = 0; i < state.saved_vertices.size(); ++i) {
+      uint32_t index = first_saved_vertex + i;
+      if (index < mesh_.VertexCount()) {
+        SetVertex(index, state.saved_vertices[i],
+                  /* update_save_state = */ false,
+                  /* update_envelope_of_removed_geometry = */ true);
+      } else {
+        ABSL_DCHECK_EQ(index, mesh_.VertexCount());
+        mesh_.AppendVertex(state.saved_vertices[i]);
+        vertex_color_sources_[index] = state.saved_vertices[i].color_source;
+        vertex_positions_[index] = state.saved_vertices[i].position;
+      }
     }
-  }
-  // Revert mutated/removed triangles. Note that `saved_triangle_indices` is an
-  // ordered map, so any new triangles will get appended in order.
-  for (const auto& [triangle, indices] :
-       save_point_state_.saved_triangle_indices) {
-    if (triangle < old_triangle_count) {
-      mesh_.SetTriangleIndices(triangle, indices);
-    } else {
-      ABSL_DCHECK_EQ(triangle, mesh_.TriangleCount());
-      mesh_.AppendTriangleIndices(indices);
+    uint32_t first_saved_triangle =
+        state.n_mesh_triangles - state.saved_triangle_indices.size();
+    for (uint32_t i = 0; i < state.saved_triangle_indices.size(); ++i) {
+      uint32_t triangle = first_saved_triangle + i;
+      if (triangle < mesh_.TriangleCount()) {
+        mesh_.SetTriangleIndices(triangle, state.saved_triangle_indices[i]);
+      } else {
+        ABSL_DCHECK_EQ(triangle, mesh_.TriangleCount());
+        mesh_.AppendTriangleIndices(state.saved_triangle_indices[i]);
+      }
     }
+    absl::c_copy(state.saved_opposite_side_offsets,
+                 opposite_side_offsets_.end() -
+                     state.saved_opposite_side_offsets.size());
   }
-
-  for (const auto& index_offset_pair :
-       save_point_state_.saved_opposite_side_offsets) {
-    UpdateOppositeSideOffset(index_offset_pair.first, index_offset_pair.second,
-                             /* update_save_state = */ false);
-  }
+  unwind(state.vertex_journal, 0, undo_vertex);
+  unwind(state.triangle_indices_journal, 0, undo_triangle);
+  unwind(state.opposite_side_offset_journal, 0, undo_opposite_side_offset);
 
   absl::c_copy(
       save_point_state_.saved_vertex_side_ids,
@@ -277,10 +340,71 @@ void Geometry::RevertToSavePoint() {
   save_point_state_.is_active = false;
 }
 
+bool Geometry::CanRecolorSinceSavePoint() const {
+  if (!save_point_state_.is_active || !mesh_.HasMeshData()) return false;
+  // If geometry from before the save point was deleted, new vertices may have
+  // been appended at indices below `n_mesh_vertices`. We don't keep track of
+  // those, so we conservatively give up on recoloring.
+  if (save_point_state_.contains_all_geometry_since_last_extrusion_break) {
+    return false;
+  }
+
+  auto is_mixed = [this](MutableMeshView::IndexType index) {
+    return index < mesh_.VertexCount() &&
+           vertex_color_sources_[index] == ExtrudedVertex::kMixedColorSource;
+  };
+  for (uint32_t i = save_point_state_.n_mesh_vertices; i < mesh_.VertexCount();
+       ++i) {
+    if (is_mixed(i)) return false;
+  }
+  for (const auto& [index, unused_vertex] : save_point_state_.vertex_journal) {
+    if (is_mixed(index)) return false;
+  }
+  return true;
+}
+
+void Geometry::RecolorSinceSavePoint(
+    absl::Span<const VertexColorShift> color_shifts) {
+  ABSL_DCHECK(CanRecolorSinceSavePoint());
+
+  auto recolor = [this, color_shifts](MutableMeshView::IndexType index) {
+    if (index >= mesh_.VertexCount()) return;
+    uint32_t color_source = vertex_color_sources_[index];
+    if (color_source >= color_shifts.size()) return;
+
+    ExtrudedVertex vertex = GetVertex(index);
+    vertex.new_non_position_attributes.opacity_shift =
+        color_shifts[color_source].opacity_shift;
+    vertex.new_non_position_attributes.hsl_shift =
+        color_shifts[color_source].hsl_shift;
+    // Any vertex that existed at the save point and has a non-fixed color
+    // source must have been modified since, so its original value has already
+    // been recorded in the journal.
+    SetVertex(index, vertex, /* update_save_state = */ false,
+              /* update_envelope_of_removed_geometry = */ false);
+  };
+  for (uint32_t i = save_point_state_.n_mesh_vertices; i < mesh_.VertexCount();
+       ++i) {
+    recolor(i);
+  }
+  for (const auto& [index, unused_vertex] : save_point_state_.vertex_journal) {
+    if (index < save_point_state_.n_mesh_vertices) recolor(index);
+  }
+}
+
 void Geometry::SetIntersectionHandling(
     IntersectionHandling intersection_handling) {
+  if (handle_self_intersections_ &&
+      intersection_handling == IntersectionHandling::kDisabled) {
+    // Keep any retriangulation done so far, the same as when an intersection
+    // runs out of outline reposition budget.
+    GiveUpIntersectionHandling(left_side_);
+    GiveUpIntersectionHandling(right_side_);
+  }
   handle_self_intersections_ =
-      intersection_handling == IntersectionHandling::kEnabled;
+      intersection_handling != IntersectionHandling::kDisabled;
+  adaptive_intersection_handling_ =
+      intersection_handling == IntersectionHandling::kAdaptive;
   if (!handle_self_intersections_) {
     left_side_.intersection.reset();
     right_side_.intersection.reset();
@@ -296,6 +420,7 @@ void Geometry::ResetMutationTracking() {
       left_side_.indices.size();
   first_mutated_right_index_offset_in_current_partition_ =
       right_side_.indices.size();
+  stats_ = {};
 }
 
 namespace {
@@ -331,7 +456,8 @@ float SimplificationTravelLimit(float average_tip_dimension) {
 }  // namespace
 
 void Geometry::ProcessNewVertices(float simplification_threshold,
-                                  const BrushTipState& last_tip_state) {
+                                  const BrushTipState& last_tip_state,
+                                  bool handle_self_intersections) {
   if (left_side_.vertex_buffer.empty() || right_side_.vertex_buffer.empty() ||
       !mesh_.HasMeshData()) {
     // Need vertices on both sides to process. Note that the vertex buffers are
@@ -341,12 +467,19 @@ void Geometry::ProcessNewVertices(float simplification_threshold,
     return;
   }
 
+  retriangulated_triangle_count_ = 0;
+  intersection_handling_suspended_ = !handle_self_intersections;
+
   float average_tip_dimension =
       0.5 * (last_tip_state.width + last_tip_state.height);
   float outline_reposition_budget =
       InitialOutlineRepositionBudget(average_tip_dimension);
-  SimplifyBufferedVertices(outline_reposition_budget, simplification_threshold,
-                           SimplificationTravelLimit(average_tip_dimension));
+  {
+    ScopedStatsTimer timer(stats_.simplification_nanos);
+    SimplifyBufferedVertices(outline_reposition_budget,
+                             simplification_threshold,
+                             SimplificationTravelLimit(average_tip_dimension));
+  }
 
   uint32_t left_index_count_before = left_side_.indices.size();
   uint32_t right_index_count_before = right_side_.indices.size();
@@ -477,17 +610,24 @@ void CaptureGeometrySinceLastExtrusionBreak(
             side_offsets.begin() + save_point_state.n_mesh_vertices,
             std::back_inserter(save_point_state.saved_side_offsets));
 
+  std::copy(opposite_side_offsets.begin() + last_extrusion_break.vertex_count,
+            opposite_side_offsets.begin() + save_point_state.n_mesh_vertices,
+            std::back_inserter(save_point_state.saved_opposite_side_offsets));
   for (uint32_t t_idx = last_extrusion_break.triangle_count;
        t_idx < save_point_state.n_mesh_triangles; ++t_idx) {
-    save_point_state.saved_triangle_indices.emplace(
-        t_idx, mesh.GetTriangleIndices(t_idx));
+    save_point_state.saved_triangle_indices.push_back(
+        mesh.GetTriangleIndices(t_idx));
   }
   for (uint32_t v_idx = last_extrusion_break.vertex_count;
        v_idx < save_point_state.n_mesh_vertices; ++v_idx) {
-    save_point_state.saved_vertices.emplace(v_idx, mesh.GetVertex(v_idx));
-    save_point_state.saved_opposite_side_offsets.emplace(
-        v_idx, opposite_side_offsets[v_idx]);
+    save_point_state.saved_vertices.push_back(mesh.GetVertex(v_idx));
   }
+  save_point_state.vertex_journal_size_at_capture =
+      save_point_state.vertex_journal.size();
+  save_point_state.triangle_indices_journal_size_at_capture =
+      save_point_state.triangle_indices_journal.size();
+  save_point_state.opposite_side_offset_journal_size_at_capture =
+      save_point_state.opposite_side_offset_journal.size();
 
   using SideInfo = GeometryLastExtrusionBreakMetadata::SideInfo;
   auto capture_side = [](const Side& side, const SideInfo& side_extrusion_break,
@@ -556,12 +696,20 @@ void Geometry::ClearSinceLastExtrusionBreak() {
   ABSL_DCHECK_LE(last_extrusion_break_.triangle_count, mesh_.TriangleCount());
   ABSL_DCHECK_LE(last_extrusion_break_.vertex_count, mesh_.VertexCount());
 
+  AddToStatsCounter(stats_.vertices_reverted,
+                    mesh_.VertexCount() - last_extrusion_break_.vertex_count);
+  AddToStatsCounter(
+      stats_.triangles_reverted,
+      mesh_.TriangleCount() - last_extrusion_break_.triangle_count);
+
   mesh_.TruncateTriangles(last_extrusion_break_.triangle_count);
   mesh_.TruncateVertices(last_extrusion_break_.vertex_count);
 
   vertex_side_ids_.resize(last_extrusion_break_.vertex_count);
   side_offsets_.resize(last_extrusion_break_.vertex_count);
   opposite_side_offsets_.resize(last_extrusion_break_.vertex_count);
+  vertex_color_sources_.resize(last_extrusion_break_.vertex_count);
+  vertex_positions_.resize(last_extrusion_break_.vertex_count);
 
   first_mutated_left_index_offset_in_current_partition_ =
       std::min<uint32_t>(first_mutated_left_index_offset_in_current_partition_,
@@ -667,7 +815,7 @@ void Geometry::DebugMakeMeshAfterSavePoint(MutableMeshView mesh_out) const {
   }
   for (MutableMeshView::IndexType i = min_index_after_save;
        i < mesh_.VertexCount(); ++i) {
-    mesh_out.AppendVertex(mesh_.GetVertex(i));
+    mesh_out.AppendVertex(GetVertex(i));
   }
   for (uint32_t i = save_point_state_.n_mesh_triangles;
        i < mesh_.TriangleCount(); ++i) {
@@ -720,6 +868,8 @@ void Geometry::Reset(const MutableMeshView& mesh) {
   vertex_side_ids_.clear();
   side_offsets_.clear();
   opposite_side_offsets_.clear();
+  vertex_color_sources_.clear();
+  vertex_positions_.clear();
   // We do this instead of just typing e.g. `left_side_ = {};` to re-use the
   // capacity allocated in `Side::indices`.
   ClearSide(left_side_);
@@ -755,30 +905,36 @@ void Geometry::AppendVertexToSide(Side& side, const ExtrudedVertex& vertex) {
 
 void Geometry::AppendLeftVertex(Point position, float opacity_shift,
                                 const std::array<float, 3>& hsl_shift,
-                                Point surface_uv, float animation_offset) {
+                                Point surface_uv, float animation_offset,
+                                uint32_t color_source) {
   AppendVertexToSide(left_side_,
                      {.position = position,
-                      .new_non_position_attributes = {
-                          .opacity_shift = opacity_shift,
-                          .hsl_shift = hsl_shift,
-                          .side_label = StrokeVertex::kExteriorLeftLabel,
-                          .surface_uv = surface_uv,
-                          .animation_offset = animation_offset,
-                      }});
+                      .new_non_position_attributes =
+                          {
+                              .opacity_shift = opacity_shift,
+                              .hsl_shift = hsl_shift,
+                              .side_label = StrokeVertex::kExteriorLeftLabel,
+                              .surface_uv = surface_uv,
+                              .animation_offset = animation_offset,
+                          },
+                      .color_source = color_source});
 }
 
 void Geometry::AppendRightVertex(Point position, float opacity_shift,
                                  const std::array<float, 3>& hsl_shift,
-                                 Point surface_uv, float animation_offset) {
+                                 Point surface_uv, float animation_offset,
+                                 uint32_t color_source) {
   AppendVertexToSide(right_side_,
                      {.position = position,
-                      .new_non_position_attributes = {
-                          .opacity_shift = opacity_shift,
-                          .hsl_shift = hsl_shift,
-                          .side_label = StrokeVertex::kExteriorRightLabel,
-                          .surface_uv = surface_uv,
-                          .animation_offset = animation_offset,
-                      }});
+                      .new_non_position_attributes =
+                          {
+                              .opacity_shift = opacity_shift,
+                              .hsl_shift = hsl_shift,
+                              .side_label = StrokeVertex::kExteriorRightLabel,
+                              .surface_uv = surface_uv,
+                              .animation_offset = animation_offset,
+                          },
+                      .color_source = color_source});
 }
 
 void Geometry::AppendLeftVertex(const LegacyVertex& vertex) {
@@ -789,8 +945,14 @@ void Geometry::AppendRightVertex(const LegacyVertex& vertex) {
   AppendVertexToSide(right_side_, ExtrudedVertex::FromLegacy(vertex));
 }
 
+ExtrudedVertex Geometry::GetVertex(MutableMeshView::IndexType index) const {
+  ExtrudedVertex vertex = mesh_.GetVertex(index);
+  vertex.color_source = vertex_color_sources_[index];
+  return vertex;
+}
+
 ExtrudedVertex Geometry::LastVertex(const Side& side) const {
-  return mesh_.GetVertex(side.indices.back());
+  return GetVertex(side.indices.back());
 }
 
 Point Geometry::LastPosition(const Side& side) const {
@@ -844,6 +1006,8 @@ void Geometry::AppendVertexToMesh(Side& side, const ExtrudedVertex& vertex) {
   MutableMeshView::IndexType new_index = mesh_.VertexCount();
   mesh_.AppendVertex(vertex);
   vertex_side_ids_.push_back(side.self_id);
+  vertex_color_sources_.push_back(vertex.color_source);
+  vertex_positions_.push_back(vertex.position);
   side_offsets_.push_back(side.indices.size());
   side.indices.push_back(new_index);
 
@@ -963,6 +1127,7 @@ void Geometry::SimplifyBufferedVertices(Side& side,
     SetVertex(side.indices.back(), simplification_vertex_buffer_[1]);
   }
 
+  uint32_t buffered_vertex_count_before = side.vertex_buffer.size();
   if (last_vertex_simplified && !should_replace_last_vertex) {
     side.vertex_buffer.resize(2);
     side.vertex_buffer.insert(side.vertex_buffer.end(),
@@ -971,6 +1136,8 @@ void Geometry::SimplifyBufferedVertices(Side& side,
   } else {
     std::swap(side.vertex_buffer, simplification_vertex_buffer_);
   }
+  AddToStatsCounter(stats_.vertices_simplified_away,
+                    buffered_vertex_count_before - side.vertex_buffer.size());
 }
 
 void Geometry::SimplifyBufferedVertices(float initial_outline_reposition_budget,
@@ -1014,8 +1181,12 @@ std::optional<uint32_t> Geometry::FindLastTriangleContainingSegmentEnd(
   }
   const Side& opposite_side = OpposingSide(search_along_side);
 
-  for (uint32_t i = mesh_.TriangleCount();
-       i > search_along_side.partition_start.first_triangle; --i) {
+  uint32_t search_end = search_along_side.partition_start.first_triangle;
+  if (adaptive_intersection_handling_ &&
+      mesh_.TriangleCount() > search_end + adaptive_retriangulation_budget_) {
+    search_end = mesh_.TriangleCount() - adaptive_retriangulation_budget_;
+  }
+  for (uint32_t i = mesh_.TriangleCount(); i > search_end; --i) {
     std::array<MutableMeshView::IndexType, 3> indices =
         mesh_.GetTriangleIndices(i - 1);
 
@@ -1028,7 +1199,9 @@ std::optional<uint32_t> Geometry::FindLastTriangleContainingSegmentEnd(
       continue;
     }
 
-    Triangle triangle = mesh_.GetTriangle(i - 1);
+    Triangle triangle = {.p0 = vertex_positions_[indices[0]],
+                         .p1 = vertex_positions_[indices[1]],
+                         .p2 = vertex_positions_[indices[2]]};
     if (LegacyTriangleContains(triangle, segment.end)) return i - 1;
 
     // See if we can end the search already:
@@ -1087,9 +1260,9 @@ bool Geometry::MoveStartingVerticesToIntersection(
   }
 
   ExtrudedVertex from_vert =
-      mesh_.GetVertex(outline[result.segment_intersection->starting_index]);
+      GetVertex(outline[result.segment_intersection->starting_index]);
   ExtrudedVertex to_vert =
-      mesh_.GetVertex(outline[result.segment_intersection->ending_index]);
+      GetVertex(outline[result.segment_intersection->ending_index]);
 
   // Interpolate with zero margin since this function is called to shift outline
   // vertices during ongoing intersection and this helps not introduce small
@@ -1150,8 +1323,8 @@ bool Geometry::ExtendOutlineToSegment(Side& outline_starting_side,
     // Extend the first non-degenerate segment of `outline` by
     // `max_extension_distance` and search for an intersection between it and
     // `segment`.
-    ExtrudedVertex from = mesh_.GetVertex(outline[*non_start_vertex]);
-    ExtrudedVertex to = mesh_.GetVertex(outline[0]);
+    ExtrudedVertex from = GetVertex(outline[*non_start_vertex]);
+    ExtrudedVertex to = GetVertex(outline[0]);
     Vec delta_vector = to.position - from.position;
     float t = 1 + max_extension_distance / delta_vector.Magnitude();
     ExtrudedVertex extended_to = Lerp(from, to, t);
@@ -1268,6 +1441,7 @@ bool Geometry::TryBeginIntersectionRetriangulation(
   //    |   \|      |   \|      |/  \|
   //    X----X      X----X      X    X
   //
+  AddRetriangulationWork(mesh_.TriangleCount() - intersection_vertex_triangle);
   for (uint32_t i = mesh_.TriangleCount(); i > intersection_vertex_triangle;
        --i) {
     std::array<MutableMeshView::IndexType, 3> mesh_indices =
@@ -1277,7 +1451,8 @@ bool Geometry::TryBeginIntersectionRetriangulation(
     // insert a new triangle after this loop.
     if (save_point_state_.is_active &&
         i - 1 < save_point_state_.n_mesh_triangles) {
-      save_point_state_.saved_triangle_indices.emplace(i - 1, mesh_indices);
+      save_point_state_.triangle_indices_journal.emplace_back(i - 1,
+                                                              mesh_indices);
     }
 
     if (i <= intersecting_side.intersection->undo_stack_starting_triangle) {
@@ -1383,6 +1558,9 @@ void Geometry::ContinueIntersectionRetriangulation(
   // shift by one triangle toward the end of the line as we go. This moves the
   // inserted gap-covering triangle to its new needed location at
   // `intersection_vertex_triangle`.
+  AddRetriangulationWork(
+      intersecting_side.intersection->oldest_retriangulation_triangle -
+      intersection_vertex_triangle);
   for (uint32_t i =
            intersecting_side.intersection->oldest_retriangulation_triangle;
        i > intersection_vertex_triangle; --i) {
@@ -1466,6 +1644,9 @@ void Geometry::UndoIntersectionRetriangulation(
     ++triangle_index;
     triangle_stack.pop_back();
   }
+  AddRetriangulationWork(
+      triangle_index -
+      intersecting_side.intersection->oldest_retriangulation_triangle);
 
   if (triangle_index ==
       intersecting_side.intersection->oldest_retriangulation_triangle) {
@@ -1584,11 +1765,11 @@ std::optional<ExtrudedVertex> Geometry::MakeWindingCorrectedIntersectionVertex(
 
   std::optional<Segment> last_cw_left_segment =
       FindLastClockwiseWindingMultiTriangleFanSegment(
-          mesh_, left_side_, affected_offset_ranges.left,
+          vertex_positions_, left_side_, affected_offset_ranges.left,
           intersection_vertex.position);
   std::optional<Segment> last_cw_right_segment =
       FindLastClockwiseWindingMultiTriangleFanSegment(
-          mesh_, right_side_, affected_offset_ranges.right,
+          vertex_positions_, right_side_, affected_offset_ranges.right,
           intersection_vertex.position);
   if (!last_cw_left_segment.has_value() && !last_cw_right_segment.has_value()) {
     // No correction needed.
@@ -1686,10 +1867,12 @@ std::optional<ExtrudedVertex> Geometry::MakeWindingCorrectedIntersectionVertex(
                .p2 = corrected_position}
               .SignedArea() < 0 ||
       FindLastClockwiseWindingMultiTriangleFanSegment(
-          mesh_, left_side_, affected_offset_ranges.left, corrected_position)
+          vertex_positions_, left_side_, affected_offset_ranges.left,
+          corrected_position)
           .has_value() ||
       FindLastClockwiseWindingMultiTriangleFanSegment(
-          mesh_, right_side_, affected_offset_ranges.right, corrected_position)
+          vertex_positions_, right_side_, affected_offset_ranges.right,
+          corrected_position)
           .has_value()) {
     return std::nullopt;
   }
@@ -1744,7 +1927,8 @@ bool Geometry::MovingStartingOutlineVerticesWouldCauseClockwiseTriangle(
     opposite_offset_range.last = LastOutlineIndexOffset(opposite_side);
   }
   return FindLastClockwiseWindingMultiTriangleFanSegment(
-             mesh_, opposite_side, opposite_offset_range, target_position)
+             vertex_positions_, opposite_side, opposite_offset_range,
+             target_position)
       .has_value();
 }
 
@@ -1787,9 +1971,9 @@ void Geometry::UpdateIntersectionPivotVertices(
     triangle_indices = mesh_.GetTriangleIndices(
         intersecting_side.intersection->oldest_retriangulation_triangle);
   }
-  ExtrudedVertex a = mesh_.GetVertex(triangle_indices[0]);
-  ExtrudedVertex b = mesh_.GetVertex(triangle_indices[1]);
-  ExtrudedVertex c = mesh_.GetVertex(triangle_indices[2]);
+  ExtrudedVertex a = GetVertex(triangle_indices[0]);
+  ExtrudedVertex b = GetVertex(triangle_indices[1]);
+  ExtrudedVertex c = GetVertex(triangle_indices[2]);
   ExtrudedVertex replacement =
       BarycentricLerp(a, b, c, new_pivot_vertex.position);
 
@@ -1863,7 +2047,7 @@ void Geometry::UpdateIntersectionOuterVertices(
     MutableMeshView::IndexType pivoting_index =
         indices[intersecting_side.first_triangle_vertex];
     if (pivoting_index <= pivot_start) break;
-    if (mesh_.GetVertex(pivoting_index).texture_coords ==
+    if (GetVertex(pivoting_index).texture_coords ==
         kWindingTextureCoordinateSentinelValue) {
       pivot_last_triangle = i - 1;
       break;
@@ -1886,7 +2070,7 @@ void Geometry::UpdateIntersectionOuterVertices(
       --i;
       continue;
     }
-    if (mesh_.GetVertex(indices[intersecting_side.first_triangle_vertex])
+    if (GetVertex(indices[intersecting_side.first_triangle_vertex])
             .texture_coords != kWindingTextureCoordinateSentinelValue) {
       break;
     }
@@ -1926,8 +2110,8 @@ void Geometry::UpdateIntersectionOuterVertices(
     current_position = previous_position;
   }
 
-  Point secondary_coords_start = mesh_.GetVertex(pivot_start).texture_coords;
-  Point secondary_coords_end = mesh_.GetVertex(pivot_end).texture_coords;
+  Point secondary_coords_start = GetVertex(pivot_start).texture_coords;
+  Point secondary_coords_end = GetVertex(pivot_end).texture_coords;
 
   // Iterate from `first_outside_index` to `last_outside_index` again to
   // interpolate the secondary texture coordinates.
@@ -1942,7 +2126,7 @@ void Geometry::UpdateIntersectionOuterVertices(
     float t = current_distance_covered / total_distance_covered;
     Point interpolated_secondary_coords = geometry_internal::Lerp(
         secondary_coords_start, secondary_coords_end, t);
-    ExtrudedVertex vertex = mesh_.GetVertex(*it);
+    ExtrudedVertex vertex = GetVertex(*it);
     vertex.secondary_texture_coords = interpolated_secondary_coords;
     SetVertex(*it, vertex);
     ++it;
@@ -1951,7 +2135,7 @@ void Geometry::UpdateIntersectionOuterVertices(
         DistanceBetween(current_position, next_position);
     current_position = next_position;
   }
-  ExtrudedVertex vertex = mesh_.GetVertex(*it);
+  ExtrudedVertex vertex = GetVertex(*it);
   vertex.secondary_texture_coords = secondary_coords_end;
   SetVertex(*it, vertex);
 }
@@ -1979,9 +2163,9 @@ void Geometry::TryFinishIntersectionHandling(
   if (result.remaining_search_budget <
       intersecting_side.intersection->initial_outline_reposition_budget) {
     ExtrudedVertex outline_from_vert =
-        mesh_.GetVertex(outline[result.segment_intersection->starting_index]);
+        GetVertex(outline[result.segment_intersection->starting_index]);
     ExtrudedVertex outline_to_vert =
-        mesh_.GetVertex(outline[result.segment_intersection->ending_index]);
+        GetVertex(outline[result.segment_intersection->ending_index]);
     pivot_start_vertex = LerpAlongExterior(
         intersecting_side, outline_from_vert, outline_to_vert,
         result.segment_intersection->outline_interpolation_value);
@@ -1996,7 +2180,7 @@ void Geometry::TryFinishIntersectionHandling(
     // of the actual intersection location to prevent a sharp concavity in the
     // outline.
     pivot_start_vertex =
-        mesh_.GetVertex(outline[result.segment_intersection->ending_index]);
+        GetVertex(outline[result.segment_intersection->ending_index]);
     pivot_end_vertex = pivot_start_vertex;
     result.segment_intersection->outline_interpolation_value = 1;
     result.segment_intersection->position = pivot_start_vertex.position;
@@ -2041,7 +2225,7 @@ void Geometry::TryFinishIntersectionHandling(
               intersecting_side.indices.begin() +
               intersecting_side.intersection->starting_offset + 1;
           AssignVerticesInRange(target + 1, intersection_pivot,
-                                mesh_.GetVertex(*target));
+                                GetVertex(*target));
         }
       }
     }
@@ -2062,7 +2246,7 @@ void Geometry::TryFinishIntersectionHandling(
           intersecting_side.intersection->starting_offset;
       AssignVerticesInRange(intersection_start_index + 1,
                             intersecting_side.indices.end(),
-                            mesh_.GetVertex(*intersection_start_index));
+                            GetVertex(*intersection_start_index));
       UndoIntersectionRetriangulation(intersecting_side);
     }
     intersecting_side.intersection.reset();
@@ -2081,7 +2265,7 @@ void Geometry::TryFinishIntersectionHandling(
         intersecting_side.intersection->starting_offset;
     AssignVerticesInRange(intersection_start_index + 1,
                           intersecting_side.indices.end() - 1,
-                          mesh_.GetVertex(*intersection_start_index));
+                          GetVertex(*intersection_start_index));
   }
   SetVertex(intersecting_side.indices.back(), pivot_end_vertex);
   UndoIntersectionRetriangulation(intersecting_side);
@@ -2091,6 +2275,19 @@ void Geometry::TryFinishIntersectionHandling(
   intersecting_side.intersection.reset();
 }
 
+void Geometry::SuspendIntersectionHandlingIfOverBudget() {
+  if (!adaptive_intersection_handling_ || intersection_handling_suspended_ ||
+      retriangulated_triangle_count_ <= adaptive_retriangulation_budget_) {
+    return;
+  }
+  // Keep the retriangulation done so far, the same as when an intersection
+  // runs out of outline reposition budget.
+  GiveUpIntersectionHandling(left_side_);
+  GiveUpIntersectionHandling(right_side_);
+  intersection_handling_suspended_ = true;
+  AddToStatsCounter(stats_.intersection_handling_fallbacks, 1);
+}
+
 void Geometry::GiveUpIntersectionHandling(Side& intersecting_side) {
   if (!intersecting_side.intersection.has_value()) return;
 
@@ -2253,7 +2450,7 @@ void Geometry::UndoNonCcwPartitionSeparationIfNeeded(
     auto target_index = side.indices.begin() +
                         side.partition_start.adjacent_first_index_offset - 1;
     AssignVerticesInRange(target_index + 1, side.indices.end(),
-                          mesh_.GetVertex(*target_index));
+                          GetVertex(*target_index));
   };
 
   if (proposed_winding == TriangleWinding::kCounterClockwise &&
@@ -2399,7 +2596,8 @@ void Geometry::TriangleBuilder::TryAppend(Side& new_vertex_side) {
     return;
   }
 
-  if (!geometry_->handle_self_intersections_) {
+  if (!geometry_->handle_self_intersections_ ||
+      geometry_->intersection_handling_suspended_) {
     geometry_->AppendVertexToMesh(new_vertex_side, next_vertex);
     return;
   }
@@ -2410,7 +2608,10 @@ void Geometry::TriangleBuilder::TryAppend(Side& new_vertex_side) {
 
   SlowPathTriangleInfo info =
       MakeSlowPathInfo(proposed_winding, new_vertex_side, next_vertex);
-  TryAppendSlowPath(proposed_winding, info);
+  {
+    ScopedStatsTimer timer(geometry_->stats_.intersection_handling_nanos);
+    TryAppendSlowPath(proposed_winding, info);
+  }
 
   if (new_vertex_side.intersection.has_value() &&
       info.proposed_vertex_triangle.has_value()) {
@@ -2418,6 +2619,7 @@ void Geometry::TriangleBuilder::TryAppend(Side& new_vertex_side) {
     new_vertex_side.intersection->last_proposed_vertex_triangle =
         *info.proposed_vertex_triangle;
   }
+  geometry_->SuspendIntersectionHandlingIfOverBudget();
 }
 
 void Geometry::TriangleBuilder::TryAppendSlowPath(
@@ -2531,7 +2733,7 @@ void Geometry::TriangleBuilder::HandleCcwAdjacentIntersectingTriangleHelper(
   float saved_budget =
       info.adjacent_side->intersection->outline_reposition_budget;
   ExtrudedVertex saved_adjacent =
-      geometry_->mesh_.GetVertex(start_adjacent_outline[0]);
+      geometry_->GetVertex(start_adjacent_outline[0]);
   bool intersection_found = geometry_->MoveStartingVerticesToIntersection(
       *info.adjacent_side, start_adjacent_outline, proposed_left_right_edge,
       initial_outline_reposition_budget_);
@@ -2739,7 +2941,7 @@ void Geometry::TriangleBuilder::HandleNonCcwNonIntersectingTriangle(
         // Use the connection index if it exists and if the opposite side's
         // first vertex has not been repositioned since the partition was
         // created.
-        target_vertex = geometry_->mesh_.GetVertex(
+        target_vertex = geometry_->GetVertex(
             *info.adjacent_side->partition_start.non_ccw_connection_index);
       } else {
         // Otherwise, we will try to move the starting vertices of the outline
@@ -2750,7 +2952,7 @@ void Geometry::TriangleBuilder::HandleNonCcwNonIntersectingTriangle(
       // If we are not intersecting the segment that connects the two sides of
       // the stroke, the target will be the next vertex in the outline.
       target_vertex =
-          geometry_->mesh_.GetVertex(start_adjacent_outline[ending_index]);
+          geometry_->GetVertex(start_adjacent_outline[ending_index]);
     }
   }
 
@@ -2968,7 +3170,7 @@ void Geometry::TriangleBuilder::HandleNonCcwBothSidesIntersectingTriangle(
   // side, we must check that the triangle made from the leading left-right
   // edge and the second outline position would have correct winding order.
   ExtrudedVertex opposite_outline_second_vertex =
-      geometry_->mesh_.GetVertex(start_opposite_outline[1]);
+      geometry_->GetVertex(start_opposite_outline[1]);
   if (geometry_->ProposedTriangleWinding(
           opposite_outline_second_vertex.position) ==
       TriangleWinding::kCounterClockwise) {
@@ -3004,7 +3206,8 @@ void Geometry::SetVertex(MutableMeshView::IndexType index,
                          bool update_envelope_of_removed_geometry) {
   if (update_save_state && save_point_state_.is_active &&
       index < save_point_state_.n_mesh_vertices) {
-    save_point_state_.saved_vertices.emplace(index, mesh_.GetVertex(index));
+    save_point_state_.vertex_journal.emplace_back(index,
+                                                  GetVertex(index));
   }
 
   if (update_envelope_of_removed_geometry) {
@@ -3018,6 +3221,8 @@ void Geometry::SetVertex(MutableMeshView::IndexType index,
   }
 
   mesh_.SetVertex(index, new_vertex);
+  vertex_color_sources_[index] = new_vertex.color_source;
+  vertex_positions_[index] = new_vertex.position;
 }
 
 void Geometry::SetTriangleIndices(
@@ -3026,7 +3231,7 @@ void Geometry::SetTriangleIndices(
     bool update_save_state) {
   if (update_save_state && save_point_state_.is_active &&
       triangle_index < save_point_state_.n_mesh_triangles) {
-    save_point_state_.saved_triangle_indices.emplace(
+    save_point_state_.triangle_indices_journal.emplace_back(
         triangle_index, mesh_.GetTriangleIndices(triangle_index));
   }
 
@@ -3040,8 +3245,8 @@ void Geometry::UpdateOppositeSideOffset(MutableMeshView::IndexType index,
   if (current_offset == new_offset) return;
   if (update_save_state && save_point_state_.is_active &&
       index < save_point_state_.n_mesh_vertices) {
-    save_point_state_.saved_opposite_side_offsets.emplace(index,
-                                                          current_offset);
+    save_point_state_.opposite_side_offset_journal.emplace_back(
+        index, current_offset);
   }
   current_offset = new_offset;
 }
@@ -3051,7 +3256,7 @@ void Geometry::BeginSuperImposedPivotFan(Side& fan_pivot_side,
   // Update the texture coordinates of the pivot start to sync with the outside
   // of the turn and append a new vertex to becoming the central vertex that
   // will be part of the triangle fan.
-  ExtrudedVertex pivot = mesh_.GetVertex(fan_pivot_side.indices.back());
+  ExtrudedVertex pivot = GetVertex(fan_pivot_side.indices.back());
   pivot.texture_coords.x = LastVertex(fan_outer_side).texture_coords.x;
   SetVertex(fan_pivot_side.indices.back(), pivot);
   pivot.texture_coords = kWindingTextureCoordinateSentinelValue;
@@ -3063,7 +3268,7 @@ void Geometry::EndSuperImposedPivotFan(Side& fan_pivot_side,
   // Append a new vertex to become the end of the pivot, and ensure that its
   // texture coordinates sync with the outside of the turn.
   ExtrudedVertex pivot_end =
-      mesh_.GetVertex(*(fan_pivot_side.indices.rbegin() + 1));
+      GetVertex(*(fan_pivot_side.indices.rbegin() + 1));
   pivot_end.texture_coords.x = LastVertex(fan_outer_side).texture_coords.x;
   AppendVertexToMesh(fan_pivot_side, pivot_end);
 }
@@ -3073,10 +3278,10 @@ bool Geometry::MeshEndsInSuperImposedPivot() const {
     return false;
   }
   return (left_side_.indices.size() > 1 &&
-          mesh_.GetVertex(*(left_side_.indices.rbegin() + 1)).texture_coords ==
+          GetVertex(*(left_side_.indices.rbegin() + 1)).texture_coords ==
               kWindingTextureCoordinateSentinelValue) ||
          (right_side_.indices.size() > 1 &&
-          mesh_.GetVertex(*(right_side_.indices.rbegin() + 1)).texture_coords ==
+          GetVertex(*(right_side_.indices.rbegin() + 1)).texture_coords ==
               kWindingTextureCoordinateSentinelValue);
 }
 
@@ -3111,7 +3316,7 @@ void Geometry::PrepBufferedVerticesForNextExtrusion(
         (n_triangles > 1 &&
          side.indices.back() == mesh_.GetVertexIndex(n_triangles - 2, 2))) {
       side.vertex_buffer.push_back(
-          mesh_.GetVertex(*(side.indices.rbegin() + 1)));
+          GetVertex(*(side.indices.rbegin() + 1)));
       ++side.next_buffered_vertex_offset;
     }
   }
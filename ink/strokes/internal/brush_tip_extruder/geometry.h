@@ -19,14 +19,14 @@
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/base/nullability.h"
-#include "absl/container/btree_map.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/types/span.h"
 #include "ink/geometry/envelope.h"
+#include "ink/geometry/mutable_mesh.h"
 #include "ink/geometry/point.h"
 #include "ink/geometry/segment.h"
 #include "ink/geometry/triangle.h"
@@ -37,6 +37,7 @@
 #include "ink/strokes/internal/brush_tip_extruder/side.h"
 #include "ink/strokes/internal/brush_tip_state.h"
 #include "ink/strokes/internal/legacy_vertex.h"
+#include "ink/strokes/stroke_shape_stats.h"
 
 namespace ink {
 namespace brush_tip_extruder_internal {
@@ -110,22 +111,38 @@ struct GeometrySavePointState {
   std::vector<SideId> saved_vertex_side_ids;
   std::vector<uint32_t> saved_side_offsets;
 
-  // A record of any vertices, triangle indices, and opposite side offsets that
-  // existed prior to setting the save point and have been modified since.
-  //
-  // We expect a small number will need to be saved, but without expected order,
-  // so we use maps for simpler bookkeeping during extrusion instead of trying
-  // to store a sub-vectors for faster revert.
-  //
-  // We use `btree_map` rather than `flat_hash_map` for `saved_vertices` and
-  // `saved_triangle_indices`, because when restoring a save point, we need to
-  // be able to re-add removed vertices/triangles in order.
-  absl::btree_map<MutableMeshView::IndexType, ExtrudedVertex> saved_vertices;
-  absl::btree_map<MutableMeshView::IndexType,
-                  std::array<MutableMeshView::IndexType, 3>>
-      saved_triangle_indices;
-  absl::flat_hash_map<MutableMeshView::IndexType, uint32_t>
-      saved_opposite_side_offsets;
+  // Saved values of the mesh vertices, triangle indices, and
+  // `Geometry::opposite_side_offsets_` that were present at the save point and
+  // have been deleted by `ClearSinceLastExtrusionBreak`. Like the two vectors
+  // above, these are captured at most once per save point as contiguous chunks
+  // that end at `n_mesh_vertices` and `n_mesh_triangles`.
+  std::vector<ExtrudedVertex> saved_vertices;
+  std::vector<std::array<MutableMeshView::IndexType, 3>> saved_triangle_indices;
+  std::vector<uint32_t> saved_opposite_side_offsets;
+
+  // Append-only journals of the prior values of any vertices, triangle indices,
+  // and opposite side offsets that existed at the save point and have been
+  // modified since. Each mutation appends one entry, without checking whether
+  // the same element was already recorded, so reverting walks each journal
+  // backwards and the oldest recorded value is the one left in place.
+  //
+  // This keeps bookkeeping during extrusion to a single `push_back()`, and the
+  // cost of reverting proportional to the number of mutations made since the
+  // save point rather than to the size of the saved geometry.
+  std::vector<std::pair<MutableMeshView::IndexType, ExtrudedVertex>>
+      vertex_journal;
+  std::vector<std::pair<uint32_t, std::array<MutableMeshView::IndexType, 3>>>
+      triangle_indices_journal;
+  std::vector<std::pair<MutableMeshView::IndexType, uint32_t>>
+      opposite_side_offset_journal;
+
+  // The sizes of the three journals above when the contiguous chunks were
+  // captured. Journal entries recorded after the capture may hold values that
+  // were themselves written after the save point, so the captured chunks must
+  // be restored after undoing those entries but before undoing older ones.
+  size_t vertex_journal_size_at_capture = 0;
+  size_t triangle_indices_journal_size_at_capture = 0;
+  size_t opposite_side_offset_journal_size_at_capture = 0;
 
   GeometryLastExtrusionBreakMetadata saved_last_extrusion_break;
 
@@ -140,7 +157,25 @@ struct GeometrySavePointState {
 // `MutableMeshView`.
 class Geometry {
  public:
-  enum class IntersectionHandling { kEnabled, kDisabled };
+  // How self-intersecting geometry is handled:
+  //   * `kEnabled`: Always fully handled, by retriangulating existing
+  //     geometry, which can touch a growing number of triangles when the
+  //     stroke loops tightly over itself.
+  //   * `kDisabled`: Never handled; self-overlapping geometry may render with
+  //     artifacts when drawn with translucent colors or winding textures.
+  //   * `kAdaptive`: Handled as for `kEnabled`, until the triangles
+  //     retriangulated during one call to `ProcessNewVertices()` exceed the
+  //     budget set by `SetAdaptiveRetriangulationBudget()`. Any ongoing
+  //     self-intersection is then given up, and the rest of that call proceeds
+  //     as for `kDisabled`. Handling resumes on the next call. The same budget
+  //     also bounds how many of the newest triangles are searched for one
+  //     containing an intersecting vertex, so that a vertex that overlaps
+  //     only much older geometry is treated as not intersecting.
+  enum class IntersectionHandling { kEnabled, kDisabled, kAdaptive };
+
+  // The budget used by `IntersectionHandling::kAdaptive` until
+  // `SetAdaptiveRetriangulationBudget()` is called.
+  static constexpr uint32_t kDefaultAdaptiveRetriangulationBudget = 512;
 
   // A size-type for outline indices.
   struct IndexCounts {
@@ -168,8 +203,17 @@ class Geometry {
   void SetTextureCoordType(TextureCoordType type);
 
   // Sets whether or not to handle self-intersections. Enabled by default.
+  //
+  // Disabling intersection handling part way through a stroke gives up on any
+  // ongoing self-intersection, keeping the triangles modified for it so far.
   void SetIntersectionHandling(IntersectionHandling intersection_handling);
 
+  // Sets the number of existing triangles that may be retriangulated by
+  // self-intersection handling during one call to `ProcessNewVertices()` when
+  // using `IntersectionHandling::kAdaptive`. Has no effect in other modes. Not
+  // affected by `Reset()`.
+  void SetAdaptiveRetriangulationBudget(uint32_t max_triangles);
+
   // The following return the offsets into `Side::indices` for the first new or
   // modified index in the last outline belonging to the left and right sides.
   uint32_t FirstMutatedLeftIndexOffsetInCurrentPartition() const;
@@ -177,11 +221,24 @@ class Geometry {
 
   const MutableMeshView& GetMeshView() const;
 
+  // Points the geometry at `mesh`, a copy of the `MutableMesh` of its current
+  // view, keeping all other state. This is used to copy the geometry of a
+  // stroke together with its mesh. Does nothing if the current view has no
+  // mesh data. See also `MutableMeshView::Rebind()`.
+  void RebindMesh(MutableMesh& mesh);
+
   // Resets the values of member variables tracking mutations, including the
-  // mutation tracking inside the mesh view. See also
-  // `MutableMeshView::ResetMutationTracking()`.
+  // mutation tracking inside the mesh view and the values returned by
+  // `GetStats()`. See also `MutableMeshView::ResetMutationTracking()`.
   void ResetMutationTracking();
 
+  // Returns the simplification and intersection handling times, the reverted
+  // and simplified vertex counts, and the intersection handling fallback count
+  // since the most recent call to `ResetMutationTracking()`. The other values
+  // in the returned stats are always zero. See also
+  // `kStrokeShapeStatsEnabled`.
+  const StrokeShapeStats& GetStats() const;
+
   // Returns the bounding region of the mesh that has visually changed since
   // either construction or the most recent call to either `Reset()` or
   // `ResetMutationTracking()`.
@@ -215,12 +272,19 @@ class Geometry {
   // called.
   //
   // TODO: b/271837965 - Add parameters for winding texture coordinates.
-  void AppendLeftVertex(Point position, float opacity_shift = 0,
-                        const std::array<float, 3>& hsl_shift = {},
-                        Point surface_uv = {0, 0}, float animation_offset = 0);
-  void AppendRightVertex(Point position, float opacity_shift = 0,
-                         const std::array<float, 3>& hsl_shift = {},
-                         Point surface_uv = {0, 0}, float animation_offset = 0);
+  //
+  // `color_source` is recorded as the `ExtrudedVertex::color_source` of the new
+  // vertex; see also `RecolorSinceSavePoint()`.
+  void AppendLeftVertex(
+      Point position, float opacity_shift = 0,
+      const std::array<float, 3>& hsl_shift = {}, Point surface_uv = {0, 0},
+      float animation_offset = 0,
+      uint32_t color_source = ExtrudedVertex::kFixedColorSource);
+  void AppendRightVertex(
+      Point position, float opacity_shift = 0,
+      const std::array<float, 3>& hsl_shift = {}, Point surface_uv = {0, 0},
+      float animation_offset = 0,
+      uint32_t color_source = ExtrudedVertex::kFixedColorSource);
 
   // The following functions append the legacy vertex types to the appropriate
   // sides:
@@ -236,13 +300,17 @@ class Geometry {
   //      meaningfully contribute to the curvature of the line.
   //   * `last_tip_state` is the most recent `BrushTipState` used to create the
   //     vertices to be triangulated.
+  //   * `handle_self_intersections` can be set to false to skip intersection
+  //     handling for these vertices, regardless of `SetIntersectionHandling()`,
+  //     when they are known not to overlap the geometry before them, e.g.
+  //     because they outline a whole particle since the last extrusion break.
   //
   // This function only performs an action if there are left and right vertices.
   // In other words, if vertices have only been added to one side, calling this
   // function will not result in simplification of that side.
-  void ProcessNewVertices(
-      float simplification_threshold,
-      const strokes_internal::BrushTipState& last_tip_state);
+  void ProcessNewVertices(float simplification_threshold,
+                          const strokes_internal::BrushTipState& last_tip_state,
+                          bool handle_self_intersections = true);
 
   // Starts a new logical partition of the stroke mesh that will be visibly
   // disconnected from existing geometry.
@@ -258,6 +326,32 @@ class Geometry {
   // Number of extrusion breaks.
   uint32_t ExtrusionBreakCount() const;
 
+  // The per-vertex color attributes that can be replaced by
+  // `RecolorSinceSavePoint()`.
+  struct VertexColorShift {
+    float opacity_shift = 0;
+    std::array<float, 3> hsl_shift = {0, 0, 0};
+  };
+
+  // Returns true if a save point is set, no geometry from before the save point
+  // has been cleared by `ClearSinceLastExtrusionBreak()`, and none of the
+  // vertices that were added or modified since the save point have colors
+  // interpolated from vertices with different `ExtrudedVertex::color_source`
+  // values.
+  //
+  // Extrusion itself never depends on vertex colors, so when this is true,
+  // repeating the same extrusion since the save point with only different
+  // colors would produce the same mesh as calling `RecolorSinceSavePoint()`.
+  bool CanRecolorSinceSavePoint() const;
+
+  // Replaces the color attributes of every vertex added or modified since the
+  // save point whose `color_source` is an index into `color_shifts` with the
+  // value at that index. Vertices with any other `color_source` are left as
+  // is. The save point itself is not affected.
+  //
+  // This should only be called when `CanRecolorSinceSavePoint()` is true.
+  void RecolorSinceSavePoint(absl::Span<const VertexColorShift> color_shifts);
+
   // Counts of left and right indices at the last extrusion break.
   IndexCounts IndexCountsAtLastExtrusionBreak() const;
 
@@ -289,6 +383,10 @@ class Geometry {
     kDegenerate,
   };
 
+  // Returns the vertex at `index` in `mesh_`, together with its
+  // `color_source` from `vertex_color_sources_`.
+  ExtrudedVertex GetVertex(MutableMeshView::IndexType index) const;
+
   // Returns the vertex associated with the last index in `side.indices`.
   ExtrudedVertex LastVertex(const Side& side) const;
   // Returns the position of the vertex associated with the last index in
@@ -356,7 +454,9 @@ class Geometry {
   // This function tests triangles in reverse from the end of the mesh until
   // `search_along_side.partition_start.first_triangle`. It will exit early if
   // it iterates past `max_early_exit_triangle` and finds that `segment` is not
-  // contained in one of the tested triangles.
+  // contained in one of the tested triangles. With
+  // `IntersectionHandling::kAdaptive`, it also tests no more than
+  // `adaptive_retriangulation_budget_` triangles.
   std::optional<uint32_t> FindLastTriangleContainingSegmentEnd(
       const Side& search_along_side, const Segment& segment,
       uint32_t max_early_exit_triangle) const;
@@ -667,7 +767,28 @@ class Geometry {
                                    float intersection_travel_limit,
                                    float retriangulation_travel_threshold);
 
+  // Records that self-intersection handling has retriangulated
+  // `triangle_count` more existing triangles in the current call to
+  // `ProcessNewVertices()`.
+  void AddRetriangulationWork(uint32_t triangle_count);
+
+  // In `IntersectionHandling::kAdaptive` mode, gives up any ongoing
+  // self-intersections and suspends intersection handling for the rest of the
+  // current call to `ProcessNewVertices()` if the retriangulation budget has
+  // been exceeded.
+  void SuspendIntersectionHandlingIfOverBudget();
+
   bool handle_self_intersections_ = true;
+  bool adaptive_intersection_handling_ = false;
+  uint32_t adaptive_retriangulation_budget_ =
+      kDefaultAdaptiveRetriangulationBudget;
+  // The number of existing triangles retriangulated so far in the current call
+  // to `ProcessNewVertices()`.
+  uint32_t retriangulated_triangle_count_ = 0;
+  // True if intersection handling is suspended for the rest of the current
+  // call to `ProcessNewVertices()`, either by its caller or by
+  // `SuspendIntersectionHandlingIfOverBudget()`.
+  bool intersection_handling_suspended_ = false;
 
   TextureCoordType texture_coord_type_ = TextureCoordType::kTiling;
 
@@ -681,6 +802,14 @@ class Geometry {
   // For each vertex in `mesh_`, stores the first offset into the opposite
   // side's `indices` for a vertex that can be part of the same triangle.
   std::vector<uint32_t> opposite_side_offsets_;
+  // For each vertex in `mesh_`, stores its `ExtrudedVertex::color_source`,
+  // which is not part of the mesh data.
+  std::vector<uint32_t> vertex_color_sources_;
+  // For each vertex in `mesh_`, stores a copy of its position. The searches
+  // backwards through the mesh for self-intersection handling read only
+  // positions, and reading them from here keeps those searches to one packed
+  // array instead of decoding each vertex from the mesh.
+  std::vector<Point> vertex_positions_;
 
   // The left and right sides of the line according to the direction of travel.
   Side left_side_;
@@ -712,6 +841,8 @@ class Geometry {
   uint32_t first_mutated_right_index_offset_in_current_partition_ = 0;
 
   DerivativeCalculator derivative_calculator_;
+
+  StrokeShapeStats stats_;
 };
 
 // --------------------------------------------------------------------------
@@ -723,6 +854,20 @@ inline void Geometry::SetTextureCoordType(TextureCoordType type) {
 
 inline const MutableMeshView& Geometry::GetMeshView() const { return mesh_; }
 
+inline void Geometry::RebindMesh(MutableMesh& mesh) {
+  if (mesh_.HasMeshData()) mesh_.Rebind(mesh);
+}
+
+inline const StrokeShapeStats& Geometry::GetStats() const { return stats_; }
+
+inline void Geometry::SetAdaptiveRetriangulationBudget(uint32_t max_triangles) {
+  adaptive_retriangulation_budget_ = max_triangles;
+}
+
+inline void Geometry::AddRetriangulationWork(uint32_t triangle_count) {
+  retriangulated_triangle_count_ += triangle_count;
+}
+
 inline const Side& Geometry::LeftSide() const { return left_side_; }
 
 inline const Side& Geometry::RightSide() const { return right_side_; }
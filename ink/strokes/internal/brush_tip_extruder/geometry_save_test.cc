@@ -355,6 +355,38 @@ TEST_F(GeometrySaveTest, ContinueIntersection) {
   EXPECT_THAT(g1.RightSide(), SideEq(g2.RightSide()));
 }
 
+TEST_F(GeometrySaveTest, RepeatedlyMutatedGeometryAcrossMultipleReverts) {
+  // Like `ContinueIntersection`, but the ongoing intersection is extended over
+  // several calls to `ProcessNewVertices()` after the save point, so the same
+  // pre-existing vertices and triangles get modified more than once before
+  // reverting. This is then repeated to check that each revert only undoes
+  // changes made since the most recent save point.
+
+  MeshData m1, m2;
+  Geometry g1(MakeView(m1)), g2(MakeView(m2));
+  Extrude({&g1, &g2}, {
+                          {.left = {{-1, 0}, {-1, 1}, {-1, 2}},
+                           .right = {{1, 0}, {1, 1}, {1, 2}}},
+                          {.left = {{-0.5, 1.5}}, .right = {{0.5, 2.5}}},
+                          {.left = {{0, 1.5}}, .right = {{0, 2.5}}},
+                      });
+  ASSERT_TRUE(g1.LeftSide().intersection.has_value());
+
+  std::vector<Extrusion> volatile_extrusions = {
+      {.left = {{0, 1}}, .right = {{-1, 2.5}}},
+      {.left = {{0, 0.5}}, .right = {{-2, 1}}},
+      {.left = {{0.25, 0.25}}, .right = {{-2, 0.5}}},
+  };
+  for (int i = 0; i < 3; ++i) {
+    g1.SetSavePoint();
+    Extrude(&g1, volatile_extrusions);
+    g1.RevertToSavePoint();
+    EXPECT_THAT(m1, VerticesAndIndicesEq(m2));
+    EXPECT_THAT(g1.LeftSide(), SideEq(g2.LeftSide()));
+    EXPECT_THAT(g1.RightSide(), SideEq(g2.RightSide()));
+  }
+}
+
 TEST_F(GeometrySaveTest, EndIntersection) {
   // Extrusion travels up and then sharply to the left. Intersection is ongoing
   // prior to the save point and is finished prior to reverting.
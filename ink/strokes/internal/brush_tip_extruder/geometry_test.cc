@@ -1598,6 +1598,35 @@ TEST(GeometryTest, SelfIntersectionFromTipStatesWithZeroWidth) {
   EXPECT_TRUE(geometry.LeftSide().intersection->retriangulation_started);
 }
 
+TEST(GeometryTest, ProcessNewVerticesWithoutHandlingSelfIntersections) {
+  // Same setup as `SelfIntersectionFromTipStatesWithZeroWidth`, but the last
+  // vertices are processed with intersection handling skipped by the caller.
+  MeshData mesh_data;
+  Geometry geometry(MakeView(mesh_data));
+  auto zero_width_tip_state = [](Point p) {
+    return BrushTipState{.position = p, .width = 0, .height = 1};
+  };
+
+  geometry.AppendLeftVertex(Point{.x = 0, .y = 1});
+  geometry.AppendRightVertex(Point{.x = 0, .y = 0});
+  geometry.ProcessNewVertices(0, zero_width_tip_state({0, 0.5}));
+
+  geometry.AppendLeftVertex(Point{.x = 2, .y = 1});
+  geometry.AppendRightVertex(Point{.x = 2, .y = 0});
+  geometry.ProcessNewVertices(0, zero_width_tip_state({1, 0.5}));
+  ASSERT_EQ(geometry.GetMeshView().TriangleCount(), 2);
+
+  geometry.AppendLeftVertex(Point{.x = 1, .y = 0.5});
+  geometry.AppendRightVertex(Point{.x = 3, .y = 0.5});
+  geometry.ProcessNewVertices(0, zero_width_tip_state({1, 0.5}),
+                              /* handle_self_intersections = */ false);
+
+  EXPECT_FALSE(geometry.LeftSide().intersection.has_value());
+  EXPECT_FALSE(geometry.RightSide().intersection.has_value());
+  EXPECT_EQ(geometry.GetMeshView().VertexCount(), 6);
+  EXPECT_THAT(geometry.GetMeshView(), TrianglesAreNotCw());
+}
+
 TEST(GeometryTest, FirstMutatedIndexOffsets) {
   MeshData mesh_data;
   Geometry geometry(MakeView(mesh_data));
@@ -48,6 +48,11 @@ MutableMeshView::MutableMeshView(
   ResetMutationTracking();
 }
 
+void MutableMeshView::Rebind(MutableMesh& mesh) {
+  ABSL_CHECK(std::holds_alternative<MutableMesh*>(data_));
+  data_ = &mesh;
+}
+
 void MutableMeshView::Clear() {
   if (LegacyVectors* legacy = std::get_if<LegacyVectors>(&data_)) {
     legacy->vertices->clear();
@@ -82,6 +82,12 @@ class MutableMeshView {
   MutableMeshView(const MutableMeshView&) = default;
   MutableMeshView& operator=(const MutableMeshView&) = default;
 
+  // Points this view at `mesh` in place of its current `MutableMesh`, keeping
+  // the mutation tracking. This is meant for a copy of a view whose mesh was
+  // copied along with it, so `mesh` should hold the same data as the current
+  // mesh. CHECK-fails if this view does not reference a `MutableMesh`.
+  void Rebind(MutableMesh& mesh);
+
   // Removes all triangles and vertices from the underlying mesh data. If
   // `HasMeshData()` is false, this is a no-op.
   void Clear();
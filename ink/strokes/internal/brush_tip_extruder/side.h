@@ -126,7 +126,8 @@ struct Side {
   // up intersection handling. Indices within each range will permanently be
   // part of triangles whose vertices all belong to this side. The first and
   // last index in each range are the only ones that will be part of triangles
-  // connecting to the opposite side of the geometry.
+  // connecting to the opposite side of the geometry. The ranges do not overlap
+  // and are ordered by offset.
   std::vector<IndexOffsetRange> intersection_discontinuities;
   // The start of the current partition used for searching mesh triangles and
   // creating `DirectedPartialOutline`s for intersection handling.
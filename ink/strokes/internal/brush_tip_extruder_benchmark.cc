@@ -0,0 +1,100 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/vec.h"
+#include "ink/strokes/internal/brush_tip_extruder.h"
+#include "ink/strokes/internal/brush_tip_state.h"
+#include "ink/strokes/internal/stroke_shape_update.h"
+#include "ink/strokes/internal/stroke_vertex.h"
+
+namespace ink::strokes_internal {
+namespace {
+
+constexpr float kBrushEpsilon = 0.01;
+constexpr float kTipRadius = 1;
+constexpr int kStatesPerTurn = 64;
+
+// Returns `n_states` circular tip states along an Archimedean spiral whose
+// turns are much closer together than the tip is wide, so that every turn
+// overlaps the ones before it. This keeps the extruder handling
+// self-intersections, and accumulating intersection discontinuities, for the
+// whole stroke.
+std::vector<BrushTipState> MakeTightSpiralTipStates(int64_t n_states) {
+  std::vector<BrushTipState> states;
+  states.reserve(n_states);
+  for (int64_t i = 0; i < n_states; ++i) {
+    float turns = static_cast<float>(i) / kStatesPerTurn;
+    Point position =
+        Point{0, 0} +
+        Vec::FromDirectionAndMagnitude(kFullTurn * turns, 2 + 0.1f * turns);
+    states.push_back({.position = position,
+                      .width = 2 * kTipRadius,
+                      .height = 2 * kTipRadius,
+                      .percent_radius = 1});
+  }
+  return states;
+}
+
+// Extrudes a tight spiral one fixed state at a time, the way it would be
+// extended while drawing.
+void BM_ExtrudeTightSpiralIncrementally(benchmark::State& state) {
+  std::vector<BrushTipState> tip_states =
+      MakeTightSpiralTipStates(state.range(0));
+  MutableMesh mesh(StrokeVertex::FullMeshFormat());
+  BrushTipExtruder extruder;
+  for (auto s : state) {
+    extruder.StartStroke(kBrushEpsilon,
+                         /* is_stamping_texture_particle_brush = */ false,
+                         mesh);
+    for (const BrushTipState& tip_state : tip_states) {
+      StrokeShapeUpdate update = extruder.ExtendStroke({&tip_state, 1}, {});
+      benchmark::DoNotOptimize(update);
+    }
+    benchmark::DoNotOptimize(mesh);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExtrudeTightSpiralIncrementally)
+    ->Range(kStatesPerTurn, 64 * kStatesPerTurn);
+
+// Extrudes a tight spiral all at once.
+void BM_ExtrudeTightSpiralAllAtOnce(benchmark::State& state) {
+  std::vector<BrushTipState> tip_states =
+      MakeTightSpiralTipStates(state.range(0));
+  MutableMesh mesh(StrokeVertex::FullMeshFormat());
+  BrushTipExtruder extruder;
+  for (auto s : state) {
+    extruder.StartStroke(kBrushEpsilon,
+                         /* is_stamping_texture_particle_brush = */ false,
+                         mesh);
+    StrokeShapeUpdate update = extruder.ExtendStroke(tip_states, {});
+    benchmark::DoNotOptimize(update);
+    benchmark::DoNotOptimize(mesh);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExtrudeTightSpiralAllAtOnce)
+    ->Range(kStatesPerTurn, 64 * kStatesPerTurn);
+
+}  // namespace
+}  // namespace ink::strokes_internal
@@ -30,6 +30,8 @@
 #include "ink/strokes/internal/brush_tip_state.h"
 #include "ink/strokes/internal/stroke_shape_update.h"
 #include "ink/strokes/internal/stroke_vertex.h"
+#include "ink/strokes/stroke_shape_budget.h"
+#include "ink/strokes/stroke_shape_stats.h"
 
 namespace ink::strokes_internal {
 namespace {
@@ -351,6 +353,50 @@ TEST_F(BrushTipExtruderTest, ExtendCoversRemovedPreviousVolatileGeometry) {
               Optional(RectNear(Rect::FromTwoPoints({-1, -1}, {4, 5}), 0.06)));
 }
 
+TEST_F(BrushTipExtruderTest, RecolorsVolatileGeometryWhenOnlyColorsChange) {
+  std::vector<BrushTipState> fixed_states =
+      MakeUniformCircularTipStates({{0, 0}, {1, 0}, {2, 0}}, 1);
+  std::vector<BrushTipState> volatile_states =
+      MakeUniformCircularTipStates({{3, 0}, {4, 0.5}, {5, 1}}, 1);
+  std::vector<BrushTipState> recolored_volatile_states = volatile_states;
+  for (size_t i = 0; i < recolored_volatile_states.size(); ++i) {
+    recolored_volatile_states[i].opacity_multiplier = 0.25f * i;
+    recolored_volatile_states[i].hue_offset_in_full_turns = 0.1f * i;
+  }
+
+  BrushTipExtruder extruder;
+  extruder.StartStroke(kBrushEpsilon,
+                       /* is_stamping_texture_particle_brush = */ false, mesh_);
+  extruder.ExtendStroke(fixed_states, volatile_states);
+  StrokeShapeUpdate update =
+      extruder.ExtendStroke({}, recolored_volatile_states);
+
+  // Only vertex attributes should have been updated.
+  EXPECT_EQ(update.first_index_offset, std::nullopt);
+  EXPECT_THAT(update.first_vertex_offset, Optional(Gt(0)));
+
+  // The result should match extruding the recolored states from scratch.
+  MutableMesh expected_mesh(StrokeVertex::FullMeshFormat());
+  BrushTipExtruder expected_extruder;
+  expected_extruder.StartStroke(
+      kBrushEpsilon, /* is_stamping_texture_particle_brush = */ false,
+      expected_mesh);
+  expected_extruder.ExtendStroke(fixed_states, recolored_volatile_states);
+
+  ASSERT_EQ(mesh_.VertexCount(), expected_mesh.VertexCount());
+  ASSERT_EQ(mesh_.TriangleCount(), expected_mesh.TriangleCount());
+  EXPECT_THAT(mesh_.RawVertexData(),
+              ElementsAreArray(expected_mesh.RawVertexData()));
+  EXPECT_THAT(mesh_.RawIndexData(),
+              ElementsAreArray(expected_mesh.RawIndexData()));
+  EXPECT_THAT(extruder.GetBounds(), EnvelopeEq(expected_extruder.GetBounds()));
+
+  // Moving the volatile states must still re-extrude them.
+  update = extruder.ExtendStroke(
+      {}, MakeUniformCircularTipStates({{3, 0}, {4, 0}, {5, 0}}, 1));
+  EXPECT_THAT(update.first_index_offset, Optional(Gt(0)));
+}
+
 TEST_F(BrushTipExtruderTest, EmptyExtendRemovesPreviousVolatileGeometry) {
   BrushTipExtruder extruder;
   extruder.StartStroke(kBrushEpsilon,
@@ -543,6 +589,152 @@ TEST_F(BrushTipExtruderTest, AddBreakPointsToNonEmptyStroke) {
   EXPECT_THAT(update.first_vertex_offset, Optional(Eq(last_vertex_count)));
 }
 
+TEST_F(BrushTipExtruderTest, TracksBoundsOfEachExtrusionBreak) {
+  BrushTipExtruder extruder;
+  extruder.StartStroke(/* brush_epsilon = */ 0.06,
+                       /* is_stamping_texture_particle_brush = */ false, mesh_);
+  BrushTipState break_point = {.width = 0, .height = 0};
+  extruder.ExtendStroke({MakeCircularTipState({0, 0}, 1), break_point,
+                         MakeCircularTipState({10, 10}, 1)},
+                        {MakeCircularTipState({20, 0}, 1)});
+
+  ASSERT_EQ(extruder.GetExtrusionBreakBounds().size(), 2);
+  EXPECT_THAT(
+      extruder.GetExtrusionBreakBounds()[0].AsRect(),
+      Optional(RectNear(Rect::FromTwoPoints({-1, -1}, {1, 1}), 0.06)));
+  EXPECT_THAT(extruder.GetExtrusionBreakBounds()[1].AsRect(),
+              Optional(RectNear(
+                  Rect::FromTwoPoints({9, -1}, {21, 11}), 0.06)));
+
+  // Replacing the volatile state only changes the bounds after the last break
+  // among the fixed states.
+  extruder.ExtendStroke({}, {});
+  ASSERT_EQ(extruder.GetExtrusionBreakBounds().size(), 2);
+  EXPECT_THAT(extruder.GetExtrusionBreakBounds()[1].AsRect(),
+              Optional(RectNear(
+                  Rect::FromTwoPoints({9, 9}, {11, 11}), 0.06)));
+  EXPECT_THAT(extruder.GetBounds().AsRect(),
+              Optional(RectNear(
+                  Rect::FromTwoPoints({-1, -1}, {11, 11}), 0.06)));
+}
+
+TEST_F(BrushTipExtruderTest, StopsExtrudingWhenVertexBudgetIsReached) {
+  BrushTipExtruder extruder;
+  extruder.SetBudget({.max_vertices_per_coat = 1});
+  extruder.StartStroke(kBrushEpsilon,
+                       /* is_stamping_texture_particle_brush = */ false, mesh_);
+  EXPECT_FALSE(extruder.ExceededBudget());
+
+  extruder.ExtendStroke(
+      MakeUniformCircularTipStates({{0, 0}, {1, 0}, {2, 1}}, 1), {});
+  EXPECT_TRUE(extruder.ExceededBudget());
+  uint32_t vertex_count = mesh_.VertexCount();
+  EXPECT_GT(vertex_count, 0);
+
+  StrokeShapeUpdate update = extruder.ExtendStroke(
+      MakeUniformCircularTipStates({{3, 1}, {4, 2}}, 1),
+      MakeUniformCircularTipStates({{5, 2}}, 1));
+  EXPECT_TRUE(update.region.IsEmpty());
+  EXPECT_EQ(mesh_.VertexCount(), vertex_count);
+
+  // The budget is kept for the next stroke, but whether it was exceeded is not.
+  extruder.StartStroke(kBrushEpsilon,
+                       /* is_stamping_texture_particle_brush = */ false, mesh_);
+  EXPECT_FALSE(extruder.ExceededBudget());
+}
+
+TEST_F(BrushTipExtruderTest, DisablesIntersectionHandlingWhenOverWorkBudget) {
+  // A loop that crosses over its own start.
+  std::vector<BrushTipState> states = MakeUniformCircularTipStates(
+      {{0, 0}, {4, 0}, {6, 2}, {4, 4}, {2, 2}, {4, -2}, {8, -2}}, 0.5);
+
+  BrushTipExtruder extruder;
+  extruder.SetBudget({.max_tip_states_per_update = 4});
+  extruder.StartStroke(kBrushEpsilon,
+                       /* is_stamping_texture_particle_brush = */ false, mesh_);
+  extruder.ExtendStroke(absl::MakeSpan(states).first(3), {});
+  EXPECT_FALSE(extruder.ExceededBudget());
+
+  extruder.ExtendStroke(absl::MakeSpan(states).subspan(3, 2),
+                        absl::MakeSpan(states).subspan(5));
+  EXPECT_FALSE(extruder.ExceededBudget());
+
+  // Exceeding the budget does not drop any tip states.
+  StrokeShapeUpdate update =
+      extruder.ExtendStroke(absl::MakeSpan(states).subspan(5),
+                            MakeUniformCircularTipStates(
+                                {{9, -2}, {10, -2}, {11, -2}}, 0.5));
+  EXPECT_TRUE(extruder.ExceededBudget());
+  EXPECT_FALSE(update.region.IsEmpty());
+  EXPECT_THAT(extruder.GetBounds().AsRect(),
+              Optional(RectNear(Rect::FromTwoPoints({-0.5, -2.5}, {11.5, 4.5}),
+                                0.1)));
+}
+
+// Returns tip states tracing `loop_count` small circles around the origin with
+// a tip much larger than the circles, so the stroke repeatedly overlaps itself.
+std::vector<BrushTipState> MakeTightLoopTipStates(int loop_count) {
+  std::vector<Point> positions;
+  constexpr int kStatesPerLoop = 12;
+  for (int i = 0; i <= loop_count * kStatesPerLoop; ++i) {
+    Angle angle = kFullTurn * i / kStatesPerLoop;
+    positions.push_back({2 * Cos(angle), 2 * Sin(angle)});
+  }
+  return MakeUniformCircularTipStates(positions, 3);
+}
+
+TEST_F(BrushTipExtruderTest, AdaptiveIntersectionHandlingWithinBudget) {
+  std::vector<BrushTipState> states = MakeTightLoopTipStates(3);
+
+  MutableMesh enabled_mesh(StrokeVertex::FullMeshFormat());
+  BrushTipExtruder enabled_extruder;
+  enabled_extruder.StartStroke(
+      kBrushEpsilon, /* is_stamping_texture_particle_brush = */ false,
+      enabled_mesh);
+  enabled_extruder.ExtendStroke(states, {});
+
+  // With a budget that is never reached, the result is the same as with
+  // unlimited intersection handling.
+  BrushTipExtruder adaptive_extruder;
+  adaptive_extruder.SetBudget(
+      {.max_retriangulated_triangles_per_tip_state = 1'000'000});
+  adaptive_extruder.StartStroke(
+      kBrushEpsilon, /* is_stamping_texture_particle_brush = */ false, mesh_);
+  adaptive_extruder.ExtendStroke(states, {});
+
+  EXPECT_THAT(mesh_.RawVertexData(),
+              ElementsAreArray(enabled_mesh.RawVertexData()));
+  EXPECT_THAT(mesh_.RawIndexData(),
+              ElementsAreArray(enabled_mesh.RawIndexData()));
+  EXPECT_FALSE(adaptive_extruder.ExceededBudget());
+  EXPECT_EQ(
+      adaptive_extruder.GetLastUpdateStats().intersection_handling_fallbacks,
+      0);
+}
+
+TEST_F(BrushTipExtruderTest, AdaptiveIntersectionHandlingOverBudget) {
+  std::vector<BrushTipState> states = MakeTightLoopTipStates(3);
+
+  BrushTipExtruder extruder;
+  extruder.SetBudget({.max_retriangulated_triangles_per_tip_state = 0});
+  extruder.StartStroke(kBrushEpsilon,
+                       /* is_stamping_texture_particle_brush = */ false, mesh_);
+  StrokeShapeUpdate update = extruder.ExtendStroke(states, {});
+
+  // Falling back does not drop geometry or count as exceeding the budget.
+  EXPECT_FALSE(update.region.IsEmpty());
+  EXPECT_THAT(extruder.GetBounds().AsRect(),
+              Optional(RectNear(Rect::FromTwoPoints({-5, -5}, {5, 5}), 0.1)));
+  EXPECT_FALSE(extruder.ExceededBudget());
+  if constexpr (kStrokeShapeStatsEnabled) {
+    EXPECT_GT(extruder.GetLastUpdateStats().intersection_handling_fallbacks,
+              0);
+  } else {
+    EXPECT_EQ(extruder.GetLastUpdateStats().intersection_handling_fallbacks,
+              0);
+  }
+}
+
 TEST_F(BrushTipExtruderTest, RejectTipStateContainedInPrevious) {
   BrushTipExtruder extruder;
   extruder.StartStroke(kBrushEpsilon,
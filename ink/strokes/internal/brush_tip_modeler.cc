@@ -15,6 +15,7 @@
 #include "ink/strokes/internal/brush_tip_modeler.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -25,6 +26,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/base/nullability.h"
+#include "absl/functional/overload.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/types/span.h"
@@ -32,7 +34,10 @@
 #include "ink/brush/brush_tip.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/point.h"
+#include "ink/geometry/vec.h"
+#include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/internal/brush_tip_modeler_helpers.h"
+#include "ink/strokes/internal/brush_tip_state.h"
 #include "ink/strokes/internal/easing_implementation.h"
 #include "ink/strokes/internal/stroke_input_modeler.h"
 #include "ink/types/duration.h"
@@ -284,6 +289,169 @@ bool SourceDependsOnNextModeledInput(BrushBehavior::Source source) {
   return false;
 }
 
+// Returns true if the value of `source` for a stable modeled input may change
+// as the stroke continues to be extended, and so cannot be cached across
+// updates.
+//
+// Note that the predicted sources are always zero for stable inputs, since
+// those all come from real inputs.
+bool SourceDependsOnStrokeEnd(BrushBehavior::Source source) {
+  switch (source) {
+    case BrushBehavior::Source::kDistanceRemainingInMultiplesOfBrushSize:
+    case BrushBehavior::Source::kTimeSinceInputInSeconds:
+    case BrushBehavior::Source::kTimeSinceInputInMillis:
+    case BrushBehavior::Source::kDistanceRemainingAsFractionOfStrokeLength:
+      return true;
+    case BrushBehavior::Source::kNormalizedPressure:
+    case BrushBehavior::Source::kTiltInRadians:
+    case BrushBehavior::Source::kTiltXInRadians:
+    case BrushBehavior::Source::kTiltYInRadians:
+    case BrushBehavior::Source::kOrientationInRadians:
+    case BrushBehavior::Source::kOrientationAboutZeroInRadians:
+    case BrushBehavior::Source::kSpeedInMultiplesOfBrushSizePerSecond:
+    case BrushBehavior::Source::kVelocityXInMultiplesOfBrushSizePerSecond:
+    case BrushBehavior::Source::kVelocityYInMultiplesOfBrushSizePerSecond:
+    case BrushBehavior::Source::kDirectionInRadians:
+    case BrushBehavior::Source::kDirectionAboutZeroInRadians:
+    case BrushBehavior::Source::kNormalizedDirectionX:
+    case BrushBehavior::Source::kNormalizedDirectionY:
+    case BrushBehavior::Source::kDistanceTraveledInMultiplesOfBrushSize:
+    case BrushBehavior::Source::kTimeOfInputInSeconds:
+    case BrushBehavior::Source::kTimeOfInputInMillis:
+    case BrushBehavior::Source::
+        kPredictedDistanceTraveledInMultiplesOfBrushSize:
+    case BrushBehavior::Source::kPredictedTimeElapsedInSeconds:
+    case BrushBehavior::Source::kPredictedTimeElapsedInMillis:
+    case BrushBehavior::Source::
+        kAccelerationInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::
+        kAccelerationXInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::
+        kAccelerationYInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::
+        kAccelerationForwardInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::
+        kAccelerationLateralInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::kInputSpeedInCentimetersPerSecond:
+    case BrushBehavior::Source::kInputVelocityXInCentimetersPerSecond:
+    case BrushBehavior::Source::kInputVelocityYInCentimetersPerSecond:
+    case BrushBehavior::Source::kInputDistanceTraveledInCentimeters:
+    case BrushBehavior::Source::kPredictedInputDistanceTraveledInCentimeters:
+    case BrushBehavior::Source::kInputAccelerationInCentimetersPerSecondSquared:
+    case BrushBehavior::Source::
+        kInputAccelerationXInCentimetersPerSecondSquared:
+    case BrushBehavior::Source::
+        kInputAccelerationYInCentimetersPerSecondSquared:
+    case BrushBehavior::Source::
+        kInputAccelerationForwardInCentimetersPerSecondSquared:
+    case BrushBehavior::Source::
+        kInputAccelerationLateralInCentimetersPerSecondSquared:
+      break;
+  }
+  return false;
+}
+
+// Returns false if `source` is null for every input of a stroke whose inputs
+// have the given `capabilities`.
+bool IsSourceAvailable(BrushBehavior::Source source,
+                       const BrushTipModeler::InputCapabilities& capabilities) {
+  switch (source) {
+    case BrushBehavior::Source::kNormalizedPressure:
+      return capabilities.has_pressure;
+    case BrushBehavior::Source::kTiltInRadians:
+      return capabilities.has_tilt;
+    case BrushBehavior::Source::kTiltXInRadians:
+      return capabilities.has_tilt && capabilities.has_orientation;
+    case BrushBehavior::Source::kTiltYInRadians:
+      return capabilities.has_tilt && capabilities.has_orientation;
+    case BrushBehavior::Source::kOrientationInRadians:
+      return capabilities.has_orientation;
+    case BrushBehavior::Source::kOrientationAboutZeroInRadians:
+      return capabilities.has_orientation;
+    case BrushBehavior::Source::kDistanceRemainingInMultiplesOfBrushSize:
+    case BrushBehavior::Source::kTimeSinceInputInSeconds:
+    case BrushBehavior::Source::kTimeSinceInputInMillis:
+    case BrushBehavior::Source::kDistanceRemainingAsFractionOfStrokeLength:
+    case BrushBehavior::Source::kSpeedInMultiplesOfBrushSizePerSecond:
+    case BrushBehavior::Source::kVelocityXInMultiplesOfBrushSizePerSecond:
+    case BrushBehavior::Source::kVelocityYInMultiplesOfBrushSizePerSecond:
+    case BrushBehavior::Source::kDirectionInRadians:
+    case BrushBehavior::Source::kDirectionAboutZeroInRadians:
+    case BrushBehavior::Source::kNormalizedDirectionX:
+    case BrushBehavior::Source::kNormalizedDirectionY:
+    case BrushBehavior::Source::kDistanceTraveledInMultiplesOfBrushSize:
+    case BrushBehavior::Source::kTimeOfInputInSeconds:
+    case BrushBehavior::Source::kTimeOfInputInMillis:
+    case BrushBehavior::Source::
+        kPredictedDistanceTraveledInMultiplesOfBrushSize:
+    case BrushBehavior::Source::kPredictedTimeElapsedInSeconds:
+    case BrushBehavior::Source::kPredictedTimeElapsedInMillis:
+    case BrushBehavior::Source::
+        kAccelerationInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::
+        kAccelerationXInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::
+        kAccelerationYInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::
+        kAccelerationForwardInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::
+        kAccelerationLateralInMultiplesOfBrushSizePerSecondSquared:
+    case BrushBehavior::Source::kInputSpeedInCentimetersPerSecond:
+    case BrushBehavior::Source::kInputVelocityXInCentimetersPerSecond:
+    case BrushBehavior::Source::kInputVelocityYInCentimetersPerSecond:
+    case BrushBehavior::Source::kInputDistanceTraveledInCentimeters:
+    case BrushBehavior::Source::kPredictedInputDistanceTraveledInCentimeters:
+    case BrushBehavior::Source::kInputAccelerationInCentimetersPerSecondSquared:
+    case BrushBehavior::Source::
+        kInputAccelerationXInCentimetersPerSecondSquared:
+    case BrushBehavior::Source::
+        kInputAccelerationYInCentimetersPerSecondSquared:
+    case BrushBehavior::Source::
+        kInputAccelerationForwardInCentimetersPerSecondSquared:
+    case BrushBehavior::Source::
+        kInputAccelerationLateralInCentimetersPerSecondSquared:
+      break;
+  }
+  return true;
+}
+
+// Returns false if `property` is missing from every input of a stroke whose
+// inputs have the given `capabilities`.
+bool IsOptionalInputPropertyAvailable(
+    BrushBehavior::OptionalInputProperty property,
+    const BrushTipModeler::InputCapabilities& capabilities) {
+  switch (property) {
+    case BrushBehavior::OptionalInputProperty::kPressure:
+      return capabilities.has_pressure;
+    case BrushBehavior::OptionalInputProperty::kTilt:
+      return capabilities.has_tilt;
+    case BrushBehavior::OptionalInputProperty::kOrientation:
+      return capabilities.has_orientation;
+    case BrushBehavior::OptionalInputProperty::kTiltXAndY:
+      return capabilities.has_tilt && capabilities.has_orientation;
+  }
+  return true;
+}
+
+// Returns the number of stack values that `node` takes as inputs.
+size_t BehaviorNodeInputCount(const BehaviorNodeImplementation& node) {
+  return std::visit(
+      absl::Overload(
+          [](const BrushBehavior::SourceNode&) -> size_t { return 0; },
+          [](const BrushBehavior::ConstantNode&) -> size_t { return 0; },
+          [](const NoiseNodeImplementation&) -> size_t { return 0; },
+          [](const BrushBehavior::BinaryOpNode&) -> size_t { return 2; },
+          [](const BrushBehavior::InterpolationNode&) -> size_t { return 3; },
+          [](const PolarTargetNodeImplementation&) -> size_t { return 2; },
+          [](const auto&) -> size_t { return 1; }),
+      node);
+}
+
+bool IsNullConstantNode(const BehaviorNodeImplementation& node) {
+  const auto* constant = std::get_if<BrushBehavior::ConstantNode>(&node);
+  return constant != nullptr && IsNullBehaviorNodeValue(constant->value);
+}
+
 Duration32 TimeSinceLastInput(
     const StrokeInputModeler::State& input_modeler_state) {
   // TODO: b/287041801 - Do we need to consider predicted inputs here too?
@@ -293,6 +461,14 @@ Duration32 TimeSinceLastInput(
 
 }  // namespace
 
+void BrushTipModeler::CopyStateFrom(const BrushTipModeler& other,
+                                    const BrushTip* absl_nonnull brush_tip) {
+  ABSL_CHECK_NE(other.brush_tip_, nullptr);
+  ABSL_DCHECK(*brush_tip == *other.brush_tip_);
+  *this = other;
+  brush_tip_ = brush_tip;
+}
+
 void BrushTipModeler::StartStroke(const BrushTip* absl_nonnull brush_tip,
                                   float brush_size, uint32_t noise_seed) {
   ABSL_CHECK_NE(brush_tip, nullptr);
@@ -313,45 +489,137 @@ void BrushTipModeler::StartStroke(const BrushTip* absl_nonnull brush_tip,
   saved_tip_states_.clear();
   new_fixed_tip_state_count_ = 0;
 
-  // These fields will be updated by the `AppendBehaviorNode()` loop below.
-  distance_remaining_behavior_upper_bound_ = 0;
-  distance_fraction_behavior_upper_bound_ = 0;
-  time_remaining_behavior_upper_bound_ = Duration32::Zero();
-  behaviors_depend_on_next_input_ = false;
+  // The capabilities of the new stroke's inputs aren't known until its first
+  // update, but are most likely the same as those of the previous stroke.
+  if (brush_size != compiled_brush_size_ ||
+      brush_tip->behaviors != compiled_behaviors_) {
+    CompileBehaviors(compiled_capabilities_);
+  }
+  checked_input_capabilities_ = false;
+  ResetBehaviorState();
+}
+
+void BrushTipModeler::CompileBehaviors(
+    const std::optional<InputCapabilities>& capabilities) {
+  ABSL_DCHECK_NE(brush_tip_, nullptr);
+
+  // This is read by the `AppendBehaviorNode()` loop below.
+  compiled_capabilities_ = capabilities;
 
   behavior_nodes_.clear();
-  current_noise_generators_.clear();
-  fixed_noise_generators_.clear();
-  current_damped_values_.clear();
-  fixed_damped_values_.clear();
+  noise_node_seeds_.clear();
+  damped_value_count_ = 0;
   behavior_targets_.clear();
-  current_target_modifiers_.clear();
-  fixed_target_modifiers_.clear();
+  initial_target_modifiers_.clear();
+  compiled_behavior_ranges_.clear();
 
+  bool any_behavior_depends_on_stroke_end = false;
+  bool all_behaviors_depend_on_stroke_end = true;
   for (const BrushBehavior& behavior : brush_tip_->behaviors) {
+    CompiledBehaviorRange range = {
+        .node_begin = behavior_nodes_.size(),
+        .noise_generator_begin = noise_node_seeds_.size(),
+        .damped_value_begin = damped_value_count_,
+        .target_begin = behavior_targets_.size(),
+    };
     for (const BrushBehavior::Node& node : behavior.nodes) {
       std::visit([this](const auto& node) { this->AppendBehaviorNode(node); },
                  node);
     }
+    range.node_end = behavior_nodes_.size();
+    range.noise_generator_end = noise_node_seeds_.size();
+    range.damped_value_end = damped_value_count_;
+    range.target_end = behavior_targets_.size();
+    range.depends_on_stroke_end = std::any_of(
+        behavior_nodes_.begin() + range.node_begin,
+        behavior_nodes_.begin() + range.node_end,
+        [](const BehaviorNodeImplementation& node) {
+          const auto* source = std::get_if<BrushBehavior::SourceNode>(&node);
+          return source != nullptr && SourceDependsOnStrokeEnd(source->source);
+        });
+    any_behavior_depends_on_stroke_end |= range.depends_on_stroke_end;
+    all_behaviors_depend_on_stroke_end &= range.depends_on_stroke_end;
+    compiled_behavior_ranges_.push_back(range);
+  }
+  // Caching only pays off when some behaviors keep stable tip states volatile
+  // (so they are regenerated on every update), but others could be skipped.
+  behaviors_can_use_stable_input_cache_ =
+      any_behavior_depends_on_stroke_end && !all_behaviors_depend_on_stroke_end;
+
+  // Only the source nodes that survived folding can affect the tip states.
+  distance_remaining_behavior_upper_bound_ = 0;
+  distance_fraction_behavior_upper_bound_ = 0;
+  time_remaining_behavior_upper_bound_ = Duration32::Zero();
+  behaviors_depend_on_next_input_ = false;
+  for (const BehaviorNodeImplementation& node : behavior_nodes_) {
+    const auto* source = std::get_if<BrushBehavior::SourceNode>(&node);
+    if (source == nullptr) continue;
+    distance_remaining_behavior_upper_bound_ =
+        std::max(distance_remaining_behavior_upper_bound_,
+                 DistanceRemainingUpperBound(*source, brush_size_));
+    time_remaining_behavior_upper_bound_ = std::max(
+        time_remaining_behavior_upper_bound_, TimeRemainingUpperBound(*source));
+    if (source->source ==
+        BrushBehavior::Source::kDistanceRemainingAsFractionOfStrokeLength) {
+      distance_fraction_behavior_upper_bound_ =
+          std::max(distance_fraction_behavior_upper_bound_,
+                   SourceValueUpperBound(*source));
+    }
+    if (SourceDependsOnNextModeledInput(source->source)) {
+      behaviors_depend_on_next_input_ = true;
+    }
+  }
+
+  compiled_behaviors_ = brush_tip_->behaviors;
+  compiled_brush_size_ = brush_size_;
+}
+
+void BrushTipModeler::ResetBehaviorState() {
+  current_noise_generators_.clear();
+  for (uint32_t node_seed : noise_node_seeds_) {
+    uint64_t combined_seed = (static_cast<uint64_t>(noise_seed_) << 32) |
+                             static_cast<uint64_t>(node_seed);
+    current_noise_generators_.emplace_back(combined_seed);
+  }
+  fixed_noise_generators_ = current_noise_generators_;
+
+  current_damped_values_.assign(damped_value_count_, kNullBehaviorNodeValue);
+  fixed_damped_values_.assign(damped_value_count_, kNullBehaviorNodeValue);
+
+  current_target_modifiers_ = initial_target_modifiers_;
+  fixed_target_modifiers_ = initial_target_modifiers_;
+
+  // Particle emission may generate any number of tip states per input from
+  // interpolated inputs, so the stable input cache is only used for continuous
+  // extrusion.
+  use_stable_input_cache_ =
+      behaviors_can_use_stable_input_cache_ &&
+      particle_gap_metrics_.traveled_distance == 0 &&
+      particle_gap_metrics_.elapsed_time == Duration32::Zero();
+  cached_inputs_begin_ = 0;
+  cached_inputs_end_ = 0;
+  cached_target_modifiers_.clear();
+  cache_end_noise_generators_ = current_noise_generators_;
+  cache_end_damped_values_ = current_damped_values_;
+  cache_end_target_modifiers_ = current_target_modifiers_;
+
+  behavior_free_tip_state_.reset();
+  if (behavior_nodes_.empty()) {
+    behavior_free_tip_state_ =
+        CreateTipState(Point{0, 0}, std::nullopt, *brush_tip_, brush_size_,
+                       behavior_targets_, initial_target_modifiers_);
   }
 }
 
 void BrushTipModeler::AppendBehaviorNode(
     const BrushBehavior::SourceNode& node) {
-  distance_remaining_behavior_upper_bound_ =
-      std::max(distance_remaining_behavior_upper_bound_,
-               DistanceRemainingUpperBound(node, brush_size_));
-  time_remaining_behavior_upper_bound_ = std::max(
-      time_remaining_behavior_upper_bound_, TimeRemainingUpperBound(node));
-  if (node.source ==
-      BrushBehavior::Source::kDistanceRemainingAsFractionOfStrokeLength) {
-    distance_fraction_behavior_upper_bound_ = std::max(
-        distance_fraction_behavior_upper_bound_, SourceValueUpperBound(node));
+  if (compiled_capabilities_.has_value() &&
+      !IsSourceAvailable(node.source, *compiled_capabilities_)) {
+    behavior_nodes_.push_back(
+        BrushBehavior::ConstantNode{.value = kNullBehaviorNodeValue});
+    return;
   }
   behavior_nodes_.push_back(node);
-  if (SourceDependsOnNextModeledInput(node.source)) {
-    behaviors_depend_on_next_input_ = true;
-  }
 }
 
 void BrushTipModeler::AppendBehaviorNode(
@@ -361,62 +629,86 @@ void BrushTipModeler::AppendBehaviorNode(
 
 void BrushTipModeler::AppendBehaviorNode(const BrushBehavior::NoiseNode& node) {
   behavior_nodes_.push_back(NoiseNodeImplementation{
-      .generator_index = current_noise_generators_.size(),
+      .generator_index = noise_node_seeds_.size(),
       .vary_over = node.vary_over,
       .base_period = node.base_period,
   });
-  uint64_t combined_seed = (static_cast<uint64_t>(noise_seed_) << 32) |
-                           static_cast<uint64_t>(node.seed);
-  current_noise_generators_.emplace_back(combined_seed);
-  fixed_noise_generators_.push_back(current_noise_generators_.back());
+  noise_node_seeds_.push_back(node.seed);
 }
 
 void BrushTipModeler::AppendBehaviorNode(
     const BrushBehavior::FallbackFilterNode& node) {
+  if (compiled_capabilities_.has_value()) {
+    // The filter either always passes its input through, or always nulls it.
+    if (IsOptionalInputPropertyAvailable(node.is_fallback_for,
+                                         *compiled_capabilities_)) {
+      ReplaceLastBehaviorSubtreeWithNull();
+    }
+    return;
+  }
   behavior_nodes_.push_back(node);
 }
 
 void BrushTipModeler::AppendBehaviorNode(
     const BrushBehavior::ToolTypeFilterNode& node) {
+  if (compiled_capabilities_.has_value()) {
+    if (!IsToolTypeEnabled(node.enabled_tool_types,
+                           compiled_capabilities_->tool_type)) {
+      ReplaceLastBehaviorSubtreeWithNull();
+    }
+    return;
+  }
   behavior_nodes_.push_back(node);
 }
 
 void BrushTipModeler::AppendBehaviorNode(
     const BrushBehavior::DampingNode& node) {
+  // A damped constant snaps to that constant on the first input, and then
+  // never moves.
+  if (std::holds_alternative<BrushBehavior::ConstantNode>(
+          behavior_nodes_.back())) {
+    return;
+  }
   behavior_nodes_.push_back(DampingNodeImplementation{
-      .damping_index = current_damped_values_.size(),
+      .damping_index = damped_value_count_++,
       .damping_source = node.damping_source,
       .damping_gap = node.damping_gap,
   });
-  current_damped_values_.push_back(kNullBehaviorNodeValue);
-  fixed_damped_values_.push_back(kNullBehaviorNodeValue);
 }
 
 void BrushTipModeler::AppendBehaviorNode(
     const BrushBehavior::ResponseNode& node) {
   behavior_nodes_.push_back(EasingImplementation(node.response_curve));
+  FoldConstantBehaviorNode(1);
 }
 
 void BrushTipModeler::AppendBehaviorNode(
     const BrushBehavior::BinaryOpNode& node) {
   behavior_nodes_.push_back(node);
+  FoldConstantBehaviorNode(2);
 }
 
 void BrushTipModeler::AppendBehaviorNode(
     const BrushBehavior::InterpolationNode& node) {
   behavior_nodes_.push_back(node);
+  FoldConstantBehaviorNode(3);
 }
 
 void BrushTipModeler::AppendBehaviorNode(
     const BrushBehavior::TargetNode& node) {
-  behavior_nodes_.push_back(TargetNodeImplementation{
-      .target_index = behavior_targets_.size(),
-      .target_modifier_range = node.target_modifier_range,
-  });
+  // A target whose input is always null keeps its initial modifier, so the
+  // whole behavior can be dropped. The target itself is still registered, so
+  // that the modifier is still applied.
+  if (IsNullConstantNode(behavior_nodes_.back())) {
+    behavior_nodes_.pop_back();
+  } else {
+    behavior_nodes_.push_back(TargetNodeImplementation{
+        .target_index = behavior_targets_.size(),
+        .target_modifier_range = node.target_modifier_range,
+    });
+  }
   behavior_targets_.push_back(node.target);
-  float initial_modifier = InitialTargetModifierValue(node.target);
-  current_target_modifiers_.push_back(initial_modifier);
-  fixed_target_modifiers_.push_back(initial_modifier);
+  initial_target_modifiers_.push_back(InitialTargetModifierValue(node.target));
 }
 
 void BrushTipModeler::AppendBehaviorNode(
@@ -430,12 +722,74 @@ void BrushTipModeler::AppendBehaviorNode(
   });
   behavior_targets_.push_back(target_x);
   behavior_targets_.push_back(target_y);
-  float initial_modifier_x = InitialTargetModifierValue(target_x);
-  float initial_modifier_y = InitialTargetModifierValue(target_y);
-  current_target_modifiers_.push_back(initial_modifier_x);
-  current_target_modifiers_.push_back(initial_modifier_y);
-  fixed_target_modifiers_.push_back(initial_modifier_x);
-  fixed_target_modifiers_.push_back(initial_modifier_y);
+  initial_target_modifiers_.push_back(InitialTargetModifierValue(target_x));
+  initial_target_modifiers_.push_back(InitialTargetModifierValue(target_y));
+
+  // As with `TargetNode`, the targets are never modified if either input is
+  // always null.
+  size_t magnitude_index = behavior_nodes_.size() - 2;
+  size_t angle_index = BehaviorSubtreeBegin(magnitude_index) - 1;
+  if (IsNullConstantNode(behavior_nodes_[magnitude_index]) ||
+      IsNullConstantNode(behavior_nodes_[angle_index])) {
+    behavior_nodes_.resize(BehaviorSubtreeBegin(angle_index));
+  }
+}
+
+size_t BrushTipModeler::BehaviorSubtreeBegin(size_t root_index) const {
+  // Nodes are stored in post-order, so the subtree is the shortest run of
+  // nodes ending at the root that produces exactly one value.
+  size_t begin = root_index;
+  size_t missing_values = BehaviorNodeInputCount(behavior_nodes_[root_index]);
+  while (missing_values > 0) {
+    ABSL_DCHECK_GT(begin, 0u);
+    --begin;
+    missing_values += BehaviorNodeInputCount(behavior_nodes_[begin]);
+    --missing_values;
+  }
+  return begin;
+}
+
+void BrushTipModeler::ReplaceLastBehaviorSubtreeWithNull() {
+  behavior_nodes_.resize(BehaviorSubtreeBegin(behavior_nodes_.size() - 1));
+  behavior_nodes_.push_back(
+      BrushBehavior::ConstantNode{.value = kNullBehaviorNodeValue});
+}
+
+void BrushTipModeler::FoldConstantBehaviorNode(size_t input_count) {
+  // Nodes are stored in post-order, so the inputs are the subtrees ending just
+  // before the operation, and just before each other.
+  std::array<float, 3> inputs;
+  ABSL_DCHECK_LE(input_count, inputs.size());
+  bool all_inputs_constant = true;
+  bool any_input_null = false;
+  size_t subtree_begin = behavior_nodes_.size() - 1;
+  for (size_t i = input_count; i > 0; --i) {
+    size_t input_root = subtree_begin - 1;
+    subtree_begin = BehaviorSubtreeBegin(input_root);
+    const auto* constant =
+        std::get_if<BrushBehavior::ConstantNode>(&behavior_nodes_[input_root]);
+    if (constant == nullptr) {
+      all_inputs_constant = false;
+      continue;
+    }
+    inputs[i - 1] = constant->value;
+    any_input_null |= IsNullBehaviorNodeValue(constant->value);
+  }
+
+  float value;
+  if (all_inputs_constant) {
+    value = EvaluateConstantBehaviorNode(
+        behavior_nodes_.back(),
+        absl::MakeConstSpan(inputs.data(), input_count));
+  } else if (any_input_null) {
+    // The operations with more than one input give a null result if any of
+    // their inputs is null.
+    value = kNullBehaviorNodeValue;
+  } else {
+    return;
+  }
+  behavior_nodes_.resize(subtree_begin);
+  behavior_nodes_.push_back(BrushBehavior::ConstantNode{.value = value});
 }
 
 namespace {
@@ -459,6 +813,25 @@ void BrushTipModeler::UpdateStroke(
   saved_tip_states_.clear();
   if (inputs.empty()) return;
 
+  if (!checked_input_capabilities_) {
+    // `StrokeInputBatch` requires every input of a stroke to have the same
+    // tool type and set of optional properties, so the first input tells us
+    // about all of them. No tip states have been generated yet, so the
+    // behaviors can still be recompiled.
+    InputCapabilities capabilities = {
+        .tool_type = input_modeler_state.tool_type,
+        .has_pressure = inputs.front().pressure != StrokeInput::kNoPressure,
+        .has_tilt = inputs.front().tilt != StrokeInput::kNoTilt,
+        .has_orientation =
+            inputs.front().orientation != StrokeInput::kNoOrientation,
+    };
+    if (capabilities != compiled_capabilities_) {
+      CompileBehaviors(capabilities);
+      ResetBehaviorState();
+    }
+    checked_input_capabilities_ = true;
+  }
+
   InputMetrics max_fixed_metrics =
       CalculateMaxFixedInputMetrics(input_modeler_state, inputs);
   ABSL_DCHECK_EQ(fixed_noise_generators_.size(),
@@ -470,10 +843,6 @@ void BrushTipModeler::UpdateStroke(
                  current_target_modifiers_.size());
   absl::c_copy(fixed_target_modifiers_, current_target_modifiers_.begin());
 
-  const ModeledStrokeInput* absl_nullable previous_input =
-      input_index_for_next_fixed_state_ > 0
-          ? &inputs[input_index_for_next_fixed_state_ - 1]
-          : nullptr;
   std::optional<InputMetrics> last_modeled_tip_state_metrics =
       last_fixed_modeled_tip_state_metrics_;
 
@@ -481,10 +850,17 @@ void BrushTipModeler::UpdateStroke(
   // reserving the last stable input if any behaviors would actually depend on
   // the first unstable input.
   int reserved_stable_input = behaviors_depend_on_next_input_ ? 1 : 0;
-  while (input_index_for_next_fixed_state_ + reserved_stable_input <
+  if (use_stable_input_cache_) {
+    TrimStableInputCache();
+    cacheable_input_end_ =
+        std::max(input_modeler_state.stable_input_count,
+                 static_cast<size_t>(reserved_stable_input)) -
+        reserved_stable_input;
+  }
+  size_t fixed_input_end = input_index_for_next_fixed_state_;
+  while (fixed_input_end + reserved_stable_input <
          input_modeler_state.stable_input_count) {
-    const ModeledStrokeInput& current_input =
-        inputs[input_index_for_next_fixed_state_];
+    const ModeledStrokeInput& current_input = inputs[fixed_input_end];
 
     // If the current `brush_tip_` has behaviors targeting distance or time
     // remaining, not all "stable" `ModeledStrokeInput` can be used to make
@@ -494,14 +870,11 @@ void BrushTipModeler::UpdateStroke(
         current_input.elapsed_time > max_fixed_metrics.elapsed_time) {
       break;
     }
-
-    ProcessSingleInput(
-        input_modeler_state, current_input,
-        GetTravelDirection(inputs, input_index_for_next_fixed_state_),
-        previous_input, last_modeled_tip_state_metrics);
-    previous_input = &current_input;
-    ++input_index_for_next_fixed_state_;
+    ++fixed_input_end;
   }
+  ProcessInputs(input_modeler_state, inputs, input_index_for_next_fixed_state_,
+                fixed_input_end, last_modeled_tip_state_metrics);
+  input_index_for_next_fixed_state_ = fixed_input_end;
 
   // Save the necessary fixed properties:
   last_fixed_modeled_tip_state_metrics_ = last_modeled_tip_state_metrics;
@@ -516,14 +889,8 @@ void BrushTipModeler::UpdateStroke(
   absl::c_copy(current_target_modifiers_, fixed_target_modifiers_.begin());
 
   // Generate the remaining tip states, which are volatile:
-  for (size_t i = input_index_for_next_fixed_state_; i < inputs.size(); ++i) {
-    const ModeledStrokeInput& current_input = inputs[i];
-
-    ProcessSingleInput(input_modeler_state, current_input,
-                       GetTravelDirection(inputs, i), previous_input,
-                       last_modeled_tip_state_metrics);
-    previous_input = &current_input;
-  }
+  ProcessInputs(input_modeler_state, inputs, input_index_for_next_fixed_state_,
+                inputs.size(), last_modeled_tip_state_metrics);
 }
 
 bool BrushTipModeler::HasUnfinishedTimeBehaviors(
@@ -555,34 +922,79 @@ InputMetrics BrushTipModeler::CalculateMaxFixedInputMetrics(
   };
 }
 
-void BrushTipModeler::ProcessSingleInput(
+void BrushTipModeler::ProcessInputs(
     const StrokeInputModeler::State& input_modeler_state,
-    const ModeledStrokeInput& current_input,
-    std::optional<Angle> current_travel_direction,
-    const ModeledStrokeInput* absl_nullable previous_input,
+    absl::Span<const ModeledStrokeInput> inputs, size_t begin, size_t end,
     std::optional<InputMetrics>& last_modeled_tip_state_metrics) {
-  bool do_continuous_extrusion =
-      particle_gap_metrics_.traveled_distance == 0 &&
-      particle_gap_metrics_.elapsed_time == Duration32::Zero();
+  if (begin == end) return;
+
+  if (particle_gap_metrics_.traveled_distance == 0 &&
+      particle_gap_metrics_.elapsed_time == Duration32::Zero()) {
+    // Continuous extrusion creates exactly one tip state per input, so the
+    // behaviors can be evaluated for all of the inputs at once.
+    AddNewTipStates(input_modeler_state, inputs, begin, end,
+                    last_modeled_tip_state_metrics);
+    return;
+  }
+
+  // Particles are emitted in two passes: first find where every particle in
+  // the span goes, and then create all of their tip states together.
+  particle_placements_.clear();
+  std::optional<InputMetrics> last_particle_metrics =
+      last_modeled_tip_state_metrics;
+  for (size_t i = begin; i < end; ++i) {
+    AppendParticlePlacements(inputs, i, last_particle_metrics);
+  }
+  if (particle_placements_.empty()) return;
+
+  if (behavior_free_tip_state_.has_value()) {
+    // As in `AddNewTipStates()`, each particle is then just a translation of
+    // the same tip state.
+    Vec offset = behavior_free_tip_state_->position - Point{0, 0};
+    for (const ParticlePlacement& placement : particle_placements_) {
+      BrushTipState& tip_state =
+          saved_tip_states_.emplace_back(*behavior_free_tip_state_);
+      tip_state.position = placement.input.position + offset;
+      AppendParticleGapTipState();
+    }
+  } else {
+    for (const ParticlePlacement& placement : particle_placements_) {
+      AddNewTipState(input_modeler_state, placement.input,
+                     placement.travel_direction,
+                     placement.previous_input_metrics,
+                     last_modeled_tip_state_metrics);
+      AppendParticleGapTipState();
+    }
+  }
+  last_modeled_tip_state_metrics = last_particle_metrics;
+}
+
+void BrushTipModeler::AppendParticlePlacements(
+    absl::Span<const ModeledStrokeInput> inputs, size_t index,
+    std::optional<InputMetrics>& last_particle_metrics) {
+  const ModeledStrokeInput& current_input = inputs[index];
+  std::optional<Angle> current_travel_direction =
+      GetTravelDirection(inputs, index);
 
-  if (do_continuous_extrusion || !last_modeled_tip_state_metrics.has_value()) {
-    // This is either
-    //   a) Continuous extrusion,
-    // OR
-    //   b) Particle extrusion, but no tip states have been modeled so far,
-    //      which should always result in emitting a single particle.
-
-    AddNewTipState(
-        input_modeler_state, current_input, current_travel_direction,
-        previous_input == nullptr
-            ? std::nullopt
-            : std::optional<InputMetrics>({
-                  .traveled_distance = previous_input->traveled_distance,
-                  .elapsed_time = previous_input->elapsed_time,
-              }),
-        last_modeled_tip_state_metrics);
-
-    if (!do_continuous_extrusion) AppendParticleGapTipState();
+  if (!last_particle_metrics.has_value()) {
+    // No tip states have been modeled so far, which should always result in
+    // emitting a single particle.
+    std::optional<InputMetrics> previous_input_metrics;
+    if (index > 0) {
+      previous_input_metrics = {
+          .traveled_distance = inputs[index - 1].traveled_distance,
+          .elapsed_time = inputs[index - 1].elapsed_time,
+      };
+    }
+    particle_placements_.push_back({
+        .input = current_input,
+        .travel_direction = current_travel_direction,
+        .previous_input_metrics = previous_input_metrics,
+    });
+    last_particle_metrics = {
+        .traveled_distance = current_input.traveled_distance,
+        .elapsed_time = current_input.elapsed_time,
+    };
     return;
   }
 
@@ -590,51 +1002,51 @@ void BrushTipModeler::ProcessSingleInput(
   // between the previous and current inputs.
 
   // If we have already modeled a tip state, we must have already had an input.
-  ABSL_DCHECK(previous_input != nullptr);
+  ABSL_DCHECK_GT(index, 0);
+  const ModeledStrokeInput& previous_input = inputs[index - 1];
 
   // Emit as many particles as can fit according to `particle_gap_metrics_`,
   // taking into account that there will usually be some budget left over from
-  // the previous call to this function.  I.e. when emitting particles,
-  // `*last_modeled_tip_state_metrics` will usually lag a little bit behind the
-  // metrics of `*previous_input`.
+  // the previous input.  I.e. when emitting particles, `*last_particle_metrics`
+  // will usually lag a little bit behind the metrics of `previous_input`.
 
   InputMetrics input_delta = {
       .traveled_distance =
-          current_input.traveled_distance - previous_input->traveled_distance,
-      .elapsed_time = current_input.elapsed_time - previous_input->elapsed_time,
+          current_input.traveled_distance - previous_input.traveled_distance,
+      .elapsed_time = current_input.elapsed_time - previous_input.elapsed_time,
   };
 
   while ((current_input.traveled_distance -
-          last_modeled_tip_state_metrics->traveled_distance) >=
+          last_particle_metrics->traveled_distance) >=
              particle_gap_metrics_.traveled_distance &&
-         (current_input.elapsed_time -
-          last_modeled_tip_state_metrics->elapsed_time) >=
+         (current_input.elapsed_time - last_particle_metrics->elapsed_time) >=
              particle_gap_metrics_.elapsed_time) {
     // Calculate an interpolation value from the current input toward the
     // previous input for the new particle tip state.
     float t = 1.f;
     if (particle_gap_metrics_.traveled_distance != 0) {
       t = std::min(t, (current_input.traveled_distance -
-                       last_modeled_tip_state_metrics->traveled_distance -
+                       last_particle_metrics->traveled_distance -
                        particle_gap_metrics_.traveled_distance) /
                           input_delta.traveled_distance);
     }
     if (particle_gap_metrics_.elapsed_time != Duration32::Zero()) {
       t = std::min(t, (current_input.elapsed_time -
-                       last_modeled_tip_state_metrics->elapsed_time -
+                       last_particle_metrics->elapsed_time -
                        particle_gap_metrics_.elapsed_time) /
                           input_delta.elapsed_time);
     }
-    ModeledStrokeInput lerped_input = Lerp(current_input, *previous_input, t);
-    AddNewTipState(input_modeler_state, lerped_input, current_travel_direction,
-                   // Use `last_modeled_tip_state_metrics` as the "previous
-                   // input" metrics (copied by value):
-                   last_modeled_tip_state_metrics,
-                   // Mutable reference out-param to replace
-                   // `last_modeled_tip_state_metrics` with updated metrics:
-                   last_modeled_tip_state_metrics);
-
-    AppendParticleGapTipState();
+    ParticlePlacement& placement = particle_placements_.emplace_back(
+        ParticlePlacement{
+            .input = Lerp(current_input, previous_input, t),
+            .travel_direction = current_travel_direction,
+            // The previous particle stands in for the "previous input".
+            .previous_input_metrics = last_particle_metrics,
+        });
+    last_particle_metrics = {
+        .traveled_distance = placement.input.traveled_distance,
+        .elapsed_time = placement.input.elapsed_time,
+    };
   }
 }
 
@@ -670,4 +1082,162 @@ void BrushTipModeler::AddNewTipState(
   };
 }
 
+void BrushTipModeler::AddNewTipStates(
+    const StrokeInputModeler::State& input_modeler_state,
+    absl::Span<const ModeledStrokeInput> inputs, size_t begin, size_t end,
+    std::optional<InputMetrics>& last_modeled_tip_state_metrics) {
+  ABSL_DCHECK_LT(begin, end);
+  if (behavior_free_tip_state_.has_value()) {
+    // Without behaviors, the tip state doesn't depend on anything but the
+    // position of the input, so there is no need to compute travel directions
+    // or to evaluate and apply target modifiers.
+    Vec offset = behavior_free_tip_state_->position - Point{0, 0};
+    for (size_t i = begin; i < end; ++i) {
+      BrushTipState& tip_state =
+          saved_tip_states_.emplace_back(*behavior_free_tip_state_);
+      tip_state.position = inputs[i].position + offset;
+    }
+    last_modeled_tip_state_metrics = {
+        .traveled_distance = inputs[end - 1].traveled_distance,
+        .elapsed_time = inputs[end - 1].elapsed_time,
+    };
+    return;
+  }
+  if (use_stable_input_cache_) {
+    // Inputs that were stable as of a previous update only need the behaviors
+    // that depend on the end of the stroke to be evaluated again.
+    size_t cached_run_end = std::min(end, cached_inputs_end_);
+    if (begin < cached_run_end) {
+      AddNewTipStatesForRange(input_modeler_state, inputs, begin,
+                              cached_run_end, /* use_cache = */ true,
+                              last_modeled_tip_state_metrics);
+      begin = cached_run_end;
+    }
+    if (begin == end) return;
+
+    // The state of the skipped behaviors picks up from where it was left at
+    // the end of the cached inputs.
+    ABSL_DCHECK_EQ(begin, cached_inputs_end_);
+    RestoreStableInputCacheEndState();
+
+    // Newly stable inputs are evaluated in full and added to the cache.
+    size_t new_cached_run_end = std::min(end, cacheable_input_end_);
+    if (begin < new_cached_run_end) {
+      AddNewTipStatesForRange(input_modeler_state, inputs, begin,
+                              new_cached_run_end, /* use_cache = */ false,
+                              last_modeled_tip_state_metrics);
+      cached_target_modifiers_.insert(cached_target_modifiers_.end(),
+                                      batch_target_modifiers_.begin(),
+                                      batch_target_modifiers_.end());
+      cached_inputs_end_ = new_cached_run_end;
+      cache_end_noise_generators_ = current_noise_generators_;
+      cache_end_damped_values_ = current_damped_values_;
+      cache_end_target_modifiers_ = current_target_modifiers_;
+      begin = new_cached_run_end;
+    }
+    if (begin == end) return;
+  }
+  AddNewTipStatesForRange(input_modeler_state, inputs, begin, end,
+                          /* use_cache = */ false,
+                          last_modeled_tip_state_metrics);
+}
+
+void BrushTipModeler::AddNewTipStatesForRange(
+    const StrokeInputModeler::State& input_modeler_state,
+    absl::Span<const ModeledStrokeInput> inputs, size_t begin, size_t end,
+    bool use_cache,
+    std::optional<InputMetrics>& last_modeled_tip_state_metrics) {
+  ABSL_CHECK_NE(brush_tip_, nullptr);
+  ABSL_DCHECK_LT(begin, end);
+  absl::Span<const ModeledStrokeInput> batch_inputs =
+      inputs.subspan(begin, end - begin);
+
+  batch_travel_directions_.clear();
+  for (size_t i = begin; i < end; ++i) {
+    batch_travel_directions_.push_back(GetTravelDirection(inputs, i));
+  }
+  size_t target_count = behavior_targets_.size();
+  if (use_cache) {
+    // Start from the cached modifiers, and let the behaviors that are
+    // evaluated below overwrite their own targets.
+    ABSL_DCHECK_GE(begin, cached_inputs_begin_);
+    ABSL_DCHECK_LE(end, cached_inputs_end_);
+    auto cached_begin = cached_target_modifiers_.begin() +
+                        (begin - cached_inputs_begin_) * target_count;
+    batch_target_modifiers_.assign(
+        cached_begin, cached_begin + batch_inputs.size() * target_count);
+  } else {
+    batch_target_modifiers_.resize(batch_inputs.size() * target_count);
+  }
+
+  std::optional<InputMetrics> previous_input_metrics;
+  if (begin > 0) {
+    previous_input_metrics = {
+        .traveled_distance = inputs[begin - 1].traveled_distance,
+        .elapsed_time = inputs[begin - 1].elapsed_time,
+    };
+  }
+  BatchBehaviorNodeContext context = {
+      .input_modeler_state = input_modeler_state,
+      .inputs = batch_inputs,
+      .travel_directions = batch_travel_directions_,
+      .brush_size = brush_size_,
+      .previous_input_metrics = previous_input_metrics,
+      .stack = behavior_stack_,
+      .noise_generators = absl::MakeSpan(current_noise_generators_),
+      .damped_values = absl::MakeSpan(current_damped_values_),
+      .target_modifiers = absl::MakeSpan(current_target_modifiers_),
+      .input_target_modifiers = absl::MakeSpan(batch_target_modifiers_),
+  };
+  ABSL_DCHECK(behavior_stack_.empty());
+  for (const CompiledBehaviorRange& range : compiled_behavior_ranges_) {
+    if (use_cache && !range.depends_on_stroke_end) continue;
+    for (size_t i = range.node_begin; i < range.node_end; ++i) {
+      ProcessBehaviorNodeBatch(behavior_nodes_[i], context);
+    }
+  }
+  ABSL_DCHECK(behavior_stack_.empty());
+
+  absl::Span<const float> input_target_modifiers = batch_target_modifiers_;
+  for (size_t i = 0; i < batch_inputs.size(); ++i) {
+    saved_tip_states_.push_back(CreateTipState(
+        batch_inputs[i].position, batch_travel_directions_[i], *brush_tip_,
+        brush_size_, behavior_targets_,
+        input_target_modifiers.subspan(i * target_count, target_count)));
+  }
+  last_modeled_tip_state_metrics = {
+      .traveled_distance = batch_inputs.back().traveled_distance,
+      .elapsed_time = batch_inputs.back().elapsed_time,
+  };
+}
+
+void BrushTipModeler::TrimStableInputCache() {
+  // Each update starts from `input_index_for_next_fixed_state_`, so cached
+  // values for earlier inputs will not be needed again.
+  size_t trim_end =
+      std::min(input_index_for_next_fixed_state_, cached_inputs_end_);
+  if (trim_end <= cached_inputs_begin_) return;
+  size_t target_count = behavior_targets_.size();
+  cached_target_modifiers_.erase(
+      cached_target_modifiers_.begin(),
+      cached_target_modifiers_.begin() +
+          (trim_end - cached_inputs_begin_) * target_count);
+  cached_inputs_begin_ = trim_end;
+}
+
+void BrushTipModeler::RestoreStableInputCacheEndState() {
+  for (const CompiledBehaviorRange& range : compiled_behavior_ranges_) {
+    if (range.depends_on_stroke_end) continue;
+    std::copy(cache_end_noise_generators_.begin() + range.noise_generator_begin,
+              cache_end_noise_generators_.begin() + range.noise_generator_end,
+              current_noise_generators_.begin() + range.noise_generator_begin);
+    std::copy(cache_end_damped_values_.begin() + range.damped_value_begin,
+              cache_end_damped_values_.begin() + range.damped_value_end,
+              current_damped_values_.begin() + range.damped_value_begin);
+    std::copy(cache_end_target_modifiers_.begin() + range.target_begin,
+              cache_end_target_modifiers_.begin() + range.target_end,
+              current_target_modifiers_.begin() + range.target_begin);
+  }
+}
+
 }  // namespace ink::strokes_internal
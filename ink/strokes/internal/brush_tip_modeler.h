@@ -25,6 +25,7 @@
 #include "ink/brush/brush_behavior.h"
 #include "ink/brush/brush_tip.h"
 #include "ink/geometry/angle.h"
+#include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/internal/brush_tip_modeler_helpers.h"
 #include "ink/strokes/internal/brush_tip_state.h"
 #include "ink/strokes/internal/stroke_input_modeler.h"
@@ -67,13 +68,32 @@ namespace ink::strokes_internal {
 // volatile.
 class BrushTipModeler {
  public:
+  // The properties of a stroke's inputs that determine which behavior nodes
+  // can ever produce a non-null value. These are the same for every input of a
+  // stroke, so they are known as soon as its first input is modeled.
+  struct InputCapabilities {
+    StrokeInput::ToolType tool_type = StrokeInput::ToolType::kUnknown;
+    bool has_pressure = false;
+    bool has_tilt = false;
+    bool has_orientation = false;
+
+    friend bool operator==(const InputCapabilities&,
+                           const InputCapabilities&) = default;
+  };
+
   BrushTipModeler() = default;
-  BrushTipModeler(const BrushTipModeler&) = delete;
-  BrushTipModeler& operator=(const BrushTipModeler&) = delete;
   BrushTipModeler(BrushTipModeler&&) = default;
   BrushTipModeler& operator=(BrushTipModeler&&) = default;
   ~BrushTipModeler() = default;
 
+  // Replaces the state of this modeler, including the stroke in progress, with
+  // a copy of the state of `other`, which must have been started. The copy
+  // models `brush_tip` in place of the tip passed to `other.StartStroke()`, so
+  // that it can refer to a copy of the brush; `brush_tip` must be equal to that
+  // tip, and must remain valid for the duration of the stroke.
+  void CopyStateFrom(const BrushTipModeler& other,
+                     const BrushTip* absl_nonnull brush_tip);
+
   // Clears any ongoing stroke and sets up the modeler to accept new stroke
   // input.
   //
@@ -114,7 +134,32 @@ class BrushTipModeler {
   absl::Span<const BrushTipState> VolatileTipStates() const;
 
  private:
-  // Helper methods for the `std::visit` call in `StartStroke`.
+  // Copies are only made by `CopyStateFrom()`, which also replaces the tip.
+  BrushTipModeler(const BrushTipModeler&) = default;
+  BrushTipModeler& operator=(const BrushTipModeler&) = default;
+
+  // Flattens the behaviors of `brush_tip_` into `behavior_nodes_` and the
+  // other cached per-tip values below, folding subtrees made up entirely of
+  // constants into a single `ConstantNode`.
+  //
+  // If `capabilities` is present, the behaviors are also specialized for
+  // strokes with those capabilities: sources the inputs lack, filters whose
+  // outcome is already known, and every operation on a value that is always
+  // null are folded away, and behaviors whose targets can never be modified
+  // are dropped. The upper bounds on distance and time remaining only take the
+  // remaining source nodes into account.
+  //
+  // This only needs to be done when the tip's behaviors, the brush size, or
+  // the capabilities change, since the result does not depend on any other
+  // per-stroke state.
+  void CompileBehaviors(const std::optional<InputCapabilities>& capabilities);
+
+  // Resets the per-stroke behavior state (noise generators, damped values, and
+  // target modifiers) to its initial values for the compiled behaviors, and
+  // updates `behavior_free_tip_state_` for the current `brush_tip_`.
+  void ResetBehaviorState();
+
+  // Helper methods for the `std::visit` call in `CompileBehaviors`.
   void AppendBehaviorNode(const BrushBehavior::SourceNode& node);
   void AppendBehaviorNode(const BrushBehavior::ConstantNode& node);
   void AppendBehaviorNode(const BrushBehavior::NoiseNode& node);
@@ -127,21 +172,39 @@ class BrushTipModeler {
   void AppendBehaviorNode(const BrushBehavior::TargetNode& node);
   void AppendBehaviorNode(const BrushBehavior::PolarTargetNode& node);
 
+  // Returns the index in `behavior_nodes_` of the first node of the subtree
+  // whose root is the node at `root_index`.
+  size_t BehaviorSubtreeBegin(size_t root_index) const;
+
+  // Replaces the subtree at the back of `behavior_nodes_` with a single
+  // `ConstantNode` whose value is null.
+  void ReplaceLastBehaviorSubtreeWithNull();
+
+  // Replaces the node at the back of `behavior_nodes_` and the subtrees of its
+  // `input_count` inputs with a single `ConstantNode` if all of those inputs
+  // are constants, or if any of them is a null constant.
+  void FoldConstantBehaviorNode(size_t input_count);
+
   // Returns the maximum values of distance traveled and time elapsed for
   // modeled inputs that can be used to generate fixed tip states.
   InputMetrics CalculateMaxFixedInputMetrics(
       const StrokeInputModeler::State& input_modeler_state,
       absl::Span<const ModeledStrokeInput> inputs) const;
 
-  // Processes a single `ModeledStrokeInput` and sets up particle emission if
-  // enabled.
-  void ProcessSingleInput(
+  // Generates the tip states for `inputs[begin]` through `inputs[end - 1]`.
+  void ProcessInputs(
       const StrokeInputModeler::State& input_modeler_state,
-      const ModeledStrokeInput& current_input,
-      std::optional<Angle> current_travel_direction,
-      const ModeledStrokeInput* absl_nullable previous_input,
+      absl::Span<const ModeledStrokeInput> inputs, size_t begin, size_t end,
       std::optional<InputMetrics>& last_modeled_tip_state_metrics);
 
+  // Appends to `particle_placements_` a placement for each particle that
+  // should be emitted between `inputs[index - 1]` and `inputs[index]`, given
+  // the metrics of the last particle before them, and updates
+  // `last_particle_metrics` to those of the last particle appended.
+  void AppendParticlePlacements(
+      absl::Span<const ModeledStrokeInput> inputs, size_t index,
+      std::optional<InputMetrics>& last_particle_metrics);
+
   // Appends a single new element to the `saved_tip_states_` based on the
   // current `input`.
   void AddNewTipState(
@@ -150,6 +213,33 @@ class BrushTipModeler {
       std::optional<InputMetrics> previous_input_metrics,
       std::optional<InputMetrics>& last_modeled_tip_state_metrics);
 
+  // Appends one new element to the `saved_tip_states_` for each of
+  // `inputs[begin]` through `inputs[end - 1]`, evaluating the tip's behaviors
+  // over all of those inputs at once. This is equivalent to calling
+  // `AddNewTipState()` for each input in turn when not emitting particles.
+  void AddNewTipStates(
+      const StrokeInputModeler::State& input_modeler_state,
+      absl::Span<const ModeledStrokeInput> inputs, size_t begin, size_t end,
+      std::optional<InputMetrics>& last_modeled_tip_state_metrics);
+
+  // Helper for `AddNewTipStates()` that evaluates the behaviors for one run of
+  // inputs. If `use_cache` is true, the inputs must all be in the stable input
+  // cache, and only the behaviors that depend on the end of the stroke are
+  // evaluated.
+  void AddNewTipStatesForRange(
+      const StrokeInputModeler::State& input_modeler_state,
+      absl::Span<const ModeledStrokeInput> inputs, size_t begin, size_t end,
+      bool use_cache,
+      std::optional<InputMetrics>& last_modeled_tip_state_metrics);
+
+  // Drops the cached values for inputs that can no longer be used to generate
+  // tip states.
+  void TrimStableInputCache();
+
+  // Resets the current state of the behaviors that do not depend on the end of
+  // the stroke to what it was after the last cached input.
+  void RestoreStableInputCacheEndState();
+
   // Appends a "gap" tip state for when the tip modeler is emitting particles.
   //
   // The `BrushTipExtruder` inserts a "break" in mesh geometry whenever the
@@ -184,6 +274,17 @@ class BrushTipModeler {
   // per-stroke seed for a given stroke.
   uint32_t noise_seed_ = 0;
 
+  // The behaviors, brush size, and input capabilities that the cached values
+  // below were compiled from. Consecutive strokes drawn with the same tip and
+  // size, on the same kind of device, reuse the compiled values rather than
+  // rebuilding them.
+  std::vector<BrushBehavior> compiled_behaviors_;
+  float compiled_brush_size_ = 0;
+  std::optional<InputCapabilities> compiled_capabilities_;
+  // Whether the compiled values have been checked against the capabilities of
+  // the current stroke's inputs, which happens on its first non-empty update.
+  bool checked_input_capabilities_ = false;
+
   // Cached values from `brush_tip_` that give the upper bounds on distance and
   // time remaining that are affected by the tip's behaviors.
   float distance_remaining_behavior_upper_bound_ = 0;
@@ -193,18 +294,86 @@ class BrushTipModeler {
   // properties of subsequent modeled inputs, like the travel direction.
   bool behaviors_depend_on_next_input_ = false;
 
+  // The ranges of `behavior_nodes_` and of the per-stroke behavior state that
+  // were compiled from one `BrushBehavior`.
+  struct CompiledBehaviorRange {
+    size_t node_begin = 0;
+    size_t node_end = 0;
+    size_t noise_generator_begin = 0;
+    size_t noise_generator_end = 0;
+    size_t damped_value_begin = 0;
+    size_t damped_value_end = 0;
+    size_t target_begin = 0;
+    size_t target_end = 0;
+    // True if the behavior has a source whose value for a stable input can
+    // change as the stroke is extended, like distance remaining.
+    bool depends_on_stroke_end = false;
+  };
+
   std::vector<BehaviorNodeImplementation> behavior_nodes_;
+  std::vector<CompiledBehaviorRange> compiled_behavior_ranges_;
+  // True if some, but not all, of the compiled behaviors depend on the end of
+  // the stroke.
+  bool behaviors_can_use_stable_input_cache_ = false;
   std::vector<float> behavior_stack_;
-  // These next two vectors must always be the same size:
+  // Scratch space used by `AddNewTipStates()`, holding the travel direction and
+  // the target modifiers for each input in the batch.
+  std::vector<std::optional<Angle>> batch_travel_directions_;
+  std::vector<float> batch_target_modifiers_;
+  // Where to emit a particle: the input to model its tip state from, and the
+  // values `AddNewTipState()` needs along with it.
+  struct ParticlePlacement {
+    ModeledStrokeInput input;
+    std::optional<Angle> travel_direction;
+    std::optional<InputMetrics> previous_input_metrics;
+  };
+  // Scratch space used by `ProcessInputs()` when emitting particles, holding
+  // the placements of the particles for the inputs being processed.
+  std::vector<ParticlePlacement> particle_placements_;
+  // If no behavior nodes survived compilation, every target keeps its initial
+  // modifier and every tip state, continuously extruded or particle, is a
+  // translation of this one, which is made for an input at the origin.
+  // `AddNewTipStates()` and `ProcessInputs()` then skip the behavior machinery
+  // entirely.
+  std::optional<BrushTipState> behavior_free_tip_state_;
+  // The `BrushBehavior::NoiseNode::seed` of each compiled noise node, which is
+  // combined with `noise_seed_` to seed the generators for each stroke.
+  std::vector<uint32_t> noise_node_seeds_;
+  // These next three vectors must always be the same size:
   std::vector<NoiseGenerator> current_noise_generators_;
   std::vector<NoiseGenerator> fixed_noise_generators_;
+  // The number of compiled damping nodes.
+  size_t damped_value_count_ = 0;
   // These next two vectors must always be the same size:
   std::vector<float> current_damped_values_;
   std::vector<float> fixed_damped_values_;
-  // These next three vectors must always be the same size:
+  // These next four vectors must always be the same size:
   std::vector<BrushBehavior::Target> behavior_targets_;
+  std::vector<float> initial_target_modifiers_;
   std::vector<float> current_target_modifiers_;
   std::vector<float> fixed_target_modifiers_;
+
+  // Stable modeled inputs never change, but when some behaviors depend on the
+  // end of the stroke (e.g. to taper it), the tip states made from the most
+  // recent stable inputs stay volatile and are regenerated on every update.
+  // The target modifiers of the remaining behaviors are cached for those
+  // inputs, along with a checkpoint of those behaviors' state after the last
+  // cached input, so that each update only has to evaluate them for newly
+  // stable and unstable inputs.
+  bool use_stable_input_cache_ = false;
+  // The range of input indices covered by `cached_target_modifiers_`.
+  size_t cached_inputs_begin_ = 0;
+  size_t cached_inputs_end_ = 0;
+  // The end of the range of inputs that can be cached in the current update.
+  size_t cacheable_input_end_ = 0;
+  // The modifier for each target at each cached input, stored with the values
+  // for each input contiguous.
+  std::vector<float> cached_target_modifiers_;
+  // The behavior state after the input at `cached_inputs_end_ - 1`. Only the
+  // values for behaviors that do not depend on the end of the stroke are used.
+  std::vector<NoiseGenerator> cache_end_noise_generators_;
+  std::vector<float> cache_end_damped_values_;
+  std::vector<float> cache_end_target_modifiers_;
 };
 
 // ---------------------------------------------------------------------------
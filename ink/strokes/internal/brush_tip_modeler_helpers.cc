@@ -40,10 +40,6 @@
 #include "ink/types/physical_distance.h"
 
 namespace ink::strokes_internal {
-namespace {
-
-using ::ink::geometry_internal::InverseLerp;
-using ::ink::geometry_internal::Lerp;
 
 bool IsToolTypeEnabled(BrushBehavior::EnabledToolTypes enabled_tool_types,
                        StrokeInput::ToolType tool_type) {
@@ -60,6 +56,11 @@ bool IsToolTypeEnabled(BrushBehavior::EnabledToolTypes enabled_tool_types,
   return false;
 }
 
+namespace {
+
+using ::ink::geometry_internal::InverseLerp;
+using ::ink::geometry_internal::Lerp;
+
 std::optional<float> GetTiltX(Angle tilt, Angle orientation) {
   if (tilt == Angle()) return 0;
   // When tilt equals pi/2, tilt-x and tilt-y are indeterminate, so we return
@@ -304,94 +305,75 @@ inline float DampOffsetTransition(float target_offset, float previous_offset,
                               response_distance.ToCentimeters());
 }
 
-void ProcessBehaviorNodeImpl(const BrushBehavior::SourceNode& node,
-                             const BehaviorNodeContext& context) {
+// Returns the normalized value of a `SourceNode` for `input`, or null if the
+// source is not available for that input.
+float SourceNodeValue(const BrushBehavior::SourceNode& node,
+                      const ModeledStrokeInput& input,
+                      std::optional<Angle> travel_direction, float brush_size,
+                      const StrokeInputModeler::State& input_modeler_state) {
   std::optional<float> source_value = GetSourceValue(
-      context.current_input, context.current_travel_direction,
-      context.brush_size, context.input_modeler_state, node.source);
-  if (!source_value.has_value()) {
-    context.stack.push_back(kNullBehaviorNodeValue);
-    return;
-  }
-
-  context.stack.push_back(ApplyOutOfRangeBehavior(
+      input, travel_direction, brush_size, input_modeler_state, node.source);
+  if (!source_value.has_value()) return kNullBehaviorNodeValue;
+  return ApplyOutOfRangeBehavior(
       node.source_out_of_range_behavior,
       InverseLerp(node.source_value_range[0], node.source_value_range[1],
-                  *source_value)));
+                  *source_value));
 }
 
-void ProcessBehaviorNodeImpl(const BrushBehavior::ConstantNode& node,
-                             const BehaviorNodeContext& context) {
-  context.stack.push_back(node.value);
-}
-
-void ProcessBehaviorNodeImpl(const NoiseNodeImplementation& node,
-                             const BehaviorNodeContext& context) {
-  float advance_by = 0.0f;
+// Returns the amount to advance the generator of a `NoiseNodeImplementation`
+// by to get from `previous_input_metrics` to `current_input`.
+float NoiseAdvanceBy(const NoiseNodeImplementation& node,
+                     const ModeledStrokeInput& current_input,
+                     const std::optional<InputMetrics>& previous_input_metrics,
+                     float brush_size,
+                     const StrokeInputModeler::State& input_modeler_state) {
   switch (node.vary_over) {
     case BrushBehavior::DampingSource::kDistanceInCentimeters: {
       PhysicalDistance period = PhysicalDistance::Centimeters(node.base_period);
       float previous_traveled_distance =
-          context.previous_input_metrics.has_value()
-              ? context.previous_input_metrics->traveled_distance
+          previous_input_metrics.has_value()
+              ? previous_input_metrics->traveled_distance
               : 0.0f;
       PhysicalDistance traveled_distance_delta =
-          context.input_modeler_state.stroke_unit_length.has_value()
-              ? *context.input_modeler_state.stroke_unit_length *
-                    (context.current_input.traveled_distance -
+          input_modeler_state.stroke_unit_length.has_value()
+              ? *input_modeler_state.stroke_unit_length *
+                    (current_input.traveled_distance -
                      previous_traveled_distance)
               : PhysicalDistance::Zero();
-      advance_by = traveled_distance_delta / period;
-    } break;
+      return traveled_distance_delta / period;
+    }
     case BrushBehavior::DampingSource::kDistanceInMultiplesOfBrushSize: {
-      float period = context.brush_size * node.base_period;
+      float period = brush_size * node.base_period;
       float previous_traveled_distance =
-          context.previous_input_metrics.has_value()
-              ? context.previous_input_metrics->traveled_distance
+          previous_input_metrics.has_value()
+              ? previous_input_metrics->traveled_distance
               : 0.0f;
       float traveled_distance_delta =
-          context.current_input.traveled_distance - previous_traveled_distance;
-      advance_by = traveled_distance_delta / period;
-    } break;
+          current_input.traveled_distance - previous_traveled_distance;
+      return traveled_distance_delta / period;
+    }
     case BrushBehavior::DampingSource::kTimeInSeconds: {
       Duration32 period = Duration32::Seconds(node.base_period);
       Duration32 previous_elapsed_time =
-          context.previous_input_metrics.has_value()
-              ? context.previous_input_metrics->elapsed_time
+          previous_input_metrics.has_value()
+              ? previous_input_metrics->elapsed_time
               : Duration32::Zero();
       Duration32 elapsed_time_delta =
-          context.current_input.elapsed_time - previous_elapsed_time;
-      advance_by = elapsed_time_delta / period;
-    } break;
-  }
-  NoiseGenerator& generator = context.noise_generators[node.generator_index];
-  generator.AdvanceInputBy(advance_by);
-  context.stack.push_back(generator.CurrentOutputValue());
-}
-
-void ProcessBehaviorNodeImpl(const BrushBehavior::FallbackFilterNode& node,
-                             const BehaviorNodeContext& context) {
-  ABSL_DCHECK(!context.stack.empty());
-  if (IsOptionalInputPropertyPresent(node.is_fallback_for,
-                                     context.current_input)) {
-    context.stack.back() = kNullBehaviorNodeValue;
-  }
-}
-
-void ProcessBehaviorNodeImpl(const BrushBehavior::ToolTypeFilterNode& node,
-                             const BehaviorNodeContext& context) {
-  ABSL_DCHECK(!context.stack.empty());
-  if (!IsToolTypeEnabled(node.enabled_tool_types,
-                         context.input_modeler_state.tool_type)) {
-    context.stack.back() = kNullBehaviorNodeValue;
+          current_input.elapsed_time - previous_elapsed_time;
+      return elapsed_time_delta / period;
+    }
   }
+  return 0.0f;
 }
 
-void ProcessBehaviorNodeImpl(const DampingNodeImplementation& node,
-                             const BehaviorNodeContext& context) {
-  ABSL_DCHECK(!context.stack.empty());
-  float& damped_value = context.damped_values[node.damping_index];
-  float input = context.stack.back();
+// Moves `damped_value` for a `DampingNodeImplementation` towards `input`, the
+// node's input value for `current_input`.
+void UpdateDampedValue(
+    const DampingNodeImplementation& node, float input,
+    const ModeledStrokeInput& current_input,
+    const std::optional<InputMetrics>& previous_input_metrics,
+    float brush_size, const StrokeInputModeler::State& input_modeler_state,
+    float& damped_value) {
   if (IsNullBehaviorNodeValue(input)) {
     // Input is null, so use previous damped value unchanged.
   } else if (IsNullBehaviorNodeValue(damped_value) ||
@@ -405,43 +387,162 @@ void ProcessBehaviorNodeImpl(const DampingNodeImplementation& node,
     // Input and previous damped value are both non-null, so move the damped
     // value towards the input according to the damping settings.  Note that a
     // non-null previous damped value implies that there was at least one
-    // previous input, and thus `context.previous_input_metrics` is present.
-    ABSL_DCHECK(context.previous_input_metrics.has_value());
+    // previous input, and thus `previous_input_metrics` is present.
+    ABSL_DCHECK(previous_input_metrics.has_value());
     switch (node.damping_source) {
       case BrushBehavior::DampingSource::kDistanceInCentimeters: {
         // If no mapping from stroke units to physical units is available, then
         // don't perform any damping (i.e. snap damped value to input).
-        if (!context.input_modeler_state.stroke_unit_length.has_value()) {
+        if (!input_modeler_state.stroke_unit_length.has_value()) {
           damped_value = input;
           break;
         }
         PhysicalDistance damping_distance =
             PhysicalDistance::Centimeters(node.damping_gap);
         PhysicalDistance traveled_distance_delta =
-            *context.input_modeler_state.stroke_unit_length *
-            (context.current_input.traveled_distance -
-             context.previous_input_metrics->traveled_distance);
+            *input_modeler_state.stroke_unit_length *
+            (current_input.traveled_distance -
+             previous_input_metrics->traveled_distance);
         damped_value = DampOffsetTransition(
             input, damped_value, traveled_distance_delta, damping_distance);
       } break;
       case BrushBehavior::DampingSource::kDistanceInMultiplesOfBrushSize: {
-        float damping_distance = context.brush_size * node.damping_gap;
+        float damping_distance = brush_size * node.damping_gap;
         float traveled_distance_delta =
-            context.current_input.traveled_distance -
-            context.previous_input_metrics->traveled_distance;
+            current_input.traveled_distance -
+            previous_input_metrics->traveled_distance;
         damped_value = DampOffsetTransition(
             input, damped_value, traveled_distance_delta, damping_distance);
       } break;
       case BrushBehavior::DampingSource::kTimeInSeconds: {
         Duration32 damping_time = Duration32::Seconds(node.damping_gap);
         Duration32 elapsed_time_delta =
-            context.current_input.elapsed_time -
-            context.previous_input_metrics->elapsed_time;
+            current_input.elapsed_time - previous_input_metrics->elapsed_time;
         damped_value = DampOffsetTransition(input, damped_value,
                                             elapsed_time_delta, damping_time);
       } break;
     }
   }
+}
+
+// Stores `first_input * second_input` or `first_input + second_input` in
+// `result` for each pair of inputs, depending on `operation`.
+void ApplyBinaryOp(BrushBehavior::BinaryOp operation,
+                   absl::Span<const float> first_inputs,
+                   absl::Span<const float> second_inputs,
+                   absl::Span<float> results) {
+  ABSL_DCHECK_EQ(first_inputs.size(), results.size());
+  ABSL_DCHECK_EQ(second_inputs.size(), results.size());
+  // kNullBehaviorNodeValue is NaN, so if either input value is null (NaN), the
+  // result will be null (NaN).
+  switch (operation) {
+    case BrushBehavior::BinaryOp::kProduct:
+      for (size_t i = 0; i < results.size(); ++i) {
+        results[i] = first_inputs[i] * second_inputs[i];
+      }
+      break;
+    case BrushBehavior::BinaryOp::kSum:
+      for (size_t i = 0; i < results.size(); ++i) {
+        results[i] = first_inputs[i] + second_inputs[i];
+      }
+      break;
+  }
+  // If any of the above operations resulted in a non-finite value (e.g.
+  // overflow to infinity), treat the result as null.
+  for (float& result : results) {
+    if (!std::isfinite(result)) result = kNullBehaviorNodeValue;
+  }
+}
+
+// Stores the result of `interpolation` over each range and parameter in
+// `results`, which may alias `params`.
+void ApplyInterpolation(BrushBehavior::Interpolation interpolation,
+                        absl::Span<const float> params,
+                        absl::Span<const float> range_starts,
+                        absl::Span<const float> range_ends,
+                        absl::Span<float> results) {
+  ABSL_DCHECK_EQ(params.size(), results.size());
+  ABSL_DCHECK_EQ(range_starts.size(), results.size());
+  ABSL_DCHECK_EQ(range_ends.size(), results.size());
+  // As with binary ops, a null (NaN) input gives a null (NaN) result for each
+  // of the below, as does any other non-finite result (e.g. overflow to
+  // infinity).
+  switch (interpolation) {
+    case BrushBehavior::Interpolation::kLerp:
+      for (size_t i = 0; i < results.size(); ++i) {
+        results[i] = Lerp(range_starts[i], range_ends[i], params[i]);
+      }
+      break;
+    case BrushBehavior::Interpolation::kInverseLerp:
+      for (size_t i = 0; i < results.size(); ++i) {
+        results[i] = range_starts[i] == range_ends[i]
+                         ? kNullBehaviorNodeValue
+                         : InverseLerp(range_starts[i], range_ends[i],
+                                       params[i]);
+      }
+      break;
+  }
+  for (float& result : results) {
+    if (!std::isfinite(result)) result = kNullBehaviorNodeValue;
+  }
+}
+
+// Returns the X/Y modifiers for a `PolarTargetNodeImplementation` with the
+// given non-null inputs.
+Vec PolarTargetModifier(const PolarTargetNodeImplementation& node,
+                        float angle_input, float magnitude_input) {
+  return Vec::FromDirectionAndMagnitude(
+      Angle::Radians(
+          Lerp(node.angle_range[0], node.angle_range[1], angle_input)),
+      Lerp(node.magnitude_range[0], node.magnitude_range[1], magnitude_input));
+}
+
+void ProcessBehaviorNodeImpl(const BrushBehavior::SourceNode& node,
+                             const BehaviorNodeContext& context) {
+  context.stack.push_back(SourceNodeValue(
+      node, context.current_input, context.current_travel_direction,
+      context.brush_size, context.input_modeler_state));
+}
+
+void ProcessBehaviorNodeImpl(const BrushBehavior::ConstantNode& node,
+                             const BehaviorNodeContext& context) {
+  context.stack.push_back(node.value);
+}
+
+void ProcessBehaviorNodeImpl(const NoiseNodeImplementation& node,
+                             const BehaviorNodeContext& context) {
+  NoiseGenerator& generator = context.noise_generators[node.generator_index];
+  generator.AdvanceInputBy(NoiseAdvanceBy(
+      node, context.current_input, context.previous_input_metrics,
+      context.brush_size, context.input_modeler_state));
+  context.stack.push_back(generator.CurrentOutputValue());
+}
+
+void ProcessBehaviorNodeImpl(const BrushBehavior::FallbackFilterNode& node,
+                             const BehaviorNodeContext& context) {
+  ABSL_DCHECK(!context.stack.empty());
+  if (IsOptionalInputPropertyPresent(node.is_fallback_for,
+                                     context.current_input)) {
+    context.stack.back() = kNullBehaviorNodeValue;
+  }
+}
+
+void ProcessBehaviorNodeImpl(const BrushBehavior::ToolTypeFilterNode& node,
+                             const BehaviorNodeContext& context) {
+  ABSL_DCHECK(!context.stack.empty());
+  if (!IsToolTypeEnabled(node.enabled_tool_types,
+                         context.input_modeler_state.tool_type)) {
+    context.stack.back() = kNullBehaviorNodeValue;
+  }
+}
+
+void ProcessBehaviorNodeImpl(const DampingNodeImplementation& node,
+                             const BehaviorNodeContext& context) {
+  ABSL_DCHECK(!context.stack.empty());
+  float& damped_value = context.damped_values[node.damping_index];
+  UpdateDampedValue(node, context.stack.back(), context.current_input,
+                    context.previous_input_metrics, context.brush_size,
+                    context.input_modeler_state, damped_value);
   context.stack.back() = damped_value;
 }
 
@@ -456,25 +557,10 @@ void ProcessBehaviorNodeImpl(const BrushBehavior::BinaryOpNode& node,
   ABSL_DCHECK_GE(context.stack.size(), 2);
   float second_input = context.stack.back();
   context.stack.pop_back();
-  float first_input = context.stack.back();
   float* result = &context.stack.back();
-  switch (node.operation) {
-    case BrushBehavior::BinaryOp::kProduct:
-      // kNullBehaviorNodeValue is NaN, so if either input value is null (NaN),
-      // the result will be null (NaN).
-      *result = first_input * second_input;
-      break;
-    case BrushBehavior::BinaryOp::kSum:
-      // kNullBehaviorNodeValue is NaN, so if either input value is null (NaN),
-      // the result will be null (NaN).
-      *result = first_input + second_input;
-      break;
-  }
-  // If any of the above operations resulted in a non-finite value
-  // (e.g. overflow to infinity), treat the result as null.
-  if (!std::isfinite(*result)) {
-    *result = kNullBehaviorNodeValue;
-  }
+  ApplyBinaryOp(node.operation, absl::MakeConstSpan(result, 1),
+                absl::MakeConstSpan(&second_input, 1),
+                absl::MakeSpan(result, 1));
 }
 
 void ProcessBehaviorNodeImpl(const BrushBehavior::InterpolationNode& node,
@@ -484,30 +570,11 @@ void ProcessBehaviorNodeImpl(const BrushBehavior::InterpolationNode& node,
   context.stack.pop_back();
   float range_start = context.stack.back();
   context.stack.pop_back();
-  float param = context.stack.back();
   float* result = &context.stack.back();
-  if (IsNullBehaviorNodeValue(range_start) ||
-      IsNullBehaviorNodeValue(range_end) || IsNullBehaviorNodeValue(param)) {
-    *result = kNullBehaviorNodeValue;
-    return;
-  }
-  switch (node.interpolation) {
-    case BrushBehavior::Interpolation::kLerp:
-      *result = Lerp(range_start, range_end, param);
-      break;
-    case BrushBehavior::Interpolation::kInverseLerp:
-      if (range_start == range_end) {
-        *result = kNullBehaviorNodeValue;
-        return;
-      }
-      *result = InverseLerp(range_start, range_end, param);
-      break;
-  }
-  // If any of the above resulted in a non-finite value (e.g. overflow to
-  // infinity), treat the result as null.
-  if (!std::isfinite(*result)) {
-    *result = kNullBehaviorNodeValue;
-  }
+  ApplyInterpolation(node.interpolation, absl::MakeConstSpan(result, 1),
+                     absl::MakeConstSpan(&range_start, 1),
+                     absl::MakeConstSpan(&range_end, 1),
+                     absl::MakeSpan(result, 1));
 }
 
 void ProcessBehaviorNodeImpl(const TargetNodeImplementation& node,
@@ -531,14 +598,160 @@ void ProcessBehaviorNodeImpl(const PolarTargetNodeImplementation& node,
       IsNullBehaviorNodeValue(magnitude_input)) {
     return;
   }
-  Vec modifier = Vec::FromDirectionAndMagnitude(
-      Angle::Radians(
-          Lerp(node.angle_range[0], node.angle_range[1], angle_input)),
-      Lerp(node.magnitude_range[0], node.magnitude_range[1], magnitude_input));
+  Vec modifier = PolarTargetModifier(node, angle_input, magnitude_input);
   context.target_modifiers[node.target_x_index] = modifier.x;
   context.target_modifiers[node.target_y_index] = modifier.y;
 }
 
+// Returns the `input_count` values for the stack entry that is `depth` entries
+// below the top of the SoA `stack` used by `ProcessBehaviorNodeBatch()`.
+absl::Span<float> BatchStackEntry(std::vector<float>& stack,
+                                  size_t input_count, size_t depth = 0) {
+  ABSL_DCHECK_GE(stack.size(), (depth + 1) * input_count);
+  return absl::MakeSpan(stack).subspan(
+      stack.size() - (depth + 1) * input_count, input_count);
+}
+
+// Returns the metrics of the input preceding `context.inputs[i]`.
+std::optional<InputMetrics> PreviousInputMetrics(
+    const BatchBehaviorNodeContext& context, size_t i) {
+  if (i == 0) return context.previous_input_metrics;
+  return InputMetrics{
+      .traveled_distance = context.inputs[i - 1].traveled_distance,
+      .elapsed_time = context.inputs[i - 1].elapsed_time,
+  };
+}
+
+void ProcessBehaviorNodeBatchImpl(const BrushBehavior::SourceNode& node,
+                                  const BatchBehaviorNodeContext& context) {
+  for (size_t i = 0; i < context.inputs.size(); ++i) {
+    context.stack.push_back(SourceNodeValue(
+        node, context.inputs[i], context.travel_directions[i],
+        context.brush_size, context.input_modeler_state));
+  }
+}
+
+void ProcessBehaviorNodeBatchImpl(const BrushBehavior::ConstantNode& node,
+                                  const BatchBehaviorNodeContext& context) {
+  context.stack.insert(context.stack.end(), context.inputs.size(), node.value);
+}
+
+void ProcessBehaviorNodeBatchImpl(const NoiseNodeImplementation& node,
+                                  const BatchBehaviorNodeContext& context) {
+  NoiseGenerator& generator = context.noise_generators[node.generator_index];
+  size_t offset = context.stack.size();
+  for (size_t i = 0; i < context.inputs.size(); ++i) {
+    context.stack.push_back(NoiseAdvanceBy(
+        node, context.inputs[i], PreviousInputMetrics(context, i),
+        context.brush_size, context.input_modeler_state));
+  }
+  // Replace the advance amounts with the resulting noise values in place.
+  absl::Span<float> values = absl::MakeSpan(context.stack).subspan(offset);
+  generator.AdvanceInputsBy(values, values);
+}
+
+void ProcessBehaviorNodeBatchImpl(const BrushBehavior::FallbackFilterNode& node,
+                                  const BatchBehaviorNodeContext& context) {
+  absl::Span<float> values =
+      BatchStackEntry(context.stack, context.inputs.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (IsOptionalInputPropertyPresent(node.is_fallback_for,
+                                       context.inputs[i])) {
+      values[i] = kNullBehaviorNodeValue;
+    }
+  }
+}
+
+void ProcessBehaviorNodeBatchImpl(const BrushBehavior::ToolTypeFilterNode& node,
+                                  const BatchBehaviorNodeContext& context) {
+  // The tool type is the same for every input in the stroke.
+  if (!IsToolTypeEnabled(node.enabled_tool_types,
+                         context.input_modeler_state.tool_type)) {
+    absl::Span<float> values =
+        BatchStackEntry(context.stack, context.inputs.size());
+    std::fill(values.begin(), values.end(), kNullBehaviorNodeValue);
+  }
+}
+
+void ProcessBehaviorNodeBatchImpl(const DampingNodeImplementation& node,
+                                  const BatchBehaviorNodeContext& context) {
+  absl::Span<float> values =
+      BatchStackEntry(context.stack, context.inputs.size());
+  float& damped_value = context.damped_values[node.damping_index];
+  for (size_t i = 0; i < values.size(); ++i) {
+    UpdateDampedValue(node, values[i], context.inputs[i],
+                      PreviousInputMetrics(context, i), context.brush_size,
+                      context.input_modeler_state, damped_value);
+    values[i] = damped_value;
+  }
+}
+
+void ProcessBehaviorNodeBatchImpl(const EasingImplementation& node,
+                                  const BatchBehaviorNodeContext& context) {
+  node.GetY(BatchStackEntry(context.stack, context.inputs.size()));
+}
+
+void ProcessBehaviorNodeBatchImpl(const BrushBehavior::BinaryOpNode& node,
+                                  const BatchBehaviorNodeContext& context) {
+  size_t n = context.inputs.size();
+  absl::Span<float> second_inputs = BatchStackEntry(context.stack, n);
+  absl::Span<float> first_inputs = BatchStackEntry(context.stack, n, 1);
+  ApplyBinaryOp(node.operation, first_inputs, second_inputs, first_inputs);
+  context.stack.resize(context.stack.size() - n);
+}
+
+void ProcessBehaviorNodeBatchImpl(const BrushBehavior::InterpolationNode& node,
+                                  const BatchBehaviorNodeContext& context) {
+  size_t n = context.inputs.size();
+  absl::Span<float> range_ends = BatchStackEntry(context.stack, n);
+  absl::Span<float> range_starts = BatchStackEntry(context.stack, n, 1);
+  absl::Span<float> params = BatchStackEntry(context.stack, n, 2);
+  ApplyInterpolation(node.interpolation, params, range_starts, range_ends,
+                     params);
+  context.stack.resize(context.stack.size() - 2 * n);
+}
+
+void ProcessBehaviorNodeBatchImpl(const TargetNodeImplementation& node,
+                                  const BatchBehaviorNodeContext& context) {
+  size_t n = context.inputs.size();
+  size_t target_count = context.target_modifiers.size();
+  absl::Span<const float> values = BatchStackEntry(context.stack, n);
+  float& modifier = context.target_modifiers[node.target_index];
+  for (size_t i = 0; i < n; ++i) {
+    if (!IsNullBehaviorNodeValue(values[i])) {
+      modifier = Lerp(node.target_modifier_range[0],
+                      node.target_modifier_range[1], values[i]);
+    }
+    context.input_target_modifiers[i * target_count + node.target_index] =
+        modifier;
+  }
+  context.stack.resize(context.stack.size() - n);
+}
+
+void ProcessBehaviorNodeBatchImpl(const PolarTargetNodeImplementation& node,
+                                  const BatchBehaviorNodeContext& context) {
+  size_t n = context.inputs.size();
+  size_t target_count = context.target_modifiers.size();
+  absl::Span<const float> magnitude_inputs = BatchStackEntry(context.stack, n);
+  absl::Span<const float> angle_inputs = BatchStackEntry(context.stack, n, 1);
+  float& modifier_x = context.target_modifiers[node.target_x_index];
+  float& modifier_y = context.target_modifiers[node.target_y_index];
+  for (size_t i = 0; i < n; ++i) {
+    if (!IsNullBehaviorNodeValue(angle_inputs[i]) &&
+        !IsNullBehaviorNodeValue(magnitude_inputs[i])) {
+      Vec modifier =
+          PolarTargetModifier(node, angle_inputs[i], magnitude_inputs[i]);
+      modifier_x = modifier.x;
+      modifier_y = modifier.y;
+    }
+    context.input_target_modifiers[i * target_count + node.target_x_index] =
+        modifier_x;
+    context.input_target_modifiers[i * target_count + node.target_y_index] =
+        modifier_y;
+  }
+  context.stack.resize(context.stack.size() - 2 * n);
+}
+
 }  // namespace
 
 void ProcessBehaviorNode(const BehaviorNodeImplementation& node,
@@ -548,6 +761,41 @@ void ProcessBehaviorNode(const BehaviorNodeImplementation& node,
       node);
 }
 
+void ProcessBehaviorNodeBatch(const BehaviorNodeImplementation& node,
+                              const BatchBehaviorNodeContext& context) {
+  ABSL_DCHECK_EQ(context.travel_directions.size(), context.inputs.size());
+  ABSL_DCHECK_EQ(context.input_target_modifiers.size(),
+                 context.inputs.size() * context.target_modifiers.size());
+  std::visit(
+      [&context](const auto& node) {
+        ProcessBehaviorNodeBatchImpl(node, context);
+      },
+      node);
+}
+
+float EvaluateConstantBehaviorNode(const BehaviorNodeImplementation& node,
+                                   absl::Span<const float> inputs) {
+  ABSL_DCHECK((std::holds_alternative<EasingImplementation>(node) &&
+               inputs.size() == 1) ||
+              (std::holds_alternative<BrushBehavior::BinaryOpNode>(node) &&
+               inputs.size() == 2) ||
+              (std::holds_alternative<BrushBehavior::InterpolationNode>(node) &&
+               inputs.size() == 3));
+  // None of the supported node types read from the stroke or from any mutable
+  // per-stroke state, so default values suffice for the rest of the context.
+  StrokeInputModeler::State input_modeler_state;
+  ModeledStrokeInput current_input;
+  std::vector<float> stack(inputs.begin(), inputs.end());
+  ProcessBehaviorNode(node, {
+                                .input_modeler_state = input_modeler_state,
+                                .current_input = current_input,
+                                .brush_size = 1,
+                                .stack = stack,
+                            });
+  ABSL_DCHECK_EQ(stack.size(), 1);
+  return stack.back();
+}
+
 namespace {
 
 // Percentage shifts for each `BrushBehavior::Target` of a `BrushTipState`.
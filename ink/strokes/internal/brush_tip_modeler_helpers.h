@@ -28,6 +28,7 @@
 #include "ink/brush/brush_tip.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/point.h"
+#include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/internal/brush_tip_state.h"
 #include "ink/strokes/internal/easing_implementation.h"
 #include "ink/strokes/internal/noise_generator.h"
@@ -46,6 +47,10 @@ inline constexpr float kNullBehaviorNodeValue =
 // Returns true if the given brush behavior node value is "null".
 inline bool IsNullBehaviorNodeValue(float value) { return std::isnan(value); }
 
+// Returns true if `tool_type` is one of the `enabled_tool_types`.
+bool IsToolTypeEnabled(BrushBehavior::EnabledToolTypes enabled_tool_types,
+                       StrokeInput::ToolType tool_type);
+
 struct NoiseNodeImplementation {
   // The index into `BehaviorNodeContext::*_noise_generators_` for the latest
   // noise generator state of this noise node.
@@ -117,6 +122,53 @@ struct BehaviorNodeContext {
 void ProcessBehaviorNode(const BehaviorNodeImplementation& node,
                          const BehaviorNodeContext& context);
 
+// Holds references to stroke data needed by `ProcessBehaviorNodeBatch()` for a
+// run of consecutive modeled inputs, as well as references to mutable state
+// that that function will need to update.
+struct BatchBehaviorNodeContext {
+  const StrokeInputModeler::State& input_modeler_state;
+  absl::Span<const ModeledStrokeInput> inputs;
+  // The travel direction at each element of `inputs`.
+  absl::Span<const std::optional<Angle>> travel_directions;
+  float brush_size;
+  // Distance/time from the start of the stroke up to the input before
+  // `inputs.front()` (if any).
+  std::optional<InputMetrics> previous_input_metrics;
+  // The node value stack, in structure-of-arrays layout: each entry on the
+  // stack is `inputs.size()` contiguous values, one for each input.
+  std::vector<float>& stack;
+  absl::Span<NoiseGenerator> noise_generators;
+  absl::Span<float> damped_values;
+  // The latest modifier value for each target, which will be left holding the
+  // values for `inputs.back()`.
+  absl::Span<float> target_modifiers;
+  // The modifier value for each target at each input, with the
+  // `target_modifiers.size()` values for each input stored contiguously.
+  absl::Span<float> input_target_modifiers;
+};
+
+// Executes the specified node for every input in `context`, giving the same
+// results as calling `ProcessBehaviorNode()` for each input in turn (with the
+// per-input values of `input_target_modifiers` captured after each input).
+//
+// Running each node over all of the inputs before moving on to the next node
+// keeps the per-node dispatch out of the inner loop, and lets the stateless
+// nodes operate on contiguous arrays of values. Stateful nodes like noise and
+// damping still visit the inputs in order.
+void ProcessBehaviorNodeBatch(const BehaviorNodeImplementation& node,
+                              const BatchBehaviorNodeContext& context);
+
+// Returns the value that `node` would leave on the stack when executed with
+// `inputs` as the top stack values (in stack order, so the last element of
+// `inputs` is the top of the stack).
+//
+// This is used to fold behavior subtrees made up entirely of constants into a
+// single `ConstantNode` ahead of time, so `node` must be one whose result
+// depends only on its stack inputs: an `EasingImplementation` (one input), a
+// `BinaryOpNode` (two inputs), or an `InterpolationNode` (three inputs).
+float EvaluateConstantBehaviorNode(const BehaviorNodeImplementation& node,
+                                   absl::Span<const float> inputs);
+
 // Constructs a `BrushTipState` at the given `position` using the non-behavior
 // parameters of `brush_tip` with `brush_size`, and then applies
 // `behavior_modifiers`.
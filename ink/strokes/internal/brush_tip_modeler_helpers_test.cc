@@ -15,6 +15,7 @@
 #include "ink/strokes/internal/brush_tip_modeler_helpers.h"
 
 #include <cmath>
+#include <cstddef>
 #include <optional>
 #include <vector>
 
@@ -44,6 +45,7 @@ using ::testing::ElementsAre;
 using ::testing::FloatEq;
 using ::testing::FloatNear;
 using ::testing::IsEmpty;
+using ::testing::Pointwise;
 
 MATCHER(NullNodeValueMatcher, "") { return IsNullBehaviorNodeValue(arg); }
 
@@ -1381,6 +1383,176 @@ TEST_F(ProcessBehaviorNodeTest, PolarTargetNode) {
               ElementsAre(FloatNear(0.0f, 1e-5), FloatNear(7.5f, 1e-5)));
 }
 
+// Returns the target modifiers after each of `inputs`, as computed by calling
+// `ProcessBehaviorNode()` for one input at a time.
+std::vector<float> ProcessBehaviorNodesOneAtATime(
+    absl::Span<const BehaviorNodeImplementation> nodes,
+    const StrokeInputModeler::State& input_modeler_state,
+    absl::Span<const ModeledStrokeInput> inputs,
+    std::vector<NoiseGenerator> noise_generators,
+    std::vector<float> damped_values, std::vector<float> target_modifiers) {
+  std::vector<float> stack;
+  std::vector<float> input_target_modifiers;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::optional<InputMetrics> previous_input_metrics;
+    if (i > 0) {
+      previous_input_metrics = {
+          .traveled_distance = inputs[i - 1].traveled_distance,
+          .elapsed_time = inputs[i - 1].elapsed_time,
+      };
+    }
+    BehaviorNodeContext context = {
+        .input_modeler_state = input_modeler_state,
+        .current_input = inputs[i],
+        .brush_size = 1,
+        .previous_input_metrics = previous_input_metrics,
+        .stack = stack,
+        .noise_generators = absl::MakeSpan(noise_generators),
+        .damped_values = absl::MakeSpan(damped_values),
+        .target_modifiers = absl::MakeSpan(target_modifiers),
+    };
+    for (const BehaviorNodeImplementation& node : nodes) {
+      ProcessBehaviorNode(node, context);
+    }
+    input_target_modifiers.insert(input_target_modifiers.end(),
+                                  target_modifiers.begin(),
+                                  target_modifiers.end());
+  }
+  return input_target_modifiers;
+}
+
+TEST(ProcessBehaviorNodeBatchTest, MatchesProcessingOneInputAtATime) {
+  std::vector<BehaviorNodeImplementation> nodes = {
+      BrushBehavior::SourceNode{
+          .source = BrushBehavior::Source::kNormalizedPressure,
+          .source_value_range = {0, 1},
+      },
+      DampingNodeImplementation{
+          .damping_index = 0,
+          .damping_source = BrushBehavior::DampingSource::kTimeInSeconds,
+          .damping_gap = 0.1,
+      },
+      EasingImplementation({EasingFunction::Predefined::kEaseInOut}),
+      BrushBehavior::ConstantNode{.value = 0.25},
+      BrushBehavior::ConstantNode{.value = 0.75},
+      BrushBehavior::InterpolationNode{
+          .interpolation = BrushBehavior::Interpolation::kLerp,
+      },
+      TargetNodeImplementation{
+          .target_index = 0,
+          .target_modifier_range = {0.5, 1.5},
+      },
+      NoiseNodeImplementation{
+          .generator_index = 0,
+          .vary_over = BrushBehavior::DampingSource::kTimeInSeconds,
+          .base_period = 0.5,
+      },
+      BrushBehavior::SourceNode{
+          .source = BrushBehavior::Source::kTiltInRadians,
+          .source_value_range = {0, 1},
+      },
+      BrushBehavior::ConstantNode{.value = 2},
+      BrushBehavior::BinaryOpNode{
+          .operation = BrushBehavior::BinaryOp::kProduct,
+      },
+      PolarTargetNodeImplementation{
+          .target_x_index = 1,
+          .target_y_index = 2,
+          .angle_range = {0, 1},
+          .magnitude_range = {0, 1},
+      },
+  };
+  StrokeInputModeler::State input_modeler_state;
+  // Leave the second input without pressure or tilt, so that the targets must
+  // carry their previous modifiers over to it.
+  std::vector<ModeledStrokeInput> inputs = {
+      {.elapsed_time = Duration32::Seconds(0.1),
+       .pressure = 0.2,
+       .tilt = Angle::Radians(0.1)},
+      {.elapsed_time = Duration32::Seconds(0.2)},
+      {.elapsed_time = Duration32::Seconds(0.3),
+       .pressure = 0.9,
+       .tilt = Angle::Radians(0.4)},
+      {.elapsed_time = Duration32::Seconds(0.4),
+       .pressure = 0.5,
+       .tilt = Angle::Radians(0.3)},
+  };
+  std::vector<std::optional<Angle>> travel_directions(inputs.size());
+  std::vector<NoiseGenerator> noise_generators = {NoiseGenerator(12345)};
+  std::vector<float> damped_values = {kNullBehaviorNodeValue};
+  std::vector<float> target_modifiers = {1, 0, 0};
+
+  std::vector<float> expected_target_modifiers = ProcessBehaviorNodesOneAtATime(
+      nodes, input_modeler_state, inputs, noise_generators, damped_values,
+      target_modifiers);
+
+  std::vector<float> stack;
+  std::vector<float> input_target_modifiers(inputs.size() *
+                                            target_modifiers.size());
+  BatchBehaviorNodeContext context = {
+      .input_modeler_state = input_modeler_state,
+      .inputs = inputs,
+      .travel_directions = travel_directions,
+      .brush_size = 1,
+      .stack = stack,
+      .noise_generators = absl::MakeSpan(noise_generators),
+      .damped_values = absl::MakeSpan(damped_values),
+      .target_modifiers = absl::MakeSpan(target_modifiers),
+      .input_target_modifiers = absl::MakeSpan(input_target_modifiers),
+  };
+  for (const BehaviorNodeImplementation& node : nodes) {
+    ProcessBehaviorNodeBatch(node, context);
+  }
+
+  EXPECT_THAT(stack, IsEmpty());
+  EXPECT_THAT(input_target_modifiers,
+              Pointwise(FloatEq(), expected_target_modifiers));
+  // The latest modifiers should be those for the last input.
+  EXPECT_THAT(target_modifiers,
+              Pointwise(FloatEq(),
+                        absl::MakeConstSpan(expected_target_modifiers)
+                            .subspan((inputs.size() - 1) *
+                                     target_modifiers.size())));
+}
+
+TEST(ProcessBehaviorNodeBatchTest, NullTargetInputsKeepPreviousModifier) {
+  StrokeInputModeler::State input_modeler_state;
+  std::vector<ModeledStrokeInput> inputs = {
+      {.pressure = 0.5}, {}, {}, {.pressure = 1}};
+  std::vector<std::optional<Angle>> travel_directions(inputs.size());
+  std::vector<float> stack;
+  std::vector<float> target_modifiers = {1};
+  std::vector<float> input_target_modifiers(inputs.size());
+  BatchBehaviorNodeContext context = {
+      .input_modeler_state = input_modeler_state,
+      .inputs = inputs,
+      .travel_directions = travel_directions,
+      .brush_size = 1,
+      .stack = stack,
+      .target_modifiers = absl::MakeSpan(target_modifiers),
+      .input_target_modifiers = absl::MakeSpan(input_target_modifiers),
+  };
+
+  ProcessBehaviorNodeBatch(
+      BrushBehavior::SourceNode{
+          .source = BrushBehavior::Source::kNormalizedPressure,
+          .source_value_range = {0, 1},
+      },
+      context);
+  EXPECT_THAT(stack, ElementsAre(FloatEq(0.5), NullNodeValueMatcher(),
+                                 NullNodeValueMatcher(), FloatEq(1)));
+
+  ProcessBehaviorNodeBatch(
+      TargetNodeImplementation{
+          .target_index = 0,
+          .target_modifier_range = {0, 2},
+      },
+      context);
+  EXPECT_THAT(stack, IsEmpty());
+  EXPECT_THAT(input_target_modifiers, ElementsAre(1, 1, 1, 2));
+  EXPECT_THAT(target_modifiers, ElementsAre(2));
+}
+
 TEST(CreateTipStateTest, HasPassedInPosition) {
   EXPECT_THAT(CreateTipState({0, 0}, Angle(), BrushTip{}, 1.f, {}, {}).position,
               PointEq({0, 0}));
@@ -14,11 +14,17 @@
 
 #include "ink/strokes/internal/brush_tip_modeler.h"
 
+#include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <limits>
+#include <variant>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
+#include "absl/types/span.h"
 #include "ink/brush/brush_behavior.h"
 #include "ink/brush/brush_tip.h"
 #include "ink/brush/easing_function.h"
@@ -40,6 +46,7 @@ using ::testing::ExplainMatchResult;
 using ::testing::Field;
 using ::testing::FloatEq;
 using ::testing::FloatNear;
+using ::testing::Gt;
 using ::testing::IsEmpty;
 using ::testing::Ne;
 using ::testing::Pointwise;
@@ -382,10 +389,6 @@ TEST(BrushTipModelerTest, TipWithFallbackFilter) {
                   BrushBehavior::Source::kSpeedInMultiplesOfBrushSizePerSecond,
               .source_value_range = {0, 1},
           },
-          BrushBehavior::FallbackFilterNode{
-              .is_fallback_for =
-                  BrushBehavior::OptionalInputProperty::kPressure,
-          },
           BrushBehavior::TargetNode{
               .target = BrushBehavior::Target::kWidthMultiplier,
               .target_modifier_range = {1.5, 2},
@@ -456,6 +459,94 @@ TEST(BrushTipModelerTest, TipWithToolTypeFilter) {
   EXPECT_FLOAT_EQ(modeler.NewFixedTipStates().front().width, 1);
 }
 
+TEST(BrushTipModelerTest, TimeBehaviorFilteredOutForToolTypeIsFinished) {
+  BrushTipModeler modeler;
+  BrushTip brush_tip = {
+      .behaviors = {BrushBehavior{{
+          BrushBehavior::SourceNode{
+              .source = BrushBehavior::Source::kTimeSinceInputInSeconds,
+              .source_value_range = {0, 1},
+          },
+          BrushBehavior::ToolTypeFilterNode{
+              .enabled_tool_types = {.stylus = true},
+          },
+          BrushBehavior::TargetNode{
+              .target = BrushBehavior::Target::kSizeMultiplier,
+              .target_modifier_range = {1, 2},
+          },
+      }}},
+  };
+  std::vector<ModeledStrokeInput> inputs = {{.position = {0, 3}}};
+
+  modeler.StartStroke(&brush_tip, 1);
+  StrokeInputModeler::State touch_state = {
+      .tool_type = StrokeInput::ToolType::kTouch,
+      .stable_input_count = 1,
+  };
+  modeler.UpdateStroke(touch_state, inputs);
+  EXPECT_FALSE(modeler.HasUnfinishedTimeBehaviors(touch_state));
+
+  // The same modeler should still apply the behavior to the next stroke if it
+  // is drawn with a stylus.
+  modeler.StartStroke(&brush_tip, 1);
+  StrokeInputModeler::State stylus_state = {
+      .tool_type = StrokeInput::ToolType::kStylus,
+      .stable_input_count = 1,
+  };
+  modeler.UpdateStroke(stylus_state, inputs);
+  EXPECT_TRUE(modeler.HasUnfinishedTimeBehaviors(stylus_state));
+}
+
+TEST(BrushTipModelerTest, BehaviorsOnMissingInputPropertiesHaveNoEffect) {
+  BrushTipModeler modeler;
+  BrushTip brush_tip = {
+      .behaviors = {BrushBehavior{{
+          // Add damped pressure to noise, so that only the pressure is known to
+          // be null ahead of time.
+          BrushBehavior::SourceNode{
+              .source = BrushBehavior::Source::kNormalizedPressure,
+              .source_value_range = {0, 1},
+          },
+          BrushBehavior::DampingNode{
+              .damping_source = BrushBehavior::DampingSource::kTimeInSeconds,
+              .damping_gap = 0.1,
+          },
+          BrushBehavior::NoiseNode{
+              .seed = 1,
+              .vary_over = BrushBehavior::DampingSource::kTimeInSeconds,
+              .base_period = 1,
+          },
+          BrushBehavior::BinaryOpNode{
+              .operation = BrushBehavior::BinaryOp::kSum,
+          },
+          BrushBehavior::TargetNode{
+              .target = BrushBehavior::Target::kWidthMultiplier,
+              .target_modifier_range = {1, 2},
+          },
+      }}},
+  };
+  StrokeInputModeler::State input_modeler_state = {
+      .stable_input_count = 2,
+  };
+
+  // Without pressure, the width is unmodified.
+  modeler.StartStroke(&brush_tip, 1);
+  modeler.UpdateStroke(input_modeler_state,
+                       {{.position = {0, 0}}, {.position = {1, 0}}});
+  ASSERT_EQ(modeler.NewFixedTipStates().size(), 2);
+  EXPECT_THAT(modeler.NewFixedTipStates(),
+              Each(Field(&BrushTipState::width, FloatEq(1))));
+
+  // With full pressure, the behavior applies again, and the sum is at least 1.
+  modeler.StartStroke(&brush_tip, 1);
+  modeler.UpdateStroke(input_modeler_state,
+                       {{.position = {0, 0}, .pressure = 1},
+                        {.position = {1, 0}, .pressure = 1}});
+  ASSERT_EQ(modeler.NewFixedTipStates().size(), 2);
+  EXPECT_THAT(modeler.NewFixedTipStates(),
+              Each(Field(&BrushTipState::width, Gt(1.5))));
+}
+
 TEST(BrushTipModelerTest, TipWithBinaryOpNode) {
   BrushTipModeler modeler;
   BrushTip brush_tip = {
@@ -494,6 +585,171 @@ TEST(BrushTipModelerTest, TipWithBinaryOpNode) {
   EXPECT_FLOAT_EQ(modeler.NewFixedTipStates().front().width, 1.5);
 }
 
+TEST(BrushTipModelerTest, TipWithConstantSubtree) {
+  BrushTipModeler modeler;
+  BrushTip brush_tip = {
+      .behaviors = {BrushBehavior{{
+          BrushBehavior::SourceNode{
+              .source = BrushBehavior::Source::kNormalizedPressure,
+              .source_value_range = {0, 1},
+          },
+          BrushBehavior::ConstantNode{.value = 0.5},
+          BrushBehavior::ConstantNode{.value = 0.25},
+          BrushBehavior::ConstantNode{.value = 0.75},
+          BrushBehavior::InterpolationNode{
+              .interpolation = BrushBehavior::Interpolation::kInverseLerp,
+          },
+          BrushBehavior::ResponseNode{
+              .response_curve = {EasingFunction::Predefined::kLinear},
+          },
+          BrushBehavior::ConstantNode{.value = 0.5},
+          BrushBehavior::BinaryOpNode{
+              .operation = BrushBehavior::BinaryOp::kProduct,
+          },
+          BrushBehavior::BinaryOpNode{
+              .operation = BrushBehavior::BinaryOp::kSum,
+          },
+          BrushBehavior::TargetNode{
+              .target = BrushBehavior::Target::kWidthMultiplier,
+              .target_modifier_range = {1, 2},
+          },
+      }}}};
+  modeler.StartStroke(&brush_tip, 1);
+
+  std::vector<ModeledStrokeInput> inputs = {{.pressure = 0.25}};
+  StrokeInputModeler::State input_modeler_state = {.stable_input_count = 1};
+  modeler.UpdateStroke(input_modeler_state, inputs);
+
+  // The constant-only subtree evaluates to inverse_lerp(0.25, 0.75, 0.5) * 0.5
+  // = 0.25, which is added to the pressure of 0.25 to give a width multiplier
+  // of 1.5.
+  ASSERT_FALSE(modeler.NewFixedTipStates().empty());
+  EXPECT_FLOAT_EQ(modeler.NewFixedTipStates().front().width, 1.5);
+}
+
+TEST(BrushTipModelerTest, TipWithNullConstantSubtree) {
+  BrushTipModeler modeler;
+  BrushTip brush_tip = {
+      .behaviors = {BrushBehavior{{
+          BrushBehavior::ConstantNode{.value = 0.5},
+          BrushBehavior::ConstantNode{.value = 1},
+          BrushBehavior::ConstantNode{.value = 1},
+          BrushBehavior::InterpolationNode{
+              .interpolation = BrushBehavior::Interpolation::kInverseLerp,
+          },
+          BrushBehavior::TargetNode{
+              .target = BrushBehavior::Target::kWidthMultiplier,
+              .target_modifier_range = {1, 2},
+          },
+      }}}};
+  modeler.StartStroke(&brush_tip, 1);
+
+  std::vector<ModeledStrokeInput> inputs = {{}};
+  StrokeInputModeler::State input_modeler_state = {.stable_input_count = 1};
+  modeler.UpdateStroke(input_modeler_state, inputs);
+
+  // An inverse lerp over an empty range is null, so the target should be left
+  // unmodified even after the constant subtree is folded away.
+  ASSERT_FALSE(modeler.NewFixedTipStates().empty());
+  EXPECT_FLOAT_EQ(modeler.NewFixedTipStates().front().width, 1);
+}
+
+TEST(BrushTipModelerTest, BehaviorFreeTipMatchesGeneralPath) {
+  BrushTip behavior_free_tip = {
+      .scale = {1.5, 0.5},
+      .corner_rounding = 0.25,
+      .slant = Angle::Degrees(10),
+      .pinch = 0.5,
+      .rotation = Angle::Degrees(30),
+      .opacity_multiplier = 0.75,
+  };
+  // A behavior that never changes its target's initial modifier still has to
+  // be evaluated by the general path, with the travel direction of each input.
+  BrushTip tip_with_behavior = behavior_free_tip;
+  tip_with_behavior.behaviors = {BrushBehavior{{
+      BrushBehavior::ConstantNode{.value = 0},
+      BrushBehavior::TargetNode{
+          .target = BrushBehavior::Target::
+              kPositionOffsetForwardInMultiplesOfBrushSize,
+          .target_modifier_range = {0, 1},
+      },
+  }}};
+
+  std::vector<ModeledStrokeInput> inputs = {
+      {.position = {0, 0}}, {.position = {1, 0.5}}, {.position = {2, 2}},
+      {.position = {1, 3}}, {.position = {-1, 2}},
+  };
+  StrokeInputModeler::State input_modeler_state = {.stable_input_count = 3};
+
+  BrushTipModeler behavior_free_modeler;
+  behavior_free_modeler.StartStroke(&behavior_free_tip, 2);
+  behavior_free_modeler.UpdateStroke(input_modeler_state, inputs);
+  BrushTipModeler general_modeler;
+  general_modeler.StartStroke(&tip_with_behavior, 2);
+  general_modeler.UpdateStroke(input_modeler_state, inputs);
+
+  std::vector<BrushTipState> behavior_free_states;
+  absl::c_copy(behavior_free_modeler.NewFixedTipStates(),
+               std::back_inserter(behavior_free_states));
+  absl::c_copy(behavior_free_modeler.VolatileTipStates(),
+               std::back_inserter(behavior_free_states));
+  std::vector<BrushTipState> general_states;
+  absl::c_copy(general_modeler.NewFixedTipStates(),
+               std::back_inserter(general_states));
+  absl::c_copy(general_modeler.VolatileTipStates(),
+               std::back_inserter(general_states));
+
+  ASSERT_EQ(behavior_free_states.size(), inputs.size());
+  ASSERT_EQ(general_states.size(), inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const BrushTipState& actual = behavior_free_states[i];
+    const BrushTipState& expected = general_states[i];
+    EXPECT_THAT(actual.position, PointEq(expected.position));
+    EXPECT_THAT(actual, NonPositionFieldsEq(expected));
+    EXPECT_THAT(actual.slant, AngleEq(expected.slant));
+    EXPECT_FLOAT_EQ(actual.pinch, expected.pinch);
+    EXPECT_FLOAT_EQ(actual.opacity_multiplier, expected.opacity_multiplier);
+  }
+}
+
+TEST(BrushTipModelerTest, StartStrokeOverWithModifiedTip) {
+  BrushTipModeler modeler;
+  BrushTip brush_tip = {
+      .behaviors = {BrushBehavior{{
+          BrushBehavior::SourceNode{
+              .source = BrushBehavior::Source::kNormalizedPressure,
+              .source_value_range = {0, 1},
+          },
+          BrushBehavior::TargetNode{
+              .target = BrushBehavior::Target::kWidthMultiplier,
+              .target_modifier_range = {1, 2},
+          },
+      }}}};
+  std::vector<ModeledStrokeInput> inputs = {{.pressure = 0.5}};
+  StrokeInputModeler::State input_modeler_state = {.stable_input_count = 1};
+
+  modeler.StartStroke(&brush_tip, 1);
+  modeler.UpdateStroke(input_modeler_state, inputs);
+  ASSERT_FALSE(modeler.NewFixedTipStates().empty());
+  EXPECT_FLOAT_EQ(modeler.NewFixedTipStates().front().width, 1.5);
+
+  // Starting over with the same tip should give the same result.
+  modeler.StartStroke(&brush_tip, 1);
+  modeler.UpdateStroke(input_modeler_state, inputs);
+  ASSERT_FALSE(modeler.NewFixedTipStates().empty());
+  EXPECT_FLOAT_EQ(modeler.NewFixedTipStates().front().width, 1.5);
+
+  // Modifying the tip in place must not reuse the behaviors compiled for the
+  // previous stroke, even though the tip's address has not changed.
+  std::get<BrushBehavior::TargetNode>(brush_tip.behaviors[0].nodes[1])
+      .target = BrushBehavior::Target::kHeightMultiplier;
+  modeler.StartStroke(&brush_tip, 1);
+  modeler.UpdateStroke(input_modeler_state, inputs);
+  ASSERT_FALSE(modeler.NewFixedTipStates().empty());
+  EXPECT_FLOAT_EQ(modeler.NewFixedTipStates().front().width, 1);
+  EXPECT_FLOAT_EQ(modeler.NewFixedTipStates().front().height, 1.5);
+}
+
 TEST(BrushTipModelerTest, TipWithClampedDistanceRemainingBehavior) {
   float max_distance_remaining_multiple = 2;
   BrushTipModeler modeler;
@@ -719,6 +975,100 @@ TEST(BrushTipModelerTest, StartStrokeWithDistanceRemainingBehaviorsOver) {
   EXPECT_EQ(modeler.VolatileTipStates().size(), 0);
 }
 
+TEST(BrushTipModelerTest, IncrementalUpdatesWithMixedDistanceRemaining) {
+  // One behavior tapers the end of the stroke, which keeps the last few stable
+  // tip states volatile, and the other damps pressure, which does not depend
+  // on the end of the stroke.
+  BrushTip brush_tip = {
+      .behaviors = {
+          BrushBehavior{{
+              BrushBehavior::SourceNode{
+                  .source = BrushBehavior::Source::
+                      kDistanceRemainingInMultiplesOfBrushSize,
+                  .source_value_range = {0, 3},
+              },
+              BrushBehavior::TargetNode{
+                  .target = BrushBehavior::Target::kWidthMultiplier,
+                  .target_modifier_range = {0.5, 1},
+              },
+          }},
+          BrushBehavior{{
+              BrushBehavior::SourceNode{
+                  .source = BrushBehavior::Source::kNormalizedPressure,
+                  .source_value_range = {0, 1},
+              },
+              BrushBehavior::DampingNode{
+                  .damping_source = BrushBehavior::DampingSource::
+                      kDistanceInMultiplesOfBrushSize,
+                  .damping_gap = 2,
+              },
+              BrushBehavior::TargetNode{
+                  .target = BrushBehavior::Target::kHeightMultiplier,
+                  .target_modifier_range = {0.5, 1.5},
+              },
+          }},
+      }};
+  float brush_size = 1;
+
+  std::vector<ModeledStrokeInput> inputs;
+  for (int i = 0; i < 20; ++i) {
+    inputs.push_back({
+        .position = {0, static_cast<float>(i)},
+        .traveled_distance = static_cast<float>(i),
+        .elapsed_time = Duration32::Seconds(0.01 * i),
+        .pressure = 0.5f + 0.4f * std::sin(static_cast<float>(i)),
+    });
+  }
+
+  // Extend the stroke a few inputs at a time, always with two unstable inputs
+  // at the end, collecting the fixed tip states from each update.
+  BrushTipModeler incremental_modeler;
+  incremental_modeler.StartStroke(&brush_tip, brush_size);
+  std::vector<BrushTipState> incremental_tip_states;
+  for (size_t input_count = 3; input_count <= inputs.size();
+       input_count += 3) {
+    StrokeInputModeler::State state = {
+        .complete_traveled_distance = inputs[input_count - 1].traveled_distance,
+        .stable_input_count = input_count - 2,
+    };
+    incremental_modeler.UpdateStroke(
+        state, absl::MakeConstSpan(inputs).first(input_count));
+    absl::Span<const BrushTipState> fixed =
+        incremental_modeler.NewFixedTipStates();
+    incremental_tip_states.insert(incremental_tip_states.end(), fixed.begin(),
+                                  fixed.end());
+  }
+  size_t final_input_count = inputs.size() - inputs.size() % 3;
+  absl::Span<const BrushTipState> volatile_states =
+      incremental_modeler.VolatileTipStates();
+  incremental_tip_states.insert(incremental_tip_states.end(),
+                                volatile_states.begin(), volatile_states.end());
+
+  // Model the same final state all at once.
+  BrushTipModeler complete_modeler;
+  complete_modeler.StartStroke(&brush_tip, brush_size);
+  StrokeInputModeler::State state = {
+      .complete_traveled_distance =
+          inputs[final_input_count - 1].traveled_distance,
+      .stable_input_count = final_input_count - 2,
+  };
+  complete_modeler.UpdateStroke(
+      state, absl::MakeConstSpan(inputs).first(final_input_count));
+  std::vector<BrushTipState> complete_tip_states(
+      complete_modeler.NewFixedTipStates().begin(),
+      complete_modeler.NewFixedTipStates().end());
+  complete_tip_states.insert(complete_tip_states.end(),
+                             complete_modeler.VolatileTipStates().begin(),
+                             complete_modeler.VolatileTipStates().end());
+
+  ASSERT_EQ(incremental_tip_states.size(), complete_tip_states.size());
+  for (size_t i = 0; i < complete_tip_states.size(); ++i) {
+    EXPECT_THAT(incremental_tip_states[i],
+                NonPositionFieldsEq(complete_tip_states[i]))
+        << "at index " << i;
+  }
+}
+
 TEST(BrushTipModelerTest, TipWithSecondsRemainingBehavior) {
   BrushTipModeler modeler;
   BrushTip brush_tip = {
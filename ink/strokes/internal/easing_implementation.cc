@@ -25,6 +25,7 @@
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "ink/brush/easing_function.h"
 #include "ink/geometry/internal/algorithms.h"
 #include "ink/geometry/point.h"
@@ -202,6 +203,15 @@ float EasingImplementation::GetY(float x) const {
                     implementation_type_);
 }
 
+void EasingImplementation::GetY(absl::Span<float> values) const {
+  std::visit(
+      absl::Overload([](const Identity& arg) {},
+                     [values](const auto& arg) {
+                       for (float& value : values) value = arg.GetY(value);
+                     }),
+      implementation_type_);
+}
+
 float EasingImplementation::Identity::GetY(float x) const { return x; }
 
 float EasingImplementation::CubicBezierApproximation::GetY(float x) const {
@@ -225,9 +235,18 @@ float EasingImplementation::Linear::GetY(float x) const {
   // x-positions of `points` are monotonically non-decreasing.  Therefore,
   // `std::upper_bound` will return an iterator to the first point whose
   // x-position is strictly greater than `x`, if any.
-  auto iter =
-      std::upper_bound(points.begin(), points.end(), x,
-                       [](float x, Point point) { return x < point.x; });
+  auto iter = points.begin();
+  if (points.size() <= kInlineSize) {
+    // For the small point counts we expect, counting the points with x-position
+    // at most `x` avoids the unpredictable branches of a binary search, and
+    // gives the same result since the points are sorted.
+    size_t count = 0;
+    for (const Point& point : points) count += point.x <= x;
+    iter += count;
+  } else {
+    iter = std::upper_bound(points.begin(), points.end(), x,
+                            [](float x, Point point) { return x < point.x; });
+  }
 
   Point prev = {0, 0};
   Point next = {1, 1};
@@ -254,10 +273,12 @@ float EasingImplementation::Linear::GetY(float x) const {
 }
 
 float EasingImplementation::Steps::GetY(float x) const {
-  if (x < 0) return 0;
-  if (x >= 1) return 1;
-
-  return starting_y + step_height * std::floor(step_count * x);
+  // Computing the step value unconditionally and then selecting the result
+  // lets this compile to conditional moves (and vectorize in the span
+  // overload of `GetY()`) instead of branches.
+  float y = starting_y + step_height * std::floor(step_count * x);
+  y = x >= 1 ? 1.f : y;
+  return x < 0 ? 0.f : y;
 }
 
 void EasingImplementation::AppendUnitIntervalCriticalPoints(
@@ -19,6 +19,7 @@
 #include <variant>
 
 #include "absl/container/inlined_vector.h"
+#include "absl/types/span.h"
 #include "ink/brush/easing_function.h"
 #include "ink/geometry/point.h"
 
@@ -42,6 +43,11 @@ class EasingImplementation {
 
   float GetY(float x) const;
 
+  // Replaces each x value in `values` with its y value, selecting the
+  // implementation for the easing function once for the whole span rather than
+  // once per value.
+  void GetY(absl::Span<float> values) const;
+
   // Appends `critical_points` with critical points, i.e. the x values where the
   // derivative is zero or undefined, in the unit interval. Zero and one are
   // only appended where they actually constitute critical points for that
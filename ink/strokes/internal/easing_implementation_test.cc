@@ -14,12 +14,16 @@
 
 #include "ink/strokes/internal/easing_implementation.h"
 
+#include <cmath>
+#include <cstddef>
 #include <limits>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/types/span.h"
 #include "ink/brush/easing_function.h"
 #include "ink/brush/fuzz_domains.h"
 
@@ -490,5 +494,24 @@ void EasingImplementationDoesNotCrash(const EasingFunction& easing_function,
 FUZZ_TEST(EasingImplementationTest, EasingImplementationDoesNotCrash)
     .WithDomains(ValidEasingFunction(), fuzztest::Arbitrary<float>());
 
+void SpanGetYMatchesScalarGetY(const EasingFunction& easing_function,
+                               std::vector<float> x_values) {
+  EasingImplementation easing_implementation(easing_function);
+  std::vector<float> y_values = x_values;
+  easing_implementation.GetY(absl::MakeSpan(y_values));
+  ASSERT_EQ(y_values.size(), x_values.size());
+  for (size_t i = 0; i < x_values.size(); ++i) {
+    float expected = easing_implementation.GetY(x_values[i]);
+    if (std::isnan(expected)) {
+      EXPECT_THAT(y_values[i], IsNan()) << "at x = " << x_values[i];
+    } else {
+      EXPECT_EQ(y_values[i], expected) << "at x = " << x_values[i];
+    }
+  }
+}
+FUZZ_TEST(EasingImplementationTest, SpanGetYMatchesScalarGetY)
+    .WithDomains(ValidEasingFunction(),
+                 fuzztest::VectorOf(fuzztest::Arbitrary<float>()));
+
 }  // namespace
 }  // namespace ink::strokes_internal
@@ -14,37 +14,56 @@
 
 #include <jni.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <optional>
 
 #include "absl/base/nullability.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "ink/brush/internal/jni/brush_jni_helper.h"
+#include "ink/geometry/angle.h"
 #include "ink/geometry/envelope.h"
 #include "ink/geometry/internal/jni/box_accumulator_jni_helper.h"
 #include "ink/geometry/internal/jni/mesh_format_jni_helper.h"
 #include "ink/geometry/internal/jni/vec_jni_helper.h"
 #include "ink/geometry/mutable_mesh.h"
 #include "ink/geometry/point.h"
+#include "ink/jni/internal/jni_array_util.h"
 #include "ink/jni/internal/jni_defines.h"
+#include "ink/jni/internal/jni_native_registration.h"
 #include "ink/jni/internal/jni_throw_util.h"
+#include "ink/jni/internal/jni_worker_thread.h"
 #include "ink/strokes/in_progress_stroke.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
 #include "ink/strokes/internal/jni/in_progress_stroke_jni_helper.h"
 #include "ink/strokes/internal/jni/stroke_input_jni_helper.h"
 #include "ink/strokes/internal/jni/stroke_jni_helper.h"
+#include "ink/strokes/stroke_shape_stats.h"
+#include "ink/strokes/stroke_update_histograms.h"
 #include "ink/types/duration.h"
+#include "ink/types/histogram.h"
+#include "ink/types/physical_distance.h"
 
 namespace {
 
+using ::ink::Angle;
 using ::ink::Duration32;
 using ::ink::Envelope;
+using ::ink::Histogram;
 using ::ink::InProgressStroke;
+using ::ink::MutableMesh;
+using ::ink::PhysicalDistance;
 using ::ink::Point;
 using ::ink::StrokeInput;
 using ::ink::StrokeInputBatch;
+using ::ink::StrokeShapeStats;
+using ::ink::StrokeUpdateHistograms;
+using ::ink::jni::AddNativeRegistration;
 using ::ink::jni::CastToBrush;
 using ::ink::jni::CastToInProgressStrokeWrapper;
 using ::ink::jni::CastToMutableInProgressStrokeWrapper;
@@ -54,11 +73,18 @@ using ::ink::jni::DeleteNativeInProgressStroke;
 using ::ink::jni::FillJBoxAccumulatorOrThrow;
 using ::ink::jni::FillJMutableVecFromPointOrThrow;
 using ::ink::jni::InProgressStrokeWrapper;
+using ::ink::jni::JIntToToolType;
+using ::ink::jni::JniWorkerThread;
+using ::ink::jni::MeshPartitionWriteStart;
 using ::ink::jni::NewNativeInProgressStroke;
 using ::ink::jni::NewNativeMeshFormat;
 using ::ink::jni::NewNativeStroke;
+using ::ink::jni::SharedStrokeUpdateHistograms;
 using ::ink::jni::ThrowExceptionFromStatus;
+using ::ink::jni::TryRegisterNatives;
 using ::ink::jni::UpdateJObjectInputOrThrow;
+using ::ink::jni::WriteToFloatBufferOrArray;
+using ::ink::jni::WriteToIntArray;
 
 }  // namespace
 
@@ -75,7 +101,7 @@ JNI_METHOD(strokes, InProgressStrokeNative, void, free)
 
 JNI_METHOD(strokes, InProgressStrokeNative, void, clear)
 (JNIEnv* env, jobject thiz, jlong native_pointer) {
-  CastToMutableInProgressStrokeWrapper(native_pointer).Stroke().Clear();
+  CastToMutableInProgressStrokeWrapper(native_pointer).Clear();
 }
 
 // Starts the stroke with a brush.
@@ -86,6 +112,16 @@ JNI_METHOD(strokes, InProgressStrokeNative, void, start)
       .Start(CastToBrush(brush_native_pointer), noise_seed);
 }
 
+// Starts the stroke with a brush, with its shape updated on a native worker
+// thread by enqueueInputsAndUpdateShapeAsync.
+JNI_METHOD(strokes, InProgressStrokeNative, void, startAsync)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jlong brush_native_pointer,
+ jint noise_seed) {
+  CastToMutableInProgressStrokeWrapper(native_pointer)
+      .StartAsync(CastToBrush(brush_native_pointer), noise_seed,
+                  JniWorkerThread());
+}
+
 JNI_METHOD(strokes, InProgressStrokeNative, jboolean, enqueueInputs)
 (JNIEnv* env, jobject thiz, jlong native_pointer, jlong real_inputs_pointer,
  jlong predicted_inputs_pointer) {
@@ -114,6 +150,91 @@ JNI_METHOD(strokes, InProgressStrokeNative, jboolean, updateShape)
   return true;
 }
 
+// Queues up one real input to be added by updateShapeWithQueuedInputs. This may
+// be called on the thread that receives input events while the stroke is
+// updated on another thread; it takes no lock and does not allocate. Returns
+// false if the queue is full, in which case the input was not queued, and
+// should be written again after the next update.
+JNI_METHOD(strokes, InProgressStrokeNative, jboolean, writeQueuedInput)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint tool_type, jfloat x,
+ jfloat y, jlong elapsed_time_millis, jfloat stroke_unit_length_cm,
+ jfloat pressure, jfloat tilt, jfloat orientation) {
+  StrokeInput input = {.tool_type = JIntToToolType(tool_type),
+                       .position = {x, y},
+                       .elapsed_time = Duration32::Millis(elapsed_time_millis),
+                       .stroke_unit_length =
+                           PhysicalDistance::Centimeters(stroke_unit_length_cm),
+                       .pressure = pressure,
+                       .tilt = Angle::Radians(tilt),
+                       .orientation = Angle::Radians(orientation)};
+  return CastToMutableInProgressStrokeWrapper(native_pointer)
+             .WriteQueuedInputs(absl::MakeConstSpan(&input, 1)) == 1;
+}
+
+// Adds the inputs queued up by writeQueuedInput, clearing any predicted inputs,
+// and updates the shape.
+JNI_METHOD(strokes, InProgressStrokeNative, jboolean,
+           updateShapeWithQueuedInputs)
+(JNIEnv* env, jobject thiz, jlong native_pointer,
+ jlong j_current_elapsed_time_millis) {
+  if (absl::Status status =
+          CastToMutableInProgressStrokeWrapper(native_pointer)
+              .UpdateShapeWithQueuedInputs(
+                  Duration32::Millis(j_current_elapsed_time_millis));
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+    return false;
+  }
+  return true;
+}
+
+// For a stroke started with startAsync, queues up adding the inputs, finishing
+// the inputs if requested, and updating the shape, on the native worker
+// thread. The resulting shape is tagged with `frame_number`, and becomes
+// visible through the other methods once it is latched with
+// latchCompletedUpdate or awaitUpdate.
+JNI_METHOD(strokes, InProgressStrokeNative, void,
+           enqueueInputsAndUpdateShapeAsync)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jlong real_inputs_pointer,
+ jlong predicted_inputs_pointer, jboolean finish_inputs,
+ jlong j_current_elapsed_time_millis, jlong frame_number) {
+  CastToMutableInProgressStrokeWrapper(native_pointer)
+      .EnqueueInputsAndUpdateShapeAsync(
+          CastToStrokeInputBatch(real_inputs_pointer),
+          CastToStrokeInputBatch(predicted_inputs_pointer), finish_inputs,
+          Duration32::Millis(j_current_elapsed_time_millis), frame_number);
+}
+
+// Makes the shape of the most recently completed asynchronous update visible,
+// and returns its frame number, or -1 if no update was completed yet. This
+// acts as the fence for asynchronous updates: buffers returned for the
+// previous shape must no longer be in use when this is called.
+JNI_METHOD(strokes, InProgressStrokeNative, jlong, latchCompletedUpdate)
+(JNIEnv* env, jobject thiz, jlong native_pointer) {
+  absl::StatusOr<int64_t> frame_number =
+      CastToMutableInProgressStrokeWrapper(native_pointer)
+          .LatchCompletedUpdate();
+  if (!frame_number.ok()) {
+    ThrowExceptionFromStatus(env, frame_number.status());
+    return -1;
+  }
+  return *frame_number;
+}
+
+// Like latchCompletedUpdate, but first blocks until the update tagged with
+// `frame_number`, or a later one, has completed.
+JNI_METHOD(strokes, InProgressStrokeNative, jlong, awaitUpdate)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jlong frame_number) {
+  absl::StatusOr<int64_t> latched_frame_number =
+      CastToMutableInProgressStrokeWrapper(native_pointer)
+          .AwaitUpdate(frame_number);
+  if (!latched_frame_number.ok()) {
+    ThrowExceptionFromStatus(env, latched_frame_number.status());
+    return -1;
+  }
+  return *latched_frame_number;
+}
+
 JNI_METHOD(strokes, InProgressStrokeNative, void, finishInput)
 (JNIEnv* env, jobject thiz, jlong native_pointer) {
   CastToMutableInProgressStrokeWrapper(native_pointer).Stroke().FinishInputs();
@@ -152,6 +273,21 @@ JNI_METHOD(strokes, InProgressStrokeNative, jlong, newStrokeFromPrunedCopy)
           .CopyToStroke(InProgressStroke::RetainAttributes::kUsedByThisBrush));
 }
 
+JNI_METHOD(strokes, InProgressStrokeNative, jlong, newStrokeFromMove)
+(JNIEnv* env, jobject thiz, jlong native_pointer) {
+  return NewNativeStroke(CastToMutableInProgressStrokeWrapper(native_pointer)
+                             .Stroke()
+                             .MoveToStroke());
+}
+
+JNI_METHOD(strokes, InProgressStrokeNative, jlong, newStrokeFromPrunedMove)
+(JNIEnv* env, jobject thiz, jlong native_pointer) {
+  return NewNativeStroke(
+      CastToMutableInProgressStrokeWrapper(native_pointer)
+          .Stroke()
+          .MoveToStroke(InProgressStroke::RetainAttributes::kUsedByThisBrush));
+}
+
 JNI_METHOD(strokes, InProgressStrokeNative, jint, getInputCount)
 (JNIEnv* env, jobject thiz, jlong native_pointer) {
   return CastToInProgressStrokeWrapper(native_pointer).Stroke().InputCount();
@@ -228,6 +364,105 @@ JNI_METHOD(strokes, InProgressStrokeNative, void, resetUpdatedRegion)
       .ResetUpdatedRegion();
 }
 
+// Returns the first vertex of the whole coat mesh that was updated since the
+// last reset of the updated region, or -1 if there were no updates. The index
+// is not relative to any mesh partition.
+JNI_METHOD(strokes, InProgressStrokeNative, jint, getFirstUpdatedVertex)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index) {
+  std::optional<uint32_t> first_vertex =
+      CastToInProgressStrokeWrapper(native_pointer)
+          .Stroke()
+          .GetCoatFirstUpdatedVertex(coat_index);
+  return first_vertex.has_value() ? *first_vertex : -1;
+}
+
+// Returns the first triangle of the whole coat mesh that was updated since the
+// last reset of the updated region, or -1 if there were no updates. The index
+// is not relative to any mesh partition.
+JNI_METHOD(strokes, InProgressStrokeNative, jint, getFirstUpdatedTriangle)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index) {
+  std::optional<uint32_t> first_triangle =
+      CastToInProgressStrokeWrapper(native_pointer)
+          .Stroke()
+          .GetCoatFirstUpdatedTriangle(coat_index);
+  return first_triangle.has_value() ? *first_triangle : -1;
+}
+
+JNI_METHOD(strokes, InProgressStrokeNative, jboolean, isUpdateStatsEnabled)
+(JNIEnv* env, jobject thiz) { return ink::kStrokeShapeStatsEnabled; }
+
+// Returns the values of `InProgressStroke::GetLastUpdateStats()` as a new long
+// array, in the order that the fields are declared in `StrokeShapeStats`.
+JNI_METHOD(strokes, InProgressStrokeNative, jlongArray, getLastUpdateStats)
+(JNIEnv* env, jobject thiz, jlong native_pointer) {
+  const StrokeShapeStats& stats = CastToInProgressStrokeWrapper(native_pointer)
+                                      .Stroke()
+                                      .GetLastUpdateStats();
+  const jlong values[] = {
+      stats.input_modeling_nanos,
+      stats.tip_modeling_nanos,
+      stats.extrusion_nanos,
+      stats.intersection_handling_nanos,
+      stats.simplification_nanos,
+      stats.derivative_update_nanos,
+      stats.vertices_appended,
+      stats.triangles_appended,
+      stats.vertices_reverted,
+      stats.triangles_reverted,
+      stats.vertices_simplified_away,
+      stats.intersection_handling_fallbacks,
+  };
+  constexpr jsize kValueCount = sizeof(values) / sizeof(values[0]);
+  jlongArray j_values = env->NewLongArray(kValueCount);
+  env->SetLongArrayRegion(j_values, 0, kValueCount, values);
+  return j_values;
+}
+
+// Sets whether strokes started by later calls to start or startAsync record
+// their updates in the process-wide update histograms.
+JNI_METHOD(strokes, InProgressStrokeNative, void, setUpdateHistogramsEnabled)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jboolean enabled) {
+  CastToMutableInProgressStrokeWrapper(native_pointer)
+      .SetUpdateHistogramsEnabled(enabled);
+}
+
+// Returns a summary of one of the process-wide update histograms as a new long
+// array of {count, sum, max, p50, p90, p95, p99}. `histogram_index` picks the
+// histogram, in the order that the fields are declared in
+// `StrokeUpdateHistograms`.
+JNI_METHOD(strokes, InProgressStrokeNative, jlongArray,
+           getUpdateHistogramSummary)
+(JNIEnv* env, jobject thiz, jint histogram_index) {
+  StrokeUpdateHistograms& histograms = SharedStrokeUpdateHistograms();
+  const Histogram* const kHistograms[] = {
+      &histograms.update_shape_nanos,
+      &histograms.inputs_per_update,
+      &histograms.modeled_inputs_per_update,
+      &histograms.input_latency_nanos,
+  };
+  ABSL_CHECK_GE(histogram_index, 0);
+  ABSL_CHECK_LT(histogram_index, static_cast<jint>(std::size(kHistograms)));
+  const Histogram& histogram = *kHistograms[histogram_index];
+  const jlong values[] = {
+      histogram.Count(),
+      histogram.Sum(),
+      histogram.Max(),
+      histogram.Percentile(0.5),
+      histogram.Percentile(0.9),
+      histogram.Percentile(0.95),
+      histogram.Percentile(0.99),
+  };
+  constexpr jsize kValueCount = sizeof(values) / sizeof(values[0]);
+  jlongArray j_values = env->NewLongArray(kValueCount);
+  env->SetLongArrayRegion(j_values, 0, kValueCount, values);
+  return j_values;
+}
+
+// Forgets everything recorded in the process-wide update histograms, e.g. after
+// uploading them.
+JNI_METHOD(strokes, InProgressStrokeNative, void, resetUpdateHistograms)
+(JNIEnv* env, jobject thiz) { SharedStrokeUpdateHistograms().Reset(); }
+
 JNI_METHOD(strokes, InProgressStrokeNative, jint, getOutlineCount)
 (JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index) {
   return CastToInProgressStrokeWrapper(native_pointer)
@@ -257,6 +492,72 @@ JNI_METHOD(strokes, InProgressStrokeNative, void, fillOutlinePosition)
   FillJMutableVecFromPointOrThrow(env, out_position, position);
 }
 
+JNI_METHOD(strokes, InProgressStrokeNative, jint, getTotalOutlineVertexCount)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index) {
+  jint count = 0;
+  for (absl::Span<const uint32_t> outline :
+       CastToInProgressStrokeWrapper(native_pointer)
+           .Stroke()
+           .GetCoatOutlines(coat_index)) {
+    count += outline.size();
+  }
+  return count;
+}
+
+// Writes the vertex count of each outline of the coat into `out_counts`, which
+// must hold at least `getOutlineCount()` values.
+JNI_METHOD(strokes, InProgressStrokeNative, void, fillOutlineVertexCounts)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index,
+ jintArray out_counts) {
+  absl::Span<const absl::Span<const uint32_t>> outlines =
+      CastToInProgressStrokeWrapper(native_pointer)
+          .Stroke()
+          .GetCoatOutlines(coat_index);
+  if (absl::Status status = WriteToIntArray(
+          env, out_counts, outlines.size(),
+          [outlines](absl::Span<jint> counts) {
+            for (size_t i = 0; i < outlines.size(); ++i) {
+              counts[i] = outlines[i].size();
+            }
+          });
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+  }
+}
+
+// Writes the x and y of every outline vertex of the coat, outline after
+// outline, into either `out_direct_buffer` or `out_array`, one of which must be
+// non-null and hold at least twice `getTotalOutlineVertexCount()` floats. This
+// replaces a `fillOutlinePosition()` call per vertex with a single call.
+JNI_METHOD(strokes, InProgressStrokeNative, void, fillOutlinePositions)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index,
+ jobject out_direct_buffer, jfloatArray out_array) {
+  const InProgressStroke& in_progress_stroke =
+      CastToInProgressStrokeWrapper(native_pointer).Stroke();
+  absl::Span<const absl::Span<const uint32_t>> outlines =
+      in_progress_stroke.GetCoatOutlines(coat_index);
+  const MutableMesh& mesh = in_progress_stroke.GetMesh(coat_index);
+  jint vertex_count = 0;
+  for (absl::Span<const uint32_t> outline : outlines) {
+    vertex_count += outline.size();
+  }
+  if (absl::Status status = WriteToFloatBufferOrArray(
+          env, out_direct_buffer, out_array, 2 * vertex_count,
+          [outlines, &mesh](absl::Span<jfloat> positions) {
+            size_t i = 0;
+            for (absl::Span<const uint32_t> outline : outlines) {
+              for (uint32_t vertex_index : outline) {
+                Point position = mesh.VertexPosition(vertex_index);
+                positions[i++] = position.x;
+                positions[i++] = position.y;
+              }
+            }
+          });
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+  }
+}
+
 JNI_METHOD(strokes, InProgressStrokeNative, jint, getMeshPartitionCount)
 (JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index) {
   return CastToInProgressStrokeWrapper(native_pointer)
@@ -270,6 +571,29 @@ JNI_METHOD(strokes, InProgressStrokeNative, jint, getVertexCount)
       .VertexCount(coat_index, mesh_index);
 }
 
+// Writes the vertex count and triangle count of each mesh partition of the
+// coat, interleaved, into `out_counts`, which must hold at least twice
+// `getMeshPartitionCount()` values.
+JNI_METHOD(strokes, InProgressStrokeNative, void,
+           fillMeshPartitionVertexAndTriangleCounts)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index,
+ jintArray out_counts) {
+  const InProgressStrokeWrapper& wrapper =
+      CastToInProgressStrokeWrapper(native_pointer);
+  int partition_count = wrapper.MeshPartitionCount(coat_index);
+  if (absl::Status status = WriteToIntArray(
+          env, out_counts, 2 * partition_count,
+          [&wrapper, coat_index, partition_count](absl::Span<jint> counts) {
+            for (int i = 0; i < partition_count; ++i) {
+              counts[2 * i] = wrapper.VertexCount(coat_index, i);
+              counts[2 * i + 1] = wrapper.TriangleCount(coat_index, i);
+            }
+          });
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+  }
+}
+
 JNI_METHOD(strokes, InProgressStrokeNative, absl_nullable jobject,
            getUnsafelyMutableRawVertexData)
 (JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index,
@@ -294,6 +618,45 @@ JNI_METHOD(strokes, InProgressStrokeNative, absl_nullable jobject,
       .GetUnsafelyMutableRawTriangleIndexData(env, coat_index, mesh_index);
 }
 
+// Copies the vertex data and 16-bit triangle index data of the given mesh
+// partition into the direct byte buffers `vertex_buffer` and `index_buffer`,
+// which may wrap memory that the renderer binds without another copy, and
+// writes the partition-relative vertex and index at which the copy started to
+// `out_write_start`. If `only_updated` is true, only the data that may have
+// changed since the updated region was last reset is written. See
+// `InProgressStrokeWrapper::WriteMeshPartitionData()`.
+JNI_METHOD(strokes, InProgressStrokeNative, void, writeMeshPartitionData)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index,
+ jint mesh_index, jboolean only_updated, jobject vertex_buffer,
+ jobject index_buffer, jintArray out_write_start) {
+  ABSL_CHECK(vertex_buffer != nullptr);
+  ABSL_CHECK(index_buffer != nullptr);
+  void* vertex_address = env->GetDirectBufferAddress(vertex_buffer);
+  void* index_address = env->GetDirectBufferAddress(index_buffer);
+  ABSL_CHECK(vertex_address != nullptr);
+  ABSL_CHECK(index_address != nullptr);
+  absl::StatusOr<MeshPartitionWriteStart> start =
+      CastToInProgressStrokeWrapper(native_pointer)
+          .WriteMeshPartitionData(
+              coat_index, mesh_index, only_updated,
+              absl::MakeSpan(static_cast<std::byte*>(vertex_address),
+                             env->GetDirectBufferCapacity(vertex_buffer)),
+              absl::MakeSpan(static_cast<std::byte*>(index_address),
+                             env->GetDirectBufferCapacity(index_buffer)));
+  if (!start.ok()) {
+    ThrowExceptionFromStatus(env, start.status());
+    return;
+  }
+  if (absl::Status status = WriteToIntArray(env, out_write_start, 2,
+                                            [&start](absl::Span<jint> out) {
+                                              out[0] = start->vertex;
+                                              out[1] = start->index;
+                                            });
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+  }
+}
+
 // Return a newly allocated copy of the given `Mesh`'s `MeshFormat`.
 JNI_METHOD(strokes, InProgressStrokeNative, jlong, newCopyOfMeshFormat)
 (JNIEnv* env, jobject thiz, jlong native_pointer, jint coat_index,
@@ -307,3 +670,68 @@ JNI_METHOD(strokes, InProgressStrokeNative, jlong, newCopyOfMeshFormat)
 }
 
 }  // extern "C"
+
+namespace {
+
+// Registers the methods that are called for every frame of a stroke, so that
+// the first stroke doesn't pay for looking them up by name. The rest are still
+// looked up by name when first called.
+void RegisterInProgressStrokeNatives(JNIEnv* env) {
+  static const JNINativeMethod kMethods[] = {
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, create, "()J"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, free, "(J)V"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, clear, "(J)V"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, start, "(JJI)V"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, startAsync, "(JJI)V"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, enqueueInputs,
+                        "(JJJ)Z"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, updateShape, "(JJ)Z"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, writeQueuedInput,
+                        "(JIFFJFFFF)Z"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative,
+                        updateShapeWithQueuedInputs, "(JJ)Z"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative,
+                        enqueueInputsAndUpdateShapeAsync, "(JJJZJJ)V"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, latchCompletedUpdate,
+                        "(J)J"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, awaitUpdate, "(JJ)J"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, finishInput, "(J)V"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, isInputFinished,
+                        "(J)Z"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, isUpdateNeeded,
+                        "(J)Z"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, changesWithTime,
+                        "(J)Z"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, getInputCount,
+                        "(J)I"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, getRealInputCount,
+                        "(J)I"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative,
+                        getPredictedInputCount, "(J)I"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, getBrushCoatCount,
+                        "(J)I"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, resetUpdatedRegion,
+                        "(J)V"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, getFirstUpdatedVertex,
+                        "(JI)I"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative,
+                        getFirstUpdatedTriangle, "(JI)I"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, getMeshPartitionCount,
+                        "(JI)I"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative, getVertexCount,
+                        "(JII)I"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative,
+                        getUnsafelyMutableRawVertexData,
+                        "(JII)Ljava/nio/ByteBuffer;"),
+      JNI_NATIVE_METHOD(strokes, InProgressStrokeNative,
+                        getUnsafelyMutableRawTriangleIndexData,
+                        "(JII)Ljava/nio/ByteBuffer;"),
+  };
+  TryRegisterNatives(env, INK_PACKAGE "/strokes/InProgressStrokeNative",
+                     kMethods);
+}
+
+[[maybe_unused]] const bool kInProgressStrokeNativesAdded =
+    AddNativeRegistration(&RegisterInProgressStrokeNatives);
+
+}  // namespace
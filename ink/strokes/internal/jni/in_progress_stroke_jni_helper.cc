@@ -5,77 +5,329 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <limits>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/base/nullability.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush.h"
 #include "ink/geometry/mutable_mesh.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke_update_histograms.h"
 #include "ink/types/duration.h"
+#include "ink/types/executor.h"
 
 namespace ink::jni {
 
 namespace {
 
+using internal::FirstUpdatedInPartition;
 using internal::PartitionedCoatIndices;
 using internal::UpdatePartitionedCoatIndices;
 
 }  // namespace
 
+StrokeUpdateHistograms& SharedStrokeUpdateHistograms() {
+  static StrokeUpdateHistograms* histograms = new StrokeUpdateHistograms();
+  return *histograms;
+}
+
 int InProgressStrokeWrapper::VertexCount(jint coat_index,
                                          jint mesh_partition_index) const {
-  ABSL_CHECK_LT(coat_index, coat_buffer_partitions_.size());
+  ABSL_CHECK_LT(coat_index, Front().coat_buffer_partitions.size());
   ABSL_CHECK_LT(mesh_partition_index,
-                coat_buffer_partitions_[coat_index].partitions.size());
-  return coat_buffer_partitions_[coat_index]
+                Front().coat_buffer_partitions[coat_index].partitions.size());
+  return Front().coat_buffer_partitions[coat_index]
       .partitions[mesh_partition_index]
       .vertex_buffer_size;
 }
 
+int InProgressStrokeWrapper::TriangleCount(jint coat_index,
+                                           jint mesh_partition_index) const {
+  return PartitionIndexCount(coat_index, mesh_partition_index) / 3;
+}
+
+int InProgressStrokeWrapper::PartitionIndexCount(
+    int coat_index, jint mesh_partition_index) const {
+  ABSL_CHECK_LT(coat_index, Front().coat_buffer_partitions.size());
+  const PartitionedCoatIndices& cache =
+      Front().coat_buffer_partitions[coat_index];
+  ABSL_CHECK_LT(mesh_partition_index, cache.partitions.size());
+  const PartitionedCoatIndices::Partition& partition =
+      cache.partitions[mesh_partition_index];
+  ABSL_CHECK_LE(0, partition.index_buffer_offset);
+  int next_partition_index_buffer_offset =
+      mesh_partition_index == static_cast<int>(cache.partitions.size()) - 1
+          ? cache.converted_index_buffer.size()
+          : cache.partitions[mesh_partition_index + 1].index_buffer_offset;
+  int partition_index_buffer_size =
+      next_partition_index_buffer_offset - partition.index_buffer_offset;
+  ABSL_CHECK_LE(partition.index_buffer_offset + partition_index_buffer_size,
+                cache.converted_index_buffer.size());
+  return partition_index_buffer_size;
+}
+
+InProgressStrokeWrapper::~InProgressStrokeWrapper() { StopAsyncUpdates(); }
+
 void InProgressStrokeWrapper::Start(const Brush& brush, int noise_seed) {
-  in_progress_stroke_.Start(brush, noise_seed);
-  UpdateCaches();
+  StopAsyncUpdates();
+  queued_inputs_.Clear();
+  Front().stroke.SetUpdateHistograms(
+      update_histograms_enabled_ ? &SharedStrokeUpdateHistograms() : nullptr);
+  Front().stroke.Start(brush, noise_seed);
+  UpdateCaches(Front());
+}
+
+void InProgressStrokeWrapper::StartAsync(const Brush& brush, int noise_seed,
+                                         Executor& executor) {
+  StopAsyncUpdates();
+  queued_inputs_.Clear();
+  async_update_histograms_ =
+      update_histograms_enabled_ ? &SharedStrokeUpdateHistograms() : nullptr;
+  for (ShapeBuffer& buffer : buffers_) {
+    buffer.stroke.Start(brush, noise_seed);
+    UpdateCaches(buffer);
+  }
+  executor_ = &executor;
+}
+
+void InProgressStrokeWrapper::Clear() {
+  StopAsyncUpdates();
+  queued_inputs_.Clear();
+  for (ShapeBuffer& buffer : buffers_) {
+    buffer.stroke.Clear();
+  }
 }
 
 absl::Status InProgressStrokeWrapper::UpdateShape(
     Duration32 current_elapsed_time) {
-  if (absl::Status status =
-          in_progress_stroke_.UpdateShape(current_elapsed_time);
+  ABSL_DCHECK_EQ(executor_, nullptr)
+      << "Use EnqueueInputsAndUpdateShapeAsync() for asynchronous strokes.";
+  if (absl::Status status = Front().stroke.UpdateShape(current_elapsed_time);
       !status.ok()) {
     return status;
   }
-  UpdateCaches();
+  UpdateCaches(Front());
   return absl::OkStatus();
 }
 
-void InProgressStrokeWrapper::UpdateCaches() {
-  int coat_count = in_progress_stroke_.BrushCoatCount();
-  coat_buffer_partitions_.resize(coat_count);
+size_t InProgressStrokeWrapper::WriteQueuedInputs(
+    absl::Span<const StrokeInput> inputs) {
+  return queued_inputs_.Push(inputs);
+}
+
+absl::Status InProgressStrokeWrapper::UpdateShapeWithQueuedInputs(
+    Duration32 current_elapsed_time) {
+  ABSL_DCHECK_EQ(executor_, nullptr)
+      << "Use EnqueueInputsAndUpdateShapeAsync() for asynchronous strokes.";
+  popped_inputs_.Clear();
+  if (absl::Status status = queued_inputs_.PopAllInto(popped_inputs_);
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status =
+          Front().stroke.EnqueueInputs(popped_inputs_, StrokeInputBatch());
+      !status.ok()) {
+    return status;
+  }
+  return UpdateShape(current_elapsed_time);
+}
+
+void InProgressStrokeWrapper::UpdateCaches(ShapeBuffer& buffer) {
+  int coat_count = buffer.stroke.BrushCoatCount();
+  buffer.coat_buffer_partitions.resize(coat_count);
   for (int coat_index = 0; coat_index < coat_count; ++coat_index) {
-    UpdateCache(coat_index);
+    UpdateCache(buffer, coat_index);
+  }
+}
+
+void InProgressStrokeWrapper::EnqueueInputsAndUpdateShapeAsync(
+    const StrokeInputBatch& real_inputs,
+    const StrokeInputBatch& predicted_inputs, bool finish_inputs,
+    Duration32 current_elapsed_time, int64_t frame) {
+  ABSL_CHECK_NE(executor_, nullptr)
+      << "EnqueueInputsAndUpdateShapeAsync() requires StartAsync().";
+  bool schedule;
+  {
+    absl::MutexLock lock(&async_mutex_);
+    queued_updates_.push_back({.real_inputs = real_inputs,
+                               .predicted_inputs = predicted_inputs,
+                               .finish_inputs = finish_inputs,
+                               .current_elapsed_time = current_elapsed_time,
+                               .frame = frame});
+    schedule = ShouldScheduleAsyncUpdates();
+  }
+  // Schedule outside of the lock, since the executor may run the task right
+  // away on this thread.
+  if (schedule) executor_->Schedule([this]() { RunAsyncUpdates(); });
+}
+
+absl::StatusOr<int64_t> InProgressStrokeWrapper::LatchCompletedUpdate() {
+  bool schedule = false;
+  absl::Status status;
+  int64_t frame;
+  {
+    absl::MutexLock lock(&async_mutex_);
+    if (back_buffer_ready_) {
+      front_ = 1 - front_;
+      back_buffer_ready_ = false;
+      latched_frame_ = completed_frame_;
+      schedule = ShouldScheduleAsyncUpdates();
+    }
+    status = std::exchange(async_status_, absl::OkStatus());
+    frame = latched_frame_;
+  }
+  if (schedule) executor_->Schedule([this]() { RunAsyncUpdates(); });
+  if (!status.ok()) return status;
+  return frame;
+}
+
+absl::StatusOr<int64_t> InProgressStrokeWrapper::AwaitUpdate(int64_t frame) {
+  while (true) {
+    absl::StatusOr<int64_t> latched_frame = LatchCompletedUpdate();
+    if (!latched_frame.ok() || *latched_frame >= frame) return latched_frame;
+    absl::MutexLock lock(&async_mutex_);
+    // Updates are only ever left queued up while the back buffer is waiting
+    // to be latched, so if neither is the case, there is nothing to wait for.
+    if (!async_update_scheduled_ && !back_buffer_ready_) return latched_frame;
+    async_mutex_.Await(absl::Condition(
+        this, &InProgressStrokeWrapper::AsyncUpdateReadyOrIdle));
+  }
+}
+
+bool InProgressStrokeWrapper::ShouldScheduleAsyncUpdates() {
+  if (async_update_scheduled_ || back_buffer_ready_ ||
+      queued_updates_.empty()) {
+    return false;
+  }
+  async_update_scheduled_ = true;
+  return true;
+}
+
+bool InProgressStrokeWrapper::AsyncUpdateReadyOrIdle() const {
+  return back_buffer_ready_ || !async_update_scheduled_;
+}
+
+bool InProgressStrokeWrapper::AsyncUpdateIdle() const {
+  return !async_update_scheduled_;
+}
+
+absl::Status InProgressStrokeWrapper::ApplyAsyncShapeUpdate(
+    const AsyncShapeUpdate& update, InProgressStroke& stroke) {
+  if (absl::Status status =
+          stroke.EnqueueInputs(update.real_inputs, update.predicted_inputs);
+      !status.ok()) {
+    return status;
+  }
+  if (update.finish_inputs) stroke.FinishInputs();
+  return stroke.UpdateShape(update.current_elapsed_time);
+}
+
+void InProgressStrokeWrapper::RunAsyncUpdates() {
+  std::vector<AsyncShapeUpdate> catch_up_updates;
+  std::vector<AsyncShapeUpdate> updates;
+  ShapeBuffer* back;
+  {
+    absl::MutexLock lock(&async_mutex_);
+    ABSL_DCHECK(async_update_scheduled_);
+    ABSL_DCHECK(!back_buffer_ready_);
+    catch_up_updates.swap(catch_up_updates_);
+    updates.swap(queued_updates_);
+    back = &buffers_[1 - front_];
+  }
+  // The back buffer's updated region and cached indices were last brought up
+  // to date before the catch-up updates, so track changes from there.
+  back->stroke.ResetUpdatedRegion();
+  // Only record each update the first time it is applied.
+  back->stroke.SetUpdateHistograms(nullptr);
+  for (const AsyncShapeUpdate& update : catch_up_updates) {
+    // Any error was already reported when the update was first applied, and
+    // left the stroke unchanged then too.
+    ApplyAsyncShapeUpdate(update, back->stroke).IgnoreError();
   }
+  back->stroke.SetUpdateHistograms(async_update_histograms_);
+  absl::Status status;
+  for (const AsyncShapeUpdate& update : updates) {
+    status.Update(ApplyAsyncShapeUpdate(update, back->stroke));
+  }
+  UpdateCaches(*back);
+  absl::MutexLock lock(&async_mutex_);
+  completed_frame_ = updates.back().frame;
+  async_status_.Update(status);
+  catch_up_updates_ = std::move(updates);
+  back_buffer_ready_ = true;
+  async_update_scheduled_ = false;
+}
+
+void InProgressStrokeWrapper::StopAsyncUpdates() {
+  absl::MutexLock lock(&async_mutex_);
+  async_mutex_.Await(
+      absl::Condition(this, &InProgressStrokeWrapper::AsyncUpdateIdle));
+  queued_updates_.clear();
+  catch_up_updates_.clear();
+  back_buffer_ready_ = false;
+  completed_frame_ = -1;
+  latched_frame_ = -1;
+  async_status_ = absl::OkStatus();
+  executor_ = nullptr;
 }
 
 namespace internal {
 
 void UpdatePartitionedCoatIndices(absl::Span<const uint32_t> index_data,
-                                  PartitionedCoatIndices& cache) {
+                                  PartitionedCoatIndices& cache,
+                                  int unchanged_index_count) {
   constexpr int kMaxVertexIndexInPartition =
       std::numeric_limits<uint16_t>::max();
-  // Clear the contents, but don't give up any of the capacity because it will
-  // be filled again right away.
-  cache.converted_index_buffer.clear();
-  cache.partitions.clear();
-  // Start the first partition, vertex_offset and index_offset start at 0. This
-  // avoids an extra linear pass in the common case where everything fits in
-  // 16-bit indices.
-  cache.partitions.emplace_back();
   int index_count = index_data.size();
-  for (int i = 0; i < index_count; ++i) {
+  // Resume at the first complete triangle that is changed or wasn't converted
+  // yet, or at the start of the first partition whose vertex offset was chosen
+  // by looking ahead into the changed indices, whichever comes first.
+  int resume_index =
+      std::min({unchanged_index_count, index_count,
+                static_cast<int>(cache.converted_index_buffer.size())}) /
+      3 * 3;
+  int kept_partition_count = 0;
+  for (const PartitionedCoatIndices::Partition& partition : cache.partitions) {
+    if (partition.last_lookahead_index >= resume_index) {
+      resume_index = std::min(resume_index, partition.index_buffer_offset);
+    }
+    if (partition.index_buffer_offset >= resume_index &&
+        kept_partition_count > 0) {
+      break;
+    }
+    ++kept_partition_count;
+  }
+  if (resume_index == 0) kept_partition_count = 0;
+  // Drop everything from the resume point on, but don't give up any of the
+  // capacity because it will be filled again right away.
+  cache.converted_index_buffer.resize(resume_index);
+  cache.vertex_buffer_size_after_triangle.resize(resume_index / 3);
+  cache.partitions.resize(kept_partition_count);
+  if (cache.partitions.empty()) {
+    // Start the first partition, vertex_offset and index_offset start at 0.
+    // This avoids an extra linear pass in the common case where everything
+    // fits in 16-bit indices.
+    cache.partitions.emplace_back();
+  } else {
+    PartitionedCoatIndices::Partition& last_partition = cache.partitions.back();
+    last_partition.vertex_buffer_size =
+        resume_index > last_partition.index_buffer_offset
+            ? cache.vertex_buffer_size_after_triangle.back()
+            : 0;
+  }
+  for (int i = resume_index; i < index_count; ++i) {
     uint32_t overall_vertex_index = index_data[i];
     uint32_t current_vertex_offset =
         cache.partitions.back().vertex_buffer_offset;
@@ -90,6 +342,10 @@ void UpdatePartitionedCoatIndices(absl::Span<const uint32_t> index_data,
           cache.partitions.back();
       current_partition.vertex_buffer_size = std::max(
           current_partition.vertex_buffer_size, vertex_index_in_partition + 1);
+      if (i % 3 == 2) {
+        cache.vertex_buffer_size_after_triangle.push_back(
+            current_partition.vertex_buffer_size);
+      }
       continue;
     }
 
@@ -106,6 +362,9 @@ void UpdatePartitionedCoatIndices(absl::Span<const uint32_t> index_data,
     uint32_t max_later_overall_vertex_index = 0;
     uint32_t min_later_overall_vertex_index =
         std::numeric_limits<uint32_t>::max();
+    // If the look-ahead reaches the end of the index buffer, appending more
+    // indices could still change its result.
+    int last_lookahead_index = index_count;
     for (int later_i = i + 1; later_i < index_count; ++later_i) {
       uint32_t later_overall_vertex_index = index_data[later_i];
       min_later_overall_vertex_index =
@@ -125,6 +384,7 @@ void UpdatePartitionedCoatIndices(absl::Span<const uint32_t> index_data,
               << "up and truncating.";
           return;
         }
+        last_lookahead_index = later_i;
         break;
       }
     }
@@ -139,46 +399,92 @@ void UpdatePartitionedCoatIndices(absl::Span<const uint32_t> index_data,
         cache.partitions.back();
     current_partition.index_buffer_offset = i + 1;
     current_partition.vertex_buffer_offset = min_later_overall_vertex_index;
+    current_partition.last_lookahead_index = last_lookahead_index;
   }
 }
 
+MeshPartitionWriteStart FirstUpdatedInPartition(
+    const PartitionedCoatIndices& cache, int partition_index,
+    std::optional<uint32_t> first_updated_vertex,
+    std::optional<uint32_t> first_updated_triangle) {
+  ABSL_CHECK_LT(partition_index, cache.partitions.size());
+  const PartitionedCoatIndices::Partition& partition =
+      cache.partitions[partition_index];
+  int partition_end =
+      partition_index == static_cast<int>(cache.partitions.size()) - 1
+          ? cache.converted_index_buffer.size()
+          : cache.partitions[partition_index + 1].index_buffer_offset;
+  int first_updated_index = first_updated_triangle.has_value()
+                                ? static_cast<int>(*first_updated_triangle) * 3
+                                : std::numeric_limits<int>::max();
+  // The converted indices are the same as converting from scratch, and
+  // converting a partition only looks at the indices up to its last look-ahead
+  // index. So a partition that starts, and whose look-ahead ends, before the
+  // first updated triangle is the same as it was when the updated region was
+  // reset, up to that triangle. Any other partition may have moved.
+  if (partition.index_buffer_offset >= first_updated_index ||
+      partition.last_lookahead_index >= first_updated_index) {
+    return {};
+  }
+  int vertex_offset = static_cast<int>(partition.vertex_buffer_offset);
+  int first_vertex = first_updated_vertex.has_value()
+                         ? static_cast<int>(*first_updated_vertex)
+                         : std::numeric_limits<int>::max();
+  return {
+      .vertex = std::clamp(first_vertex, vertex_offset,
+                           vertex_offset + partition.vertex_buffer_size) -
+                vertex_offset,
+      .index = std::min(first_updated_index, partition_end) -
+               partition.index_buffer_offset,
+  };
+}
+
 }  // namespace internal
 
-void InProgressStrokeWrapper::UpdateCache(int coat_index) {
-  const MutableMesh& mesh = in_progress_stroke_.GetMesh(coat_index);
+void InProgressStrokeWrapper::UpdateCache(ShapeBuffer& buffer,
+                                          int coat_index) {
+  const MutableMesh& mesh = buffer.stroke.GetMesh(coat_index);
   ABSL_CHECK_EQ(mesh.IndexStride(), sizeof(uint32_t))
       << "Unsupported index stride: " << mesh.IndexStride();
   const absl::Span<const std::byte>& raw_index_data = mesh.RawIndexData();
   int index_count = raw_index_data.size() / sizeof(uint32_t);
   ABSL_CHECK_EQ(index_count, mesh.TriangleCount() * 3);
+  // Triangles before the first one updated since the updated region was last
+  // reset are the same as they were for the previous call, since the region
+  // can only be reset between calls. Only the rest needs to be converted, so
+  // that the cost per update doesn't grow with the length of the stroke.
+  int unchanged_triangle_count =
+      buffer.stroke.GetCoatFirstUpdatedTriangle(coat_index)
+          .value_or(mesh.TriangleCount());
   UpdatePartitionedCoatIndices(
       absl::MakeConstSpan(
           reinterpret_cast<const uint32_t*>(raw_index_data.data()),
           index_count),
-      coat_buffer_partitions_[coat_index]);
+      buffer.coat_buffer_partitions[coat_index], unchanged_triangle_count * 3);
 }
 
 int InProgressStrokeWrapper::MeshPartitionCount(jint coat_index) const {
-  ABSL_CHECK_LT(coat_index, coat_buffer_partitions_.size());
-  return coat_buffer_partitions_[coat_index].partitions.size();
+  ABSL_CHECK_LT(coat_index, Front().coat_buffer_partitions.size());
+  return Front().coat_buffer_partitions[coat_index].partitions.size();
 }
 
 absl_nullable jobject InProgressStrokeWrapper::GetUnsafelyMutableRawVertexData(
     JNIEnv* env, int coat_index, jint mesh_partition_index) const {
-  ABSL_CHECK_LT(coat_index, coat_buffer_partitions_.size());
+  ABSL_CHECK_LT(coat_index, Front().coat_buffer_partitions.size());
   ABSL_CHECK_LT(mesh_partition_index,
-                coat_buffer_partitions_[coat_index].partitions.size());
+                Front().coat_buffer_partitions[coat_index].partitions.size());
   const absl::Span<const std::byte> raw_vertex_data =
-      in_progress_stroke_.GetMesh(coat_index).RawVertexData();
+      Front().stroke.GetMesh(coat_index).RawVertexData();
   // absl::Span::data() may be nullptr if empty, which NewDirectByteBuffer does
   // not permit (even if the size is zero).
   if (raw_vertex_data.data() == nullptr) {
     return nullptr;
   }
   const PartitionedCoatIndices::Partition& partition =
-      coat_buffer_partitions_[coat_index].partitions[mesh_partition_index];
-  uint16_t vertex_stride =
-      in_progress_stroke_.GetMesh(coat_index).VertexStride();
+      Front()
+          .coat_buffer_partitions[coat_index]
+          .partitions[mesh_partition_index];
+  uint16_t vertex_stride = Front().stroke.GetMesh(coat_index).VertexStride();
   ABSL_CHECK_LE(0, partition.vertex_buffer_offset);
   ABSL_CHECK_LE(
       (partition.vertex_buffer_offset + partition.vertex_buffer_size) *
@@ -196,10 +502,11 @@ absl_nullable jobject InProgressStrokeWrapper::GetUnsafelyMutableRawVertexData(
 absl_nullable jobject
 InProgressStrokeWrapper::GetUnsafelyMutableRawTriangleIndexData(
     JNIEnv* env, int coat_index, jint mesh_partition_index) const {
-  ABSL_CHECK_LT(coat_index, coat_buffer_partitions_.size());
+  ABSL_CHECK_LT(coat_index, Front().coat_buffer_partitions.size());
   ABSL_CHECK_LT(mesh_partition_index,
-                coat_buffer_partitions_[coat_index].partitions.size());
-  const PartitionedCoatIndices& cache = coat_buffer_partitions_[coat_index];
+                Front().coat_buffer_partitions[coat_index].partitions.size());
+  const PartitionedCoatIndices& cache =
+      Front().coat_buffer_partitions[coat_index];
   const std::vector<uint16_t>& triangle_index_data =
       cache.converted_index_buffer;
   // std::vector::data() may be nullptr if empty, which NewDirectByteBuffer
@@ -209,15 +516,8 @@ InProgressStrokeWrapper::GetUnsafelyMutableRawTriangleIndexData(
   }
   const PartitionedCoatIndices::Partition& partition =
       cache.partitions[mesh_partition_index];
-  ABSL_CHECK_LE(0, partition.index_buffer_offset);
-  int next_partition_index_buffer_offset =
-      mesh_partition_index == static_cast<int>(cache.partitions.size()) - 1
-          ? triangle_index_data.size()
-          : cache.partitions[mesh_partition_index + 1].index_buffer_offset;
   int partition_index_buffer_size =
-      next_partition_index_buffer_offset - partition.index_buffer_offset;
-  ABSL_CHECK_LE(partition.index_buffer_offset + partition_index_buffer_size,
-                triangle_index_data.size());
+      PartitionIndexCount(coat_index, mesh_partition_index);
   return env->NewDirectByteBuffer(
       // NewDirectByteBuffer needs a non-const void*. The resulting buffer
       // is writeable, but it will be wrapped at the Kotlin layer in a
@@ -228,4 +528,57 @@ InProgressStrokeWrapper::GetUnsafelyMutableRawTriangleIndexData(
       partition_index_buffer_size * sizeof(uint16_t));
 }
 
+absl::StatusOr<MeshPartitionWriteStart>
+InProgressStrokeWrapper::WriteMeshPartitionData(
+    int coat_index, jint mesh_partition_index, bool only_updated,
+    absl::Span<std::byte> vertex_destination,
+    absl::Span<std::byte> index_destination) const {
+  ABSL_CHECK_LT(coat_index, Front().coat_buffer_partitions.size());
+  const PartitionedCoatIndices& cache =
+      Front().coat_buffer_partitions[coat_index];
+  ABSL_CHECK_LT(mesh_partition_index, cache.partitions.size());
+  const PartitionedCoatIndices::Partition& partition =
+      cache.partitions[mesh_partition_index];
+  const MutableMesh& mesh = Front().stroke.GetMesh(coat_index);
+  size_t vertex_stride = mesh.VertexStride();
+  int index_count = PartitionIndexCount(coat_index, mesh_partition_index);
+  size_t vertex_bytes = partition.vertex_buffer_size * vertex_stride;
+  size_t index_bytes = index_count * sizeof(uint16_t);
+  if (vertex_destination.size() < vertex_bytes ||
+      index_destination.size() < index_bytes) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Mesh partition needs ", vertex_bytes, " bytes of vertex data and ",
+        index_bytes, " bytes of index data, but the destinations hold ",
+        vertex_destination.size(), " and ", index_destination.size()));
+  }
+
+  MeshPartitionWriteStart start;
+  if (only_updated) {
+    start = FirstUpdatedInPartition(
+        cache, mesh_partition_index,
+        Front().stroke.GetCoatFirstUpdatedVertex(coat_index),
+        Front().stroke.GetCoatFirstUpdatedTriangle(coat_index));
+  }
+
+  absl::Span<const std::byte> raw_vertex_data = mesh.RawVertexData();
+  ABSL_CHECK_LE(
+      (partition.vertex_buffer_offset + partition.vertex_buffer_size) *
+          vertex_stride,
+      raw_vertex_data.size());
+  if (start.vertex < partition.vertex_buffer_size) {
+    std::memcpy(
+        vertex_destination.data() + start.vertex * vertex_stride,
+        raw_vertex_data.data() +
+            (partition.vertex_buffer_offset + start.vertex) * vertex_stride,
+        (partition.vertex_buffer_size - start.vertex) * vertex_stride);
+  }
+  if (start.index < index_count) {
+    std::memcpy(index_destination.data() + start.index * sizeof(uint16_t),
+                cache.converted_index_buffer.data() +
+                    partition.index_buffer_offset + start.index,
+                (index_count - start.index) * sizeof(uint16_t));
+  }
+  return start;
+}
+
 }  // namespace ink::jni
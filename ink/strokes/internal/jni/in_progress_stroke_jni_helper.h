@@ -17,19 +17,38 @@
 
 #include <jni.h>
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush.h"
 #include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/internal/stroke_input_ring_buffer.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke_update_histograms.h"
 #include "ink/types/duration.h"
+#include "ink/types/executor.h"
 
 namespace ink::jni {
 
+// Where `InProgressStrokeWrapper::WriteMeshPartitionData()` started writing, in
+// vertices and in 16-bit indices from the start of the mesh partition.
+// Everything from there to the end of the partition was written.
+struct MeshPartitionWriteStart {
+  int vertex = 0;
+  int index = 0;
+};
+
 namespace internal {
 
 struct PartitionedCoatIndices {
@@ -49,6 +68,12 @@ struct PartitionedCoatIndices {
     // tracked separately from vertex_buffer_offset because the partitions of
     // the vertex buffer may overlap.
     int vertex_buffer_size = 0;
+
+    // The last index of the index buffer that was examined to choose
+    // vertex_buffer_offset, or -1 if the offset was not chosen by looking
+    // ahead. If the index buffer has changed at or before this index, the
+    // partition has to be converted again from its start.
+    int last_lookahead_index = -1;
   };
 
   // The whole index buffer for a coat, converted to 16-bit indices from
@@ -66,12 +91,38 @@ struct PartitionedCoatIndices {
   // non-overlapping partitions (the corresponding partitions of the vertex
   // buffer may overlap).
   std::vector<Partition> partitions;
+
+  // For each converted triangle, the vertex_buffer_size of its partition just
+  // after the triangle was added. This allows the conversion to be resumed
+  // from any triangle without scanning the triangles before it again.
+  std::vector<int> vertex_buffer_size_after_triangle;
 };
 
 // Exposes the core of InProgressStrokeWrapper::UpdateCache(int coat_index)
 // for testing.
+//
+// Converts `index_data` into `cache`. The first `unchanged_index_count` values
+// of `index_data` must be the same as in the previous call with `cache`, and
+// their conversion is kept as long as it can't depend on the values that
+// follow. Passing 0 converts all of `index_data` from scratch. Either way, the
+// result is the same as converting `index_data` from scratch.
 void UpdatePartitionedCoatIndices(absl::Span<const uint32_t> index_data,
-                                  PartitionedCoatIndices& cache);
+                                  PartitionedCoatIndices& cache,
+                                  int unchanged_index_count = 0);
+
+// Exposes the core of InProgressStrokeWrapper::WriteMeshPartitionData() for
+// testing.
+//
+// Returns the first vertex and the first converted index of the partition at
+// `partition_index` of `cache` that may have changed since the updated region
+// of the stroke was last reset, given the first vertex and triangle of the coat
+// that were updated since then, if any. This is the end of the partition if
+// nothing in it may have changed, and its start if the partition may have
+// moved.
+MeshPartitionWriteStart FirstUpdatedInPartition(
+    const PartitionedCoatIndices& cache, int partition_index,
+    std::optional<uint32_t> first_updated_vertex,
+    std::optional<uint32_t> first_updated_triangle);
 
 }  // namespace internal
 
@@ -79,12 +130,20 @@ void UpdatePartitionedCoatIndices(absl::Span<const uint32_t> index_data,
 // that is used for converting 32-bit indices to 16-bit indices, without needing
 // to allocate a new buffer for this conversion every time.
 //
+// A stroke started with `StartAsync()` builds its shape on an `Executor`
+// instead of the calling thread. It is double-buffered: `Stroke()` and the mesh
+// accessors return the shape as of the last latched update, while the next
+// update is built in a second `InProgressStroke`. The two are kept in sync by
+// applying every update to both, so latching a completed update is just a
+// swap, at the cost of doing the work of each update twice on the executor.
+//
 // TODO: b/294561921 - Change MutableMesh to create partitions as it goes and
 // always use 16-bit indices, then remove this wrapper.
 class InProgressStrokeWrapper {
  public:
   InProgressStrokeWrapper() = default;
-  ~InProgressStrokeWrapper() = default;
+  // Waits for any asynchronous update to finish.
+  ~InProgressStrokeWrapper();
 
   // No move or copy. This should live on the heap and be passed by reference.
   InProgressStrokeWrapper(const InProgressStrokeWrapper&) = delete;
@@ -92,36 +151,197 @@ class InProgressStrokeWrapper {
   InProgressStrokeWrapper(InProgressStrokeWrapper&&) = delete;
   InProgressStrokeWrapper& operator=(InProgressStrokeWrapper&&) = delete;
 
-  const InProgressStroke& Stroke() const { return in_progress_stroke_; }
-  InProgressStroke& Stroke() { return in_progress_stroke_; }
+  // For a stroke started with `StartAsync()`, inputs must only be added with
+  // `EnqueueInputsAndUpdateShapeAsync()`, which keeps both buffers in sync.
+  const InProgressStroke& Stroke() const { return Front().stroke; }
+  InProgressStroke& Stroke() { return Front().stroke; }
 
-  // Starts a stroke and clears the converted index buffers.
+  // Starts a stroke and clears the converted index buffers. This drops any
+  // inputs queued up by `WriteQueuedInputs()`.
   void Start(const Brush& brush, int noise_seed);
 
+  // Starts a stroke whose shape is updated on `executor` by
+  // `EnqueueInputsAndUpdateShapeAsync()`. `executor` must outlive this
+  // wrapper, or the next call to `Start()`, `StartAsync()`, or `Clear()`.
+  void StartAsync(const Brush& brush, int noise_seed, Executor& executor);
+
+  // Clears the stroke, after waiting for any asynchronous update to finish.
+  void Clear();
+
+  // Sets whether strokes started by subsequent calls to `Start()` or
+  // `StartAsync()` record their updates in `SharedStrokeUpdateHistograms()`.
+  // Each update is recorded once, when it is first applied, even though the
+  // updates of a stroke started with `StartAsync()` are applied to both
+  // buffers. Disabled by default.
+  void SetUpdateHistogramsEnabled(bool enabled) {
+    update_histograms_enabled_ = enabled;
+  }
+
   // Updates the shape of the shape of the stroke and updates the converted
   // index buffers.
   absl::Status UpdateShape(Duration32 current_elapsed_time);
 
+  // Queues up real `inputs` to be added to the stroke by the next call to
+  // `UpdateShapeWithQueuedInputs()`. Unlike the other methods, this may be
+  // called from another thread, e.g. the one on which the platform delivers
+  // input events, as long as it is only called from one thread at a time. It
+  // takes no lock and does not allocate.
+  //
+  // Returns how many of `inputs`, from the start, were queued up. The rest did
+  // not fit in the queue, and should be written again after the next update;
+  // queued inputs are never dropped to make room for them.
+  size_t WriteQueuedInputs(absl::Span<const StrokeInput> inputs);
+
+  // Adds the inputs queued up by `WriteQueuedInputs()` to the stroke, as
+  // `InProgressStroke::EnqueueInputs()` would with no predicted inputs, and
+  // then updates the shape as `UpdateShape()` does. If the queued inputs are
+  // invalid, they are dropped, and the error is returned without updating the
+  // shape.
+  absl::Status UpdateShapeWithQueuedInputs(Duration32 current_elapsed_time);
+
+  // For a stroke started with `StartAsync()`, queues up adding the inputs and
+  // then updating the shape, as `InProgressStroke::EnqueueInputs()`,
+  // `InProgressStroke::FinishInputs()` if `finish_inputs` is true, and
+  // `InProgressStroke::UpdateShape()` would, and returns without waiting for
+  // it. The resulting shape is tagged with `frame`, which should increase with
+  // every call.
+  void EnqueueInputsAndUpdateShapeAsync(
+      const StrokeInputBatch& real_inputs,
+      const StrokeInputBatch& predicted_inputs, bool finish_inputs,
+      Duration32 current_elapsed_time, int64_t frame);
+
+  // If an asynchronous update has completed since the last latch, makes the
+  // shape of the most recent completed update the one returned by `Stroke()`
+  // and the mesh accessors. This should be called at a point where none of the
+  // buffers returned for the previous shape are still in use. Returns the frame
+  // of the latched shape, or -1 if no update has been latched since the stroke
+  // was started. Returns an error if any update completed since the last latch
+  // failed, in which case that update left the stroke unchanged.
+  absl::StatusOr<int64_t> LatchCompletedUpdate();
+
+  // Like `LatchCompletedUpdate()`, but first waits for the update tagged with
+  // `frame`, or a later one, to complete. Returns without waiting if there is
+  // no such update queued up.
+  absl::StatusOr<int64_t> AwaitUpdate(int64_t frame);
+
   int MeshPartitionCount(jint coat_index) const;
   int VertexCount(jint coat_index, jint mesh_partition_index) const;
+  int TriangleCount(jint coat_index, jint mesh_partition_index) const;
   absl_nullable jobject GetUnsafelyMutableRawVertexData(
       JNIEnv* env, int coat_index, jint mesh_partition_index) const;
   absl_nullable jobject GetUnsafelyMutableRawTriangleIndexData(
       JNIEnv* env, int coat_index, jint mesh_partition_index) const;
 
+  // Copies the vertex data and the 16-bit triangle index data of a mesh
+  // partition, the same data as is returned by
+  // `GetUnsafelyMutableRawVertexData()` and
+  // `GetUnsafelyMutableRawTriangleIndexData()`, into memory owned by the
+  // caller. This can be memory that the renderer binds directly, such as a
+  // locked `AHardwareBuffer` or a mapped GPU buffer, so that it doesn't have to
+  // be uploaded again. Returns an error without writing anything if either
+  // destination is too small for the whole partition.
+  //
+  // If `only_updated` is true, the destinations must hold the partition's data
+  // as of the last reset of the stroke's updated region, and only the data that
+  // may have changed since then is written, so that the cost per frame doesn't
+  // grow with the length of the stroke. Otherwise, the whole partition is
+  // written.
+  absl::StatusOr<MeshPartitionWriteStart> WriteMeshPartitionData(
+      int coat_index, jint mesh_partition_index, bool only_updated,
+      absl::Span<std::byte> vertex_destination,
+      absl::Span<std::byte> index_destination) const;
+
  private:
-  void UpdateCaches();
-  void UpdateCache(int coat_index);
+  struct ShapeBuffer {
+    InProgressStroke stroke;
+
+    // For each brush coat, holds data underlying ShortBuffers of indices used
+    // for mesh rendering. Since the indices need to fit in a ShortBuffer, they
+    // are converted from 32-bit to 16-bit and possibly partitioned into
+    // multiple buffers underlying multiple meshes.
+    std::vector<internal::PartitionedCoatIndices> coat_buffer_partitions;
+  };
+
+  struct AsyncShapeUpdate {
+    StrokeInputBatch real_inputs;
+    StrokeInputBatch predicted_inputs;
+    bool finish_inputs = false;
+    Duration32 current_elapsed_time;
+    int64_t frame = 0;
+  };
+
+  const ShapeBuffer& Front() const { return buffers_[front_]; }
+  ShapeBuffer& Front() { return buffers_[front_]; }
+
+  static void UpdateCaches(ShapeBuffer& buffer);
+  static void UpdateCache(ShapeBuffer& buffer, int coat_index);
+  static absl::Status ApplyAsyncShapeUpdate(const AsyncShapeUpdate& update,
+                                            InProgressStroke& stroke);
 
-  InProgressStroke in_progress_stroke_;
+  // Room for a few frames of inputs from a high-rate stylus.
+  static constexpr size_t kInputQueueCapacity = 256;
 
-  // For each brush coat, holds data underlying ShortBuffers of indices used for
-  // mesh rendering. Since the indices need to fit in a ShortBuffer, they are
-  // converted from 32-bit to 16-bit and possibly partitioned into multiple
-  // buffers underlying multiple meshes.
-  std::vector<internal::PartitionedCoatIndices> coat_buffer_partitions_;
+  // Returns the number of 16-bit indices in the given partition of the
+  // converted index buffer.
+  int PartitionIndexCount(int coat_index, jint mesh_partition_index) const;
+
+  // Waits for any asynchronous update to finish, then drops any that are
+  // still queued up and resets the asynchronous state.
+  void StopAsyncUpdates();
+
+  // Returns true if a task running `RunAsyncUpdates()` should be scheduled,
+  // and marks it as scheduled.
+  bool ShouldScheduleAsyncUpdates()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(async_mutex_);
+  // Applies all queued-up updates to the back buffer, and marks it ready to be
+  // latched. Runs on the executor.
+  void RunAsyncUpdates();
+  bool AsyncUpdateReadyOrIdle() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(async_mutex_);
+  bool AsyncUpdateIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(async_mutex_);
+
+  // The second buffer is only used by strokes started with `StartAsync()`.
+  std::array<ShapeBuffer, 2> buffers_;
+
+  // The index into `buffers_` of the buffer returned by `Stroke()`. This is
+  // only written on the calling thread, under `async_mutex_`, while the
+  // executor is not using either buffer.
+  int front_ = 0;
+
+  Executor* absl_nullable executor_ = nullptr;
+  bool update_histograms_enabled_ = false;
+  // Where the executor records the updates of a stroke started with
+  // `StartAsync()`, as of that call.
+  StrokeUpdateHistograms* absl_nullable async_update_histograms_ = nullptr;
+
+  // Inputs written by `WriteQueuedInputs()`, and the batch into which
+  // `UpdateShapeWithQueuedInputs()` pops them, which is kept to reuse its
+  // allocation.
+  stroke_input_internal::StrokeInputRingBuffer queued_inputs_{
+      kInputQueueCapacity};
+  StrokeInputBatch popped_inputs_;
+
+  absl::Mutex async_mutex_;
+  // Updates that are waiting to be applied to the back buffer.
+  std::vector<AsyncShapeUpdate> queued_updates_ ABSL_GUARDED_BY(async_mutex_);
+  // Updates that were applied to the front buffer but not yet to the back
+  // buffer.
+  std::vector<AsyncShapeUpdate> catch_up_updates_
+      ABSL_GUARDED_BY(async_mutex_);
+  // Whether a task running `RunAsyncUpdates()` is scheduled or running.
+  bool async_update_scheduled_ ABSL_GUARDED_BY(async_mutex_) = false;
+  // Whether the back buffer holds a completed update that wasn't latched yet.
+  // The executor doesn't touch either buffer while this is true.
+  bool back_buffer_ready_ ABSL_GUARDED_BY(async_mutex_) = false;
+  int64_t completed_frame_ ABSL_GUARDED_BY(async_mutex_) = -1;
+  int64_t latched_frame_ ABSL_GUARDED_BY(async_mutex_) = -1;
+  absl::Status async_status_ ABSL_GUARDED_BY(async_mutex_);
 };
 
+// Returns the process-wide histograms of the updates of every stroke with
+// `SetUpdateHistogramsEnabled(true)`, for telemetry.
+StrokeUpdateHistograms& SharedStrokeUpdateHistograms();
+
 // Creates a new stack-allocated
 // `ink::jni::InProgressStrokeWrapper` containing an empty
 // `InProgressStroke` and returns a pointer to it as a jlong, suitable for
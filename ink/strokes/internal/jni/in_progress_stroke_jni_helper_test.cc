@@ -1,18 +1,40 @@
 #include "ink/strokes/internal/jni/in_progress_stroke_jni_helper.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_family.h"
+#include "ink/color/color.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke_update_histograms.h"
+#include "ink/types/duration.h"
+#include "ink/types/test_executor.h"
 
 namespace ink::jni {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::ink::jni::internal::FirstUpdatedInPartition;
 using ::ink::jni::internal::PartitionedCoatIndices;
 using ::ink::jni::internal::UpdatePartitionedCoatIndices;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::Field;
 using ::testing::IsEmpty;
 using ::testing::Matcher;
@@ -160,5 +182,434 @@ TEST(UpdatePartitionedCoatIndicesTest,
                                 })));
 }
 
+// Expects `cache` to be the same as the result of converting `indices` from
+// scratch.
+void ExpectSameAsFromScratch(absl::Span<const uint32_t> indices,
+                             const PartitionedCoatIndices& cache) {
+  PartitionedCoatIndices expected;
+  UpdatePartitionedCoatIndices(indices, expected);
+  EXPECT_EQ(cache.converted_index_buffer, expected.converted_index_buffer);
+  ASSERT_EQ(cache.partitions.size(), expected.partitions.size());
+  for (size_t i = 0; i < expected.partitions.size(); ++i) {
+    EXPECT_THAT(cache.partitions[i], PartitionIs(expected.partitions[i]));
+  }
+}
+
+TEST(UpdatePartitionedCoatIndicesTest, KeepsUnchangedConvertedIndices) {
+  PartitionedCoatIndices cache;
+  UpdatePartitionedCoatIndices({0, 1, 2}, cache);
+  // Overwrite the converted first triangle to check that it is not converted
+  // again.
+  cache.converted_index_buffer[0] = 7;
+  UpdatePartitionedCoatIndices({0, 1, 2, 2, 1, 3}, cache,
+                               /*unchanged_index_count=*/3);
+  EXPECT_THAT(cache.converted_index_buffer, ElementsAre(7, 1, 2, 2, 1, 3));
+  EXPECT_THAT(cache.partitions, ElementsAre(PartitionIs({
+                                    .index_buffer_offset = 0,
+                                    .vertex_buffer_offset = 0,
+                                    .vertex_buffer_size = 4,
+                                })));
+}
+
+TEST(UpdatePartitionedCoatIndicesTest, ResumesAfterChangedTriangles) {
+  PartitionedCoatIndices cache;
+  UpdatePartitionedCoatIndices({0, 1, 2, 2, 1, 9, 9, 1, 8}, cache);
+  // The second triangle changes and the third is removed, which shrinks the
+  // partition's vertex buffer.
+  std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 3};
+  UpdatePartitionedCoatIndices(indices, cache, /*unchanged_index_count=*/3);
+  ExpectSameAsFromScratch(indices, cache);
+  EXPECT_THAT(cache.converted_index_buffer, ElementsAre(0, 1, 2, 2, 1, 3));
+  EXPECT_THAT(cache.partitions, ElementsAre(PartitionIs({
+                                    .index_buffer_offset = 0,
+                                    .vertex_buffer_offset = 0,
+                                    .vertex_buffer_size = 4,
+                                })));
+}
+
+TEST(UpdatePartitionedCoatIndicesTest,
+     ResumesPartitionWhoseOffsetDependsOnAppendedIndices) {
+  PartitionedCoatIndices cache;
+  UpdatePartitionedCoatIndices(
+      {0, 1, 2, kMax16BitIndex + 10, kMax16BitIndex + 11, kMax16BitIndex + 12},
+      cache);
+  // The appended triangle lowers the first vertex of the second partition, so
+  // that partition has to be converted again from its start.
+  std::vector<uint32_t> indices = {
+      0, 1, 2, kMax16BitIndex + 10, kMax16BitIndex + 11, kMax16BitIndex + 12,
+      kMax16BitIndex + 5, kMax16BitIndex + 6, kMax16BitIndex + 7};
+  UpdatePartitionedCoatIndices(indices, cache, /*unchanged_index_count=*/6);
+  ExpectSameAsFromScratch(indices, cache);
+  EXPECT_THAT(cache.converted_index_buffer,
+              ElementsAre(0, 1, 2, 5, 6, 7, 0, 1, 2));
+}
+
+TEST(UpdatePartitionedCoatIndicesTest,
+     ResumingGrowingStripMatchesConvertingFromScratch) {
+  // Grow a triangle strip past the 16-bit limit, rewriting the last few
+  // triangles on every update like an in-progress stroke does.
+  std::vector<uint32_t> indices;
+  PartitionedCoatIndices cache;
+  constexpr uint32_t kTrianglesPerUpdate = 5000;
+  constexpr uint32_t kRewrittenTriangles = 10;
+  for (uint32_t triangle_count = kTrianglesPerUpdate;
+       triangle_count < 3 * kTrianglesPerUpdate + kMax16BitIndex;
+       triangle_count += kTrianglesPerUpdate) {
+    uint32_t unchanged_triangle_count =
+        indices.empty() ? 0 : indices.size() / 3 - kRewrittenTriangles;
+    indices.resize(unchanged_triangle_count * 3);
+    for (uint32_t t = unchanged_triangle_count; t < triangle_count; ++t) {
+      indices.insert(indices.end(), {t, t + 1, t + 2});
+    }
+    UpdatePartitionedCoatIndices(indices, cache, unchanged_triangle_count * 3);
+    ExpectSameAsFromScratch(indices, cache);
+  }
+  EXPECT_GT(cache.partitions.size(), 1u);
+}
+
+TEST(FirstUpdatedInPartitionTest, ReturnsEndOfPartitionIfNothingWasUpdated) {
+  PartitionedCoatIndices cache;
+  UpdatePartitionedCoatIndices({0, 1, 2, 2, 1, 3}, cache);
+  MeshPartitionWriteStart start =
+      FirstUpdatedInPartition(cache, 0, std::nullopt, std::nullopt);
+  EXPECT_EQ(start.vertex, 4);
+  EXPECT_EQ(start.index, 6);
+}
+
+TEST(FirstUpdatedInPartitionTest, ReturnsStartOfUpdatedData) {
+  PartitionedCoatIndices cache;
+  UpdatePartitionedCoatIndices({0, 1, 2, 2, 1, 3, 3, 1, 4}, cache);
+  MeshPartitionWriteStart start = FirstUpdatedInPartition(cache, 0, 3, 2);
+  EXPECT_EQ(start.vertex, 3);
+  EXPECT_EQ(start.index, 6);
+}
+
+TEST(FirstUpdatedInPartitionTest, KeepsOnlyUnchangedDataOfGrowingStrip) {
+  // Grow a triangle strip past the 16-bit limit as in
+  // `ResumingGrowingStripMatchesConvertingFromScratch`, and check that the
+  // converted indices before the returned start of each partition are the same
+  // as before the update.
+  std::vector<uint32_t> indices;
+  PartitionedCoatIndices cache;
+  constexpr uint32_t kTrianglesPerUpdate = 5000;
+  constexpr uint32_t kRewrittenTriangles = 10;
+  int partial_partition_count = 0;
+  for (uint32_t triangle_count = kTrianglesPerUpdate;
+       triangle_count < 3 * kTrianglesPerUpdate + kMax16BitIndex;
+       triangle_count += kTrianglesPerUpdate) {
+    uint32_t unchanged_triangle_count =
+        indices.empty() ? 0 : indices.size() / 3 - kRewrittenTriangles;
+    indices.resize(unchanged_triangle_count * 3);
+    for (uint32_t t = unchanged_triangle_count; t < triangle_count; ++t) {
+      indices.insert(indices.end(), {t, t + 1, t + 2});
+    }
+    PartitionedCoatIndices previous = cache;
+    UpdatePartitionedCoatIndices(indices, cache, unchanged_triangle_count * 3);
+
+    for (size_t i = 0; i < cache.partitions.size(); ++i) {
+      MeshPartitionWriteStart start = FirstUpdatedInPartition(
+          cache, i, unchanged_triangle_count, unchanged_triangle_count);
+      if (start.index == 0) continue;
+      ++partial_partition_count;
+      const PartitionedCoatIndices::Partition& partition = cache.partitions[i];
+      ASSERT_LT(i, previous.partitions.size());
+      EXPECT_EQ(previous.partitions[i].index_buffer_offset,
+                partition.index_buffer_offset);
+      EXPECT_EQ(previous.partitions[i].vertex_buffer_offset,
+                partition.vertex_buffer_offset);
+      // The vertices of the strip's unchanged triangles are unchanged, except
+      // for the last two, which the first rewritten triangle also uses.
+      EXPECT_LE(partition.vertex_buffer_offset + start.vertex,
+                unchanged_triangle_count + 2);
+      int end = partition.index_buffer_offset + start.index;
+      ASSERT_LE(end, previous.converted_index_buffer.size());
+      EXPECT_TRUE(std::equal(
+          cache.converted_index_buffer.begin() + partition.index_buffer_offset,
+          cache.converted_index_buffer.begin() + end,
+          previous.converted_index_buffer.begin() +
+              partition.index_buffer_offset));
+    }
+  }
+  EXPECT_GT(cache.partitions.size(), 1u);
+  EXPECT_GT(partial_partition_count, 0);
+}
+
+Brush CreateTestBrush() {
+  absl::StatusOr<Brush> brush =
+      Brush::Create(BrushFamily(), Color(), /*size=*/5, /*epsilon=*/0.01);
+  ABSL_CHECK_OK(brush);
+  return *brush;
+}
+
+// Returns real inputs for the given frame of a test stroke, moving along a
+// wavy line.
+StrokeInputBatch CreateTestInputs(int frame) {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 5; ++i) {
+    float t = frame * 5 + i;
+    inputs.push_back({.position = {t, 10 * std::sin(t / 4)},
+                      .elapsed_time = Duration32::Millis(t)});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *batch;
+}
+
+TEST(InProgressStrokeWrapperTest, AsyncUpdateIsVisibleOnceLatched) {
+  ManualExecutor executor;
+  InProgressStrokeWrapper wrapper;
+  wrapper.StartAsync(CreateTestBrush(), /*noise_seed=*/0, executor);
+  wrapper.EnqueueInputsAndUpdateShapeAsync(
+      CreateTestInputs(0), StrokeInputBatch(), /*finish_inputs=*/false,
+      Duration32::Millis(5), /*frame=*/1);
+  EXPECT_EQ(executor.PendingTaskCount(), 1u);
+  EXPECT_THAT(wrapper.LatchCompletedUpdate(), IsOkAndHolds(-1));
+  EXPECT_EQ(wrapper.Stroke().InputCount(), 0);
+
+  executor.RunScheduledTasks();
+  // The completed update isn't visible until it is latched.
+  EXPECT_EQ(wrapper.Stroke().InputCount(), 0);
+  EXPECT_THAT(wrapper.LatchCompletedUpdate(), IsOkAndHolds(1));
+  EXPECT_EQ(wrapper.Stroke().InputCount(), 5);
+  EXPECT_EQ(wrapper.MeshPartitionCount(0), 1);
+  EXPECT_GT(wrapper.TriangleCount(0, 0), 0);
+}
+
+TEST(InProgressStrokeWrapperTest, AsyncUpdatesWaitForLatch) {
+  ManualExecutor executor;
+  InProgressStrokeWrapper wrapper;
+  wrapper.StartAsync(CreateTestBrush(), /*noise_seed=*/0, executor);
+  wrapper.EnqueueInputsAndUpdateShapeAsync(
+      CreateTestInputs(0), StrokeInputBatch(), /*finish_inputs=*/false,
+      Duration32::Millis(5), /*frame=*/1);
+  executor.RunScheduledTasks();
+
+  // The completed update for frame 1 holds the back buffer, so the updates for
+  // frames 2 and 3 can't start until it is latched, and then run together.
+  wrapper.EnqueueInputsAndUpdateShapeAsync(
+      CreateTestInputs(1), StrokeInputBatch(), /*finish_inputs=*/false,
+      Duration32::Millis(10), /*frame=*/2);
+  wrapper.EnqueueInputsAndUpdateShapeAsync(
+      CreateTestInputs(2), StrokeInputBatch(), /*finish_inputs=*/true,
+      Duration32::Millis(15), /*frame=*/3);
+  EXPECT_EQ(executor.PendingTaskCount(), 0u);
+  EXPECT_THAT(wrapper.LatchCompletedUpdate(), IsOkAndHolds(1));
+  EXPECT_EQ(executor.PendingTaskCount(), 1u);
+
+  executor.RunScheduledTasks();
+  EXPECT_THAT(wrapper.LatchCompletedUpdate(), IsOkAndHolds(3));
+  EXPECT_EQ(wrapper.Stroke().InputCount(), 15);
+  EXPECT_TRUE(wrapper.Stroke().InputsAreFinished());
+}
+
+TEST(InProgressStrokeWrapperTest, RecordsEachAsyncUpdateOnceInHistograms) {
+  StrokeUpdateHistograms& histograms = SharedStrokeUpdateHistograms();
+  histograms.Reset();
+  ManualExecutor executor;
+  InProgressStrokeWrapper wrapper;
+  wrapper.SetUpdateHistogramsEnabled(true);
+  wrapper.StartAsync(CreateTestBrush(), /*noise_seed=*/0, executor);
+
+  // Each update is applied to both buffers, the second time to catch up
+  // after the first buffer is latched, but only recorded the first time.
+  for (int frame = 1; frame <= 3; ++frame) {
+    wrapper.EnqueueInputsAndUpdateShapeAsync(
+        CreateTestInputs(frame - 1), StrokeInputBatch(),
+        /*finish_inputs=*/false, Duration32::Millis(5 * frame), frame);
+    executor.RunScheduledTasks();
+    ASSERT_THAT(wrapper.LatchCompletedUpdate(), IsOkAndHolds(frame));
+  }
+  EXPECT_EQ(histograms.update_shape_nanos.Count(), 3);
+  EXPECT_EQ(histograms.inputs_per_update.Sum(), 15);
+
+  // Strokes started after disabling the histograms don't record.
+  wrapper.SetUpdateHistogramsEnabled(false);
+  wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+  ASSERT_EQ(wrapper.Stroke().EnqueueInputs(CreateTestInputs(0),
+                                           StrokeInputBatch()),
+            absl::OkStatus());
+  ASSERT_EQ(wrapper.UpdateShape(Duration32::Millis(5)), absl::OkStatus());
+  EXPECT_EQ(histograms.update_shape_nanos.Count(), 3);
+  histograms.Reset();
+}
+
+TEST(InProgressStrokeWrapperTest, AsyncUpdatesMatchSynchronousUpdates) {
+  ThreadPerTaskExecutor executor;
+  InProgressStrokeWrapper async_wrapper;
+  async_wrapper.StartAsync(CreateTestBrush(), /*noise_seed=*/0, executor);
+  InProgressStrokeWrapper sync_wrapper;
+  sync_wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+
+  for (int frame = 1; frame <= 20; ++frame) {
+    StrokeInputBatch real_inputs = CreateTestInputs(frame);
+    StrokeInputBatch predicted_inputs = CreateTestInputs(frame + 1);
+    Duration32 elapsed_time = Duration32::Millis(5 * frame);
+    async_wrapper.EnqueueInputsAndUpdateShapeAsync(
+        real_inputs, predicted_inputs, /*finish_inputs=*/false, elapsed_time,
+        frame);
+    ASSERT_EQ(sync_wrapper.Stroke().EnqueueInputs(real_inputs,
+                                                  predicted_inputs),
+              absl::OkStatus());
+    ASSERT_EQ(sync_wrapper.UpdateShape(elapsed_time), absl::OkStatus());
+
+    // Every other frame, wait for the async stroke to catch up, and compare
+    // the two.
+    if (frame % 2 == 1) continue;
+    ASSERT_THAT(async_wrapper.AwaitUpdate(frame), IsOkAndHolds(frame));
+    const MutableMesh& async_mesh = async_wrapper.Stroke().GetMesh(0);
+    const MutableMesh& sync_mesh = sync_wrapper.Stroke().GetMesh(0);
+    EXPECT_THAT(async_mesh.RawVertexData(),
+                ElementsAreArray(sync_mesh.RawVertexData()));
+    EXPECT_THAT(async_mesh.RawIndexData(),
+                ElementsAreArray(sync_mesh.RawIndexData()));
+    ASSERT_EQ(async_wrapper.MeshPartitionCount(0),
+              sync_wrapper.MeshPartitionCount(0));
+    for (int i = 0; i < sync_wrapper.MeshPartitionCount(0); ++i) {
+      EXPECT_EQ(async_wrapper.VertexCount(0, i),
+                sync_wrapper.VertexCount(0, i));
+      EXPECT_EQ(async_wrapper.TriangleCount(0, i),
+                sync_wrapper.TriangleCount(0, i));
+    }
+  }
+}
+
+TEST(InProgressStrokeWrapperTest, LatchReportsFailedAsyncUpdate) {
+  ManualExecutor executor;
+  InProgressStrokeWrapper wrapper;
+  wrapper.StartAsync(CreateTestBrush(), /*noise_seed=*/0, executor);
+  wrapper.EnqueueInputsAndUpdateShapeAsync(
+      CreateTestInputs(0), StrokeInputBatch(), /*finish_inputs=*/true,
+      Duration32::Millis(5), /*frame=*/1);
+  executor.RunScheduledTasks();
+  EXPECT_THAT(wrapper.LatchCompletedUpdate(), IsOkAndHolds(1));
+
+  // Inputs can't be added after they are finished.
+  wrapper.EnqueueInputsAndUpdateShapeAsync(
+      CreateTestInputs(1), StrokeInputBatch(), /*finish_inputs=*/false,
+      Duration32::Millis(10), /*frame=*/2);
+  executor.RunScheduledTasks();
+  EXPECT_THAT(wrapper.LatchCompletedUpdate(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  // The error is only reported once, and the failed update left the stroke
+  // unchanged.
+  EXPECT_THAT(wrapper.LatchCompletedUpdate(), IsOkAndHolds(2));
+  EXPECT_EQ(wrapper.Stroke().InputCount(), 5);
+}
+
+TEST(InProgressStrokeWrapperTest, QueuedInputsMatchEnqueuedInputs) {
+  InProgressStrokeWrapper queued_wrapper;
+  queued_wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+  InProgressStrokeWrapper wrapper;
+  wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+
+  for (int frame = 0; frame < 10; ++frame) {
+    StrokeInputBatch real_inputs = CreateTestInputs(frame);
+    std::vector<StrokeInput> inputs(real_inputs.begin(), real_inputs.end());
+    Duration32 elapsed_time = Duration32::Millis(5 * frame);
+    ASSERT_EQ(queued_wrapper.WriteQueuedInputs(inputs), inputs.size());
+    ASSERT_EQ(queued_wrapper.UpdateShapeWithQueuedInputs(elapsed_time),
+              absl::OkStatus());
+    ASSERT_EQ(wrapper.Stroke().EnqueueInputs(real_inputs, StrokeInputBatch()),
+              absl::OkStatus());
+    ASSERT_EQ(wrapper.UpdateShape(elapsed_time), absl::OkStatus());
+  }
+  EXPECT_EQ(queued_wrapper.Stroke().InputCount(), 50);
+  EXPECT_THAT(queued_wrapper.Stroke().GetMesh(0).RawVertexData(),
+              ElementsAreArray(wrapper.Stroke().GetMesh(0).RawVertexData()));
+  EXPECT_EQ(queued_wrapper.TriangleCount(0, 0), wrapper.TriangleCount(0, 0));
+}
+
+TEST(InProgressStrokeWrapperTest, QueuedInputsThatDontFitAreRejected) {
+  InProgressStrokeWrapper wrapper;
+  wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 1000; ++i) {
+    inputs.push_back({.position = {static_cast<float>(i), 0},
+                      .elapsed_time = Duration32::Millis(i)});
+  }
+  size_t written = wrapper.WriteQueuedInputs(inputs);
+  EXPECT_GT(written, 0u);
+  EXPECT_LT(written, inputs.size());
+  ASSERT_EQ(wrapper.UpdateShapeWithQueuedInputs(Duration32::Zero()),
+            absl::OkStatus());
+  EXPECT_EQ(wrapper.Stroke().InputCount(), written);
+
+  // Once the queue is drained, the rest can be written.
+  EXPECT_GT(wrapper.WriteQueuedInputs(absl::MakeConstSpan(inputs).subspan(
+                written)),
+            0u);
+}
+
+TEST(InProgressStrokeWrapperTest, StartDropsQueuedInputs) {
+  InProgressStrokeWrapper wrapper;
+  wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+  StrokeInputBatch real_inputs = CreateTestInputs(0);
+  std::vector<StrokeInput> inputs(real_inputs.begin(), real_inputs.end());
+  ASSERT_EQ(wrapper.WriteQueuedInputs(inputs), inputs.size());
+
+  wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+  ASSERT_EQ(wrapper.UpdateShapeWithQueuedInputs(Duration32::Zero()),
+            absl::OkStatus());
+  EXPECT_EQ(wrapper.Stroke().InputCount(), 0);
+}
+
+TEST(InProgressStrokeWrapperTest, WritesOnlyUpdatedMeshPartitionData) {
+  InProgressStrokeWrapper wrapper;
+  wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+  std::vector<std::byte> vertices;
+  std::vector<std::byte> indices;
+  bool wrote_partial_update = false;
+  for (int frame = 0; frame < 20; ++frame) {
+    ASSERT_EQ(wrapper.Stroke().EnqueueInputs(CreateTestInputs(frame),
+                                             CreateTestInputs(frame + 1)),
+              absl::OkStatus());
+    ASSERT_EQ(wrapper.UpdateShape(Duration32::Millis(5 * frame)),
+              absl::OkStatus());
+    ASSERT_EQ(wrapper.MeshPartitionCount(0), 1);
+    // Resizing keeps the data that was written for the previous frame.
+    vertices.resize(wrapper.VertexCount(0, 0) *
+                    wrapper.Stroke().GetMesh(0).VertexStride());
+    indices.resize(wrapper.TriangleCount(0, 0) * 3 * sizeof(uint16_t));
+    absl::StatusOr<MeshPartitionWriteStart> start =
+        wrapper.WriteMeshPartitionData(0, 0, /*only_updated=*/frame > 0,
+                                       absl::MakeSpan(vertices),
+                                       absl::MakeSpan(indices));
+    ASSERT_EQ(start.status(), absl::OkStatus());
+    wrote_partial_update |= start->vertex > 0 && start->index > 0;
+
+    std::vector<std::byte> expected_vertices(vertices.size());
+    std::vector<std::byte> expected_indices(indices.size());
+    ASSERT_EQ(wrapper
+                  .WriteMeshPartitionData(0, 0, /*only_updated=*/false,
+                                          absl::MakeSpan(expected_vertices),
+                                          absl::MakeSpan(expected_indices))
+                  .status(),
+              absl::OkStatus());
+    EXPECT_THAT(vertices, ElementsAreArray(expected_vertices));
+    EXPECT_THAT(indices, ElementsAreArray(expected_indices));
+    wrapper.Stroke().ResetUpdatedRegion();
+  }
+  EXPECT_TRUE(wrote_partial_update);
+}
+
+TEST(InProgressStrokeWrapperTest, WriteMeshPartitionDataRejectsSmallBuffers) {
+  InProgressStrokeWrapper wrapper;
+  wrapper.Start(CreateTestBrush(), /*noise_seed=*/0);
+  ASSERT_EQ(
+      wrapper.Stroke().EnqueueInputs(CreateTestInputs(0), StrokeInputBatch()),
+      absl::OkStatus());
+  ASSERT_EQ(wrapper.UpdateShape(Duration32::Millis(5)), absl::OkStatus());
+  ASSERT_GT(wrapper.TriangleCount(0, 0), 0);
+
+  std::vector<std::byte> vertices(wrapper.VertexCount(0, 0) *
+                                  wrapper.Stroke().GetMesh(0).VertexStride());
+  std::vector<std::byte> indices(1);
+  EXPECT_THAT(wrapper.WriteMeshPartitionData(0, 0, /*only_updated=*/false,
+                                             absl::MakeSpan(vertices),
+                                             absl::MakeSpan(indices)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
 }  // namespace ink::jni
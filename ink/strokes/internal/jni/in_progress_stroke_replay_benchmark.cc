@@ -0,0 +1,305 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays recorded strokes through `InProgressStroke` and
+// `InProgressStrokeWrapper` with the timing of a live app, and reports the
+// latency of each frame, from passing in its inputs to having its mesh ready to
+// draw.
+//
+// Inputs arrive at 240Hz. On each frame, at 60Hz or 120Hz, the replay passes
+// in the real inputs that arrived since the previous frame along with one frame
+// of predicted inputs, updates the shape, and reads back the mesh of every coat
+// as a renderer uploading it would. The predicted inputs are the recorded ones
+// that follow, so prediction is perfect. The pipeline under test is one of:
+//   0. `InProgressStroke` alone.
+//   1. `InProgressStrokeWrapper` updated on the calling thread, with readback
+//      through its partition caches, as in the synchronous JNI path.
+//   2. `InProgressStrokeWrapper` updated on the JNI worker thread, awaiting
+//      each frame's update before reading it back.
+//
+// `BM_PacedReplay` starts each frame at its scheduled time instead of as soon
+// as the previous one has finished, so that caches and CPU frequency behave as
+// they do between real frames; its wall time is mostly spent waiting.
+//
+// Each benchmark reports:
+//   * `p50_frame_us`, `p90_frame_us`, `p99_frame_us`, `p999_frame_us` and
+//     `max_frame_us`: percentiles of frame latency.
+//   * `over_budget_frames`: the fraction of frames whose latency exceeds the
+//     frame period, each of which would miss its frame.
+//   * `outlier_frames`: the fraction of frames whose latency exceeds 4 times
+//     the median.
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_behavior.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/color/color.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/rect.h"
+#include "ink/jni/internal/jni_worker_thread.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/recorded_test_inputs.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/jni/in_progress_stroke_jni_helper.h"
+#include "ink/types/duration.h"
+
+namespace ink::jni {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float kInputBoundsSize = 200;
+constexpr float kBrushSize = 10;
+constexpr float kBrushEpsilon = 0.01;
+constexpr float kInputRateHz = 240;
+constexpr int kOutlierMedianMultiple = 4;
+
+enum class Pipeline { kInProgressStroke, kWrapper, kWrapperAsync };
+
+// A marker with a constant size, and a pen whose size follows the pressure
+// with a time-based damping, so that its shape keeps changing between inputs.
+Brush MakeBrush(int family) {
+  BrushTip tip = {.scale = {1, 1}, .corner_rounding = 1};
+  if (family == 1) {
+    tip.behaviors = {BrushBehavior{{
+        BrushBehavior::SourceNode{
+            .source = BrushBehavior::Source::kNormalizedPressure,
+            .source_value_range = {0, 1},
+        },
+        BrushBehavior::DampingNode{
+            .damping_source = BrushBehavior::DampingSource::kTimeInSeconds,
+            .damping_gap = 0.02,
+        },
+        BrushBehavior::TargetNode{
+            .target = BrushBehavior::Target::kSizeMultiplier,
+            .target_modifier_range = {0.5, 1.5},
+        },
+    }}};
+  }
+  absl::StatusOr<BrushFamily> brush_family =
+      BrushFamily::Create(tip, BrushPaint{});
+  ABSL_CHECK_OK(brush_family);
+  absl::StatusOr<Brush> brush = Brush::Create(
+      *std::move(brush_family), Color::Black(), kBrushSize, kBrushEpsilon);
+  ABSL_CHECK_OK(brush);
+  return *std::move(brush);
+}
+
+// The inputs passed in on one frame.
+struct Frame {
+  StrokeInputBatch real;
+  StrokeInputBatch predicted;
+  bool finish_inputs = false;
+  // When the frame is scheduled, relative to the start of the stroke.
+  Duration32 elapsed_time;
+};
+
+// Splits `inputs` into the frames of a display refreshing at `frame_rate_hz`.
+// Each frame gets the inputs that arrived since the previous frame as real
+// inputs, and the inputs arriving within the next frame period as predicted
+// inputs. The last frame finishes the inputs.
+std::vector<Frame> SplitIntoFrames(const StrokeInputBatch& inputs,
+                                   int frame_rate_hz) {
+  std::vector<Frame> frames;
+  size_t next_input = 0;
+  for (int64_t frame_index = 0; next_input < inputs.Size(); ++frame_index) {
+    Duration32 frame_time = Duration32::Seconds(
+        static_cast<float>(frame_index) / static_cast<float>(frame_rate_hz));
+    Duration32 prediction_end =
+        frame_time + Duration32::Seconds(1.f / frame_rate_hz);
+    Frame& frame = frames.emplace_back();
+    frame.elapsed_time = frame_time;
+    while (next_input < inputs.Size() &&
+           inputs.Get(next_input).elapsed_time <= frame_time) {
+      ABSL_CHECK_OK(frame.real.Append(inputs.Get(next_input++)));
+    }
+    for (size_t i = next_input;
+         i < inputs.Size() && inputs.Get(i).elapsed_time <= prediction_end;
+         ++i) {
+      ABSL_CHECK_OK(frame.predicted.Append(inputs.Get(i)));
+    }
+  }
+  frames.back().finish_inputs = true;
+  return frames;
+}
+
+// Copies `data` into `upload`, standing in for a renderer's buffer upload.
+void Upload(absl::Span<const std::byte> data, std::vector<std::byte>& upload) {
+  upload.resize(data.size());
+  if (!data.empty()) std::memcpy(upload.data(), data.data(), data.size());
+  benchmark::DoNotOptimize(upload.data());
+}
+
+void ReadBack(const InProgressStroke& stroke, std::vector<std::byte>& upload) {
+  for (uint32_t coat = 0; coat < stroke.BrushCoatCount(); ++coat) {
+    const MutableMesh& mesh = stroke.GetMesh(coat);
+    Upload(mesh.RawVertexData(), upload);
+    Upload(mesh.RawIndexData(), upload);
+  }
+}
+
+void ReadBack(const InProgressStrokeWrapper& wrapper,
+              std::vector<std::byte>& upload) {
+  const InProgressStroke& stroke = wrapper.Stroke();
+  for (uint32_t coat = 0; coat < stroke.BrushCoatCount(); ++coat) {
+    int vertex_count = 0;
+    int triangle_count = 0;
+    for (int partition = 0; partition < wrapper.MeshPartitionCount(coat);
+         ++partition) {
+      vertex_count += wrapper.VertexCount(coat, partition);
+      triangle_count += wrapper.TriangleCount(coat, partition);
+    }
+    benchmark::DoNotOptimize(vertex_count);
+    benchmark::DoNotOptimize(triangle_count);
+    const MutableMesh& mesh = stroke.GetMesh(coat);
+    Upload(mesh.RawVertexData(), upload);
+    Upload(mesh.RawIndexData(), upload);
+  }
+}
+
+// Accumulates the latency of every frame replayed by a benchmark.
+class FrameLatencies {
+ public:
+  void Add(Clock::duration latency) { latencies_.push_back(latency); }
+
+  void Report(benchmark::State& state, Clock::duration frame_period) {
+    if (latencies_.empty()) return;
+    std::sort(latencies_.begin(), latencies_.end());
+    auto percentile_us = [this](double fraction) {
+      double count = latencies_.size();
+      size_t last = latencies_.size() - 1;
+      size_t index = std::min(last, static_cast<size_t>(fraction * count));
+      return std::chrono::duration<double, std::micro>(latencies_[index])
+          .count();
+    };
+    state.counters["p50_frame_us"] = percentile_us(0.5);
+    state.counters["p90_frame_us"] = percentile_us(0.9);
+    state.counters["p99_frame_us"] = percentile_us(0.99);
+    state.counters["p999_frame_us"] = percentile_us(0.999);
+    state.counters["max_frame_us"] = percentile_us(1);
+
+    Clock::duration outlier_threshold =
+        latencies_[latencies_.size() / 2] * kOutlierMedianMultiple;
+    auto fraction_over = [this](Clock::duration threshold) {
+      auto first_over = std::upper_bound(latencies_.begin(), latencies_.end(),
+                                         threshold);
+      return static_cast<double>(latencies_.end() - first_over) /
+             static_cast<double>(latencies_.size());
+    };
+    state.counters["over_budget_frames"] = fraction_over(frame_period);
+    state.counters["outlier_frames"] = fraction_over(outlier_threshold);
+  }
+
+ private:
+  std::vector<Clock::duration> latencies_;
+};
+
+// Replays the stroke described by the benchmark arguments once per iteration,
+// starting each frame at its scheduled time if `paced` is true.
+void Replay(benchmark::State& state, bool paced) {
+  Pipeline pipeline = static_cast<Pipeline>(state.range(0));
+  int frame_rate_hz = state.range(1);
+  Brush brush = MakeBrush(state.range(2));
+  std::vector<Frame> frames = SplitIntoFrames(
+      MakeLongRecordedInputs(
+          Rect::FromTwoPoints({0, 0}, {kInputBoundsSize, kInputBoundsSize}),
+          state.range(3), kInputRateHz),
+      frame_rate_hz);
+  Clock::duration frame_period =
+      std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / frame_rate_hz));
+
+  InProgressStroke stroke;
+  InProgressStrokeWrapper wrapper;
+  std::vector<std::byte> upload;
+  FrameLatencies latencies;
+
+  for (auto _ : state) {
+    switch (pipeline) {
+      case Pipeline::kInProgressStroke:
+        stroke.Start(brush);
+        break;
+      case Pipeline::kWrapper:
+        wrapper.Start(brush, 0);
+        break;
+      case Pipeline::kWrapperAsync:
+        wrapper.StartAsync(brush, 0, JniWorkerThread());
+        break;
+    }
+    Clock::time_point replay_start = Clock::now();
+    for (size_t frame_index = 0; frame_index < frames.size(); ++frame_index) {
+      const Frame& frame = frames[frame_index];
+      if (paced) {
+        std::this_thread::sleep_until(replay_start +
+                                      frame_period * frame_index);
+      }
+      Clock::time_point frame_start = Clock::now();
+      switch (pipeline) {
+        case Pipeline::kInProgressStroke:
+          ABSL_CHECK_OK(stroke.EnqueueInputs(frame.real, frame.predicted));
+          if (frame.finish_inputs) stroke.FinishInputs();
+          ABSL_CHECK_OK(stroke.UpdateShape(frame.elapsed_time));
+          ReadBack(stroke, upload);
+          break;
+        case Pipeline::kWrapper:
+          ABSL_CHECK_OK(
+              wrapper.Stroke().EnqueueInputs(frame.real, frame.predicted));
+          if (frame.finish_inputs) wrapper.Stroke().FinishInputs();
+          ABSL_CHECK_OK(wrapper.UpdateShape(frame.elapsed_time));
+          ReadBack(wrapper, upload);
+          break;
+        case Pipeline::kWrapperAsync:
+          wrapper.EnqueueInputsAndUpdateShapeAsync(
+              frame.real, frame.predicted, frame.finish_inputs,
+              frame.elapsed_time, frame_index);
+          ABSL_CHECK_OK(wrapper.AwaitUpdate(frame_index));
+          ReadBack(wrapper, upload);
+          break;
+      }
+      latencies.Add(Clock::now() - frame_start);
+    }
+  }
+  wrapper.Clear();
+  latencies.Report(state, frame_period);
+}
+
+void BM_Replay(benchmark::State& state) { Replay(state, /*paced=*/false); }
+BENCHMARK(BM_Replay)
+    ->ArgNames({"pipeline", "frame_hz", "family", "inputs"})
+    ->ArgsProduct({{0, 1, 2}, {60, 120}, {0, 1}, {2400}});
+
+void BM_PacedReplay(benchmark::State& state) { Replay(state, /*paced=*/true); }
+// Each iteration takes as long as the stroke, 5 seconds, in real time.
+BENCHMARK(BM_PacedReplay)
+    ->ArgNames({"pipeline", "frame_hz", "family", "inputs"})
+    ->ArgsProduct({{0, 1, 2}, {60, 120}, {0, 1}, {1200}})
+    ->Iterations(2)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace ink::jni
@@ -0,0 +1,31 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <jni.h>
+
+#include "ink/jni/internal/jni_defines.h"
+#include "ink/types/memory_trim.h"
+
+extern "C" {
+
+// Releases the rebuildable caches and pools up to `level`, which is the value
+// of a `MemoryTrimLevel`, e.g. from `ComponentCallbacks2.onTrimMemory()`, and
+// returns an estimate of the number of bytes released.
+JNI_METHOD(strokes, MemoryTrimNative, jlong, trimMemory)
+(JNIEnv* env, jobject object, jint level) {
+  return static_cast<jlong>(
+      ink::TrimMemory(static_cast<ink::MemoryTrimLevel>(level)));
+}
+
+}  // extern "C"
@@ -15,9 +15,12 @@
 #include <jni.h>
 
 #include <optional>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "ink/geometry/angle.h"
+#include "ink/jni/internal/jni_array_util.h"
 #include "ink/jni/internal/jni_defines.h"
 #include "ink/jni/internal/jni_throw_util.h"
 #include "ink/strokes/input/stroke_input.h"
@@ -42,12 +45,75 @@ using ::ink::StrokeInputBatch;
 using ::ink::jni::CastToMutableStrokeInputBatch;
 using ::ink::jni::CastToStrokeInputBatch;
 using ::ink::jni::DeleteNativeStrokeInputBatch;
+using ::ink::jni::ForEachNativePointer;
 using ::ink::jni::JIntToToolType;
 using ::ink::jni::NewNativeStrokeInputBatch;
 using ::ink::jni::ThrowExceptionFromStatus;
 using ::ink::jni::ToolTypeToJInt;
 using ::ink::jni::UpdateJObjectInputOrThrow;
 
+// Copies `count` floats starting at `offset` from `array` into `values`, or
+// leaves `values` empty if `array` is null. The range must already have been
+// checked against the length of `array`.
+void CopyFloatRegion(JNIEnv* env, jfloatArray array, jint offset, jint count,
+                     std::vector<float>& values) {
+  if (array == nullptr) return;
+  values.resize(count);
+  env->GetFloatArrayRegion(array, offset, count, values.data());
+}
+
+// Returns an error unless `array` is null (when `nullable` is true), or holds
+// at least `offset + count` elements.
+absl::Status CheckArrayRange(JNIEnv* env, jarray array, bool nullable,
+                             jint offset, jint count, const char* name) {
+  if (array == nullptr) {
+    if (nullable) return absl::OkStatus();
+    return absl::InvalidArgumentError(absl::StrCat("`", name, "` is null"));
+  }
+  jsize length = env->GetArrayLength(array);
+  if (offset > length || count > length - offset) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`", name, "` has ", length, " elements, but ", count,
+                     " are needed starting at offset ", offset));
+  }
+  return absl::OkStatus();
+}
+
+// Returns an error if any of the arrays passed to `appendColumns` is missing
+// or too short for the range of inputs to append.
+absl::Status CheckColumnArrays(JNIEnv* env, jfloatArray x, jfloatArray y,
+                               jlongArray event_time_millis,
+                               jfloatArray pressure, jfloatArray tilt,
+                               jfloatArray orientation, jint offset,
+                               jint count) {
+  if (offset < 0 || count < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`offset` and `count` must be non-negative, got ", offset,
+                     " and ", count));
+  }
+  struct ArrayToCheck {
+    jarray array;
+    bool nullable;
+    const char* name;
+  };
+  for (const ArrayToCheck& to_check : {
+           ArrayToCheck{x, false, "x"},
+           ArrayToCheck{y, false, "y"},
+           ArrayToCheck{event_time_millis, false, "event_time_millis"},
+           ArrayToCheck{pressure, true, "pressure"},
+           ArrayToCheck{tilt, true, "tilt"},
+           ArrayToCheck{orientation, true, "orientation"},
+       }) {
+    if (absl::Status status =
+            CheckArrayRange(env, to_check.array, to_check.nullable, offset,
+                            count, to_check.name);
+        !status.ok()) {
+      return status;
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 extern "C" {
@@ -61,6 +127,14 @@ STROKE_INPUT_BATCH_JNI_METHOD(void, free)
   DeleteNativeStrokeInputBatch(native_pointer);
 }
 
+// Frees each of the Kotlin StrokeInputBatch.nativePointer or
+// MutableStrokeInputBatch.nativePointer values in `native_pointers` in a
+// single call.
+STROKE_INPUT_BATCH_JNI_METHOD(void, freeAll)
+(JNIEnv* env, jobject thiz, jlongArray native_pointers) {
+  ForEachNativePointer(env, native_pointers, DeleteNativeStrokeInputBatch);
+}
+
 STROKE_INPUT_BATCH_JNI_METHOD(jint, getSize)
 (JNIEnv* env, jobject thiz, jlong native_pointer) {
   return CastToStrokeInputBatch(native_pointer).Size();
@@ -155,6 +229,63 @@ MUTABLE_STROKE_INPUT_BATCH_JNI_METHOD(jboolean, appendBatch)
   return true;
 }
 
+// Appends `count` inputs starting at `offset` in each of the given arrays, such
+// as those collected from `MotionEvent.getHistorical*()`, without allocating a
+// Kotlin object per input. `event_time_millis` holds absolute event times,
+// from which `start_time_millis` is subtracted to get each input's elapsed
+// time. Any of `pressure`, `tilt`, and `orientation` may be null if the inputs
+// do not report that property.
+MUTABLE_STROKE_INPUT_BATCH_JNI_METHOD(jboolean, appendColumns)
+(JNIEnv* env, jobject thiz, jlong native_pointer, jint tool_type,
+ jfloat stroke_unit_length_cm, jfloatArray x, jfloatArray y,
+ jlongArray event_time_millis, jlong start_time_millis, jfloatArray pressure,
+ jfloatArray tilt, jfloatArray orientation, jint offset, jint count) {
+  if (absl::Status status = CheckColumnArrays(env, x, y, event_time_millis,
+                                              pressure, tilt, orientation,
+                                              offset, count);
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+    return false;
+  }
+
+  std::vector<float> x_values;
+  std::vector<float> y_values;
+  std::vector<float> pressure_values;
+  std::vector<float> tilt_values;
+  std::vector<float> orientation_values;
+  CopyFloatRegion(env, x, offset, count, x_values);
+  CopyFloatRegion(env, y, offset, count, y_values);
+  CopyFloatRegion(env, pressure, offset, count, pressure_values);
+  CopyFloatRegion(env, tilt, offset, count, tilt_values);
+  CopyFloatRegion(env, orientation, offset, count, orientation_values);
+  std::vector<jlong> times(count);
+  env->GetLongArrayRegion(event_time_millis, offset, count, times.data());
+  std::vector<float> elapsed_seconds(count);
+  for (jint i = 0; i < count; ++i) {
+    elapsed_seconds[i] =
+        Duration32::Millis(times[i] - start_time_millis).ToSeconds();
+  }
+
+  if (absl::Status status =
+          CastToMutableStrokeInputBatch(native_pointer)
+              .AppendColumns({
+                  .tool_type = JIntToToolType(tool_type),
+                  .stroke_unit_length =
+                      PhysicalDistance::Centimeters(stroke_unit_length_cm),
+                  .x = x_values,
+                  .y = y_values,
+                  .elapsed_seconds = elapsed_seconds,
+                  .pressure = pressure_values,
+                  .tilt_radians = tilt_values,
+                  .orientation_radians = orientation_values,
+              });
+      !status.ok()) {
+    ThrowExceptionFromStatus(env, status);
+    return false;
+  }
+  return true;
+}
+
 MUTABLE_STROKE_INPUT_BATCH_JNI_METHOD(void, clear)
 (JNIEnv* env, jobject thiz, jlong native_pointer) {
   CastToMutableStrokeInputBatch(native_pointer).Clear();
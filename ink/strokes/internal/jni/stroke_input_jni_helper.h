@@ -18,6 +18,7 @@
 #include <jni.h>
 
 #include "absl/log/absl_check.h"
+#include "ink/jni/internal/jni_object_pool.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
 
@@ -27,7 +28,8 @@ namespace ink::jni {
 // pointer to it as a jlong, suitable for wrapping in a Kotlin
 // StrokeInputBatch or MutableStrokeInputBatch.
 inline jlong NewNativeStrokeInputBatch(const StrokeInputBatch& batch) {
-  return reinterpret_cast<jlong>(new StrokeInputBatch(batch));
+  return reinterpret_cast<jlong>(
+      GetNativeObjectPool<StrokeInputBatch>().New(batch));
 }
 
 // Creates a new stack-allocated empty `StrokeInputBatch` and returns a
@@ -60,7 +62,8 @@ inline StrokeInputBatch& CastToMutableStrokeInputBatch(
 // MutableStrokeInputBatch.nativePointer.
 inline void DeleteNativeStrokeInputBatch(jlong native_pointer) {
   if (native_pointer == 0) return;
-  delete reinterpret_cast<StrokeInputBatch*>(native_pointer);
+  GetNativeObjectPool<StrokeInputBatch>().Delete(
+      reinterpret_cast<StrokeInputBatch*>(native_pointer));
 }
 
 // Converts Kotlin jint representation of InputToolType enum to C++
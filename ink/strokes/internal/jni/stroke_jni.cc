@@ -18,20 +18,24 @@
 #include "ink/brush/internal/jni/brush_jni_helper.h"
 #include "ink/geometry/internal/jni/partitioned_mesh_jni_helper.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/jni/internal/jni_array_util.h"
 #include "ink/jni/internal/jni_defines.h"
 #include "ink/strokes/input/stroke_input_batch.h"
 #include "ink/strokes/internal/jni/stroke_input_jni_helper.h"
 #include "ink/strokes/internal/jni/stroke_jni_helper.h"
 #include "ink/strokes/stroke.h"
+#include "ink/types/memory_footprint.h"
 
 namespace {
 
+using ::ink::MemoryFootprint;
 using ::ink::Stroke;
 using ::ink::jni::CastToBrush;
 using ::ink::jni::CastToPartitionedMesh;
 using ::ink::jni::CastToStroke;
 using ::ink::jni::CastToStrokeInputBatch;
 using ::ink::jni::DeleteNativeStroke;
+using ::ink::jni::ForEachNativePointer;
 using ::ink::jni::NewNativePartitionedMesh;
 using ::ink::jni::NewNativeStroke;
 using ::ink::jni::NewNativeStrokeInputBatch;
@@ -78,10 +82,26 @@ JNI_METHOD(strokes, StrokeNative, jlong, newShallowCopyOfShape)
       CastToStroke(native_pointer_to_stroke).GetShape());
 }
 
+// Returns an estimate of the number of bytes of memory held by the given
+// `Stroke`, including any data it shares with other strokes.
+JNI_METHOD(strokes, StrokeNative, jlong, memoryFootprintBytes)
+(JNIEnv* env, jobject object, jlong native_pointer_to_stroke) {
+  MemoryFootprint footprint;
+  CastToStroke(native_pointer_to_stroke).AddToMemoryFootprint(footprint);
+  return footprint.TotalBytes();
+}
+
 // Free the given `Stroke`.
 JNI_METHOD(strokes, StrokeNative, void, free)
 (JNIEnv* env, jobject object, jlong native_pointer_to_stroke) {
   DeleteNativeStroke(native_pointer_to_stroke);
 }
 
+// Frees each of the Kotlin Stroke.nativePointer values in `native_pointers` in
+// a single call.
+JNI_METHOD(strokes, StrokeNative, void, freeAll)
+(JNIEnv* env, jobject object, jlongArray native_pointers) {
+  ForEachNativePointer(env, native_pointers, DeleteNativeStroke);
+}
+
 }  // extern "C"
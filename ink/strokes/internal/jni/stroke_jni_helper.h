@@ -18,6 +18,7 @@
 #include <jni.h>
 
 #include "absl/log/absl_check.h"
+#include "ink/jni/internal/jni_object_pool.h"
 #include "ink/strokes/stroke.h"
 
 namespace ink::jni {
@@ -25,7 +26,7 @@ namespace ink::jni {
 // Creates a new stack-allocated copy of the `Stroke` and returns a pointer
 // to it as a jlong, suitable for wrapping in a Kotlin Stroke.
 inline jlong NewNativeStroke(const Stroke& stroke) {
-  return reinterpret_cast<jlong>(new Stroke(stroke));
+  return reinterpret_cast<jlong>(GetNativeObjectPool<Stroke>().New(stroke));
 }
 
 // Casts a Kotlin Stroke.nativePointer to a C++ Stroke. The returned
@@ -38,7 +39,8 @@ inline const Stroke& CastToStroke(jlong native_pointer) {
 // Frees a Kotlin Stroke.nativePointer.
 inline void DeleteNativeStroke(jlong native_pointer) {
   ABSL_CHECK_NE(native_pointer, 0);
-  delete reinterpret_cast<Stroke*>(native_pointer);
+  GetNativeObjectPool<Stroke>().Delete(
+      reinterpret_cast<Stroke*>(native_pointer));
 }
 
 }  // namespace ink::jni
@@ -15,10 +15,12 @@
 #include "ink/strokes/internal/noise_generator.h"
 
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <random>
 
 #include "absl/log/absl_check.h"
+#include "absl/types/span.h"
 #include "ink/geometry/internal/algorithms.h"
 
 namespace ink::strokes_internal {
@@ -33,15 +35,32 @@ NoiseGenerator::NoiseGenerator(uint64_t seed) {
   next_value_ = distribution(prng_);
 }
 
-float NoiseGenerator::CurrentOutputValue() const {
-  ABSL_DCHECK_GE(progress_, 0.0f);
-  ABSL_DCHECK_LT(progress_, 1.0f);
-  // Use a smoothstep function (https://en.wikipedia.org/wiki/Smoothstep) to
-  // connect the current two random values from the PRNG, so as to make the
-  // noise function smooth as well as continuous.
+namespace {
+
+// Use a smoothstep function (https://en.wikipedia.org/wiki/Smoothstep) to
+// connect two consecutive random values from the PRNG, so as to make the noise
+// function smooth as well as continuous.
+float SmoothstepLatticeValues(float prev_value, float next_value,
+                              float progress) {
+  ABSL_DCHECK_GE(progress, 0.0f);
+  ABSL_DCHECK_LT(progress, 1.0f);
   return ::ink::geometry_internal::Lerp(
-      prev_value_, next_value_,
-      progress_ * progress_ * (3.0f - 2.0f * progress_));
+      prev_value, next_value, progress * progress * (3.0f - 2.0f * progress));
+}
+
+// Replaces each progress value in `values` with the corresponding output value
+// for the lattice values `prev_value` and `next_value`.
+void SmoothstepLatticeValues(float prev_value, float next_value,
+                             absl::Span<float> values) {
+  for (float& value : values) {
+    value = SmoothstepLatticeValues(prev_value, next_value, value);
+  }
+}
+
+}  // namespace
+
+float NoiseGenerator::CurrentOutputValue() const {
+  return SmoothstepLatticeValues(prev_value_, next_value_, progress_);
 }
 
 void NoiseGenerator::AdvanceInputBy(float advance_by) {
@@ -72,4 +91,26 @@ void NoiseGenerator::AdvanceInputBy(float advance_by) {
   }
 }
 
+void NoiseGenerator::AdvanceInputsBy(absl::Span<const float> advance_by,
+                                     absl::Span<float> output_values) {
+  ABSL_CHECK_EQ(advance_by.size(), output_values.size());
+  // First store the progress for each value, noting where the lattice values
+  // change, then interpolate each run of values that share lattice values.
+  size_t run_start = 0;
+  for (size_t i = 0; i < advance_by.size(); ++i) {
+    float prev_value = prev_value_;
+    float next_value = next_value_;
+    AdvanceInputBy(advance_by[i]);
+    if (prev_value != prev_value_ || next_value != next_value_) {
+      SmoothstepLatticeValues(
+          prev_value, next_value,
+          output_values.subspan(run_start, i - run_start));
+      run_start = i;
+    }
+    output_values[i] = progress_;
+  }
+  SmoothstepLatticeValues(prev_value_, next_value_,
+                          output_values.subspan(run_start));
+}
+
 }  // namespace ink::strokes_internal
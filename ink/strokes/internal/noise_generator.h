@@ -18,6 +18,8 @@
 #include <cstdint>
 #include <random>
 
+#include "absl/types/span.h"
+
 namespace ink::strokes_internal {
 
 // A random gradient noise function that maps input values in [0, inf) to output
@@ -52,6 +54,18 @@ class NoiseGenerator {
   // zero is a no-op.
   void AdvanceInputBy(float advance_by);
 
+  // Equivalent to calling `AdvanceInputBy(advance_by[i])` followed by
+  // `output_values[i] = CurrentOutputValue()` for each `i` in order, and gives
+  // bit-identical results to doing so. The two spans must have the same size
+  // (CHECK-enforced), and may be the same span, in which case each advance
+  // amount is replaced by the corresponding output value.
+  //
+  // This walks the lattice sequence once and then interpolates each run of
+  // outputs that share a pair of lattice values in a separate loop, rather
+  // than interleaving the two for each value.
+  void AdvanceInputsBy(absl::Span<const float> advance_by,
+                       absl::Span<float> output_values);
+
  private:
   // The underlying PRNG used to generate lattice values for our 1D gradient
   // noise function. A few notes on the choice of PRNG implementation here:
@@ -15,7 +15,9 @@
 #include "ink/strokes/internal/noise_generator.h"
 
 #include <cstdint>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
@@ -106,5 +108,47 @@ FUZZ_TEST(NoiseGeneratorTest, CopiedGeneratorEmitsSameSequence)
     .WithDomains(fuzztest::Arbitrary<uint64_t>(),
                  fuzztest::InRange<float>(0, 3));
 
+// Tests that advancing through a batch of values emits bit-identical values to
+// advancing one value at a time, and leaves the generator in the same state.
+void BatchAdvanceMatchesScalarAdvance(uint64_t seed,
+                                      std::vector<float> advance_by) {
+  NoiseGenerator scalar_generator(seed);
+  std::vector<float> expected;
+  for (float advance : advance_by) {
+    scalar_generator.AdvanceInputBy(advance);
+    expected.push_back(scalar_generator.CurrentOutputValue());
+  }
+
+  NoiseGenerator batch_generator(seed);
+  std::vector<float> actual(advance_by.size());
+  batch_generator.AdvanceInputsBy(advance_by, absl::MakeSpan(actual));
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(batch_generator.CurrentOutputValue(),
+            scalar_generator.CurrentOutputValue());
+
+  // Writing the output over the input must give the same result.
+  NoiseGenerator in_place_generator(seed);
+  in_place_generator.AdvanceInputsBy(advance_by, absl::MakeSpan(advance_by));
+  EXPECT_EQ(advance_by, expected);
+}
+FUZZ_TEST(NoiseGeneratorTest, BatchAdvanceMatchesScalarAdvance)
+    .WithDomains(fuzztest::Arbitrary<uint64_t>(),
+                 fuzztest::VectorOf(fuzztest::InRange<float>(0, 3)));
+
+TEST(NoiseGeneratorTest, BatchAdvanceWithNoValuesIsNoOp) {
+  NoiseGenerator generator(12345);
+  float value = generator.CurrentOutputValue();
+  generator.AdvanceInputsBy({}, {});
+  EXPECT_EQ(generator.CurrentOutputValue(), value);
+}
+
+TEST(NoiseGeneratorDeathTest, BatchAdvanceWithMismatchedSizes) {
+  NoiseGenerator generator(12345);
+  std::vector<float> advance_by = {0.1, 0.2};
+  std::vector<float> output(1);
+  EXPECT_DEATH_IF_SUPPORTED(
+      generator.AdvanceInputsBy(advance_by, absl::MakeSpan(output)), "");
+}
+
 }  // namespace
 }  // namespace ink::strokes_internal
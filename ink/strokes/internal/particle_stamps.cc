@@ -0,0 +1,74 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/internal/particle_stamps.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/brush_tip_modeler.h"
+#include "ink/strokes/internal/brush_tip_state.h"
+#include "ink/strokes/internal/stroke_input_modeler.h"
+#include "ink/types/duration.h"
+
+namespace ink::strokes_internal {
+
+bool IsStampingParticleCoat(const BrushCoat& coat) {
+  // We can only handle stamping textures when there is a single texture layer.
+  return coat.paint.texture_layers.size() == 1 &&
+         coat.paint.texture_layers[0].mapping ==
+             BrushPaint::TextureMapping::kStamping &&
+         (coat.tip.particle_gap_distance_scale != 0 ||
+          coat.tip.particle_gap_duration != Duration32::Zero());
+}
+
+void AppendParticleStamps(const Brush& brush, uint32_t coat_index,
+                          const StrokeInputBatch& inputs,
+                          std::vector<BrushTipState>& stamps) {
+  ABSL_CHECK_LT(coat_index, brush.CoatCount());
+  if (inputs.IsEmpty()) return;
+
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(brush.GetFamily().GetInputModel(),
+                            brush.GetEpsilon());
+  input_modeler.ExtendStroke(inputs, StrokeInputBatch(),
+                             Duration32::Infinite());
+
+  BrushTipModeler tip_modeler;
+  tip_modeler.StartStroke(&brush.GetCoats()[coat_index].tip, brush.GetSize(),
+                          inputs.GetNoiseSeed());
+  tip_modeler.UpdateStroke(input_modeler.GetState(),
+                           input_modeler.GetModeledInputs());
+
+  // This matches the condition for which `BrushTipExtruder` inserts a break in
+  // the geometry rather than extruding the tip state.
+  float epsilon = brush.GetEpsilon();
+  auto append_stamps = [epsilon,
+                        &stamps](absl::Span<const BrushTipState> states) {
+    for (const BrushTipState& state : states) {
+      if (state.width < epsilon && state.height < epsilon) continue;
+      stamps.push_back(state);
+    }
+  };
+  append_stamps(tip_modeler.NewFixedTipStates());
+  append_stamps(tip_modeler.VolatileTipStates());
+}
+
+}  // namespace ink::strokes_internal
@@ -0,0 +1,53 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_INTERNAL_PARTICLE_STAMPS_H_
+#define INK_STROKES_INTERNAL_PARTICLE_STAMPS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/brush_tip_state.h"
+
+namespace ink::strokes_internal {
+
+// Returns true if `coat` has a single texture layer with `kStamping` mapping
+// and a tip that emits particles.
+//
+// The `BrushTipExtruder` gives every particle of such a coat surface UVs that
+// map the whole texture onto the `width` by `height` rectangle centered on the
+// particle's tip position and rotated by its tip rotation, ignoring slant,
+// pinch, and corner rounding. Each particle can therefore also be drawn as a
+// single textured quad, or "stamp", clipped to the tip shape.
+bool IsStampingParticleCoat(const BrushCoat& coat);
+
+// Models the tip states of the particles of coat `coat_index` of `brush` over
+// the complete `inputs`, and appends them to `stamps` in the order they are
+// emitted. No geometry is extruded, so this is much cheaper than building the
+// coat's mesh.
+//
+// The gap tip states between particles, which are the ones smaller than the
+// brush epsilon in both dimensions, are skipped. As for a finished `Stroke`,
+// time-since-input behaviors are completed. `coat_index` must be less than
+// `brush.CoatCount()`.
+void AppendParticleStamps(const Brush& brush, uint32_t coat_index,
+                          const StrokeInputBatch& inputs,
+                          std::vector<BrushTipState>& stamps);
+
+}  // namespace ink::strokes_internal
+
+#endif  // INK_STROKES_INTERNAL_PARTICLE_STAMPS_H_
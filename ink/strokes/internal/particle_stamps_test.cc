@@ -0,0 +1,136 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/internal/particle_stamps.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/color/color.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/brush_tip_state.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+
+namespace ink::strokes_internal {
+namespace {
+
+using ::testing::FloatEq;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+const BrushPaint::TextureLayer kStampingLayer = {
+    .client_texture_id = "stamp",
+    .mapping = BrushPaint::TextureMapping::kStamping};
+
+Brush MakeBrush(const BrushTip& tip, const BrushPaint& paint) {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(tip, paint);
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush = Brush::Create(*family, Color::Black(),
+                                              /* size = */ 10,
+                                              /* epsilon = */ 0.1);
+  ABSL_CHECK_OK(brush);
+  return *brush;
+}
+
+StrokeInputBatch MakeHorizontalLine() {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i <= 10; ++i) {
+    inputs.push_back({.position = {10.f * i, 0},
+                      .elapsed_time = Duration32::Seconds(0.1 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *batch;
+}
+
+TEST(ParticleStampsTest, IsStampingParticleCoat) {
+  EXPECT_TRUE(IsStampingParticleCoat(
+      {.tip = {.particle_gap_distance_scale = 0.5},
+       .paint = {.texture_layers = {kStampingLayer}}}));
+  EXPECT_TRUE(IsStampingParticleCoat(
+      {.tip = {.particle_gap_duration = Duration32::Seconds(0.1)},
+       .paint = {.texture_layers = {kStampingLayer}}}));
+
+  // Not a particle brush.
+  EXPECT_FALSE(
+      IsStampingParticleCoat({.paint = {.texture_layers = {kStampingLayer}}}));
+  // Not textured, tiled, or with more than one layer.
+  EXPECT_FALSE(
+      IsStampingParticleCoat({.tip = {.particle_gap_distance_scale = 0.5}}));
+  EXPECT_FALSE(IsStampingParticleCoat(
+      {.tip = {.particle_gap_distance_scale = 0.5},
+       .paint = {.texture_layers = {
+                     {.mapping = BrushPaint::TextureMapping::kTiling}}}}));
+  EXPECT_FALSE(IsStampingParticleCoat(
+      {.tip = {.particle_gap_distance_scale = 0.5},
+       .paint = {.texture_layers = {kStampingLayer, kStampingLayer}}}));
+}
+
+TEST(ParticleStampsTest, EmptyInputsHaveNoStamps) {
+  Brush brush = MakeBrush({.particle_gap_distance_scale = 1},
+                          {.texture_layers = {kStampingLayer}});
+  std::vector<BrushTipState> stamps;
+  AppendParticleStamps(brush, 0, StrokeInputBatch(), stamps);
+  EXPECT_THAT(stamps, IsEmpty());
+}
+
+TEST(ParticleStampsTest, OneStampPerParticleOutline) {
+  Brush brush = MakeBrush(
+      {.rotation = Angle::Degrees(30), .particle_gap_distance_scale = 1},
+      {.texture_layers = {kStampingLayer}});
+  StrokeInputBatch inputs = MakeHorizontalLine();
+
+  std::vector<BrushTipState> stamps;
+  AppendParticleStamps(brush, 0, inputs, stamps);
+
+  // The extruder makes one outline for each particle.
+  Stroke stroke(brush, inputs);
+  ASSERT_GT(stroke.GetShape().OutlineCount(0), 1u);
+  EXPECT_THAT(stamps, SizeIs(stroke.GetShape().OutlineCount(0)));
+
+  float previous_x = -1;
+  for (const BrushTipState& stamp : stamps) {
+    EXPECT_GT(stamp.position.x, previous_x);
+    EXPECT_THAT(stamp.position.y, FloatEq(0));
+    EXPECT_THAT(stamp.width, FloatEq(10));
+    EXPECT_THAT(stamp.height, FloatEq(10));
+    EXPECT_THAT(stamp.rotation, AngleEq(Angle::Degrees(30)));
+    previous_x = stamp.position.x;
+  }
+}
+
+TEST(ParticleStampsTest, AppendsToExistingStamps) {
+  Brush brush = MakeBrush({.particle_gap_distance_scale = 1},
+                          {.texture_layers = {kStampingLayer}});
+  std::vector<BrushTipState> stamps(2);
+  AppendParticleStamps(brush, 0, MakeHorizontalLine(), stamps);
+  std::vector<BrushTipState> new_stamps;
+  AppendParticleStamps(brush, 0, MakeHorizontalLine(), new_stamps);
+  EXPECT_THAT(stamps, SizeIs(2 + new_stamps.size()));
+}
+
+}  // namespace
+}  // namespace ink::strokes_internal
@@ -0,0 +1,81 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/strokes/internal/stroke_input_decimator.h"
+
+#include <cmath>
+#include <optional>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/vec.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+
+namespace ink::strokes_internal {
+namespace {
+
+// Changes in pressure, tilt, and orientation smaller than these are not
+// considered visually distinct by any brush behavior in practice.
+constexpr float kPressureTolerance = 0.01;
+constexpr Angle kAngleTolerance = Angle::Degrees(1);
+
+bool AnglesAreClose(Angle a, Angle b) {
+  return std::abs((a - b).NormalizedAboutZero().ValueInRadians()) <=
+         kAngleTolerance.ValueInRadians();
+}
+
+}  // namespace
+
+void StrokeInputDecimator::StartStroke(float min_distance) {
+  ABSL_CHECK_GE(min_distance, 0);
+  min_distance_ = min_distance;
+  last_kept_input_.reset();
+}
+
+absl::Status StrokeInputDecimator::AppendKeptInputs(
+    const StrokeInputBatch& inputs, StrokeInputBatch& kept_inputs) {
+  kept_scratch_.Clear();
+  std::optional<StrokeInput> last_kept_input = last_kept_input_;
+  for (const StrokeInput& input : inputs) {
+    if (!ShouldKeep(input, last_kept_input)) continue;
+    if (absl::Status status = kept_scratch_.Append(input); !status.ok()) {
+      return status;
+    }
+    last_kept_input = input;
+  }
+  if (absl::Status status = kept_inputs.Append(kept_scratch_); !status.ok()) {
+    return status;
+  }
+  last_kept_input_ = last_kept_input;
+  return absl::OkStatus();
+}
+
+bool StrokeInputDecimator::ShouldKeep(
+    const StrokeInput& input,
+    const std::optional<StrokeInput>& last_kept_input) const {
+  if (!last_kept_input.has_value()) return true;
+  const StrokeInput& last = *last_kept_input;
+  // Every input of a stroke has the same set of optional properties, so any
+  // missing ones compare as equal.
+  return (input.position - last.position).Magnitude() >= min_distance_ ||
+         std::abs(input.pressure - last.pressure) > kPressureTolerance ||
+         !AnglesAreClose(input.tilt, last.tilt) ||
+         !AnglesAreClose(input.orientation, last.orientation);
+}
+
+}  // namespace ink::strokes_internal
@@ -0,0 +1,72 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_STROKES_INTERNAL_STROKE_INPUT_DECIMATOR_H_
+#define INK_STROKES_INTERNAL_STROKE_INPUT_DECIMATOR_H_
+
+#include <optional>
+
+#include "absl/status/status.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+
+namespace ink::strokes_internal {
+
+// Drops raw inputs that would not visibly change a stroke, before they are
+// modeled.
+//
+// High-rate styluses report many consecutive inputs that are closer together
+// than the brush epsilon. The `StrokeInputModeler` already discards modeled
+// results that are closer than the epsilon, but each raw input still costs a
+// modeler update. An input is dropped only if, compared to the last input that
+// was kept, it is:
+//   * less than the `min_distance` passed to `StartStroke()` away, and
+//   * within a small tolerance in pressure, tilt, and orientation.
+// Inputs at pressure, tilt, or orientation extremes are therefore kept, and
+// since the kept inputs still carry their own elapsed times, distance- and
+// time-based brush behaviors see the same `InputMetrics` up to `min_distance`.
+class StrokeInputDecimator {
+ public:
+  // Starts a new stroke, with no inputs kept yet. `min_distance` is
+  // CHECK-validated to be non-negative; a value of zero keeps every input.
+  void StartStroke(float min_distance);
+
+  // Returns true if this may drop any inputs, i.e. if the current stroke was
+  // started with a positive `min_distance`.
+  bool IsEnabled() const { return min_distance_ > 0; }
+
+  // Appends the inputs of `inputs` that should be kept to `kept_inputs`.
+  //
+  // The last input of `kept_inputs` is expected to be the last input kept by a
+  // previous call since `StartStroke()`, if any. If the kept inputs cannot be
+  // appended to `kept_inputs`, returns the error and leaves both `kept_inputs`
+  // and this object unchanged.
+  absl::Status AppendKeptInputs(const StrokeInputBatch& inputs,
+                                StrokeInputBatch& kept_inputs);
+
+ private:
+  // Returns true if `input` should be kept after `last_kept_input`.
+  bool ShouldKeep(const StrokeInput& input,
+                  const std::optional<StrokeInput>& last_kept_input) const;
+
+  float min_distance_ = 0;
+  std::optional<StrokeInput> last_kept_input_;
+  // Scratch storage for `AppendKeptInputs()`.
+  StrokeInputBatch kept_scratch_;
+};
+
+}  // namespace ink::strokes_internal
+
+#endif  // INK_STROKES_INTERNAL_STROKE_INPUT_DECIMATOR_H_
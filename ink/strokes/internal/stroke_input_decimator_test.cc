@@ -0,0 +1,164 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/strokes/internal/stroke_input_decimator.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink/geometry/angle.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/duration.h"
+
+namespace ink::strokes_internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatEq;
+
+StrokeInputBatch MakeBatch(const std::vector<StrokeInput>& inputs) {
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *batch;
+}
+
+// Returns inputs moving along the x-axis by `step` every millisecond.
+std::vector<StrokeInput> MakeLineInputs(int count, float step,
+                                        float pressure = 0.5) {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < count; ++i) {
+    inputs.push_back({.position = {step * i, 0},
+                      .elapsed_time = Duration32::Millis(i),
+                      .pressure = pressure});
+  }
+  return inputs;
+}
+
+std::vector<float> XPositions(const StrokeInputBatch& batch) {
+  std::vector<float> x;
+  for (const StrokeInput& input : batch) x.push_back(input.position.x);
+  return x;
+}
+
+TEST(StrokeInputDecimatorTest, ZeroMinDistanceKeepsEveryInput) {
+  StrokeInputDecimator decimator;
+  decimator.StartStroke(0);
+  EXPECT_FALSE(decimator.IsEnabled());
+
+  StrokeInputBatch inputs = MakeBatch(MakeLineInputs(5, 0.001));
+  StrokeInputBatch kept;
+  ASSERT_EQ(absl::OkStatus(), decimator.AppendKeptInputs(inputs, kept));
+  EXPECT_EQ(kept.Size(), 5);
+}
+
+TEST(StrokeInputDecimatorTest, DropsInputsCloserThanMinDistance) {
+  StrokeInputDecimator decimator;
+  decimator.StartStroke(0.01);
+  EXPECT_TRUE(decimator.IsEnabled());
+
+  StrokeInputBatch inputs = MakeBatch(MakeLineInputs(7, 0.004));
+  StrokeInputBatch kept;
+  ASSERT_EQ(absl::OkStatus(), decimator.AppendKeptInputs(inputs, kept));
+  EXPECT_THAT(XPositions(kept),
+              ElementsAre(FloatEq(0), FloatEq(0.012), FloatEq(0.024)));
+}
+
+TEST(StrokeInputDecimatorTest, ComparesAgainstInputsKeptByPreviousCalls) {
+  std::vector<StrokeInput> inputs = MakeLineInputs(6, 0.004);
+  StrokeInputDecimator decimator;
+  decimator.StartStroke(0.01);
+
+  StrokeInputBatch kept;
+  ASSERT_EQ(absl::OkStatus(),
+            decimator.AppendKeptInputs(
+                MakeBatch({inputs.begin(), inputs.begin() + 2}), kept));
+  ASSERT_EQ(absl::OkStatus(),
+            decimator.AppendKeptInputs(
+                MakeBatch({inputs.begin() + 2, inputs.end()}), kept));
+  EXPECT_THAT(XPositions(kept), ElementsAre(FloatEq(0), FloatEq(0.012)));
+
+  // Starting a new stroke forgets the last kept input.
+  decimator.StartStroke(0.01);
+  StrokeInputBatch new_kept;
+  ASSERT_EQ(absl::OkStatus(),
+            decimator.AppendKeptInputs(MakeBatch({inputs[1]}), new_kept));
+  EXPECT_EQ(new_kept.Size(), 1);
+}
+
+TEST(StrokeInputDecimatorTest, KeepsCloseInputsWithDistinctStylusState) {
+  std::vector<StrokeInput> inputs = MakeLineInputs(4, 0.001);
+  inputs[1].pressure = 0.9;
+  inputs[2].pressure = 0.9;
+  inputs[3].pressure = 0.1;
+
+  StrokeInputDecimator decimator;
+  decimator.StartStroke(0.01);
+  StrokeInputBatch kept;
+  ASSERT_EQ(absl::OkStatus(),
+            decimator.AppendKeptInputs(MakeBatch(inputs), kept));
+  std::vector<float> pressures;
+  for (const StrokeInput& input : kept) pressures.push_back(input.pressure);
+  EXPECT_THAT(pressures, ElementsAre(FloatEq(0.5), FloatEq(0.9), FloatEq(0.1)));
+
+  std::vector<StrokeInput> tilted_inputs = {
+      {.position = {0, 0},
+       .elapsed_time = Duration32::Zero(),
+       .tilt = Angle::Degrees(10)},
+      {.position = {0, 0.001},
+       .elapsed_time = Duration32::Millis(1),
+       .tilt = Angle::Degrees(10.5)},
+      {.position = {0, 0.002},
+       .elapsed_time = Duration32::Millis(2),
+       .tilt = Angle::Degrees(30)},
+  };
+  decimator.StartStroke(0.01);
+  kept.Clear();
+  ASSERT_EQ(absl::OkStatus(),
+            decimator.AppendKeptInputs(MakeBatch(tilted_inputs), kept));
+  EXPECT_EQ(kept.Size(), 2);
+}
+
+TEST(StrokeInputDecimatorTest, LeavesStateUnchangedOnAppendError) {
+  StrokeInputDecimator decimator;
+  decimator.StartStroke(0.01);
+  StrokeInputBatch kept;
+  ASSERT_EQ(absl::OkStatus(),
+            decimator.AppendKeptInputs(MakeBatch(MakeLineInputs(1, 1)), kept));
+
+  // Inputs without pressure cannot be appended to inputs with pressure.
+  std::vector<StrokeInput> inputs =
+      MakeLineInputs(3, 1, StrokeInput::kNoPressure);
+  inputs.erase(inputs.begin());
+  absl::Status status = decimator.AppendKeptInputs(MakeBatch(inputs), kept);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(kept.Size(), 1);
+
+  // The failed inputs were not recorded as kept.
+  ASSERT_EQ(absl::OkStatus(),
+            decimator.AppendKeptInputs(
+                MakeBatch({{.position = {0.005, 0},
+                            .elapsed_time = Duration32::Millis(1),
+                            .pressure = 0.5}}),
+                kept));
+  EXPECT_EQ(kept.Size(), 1);
+}
+
+}  // namespace
+}  // namespace ink::strokes_internal
@@ -15,6 +15,7 @@
 #include "ink/strokes/internal/stroke_input_modeler.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <optional>
 #include <variant>
@@ -45,6 +46,19 @@ constexpr float kDefaultLoopMitigationInterpolationStrengthAtSpeedUpperBound =
 const stroke_model::Duration kDefaultLoopMitigationMinSpeedSamplingWindow =
     stroke_model::Duration(0.04);
 
+// Limits on how far apart, and how different, consecutive modeled inputs may be
+// when using `BrushFamily::ExperimentalAdaptiveSamplingModel`. The spacing
+// limit keeps behaviors that depend on time or distance reasonably sampled even
+// along perfectly straight segments, and is given in multiples of the brush
+// epsilon.
+constexpr float kAdaptiveSamplingMaxSpacingInEpsilons = 16;
+constexpr float kAdaptiveSamplingMaxPressureChange = 0.02;
+constexpr float kAdaptiveSamplingMaxTiltOrOrientationChangeInRadians = 0.035;
+
+// The number of evenly spaced times within the prediction horizon at which
+// `ExtendStroke()` extrapolates the stroke when it predicts inputs itself.
+constexpr int kExtrapolatedInputCount = 12;
+
 void StrokeInputModeler::StartStroke(const BrushFamily::InputModel& input_model,
                                      float brush_epsilon) {
   // The `stroke_modeler_` cannot be reset until we get the first input in order
@@ -54,6 +68,7 @@ void StrokeInputModeler::StartStroke(const BrushFamily::InputModel& input_model,
   input_model_ = input_model;
   brush_epsilon_ = brush_epsilon;
   last_real_stroke_input_.reset();
+  last_real_input_ends_stroke_ = true;
   state_.tool_type = StrokeInput::ToolType::kUnknown;
   state_.stroke_unit_length = std::nullopt;
   state_.complete_elapsed_time = Duration32::Zero();
@@ -108,6 +123,13 @@ LoopContractionParams(
   };
 }
 
+PositionModelerParams::LoopContractionMitigationParameters
+LoopContractionParams(
+    const BrushFamily::ExperimentalAdaptiveSamplingModel& adaptive_model,
+    std::optional<PhysicalDistance> stroke_unit_length) {
+  return LoopContractionParams(BrushFamily::SpringModel{}, stroke_unit_length);
+}
+
 PositionModelerParams::LoopContractionMitigationParameters
 MakeLoopContractionMitigationParameters(
     const BrushFamily::InputModel& input_model,
@@ -129,6 +151,11 @@ StylusStateModelerParams StylusModelerParams(
   return StylusModelerParams(BrushFamily::SpringModel{});
 }
 
+StylusStateModelerParams StylusModelerParams(
+    const BrushFamily::ExperimentalAdaptiveSamplingModel& adaptive_model) {
+  return StylusModelerParams(BrushFamily::SpringModel{});
+}
+
 StylusStateModelerParams MakeStylusStateModelerParams(
     const BrushFamily::InputModel& input_model) {
   return std::visit(
@@ -140,6 +167,28 @@ StylusStateModelerParams MakeStylusStateModelerParams(
 
 // LINT.ThenChange(../../brush/brush_family.h:input_model_types)
 
+stroke_model::Input MakeStrokeModelInput(
+    const StrokeInput& input, stroke_model::Input::EventType event_type) {
+  return {.event_type = event_type,
+          .position = {input.position.x, input.position.y},
+          .time = stroke_model::Time(input.elapsed_time.ToSeconds()),
+          .pressure = input.pressure,
+          .tilt = input.tilt.ValueInRadians(),
+          .orientation = input.orientation.ValueInRadians()};
+}
+
+// Returns true if the stylus state of `result` differs enough from that of
+// `previous` that `result` should be kept even if it is close by.
+bool StylusStateChanged(const ModeledStrokeInput& previous,
+                        const stroke_model::Result& result) {
+  return std::abs(result.pressure - previous.pressure) >
+             kAdaptiveSamplingMaxPressureChange ||
+         std::abs(result.tilt - previous.tilt.ValueInRadians()) >
+             kAdaptiveSamplingMaxTiltOrOrientationChangeInRadians ||
+         std::abs(result.orientation - previous.orientation.ValueInRadians()) >
+             kAdaptiveSamplingMaxTiltOrOrientationChangeInRadians;
+}
+
 void ResetStrokeModeler(stroke_model::StrokeModeler& stroke_modeler,
                         const BrushFamily::InputModel& input_model,
                         float brush_epsilon,
@@ -178,7 +227,8 @@ void ResetStrokeModeler(stroke_model::StrokeModeler& stroke_modeler,
 
 void StrokeInputModeler::ExtendStroke(const StrokeInputBatch& real_inputs,
                                       const StrokeInputBatch& predicted_inputs,
-                                      Duration32 current_elapsed_time) {
+                                      Duration32 current_elapsed_time,
+                                      Duration32 prediction_horizon) {
   ABSL_CHECK_GT(brush_epsilon_, 0) << "`StartStroke()` has not been called.";
 
   absl::Cleanup update_time_and_distance = [&]() {
@@ -186,10 +236,13 @@ void StrokeInputModeler::ExtendStroke(const StrokeInputBatch& real_inputs,
   };
 
   if (real_inputs.IsEmpty() && predicted_inputs.IsEmpty() &&
-      state_.real_input_count == modeled_inputs_.size()) {
-    // We can return early, because there are no new inputs, and none of the
-    // modeled inputs came from previous `predicted_inputs`. This allows us to
-    // skip re-modeling the `last_real_stroke_input_`.
+      state_.real_input_count == modeled_inputs_.size() &&
+      (last_real_input_ends_stroke_ ||
+       prediction_horizon > Duration32::Zero())) {
+    // We can return early, because there are no new inputs, none of the
+    // modeled inputs came from previous `predicted_inputs` or extrapolation,
+    // and the last real input was already modeled the same way. This allows us
+    // to skip re-modeling the `last_real_stroke_input_`.
     return;
   }
 
@@ -227,17 +280,24 @@ void StrokeInputModeler::ExtendStroke(const StrokeInputBatch& real_inputs,
   bool stroke_modeler_save_has_input = stroke_modeler_has_input_;
   state_.stable_input_count = modeled_inputs_.size();
 
+  // When extrapolating, the last real input is not modeled as the end of the
+  // stroke, so that the extrapolation starts from the modeled motion rather
+  // than from the modeler catching up to a stop.
+  bool extrapolate =
+      predicted_inputs.IsEmpty() && prediction_horizon > Duration32::Zero();
+  bool real_input_ends_update = predicted_inputs.IsEmpty() && !extrapolate;
   if (!real_inputs.IsEmpty()) {
     last_real_stroke_input_ = real_inputs.Get(real_inputs.Size() - 1);
-    ModelInput(*last_real_stroke_input_,
-               /* last_input_in_update = */ predicted_inputs.IsEmpty());
+    ModelInput(*last_real_stroke_input_, real_input_ends_update);
   } else if (last_real_stroke_input_.has_value()) {
-    ModelInput(*last_real_stroke_input_,
-               /* last_input_in_update = */ predicted_inputs.IsEmpty());
+    ModelInput(*last_real_stroke_input_, real_input_ends_update);
   }
 
+  last_real_input_ends_stroke_ = real_input_ends_update;
   state_.real_input_count = modeled_inputs_.size();
 
+  if (extrapolate) AppendExtrapolatedInputs(prediction_horizon);
+
   for (size_t i = 0; i < predicted_inputs.Size(); ++i) {
     ModelInput(predicted_inputs.Get(i),
                /* last_input_in_update = */ i == predicted_inputs.Size() - 1);
@@ -275,14 +335,8 @@ void StrokeInputModeler::ModelInput(const StrokeInput& input,
 
   // `StrokeInputBatch` and `InProgressStroke` are designed to perform all the
   // necessary validation so that this operation should not fail.
-  ABSL_CHECK_OK(stroke_modeler_.Update(
-      {.event_type = event_type,
-       .position = {input.position.x, input.position.y},
-       .time = stroke_model::Time(input.elapsed_time.ToSeconds()),
-       .pressure = input.pressure,
-       .tilt = input.tilt.ValueInRadians(),
-       .orientation = input.orientation.ValueInRadians()},
-      result_buffer_));
+  ABSL_CHECK_OK(stroke_modeler_.Update(MakeStrokeModelInput(input, event_type),
+                                       result_buffer_));
 
   std::optional<Point> previous_position;
   float traveled_distance = 0;
@@ -291,13 +345,29 @@ void StrokeInputModeler::ModelInput(const StrokeInput& input,
     traveled_distance = modeled_inputs_.back().traveled_distance;
   }
 
-  for (const stroke_model::Result& result : result_buffer_) {
+  bool adaptive_sampling =
+      std::holds_alternative<BrushFamily::ExperimentalAdaptiveSamplingModel>(
+          input_model_);
+  // The largest angle between the velocity of the last kept modeled input and
+  // that of any result considered since.
+  float max_turn_in_radians = 0;
+
+  for (size_t i = 0; i < result_buffer_.size(); ++i) {
+    const stroke_model::Result& result = result_buffer_[i];
     Point position = {.x = result.position.x, .y = result.position.y};
 
     if (previous_position.has_value()) {
       float delta = (position - *previous_position).Magnitude();
       if (delta < brush_epsilon_) continue;
 
+      // The last result of an update is the current end of the stroke, which
+      // is always kept.
+      if (adaptive_sampling &&
+          !(last_input_in_update && i + 1 == result_buffer_.size()) &&
+          SkipForAdaptiveSampling(result, delta, max_turn_in_radians)) {
+        continue;
+      }
+
       traveled_distance += delta;
     }
 
@@ -314,9 +384,127 @@ void StrokeInputModeler::ModelInput(const StrokeInput& input,
     });
 
     previous_position = position;
+    max_turn_in_radians = 0;
   }
 }
 
+void StrokeInputModeler::AppendExtrapolatedInputs(
+    Duration32 prediction_horizon) {
+  if (modeled_inputs_.empty()) return;
+
+  // Copied, since appending to `modeled_inputs_` may reallocate.
+  const ModeledStrokeInput last = modeled_inputs_.back();
+  Point previous_position = last.position;
+  float traveled_distance = last.traveled_distance;
+  for (int i = 1; i <= kExtrapolatedInputCount; ++i) {
+    Duration32 time_ahead = prediction_horizon *
+                            (static_cast<float>(i) / kExtrapolatedInputCount);
+    float t = time_ahead.ToSeconds();
+    Vec velocity = last.velocity + t * last.acceleration;
+    // Stop once the extrapolated motion would stop or turn back, which a
+    // decelerating pointer would otherwise predict.
+    if (Vec::DotProduct(velocity, last.velocity) <= 0) break;
+
+    Point position =
+        last.position + t * last.velocity + (0.5f * t * t) * last.acceleration;
+    float delta = (position - previous_position).Magnitude();
+    if (delta < brush_epsilon_) continue;
+    traveled_distance += delta;
+
+    modeled_inputs_.push_back({
+        .position = position,
+        .velocity = velocity,
+        .acceleration = last.acceleration,
+        .traveled_distance = traveled_distance,
+        .elapsed_time = last.elapsed_time + time_ahead,
+        .pressure = last.pressure,
+        .tilt = last.tilt,
+        .orientation = last.orientation,
+    });
+    previous_position = position;
+  }
+}
+
+bool StrokeInputModeler::SkipForAdaptiveSampling(
+    const stroke_model::Result& result, float distance_from_previous,
+    float& max_turn_in_radians) const {
+  const ModeledStrokeInput& previous = modeled_inputs_.back();
+  if (distance_from_previous >=
+          kAdaptiveSamplingMaxSpacingInEpsilons * brush_epsilon_ ||
+      StylusStateChanged(previous, result)) {
+    return false;
+  }
+
+  // Without a direction of travel at both ends, we can't bound how far the
+  // modeled curve strays from the chord, so fall back to the epsilon spacing.
+  Vec velocity = {.x = result.velocity.x, .y = result.velocity.y};
+  if (velocity.MagnitudeSquared() == 0 ||
+      previous.velocity.MagnitudeSquared() == 0) {
+    return false;
+  }
+  max_turn_in_radians = std::max(
+      max_turn_in_radians,
+      Vec::AbsoluteAngleBetween(previous.velocity, velocity).ValueInRadians());
+
+  // A circular arc of length L that turns by an angle theta strays from its
+  // chord by about L * theta / 8. Requiring L * theta <= 4 * epsilon keeps that
+  // deviation to half the brush epsilon, leaving some slack for curves that
+  // aren't circular.
+  return distance_from_previous * max_turn_in_radians <= 4 * brush_epsilon_;
+}
+
+void StrokeInputModeler::StartStrokeFromModeledInputs(
+    const StrokeInputModeler& source, size_t start, size_t end) {
+  ABSL_CHECK_LT(start, end);
+  ABSL_CHECK_LE(end, source.modeled_inputs_.size());
+  StartStroke(source.input_model_, source.brush_epsilon_);
+  state_.tool_type = source.state_.tool_type;
+  state_.stroke_unit_length = source.state_.stroke_unit_length;
+
+  float start_distance = source.modeled_inputs_[start].traveled_distance;
+  modeled_inputs_.assign(source.modeled_inputs_.begin() + start,
+                         source.modeled_inputs_.begin() + end);
+  for (ModeledStrokeInput& input : modeled_inputs_) {
+    input.traveled_distance -= start_distance;
+  }
+  state_.stable_input_count = modeled_inputs_.size();
+  state_.real_input_count = modeled_inputs_.size();
+  UpdateStateTimeAndDistance(source.state_.complete_elapsed_time);
+}
+
+void StrokeInputModeler::CopyStateFrom(const StrokeInputModeler& other,
+                                       const StrokeInputBatch& real_inputs) {
+  input_model_ = other.input_model_;
+  brush_epsilon_ = other.brush_epsilon_;
+  last_real_stroke_input_ = other.last_real_stroke_input_;
+  last_real_input_ends_stroke_ = other.last_real_input_ends_stroke_;
+  modeled_inputs_ = other.modeled_inputs_;
+  state_ = other.state_;
+
+  // Until there is a real input, the stroke modeler is reset on every update.
+  stroke_modeler_has_input_ = false;
+  if (!last_real_stroke_input_.has_value()) return;
+
+  // Between updates, the stroke modeler has modeled every real input but the
+  // last one, which is always modeled again by the next update. See
+  // `ExtendStroke()`.
+  ABSL_CHECK(!real_inputs.IsEmpty());
+  ResetStrokeModeler(stroke_modeler_, input_model_, brush_epsilon_,
+                     real_inputs.GetStrokeUnitLength());
+  for (size_t i = 0; i + 1 < real_inputs.Size(); ++i) {
+    result_buffer_.clear();
+    ABSL_CHECK_OK(stroke_modeler_.Update(
+        MakeStrokeModelInput(real_inputs.Get(i),
+                             stroke_modeler_has_input_
+                                 ? stroke_model::Input::EventType::kMove
+                                 : stroke_model::Input::EventType::kDown),
+        result_buffer_));
+    stroke_modeler_has_input_ = true;
+  }
+  result_buffer_.clear();
+  ABSL_DCHECK_EQ(stroke_modeler_has_input_, other.stroke_modeler_has_input_);
+}
+
 void StrokeInputModeler::UpdateStateTimeAndDistance(
     Duration32 current_elapsed_time) {
   if (modeled_inputs_.empty()) {
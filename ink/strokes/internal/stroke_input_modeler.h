@@ -149,9 +149,41 @@ class StrokeInputModeler {
   // This always clears any previously generated unstable modeled inputs. Either
   // or both of `real_inputs` and `predicted_inputs` may be empty. CHECK-fails
   // if `StartStroke()` has not been called at least once.
+  //
+  // If `predicted_inputs` is empty and `prediction_horizon` is positive, the
+  // modeler instead predicts the continuation of the stroke itself, by
+  // extrapolating the position, velocity, and acceleration of the last modeled
+  // real input up to `prediction_horizon` past it. Like modeled predicted
+  // inputs, these are unstable, and come after `State::real_input_count`.
   void ExtendStroke(const StrokeInputBatch& real_inputs,
                     const StrokeInputBatch& predicted_inputs,
-                    Duration32 current_elapsed_time);
+                    Duration32 current_elapsed_time,
+                    Duration32 prediction_horizon = Duration32::Zero());
+
+  // Clears any ongoing stroke and replaces it with the modeled inputs of
+  // `source` in the index range [`start`, `end`), with their traveled distances
+  // rebased to start at zero. Their elapsed times are kept, as they are for the
+  // inputs that they were modeled from. All of them are stable and real. This
+  // lets part of an existing stroke be built without modeling its inputs
+  // again, e.g. when splitting a stroke.
+  //
+  // The input model, brush epsilon, tool type, and stroke unit length are
+  // copied from `source`. CHECK-fails unless `start < end` and `end` is at most
+  // the number of modeled inputs of `source`. The new stroke must not be
+  // extended with `ExtendStroke()` afterwards.
+  void StartStrokeFromModeledInputs(const StrokeInputModeler& source,
+                                    size_t start, size_t end);
+
+  // Replaces the current stroke with a copy of the stroke of `other`, which can
+  // then be extended independently of `other`. `real_inputs` must hold the real
+  // inputs passed to `other.ExtendStroke()` so far, in order.
+  //
+  // The underlying `stroke_model::StrokeModeler` can't be copied, so its state
+  // is rebuilt by running it over `real_inputs` again. This takes time
+  // proportional to their count, but skips everything else that modeling them
+  // involves, as the modeled inputs themselves are copied from `other`.
+  void CopyStateFrom(const StrokeInputModeler& other,
+                     const StrokeInputBatch& real_inputs);
 
   const State& GetState() const { return state_; }
   absl::Span<const ModeledStrokeInput> GetModeledInputs() const {
@@ -166,6 +198,19 @@ class StrokeInputModeler {
   // must always be "unstable".
   void ModelInput(const StrokeInput& input, bool last_input_in_update);
 
+  // Appends modeled inputs extrapolated from the last modeled input, up to
+  // `prediction_horizon` past it.
+  void AppendExtrapolatedInputs(Duration32 prediction_horizon);
+
+  // Returns true if `result`, which is `distance_from_previous` away from the
+  // last modeled input, should be dropped under
+  // `BrushFamily::ExperimentalAdaptiveSamplingModel`. Updates
+  // `max_turn_in_radians` with the direction change up to `result`, so that
+  // turns in dropped results are still accounted for by later results.
+  bool SkipForAdaptiveSampling(const stroke_model::Result& result,
+                               float distance_from_previous,
+                               float& max_turn_in_radians) const;
+
   // Updates `state_` elapsed time and distance properties.
   void UpdateStateTimeAndDistance(Duration32 current_elapsed_time);
 
@@ -178,6 +223,9 @@ class StrokeInputModeler {
   stroke_model::StrokeModeler stroke_modeler_;
   std::vector<stroke_model::Result> result_buffer_;
   std::optional<StrokeInput> last_real_stroke_input_;
+  // True if `last_real_stroke_input_` was last modeled as the end of the
+  // stroke, rather than followed by predicted or extrapolated inputs.
+  bool last_real_input_ends_stroke_ = true;
   // All modeled inputs for a stroke.
   std::vector<ModeledStrokeInput> modeled_inputs_;
   bool stroke_modeler_has_input_ = false;
@@ -14,6 +14,8 @@
 
 #include "ink/strokes/internal/stroke_input_modeler.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <optional>
 #include <vector>
@@ -22,8 +24,12 @@
 #include "gtest/gtest.h"
 #include "absl/log/absl_check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "ink/brush/brush_family.h"
 #include "ink/geometry/angle.h"
+#include "ink/geometry/distance.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/segment.h"
 #include "ink/geometry/type_matchers.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
@@ -39,6 +45,7 @@ using ::testing::ElementsAre;
 using ::testing::ExplainMatchResult;
 using ::testing::Field;
 using ::testing::FloatNear;
+using ::testing::Lt;
 using ::testing::Optional;
 
 // Returns a vector of single-input `StrokeInputBatch` that can be used for a
@@ -398,6 +405,190 @@ TEST(StrokeInputModelerTest, LargeBrushEpsilonIsRespected) {
               PositionsAreSeparatedByAtLeast(brush_epsilon));
 }
 
+// Returns a single `StrokeInputBatch` for a slow stylus stroke with a constant
+// pressure, that goes along a straight line and then along a half circle.
+StrokeInputBatch MakeSlowLineAndArcInputBatch() {
+  std::vector<StrokeInput> inputs;
+  auto add_input = [&inputs](Point position) {
+    inputs.push_back(
+        {.tool_type = StrokeInput::ToolType::kStylus,
+         .position = position,
+         .elapsed_time = Duration32::Seconds(0.05f * inputs.size()),
+         .stroke_unit_length = PhysicalDistance::Centimeters(0.1),
+         .pressure = 0.5});
+  };
+  for (int i = 0; i < 40; ++i) {
+    add_input({.x = 2.f * i, .y = 0});
+  }
+  constexpr float kRadius = 20;
+  for (int i = 1; i <= 40; ++i) {
+    float angle = 3.14159f * i / 40;
+    add_input({.x = 80 + kRadius * std::sin(angle),
+               .y = kRadius - kRadius * std::cos(angle)});
+  }
+  auto batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *batch;
+}
+
+std::vector<ModeledStrokeInput> ModelStroke(
+    const BrushFamily::InputModel& input_model, float brush_epsilon,
+    const StrokeInputBatch& inputs) {
+  StrokeInputModeler modeler;
+  modeler.StartStroke(input_model, brush_epsilon);
+  modeler.ExtendStroke(inputs, {}, inputs.Get(inputs.Size() - 1).elapsed_time);
+  absl::Span<const ModeledStrokeInput> modeled = modeler.GetModeledInputs();
+  return std::vector<ModeledStrokeInput>(modeled.begin(), modeled.end());
+}
+
+// Returns the distance from `point` to the polyline through the positions of
+// `polyline`.
+float DistanceToPolyline(Point point,
+                         const std::vector<ModeledStrokeInput>& polyline) {
+  float distance = Distance(point, polyline.front().position);
+  for (size_t i = 1; i < polyline.size(); ++i) {
+    distance = std::min(
+        distance, Distance(point, Segment{.start = polyline[i - 1].position,
+                                          .end = polyline[i].position}));
+  }
+  return distance;
+}
+
+TEST(StrokeInputModelerTest, AdaptiveSamplingModelUsesFewerInputs) {
+  StrokeInputBatch inputs = MakeSlowLineAndArcInputBatch();
+  float brush_epsilon = 0.1;
+  std::vector<ModeledStrokeInput> spring =
+      ModelStroke(BrushFamily::SpringModel{}, brush_epsilon, inputs);
+  std::vector<ModeledStrokeInput> adaptive = ModelStroke(
+      BrushFamily::ExperimentalAdaptiveSamplingModel{}, brush_epsilon, inputs);
+
+  ASSERT_FALSE(adaptive.empty());
+  EXPECT_THAT(adaptive.size(), Lt(spring.size() / 2));
+  EXPECT_THAT(adaptive, PositionsAreSeparatedByAtLeast(brush_epsilon));
+  // The ends of the stroke are kept.
+  EXPECT_THAT(adaptive.front().position,
+              PointNear(spring.front().position, 1e-5));
+  EXPECT_THAT(adaptive.back().position,
+              PointNear(spring.back().position, 1e-5));
+}
+
+TEST(StrokeInputModelerTest, AdaptiveSamplingModelStaysNearSpringModel) {
+  StrokeInputBatch inputs = MakeSlowLineAndArcInputBatch();
+  float brush_epsilon = 0.1;
+  std::vector<ModeledStrokeInput> spring =
+      ModelStroke(BrushFamily::SpringModel{}, brush_epsilon, inputs);
+  std::vector<ModeledStrokeInput> adaptive = ModelStroke(
+      BrushFamily::ExperimentalAdaptiveSamplingModel{}, brush_epsilon, inputs);
+
+  ASSERT_FALSE(adaptive.empty());
+  for (const ModeledStrokeInput& input : spring) {
+    EXPECT_THAT(DistanceToPolyline(input.position, adaptive),
+                Lt(2 * brush_epsilon))
+        << "at position " << input.position;
+  }
+}
+
+TEST(StrokeInputModelerTest, AdaptiveSamplingModelKeepsPressureChanges) {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 40; ++i) {
+    inputs.push_back({.tool_type = StrokeInput::ToolType::kStylus,
+                      .position = {.x = 2.f * i, .y = 0},
+                      .elapsed_time = Duration32::Seconds(0.05f * i),
+                      .pressure = 0.025f * i});
+  }
+  auto batch = StrokeInputBatch::Create(inputs);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+  std::vector<ModeledStrokeInput> adaptive = ModelStroke(
+      BrushFamily::ExperimentalAdaptiveSamplingModel{}, 0.1, *batch);
+
+  ASSERT_FALSE(adaptive.empty());
+  for (size_t i = 1; i < adaptive.size(); ++i) {
+    // Allow for a single result's worth of pressure change beyond the limit.
+    EXPECT_THAT(std::abs(adaptive[i].pressure - adaptive[i - 1].pressure),
+                Lt(0.05));
+  }
+}
+
+TEST(StrokeInputModelerTest, ExtendWithPredictionHorizonExtrapolates) {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 10; ++i) {
+    inputs.push_back({.tool_type = StrokeInput::ToolType::kStylus,
+                      .position = {.x = 1.f * i, .y = 0},
+                      .elapsed_time = Duration32::Millis(10 * i)});
+  }
+  auto batch = StrokeInputBatch::Create(inputs);
+  ASSERT_EQ(batch.status(), absl::OkStatus());
+
+  StrokeInputModeler modeler;
+  modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.01);
+  Duration32 horizon = Duration32::Millis(30);
+  modeler.ExtendStroke(*batch, {}, Duration32::Millis(90), horizon);
+
+  const StrokeInputModeler::State& state = modeler.GetState();
+  absl::Span<const ModeledStrokeInput> modeled = modeler.GetModeledInputs();
+  ASSERT_GT(modeled.size(), state.real_input_count);
+  const ModeledStrokeInput& last_real = modeled[state.real_input_count - 1];
+  for (size_t i = state.real_input_count; i < modeled.size(); ++i) {
+    EXPECT_GT(modeled[i].position.x, modeled[i - 1].position.x);
+    EXPECT_GT(modeled[i].elapsed_time, modeled[i - 1].elapsed_time);
+    EXPECT_LE(modeled[i].elapsed_time, last_real.elapsed_time + horizon);
+  }
+  EXPECT_THAT(modeled, PositionsAreSeparatedByAtLeast(0.01));
+
+  // Explicit predicted inputs take precedence over extrapolation.
+  auto predicted = StrokeInputBatch::Create(
+      {{.tool_type = StrokeInput::ToolType::kStylus,
+        .position = {.x = 9, .y = 5},
+        .elapsed_time = Duration32::Millis(100)}});
+  ASSERT_EQ(predicted.status(), absl::OkStatus());
+  modeler.ExtendStroke({}, *predicted, Duration32::Millis(90), horizon);
+  EXPECT_GT(modeler.GetModeledInputs().back().position.y, 0);
+
+  // Without a horizon, the stroke ends at the last real input.
+  modeler.ExtendStroke({}, {}, Duration32::Millis(90));
+  EXPECT_EQ(modeler.GetState().real_input_count,
+            modeler.GetModeledInputs().size());
+  EXPECT_THAT(modeler.GetModeledInputs().back().position,
+              PointNear({9, 0}, 0.01));
+}
+
+TEST(StrokeInputModelerTest, StartStrokeFromModeledInputsCopiesRange) {
+  std::vector<StrokeInputBatch> input_batches = MakeStylusInputBatchSequence();
+  StrokeInputModeler source;
+  source.StartStroke(BrushFamily::DefaultInputModel(), 0.01);
+  for (const StrokeInputBatch& batch : input_batches) {
+    source.ExtendStroke(batch, {}, Duration32::Infinite());
+  }
+  absl::Span<const ModeledStrokeInput> source_inputs =
+      source.GetModeledInputs();
+  ASSERT_GT(source_inputs.size(), 10u);
+  size_t start = 3;
+  size_t end = source_inputs.size() - 2;
+
+  StrokeInputModeler modeler;
+  modeler.StartStrokeFromModeledInputs(source, start, end);
+
+  const StrokeInputModeler::State& state = modeler.GetState();
+  absl::Span<const ModeledStrokeInput> modeled = modeler.GetModeledInputs();
+  ASSERT_EQ(modeled.size(), end - start);
+  EXPECT_EQ(state.tool_type, StrokeInput::ToolType::kStylus);
+  EXPECT_THAT(state.stroke_unit_length,
+              Optional(PhysicalDistanceEq(PhysicalDistance::Centimeters(1))));
+  EXPECT_EQ(state.stable_input_count, modeled.size());
+  EXPECT_EQ(state.real_input_count, modeled.size());
+  EXPECT_EQ(state.complete_elapsed_time, Duration32::Infinite());
+
+  // Positions and elapsed times are kept, and traveled distances start over.
+  float start_distance = source_inputs[start].traveled_distance;
+  for (size_t i = 0; i < modeled.size(); ++i) {
+    ModeledStrokeInput expected = source_inputs[start + i];
+    expected.traveled_distance -= start_distance;
+    EXPECT_THAT(modeled[i], ModeledStrokeInputNear(expected, 0.001));
+  }
+  EXPECT_FLOAT_EQ(state.total_real_distance, modeled.back().traveled_distance);
+  EXPECT_EQ(state.total_real_elapsed_time, modeled.back().elapsed_time);
+}
+
 TEST(StrokeInputModelerDeathTest, ExtendWithoutStart) {
   EXPECT_DEATH_IF_SUPPORTED(
       StrokeInputModeler().ExtendStroke({}, {}, Duration32::Zero()),
@@ -410,5 +601,13 @@ TEST(StrokeInputModelerDeathTest, StartWithZeroEpsilon) {
       "brush_epsilon");
 }
 
+TEST(StrokeInputModelerDeathTest, StartStrokeFromEmptyModeledInputs) {
+  StrokeInputModeler source;
+  source.StartStroke(BrushFamily::DefaultInputModel(), 0.01);
+  EXPECT_DEATH_IF_SUPPORTED(
+      StrokeInputModeler().StartStrokeFromModeledInputs(source, 0, 0),
+      "start < end");
+}
+
 }  // namespace
 }  // namespace ink::strokes_internal
@@ -26,6 +26,21 @@
 
 namespace ink::strokes_internal {
 
+StrokeOutline::StrokeOutline(const StrokeOutline& other) { *this = other; }
+
+StrokeOutline& StrokeOutline::operator=(const StrokeOutline& other) {
+  if (this == &other) return *this;
+  if (index_storage_.capacity != other.index_storage_.capacity) {
+    index_storage_.data = std::make_unique_for_overwrite<uint32_t[]>(
+        other.index_storage_.capacity);
+    index_storage_.capacity = other.index_storage_.capacity;
+  }
+  index_storage_.used_counts = other.index_storage_.used_counts;
+  absl::c_copy(other.index_storage_.UsedSpan(),
+               index_storage_.UsedSpan().begin());
+  return *this;
+}
+
 void StrokeOutline::GrowIndexStorage(IndexCounts new_index_counts) {
   StrokeOutline::IndexCounts current_counts = index_storage_.used_counts;
   size_t minimum_new_capacity =
@@ -43,9 +43,11 @@ class StrokeOutline {
   };
 
   StrokeOutline() = default;
-  StrokeOutline(const StrokeOutline&) = delete;
+  // Copies the indices into storage of the same capacity, which is only
+  // reallocated if the capacities differ.
+  StrokeOutline(const StrokeOutline& other);
   StrokeOutline(StrokeOutline&&) = default;
-  StrokeOutline& operator=(const StrokeOutline&) = delete;
+  StrokeOutline& operator=(const StrokeOutline& other);
   StrokeOutline& operator=(StrokeOutline&&) = default;
   ~StrokeOutline() = default;
 
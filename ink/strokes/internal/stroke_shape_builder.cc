@@ -14,67 +14,178 @@
 
 #include "ink/strokes/internal/stroke_shape_builder.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 
+#include "absl/base/nullability.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush_coat.h"
-#include "ink/brush/brush_family.h"
-#include "ink/brush/brush_paint.h"
-#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/internal/circle.h"
 #include "ink/strokes/internal/brush_tip_extruder.h"
 #include "ink/strokes/internal/brush_tip_modeler.h"
+#include "ink/strokes/internal/brush_tip_state.h"
+#include "ink/strokes/internal/particle_stamps.h"
+#include "ink/strokes/internal/stroke_input_modeler.h"
 #include "ink/strokes/internal/stroke_outline.h"
+#include "ink/strokes/internal/stroke_shape_stats_timer.h"
 #include "ink/strokes/internal/stroke_shape_update.h"
+#include "ink/strokes/stroke_shape_budget.h"
+#include "ink/strokes/stroke_shape_stats.h"
+#include "ink/types/cancellation_token.h"
 #include "ink/types/duration.h"
 
 namespace ink::strokes_internal {
 namespace {
 
-bool IsStampingTextureCoat(const BrushCoat& coat) {
-  // We can only handle stamping textures when there is a single texture layer.
-  return coat.paint.texture_layers.size() == 1 &&
-         coat.paint.texture_layers[0].mapping ==
-             BrushPaint::TextureMapping::kStamping;
+// Returns true if `tip` emits discrete particles rather than continuous
+// geometry.
+bool EmitsParticles(const BrushTip& tip) {
+  return tip.particle_gap_distance_scale != 0 ||
+         tip.particle_gap_duration != Duration32::Zero();
 }
 
-}  // namespace
+// Returns the estimated number of vertices in each end cap of a stroke drawn
+// with `tip`, which is the number of points on half of the tip's bounding
+// circle at the resolution used by `BrushTipExtruder`. Returns zero for tips
+// that emit particles, whose geometry depends on more than the input count.
+uint32_t EstimateCapVertexCount(const BrushTip& tip, float brush_size,
+                                float brush_epsilon) {
+  if (EmitsParticles(tip)) return 0;
+  geometry_internal::Circle bounding_circle(
+      {0, 0}, 0.5f * brush_size * std::max(tip.scale.x, tip.scale.y));
+  Angle step = bounding_circle.GetArcAngleForChordHeight(brush_epsilon);
+  if (step <= Angle()) return 1;
+  return static_cast<uint32_t>(std::clamp<float>(
+      std::ceil(kHalfTurn / step), 1, std::numeric_limits<int16_t>::max()));
+}
 
-void StrokeShapeBuilder::StartStroke(const BrushFamily::InputModel& input_model,
-                                     const BrushCoat& coat, float brush_size,
-                                     float brush_epsilon, uint32_t noise_seed) {
-  // The `input_modeler_`, `tip_modeler_` and `tip_extruder_` CHECK-validate
-  // `brush_tip` being not null, and `brush_size` and `brush_epsilon` being
-  // greater than zero.
-  input_modeler_.StartStroke(input_model, brush_epsilon);
+// The number of new fixed tip states that `ExtendStroke()` extrudes between
+// checks for cancellation.
+constexpr size_t kTipStatesPerCancellationCheck = 256;
+
+}  // namespace
 
+void StrokeShapeBuilder::StartStroke(const BrushCoat& coat, float brush_size,
+                                     float brush_epsilon, uint32_t noise_seed,
+                                     const StrokeShapeBudget& budget,
+                                     bool separate_volatile_geometry) {
+  // The `tip_.modeler` and `tip_.extruder` CHECK-validate `brush_tip` being not
+  // null, and `brush_size` and `brush_epsilon` being greater than zero.
   mesh_bounds_.Reset();
+  last_update_stats_ = {};
   outlines_.clear();
 
-  bool is_stamping_texture_brush = IsStampingTextureCoat(coat);
-  bool is_stamping_texture_particle_brush =
-      is_stamping_texture_brush &&
-      (coat.tip.particle_gap_distance_scale != 0 ||
-       coat.tip.particle_gap_duration != Duration32::Zero());
+  brush_epsilon_ = brush_epsilon;
+  is_stamping_texture_particle_brush_ = IsStampingParticleCoat(coat);
+  emits_particles_ = EmitsParticles(coat.tip);
+  separate_volatile_geometry_ = separate_volatile_geometry;
   tip_.modeler.StartStroke(&coat.tip, brush_size, noise_seed);
-  tip_.extruder.StartStroke(brush_epsilon, is_stamping_texture_particle_brush,
+  tip_.extruder.SetBudget(budget);
+  tip_.extruder.StartStroke(brush_epsilon, is_stamping_texture_particle_brush_,
                             mesh_);
+
+  volatile_mesh_.Clear();
+  volatile_mesh_bounds_.Reset();
+  volatile_outlines_.clear();
+  last_fixed_tip_state_.reset();
+  volatile_extruder_.SetBudget(budget);
+  estimated_cap_vertex_count_ =
+      EstimateCapVertexCount(coat.tip, brush_size, brush_epsilon);
+}
+
+void StrokeShapeBuilder::CopyStateFrom(const StrokeShapeBuilder& other,
+                                       const BrushCoat& coat) {
+  mesh_ = other.mesh_.Clone();
+  mesh_bounds_ = other.mesh_bounds_;
+  tip_.modeler.CopyStateFrom(other.tip_.modeler, &coat.tip);
+  tip_.extruder.CopyStateFrom(other.tip_.extruder, mesh_);
+  outlines_.clear();
+  for (const StrokeOutline& outline : tip_.extruder.GetOutlines()) {
+    absl::Span<const uint32_t> indices = outline.GetIndices();
+    if (!indices.empty()) outlines_.push_back(indices);
+  }
+
+  volatile_mesh_ = other.volatile_mesh_.Clone();
+  volatile_mesh_bounds_ = other.volatile_mesh_bounds_;
+  volatile_extruder_.CopyStateFrom(other.volatile_extruder_, volatile_mesh_);
+  volatile_outlines_.clear();
+  for (const StrokeOutline& outline : volatile_extruder_.GetOutlines()) {
+    absl::Span<const uint32_t> indices = outline.GetIndices();
+    if (!indices.empty()) volatile_outlines_.push_back(indices);
+  }
+  last_fixed_tip_state_ = other.last_fixed_tip_state_;
+
+  brush_epsilon_ = other.brush_epsilon_;
+  is_stamping_texture_particle_brush_ =
+      other.is_stamping_texture_particle_brush_;
+  emits_particles_ = other.emits_particles_;
+  separate_volatile_geometry_ = other.separate_volatile_geometry_;
+  last_update_stats_ = other.last_update_stats_;
+  estimated_cap_vertex_count_ = other.estimated_cap_vertex_count_;
+}
+
+void StrokeShapeBuilder::ReserveForModeledInputCount(
+    size_t modeled_input_count) {
+  if (estimated_cap_vertex_count_ == 0) return;
+  // Continuous extrusion adds about one vertex on each side of the stroke per
+  // modeled input, plus the vertices of the two end caps, and about one
+  // triangle per vertex.
+  uint32_t vertex_count = std::min<size_t>(
+      2 * modeled_input_count + 2 * estimated_cap_vertex_count_,
+      std::numeric_limits<uint32_t>::max());
+  mesh_.Reserve(vertex_count, vertex_count);
 }
 
 StrokeShapeUpdate StrokeShapeBuilder::ExtendStroke(
-    const StrokeInputBatch& real_inputs,
-    const StrokeInputBatch& predicted_inputs, Duration32 current_elapsed_time) {
-  input_modeler_.ExtendStroke(real_inputs, predicted_inputs,
-                              current_elapsed_time);
+    const StrokeInputModeler& input_modeler,
+    const CancellationToken* absl_nullable cancellation) {
   StrokeShapeUpdate update;
   mesh_bounds_.Reset();
 
   outlines_.clear();
   BrushTipModeler& tip_modeler = tip_.modeler;
   BrushTipExtruder& tip_extruder = tip_.extruder;
-  tip_modeler.UpdateStroke(input_modeler_.GetState(),
-                           input_modeler_.GetModeledInputs());
-  update.Add(tip_extruder.ExtendStroke(tip_modeler.NewFixedTipStates(),
-                                       tip_modeler.VolatileTipStates()));
+  int64_t tip_modeling_nanos = 0;
+  {
+    ScopedStatsTimer timer(tip_modeling_nanos);
+    tip_modeler.UpdateStroke(input_modeler.GetState(),
+                             input_modeler.GetModeledInputs());
+  }
+  absl::Span<const BrushTipState> new_fixed_states =
+      tip_modeler.NewFixedTipStates();
+  last_update_stats_ = {};
+  // Without a cancellation token, all of the tip states are extruded at once.
+  // Otherwise, leading chunks of the new fixed states are extruded on their
+  // own first, as successive incremental updates would, so that cancellation
+  // can be checked in between.
+  while (cancellation != nullptr &&
+         new_fixed_states.size() > kTipStatesPerCancellationCheck) {
+    if (cancellation->IsCancelled()) break;
+    update.Add(tip_extruder.ExtendStroke(
+        new_fixed_states.subspan(0, kTipStatesPerCancellationCheck), {}));
+    last_update_stats_.Add(tip_extruder.GetLastUpdateStats());
+    new_fixed_states.remove_prefix(kTipStatesPerCancellationCheck);
+  }
+  if (cancellation == nullptr || !cancellation->IsCancelled()) {
+    if (separate_volatile_geometry_) {
+      update.Add(tip_extruder.ExtendStroke(new_fixed_states, {}));
+      last_update_stats_.Add(tip_extruder.GetLastUpdateStats());
+      if (!new_fixed_states.empty()) {
+        last_fixed_tip_state_ = new_fixed_states.back();
+      }
+      update.Add(ReplaceVolatileGeometry(tip_modeler.VolatileTipStates()));
+    } else {
+      update.Add(tip_extruder.ExtendStroke(new_fixed_states,
+                                           tip_modeler.VolatileTipStates()));
+      last_update_stats_.Add(tip_extruder.GetLastUpdateStats());
+    }
+  }
+  last_update_stats_.tip_modeling_nanos = tip_modeling_nanos;
   mesh_bounds_.Add(tip_extruder.GetBounds());
   for (const StrokeOutline& outline : tip_extruder.GetOutlines()) {
     const absl::Span<const uint32_t>& indices = outline.GetIndices();
@@ -86,8 +197,42 @@ StrokeShapeUpdate StrokeShapeBuilder::ExtendStroke(
   return update;
 }
 
-bool StrokeShapeBuilder::HasUnfinishedTimeBehaviors() const {
-  return tip_.modeler.HasUnfinishedTimeBehaviors(input_modeler_.GetState());
+StrokeShapeUpdate StrokeShapeBuilder::ReplaceVolatileGeometry(
+    absl::Span<const BrushTipState> volatile_states) {
+  StrokeShapeUpdate update;
+  update.region.Add(volatile_mesh_bounds_);
+  volatile_mesh_bounds_.Reset();
+  volatile_outlines_.clear();
+  volatile_extruder_.StartStroke(
+      brush_epsilon_, is_stamping_texture_particle_brush_, volatile_mesh_);
+  if (volatile_states.empty()) return update;
+
+  // Particles are stamped independently, so only continuous geometry needs to
+  // start from the last fixed state. Restarting the extruder on every update
+  // means the volatile states can be extruded as fixed ones.
+  volatile_tip_states_.clear();
+  if (!emits_particles_ && last_fixed_tip_state_.has_value()) {
+    volatile_tip_states_.push_back(*last_fixed_tip_state_);
+  }
+  volatile_tip_states_.insert(volatile_tip_states_.end(),
+                              volatile_states.begin(), volatile_states.end());
+  volatile_extruder_.ExtendStroke(volatile_tip_states_, {});
+  last_update_stats_.Add(volatile_extruder_.GetLastUpdateStats());
+
+  volatile_mesh_bounds_.Add(volatile_extruder_.GetBounds());
+  update.region.Add(volatile_mesh_bounds_);
+  for (const StrokeOutline& outline : volatile_extruder_.GetOutlines()) {
+    const absl::Span<const uint32_t>& indices = outline.GetIndices();
+    if (!indices.empty()) {
+      volatile_outlines_.push_back(indices);
+    }
+  }
+  return update;
+}
+
+bool StrokeShapeBuilder::HasUnfinishedTimeBehaviors(
+    const StrokeInputModeler& input_modeler) const {
+  return tip_.modeler.HasUnfinishedTimeBehaviors(input_modeler.GetState());
 }
 
 }  // namespace ink::strokes_internal
@@ -15,26 +15,38 @@
 #ifndef INK_STROKES_INTERNAL_STROKE_SHAPE_BUILDER_H_
 #define INK_STROKES_INTERNAL_STROKE_SHAPE_BUILDER_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <vector>
 
+#include "absl/base/nullability.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush_coat.h"
-#include "ink/brush/brush_family.h"
 #include "ink/geometry/envelope.h"
 #include "ink/geometry/mutable_mesh.h"
-#include "ink/strokes/input/stroke_input_batch.h"
 #include "ink/strokes/internal/brush_tip_extruder.h"
 #include "ink/strokes/internal/brush_tip_modeler.h"
+#include "ink/strokes/internal/brush_tip_state.h"
 #include "ink/strokes/internal/stroke_input_modeler.h"
 #include "ink/strokes/internal/stroke_shape_update.h"
 #include "ink/strokes/internal/stroke_vertex.h"
-#include "ink/types/duration.h"
+#include "ink/strokes/stroke_shape_budget.h"
+#include "ink/strokes/stroke_shape_stats.h"
+#include "ink/types/cancellation_token.h"
 
 namespace ink::strokes_internal {
 
-// A `StrokeShapeBuilder` handles the end-to-end operation of turning
-// `StrokeInput` and `Brush` into a `MutableMesh` with associated outlines.
+// A `StrokeShapeBuilder` handles the operation of turning the modeled inputs
+// of a `StrokeInputModeler` and one `BrushCoat` into a `MutableMesh` with
+// associated outlines.
+//
+// Input modeling depends only on the `BrushFamily::InputModel` and brush
+// epsilon, which are shared by every coat of a brush. The `StrokeInputModeler`
+// is therefore owned by the caller, so that a brush with multiple coats only
+// models its inputs once per update, and the same modeler is passed to the
+// `StrokeShapeBuilder` for each coat.
 //
 // It is a distinct type from the public `InProgressStroke` because unlike that
 // type, the `StrokeShapeBuilder`:
@@ -64,27 +76,61 @@ class StrokeShapeBuilder {
   // duration of the stroke. `brush_size` and `brush_epsilon` must be greater
   // than zero. See also `Brush::Create()` for detailed documentation. This
   // function must be called before calling `ExtendStroke()`.
-  void StartStroke(const BrushFamily::InputModel& input_model,
-                   const BrushCoat& coat, float brush_size, float brush_epsilon,
-                   uint32_t noise_seed = 0);
+  //
+  // The geometry and work of the stroke are limited by `budget`, which is
+  // unlimited by default.
+  //
+  // If `separate_volatile_geometry` is true, the geometry of volatile tip
+  // states is kept out of `GetMesh()` and extruded into the separate, small
+  // mesh returned by `GetVolatileMesh()` instead. See `GetVolatileMesh()`.
+  void StartStroke(const BrushCoat& coat, float brush_size, float brush_epsilon,
+                   uint32_t noise_seed = 0,
+                   const StrokeShapeBudget& budget = {},
+                   bool separate_volatile_geometry = false);
+
+  // Replaces the current stroke with a copy of the stroke of `other`, including
+  // its meshes, outlines, and the state of its tip modeler and extruders, so
+  // that it can be extended independently of `other`. The next call to
+  // `ExtendStroke()` must pass a copy of the input modeler used with `other`;
+  // see `StrokeInputModeler::CopyStateFrom()`.
+  //
+  // `other` must have been started, and `coat` must be equal to the coat it was
+  // started with, e.g. the same coat of a copy of the brush. As with
+  // `StartStroke()`, `coat` must remain valid for the duration of the stroke.
+  void CopyStateFrom(const StrokeShapeBuilder& other, const BrushCoat& coat);
 
-  // Adds new incremental real and predicted inputs to the current stroke.
+  // Updates the current stroke geometry using the current state and modeled
+  // inputs of `input_modeler`.
+  //
+  // The `input_modeler` must have been started with the same brush epsilon
+  // passed to `StartStroke()`, and must be the same modeler for every call to
+  // this function over the course of a stroke. It is expected to have been
+  // extended with any new inputs since the previous call to this function.
   //
-  // The `real_inputs` and `predicted_inputs` parameters must have already been
-  // checked to form a valid input sequence together with any previously
-  // passed-in inputs for the current stroke.
+  // If `cancellation` is non-null, it is checked between chunks of extruded
+  // tip states, and the update stops early once it is cancelled. The geometry
+  // of a cancelled update is incomplete, and the stroke must be restarted
+  // before it is used again.
+  StrokeShapeUpdate ExtendStroke(
+      const StrokeInputModeler& input_modeler,
+      const CancellationToken* absl_nullable cancellation = nullptr);
+
+  // Reserves mesh capacity for the estimated geometry of the current stroke
+  // once it has `modeled_input_count` modeled inputs, based on the brush size
+  // and epsilon passed to `StartStroke()`. This must be called after
+  // `StartStroke()`, and is only a hint: it does not affect the resulting
+  // geometry, and does nothing for coats that emit particles.
   //
-  // The `current_elapsed_time` should be the duration from the start of the
-  // stroke until "now". The `elapsed_time` of inputs may be "in the future"
-  // relative to this duration.
-  StrokeShapeUpdate ExtendStroke(const StrokeInputBatch& real_inputs,
-                                 const StrokeInputBatch& predicted_inputs,
-                                 Duration32 current_elapsed_time);
+  // This is meant for callers that know all of the inputs of a stroke up
+  // front. Calling it on every incremental update would defeat the geometric
+  // growth of the mesh's buffers.
+  void ReserveForModeledInputCount(size_t modeled_input_count);
 
   // Returns true if the `BrushTip` for this builder has any behaviors whose
   // source values could continue to change with the further passage of time
   // (even in the absence of any new inputs).
-  bool HasUnfinishedTimeBehaviors() const;
+  bool HasUnfinishedTimeBehaviors(
+      const StrokeInputModeler& input_modeler) const;
 
   const MutableMesh& GetMesh() const;
 
@@ -97,8 +143,40 @@ class StrokeShapeBuilder {
   // public `InProgressStroke::GetCoatOutlines()` for more details.
   absl::Span<const absl::Span<const uint32_t>> GetOutlines() const;
 
+  // Returns true if any limit of the budget passed to `StartStroke()` has been
+  // reached during the current stroke.
+  bool ExceededBudget() const;
+
+  // Returns true if the current stroke was started with
+  // `separate_volatile_geometry`.
+  bool SeparatesVolatileGeometry() const;
+
+  // Returns the geometry of the volatile tip states of the current stroke if it
+  // separates volatile geometry, or an empty mesh otherwise. In that case,
+  // `GetMesh()` only ever grows by fixed tip states, which rarely changes its
+  // existing vertices and triangles, while this mesh is rebuilt from scratch on
+  // every call to `ExtendStroke()`. For continuous coats, it starts from the
+  // last fixed tip state, so that it overlaps the end of `GetMesh()` and the
+  // two can be drawn on top of each other without a gap.
+  //
+  // The returned outlines index into `GetVolatileMesh()`, and the updated
+  // region returned by `ExtendStroke()` includes both the previous and the new
+  // bounds of this mesh.
+  const MutableMesh& GetVolatileMesh() const;
+  const Envelope& GetVolatileMeshBounds() const;
+  absl::Span<const absl::Span<const uint32_t>> GetVolatileOutlines() const;
+
+  // Returns the stats collected by the most recent call to `ExtendStroke()`.
+  // The input modeling time is always zero, as inputs are modeled by the
+  // caller. See also `kStrokeShapeStatsEnabled`.
+  const StrokeShapeStats& GetLastUpdateStats() const;
+
  private:
-  StrokeInputModeler input_modeler_;
+  // Rebuilds `volatile_mesh_` and `volatile_outlines_` from `volatile_states`,
+  // and returns the region covering the old and new volatile geometry.
+  StrokeShapeUpdate ReplaceVolatileGeometry(
+      absl::Span<const BrushTipState> volatile_states);
+
   MutableMesh mesh_;
   Envelope mesh_bounds_;
 
@@ -114,13 +192,37 @@ class StrokeShapeBuilder {
 
   // The modeler/extruder for the brush tip.
   BrushTipModelerAndExtruder tip_;
+
+  // The mesh, outlines, and extruder for the volatile tip states, which are
+  // only used if `separate_volatile_geometry_` is true. The extruder is
+  // restarted on every call to `ExtendStroke()`, and `volatile_tip_states_` is
+  // kept as a member to reuse its allocation.
+  MutableMesh volatile_mesh_;
+  Envelope volatile_mesh_bounds_;
+  absl::InlinedVector<absl::Span<const uint32_t>, 1> volatile_outlines_;
+  BrushTipExtruder volatile_extruder_;
+  std::vector<BrushTipState> volatile_tip_states_;
+  // The last fixed tip state extruded into `mesh_`, which starts the volatile
+  // geometry of continuous coats.
+  std::optional<BrushTipState> last_fixed_tip_state_;
+  float brush_epsilon_ = 0;
+  bool is_stamping_texture_particle_brush_ = false;
+  bool emits_particles_ = false;
+  bool separate_volatile_geometry_ = false;
+
+  StrokeShapeStats last_update_stats_;
+
+  // The estimated number of vertices in each end cap of the current stroke, or
+  // zero if its geometry isn't estimated by `ReserveForModeledInputCount()`.
+  uint32_t estimated_cap_vertex_count_ = 0;
 };
 
 // ---------------------------------------------------------------------------
 //                     Implementation details below
 
 inline StrokeShapeBuilder::StrokeShapeBuilder()
-    : mesh_(StrokeVertex::FullMeshFormat()) {}
+    : mesh_(StrokeVertex::FullMeshFormat()),
+      volatile_mesh_(StrokeVertex::FullMeshFormat()) {}
 
 inline const MutableMesh& StrokeShapeBuilder::GetMesh() const { return mesh_; }
 
@@ -133,6 +235,32 @@ StrokeShapeBuilder::GetOutlines() const {
   return outlines_;
 }
 
+inline bool StrokeShapeBuilder::ExceededBudget() const {
+  return tip_.extruder.ExceededBudget() ||
+         (separate_volatile_geometry_ && volatile_extruder_.ExceededBudget());
+}
+
+inline bool StrokeShapeBuilder::SeparatesVolatileGeometry() const {
+  return separate_volatile_geometry_;
+}
+
+inline const MutableMesh& StrokeShapeBuilder::GetVolatileMesh() const {
+  return volatile_mesh_;
+}
+
+inline const Envelope& StrokeShapeBuilder::GetVolatileMeshBounds() const {
+  return volatile_mesh_bounds_;
+}
+
+inline absl::Span<const absl::Span<const uint32_t>>
+StrokeShapeBuilder::GetVolatileOutlines() const {
+  return volatile_outlines_;
+}
+
+inline const StrokeShapeStats& StrokeShapeBuilder::GetLastUpdateStats() const {
+  return last_update_stats_;
+}
+
 }  // namespace ink::strokes_internal
 
 #endif  // INK_STROKES_INTERNAL_STROKE_SHAPE_BUILDER_H_
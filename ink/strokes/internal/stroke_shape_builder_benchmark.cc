@@ -12,12 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
 #include "absl/log/absl_check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "benchmark/benchmark.h"
 #include "ink/brush/brush.h"
 #include "ink/brush/brush_behavior.h"
@@ -27,13 +31,17 @@
 #include "ink/brush/easing_function.h"
 #include "ink/color/color.h"
 #include "ink/geometry/angle.h"
+#include "ink/geometry/distance.h"
 #include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
 #include "ink/strokes/input/recorded_test_inputs.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/stroke_input_modeler.h"
 #include "ink/strokes/internal/stroke_shape_builder.h"
 #include "ink/strokes/internal/stroke_shape_update.h"
 #include "ink/types/duration.h"
+#include "ink/types/internal/allocation_counter.h"
 
 namespace ink::strokes_internal {
 namespace {
@@ -45,15 +53,18 @@ namespace {
 void BuildStrokeShapeIncrementally(
     const Brush& brush,
     const std::vector<std::pair<StrokeInputBatch, StrokeInputBatch>>& inputs,
-    StrokeShapeBuilder& builder) {
+    StrokeInputModeler& input_modeler, StrokeShapeBuilder& builder) {
   ABSL_CHECK_EQ(brush.CoatCount(), 1u);
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush.GetCoats()[0],
-                      brush.GetSize(), brush.GetEpsilon());
+  input_modeler.StartStroke(brush.GetFamily().GetInputModel(),
+                            brush.GetEpsilon());
+  builder.StartStroke(brush.GetCoats()[0], brush.GetSize(),
+                      brush.GetEpsilon());
   benchmark::DoNotOptimize(builder);
   for (const auto& [real_inputs, predicted_inputs] : inputs) {
-    StrokeShapeUpdate update = builder.ExtendStroke(
+    input_modeler.ExtendStroke(
         real_inputs, predicted_inputs,
         real_inputs.Get(real_inputs.Size() - 1).elapsed_time);
+    StrokeShapeUpdate update = builder.ExtendStroke(input_modeler);
     benchmark::DoNotOptimize(builder);
     benchmark::DoNotOptimize(update);
   }
@@ -68,21 +79,25 @@ void BuildStrokeShapeIncrementally(
 void BuildStrokeShapeIncrementally(
     const Brush& brush,
     const std::vector<std::pair<StrokeInputBatch, StrokeInputBatch>>& inputs) {
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
   benchmark::DoNotOptimize(builder);
-  BuildStrokeShapeIncrementally(brush, inputs, builder);
+  BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
 }
 
 // Starts a new stroke on the passed in builder and adds StrokeInputBatch.
 void BuildStrokeShapeAllAtOnce(const Brush& brush,
                                const StrokeInputBatch& inputs,
+                               StrokeInputModeler& input_modeler,
                                StrokeShapeBuilder& builder) {
   benchmark::DoNotOptimize(builder);
   ABSL_CHECK_EQ(brush.CoatCount(), 1u);
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush.GetCoats()[0],
-                      brush.GetSize(), brush.GetEpsilon());
-  StrokeShapeUpdate update =
-      builder.ExtendStroke(inputs, {}, Duration32::Infinite());
+  input_modeler.StartStroke(brush.GetFamily().GetInputModel(),
+                            brush.GetEpsilon());
+  builder.StartStroke(brush.GetCoats()[0], brush.GetSize(),
+                      brush.GetEpsilon());
+  input_modeler.ExtendStroke(inputs, {}, Duration32::Infinite());
+  StrokeShapeUpdate update = builder.ExtendStroke(input_modeler);
   benchmark::DoNotOptimize(update);
 }
 
@@ -93,9 +108,10 @@ void BuildStrokeShapeAllAtOnce(const Brush& brush,
 // that combines all Input count for this stroke.
 void BuildStrokeShapeAllAtOnce(const Brush& brush,
                                const StrokeInputBatch& inputs) {
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
   benchmark::DoNotOptimize(builder);
-  BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
 }
 
 Brush MakeDefaultBrush(float size, float epsilon) {
@@ -106,6 +122,17 @@ Brush MakeDefaultBrush(float size, float epsilon) {
   return *std::move(brush);
 }
 
+Brush MakeDefaultBrushWithInputModel(
+    float size, float epsilon, const BrushFamily::InputModel& input_model) {
+  absl::StatusOr<BrushFamily> family =
+      BrushFamily::Create(BrushTip{}, BrushPaint{}, "", input_model);
+  ABSL_CHECK_OK(family);
+  Color color;
+  absl::StatusOr<Brush> brush = Brush::Create(*family, color, size, epsilon);
+  ABSL_CHECK_OK(brush);
+  return *std::move(brush);
+}
+
 Brush MakeSingleBehaviorBrush(float size, float epsilon) {
   BrushTip tip = {
       .scale = {1, 1},
@@ -205,6 +232,65 @@ Brush MakeMultiBehaviorBrush(float size, float epsilon) {
   return *std::move(brush);
 }
 
+// Makes a brush that tapers the end of the stroke, which keeps the most recent
+// stable tip states volatile, along with damped and noisy behaviors that do not
+// depend on the end of the stroke.
+Brush MakeTaperedDampedBehaviorBrush(float size, float epsilon) {
+  BrushTip tip = {
+      .scale = {1, 1},
+      .corner_rounding = 1,
+      .behaviors = {
+          BrushBehavior{{
+              BrushBehavior::SourceNode{
+                  .source = BrushBehavior::Source::
+                      kDistanceRemainingInMultiplesOfBrushSize,
+                  .source_value_range = {0, 5},
+              },
+              BrushBehavior::TargetNode{
+                  .target = BrushBehavior::Target::kSizeMultiplier,
+                  .target_modifier_range = {0.2, 1},
+              },
+          }},
+          BrushBehavior{{
+              BrushBehavior::SourceNode{
+                  .source = BrushBehavior::Source::
+                      kSpeedInMultiplesOfBrushSizePerSecond,
+                  .source_value_range = {0, 20},
+              },
+              BrushBehavior::DampingNode{
+                  .damping_source =
+                      BrushBehavior::DampingSource::kTimeInSeconds,
+                  .damping_gap = 0.25,
+              },
+              BrushBehavior::ResponseNode{
+                  .response_curve = {EasingFunction::Predefined::kEaseInOut},
+              },
+              BrushBehavior::TargetNode{
+                  .target = BrushBehavior::Target::kWidthMultiplier,
+                  .target_modifier_range = {0.5, 1.5},
+              },
+          }},
+          BrushBehavior{{
+              BrushBehavior::NoiseNode{
+                  .seed = 12345,
+                  .vary_over = BrushBehavior::DampingSource::
+                      kDistanceInMultiplesOfBrushSize,
+                  .base_period = 2,
+              },
+              BrushBehavior::TargetNode{
+                  .target = BrushBehavior::Target::kHueOffsetInRadians,
+                  .target_modifier_range = {0, kHalfTurn.ValueInRadians()},
+              },
+          }}}};
+  absl::StatusOr<BrushFamily> family =
+      BrushFamily::Create(tip, BrushPaint{}, "");
+  ABSL_CHECK_OK(family);
+  Color color;
+  absl::StatusOr<Brush> brush = Brush::Create(*family, color, size, epsilon);
+  ABSL_CHECK_OK(brush);
+  return *std::move(brush);
+}
+
 StrokeInputBatch MakeSyntheticStraightLineInputs(
     const Rect& bounds, int input_count, Duration32 full_stroke_duration) {
   Duration32 time_per_input = full_stroke_duration / input_count;
@@ -223,6 +309,28 @@ StrokeInputBatch MakeSyntheticStraightLineInputs(
   return *std::move(result);
 }
 
+// Returns the inputs of `MakeSyntheticStraightLineInputs()` split into batches
+// of `inputs_per_batch` real inputs each, without any predicted inputs.
+std::vector<std::pair<StrokeInputBatch, StrokeInputBatch>>
+MakeSyntheticIncrementalStraightLineInputs(const Rect& bounds, int input_count,
+                                           Duration32 full_stroke_duration,
+                                           int inputs_per_batch) {
+  StrokeInputBatch all_inputs = MakeSyntheticStraightLineInputs(
+      bounds, input_count, full_stroke_duration);
+  std::vector<std::pair<StrokeInputBatch, StrokeInputBatch>> batches;
+  for (int start = 0; start < input_count; start += inputs_per_batch) {
+    std::vector<StrokeInput> inputs;
+    for (int i = start; i < std::min(start + inputs_per_batch, input_count);
+         ++i) {
+      inputs.push_back(all_inputs.Get(i));
+    }
+    absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+    ABSL_CHECK_OK(batch);
+    batches.emplace_back(*std::move(batch), StrokeInputBatch());
+  }
+  return batches;
+}
+
 // ********************** Benchmark Tests **********************************
 //
 // For the following tests that have meaningful input (not empty or dot) the
@@ -236,6 +344,7 @@ StrokeInputBatch MakeSyntheticStraightLineInputs(
 // Empty input.
 void BM_Empty(benchmark::State& state) {
   Brush brush = MakeDefaultBrush(20, 0.05);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(brush, StrokeInputBatch());
   }
@@ -253,6 +362,7 @@ void BM_Dot(benchmark::State& state) {
                                  .orientation = 1.5 * kHalfTurn}});
   ABSL_CHECK_OK(dot_input);
   Brush brush = MakeDefaultBrush(20, 0.05);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(brush, *dot_input);
   }
@@ -266,6 +376,7 @@ void BM_StraightLineIncremental(benchmark::State& state) {
   auto inputs = MakeIncrementalStraightLineInputs(bounds);
   Brush brush = MakeDefaultBrush(20, 0.05);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(inputs.size()))
     BuildStrokeShapeIncrementally(brush, inputs);
 }
@@ -275,12 +386,14 @@ void BM_StraightLineIncrementalPrewarmed(benchmark::State& state) {
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   auto inputs = MakeIncrementalStraightLineInputs(bounds);
   Brush brush = MakeDefaultBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeIncrementally(brush, inputs, builder);
+  BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(inputs.size())) {
-    BuildStrokeShapeIncrementally(brush, inputs, builder);
+    BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
   }
 }
 BENCHMARK(BM_StraightLineIncrementalPrewarmed);
@@ -290,6 +403,7 @@ void BM_StraightLineComplete(benchmark::State& state) {
   StrokeInputBatch inputs = MakeCompleteStraightLineInputs(bounds);
   Brush brush = MakeDefaultBrush(20, 0.05);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(brush, inputs);
   }
@@ -301,23 +415,48 @@ void BM_StraightLineCompletePrewarmed(benchmark::State& state) {
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   StrokeInputBatch inputs = MakeCompleteStraightLineInputs(bounds);
   Brush brush = MakeDefaultBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
 }
 BENCHMARK(BM_StraightLineCompletePrewarmed);
 
+// A long stroke built a few inputs at a time, so that the cost of each update
+// should stay proportional to the newly added geometry rather than to the
+// length of the stroke so far.
+void BM_LongStraightLineIncremental(benchmark::State& state) {
+  Rect bounds = Rect::FromTwoPoints({0, 0}, {10000, 100});
+  auto inputs = MakeSyntheticIncrementalStraightLineInputs(
+      bounds, state.range(0), Duration32::Seconds(60),
+      /* inputs_per_batch = */ 4);
+  Brush brush = MakeDefaultBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
+  StrokeShapeBuilder builder;
+  BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
+  benchmark::DoNotOptimize(builder);
+
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  while (state.KeepRunningBatch(inputs.size())) {
+    BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
+  }
+  state.SetLabel(absl::StrCat("Input count: ", state.range(0)));
+}
+BENCHMARK(BM_LongStraightLineIncremental)->Arg(500)->Arg(2000)->Arg(8000);
+
 // Spring shape tests.
 void BM_SpringShapeIncremental(benchmark::State& state) {
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   auto inputs = MakeIncrementalSpringShapeInputs(bounds);
   Brush brush = MakeDefaultBrush(20, 0.05);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(inputs.size()))
     BuildStrokeShapeIncrementally(brush, inputs);
 }
@@ -327,12 +466,14 @@ void BM_SpringShapeIncrementalPrewarmed(benchmark::State& state) {
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   auto inputs = MakeIncrementalSpringShapeInputs(bounds);
   Brush brush = MakeDefaultBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeIncrementally(brush, inputs, builder);
+  BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(inputs.size())) {
-    BuildStrokeShapeIncrementally(brush, inputs, builder);
+    BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
   }
 }
 BENCHMARK(BM_SpringShapeIncrementalPrewarmed);
@@ -342,6 +483,7 @@ void BM_SpringShapeComplete(benchmark::State& state) {
   StrokeInputBatch inputs = MakeCompleteSpringShapeInputs(bounds);
   Brush brush = MakeDefaultBrush(20, 0.05);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(brush, inputs);
   }
@@ -353,11 +495,13 @@ void BM_SpringShapeCompletePreWarmed(benchmark::State& state) {
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   StrokeInputBatch inputs = MakeCompleteSpringShapeInputs(bounds);
   Brush brush = MakeDefaultBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
@@ -370,6 +514,7 @@ void BM_SpringShapeIncrementalSingleBehavior(benchmark::State& state) {
   auto inputs = MakeIncrementalSpringShapeInputs(bounds);
   Brush brush = MakeSingleBehaviorBrush(20, 0.05);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(inputs.size()))
     BuildStrokeShapeIncrementally(brush, inputs);
 }
@@ -379,12 +524,14 @@ void BM_SpringShapeIncrementalPrewarmedSingleBehavior(benchmark::State& state) {
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   auto inputs = MakeIncrementalSpringShapeInputs(bounds);
   Brush brush = MakeSingleBehaviorBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeIncrementally(brush, inputs, builder);
+  BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(inputs.size())) {
-    BuildStrokeShapeIncrementally(brush, inputs, builder);
+    BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
   }
 }
 BENCHMARK(BM_SpringShapeIncrementalPrewarmedSingleBehavior);
@@ -394,6 +541,7 @@ void BM_SpringShapeCompleteSingleBehavior(benchmark::State& state) {
   StrokeInputBatch inputs = MakeCompleteSpringShapeInputs(bounds);
   Brush brush = MakeSingleBehaviorBrush(20, 0.05);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(brush, inputs);
   }
@@ -405,11 +553,13 @@ void BM_SpringShapeCompletePreWarmedSingleBehavior(benchmark::State& state) {
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   StrokeInputBatch inputs = MakeCompleteSpringShapeInputs(bounds);
   Brush brush = MakeSingleBehaviorBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
@@ -422,6 +572,7 @@ void BM_SpringShapeIncrementalMultipleBehavior(benchmark::State& state) {
   auto inputs = MakeIncrementalSpringShapeInputs(bounds);
   Brush brush = MakeMultiBehaviorBrush(20, 0.05);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(inputs.size()))
     BuildStrokeShapeIncrementally(brush, inputs);
 }
@@ -432,12 +583,14 @@ void BM_SpringShapeIncrementalPrewarmedMultipleBehavior(
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   auto inputs = MakeIncrementalSpringShapeInputs(bounds);
   Brush brush = MakeMultiBehaviorBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeIncrementally(brush, inputs, builder);
+  BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(inputs.size())) {
-    BuildStrokeShapeIncrementally(brush, inputs, builder);
+    BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
   }
 }
 BENCHMARK(BM_SpringShapeIncrementalPrewarmedMultipleBehavior);
@@ -447,6 +600,7 @@ void BM_SpringShapeCompleteMultipleBehavior(benchmark::State& state) {
   StrokeInputBatch inputs = MakeCompleteSpringShapeInputs(bounds);
   Brush brush = MakeMultiBehaviorBrush(20, 0.05);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(brush, inputs);
   }
@@ -458,17 +612,126 @@ void BM_SpringShapeCompletePreWarmedMultipleBehavior(benchmark::State& state) {
   Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
   StrokeInputBatch inputs = MakeCompleteSpringShapeInputs(bounds);
   Brush brush = MakeMultiBehaviorBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
 }
 BENCHMARK(BM_SpringShapeCompletePreWarmedMultipleBehavior);
 
+// Spring shape tests with a tapered end. The damped and noisy behaviors do not
+// need to be re-evaluated on every update for the stable inputs in the taper.
+void BM_SpringShapeIncrementalTaperedDampedBehavior(benchmark::State& state) {
+  Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
+  auto inputs = MakeIncrementalSpringShapeInputs(bounds);
+  Brush brush = MakeTaperedDampedBehaviorBrush(20, 0.05);
+
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  while (state.KeepRunningBatch(inputs.size()))
+    BuildStrokeShapeIncrementally(brush, inputs);
+}
+BENCHMARK(BM_SpringShapeIncrementalTaperedDampedBehavior);
+
+void BM_SpringShapeIncrementalPrewarmedTaperedDampedBehavior(
+    benchmark::State& state) {
+  Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
+  auto inputs = MakeIncrementalSpringShapeInputs(bounds);
+  Brush brush = MakeTaperedDampedBehaviorBrush(20, 0.05);
+  StrokeInputModeler input_modeler;
+  StrokeShapeBuilder builder;
+  BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
+  benchmark::DoNotOptimize(builder);
+
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  while (state.KeepRunningBatch(inputs.size())) {
+    BuildStrokeShapeIncrementally(brush, inputs, input_modeler, builder);
+  }
+}
+BENCHMARK(BM_SpringShapeIncrementalPrewarmedTaperedDampedBehavior);
+
+// Input model tests. These compare `BrushFamily::SpringModel` (argument 0)
+// against `BrushFamily::ExperimentalAdaptiveSamplingModel` (argument 1) on a
+// recorded stroke and on a slow synthetic line. Besides timing, they report
+// the number of modeled inputs, and the largest distance from a modeled input
+// of the spring model to the polyline through the modeled inputs of the
+// benchmarked model, as a multiple of the brush epsilon.
+BrushFamily::InputModel InputModelFromBenchmarkArg(int64_t arg) {
+  if (arg == 0) return BrushFamily::SpringModel{};
+  return BrushFamily::ExperimentalAdaptiveSamplingModel{};
+}
+
+void SetInputModelCounters(benchmark::State& state, const Brush& brush,
+                           const StrokeInputBatch& inputs) {
+  StrokeInputModeler reference_modeler;
+  reference_modeler.StartStroke(BrushFamily::SpringModel{},
+                                brush.GetEpsilon());
+  reference_modeler.ExtendStroke(inputs, {}, Duration32::Infinite());
+  StrokeInputModeler modeler;
+  modeler.StartStroke(brush.GetFamily().GetInputModel(), brush.GetEpsilon());
+  modeler.ExtendStroke(inputs, {}, Duration32::Infinite());
+  absl::Span<const ModeledStrokeInput> modeled = modeler.GetModeledInputs();
+  ABSL_CHECK(!modeled.empty());
+
+  float max_deviation = 0;
+  for (const ModeledStrokeInput& input :
+       reference_modeler.GetModeledInputs()) {
+    float deviation = Distance(input.position, modeled.front().position);
+    for (size_t i = 1; i < modeled.size(); ++i) {
+      deviation = std::min(
+          deviation, Distance(input.position,
+                              Segment{.start = modeled[i - 1].position,
+                                      .end = modeled[i].position}));
+    }
+    max_deviation = std::max(max_deviation, deviation);
+  }
+  state.counters["modeled_inputs"] = modeled.size();
+  state.counters["max_deviation_in_epsilons"] =
+      max_deviation / brush.GetEpsilon();
+}
+
+void BM_SpringShapeCompleteByInputModel(benchmark::State& state) {
+  Rect bounds = Rect::FromTwoPoints({0, 0}, {100, 100});
+  StrokeInputBatch inputs = MakeCompleteSpringShapeInputs(bounds);
+  Brush brush = MakeDefaultBrushWithInputModel(
+      20, 0.05, InputModelFromBenchmarkArg(state.range(0)));
+  StrokeInputModeler input_modeler;
+  StrokeShapeBuilder builder;
+  BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
+  benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
+    benchmark::DoNotOptimize(builder);
+  }
+  SetInputModelCounters(state, brush, inputs);
+}
+BENCHMARK(BM_SpringShapeCompleteByInputModel)->Arg(0)->Arg(1);
+
+void BM_SlowStraightLineCompleteByInputModel(benchmark::State& state) {
+  Rect bounds = Rect::FromTwoPoints({0, 0}, {1000, 100});
+  StrokeInputBatch inputs =
+      MakeSyntheticStraightLineInputs(bounds, 1800, Duration32::Seconds(30));
+  Brush brush = MakeDefaultBrushWithInputModel(
+      20, 0.05, InputModelFromBenchmarkArg(state.range(0)));
+  StrokeInputModeler input_modeler;
+  StrokeShapeBuilder builder;
+  BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
+  benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
+  for (auto s : state) {
+    BuildStrokeShapeAllAtOnce(brush, inputs, input_modeler, builder);
+    benchmark::DoNotOptimize(builder);
+  }
+  SetInputModelCounters(state, brush, inputs);
+}
+BENCHMARK(BM_SlowStraightLineCompleteByInputModel)->Arg(0)->Arg(1);
+
 // ********************** Benchmark Tests **********************************
 //
 // The following tests we will use synthetically created inputs to test the
@@ -519,6 +782,7 @@ void BM_SyntheticStraightLineOverlappingRectangleBrushtips(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(*brush, inputs);
   }
@@ -556,11 +820,13 @@ void BM_SyntheticStraightLineOverlappingRectangleBrushtipsPrewarmed(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
@@ -600,6 +866,7 @@ void BM_SyntheticStraightLineHueChangeRectangleBrushtips(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(*brush, inputs);
   }
@@ -637,11 +904,13 @@ void BM_SyntheticStraightLineHueChangeRectangleBrushtipsPrewarmed(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
@@ -662,6 +931,7 @@ void BM_SyntheticStraightLineNoRotationRectangleBrushtips(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(*brush, inputs);
   }
@@ -683,11 +953,13 @@ void BM_SyntheticStraightLineNoRotationRectangleBrushtipsPrewarmed(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
@@ -726,6 +998,7 @@ void BM_SyntheticStraightLineOverlappingPillBrushtips(benchmark::State& state) {
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(*brush, inputs);
   }
@@ -763,11 +1036,13 @@ void BM_SyntheticStraightLineOverlappingPillBrushtipsPrewarmed(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
@@ -806,6 +1081,7 @@ void BM_SyntheticStraightLineHueChangePillBrushtips(benchmark::State& state) {
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(*brush, inputs);
   }
@@ -843,11 +1119,13 @@ void BM_SyntheticStraightLineHueChangePillBrushtipsPrewarmed(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
@@ -867,6 +1145,7 @@ void BM_SyntheticStraightLineNoRotationPillBrushtips(benchmark::State& state) {
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
     BuildStrokeShapeAllAtOnce(*brush, inputs);
   }
@@ -888,11 +1167,13 @@ void BM_SyntheticStraightLineNoRotationPillBrushtipsPrewarmed(
   auto brush = Brush::Create(*brush_family, Color::GoogleBlue(), 1, 0.25);
   ABSL_CHECK_OK(brush);
 
+  StrokeInputModeler input_modeler;
   StrokeShapeBuilder builder;
-  BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+  BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
   benchmark::DoNotOptimize(builder);
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   for (auto s : state) {
-    BuildStrokeShapeAllAtOnce(*brush, inputs, builder);
+    BuildStrokeShapeAllAtOnce(*brush, inputs, input_modeler, builder);
     benchmark::DoNotOptimize(builder);
   }
   state.SetLabel(absl::StrCat("Input count: ", inputs.Size()));
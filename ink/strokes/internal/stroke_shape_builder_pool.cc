@@ -0,0 +1,89 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/internal/stroke_shape_builder_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ink/strokes/internal/stroke_shape_builder.h"
+#include "ink/types/memory_trim.h"
+
+namespace ink::strokes_internal {
+namespace {
+
+// Incremented by `TrimMemory()`. The pools belong to their threads, so each
+// pool is cleared by its own thread, the next time it is used after a trim.
+std::atomic<uint64_t> trim_generation = 0;
+
+}  // namespace
+
+StrokeShapeBuilderPool& StrokeShapeBuilderPool::ForCurrentThread() {
+  // Intentionally leaked, so that the callback stays registered until exit.
+  [[maybe_unused]] static auto* trim_registration =
+      new MemoryTrimRegistration(RegisterMemoryTrimCallback(
+          MemoryTrimLevel::kPooledMemory, []() -> size_t {
+            trim_generation.fetch_add(1, std::memory_order_relaxed);
+            // The memory is only released later, so none is reported here.
+            return 0;
+          }));
+
+  // Fall back to a single process-wide pool only if `thread_local` is
+  // unsupported, which should be almost never.
+#ifdef ABSL_HAVE_THREAD_LOCAL
+  thread_local
+#endif
+      StrokeShapeBuilderPool pool;
+  uint64_t generation = trim_generation.load(std::memory_order_relaxed);
+  if (pool.trim_generation_ != generation) {
+    pool.Clear();
+    pool.trim_generation_ = generation;
+  }
+  return pool;
+}
+
+StrokeShapeBuilder StrokeShapeBuilderPool::Acquire() {
+  if (idle_builders_.empty()) return StrokeShapeBuilder();
+  StrokeShapeBuilder builder = std::move(idle_builders_.back());
+  idle_builders_.pop_back();
+  return builder;
+}
+
+void StrokeShapeBuilderPool::Release(StrokeShapeBuilder builder) {
+  if (idle_builders_.size() < limits_.max_idle_builders &&
+      ShouldRetain(builder)) {
+    idle_builders_.push_back(std::move(builder));
+  }
+}
+
+void StrokeShapeBuilderPool::SetLimits(const Limits& limits) {
+  limits_ = limits;
+  std::erase_if(idle_builders_, [this](const StrokeShapeBuilder& builder) {
+    return !ShouldRetain(builder);
+  });
+  if (idle_builders_.size() > limits_.max_idle_builders) {
+    idle_builders_.resize(limits_.max_idle_builders);
+  }
+}
+
+bool StrokeShapeBuilderPool::ShouldRetain(
+    const StrokeShapeBuilder& builder) const {
+  // Vectors inside the builder never shrink, so the size of its latest mesh is
+  // a lower bound on the memory that retaining it would pin.
+  return builder.GetMesh().VertexCount() <= limits_.max_retained_vertex_count;
+}
+
+}  // namespace ink::strokes_internal
@@ -0,0 +1,97 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_INTERNAL_STROKE_SHAPE_BUILDER_POOL_H_
+#define INK_STROKES_INTERNAL_STROKE_SHAPE_BUILDER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ink/strokes/internal/stroke_shape_builder.h"
+
+namespace ink::strokes_internal {
+
+// A pool of idle `StrokeShapeBuilder`s whose internal allocations have already
+// been grown by previous strokes.
+//
+// Most of the cost of building the shape of a stroke with a cold builder goes
+// into growing the vectors in its modelers, extruder and `MutableMesh`.
+// Borrowing a builder from a pool lets new `Stroke`s and `InProgressStroke`s
+// reuse those allocations instead.
+//
+// To keep a single very large stroke from pinning its memory for the lifetime
+// of the pool, a released builder is only retained if its most recent mesh is
+// within `Limits::max_retained_vertex_count`, and at most
+// `Limits::max_idle_builders` builders are retained at once.
+//
+// This type is not thread-safe. Use `ForCurrentThread()` to get a pool that is
+// owned by and only accessed from the calling thread.
+class StrokeShapeBuilderPool {
+ public:
+  struct Limits {
+    // The maximum number of idle builders retained by the pool.
+    size_t max_idle_builders = 8;
+    // Builders whose most recent mesh has more vertices than this are
+    // destroyed on release rather than being retained.
+    uint32_t max_retained_vertex_count = 1 << 16;
+  };
+
+  StrokeShapeBuilderPool() = default;
+  explicit StrokeShapeBuilderPool(const Limits& limits) : limits_(limits) {}
+  StrokeShapeBuilderPool(const StrokeShapeBuilderPool&) = delete;
+  StrokeShapeBuilderPool& operator=(const StrokeShapeBuilderPool&) = delete;
+  StrokeShapeBuilderPool(StrokeShapeBuilderPool&&) = default;
+  StrokeShapeBuilderPool& operator=(StrokeShapeBuilderPool&&) = default;
+  ~StrokeShapeBuilderPool() = default;
+
+  // Returns the pool for the calling thread, which is used by `Stroke` shape
+  // generation and by `InProgressStroke::Start()`. After a call to
+  // `TrimMemory()`, each thread's pool is cleared the next time this is called
+  // on that thread.
+  static StrokeShapeBuilderPool& ForCurrentThread();
+
+  // Returns a builder from the pool, or a newly-constructed builder if the pool
+  // is empty. `StartStroke()` must be called on the returned builder before it
+  // is used.
+  StrokeShapeBuilder Acquire();
+
+  // Returns `builder` to the pool for reuse, unless doing so would exceed the
+  // current `Limits`, in which case `builder` is destroyed.
+  void Release(StrokeShapeBuilder builder);
+
+  // Sets new limits, immediately destroying any idle builders that no longer
+  // fit within them.
+  void SetLimits(const Limits& limits);
+  const Limits& GetLimits() const { return limits_; }
+
+  // Returns the number of idle builders currently held by the pool.
+  size_t IdleBuilderCount() const { return idle_builders_.size(); }
+
+  // Destroys all idle builders, releasing their memory.
+  void Clear() { idle_builders_.clear(); }
+
+ private:
+  bool ShouldRetain(const StrokeShapeBuilder& builder) const;
+
+  Limits limits_;
+  std::vector<StrokeShapeBuilder> idle_builders_;
+  // The number of `TrimMemory()` calls as of the last time `ForCurrentThread()`
+  // checked this pool.
+  uint64_t trim_generation_ = 0;
+};
+
+}  // namespace ink::strokes_internal
+
+#endif  // INK_STROKES_INTERNAL_STROKE_SHAPE_BUILDER_POOL_H_
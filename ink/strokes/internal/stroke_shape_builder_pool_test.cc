@@ -0,0 +1,155 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/internal/stroke_shape_builder_pool.h"
+
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/stroke_input_modeler.h"
+#include "ink/strokes/internal/stroke_shape_builder.h"
+#include "ink/types/duration.h"
+#include "ink/types/memory_trim.h"
+
+namespace ink::strokes_internal {
+namespace {
+
+// Returns a builder whose mesh has been extended with a short stroke.
+StrokeShapeBuilder MakeUsedBuilder() {
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create({
+      {.position = {5, 7}, .elapsed_time = Duration32::Zero()},
+      {.position = {6, 8}, .elapsed_time = Duration32::Seconds(1. / 60)},
+      {.position = {7, 9}, .elapsed_time = Duration32::Seconds(2. / 60)},
+  });
+  ABSL_CHECK_OK(inputs);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+
+  StrokeShapeBuilder builder;
+  builder.StartStroke(BrushCoat{.tip = BrushTip(), .paint = {}}, 10, 0.1);
+  builder.ExtendStroke(input_modeler);
+  return builder;
+}
+
+TEST(StrokeShapeBuilderPoolTest, DefaultConstructed) {
+  StrokeShapeBuilderPool pool;
+  EXPECT_EQ(pool.IdleBuilderCount(), 0);
+  EXPECT_EQ(pool.GetLimits().max_idle_builders,
+            StrokeShapeBuilderPool::Limits().max_idle_builders);
+  EXPECT_EQ(pool.GetLimits().max_retained_vertex_count,
+            StrokeShapeBuilderPool::Limits().max_retained_vertex_count);
+}
+
+TEST(StrokeShapeBuilderPoolTest, AcquireFromEmptyPool) {
+  StrokeShapeBuilderPool pool;
+  StrokeShapeBuilder builder = pool.Acquire();
+  EXPECT_EQ(builder.GetMesh().VertexCount(), 0);
+  EXPECT_EQ(pool.IdleBuilderCount(), 0);
+}
+
+TEST(StrokeShapeBuilderPoolTest, ReleaseAndAcquire) {
+  StrokeShapeBuilderPool pool;
+  pool.Release(MakeUsedBuilder());
+  pool.Release(MakeUsedBuilder());
+  EXPECT_EQ(pool.IdleBuilderCount(), 2);
+
+  StrokeShapeBuilder builder = pool.Acquire();
+  EXPECT_EQ(pool.IdleBuilderCount(), 1);
+
+  // A reused builder behaves like a new one once the next stroke is started.
+  builder.StartStroke(BrushCoat{.tip = BrushTip(), .paint = {}}, 10, 0.1);
+  EXPECT_EQ(builder.GetMesh().VertexCount(), 0);
+  EXPECT_TRUE(builder.GetMeshBounds().IsEmpty());
+}
+
+TEST(StrokeShapeBuilderPoolTest, ReleaseBeyondMaxIdleBuildersIsDiscarded) {
+  StrokeShapeBuilderPool pool({.max_idle_builders = 1});
+  pool.Release(MakeUsedBuilder());
+  pool.Release(MakeUsedBuilder());
+  EXPECT_EQ(pool.IdleBuilderCount(), 1);
+}
+
+TEST(StrokeShapeBuilderPoolTest, ReleaseOfLargeBuilderIsDiscarded) {
+  StrokeShapeBuilder builder = MakeUsedBuilder();
+  ASSERT_GT(builder.GetMesh().VertexCount(), 0);
+
+  StrokeShapeBuilderPool pool({.max_retained_vertex_count =
+                                   builder.GetMesh().VertexCount() - 1});
+  pool.Release(std::move(builder));
+  EXPECT_EQ(pool.IdleBuilderCount(), 0);
+
+  pool.Release(StrokeShapeBuilder());
+  EXPECT_EQ(pool.IdleBuilderCount(), 1);
+}
+
+TEST(StrokeShapeBuilderPoolTest, SetLimitsTrimsIdleBuilders) {
+  StrokeShapeBuilderPool pool;
+  pool.Release(MakeUsedBuilder());
+  pool.Release(StrokeShapeBuilder());
+  pool.Release(StrokeShapeBuilder());
+  pool.Release(StrokeShapeBuilder());
+  ASSERT_EQ(pool.IdleBuilderCount(), 4);
+
+  pool.SetLimits({.max_idle_builders = 3, .max_retained_vertex_count = 0});
+  EXPECT_EQ(pool.GetLimits().max_idle_builders, 3);
+  EXPECT_EQ(pool.GetLimits().max_retained_vertex_count, 0);
+  EXPECT_EQ(pool.IdleBuilderCount(), 3);
+
+  pool.SetLimits({.max_idle_builders = 1});
+  EXPECT_EQ(pool.IdleBuilderCount(), 1);
+}
+
+TEST(StrokeShapeBuilderPoolTest, Clear) {
+  StrokeShapeBuilderPool pool;
+  pool.Release(MakeUsedBuilder());
+  pool.Release(MakeUsedBuilder());
+  pool.Clear();
+  EXPECT_EQ(pool.IdleBuilderCount(), 0);
+}
+
+TEST(StrokeShapeBuilderPoolTest, ForCurrentThreadIsPerThread) {
+  StrokeShapeBuilderPool* this_thread_pool =
+      &StrokeShapeBuilderPool::ForCurrentThread();
+  EXPECT_EQ(&StrokeShapeBuilderPool::ForCurrentThread(), this_thread_pool);
+
+  StrokeShapeBuilderPool* other_thread_pool = nullptr;
+  std::thread([&other_thread_pool] {
+    other_thread_pool = &StrokeShapeBuilderPool::ForCurrentThread();
+  }).join();
+  EXPECT_NE(other_thread_pool, this_thread_pool);
+}
+
+TEST(StrokeShapeBuilderPoolTest, TrimMemoryClearsPoolsOnNextUse) {
+  StrokeShapeBuilderPool::ForCurrentThread().Release(MakeUsedBuilder());
+  ASSERT_EQ(StrokeShapeBuilderPool::ForCurrentThread().IdleBuilderCount(), 1);
+
+  TrimMemory(MemoryTrimLevel::kPooledMemory);
+  EXPECT_EQ(StrokeShapeBuilderPool::ForCurrentThread().IdleBuilderCount(), 0);
+
+  // The pool keeps working as usual after being trimmed.
+  StrokeShapeBuilderPool::ForCurrentThread().Release(MakeUsedBuilder());
+  EXPECT_EQ(StrokeShapeBuilderPool::ForCurrentThread().IdleBuilderCount(), 1);
+  StrokeShapeBuilderPool::ForCurrentThread().Clear();
+}
+
+}  // namespace
+}  // namespace ink::strokes_internal
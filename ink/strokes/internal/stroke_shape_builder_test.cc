@@ -14,6 +14,7 @@
 
 #include "ink/strokes/internal/stroke_shape_builder.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 
@@ -30,6 +31,7 @@
 #include "ink/geometry/mutable_mesh.h"
 #include "ink/geometry/type_matchers.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/stroke_input_modeler.h"
 #include "ink/strokes/internal/stroke_shape_update.h"
 #include "ink/strokes/internal/stroke_vertex.h"
 #include "ink/types/duration.h"
@@ -56,7 +58,9 @@ TEST(StrokeShapeBuilderTest, DefaultConstructedIsEmpty) {
 TEST(StrokeShapeBuilderTest, FirstStartStrokeHasEmptyMeshAndOutline) {
   StrokeShapeBuilder builder;
   BrushCoat brush_coat{.tip = BrushTip(), .paint = {}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat, 10, 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  builder.StartStroke(brush_coat, 10, 0.1);
 
   EXPECT_EQ(builder.GetMesh().VertexCount(), 0);
   EXPECT_EQ(builder.GetMesh().TriangleCount(), 0);
@@ -67,9 +71,12 @@ TEST(StrokeShapeBuilderTest, FirstStartStrokeHasEmptyMeshAndOutline) {
 TEST(StrokeShapeBuilderTest, EmptyExtendHasEmptyUpdateMeshAndOutline) {
   StrokeShapeBuilder builder;
   BrushCoat brush_coat{.tip = BrushTip(), .paint = {}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat, 10, 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  builder.StartStroke(brush_coat, 10, 0.1);
 
-  StrokeShapeUpdate update = builder.ExtendStroke({}, {}, Duration32::Zero());
+  input_modeler.ExtendStroke({}, {}, Duration32::Zero());
+  StrokeShapeUpdate update = builder.ExtendStroke(input_modeler);
 
   EXPECT_EQ(builder.GetMesh().VertexCount(), 0);
   EXPECT_EQ(builder.GetMesh().TriangleCount(), 0);
@@ -84,7 +91,9 @@ TEST(StrokeShapeBuilderTest, EmptyExtendHasEmptyUpdateMeshAndOutline) {
 TEST(StrokeShapeBuilderTest, NonEmptyExtend) {
   StrokeShapeBuilder builder;
   BrushCoat brush_coat{.tip = BrushTip(), .paint = {}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat, 10, 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  builder.StartStroke(brush_coat, 10, 0.1);
 
   absl::StatusOr<StrokeInputBatch> real_inputs = StrokeInputBatch::Create({
       {.position = {5, 7}, .elapsed_time = Duration32::Zero()},
@@ -98,8 +107,9 @@ TEST(StrokeShapeBuilderTest, NonEmptyExtend) {
   });
   ASSERT_EQ(predicted_inputs.status(), absl::OkStatus());
 
-  StrokeShapeUpdate update =
-      builder.ExtendStroke(*real_inputs, *predicted_inputs, Duration32::Zero());
+  input_modeler.ExtendStroke(*real_inputs, *predicted_inputs,
+                             Duration32::Zero());
+  StrokeShapeUpdate update = builder.ExtendStroke(input_modeler);
 
   EXPECT_NE(builder.GetMesh().VertexCount(), 0);
   EXPECT_NE(builder.GetMesh().TriangleCount(), 0);
@@ -116,7 +126,8 @@ TEST(StrokeShapeBuilderTest, NonEmptyExtend) {
       {.position = {7, 8}, .elapsed_time = Duration32::Seconds(3. / 60)},
   });
   ASSERT_EQ(real_inputs.status(), absl::OkStatus());
-  update = builder.ExtendStroke(*real_inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*real_inputs, {}, Duration32::Zero());
+  update = builder.ExtendStroke(input_modeler);
 
   EXPECT_NE(builder.GetMesh().VertexCount(), 0);
   EXPECT_NE(builder.GetMesh().TriangleCount(), 0);
@@ -134,13 +145,16 @@ TEST(StrokeShapeBuilderTest, NonEmptyExtend) {
 TEST(StrokeShapeBuilderTest, StartAfterExtendEmptiesMeshAndOutline) {
   StrokeShapeBuilder builder;
   BrushCoat brush_coat{.tip = BrushTip(), .paint = {}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat, 10, 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  builder.StartStroke(brush_coat, 10, 0.1);
 
   absl::StatusOr<StrokeInputBatch> inputs =
       StrokeInputBatch::Create({{.position = {5, 7}}});
   ASSERT_EQ(inputs.status(), absl::OkStatus());
 
-  builder.ExtendStroke(*inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  builder.ExtendStroke(input_modeler);
   ASSERT_NE(builder.GetMesh().VertexCount(), 0);
   ASSERT_NE(builder.GetMesh().TriangleCount(), 0);
   ASSERT_THAT(builder.GetMeshBounds().AsRect(),
@@ -148,7 +162,8 @@ TEST(StrokeShapeBuilderTest, StartAfterExtendEmptiesMeshAndOutline) {
                                 0.0001)));
   ASSERT_THAT(builder.GetOutlines(), ElementsAre(Not(IsEmpty())));
 
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat, 10, 0.1);
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  builder.StartStroke(brush_coat, 10, 0.1);
 
   EXPECT_EQ(builder.GetMesh().VertexCount(), 0);
   EXPECT_EQ(builder.GetMesh().TriangleCount(), 0);
@@ -159,14 +174,18 @@ TEST(StrokeShapeBuilderTest, StartAfterExtendEmptiesMeshAndOutline) {
 TEST(StrokeShapeBuilderTest, NonTexturedNonParticleBrushDoesNotHaveSurfaceUvs) {
   StrokeShapeBuilder builder;
   BrushCoat brush_coat{.tip = BrushTip{}, .paint = {}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat,
-                      /* brush_size = */ 10, /* brush_epsilon = */ 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(),
+                            /* brush_epsilon = */ 0.1);
+  builder.StartStroke(brush_coat, /* brush_size = */ 10,
+                      /* brush_epsilon = */ 0.1);
 
   absl::StatusOr<StrokeInputBatch> inputs =
       StrokeInputBatch::Create({{.position = {5, 7}}});
   ASSERT_EQ(inputs.status(), absl::OkStatus());
 
-  builder.ExtendStroke(*inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  builder.ExtendStroke(input_modeler);
 
   for (uint32_t i = 0; i < builder.GetMesh().VertexCount(); ++i) {
     EXPECT_THAT(StrokeVertex::GetSurfaceUvFromMesh(builder.GetMesh(), i),
@@ -180,14 +199,18 @@ TEST(StrokeShapeBuilderTest, StampingNonParticleBrushDoesNotHaveSurfaceUvs) {
       .tip = BrushTip{},
       .paint = {.texture_layers = {
                     {.mapping = BrushPaint::TextureMapping::kStamping}}}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat,
-                      /* brush_size = */ 10, /* brush_epsilon = */ 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(),
+                            /* brush_epsilon = */ 0.1);
+  builder.StartStroke(brush_coat, /* brush_size = */ 10,
+                      /* brush_epsilon = */ 0.1);
 
   absl::StatusOr<StrokeInputBatch> inputs =
       StrokeInputBatch::Create({{.position = {5, 7}}});
   ASSERT_EQ(inputs.status(), absl::OkStatus());
 
-  builder.ExtendStroke(*inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  builder.ExtendStroke(input_modeler);
 
   for (uint32_t i = 0; i < builder.GetMesh().VertexCount(); ++i) {
     EXPECT_THAT(StrokeVertex::GetSurfaceUvFromMesh(builder.GetMesh(), i),
@@ -200,14 +223,18 @@ TEST(StrokeShapeBuilderTest,
   StrokeShapeBuilder builder;
   BrushCoat brush_coat{.tip = BrushTip{.particle_gap_distance_scale = 0.05},
                        .paint = {}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat,
-                      /* brush_size = */ 10, /* brush_epsilon = */ 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(),
+                            /* brush_epsilon = */ 0.1);
+  builder.StartStroke(brush_coat, /* brush_size = */ 10,
+                      /* brush_epsilon = */ 0.1);
 
   absl::StatusOr<StrokeInputBatch> inputs =
       StrokeInputBatch::Create({{.position = {5, 7}}});
   ASSERT_EQ(inputs.status(), absl::OkStatus());
 
-  builder.ExtendStroke(*inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  builder.ExtendStroke(input_modeler);
 
   for (uint32_t i = 0; i < builder.GetMesh().VertexCount(); ++i) {
     EXPECT_THAT(StrokeVertex::GetSurfaceUvFromMesh(builder.GetMesh(), i),
@@ -222,14 +249,18 @@ TEST(StrokeShapeBuilderTest,
       .tip = BrushTip{.particle_gap_distance_scale = 0.05},
       .paint = {.texture_layers = {
                     {.mapping = BrushPaint::TextureMapping::kTiling}}}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat,
-                      /* brush_size = */ 10, /* brush_epsilon = */ 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(),
+                            /* brush_epsilon = */ 0.1);
+  builder.StartStroke(brush_coat, /* brush_size = */ 10,
+                      /* brush_epsilon = */ 0.1);
 
   absl::StatusOr<StrokeInputBatch> inputs =
       StrokeInputBatch::Create({{.position = {5, 7}}});
   ASSERT_EQ(inputs.status(), absl::OkStatus());
 
-  builder.ExtendStroke(*inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  builder.ExtendStroke(input_modeler);
 
   for (uint32_t i = 0; i < builder.GetMesh().VertexCount(); ++i) {
     EXPECT_THAT(StrokeVertex::GetSurfaceUvFromMesh(builder.GetMesh(), i),
@@ -243,14 +274,18 @@ TEST(StrokeShapeBuilderTest,
   BrushCoat brush_coat{
       .tip = BrushTip{.particle_gap_duration = Duration32::Seconds(0.05)},
       .paint = {}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat,
-                      /* brush_size = */ 10, /* brush_epsilon = */ 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(),
+                            /* brush_epsilon = */ 0.1);
+  builder.StartStroke(brush_coat, /* brush_size = */ 10,
+                      /* brush_epsilon = */ 0.1);
 
   absl::StatusOr<StrokeInputBatch> inputs =
       StrokeInputBatch::Create({{.position = {5, 7}}});
   ASSERT_EQ(inputs.status(), absl::OkStatus());
 
-  builder.ExtendStroke(*inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  builder.ExtendStroke(input_modeler);
 
   for (uint32_t i = 0; i < builder.GetMesh().VertexCount(); ++i) {
     EXPECT_THAT(StrokeVertex::GetSurfaceUvFromMesh(builder.GetMesh(), i),
@@ -264,14 +299,18 @@ TEST(StrokeShapeBuilderTest, StampingParticleDistanceBrushHasSurfaceUvs) {
       .tip = BrushTip{.particle_gap_distance_scale = 0.05},
       .paint = {.texture_layers = {
                     {.mapping = BrushPaint::TextureMapping::kStamping}}}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat,
-                      /* brush_size = */ 10, /* brush_epsilon = */ 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(),
+                            /* brush_epsilon = */ 0.1);
+  builder.StartStroke(brush_coat, /* brush_size = */ 10,
+                      /* brush_epsilon = */ 0.1);
 
   absl::StatusOr<StrokeInputBatch> inputs =
       StrokeInputBatch::Create({{.position = {5, 7}}});
   ASSERT_EQ(inputs.status(), absl::OkStatus());
 
-  builder.ExtendStroke(*inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  builder.ExtendStroke(input_modeler);
 
   // For strokes that don't use the surface UV, all UV values are set to (0, 0).
   // We test that this isn't the case by finding the envelope; if its width and
@@ -291,14 +330,18 @@ TEST(StrokeShapeBuilderTest, StampingParticleDurationBrushHasSurfaceUvs) {
       .tip = BrushTip{.particle_gap_duration = Duration32::Seconds(0.05)},
       .paint = {.texture_layers = {
                     {.mapping = BrushPaint::TextureMapping::kStamping}}}};
-  builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat,
-                      /* brush_size = */ 10, /* brush_epsilon = */ 0.1);
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(),
+                            /* brush_epsilon = */ 0.1);
+  builder.StartStroke(brush_coat, /* brush_size = */ 10,
+                      /* brush_epsilon = */ 0.1);
 
   absl::StatusOr<StrokeInputBatch> inputs =
       StrokeInputBatch::Create({{.position = {5, 7}}});
   ASSERT_EQ(inputs.status(), absl::OkStatus());
 
-  builder.ExtendStroke(*inputs, {}, Duration32::Zero());
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  builder.ExtendStroke(input_modeler);
 
   // For strokes that don't use the surface UV, all UV values are set to (0, 0).
   // We test that this isn't the case by finding the envelope; if its width and
@@ -312,26 +355,90 @@ TEST(StrokeShapeBuilderTest, StampingParticleDurationBrushHasSurfaceUvs) {
   EXPECT_GT(uv_envelope.AsRect()->Height(), 0);
 }
 
+TEST(StrokeShapeBuilderTest, BuildersSharingInputModelerMatchSeparateModelers) {
+  BrushCoat brush_coat_a{.tip = BrushTip(), .paint = {}};
+  BrushCoat brush_coat_b{.tip = BrushTip{.scale = {0.5, 1}}, .paint = {}};
+
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create({
+      {.position = {5, 7}, .elapsed_time = Duration32::Zero()},
+      {.position = {6, 8}, .elapsed_time = Duration32::Seconds(1. / 60)},
+      {.position = {7, 9}, .elapsed_time = Duration32::Seconds(2. / 60)},
+  });
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+
+  StrokeInputModeler shared_modeler;
+  shared_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  StrokeShapeBuilder shared_builder_a;
+  StrokeShapeBuilder shared_builder_b;
+  shared_builder_a.StartStroke(brush_coat_a, 10, 0.1);
+  shared_builder_b.StartStroke(brush_coat_b, 10, 0.1);
+  shared_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  shared_builder_a.ExtendStroke(shared_modeler);
+  shared_builder_b.ExtendStroke(shared_modeler);
+
+  StrokeInputModeler separate_modeler;
+  separate_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  StrokeShapeBuilder separate_builder_b;
+  separate_builder_b.StartStroke(brush_coat_b, 10, 0.1);
+  separate_modeler.ExtendStroke(*inputs, {}, Duration32::Zero());
+  separate_builder_b.ExtendStroke(separate_modeler);
+
+  ASSERT_NE(shared_builder_a.GetMesh().VertexCount(), 0);
+  ASSERT_EQ(shared_builder_b.GetMesh().VertexCount(),
+            separate_builder_b.GetMesh().VertexCount());
+  ASSERT_EQ(shared_builder_b.GetMesh().TriangleCount(),
+            separate_builder_b.GetMesh().TriangleCount());
+  for (uint32_t i = 0; i < shared_builder_b.GetMesh().VertexCount(); ++i) {
+    EXPECT_THAT(shared_builder_b.GetMesh().VertexPosition(i),
+                PointEq(separate_builder_b.GetMesh().VertexPosition(i)));
+  }
+}
+
+TEST(StrokeShapeBuilderTest, ReserveForModeledInputCountCoversStraightStroke) {
+  BrushCoat brush_coat{.tip = BrushTip(), .paint = {}};
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create({
+      {.position = {5, 7}, .elapsed_time = Duration32::Zero()},
+      {.position = {6, 8}, .elapsed_time = Duration32::Seconds(1. / 60)},
+      {.position = {7, 9}, .elapsed_time = Duration32::Seconds(2. / 60)},
+  });
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  input_modeler.ExtendStroke(*inputs, {}, Duration32::Infinite());
+  StrokeShapeBuilder builder;
+  builder.StartStroke(brush_coat, 10, 0.1);
+  builder.ReserveForModeledInputCount(
+      input_modeler.GetModeledInputs().size());
+
+  // The reserved capacity is enough for the whole stroke, so the mesh's
+  // buffers are never reallocated while it is extruded.
+  const std::byte* vertex_data = builder.GetMesh().RawVertexData().data();
+  const std::byte* index_data = builder.GetMesh().RawIndexData().data();
+  builder.ExtendStroke(input_modeler);
+  ASSERT_NE(builder.GetMesh().VertexCount(), 0);
+  EXPECT_EQ(builder.GetMesh().RawVertexData().data(), vertex_data);
+  EXPECT_EQ(builder.GetMesh().RawIndexData().data(), index_data);
+}
+
 TEST(StrokeShapeBuilderDeathTest, StartWithZeroBrushSize) {
   StrokeShapeBuilder builder;
   BrushCoat brush_coat{.tip = BrushTip(), .paint = {}};
-  EXPECT_DEATH_IF_SUPPORTED(
-      builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat, 0, 0.1),
-      "");
+  EXPECT_DEATH_IF_SUPPORTED(builder.StartStroke(brush_coat, 0, 0.1), "");
 }
 
 TEST(StrokeShapeBuilderDeathTest, StartWithZeroBrushEpsilon) {
   StrokeShapeBuilder builder;
   BrushCoat brush_coat{.tip = BrushTip(), .paint = {}};
-  EXPECT_DEATH_IF_SUPPORTED(
-      builder.StartStroke(BrushFamily::DefaultInputModel(), brush_coat, 1, 0),
-      "");
+  EXPECT_DEATH_IF_SUPPORTED(builder.StartStroke(brush_coat, 1, 0), "");
 }
 
 TEST(StrokeShapeBuilderDeathTest, ExtendWithoutStart) {
   StrokeShapeBuilder builder;
-  EXPECT_DEATH_IF_SUPPORTED(builder.ExtendStroke({}, {}, Duration32::Zero()),
-                            "");
+  StrokeInputModeler input_modeler;
+  input_modeler.StartStroke(BrushFamily::DefaultInputModel(), 0.1);
+  input_modeler.ExtendStroke({}, {}, Duration32::Zero());
+  EXPECT_DEATH_IF_SUPPORTED(builder.ExtendStroke(input_modeler), "");
 }
 
 }  // namespace
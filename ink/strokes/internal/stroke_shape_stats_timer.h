@@ -0,0 +1,59 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_STROKES_INTERNAL_STROKE_SHAPE_STATS_TIMER_H_
+#define INK_STROKES_INTERNAL_STROKE_SHAPE_STATS_TIMER_H_
+
+#include <cstdint>
+
+#include "absl/time/clock.h"
+#include "ink/strokes/stroke_shape_stats.h"
+
+namespace ink::strokes_internal {
+
+// Adds the time elapsed between its construction and destruction to one of the
+// `StrokeShapeStats` time values.
+//
+// When `kStrokeShapeStatsEnabled` is false, this type does nothing and does not
+// read the clock.
+class ScopedStatsTimer {
+ public:
+  explicit ScopedStatsTimer(int64_t& nanos) : nanos_(nanos) {
+    if constexpr (kStrokeShapeStatsEnabled) {
+      start_nanos_ = absl::GetCurrentTimeNanos();
+    }
+  }
+  ScopedStatsTimer(const ScopedStatsTimer&) = delete;
+  ScopedStatsTimer& operator=(const ScopedStatsTimer&) = delete;
+  ~ScopedStatsTimer() {
+    if constexpr (kStrokeShapeStatsEnabled) {
+      nanos_ += absl::GetCurrentTimeNanos() - start_nanos_;
+    }
+  }
+
+ private:
+  int64_t& nanos_;
+  int64_t start_nanos_ = 0;
+};
+
+// Adds `amount` to one of the `StrokeShapeStats` counters, if
+// `kStrokeShapeStatsEnabled` is true.
+inline void AddToStatsCounter(int64_t& counter, int64_t amount) {
+  if constexpr (kStrokeShapeStatsEnabled) counter += amount;
+}
+
+}  // namespace ink::strokes_internal
+
+#endif  // INK_STROKES_INTERNAL_STROKE_SHAPE_STATS_TIMER_H_
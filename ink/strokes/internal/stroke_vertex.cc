@@ -17,10 +17,12 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <optional>
+#include <type_traits>
 #include <utility>
 
 #include "absl/algorithm/container.h"
@@ -341,94 +343,76 @@ float StrokeVertex::GetAnimationOffsetFromMesh(const MutableMesh& mesh,
 
 namespace {
 
-// TODO: b/306149329 - Investigate memcpy-ing the entire struct instead of
-// repeatedly calling `SetFloatVertexAttribute()`.
-void SetNonPositionAttributes(
-    MutableMesh& mesh, uint32_t index,
-    const StrokeVertex::NonPositionAttributes& attributes) {
-  // Clamp the opacity and HSL shifts to within their expected bounds so that
-  // they can be packed with hard-coded `MeshAttributePackingParams`.
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.opacity_shift,
-      {std::clamp(attributes.opacity_shift, -1.f, 1.f)});
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.hsl_shift,
-      {std::clamp(attributes.hsl_shift[0], -1.f, 1.f),
-       std::clamp(attributes.hsl_shift[1], -1.f, 1.f),
-       std::clamp(attributes.hsl_shift[2], -1.f, 1.f)});
-
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.side_derivative,
-      {attributes.side_derivative.x, attributes.side_derivative.y});
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.side_label,
-      {attributes.side_label.encoded_value});
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.forward_derivative,
-      {attributes.forward_derivative.x, attributes.forward_derivative.y});
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.forward_label,
-      {attributes.forward_label.encoded_value});
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.surface_uv,
-      {attributes.surface_uv.x, attributes.surface_uv.y});
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.animation_offset,
-      {attributes.animation_offset});
+// Writes `value` into the data of the vertex at `index` in a mesh with the
+// full format, at the constant `kOffset` into the unpacked vertex layout. Since
+// that layout is identical to `StrokeVertex`, offsets into the struct can be
+// used directly, and each write compiles down to a plain store instead of a
+// lookup and switch on the attribute's type.
+template <size_t kOffset, typename T>
+void WriteFullFormatVertexData(MutableMesh& mesh, uint32_t index,
+                               const T& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(kOffset + sizeof(T) <= sizeof(StrokeVertex));
+  ABSL_DCHECK(MeshFormat::IsUnpackedEquivalent(
+      mesh.Format(), StrokeVertex::FullMeshFormat()));
+  ABSL_DCHECK_LT(index, mesh.VertexCount());
+  std::memcpy(
+      &mesh.MutableRawVertexData()[index * sizeof(StrokeVertex) + kOffset],
+      &value, sizeof(T));
+}
+
+// Returns a copy of `vertex` with the opacity and HSL shifts clamped to within
+// their expected bounds so that they can be packed with hard-coded
+// `MeshAttributePackingParams`.
+StrokeVertex ClampColorShifts(const StrokeVertex& vertex) {
+  StrokeVertex clamped = vertex;
+  StrokeVertex::NonPositionAttributes& attributes =
+      clamped.non_position_attributes;
+  attributes.opacity_shift = std::clamp(attributes.opacity_shift, -1.f, 1.f);
+  for (float& shift : attributes.hsl_shift) {
+    shift = std::clamp(shift, -1.f, 1.f);
+  }
+  return clamped;
 }
 
 }  // namespace
 
 void StrokeVertex::AppendToMesh(MutableMesh& mesh, const StrokeVertex& vertex) {
-  ABSL_DCHECK(
-      MeshFormat::IsUnpackedEquivalent(mesh.Format(), FullMeshFormat()));
   mesh.AppendVertex(vertex.position);
-  SetNonPositionAttributes(mesh, mesh.VertexCount() - 1,
-                           vertex.non_position_attributes);
+  WriteFullFormatVertexData<0>(mesh, mesh.VertexCount() - 1,
+                               ClampColorShifts(vertex));
 }
 
 void StrokeVertex::SetInMesh(MutableMesh& mesh, uint32_t index,
                              const StrokeVertex& vertex) {
-  ABSL_DCHECK(
-      MeshFormat::IsUnpackedEquivalent(mesh.Format(), FullMeshFormat()));
-  mesh.SetVertexPosition(index, vertex.position);
-  SetNonPositionAttributes(mesh, index, vertex.non_position_attributes);
+  WriteFullFormatVertexData<0>(mesh, index, ClampColorShifts(vertex));
 }
 
 void StrokeVertex::SetSideDerivativeInMesh(MutableMesh& mesh, uint32_t index,
                                            Vec derivative) {
-  ABSL_DCHECK(
-      MeshFormat::IsUnpackedEquivalent(mesh.Format(), FullMeshFormat()));
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.side_derivative,
-      {derivative.x, derivative.y});
+  WriteFullFormatVertexData<offsetof(
+      StrokeVertex, non_position_attributes.side_derivative)>(mesh, index,
+                                                              derivative);
 }
 
 void StrokeVertex::SetForwardDerivativeInMesh(MutableMesh& mesh, uint32_t index,
                                               Vec derivative) {
-  ABSL_DCHECK(
-      MeshFormat::IsUnpackedEquivalent(mesh.Format(), FullMeshFormat()));
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.forward_derivative,
-      {derivative.x, derivative.y});
+  WriteFullFormatVertexData<offsetof(
+      StrokeVertex, non_position_attributes.forward_derivative)>(mesh, index,
+                                                                 derivative);
 }
 
 void StrokeVertex::SetSideLabelInMesh(MutableMesh& mesh, uint32_t index,
                                       Label label) {
-  ABSL_DCHECK(
-      MeshFormat::IsUnpackedEquivalent(mesh.Format(), FullMeshFormat()));
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.side_label,
-      {label.encoded_value});
+  WriteFullFormatVertexData<offsetof(
+      StrokeVertex, non_position_attributes.side_label)>(mesh, index, label);
 }
 
 void StrokeVertex::SetForwardLabelInMesh(MutableMesh& mesh, uint32_t index,
                                          Label label) {
-  ABSL_DCHECK(
-      MeshFormat::IsUnpackedEquivalent(mesh.Format(), FullMeshFormat()));
-  mesh.SetFloatVertexAttribute(
-      index, StrokeVertex::kFullFormatAttributeIndices.forward_label,
-      {label.encoded_value});
+  WriteFullFormatVertexData<offsetof(
+      StrokeVertex, non_position_attributes.forward_label)>(mesh, index,
+                                                            label);
 }
 
 namespace {
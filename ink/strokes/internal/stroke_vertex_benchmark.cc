@@ -0,0 +1,63 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "absl/log/absl_check.h"
+#include "benchmark/benchmark.h"
+#include "ink/geometry/mutable_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/vec.h"
+#include "ink/strokes/internal/stroke_vertex.h"
+
+namespace ink::strokes_internal {
+namespace {
+
+// Returns a triangle strip of `n_vertices` vertices in the full stroke vertex
+// format, zig-zagging along the x-axis, with varying non-position attributes.
+MutableMesh MakeStrokeVertexStrip(int64_t n_vertices) {
+  MutableMesh mesh(StrokeVertex::FullMeshFormat());
+  for (int64_t i = 0; i < n_vertices; ++i) {
+    float side = i % 2 == 0 ? -1 : 1;
+    StrokeVertex::AppendToMesh(
+        mesh, {.position = {0.5f * i, side},
+               .non_position_attributes = {
+                   .opacity_shift = 0.01f * (i % 50),
+                   .hsl_shift = {0.1f, -0.2f, 0.3f},
+                   .side_derivative = Vec{0, side},
+                   .side_label = side < 0 ? StrokeVertex::kExteriorLeftLabel
+                                          : StrokeVertex::kExteriorRightLabel,
+                   .forward_derivative = Vec{0.5f, 0},
+                   .surface_uv = {0.5f * i / n_vertices, (side + 1) / 2},
+               }});
+  }
+  for (uint32_t i = 2; i < mesh.VertexCount(); ++i) {
+    mesh.AppendTriangleIndices({i - 2, i - 1, i});
+  }
+  return mesh;
+}
+
+void BM_AsMeshes(benchmark::State& state) {
+  MutableMesh mesh = MakeStrokeVertexStrip(state.range(0));
+  for (auto s : state) {
+    auto meshes = mesh.AsMeshes();
+    ABSL_CHECK_OK(meshes);
+    benchmark::DoNotOptimize(meshes);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AsMeshes)->Range(64, 1 << 16);
+
+}  // namespace
+}  // namespace ink::strokes_internal
@@ -0,0 +1,137 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_PERFORMANCE_PROFILE_H_
+#define INK_STROKES_PERFORMANCE_PROFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "ink/strokes/stroke_shape_budget.h"
+#include "ink/types/duration.h"
+
+namespace ink {
+
+// The performance and memory settings of every part of the library that has
+// them, gathered in one place so that an app can pick them per device class,
+// e.g. to A/B test tiers, instead of setting each one separately.
+//
+// A profile is consumed by:
+//   * `InProgressStroke::SetPerformanceProfile()`
+//   * `Stroke::LevelOfDetailForScale()`
+//   * `MeshEncodingOptionsForProfile()` and
+//     `StrokeInputBatchEncodingOptionsForProfile()` in `ink/storage`
+//   * `SkiaRenderer::SetPerformanceProfile()`
+// Each of these only sets the corresponding individual settings, which can
+// still be changed afterwards.
+//
+// A default-constructed profile holds the defaults of each of those settings.
+// `ForTier()` returns a preset, whose fields can be overridden before it is
+// applied.
+struct PerformanceProfile {
+  enum class Tier : uint8_t {
+    // For devices with little memory or slow CPUs. Bounds the work and memory
+    // of each stroke, and draws coarser levels of detail.
+    kLow,
+    // For typical devices.
+    kBalanced,
+    // For devices where stroke quality matters more than the cost of drawing
+    // it. Keeps the full shape of every stroke, and uses larger caches.
+    kHigh,
+  };
+
+  static PerformanceProfile ForTier(Tier tier);
+
+  // ---------------------------------------------------------------------------
+  // `InProgressStroke` settings; see the setter of the same name.
+
+  StrokeShapeBudget budget;
+  bool input_decimation_enabled = false;
+  Duration32 prediction_horizon = Duration32::Zero();
+  // Not enabled by any preset, since it changes which meshes must be drawn.
+  bool separate_tail_enabled = false;
+  bool vertex_welding_enabled = false;
+
+  // ---------------------------------------------------------------------------
+  // `Stroke` settings.
+
+  // The number of levels of detail coarser than the one whose error matches
+  // the brush epsilon at the drawn scale that `Stroke::LevelOfDetailForScale()`
+  // returns, trading visible precision for fewer triangles to draw.
+  uint32_t level_of_detail_bias = 0;
+
+  // ---------------------------------------------------------------------------
+  // Storage settings; see `MeshEncodingOptions` and
+  // `StrokeInputBatchEncodingOptions`.
+
+  // The maximum error of each coordinate of encoded mesh and input positions.
+  std::optional<float> max_encoded_position_error;
+  // Not enabled by any preset, since older decoders can't read the result.
+  bool compress_triangle_index = false;
+
+  // ---------------------------------------------------------------------------
+  // `SkiaRenderer` settings; see the setter of the same name.
+
+  size_t mesh_buffer_cache_max_bytes = 0;
+  size_t path_cache_max_bytes = 0;
+  size_t texture_cache_max_bytes = std::numeric_limits<size_t>::max();
+  bool texture_mipmaps_enabled = false;
+  size_t drawable_cache_max_entries = 0;
+};
+
+// ---------------------------------------------------------------------------
+//                     Implementation details below
+
+inline PerformanceProfile PerformanceProfile::ForTier(Tier tier) {
+  constexpr size_t kMiB = size_t{1} << 20;
+  PerformanceProfile profile;
+  switch (tier) {
+    case Tier::kLow:
+      profile.budget = {.max_vertices_per_coat = 1 << 15,
+                        .max_tip_states_per_update = 256,
+                        .max_retriangulated_triangles_per_tip_state = 64};
+      profile.input_decimation_enabled = true;
+      profile.vertex_welding_enabled = true;
+      profile.level_of_detail_bias = 1;
+      profile.mesh_buffer_cache_max_bytes = 4 * kMiB;
+      profile.path_cache_max_bytes = 2 * kMiB;
+      profile.texture_cache_max_bytes = 16 * kMiB;
+      profile.drawable_cache_max_entries = 64;
+      break;
+    case Tier::kBalanced:
+      profile.budget = {.max_vertices_per_coat = 1 << 17,
+                        .max_tip_states_per_update = 1024,
+                        .max_retriangulated_triangles_per_tip_state = 256};
+      profile.input_decimation_enabled = true;
+      profile.mesh_buffer_cache_max_bytes = 16 * kMiB;
+      profile.path_cache_max_bytes = 8 * kMiB;
+      profile.texture_cache_max_bytes = 64 * kMiB;
+      profile.texture_mipmaps_enabled = true;
+      profile.drawable_cache_max_entries = 256;
+      break;
+    case Tier::kHigh:
+      profile.mesh_buffer_cache_max_bytes = 64 * kMiB;
+      profile.path_cache_max_bytes = 32 * kMiB;
+      profile.texture_mipmaps_enabled = true;
+      profile.drawable_cache_max_entries = 1024;
+      break;
+  }
+  return profile;
+}
+
+}  // namespace ink
+
+#endif  // INK_STROKES_PERFORMANCE_PROFILE_H_
@@ -0,0 +1,257 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Benchmarks for building stroke shapes from long, real-world-like inputs.
+//
+// The recorded straight line and spring inputs are chained end-to-end and
+// re-timed to a 240Hz stylus report rate, so that strokes of any length can be
+// built from real pen motion. Each benchmark reports, alongside wall time:
+//   * `vertices`: mesh vertices produced per second.
+//   * `allocs_per_update`: heap allocations per shape update.
+//   * `p99_update_us`: the 99th percentile latency of a single shape update.
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/statusor.h"
+#include "benchmark/benchmark.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_behavior.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/color/color.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/rect.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/recorded_test_inputs.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/internal/allocation_counter.h"
+
+namespace ink {
+namespace {
+
+constexpr float kInputBoundsSize = 200;
+constexpr float kBrushSize = 10;
+constexpr float kBrushEpsilon = 0.01;
+constexpr float kInputRateHz = 240;
+// Stylus inputs are typically delivered to the app once per 60Hz frame.
+constexpr int kRealInputsPerUpdate = 4;
+constexpr int kPredictedInputsPerUpdate = 2;
+
+// Brushes approximating the kinds of stock brush families that apps ship with.
+// The canonical stock families are defined outside of the C++ library, so
+// these only aim to exercise the same tip shapes and behaviors.
+enum class FamilyKind { kMarker, kPressurePen, kHighlighter, kParticles };
+
+constexpr FamilyKind kAllFamilyKinds[] = {
+    FamilyKind::kMarker,
+    FamilyKind::kPressurePen,
+    FamilyKind::kHighlighter,
+    FamilyKind::kParticles,
+};
+
+BrushTip MakeBrushTip(FamilyKind kind) {
+  switch (kind) {
+    case FamilyKind::kMarker:
+      return BrushTip{.scale = {1, 1}, .corner_rounding = 1};
+    case FamilyKind::kPressurePen:
+      return BrushTip{
+          .scale = {1, 1},
+          .corner_rounding = 1,
+          .behaviors = {BrushBehavior{{
+              BrushBehavior::SourceNode{
+                  .source = BrushBehavior::Source::kNormalizedPressure,
+                  .source_value_range = {0, 1},
+              },
+              BrushBehavior::DampingNode{
+                  .damping_source =
+                      BrushBehavior::DampingSource::kTimeInSeconds,
+                  .damping_gap = 0.02,
+              },
+              BrushBehavior::TargetNode{
+                  .target = BrushBehavior::Target::kSizeMultiplier,
+                  .target_modifier_range = {0.5, 1.5},
+              },
+          }}}};
+    case FamilyKind::kHighlighter:
+      return BrushTip{.scale = {0.25, 1}, .corner_rounding = 0.3};
+    case FamilyKind::kParticles:
+      return BrushTip{.scale = {0.5, 0.5},
+                      .corner_rounding = 1,
+                      .particle_gap_distance_scale = 0.5};
+  }
+  ABSL_LOG(FATAL) << "Unhandled FamilyKind: " << static_cast<int>(kind);
+}
+
+Brush MakeBrush(FamilyKind kind) {
+  absl::StatusOr<BrushFamily> family =
+      BrushFamily::Create(MakeBrushTip(kind), BrushPaint{});
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush = Brush::Create(
+      *std::move(family), Color::Black(), kBrushSize, kBrushEpsilon);
+  ABSL_CHECK_OK(brush);
+  return *std::move(brush);
+}
+
+// Returns at least `min_input_count` recorded inputs arriving at
+// `kInputRateHz`.
+StrokeInputBatch MakeInputs(size_t min_input_count) {
+  return MakeLongRecordedInputs(
+      Rect::FromTwoPoints({0, 0}, {kInputBoundsSize, kInputBoundsSize}),
+      min_input_count, kInputRateHz);
+}
+
+// Splits `inputs` into per-update slices of `kRealInputsPerUpdate` real inputs,
+// each paired with the next `kPredictedInputsPerUpdate` inputs as prediction.
+std::vector<std::pair<StrokeInputBatch, StrokeInputBatch>> SplitIntoUpdates(
+    const StrokeInputBatch& inputs) {
+  std::vector<std::pair<StrokeInputBatch, StrokeInputBatch>> updates;
+  for (size_t start = 0; start < inputs.Size();
+       start += kRealInputsPerUpdate) {
+    size_t real_end = std::min(start + kRealInputsPerUpdate, inputs.Size());
+    size_t predicted_end =
+        std::min(real_end + kPredictedInputsPerUpdate, inputs.Size());
+    StrokeInputBatch real;
+    StrokeInputBatch predicted;
+    for (size_t i = start; i < real_end; ++i) {
+      ABSL_CHECK_OK(real.Append(inputs.Get(i)));
+    }
+    for (size_t i = real_end; i < predicted_end; ++i) {
+      ABSL_CHECK_OK(predicted.Append(inputs.Get(i)));
+    }
+    updates.emplace_back(std::move(real), std::move(predicted));
+  }
+  return updates;
+}
+
+size_t MeshVertexCount(const InProgressStroke& stroke) {
+  size_t count = 0;
+  for (uint32_t i = 0; i < stroke.BrushCoatCount(); ++i) {
+    count += stroke.GetMesh(i).VertexCount();
+  }
+  return count;
+}
+
+size_t MeshVertexCount(const PartitionedMesh& shape) {
+  size_t count = 0;
+  for (uint32_t group = 0; group < shape.RenderGroupCount(); ++group) {
+    for (const Mesh& mesh : shape.RenderGroupMeshes(group)) {
+      count += mesh.VertexCount();
+    }
+  }
+  return count;
+}
+
+// Accumulates the metrics reported by every benchmark in this file.
+class UpdateMetrics {
+ public:
+  // Runs and times `update` as a single shape update.
+  template <typename Update>
+  void Measure(Update update) {
+    int64_t allocations_before =
+        ink_internal::GetAllocationStats().allocations;
+    auto start = std::chrono::steady_clock::now();
+    update();
+    auto end = std::chrono::steady_clock::now();
+    allocations_ +=
+        ink_internal::GetAllocationStats().allocations - allocations_before;
+    latencies_.push_back(end - start);
+  }
+
+  void AddVertices(size_t count) { vertices_ += count; }
+
+  void Report(benchmark::State& state) {
+    state.counters["vertices"] =
+        benchmark::Counter(vertices_, benchmark::Counter::kIsRate);
+    state.counters["allocs_per_update"] =
+        latencies_.empty() ? 0 : allocations_ / latencies_.size();
+    if (!latencies_.empty()) {
+      auto p99 = latencies_.begin() + (latencies_.size() * 99) / 100;
+      std::nth_element(latencies_.begin(), p99, latencies_.end());
+      state.counters["p99_update_us"] =
+          std::chrono::duration<double, std::micro>(*p99).count();
+    }
+  }
+
+ private:
+  std::vector<std::chrono::steady_clock::duration> latencies_;
+  double allocations_ = 0;
+  double vertices_ = 0;
+};
+
+// Builds the stroke the way an app does while it is being drawn, with one
+// shape update per frame of real and predicted inputs.
+void BM_IncrementalRecordedInputs(benchmark::State& state) {
+  Brush brush = MakeBrush(kAllFamilyKinds[state.range(0)]);
+  std::vector<std::pair<StrokeInputBatch, StrokeInputBatch>> updates =
+      SplitIntoUpdates(MakeInputs(state.range(1)));
+  InProgressStroke stroke;
+  UpdateMetrics metrics;
+
+  for (auto _ : state) {
+    stroke.Start(brush);
+    for (const auto& [real, predicted] : updates) {
+      metrics.Measure([&] {
+        ABSL_CHECK_OK(stroke.EnqueueInputs(real, predicted));
+        ABSL_CHECK_OK(
+            stroke.UpdateShape(real.Get(real.Size() - 1).elapsed_time));
+      });
+    }
+    stroke.FinishInputs();
+    metrics.Measure([&] {
+      ABSL_CHECK_OK(stroke.UpdateShape(stroke.GetInputs().GetDuration()));
+    });
+    metrics.AddVertices(MeshVertexCount(stroke));
+    benchmark::DoNotOptimize(stroke);
+  }
+  metrics.Report(state);
+}
+BENCHMARK(BM_IncrementalRecordedInputs)
+    ->ArgNames({"family", "inputs"})
+    ->ArgsProduct({{0, 1, 2, 3}, {1000, 10000, 20000}});
+
+// Builds the stroke from all of its inputs at once, as when a stroke is loaded.
+void BM_CompleteRecordedInputs(benchmark::State& state) {
+  Brush brush = MakeBrush(kAllFamilyKinds[state.range(0)]);
+  StrokeInputBatch inputs = MakeInputs(state.range(1));
+  UpdateMetrics metrics;
+
+  for (auto _ : state) {
+    size_t vertex_count = 0;
+    metrics.Measure([&] {
+      Stroke stroke(brush, inputs);
+      vertex_count = MeshVertexCount(stroke.GetShape());
+      benchmark::DoNotOptimize(stroke);
+    });
+    metrics.AddVertices(vertex_count);
+  }
+  metrics.Report(state);
+}
+BENCHMARK(BM_CompleteRecordedInputs)
+    ->ArgNames({"family", "inputs"})
+    ->ArgsProduct({{0, 1, 2, 3}, {1000, 10000, 20000}});
+
+}  // namespace
+}  // namespace ink
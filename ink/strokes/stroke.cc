@@ -14,30 +14,61 @@
 
 #include "ink/strokes/stroke.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/base/call_once.h"
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/algorithm/container.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "ink/brush/brush.h"
 #include "ink/brush/brush_coat.h"
 #include "ink/brush/brush_family.h"
 #include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/mesh_format.h"
 #include "ink/geometry/mutable_mesh.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/rect.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/internal/stroke_input_modeler.h"
 #include "ink/strokes/internal/stroke_shape_builder.h"
+#include "ink/strokes/internal/stroke_shape_builder_pool.h"
 #include "ink/strokes/internal/stroke_vertex.h"
+#include "ink/strokes/performance_profile.h"
+#include "ink/strokes/stroke_shape_cache.h"
+#include "ink/types/cancellation_token.h"
 #include "ink/types/duration.h"
+#include "ink/types/executor.h"
+#include "ink/types/memory_footprint.h"
+#include "ink/types/small_array.h"
+#include "ink/types/trace.h"
 
 namespace ink {
 namespace {
 
+using ::ink::strokes_internal::ModeledStrokeInput;
+using ::ink::strokes_internal::StrokeInputModeler;
 using ::ink::strokes_internal::StrokeShapeBuilder;
+using ::ink::strokes_internal::StrokeShapeBuilderPool;
 using ::ink::strokes_internal::StrokeVertex;
 
 bool BrushCoatTipsAreEqual(absl::Span<const BrushCoat> coats1,
@@ -53,29 +84,283 @@ bool BrushCoatTipsAreEqual(absl::Span<const BrushCoat> coats1,
   return true;
 }
 
+// Returns the scale factor of `transform` if its linear part is a rotation and
+// uniform scale, to within `tolerance` in the output space for every point of
+// `bounds`, or nullopt otherwise. Reflections are never accepted, since they
+// would flip the winding of the mesh triangles.
+std::optional<float> SimilarityScaleWithinTolerance(
+    const AffineTransform& transform, const Rect& bounds, float tolerance) {
+  // The linear part splits into a rotation and uniform scale [p -q; q p], and a
+  // remainder [u v; v -u] that stretches by hypot(u, v) along some axis.
+  float p = 0.5f * (transform.A() + transform.E());
+  float q = 0.5f * (transform.D() - transform.B());
+  float u = 0.5f * (transform.A() - transform.E());
+  float v = 0.5f * (transform.B() + transform.D());
+  float scale = std::hypot(p, q);
+  float determinant =
+      transform.A() * transform.E() - transform.B() * transform.D();
+  if (!std::isfinite(scale) || scale <= 0 || !(determinant > 0)) {
+    return std::nullopt;
+  }
+  // Relative to the similarity transform that agrees with `transform` at the
+  // center of `bounds`, no point of `bounds` moves further than the remainder's
+  // stretch times half the diagonal.
+  float half_diagonal = 0.5f * std::hypot(bounds.Width(), bounds.Height());
+  if (std::hypot(u, v) * half_diagonal > tolerance * scale) return std::nullopt;
+  return scale;
+}
+
+// Returns the index in `format` of the attribute with `id`, or nullopt if there
+// is none.
+std::optional<uint32_t> FindAttributeIndex(const MeshFormat& format,
+                                           MeshFormat::AttributeId id) {
+  absl::Span<const MeshFormat::Attribute> attributes = format.Attributes();
+  for (uint32_t i = 0; i < attributes.size(); ++i) {
+    if (attributes[i].id == id) return i;
+  }
+  return std::nullopt;
+}
+
+// Returns a copy of `shape` with `transform` applied to the vertex positions
+// and to the side and forward derivatives of every mesh. The meshes are
+// repacked one-to-one, so that the outlines and the structure of the spatial
+// index (if initialized) still refer to the same vertices and triangles.
+absl::StatusOr<PartitionedMesh> TransformShape(
+    const PartitionedMesh& shape, const AffineTransform& transform) {
+  uint32_t group_count = shape.RenderGroupCount();
+  std::vector<std::vector<Mesh>> group_meshes(group_count);
+  std::vector<std::vector<std::vector<PartitionedMesh::VertexIndexPair>>>
+      group_outline_pairs(group_count);
+  std::vector<std::vector<absl::Span<const PartitionedMesh::VertexIndexPair>>>
+      group_outlines(group_count);
+  std::vector<PartitionedMesh::MeshGroup> groups(group_count);
+  for (uint32_t group = 0; group < group_count; ++group) {
+    for (const Mesh& mesh : shape.RenderGroupMeshes(group)) {
+      MutableMesh mutable_mesh = MutableMesh::FromMesh(mesh);
+      mutable_mesh.TransformVertexPositions(transform);
+      for (MeshFormat::AttributeId id :
+           {MeshFormat::AttributeId::kSideDerivative,
+            MeshFormat::AttributeId::kForwardDerivative}) {
+        std::optional<uint32_t> attribute_index =
+            FindAttributeIndex(mutable_mesh.Format(), id);
+        if (!attribute_index.has_value()) continue;
+        for (uint32_t i = 0; i < mutable_mesh.VertexCount(); ++i) {
+          SmallArray<float, 4> value =
+              mutable_mesh.FloatVertexAttribute(i, *attribute_index);
+          mutable_mesh.SetFloatVertexAttribute(
+              i, *attribute_index,
+              {transform.A() * value[0] + transform.B() * value[1],
+               transform.D() * value[0] + transform.E() * value[1]});
+        }
+      }
+      StrokeVertex::CustomPackingArray packing_params =
+          StrokeVertex::MakeCustomPackingArray(mutable_mesh.Format());
+      absl::StatusOr<absl::InlinedVector<Mesh, 1>> meshes =
+          mutable_mesh.AsMeshes(packing_params.Values());
+      if (!meshes.ok()) return meshes.status();
+      // A `Mesh` never has more vertices than fit in 16-bit indices, so it is
+      // never split when repacked.
+      ABSL_CHECK_EQ(meshes->size(), 1u);
+      group_meshes[group].push_back(std::move((*meshes)[0]));
+    }
+    for (uint32_t i = 0; i < shape.OutlineCount(group); ++i) {
+      PartitionedMesh::OutlineView outline = shape.Outline(group, i);
+      group_outline_pairs[group].emplace_back(outline.begin(), outline.end());
+    }
+    group_outlines[group].assign(group_outline_pairs[group].begin(),
+                                 group_outline_pairs[group].end());
+    groups[group] = {.meshes = group_meshes[group],
+                     .outlines = group_outlines[group]};
+  }
+  absl::StatusOr<PartitionedMesh> transformed =
+      PartitionedMesh::FromMeshGroups(groups);
+  if (!transformed.ok()) return transformed.status();
+  if (shape.IsSpatialIndexInitialized()) {
+    // A similarity transform keeps the relative sizes and positions of the
+    // triangles, so the structure of the old index is still a good one.
+    if (absl::Status status = transformed->InitializeSpatialIndexFromStructure(
+            shape.GetSpatialIndexStructure());
+        !status.ok()) {
+      return status;
+    }
+  }
+  return transformed;
+}
+
 }  // namespace
 
+// Each level is generated at most once, on first access. The brush and inputs
+// are passed in by the owning `Stroke` rather than stored, since every `Stroke`
+// sharing an instance of this class has the same brush and inputs.
+class Stroke::LevelOfDetailShapes {
+ public:
+  const PartitionedMesh& Get(uint32_t level, const Brush& brush,
+                             const StrokeInputBatch& inputs) {
+    ABSL_DCHECK_GT(level, 0u);
+    ABSL_DCHECK_LE(level, kMaxLevelOfDetail);
+    Level& lod = levels_[level - 1];
+    absl::call_once(lod.once, [level, &brush, &inputs, &lod] {
+      Brush lod_brush = brush;
+      ABSL_CHECK_OK(lod_brush.SetEpsilon(std::min(
+          std::ldexp(brush.GetEpsilon(), level), brush.GetSize())));
+      if (absl::Status status = GenerateShape(
+              lod_brush, inputs, /* coat_executor = */ nullptr, lod.shape);
+          !status.ok()) {
+        ABSL_LOG(WARNING) << "Failed to create PartitionedMesh for level of "
+                             "detail "
+                          << level << ": " << status;
+      }
+      lod.is_generated.store(true, std::memory_order_release);
+    });
+    return lod.shape;
+  }
+
+  // Adds the shapes of the levels that have been generated so far. Levels that
+  // are still being generated are skipped.
+  void AddToMemoryFootprint(MemoryFootprint& footprint) const {
+    if (!footprint.AddShared(this)) return;
+    footprint.AddBytes(sizeof(LevelOfDetailShapes));
+    for (const Level& lod : levels_) {
+      if (lod.is_generated.load(std::memory_order_acquire)) {
+        lod.shape.AddToMemoryFootprint(footprint);
+      }
+    }
+  }
+
+ private:
+  struct Level {
+    absl::once_flag once;
+    // Set once `shape` has been generated, after which it is never modified.
+    std::atomic<bool> is_generated = false;
+    PartitionedMesh shape;
+  };
+
+  std::array<Level, kMaxLevelOfDetail> levels_;
+};
+
 Stroke::Stroke(const Brush& brush)
     : brush_(brush),
-      shape_(PartitionedMesh::WithEmptyGroups(brush_.CoatCount())) {}
+      shape_(PartitionedMesh::WithEmptyGroups(brush_.CoatCount())),
+      lod_shapes_(std::make_shared<LevelOfDetailShapes>()) {}
 
-Stroke::Stroke(const Brush& brush, const StrokeInputBatch& inputs)
+Stroke::Stroke(const Brush& brush, const StrokeInputBatch& inputs,
+               Executor* absl_nullable coat_executor)
     : brush_(brush), inputs_(inputs) {
-  RegenerateShape();
+  RegenerateShape(coat_executor);
 }
 
 Stroke::Stroke(const Brush& brush, const StrokeInputBatch& inputs,
                const PartitionedMesh& shape)
-    : brush_(brush), inputs_(inputs), shape_(shape) {
+    : brush_(brush),
+      inputs_(inputs),
+      shape_(shape),
+      lod_shapes_(std::make_shared<LevelOfDetailShapes>()) {
   ABSL_CHECK_EQ(shape_.RenderGroupCount(), brush_.CoatCount())
       << "`shape` must have one render group per brush coat in `brush`";
 }
 
+// The shape data for a stroke created by `WithLazyShape()`. The brush and
+// inputs are copied rather than read from the owning `Stroke`, since setters
+// that do not regenerate the shape may change the stroke's brush afterwards.
+class Stroke::LazyShape {
+ public:
+  LazyShape(const Brush& brush, const StrokeInputBatch& inputs)
+      : brush_(brush), inputs_(inputs) {}
+
+  const PartitionedMesh& Get(Executor* absl_nullable coat_executor) {
+    absl::call_once(once_, [this, coat_executor] {
+      if (absl::Status status =
+              GenerateShape(*brush_, inputs_, coat_executor, shape_);
+          !status.ok()) {
+        ABSL_LOG(WARNING) << "Failed to create PartitionedMesh: " << status;
+      }
+      // The brush and inputs are no longer needed once the shape exists.
+      brush_.reset();
+      inputs_ = StrokeInputBatch();
+      is_generated_.store(true, std::memory_order_release);
+    });
+    return shape_;
+  }
+
+  // Adds the shape if it has been generated. Until then, the pending brush and
+  // inputs are the same as those of the owning `Stroke`, which counts them.
+  void AddToMemoryFootprint(MemoryFootprint& footprint) const {
+    if (!footprint.AddShared(this)) return;
+    footprint.AddBytes(sizeof(LazyShape));
+    if (is_generated_.load(std::memory_order_acquire)) {
+      shape_.AddToMemoryFootprint(footprint);
+    }
+  }
+
+ private:
+  absl::once_flag once_;
+  // Set once `shape_` has been generated, after which none of the members
+  // below are modified.
+  std::atomic<bool> is_generated_ = false;
+  std::optional<Brush> brush_;
+  StrokeInputBatch inputs_;
+  PartitionedMesh shape_;
+};
+
+Stroke Stroke::WithLazyShape(const Brush& brush,
+                             const StrokeInputBatch& inputs) {
+  Stroke stroke(brush);
+  stroke.inputs_ = inputs;
+  if (!inputs.IsEmpty()) {
+    stroke.lazy_shape_ = std::make_shared<LazyShape>(brush, inputs);
+  }
+  return stroke;
+}
+
+const PartitionedMesh& Stroke::GetShape() const {
+  if (lazy_shape_ == nullptr) return shape_;
+  return lazy_shape_->Get(/* coat_executor = */ nullptr);
+}
+
+void Stroke::PrefetchShape(Executor* absl_nullable coat_executor) const {
+  if (lazy_shape_ != nullptr) lazy_shape_->Get(coat_executor);
+}
+
+void Stroke::AddToMemoryFootprint(MemoryFootprint& footprint) const {
+  brush_.GetFamily().AddToMemoryFootprint(footprint);
+  inputs_.AddToMemoryFootprint(footprint);
+  shape_.AddToMemoryFootprint(footprint);
+  if (lazy_shape_ != nullptr) lazy_shape_->AddToMemoryFootprint(footprint);
+  lod_shapes_->AddToMemoryFootprint(footprint);
+}
+
+const PartitionedMesh& Stroke::GetShapeAtLevelOfDetail(uint32_t level) const {
+  ABSL_CHECK_LE(level, kMaxLevelOfDetail);
+  if (level == 0) return GetShape();
+  return lod_shapes_->Get(level, brush_, inputs_);
+}
+
+uint32_t Stroke::LevelOfDetailForScale(float object_to_canvas_scale) {
+  if (!std::isfinite(object_to_canvas_scale) || object_to_canvas_scale <= 0 ||
+      object_to_canvas_scale >= 1) {
+    return 0;
+  }
+  // Level `n` has `2^n` times the error of level 0, which scales back down to
+  // at most the brush epsilon when `2^n * object_to_canvas_scale <= 1`.
+  float max_level = std::floor(-std::log2(object_to_canvas_scale));
+  return max_level >= kMaxLevelOfDetail ? kMaxLevelOfDetail
+                                        : static_cast<uint32_t>(max_level);
+}
+
+uint32_t Stroke::LevelOfDetailForScale(float object_to_canvas_scale,
+                                       const PerformanceProfile& profile) {
+  uint32_t level = LevelOfDetailForScale(object_to_canvas_scale);
+  return kMaxLevelOfDetail - level <= profile.level_of_detail_bias
+             ? kMaxLevelOfDetail
+             : level + profile.level_of_detail_bias;
+}
+
 void Stroke::SetBrushAndInputs(const Brush& brush,
-                               const StrokeInputBatch& inputs) {
+                               const StrokeInputBatch& inputs,
+                               Executor* absl_nullable coat_executor) {
   brush_ = brush;
   inputs_ = inputs;
-  RegenerateShape();
+  RegenerateShape(coat_executor);
 }
 
 void Stroke::SetBrush(const Brush& brush) {
@@ -86,7 +371,9 @@ void Stroke::SetBrush(const Brush& brush) {
 
   brush_ = brush;
   if (needs_regenerate) {
-    RegenerateShape();
+    RegenerateOrDeferShape();
+  } else {
+    lod_shapes_ = std::make_shared<LevelOfDetailShapes>();
   }
 }
 
@@ -95,7 +382,9 @@ void Stroke::SetBrushFamily(const BrushFamily& brush_family) {
       !BrushCoatTipsAreEqual(brush_family.GetCoats(), brush_.GetCoats());
   brush_.SetFamily(brush_family);
   if (needs_regenerate) {
-    RegenerateShape();
+    RegenerateOrDeferShape();
+  } else {
+    lod_shapes_ = std::make_shared<LevelOfDetailShapes>();
   }
 }
 
@@ -109,7 +398,18 @@ absl::Status Stroke::SetBrushSize(float size) {
   if (!status.ok()) {
     return status;
   }
-  RegenerateShape();
+  RegenerateOrDeferShape();
+  return absl::OkStatus();
+}
+
+absl::Status Stroke::SetBrushSizeWithLazyShape(float size) {
+  if (size == brush_.GetSize()) {
+    return absl::OkStatus();
+  }
+  if (absl::Status status = brush_.SetSize(size); !status.ok()) {
+    return status;
+  }
+  DeferShape();
   return absl::OkStatus();
 }
 
@@ -121,7 +421,61 @@ absl::Status Stroke::SetBrushEpsilon(float epsilon) {
   if (!status.ok()) {
     return status;
   }
-  RegenerateShape();
+  RegenerateOrDeferShape();
+  return absl::OkStatus();
+}
+
+absl::Status Stroke::ApplyTransform(const AffineTransform& transform,
+                                    Executor* absl_nullable coat_executor) {
+  if (!transform.Inverse().has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`transform` must be invertible, got ", transform));
+  }
+  StrokeInputBatch transformed_inputs = inputs_;
+  transformed_inputs.Transform(transform);
+
+  // A deferred shape stays deferred, and is generated from the transformed
+  // inputs if it is ever needed.
+  if (lazy_shape_ != nullptr) {
+    inputs_ = std::move(transformed_inputs);
+    DeferShape();
+    return absl::OkStatus();
+  }
+
+  std::optional<float> scale;
+  if (const std::optional<Rect>& bounds = shape_.Bounds().AsRect();
+      bounds.has_value()) {
+    scale = SimilarityScaleWithinTolerance(transform, *bounds,
+                                           brush_.GetEpsilon());
+  }
+  if (!scale.has_value()) {
+    inputs_ = std::move(transformed_inputs);
+    RegenerateShape(coat_executor);
+    return absl::OkStatus();
+  }
+
+  Brush scaled_brush = brush_;
+  if (absl::Status status = scaled_brush.SetSize(*scale * brush_.GetSize());
+      !status.ok()) {
+    return status;
+  }
+  if (absl::Status status =
+          scaled_brush.SetEpsilon(*scale * brush_.GetEpsilon());
+      !status.ok()) {
+    return status;
+  }
+  absl::StatusOr<PartitionedMesh> transformed_shape =
+      TransformShape(shape_, transform);
+  brush_ = std::move(scaled_brush);
+  inputs_ = std::move(transformed_inputs);
+  if (!transformed_shape.ok()) {
+    ABSL_LOG(WARNING) << "Failed to transform stroke shape, regenerating: "
+                      << transformed_shape.status();
+    RegenerateShape(coat_executor);
+    return absl::OkStatus();
+  }
+  shape_ = *std::move(transformed_shape);
+  lod_shapes_ = std::make_shared<LevelOfDetailShapes>();
   return absl::OkStatus();
 }
 
@@ -136,14 +490,244 @@ namespace {
 // Resources for stroke shape generation grouped into a struct for simpler
 // `thread_local` variable creation in `RegenerateShape()` below.
 struct ShapeGenerationResources {
+  StrokeInputModeler input_modeler;
+  // Builders borrowed from the thread's `StrokeShapeBuilderPool` for the
+  // duration of a single call to `TryRegenerateShape()`.
   std::vector<StrokeShapeBuilder> builders;
   std::vector<StrokeVertex::CustomPackingArray> custom_packing_arrays;
   std::vector<PartitionedMesh::MutableMeshGroup> mesh_groups;
 };
 
+// Builds the shape of every coat of `brush` into `shape`, from the modeled
+// inputs of `resources.input_modeler`, building the coats concurrently on
+// `coat_executor` if it is non-null. On failure or cancellation, returns an
+// error and sets `shape` to have only empty render groups.
+absl::Status BuildShapeFromModeledInputs(
+    const Brush& brush, uint32_t noise_seed,
+    Executor* absl_nullable coat_executor,
+    const CancellationToken* absl_nullable cancellation,
+    ShapeGenerationResources& resources, PartitionedMesh& shape) {
+  absl::Span<const BrushCoat> coats = brush.GetCoats();
+  size_t num_coats = coats.size();
+
+  // Borrow one builder per coat from the pool, which retains their allocations
+  // between strokes unless a stroke grows them past the pool's limits.
+  StrokeShapeBuilderPool& builder_pool =
+      StrokeShapeBuilderPool::ForCurrentThread();
+  while (resources.builders.size() < num_coats) {
+    resources.builders.push_back(builder_pool.Acquire());
+  }
+  resources.custom_packing_arrays.resize(num_coats);
+  resources.mesh_groups.resize(num_coats);
+
+  // Each task only writes to the elements of `resources` for its own coat. The
+  // resources are captured through a reference so that tasks running on other
+  // threads use this thread's `resources` rather than their own.
+  ParallelFor(coat_executor, num_coats,
+              [&brush, noise_seed, coats, cancellation, &resources](size_t i) {
+                StrokeShapeBuilder& builder = resources.builders[i];
+                builder.StartStroke(coats[i], brush.GetSize(),
+                                    brush.GetEpsilon(), noise_seed);
+                builder.ReserveForModeledInputCount(
+                    resources.input_modeler.GetModeledInputs().size());
+                builder.ExtendStroke(resources.input_modeler, cancellation);
+
+                const MutableMesh& mesh = builder.GetMesh();
+                resources.custom_packing_arrays[i] =
+                    StrokeVertex::MakeCustomPackingArray(mesh.Format());
+                resources.mesh_groups[i] = {
+                    .mesh = &mesh,
+                    .outlines = builder.GetOutlines(),
+                    .packing_params =
+                        resources.custom_packing_arrays[i].Values(),
+                };
+              });
+
+  // A coat whose extrusion was cancelled is incomplete, so the cancellation is
+  // checked again before packing the meshes.
+  absl::StatusOr<PartitionedMesh> partitioned_mesh =
+      cancellation != nullptr && cancellation->IsCancelled()
+          ? absl::CancelledError("Stroke shape generation was cancelled")
+          : PartitionedMesh::FromMutableMeshGroups(resources.mesh_groups,
+                                                   coat_executor);
+  for (StrokeShapeBuilder& builder : resources.builders) {
+    builder_pool.Release(std::move(builder));
+  }
+  resources.builders.clear();
+  if (!partitioned_mesh.ok()) {
+    shape = PartitionedMesh::WithEmptyGroups(brush.CoatCount());
+    return partitioned_mesh.status();
+  }
+  shape = *std::move(partitioned_mesh);
+  return absl::OkStatus();
+}
+
 }  // namespace
 
-void Stroke::RegenerateShape() {
+std::vector<absl::Status> Stroke::RegenerateShapes(
+    absl::Span<Stroke* absl_nonnull const> strokes, Executor& executor) {
+  std::vector<absl::Status> statuses(strokes.size());
+  // Each task regenerates one whole stroke. Coats are not further split into
+  // tasks on `executor`, since a task must not block on other tasks run by the
+  // same executor.
+  ParallelFor(&executor, strokes.size(), [strokes, &statuses](size_t i) {
+    ABSL_DCHECK_NE(strokes[i], nullptr);
+    statuses[i] = strokes[i]->TryRegenerateShape(/* coat_executor = */ nullptr);
+  });
+  return statuses;
+}
+
+std::vector<Stroke> Stroke::SplitAtErasedInputs(
+    absl::Span<const InputRange> erased_ranges) const {
+  ScopedTraceEvent trace_event("ink::Stroke::SplitAtErasedInputs");
+  size_t input_count = inputs_.Size();
+  std::vector<bool> erased(input_count, false);
+  for (const InputRange& range : erased_ranges) {
+    for (size_t i = range.start; i < std::min(range.end, input_count); ++i) {
+      erased[i] = true;
+    }
+  }
+  std::vector<InputRange> pieces;
+  for (size_t i = 0; i < input_count;) {
+    if (erased[i]) {
+      ++i;
+      continue;
+    }
+    InputRange& piece = pieces.emplace_back(InputRange{.start = i});
+    while (i < input_count && !erased[i]) ++i;
+    piece.end = i;
+  }
+  if (pieces.size() == 1 && pieces[0].start == 0 &&
+      pieces[0].end == input_count) {
+    return {*this};
+  }
+  if (pieces.empty()) return {};
+
+  // Model the inputs of the whole stroke once, the same way as for its shape.
+  ShapeGenerationResources source;
+  source.input_modeler.StartStroke(brush_.GetFamily().GetInputModel(),
+                                   brush_.GetEpsilon());
+  source.input_modeler.ExtendStroke(inputs_, StrokeInputBatch(),
+                                    Duration32::Infinite());
+  absl::Span<const ModeledStrokeInput> modeled_inputs =
+      source.input_modeler.GetModeledInputs();
+
+  ShapeGenerationResources piece_gen;
+  std::vector<Stroke> pieces_out;
+  pieces_out.reserve(pieces.size());
+  for (const InputRange& piece : pieces) {
+    Stroke& stroke = pieces_out.emplace_back(brush_);
+    stroke.inputs_ = inputs_.Slice(piece.start, piece.end - piece.start);
+
+    // Use the modeled inputs from the time of the first input of the piece to
+    // the time of its last input. The last piece of the stroke also keeps the
+    // modeled inputs that catch up with the last input after its time.
+    Duration32 start_time = inputs_.Get(piece.start).elapsed_time;
+    Duration32 end_time = inputs_.Get(piece.end - 1).elapsed_time;
+    size_t modeled_start = 0;
+    if (piece.start > 0) {
+      modeled_start = absl::c_partition_point(
+          modeled_inputs, [start_time](const ModeledStrokeInput& input) {
+            return input.elapsed_time < start_time;
+          }) - modeled_inputs.begin();
+    }
+    size_t modeled_end = modeled_inputs.size();
+    if (piece.end < input_count) {
+      modeled_end = absl::c_partition_point(
+          modeled_inputs, [end_time](const ModeledStrokeInput& input) {
+            return input.elapsed_time <= end_time;
+          }) - modeled_inputs.begin();
+    }
+
+    absl::Status status;
+    if (modeled_start < modeled_end) {
+      piece_gen.input_modeler.StartStrokeFromModeledInputs(
+          source.input_modeler, modeled_start, modeled_end);
+      status = BuildShapeFromModeledInputs(
+          brush_, inputs_.GetNoiseSeed(), /* coat_executor = */ nullptr,
+          /* cancellation = */ nullptr, piece_gen, stroke.shape_);
+    } else {
+      status = stroke.TryRegenerateShape(/* coat_executor = */ nullptr);
+    }
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Failed to create PartitionedMesh: " << status;
+    }
+  }
+  return pieces_out;
+}
+
+void Stroke::RegenerateShapesAsync(
+    std::vector<Stroke> strokes, Executor& executor,
+    CancellationToken cancellation,
+    absl::AnyInvocable<void(size_t index, absl::StatusOr<Stroke> stroke)>
+        on_done) {
+  // Shared by the tasks, and kept alive by the last one to finish.
+  struct SharedState {
+    std::vector<Stroke> strokes;
+    CancellationToken cancellation;
+    absl::Mutex on_done_mutex;
+    absl::AnyInvocable<void(size_t, absl::StatusOr<Stroke>)> on_done
+        ABSL_GUARDED_BY(on_done_mutex);
+  };
+  auto state = std::make_shared<SharedState>();
+  state->strokes = std::move(strokes);
+  state->cancellation = std::move(cancellation);
+  state->on_done = std::move(on_done);
+
+  for (size_t i = 0; i < state->strokes.size(); ++i) {
+    executor.Schedule([state, i]() {
+      ScopedTraceEvent trace_event("ink::Stroke::RegenerateShapesAsync");
+      Stroke& stroke = state->strokes[i];
+      // Each task regenerates one whole stroke, without further splitting its
+      // coats into tasks, as in `RegenerateShapes()`.
+      absl::Status status = stroke.TryRegenerateShape(
+          /* coat_executor = */ nullptr, &state->cancellation);
+      absl::StatusOr<Stroke> result = std::move(stroke);
+      if (!status.ok()) result = status;
+      absl::MutexLock lock(&state->on_done_mutex);
+      state->on_done(i, std::move(result));
+    });
+  }
+}
+
+void Stroke::RegenerateShape(Executor* absl_nullable coat_executor) {
+  ScopedTraceEvent trace_event("ink::Stroke::RegenerateShape");
+  if (absl::Status status = TryRegenerateShape(coat_executor); !status.ok()) {
+    ABSL_LOG(WARNING) << "Failed to create PartitionedMesh: " << status;
+  }
+}
+
+void Stroke::DeferShape() {
+  shape_ = PartitionedMesh::WithEmptyGroups(brush_.CoatCount());
+  lod_shapes_ = std::make_shared<LevelOfDetailShapes>();
+  if (inputs_.IsEmpty()) {
+    // There is nothing to defer; this just makes the empty render groups.
+    RegenerateShape();
+    return;
+  }
+  lazy_shape_ = std::make_shared<LazyShape>(brush_, inputs_);
+}
+
+void Stroke::RegenerateOrDeferShape() {
+  if (lazy_shape_ != nullptr) {
+    DeferShape();
+  } else {
+    RegenerateShape();
+  }
+}
+
+absl::Status Stroke::TryRegenerateShape(
+    Executor* absl_nullable coat_executor,
+    const CancellationToken* absl_nullable cancellation) {
+  lazy_shape_.reset();
+  lod_shapes_ = std::make_shared<LevelOfDetailShapes>();
+  return GenerateShape(brush_, inputs_, coat_executor, shape_, cancellation);
+}
+
+absl::Status Stroke::GenerateShape(
+    const Brush& brush, const StrokeInputBatch& inputs,
+    Executor* absl_nullable coat_executor, PartitionedMesh& shape,
+    const CancellationToken* absl_nullable cancellation) {
   // Create thread local stroke shape resources to save allocations if
   // `thread_local` is supported, which is almost always. If not, fall back to a
   // regular local variable.
@@ -152,60 +736,55 @@ void Stroke::RegenerateShape() {
 #endif
       ShapeGenerationResources shape_gen;
 
-  absl::Span<const BrushCoat> coats = brush_.GetCoats();
-  size_t num_coats = coats.size();
-  if (num_coats == 0 || inputs_.IsEmpty()) {
-    shape_ = PartitionedMesh::WithEmptyGroups(brush_.CoatCount());
-    return;
+  if (brush.CoatCount() == 0 || inputs.IsEmpty()) {
+    shape = PartitionedMesh::WithEmptyGroups(brush.CoatCount());
+    return absl::OkStatus();
   }
 
-  // If necessary, expand the thread-local builders vector to the number of
-  // brush coats. In order to cache all the allocations within, we never shrink
-  // this vector.
-  if (shape_gen.builders.size() < num_coats) {
-    shape_gen.builders.resize(num_coats);
-  }
-  shape_gen.custom_packing_arrays.clear();
-  shape_gen.custom_packing_arrays.reserve(num_coats);
-  shape_gen.mesh_groups.clear();
-  shape_gen.mesh_groups.reserve(num_coats);
-
-  for (size_t i = 0; i < num_coats; ++i) {
-    StrokeShapeBuilder& builder = shape_gen.builders[i];
-    builder.StartStroke(brush_.GetFamily().GetInputModel(), coats[i],
-                        brush_.GetSize(), brush_.GetEpsilon(),
-                        inputs_.GetNoiseSeed());
-
-    // A finished stroke has all of its
-    // `BrushBehavior::Source::kTimeSinceInputInMillis` and
-    // `BrushBehavior::Source::kTimeSinceInputInSeconds` behaviors completed.
-    // Passing an infinite duration to `ExtendStroke()` achieves this, in an
-    // equivalent but simpler way than looping through each behavior and finding
-    // the ones using these sources and getting their maximum range values.
-    builder.ExtendStroke(inputs_, StrokeInputBatch(), Duration32::Infinite());
-
-    const MutableMesh& mesh = builder.GetMesh();
-    shape_gen.custom_packing_arrays.push_back(
-        StrokeVertex::MakeCustomPackingArray(mesh.Format()));
-
-    shape_gen.mesh_groups.push_back({
-        .mesh = &mesh,
-        .outlines = builder.GetOutlines(),
-        .packing_params = shape_gen.custom_packing_arrays.back().Values(),
-    });
+  std::shared_ptr<StrokeShapeCache> cache =
+      StrokeShapeCache::GetProcessCache();
+  if (cache != nullptr) {
+    if (std::optional<PartitionedMesh> cached_shape =
+            cache->Find(brush, inputs)) {
+      shape = *std::move(cached_shape);
+      return absl::OkStatus();
+    }
   }
 
-  absl::StatusOr<PartitionedMesh> partitioned_mesh =
-      PartitionedMesh::FromMutableMeshGroups(shape_gen.mesh_groups);
-  if (partitioned_mesh.ok()) {
-    shape_ = *std::move(partitioned_mesh);
-  } else {
-    ABSL_LOG(WARNING) << "Failed to create PartitionedMesh: "
-                      << partitioned_mesh.status();
-    shape_ = PartitionedMesh::WithEmptyGroups(brush_.CoatCount());
+  auto is_cancelled = [cancellation]() {
+    return cancellation != nullptr && cancellation->IsCancelled();
+  };
+  auto cancelled_error = [&shape, &brush]() {
+    shape = PartitionedMesh::WithEmptyGroups(brush.CoatCount());
+    return absl::CancelledError("Stroke shape generation was cancelled");
+  };
+  if (is_cancelled()) return cancelled_error();
+
+  // All coats share the same input model and epsilon, so the inputs are
+  // modeled once and the result is used to build the shape of every coat.
+  //
+  // A finished stroke has all of its
+  // `BrushBehavior::Source::kTimeSinceInputInMillis` and
+  // `BrushBehavior::Source::kTimeSinceInputInSeconds` behaviors completed.
+  // Passing an infinite duration to `ExtendStroke()` achieves this, in an
+  // equivalent but simpler way than looping through each behavior and finding
+  // the ones using these sources and getting their maximum range values.
+  shape_gen.input_modeler.StartStroke(brush.GetFamily().GetInputModel(),
+                                      brush.GetEpsilon());
+  shape_gen.input_modeler.ExtendStroke(inputs, StrokeInputBatch(),
+                                       Duration32::Infinite());
+  if (is_cancelled()) return cancelled_error();
+
+  if (absl::Status status = BuildShapeFromModeledInputs(
+          brush, inputs.GetNoiseSeed(), coat_executor, cancellation, shape_gen,
+          shape);
+      !status.ok()) {
+    return status;
   }
 
-  ABSL_DCHECK_EQ(shape_.RenderGroupCount(), brush_.CoatCount());
+  ABSL_DCHECK_EQ(shape.RenderGroupCount(), brush.CoatCount());
+  if (cache != nullptr) cache->Insert(brush, inputs, shape);
+  return absl::OkStatus();
 }
 
 }  // namespace ink
@@ -15,13 +15,27 @@
 #ifndef INK_STROKES_STROKE_H_
 #define INK_STROKES_STROKE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "ink/brush/brush.h"
 #include "ink/brush/brush_family.h"
 #include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/partitioned_mesh.h"
 #include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/performance_profile.h"
+#include "ink/types/cancellation_token.h"
 #include "ink/types/duration.h"
+#include "ink/types/executor.h"
+#include "ink/types/memory_footprint.h"
 
 namespace ink {
 
@@ -41,7 +55,16 @@ class Stroke {
 
   // Creates a stroke using the given `brush` and `inputs` to generate the
   // shape.
-  Stroke(const Brush& brush, const StrokeInputBatch& inputs);
+  //
+  // If `coat_executor` is non-null and `brush` has more than one coat, the
+  // shape of each coat is generated concurrently by tasks run on
+  // `coat_executor`.
+  //
+  // If a process-wide `StrokeShapeCache` has been installed, the shape is taken
+  // from it when possible instead of being generated, and a newly generated
+  // shape is added to it. This also applies whenever the shape is regenerated.
+  Stroke(const Brush& brush, const StrokeInputBatch& inputs,
+         Executor* absl_nullable coat_executor = nullptr);
 
   // Constructs with the given `brush`, `inputs`, and a pre-generated
   // `shape`.
@@ -58,6 +81,17 @@ class Stroke {
   Stroke(const Brush& brush, const StrokeInputBatch& inputs,
          const PartitionedMesh& shape);
 
+  // Creates a stroke using the given `brush` and `inputs`, but defers
+  // generating its shape until the first call to `GetShape()` or
+  // `PrefetchShape()`.
+  //
+  // This is intended for loading many strokes whose shapes may not all be
+  // needed right away, such as the strokes of a large document of which only
+  // a small part is visible. Copies of the returned stroke share the deferred
+  // shape, so it is generated at most once between them.
+  static Stroke WithLazyShape(const Brush& brush,
+                              const StrokeInputBatch& inputs);
+
   Stroke(const Stroke& s) = default;
   Stroke(Stroke&& s) = default;
   Stroke& operator=(const Stroke& s) = default;
@@ -68,19 +102,79 @@ class Stroke {
   const StrokeInputBatch& GetInputs() const { return inputs_; }
   // Returns the `PartitionedMesh` for this stroke. This shape will have exactly
   // one render group per brush coat in `GetBrush()`.
-  const PartitionedMesh& GetShape() const { return shape_; }
+  //
+  // For a stroke created by `WithLazyShape()`, the first call generates the
+  // shape, blocking any concurrent callers until it is ready.
+  const PartitionedMesh& GetShape() const;
+
+  // The number of coarser levels of detail available from
+  // `GetShapeAtLevelOfDetail()`, in addition to the full-detail level 0.
+  static constexpr uint32_t kMaxLevelOfDetail = 4;
+
+  // Returns a version of `GetShape()` that is generated with a looser geometric
+  // tolerance, for use when the stroke is drawn small enough that the detail
+  // of the full shape would not be visible.
+  //
+  // Level 0 is the shape returned by `GetShape()`. Each subsequent level
+  // doubles the brush epsilon used to generate the shape, up to a maximum of
+  // the brush size, so level `n` has roughly `2^n` times the geometric error
+  // and far fewer triangles for long strokes. Levels above 0 are generated on
+  // first access and kept until the shape is next regenerated. Like
+  // `GetShape()`, this is safe to call concurrently with other const methods.
+  //
+  // CHECK-fails if `level` is greater than `kMaxLevelOfDetail`.
+  const PartitionedMesh& GetShapeAtLevelOfDetail(uint32_t level) const;
+
+  // Returns the coarsest level of detail for `GetShapeAtLevelOfDetail()` whose
+  // geometric error, after scaling by `object_to_canvas_scale`, does not exceed
+  // the brush epsilon. That is, the level of detail for which drawing the
+  // stroke scaled down by `object_to_canvas_scale` looks the same as drawing
+  // the full-detail shape at its original size.
+  //
+  // Returns 0 for scales of 1 or more, and for non-finite or non-positive
+  // scales.
+  static uint32_t LevelOfDetailForScale(float object_to_canvas_scale);
+
+  // Same as above, but coarser by `profile.level_of_detail_bias` levels, up to
+  // `kMaxLevelOfDetail`, including for scales of 1 or more.
+  static uint32_t LevelOfDetailForScale(float object_to_canvas_scale,
+                                        const PerformanceProfile& profile);
+
+  // Generates the shape now if its generation was deferred by
+  // `WithLazyShape()` and has not yet happened, so that a later call to
+  // `GetShape()` does not have to wait for it. Does nothing otherwise.
+  //
+  // Like `GetShape()`, this is safe to call concurrently with other const
+  // methods. See the constructor above for the meaning of `coat_executor`.
+  void PrefetchShape(Executor* absl_nullable coat_executor = nullptr) const;
+
+  // Adds an estimate of the memory held by this stroke to `footprint`: its
+  // brush, its inputs, its shape, and any coarser levels of detail or deferred
+  // shape that have been generated so far.
+  //
+  // Strokes share their inputs and shapes with their copies, and this shared
+  // data is only counted once per `footprint`. So adding every stroke of a
+  // document to one `MemoryFootprint` gives the memory held by the document,
+  // while adding a single stroke to a fresh `MemoryFootprint` gives the memory
+  // that the stroke keeps alive. Like `GetShape()`, this is safe to call
+  // concurrently with other const methods.
+  void AddToMemoryFootprint(MemoryFootprint& footprint) const;
 
   // Returns the total input duration for this stroke.
   Duration32 GetInputDuration() const { return inputs_.GetDuration(); }
 
   // Sets both the `brush` and `inputs` for the stroke, always clearing the
   // shape and regenerating it if the new `inputs` are non-empty.
-  void SetBrushAndInputs(const Brush& brush, const StrokeInputBatch& inputs);
+  //
+  // See the constructor above for the meaning of `coat_executor`.
+  void SetBrushAndInputs(const Brush& brush, const StrokeInputBatch& inputs,
+                         Executor* absl_nullable coat_executor = nullptr);
 
   // Sets the `brush`, regenerating the mesh if needed.
   //
   // The mesh is regenerated if this call results in a change of the
-  // `BrushTip`s, brush size, or brush epsilon.
+  // `BrushTip`s, brush size, or brush epsilon. Like the other setters below, a
+  // shape deferred by `WithLazyShape()` stays deferred instead.
   void SetBrush(const Brush& brush);
 
   // Sets the brush `family`, regenerating the mesh if the new family has a
@@ -91,12 +185,23 @@ class Stroke {
   void SetBrushColor(const Color& color);
 
   // Sets the brush `size`, regenerating the shape if the new `size` is valid
-  // and different from the current value.
+  // and different from the current value. If the shape was deferred by
+  // `WithLazyShape()`, it stays deferred, and is generated with the new size
+  // when it is next needed.
   //
   // Returns an error and does not modify the stroke if `size` is not a finite
   // and positive value or if `size` is smaller than `epsilon`.
   absl::Status SetBrushSize(float size);
 
+  // Like `SetBrushSize()`, but defers regenerating the shape until it is next
+  // needed, as for a stroke created by `WithLazyShape()`.
+  //
+  // This is intended for resizing many strokes at once, such as while dragging
+  // a brush size slider with a large selection: the call itself is cheap, only
+  // the strokes that are then drawn have their shapes regenerated, and the rest
+  // can be regenerated in the background with `PrefetchShape()`.
+  absl::Status SetBrushSizeWithLazyShape(float size);
+
   // Sets the brush `epsilon`, regenerating the shape if the new `epsilon` is
   // valid and different from the current value.
   //
@@ -108,13 +213,138 @@ class Stroke {
   // shape if `inputs` is empty.
   void SetInputs(const StrokeInputBatch& inputs);
 
+  // Applies `transform` to the inputs and shape of the stroke, as when moving,
+  // rotating, or scaling a selection, so that the stroke doesn't need to carry
+  // an object-to-canvas transform afterwards.
+  //
+  // If `transform` is a similarity transform (a rotation, uniform scale, and
+  // translation) to within the brush epsilon over the bounds of the shape, the
+  // brush size and epsilon are scaled along with the stroke, and the meshes of
+  // the current shape are transformed in place, including their derivative
+  // attributes and spatial index, instead of being regenerated. Otherwise, such
+  // as for a shear, a non-uniform scale, or a reflection, the brush is left
+  // unchanged and the shape is regenerated from the transformed inputs,
+  // building the coats concurrently on `coat_executor` if it is non-null.
+  //
+  // Returns an error and does not modify the stroke if `transform` is not
+  // invertible, or if scaling the brush would make its size or epsilon invalid.
+  absl::Status ApplyTransform(const AffineTransform& transform,
+                              Executor* absl_nullable coat_executor = nullptr);
+
+  // A half-open range [`start`, `end`) of indices into the inputs of a stroke.
+  struct InputRange {
+    size_t start = 0;
+    size_t end = 0;
+  };
+
+  // Splits the stroke into the pieces that remain after erasing the inputs in
+  // `erased_ranges`, as for a segment eraser. The ranges may be empty, overlap,
+  // come in any order, and extend past the end of the inputs.
+  //
+  // Returns one stroke per maximal run of inputs that are not erased, in input
+  // order, each with the brush and noise seed of this stroke. If nothing is
+  // erased, this returns a copy of this stroke, sharing its shape.
+  //
+  // The inputs are modeled once for the whole stroke, and the shape of each
+  // piece is built from the range of those modeled inputs that lies between
+  // the piece's first and last inputs, rather than modeling the piece's inputs
+  // from scratch. Each piece therefore follows the same path as this stroke,
+  // apart from its new end caps, instead of restarting input modeling at each
+  // cut. As a result, its shape can differ slightly from the one regenerated
+  // from its inputs, e.g. when its brush size is later changed. A piece whose
+  // range has no modeled inputs has its shape generated from its inputs.
+  std::vector<Stroke> SplitAtErasedInputs(
+      absl::Span<const InputRange> erased_ranges) const;
+
+  // Regenerates the shape of each of the `strokes` from its current brush and
+  // inputs, spreading the strokes across tasks run on `executor`.
+  //
+  // This is intended for regenerating many strokes at once, such as after
+  // loading a document that has inputs but no saved shapes. In that case, each
+  // `Stroke` can be constructed cheaply with a `PartitionedMesh` from
+  // `PartitionedMesh::WithEmptyGroups()`, and then regenerated in one call to
+  // this function.
+  //
+  // Shape generation resources are cached per thread, so warmed-up
+  // allocations are reused by consecutive strokes that run on the same worker
+  // thread. The coats of each stroke are built sequentially within its task.
+  //
+  // Returns one status per stroke, in the same order as `strokes`. If the shape
+  // of a stroke could not be generated, its status is an error and that stroke
+  // is left with an empty shape. The strokes must all be distinct and non-null,
+  // and must not be accessed by other threads until this function returns.
+  static std::vector<absl::Status> RegenerateShapes(
+      absl::Span<Stroke* absl_nonnull const> strokes, Executor& executor);
+
+  // Regenerates the shapes of `strokes` in the background, one task per stroke
+  // scheduled on `executor`, and passes each regenerated stroke to `on_done`
+  // along with its index in `strokes`.
+  //
+  // This is intended for interactive edits that regenerate many strokes, such
+  // as dragging a brush size slider with many strokes selected. Each stroke
+  // with the new brush can be made cheaply with `WithLazyShape()`, and when a
+  // newer edit supersedes the request, cancelling `cancellation` makes the
+  // remaining work stop at its next coarse check point (e.g. between chunks of
+  // each coat's geometry), so that the executor moves on to the newer request.
+  //
+  // Each stroke is only passed to `on_done` once its shape is complete, so the
+  // caller can swap it in for the old stroke as a whole. If a stroke is
+  // cancelled before its shape is complete, `on_done` gets a `kCancelled`
+  // error for it instead, and if its shape could not be generated, it gets the
+  // error for that. `on_done` is called exactly once per stroke, from the
+  // executor's threads, but never concurrently with itself.
+  static void RegenerateShapesAsync(
+      std::vector<Stroke> strokes, Executor& executor,
+      CancellationToken cancellation,
+      absl::AnyInvocable<void(size_t index, absl::StatusOr<Stroke> stroke)>
+          on_done);
+
  private:
-  // Regenerates the PartitionedMesh.
-  void RegenerateShape();
+  // The deferred shape of a stroke created by `WithLazyShape()`.
+  class LazyShape;
+  // The lazily generated shapes for the levels of detail above 0.
+  class LevelOfDetailShapes;
+
+  // Generates the shape for `brush` and `inputs` into `shape`, building the
+  // coats concurrently on `coat_executor` if it is non-null. On failure,
+  // returns an error and sets `shape` to have only empty render groups. If
+  // `cancellation` is non-null and gets cancelled before the shape is
+  // complete, this fails with a `kCancelled` error.
+  static absl::Status GenerateShape(
+      const Brush& brush, const StrokeInputBatch& inputs,
+      Executor* absl_nullable coat_executor, PartitionedMesh& shape,
+      const CancellationToken* absl_nullable cancellation = nullptr);
+
+  // Regenerates the PartitionedMesh, building the coats concurrently on
+  // `coat_executor` if it is non-null. Logs a warning and leaves the stroke
+  // with an empty shape if generation fails.
+  void RegenerateShape(Executor* absl_nullable coat_executor = nullptr);
+
+  // Replaces the shape with a deferred one for the current brush and inputs,
+  // as if the stroke had been created by `WithLazyShape()`.
+  void DeferShape();
+
+  // Calls `DeferShape()` if the shape is already deferred, and otherwise
+  // `RegenerateShape()`.
+  void RegenerateOrDeferShape();
+
+  // Like `RegenerateShape()`, but returns an error instead of logging when
+  // generation fails.
+  absl::Status TryRegenerateShape(
+      Executor* absl_nullable coat_executor,
+      const CancellationToken* absl_nullable cancellation = nullptr);
 
   Brush brush_;
   StrokeInputBatch inputs_;
   PartitionedMesh shape_;
+  // Non-null if the shape of this stroke was deferred by `WithLazyShape()`, in
+  // which case it is used in place of `shape_`. Reset whenever the shape is
+  // regenerated.
+  std::shared_ptr<LazyShape> lazy_shape_;
+  // The coarser levels of detail of the current shape, shared between copies
+  // of this stroke. Replaced whenever the brush or inputs change, since copies
+  // that share it must have the same brush and inputs. Never null.
+  std::shared_ptr<LevelOfDetailShapes> lod_shapes_;
 };
 
 }  // namespace ink
@@ -30,6 +30,7 @@
 #include "ink/strokes/input/recorded_test_inputs.h"
 #include "ink/strokes/input/stroke_input_batch.h"
 #include "ink/strokes/stroke.h"
+#include "ink/types/internal/allocation_counter.h"
 
 namespace ink {
 namespace {
@@ -62,6 +63,7 @@ void BM_CircleBrushWithSize(benchmark::State& state) {
   Brush brush = MakeBrush(BrushTip{.scale = {1, 1}, .corner_rounding = 1},
                           state.range(0));
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(input_batches.size())) {
     for (const StrokeInputBatch& inputs : input_batches) {
       Stroke stroke(brush, inputs);
@@ -76,6 +78,7 @@ void BM_RoundedRectangleBrushWithSize(benchmark::State& state) {
   Brush brush = MakeBrush(BrushTip{.scale = {0.1, 1.0}, .corner_rounding = 0.2},
                           state.range(0));
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(input_batches.size())) {
     for (const StrokeInputBatch& inputs : input_batches) {
       Stroke stroke(brush, inputs);
@@ -111,6 +114,7 @@ void BM_CircleBrushWithSizeSingleBehavior(benchmark::State& state) {
       }}}};
   Brush brush = MakeBrush(brush_tip, state.range(0));
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(input_batches.size())) {
     for (const StrokeInputBatch& inputs : input_batches) {
       Stroke stroke(brush, inputs);
@@ -184,6 +188,7 @@ void BM_RoundedRectangleBrushWithSizeMultipleBehavior(benchmark::State& state) {
       }};
   Brush brush = MakeBrush(brush_tip, state.range(0));
 
+  ink_internal::ScopedAllocationCounters allocation_counters(state);
   while (state.KeepRunningBatch(input_batches.size())) {
     for (const StrokeInputBatch& inputs : input_batches) {
       Stroke stroke(brush, inputs);
@@ -0,0 +1,425 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/stroke_performance_corpus.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/config.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_behavior.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_paint.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
+#include "ink/geometry/angle.h"
+#include "ink/geometry/envelope.h"
+#include "ink/geometry/intersects.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
+#include "ink/geometry/rect.h"
+#include "ink/geometry/segment.h"
+#include "ink/geometry/vec.h"
+#include "ink/strokes/input/recorded_test_inputs.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/numbers.h"
+
+namespace ink {
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+
+// The minimum rate at which the input modeler emits modeled inputs; see
+// `ResetStrokeModeler()` in stroke_input_modeler.cc.
+constexpr double kModeledInputsPerSecond = 180;
+
+// The most that brush behaviors can scale the width or height of a tip.
+constexpr double kMaxTipSizeMultiplier = 2;
+
+// The margin by which the vertex budget exceeds the model described in the
+// header, and a cap on the budget that keeps the time budgets from
+// overflowing.
+constexpr double kVertexBudgetMargin = 4;
+constexpr double kMaxVertexBudget = 1e12;
+
+// The time budgets allow this much time per vertex in the vertex budget (or,
+// for queries, per triangle that was built), plus a fixed amount per stroke.
+constexpr nanoseconds kBuildTimePerVertex = microseconds(1);
+constexpr nanoseconds kBuildTimeBase = milliseconds(100);
+constexpr nanoseconds kQueryTimePerTriangle = microseconds(1);
+constexpr nanoseconds kQueryTimeBase = milliseconds(50);
+
+// The number of cells along each side of the grid of rectangles that
+// `MeasureStrokeWork()` queries.
+constexpr int kQueryGridSize = 4;
+
+#if !defined(NDEBUG) || defined(ABSL_HAVE_ADDRESS_SANITIZER) || \
+    defined(ABSL_HAVE_MEMORY_SANITIZER) ||                       \
+    defined(ABSL_HAVE_THREAD_SANITIZER)
+constexpr int kTimeBudgetScale = 20;
+#else
+constexpr int kTimeBudgetScale = 1;
+#endif
+
+// Returns an upper bound on the number of vertices in a polygon that
+// approximates a circle of the given radius to within `max_chord_height`.
+double CircleVertexCount(double radius, double max_chord_height) {
+  constexpr double kMinVertexCount = 8;
+  if (max_chord_height >= radius) return kMinVertexCount;
+  // Each chord of height `h` subtends an angle of `2 * acos(1 - h / r)`.
+  return kMinVertexCount +
+         std::ceil(numbers::kPi / std::acos(1 - max_chord_height / radius));
+}
+
+double DistanceTraveled(const StrokeInputBatch& inputs) {
+  double distance = 0;
+  for (size_t i = 1; i < inputs.Size(); ++i) {
+    distance += (inputs.Get(i).position - inputs.Get(i - 1).position)
+                    .Magnitude();
+  }
+  return distance;
+}
+
+// Returns an upper bound on the number of particles emitted by `tip`, or zero
+// if it is not a particle tip.
+double ParticleCount(const BrushTip& tip, float brush_size,
+                     double distance_traveled, double duration_seconds) {
+  double gap_distance = tip.particle_gap_distance_scale * brush_size;
+  double gap_seconds = tip.particle_gap_duration.ToSeconds();
+  if (gap_distance <= 0 && gap_seconds <= 0) return 0;
+  // Each gap is a lower bound on the spacing between particles.
+  double count = std::numeric_limits<double>::infinity();
+  if (gap_distance > 0) count = distance_traveled / gap_distance;
+  if (gap_seconds > 0) count = std::min(count, duration_seconds / gap_seconds);
+  return count + 1;
+}
+
+std::string FormatMillis(nanoseconds duration) {
+  return absl::StrCat(
+      std::chrono::duration<double, std::milli>(duration).count(), "ms");
+}
+
+StrokeInputBatch MakeInputs(absl::Span<const StrokeInput> inputs) {
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *std::move(batch);
+}
+
+Brush MakeBrush(absl::Span<const BrushTip> tips, float size, float epsilon) {
+  std::vector<BrushCoat> coats;
+  for (const BrushTip& tip : tips) coats.push_back({.tip = tip});
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(coats);
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush =
+      Brush::Create(*std::move(family), Color::Black(), size, epsilon);
+  ABSL_CHECK_OK(brush);
+  return *std::move(brush);
+}
+
+// A stylus held in place while its pressure varies, so that every modeled
+// input has the same position but a different tip size.
+StrokePerformanceCase StationaryPenWithVaryingPressure() {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 600; ++i) {
+    inputs.push_back({.tool_type = StrokeInput::ToolType::kStylus,
+                      .position = {50, 50},
+                      .elapsed_time = Duration32::Millis(4 * i),
+                      .pressure = 0.5f + 0.5f * std::sin(0.3f * i)});
+  }
+  BrushTip tip = {.behaviors = {BrushBehavior{{
+                      BrushBehavior::SourceNode{
+                          .source = BrushBehavior::Source::kNormalizedPressure,
+                          .source_value_range = {0, 1},
+                      },
+                      BrushBehavior::TargetNode{
+                          .target = BrushBehavior::Target::kSizeMultiplier,
+                          .target_modifier_range = {0.2, 2},
+                      },
+                  }}}};
+  return {.name = "stationary_pen_with_varying_pressure",
+          .brush = MakeBrush({tip}, 20, 0.01),
+          .inputs = MakeInputs(inputs)};
+}
+
+// A zigzag whose points are much closer together along the stroke than the
+// brush is wide, so that every input reverses direction within the tip.
+StrokePerformanceCase DenseZigzag() {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 2000; ++i) {
+    inputs.push_back(
+        {.position = {0.05f * i, i % 2 == 0 ? 0.f : 40.f},
+         .elapsed_time = Duration32::Millis(4 * i)});
+  }
+  return {.name = "dense_zigzag",
+          .brush = MakeBrush({BrushTip{}}, 20, 0.01),
+          .inputs = MakeInputs(inputs)};
+}
+
+// A large brush with a small epsilon, so that every turn is approximated by
+// many vertices.
+StrokePerformanceCase LargeBrushWithFineEpsilon() {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 500; ++i) {
+    float angle = 0.05f * i;
+    inputs.push_back({.position = {300 * std::cos(angle),
+                                   300 * std::sin(angle)},
+                      .elapsed_time = Duration32::Millis(8 * i)});
+  }
+  return {.name = "large_brush_with_fine_epsilon",
+          .brush = MakeBrush({BrushTip{}}, 400, 0.002),
+          .inputs = MakeInputs(inputs)};
+}
+
+// A spiral whose loops overlap each other many times over, which makes for
+// many self-overlapping triangles.
+StrokePerformanceCase TightSpiral() {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 3000; ++i) {
+    float radius = 5 + 0.01f * i;
+    float angle = 0.3f * i;
+    inputs.push_back(
+        {.position = {radius * std::cos(angle), radius * std::sin(angle)},
+         .elapsed_time = Duration32::Millis(4 * i)});
+  }
+  return {.name = "tight_spiral",
+          .brush = MakeBrush({BrushTip{}}, 8, 0.01),
+          .inputs = MakeInputs(inputs)};
+}
+
+// A stroke that pauses for several seconds, during which the input modeler
+// upsamples.
+StrokePerformanceCase LongPause() {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 40; ++i) {
+    inputs.push_back({.position = {2.f * i, 0},
+                      .elapsed_time = Duration32::Millis(
+                          8 * i + (i < 20 ? 0 : 5000))});
+  }
+  return {.name = "long_pause",
+          .brush = MakeBrush({BrushTip{}}, 10, 0.01),
+          .inputs = MakeInputs(inputs)};
+}
+
+// A particle brush whose particles are much closer together than the inputs.
+StrokePerformanceCase DenseParticles() {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < 200; ++i) {
+    inputs.push_back({.position = {10.f * i, 0},
+                      .elapsed_time = Duration32::Millis(8 * i)});
+  }
+  return {.name = "dense_particles",
+          .brush = MakeBrush({BrushTip{.particle_gap_distance_scale = 0.05}},
+                             10, 0.01),
+          .inputs = MakeInputs(inputs)};
+}
+
+// Several coats whose tips are moved and resized by noise, so that their
+// extrusions constantly change direction and size.
+StrokePerformanceCase MultipleNoisyCoats() {
+  std::vector<BrushTip> tips;
+  for (uint32_t seed = 0; seed < 4; ++seed) {
+    tips.push_back(BrushTip{
+        .behaviors = {
+            BrushBehavior{{
+                BrushBehavior::NoiseNode{
+                    .seed = seed,
+                    .vary_over = BrushBehavior::DampingSource::
+                        kDistanceInMultiplesOfBrushSize,
+                    .base_period = 0.5,
+                },
+                BrushBehavior::TargetNode{
+                    .target = BrushBehavior::Target::
+                        kPositionOffsetLateralInMultiplesOfBrushSize,
+                    .target_modifier_range = {-1, 1},
+                },
+            }},
+            BrushBehavior{{
+                BrushBehavior::NoiseNode{
+                    .seed = seed + 100,
+                    .vary_over = BrushBehavior::DampingSource::
+                        kDistanceInMultiplesOfBrushSize,
+                    .base_period = 0.25,
+                },
+                BrushBehavior::TargetNode{
+                    .target = BrushBehavior::Target::kSizeMultiplier,
+                    .target_modifier_range = {0, 2},
+                },
+            }},
+        }});
+  }
+  return {.name = "multiple_noisy_coats",
+          .brush = MakeBrush(tips, 10, 0.01),
+          .inputs = MakeCompleteSpringShapeInputs(
+              Rect::FromTwoPoints({0, 0}, {200, 200}))};
+}
+
+// A thin rectangular tip that spins several times per brush size traveled,
+// which makes consecutive tip shapes hard to connect.
+StrokePerformanceCase SpinningRectangle() {
+  BrushTip tip = {
+      .scale = {0.1, 1},
+      .corner_rounding = 0,
+      .behaviors = {BrushBehavior{{
+          BrushBehavior::SourceNode{
+              .source = BrushBehavior::Source::
+                  kDistanceTraveledInMultiplesOfBrushSize,
+              .source_out_of_range_behavior =
+                  BrushBehavior::OutOfRange::kRepeat,
+              .source_value_range = {0, 0.25},
+          },
+          BrushBehavior::TargetNode{
+              .target = BrushBehavior::Target::kRotationOffsetInRadians,
+              .target_modifier_range = {0, kFullTurn.ValueInRadians()},
+          },
+      }}}};
+  return {.name = "spinning_rectangle",
+          .brush = MakeBrush({tip}, 20, 0.01),
+          .inputs = MakeCompleteStraightLineInputs(
+              Rect::FromTwoPoints({0, 0}, {200, 200}))};
+}
+
+}  // namespace
+
+StrokeWork MeasureStrokeWork(const Brush& brush,
+                             const StrokeInputBatch& inputs) {
+  StrokeWork work;
+  auto build_start = std::chrono::steady_clock::now();
+  Stroke stroke(brush, inputs);
+  const PartitionedMesh& shape = stroke.GetShape();
+  work.build_time = std::chrono::steady_clock::now() - build_start;
+
+  for (uint32_t group = 0; group < shape.RenderGroupCount(); ++group) {
+    for (const Mesh& mesh : shape.RenderGroupMeshes(group)) {
+      work.vertex_count += mesh.VertexCount();
+      work.triangle_count += mesh.TriangleCount();
+    }
+  }
+
+  Envelope bounds = shape.Bounds();
+  if (bounds.IsEmpty()) return work;
+  const Rect& rect = *bounds.AsRect();
+  auto query_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kQueryGridSize; ++i) {
+    for (int j = 0; j < kQueryGridSize; ++j) {
+      Rect cell = Rect::FromTwoPoints(
+          {rect.XMin() + rect.Width() * i / kQueryGridSize,
+           rect.YMin() + rect.Height() * j / kQueryGridSize},
+          {rect.XMin() + rect.Width() * (i + 1) / kQueryGridSize,
+           rect.YMin() + rect.Height() * (j + 1) / kQueryGridSize});
+      Intersects(cell, shape, AffineTransform());
+    }
+  }
+  for (const Segment& diagonal :
+       {Segment{{rect.XMin(), rect.YMin()}, {rect.XMax(), rect.YMax()}},
+        Segment{{rect.XMin(), rect.YMax()}, {rect.XMax(), rect.YMin()}}}) {
+    Intersects(diagonal, shape, AffineTransform());
+  }
+  work.query_time = std::chrono::steady_clock::now() - query_start;
+  return work;
+}
+
+StrokeWorkBudget GetStrokeWorkBudget(const Brush& brush,
+                                     const StrokeInputBatch& inputs) {
+  double duration_seconds = inputs.GetDuration().ToSeconds();
+  double distance_traveled = DistanceTraveled(inputs);
+  double modeled_input_count =
+      inputs.Size() + std::ceil(duration_seconds * kModeledInputsPerSecond) + 1;
+
+  double vertex_count = 0;
+  for (const BrushCoat& coat : brush.GetCoats()) {
+    const BrushTip& tip = coat.tip;
+    double tip_state_count =
+        modeled_input_count + ParticleCount(tip, brush.GetSize(),
+                                            distance_traveled,
+                                            duration_seconds);
+    double max_radius = 0.5 * kMaxTipSizeMultiplier * brush.GetSize() *
+                        std::max(tip.scale.x, tip.scale.y);
+    vertex_count += tip_state_count *
+                    CircleVertexCount(max_radius, brush.GetEpsilon());
+  }
+  vertex_count *= kVertexBudgetMargin;
+
+  StrokeWorkBudget budget;
+  budget.max_vertex_count =
+      static_cast<int64_t>(std::min(vertex_count, kMaxVertexBudget));
+  budget.max_build_time =
+      kTimeBudgetScale *
+      (kBuildTimeBase + kBuildTimePerVertex * budget.max_vertex_count);
+  budget.max_query_time_base = kTimeBudgetScale * kQueryTimeBase;
+  budget.max_query_time_per_triangle = kTimeBudgetScale * kQueryTimePerTriangle;
+  return budget;
+}
+
+absl::Status CheckStrokeWorkWithinBudget(const StrokeWork& work,
+                                         const StrokeWorkBudget& budget) {
+  std::vector<std::string> errors;
+  if (work.vertex_count > budget.max_vertex_count) {
+    errors.push_back(absl::StrCat("vertex count ", work.vertex_count,
+                                  " exceeds budget of ",
+                                  budget.max_vertex_count));
+  }
+  if (work.build_time > budget.max_build_time) {
+    errors.push_back(absl::StrCat("build time ",
+                                  FormatMillis(work.build_time),
+                                  " exceeds budget of ",
+                                  FormatMillis(budget.max_build_time)));
+  }
+  nanoseconds max_query_time =
+      budget.max_query_time_base +
+      budget.max_query_time_per_triangle * work.triangle_count;
+  if (work.query_time > max_query_time) {
+    errors.push_back(absl::StrCat("query time ",
+                                  FormatMillis(work.query_time),
+                                  " exceeds budget of ",
+                                  FormatMillis(max_query_time)));
+  }
+  if (errors.empty()) return absl::OkStatus();
+  return absl::ResourceExhaustedError(absl::StrJoin(errors, "; "));
+}
+
+std::vector<StrokePerformanceCase> StrokePerformanceCorpus() {
+  std::vector<StrokePerformanceCase> corpus;
+  corpus.push_back(StationaryPenWithVaryingPressure());
+  corpus.push_back(DenseZigzag());
+  corpus.push_back(LargeBrushWithFineEpsilon());
+  corpus.push_back(TightSpiral());
+  corpus.push_back(LongPause());
+  corpus.push_back(DenseParticles());
+  corpus.push_back(MultipleNoisyCoats());
+  corpus.push_back(SpinningRectangle());
+  return corpus;
+}
+
+}  // namespace ink
@@ -0,0 +1,88 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_STROKE_PERFORMANCE_CORPUS_H_
+#define INK_STROKES_STROKE_PERFORMANCE_CORPUS_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "ink/brush/brush.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+
+namespace ink {
+
+// The work done to build the shape of a stroke, and to run a fixed set of
+// geometry queries against it.
+struct StrokeWork {
+  // The total number of vertices and triangles across all of the meshes of the
+  // stroke's shape.
+  int64_t vertex_count = 0;
+  int64_t triangle_count = 0;
+  std::chrono::nanoseconds build_time{0};
+  std::chrono::nanoseconds query_time{0};
+};
+
+// Builds a `Stroke` from `brush` and `inputs`, and measures the work that took.
+StrokeWork MeasureStrokeWork(const Brush& brush,
+                             const StrokeInputBatch& inputs);
+
+// Upper bounds on the work that building a stroke should take.
+//
+// These are derived from the brush and inputs rather than recorded from a
+// particular run, so that they apply to any stroke: the number of modeled
+// inputs is bounded by the input count and the stroke duration (which the
+// input modeler upsamples), the number of tip states by that and the particle
+// gaps, and the number of vertices per tip state by the number of vertices in
+// a circle as large as the largest tip, approximated to within the brush
+// epsilon. The build time is bounded in proportion to the vertex budget, and
+// the query time in proportion to the number of triangles actually built.
+//
+// The bounds have a wide margin, so they fail on work that grows faster than
+// this model rather than on small regressions. Times are further scaled up in
+// debug and sanitizer builds.
+struct StrokeWorkBudget {
+  int64_t max_vertex_count = 0;
+  std::chrono::nanoseconds max_build_time{0};
+  std::chrono::nanoseconds max_query_time_base{0};
+  std::chrono::nanoseconds max_query_time_per_triangle{0};
+};
+
+StrokeWorkBudget GetStrokeWorkBudget(const Brush& brush,
+                                     const StrokeInputBatch& inputs);
+
+// Returns a `ResourceExhaustedError` describing each bound in `budget` that
+// `work` exceeds, or OK if there are none.
+absl::Status CheckStrokeWorkWithinBudget(const StrokeWork& work,
+                                         const StrokeWorkBudget& budget);
+
+// A brush and inputs that have made stroke building slow or its shape large.
+struct StrokePerformanceCase {
+  std::string name;
+  Brush brush;
+  StrokeInputBatch inputs;
+};
+
+// Returns the corpus of known worst cases for stroke building, which
+// stroke_performance_test.cc checks against `GetStrokeWorkBudget()`. When
+// stroke_performance_fuzz_test.cc finds a case that is over budget, fix the
+// cause, then add the minimized reproducer that it prints here.
+std::vector<StrokePerformanceCase> StrokePerformanceCorpus();
+
+}  // namespace ink
+
+#endif  // INK_STROKES_STROKE_PERFORMANCE_CORPUS_H_
@@ -0,0 +1,62 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Searches for brushes and inputs that make stroke building slow, or its shape
+// large, relative to `GetStrokeWorkBudget()`. Run it in fuzzing mode with e.g.:
+//
+//   bazel run --config=fuzztest //ink/strokes:stroke_performance_fuzz_test \
+//     -- --fuzz=StrokePerformanceFuzzTest.StrokeWorkIsWithinBudget
+//
+// Any case over budget fails the test, and is reported as a minimized
+// reproducer. Once the cause is fixed, add the reproducer to
+// `StrokePerformanceCorpus()` so that stroke_performance_test.cc guards it.
+// (The corpus can't seed this test, since the brush and input domains are built
+// with `fuzztest::Map()`, which doesn't support seeds.)
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "fuzztest/fuzztest.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/fuzz_domains.h"
+#include "ink/geometry/rect.h"
+#include "ink/strokes/input/fuzz_domains.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke_performance_corpus.h"
+#include "ink/types/duration.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+
+void StrokeWorkIsWithinBudget(const Brush& brush,
+                              const StrokeInputBatch& inputs) {
+  StrokeWork work = MeasureStrokeWork(brush, inputs);
+  EXPECT_THAT(
+      CheckStrokeWorkWithinBudget(work, GetStrokeWorkBudget(brush, inputs)),
+      IsOk());
+}
+// Input positions are kept to a bounded area, as arbitrary ones can't always be
+// turned into a mesh (see `CanConstructStrokeFromAnyInputBatch` in
+// stroke_test.cc). Durations are bounded too: the input modeler upsamples long
+// pauses, which the budget allows for, but which would make each run slow.
+FUZZ_TEST(StrokePerformanceFuzzTest, StrokeWorkIsWithinBudget)
+    .WithDomains(ValidBrush(),
+                 StrokeInputBatchInRectAndDuration(
+                     Rect::FromTwoPoints({-1000, -1000}, {1000, 1000}),
+                     Duration32::Seconds(10)));
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,101 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "ink/brush/brush.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke_performance_corpus.h"
+
+namespace ink {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::AllOf;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(StrokePerformanceTest, CorpusStrokesAreWithinBudget) {
+  for (const StrokePerformanceCase& test_case : StrokePerformanceCorpus()) {
+    SCOPED_TRACE(test_case.name);
+    StrokeWork work = MeasureStrokeWork(test_case.brush, test_case.inputs);
+    EXPECT_GT(work.vertex_count, 0);
+    EXPECT_THAT(
+        CheckStrokeWorkWithinBudget(
+            work, GetStrokeWorkBudget(test_case.brush, test_case.inputs)),
+        IsOk());
+  }
+}
+
+TEST(StrokePerformanceTest, CheckStrokeWorkWithinBudget) {
+  using std::chrono::milliseconds;
+  StrokeWorkBudget budget = {
+      .max_vertex_count = 100,
+      .max_build_time = milliseconds(10),
+      .max_query_time_base = milliseconds(1),
+      .max_query_time_per_triangle = milliseconds(1),
+  };
+  StrokeWork work = {.vertex_count = 100,
+                     .triangle_count = 50,
+                     .build_time = milliseconds(10),
+                     .query_time = milliseconds(51)};
+  EXPECT_THAT(CheckStrokeWorkWithinBudget(work, budget), IsOk());
+
+  work.vertex_count = 101;
+  EXPECT_THAT(CheckStrokeWorkWithinBudget(work, budget),
+              StatusIs(absl::StatusCode::kResourceExhausted,
+                       AllOf(HasSubstr("vertex count"),
+                             Not(HasSubstr("build time")),
+                             Not(HasSubstr("query time")))));
+
+  work.vertex_count = 100;
+  work.build_time = milliseconds(11);
+  work.query_time = milliseconds(52);
+  EXPECT_THAT(CheckStrokeWorkWithinBudget(work, budget),
+              StatusIs(absl::StatusCode::kResourceExhausted,
+                       AllOf(Not(HasSubstr("vertex count")),
+                             HasSubstr("build time"),
+                             HasSubstr("query time"))));
+}
+
+TEST(StrokePerformanceTest, BudgetGrowsWithInputsAndShrinkingEpsilon) {
+  std::vector<StrokePerformanceCase> corpus = StrokePerformanceCorpus();
+  ASSERT_FALSE(corpus.empty());
+  const StrokePerformanceCase& test_case = corpus.front();
+  StrokeWorkBudget budget =
+      GetStrokeWorkBudget(test_case.brush, test_case.inputs);
+  EXPECT_GT(budget.max_vertex_count, 0);
+
+  StrokeInputBatch fewer_inputs = test_case.inputs;
+  fewer_inputs.Erase(1);
+  StrokeWorkBudget fewer_inputs_budget =
+      GetStrokeWorkBudget(test_case.brush, fewer_inputs);
+  EXPECT_LT(fewer_inputs_budget.max_vertex_count, budget.max_vertex_count);
+  EXPECT_LT(fewer_inputs_budget.max_build_time, budget.max_build_time);
+
+  Brush finer_brush = test_case.brush;
+  ASSERT_THAT(finer_brush.SetEpsilon(test_case.brush.GetEpsilon() / 10),
+              IsOk());
+  EXPECT_GT(GetStrokeWorkBudget(finer_brush, test_case.inputs).max_vertex_count,
+            budget.max_vertex_count);
+}
+
+}  // namespace
+}  // namespace ink
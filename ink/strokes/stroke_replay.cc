@@ -0,0 +1,128 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/stroke_replay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+
+namespace ink {
+
+StrokeReplay::StrokeReplay(const Brush& brush, const StrokeInputBatch& inputs,
+                           Duration32 checkpoint_interval)
+    : brush_(brush),
+      inputs_(inputs),
+      checkpoint_interval_(checkpoint_interval) {
+  ABSL_CHECK_GT(checkpoint_interval_, Duration32::Zero());
+  Restart();
+}
+
+StrokeReplay::StrokeReplay(const Stroke& stroke, Duration32 checkpoint_interval)
+    : StrokeReplay(stroke.GetBrush(), stroke.GetInputs(), checkpoint_interval) {
+}
+
+absl::Status StrokeReplay::SeekTo(Duration32 elapsed_time) {
+  if (elapsed_time < Duration32::Zero()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "`elapsed_time` must be non-negative. Got %v.", elapsed_time));
+  }
+
+  // Resume from the latest checkpoint at or before `elapsed_time` if seeking
+  // backward, or if that checkpoint is ahead of the current time.
+  float intervals = std::floor(elapsed_time / checkpoint_interval_);
+  size_t checkpoint_count = intervals < checkpoints_.size()
+                                ? static_cast<size_t>(intervals)
+                                : checkpoints_.size();
+  Duration32 checkpoint_time =
+      checkpoint_interval_ * static_cast<float>(checkpoint_count);
+  if (elapsed_time < elapsed_time_ || checkpoint_time > elapsed_time_) {
+    if (checkpoint_count == 0) {
+      Restart();
+    } else {
+      const Checkpoint& checkpoint = checkpoints_[checkpoint_count - 1];
+      stroke_.CopyFrom(checkpoint.stroke);
+      input_count_ = checkpoint.input_count;
+      elapsed_time_ = checkpoint_time;
+    }
+  }
+
+  // Play forward, stopping to save each checkpoint that hasn't been reached
+  // before. No checkpoints are saved once every input has been given to the
+  // stroke, since replaying from the last one only updates the time.
+  while (true) {
+    Duration32 next_checkpoint_time =
+        checkpoint_interval_ * static_cast<float>(checkpoints_.size() + 1);
+    bool saves_checkpoint = input_count_ < inputs_.Size() &&
+                            next_checkpoint_time <= elapsed_time;
+    Duration32 step_end =
+        saves_checkpoint ? next_checkpoint_time : elapsed_time;
+    if (absl::Status status = AdvanceTo(step_end); !status.ok()) {
+      return status;
+    }
+    if (saves_checkpoint) {
+      Checkpoint& checkpoint = checkpoints_.emplace_back();
+      checkpoint.stroke.CopyFrom(stroke_);
+      checkpoint.input_count = input_count_;
+    }
+    if (step_end == elapsed_time) break;
+  }
+  return absl::OkStatus();
+}
+
+void StrokeReplay::Restart() {
+  stroke_.Start(brush_, inputs_.GetNoiseSeed());
+  input_count_ = 0;
+  elapsed_time_ = Duration32::Zero();
+}
+
+absl::Status StrokeReplay::AdvanceTo(Duration32 elapsed_time) {
+  ABSL_DCHECK_GE(elapsed_time, elapsed_time_);
+  absl::Span<const float> input_times = inputs_.GetElapsedTimesInSeconds();
+  size_t input_end =
+      std::upper_bound(input_times.begin() + input_count_, input_times.end(),
+                       elapsed_time.ToSeconds()) -
+      input_times.begin();
+  if (input_end == input_count_ && elapsed_time == elapsed_time_) {
+    return absl::OkStatus();
+  }
+
+  if (input_end > input_count_) {
+    if (absl::Status status = stroke_.EnqueueInputs(
+            inputs_.Slice(input_count_, input_end - input_count_), {});
+        !status.ok()) {
+      return status;
+    }
+    input_count_ = input_end;
+  }
+  if (input_count_ == inputs_.Size() && !stroke_.InputsAreFinished()) {
+    stroke_.FinishInputs();
+  }
+  if (absl::Status status = stroke_.UpdateShape(elapsed_time); !status.ok()) {
+    return status;
+  }
+  elapsed_time_ = elapsed_time;
+  return absl::OkStatus();
+}
+
+}  // namespace ink
@@ -0,0 +1,111 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_STROKE_REPLAY_H_
+#define INK_STROKES_STROKE_REPLAY_H_
+
+#include <cstddef>
+#include <deque>
+
+#include "absl/status/status.h"
+#include "ink/brush/brush.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+
+namespace ink {
+
+// Plays back the inputs of a complete stroke over time, as they were drawn,
+// and can seek to any time in that playback, e.g. for a scrubbable animation
+// of how a drawing was made.
+//
+// The playback time is on the same clock as the inputs' elapsed times, and the
+// stroke at time `t` is the `InProgressStroke` that had been given every input
+// with an elapsed time of at most `t`, and updated to time `t`.
+//
+// Seeking forward continues the stroke from where it is. So that seeking
+// backward doesn't have to rebuild the stroke from its first input, the first
+// time playback reaches each multiple of the checkpoint interval, a copy of the
+// stroke is saved as a checkpoint, and later seeks resume from the latest
+// checkpoint at or before the seek time. Once the stroke has been played
+// through, each seek only replays at most one checkpoint interval of inputs.
+// Each checkpoint holds a copy of the stroke's meshes at its time, so shorter
+// intervals make seeking cheaper at the cost of memory.
+class StrokeReplay {
+ public:
+  // Replays `inputs` drawn with `brush`. `checkpoint_interval` must be
+  // positive.
+  StrokeReplay(const Brush& brush, const StrokeInputBatch& inputs,
+               Duration32 checkpoint_interval = Duration32::Seconds(0.5));
+  explicit StrokeReplay(
+      const Stroke& stroke,
+      Duration32 checkpoint_interval = Duration32::Seconds(0.5));
+
+  // Not copyable or movable, since the checkpoints must stay in place.
+  StrokeReplay(const StrokeReplay&) = delete;
+  StrokeReplay& operator=(const StrokeReplay&) = delete;
+  ~StrokeReplay() = default;
+
+  // Brings the stroke returned by `GetInProgressStroke()` to its state at
+  // `elapsed_time`, which may be before or after the current time. Returns an
+  // error if `elapsed_time` is negative, in which case nothing changes.
+  //
+  // Resuming from a checkpoint reports the whole stroke as updated, as
+  // `InProgressStroke::CopyFrom()` does. Seeking back before the first
+  // checkpoint restarts the stroke, which resets its updated region as
+  // `InProgressStroke::Start()` does.
+  absl::Status SeekTo(Duration32 elapsed_time);
+
+  // Returns the time of the last call to `SeekTo()`, or zero if there has been
+  // none yet, in which case nothing is drawn.
+  Duration32 GetElapsedTime() const { return elapsed_time_; }
+
+  // Returns the stroke at the current time. It may be drawn like any other
+  // `InProgressStroke`, and its updated region may be reset, but it must not
+  // otherwise be modified.
+  const InProgressStroke& GetInProgressStroke() const { return stroke_; }
+  InProgressStroke& GetInProgressStroke() { return stroke_; }
+
+  // Returns the number of checkpoints saved so far.
+  size_t CheckpointCount() const { return checkpoints_.size(); }
+
+ private:
+  struct Checkpoint {
+    InProgressStroke stroke;
+    size_t input_count = 0;
+  };
+
+  // Restarts the stroke at time zero, before any of its inputs.
+  void Restart();
+
+  // Plays the stroke forward to `elapsed_time`, which must not be before the
+  // current time.
+  absl::Status AdvanceTo(Duration32 elapsed_time);
+
+  Brush brush_;
+  StrokeInputBatch inputs_;
+  Duration32 checkpoint_interval_;
+  InProgressStroke stroke_;
+  // The number of `inputs_`, from the start, given to `stroke_` so far.
+  size_t input_count_ = 0;
+  Duration32 elapsed_time_ = Duration32::Zero();
+  // Checkpoint `i` holds the stroke at time `(i + 1) * checkpoint_interval_`.
+  // Held in a `std::deque` so that the strokes are never moved.
+  std::deque<Checkpoint> checkpoints_;
+};
+
+}  // namespace ink
+
+#endif  // INK_STROKES_STROKE_REPLAY_H_
@@ -0,0 +1,172 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/stroke_replay.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_family.h"
+#include "ink/color/color.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/strokes/in_progress_stroke.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/input/type_matchers.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+
+namespace ink {
+namespace {
+
+using ::testing::HasSubstr;
+
+Brush CreateTestBrush() {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(
+      {.scale = {0.5, 0.5}, .corner_rounding = 1}, {}, "");
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush = Brush::Create(*family, Color(),
+                                              /*size=*/2, /*epsilon=*/0.01);
+  ABSL_CHECK_OK(brush);
+  return *brush;
+}
+
+// Returns a wavy line of inputs, one every 0.1 seconds for two seconds.
+StrokeInputBatch MakeInputs() {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i <= 20; ++i) {
+    inputs.push_back({.position = {static_cast<float>(i),
+                                   static_cast<float>(i % 3)},
+                      .elapsed_time = Duration32::Seconds(0.1 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *batch;
+}
+
+// Returns the `inputs` with an elapsed time of at most `elapsed_time`.
+StrokeInputBatch InputsUpTo(const StrokeInputBatch& inputs,
+                            Duration32 elapsed_time) {
+  size_t count = 0;
+  while (count < inputs.Size() &&
+         inputs.Get(count).elapsed_time <= elapsed_time) {
+    ++count;
+  }
+  return inputs.Slice(0, count);
+}
+
+void ExpectSameStroke(const InProgressStroke& actual,
+                      const InProgressStroke& expected) {
+  EXPECT_THAT(actual.GetInputs(), StrokeInputBatchEq(expected.GetInputs()));
+  EXPECT_EQ(actual.InputsAreFinished(), expected.InputsAreFinished());
+  ASSERT_EQ(actual.BrushCoatCount(), expected.BrushCoatCount());
+  for (uint32_t i = 0; i < actual.BrushCoatCount(); ++i) {
+    EXPECT_EQ(actual.GetMesh(i).VertexCount(),
+              expected.GetMesh(i).VertexCount());
+    EXPECT_EQ(actual.GetMesh(i).TriangleCount(),
+              expected.GetMesh(i).TriangleCount());
+    EXPECT_THAT(actual.GetMeshBounds(i),
+                EnvelopeEq(expected.GetMeshBounds(i)));
+  }
+}
+
+TEST(StrokeReplayTest, StartsEmpty) {
+  StrokeReplay replay(CreateTestBrush(), MakeInputs());
+  EXPECT_EQ(replay.GetElapsedTime(), Duration32::Zero());
+  EXPECT_EQ(replay.CheckpointCount(), 0);
+  EXPECT_EQ(replay.GetInProgressStroke().GetInputs().Size(), 0);
+  EXPECT_TRUE(replay.GetInProgressStroke().GetMeshBounds(0).IsEmpty());
+}
+
+TEST(StrokeReplayTest, SeekForwardGivesInputsUpToTime) {
+  StrokeInputBatch inputs = MakeInputs();
+  StrokeReplay replay(CreateTestBrush(), inputs, Duration32::Seconds(0.5));
+
+  for (float seconds : {0.f, 0.25f, 0.5f, 1.3f, 2.f, 3.f}) {
+    Duration32 time = Duration32::Seconds(seconds);
+    ASSERT_EQ(replay.SeekTo(time), absl::OkStatus());
+    EXPECT_EQ(replay.GetElapsedTime(), time);
+    EXPECT_THAT(replay.GetInProgressStroke().GetInputs(),
+                StrokeInputBatchEq(InputsUpTo(inputs, time)));
+    EXPECT_EQ(replay.GetInProgressStroke().InputsAreFinished(),
+              seconds >= 2);
+  }
+  // Checkpoints are saved at 0.5, 1, 1.5, and 2 seconds; the last input is at
+  // 2 seconds, so none are saved after that.
+  EXPECT_EQ(replay.CheckpointCount(), 4);
+}
+
+TEST(StrokeReplayTest, SeekBackwardMatchesSeekFromStart) {
+  Brush brush = CreateTestBrush();
+  StrokeInputBatch inputs = MakeInputs();
+  StrokeReplay replay(brush, inputs, Duration32::Seconds(0.5));
+  ASSERT_EQ(replay.SeekTo(Duration32::Seconds(2.5)), absl::OkStatus());
+  size_t checkpoint_count = replay.CheckpointCount();
+
+  for (float seconds : {1.7f, 1.2f, 1.f, 0.3f, 0.f, 1.9f, 0.6f}) {
+    Duration32 time = Duration32::Seconds(seconds);
+    ASSERT_EQ(replay.SeekTo(time), absl::OkStatus());
+    EXPECT_EQ(replay.GetElapsedTime(), time);
+
+    StrokeReplay expected(brush, inputs, Duration32::Seconds(0.5));
+    ASSERT_EQ(expected.SeekTo(time), absl::OkStatus());
+    ExpectSameStroke(replay.GetInProgressStroke(),
+                     expected.GetInProgressStroke());
+  }
+  // Seeking over already-played times reuses the existing checkpoints.
+  EXPECT_EQ(replay.CheckpointCount(), checkpoint_count);
+}
+
+TEST(StrokeReplayTest, SeekForwardPastUnplayedCheckpointsSavesThem) {
+  StrokeReplay replay(CreateTestBrush(), MakeInputs(),
+                      Duration32::Seconds(0.5));
+  ASSERT_EQ(replay.SeekTo(Duration32::Seconds(1.2)), absl::OkStatus());
+  EXPECT_EQ(replay.CheckpointCount(), 2);
+
+  ASSERT_EQ(replay.SeekTo(Duration32::Seconds(0.7)), absl::OkStatus());
+  ASSERT_EQ(replay.SeekTo(Duration32::Seconds(1.7)), absl::OkStatus());
+  EXPECT_EQ(replay.CheckpointCount(), 3);
+}
+
+TEST(StrokeReplayTest, ReplaysStroke) {
+  Brush brush = CreateTestBrush();
+  StrokeInputBatch inputs = MakeInputs();
+  StrokeReplay replay(Stroke(brush, inputs));
+  ASSERT_EQ(replay.SeekTo(Duration32::Seconds(1)), absl::OkStatus());
+
+  StrokeReplay expected(brush, inputs);
+  ASSERT_EQ(expected.SeekTo(Duration32::Seconds(1)), absl::OkStatus());
+  ExpectSameStroke(replay.GetInProgressStroke(),
+                   expected.GetInProgressStroke());
+}
+
+TEST(StrokeReplayTest, SeekToNegativeTimeFails) {
+  StrokeReplay replay(CreateTestBrush(), MakeInputs());
+  ASSERT_EQ(replay.SeekTo(Duration32::Seconds(1)), absl::OkStatus());
+
+  absl::Status status = replay.SeekTo(Duration32::Seconds(-1));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("non-negative"));
+  EXPECT_EQ(replay.GetElapsedTime(), Duration32::Seconds(1));
+}
+
+}  // namespace
+}  // namespace ink
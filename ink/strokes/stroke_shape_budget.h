@@ -0,0 +1,71 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_STROKES_STROKE_SHAPE_BUDGET_H_
+#define INK_STROKES_STROKE_SHAPE_BUDGET_H_
+
+#include <cstdint>
+#include <limits>
+
+namespace ink {
+
+// Limits on the memory and work used to build the shape of each brush coat of
+// an `InProgressStroke`, so that pathological input (e.g. scribbling in one
+// spot for a long time) cannot make updates arbitrarily slow or the mesh
+// arbitrarily large.
+//
+// Every limit defaults to `kUnlimited`. When a limit is reached, the stroke
+// degrades in a defined way for the rest of the stroke, as documented on each
+// member, rather than failing.
+struct StrokeShapeBudget {
+  static constexpr uint32_t kUnlimited = std::numeric_limits<uint32_t>::max();
+
+  // The maximum number of vertices in the mesh of each coat. Once reached, no
+  // more geometry is extruded for that coat, so the visible stroke stops
+  // growing. The limit is checked before extruding each brush tip state, so the
+  // mesh can exceed it by the vertices of one tip state and its end cap.
+  uint32_t max_vertices_per_coat = kUnlimited;
+
+  // The maximum number of outlines of each coat, i.e. the number of
+  // disconnected pieces of geometry, such as the particles of a particle
+  // brush. Once reached, no more geometry is extruded for that coat.
+  uint32_t max_outlines_per_coat = kUnlimited;
+
+  // The maximum number of brush tip states that one shape update of each coat
+  // may extrude, counting both fixed and predicted states. If an update
+  // exceeds it, self-intersection handling, the part of extrusion whose cost
+  // can grow with the size of the stroke, is disabled for the rest of the
+  // stroke. Self-overlapping parts of the stroke may then render with
+  // artifacts when drawn with translucent colors or winding textures.
+  uint32_t max_tip_states_per_update = kUnlimited;
+
+  // The maximum number of existing triangles that self-intersection handling
+  // may retriangulate while extruding one brush tip state of each coat. This
+  // work grows when the stroke loops tightly over itself. If it exceeds the
+  // limit, the ongoing self-intersection is given up, keeping the
+  // retriangulation done so far, and the rest of that tip state is extruded
+  // without intersection handling. Unlike the other limits, this only degrades
+  // the tip state that exceeded it, and does not count towards
+  // `InProgressStroke::ExceededBudget()`. Occurrences are counted by
+  // `StrokeShapeStats::intersection_handling_fallbacks`.
+  uint32_t max_retriangulated_triangles_per_tip_state = kUnlimited;
+
+  friend bool operator==(const StrokeShapeBudget&,
+                         const StrokeShapeBudget&) = default;
+};
+
+}  // namespace ink
+
+#endif  // INK_STROKES_STROKE_SHAPE_BUDGET_H_
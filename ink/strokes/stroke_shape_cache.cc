@@ -0,0 +1,271 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/stroke_shape_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/base/attributes.h"
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
+#include "absl/log/absl_check.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/geometry/mesh.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/strokes/input/stroke_input.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/types/memory_trim.h"
+
+namespace ink {
+namespace {
+
+// Wraps the parts of a `Brush` and `StrokeInputBatch` that are part of a cache
+// key so that they can be hashed together. Brush tips are not hashable, so
+// they only take part in equality comparison of keys.
+struct HashableKey {
+  const Brush& brush;
+  const StrokeInputBatch& inputs;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const HashableKey& key) {
+    h = H::combine(std::move(h), key.brush.GetSize(), key.brush.GetEpsilon(),
+                   key.brush.GetFamily().GetInputModel().index(),
+                   key.inputs.GetNoiseSeed());
+    absl::Span<const BrushCoat> coats = key.brush.GetCoats();
+    for (const BrushCoat& coat : coats) {
+      h = H::combine(std::move(h), coat.paint);
+    }
+    h = H::combine(std::move(h), coats.size());
+    for (const StrokeInput& input : key.inputs) {
+      h = H::combine(std::move(h), input.tool_type, input.position.x,
+                     input.position.y, input.elapsed_time.ToSeconds(),
+                     input.stroke_unit_length.ToCentimeters(), input.pressure,
+                     input.tilt.ValueInRadians(),
+                     input.orientation.ValueInRadians());
+    }
+    return H::combine(std::move(h), key.inputs.Size());
+  }
+};
+
+bool InputsAreEqual(const StrokeInput& a, const StrokeInput& b) {
+  return a.tool_type == b.tool_type && a.position == b.position &&
+         a.elapsed_time == b.elapsed_time &&
+         a.stroke_unit_length == b.stroke_unit_length &&
+         a.pressure == b.pressure && a.tilt == b.tilt &&
+         a.orientation == b.orientation;
+}
+
+bool InputBatchesAreEqual(const StrokeInputBatch& a,
+                          const StrokeInputBatch& b) {
+  if (a.Size() != b.Size() || a.GetNoiseSeed() != b.GetNoiseSeed()) {
+    return false;
+  }
+  // Batches that share their copy-on-write data are trivially equal.
+  if (a.begin() == b.begin()) return true;
+  for (size_t i = 0; i < a.Size(); ++i) {
+    if (!InputsAreEqual(a.Get(i), b.Get(i))) return false;
+  }
+  return true;
+}
+
+ABSL_CONST_INIT absl::Mutex process_cache_mutex(absl::kConstInit);
+
+std::shared_ptr<StrokeShapeCache>& ProcessCache()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(process_cache_mutex) {
+  // Intentionally leaked to avoid destruction order issues at exit.
+  static auto* cache = new std::shared_ptr<StrokeShapeCache>();
+  return *cache;
+}
+
+// Registers the process-wide cache to be cleared by `TrimMemory()`, the first
+// time this is called. This must not be called while holding
+// `process_cache_mutex`, which the trim callback acquires.
+void RegisterProcessCacheForTrim() {
+  // Intentionally leaked, so that the callback stays registered until exit.
+  [[maybe_unused]] static auto* registration =
+      new MemoryTrimRegistration(RegisterMemoryTrimCallback(
+          MemoryTrimLevel::kCaches, []() -> size_t {
+            std::shared_ptr<StrokeShapeCache> cache =
+                StrokeShapeCache::GetProcessCache();
+            if (cache == nullptr) return 0;
+            size_t bytes = cache->TotalBytes();
+            cache->Clear();
+            return bytes;
+          }));
+}
+
+}  // namespace
+
+std::shared_ptr<StrokeShapeCache> StrokeShapeCache::GetProcessCache() {
+  absl::MutexLock lock(&process_cache_mutex);
+  return ProcessCache();
+}
+
+void StrokeShapeCache::SetProcessCache(
+    std::shared_ptr<StrokeShapeCache> cache) {
+  RegisterProcessCacheForTrim();
+  absl::MutexLock lock(&process_cache_mutex);
+  ProcessCache() = std::move(cache);
+}
+
+std::optional<PartitionedMesh> StrokeShapeCache::Find(
+    const Brush& brush, const StrokeInputBatch& inputs) {
+  size_t hash = HashKey(brush, inputs);
+  absl::MutexLock lock(&mutex_);
+  EntryList::iterator it = FindEntry(hash, brush, inputs);
+  if (it == entries_.end()) return std::nullopt;
+  // Move the entry to the front of the list. This does not invalidate any
+  // iterators, so `entries_by_hash_` does not need to be updated.
+  entries_.splice(entries_.begin(), entries_, it);
+  return it->shape;
+}
+
+void StrokeShapeCache::Insert(const Brush& brush,
+                              const StrokeInputBatch& inputs,
+                              const PartitionedMesh& shape) {
+  size_t hash = HashKey(brush, inputs);
+  size_t bytes = EstimateEntryBytes(inputs, shape);
+  absl::MutexLock lock(&mutex_);
+  if (EntryList::iterator it = FindEntry(hash, brush, inputs);
+      it != entries_.end()) {
+    EraseEntry(it);
+  }
+  if (bytes > max_bytes_) return;
+
+  EvictToFit(max_bytes_ - bytes);
+  entries_.push_front(Entry{
+      .key = {.family = brush.GetFamily(),
+              .brush_size = brush.GetSize(),
+              .brush_epsilon = brush.GetEpsilon(),
+              .inputs = inputs},
+      .shape = shape,
+      .hash = hash,
+      .bytes = bytes,
+  });
+  entries_by_hash_[hash].push_back(entries_.begin());
+  total_bytes_ += bytes;
+}
+
+void StrokeShapeCache::SetMaxBytes(size_t max_bytes) {
+  absl::MutexLock lock(&mutex_);
+  max_bytes_ = max_bytes;
+  EvictToFit(max_bytes_);
+}
+
+size_t StrokeShapeCache::MaxBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return max_bytes_;
+}
+
+size_t StrokeShapeCache::TotalBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return total_bytes_;
+}
+
+size_t StrokeShapeCache::EntryCount() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+void StrokeShapeCache::Clear() {
+  absl::MutexLock lock(&mutex_);
+  entries_.clear();
+  entries_by_hash_.clear();
+  total_bytes_ = 0;
+}
+
+size_t StrokeShapeCache::EstimateEntryBytes(const StrokeInputBatch& inputs,
+                                            const PartitionedMesh& shape) {
+  // The inputs are stored more compactly than a `StrokeInput` each, but this
+  // is a reasonable upper bound.
+  size_t bytes = sizeof(Entry) + inputs.Size() * sizeof(StrokeInput);
+  for (const Mesh& mesh : shape.Meshes()) {
+    bytes += mesh.RawVertexData().size() + mesh.RawIndexData().size();
+  }
+  // Outlines store a 16-bit vertex index per vertex, plus a little for each
+  // run of vertices in the same mesh, which this ignores.
+  for (uint32_t group = 0; group < shape.RenderGroupCount(); ++group) {
+    for (uint32_t outline = 0; outline < shape.OutlineCount(group);
+         ++outline) {
+      bytes += shape.OutlineVertexCount(group, outline) * sizeof(uint16_t);
+    }
+  }
+  return bytes;
+}
+
+size_t StrokeShapeCache::HashKey(const Brush& brush,
+                                 const StrokeInputBatch& inputs) {
+  return absl::Hash<HashableKey>()(HashableKey{brush, inputs});
+}
+
+bool StrokeShapeCache::KeyMatches(const Key& key, const Brush& brush,
+                                  const StrokeInputBatch& inputs) {
+  if (key.brush_size != brush.GetSize() ||
+      key.brush_epsilon != brush.GetEpsilon() ||
+      key.family.GetInputModel().index() !=
+          brush.GetFamily().GetInputModel().index()) {
+    return false;
+  }
+  // Families that share their data, e.g. the family of a brush that every
+  // stroke was drawn with, trivially have equal coats. The client ID is not
+  // part of the key, so this doesn't compare the families as a whole.
+  absl::Span<const BrushCoat> key_coats = key.family.GetCoats();
+  absl::Span<const BrushCoat> coats = brush.GetCoats();
+  if (key_coats.data() != coats.data() && key_coats != coats) return false;
+  return InputBatchesAreEqual(key.inputs, inputs);
+}
+
+StrokeShapeCache::EntryList::iterator StrokeShapeCache::FindEntry(
+    size_t hash, const Brush& brush, const StrokeInputBatch& inputs) {
+  auto bucket = entries_by_hash_.find(hash);
+  if (bucket == entries_by_hash_.end()) return entries_.end();
+  for (EntryList::iterator it : bucket->second) {
+    if (KeyMatches(it->key, brush, inputs)) return it;
+  }
+  return entries_.end();
+}
+
+void StrokeShapeCache::EraseEntry(EntryList::iterator it) {
+  auto bucket = entries_by_hash_.find(it->hash);
+  ABSL_DCHECK(bucket != entries_by_hash_.end());
+  absl::InlinedVector<EntryList::iterator, 1>& bucket_entries = bucket->second;
+  for (size_t i = 0; i < bucket_entries.size(); ++i) {
+    if (bucket_entries[i] == it) {
+      bucket_entries.erase(bucket_entries.begin() + i);
+      break;
+    }
+  }
+  if (bucket_entries.empty()) entries_by_hash_.erase(bucket);
+  total_bytes_ -= it->bytes;
+  entries_.erase(it);
+}
+
+void StrokeShapeCache::EvictToFit(size_t max_bytes) {
+  while (total_bytes_ > max_bytes) {
+    ABSL_DCHECK(!entries_.empty());
+    EraseEntry(std::prev(entries_.end()));
+  }
+}
+
+}  // namespace ink
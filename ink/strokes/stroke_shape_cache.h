@@ -0,0 +1,141 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_STROKE_SHAPE_CACHE_H_
+#define INK_STROKES_STROKE_SHAPE_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <optional>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/synchronization/mutex.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_coat.h"
+#include "ink/brush/brush_family.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+
+namespace ink {
+
+// A bounded cache of stroke shapes, keyed on everything about a `Brush` and
+// `StrokeInputBatch` that affects the shape generated from them.
+//
+// The same stroke is often regenerated from identical inputs, for example on
+// undo and redo, copy and paste, or after a round trip through storage. When a
+// process-wide cache is installed with `SetProcessCache()`, `Stroke` looks up
+// its shape here before generating it, and adds newly generated shapes.
+//
+// Entries are keyed on the brush coats, input model, size and epsilon, and on
+// the contents of the inputs, including the noise seed. The brush color does
+// not affect the shape, and so is not part of the key. Since `PartitionedMesh`
+// shares its data between copies, a cache hit does not copy any mesh data.
+//
+// The cache keeps an estimate of the number of bytes used by its entries, and
+// evicts the least recently used entries to stay within `MaxBytes()`.
+//
+// This type is thread-safe.
+class StrokeShapeCache {
+ public:
+  explicit StrokeShapeCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+  StrokeShapeCache(const StrokeShapeCache&) = delete;
+  StrokeShapeCache& operator=(const StrokeShapeCache&) = delete;
+  ~StrokeShapeCache() = default;
+
+  // Returns the process-wide cache used by `Stroke`, or null if none has been
+  // installed, which is the default.
+  static std::shared_ptr<StrokeShapeCache> GetProcessCache();
+
+  // Installs `cache` as the process-wide cache used by `Stroke`, replacing any
+  // previous one. Passing null disables caching. The process-wide cache is
+  // cleared by `TrimMemory()` with `MemoryTrimLevel::kCaches` or higher.
+  static void SetProcessCache(std::shared_ptr<StrokeShapeCache> cache);
+
+  // Returns the cached shape for `brush` and `inputs` if there is one, marking
+  // it as the most recently used entry.
+  std::optional<PartitionedMesh> Find(const Brush& brush,
+                                      const StrokeInputBatch& inputs);
+
+  // Adds `shape` as the shape for `brush` and `inputs`, replacing any existing
+  // entry, then evicts entries as needed to stay within `MaxBytes()`. A shape
+  // that is larger than `MaxBytes()` on its own is not added.
+  void Insert(const Brush& brush, const StrokeInputBatch& inputs,
+              const PartitionedMesh& shape);
+
+  // Sets the maximum number of bytes used by entries, evicting the least
+  // recently used entries if needed.
+  void SetMaxBytes(size_t max_bytes);
+  size_t MaxBytes() const;
+
+  // Returns the estimated number of bytes used by all current entries.
+  size_t TotalBytes() const;
+
+  // Returns the number of entries currently in the cache.
+  size_t EntryCount() const;
+
+  // Removes all entries.
+  void Clear();
+
+  // Returns the estimated number of bytes that an entry for `inputs` and
+  // `shape` would use.
+  static size_t EstimateEntryBytes(const StrokeInputBatch& inputs,
+                                   const PartitionedMesh& shape);
+
+ private:
+  struct Key {
+    // Only the coats and input model of the family are part of the key. It is
+    // held by value since its copies share the same data.
+    BrushFamily family;
+    float brush_size;
+    float brush_epsilon;
+    StrokeInputBatch inputs;
+  };
+
+  struct Entry {
+    Key key;
+    PartitionedMesh shape;
+    size_t hash;
+    size_t bytes;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  static size_t HashKey(const Brush& brush, const StrokeInputBatch& inputs);
+  static bool KeyMatches(const Key& key, const Brush& brush,
+                         const StrokeInputBatch& inputs);
+
+  // Returns the entry for `brush` and `inputs` with the precomputed `hash`, or
+  // `entries_.end()` if there is none.
+  EntryList::iterator FindEntry(size_t hash, const Brush& brush,
+                                const StrokeInputBatch& inputs)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void EraseEntry(EntryList::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void EvictToFit(size_t max_bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  size_t max_bytes_ ABSL_GUARDED_BY(mutex_);
+  size_t total_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Entries ordered from most to least recently used.
+  EntryList entries_ ABSL_GUARDED_BY(mutex_);
+  // Maps each key hash to all of the entries with that hash.
+  absl::flat_hash_map<size_t, absl::InlinedVector<EntryList::iterator, 1>>
+      entries_by_hash_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace ink
+
+#endif  // INK_STROKES_STROKE_SHAPE_CACHE_H_
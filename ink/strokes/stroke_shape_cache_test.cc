@@ -0,0 +1,241 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/strokes/stroke_shape_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "ink/brush/brush.h"
+#include "ink/brush/brush_family.h"
+#include "ink/brush/brush_tip.h"
+#include "ink/color/color.h"
+#include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/type_matchers.h"
+#include "ink/strokes/input/stroke_input_batch.h"
+#include "ink/strokes/stroke.h"
+#include "ink/types/duration.h"
+#include "ink/types/memory_trim.h"
+
+namespace ink {
+namespace {
+
+using ::testing::Not;
+using ::testing::Optional;
+
+Brush CreateBrush(const BrushTip& tip = BrushTip(), float size = 10,
+                  const Color& color = Color::Black()) {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(tip, {});
+  ABSL_CHECK_OK(family);
+  absl::StatusOr<Brush> brush = Brush::Create(*family, color, size, 0.1);
+  ABSL_CHECK_OK(brush);
+  return *brush;
+}
+
+StrokeInputBatch CreateInputs(float end_x = 5, uint32_t noise_seed = 0) {
+  absl::StatusOr<StrokeInputBatch> inputs = StrokeInputBatch::Create(
+      {
+          {.position = {0, 0}, .elapsed_time = Duration32::Zero()},
+          {.position = {2, 1}, .elapsed_time = Duration32::Seconds(0.1)},
+          {.position = {end_x, 2}, .elapsed_time = Duration32::Seconds(0.2)},
+      },
+      noise_seed);
+  ABSL_CHECK_OK(inputs);
+  return *inputs;
+}
+
+PartitionedMesh CreateShape(const Brush& brush,
+                            const StrokeInputBatch& inputs) {
+  return Stroke(brush, inputs).GetShape();
+}
+
+TEST(StrokeShapeCacheTest, EmptyCache) {
+  StrokeShapeCache cache(1 << 20);
+  EXPECT_EQ(cache.MaxBytes(), 1 << 20);
+  EXPECT_EQ(cache.TotalBytes(), 0);
+  EXPECT_EQ(cache.EntryCount(), 0);
+  EXPECT_EQ(cache.Find(CreateBrush(), CreateInputs()), std::nullopt);
+}
+
+TEST(StrokeShapeCacheTest, InsertAndFind) {
+  StrokeShapeCache cache(1 << 20);
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateInputs();
+  PartitionedMesh shape = CreateShape(brush, inputs);
+  cache.Insert(brush, inputs, shape);
+
+  EXPECT_EQ(cache.EntryCount(), 1);
+  EXPECT_EQ(cache.TotalBytes(),
+            StrokeShapeCache::EstimateEntryBytes(inputs, shape));
+  EXPECT_THAT(cache.Find(brush, inputs),
+              Optional(PartitionedMeshShallowEq(shape)));
+  // Equal inputs that don't share data also hit.
+  EXPECT_THAT(cache.Find(brush, inputs.MakeDeepCopy()),
+              Optional(PartitionedMeshShallowEq(shape)));
+}
+
+TEST(StrokeShapeCacheTest, BrushColorIsNotPartOfKey) {
+  StrokeShapeCache cache(1 << 20);
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateInputs();
+  PartitionedMesh shape = CreateShape(brush, inputs);
+  cache.Insert(brush, inputs, shape);
+
+  EXPECT_THAT(cache.Find(CreateBrush(BrushTip(), 10, Color::White()), inputs),
+              Optional(PartitionedMeshShallowEq(shape)));
+}
+
+TEST(StrokeShapeCacheTest, DifferentKeysMiss) {
+  StrokeShapeCache cache(1 << 20);
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateInputs();
+  cache.Insert(brush, inputs, CreateShape(brush, inputs));
+
+  EXPECT_EQ(cache.Find(CreateBrush(BrushTip(), 20), inputs), std::nullopt);
+  EXPECT_EQ(cache.Find(CreateBrush(BrushTip{.corner_rounding = 0}), inputs),
+            std::nullopt);
+  EXPECT_EQ(cache.Find(brush, CreateInputs(6)), std::nullopt);
+  EXPECT_EQ(cache.Find(brush, CreateInputs(5, 1)), std::nullopt);
+}
+
+TEST(StrokeShapeCacheTest, InsertReplacesExistingEntry) {
+  StrokeShapeCache cache(1 << 20);
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateInputs();
+  cache.Insert(brush, inputs, CreateShape(brush, inputs));
+  PartitionedMesh shape = CreateShape(brush, inputs);
+  cache.Insert(brush, inputs, shape);
+
+  EXPECT_EQ(cache.EntryCount(), 1);
+  EXPECT_EQ(cache.TotalBytes(),
+            StrokeShapeCache::EstimateEntryBytes(inputs, shape));
+  EXPECT_THAT(cache.Find(brush, inputs),
+              Optional(PartitionedMeshShallowEq(shape)));
+}
+
+TEST(StrokeShapeCacheTest, EvictsLeastRecentlyUsed) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs_a = CreateInputs(5);
+  StrokeInputBatch inputs_b = CreateInputs(6);
+  StrokeInputBatch inputs_c = CreateInputs(7);
+  PartitionedMesh shape_a = CreateShape(brush, inputs_a);
+  PartitionedMesh shape_b = CreateShape(brush, inputs_b);
+  PartitionedMesh shape_c = CreateShape(brush, inputs_c);
+  size_t bytes_a = StrokeShapeCache::EstimateEntryBytes(inputs_a, shape_a);
+  size_t bytes_b = StrokeShapeCache::EstimateEntryBytes(inputs_b, shape_b);
+  size_t bytes_c = StrokeShapeCache::EstimateEntryBytes(inputs_c, shape_c);
+
+  // Only room for `b` and `c`, or for `a` and `c`.
+  StrokeShapeCache cache(std::max(bytes_a, bytes_b) + bytes_c);
+  cache.Insert(brush, inputs_a, shape_a);
+  cache.Insert(brush, inputs_b, shape_b);
+  // Use `a`, so that `b` is the least recently used.
+  ASSERT_NE(cache.Find(brush, inputs_a), std::nullopt);
+  cache.Insert(brush, inputs_c, shape_c);
+
+  EXPECT_EQ(cache.EntryCount(), 2);
+  EXPECT_EQ(cache.TotalBytes(), bytes_a + bytes_c);
+  EXPECT_NE(cache.Find(brush, inputs_a), std::nullopt);
+  EXPECT_EQ(cache.Find(brush, inputs_b), std::nullopt);
+  EXPECT_NE(cache.Find(brush, inputs_c), std::nullopt);
+}
+
+TEST(StrokeShapeCacheTest, DoesNotInsertEntryLargerThanMaxBytes) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateInputs();
+  PartitionedMesh shape = CreateShape(brush, inputs);
+  StrokeShapeCache cache(StrokeShapeCache::EstimateEntryBytes(inputs, shape) -
+                         1);
+  cache.Insert(brush, inputs, shape);
+  EXPECT_EQ(cache.EntryCount(), 0);
+  EXPECT_EQ(cache.TotalBytes(), 0);
+}
+
+TEST(StrokeShapeCacheTest, SetMaxBytesEvicts) {
+  StrokeShapeCache cache(1 << 20);
+  Brush brush = CreateBrush();
+  cache.Insert(brush, CreateInputs(5), CreateShape(brush, CreateInputs(5)));
+  cache.Insert(brush, CreateInputs(6), CreateShape(brush, CreateInputs(6)));
+  ASSERT_EQ(cache.EntryCount(), 2);
+
+  cache.SetMaxBytes(cache.TotalBytes() - 1);
+  EXPECT_EQ(cache.EntryCount(), 1);
+  EXPECT_NE(cache.Find(brush, CreateInputs(6)), std::nullopt);
+
+  cache.SetMaxBytes(0);
+  EXPECT_EQ(cache.MaxBytes(), 0);
+  EXPECT_EQ(cache.EntryCount(), 0);
+  EXPECT_EQ(cache.TotalBytes(), 0);
+}
+
+TEST(StrokeShapeCacheTest, Clear) {
+  StrokeShapeCache cache(1 << 20);
+  Brush brush = CreateBrush();
+  cache.Insert(brush, CreateInputs(), CreateShape(brush, CreateInputs()));
+  cache.Clear();
+  EXPECT_EQ(cache.EntryCount(), 0);
+  EXPECT_EQ(cache.TotalBytes(), 0);
+  EXPECT_EQ(cache.Find(brush, CreateInputs()), std::nullopt);
+}
+
+TEST(StrokeShapeCacheTest, StrokeUsesProcessCache) {
+  ASSERT_EQ(StrokeShapeCache::GetProcessCache(), nullptr);
+  auto cache = std::make_shared<StrokeShapeCache>(1 << 20);
+  StrokeShapeCache::SetProcessCache(cache);
+  EXPECT_EQ(StrokeShapeCache::GetProcessCache(), cache);
+
+  Brush brush = CreateBrush();
+  Stroke first_stroke(brush, CreateInputs());
+  EXPECT_EQ(cache->EntryCount(), 1);
+  Stroke second_stroke(CreateBrush(BrushTip(), 10, Color::White()),
+                       CreateInputs());
+  EXPECT_EQ(cache->EntryCount(), 1);
+  EXPECT_THAT(second_stroke.GetShape(),
+              PartitionedMeshShallowEq(first_stroke.GetShape()));
+
+  StrokeShapeCache::SetProcessCache(nullptr);
+  EXPECT_EQ(StrokeShapeCache::GetProcessCache(), nullptr);
+  Stroke third_stroke(brush, CreateInputs());
+  EXPECT_THAT(third_stroke.GetShape(),
+              PartitionedMeshDeepEq(first_stroke.GetShape()));
+  EXPECT_THAT(third_stroke.GetShape(),
+              Not(PartitionedMeshShallowEq(first_stroke.GetShape())));
+}
+
+TEST(StrokeShapeCacheTest, TrimMemoryClearsProcessCache) {
+  auto cache = std::make_shared<StrokeShapeCache>(1 << 20);
+  StrokeShapeCache::SetProcessCache(cache);
+  Brush brush = CreateBrush();
+  cache->Insert(brush, CreateInputs(), CreateShape(brush, CreateInputs()));
+  size_t bytes = cache->TotalBytes();
+  ASSERT_GT(bytes, 0);
+
+  // Pooled memory is trimmed before caches, so this keeps the entry.
+  TrimMemory(MemoryTrimLevel::kPooledMemory);
+  EXPECT_EQ(cache->EntryCount(), 1);
+
+  EXPECT_GE(TrimMemory(MemoryTrimLevel::kCaches), bytes);
+  EXPECT_EQ(cache->EntryCount(), 0);
+  StrokeShapeCache::SetProcessCache(nullptr);
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,100 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_STROKES_STROKE_SHAPE_STATS_H_
+#define INK_STROKES_STROKE_SHAPE_STATS_H_
+
+#include <cstdint>
+
+namespace ink {
+
+// True if Ink was built with `INK_ENABLE_STROKE_SHAPE_STATS` defined (e.g. by
+// passing `--copt=-DINK_ENABLE_STROKE_SHAPE_STATS` to Bazel). Otherwise, the
+// code that collects `StrokeShapeStats` compiles away and every value reported
+// is zero.
+#ifdef INK_ENABLE_STROKE_SHAPE_STATS
+inline constexpr bool kStrokeShapeStatsEnabled = true;
+#else
+inline constexpr bool kStrokeShapeStatsEnabled = false;
+#endif
+
+// Timings and counters describing the work done to update the shape of a
+// stroke, e.g. by one call to `InProgressStroke::UpdateShape()`.
+//
+// Times are wall-clock durations in nanoseconds. When brush coats are updated
+// concurrently, the per-coat times are summed, so the stage times can add up to
+// more than the wall-clock time of the whole update.
+struct StrokeShapeStats {
+  // Time spent modeling the raw stroke inputs.
+  int64_t input_modeling_nanos = 0;
+  // Time spent turning modeled inputs into brush tip states.
+  int64_t tip_modeling_nanos = 0;
+  // Time spent extruding brush tip states into mesh geometry. This includes
+  // the time in `intersection_handling_nanos` and `simplification_nanos`, as
+  // well as writing the new vertices and triangles to the mesh, but not the
+  // time in `derivative_update_nanos`.
+  int64_t extrusion_nanos = 0;
+  // Time spent handling and retriangulating self-intersecting geometry.
+  int64_t intersection_handling_nanos = 0;
+  // Time spent simplifying the outline of newly extruded geometry.
+  int64_t simplification_nanos = 0;
+  // Time spent updating vertex derivatives and margins after extrusion.
+  int64_t derivative_update_nanos = 0;
+
+  // Number of vertices and triangles added to the mesh, including any that
+  // replaced reverted geometry.
+  int64_t vertices_appended = 0;
+  int64_t triangles_appended = 0;
+  // Number of vertices and triangles removed from the mesh to be re-extruded,
+  // typically because they were built from volatile or predicted inputs.
+  int64_t vertices_reverted = 0;
+  int64_t triangles_reverted = 0;
+  // Number of extruded vertices dropped by outline simplification before they
+  // were written to the mesh.
+  int64_t vertices_simplified_away = 0;
+  // Number of times adaptive self-intersection handling exceeded its
+  // retriangulation budget while extruding one brush tip state, and so gave up
+  // handling self-intersections for the rest of it. See
+  // `StrokeShapeBudget::max_retriangulated_triangles_per_tip_state`.
+  int64_t intersection_handling_fallbacks = 0;
+
+  // Adds every value of `other` to the corresponding value of this object.
+  void Add(const StrokeShapeStats& other);
+
+  friend bool operator==(const StrokeShapeStats&,
+                         const StrokeShapeStats&) = default;
+};
+
+// ---------------------------------------------------------------------------
+//                     Implementation details below
+
+inline void StrokeShapeStats::Add(const StrokeShapeStats& other) {
+  input_modeling_nanos += other.input_modeling_nanos;
+  tip_modeling_nanos += other.tip_modeling_nanos;
+  extrusion_nanos += other.extrusion_nanos;
+  intersection_handling_nanos += other.intersection_handling_nanos;
+  simplification_nanos += other.simplification_nanos;
+  derivative_update_nanos += other.derivative_update_nanos;
+  vertices_appended += other.vertices_appended;
+  triangles_appended += other.triangles_appended;
+  vertices_reverted += other.vertices_reverted;
+  triangles_reverted += other.triangles_reverted;
+  vertices_simplified_away += other.vertices_simplified_away;
+  intersection_handling_fallbacks += other.intersection_handling_fallbacks;
+}
+
+}  // namespace ink
+
+#endif  // INK_STROKES_STROKE_SHAPE_STATS_H_
@@ -14,9 +14,13 @@
 
 #include "ink/strokes/stroke.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -34,17 +38,25 @@
 #include "ink/brush/fuzz_domains.h"
 #include "ink/brush/type_matchers.h"
 #include "ink/color/color.h"
+#include "ink/geometry/affine_transform.h"
 #include "ink/geometry/angle.h"
 #include "ink/geometry/envelope.h"
+#include "ink/geometry/mesh.h"
 #include "ink/geometry/mesh_test_helpers.h"
 #include "ink/geometry/partitioned_mesh.h"
+#include "ink/geometry/point.h"
 #include "ink/geometry/rect.h"
 #include "ink/geometry/type_matchers.h"
+#include "ink/geometry/vec.h"
 #include "ink/strokes/input/fuzz_domains.h"
 #include "ink/strokes/input/stroke_input.h"
 #include "ink/strokes/input/stroke_input_batch.h"
 #include "ink/strokes/input/type_matchers.h"
+#include "ink/strokes/performance_profile.h"
+#include "ink/types/cancellation_token.h"
 #include "ink/types/duration.h"
+#include "ink/types/memory_footprint.h"
+#include "ink/types/test_executor.h"
 
 namespace ink {
 namespace {
@@ -107,6 +119,19 @@ StrokeInputBatch CreateFilledInputs() {
 
 StrokeInputBatch CreateEmptyInputs() { return StrokeInputBatch(); }
 
+// Returns `count` inputs along a horizontal line, one unit and 10 ms apart.
+StrokeInputBatch CreateLineInputs(int count) {
+  std::vector<StrokeInput> inputs;
+  for (int i = 0; i < count; ++i) {
+    inputs.push_back({.tool_type = StrokeInput::ToolType::kStylus,
+                      .position = {static_cast<float>(i), 0},
+                      .elapsed_time = Duration32::Millis(10 * i)});
+  }
+  absl::StatusOr<StrokeInputBatch> batch = StrokeInputBatch::Create(inputs);
+  ABSL_CHECK_OK(batch);
+  return *batch;
+}
+
 PartitionedMesh CreateFilledShape() {
   auto shape = PartitionedMesh::FromMutableMesh(
       MakeStraightLineMutableMesh(18, MakeSinglePackedPositionFormat()),
@@ -580,6 +605,484 @@ TEST(StrokeTest, GetInputDuration) {
   EXPECT_EQ(stroke.GetInputDuration(), Duration32::Seconds(2));
 }
 
+TEST(StrokeTest, ConstructWithCoatExecutorMatchesSequentialShape) {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create({
+      BrushCoat{.tip = BrushTip()},
+      BrushCoat{.tip = BrushTip{.scale = {0.5, 1}, .corner_rounding = 0}},
+      BrushCoat{.tip = BrushTip{.scale = {1, 0.25}}},
+  });
+  ASSERT_EQ(family.status(), absl::OkStatus());
+  absl::StatusOr<Brush> brush = Brush::Create(*family, Color::White(), 10, 0.1);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  StrokeInputBatch inputs = CreateFilledInputs();
+
+  ThreadPerTaskExecutor executor;
+  Stroke parallel_stroke(*brush, inputs, &executor);
+  Stroke sequential_stroke(*brush, inputs);
+
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+  ASSERT_EQ(parallel_stroke.GetShape().RenderGroupCount(), 3u);
+  EXPECT_THAT(parallel_stroke.GetShape(),
+              PartitionedMeshDeepEq(sequential_stroke.GetShape()));
+
+  parallel_stroke.SetBrushAndInputs(*brush, CreateEmptyInputs(), &executor);
+  EXPECT_TRUE(parallel_stroke.GetShape().Bounds().IsEmpty());
+  parallel_stroke.SetBrushAndInputs(*brush, inputs, &executor);
+  EXPECT_EQ(executor.ParallelForCalls(), 2);
+  EXPECT_THAT(parallel_stroke.GetShape(),
+              PartitionedMeshDeepEq(sequential_stroke.GetShape()));
+}
+
+TEST(StrokeTest, ApplyTransformWithSimilarityTransformsShapeInPlace) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke original(brush, inputs);
+  original.GetShape().InitializeSpatialIndex();
+
+  // A quarter turn, a uniform scale by 2, and a translation.
+  AffineTransform transform(0, -2, 3, 2, 0, -1);
+  Stroke stroke = original;
+  ASSERT_EQ(stroke.ApplyTransform(transform), absl::OkStatus());
+
+  StrokeInputBatch expected_inputs = inputs;
+  expected_inputs.Transform(transform);
+  EXPECT_THAT(stroke.GetInputs(), StrokeInputBatchEq(expected_inputs));
+  EXPECT_FLOAT_EQ(stroke.GetBrush().GetSize(), 2 * brush.GetSize());
+  EXPECT_FLOAT_EQ(stroke.GetBrush().GetEpsilon(), 2 * brush.GetEpsilon());
+
+  // The shape has the same meshes and outlines as before, with each vertex
+  // moved by `transform`, rather than being re-extruded for the rotated inputs.
+  const PartitionedMesh& old_shape = original.GetShape();
+  const PartitionedMesh& new_shape = stroke.GetShape();
+  ASSERT_EQ(new_shape.RenderGroupCount(), old_shape.RenderGroupCount());
+  ASSERT_EQ(new_shape.Meshes().size(), old_shape.Meshes().size());
+  EXPECT_EQ(new_shape.OutlineCount(0), old_shape.OutlineCount(0));
+  EXPECT_TRUE(new_shape.IsSpatialIndexInitialized());
+  for (size_t m = 0; m < old_shape.Meshes().size(); ++m) {
+    const Mesh& old_mesh = old_shape.Meshes()[m];
+    const Mesh& new_mesh = new_shape.Meshes()[m];
+    ASSERT_EQ(new_mesh.VertexCount(), old_mesh.VertexCount());
+    ASSERT_EQ(new_mesh.TriangleCount(), old_mesh.TriangleCount());
+    for (uint32_t i = 0; i < old_mesh.VertexCount(); ++i) {
+      EXPECT_THAT(new_mesh.VertexPosition(i),
+                  PointNear(transform.Apply(old_mesh.VertexPosition(i)), 0.02));
+    }
+  }
+  Envelope expected_bounds(transform.Apply(*old_shape.Bounds().AsRect()));
+  EXPECT_THAT(new_shape.Bounds(),
+              EnvelopeNear(*expected_bounds.AsRect(), 0.02));
+}
+
+TEST(StrokeTest, ApplyTransformWithShearRegeneratesShape) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke stroke(brush, inputs);
+
+  AffineTransform shear = AffineTransform::SkewX(0.5);
+  ASSERT_EQ(stroke.ApplyTransform(shear), absl::OkStatus());
+
+  StrokeInputBatch expected_inputs = inputs;
+  expected_inputs.Transform(shear);
+  Stroke expected(brush, expected_inputs);
+  EXPECT_THAT(stroke.GetBrush(), BrushEq(brush));
+  EXPECT_THAT(stroke.GetInputs(), StrokeInputBatchEq(expected_inputs));
+  EXPECT_THAT(stroke.GetShape(), PartitionedMeshDeepEq(expected.GetShape()));
+}
+
+TEST(StrokeTest, ApplyTransformWithSingularTransformReturnsError) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke stroke(brush, inputs);
+  Envelope bounds = stroke.GetShape().Bounds();
+
+  absl::Status status = stroke.ApplyTransform(AffineTransform::Scale(0));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(stroke.GetInputs(), StrokeInputBatchEq(inputs));
+  EXPECT_THAT(stroke.GetShape().Bounds(), EnvelopeEq(bounds));
+}
+
+TEST(StrokeTest, SplitAtErasedInputsWithNothingErasedReturnsCopy) {
+  Stroke stroke(CreateBrush(), CreateLineInputs(30));
+
+  std::vector<Stroke> pieces = stroke.SplitAtErasedInputs({});
+  ASSERT_THAT(pieces, SizeIs(1));
+  EXPECT_THAT(pieces[0].GetInputs(), StrokeInputBatchEq(stroke.GetInputs()));
+  EXPECT_THAT(pieces[0].GetShape(), PartitionedMeshDeepEq(stroke.GetShape()));
+
+  // Empty ranges and ranges past the end of the inputs don't erase anything.
+  pieces = stroke.SplitAtErasedInputs(
+      {{.start = 5, .end = 5}, {.start = 30, .end = 40}});
+  ASSERT_THAT(pieces, SizeIs(1));
+  EXPECT_THAT(pieces[0].GetInputs(), StrokeInputBatchEq(stroke.GetInputs()));
+  EXPECT_THAT(pieces[0].GetShape(), PartitionedMeshDeepEq(stroke.GetShape()));
+}
+
+TEST(StrokeTest, SplitAtErasedInputsReturnsRemainingPieces) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateLineInputs(30);
+  Stroke stroke(brush, inputs);
+
+  std::vector<Stroke> pieces = stroke.SplitAtErasedInputs(
+      {{.start = 12, .end = 18}, {.start = 10, .end = 15}});
+  ASSERT_THAT(pieces, SizeIs(2));
+  EXPECT_THAT(pieces[0].GetBrush(), BrushEq(brush));
+  ASSERT_EQ(pieces[0].GetInputs().Size(), 10u);
+  EXPECT_THAT(pieces[0].GetInputs().Get(0), StrokeInputEq(inputs.Get(0)));
+  EXPECT_THAT(pieces[0].GetInputs().Get(9), StrokeInputEq(inputs.Get(9)));
+  ASSERT_EQ(pieces[1].GetInputs().Size(), 12u);
+  EXPECT_THAT(pieces[1].GetInputs().Get(0), StrokeInputEq(inputs.Get(18)));
+  EXPECT_THAT(pieces[1].GetInputs().Get(11), StrokeInputEq(inputs.Get(29)));
+
+  // Each piece follows the path of the original stroke, so it lies within the
+  // original shape, with a gap where the inputs were erased.
+  Rect bounds = *stroke.GetShape().Bounds().AsRect();
+  Rect bounds0 = *pieces[0].GetShape().Bounds().AsRect();
+  Rect bounds1 = *pieces[1].GetShape().Bounds().AsRect();
+  for (const Rect& piece_bounds : {bounds0, bounds1}) {
+    EXPECT_GE(piece_bounds.XMin(), bounds.XMin() - 0.01);
+    EXPECT_LE(piece_bounds.XMax(), bounds.XMax() + 0.01);
+    EXPECT_GE(piece_bounds.YMin(), bounds.YMin() - 0.01);
+    EXPECT_LE(piece_bounds.YMax(), bounds.YMax() + 0.01);
+  }
+  EXPECT_LT(bounds0.XMax(), bounds1.XMin());
+}
+
+TEST(StrokeTest, SplitAtErasedInputsWithEverythingErased) {
+  Stroke stroke(CreateBrush(), CreateLineInputs(30));
+  EXPECT_THAT(stroke.SplitAtErasedInputs({{.start = 0, .end = 30}}),
+              IsEmpty());
+  EXPECT_THAT(Stroke(CreateBrush()).SplitAtErasedInputs({}), IsEmpty());
+}
+
+TEST(StrokeTest, RegenerateShapesMatchesIndividualRegeneration) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke expected_stroke(brush, inputs);
+
+  std::vector<Stroke> strokes;
+  for (int i = 0; i < 5; ++i) {
+    strokes.emplace_back(
+        brush, inputs, PartitionedMesh::WithEmptyGroups(brush.CoatCount()));
+  }
+  // Include a stroke with no inputs to check that it's left empty.
+  strokes.emplace_back(brush);
+  std::vector<Stroke*> stroke_pointers;
+  for (Stroke& stroke : strokes) stroke_pointers.push_back(&stroke);
+
+  ThreadPerTaskExecutor executor;
+  std::vector<absl::Status> statuses =
+      Stroke::RegenerateShapes(stroke_pointers, executor);
+
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+  ASSERT_THAT(statuses, SizeIs(strokes.size()));
+  for (const absl::Status& status : statuses) {
+    EXPECT_EQ(status, absl::OkStatus());
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_THAT(strokes[i].GetShape(),
+                PartitionedMeshDeepEq(expected_stroke.GetShape()));
+  }
+  EXPECT_TRUE(strokes.back().GetShape().Bounds().IsEmpty());
+  EXPECT_EQ(strokes.back().GetShape().RenderGroupCount(), brush.CoatCount());
+}
+
+TEST(StrokeTest, RegenerateShapesWithNoStrokes) {
+  ThreadPerTaskExecutor executor;
+  EXPECT_THAT(Stroke::RegenerateShapes({}, executor), IsEmpty());
+}
+
+TEST(StrokeTest, RegenerateShapesAsyncPublishesCompleteStrokes) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke expected_stroke(brush, inputs);
+
+  std::vector<Stroke> strokes;
+  for (int i = 0; i < 3; ++i) {
+    strokes.push_back(Stroke::WithLazyShape(brush, inputs));
+  }
+  std::vector<std::optional<absl::StatusOr<Stroke>>> results(strokes.size());
+
+  ManualExecutor executor;
+  Stroke::RegenerateShapesAsync(
+      std::move(strokes), executor, CancellationToken(),
+      [&results](size_t index, absl::StatusOr<Stroke> stroke) {
+        results[index] = std::move(stroke);
+      });
+  EXPECT_EQ(executor.PendingTaskCount(), 3u);
+  executor.RunScheduledTasks();
+
+  for (const std::optional<absl::StatusOr<Stroke>>& result : results) {
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(result->status(), absl::OkStatus());
+    EXPECT_THAT((*result)->GetInputs(), StrokeInputBatchEq(inputs));
+    EXPECT_THAT((*result)->GetShape(),
+                PartitionedMeshDeepEq(expected_stroke.GetShape()));
+  }
+}
+
+TEST(StrokeTest, RegenerateShapesAsyncCancelledBeforeRunning) {
+  Brush brush = CreateBrush();
+  std::vector<Stroke> strokes;
+  for (int i = 0; i < 3; ++i) {
+    strokes.push_back(Stroke::WithLazyShape(brush, CreateFilledInputs()));
+  }
+  std::vector<absl::Status> statuses(strokes.size());
+
+  ManualExecutor executor;
+  CancellationToken cancellation;
+  Stroke::RegenerateShapesAsync(
+      std::move(strokes), executor, cancellation,
+      [&statuses](size_t index, absl::StatusOr<Stroke> stroke) {
+        statuses[index] = stroke.status();
+      });
+  cancellation.Cancel();
+  executor.RunScheduledTasks();
+
+  for (const absl::Status& status : statuses) {
+    EXPECT_EQ(status.code(), absl::StatusCode::kCancelled);
+  }
+}
+
+TEST(StrokeTest, RegenerateShapesAsyncOnOtherThreads) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke expected_stroke(brush, inputs);
+
+  std::vector<Stroke> strokes;
+  for (int i = 0; i < 5; ++i) {
+    strokes.push_back(Stroke::WithLazyShape(brush, inputs));
+  }
+  // `on_done` is never called concurrently, so `results` needs no lock of its
+  // own, but the executor must finish before it's read.
+  std::vector<std::optional<absl::StatusOr<Stroke>>> results(strokes.size());
+  {
+    ThreadPerTaskExecutor executor;
+    Stroke::RegenerateShapesAsync(
+        std::move(strokes), executor, CancellationToken(),
+        [&results](size_t index, absl::StatusOr<Stroke> stroke) {
+          results[index] = std::move(stroke);
+        });
+  }
+
+  for (const std::optional<absl::StatusOr<Stroke>>& result : results) {
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(result->status(), absl::OkStatus());
+    EXPECT_THAT((*result)->GetShape(),
+                PartitionedMeshDeepEq(expected_stroke.GetShape()));
+  }
+}
+
+TEST(StrokeTest, WithLazyShapeMatchesEagerShape) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke eager_stroke(brush, inputs);
+  Stroke lazy_stroke = Stroke::WithLazyShape(brush, inputs);
+
+  EXPECT_THAT(lazy_stroke.GetBrush(), BrushEq(brush));
+  EXPECT_THAT(lazy_stroke.GetInputs(), StrokeInputBatchEq(inputs));
+  EXPECT_THAT(lazy_stroke.GetShape(),
+              PartitionedMeshDeepEq(eager_stroke.GetShape()));
+}
+
+TEST(StrokeTest, WithLazyShapeAndEmptyInputs) {
+  Brush brush = CreateBrush();
+  Stroke stroke = Stroke::WithLazyShape(brush, CreateEmptyInputs());
+  EXPECT_TRUE(stroke.GetShape().Bounds().IsEmpty());
+  EXPECT_EQ(stroke.GetShape().RenderGroupCount(), brush.CoatCount());
+}
+
+TEST(StrokeTest, WithLazyShapeCopiesShareGeneratedShape) {
+  Brush brush = CreateBrush();
+  Stroke stroke = Stroke::WithLazyShape(brush, CreateFilledInputs());
+  Stroke copy = stroke;
+  ThreadPerTaskExecutor executor;
+  copy.PrefetchShape(&executor);
+
+  // Both strokes see the same mesh data, since it is only generated once.
+  EXPECT_THAT(stroke.GetShape(), PartitionedMeshShallowEq(copy.GetShape()));
+}
+
+TEST(StrokeTest, WithLazyShapeConcurrentFirstAccess) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke expected_stroke(brush, inputs);
+  Stroke lazy_stroke = Stroke::WithLazyShape(brush, inputs);
+
+  ThreadPerTaskExecutor executor;
+  std::vector<const PartitionedMesh*> shapes(8);
+  executor.ParallelFor(shapes.size(), [&](size_t i) {
+    if (i % 2 == 0) lazy_stroke.PrefetchShape();
+    shapes[i] = &lazy_stroke.GetShape();
+  });
+
+  for (const PartitionedMesh* shape : shapes) {
+    EXPECT_EQ(shape, &lazy_stroke.GetShape());
+  }
+  EXPECT_THAT(lazy_stroke.GetShape(),
+              PartitionedMeshDeepEq(expected_stroke.GetShape()));
+}
+
+TEST(StrokeTest, WithLazyShapeKeepsShapeFromOriginalBrush) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke eager_stroke(brush, inputs);
+  Stroke lazy_stroke = Stroke::WithLazyShape(brush, inputs);
+
+  // Changing only the color does not regenerate the shape, so the deferred
+  // shape must still match the shape of the original brush.
+  lazy_stroke.SetBrushColor(Color::Black());
+  EXPECT_THAT(lazy_stroke.GetShape(),
+              PartitionedMeshDeepEq(eager_stroke.GetShape()));
+
+  // Changing the size does regenerate the shape.
+  ASSERT_EQ(lazy_stroke.SetBrushSize(20), absl::OkStatus());
+  ASSERT_EQ(eager_stroke.SetBrushSize(20), absl::OkStatus());
+  EXPECT_THAT(lazy_stroke.GetShape(),
+              PartitionedMeshDeepEq(eager_stroke.GetShape()));
+}
+
+TEST(StrokeTest, SetBrushSizeWithLazyShapeMatchesSetBrushSize) {
+  Brush brush = CreateBrush();
+  StrokeInputBatch inputs = CreateFilledInputs();
+  Stroke eager_stroke(brush, inputs);
+  Stroke lazy_stroke(brush, inputs);
+  Stroke original_stroke = lazy_stroke;
+
+  ASSERT_EQ(lazy_stroke.SetBrushSizeWithLazyShape(20), absl::OkStatus());
+  ASSERT_EQ(eager_stroke.SetBrushSize(20), absl::OkStatus());
+  EXPECT_EQ(lazy_stroke.GetBrush().GetSize(), 20);
+  EXPECT_THAT(lazy_stroke.GetShape(),
+              PartitionedMeshDeepEq(eager_stroke.GetShape()));
+  // Copies made before the change keep the old shape.
+  EXPECT_THAT(original_stroke.GetShape(),
+              Not(PartitionedMeshDeepEq(eager_stroke.GetShape())));
+}
+
+TEST(StrokeTest, SetBrushSizeWithLazyShapeInvalidSize) {
+  Brush brush = CreateBrush();
+  Stroke stroke(brush, CreateFilledInputs());
+  PartitionedMesh shape = stroke.GetShape();
+
+  EXPECT_EQ(stroke.SetBrushSizeWithLazyShape(-1).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(stroke.GetBrush(), BrushEq(brush));
+  EXPECT_THAT(stroke.GetShape(), PartitionedMeshShallowEq(shape));
+}
+
+TEST(StrokeTest, SetBrushSizeWithLazyShapeAndEmptyInputs) {
+  Brush brush = CreateBrush();
+  Stroke stroke(brush, CreateEmptyInputs());
+  ASSERT_EQ(stroke.SetBrushSizeWithLazyShape(20), absl::OkStatus());
+  EXPECT_TRUE(stroke.GetShape().Bounds().IsEmpty());
+  EXPECT_EQ(stroke.GetShape().RenderGroupCount(), brush.CoatCount());
+}
+
+uint32_t TotalTriangleCount(const PartitionedMesh& shape) {
+  uint32_t count = 0;
+  for (const Mesh& mesh : shape.Meshes()) count += mesh.TriangleCount();
+  return count;
+}
+
+TEST(StrokeTest, GetShapeAtLevelOfDetailReducesTriangles) {
+  absl::StatusOr<BrushFamily> family = BrushFamily::Create(BrushTip(), {});
+  ASSERT_EQ(family.status(), absl::OkStatus());
+  absl::StatusOr<Brush> brush = Brush::Create(*family, Color::Black(), 5, 0.01);
+  ASSERT_EQ(brush.status(), absl::OkStatus());
+  std::vector<StrokeInput> input_vector;
+  for (int i = 0; i < 200; ++i) {
+    Angle angle = kFullTurn * (i / 200.f);
+    input_vector.push_back({
+        .position = Point{0, 0} + Vec::FromDirectionAndMagnitude(angle, 50),
+        .elapsed_time = Duration32::Millis(i * 10),
+    });
+  }
+  absl::StatusOr<StrokeInputBatch> inputs =
+      StrokeInputBatch::Create(input_vector);
+  ASSERT_EQ(inputs.status(), absl::OkStatus());
+  Stroke stroke(*brush, *inputs);
+
+  EXPECT_THAT(stroke.GetShapeAtLevelOfDetail(0),
+              PartitionedMeshShallowEq(stroke.GetShape()));
+  uint32_t previous_count = TotalTriangleCount(stroke.GetShape());
+  for (uint32_t level = 1; level <= Stroke::kMaxLevelOfDetail; ++level) {
+    const PartitionedMesh& shape = stroke.GetShapeAtLevelOfDetail(level);
+    EXPECT_EQ(shape.RenderGroupCount(), stroke.GetShape().RenderGroupCount());
+    uint32_t count = TotalTriangleCount(shape);
+    EXPECT_GT(count, 0u);
+    EXPECT_LE(count, previous_count) << "level " << level;
+    previous_count = count;
+  }
+  EXPECT_LT(
+      TotalTriangleCount(stroke.GetShapeAtLevelOfDetail(
+          Stroke::kMaxLevelOfDetail)),
+      TotalTriangleCount(stroke.GetShape()));
+}
+
+TEST(StrokeTest, GetShapeAtLevelOfDetailIsCachedAndSharedByCopies) {
+  Stroke stroke(CreateBrush(), CreateFilledInputs());
+  const PartitionedMesh& lod_shape = stroke.GetShapeAtLevelOfDetail(2);
+  EXPECT_EQ(&stroke.GetShapeAtLevelOfDetail(2), &lod_shape);
+
+  Stroke copy = stroke;
+  EXPECT_EQ(&copy.GetShapeAtLevelOfDetail(2), &lod_shape);
+
+  // Changing the inputs of the copy regenerates its levels of detail, but
+  // leaves the original stroke alone.
+  copy.SetInputs(CreateFilledInputs());
+  EXPECT_NE(&copy.GetShapeAtLevelOfDetail(2), &lod_shape);
+  EXPECT_EQ(&stroke.GetShapeAtLevelOfDetail(2), &lod_shape);
+}
+
+TEST(StrokeTest, GetShapeAtLevelOfDetailWithEmptyInputs) {
+  Brush brush = CreateBrush();
+  Stroke stroke(brush);
+  for (uint32_t level = 0; level <= Stroke::kMaxLevelOfDetail; ++level) {
+    EXPECT_EQ(stroke.GetShapeAtLevelOfDetail(level).RenderGroupCount(),
+              brush.CoatCount());
+    EXPECT_TRUE(stroke.GetShapeAtLevelOfDetail(level).Bounds().IsEmpty());
+  }
+}
+
+TEST(StrokeTest, LevelOfDetailForScale) {
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(2), 0);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(1), 0);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.75), 0);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.5), 1);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.3), 1);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.25), 2);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.125), 3);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.001), Stroke::kMaxLevelOfDetail);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0), 0);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(-0.5), 0);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(
+                std::numeric_limits<float>::quiet_NaN()),
+            0);
+  EXPECT_EQ(
+      Stroke::LevelOfDetailForScale(std::numeric_limits<float>::infinity()),
+      0);
+}
+
+TEST(StrokeTest, LevelOfDetailForScaleWithProfile) {
+  PerformanceProfile profile;
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.5, profile), 1);
+
+  profile.level_of_detail_bias = 1;
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(1, profile), 1);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.5, profile), 2);
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.001, profile),
+            Stroke::kMaxLevelOfDetail);
+
+  profile.level_of_detail_bias = std::numeric_limits<uint32_t>::max();
+  EXPECT_EQ(Stroke::LevelOfDetailForScale(0.5, profile),
+            Stroke::kMaxLevelOfDetail);
+}
+
+TEST(StrokeDeathTest, GetShapeAtLevelOfDetailAboveMax) {
+  Stroke stroke(CreateBrush(), CreateFilledInputs());
+  EXPECT_DEATH_IF_SUPPORTED(
+      stroke.GetShapeAtLevelOfDetail(Stroke::kMaxLevelOfDetail + 1), "");
+}
+
 TEST(StrokeDeathTest, ConstructFromMismatchedShapeAndBrush) {
   BrushCoat coat = BrushCoat{.tip = BrushTip()};
   absl::StatusOr<BrushFamily> family = BrushFamily::Create({coat, coat});
@@ -606,5 +1109,57 @@ void CanConstructStrokeFromAnyInputBatch(const Brush& brush,
 FUZZ_TEST(DISABLED_StrokeTest, CanConstructStrokeFromAnyInputBatch)
     .WithDomains(ValidBrush(), ArbitraryStrokeInputBatch());
 
+size_t MemoryFootprintBytes(const Stroke& stroke) {
+  MemoryFootprint footprint;
+  stroke.AddToMemoryFootprint(footprint);
+  return footprint.TotalBytes();
+}
+
+TEST(StrokeTest, MemoryFootprintIncludesInputsAndShape) {
+  Stroke stroke(CreateBrush(), CreateFilledInputs());
+  MemoryFootprint inputs_and_shape;
+  stroke.GetInputs().AddToMemoryFootprint(inputs_and_shape);
+  stroke.GetShape().AddToMemoryFootprint(inputs_and_shape);
+  EXPECT_GT(inputs_and_shape.TotalBytes(), 0u);
+  EXPECT_GT(MemoryFootprintBytes(stroke), inputs_and_shape.TotalBytes());
+}
+
+TEST(StrokeTest, MemoryFootprintCountsSharedDataOnce) {
+  Stroke stroke(CreateBrush(), CreateFilledInputs());
+  Stroke copy = stroke;
+  EXPECT_EQ(MemoryFootprintBytes(copy), MemoryFootprintBytes(stroke));
+
+  // The copy shares the inputs and shape of the original, so it only adds its
+  // own brush family.
+  MemoryFootprint brush_family;
+  copy.GetBrush().GetFamily().AddToMemoryFootprint(brush_family);
+  MemoryFootprint both;
+  stroke.AddToMemoryFootprint(both);
+  copy.AddToMemoryFootprint(both);
+  EXPECT_EQ(both.TotalBytes(),
+            MemoryFootprintBytes(stroke) + brush_family.TotalBytes());
+
+  // Once the copy has inputs of its own, they are counted separately.
+  copy.SetInputs(CreateFilledInputs());
+  MemoryFootprint after_set_inputs;
+  stroke.AddToMemoryFootprint(after_set_inputs);
+  copy.AddToMemoryFootprint(after_set_inputs);
+  EXPECT_GT(after_set_inputs.TotalBytes(), both.TotalBytes());
+}
+
+TEST(StrokeTest, MemoryFootprintGrowsWithGeneratedLevelsOfDetail) {
+  Stroke stroke(CreateBrush(), CreateFilledInputs());
+  size_t bytes_before = MemoryFootprintBytes(stroke);
+  stroke.GetShapeAtLevelOfDetail(1);
+  EXPECT_GT(MemoryFootprintBytes(stroke), bytes_before);
+}
+
+TEST(StrokeTest, MemoryFootprintOfLazyShapeGrowsOnceGenerated) {
+  Stroke stroke = Stroke::WithLazyShape(CreateBrush(), CreateFilledInputs());
+  size_t bytes_before = MemoryFootprintBytes(stroke);
+  stroke.PrefetchShape();
+  EXPECT_GT(MemoryFootprintBytes(stroke), bytes_before);
+}
+
 }  // namespace
 }  // namespace ink
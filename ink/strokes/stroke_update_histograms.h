@@ -0,0 +1,62 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_STROKES_STROKE_UPDATE_HISTOGRAMS_H_
+#define INK_STROKES_STROKE_UPDATE_HISTOGRAMS_H_
+
+#include "ink/types/histogram.h"
+
+namespace ink {
+
+// Distributions of the cost and latency of successful calls to
+// `InProgressStroke::UpdateShape()`, collected across many updates, and
+// possibly across many strokes, for telemetry.
+//
+// Unlike `StrokeShapeStats`, these are always available, but are only
+// collected by an `InProgressStroke` that has been given them with
+// `SetUpdateHistograms()`. One object may be shared by several
+// `InProgressStroke`s, including ones updated on different threads.
+struct StrokeUpdateHistograms {
+  // Wall-clock duration of each update, in nanoseconds.
+  Histogram update_shape_nanos;
+  // Number of real inputs processed by each update.
+  Histogram inputs_per_update;
+  // Number of modeled inputs (re)generated by each update, including the
+  // modeled inputs for predicted inputs.
+  Histogram modeled_inputs_per_update;
+  // For each update that processed real inputs, the time from the last of
+  // those inputs to the end of the update, in nanoseconds: the difference
+  // between the `current_elapsed_time` passed to `UpdateShape()` and the
+  // input's `elapsed_time`, plus the update's duration. This assumes that
+  // `current_elapsed_time` is measured on the same clock as the inputs, just
+  // before the update.
+  Histogram input_latency_nanos;
+
+  // Forgets all recorded values.
+  void Reset();
+};
+
+// ---------------------------------------------------------------------------
+//                     Implementation details below
+
+inline void StrokeUpdateHistograms::Reset() {
+  update_shape_nanos.Reset();
+  inputs_per_update.Reset();
+  modeled_inputs_per_update.Reset();
+  input_latency_nanos.Reset();
+}
+
+}  // namespace ink
+
+#endif  // INK_STROKES_STROKE_UPDATE_HISTOGRAMS_H_
@@ -0,0 +1,98 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/types/allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include "absl/base/nullability.h"
+#include "absl/log/absl_check.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ink {
+namespace {
+
+class NewDeleteAllocator : public Allocator {
+ public:
+  void* absl_nonnull Allocate(size_t bytes, size_t alignment) override {
+    return ::operator new(bytes, std::align_val_t(alignment));
+  }
+  void Deallocate(void* absl_nonnull ptr, size_t bytes,
+                  size_t alignment) override {
+    ::operator delete(ptr, bytes, std::align_val_t(alignment));
+  }
+};
+
+// Returns the number of bytes to skip from `ptr` to reach an address that is a
+// multiple of `alignment`.
+size_t PaddingToAlign(const std::byte* ptr, size_t alignment) {
+  return -reinterpret_cast<uintptr_t>(ptr) & (alignment - 1);
+}
+
+}  // namespace
+
+Allocator& DefaultAllocator() {
+  static Allocator* const kAllocator = new NewDeleteAllocator();
+  return *kAllocator;
+}
+
+ArenaAllocator::ArenaAllocator(size_t block_size) : block_size_(block_size) {
+  ABSL_CHECK_GT(block_size, 0u);
+}
+
+void* absl_nonnull ArenaAllocator::Allocate(size_t bytes, size_t alignment) {
+  ABSL_DCHECK_NE(alignment, 0u);
+  ABSL_DCHECK_EQ(alignment & (alignment - 1), 0u);
+  absl::MutexLock lock(&mutex_);
+  if (next_ != nullptr) {
+    size_t padding = PaddingToAlign(next_, alignment);
+    if (padding + bytes <= remaining_) {
+      std::byte* result = next_ + padding;
+      next_ = result + bytes;
+      remaining_ -= padding + bytes;
+      return result;
+    }
+  }
+  // The worst-case padding is `alignment - 1` bytes.
+  size_t worst_case_bytes = bytes + alignment - 1;
+  if (worst_case_bytes > block_size_) {
+    // Give this allocation a block of its own, so that the remainder of the
+    // current block can still be used by later allocations.
+    std::byte* block = NewBlock(worst_case_bytes);
+    return block + PaddingToAlign(block, alignment);
+  }
+  std::byte* block = NewBlock(block_size_);
+  std::byte* result = block + PaddingToAlign(block, alignment);
+  next_ = result + bytes;
+  remaining_ = block + block_size_ - next_;
+  return result;
+}
+
+size_t ArenaAllocator::ReservedBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return reserved_bytes_;
+}
+
+std::byte* absl_nonnull ArenaAllocator::NewBlock(size_t bytes) {
+  // Deliberately not value-initialized, since callers overwrite the memory.
+  blocks_.push_back(std::unique_ptr<std::byte[]>(new std::byte[bytes]));
+  reserved_bytes_ += bytes;
+  return blocks_.back().get();
+}
+
+}  // namespace ink
@@ -0,0 +1,104 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_TYPES_ALLOCATOR_H_
+#define INK_TYPES_ALLOCATOR_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ink {
+
+// An interface for allocating the memory that backs Ink's immutable geometry,
+// such as the vertex and index data of a `Mesh`.
+//
+// Operations that create such objects accept an optional `Allocator`, which
+// lets the host application control where that memory lives; e.g. all of the
+// meshes in a document can be placed in an `ArenaAllocator` that is freed in
+// bulk when the document is closed, or a renderer can have mesh data written
+// straight into memory that it uploads to the GPU. Passing null uses
+// `DefaultAllocator()`.
+//
+// The allocator must outlive every object whose memory it provided. Since
+// objects like `Mesh` may be created concurrently (see `Executor`),
+// implementations must be thread-safe.
+class Allocator {
+ public:
+  virtual ~Allocator() = default;
+
+  // Returns a non-null pointer to at least `bytes` bytes of memory, aligned to
+  // `alignment`, which is a power of two.
+  virtual void* absl_nonnull Allocate(size_t bytes, size_t alignment) = 0;
+
+  // Releases memory returned by `Allocate()`; `bytes` and `alignment` are the
+  // values that were passed to that call.
+  virtual void Deallocate(void* absl_nonnull ptr, size_t bytes,
+                          size_t alignment) = 0;
+};
+
+// Returns the allocator that is used when none is given, which allocates with
+// the global `operator new` and `operator delete`.
+Allocator& DefaultAllocator();
+
+// An `Allocator` that carves allocations out of large blocks of memory, which
+// are only freed when the `ArenaAllocator` is destroyed; `Deallocate()` does
+// nothing. This makes allocation very cheap, and lets many objects with the
+// same lifetime be freed at once, at the cost of not reusing the memory of
+// objects that are destroyed early.
+//
+// This class is thread-safe.
+class ArenaAllocator : public Allocator {
+ public:
+  // Constructs an arena that reserves memory in blocks of `block_size` bytes.
+  // Allocations that don't fit in a block get a block of their own.
+  explicit ArenaAllocator(size_t block_size = kDefaultBlockSize);
+
+  ArenaAllocator(const ArenaAllocator&) = delete;
+  ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+  ~ArenaAllocator() override = default;
+
+  void* absl_nonnull Allocate(size_t bytes, size_t alignment) override;
+  void Deallocate(void* absl_nonnull ptr, size_t bytes,
+                  size_t alignment) override {}
+
+  // Returns the total number of bytes in the blocks that this arena has
+  // reserved so far.
+  size_t ReservedBytes() const;
+
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+ private:
+  // Returns a new block of `bytes` bytes, which is owned by the arena.
+  std::byte* absl_nonnull NewBlock(size_t bytes)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const size_t block_size_;
+  mutable absl::Mutex mutex_;
+  std::vector<std::unique_ptr<std::byte[]>> blocks_ ABSL_GUARDED_BY(mutex_);
+  size_t reserved_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The unused remainder of the most recent regular-sized block.
+  std::byte* absl_nullable next_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  size_t remaining_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace ink
+
+#endif  // INK_TYPES_ALLOCATOR_H_
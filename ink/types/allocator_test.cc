@@ -0,0 +1,123 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/types/allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace ink {
+namespace {
+
+bool IsAligned(const void* ptr, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+TEST(AllocatorTest, DefaultAllocatorReturnsAlignedMemory) {
+  Allocator& allocator = DefaultAllocator();
+  for (size_t alignment : {1, 4, 16, 64}) {
+    void* ptr = allocator.Allocate(100, alignment);
+    EXPECT_TRUE(IsAligned(ptr, alignment)) << alignment;
+    std::memset(ptr, 0xab, 100);
+    allocator.Deallocate(ptr, 100, alignment);
+  }
+}
+
+TEST(AllocatorTest, DefaultAllocatorIsASingleton) {
+  EXPECT_EQ(&DefaultAllocator(), &DefaultAllocator());
+}
+
+TEST(ArenaAllocatorTest, StartsEmpty) {
+  ArenaAllocator arena;
+  EXPECT_EQ(arena.ReservedBytes(), 0u);
+}
+
+TEST(ArenaAllocatorTest, SmallAllocationsShareABlock) {
+  ArenaAllocator arena(1024);
+  void* a = arena.Allocate(100, 8);
+  void* b = arena.Allocate(100, 8);
+  EXPECT_NE(a, b);
+  EXPECT_EQ(arena.ReservedBytes(), 1024u);
+}
+
+TEST(ArenaAllocatorTest, AllocationsAreAlignedAndDisjoint) {
+  ArenaAllocator arena(256);
+  std::vector<std::byte*> allocations;
+  for (int i = 0; i < 100; ++i) {
+    size_t alignment = size_t{1} << (i % 7);
+    auto* ptr = static_cast<std::byte*>(arena.Allocate(i % 13 + 1, alignment));
+    EXPECT_TRUE(IsAligned(ptr, alignment)) << i;
+    std::memset(ptr, i, i % 13 + 1);
+    allocations.push_back(ptr);
+  }
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < i % 13 + 1; ++j) {
+      EXPECT_EQ(static_cast<int>(allocations[i][j]), i) << i;
+    }
+  }
+}
+
+TEST(ArenaAllocatorTest, StartsNewBlockWhenFull) {
+  ArenaAllocator arena(128);
+  arena.Allocate(100, 1);
+  arena.Allocate(100, 1);
+  EXPECT_EQ(arena.ReservedBytes(), 256u);
+}
+
+TEST(ArenaAllocatorTest, LargeAllocationGetsItsOwnBlock) {
+  ArenaAllocator arena(128);
+  auto* small = static_cast<std::byte*>(arena.Allocate(16, 1));
+  arena.Allocate(1000, 1);
+  EXPECT_EQ(arena.ReservedBytes(), 128u + 1000u);
+  // The remainder of the first block is still used for small allocations.
+  EXPECT_EQ(static_cast<std::byte*>(arena.Allocate(16, 1)), small + 16);
+  EXPECT_EQ(arena.ReservedBytes(), 128u + 1000u);
+}
+
+TEST(ArenaAllocatorTest, DeallocateDoesNotReuseMemory) {
+  ArenaAllocator arena;
+  void* a = arena.Allocate(16, 8);
+  arena.Deallocate(a, 16, 8);
+  EXPECT_NE(arena.Allocate(16, 8), a);
+}
+
+TEST(ArenaAllocatorTest, ConcurrentAllocationsAreDisjoint) {
+  ArenaAllocator arena(1024);
+  constexpr int kThreads = 4;
+  constexpr int kAllocationsPerThread = 1000;
+  std::vector<std::vector<int*>> allocations(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&arena, &allocations, t] {
+      for (int i = 0; i < kAllocationsPerThread; ++i) {
+        int* ptr = static_cast<int*>(arena.Allocate(sizeof(int), alignof(int)));
+        *ptr = t;
+        allocations[t].push_back(ptr);
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int t = 0; t < kThreads; ++t) {
+    for (int* ptr : allocations[t]) EXPECT_EQ(*ptr, t);
+  }
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,54 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_TYPES_CANCELLATION_TOKEN_H_
+#define INK_TYPES_CANCELLATION_TOKEN_H_
+
+#include <atomic>
+#include <memory>
+
+namespace ink {
+
+// A flag with which the host application can ask background work to stop
+// early, e.g. because its result has been superseded by a newer request.
+//
+// Copies of a token share the same flag, so the application keeps one copy and
+// passes another along with the work. Cancellation cannot be undone; use a new
+// token for the next request. Work checks the flag only at coarse points, so
+// it may still run for a short while after `Cancel()` is called.
+//
+// All methods are safe to call concurrently.
+class CancellationToken {
+ public:
+  CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>()) {}
+  CancellationToken(const CancellationToken&) = default;
+  CancellationToken& operator=(const CancellationToken&) = default;
+  ~CancellationToken() = default;
+
+  // Requests cancellation of the work that was given a copy of this token.
+  void Cancel() const { cancelled_->store(true, std::memory_order_relaxed); }
+
+  // Returns true if `Cancel()` has been called on any copy of this token.
+  bool IsCancelled() const {
+    return cancelled_->load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Never null. Not moved from, so that a moved-from token stays usable.
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+}  // namespace ink
+
+#endif  // INK_TYPES_CANCELLATION_TOKEN_H_
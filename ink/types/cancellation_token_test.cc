@@ -0,0 +1,60 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/types/cancellation_token.h"
+
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace ink {
+namespace {
+
+TEST(CancellationTokenTest, NotCancelledByDefault) {
+  CancellationToken token;
+  EXPECT_FALSE(token.IsCancelled());
+}
+
+TEST(CancellationTokenTest, CopiesShareCancellation) {
+  CancellationToken token;
+  CancellationToken copy = token;
+  CancellationToken other;
+  copy.Cancel();
+  EXPECT_TRUE(token.IsCancelled());
+  EXPECT_TRUE(copy.IsCancelled());
+  EXPECT_FALSE(other.IsCancelled());
+
+  // Cancelling again has no further effect.
+  token.Cancel();
+  EXPECT_TRUE(copy.IsCancelled());
+}
+
+TEST(CancellationTokenTest, MovedFromTokenStaysUsable) {
+  CancellationToken token;
+  CancellationToken moved = std::move(token);
+  token.Cancel();  // NOLINT(bugprone-use-after-move)
+  EXPECT_TRUE(token.IsCancelled());  // NOLINT(bugprone-use-after-move)
+  EXPECT_TRUE(moved.IsCancelled());
+}
+
+TEST(CancellationTokenTest, CancelFromAnotherThread) {
+  CancellationToken token;
+  std::thread thread([token]() { token.Cancel(); });
+  thread.join();
+  EXPECT_TRUE(token.IsCancelled());
+}
+
+}  // namespace
+}  // namespace ink
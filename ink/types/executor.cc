@@ -0,0 +1,84 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/types/executor.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ink {
+namespace {
+
+std::atomic<Executor*> process_executor = nullptr;
+
+}  // namespace
+
+void SetProcessExecutor(Executor* absl_nullable executor) {
+  process_executor.store(executor, std::memory_order_release);
+}
+
+Executor* absl_nullable GetProcessExecutor() {
+  return process_executor.load(std::memory_order_acquire);
+}
+
+void TaskGroup::Run(absl::AnyInvocable<void() &&> task) {
+  {
+    absl::MutexLock lock(&state_->mutex);
+    state_->pending_tasks.push_back(std::move(task));
+  }
+  if (executor_ == nullptr) return;
+  // The scheduled task doesn't necessarily run this particular task, just
+  // whichever one is pending when it gets to run, if any.
+  executor_->Schedule([state = state_]() { RunOnePendingTask(*state); });
+}
+
+void TaskGroup::Wait() {
+  State& state = *state_;
+  auto has_pending_or_done = [&state]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+                                 state.mutex) {
+    return !state.pending_tasks.empty() || state.running_count == 0;
+  };
+  while (true) {
+    while (RunOnePendingTask(state)) {
+    }
+    absl::MutexLock lock(&state.mutex);
+    // Tasks that are still running elsewhere may add more tasks, which are then
+    // run here too.
+    state.mutex.Await(absl::Condition(&has_pending_or_done));
+    if (state.pending_tasks.empty()) return;
+  }
+}
+
+bool TaskGroup::RunOnePendingTask(State& state) {
+  absl::AnyInvocable<void() &&> task;
+  {
+    absl::MutexLock lock(&state.mutex);
+    if (state.pending_tasks.empty()) return false;
+    task = std::move(state.pending_tasks.front());
+    state.pending_tasks.pop_front();
+    ++state.running_count;
+  }
+  std::move(task)();
+  absl::MutexLock lock(&state.mutex);
+  --state.running_count;
+  return true;
+}
+
+}  // namespace ink
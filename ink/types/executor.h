@@ -0,0 +1,149 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_TYPES_EXECUTOR_H_
+#define INK_TYPES_EXECUTOR_H_
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ink {
+
+// An interface for running independent units of work, possibly concurrently.
+//
+// Ink does not create any threads of its own. Instead, operations that can be
+// parallelized accept an `Executor`, which the host application implements on
+// top of whatever thread pool or task system it already uses.
+class Executor {
+ public:
+  virtual ~Executor() = default;
+
+  // Calls `task(i)` once for each `i` in the range [0, `count`), and returns
+  // once every one of those calls has returned.
+  //
+  // The calls may happen concurrently and in any order, and implementations
+  // are free to run some or all of them on the calling thread. The `task` must
+  // therefore be safe to call concurrently with distinct indices, and must not
+  // block waiting on another call to `task`.
+  virtual void ParallelFor(size_t count,
+                           absl::FunctionRef<void(size_t)> task) = 0;
+
+  // Runs `task` once, possibly asynchronously; this may return before `task`
+  // has run. This is used for background work whose result is not needed right
+  // away, such as building caches.
+  //
+  // The default implementation runs `task` on the calling thread before
+  // returning, so executors that only support `ParallelFor()` still work, just
+  // without the benefit of running the work in the background.
+  virtual void Schedule(absl::AnyInvocable<void() &&> task) {
+    std::move(task)();
+  }
+};
+
+// Calls `executor->ParallelFor(count, task)`, or calls `task(i)` in order on
+// the calling thread for each `i` in [0, `count`) if `executor` is null.
+//
+// Work is also run on the calling thread when there is at most one task, since
+// there is nothing to parallelize.
+inline void ParallelFor(Executor* absl_nullable executor, size_t count,
+                        absl::FunctionRef<void(size_t)> task) {
+  if (executor == nullptr || count <= 1) {
+    for (size_t i = 0; i < count; ++i) task(i);
+    return;
+  }
+  executor->ParallelFor(count, task);
+}
+
+// Installs `executor` as the process-wide executor, or uninstalls it if
+// `executor` is null. The executor must outlive every use of it, which in
+// practice means it should live until the process exits.
+//
+// Ink's APIs never fall back to this on their own; a null `Executor*` argument
+// always means "run on the calling thread". Instead, this lets a host install
+// its thread pool once (e.g. from `JNI_OnLoad()`), and have code that doesn't
+// otherwise have an executor at hand, such as the JNI bindings, pick it up via
+// `GetProcessExecutor()`.
+void SetProcessExecutor(Executor* absl_nullable executor);
+
+// Returns the executor installed by `SetProcessExecutor()`, or null if there is
+// none.
+Executor* absl_nullable GetProcessExecutor();
+
+// A set of tasks that can be waited on together, built on top of
+// `Executor::Schedule()`.
+//
+// Each task passed to `Run()` is claimed by whichever comes first: a task
+// scheduled on the executor, or the thread calling `Wait()`. So `Wait()` helps
+// with the group's own work instead of blocking on it, which makes it safe to
+// call from a task running on the same executor, and means that the group still
+// completes if the executor runs scheduled tasks late or not at all.
+//
+// For example:
+//
+//   TaskGroup group(executor);
+//   for (Coat& coat : coats) {
+//     group.Run([&coat]() { BuildMesh(coat); });
+//   }
+//   group.Wait();
+//
+// `Run()` and `Wait()` may be called from any thread, including from within a
+// task of the group.
+class TaskGroup {
+ public:
+  // If `executor` is null, every task is run by `Wait()` on the calling thread.
+  explicit TaskGroup(Executor* absl_nullable executor) : executor_(executor) {}
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // Waits for every task of the group; see `Wait()`.
+  ~TaskGroup() { Wait(); }
+
+  // Adds `task` to the group.
+  void Run(absl::AnyInvocable<void() &&> task);
+
+  // Runs unclaimed tasks of the group on the calling thread, then blocks until
+  // every task of the group that was claimed elsewhere has returned. Tasks that
+  // are added by other tasks while this is waiting are waited for too.
+  void Wait();
+
+ private:
+  // The state is shared with the tasks scheduled on the executor, which may
+  // run after the group is destroyed if `Wait()` claimed their work first.
+  struct State {
+    absl::Mutex mutex;
+    std::deque<absl::AnyInvocable<void() &&>> pending_tasks
+        ABSL_GUARDED_BY(mutex);
+    size_t running_count ABSL_GUARDED_BY(mutex) = 0;
+  };
+
+  // Claims and runs one pending task of `state`, if there is one. Returns
+  // whether a task was run.
+  static bool RunOnePendingTask(State& state);
+
+  Executor* absl_nullable executor_;
+  std::shared_ptr<State> state_ = std::make_shared<State>();
+};
+
+}  // namespace ink
+
+#endif  // INK_TYPES_EXECUTOR_H_
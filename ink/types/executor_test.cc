@@ -0,0 +1,157 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/types/executor.h"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/functional/function_ref.h"
+#include "ink/types/test_executor.h"
+
+namespace ink {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(ExecutorTest, NullExecutorRunsTasksInOrder) {
+  std::vector<size_t> indices;
+  ParallelFor(nullptr, 4, [&indices](size_t i) { indices.push_back(i); });
+  EXPECT_THAT(indices, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(ExecutorTest, ZeroTasksDoesNothing) {
+  ThreadPerTaskExecutor executor;
+  int calls = 0;
+  ParallelFor(&executor, 0, [&calls](size_t) { ++calls; });
+  EXPECT_EQ(calls, 0);
+  EXPECT_EQ(executor.ParallelForCalls(), 0);
+}
+
+TEST(ExecutorTest, SingleTaskRunsOnCallingThread) {
+  ThreadPerTaskExecutor executor;
+  std::thread::id task_thread;
+  ParallelFor(&executor, 1, [&task_thread](size_t) {
+    task_thread = std::this_thread::get_id();
+  });
+  EXPECT_EQ(task_thread, std::this_thread::get_id());
+  EXPECT_EQ(executor.ParallelForCalls(), 0);
+}
+
+TEST(ExecutorTest, MultipleTasksUseExecutor) {
+  ThreadPerTaskExecutor executor;
+  std::vector<int> calls_per_index(8, 0);
+  ParallelFor(&executor, calls_per_index.size(),
+              [&calls_per_index](size_t i) { ++calls_per_index[i]; });
+  EXPECT_THAT(calls_per_index, Each(1));
+  EXPECT_EQ(executor.ParallelForCalls(), 1);
+}
+
+TEST(ExecutorTest, DefaultScheduleRunsTaskBeforeReturning) {
+  class ParallelForOnlyExecutor : public Executor {
+   public:
+    void ParallelFor(size_t count,
+                     absl::FunctionRef<void(size_t)> task) override {
+      for (size_t i = 0; i < count; ++i) task(i);
+    }
+  };
+  ParallelForOnlyExecutor executor;
+  int calls = 0;
+  executor.Schedule([&calls]() { ++calls; });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ExecutorTest, ManualExecutorDefersScheduledTasks) {
+  ManualExecutor executor;
+  std::vector<int> order;
+  executor.Schedule([&order]() { order.push_back(0); });
+  executor.Schedule([&order]() { order.push_back(1); });
+  EXPECT_THAT(order, IsEmpty());
+  EXPECT_EQ(executor.PendingTaskCount(), 2);
+
+  executor.RunScheduledTasks();
+  EXPECT_THAT(order, ElementsAre(0, 1));
+  EXPECT_EQ(executor.PendingTaskCount(), 0);
+}
+
+TEST(ExecutorTest, ProcessExecutorIsNullUntilSet) {
+  EXPECT_EQ(GetProcessExecutor(), nullptr);
+  ManualExecutor executor;
+  SetProcessExecutor(&executor);
+  EXPECT_EQ(GetProcessExecutor(), &executor);
+  SetProcessExecutor(nullptr);
+  EXPECT_EQ(GetProcessExecutor(), nullptr);
+}
+
+TEST(TaskGroupTest, NullExecutorRunsTasksOnWait) {
+  std::vector<int> order;
+  TaskGroup group(nullptr);
+  group.Run([&order]() { order.push_back(0); });
+  group.Run([&order]() { order.push_back(1); });
+  EXPECT_THAT(order, IsEmpty());
+  group.Wait();
+  EXPECT_THAT(order, ElementsAre(0, 1));
+}
+
+TEST(TaskGroupTest, WaitRunsTasksThatTheExecutorHasNotRun) {
+  ManualExecutor executor;
+  int calls = 0;
+  {
+    TaskGroup group(&executor);
+    group.Run([&calls]() { ++calls; });
+    group.Run([&calls]() { ++calls; });
+    EXPECT_EQ(executor.PendingTaskCount(), 2);
+    group.Wait();
+    EXPECT_EQ(calls, 2);
+  }
+  // The tasks scheduled on the executor find nothing left to do, even though
+  // the group is gone.
+  executor.RunScheduledTasks();
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(TaskGroupTest, WaitsForTasksAddedByOtherTasks) {
+  ThreadPerTaskExecutor executor;
+  std::atomic<int> calls = 0;
+  TaskGroup group(&executor);
+  for (int i = 0; i < 10; ++i) {
+    group.Run([&calls, &group]() {
+      ++calls;
+      group.Run([&calls]() { ++calls; });
+    });
+  }
+  group.Wait();
+  EXPECT_EQ(calls.load(), 20);
+}
+
+TEST(TaskGroupTest, DestructorWaits) {
+  ThreadPerTaskExecutor executor;
+  std::atomic<int> calls = 0;
+  {
+    TaskGroup group(&executor);
+    for (int i = 0; i < 10; ++i) {
+      group.Run([&calls]() { ++calls; });
+    }
+  }
+  EXPECT_EQ(calls.load(), 10);
+}
+
+}  // namespace
+}  // namespace ink
@@ -30,6 +30,11 @@ fuzztest::Domain<Duration32> FiniteNonNegativeDuration32() {
       fuzztest::Map(&Duration32::Seconds, fuzztest::NonNegative<float>()));
 }
 
+fuzztest::Domain<Duration32> Duration32InRange(Duration32 min, Duration32 max) {
+  return fuzztest::Map(&Duration32::Seconds,
+                       fuzztest::InRange(min.ToSeconds(), max.ToSeconds()));
+}
+
 fuzztest::Domain<PhysicalDistance> ArbitraryPhysicalDistance() {
   return fuzztest::Map(&PhysicalDistance::Centimeters,
                        fuzztest::Arbitrary<float>());
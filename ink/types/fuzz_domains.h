@@ -27,6 +27,8 @@ namespace ink {
 fuzztest::Domain<Duration32> ArbitraryDuration32();
 // The domain of all durations that are finite and non-negative.
 fuzztest::Domain<Duration32> FiniteNonNegativeDuration32();
+// The domain of all durations between `min` and `max`, inclusive.
+fuzztest::Domain<Duration32> Duration32InRange(Duration32 min, Duration32 max);
 
 // The domain of all physical distances, including NaN and negative and/or
 // infinite distances.
@@ -0,0 +1,93 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/types/histogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace ink {
+namespace {
+
+// Bucket `i < 4` holds just the value `i`. Above that, a value with its highest
+// set bit at position `e >= 2` falls into one of the four buckets for that
+// power of two, chosen by the next two bits.
+int BucketIndex(uint64_t value) {
+  if (value < 4) return static_cast<int>(value);
+  int e = std::bit_width(value) - 1;
+  return 4 * (e - 1) + static_cast<int>((value >> (e - 2)) & 3);
+}
+
+uint64_t BucketLowerBound(int index) {
+  if (index < 4) return index;
+  return uint64_t{4 + static_cast<uint64_t>(index % 4)} << (index / 4 - 1);
+}
+
+uint64_t BucketWidth(int index) {
+  if (index < 4) return 1;
+  return uint64_t{1} << (index / 4 - 1);
+}
+
+}  // namespace
+
+void Histogram::Record(int64_t value) {
+  value = std::max<int64_t>(value, 0);
+  buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  int64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max &&
+         !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+void Histogram::Reset() {
+  for (std::atomic<uint32_t>& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+int64_t Histogram::Percentile(float fraction) const {
+  // Count from the buckets themselves, rather than using `count_`, so that the
+  // rank is consistent with the buckets even if `Record()` is racing.
+  uint64_t total = 0;
+  for (const std::atomic<uint32_t>& bucket : buckets_) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  if (total == 0) return 0;
+
+  fraction = std::clamp(fraction, 0.f, 1.f);
+  uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(static_cast<double>(fraction) *
+                                         static_cast<double>(total))));
+  uint64_t seen = 0;
+  int index = 0;
+  for (; index < kBucketCount - 1; ++index) {
+    seen += buckets_[index].load(std::memory_order_relaxed);
+    if (seen >= rank) break;
+  }
+  // Report the middle of the bucket, but never more than the largest value
+  // actually recorded.
+  int64_t value = static_cast<int64_t>(BucketLowerBound(index) +
+                                       (BucketWidth(index) - 1) / 2);
+  return std::min(value, Max());
+}
+
+}  // namespace ink
@@ -0,0 +1,76 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_TYPES_HISTOGRAM_H_
+#define INK_TYPES_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace ink {
+
+// A fixed-memory histogram of non-negative integer values, such as durations
+// in nanoseconds or counts of inputs, from which approximate percentiles can be
+// read.
+//
+// Values are counted in log-linear buckets: each power of two is split into
+// four buckets of equal width, and the values 0 through 3 each get their own
+// bucket. So a percentile is exact for values below 8, and otherwise within
+// 12.5% of the recorded value. The buckets cover every `int64_t`, so no values
+// are dropped; negative values are recorded as zero.
+//
+// All methods are thread-safe and lock-free, so that values can be recorded on
+// a rendering thread while another thread reads or resets the histogram.
+// Reads that race with `Record()` or `Reset()` may see some of the values
+// recorded or reset by those calls but not others.
+class Histogram {
+ public:
+  static constexpr int kBucketCount = 248;
+
+  Histogram() = default;
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+  ~Histogram() = default;
+
+  void Record(int64_t value);
+
+  // Forgets all recorded values.
+  void Reset();
+
+  // Returns the number of recorded values.
+  int64_t Count() const { return count_.load(std::memory_order_relaxed); }
+
+  // Returns the sum of the recorded values.
+  int64_t Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+  // Returns the largest recorded value, or zero if there are none.
+  int64_t Max() const { return max_.load(std::memory_order_relaxed); }
+
+  // Returns an approximation of the smallest recorded value that is at least as
+  // large as the given `fraction` of the recorded values, e.g. the median for
+  // 0.5. `fraction` is clamped to [0, 1]. Returns zero if no values have been
+  // recorded.
+  int64_t Percentile(float fraction) const;
+
+ private:
+  std::array<std::atomic<uint32_t>, kBucketCount> buckets_ = {};
+  std::atomic<int64_t> count_ = 0;
+  std::atomic<int64_t> sum_ = 0;
+  std::atomic<int64_t> max_ = 0;
+};
+
+}  // namespace ink
+
+#endif  // INK_TYPES_HISTOGRAM_H_
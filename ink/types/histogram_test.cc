@@ -0,0 +1,116 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/types/histogram.h"
+
+#include <cstdint>
+#include <limits>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace ink {
+namespace {
+
+TEST(HistogramTest, EmptyHistogramReportsZero) {
+  Histogram histogram;
+  EXPECT_EQ(histogram.Count(), 0);
+  EXPECT_EQ(histogram.Sum(), 0);
+  EXPECT_EQ(histogram.Max(), 0);
+  EXPECT_EQ(histogram.Percentile(0.5), 0);
+}
+
+TEST(HistogramTest, SmallValuesAreExact) {
+  Histogram histogram;
+  for (int64_t value = 0; value < 8; ++value) histogram.Record(value);
+
+  EXPECT_EQ(histogram.Count(), 8);
+  EXPECT_EQ(histogram.Sum(), 28);
+  EXPECT_EQ(histogram.Max(), 7);
+  EXPECT_EQ(histogram.Percentile(0), 0);
+  EXPECT_EQ(histogram.Percentile(0.25), 1);
+  EXPECT_EQ(histogram.Percentile(0.5), 3);
+  EXPECT_EQ(histogram.Percentile(0.51), 4);
+  EXPECT_EQ(histogram.Percentile(1), 7);
+}
+
+TEST(HistogramTest, LargeValuesAreApproximate) {
+  Histogram histogram;
+  for (int64_t value = 1; value <= 1000; ++value) {
+    histogram.Record(value * 1000);
+  }
+
+  EXPECT_EQ(histogram.Count(), 1000);
+  EXPECT_EQ(histogram.Max(), 1000000);
+  for (float fraction : {0.1f, 0.5f, 0.9f, 0.99f, 1.f}) {
+    EXPECT_NEAR(histogram.Percentile(fraction), fraction * 1000000,
+                0.125 * fraction * 1000000)
+        << "fraction = " << fraction;
+  }
+}
+
+TEST(HistogramTest, ClampsNegativeValuesAndFractions) {
+  Histogram histogram;
+  histogram.Record(-5);
+  histogram.Record(10);
+
+  EXPECT_EQ(histogram.Count(), 2);
+  EXPECT_EQ(histogram.Sum(), 10);
+  EXPECT_EQ(histogram.Percentile(-1), 0);
+  EXPECT_EQ(histogram.Percentile(2), 10);
+}
+
+TEST(HistogramTest, RecordsLargestValue) {
+  Histogram histogram;
+  histogram.Record(std::numeric_limits<int64_t>::max());
+  EXPECT_EQ(histogram.Max(), std::numeric_limits<int64_t>::max());
+  EXPECT_GT(histogram.Percentile(0.5),
+            std::numeric_limits<int64_t>::max() / 8 * 7);
+}
+
+TEST(HistogramTest, Reset) {
+  Histogram histogram;
+  histogram.Record(100);
+  histogram.Record(200);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.Count(), 0);
+  EXPECT_EQ(histogram.Sum(), 0);
+  EXPECT_EQ(histogram.Max(), 0);
+  EXPECT_EQ(histogram.Percentile(0.5), 0);
+
+  histogram.Record(3);
+  EXPECT_EQ(histogram.Percentile(0.5), 3);
+}
+
+TEST(HistogramTest, RecordsFromManyThreads) {
+  Histogram histogram;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&histogram, i]() {
+      for (int j = 0; j < 1000; ++j) histogram.Record(i);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(histogram.Count(), 4000);
+  EXPECT_EQ(histogram.Sum(), 6000);
+  EXPECT_EQ(histogram.Max(), 3);
+  EXPECT_EQ(histogram.Percentile(0.25), 0);
+  EXPECT_EQ(histogram.Percentile(0.75), 2);
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,95 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/types/internal/allocation_counter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark/benchmark.h"
+
+namespace {
+
+std::atomic<int64_t> allocation_count = 0;
+std::atomic<int64_t> allocated_bytes = 0;
+
+void CountAllocation(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+// The array and `std::nothrow_t` forms of these operators are implemented in
+// terms of the ones below by the standard library, and so are counted too.
+
+void* operator new(std::size_t size) {
+  CountAllocation(size);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  CountAllocation(size);
+  std::size_t align = static_cast<std::size_t>(alignment);
+  // `aligned_alloc` requires the size to be a multiple of the alignment.
+  std::size_t aligned_size = (size + align - 1) / align * align;
+  if (void* p = std::aligned_alloc(align, aligned_size == 0 ? align
+                                                            : aligned_size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+namespace ink_internal {
+
+AllocationStats GetAllocationStats() {
+  return {.allocations = allocation_count.load(std::memory_order_relaxed),
+          .bytes = allocated_bytes.load(std::memory_order_relaxed)};
+}
+
+ScopedAllocationCounters::ScopedAllocationCounters(benchmark::State& state)
+    : state_(state), before_(GetAllocationStats()) {}
+
+AllocationStats ScopedAllocationCounters::Allocations() const {
+  AllocationStats now = reported_ ? after_ : GetAllocationStats();
+  return {.allocations = now.allocations - before_.allocations,
+          .bytes = now.bytes - before_.bytes};
+}
+
+void ScopedAllocationCounters::Report() {
+  if (reported_) return;
+  after_ = GetAllocationStats();
+  reported_ = true;
+  AllocationStats allocations = Allocations();
+  state_.counters["allocs_per_iter"] = benchmark::Counter(
+      allocations.allocations, benchmark::Counter::kAvgIterations);
+  state_.counters["alloc_bytes_per_iter"] = benchmark::Counter(
+      allocations.bytes, benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace ink_internal
@@ -0,0 +1,79 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_TYPES_INTERNAL_ALLOCATION_COUNTER_H_
+#define INK_TYPES_INTERNAL_ALLOCATION_COUNTER_H_
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+
+namespace ink_internal {
+
+// Heap allocation instrumentation for benchmarks.
+//
+// Linking this library into a binary replaces the global `operator new` and
+// `operator delete` with versions that count every allocation made through
+// them, from any thread. Memory obtained directly from `malloc` (e.g. by C
+// libraries like libtess2) is not counted.
+
+// Totals of the allocations made through `operator new` since the process
+// started.
+struct AllocationStats {
+  int64_t allocations = 0;
+  int64_t bytes = 0;
+};
+
+AllocationStats GetAllocationStats();
+
+// Reports the heap allocations made during a benchmark loop as the counters:
+//   * `allocs_per_iter`: allocations per iteration.
+//   * `alloc_bytes_per_iter`: bytes requested per iteration.
+// Construct this after any setup, just before the benchmark loop; the counters
+// are set when it is destroyed, or when `Report()` is called, whichever comes
+// first. For example:
+//
+//   void BM_Foo(benchmark::State& state) {
+//     Foo foo = MakeFoo();
+//     ScopedAllocationCounters allocation_counters(state);
+//     for (auto s : state) {
+//       benchmark::DoNotOptimize(foo.Bar());
+//     }
+//   }
+class ScopedAllocationCounters {
+ public:
+  explicit ScopedAllocationCounters(benchmark::State& state);
+  ~ScopedAllocationCounters() { Report(); }
+
+  ScopedAllocationCounters(const ScopedAllocationCounters&) = delete;
+  ScopedAllocationCounters& operator=(const ScopedAllocationCounters&) =
+      delete;
+
+  // Returns the allocations made since construction, or until `Report()` was
+  // called.
+  AllocationStats Allocations() const;
+
+  // Sets the counters, and stops counting. Later calls have no effect.
+  void Report();
+
+ private:
+  benchmark::State& state_;
+  AllocationStats before_;
+  AllocationStats after_;
+  bool reported_ = false;
+};
+
+}  // namespace ink_internal
+
+#endif  // INK_TYPES_INTERNAL_ALLOCATION_COUNTER_H_
@@ -15,7 +15,8 @@
 #ifndef INK_TYPES_INTERNAL_COPY_ON_WRITE_H_
 #define INK_TYPES_INTERNAL_COPY_ON_WRITE_H_
 
-#include <memory>
+#include <atomic>
+#include <cstdint>
 #include <type_traits>
 #include <utility>
 
@@ -24,6 +25,18 @@
 
 namespace ink_internal {
 
+// Whether the managed object of a `CopyOnWrite` may be shared between threads.
+enum class CopyOnWriteSharing {
+  // Copies may be made, used, and destroyed on different threads, as with
+  // `std::shared_ptr`. The reference count is updated atomically.
+  kThreadSafe,
+  // All of the `CopyOnWrite` objects that share a managed object must only be
+  // used from one thread at a time, with external synchronization if they are
+  // ever handed to another thread. The reference count is a plain integer, so
+  // copying and destroying them never costs an atomic read-modify-write.
+  kThreadConfined,
+};
+
 // Container that manages an optional value of copy-constructible type `T` and
 // provides copy-on-write semantics.
 //
@@ -40,76 +53,145 @@ namespace ink_internal {
 // Similarly to `std::optional`, a mutable reference to a newly created value is
 // returned by `Emplace()`.
 //
-template <typename T>
+// Objects that never leave the thread that created them can use
+// `ThreadConfinedCopyOnWrite<T>` below to avoid atomic reference counting.
+template <typename T,
+          CopyOnWriteSharing kSharing = CopyOnWriteSharing::kThreadSafe>
 class CopyOnWrite {
  public:
   static_assert(std::is_copy_constructible_v<T>);
 
   // Constructs a `CopyOnWrite` holding the given `value`.
-  explicit CopyOnWrite(const T& value) : value_(std::make_shared<T>(value)) {}
-  explicit CopyOnWrite(T&& value)
-      : value_(std::make_shared<T>(std::move(value))) {}
+  explicit CopyOnWrite(const T& value) : block_(new Block(value)) {}
+  explicit CopyOnWrite(T&& value) : block_(new Block(std::move(value))) {}
 
   CopyOnWrite() = default;
-  CopyOnWrite(const CopyOnWrite&) = default;
-  CopyOnWrite(CopyOnWrite&&) = default;
-  CopyOnWrite& operator=(const CopyOnWrite&) = default;
-  CopyOnWrite& operator=(CopyOnWrite&&) = default;
-  ~CopyOnWrite() = default;
+  CopyOnWrite(const CopyOnWrite& other) : block_(other.block_) {
+    if (block_ != nullptr) block_->AddRef();
+  }
+  CopyOnWrite(CopyOnWrite&& other)
+      : block_(std::exchange(other.block_, nullptr)) {}
+  CopyOnWrite& operator=(const CopyOnWrite& other) {
+    Block* new_block = other.block_;
+    if (new_block != nullptr) new_block->AddRef();
+    Reset();
+    block_ = new_block;
+    return *this;
+  }
+  CopyOnWrite& operator=(CopyOnWrite&& other) {
+    if (this != &other) {
+      Reset();
+      block_ = std::exchange(other.block_, nullptr);
+    }
+    return *this;
+  }
+  ~CopyOnWrite() { Reset(); }
 
   // Allocates a new managed object that is direct-initialized with `args`, and
   // returns a mutable reference to the newly managed object.
   template <typename... Args>
   T& Emplace(Args&&... args) {
-    value_ = std::make_shared<T>(std::forward<Args>(args)...);
-    return *value_;
+    // The new object is constructed before releasing the old one, since `args`
+    // may refer to it.
+    Block* new_block = new Block(std::forward<Args>(args)...);
+    Reset();
+    block_ = new_block;
+    return block_->value;
   }
 
   // Resets the `CopyOnWrite` to the empty state. Any managed object is
   // destroyed if and only if it is not shared.
-  void Reset() { value_.reset(); }
+  void Reset() {
+    if (block_ != nullptr && block_->Release()) delete block_;
+    block_ = nullptr;
+  }
 
-  bool HasValue() const { return value_ != nullptr; }
+  bool HasValue() const { return block_ != nullptr; }
 
   // Returns true if the `CopyOnWrite` contains a value and the managed object
   // is shared with at least one other `CopyOnWrite` object.
-  bool IsShared() const { return value_.use_count() > 1; }
+  bool IsShared() const { return block_ != nullptr && block_->IsShared(); }
 
   // Returns a mutable reference to the managed object.
   //
   // Check-fails if `HasValue()` is `false`. If `IsShared()` is `true`, this
   // function first creates a new copy of the managed object.
   T& MutableValue() {
-    ABSL_CHECK_NE(value_, nullptr);
-    if (IsShared()) Emplace(*value_);
-    return *value_;
+    ABSL_CHECK_NE(block_, nullptr);
+    if (IsShared()) Emplace(block_->value);
+    return block_->value;
   }
 
   // Returns a read-only reference to the managed object. Check-fails if
   // `HasValue()` is `false`.
   const T& Value() const {
     ABSL_CHECK(HasValue());
-    return *value_;
+    return block_->value;
   }
 
   // Returns a read-only reference to the managed object. Behavior is undefined
   // if `HasValue()` returns `false`; CHECK-fails in debug.
   const T& operator*() const {
     ABSL_DCHECK(HasValue());
-    return *value_;
+    return block_->value;
   }
 
   // Returns a read-only pointer to the managed object. Behavior is undefined
   // if `HasValue()` returns `false`; CHECK-fails in debug.
   const T* operator->() const {
     ABSL_DCHECK(HasValue());
-    return value_.get();
+    return &block_->value;
   }
 
  private:
-  absl_nullable std::shared_ptr<T> value_;
+  // The managed object, allocated together with the number of `CopyOnWrite`
+  // objects that share it.
+  struct Block {
+    template <typename... Args>
+    explicit Block(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    void AddRef() {
+      if constexpr (kSharing == CopyOnWriteSharing::kThreadSafe) {
+        ref_count.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        ++ref_count;
+      }
+    }
+
+    // Returns true if this released the last reference.
+    bool Release() {
+      if constexpr (kSharing == CopyOnWriteSharing::kThreadSafe) {
+        return ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+      } else {
+        return --ref_count == 0;
+      }
+    }
+
+    bool IsShared() const {
+      if constexpr (kSharing == CopyOnWriteSharing::kThreadSafe) {
+        // Acquire ordering makes any use of the value by owners that have
+        // since released it happen before this owner mutates it.
+        return ref_count.load(std::memory_order_acquire) > 1;
+      } else {
+        return ref_count > 1;
+      }
+    }
+
+    std::conditional_t<kSharing == CopyOnWriteSharing::kThreadSafe,
+                       std::atomic<uint32_t>, uint32_t>
+        ref_count = 1;
+    T value;
+  };
+
+  Block* absl_nullable block_ = nullptr;
 };
 
+// A `CopyOnWrite` whose copies must all be used from a single thread at a
+// time. See `CopyOnWriteSharing::kThreadConfined`.
+template <typename T>
+using ThreadConfinedCopyOnWrite =
+    CopyOnWrite<T, CopyOnWriteSharing::kThreadConfined>;
+
 }  // namespace ink_internal
 
 #endif  // INK_TYPES_INTERNAL_COPY_ON_WRITE_H_
@@ -177,6 +177,72 @@ TEST(CopyOnWriteTest, GetMutatableValueAfterCopy) {
   EXPECT_THAT(*y, ElementsAreArray(*x));
 }
 
+TEST(CopyOnWriteTest, SelfAssignment) {
+  CopyOnWrite<int> x(5);
+  CopyOnWrite<int>& x_ref = x;
+  x = x_ref;
+  EXPECT_TRUE(x.HasValue());
+  EXPECT_FALSE(x.IsShared());
+  EXPECT_EQ(*x, 5);
+
+  x = std::move(x_ref);
+  EXPECT_TRUE(x.HasValue());
+  EXPECT_FALSE(x.IsShared());
+  EXPECT_EQ(*x, 5);
+}
+
+TEST(CopyOnWriteTest, EmplaceFromOwnValue) {
+  CopyOnWrite<std::vector<int>> x;
+  x.Emplace() = {1, 2, 3};
+  const int* address_before_emplace = x->data();
+
+  x.Emplace(*x);
+  EXPECT_NE(x->data(), address_before_emplace);
+  EXPECT_THAT(*x, ElementsAreArray({1, 2, 3}));
+}
+
+TEST(CopyOnWriteTest, ThreadConfinedCopyIsShallowUntilMutated) {
+  ThreadConfinedCopyOnWrite<std::vector<int>> x;
+  x.Emplace() = {1, 2, 3};
+  const int* address_before_copy = x->data();
+
+  ThreadConfinedCopyOnWrite<std::vector<int>> y = x;
+  EXPECT_TRUE(x.IsShared());
+  EXPECT_TRUE(y.IsShared());
+  EXPECT_EQ(y->data(), address_before_copy);
+
+  y.MutableValue().push_back(4);
+  EXPECT_FALSE(x.IsShared());
+  EXPECT_FALSE(y.IsShared());
+  EXPECT_EQ(x->data(), address_before_copy);
+  EXPECT_THAT(*x, ElementsAreArray({1, 2, 3}));
+  EXPECT_THAT(*y, ElementsAreArray({1, 2, 3, 4}));
+
+  // Once the copy is gone, the original can be mutated in place.
+  y = x;
+  const std::vector<int>* value_before_reset = &*x;
+  y.Reset();
+  EXPECT_EQ(&x.MutableValue(), value_before_reset);
+}
+
+TEST(CopyOnWriteTest, ThreadConfinedMoveLeavesEmpty) {
+  ThreadConfinedCopyOnWrite<int> x(3);
+  ThreadConfinedCopyOnWrite<int> y = x;
+  ThreadConfinedCopyOnWrite<int> z(std::move(y));
+
+  // (Suppress ClangTidy bugprone-use-after-move)
+  EXPECT_FALSE(y.HasValue());  // NOLINT
+  EXPECT_TRUE(x.IsShared());
+  EXPECT_TRUE(z.IsShared());
+  EXPECT_EQ(*z, 3);
+
+  x = ThreadConfinedCopyOnWrite<int>(4);
+  EXPECT_FALSE(x.IsShared());
+  EXPECT_FALSE(z.IsShared());
+  EXPECT_EQ(*x, 4);
+  EXPECT_EQ(*z, 3);
+}
+
 TEST(CopyOnWriteTest, MutableValueOnEmpty) {
   CopyOnWrite<int> x;
   ASSERT_FALSE(x.HasValue());
@@ -0,0 +1,68 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_TYPES_MEMORY_FOOTPRINT_H_
+#define INK_TYPES_MEMORY_FOOTPRINT_H_
+
+#include <cstddef>
+
+#include "absl/base/nullability.h"
+#include "absl/container/flat_hash_set.h"
+
+namespace ink {
+
+// Accumulates an estimate of the heap memory held by Ink objects, such as
+// `Stroke`, `PartitionedMesh`, and `StrokeInputBatch`.
+//
+// Many Ink objects share their data with their copies. Each object reports the
+// shared data it refers to, but a `MemoryFootprint` only counts each shared
+// allocation the first time it is reported. Adding several objects to the same
+// `MemoryFootprint` therefore gives the memory held by all of them together,
+// and adding a copy of an object that was already added costs nothing.
+//
+// The estimate covers the allocations owned by each object, but not the inline
+// size of the object itself, which belongs to whatever holds the object, nor
+// the overhead of the memory allocator.
+class MemoryFootprint {
+ public:
+  MemoryFootprint() = default;
+  MemoryFootprint(const MemoryFootprint&) = default;
+  MemoryFootprint(MemoryFootprint&&) = default;
+  MemoryFootprint& operator=(const MemoryFootprint&) = default;
+  MemoryFootprint& operator=(MemoryFootprint&&) = default;
+  ~MemoryFootprint() = default;
+
+  // Returns the total number of bytes added so far.
+  size_t TotalBytes() const { return total_bytes_; }
+
+  // Adds `bytes` that are owned by the object being added.
+  void AddBytes(size_t bytes) { total_bytes_ += bytes; }
+
+  // Records the shared allocation at `shared_data` as counted. Returns true if
+  // it had not already been counted, in which case the caller should go on to
+  // add the bytes it holds, or false if it had, in which case the caller
+  // should skip it.
+  bool AddShared(const void* absl_nonnull shared_data) {
+    return counted_shared_data_.insert(shared_data).second;
+  }
+
+ private:
+  absl::flat_hash_set<const void*> counted_shared_data_;
+  size_t total_bytes_ = 0;
+};
+
+}  // namespace ink
+
+#endif  // INK_TYPES_MEMORY_FOOTPRINT_H_
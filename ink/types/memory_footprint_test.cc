@@ -0,0 +1,58 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/types/memory_footprint.h"
+
+#include "gtest/gtest.h"
+
+namespace ink {
+namespace {
+
+TEST(MemoryFootprintTest, DefaultConstructedIsEmpty) {
+  EXPECT_EQ(MemoryFootprint().TotalBytes(), 0u);
+}
+
+TEST(MemoryFootprintTest, AddBytesAccumulates) {
+  MemoryFootprint footprint;
+  footprint.AddBytes(10);
+  footprint.AddBytes(32);
+  EXPECT_EQ(footprint.TotalBytes(), 42u);
+}
+
+TEST(MemoryFootprintTest, AddSharedOnlyReturnsTrueOncePerAllocation) {
+  int first = 0;
+  int second = 0;
+  MemoryFootprint footprint;
+  EXPECT_TRUE(footprint.AddShared(&first));
+  EXPECT_TRUE(footprint.AddShared(&second));
+  EXPECT_FALSE(footprint.AddShared(&first));
+  EXPECT_FALSE(footprint.AddShared(&second));
+  // Recording shared data doesn't add any bytes by itself.
+  EXPECT_EQ(footprint.TotalBytes(), 0u);
+}
+
+TEST(MemoryFootprintTest, CopyRemembersCountedSharedData) {
+  int shared = 0;
+  MemoryFootprint footprint;
+  ASSERT_TRUE(footprint.AddShared(&shared));
+  footprint.AddBytes(8);
+
+  MemoryFootprint copy = footprint;
+  EXPECT_EQ(copy.TotalBytes(), 8u);
+  EXPECT_FALSE(copy.AddShared(&shared));
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,90 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/types/memory_trim.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+#include "absl/base/const_init.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ink {
+namespace {
+
+struct RegisteredCallback {
+  MemoryTrimLevel level;
+  MemoryTrimCallback callback;
+};
+
+ABSL_CONST_INIT absl::Mutex registry_mutex(absl::kConstInit);
+
+// Registered callbacks, in order of registration.
+std::map<uint64_t, RegisteredCallback>& Registry()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(registry_mutex) {
+  // Intentionally leaked to avoid destruction order issues at exit.
+  static auto* registry = new std::map<uint64_t, RegisteredCallback>();
+  return *registry;
+}
+
+uint64_t next_id ABSL_GUARDED_BY(registry_mutex) = 1;
+
+void Unregister(uint64_t id) {
+  if (id == 0) return;
+  absl::MutexLock lock(&registry_mutex);
+  Registry().erase(id);
+}
+
+}  // namespace
+
+MemoryTrimRegistration::MemoryTrimRegistration(MemoryTrimRegistration&& other)
+    : id_(std::exchange(other.id_, 0)) {}
+
+MemoryTrimRegistration& MemoryTrimRegistration::operator=(
+    MemoryTrimRegistration&& other) {
+  if (this != &other) {
+    Unregister(id_);
+    id_ = std::exchange(other.id_, 0);
+  }
+  return *this;
+}
+
+MemoryTrimRegistration::~MemoryTrimRegistration() { Unregister(id_); }
+
+MemoryTrimRegistration RegisterMemoryTrimCallback(
+    MemoryTrimLevel level, MemoryTrimCallback callback) {
+  absl::MutexLock lock(&registry_mutex);
+  uint64_t id = next_id++;
+  Registry().emplace(id, RegisteredCallback{.level = level,
+                                            .callback = std::move(callback)});
+  return MemoryTrimRegistration(id);
+}
+
+size_t TrimMemory(MemoryTrimLevel level) {
+  absl::MutexLock lock(&registry_mutex);
+  size_t bytes = 0;
+  for (int pass = 0; pass <= static_cast<int>(level); ++pass) {
+    for (auto& [id, registered] : Registry()) {
+      if (static_cast<int>(registered.level) == pass) {
+        bytes += registered.callback();
+      }
+    }
+  }
+  return bytes;
+}
+
+}  // namespace ink
@@ -0,0 +1,92 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_TYPES_MEMORY_TRIM_H_
+#define INK_TYPES_MEMORY_TRIM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/functional/any_invocable.h"
+
+namespace ink {
+
+// How much memory `TrimMemory()` should release. Each level releases the
+// memory of every lower level as well, and levels are trimmed from lowest to
+// highest, so that memory that is cheapest to get back goes first.
+//
+// On Android, `ComponentCallbacks2.onTrimMemory()` can map
+// `TRIM_MEMORY_UI_HIDDEN` to `kPooledMemory`, `TRIM_MEMORY_BACKGROUND` to
+// `kCaches`, and anything more severe to `kAll`.
+enum class MemoryTrimLevel : uint8_t {
+  // Idle storage kept for reuse by later allocations, such as the free lists
+  // of the JNI object pools and the idle stroke shape builders. Releasing it
+  // only costs the allocations it would have saved.
+  kPooledMemory,
+  // Results that are recomputed from their inputs on a cache miss, such as the
+  // `StrokeShapeCache` and `BrushFamilyDecodeCache` process caches.
+  kCaches,
+  // Everything that can be rebuilt, including texture images, which have to
+  // be fetched from the `TextureBitmapStore` again.
+  kAll,
+};
+
+// A callback that releases the memory belonging to one `MemoryTrimLevel`, and
+// returns an estimate of the number of bytes it released.
+using MemoryTrimCallback = absl::AnyInvocable<size_t()>;
+
+// Keeps a callback registered with `RegisterMemoryTrimCallback()`, and
+// unregisters it when destroyed. Once the destructor returns, the callback is
+// not running and will not be called again.
+class MemoryTrimRegistration {
+ public:
+  // Constructs a registration that holds no callback.
+  MemoryTrimRegistration() = default;
+  MemoryTrimRegistration(const MemoryTrimRegistration&) = delete;
+  MemoryTrimRegistration(MemoryTrimRegistration&& other);
+  MemoryTrimRegistration& operator=(const MemoryTrimRegistration&) = delete;
+  MemoryTrimRegistration& operator=(MemoryTrimRegistration&& other);
+  ~MemoryTrimRegistration();
+
+ private:
+  friend MemoryTrimRegistration RegisterMemoryTrimCallback(
+      MemoryTrimLevel level, MemoryTrimCallback callback);
+
+  explicit MemoryTrimRegistration(uint64_t id) : id_(id) {}
+
+  // The key of the callback in the process-wide registry, or zero if none.
+  uint64_t id_ = 0;
+};
+
+// Registers `callback` to be called by every `TrimMemory()` call with a level
+// of at least `level`, for as long as the returned registration is alive.
+//
+// Callbacks may be called on any thread, and are called one at a time while
+// holding the registry's lock, so they must not register or unregister
+// callbacks themselves.
+[[nodiscard]] MemoryTrimRegistration RegisterMemoryTrimCallback(
+    MemoryTrimLevel level, MemoryTrimCallback callback);
+
+// Releases the memory of the rebuildable caches and pools of every registered
+// callback up to `level`, in order of level, and returns an estimate of the
+// total number of bytes released. This can be called from any thread.
+//
+// Memory that belongs to a single thread, such as the caches of a
+// `SkiaRenderer` other than its texture images, is not released by this;
+// release it on its own thread, e.g. with `SkiaRenderer::TrimMemory()`.
+size_t TrimMemory(MemoryTrimLevel level);
+
+}  // namespace ink
+
+#endif  // INK_TYPES_MEMORY_TRIM_H_
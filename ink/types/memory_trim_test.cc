@@ -0,0 +1,106 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ink/types/memory_trim.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace ink {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(MemoryTrimTest, TrimWithoutCallbacksReleasesNothing) {
+  EXPECT_EQ(TrimMemory(MemoryTrimLevel::kAll), 0);
+}
+
+TEST(MemoryTrimTest, CallsCallbacksUpToLevelInOrderOfLevel) {
+  std::vector<std::string> calls;
+  MemoryTrimRegistration all =
+      RegisterMemoryTrimCallback(MemoryTrimLevel::kAll, [&calls]() {
+        calls.push_back("all");
+        return 100;
+      });
+  MemoryTrimRegistration caches =
+      RegisterMemoryTrimCallback(MemoryTrimLevel::kCaches, [&calls]() {
+        calls.push_back("caches");
+        return 10;
+      });
+  MemoryTrimRegistration pools =
+      RegisterMemoryTrimCallback(MemoryTrimLevel::kPooledMemory, [&calls]() {
+        calls.push_back("pools");
+        return 1;
+      });
+
+  EXPECT_EQ(TrimMemory(MemoryTrimLevel::kPooledMemory), 1);
+  EXPECT_THAT(calls, ElementsAre("pools"));
+
+  calls.clear();
+  EXPECT_EQ(TrimMemory(MemoryTrimLevel::kCaches), 11);
+  EXPECT_THAT(calls, ElementsAre("pools", "caches"));
+
+  calls.clear();
+  EXPECT_EQ(TrimMemory(MemoryTrimLevel::kAll), 111);
+  EXPECT_THAT(calls, ElementsAre("pools", "caches", "all"));
+}
+
+TEST(MemoryTrimTest, DestroyingRegistrationUnregistersCallback) {
+  int call_count = 0;
+  {
+    MemoryTrimRegistration registration = RegisterMemoryTrimCallback(
+        MemoryTrimLevel::kPooledMemory, [&call_count]() {
+          ++call_count;
+          return 5;
+        });
+    EXPECT_EQ(TrimMemory(MemoryTrimLevel::kAll), 5);
+  }
+  EXPECT_EQ(TrimMemory(MemoryTrimLevel::kAll), 0);
+  EXPECT_EQ(call_count, 1);
+}
+
+TEST(MemoryTrimTest, MovedRegistrationKeepsCallback) {
+  std::vector<int> calls;
+  MemoryTrimRegistration first = RegisterMemoryTrimCallback(
+      MemoryTrimLevel::kCaches, [&calls]() {
+        calls.push_back(1);
+        return 0;
+      });
+  MemoryTrimRegistration moved = std::move(first);
+  first = MemoryTrimRegistration();
+  TrimMemory(MemoryTrimLevel::kCaches);
+  EXPECT_THAT(calls, ElementsAre(1));
+
+  // Assigning over a registration unregisters its previous callback.
+  moved = RegisterMemoryTrimCallback(MemoryTrimLevel::kCaches, [&calls]() {
+    calls.push_back(2);
+    return 0;
+  });
+  calls.clear();
+  TrimMemory(MemoryTrimLevel::kCaches);
+  EXPECT_THAT(calls, ElementsAre(2));
+
+  moved = MemoryTrimRegistration();
+  calls.clear();
+  TrimMemory(MemoryTrimLevel::kCaches);
+  EXPECT_THAT(calls, IsEmpty());
+}
+
+}  // namespace
+}  // namespace ink
@@ -0,0 +1,113 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INK_TYPES_TEST_EXECUTOR_H_
+#define INK_TYPES_TEST_EXECUTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "ink/types/executor.h"
+
+namespace ink {
+
+// An `Executor` for tests that runs every task on its own newly-created thread,
+// so that tests of parallel code paths actually exercise concurrency.
+class ThreadPerTaskExecutor : public Executor {
+ public:
+  // Waits for all tasks passed to `Schedule()` to finish.
+  ~ThreadPerTaskExecutor() override {
+    // The tasks may themselves schedule more tasks, so keep going until there
+    // are none left.
+    while (true) {
+      std::vector<std::thread> threads;
+      {
+        absl::MutexLock lock(&mutex_);
+        threads.swap(scheduled_threads_);
+      }
+      if (threads.empty()) return;
+      for (std::thread& thread : threads) thread.join();
+    }
+  }
+
+  void ParallelFor(size_t count,
+                   absl::FunctionRef<void(size_t)> task) override {
+    parallel_for_calls_.fetch_add(1, std::memory_order_relaxed);
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      threads.emplace_back([task, i]() { task(i); });
+    }
+    for (std::thread& thread : threads) thread.join();
+  }
+
+  void Schedule(absl::AnyInvocable<void() &&> task) override {
+    absl::MutexLock lock(&mutex_);
+    scheduled_threads_.emplace_back(
+        [task = std::move(task)]() mutable { std::move(task)(); });
+  }
+
+  // Returns the number of times `ParallelFor()` has been called.
+  int ParallelForCalls() const {
+    return parallel_for_calls_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int> parallel_for_calls_ = 0;
+  absl::Mutex mutex_;
+  std::vector<std::thread> scheduled_threads_ ABSL_GUARDED_BY(mutex_);
+};
+
+// An `Executor` for tests that holds on to the tasks passed to `Schedule()`
+// until `RunScheduledTasks()` is called, so that tests can observe the state
+// before background work has run. `ParallelFor()` runs its tasks in order on
+// the calling thread.
+class ManualExecutor : public Executor {
+ public:
+  void ParallelFor(size_t count,
+                   absl::FunctionRef<void(size_t)> task) override {
+    for (size_t i = 0; i < count; ++i) task(i);
+  }
+
+  void Schedule(absl::AnyInvocable<void() &&> task) override {
+    scheduled_tasks_.push_back(std::move(task));
+  }
+
+  // Returns the number of scheduled tasks that have not yet been run.
+  size_t PendingTaskCount() const { return scheduled_tasks_.size(); }
+
+  // Runs and discards all currently scheduled tasks, in the order they were
+  // scheduled.
+  void RunScheduledTasks() {
+    std::deque<absl::AnyInvocable<void() &&>> tasks =
+        std::move(scheduled_tasks_);
+    scheduled_tasks_.clear();
+    for (absl::AnyInvocable<void() &&>& task : tasks) std::move(task)();
+  }
+
+ private:
+  std::deque<absl::AnyInvocable<void() &&>> scheduled_tasks_;
+};
+
+}  // namespace ink
+
+#endif  // INK_TYPES_TEST_EXECUTOR_H_
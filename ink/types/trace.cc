@@ -0,0 +1,37 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/types/trace.h"
+
+#include <atomic>
+
+#include "absl/base/nullability.h"
+
+namespace ink {
+namespace {
+
+constinit std::atomic<TraceSink*> global_trace_sink = nullptr;
+
+}  // namespace
+
+void SetTraceSink(TraceSink* absl_nullable sink) {
+  global_trace_sink.store(sink, std::memory_order_release);
+}
+
+TraceSink* absl_nullable GetTraceSink() {
+  return global_trace_sink.load(std::memory_order_acquire);
+}
+
+}  // namespace ink
@@ -0,0 +1,75 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INK_TYPES_TRACE_H_
+#define INK_TYPES_TRACE_H_
+
+#include "absl/base/nullability.h"
+
+namespace ink {
+
+// An interface for receiving trace events from Ink's more expensive
+// operations, so that they can be forwarded to a host profiling tool such as
+// ATrace or the Perfetto SDK.
+//
+// Events are strictly nested on each thread: every call to `BeginEvent()` is
+// matched by a later call to `EndEvent()` on the same thread, and any events
+// that begin in between also end in between.
+class TraceSink {
+ public:
+  virtual ~TraceSink() = default;
+
+  // Called when an event named `name` begins on the current thread. `name` is
+  // a null-terminated string literal that remains valid for the lifetime of the
+  // program.
+  virtual void BeginEvent(const char* absl_nonnull name) = 0;
+
+  // Called when the most recently begun event on the current thread ends.
+  virtual void EndEvent() = 0;
+};
+
+// Installs `sink` as the destination for trace events from every thread, or
+// stops emitting trace events if `sink` is null. The `sink` must remain valid
+// until it is replaced and any events already begun on it have ended.
+//
+// There is no sink installed by default.
+void SetTraceSink(TraceSink* absl_nullable sink);
+
+// Returns the currently installed sink, or null if there is none.
+TraceSink* absl_nullable GetTraceSink();
+
+// Emits a trace event that begins on construction and ends on destruction.
+//
+// When no sink is installed, this just checks for one on construction; in
+// particular, no event will be ended on a sink installed after construction.
+class ScopedTraceEvent {
+ public:
+  explicit ScopedTraceEvent(const char* absl_nonnull name)
+      : sink_(GetTraceSink()) {
+    if (sink_ != nullptr) sink_->BeginEvent(name);
+  }
+  ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+  ScopedTraceEvent& operator=(const ScopedTraceEvent&) = delete;
+  ~ScopedTraceEvent() {
+    if (sink_ != nullptr) sink_->EndEvent();
+  }
+
+ private:
+  TraceSink* absl_nullable sink_;
+};
+
+}  // namespace ink
+
+#endif  // INK_TYPES_TRACE_H_
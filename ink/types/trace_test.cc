@@ -0,0 +1,83 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "ink/types/trace.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace ink {
+namespace {
+
+using ::testing::ElementsAre;
+
+class RecordingTraceSink : public TraceSink {
+ public:
+  void BeginEvent(const char* name) override {
+    events_.push_back(std::string("begin ") + name);
+  }
+  void EndEvent() override { events_.push_back("end"); }
+
+  const std::vector<std::string>& Events() const { return events_; }
+
+ private:
+  std::vector<std::string> events_;
+};
+
+TEST(TraceTest, NoSinkByDefault) { EXPECT_EQ(GetTraceSink(), nullptr); }
+
+TEST(TraceTest, ScopedEventsAreNested) {
+  RecordingTraceSink sink;
+  SetTraceSink(&sink);
+  {
+    ScopedTraceEvent outer("outer");
+    ScopedTraceEvent inner("inner");
+  }
+  SetTraceSink(nullptr);
+
+  EXPECT_THAT(sink.Events(),
+              ElementsAre("begin outer", "begin inner", "end", "end"));
+}
+
+TEST(TraceTest, EventEndsOnSinkItBeganOn) {
+  RecordingTraceSink first_sink;
+  RecordingTraceSink second_sink;
+  SetTraceSink(&first_sink);
+  {
+    ScopedTraceEvent event("event");
+    SetTraceSink(&second_sink);
+  }
+  SetTraceSink(nullptr);
+
+  EXPECT_THAT(first_sink.Events(), ElementsAre("begin event", "end"));
+  EXPECT_THAT(second_sink.Events(), ElementsAre());
+}
+
+TEST(TraceTest, NoEventsWithoutSink) {
+  RecordingTraceSink sink;
+  {
+    ScopedTraceEvent event("event");
+    SetTraceSink(&sink);
+  }
+  SetTraceSink(nullptr);
+
+  EXPECT_THAT(sink.Events(), ElementsAre());
+}
+
+}  // namespace
+}  // namespace ink